@@ -6,16 +6,92 @@
 
 #include <stddef.h>
 
+#include "base/cpu.h"
+#include "build/build_config.h"
 #include "third_party/modp_b64/modp_b64.h"
 
+#if defined(ARCH_CPU_X86_FAMILY) && defined(COMPILER_GCC)
+#define BASE_BASE64_HAVE_SSSE3 1
+#include <tmmintrin.h>
+#endif
+
 namespace base {
 
+namespace {
+
+#if defined(BASE_BASE64_HAVE_SSSE3)
+
+// Encodes groups of 12 input bytes into 16 base64 characters per iteration.
+// Each 32-bit lane is shuffled to hold one 3-byte group, the four 6-bit
+// indices are extracted with masked multiplies, and the indices are
+// translated to ASCII with a range-offset shuffle table. Reads 16 bytes per
+// load, so it stops once fewer than 16 input bytes remain and returns the
+// number of bytes consumed (a multiple of 12); the caller encodes the
+// remainder, including any padding.
+__attribute__((target("ssse3"))) size_t
+Base64EncodeSSSE3(const char* input, size_t input_size, char* output) {
+  // Positions each 3-byte group within a 32-bit lane, duplicating the middle
+  // bytes, so that every 6-bit index can be reached by a 16-bit multiply.
+  const __m128i kReshuffle = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3,
+                                          4, 1, 2, 0, 1);
+  // Offsets from a 6-bit index to its base64 character, by index range:
+  // [0,25] -> 'A', [26,51] -> 'a'-26, [52,61] -> '0'-52, 62 -> '+', 63 -> '/'.
+  const __m128i kRangeOffsets = _mm_setr_epi8(65, 71, -4, -4, -4, -4, -4, -4,
+                                              -4, -4, -4, -4, -19, -16, 0, 0);
+  size_t consumed = 0;
+  while (input_size - consumed >= 16) {
+    const __m128i in = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + consumed)),
+        kReshuffle);
+    const __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    // Reduce each index to the number of its range in |kRangeOffsets|: the
+    // saturating subtraction maps [0,51] to 0 and [52,63] to [1,12], then the
+    // comparison bumps [26,63] by one.
+    __m128i ranges = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    ranges = _mm_sub_epi8(ranges, _mm_cmpgt_epi8(indices, _mm_set1_epi8(25)));
+    const __m128i ascii =
+        _mm_add_epi8(indices, _mm_shuffle_epi8(kRangeOffsets, ranges));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output), ascii);
+
+    consumed += 12;
+    output += 16;
+  }
+  return consumed;
+}
+
+bool Base64HaveSSSE3() {
+  static const bool has_ssse3 = CPU().has_ssse3();
+  return has_ssse3;
+}
+
+#endif  // defined(BASE_BASE64_HAVE_SSSE3)
+
+}  // namespace
+
 void Base64Encode(const StringPiece& input, std::string* output) {
   std::string temp;
   temp.resize(modp_b64_encode_len(input.size()));  // makes room for null byte
 
+  size_t consumed = 0;
+  size_t written = 0;
+#if defined(BASE_BASE64_HAVE_SSSE3)
+  if (input.size() >= 16 && Base64HaveSSSE3()) {
+    consumed = Base64EncodeSSSE3(input.data(), input.size(), &temp[0]);
+    written = consumed / 3 * 4;
+  }
+#endif
+
   // modp_b64_encode_len() returns at least 1, so temp[0] is safe to use.
-  size_t output_size = modp_b64_encode(&(temp[0]), input.data(), input.size());
+  // Since |consumed| is a multiple of 3, the remainder starts on a group
+  // boundary and modp_b64_encode() finishes the stream, padding included.
+  size_t output_size = written + modp_b64_encode(&temp[written],
+                                                 input.data() + consumed,
+                                                 input.size() - consumed);
 
   temp.resize(output_size);  // strips off null byte
   output->swap(temp);
@@ -0,0 +1,86 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/base64.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace base {
+
+namespace {
+
+// Returns |size| bytes of deterministic pseudo-random binary data.
+std::string MakeTestBlob(size_t size) {
+  std::string blob(size, '\0');
+  uint32_t state = 0x8badf00d;
+  for (size_t i = 0; i < size; ++i) {
+    state = state * 1664525 + 1013904223;
+    blob[i] = static_cast<char>(state >> 24);
+  }
+  return blob;
+}
+
+void RunEncodeBenchmark(const char* trace, size_t input_size, int iterations) {
+  const std::string blob = MakeTestBlob(input_size);
+  std::string encoded;
+
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < iterations; ++i)
+    Base64Encode(blob, &encoded);
+  TimeDelta elapsed = TimeTicks::Now() - start;
+
+  const double throughput_mb_s =
+      static_cast<double>(input_size) * iterations /
+      elapsed.InSecondsF() / (1024 * 1024);
+  perf_test::PrintResult("Base64Encode", "", trace, throughput_mb_s, "MB/s",
+                         true);
+}
+
+void RunHexEncodeBenchmark(const char* trace,
+                           size_t input_size,
+                           int iterations) {
+  const std::string blob = MakeTestBlob(input_size);
+  std::string encoded;
+
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < iterations; ++i)
+    encoded = HexEncode(blob.data(), blob.size());
+  TimeDelta elapsed = TimeTicks::Now() - start;
+
+  const double throughput_mb_s =
+      static_cast<double>(input_size) * iterations /
+      elapsed.InSecondsF() / (1024 * 1024);
+  perf_test::PrintResult("HexEncode", "", trace, throughput_mb_s, "MB/s",
+                         true);
+}
+
+}  // namespace
+
+// Covers the sizes seen in logging and NetLog export: short identifiers,
+// packet-sized payloads, and multi-megabyte log dumps.
+TEST(Base64PerfTest, Encode) {
+  RunEncodeBenchmark("64b", 64, 200000);
+  RunEncodeBenchmark("1400b", 1400, 100000);
+  RunEncodeBenchmark("64kb", 64 * 1024, 4000);
+  RunEncodeBenchmark("4mb", 4 * 1024 * 1024, 64);
+}
+
+TEST(Base64PerfTest, HexEncode) {
+  RunHexEncodeBenchmark("64b", 64, 200000);
+  RunHexEncodeBenchmark("1400b", 1400, 100000);
+  RunHexEncodeBenchmark("64kb", 64 * 1024, 4000);
+  RunHexEncodeBenchmark("4mb", 4 * 1024 * 1024, 64);
+}
+
+}  // namespace base
@@ -430,6 +430,17 @@ TEST_F(BindTest, OnceCallbackBasicTest) {
   EXPECT_EQ(41, BindOnce(c2, 13).Run());
 }
 
+// Verify that the BindState of a destroyed callback is recycled by the next
+// Bind() of the same size on the same thread.
+TEST_F(BindTest, BindStateFreeListRecycling) {
+  // Populate the free list bucket for this BindState size.
+  { OnceCallback<int(int)> warm_up = BindOnce(&Sum, 1, 2, 4, 8, 16); }
+
+  const size_t hits_before = internal::GetBindStateFreeListHitCountForTesting();
+  { OnceCallback<int(int)> recycled = BindOnce(&Sum, 2, 3, 5, 7, 11); }
+  EXPECT_GT(internal::GetBindStateFreeListHitCountForTesting(), hits_before);
+}
+
 // IgnoreResult adapter test.
 //   - Function with return value.
 //   - Method with return value.
@@ -4,7 +4,13 @@
 
 #include "base/callback_internal.h"
 
+#include <stdlib.h>
+
+#include "base/atomicops.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
 
 namespace base {
 namespace internal {
@@ -15,8 +21,122 @@ bool ReturnFalse(const BindStateBase*) {
   return false;
 }
 
+// BindState allocations are rounded up to a multiple of
+// |kBindStateAllocGranularity| and recycled through a per-thread free list
+// with one bucket per size class. Allocations larger than
+// |kBindStateAllocMaxSize| go straight to the heap. The free list requires no
+// lock: blocks freed on a thread are reused by that thread, which is the
+// common case since callbacks are typically destroyed where they run.
+constexpr size_t kBindStateAllocGranularity = 32;
+constexpr size_t kBindStateAllocMaxSize = 256;
+constexpr size_t kBindStateAllocBuckets =
+    kBindStateAllocMaxSize / kBindStateAllocGranularity;
+
+// Bounds the number of free blocks cached per bucket on each thread.
+constexpr size_t kBindStateAllocMaxFreePerBucket = 16;
+
+// Precedes every BindState allocation. |bytes| holds the rounded-up
+// allocation size, or 0 if the allocation was too large for the free list.
+// Two words, so that the data that follows keeps malloc()'s alignment. The
+// first word doubles as the free list "next" pointer while a block is on the
+// list.
+struct BlockHeader {
+  size_t bytes;
+  size_t unused_padding;
+};
+
+struct BindStateFreeList {
+  void* buckets[kBindStateAllocBuckets];
+  size_t counts[kBindStateAllocBuckets];
+};
+
+subtle::AtomicWord g_free_list_hits = 0;
+subtle::AtomicWord g_free_list_misses = 0;
+
+ThreadLocalStorage::StaticSlot g_free_list_tls = TLS_INITIALIZER;
+LazyInstance<Lock>::Leaky g_free_list_tls_init_lock = LAZY_INSTANCE_INITIALIZER;
+
+void DestroyFreeList(void* value) {
+  BindStateFreeList* free_list = static_cast<BindStateFreeList*>(value);
+  for (size_t i = 0; i < kBindStateAllocBuckets; ++i) {
+    void* block = free_list->buckets[i];
+    while (block) {
+      void* next = *static_cast<void**>(block);
+      free(block);
+      block = next;
+    }
+  }
+  delete free_list;
+}
+
+BindStateFreeList* GetBindStateFreeList() {
+  if (!g_free_list_tls.initialized()) {
+    AutoLock auto_lock(g_free_list_tls_init_lock.Get());
+    if (!g_free_list_tls.initialized())
+      g_free_list_tls.Initialize(&DestroyFreeList);
+  }
+  BindStateFreeList* free_list =
+      static_cast<BindStateFreeList*>(g_free_list_tls.Get());
+  if (!free_list) {
+    free_list = new BindStateFreeList();
+    g_free_list_tls.Set(free_list);
+  }
+  return free_list;
+}
+
 }  // namespace
 
+void* BindStateBase::operator new(size_t size) {
+  const size_t total_size = (size + sizeof(BlockHeader) +
+                             kBindStateAllocGranularity - 1) &
+                            ~(kBindStateAllocGranularity - 1);
+  if (total_size <= kBindStateAllocMaxSize) {
+    const size_t bucket = total_size / kBindStateAllocGranularity - 1;
+    BindStateFreeList* free_list = GetBindStateFreeList();
+    void* block = free_list->buckets[bucket];
+    if (block) {
+      free_list->buckets[bucket] = *static_cast<void**>(block);
+      free_list->counts[bucket]--;
+      subtle::NoBarrier_AtomicIncrement(&g_free_list_hits, 1);
+      BlockHeader* header = static_cast<BlockHeader*>(block);
+      header->bytes = total_size;
+      return header + 1;
+    }
+  }
+  subtle::NoBarrier_AtomicIncrement(&g_free_list_misses, 1);
+  const bool recyclable = total_size <= kBindStateAllocMaxSize;
+  BlockHeader* header = static_cast<BlockHeader*>(
+      malloc(recyclable ? total_size : size + sizeof(BlockHeader)));
+  CHECK(header);
+  header->bytes = recyclable ? total_size : 0;
+  return header + 1;
+}
+
+void BindStateBase::operator delete(void* ptr) {
+  if (!ptr)
+    return;
+  BlockHeader* header = static_cast<BlockHeader*>(ptr) - 1;
+  if (header->bytes != 0) {
+    const size_t bucket = header->bytes / kBindStateAllocGranularity - 1;
+    BindStateFreeList* free_list = GetBindStateFreeList();
+    if (free_list->counts[bucket] < kBindStateAllocMaxFreePerBucket) {
+      *reinterpret_cast<void**>(header) = free_list->buckets[bucket];
+      free_list->buckets[bucket] = header;
+      free_list->counts[bucket]++;
+      return;
+    }
+  }
+  free(header);
+}
+
+size_t GetBindStateFreeListHitCountForTesting() {
+  return static_cast<size_t>(subtle::NoBarrier_Load(&g_free_list_hits));
+}
+
+size_t GetBindStateFreeListMissCountForTesting() {
+  return static_cast<size_t>(subtle::NoBarrier_Load(&g_free_list_misses));
+}
+
 void BindStateBaseRefCountTraits::Destruct(const BindStateBase* bind_state) {
   bind_state->destructor_(bind_state);
 }
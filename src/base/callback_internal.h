@@ -8,6 +8,8 @@
 #ifndef BASE_CALLBACK_INTERNAL_H_
 #define BASE_CALLBACK_INTERNAL_H_
 
+#include <stddef.h>
+
 #include "base/base_export.h"
 #include "base/callback_forward.h"
 #include "base/macros.h"
@@ -49,6 +51,13 @@ class BASE_EXPORT BindStateBase
 
   using InvokeFuncStorage = void(*)();
 
+  // BindStates are allocated for nearly every base::Bind() call, so small
+  // ones are recycled through a per-thread free list instead of paying for a
+  // heap allocation and deallocation per callback. Large BindStates fall back
+  // to the heap. See callback_internal.cc.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr);
+
  private:
   BindStateBase(InvokeFuncStorage polymorphic_invoke,
                 void (*destructor)(const BindStateBase*));
@@ -153,6 +162,13 @@ class BASE_EXPORT CallbackBase<CopyMode::Copyable>
 extern template class CallbackBase<CopyMode::MoveOnly>;
 extern template class CallbackBase<CopyMode::Copyable>;
 
+// Number of BindState allocations that were served from the per-thread free
+// list, and number that had to go to the heap (either because the free list
+// bucket was empty or because the BindState was too large). Approximate:
+// counters are incremented without barriers.
+BASE_EXPORT size_t GetBindStateFreeListHitCountForTesting();
+BASE_EXPORT size_t GetBindStateFreeListMissCountForTesting();
+
 }  // namespace internal
 }  // namespace base
 
@@ -0,0 +1,320 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_MRU_CACHE_H_
+#define BASE_CONTAINERS_FLAT_MRU_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace base {
+
+// FlatMRUCache is an MRUCache variant for hot caches. Where base::MRUCache
+// composes std::list and std::map -- two heap allocations per insert and a
+// pointer chase per touch -- FlatMRUCache stores entries directly in a
+// single open-addressed hash table allocated up front, with the recency
+// list threaded through the table slots as indices. Inserting, touching and
+// evicting never allocate.
+//
+// Differences from MRUCache to be aware of when migrating:
+//  * The maximum size is fixed at construction; there is no NO_AUTO_EVICT.
+//  * The key must be hashable (as with HashingMRUCache) and is stored
+//    inline, so it should be reasonably cheap to move.
+//  * Iterators are invalidated by every mutation, except that Erase()
+//    returns a valid iterator to the next (older) entry.
+//
+// Iteration visits entries from most to least recently used. The table is
+// sized for a maximum load factor of 1/2, so the memory cost is roughly
+// 2 * max_size slots, each holding a value_type inline.
+template <class KeyType, class PayloadType, class HashType = std::hash<KeyType>>
+class FlatMRUCache {
+ public:
+  using value_type = std::pair<KeyType, PayloadType>;
+  using size_type = size_t;
+
+ private:
+  static const uint32_t kInvalidIndex = 0xffffffffu;
+
+  struct Slot {
+    value_type* value() {
+      return reinterpret_cast<value_type*>(&storage);
+    }
+    const value_type* value() const {
+      return reinterpret_cast<const value_type*>(&storage);
+    }
+
+    // Recency links; indices of other slots, or kInvalidIndex at the ends.
+    uint32_t prev = kInvalidIndex;
+    uint32_t next = kInvalidIndex;
+    size_t hash = 0;
+    bool occupied = false;
+    typename std::aligned_storage<sizeof(value_type),
+                                  alignof(value_type)>::type storage;
+  };
+
+ public:
+
+  // Iterates from the most to the least recently used entry.
+  template <bool is_const>
+  class Iterator {
+   public:
+    using CacheType =
+        typename std::conditional<is_const, const FlatMRUCache, FlatMRUCache>::
+            type;
+    using reference =
+        typename std::conditional<is_const, const value_type, value_type>::
+            type&;
+    using pointer =
+        typename std::conditional<is_const, const value_type, value_type>::
+            type*;
+
+    Iterator() : cache_(nullptr), index_(kInvalidIndex) {}
+
+    // Conversion from iterator to const_iterator.
+    Iterator(const Iterator<false>& other)
+        : cache_(other.cache_), index_(other.index_) {}
+
+    reference operator*() const { return *cache_->slots_[index_].value(); }
+    pointer operator->() const { return cache_->slots_[index_].value(); }
+
+    Iterator& operator++() {
+      index_ = cache_->slots_[index_].next;
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class FlatMRUCache;
+    template <bool other_const>
+    friend class Iterator;
+
+    Iterator(CacheType* cache, uint32_t index)
+        : cache_(cache), index_(index) {}
+
+    CacheType* cache_;
+    uint32_t index_;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  explicit FlatMRUCache(size_type max_size) : max_size_(max_size) {
+    DCHECK_GT(max_size, 0u);
+    DCHECK_LT(max_size, static_cast<size_type>(kInvalidIndex) / 2);
+    // Size the table so the load factor never exceeds 1/2.
+    table_size_ = 8;
+    while (table_size_ < max_size * 2)
+      table_size_ <<= 1;
+    mask_ = static_cast<uint32_t>(table_size_ - 1);
+    slots_.reset(new Slot[table_size_]);
+  }
+
+  ~FlatMRUCache() { Clear(); }
+
+  size_type max_size() const { return max_size_; }
+  size_type size() const { return count_; }
+  bool empty() const { return count_ == 0; }
+
+  // Inserts a payload item with the given key, evicting the least recently
+  // used entry if the cache is full. If an existing item has the same key,
+  // it is replaced. Returns an iterator to the inserted item, which is the
+  // front of the recency list.
+  template <typename Payload>
+  iterator Put(const KeyType& key, Payload&& payload) {
+    size_t hash = HashType()(key);
+    uint32_t existing = FindIndex(key, hash);
+    if (existing != kInvalidIndex)
+      RemoveEntry(existing, nullptr);
+    else if (count_ == max_size_)
+      RemoveEntry(tail_, nullptr);
+
+    uint32_t index = static_cast<uint32_t>(hash) & mask_;
+    while (slots_[index].occupied)
+      index = (index + 1) & mask_;
+    Slot* slot = &slots_[index];
+    new (&slot->storage) value_type(key, std::forward<Payload>(payload));
+    slot->hash = hash;
+    slot->occupied = true;
+    count_++;
+    LinkFront(index);
+    return iterator(this, index);
+  }
+
+  // Returns the item with the given key and moves it to the front of the
+  // recency list, or end() if not found.
+  iterator Get(const KeyType& key) {
+    uint32_t index = FindIndex(key, HashType()(key));
+    if (index == kInvalidIndex)
+      return end();
+    if (index != head_) {
+      Unlink(index);
+      LinkFront(index);
+    }
+    return iterator(this, index);
+  }
+
+  // Like Get(), but without affecting the recency ordering.
+  iterator Peek(const KeyType& key) {
+    uint32_t index = FindIndex(key, HashType()(key));
+    return index == kInvalidIndex ? end() : iterator(this, index);
+  }
+  const_iterator Peek(const KeyType& key) const {
+    uint32_t index = FindIndex(key, HashType()(key));
+    return index == kInvalidIndex ? end() : const_iterator(this, index);
+  }
+
+  // Erases the item referenced by the given iterator and returns an iterator
+  // to the next (older) item.
+  iterator Erase(iterator pos) {
+    DCHECK_EQ(this, pos.cache_);
+    DCHECK(slots_[pos.index_].occupied);
+    // Deletion may relocate other slots; RemoveEntry() keeps |next| pointing
+    // at the right entry if it moves.
+    uint32_t next = slots_[pos.index_].next;
+    RemoveEntry(pos.index_, &next);
+    return iterator(this, next);
+  }
+
+  // Shrinks the cache so it only holds |new_size| items, dropping the least
+  // recently used ones first. Does nothing if |new_size| is not smaller than
+  // the current size.
+  void ShrinkToSize(size_type new_size) {
+    while (count_ > new_size)
+      RemoveEntry(tail_, nullptr);
+  }
+
+  // Deletes everything from the cache.
+  void Clear() {
+    for (size_type i = 0; i < table_size_; i++) {
+      if (slots_[i].occupied) {
+        slots_[i].value()->~value_type();
+        slots_[i].occupied = false;
+      }
+      slots_[i].prev = kInvalidIndex;
+      slots_[i].next = kInvalidIndex;
+    }
+    head_ = kInvalidIndex;
+    tail_ = kInvalidIndex;
+    count_ = 0;
+  }
+
+  iterator begin() { return iterator(this, head_); }
+  const_iterator begin() const { return const_iterator(this, head_); }
+  iterator end() { return iterator(this, kInvalidIndex); }
+  const_iterator end() const { return const_iterator(this, kInvalidIndex); }
+
+ private:
+  // Returns the slot holding |key|, or kInvalidIndex. Linear probing with no
+  // tombstones: RemoveEntry() keeps probe chains contiguous, so the search
+  // may stop at the first free slot.
+  uint32_t FindIndex(const KeyType& key, size_t hash) const {
+    uint32_t index = static_cast<uint32_t>(hash) & mask_;
+    while (slots_[index].occupied) {
+      if (slots_[index].hash == hash && slots_[index].value()->first == key)
+        return index;
+      index = (index + 1) & mask_;
+    }
+    return kInvalidIndex;
+  }
+
+  void LinkFront(uint32_t index) {
+    slots_[index].prev = kInvalidIndex;
+    slots_[index].next = head_;
+    if (head_ != kInvalidIndex)
+      slots_[head_].prev = index;
+    else
+      tail_ = index;
+    head_ = index;
+  }
+
+  void Unlink(uint32_t index) {
+    Slot* slot = &slots_[index];
+    if (slot->prev != kInvalidIndex)
+      slots_[slot->prev].next = slot->next;
+    else
+      head_ = slot->next;
+    if (slot->next != kInvalidIndex)
+      slots_[slot->next].prev = slot->prev;
+    else
+      tail_ = slot->prev;
+  }
+
+  // Moves the contents of slot |from| into the free slot |to|, fixing up the
+  // recency links that referred to |from|. |*tracked|, if non-null, is an
+  // index a caller wants to keep valid across the move.
+  void MoveSlot(uint32_t from, uint32_t to, uint32_t* tracked) {
+    Slot* src = &slots_[from];
+    Slot* dest = &slots_[to];
+    new (&dest->storage) value_type(std::move(*src->value()));
+    src->value()->~value_type();
+    dest->hash = src->hash;
+    dest->occupied = true;
+    src->occupied = false;
+    dest->prev = src->prev;
+    dest->next = src->next;
+    if (dest->prev != kInvalidIndex)
+      slots_[dest->prev].next = to;
+    else
+      head_ = to;
+    if (dest->next != kInvalidIndex)
+      slots_[dest->next].prev = to;
+    else
+      tail_ = to;
+    if (tracked && *tracked == from)
+      *tracked = to;
+  }
+
+  // Unlinks and destroys the entry in slot |index|, then compacts the probe
+  // chain behind it (backward-shift deletion) so lookups never need
+  // tombstones.
+  void RemoveEntry(uint32_t index, uint32_t* tracked) {
+    Unlink(index);
+    slots_[index].value()->~value_type();
+    slots_[index].occupied = false;
+    count_--;
+
+    uint32_t hole = index;
+    uint32_t probe = (hole + 1) & mask_;
+    while (slots_[probe].occupied) {
+      uint32_t ideal = static_cast<uint32_t>(slots_[probe].hash) & mask_;
+      // The entry can stay if its ideal slot lies cyclically in
+      // (hole, probe]; otherwise its probe chain crossed the hole and it
+      // must be moved back.
+      bool reachable = hole <= probe ? (ideal > hole && ideal <= probe)
+                                     : (ideal > hole || ideal <= probe);
+      if (!reachable) {
+        MoveSlot(probe, hole, tracked);
+        hole = probe;
+      }
+      probe = (probe + 1) & mask_;
+    }
+  }
+
+  const size_type max_size_;
+  size_type table_size_;
+  uint32_t mask_;
+  size_type count_ = 0;
+  uint32_t head_ = kInvalidIndex;  // Most recently used.
+  uint32_t tail_ = kInvalidIndex;  // Least recently used.
+  std::unique_ptr<Slot[]> slots_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlatMRUCache);
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_MRU_CACHE_H_
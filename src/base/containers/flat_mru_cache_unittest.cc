@@ -0,0 +1,185 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_mru_cache.h"
+
+#include <stddef.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+int cached_item_live_count = 0;
+
+struct CachedItem {
+  CachedItem() : value(0) { cached_item_live_count++; }
+
+  explicit CachedItem(int new_value) : value(new_value) {
+    cached_item_live_count++;
+  }
+
+  CachedItem(const CachedItem& other) : value(other.value) {
+    cached_item_live_count++;
+  }
+
+  CachedItem(CachedItem&& other) : value(other.value) {
+    cached_item_live_count++;
+  }
+
+  ~CachedItem() { cached_item_live_count--; }
+
+  int value;
+};
+
+// Returns the keys of |cache| from most to least recently used.
+template <class Cache>
+std::vector<int> KeyOrder(const Cache& cache) {
+  std::vector<int> keys;
+  for (auto iter = cache.begin(); iter != cache.end(); ++iter)
+    keys.push_back(iter->first);
+  return keys;
+}
+
+// A hash that maps every key to one of two buckets, forcing long probe
+// chains and exercising slot relocation on erase.
+struct CollidingHash {
+  size_t operator()(const int& value) const { return value & 1; }
+};
+
+}  // namespace
+
+TEST(FlatMRUCacheTest, Basic) {
+  typedef base::FlatMRUCache<int, CachedItem> Cache;
+  Cache cache(10);
+
+  EXPECT_TRUE(cache.empty());
+  EXPECT_EQ(10u, cache.max_size());
+  EXPECT_TRUE(cache.Get(0) == cache.end());
+  EXPECT_TRUE(cache.Peek(0) == cache.end());
+
+  Cache::iterator inserted = cache.Put(5, CachedItem(10));
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(5, inserted->first);
+  EXPECT_EQ(10, inserted->second.value);
+
+  cache.Put(6, CachedItem(20));
+  EXPECT_EQ((std::vector<int>{6, 5}), KeyOrder(cache));
+
+  // Getting an item moves it to the front.
+  Cache::iterator found = cache.Get(5);
+  ASSERT_TRUE(found != cache.end());
+  EXPECT_EQ(10, found->second.value);
+  EXPECT_EQ((std::vector<int>{5, 6}), KeyOrder(cache));
+
+  // Peek does not affect the ordering.
+  found = cache.Peek(6);
+  ASSERT_TRUE(found != cache.end());
+  EXPECT_EQ((std::vector<int>{5, 6}), KeyOrder(cache));
+
+  // Replacing a key moves it to the front and keeps the size.
+  cache.Put(6, CachedItem(30));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ((std::vector<int>{6, 5}), KeyOrder(cache));
+  EXPECT_EQ(30, cache.Peek(6)->second.value);
+
+  cache.Clear();
+  EXPECT_TRUE(cache.empty());
+  EXPECT_EQ(0, cached_item_live_count);
+}
+
+TEST(FlatMRUCacheTest, EvictsLeastRecentlyUsed) {
+  typedef base::FlatMRUCache<int, CachedItem> Cache;
+  Cache cache(3);
+
+  for (int i = 0; i < 3; i++)
+    cache.Put(i, CachedItem(i));
+  EXPECT_EQ((std::vector<int>{2, 1, 0}), KeyOrder(cache));
+
+  // Touch 0 so 1 becomes the eviction candidate.
+  cache.Get(0);
+  cache.Put(3, CachedItem(3));
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ((std::vector<int>{3, 0, 2}), KeyOrder(cache));
+  EXPECT_TRUE(cache.Peek(1) == cache.end());
+}
+
+TEST(FlatMRUCacheTest, EraseReturnsNextOldest) {
+  typedef base::FlatMRUCache<int, CachedItem, CollidingHash> Cache;
+  Cache cache(8);
+
+  // All even keys collide with each other, as do all odd ones, so erasing
+  // in the middle of a probe chain relocates later entries.
+  for (int i = 0; i < 8; i++)
+    cache.Put(i, CachedItem(i * 10));
+
+  Cache::iterator iter = cache.Peek(4);
+  ASSERT_TRUE(iter != cache.end());
+  iter = cache.Erase(iter);
+  ASSERT_TRUE(iter != cache.end());
+  EXPECT_EQ(3, iter->first);  // The next older entry.
+  EXPECT_EQ(7u, cache.size());
+
+  // Every remaining entry is still reachable with the right value.
+  for (int i = 0; i < 8; i++) {
+    if (i == 4) {
+      EXPECT_TRUE(cache.Peek(i) == cache.end());
+      continue;
+    }
+    ASSERT_TRUE(cache.Peek(i) != cache.end());
+    EXPECT_EQ(i * 10, cache.Peek(i)->second.value);
+  }
+
+  // Erasing the oldest entry returns end().
+  iter = cache.Peek(0);
+  ASSERT_TRUE(iter != cache.end());
+  EXPECT_TRUE(cache.Erase(iter) == cache.end());
+  EXPECT_TRUE(cache.Peek(0) == cache.end());
+}
+
+TEST(FlatMRUCacheTest, ShrinkToSize) {
+  typedef base::FlatMRUCache<int, CachedItem> Cache;
+  Cache cache(10);
+
+  for (int i = 0; i < 6; i++)
+    cache.Put(i, CachedItem(i));
+  cache.ShrinkToSize(2);
+  EXPECT_EQ((std::vector<int>{5, 4}), KeyOrder(cache));
+
+  cache.ShrinkToSize(5);  // Growing is a no-op.
+  EXPECT_EQ(2u, cache.size());
+}
+
+TEST(FlatMRUCacheTest, DestructorDestroysValues) {
+  {
+    typedef base::FlatMRUCache<std::string, CachedItem> Cache;
+    Cache cache(4);
+    cache.Put("alpha", CachedItem(1));
+    cache.Put("beta", CachedItem(2));
+    EXPECT_EQ(2, cached_item_live_count);
+  }
+  EXPECT_EQ(0, cached_item_live_count);
+}
+
+TEST(FlatMRUCacheTest, Churn) {
+  // Many more insertions than capacity, with a colliding hash, to exercise
+  // wraparound, eviction and relocation together.
+  typedef base::FlatMRUCache<int, CachedItem, CollidingHash> Cache;
+  Cache cache(4);
+
+  for (int i = 0; i < 100; i++)
+    cache.Put(i, CachedItem(i));
+
+  EXPECT_EQ(4u, cache.size());
+  EXPECT_EQ((std::vector<int>{99, 98, 97, 96}), KeyOrder(cache));
+  for (int i = 96; i < 100; i++)
+    EXPECT_EQ(i, cache.Get(i)->second.value);
+}
+
+}  // namespace base
@@ -0,0 +1,165 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_MPSC_QUEUE_H_
+#define BASE_CONTAINERS_MPSC_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/macros.h"
+
+namespace base {
+
+// A bounded lock-free queue for handing values from one or more producer
+// threads to a single consumer thread.
+//
+// Any thread may call TryPush(). TryPop() and TryPopBatch() must only be
+// called from one thread at a time (a single-producer/single-consumer setup
+// is just the special case of one pushing thread). Pushes never block: when
+// the queue is full, TryPush() fails and the caller decides whether to drop,
+// retry or fall back to a locking path. Values pushed by one thread are
+// popped in push order; values from different threads are interleaved in an
+// unspecified but consistent order.
+//
+// The implementation is a ring of slots, each carrying a sequence counter
+// that tells producers and the consumer whether the slot is ready for them
+// (Dmitry Vyukov's bounded queue). The head and tail indices live on their
+// own cache lines so producers and the consumer do not contend on the same
+// line for every operation.
+//
+// The queue owns the values it holds: anything not popped is destroyed with
+// the queue. T must be movable; it does not need to be default-constructible.
+template <typename T>
+class MPSCQueue {
+ public:
+  // Creates a queue holding at least |capacity| elements. The actual
+  // capacity is rounded up to the next power of two.
+  explicit MPSCQueue(size_t capacity)
+      : mask_(RoundUpToPowerOfTwo(capacity) - 1),
+        slots_(new Slot[mask_ + 1]),
+        enqueue_pos_(0),
+        dequeue_pos_(0) {
+    DCHECK_GT(capacity, 0u);
+    for (size_t i = 0; i <= mask_; i++)
+      slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  ~MPSCQueue() {
+    // Destroy any values that were never popped. No other thread may touch
+    // the queue by now, so plain loads are enough.
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+      Slot* slot = &slots_[pos & mask_];
+      if (slot->sequence.load(std::memory_order_relaxed) != pos + 1)
+        break;
+      slot->value()->~T();
+      pos++;
+    }
+  }
+
+  // Adds |value| to the queue. Returns false, leaving |value| destroyed, if
+  // the queue is full. Callable from any thread.
+  bool TryPush(T value) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[pos & mask_];
+      size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      intptr_t difference =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (difference == 0) {
+        // The slot is free; race other producers to claim it.
+        if (enqueue_pos_.compare_exchange_weak(pos, pos + 1,
+                                               std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;  // Full: the consumer has not vacated this slot yet.
+      } else {
+        // Another producer claimed |pos|; reload and try the next slot.
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    new (slot->storage()) T(std::move(value));
+    // Publishes the value: the consumer may pop once it sees pos + 1.
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Removes the oldest value into |*value|. Returns false if the queue is
+  // empty. Must only be called from the consumer thread.
+  bool TryPop(T* value) { return TryPopInto(value); }
+
+  // Removes up to |max_count| values into |values| and returns how many were
+  // popped, amortizing the per-pop synchronization over a whole batch. Must
+  // only be called from the consumer thread.
+  size_t TryPopBatch(T* values, size_t max_count) {
+    size_t count = 0;
+    while (count < max_count && TryPopInto(&values[count]))
+      count++;
+    return count;
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  // In the fast path producers touch |enqueue_pos_| and the consumer
+  // |dequeue_pos_|; keep each index on its own cache line.
+  static const size_t kCacheLineSize = 64;
+
+  struct Slot {
+    void* storage() { return &storage_v; }
+    T* value() { return reinterpret_cast<T*>(&storage_v); }
+
+    std::atomic<size_t> sequence;
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage_v;
+  };
+
+  static size_t RoundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value)
+      result <<= 1;
+    return result;
+  }
+
+  bool TryPopInto(T* value) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Slot* slot = &slots_[pos & mask_];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    intptr_t difference =
+        static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+    if (difference < 0)
+      return false;  // Empty, or the producer that claimed |pos| is mid-push.
+    DCHECK_EQ(0, difference) << "multiple threads popping concurrently";
+    // Single consumer, so a plain store claims the slot; producers only look
+    // at it again after the sequence update below.
+    dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+    *value = std::move(*slot->value());
+    slot->value()->~T();
+    // Marks the slot free for the producer that wraps around to it.
+    slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  char pad0_[kCacheLineSize];
+  std::atomic<size_t> enqueue_pos_;
+  char pad1_[kCacheLineSize];
+  std::atomic<size_t> dequeue_pos_;
+
+  DISALLOW_COPY_AND_ASSIGN(MPSCQueue);
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_MPSC_QUEUE_H_
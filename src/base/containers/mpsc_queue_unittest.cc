@@ -0,0 +1,155 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/mpsc_queue.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <utility>
+
+#include "base/macros.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+TEST(MPSCQueueTest, PushPopOrder) {
+  MPSCQueue<int> queue(3);
+  EXPECT_EQ(4u, queue.capacity());  // Rounded up to a power of two.
+
+  for (int i = 0; i < 4; i++)
+    EXPECT_TRUE(queue.TryPush(i));
+  EXPECT_FALSE(queue.TryPush(4));  // Full.
+
+  int value = -1;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(queue.TryPop(&value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(queue.TryPop(&value));  // Empty.
+
+  // Push and pop across several wraparounds of the ring.
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(queue.TryPush(i));
+    EXPECT_TRUE(queue.TryPop(&value));
+    EXPECT_EQ(i, value);
+  }
+}
+
+TEST(MPSCQueueTest, PopBatch) {
+  MPSCQueue<int> queue(8);
+  for (int i = 0; i < 5; i++)
+    EXPECT_TRUE(queue.TryPush(i));
+
+  int values[8];
+  EXPECT_EQ(2u, queue.TryPopBatch(values, 2));
+  EXPECT_EQ(0, values[0]);
+  EXPECT_EQ(1, values[1]);
+
+  // A batch larger than the queue contents pops what is there.
+  EXPECT_EQ(3u, queue.TryPopBatch(values, 8));
+  EXPECT_EQ(2, values[0]);
+  EXPECT_EQ(4, values[2]);
+  EXPECT_EQ(0u, queue.TryPopBatch(values, 8));
+}
+
+TEST(MPSCQueueTest, MoveOnlyValues) {
+  MPSCQueue<std::unique_ptr<int>> queue(4);
+  EXPECT_TRUE(queue.TryPush(std::unique_ptr<int>(new int(5))));
+
+  std::unique_ptr<int> value;
+  EXPECT_TRUE(queue.TryPop(&value));
+  ASSERT_TRUE(value);
+  EXPECT_EQ(5, *value);
+}
+
+TEST(MPSCQueueTest, DestructorDestroysUnpoppedValues) {
+  int destroyed = 0;
+  struct Counter {
+    explicit Counter(int* destroyed) : destroyed(destroyed) {}
+    Counter(Counter&& other) : destroyed(other.destroyed) {
+      other.destroyed = nullptr;
+    }
+    Counter& operator=(Counter&& other) {
+      destroyed = other.destroyed;
+      other.destroyed = nullptr;
+      return *this;
+    }
+    ~Counter() {
+      if (destroyed)
+        (*destroyed)++;
+    }
+    int* destroyed;
+  };
+
+  {
+    MPSCQueue<Counter> queue(8);
+    for (int i = 0; i < 3; i++)
+      EXPECT_TRUE(queue.TryPush(Counter(&destroyed)));
+  }
+  EXPECT_EQ(3, destroyed);
+}
+
+class ProducerThread : public PlatformThread::Delegate {
+ public:
+  ProducerThread(MPSCQueue<uint64_t>* queue, uint64_t id, uint64_t count)
+      : queue_(queue), id_(id), count_(count) {}
+
+  void ThreadMain() override {
+    for (uint64_t i = 0; i < count_; i++) {
+      // The queue is intentionally smaller than the push count; spin until
+      // the consumer makes room.
+      while (!queue_->TryPush((id_ << 32) | i))
+        PlatformThread::YieldCurrentThread();
+    }
+  }
+
+ private:
+  MPSCQueue<uint64_t>* queue_;
+  const uint64_t id_;
+  const uint64_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProducerThread);
+};
+
+TEST(MPSCQueueTest, MultipleProducers) {
+  const uint64_t kProducers = 4;
+  const uint64_t kPerProducer = 10000;
+
+  MPSCQueue<uint64_t> queue(64);
+  ProducerThread* producers[kProducers];
+  PlatformThreadHandle handles[kProducers];
+  for (uint64_t i = 0; i < kProducers; i++) {
+    producers[i] = new ProducerThread(&queue, i, kPerProducer);
+    ASSERT_TRUE(PlatformThread::Create(0, producers[i], &handles[i]));
+  }
+
+  // Values from each producer must arrive in the order they were pushed.
+  uint64_t next_expected[kProducers] = {0};
+  uint64_t received = 0;
+  uint64_t values[16];
+  while (received < kProducers * kPerProducer) {
+    size_t popped = queue.TryPopBatch(values, arraysize(values));
+    for (size_t i = 0; i < popped; i++) {
+      uint64_t id = values[i] >> 32;
+      uint64_t sequence = values[i] & 0xffffffff;
+      ASSERT_LT(id, kProducers);
+      ASSERT_EQ(next_expected[id], sequence);
+      next_expected[id]++;
+    }
+    received += popped;
+  }
+
+  for (uint64_t i = 0; i < kProducers; i++) {
+    PlatformThread::Join(handles[i]);
+    delete producers[i];
+  }
+  EXPECT_FALSE(queue.TryPop(values));
+}
+
+}  // namespace
+}  // namespace base
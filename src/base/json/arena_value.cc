@@ -0,0 +1,194 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/arena_value.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+
+#include "base/logging.h"
+
+namespace base {
+
+namespace {
+
+// Usable space in the initial block; big enough for a typical NetLog
+// parameter tree without a second allocation.
+const size_t kDefaultBlockSize = 4096;
+
+// Every allocation is rounded up so the next one is aligned for any node.
+const size_t kAlignment = alignof(double) > alignof(void*) ? alignof(double)
+                                                           : alignof(void*);
+
+size_t AlignUp(size_t size) {
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+}  // namespace
+
+ValueArena::ValueArena()
+    : blocks_(nullptr), next_(nullptr), remaining_(0), bytes_used_(0) {
+  AddBlock(kDefaultBlockSize);
+}
+
+ValueArena::~ValueArena() {
+  while (blocks_) {
+    Block* next = blocks_->next;
+    free(blocks_);
+    blocks_ = next;
+  }
+}
+
+void* ValueArena::Allocate(size_t size) {
+  size = AlignUp(size);
+  if (size > remaining_)
+    AddBlock(size);
+  void* result = next_;
+  next_ += size;
+  remaining_ -= size;
+  bytes_used_ += size;
+  return result;
+}
+
+StringPiece ValueArena::CopyString(StringPiece str) {
+  if (str.empty())
+    return StringPiece();
+  char* copy = static_cast<char*>(Allocate(str.size()));
+  memcpy(copy, str.data(), str.size());
+  return StringPiece(copy, str.size());
+}
+
+void ValueArena::Reset() {
+  // Keep the newest block -- block sizes double, so it is also the largest --
+  // and free the rest. Steady-state reuse of an arena for similarly sized
+  // trees then settles on zero heap traffic.
+  Block* keep = blocks_;
+  Block* doomed = keep->next;
+  while (doomed) {
+    Block* next = doomed->next;
+    free(doomed);
+    doomed = next;
+  }
+  keep->next = nullptr;
+  next_ = reinterpret_cast<char*>(keep + 1);
+  remaining_ = keep->data_size;
+  bytes_used_ = 0;
+}
+
+void ValueArena::AddBlock(size_t min_size) {
+  // Double the block size as the tree grows so huge trees need O(log n)
+  // blocks, and always satisfy oversized single allocations.
+  size_t data_size = blocks_ ? blocks_->data_size * 2 : kDefaultBlockSize;
+  if (data_size < min_size)
+    data_size = AlignUp(min_size);
+  Block* block = static_cast<Block*>(malloc(sizeof(Block) + data_size));
+  CHECK(block);
+  block->next = blocks_;
+  block->data_size = data_size;
+  blocks_ = block;
+  next_ = reinterpret_cast<char*>(block + 1);
+  remaining_ = data_size;
+}
+
+ArenaValue::ArenaValue(Type type)
+    : type_(type),
+      in_parent_(false),
+      first_child_(nullptr),
+      last_child_(nullptr),
+      next_sibling_(nullptr) {}
+
+// static
+ArenaValue* ArenaValue::CreateNone(ValueArena* arena) {
+  return new (arena->Allocate(sizeof(ArenaValue))) ArenaValue(Type::NONE);
+}
+
+// static
+ArenaValue* ArenaValue::CreateBool(ValueArena* arena, bool value) {
+  ArenaValue* node =
+      new (arena->Allocate(sizeof(ArenaValue))) ArenaValue(Type::BOOLEAN);
+  node->bool_value_ = value;
+  return node;
+}
+
+// static
+ArenaValue* ArenaValue::CreateInt(ValueArena* arena, int value) {
+  ArenaValue* node =
+      new (arena->Allocate(sizeof(ArenaValue))) ArenaValue(Type::INTEGER);
+  node->int_value_ = value;
+  return node;
+}
+
+// static
+ArenaValue* ArenaValue::CreateDouble(ValueArena* arena, double value) {
+  ArenaValue* node =
+      new (arena->Allocate(sizeof(ArenaValue))) ArenaValue(Type::DOUBLE);
+  node->double_value_ = value;
+  return node;
+}
+
+// static
+ArenaValue* ArenaValue::CreateString(ValueArena* arena, StringPiece value) {
+  ArenaValue* node =
+      new (arena->Allocate(sizeof(ArenaValue))) ArenaValue(Type::STRING);
+  node->string_value_ = arena->CopyString(value);
+  return node;
+}
+
+// static
+ArenaValue* ArenaValue::CreateList(ValueArena* arena) {
+  return new (arena->Allocate(sizeof(ArenaValue))) ArenaValue(Type::LIST);
+}
+
+// static
+ArenaValue* ArenaValue::CreateDict(ValueArena* arena) {
+  return new (arena->Allocate(sizeof(ArenaValue)))
+      ArenaValue(Type::DICTIONARY);
+}
+
+bool ArenaValue::GetBool() const {
+  DCHECK(type_ == Type::BOOLEAN);
+  return bool_value_;
+}
+
+int ArenaValue::GetInt() const {
+  DCHECK(type_ == Type::INTEGER);
+  return int_value_;
+}
+
+double ArenaValue::GetDouble() const {
+  DCHECK(type_ == Type::DOUBLE);
+  return double_value_;
+}
+
+StringPiece ArenaValue::GetString() const {
+  DCHECK(type_ == Type::STRING);
+  return string_value_;
+}
+
+void ArenaValue::Append(ArenaValue* value) {
+  DCHECK(type_ == Type::LIST);
+  DCHECK(!value->in_parent_);
+  value->in_parent_ = true;
+  if (last_child_)
+    last_child_->next_sibling_ = value;
+  else
+    first_child_ = value;
+  last_child_ = value;
+}
+
+void ArenaValue::Set(ValueArena* arena, StringPiece key, ArenaValue* value) {
+  DCHECK(type_ == Type::DICTIONARY);
+  DCHECK(!value->in_parent_);
+  value->in_parent_ = true;
+  value->key_ = arena->CopyString(key);
+  if (last_child_)
+    last_child_->next_sibling_ = value;
+  else
+    first_child_ = value;
+  last_child_ = value;
+}
+
+}  // namespace base
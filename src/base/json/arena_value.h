@@ -0,0 +1,136 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_JSON_ARENA_VALUE_H_
+#define BASE_JSON_ARENA_VALUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+class ArenaValue;
+
+// Bump-allocates the storage behind ArenaValue trees. All allocations are
+// freed at once when the arena is destroyed or Reset(), so building and
+// discarding a large short-lived tree costs a handful of block allocations
+// instead of one heap operation per node. Not thread safe.
+class BASE_EXPORT ValueArena {
+ public:
+  ValueArena();
+  ~ValueArena();
+
+  // Returns |size| bytes suitably aligned for any ArenaValue allocation. The
+  // memory is zero-initialized only by chance; callers construct into it. It
+  // stays valid until the arena is destroyed or Reset().
+  void* Allocate(size_t size);
+
+  // Copies |str| into the arena and returns a piece pointing at the copy.
+  StringPiece CopyString(StringPiece str);
+
+  // Discards every allocation made so far but keeps the first block for
+  // reuse, invalidating all nodes and strings handed out by this arena.
+  void Reset();
+
+  // Total bytes handed out since construction or the last Reset().
+  size_t bytes_used() const { return bytes_used_; }
+
+ private:
+  // Header preceding each backing block; the usable space follows it.
+  struct Block {
+    Block* next;
+    size_t data_size;
+  };
+
+  // Makes |next_|/|remaining_| point at a fresh block with room for at least
+  // |min_size| bytes.
+  void AddBlock(size_t min_size);
+
+  Block* blocks_;      // Most recently allocated block first.
+  char* next_;         // Bump pointer into the current block.
+  size_t remaining_;   // Bytes left in the current block.
+  size_t bytes_used_;
+
+  DISALLOW_COPY_AND_ASSIGN(ValueArena);
+};
+
+// A JSON-style value whose nodes and strings live in a caller-owned
+// ValueArena, for call sites -- NetLog parameter callbacks, config parsing --
+// that build large trees only to serialize and discard them. Nodes are
+// trivially destructible: dropping the arena frees the whole tree without
+// walking it. Trees are append-only; lists and dictionaries keep insertion
+// order through intrusive sibling links, and dictionaries do not check for
+// duplicate keys. Use JSONWriter to serialize a tree.
+class BASE_EXPORT ArenaValue {
+ public:
+  enum class Type : uint8_t {
+    NONE,
+    BOOLEAN,
+    INTEGER,
+    DOUBLE,
+    STRING,
+    LIST,
+    DICTIONARY,
+  };
+
+  // All nodes are created in |arena| and share its lifetime. CreateString()
+  // copies |value| into the arena, so the caller's buffer may go away.
+  static ArenaValue* CreateNone(ValueArena* arena);
+  static ArenaValue* CreateBool(ValueArena* arena, bool value);
+  static ArenaValue* CreateInt(ValueArena* arena, int value);
+  static ArenaValue* CreateDouble(ValueArena* arena, double value);
+  static ArenaValue* CreateString(ValueArena* arena, StringPiece value);
+  static ArenaValue* CreateList(ValueArena* arena);
+  static ArenaValue* CreateDict(ValueArena* arena);
+
+  Type type() const { return type_; }
+
+  // Typed accessors. It is an error to call one on a node of another type.
+  bool GetBool() const;
+  int GetInt() const;
+  double GetDouble() const;
+  StringPiece GetString() const;
+
+  // Appends |value| to this list. |value| must come from the same arena and
+  // must not already have a parent.
+  void Append(ArenaValue* value);
+
+  // Adds |value| to this dictionary under |key|, which is copied into
+  // |arena|. |value| must come from the same arena and must not already have
+  // a parent.
+  void Set(ValueArena* arena, StringPiece key, ArenaValue* value);
+
+  // Child iteration for lists and dictionaries, in insertion order.
+  const ArenaValue* first_child() const { return first_child_; }
+  const ArenaValue* next_sibling() const { return next_sibling_; }
+
+  // The key this node was Set() under; empty for list elements and roots.
+  StringPiece key() const { return key_; }
+
+ private:
+  explicit ArenaValue(Type type);
+
+  Type type_;
+  bool in_parent_;  // True once appended to a list or dictionary.
+  union {
+    bool bool_value_;
+    int int_value_;
+    double double_value_;
+  };
+  StringPiece string_value_;
+  StringPiece key_;
+  ArenaValue* first_child_;
+  ArenaValue* last_child_;
+  ArenaValue* next_sibling_;
+
+  DISALLOW_COPY_AND_ASSIGN(ArenaValue);
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_ARENA_VALUE_H_
@@ -0,0 +1,105 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/arena_value.h"
+
+#include <stddef.h>
+
+#include <string>
+
+#include "base/json/json_writer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(ArenaValueTest, BasicTypes) {
+  ValueArena arena;
+
+  EXPECT_EQ(ArenaValue::Type::NONE, ArenaValue::CreateNone(&arena)->type());
+  EXPECT_TRUE(ArenaValue::CreateBool(&arena, true)->GetBool());
+  EXPECT_FALSE(ArenaValue::CreateBool(&arena, false)->GetBool());
+  EXPECT_EQ(42, ArenaValue::CreateInt(&arena, 42)->GetInt());
+  EXPECT_EQ(3.25, ArenaValue::CreateDouble(&arena, 3.25)->GetDouble());
+
+  // Strings are copied into the arena, so the source may be destroyed.
+  ArenaValue* string_node;
+  {
+    std::string source("copied");
+    string_node = ArenaValue::CreateString(&arena, source);
+  }
+  EXPECT_EQ("copied", string_node->GetString());
+}
+
+TEST(ArenaValueTest, BuildAndWrite) {
+  ValueArena arena;
+
+  ArenaValue* root = ArenaValue::CreateDict(&arena);
+  root->Set(&arena, "bool", ArenaValue::CreateBool(&arena, true));
+  root->Set(&arena, "int", ArenaValue::CreateInt(&arena, 7));
+
+  ArenaValue* list = ArenaValue::CreateList(&arena);
+  list->Append(ArenaValue::CreateString(&arena, "a"));
+  list->Append(ArenaValue::CreateNone(&arena));
+  list->Append(ArenaValue::CreateDouble(&arena, 1.5));
+  root->Set(&arena, "list", list);
+
+  std::string json;
+  EXPECT_TRUE(JSONWriter::Write(*root, &json));
+  EXPECT_EQ("{\"bool\":true,\"int\":7,\"list\":[\"a\",null,1.5]}", json);
+}
+
+TEST(ArenaValueTest, EmptyContainers) {
+  ValueArena arena;
+
+  std::string json;
+  EXPECT_TRUE(JSONWriter::Write(*ArenaValue::CreateList(&arena), &json));
+  EXPECT_EQ("[]", json);
+  EXPECT_TRUE(JSONWriter::Write(*ArenaValue::CreateDict(&arena), &json));
+  EXPECT_EQ("{}", json);
+}
+
+TEST(ArenaValueTest, LargeTreeAndReset) {
+  ValueArena arena;
+
+  // Much larger than the initial block, forcing several block allocations.
+  const int kNodes = 10000;
+  ArenaValue* list = ArenaValue::CreateList(&arena);
+  for (int i = 0; i < kNodes; ++i)
+    list->Append(ArenaValue::CreateInt(&arena, i));
+
+  int i = 0;
+  for (const ArenaValue* value = list->first_child(); value;
+       value = value->next_sibling()) {
+    ASSERT_EQ(i++, value->GetInt());
+  }
+  EXPECT_EQ(kNodes, i);
+
+  // After Reset() the arena is reusable and starts from scratch.
+  size_t used_before = arena.bytes_used();
+  arena.Reset();
+  EXPECT_EQ(0u, arena.bytes_used());
+
+  ArenaValue* reused = ArenaValue::CreateList(&arena);
+  for (int j = 0; j < kNodes; ++j)
+    reused->Append(ArenaValue::CreateInt(&arena, j));
+  EXPECT_EQ(used_before, arena.bytes_used());
+}
+
+TEST(ArenaValueTest, PrettyPrintMatchesValue) {
+  ValueArena arena;
+
+  ArenaValue* root = ArenaValue::CreateDict(&arena);
+  root->Set(&arena, "key", ArenaValue::CreateString(&arena, "value"));
+
+  std::string json;
+  EXPECT_TRUE(JSONWriter::WriteWithOptions(
+      *root, JSONWriter::OPTIONS_PRETTY_PRINT, &json));
+#if defined(OS_WIN)
+  EXPECT_EQ("{\r\n   \"key\": \"value\"\r\n}\r\n", json);
+#else
+  EXPECT_EQ("{\n   \"key\": \"value\"\n}\n", json);
+#endif
+}
+
+}  // namespace base
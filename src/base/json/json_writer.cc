@@ -9,6 +9,7 @@
 #include <cmath>
 #include <limits>
 
+#include "base/json/arena_value.h"
 #include "base/json/string_escape.h"
 #include "base/logging.h"
 #include "base/strings/string_number_conversions.h"
@@ -46,6 +47,27 @@ bool JSONWriter::WriteWithOptions(const Value& node,
   return result;
 }
 
+// static
+bool JSONWriter::Write(const ArenaValue& node, std::string* json) {
+  return WriteWithOptions(node, 0, json);
+}
+
+// static
+bool JSONWriter::WriteWithOptions(const ArenaValue& node,
+                                  int options,
+                                  std::string* json) {
+  json->clear();
+  json->reserve(1024);
+
+  JSONWriter writer(options, json);
+  bool result = writer.BuildJSONString(node, 0U);
+
+  if (options & OPTIONS_PRETTY_PRINT)
+    json->append(kPrettyPrintLineEnding);
+
+  return result;
+}
+
 JSONWriter::JSONWriter(int options, std::string* json)
     : omit_binary_values_((options & OPTIONS_OMIT_BINARY_VALUES) != 0),
       omit_double_type_preservation_(
@@ -82,31 +104,7 @@ bool JSONWriter::BuildJSONString(const Value& node, size_t depth) {
       double value;
       bool result = node.GetAsDouble(&value);
       DCHECK(result);
-      if (omit_double_type_preservation_ &&
-          value <= std::numeric_limits<int64_t>::max() &&
-          value >= std::numeric_limits<int64_t>::min() &&
-          std::floor(value) == value) {
-        json_string_->append(Int64ToString(static_cast<int64_t>(value)));
-        return result;
-      }
-      std::string real = DoubleToString(value);
-      // Ensure that the number has a .0 if there's no decimal or 'e'.  This
-      // makes sure that when we read the JSON back, it's interpreted as a
-      // real rather than an int.
-      if (real.find('.') == std::string::npos &&
-          real.find('e') == std::string::npos &&
-          real.find('E') == std::string::npos) {
-        real.append(".0");
-      }
-      // The JSON spec requires that non-integer values in the range (-1,1)
-      // have a zero before the decimal point - ".52" is not valid, "0.52" is.
-      if (real[0] == '.') {
-        real.insert(static_cast<size_t>(0), static_cast<size_t>(1), '0');
-      } else if (real.length() > 1 && real[0] == '-' && real[1] == '.') {
-        // "-.1" bad "-0.1" good
-        real.insert(static_cast<size_t>(1), static_cast<size_t>(1), '0');
-      }
-      json_string_->append(real);
+      AppendDouble(value);
       return result;
     }
 
@@ -203,6 +201,124 @@ bool JSONWriter::BuildJSONString(const Value& node, size_t depth) {
   return false;
 }
 
+bool JSONWriter::BuildJSONString(const ArenaValue& node, size_t depth) {
+  switch (node.type()) {
+    case ArenaValue::Type::NONE: {
+      json_string_->append("null");
+      return true;
+    }
+
+    case ArenaValue::Type::BOOLEAN: {
+      json_string_->append(node.GetBool() ? "true" : "false");
+      return true;
+    }
+
+    case ArenaValue::Type::INTEGER: {
+      json_string_->append(IntToString(node.GetInt()));
+      return true;
+    }
+
+    case ArenaValue::Type::DOUBLE: {
+      AppendDouble(node.GetDouble());
+      return true;
+    }
+
+    case ArenaValue::Type::STRING: {
+      EscapeJSONString(node.GetString(), true, json_string_);
+      return true;
+    }
+
+    case ArenaValue::Type::LIST: {
+      json_string_->push_back('[');
+      if (pretty_print_)
+        json_string_->push_back(' ');
+
+      bool result = true;
+      for (const ArenaValue* value = node.first_child(); value;
+           value = value->next_sibling()) {
+        if (value != node.first_child()) {
+          json_string_->push_back(',');
+          if (pretty_print_)
+            json_string_->push_back(' ');
+        }
+
+        if (!BuildJSONString(*value, depth))
+          result = false;
+      }
+
+      if (pretty_print_)
+        json_string_->push_back(' ');
+      json_string_->push_back(']');
+      return result;
+    }
+
+    case ArenaValue::Type::DICTIONARY: {
+      json_string_->push_back('{');
+      if (pretty_print_)
+        json_string_->append(kPrettyPrintLineEnding);
+
+      bool result = true;
+      for (const ArenaValue* value = node.first_child(); value;
+           value = value->next_sibling()) {
+        if (value != node.first_child()) {
+          json_string_->push_back(',');
+          if (pretty_print_)
+            json_string_->append(kPrettyPrintLineEnding);
+        }
+
+        if (pretty_print_)
+          IndentLine(depth + 1U);
+
+        EscapeJSONString(value->key(), true, json_string_);
+        json_string_->push_back(':');
+        if (pretty_print_)
+          json_string_->push_back(' ');
+
+        if (!BuildJSONString(*value, depth + 1U))
+          result = false;
+      }
+
+      if (pretty_print_) {
+        json_string_->append(kPrettyPrintLineEnding);
+        IndentLine(depth);
+      }
+
+      json_string_->push_back('}');
+      return result;
+    }
+  }
+  NOTREACHED();
+  return false;
+}
+
+void JSONWriter::AppendDouble(double value) {
+  if (omit_double_type_preservation_ &&
+      value <= std::numeric_limits<int64_t>::max() &&
+      value >= std::numeric_limits<int64_t>::min() &&
+      std::floor(value) == value) {
+    json_string_->append(Int64ToString(static_cast<int64_t>(value)));
+    return;
+  }
+  std::string real = DoubleToString(value);
+  // Ensure that the number has a .0 if there's no decimal or 'e'.  This
+  // makes sure that when we read the JSON back, it's interpreted as a
+  // real rather than an int.
+  if (real.find('.') == std::string::npos &&
+      real.find('e') == std::string::npos &&
+      real.find('E') == std::string::npos) {
+    real.append(".0");
+  }
+  // The JSON spec requires that non-integer values in the range (-1,1)
+  // have a zero before the decimal point - ".52" is not valid, "0.52" is.
+  if (real[0] == '.') {
+    real.insert(static_cast<size_t>(0), static_cast<size_t>(1), '0');
+  } else if (real.length() > 1 && real[0] == '-' && real[1] == '.') {
+    // "-.1" bad "-0.1" good
+    real.insert(static_cast<size_t>(1), static_cast<size_t>(1), '0');
+  }
+  json_string_->append(real);
+}
+
 void JSONWriter::IndentLine(size_t depth) {
   json_string_->append(depth * 3U, ' ');
 }
@@ -14,6 +14,7 @@
 
 namespace base {
 
+class ArenaValue;
 class Value;
 
 class BASE_EXPORT JSONWriter {
@@ -50,12 +51,23 @@ class BASE_EXPORT JSONWriter {
                                int options,
                                std::string* json);
 
+  // As above, for an arena-backed tree. ArenaValue has no binary type, so
+  // these always succeed.
+  static bool Write(const ArenaValue& node, std::string* json);
+  static bool WriteWithOptions(const ArenaValue& node,
+                               int options,
+                               std::string* json);
+
  private:
   JSONWriter(int options, std::string* json);
 
   // Called recursively to build the JSON string. When completed,
   // |json_string_| will contain the JSON.
   bool BuildJSONString(const Value& node, size_t depth);
+  bool BuildJSONString(const ArenaValue& node, size_t depth);
+
+  // Appends the JSON for a double. Shared by both value types.
+  void AppendDouble(double value);
 
   // Adds space to json_string_ for the indent level.
   void IndentLine(size_t depth);
@@ -4,6 +4,8 @@
 
 #include "base/message_loop/message_loop.h"
 
+#include <string.h>
+
 #include <algorithm>
 #include <utility>
 
@@ -67,8 +69,26 @@ std::unique_ptr<MessagePump> ReturnPump(std::unique_ptr<MessagePump> pump) {
   return pump;
 }
 
+// Records |value| into a power-of-two bucketed histogram: bucket 0 holds
+// zeroes (and negative clock skew), bucket i holds [2^(i-1), 2^i), and the
+// last bucket absorbs everything larger.
+void RecordToWorkBatchHistogram(
+    uint64_t (&buckets)[MessageLoopWorkBatchStats::kNumBuckets],
+    int64_t value) {
+  int bucket = 0;
+  while (value > 0 && bucket < MessageLoopWorkBatchStats::kNumBuckets - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  ++buckets[bucket];
+}
+
 }  // namespace
 
+MessageLoopWorkBatchStats::MessageLoopWorkBatchStats() {
+  memset(this, 0, sizeof(*this));
+}
+
 //------------------------------------------------------------------------------
 
 MessageLoop::TaskObserver::TaskObserver() {
@@ -287,6 +307,9 @@ MessageLoop::MessageLoop(Type type, MessagePumpFactoryCallback pump_factory)
       in_high_res_mode_(false),
 #endif
       nestable_tasks_allowed_(true),
+      work_batch_size_(1),
+      work_batch_stats_(nullptr),
+      quit_requested_(false),
       pump_factory_(std::move(pump_factory)),
       current_pending_task_(nullptr),
       incoming_task_queue_(new internal::IncomingTaskQueue(this)),
@@ -352,9 +375,18 @@ void MessageLoop::Run() {
 
 void MessageLoop::Quit() {
   DCHECK_EQ(this, current());
+  quit_requested_ = true;
   pump_->Quit();
 }
 
+void MessageLoop::SetWorkBatchSize(int work_batch_size,
+                                   TimeDelta work_batch_duration) {
+  DCHECK_EQ(this, current());
+  DCHECK_GE(work_batch_size, 1);
+  work_batch_size_ = work_batch_size;
+  work_batch_duration_ = work_batch_duration;
+}
+
 void MessageLoop::EnsureWorkScheduled() {
   DCHECK_EQ(this, current());
   ReloadWorkQueue();
@@ -503,11 +535,24 @@ bool MessageLoop::DoWork() {
     return false;
   }
 
+  quit_requested_ = false;
+  const bool bounded_batch =
+      work_batch_size_ > 1 && !work_batch_duration_.is_zero();
+  TimeTicks batch_start;
+  if (work_batch_stats_ || bounded_batch)
+    batch_start = TimeTicks::Now();
+  int ran_tasks = 0;
+
   for (;;) {
     ReloadWorkQueue();
     if (work_queue_.empty())
       break;
 
+    if (work_batch_stats_ && ran_tasks == 0) {
+      RecordToWorkBatchHistogram(work_batch_stats_->queue_depth,
+                                 work_queue_.size());
+    }
+
     // Execute oldest task.
     do {
       PendingTask pending_task = std::move(work_queue_.front());
@@ -525,16 +570,45 @@ bool MessageLoop::DoWork() {
         if (delayed_work_queue_.top().sequence_num == sequence_num)
           pump_->ScheduleDelayedWork(delayed_run_time);
       } else {
-        if (DeferOrRunPendingTask(std::move(pending_task)))
-          return true;
+        if (work_batch_stats_ && !pending_task.time_posted.is_null()) {
+          RecordToWorkBatchHistogram(
+              work_batch_stats_->task_queue_time_us,
+              (TimeTicks::Now() - pending_task.time_posted).InMicroseconds());
+        }
+        if (DeferOrRunPendingTask(std::move(pending_task))) {
+          // A task ran; see whether the batch budget allows running another
+          // one before handing control back to the pump so that it can
+          // service timers and native work.
+          ++ran_tasks;
+          if (ran_tasks >= work_batch_size_ || quit_requested_ ||
+              (bounded_batch &&
+               TimeTicks::Now() - batch_start >= work_batch_duration_)) {
+            return FinishWorkBatch(ran_tasks, batch_start);
+          }
+        }
       }
     } while (!work_queue_.empty());
   }
 
+  if (ran_tasks > 0)
+    return FinishWorkBatch(ran_tasks, batch_start);
+
   // Nothing happened.
   return false;
 }
 
+bool MessageLoop::FinishWorkBatch(int ran_tasks, TimeTicks batch_start) {
+  DCHECK_GT(ran_tasks, 0);
+  if (work_batch_stats_) {
+    ++work_batch_stats_->num_batches;
+    RecordToWorkBatchHistogram(work_batch_stats_->batch_tasks, ran_tasks);
+    RecordToWorkBatchHistogram(
+        work_batch_stats_->batch_duration_us,
+        (TimeTicks::Now() - batch_start).InMicroseconds());
+  }
+  return true;
+}
+
 bool MessageLoop::DoDelayedWork(TimeTicks* next_delayed_work_time) {
   if (!NestableTasksAllowed() ||
       !SweepDelayedWorkQueueAndReturnTrueIfStillHasWork()) {
@@ -692,6 +692,37 @@ TEST_P(MessageLoopTypedTest, PostTask) {
   EXPECT_EQ(foo->result(), "abacad");
 }
 
+namespace {
+
+void IncrementThenMaybeQuit(int* counter, int target) {
+  if (++(*counter) == target)
+    RunLoop::QuitCurrentWhenIdleDeprecated();
+}
+
+}  // namespace
+
+TEST_P(MessageLoopTypedTest, WorkBatch) {
+  MessageLoop loop(GetParam());
+  MessageLoopWorkBatchStats stats;
+  loop.SetWorkBatchSize(4, TimeDelta::FromMilliseconds(50));
+  loop.set_work_batch_stats(&stats);
+
+  const int kNumTasks = 10;
+  int counter = 0;
+  for (int i = 0; i < kNumTasks; ++i) {
+    ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, BindOnce(&IncrementThenMaybeQuit, &counter, kNumTasks));
+  }
+  RunLoop().Run();
+
+  // All tasks ran, in fewer pump iterations than tasks.
+  EXPECT_EQ(kNumTasks, counter);
+  EXPECT_GT(stats.num_batches, 0u);
+  EXPECT_LT(stats.num_batches, static_cast<uint64_t>(kNumTasks));
+
+  loop.set_work_batch_stats(nullptr);
+}
+
 TEST_P(MessageLoopTypedTest, PostDelayedTask_Basic) {
   MessageLoop loop(GetParam());
 
@@ -16,10 +16,12 @@
 #include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/compiler_specific.h"
 #include "base/debug/alias.h"
 #include "base/debug/crash_logging.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/metrics/histogram_macros.h"
@@ -32,6 +34,7 @@
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
 #include "base/values.h"
 #include "build/build_config.h"
 
@@ -96,6 +99,158 @@ bool ValidateRangeChecksum(const HistogramBase& histogram,
 typedef HistogramBase::Count Count;
 typedef HistogramBase::Sample Sample;
 
+namespace {
+
+struct SampleBufferRegistry {
+  Lock lock;
+  std::vector<ThreadHistogramSampleBuffer*> buffers;
+};
+
+LazyInstance<SampleBufferRegistry>::Leaky g_sample_buffer_registry =
+    LAZY_INSTANCE_INITIALIZER;
+ThreadLocalStorage::StaticSlot g_sample_buffer_tls = TLS_INITIALIZER;
+LazyInstance<Lock>::Leaky g_sample_buffer_tls_init_lock =
+    LAZY_INSTANCE_INITIALIZER;
+
+}  // namespace
+
+// Parks histogram samples on the thread that recorded them, so that the hot
+// Histogram::Add() path updates a thread-local buffer instead of doing an
+// atomic read-modify-write on bucket counters that bounce between cores when
+// the same histogram is recorded from several threads. Parked samples are
+// folded into their histogram when the thread's buffer fills up, when the
+// histogram is snapshotted or destroyed, and when the thread exits, so
+// snapshots always observe every sample recorded before them.
+class ThreadHistogramSampleBuffer {
+ public:
+  // Parks one sample recorded for |histogram| on the calling thread.
+  static void Park(Histogram* histogram, Sample value, Count count) {
+    // Samples spilled from a full buffer; folded in below, outside the lock,
+    // since Accumulate() may itself record histograms on rare error paths.
+    PendingSample overflow[kBufferSize];
+    size_t num_overflow = 0;
+
+    ThreadHistogramSampleBuffer* buffer = Get();
+    {
+      AutoLock auto_lock(buffer->lock_);
+      for (size_t i = 0; i < buffer->num_samples_; ++i) {
+        PendingSample& sample = buffer->samples_[i];
+        if (sample.histogram == histogram && sample.value == value) {
+          sample.count += count;
+          return;
+        }
+      }
+      if (buffer->num_samples_ == kBufferSize) {
+        memcpy(overflow, buffer->samples_, sizeof(buffer->samples_));
+        num_overflow = buffer->num_samples_;
+        buffer->num_samples_ = 0;
+      }
+      PendingSample& sample = buffer->samples_[buffer->num_samples_++];
+      sample.histogram = histogram;
+      sample.value = value;
+      sample.count = count;
+    }
+
+    for (size_t i = 0; i < num_overflow; ++i)
+      AccumulateDirectly(overflow[i]);
+  }
+
+  // Folds every sample parked for |histogram|, on any thread, into it.
+  static void FlushPendingSamplesFor(const Histogram* histogram) {
+    std::vector<PendingSample> pending;
+    TakePendingSamplesFor(histogram, &pending);
+    for (const PendingSample& sample : pending)
+      AccumulateDirectly(sample);
+  }
+
+  // Drops every sample parked for |histogram|. Called when it is being
+  // destroyed.
+  static void DiscardPendingSamplesFor(const Histogram* histogram) {
+    std::vector<PendingSample> pending;
+    TakePendingSamplesFor(histogram, &pending);
+  }
+
+ private:
+  struct PendingSample {
+    Histogram* histogram;
+    Sample value;
+    Count count;
+  };
+
+  // Maximum number of distinct (histogram, value) pairs parked per thread.
+  static constexpr size_t kBufferSize = 64;
+
+  ThreadHistogramSampleBuffer() = default;
+  ~ThreadHistogramSampleBuffer() = default;
+
+  // Returns the buffer of the calling thread, creating and registering it on
+  // first use.
+  static ThreadHistogramSampleBuffer* Get() {
+    if (!g_sample_buffer_tls.initialized()) {
+      AutoLock auto_lock(g_sample_buffer_tls_init_lock.Get());
+      if (!g_sample_buffer_tls.initialized())
+        g_sample_buffer_tls.Initialize(&DestroyOnThreadExit);
+    }
+    ThreadHistogramSampleBuffer* buffer =
+        static_cast<ThreadHistogramSampleBuffer*>(g_sample_buffer_tls.Get());
+    if (!buffer) {
+      buffer = new ThreadHistogramSampleBuffer();
+      g_sample_buffer_tls.Set(buffer);
+      SampleBufferRegistry* registry = g_sample_buffer_registry.Pointer();
+      AutoLock auto_lock(registry->lock);
+      registry->buffers.push_back(buffer);
+    }
+    return buffer;
+  }
+
+  static void DestroyOnThreadExit(void* value) {
+    ThreadHistogramSampleBuffer* buffer =
+        static_cast<ThreadHistogramSampleBuffer*>(value);
+    {
+      SampleBufferRegistry* registry = g_sample_buffer_registry.Pointer();
+      AutoLock auto_lock(registry->lock);
+      auto it = std::find(registry->buffers.begin(), registry->buffers.end(),
+                          buffer);
+      DCHECK(it != registry->buffers.end());
+      registry->buffers.erase(it);
+    }
+    // No other thread can reach |buffer| anymore; fold its samples in.
+    for (size_t i = 0; i < buffer->num_samples_; ++i)
+      AccumulateDirectly(buffer->samples_[i]);
+    delete buffer;
+  }
+
+  static void AccumulateDirectly(const PendingSample& sample) {
+    sample.histogram->unlogged_samples_->Accumulate(sample.value, sample.count);
+  }
+
+  // Moves the samples parked for |histogram| on any thread into |pending|.
+  // Accumulation happens in the callers, outside all buffer locks.
+  static void TakePendingSamplesFor(const Histogram* histogram,
+                                    std::vector<PendingSample>* pending) {
+    SampleBufferRegistry* registry = g_sample_buffer_registry.Pointer();
+    AutoLock registry_lock(registry->lock);
+    for (ThreadHistogramSampleBuffer* buffer : registry->buffers) {
+      AutoLock auto_lock(buffer->lock_);
+      size_t i = 0;
+      while (i < buffer->num_samples_) {
+        if (buffer->samples_[i].histogram != histogram) {
+          ++i;
+          continue;
+        }
+        pending->push_back(buffer->samples_[i]);
+        buffer->samples_[i] = buffer->samples_[--buffer->num_samples_];
+      }
+    }
+  }
+
+  Lock lock_;
+  PendingSample samples_[kBufferSize];
+  size_t num_samples_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ThreadHistogramSampleBuffer);
+};
+
 // static
 const uint32_t Histogram::kBucketCount_MAX = 16384u;
 
@@ -483,7 +638,7 @@ void Histogram::AddCount(int value, int count) {
     NOTREACHED();
     return;
   }
-  unlogged_samples_->Accumulate(value, count);
+  ThreadHistogramSampleBuffer::Park(this, value, count);
 
   FindAndRunCallback(value);
 }
@@ -633,6 +788,7 @@ Histogram::Histogram(const std::string& name,
 }
 
 Histogram::~Histogram() {
+  ThreadHistogramSampleBuffer::DiscardPendingSamplesFor(this);
 }
 
 bool Histogram::PrintEmptyBucket(uint32_t index) const {
@@ -694,6 +850,10 @@ std::unique_ptr<SampleVector> Histogram::SnapshotAllSamples() const {
 }
 
 std::unique_ptr<SampleVector> Histogram::SnapshotUnloggedSamples() const {
+  // Fold in samples still parked in per-thread buffers, so the snapshot
+  // reflects everything recorded before it was taken.
+  ThreadHistogramSampleBuffer::FlushPendingSamplesFor(this);
+
   // TODO(bcwhite): Remove these CHECKs once crbug/734049 is resolved.
   HistogramSamples* unlogged = unlogged_samples_.get();
   CHECK(unlogged_samples_);
@@ -93,6 +93,7 @@ class Pickle;
 class PickleIterator;
 class SampleVector;
 class SampleVectorBase;
+class ThreadHistogramSampleBuffer;
 
 class BASE_EXPORT Histogram : public HistogramBase {
  public:
@@ -269,6 +270,9 @@ class BASE_EXPORT Histogram : public HistogramBase {
   friend class StatisticsRecorder;  // To allow it to delete duplicates.
   friend class StatisticsRecorderTest;
 
+  // Parks samples per thread and folds them into |unlogged_samples_|.
+  friend class ThreadHistogramSampleBuffer;
+
   friend BASE_EXPORT HistogramBase* DeserializeHistogramInfo(
       base::PickleIterator* iter);
   static HistogramBase* DeserializeInfoImpl(base::PickleIterator* iter);
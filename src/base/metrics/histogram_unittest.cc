@@ -22,7 +22,9 @@
 #include "base/metrics/statistics_recorder.h"
 #include "base/pickle.h"
 #include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/test/gtest_util.h"
+#include "base/threading/platform_thread.h"
 #include "base/time/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -177,6 +179,59 @@ TEST_P(HistogramTest, DeltaTest) {
   EXPECT_EQ(0, samples->TotalCount());
 }
 
+namespace {
+
+// Records a couple of samples, then stays alive until told to exit so that
+// its per-thread sample buffer is not flushed by thread teardown.
+class RecordSamplesThread : public PlatformThread::Delegate {
+ public:
+  RecordSamplesThread(HistogramBase* histogram,
+                      WaitableEvent* samples_recorded,
+                      WaitableEvent* quit)
+      : histogram_(histogram),
+        samples_recorded_(samples_recorded),
+        quit_(quit) {}
+
+  void ThreadMain() override {
+    histogram_->Add(20);
+    histogram_->Add(20);
+    samples_recorded_->Signal();
+    quit_->Wait();
+  }
+
+ private:
+  HistogramBase* const histogram_;
+  WaitableEvent* const samples_recorded_;
+  WaitableEvent* const quit_;
+
+  DISALLOW_COPY_AND_ASSIGN(RecordSamplesThread);
+};
+
+}  // namespace
+
+// Samples recorded on another thread must show up in a snapshot taken while
+// that thread is still running, even though samples are buffered per thread.
+TEST_P(HistogramTest, CrossThreadSnapshotTest) {
+  HistogramBase* histogram = Histogram::FactoryGet("CrossThreadHistogram", 1,
+                                                   64, 8, HistogramBase::kNoFlags);
+
+  WaitableEvent samples_recorded(WaitableEvent::ResetPolicy::MANUAL,
+                                 WaitableEvent::InitialState::NOT_SIGNALED);
+  WaitableEvent quit(WaitableEvent::ResetPolicy::MANUAL,
+                     WaitableEvent::InitialState::NOT_SIGNALED);
+  RecordSamplesThread recorder(histogram, &samples_recorded, &quit);
+  PlatformThreadHandle handle;
+  ASSERT_TRUE(PlatformThread::Create(0, &recorder, &handle));
+  samples_recorded.Wait();
+
+  std::unique_ptr<HistogramSamples> samples = histogram->SnapshotSamples();
+  EXPECT_EQ(2, samples->TotalCount());
+  EXPECT_EQ(2, samples->GetCount(20));
+
+  quit.Signal();
+  PlatformThread::Join(handle);
+}
+
 // Check that final-delta calculations work correctly.
 TEST_P(HistogramTest, FinalDeltaTest) {
   HistogramBase* histogram =
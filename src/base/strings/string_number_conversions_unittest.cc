@@ -847,6 +847,21 @@ TEST(StringNumberConversionsTest, HexEncode) {
   unsigned char bytes[] = {0x01, 0xff, 0x02, 0xfe, 0x03, 0x80, 0x81};
   hex = HexEncode(bytes, sizeof(bytes));
   EXPECT_EQ(hex.compare("01FF02FE038081"), 0);
+
+  // Exercise the vectorized path, which only engages on inputs of 16 bytes
+  // or more, at every alignment of its 16-byte blocks.
+  static const char kHexChars[] = "0123456789ABCDEF";
+  unsigned char long_bytes[100];
+  std::string expected;
+  for (size_t i = 0; i < arraysize(long_bytes); ++i) {
+    long_bytes[i] = static_cast<unsigned char>(i * 7 + 1);
+    expected.push_back(kHexChars[long_bytes[i] >> 4]);
+    expected.push_back(kHexChars[long_bytes[i] & 0xf]);
+  }
+  for (size_t len = 0; len <= arraysize(long_bytes); ++len) {
+    EXPECT_EQ(expected.substr(0, len * 2), HexEncode(long_bytes, len))
+        << "length " << len;
+  }
 }
 
 // Test cases of known-bad strtod conversions that motivated the use of dmg_fp.
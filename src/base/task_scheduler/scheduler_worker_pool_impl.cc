@@ -7,6 +7,7 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <deque>
 #include <utility>
 
 #include "base/atomicops.h"
@@ -33,6 +34,14 @@ namespace internal {
 namespace {
 
 constexpr char kPoolNameSuffix[] = "Pool";
+
+// Maximum number of Sequences that a worker moves from the shared priority
+// queue to its local work deque in a single Transaction. Grabbing a few
+// Sequences at once amortizes contention on the shared queue's lock when many
+// one-off tasks are posted. The extra Sequences remain visible to other
+// workers through work stealing, and a small batch keeps execution close to
+// the shared queue's priority order.
+constexpr size_t kSharedQueueRefillBatchSize = 4;
 constexpr char kDetachDurationHistogramPrefix[] =
     "TaskScheduler.DetachDuration.";
 constexpr char kNumTasksBeforeDetachHistogramPrefix[] =
@@ -161,8 +170,33 @@ class SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl
   // Calls cleanup on |worker| and removes it from the pool.
   void Cleanup(SchedulerWorker* worker);
 
+  // Removes and returns the Sequence at the front of |local_sequences_|, or
+  // nullptr if it is empty. Only called by the worker that owns this delegate.
+  scoped_refptr<Sequence> PopLocalSequence();
+
+  // Removes and returns the Sequence at the back of |local_sequences_|, or
+  // nullptr if it is empty. Called by other workers that ran out of work.
+  scoped_refptr<Sequence> StealSequence();
+
+  // Tries to steal a Sequence from the local deque of another worker of the
+  // pool. Returns nullptr if no worker has a stealable Sequence.
+  // |outer_->lock_| must be held, since |outer_->worker_delegates_| is
+  // iterated.
+  scoped_refptr<Sequence> StealSequenceFromOtherWorkers();
+
   SchedulerWorkerPoolImpl* outer_;
 
+  // Synchronizes accesses to |local_sequences_|. Has |outer_->lock_| as its
+  // predecessor so that a stealing worker can lock the deques of its peers
+  // while it holds |outer_->lock_|.
+  SchedulerLock local_sequences_lock_;
+
+  // Sequences retrieved from |outer_->shared_priority_queue_| in a batch by
+  // the worker that owns this delegate, but not started yet. The owner pops
+  // from the front; stealing workers pop from the back, where the Sequences
+  // with the lowest priority of the batch live.
+  std::deque<scoped_refptr<Sequence>> local_sequences_;
+
   // Time of the last detach.
   TimeTicks last_detach_time_;
 
@@ -397,7 +431,7 @@ size_t SchedulerWorkerPoolImpl::GetWorkerCapacityForTesting() {
 
 SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
     SchedulerWorkerDelegateImpl(SchedulerWorkerPoolImpl* outer)
-    : outer_(outer) {}
+    : outer_(outer), local_sequences_lock_(&outer->lock_) {}
 
 SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
     ~SchedulerWorkerDelegateImpl() = default;
@@ -433,8 +467,10 @@ SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::GetWork(
     DCHECK(ContainsWorker(outer_->workers_, worker));
   }
 
-  scoped_refptr<Sequence> sequence;
-  {
+  // Sequences batched into the local deque by a previous call are handed out
+  // without touching the shared queue or its lock.
+  scoped_refptr<Sequence> sequence = PopLocalSequence();
+  if (!sequence) {
     std::unique_ptr<PriorityQueue::Transaction> shared_transaction(
         outer_->shared_priority_queue_.BeginTransaction());
 
@@ -453,26 +489,57 @@ SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::GetWork(
       //    No thread runs the Sequence inserted in step 2.
       AutoSchedulerLock auto_lock(outer_->lock_);
 
-      // Record the TaskScheduler.NumTasksBetweenWaits histogram. After
-      // returning nullptr, the SchedulerWorker will perform a wait on its
-      // WaitableEvent, so we record how many tasks were ran since the last wait
-      // here.
-      outer_->num_tasks_between_waits_histogram_->Add(
-          num_tasks_since_last_wait_);
-      num_tasks_since_last_wait_ = 0;
-
-      if (CanCleanup(worker)) {
-        Cleanup(worker);
+      // The shared queue is empty, but another worker may be sitting on a
+      // batch of Sequences it hasn't started yet. Steal one before idling.
+      sequence = StealSequenceFromOtherWorkers();
+      if (!sequence) {
+        // Record the TaskScheduler.NumTasksBetweenWaits histogram. After
+        // returning nullptr, the SchedulerWorker will perform a wait on its
+        // WaitableEvent, so we record how many tasks were ran since the last
+        // wait here.
+        outer_->num_tasks_between_waits_histogram_->Add(
+            num_tasks_since_last_wait_);
+        num_tasks_since_last_wait_ = 0;
+
+        if (CanCleanup(worker)) {
+          Cleanup(worker);
+          return nullptr;
+        }
+
+        outer_->AddToIdleWorkersStack(worker);
+        if (idle_start_time_.is_null())
+          idle_start_time_ = TimeTicks::Now();
         return nullptr;
       }
+    } else {
+      // Pop a batch of Sequences in a single Transaction and stash the extra
+      // ones in the local deque, so that subsequent calls don't have to
+      // contend on the shared queue's lock. The batch is popped in priority
+      // order, so the front of the local deque holds the highest-priority
+      // Sequence of the batch.
+      sequence = shared_transaction->PopSequence();
+      std::vector<scoped_refptr<Sequence>> extra_sequences;
+      while (extra_sequences.size() < kSharedQueueRefillBatchSize - 1 &&
+             !shared_transaction->IsEmpty()) {
+        extra_sequences.push_back(shared_transaction->PopSequence());
+      }
 
-      outer_->AddToIdleWorkersStack(worker);
-      if (idle_start_time_.is_null())
-        idle_start_time_ = TimeTicks::Now();
-      return nullptr;
+      // End the Transaction before acquiring |local_sequences_lock_|, which
+      // has |outer_->lock_| rather than the shared queue's lock as its
+      // predecessor.
+      shared_transaction.reset();
+
+      if (!extra_sequences.empty()) {
+        {
+          AutoSchedulerLock auto_lock(local_sequences_lock_);
+          for (auto& extra_sequence : extra_sequences)
+            local_sequences_.push_back(std::move(extra_sequence));
+        }
+        // Give an idle peer a chance to steal the stashed Sequences instead
+        // of leaving them behind a potentially long task on this worker.
+        outer_->WakeUpOneWorker();
+      }
     }
-
-    sequence = shared_transaction->PopSequence();
   }
   DCHECK(sequence);
   {
@@ -521,11 +588,49 @@ void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::Cleanup(
   worker->Cleanup();
   outer_->RemoveFromIdleWorkersStack(worker);
 
-  // Remove the worker from |workers_|.
+  // Remove the worker from |workers_| and this delegate from
+  // |worker_delegates_|.
   auto worker_iter =
       std::find(outer_->workers_.begin(), outer_->workers_.end(), worker);
   DCHECK(worker_iter != outer_->workers_.end());
   outer_->workers_.erase(worker_iter);
+  auto delegate_iter = std::find(outer_->worker_delegates_.begin(),
+                                 outer_->worker_delegates_.end(), this);
+  DCHECK(delegate_iter != outer_->worker_delegates_.end());
+  outer_->worker_delegates_.erase(delegate_iter);
+}
+
+scoped_refptr<Sequence>
+SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::PopLocalSequence() {
+  AutoSchedulerLock auto_lock(local_sequences_lock_);
+  if (local_sequences_.empty())
+    return nullptr;
+  scoped_refptr<Sequence> sequence = std::move(local_sequences_.front());
+  local_sequences_.pop_front();
+  return sequence;
+}
+
+scoped_refptr<Sequence>
+SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::StealSequence() {
+  AutoSchedulerLock auto_lock(local_sequences_lock_);
+  if (local_sequences_.empty())
+    return nullptr;
+  scoped_refptr<Sequence> sequence = std::move(local_sequences_.back());
+  local_sequences_.pop_back();
+  return sequence;
+}
+
+scoped_refptr<Sequence> SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::
+    StealSequenceFromOtherWorkers() {
+  outer_->lock_.AssertAcquired();
+  for (SchedulerWorkerDelegateImpl* delegate : outer_->worker_delegates_) {
+    if (delegate == this)
+      continue;
+    scoped_refptr<Sequence> sequence = delegate->StealSequence();
+    if (sequence)
+      return sequence;
+  }
+  return nullptr;
 }
 
 void SchedulerWorkerPoolImpl::SchedulerWorkerDelegateImpl::OnMainExit(
@@ -615,14 +720,18 @@ SchedulerWorkerPoolImpl::CreateRegisterAndStartSchedulerWorker() {
   // SchedulerWorker needs |lock_| as a predecessor for its thread lock
   // because in WakeUpOneWorker, |lock_| is first acquired and then
   // the thread lock is acquired when WakeUp is called on the worker.
+  std::unique_ptr<SchedulerWorkerDelegateImpl> delegate =
+      MakeUnique<SchedulerWorkerDelegateImpl>(this);
+  SchedulerWorkerDelegateImpl* delegate_raw = delegate.get();
   scoped_refptr<SchedulerWorker> worker = MakeRefCounted<SchedulerWorker>(
-      priority_hint_, MakeUnique<SchedulerWorkerDelegateImpl>(this),
-      task_tracker_, &lock_, backward_compatibility_);
+      priority_hint_, std::move(delegate), task_tracker_, &lock_,
+      backward_compatibility_);
 
   if (!worker->Start())
     return nullptr;
 
   workers_.push_back(worker);
+  worker_delegates_.push_back(delegate_raw);
 
   if (!cleanup_timestamps_.empty()) {
     detach_duration_histogram_->AddTime(TimeTicks::Now() -
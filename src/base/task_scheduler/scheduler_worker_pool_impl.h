@@ -155,9 +155,10 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
 
   SchedulerBackwardCompatibility backward_compatibility_;
 
-  // Synchronizes accesses to |workers_|, |worker_capacity_|,
-  // |idle_workers_stack_|, |idle_workers_stack_cv_for_testing_|,
-  // |num_wake_ups_before_start_|, and |cleanup_timestamps_| . Has
+  // Synchronizes accesses to |workers_|, |worker_delegates_|,
+  // |worker_capacity_|, |idle_workers_stack_|,
+  // |idle_workers_stack_cv_for_testing_|, |num_wake_ups_before_start_|, and
+  // |cleanup_timestamps_| . Has
   // |shared_priority_queue_|'s lock as its predecessor so that a worker can be
   // pushed to |idle_workers_stack_| within the scope of a Transaction (more
   // details in GetWork()).
@@ -166,6 +167,10 @@ class BASE_EXPORT SchedulerWorkerPoolImpl : public SchedulerWorkerPool {
   // All workers owned by this worker pool.
   std::vector<scoped_refptr<SchedulerWorker>> workers_;
 
+  // Delegates of the workers in |workers_|. Workers use this to steal
+  // Sequences from the local work deques of other workers before going idle.
+  std::vector<SchedulerWorkerDelegateImpl*> worker_delegates_;
+
   // Workers can be added as needed up until there are |worker_capacity_|
   // workers.
   size_t worker_capacity_ = 0;
@@ -126,6 +126,12 @@ void DrainableIOBuffer::SetOffset(int bytes) {
   data_ = base_->data() + used_;
 }
 
+void DrainableIOBuffer::SetSize(int size) {
+  DCHECK_GE(size, 0);
+  size_ = size;
+  SetOffset(0);
+}
+
 DrainableIOBuffer::~DrainableIOBuffer() {
   // The buffer is owned by the |base_| instance.
   data_ = NULL;
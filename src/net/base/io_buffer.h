@@ -172,6 +172,11 @@ class NET_EXPORT DrainableIOBuffer : public IOBuffer {
   // and remaining are updated appropriately.
   void SetOffset(int bytes);
 
+  // Rewinds the consumed count to zero and changes the visible size to
+  // |size|, so the buffer can be reused for a fresh chunk of data. |size|
+  // must not exceed the size of the underlying buffer.
+  void SetSize(int size);
+
   int size() const { return size_; }
 
  private:
@@ -4,6 +4,10 @@
 
 #include "net/cert/caching_cert_verifier.h"
 
+#include <utility>
+
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
 #include "base/time/time.h"
 #include "net/base/net_errors.h"
 
@@ -11,19 +15,27 @@ namespace net {
 
 namespace {
 
-// The maximum number of cache entries to use for the ExpiringCache.
-const unsigned kMaxCacheEntries = 256;
+// The maximum number of cache entries to use for the ExpiringCache. An edge
+// typically sees the same few dozen chains repeatedly, but with many distinct
+// hostnames per chain; a full verification costs several milliseconds of CPU,
+// so keeping more results around is cheap by comparison.
+const unsigned kMaxCacheEntries = 1024;
 
 // The number of seconds to cache entries.
 const unsigned kTTLSecs = 1800;  // 30 minutes.
 
+// How close to expiration a cached entry may get before a hit on it kicks
+// off a background revalidation to refresh it.
+const unsigned kRevalidationWindowSecs = 300;  // 5 minutes.
+
 }  // namespace
 
 CachingCertVerifier::CachingCertVerifier(std::unique_ptr<CertVerifier> verifier)
     : verifier_(std::move(verifier)),
       cache_(kMaxCacheEntries),
       requests_(0u),
-      cache_hits_(0u) {
+      cache_hits_(0u),
+      revalidations_(0u) {
   CertDatabase::GetInstance()->AddObserver(this);
 }
 
@@ -45,8 +57,16 @@ int CachingCertVerifier::Verify(const CertVerifier::RequestParams& params,
       cache_.Get(params, CacheValidityPeriod(base::Time::Now()));
   if (cached_entry) {
     ++cache_hits_;
+    // Copy out of the cache before a possible revalidation below mutates it.
+    int error = cached_entry->error;
     *verify_result = cached_entry->result;
-    return cached_entry->error;
+    // If the entry is close to expiring, refresh it in the background so
+    // that a later handshake does not have to wait on a full verification.
+    if (cached_entry->expiration_time - base::Time::Now() <=
+        base::TimeDelta::FromSeconds(kRevalidationWindowSecs)) {
+      MaybeStartRevalidation(params, crl_set, net_log);
+    }
+    return error;
   }
 
   base::Time start_time = base::Time::Now();
@@ -90,6 +110,10 @@ CachingCertVerifier::CachedResult::CachedResult() : error(ERR_FAILED) {}
 
 CachingCertVerifier::CachedResult::~CachedResult() {}
 
+CachingCertVerifier::RevalidationAttempt::RevalidationAttempt() {}
+
+CachingCertVerifier::RevalidationAttempt::~RevalidationAttempt() {}
+
 CachingCertVerifier::CacheValidityPeriod::CacheValidityPeriod(base::Time now)
     : verification_time(now), expiration_time(now) {}
 
@@ -175,10 +199,46 @@ void CachingCertVerifier::AddResultToCache(
   CachedResult cached_result;
   cached_result.error = error;
   cached_result.result = verify_result;
-  cache_.Put(
-      params, cached_result, CacheValidityPeriod(start_time),
-      CacheValidityPeriod(start_time,
-                          start_time + base::TimeDelta::FromSeconds(kTTLSecs)));
+  cached_result.expiration_time =
+      start_time + base::TimeDelta::FromSeconds(kTTLSecs);
+  cache_.Put(params, cached_result, CacheValidityPeriod(start_time),
+             CacheValidityPeriod(start_time, cached_result.expiration_time));
+}
+
+void CachingCertVerifier::MaybeStartRevalidation(
+    const RequestParams& params,
+    CRLSet* crl_set,
+    const NetLogWithSource& net_log) {
+  if (inflight_revalidations_.count(params) > 0)
+    return;
+
+  ++revalidations_;
+
+  std::unique_ptr<RevalidationAttempt> attempt =
+      base::MakeUnique<RevalidationAttempt>();
+  RevalidationAttempt* attempt_ptr = attempt.get();
+  base::Time start_time = base::Time::Now();
+  CompletionCallback callback =
+      base::Bind(&CachingCertVerifier::OnRevalidationFinished,
+                 base::Unretained(this), params, start_time);
+  int result = verifier_->Verify(params, crl_set, &attempt_ptr->result,
+                                 callback, &attempt_ptr->request, net_log);
+  if (result == ERR_IO_PENDING) {
+    inflight_revalidations_[params] = std::move(attempt);
+    return;
+  }
+
+  // Synchronous completion; replace the cached entry directly.
+  AddResultToCache(params, start_time, attempt_ptr->result, result);
+}
+
+void CachingCertVerifier::OnRevalidationFinished(const RequestParams& params,
+                                                 base::Time start_time,
+                                                 int error) {
+  auto it = inflight_revalidations_.find(params);
+  DCHECK(it != inflight_revalidations_.end());
+  AddResultToCache(params, start_time, it->second->result, error);
+  inflight_revalidations_.erase(it);
 }
 
 void CachingCertVerifier::VisitEntries(CacheVisitor* visitor) const {
@@ -199,6 +259,9 @@ void CachingCertVerifier::VisitEntries(CacheVisitor* visitor) const {
 }
 
 void CachingCertVerifier::OnCertDBChanged() {
+  // Results computed against the old trust settings are no longer meaningful,
+  // whether cached or still in flight.
+  inflight_revalidations_.clear();
   ClearCache();
 }
 
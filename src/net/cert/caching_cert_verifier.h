@@ -5,6 +5,7 @@
 #ifndef NET_CERT_CACHING_CERT_VERIFIER_H_
 #define NET_CERT_CACHING_CERT_VERIFIER_H_
 
+#include <map>
 #include <memory>
 
 #include "net/base/expiring_cache.h"
@@ -89,6 +90,7 @@ class NET_EXPORT CachingCertVerifier : public CertVerifier,
   FRIEND_TEST_ALL_PREFIXES(CachingCertVerifierTest, Visitor);
   FRIEND_TEST_ALL_PREFIXES(CachingCertVerifierTest, AddsEntries);
   FRIEND_TEST_ALL_PREFIXES(CachingCertVerifierTest, DifferentCACerts);
+  FRIEND_TEST_ALL_PREFIXES(CachingCertVerifierTest, RevalidatesNearExpiration);
 
   // CachedResult contains the result of a certificate verification.
   struct NET_EXPORT_PRIVATE CachedResult {
@@ -97,6 +99,18 @@ class NET_EXPORT CachingCertVerifier : public CertVerifier,
 
     int error;                // The return value of CertVerifier::Verify.
     CertVerifyResult result;  // The output of CertVerifier::Verify.
+    base::Time expiration_time;  // When this result ceases to be usable.
+  };
+
+  // State for an in-progress background revalidation of a cached entry.
+  // |result| must outlive |request|, as the underlying verifier writes into
+  // it on completion.
+  struct RevalidationAttempt {
+    RevalidationAttempt();
+    ~RevalidationAttempt();
+
+    CertVerifyResult result;
+    std::unique_ptr<Request> request;
   };
 
   // Rather than having a single validity point along a monotonically increasing
@@ -143,6 +157,20 @@ class NET_EXPORT CachingCertVerifier : public CertVerifier,
                         const CertVerifyResult& verify_result,
                         int error);
 
+  // Starts a background verification for |params| if one is not already in
+  // flight, so that a cached entry nearing expiration is refreshed before a
+  // handshake has to block on it. The result replaces the cached entry when
+  // it completes.
+  void MaybeStartRevalidation(const RequestParams& params,
+                              CRLSet* crl_set,
+                              const NetLogWithSource& net_log);
+
+  // Handles completion of the background revalidation for |params|, which
+  // started at |start_time|.
+  void OnRevalidationFinished(const RequestParams& params,
+                              base::Time start_time,
+                              int error);
+
   // CertDatabase::Observer methods:
   void OnCertDBChanged() override;
 
@@ -151,13 +179,20 @@ class NET_EXPORT CachingCertVerifier : public CertVerifier,
   size_t GetCacheSize() const;
   uint64_t cache_hits() const { return cache_hits_; }
   uint64_t requests() const { return requests_; }
+  uint64_t revalidations() const { return revalidations_; }
 
   std::unique_ptr<CertVerifier> verifier_;
 
   CertVerificationCache cache_;
 
+  // In-flight background revalidations, keyed by the cached entry they will
+  // replace. Destroying an attempt cancels the underlying request.
+  std::map<RequestParams, std::unique_ptr<RevalidationAttempt>>
+      inflight_revalidations_;
+
   uint64_t requests_;
   uint64_t cache_hits_;
+  uint64_t revalidations_;
 
   DISALLOW_COPY_AND_ASSIGN(CachingCertVerifier);
 };
@@ -219,6 +219,54 @@ TEST_F(CachingCertVerifierTest, AddsEntries) {
   ASSERT_EQ(1u, verifier_.GetCacheSize());
 }
 
+// Tests that a cache hit on an entry nearing expiration kicks off a
+// background revalidation that refreshes the entry.
+TEST_F(CachingCertVerifierTest, RevalidatesNearExpiration) {
+  base::FilePath certs_dir = GetTestCertsDirectory();
+  scoped_refptr<X509Certificate> test_cert(
+      ImportCertFromFile(certs_dir, "ok_cert.pem"));
+  ASSERT_TRUE(test_cert.get());
+
+  CertVerifyResult result;
+  result.verified_cert = test_cert;
+  result.cert_status = CERT_STATUS_WEAK_KEY;
+
+  // Add an entry whose 30 minute TTL is nearly used up, but which is still
+  // valid.
+  CertVerifier::RequestParams params(test_cert, "www.example.com", 0,
+                                     std::string(), CertificateList());
+  EXPECT_TRUE(verifier_.AddEntry(
+      params, ERR_CERT_WEAK_KEY, result,
+      base::Time::Now() - base::TimeDelta::FromMinutes(26)));
+  ASSERT_EQ(1u, verifier_.GetCacheSize());
+  ASSERT_EQ(0u, verifier_.revalidations());
+
+  TestCompletionCallback callback;
+  std::unique_ptr<CertVerifier::Request> request;
+  CertVerifyResult cached_result;
+
+  // The aging entry is still served synchronously from the cache...
+  int error =
+      verifier_.Verify(params, nullptr, &cached_result, callback.callback(),
+                       &request, NetLogWithSource());
+  ASSERT_THAT(error, IsError(ERR_CERT_WEAK_KEY));
+  ASSERT_FALSE(request);
+  ASSERT_EQ(1u, verifier_.cache_hits());
+  // ...and a background revalidation was started. The mock verifier
+  // completes synchronously, so the refreshed result is already cached.
+  ASSERT_EQ(1u, verifier_.revalidations());
+  ASSERT_EQ(1u, verifier_.GetCacheSize());
+
+  // The refreshed entry reflects the underlying verifier's new result and
+  // does not trigger another revalidation.
+  error = verifier_.Verify(params, nullptr, &cached_result,
+                           callback.callback(), &request, NetLogWithSource());
+  ASSERT_NE(ERR_IO_PENDING, error);
+  ASSERT_TRUE(IsCertificateError(error));
+  ASSERT_EQ(2u, verifier_.cache_hits());
+  ASSERT_EQ(1u, verifier_.revalidations());
+}
+
 // Tests the same server certificate with different intermediate CA
 // certificates.  These should be treated as different certificate chains even
 // though the two X509Certificate objects contain the same server certificate.
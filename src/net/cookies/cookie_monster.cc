@@ -44,6 +44,7 @@
 
 #include "net/cookies/cookie_monster.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <set>
@@ -163,6 +164,11 @@ typedef std::vector<CanonicalCookie*> CanonicalCookieVector;
 // will update it again.
 const int kDefaultAccessUpdateThresholdSeconds = 60;
 
+// Maximum number of host -> domain key mappings memoized by GetKey() before
+// the cache is cleared. Sized to comfortably cover the working set of hosts
+// a browsing session touches between purges.
+const size_t kDomainKeyCacheMaxSize = 1024;
+
 // Comparator to sort cookies from highest creation date to lowest
 // creation date.
 struct OrderByCreationTimeDesc {
@@ -181,7 +187,7 @@ const int kVlogGetCookies = 9;
 // Mozilla sorts on the path length (longest first), and then it
 // sorts by creation time (oldest first).
 // The RFC says the sort order for the domain attribute is undefined.
-bool CookieSorter(CanonicalCookie* cc1, CanonicalCookie* cc2) {
+bool CookieSorter(const CanonicalCookie* cc1, const CanonicalCookie* cc2) {
   if (cc1->Path().length() == cc2->Path().length())
     return cc1->CreationDate() < cc2->CreationDate();
   return cc1->Path().length() > cc2->Path().length();
@@ -196,6 +202,21 @@ bool LRACookieSorter(const CookieMonster::CookieMap::iterator& it1,
   return it1->second->CreationDate() < it2->second->CreationDate();
 }
 
+// Computes the domain key (eTLD+1) used to partition the cookie map. See the
+// comment ahead of CookieMonster::GetKey() for the rationale behind the
+// algorithm; GetKey() itself adds memoization on top of this.
+std::string CookieKeyForDomain(const std::string& domain) {
+  std::string effective_domain(
+      registry_controlled_domains::GetDomainAndRegistry(
+          domain, registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES));
+  if (effective_domain.empty())
+    effective_domain = domain;
+
+  if (!effective_domain.empty() && effective_domain[0] == '.')
+    return effective_domain.substr(1);
+  return effective_domain;
+}
+
 // Our strategy to find duplicates is:
 // (1) Build a map from (cookiename, cookiepath) to
 //     {list of cookies with this signature, sorted by creation time}.
@@ -1859,15 +1880,63 @@ size_t CookieMonster::GarbageCollectLeastRecentlyAccessed(
 std::string CookieMonster::GetKey(const std::string& domain) const {
   DCHECK(thread_checker_.CalledOnValidThread());
 
-  std::string effective_domain(
-      registry_controlled_domains::GetDomainAndRegistry(
-          domain, registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES));
-  if (effective_domain.empty())
-    effective_domain = domain;
+  auto cached = domain_key_cache_.find(domain);
+  if (cached != domain_key_cache_.end())
+    return cached->second;
 
-  if (!effective_domain.empty() && effective_domain[0] == '.')
-    return effective_domain.substr(1);
-  return effective_domain;
+  std::string key(CookieKeyForDomain(domain));
+
+  if (domain_key_cache_.size() >= kDomainKeyCacheMaxSize)
+    domain_key_cache_.clear();
+  domain_key_cache_[domain] = key;
+  return key;
+}
+
+CookieMonster::Snapshot::Snapshot() {}
+
+CookieMonster::Snapshot::~Snapshot() {}
+
+void CookieMonster::Snapshot::GetCookiesForURL(const GURL& url,
+                                               const CookieOptions& options,
+                                               CookieList* cookies) const {
+  auto it = cookies_by_key_.find(CookieKeyForDomain(url.host()));
+  if (it == cookies_by_key_.end())
+    return;
+
+  const Time current_time(Time::Now());
+  for (const CanonicalCookie& cc : it->second) {
+    // Filter out cookies that have expired since the snapshot was taken.
+    if (cc.IsExpired(current_time))
+      continue;
+    if (!cc.IncludeForRequestURL(url, options))
+      continue;
+    // The per-key lists are presorted, so matches come out already in
+    // CookieSorter order.
+    cookies->push_back(cc);
+  }
+}
+
+std::unique_ptr<CookieMonster::Snapshot> CookieMonster::CreateSnapshot() const {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  std::unique_ptr<Snapshot> snapshot(new Snapshot);
+  const Time current_time(Time::Now());
+  for (const auto& entry : cookies_) {
+    CanonicalCookie* cc = entry.second.get();
+    if (cc->IsExpired(current_time))
+      continue;
+    snapshot->cookies_by_key_[entry.first].push_back(*cc);
+  }
+
+  // Presort each per-key list so queries can append matches without a
+  // per-request sort.
+  for (auto& entry : snapshot->cookies_by_key_) {
+    std::sort(entry.second.begin(), entry.second.end(),
+              [](const CanonicalCookie& cc1, const CanonicalCookie& cc2) {
+                return CookieSorter(&cc1, &cc2);
+              });
+  }
+  return snapshot;
 }
 
 bool CookieMonster::HasCookieableScheme(const GURL& url) {
@@ -16,6 +16,7 @@
 #include <queue>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -233,6 +234,42 @@ class NET_EXPORT CookieMonster : public CookieStore {
                                            const base::Time& creation_time,
                                            SetCookiesCallback callback);
 
+  // An immutable, read-only copy of the cookies in the store, indexed by
+  // domain key (eTLD+1) and presorted for path matching. A snapshot is built
+  // on the CookieMonster's thread but, being self-contained, may be queried
+  // from any thread without touching the live store. Queries never update
+  // cookie access times. Cookies that expire after the snapshot is taken are
+  // filtered out at query time, but cookies set or deleted later are not
+  // reflected; take a new snapshot to pick them up.
+  class NET_EXPORT Snapshot {
+   public:
+    ~Snapshot();
+
+    // Appends to |cookies| the cookies in the snapshot that would be included
+    // for a request to |url| given |options|, in the same order that
+    // GetCookieListWithOptionsAsync would return them (longest path first,
+    // then earliest creation time).
+    void GetCookiesForURL(const GURL& url,
+                          const CookieOptions& options,
+                          CookieList* cookies) const;
+
+   private:
+    friend class CookieMonster;
+
+    Snapshot();
+
+    // Domain key (eTLD+1) -> cookies for that key, sorted by CookieSorter
+    // order at construction so queries need no per-request sort.
+    std::unordered_map<std::string, CookieList> cookies_by_key_;
+
+    DISALLOW_COPY_AND_ASSIGN(Snapshot);
+  };
+
+  // Builds a snapshot of all unexpired cookies currently in the store. Must
+  // be called on the CookieMonster's thread; the returned snapshot may
+  // outlive the store and be used from other threads.
+  std::unique_ptr<Snapshot> CreateSnapshot() const;
+
  private:
   CookieMonster(PersistentCookieStore* store,
                 CookieMonsterDelegate* delegate,
@@ -669,6 +706,13 @@ class NET_EXPORT CookieMonster : public CookieStore {
 
   CookieMap cookies_;
 
+  // Memoizes host -> domain key (eTLD+1) mappings computed by GetKey(), so
+  // repeated lookups for the same host skip the registry-controlled-domain
+  // computation. The mapping is a pure function of the host, so entries never
+  // become stale; the cache is simply cleared when it reaches
+  // kDomainKeyCacheMaxSize to bound memory use.
+  mutable std::unordered_map<std::string, std::string> domain_key_cache_;
+
   // Indicates whether the cookie store has been initialized.
   bool initialized_;
 
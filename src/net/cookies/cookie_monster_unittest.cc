@@ -1708,6 +1708,73 @@ TEST_F(CookieMonsterTest, GetAllCookiesForURLPathMatching) {
   ASSERT_TRUE(++it == cookies.end());
 }
 
+TEST_F(CookieMonsterTest, Snapshot) {
+  std::unique_ptr<CookieMonster> cm(
+      new CookieMonster(nullptr, nullptr, kLastAccessThreshold));
+
+  CookieOptions options;
+  options.set_include_httponly();
+
+  EXPECT_TRUE(SetCookieWithOptions(cm.get(), www_foo_foo_.url(),
+                                   "A=B; path=/foo;", options));
+  EXPECT_TRUE(
+      SetCookieWithOptions(cm.get(), http_www_foo_.url(), "C=D;", options));
+  EXPECT_TRUE(SetCookieWithOptions(cm.get(), http_www_foo_.url(),
+                                   "E=F; httponly", options));
+  EXPECT_TRUE(
+      SetCookieWithOptions(cm.get(), http_bar_com_.url(), "G=H;", options));
+
+  const Time last_access_date(GetFirstCookieAccessDate(cm.get()));
+
+  std::unique_ptr<CookieMonster::Snapshot> snapshot(cm->CreateSnapshot());
+
+  // Cookies for the queried URL come back in the same order as the live
+  // store: longest path first, then earliest creation time.
+  CookieList cookies;
+  snapshot->GetCookiesForURL(www_foo_foo_.url(), options, &cookies);
+  CookieList::iterator it = cookies.begin();
+
+  ASSERT_TRUE(it != cookies.end());
+  EXPECT_EQ("A", it->Name());
+  EXPECT_EQ("/foo", it->Path());
+
+  ASSERT_TRUE(++it != cookies.end());
+  EXPECT_EQ("C", it->Name());
+
+  ASSERT_TRUE(++it != cookies.end());
+  EXPECT_EQ("E", it->Name());
+
+  ASSERT_TRUE(++it == cookies.end());
+
+  // Excluding http-only cookies leaves E out.
+  cookies.clear();
+  snapshot->GetCookiesForURL(http_www_foo_.url(), CookieOptions(), &cookies);
+  ASSERT_EQ(1u, cookies.size());
+  EXPECT_EQ("C", cookies[0].Name());
+
+  // Cookies for other domain keys are not returned.
+  cookies.clear();
+  snapshot->GetCookiesForURL(http_bar_com_.url(), options, &cookies);
+  ASSERT_EQ(1u, cookies.size());
+  EXPECT_EQ("G", cookies[0].Name());
+
+  // Snapshot queries must not update access times in the live store.
+  EXPECT_EQ(last_access_date, GetFirstCookieAccessDate(cm.get()));
+
+  // Cookies set after the snapshot was taken are not reflected.
+  EXPECT_TRUE(
+      SetCookieWithOptions(cm.get(), http_www_foo_.url(), "I=J;", options));
+  cookies.clear();
+  snapshot->GetCookiesForURL(http_www_foo_.url(), options, &cookies);
+  EXPECT_EQ(2u, cookies.size());
+
+  // The snapshot remains usable after the store goes away.
+  cm.reset();
+  cookies.clear();
+  snapshot->GetCookiesForURL(http_www_foo_.url(), options, &cookies);
+  EXPECT_EQ(2u, cookies.size());
+}
+
 TEST_F(CookieMonsterTest, CookieSorting) {
   std::unique_ptr<CookieMonster> cm(new CookieMonster(nullptr, nullptr));
 
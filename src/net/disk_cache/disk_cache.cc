@@ -10,6 +10,7 @@
 #include "base/single_thread_task_runner.h"
 #include "base/task_scheduler/task_scheduler.h"
 #include "net/base/cache_type.h"
+#include "net/base/io_buffer.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/backend_cleanup_tracker.h"
 #include "net/disk_cache/blockfile/backend_impl.h"
@@ -292,4 +293,11 @@ int Backend::CalculateSizeOfEntriesBetween(base::Time initial_time,
   return net::ERR_NOT_IMPLEMENTED;
 }
 
+void Entry::Preload(int index, int offset, int length) {}
+
+scoped_refptr<net::IOBuffer> Entry::GetZeroCopyData(int index, int* out_len) {
+  *out_len = 0;
+  return nullptr;
+}
+
 }  // namespace disk_cache
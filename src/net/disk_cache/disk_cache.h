@@ -278,6 +278,27 @@ class NET_EXPORT Entry {
                         const CompletionCallback& callback,
                         bool truncate) = 0;
 
+  // Hints that the byte range [offset, offset + length) of the stream with
+  // the given index will be read soon, so the implementation may warm its
+  // caches ahead of the corresponding ReadData calls. A negative |length|
+  // requests readahead to the end of the stream, so Preload(index, 0, -1)
+  // asks for the whole stream; callers opening small entries they intend to
+  // consume in full should do exactly that. This is purely advisory: there
+  // is no completion signal and implementations are free to ignore it. The
+  // default implementation does nothing.
+  virtual void Preload(int index, int offset, int length);
+
+  // Returns a reference-counted buffer holding the complete data of the
+  // stream with the given index without copying it, storing the data length
+  // in |*out_len|, or NULL if the backend cannot share its storage (or the
+  // stream is empty), in which case the caller must fall back to ReadData.
+  // The returned buffer is a snapshot: it stays valid and unchanged even if
+  // the entry is later written to, doomed or closed, and the caller must
+  // not write through it. This lets a cache hit be handed to a consumer
+  // (e.g. a socket write) with zero payload copies. The default
+  // implementation returns NULL.
+  virtual scoped_refptr<IOBuffer> GetZeroCopyData(int index, int* out_len);
+
   // Sparse entries support:
   //
   // A Backend implementation can support sparse entries, so the cache keeps
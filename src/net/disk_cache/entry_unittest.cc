@@ -723,6 +723,68 @@ TEST_F(DiskCacheEntryTest, MemoryOnlyStreamAccess) {
   StreamAccess();
 }
 
+// Tests the zero-copy read path of the memory-only cache: the returned
+// buffer must match the stored data and keep it alive and unchanged across
+// later writes and across the entry being doomed.
+TEST_F(DiskCacheEntryTest, MemoryOnlyZeroCopyData) {
+  SetMemoryOnlyMode();
+  InitCache();
+
+  disk_cache::Entry* entry = NULL;
+  ASSERT_THAT(CreateEntry("the first key", &entry), IsOk());
+
+  const int kSize = 1024;
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(kSize));
+  CacheTestFillBuffer(buffer->data(), kSize, false);
+
+  // An empty stream has nothing to share.
+  int len = -1;
+  EXPECT_FALSE(entry->GetZeroCopyData(1, &len));
+  EXPECT_EQ(0, len);
+
+  EXPECT_EQ(kSize, WriteData(entry, 1, 0, buffer.get(), kSize, false));
+
+  scoped_refptr<net::IOBuffer> snapshot = entry->GetZeroCopyData(1, &len);
+  ASSERT_TRUE(snapshot);
+  ASSERT_EQ(kSize, len);
+  EXPECT_EQ(0, memcmp(buffer->data(), snapshot->data(), kSize));
+
+  // Overwriting the stream must not change the bytes already handed out.
+  scoped_refptr<net::IOBuffer> buffer2(new net::IOBuffer(kSize));
+  CacheTestFillBuffer(buffer2->data(), kSize, false);
+  EXPECT_EQ(kSize, WriteData(entry, 1, 0, buffer2.get(), kSize, false));
+  EXPECT_EQ(0, memcmp(buffer->data(), snapshot->data(), kSize));
+
+  // The buffers also survive the entry itself going away.
+  scoped_refptr<net::IOBuffer> snapshot2 = entry->GetZeroCopyData(1, &len);
+  ASSERT_TRUE(snapshot2);
+  ASSERT_EQ(kSize, len);
+  EXPECT_EQ(0, memcmp(buffer2->data(), snapshot2->data(), kSize));
+  entry->Doom();
+  entry->Close();
+  EXPECT_EQ(0, memcmp(buffer->data(), snapshot->data(), kSize));
+  EXPECT_EQ(0, memcmp(buffer2->data(), snapshot2->data(), kSize));
+}
+
+// Backends that cannot share their storage must report that with a NULL
+// return, so callers fall back to ReadData.
+TEST_F(DiskCacheEntryTest, ZeroCopyDataUnsupported) {
+  InitCache();
+
+  disk_cache::Entry* entry = NULL;
+  ASSERT_THAT(CreateEntry("the first key", &entry), IsOk());
+
+  const int kSize = 100;
+  scoped_refptr<net::IOBuffer> buffer(new net::IOBuffer(kSize));
+  CacheTestFillBuffer(buffer->data(), kSize, false);
+  EXPECT_EQ(kSize, WriteData(entry, 1, 0, buffer.get(), kSize, false));
+
+  int len = -1;
+  EXPECT_FALSE(entry->GetZeroCopyData(1, &len));
+  EXPECT_EQ(0, len);
+  entry->Close();
+}
+
 void DiskCacheEntryTest::GetKey() {
   std::string key("the first key");
   disk_cache::Entry* entry;
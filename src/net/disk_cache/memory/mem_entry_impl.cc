@@ -64,6 +64,24 @@ std::string GenerateChildName(const std::string& base_name, int child_id) {
   return base::StringPrintf("Range_%s:%i", base_name.c_str(), child_id);
 }
 
+// An IOBuffer pointing into a refcounted stream, keeping the stream (and
+// thus the bytes) alive for as long as the buffer itself. Used to implement
+// GetZeroCopyData(): the bytes are never mutated once handed out, because
+// MemEntryImpl copies a stream with outstanding references before writing
+// to it.
+class StreamDataIOBuffer : public net::IOBuffer {
+ public:
+  explicit StreamDataIOBuffer(scoped_refptr<MemEntryImpl::StreamData> stream)
+      : IOBuffer(stream->bytes().data()), stream_(std::move(stream)) {}
+
+ private:
+  ~StreamDataIOBuffer() override { data_ = nullptr; }
+
+  scoped_refptr<MemEntryImpl::StreamData> stream_;
+
+  DISALLOW_COPY_AND_ASSIGN(StreamDataIOBuffer);
+};
+
 // Returns NetLog parameters for the creation of a MemEntryImpl. A separate
 // function is needed because child entries don't store their key().
 std::unique_ptr<base::Value> NetLogEntryCreationCallback(
@@ -86,6 +104,13 @@ std::unique_ptr<base::Value> NetLogEntryCreationCallback(
 
 }  // namespace
 
+MemEntryImpl::StreamData::StreamData() {}
+
+MemEntryImpl::StreamData::StreamData(const std::vector<char>& bytes)
+    : bytes_(bytes) {}
+
+MemEntryImpl::StreamData::~StreamData() {}
+
 MemEntryImpl::MemEntryImpl(MemBackendImpl* backend,
                            const std::string& key,
                            net::NetLog* net_log)
@@ -129,8 +154,10 @@ bool MemEntryImpl::InUse() const {
 
 int MemEntryImpl::GetStorageSize() const {
   int storage_size = static_cast<int32_t>(key_.size());
-  for (const auto& i : data_)
-    storage_size += i.size();
+  for (const auto& stream : data_) {
+    if (stream)
+      storage_size += stream->bytes().size();
+  }
   return storage_size;
 }
 
@@ -176,9 +203,9 @@ Time MemEntryImpl::GetLastModified() const {
 }
 
 int32_t MemEntryImpl::GetDataSize(int index) const {
-  if (index < 0 || index >= kNumStreams)
+  if (index < 0 || index >= kNumStreams || !data_[index])
     return 0;
-  return data_[index].size();
+  return data_[index]->bytes().size();
 }
 
 int MemEntryImpl::ReadData(int index, int offset, IOBuffer* buf, int buf_len,
@@ -272,9 +299,27 @@ int MemEntryImpl::ReadyForSparseIO(const CompletionCallback& callback) {
 size_t MemEntryImpl::EstimateMemoryUsage() const {
   // Subtlety: the entries in children_ are not double counted, as the entry
   // pointers won't be followed by EstimateMemoryUsage.
-  return base::trace_event::EstimateMemoryUsage(data_) +
-         base::trace_event::EstimateMemoryUsage(key_) +
-         base::trace_event::EstimateMemoryUsage(children_);
+  size_t usage = base::trace_event::EstimateMemoryUsage(key_) +
+                 base::trace_event::EstimateMemoryUsage(children_);
+  for (const auto& stream : data_) {
+    if (stream)
+      usage += base::trace_event::EstimateMemoryUsage(stream->bytes());
+  }
+  return usage;
+}
+
+scoped_refptr<net::IOBuffer> MemEntryImpl::GetZeroCopyData(int index,
+                                                           int* out_len) {
+  DCHECK(out_len);
+  *out_len = 0;
+  if (index < 0 || index >= kNumStreams)
+    return nullptr;
+  if (!data_[index] || data_[index]->bytes().empty())
+    return nullptr;
+
+  UpdateStateOnUse(ENTRY_WAS_NOT_MODIFIED);
+  *out_len = data_[index]->bytes().size();
+  return new StreamDataIOBuffer(data_[index]);
 }
 
 // ------------------------------------------------------------------------
@@ -328,7 +373,7 @@ int MemEntryImpl::InternalReadData(int index, int offset, IOBuffer* buf,
   if (index < 0 || index >= kNumStreams || buf_len < 0)
     return net::ERR_INVALID_ARGUMENT;
 
-  int entry_size = data_[index].size();
+  int entry_size = GetDataSize(index);
   if (offset >= entry_size || offset < 0 || !buf_len)
     return 0;
 
@@ -336,8 +381,9 @@ int MemEntryImpl::InternalReadData(int index, int offset, IOBuffer* buf,
     buf_len = entry_size - offset;
 
   UpdateStateOnUse(ENTRY_WAS_NOT_MODIFIED);
-  std::copy(data_[index].begin() + offset,
-            data_[index].begin() + offset + buf_len, buf->data());
+  const std::vector<char>& bytes = data_[index]->bytes();
+  std::copy(bytes.begin() + offset, bytes.begin() + offset + buf_len,
+            buf->data());
   return buf_len;
 }
 
@@ -364,7 +410,7 @@ int MemEntryImpl::InternalWriteData(int index, int offset, IOBuffer* buf,
     return net::ERR_FAILED;
   }
 
-  int old_data_size = data_[index].size();
+  int old_data_size = GetDataSize(index);
   if (truncate || old_data_size < offset + buf_len) {
     int delta = offset + buf_len - old_data_size;
     backend_->ModifyStorageSize(delta);
@@ -374,13 +420,12 @@ int MemEntryImpl::InternalWriteData(int index, int offset, IOBuffer* buf,
       return net::ERR_INSUFFICIENT_RESOURCES;
     }
 
-    data_[index].resize(offset + buf_len);
+    std::vector<char>& bytes = MutableStreamBytes(index);
+    bytes.resize(offset + buf_len);
 
     // Zero fill any hole.
-    if (old_data_size < offset) {
-      std::fill(data_[index].begin() + old_data_size,
-                data_[index].begin() + offset, 0);
-    }
+    if (old_data_size < offset)
+      std::fill(bytes.begin() + old_data_size, bytes.begin() + offset, 0);
   }
 
   UpdateStateOnUse(ENTRY_WAS_MODIFIED);
@@ -389,7 +434,8 @@ int MemEntryImpl::InternalWriteData(int index, int offset, IOBuffer* buf,
   if (!buf_len)
     return 0;
 
-  std::copy(buf->data(), buf->data() + buf_len, data_[index].begin() + offset);
+  std::vector<char>& bytes = MutableStreamBytes(index);
+  std::copy(buf->data(), buf->data() + buf_len, bytes.begin() + offset);
   return buf_len;
 }
 
@@ -589,6 +635,17 @@ MemEntryImpl* MemEntryImpl::GetChild(int64_t offset, bool create) {
   return nullptr;
 }
 
+std::vector<char>& MemEntryImpl::MutableStreamBytes(int index) {
+  if (!data_[index]) {
+    data_[index] = new StreamData();
+  } else if (!data_[index]->HasOneRef()) {
+    // Copy-on-write: a GetZeroCopyData() consumer still references the
+    // current bytes, so it must keep seeing them unchanged.
+    data_[index] = new StreamData(data_[index]->bytes());
+  }
+  return data_[index]->bytes();
+}
+
 int MemEntryImpl::FindNextChild(int64_t offset, int len, MemEntryImpl** child) {
   DCHECK(child);
   *child = nullptr;
@@ -15,6 +15,7 @@
 #include "base/containers/linked_list.h"
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/time/time.h"
 #include "base/trace_event/memory_usage_estimator.h"
 #include "net/base/net_export.h"
@@ -60,6 +61,28 @@ class NET_EXPORT_PRIVATE MemEntryImpl final
     : public Entry,
       public base::LinkNode<MemEntryImpl> {
  public:
+  // Refcounted storage for one data stream. GetZeroCopyData() hands out
+  // references to this object, so the bytes stay valid after the entry is
+  // modified, doomed or destroyed: writes copy the stream before mutating
+  // it whenever somebody else still holds a reference.
+  class NET_EXPORT_PRIVATE StreamData
+      : public base::RefCountedThreadSafe<StreamData> {
+   public:
+    StreamData();
+    explicit StreamData(const std::vector<char>& bytes);
+
+    std::vector<char>& bytes() { return bytes_; }
+    const std::vector<char>& bytes() const { return bytes_; }
+
+   private:
+    friend class base::RefCountedThreadSafe<StreamData>;
+    ~StreamData();
+
+    std::vector<char> bytes_;
+
+    DISALLOW_COPY_AND_ASSIGN(StreamData);
+  };
+
   enum EntryType {
     PARENT_ENTRY,
     CHILD_ENTRY,
@@ -131,6 +154,7 @@ class NET_EXPORT_PRIVATE MemEntryImpl final
   bool CouldBeSparse() const override;
   void CancelSparseIO() override {}
   int ReadyForSparseIO(const CompletionCallback& callback) override;
+  scoped_refptr<IOBuffer> GetZeroCopyData(int index, int* out_len) override;
   size_t EstimateMemoryUsage() const;
 
  private:
@@ -170,8 +194,14 @@ class NET_EXPORT_PRIVATE MemEntryImpl final
   // bytes in the entry. The first child found is output to |child|.
   int FindNextChild(int64_t offset, int len, MemEntryImpl** child);
 
+  // Returns the bytes of the given stream for writing, creating the stream
+  // if it does not exist yet and copying it first if a GetZeroCopyData()
+  // consumer still references it.
+  std::vector<char>& MutableStreamBytes(int index);
+
   std::string key_;
-  std::vector<char> data_[kNumStreams];  // User data.
+  // User data; a NULL stream is empty.
+  scoped_refptr<StreamData> data_[kNumStreams];
   int ref_count_;
 
   int child_id_;              // The ID of a child entry.
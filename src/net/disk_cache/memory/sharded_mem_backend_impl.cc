@@ -0,0 +1,205 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/memory/sharded_mem_backend_impl.h"
+
+#include <utility>
+
+#include "base/hash.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "net/base/net_errors.h"
+
+using base::Time;
+
+namespace disk_cache {
+
+ShardedMemBackendImpl::ShardedMemBackendImpl(int num_shards,
+                                             net::NetLog* net_log)
+    : net_log_(net_log), weak_factory_(this) {
+  DCHECK_GT(num_shards, 0);
+  for (int i = 0; i < num_shards; ++i)
+    shards_.push_back(base::MakeUnique<MemBackendImpl>(net_log));
+}
+
+ShardedMemBackendImpl::~ShardedMemBackendImpl() {}
+
+// static
+std::unique_ptr<ShardedMemBackendImpl> ShardedMemBackendImpl::CreateBackend(
+    int max_bytes,
+    int num_shards,
+    net::NetLog* net_log) {
+  if (num_shards <= 0 || max_bytes < 0)
+    return nullptr;
+  std::unique_ptr<ShardedMemBackendImpl> cache(
+      base::MakeUnique<ShardedMemBackendImpl>(num_shards, net_log));
+  if (!cache->SetMaxSize(max_bytes) || !cache->Init()) {
+    LOG(ERROR) << "Unable to create sharded memory cache";
+    return nullptr;
+  }
+  return cache;
+}
+
+bool ShardedMemBackendImpl::Init() {
+  for (const auto& shard : shards_) {
+    if (!shard->Init())
+      return false;
+  }
+  return true;
+}
+
+bool ShardedMemBackendImpl::SetMaxSize(int max_bytes) {
+  if (max_bytes < 0)
+    return false;
+  // Zero means every shard picks its own default.
+  int per_shard_bytes = max_bytes / num_shards();
+  for (const auto& shard : shards_) {
+    if (!shard->SetMaxSize(per_shard_bytes))
+      return false;
+  }
+  return true;
+}
+
+net::CacheType ShardedMemBackendImpl::GetCacheType() const {
+  return net::MEMORY_CACHE;
+}
+
+int32_t ShardedMemBackendImpl::GetEntryCount() const {
+  int32_t count = 0;
+  for (const auto& shard : shards_)
+    count += shard->GetEntryCount();
+  return count;
+}
+
+int ShardedMemBackendImpl::OpenEntry(const std::string& key,
+                                     Entry** entry,
+                                     const CompletionCallback& callback) {
+  return ShardForKey(key)->OpenEntry(key, entry, callback);
+}
+
+int ShardedMemBackendImpl::CreateEntry(const std::string& key,
+                                       Entry** entry,
+                                       const CompletionCallback& callback) {
+  return ShardForKey(key)->CreateEntry(key, entry, callback);
+}
+
+int ShardedMemBackendImpl::DoomEntry(const std::string& key,
+                                     const CompletionCallback& callback) {
+  return ShardForKey(key)->DoomEntry(key, callback);
+}
+
+int ShardedMemBackendImpl::DoomAllEntries(const CompletionCallback& callback) {
+  return DoomEntriesBetween(Time(), Time(), callback);
+}
+
+int ShardedMemBackendImpl::DoomEntriesBetween(
+    Time initial_time,
+    Time end_time,
+    const CompletionCallback& callback) {
+  for (const auto& shard : shards_) {
+    int result = shard->DoomEntriesBetween(initial_time, end_time, callback);
+    if (result != net::OK)
+      return result;
+  }
+  return net::OK;
+}
+
+int ShardedMemBackendImpl::DoomEntriesSince(
+    Time initial_time,
+    const CompletionCallback& callback) {
+  return DoomEntriesBetween(initial_time, Time::Max(), callback);
+}
+
+int ShardedMemBackendImpl::CalculateSizeOfAllEntries(
+    const CompletionCallback& callback) {
+  int size = 0;
+  for (const auto& shard : shards_)
+    size += shard->CalculateSizeOfAllEntries(callback);
+  return size;
+}
+
+int ShardedMemBackendImpl::CalculateSizeOfEntriesBetween(
+    base::Time initial_time,
+    base::Time end_time,
+    const CompletionCallback& callback) {
+  int size = 0;
+  for (const auto& shard : shards_) {
+    size +=
+        shard->CalculateSizeOfEntriesBetween(initial_time, end_time, callback);
+  }
+  return size;
+}
+
+// Enumerates the shards in order, draining each shard's own iterator before
+// moving to the next.
+class ShardedMemBackendImpl::ShardedMemIterator final
+    : public Backend::Iterator {
+ public:
+  explicit ShardedMemIterator(base::WeakPtr<ShardedMemBackendImpl> backend)
+      : backend_(backend), shard_index_(0) {}
+
+  int OpenNextEntry(Entry** next_entry,
+                    const CompletionCallback& callback) override {
+    if (!backend_)
+      return net::ERR_FAILED;
+
+    while (shard_index_ < backend_->num_shards()) {
+      if (!shard_iterator_) {
+        shard_iterator_ =
+            backend_->shards_[shard_index_]->CreateIterator();
+      }
+      int result = shard_iterator_->OpenNextEntry(next_entry, callback);
+      if (result != net::ERR_FAILED)
+        return result;
+      // This shard is exhausted; move to the next one.
+      shard_iterator_.reset();
+      ++shard_index_;
+    }
+    *next_entry = nullptr;
+    return net::ERR_FAILED;
+  }
+
+ private:
+  base::WeakPtr<ShardedMemBackendImpl> backend_;
+  int shard_index_;
+  std::unique_ptr<Backend::Iterator> shard_iterator_;
+};
+
+std::unique_ptr<Backend::Iterator> ShardedMemBackendImpl::CreateIterator() {
+  return std::unique_ptr<Backend::Iterator>(
+      new ShardedMemIterator(weak_factory_.GetWeakPtr()));
+}
+
+void ShardedMemBackendImpl::GetStats(base::StringPairs* stats) {
+  stats->push_back(
+      std::make_pair("Shard count", base::IntToString(num_shards())));
+  for (int i = 0; i < num_shards(); ++i) {
+    stats->push_back(std::make_pair(
+        "Shard " + base::IntToString(i) + " entries",
+        base::IntToString(shards_[i]->GetEntryCount())));
+  }
+}
+
+void ShardedMemBackendImpl::OnExternalCacheHit(const std::string& key) {
+  ShardForKey(key)->OnExternalCacheHit(key);
+}
+
+size_t ShardedMemBackendImpl::DumpMemoryStats(
+    base::trace_event::ProcessMemoryDump* pmd,
+    const std::string& parent_absolute_name) const {
+  size_t size = 0;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    size += shards_[i]->DumpMemoryStats(
+        pmd, parent_absolute_name + "/shard_" +
+                 base::SizeTToString(i));
+  }
+  return size;
+}
+
+MemBackendImpl* ShardedMemBackendImpl::ShardForKey(const std::string& key) {
+  return shards_[base::Hash(key) % shards_.size()].get();
+}
+
+}  // namespace disk_cache
@@ -42,6 +42,7 @@
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
 #include "net/disk_cache/simple/simple_index_file.h"
+#include "net/disk_cache/simple/simple_io_batcher.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "net/disk_cache/simple/simple_version_upgrade.h"
@@ -67,6 +68,12 @@ const char kThreadNamePrefix[] = "SimpleCache";
 // Maximum fraction of the cache that one entry can consume.
 const int kMaxFileRatio = 8;
 
+// Maximum number of entry read/write operations submitted to the worker
+// pool as one batch. Large enough to absorb the bursts the HTTP cache
+// issues within one IO-thread task, small enough that one batch cannot
+// monopolize a worker thread.
+const size_t kMaxIoBatchSize = 16;
+
 class LeakySequencedWorkerPool {
  public:
   LeakySequencedWorkerPool()
@@ -279,6 +286,8 @@ SimpleBackendImpl::~SimpleBackendImpl() {
 
 int SimpleBackendImpl::Init(const CompletionCallback& completion_callback) {
   worker_pool_ = g_sequenced_worker_pool.Get().GetTaskRunner();
+  io_batcher_ = base::MakeUnique<SimpleIoBatcher>(
+      worker_pool_, base::ThreadTaskRunnerHandle::Get(), kMaxIoBatchSize);
 
   index_ = base::MakeUnique<SimpleIndex>(
       base::ThreadTaskRunnerHandle::Get(), cleanup_tracker_.get(), this,
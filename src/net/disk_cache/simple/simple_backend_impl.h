@@ -50,6 +50,7 @@ namespace disk_cache {
 class BackendCleanupTracker;
 class SimpleEntryImpl;
 class SimpleIndex;
+class SimpleIoBatcher;
 
 class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
     public SimpleIndexDelegate,
@@ -70,6 +71,10 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
 
   base::TaskRunner* worker_pool() { return worker_pool_.get(); }
 
+  // Batches entry stream reads and writes onto the worker pool. Created in
+  // Init(); null before that.
+  SimpleIoBatcher* io_batcher() { return io_batcher_.get(); }
+
   int Init(const CompletionCallback& completion_callback);
 
   // Sets the maximum size for the total amount of data stored by this instance.
@@ -223,6 +228,7 @@ class NET_EXPORT_PRIVATE SimpleBackendImpl : public Backend,
   std::unique_ptr<SimpleIndex> index_;
   const scoped_refptr<base::SequencedTaskRunner> cache_runner_;
   scoped_refptr<base::TaskRunner> worker_pool_;
+  std::unique_ptr<SimpleIoBatcher> io_batcher_;
 
   int orig_max_size_;
   const SimpleEntryImpl::OperationsMode entry_operations_mode_;
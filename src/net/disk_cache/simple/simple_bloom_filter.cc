@@ -0,0 +1,107 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_bloom_filter.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "net/disk_cache/simple/simple_util.h"
+
+namespace disk_cache {
+namespace {
+
+const uint32_t kSerializedFormatVersion = 1;
+
+// Never size a filter below this, so tiny caches still get a meaningful
+// false positive rate.
+const size_t kMinBitCount = 1024;
+
+size_t RoundUpToPowerOfTwo(size_t value) {
+  size_t result = 1;
+  while (result < value)
+    result *= 2;
+  return result;
+}
+
+}  // namespace
+
+SimpleBloomFilter::SimpleBloomFilter(size_t bit_count)
+    : bits_(RoundUpToPowerOfTwo(std::max(bit_count, kMinBitCount)) / 8, 0) {}
+
+SimpleBloomFilter::~SimpleBloomFilter() {}
+
+void SimpleBloomFilter::Insert(uint64_t entry_hash) {
+  for (int i = 0; i < kNumProbes; ++i) {
+    const size_t bit = BitForProbe(entry_hash, i);
+    bits_[bit / 8] |= 1 << (bit % 8);
+  }
+}
+
+bool SimpleBloomFilter::MayContain(uint64_t entry_hash) const {
+  for (int i = 0; i < kNumProbes; ++i) {
+    const size_t bit = BitForProbe(entry_hash, i);
+    if (!(bits_[bit / 8] & (1 << (bit % 8))))
+      return false;
+  }
+  return true;
+}
+
+void SimpleBloomFilter::Clear() {
+  memset(bits_.data(), 0, bits_.size());
+}
+
+void SimpleBloomFilter::Serialize(std::string* output) const {
+  base::Pickle pickle;
+  pickle.WriteUInt32(kSerializedFormatVersion);
+  pickle.WriteUInt64(bit_count());
+  pickle.WriteData(reinterpret_cast<const char*>(bits_.data()), bits_.size());
+  pickle.WriteUInt32(simple_util::Crc32(
+      reinterpret_cast<const char*>(bits_.data()), bits_.size()));
+  output->append(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+bool SimpleBloomFilter::Deserialize(base::StringPiece data) {
+  base::Pickle pickle(data.data(), data.size());
+  base::PickleIterator it(pickle);
+  uint32_t version;
+  uint64_t bit_count;
+  const char* filter_data;
+  int filter_data_length;
+  uint32_t crc;
+  if (!it.ReadUInt32(&version) || version != kSerializedFormatVersion ||
+      !it.ReadUInt64(&bit_count) ||
+      !it.ReadData(&filter_data, &filter_data_length) ||
+      !it.ReadUInt32(&crc)) {
+    return false;
+  }
+  if (bit_count == 0 || (bit_count & (bit_count - 1)) != 0 ||
+      bit_count != static_cast<uint64_t>(filter_data_length) * 8) {
+    return false;
+  }
+  if (crc != simple_util::Crc32(filter_data, filter_data_length))
+    return false;
+  bits_.assign(filter_data, filter_data + filter_data_length);
+  return true;
+}
+
+// static
+size_t SimpleBloomFilter::RecommendedBitCount(size_t entry_count) {
+  return std::max(kMinBitCount, entry_count * 8);
+}
+
+size_t SimpleBloomFilter::BitForProbe(uint64_t entry_hash,
+                                      int probe_index) const {
+  // Double hashing on the two halves of the entry hash; the halves are
+  // already well mixed, so no further hashing is needed. Forcing |h2| odd
+  // makes each probe sequence cover the whole (power of two sized) filter.
+  const uint32_t h1 = static_cast<uint32_t>(entry_hash);
+  const uint32_t h2 = static_cast<uint32_t>(entry_hash >> 32) | 1;
+  return (h1 + static_cast<uint32_t>(probe_index) * h2) & (bit_count() - 1);
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,70 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_BLOOM_FILTER_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_BLOOM_FILTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// A Bloom filter over entry key hashes, used to answer "certainly not
+// cached" in a few cache-line probes before the index's hash map or the
+// disk is consulted. Since most lookups on a typical cache are misses,
+// this is the common path.
+//
+// The filter never returns a false negative for a hash that was inserted.
+// Removal is not supported: doomed entries leave their bits set, which only
+// costs extra false positives until the filter is rebuilt from the index.
+class NET_EXPORT_PRIVATE SimpleBloomFilter {
+ public:
+  // Creates a filter of at least |bit_count| bits, rounded up to a power of
+  // two so probes reduce to a mask.
+  explicit SimpleBloomFilter(size_t bit_count);
+  ~SimpleBloomFilter();
+
+  void Insert(uint64_t entry_hash);
+
+  // Returns false only if |entry_hash| was certainly never inserted.
+  bool MayContain(uint64_t entry_hash) const;
+
+  void Clear();
+
+  size_t bit_count() const { return bits_.size() * 8; }
+
+  // Appends the filter to |output| in a self-validating format.
+  void Serialize(std::string* output) const;
+
+  // Replaces this filter's contents with a previously serialized filter.
+  // Returns false and leaves the filter unchanged if |data| is truncated or
+  // corrupt.
+  bool Deserialize(base::StringPiece data);
+
+  // Returns the bit count to use for a cache of |entry_count| entries:
+  // 8 bits per entry, which with 4 probes keeps the false positive rate
+  // near 2%.
+  static size_t RecommendedBitCount(size_t entry_count);
+
+ private:
+  static const int kNumProbes = 4;
+
+  // Returns the bit position for probe |probe_index| of |entry_hash|.
+  size_t BitForProbe(uint64_t entry_hash, int probe_index) const;
+
+  std::vector<uint8_t> bits_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleBloomFilter);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_BLOOM_FILTER_H_
@@ -0,0 +1,91 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_bloom_filter.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace disk_cache {
+namespace {
+
+// An arbitrary multiplicative mixer to derive distinct test hashes.
+uint64_t TestHash(uint64_t seed) {
+  return seed * UINT64_C(0x9e3779b97f4a7c15);
+}
+
+TEST(SimpleBloomFilterTest, NoFalseNegatives) {
+  SimpleBloomFilter filter(SimpleBloomFilter::RecommendedBitCount(1000));
+  for (uint64_t i = 0; i < 1000; ++i)
+    filter.Insert(TestHash(i));
+  for (uint64_t i = 0; i < 1000; ++i)
+    EXPECT_TRUE(filter.MayContain(TestHash(i))) << i;
+}
+
+TEST(SimpleBloomFilterTest, FalsePositiveRateIsLow) {
+  SimpleBloomFilter filter(SimpleBloomFilter::RecommendedBitCount(1000));
+  for (uint64_t i = 0; i < 1000; ++i)
+    filter.Insert(TestHash(i));
+
+  int false_positives = 0;
+  const int kProbes = 10000;
+  for (uint64_t i = 1000; i < 1000 + kProbes; ++i) {
+    if (filter.MayContain(TestHash(i)))
+      ++false_positives;
+  }
+  // 8 bits per entry with 4 probes gives ~2%; leave headroom for hash luck.
+  EXPECT_LT(false_positives, kProbes / 20);
+}
+
+TEST(SimpleBloomFilterTest, ClearEmptiesTheFilter) {
+  SimpleBloomFilter filter(1024);
+  filter.Insert(TestHash(7));
+  EXPECT_TRUE(filter.MayContain(TestHash(7)));
+  filter.Clear();
+  EXPECT_FALSE(filter.MayContain(TestHash(7)));
+}
+
+TEST(SimpleBloomFilterTest, BitCountRoundsUpToPowerOfTwo) {
+  SimpleBloomFilter filter(1500);
+  EXPECT_EQ(2048u, filter.bit_count());
+  // Tiny filters are clamped to a useful minimum.
+  SimpleBloomFilter tiny_filter(1);
+  EXPECT_EQ(1024u, tiny_filter.bit_count());
+}
+
+TEST(SimpleBloomFilterTest, SerializeRoundTrip) {
+  SimpleBloomFilter filter(4096);
+  for (uint64_t i = 0; i < 100; ++i)
+    filter.Insert(TestHash(i));
+
+  std::string serialized;
+  filter.Serialize(&serialized);
+
+  SimpleBloomFilter restored(1024);
+  ASSERT_TRUE(restored.Deserialize(serialized));
+  EXPECT_EQ(filter.bit_count(), restored.bit_count());
+  for (uint64_t i = 0; i < 100; ++i)
+    EXPECT_TRUE(restored.MayContain(TestHash(i))) << i;
+  EXPECT_FALSE(restored.MayContain(TestHash(54321)));
+}
+
+TEST(SimpleBloomFilterTest, CorruptSerializationIsRejected) {
+  SimpleBloomFilter filter(1024);
+  filter.Insert(TestHash(1));
+  std::string serialized;
+  filter.Serialize(&serialized);
+
+  std::string truncated = serialized.substr(0, serialized.size() / 2);
+  std::string flipped = serialized;
+  flipped[flipped.size() / 2] ^= 0xff;
+
+  SimpleBloomFilter restored(1024);
+  EXPECT_FALSE(restored.Deserialize(truncated));
+  EXPECT_FALSE(restored.Deserialize(flipped));
+  EXPECT_FALSE(restored.Deserialize(base::StringPiece()));
+}
+
+}  // namespace
+}  // namespace disk_cache
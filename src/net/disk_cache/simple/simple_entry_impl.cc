@@ -29,6 +29,7 @@
 #include "net/disk_cache/simple/simple_histogram_enums.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
 #include "net/disk_cache/simple/simple_index.h"
+#include "net/disk_cache/simple/simple_io_batcher.h"
 #include "net/disk_cache/simple/simple_net_log_parameters.h"
 #include "net/disk_cache/simple/simple_synchronous_entry.h"
 #include "net/disk_cache/simple/simple_util.h"
@@ -224,7 +225,11 @@ int SimpleEntryImpl::OpenEntry(Entry** out_entry,
     INDEX_MAX = 3,
   };
   OpenEntryIndexEnum open_entry_index_enum = INDEX_NOEXIST;
-  if (have_index) {
+  if (!backend_->index()->MayHave(entry_hash_)) {
+    // The Bloom filter never gives a false negative, so this is a certain
+    // miss proved in a few cache-line probes.
+    open_entry_index_enum = INDEX_MISS;
+  } else if (have_index) {
     if (backend_->index()->Has(entry_hash_))
       open_entry_index_enum = INDEX_HIT;
     else
@@ -476,6 +481,31 @@ int SimpleEntryImpl::WriteData(int stream_index,
   return ret_value;
 }
 
+void SimpleEntryImpl::Preload(int stream_index, int offset, int length) {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  if (stream_index <= 0 || stream_index >= kSimpleEntryStreamCount ||
+      offset < 0) {
+    // Stream 0 is kept in memory once the entry is open, so only the
+    // file-backed streams benefit from warming the page cache.
+    return;
+  }
+  const int file_index = simple_util::GetFileIndexFromStreamIndex(stream_index);
+  const base::FilePath file_path = path_.AppendASCII(
+      simple_util::GetFilenameFromEntryHashAndFileIndex(entry_hash_,
+                                                        file_index));
+  // In each file, stream data begins right after the header and key, so the
+  // stream offset translates to a fixed file offset. A zero length asks
+  // posix_fadvise for everything through the end of the file, which is the
+  // whole-entry readahead mode.
+  const int64_t file_offset = simple_util::GetHeaderSize(key_.size()) + offset;
+  const int64_t file_length = length < 0 ? 0 : length;
+  // The hint bypasses the operation queue on purpose: it orders with nothing
+  // and must not delay real IO behind it.
+  worker_pool_->PostTask(
+      FROM_HERE, base::Bind(base::IgnoreResult(&simple_util::PreloadFileRange),
+                            file_path, file_offset, file_length));
+}
+
 int SimpleEntryImpl::ReadSparseData(int64_t offset,
                                     net::IOBuffer* buf,
                                     int buf_len,
@@ -890,7 +920,14 @@ void SimpleEntryImpl::ReadDataInternal(int stream_index,
       base::Bind(&SimpleEntryImpl::ReadOperationComplete, this, stream_index,
                  offset, callback, base::Passed(&crc_request),
                  base::Passed(&entry_stat), base::Passed(&result));
-  worker_pool_->PostTaskAndReply(FROM_HERE, task, reply);
+  // Submit through the backend's batcher so a burst of reads across entries
+  // costs one worker-pool handoff. Doomed entries can outlive the backend;
+  // they fall back to a direct handoff.
+  if (backend_.get()) {
+    backend_->io_batcher()->PostOperation(task, reply);
+  } else {
+    worker_pool_->PostTaskAndReply(FROM_HERE, task, reply);
+  }
 }
 
 void SimpleEntryImpl::WriteDataInternal(int stream_index,
@@ -985,7 +1022,11 @@ void SimpleEntryImpl::WriteDataInternal(int stream_index,
   Closure reply = base::Bind(&SimpleEntryImpl::WriteOperationComplete, this,
                              stream_index, callback, base::Passed(&entry_stat),
                              base::Passed(&result), base::RetainedRef(buf));
-  worker_pool_->PostTaskAndReply(FROM_HERE, task, reply);
+  if (backend_.get()) {
+    backend_->io_batcher()->PostOperation(task, reply);
+  } else {
+    worker_pool_->PostTaskAndReply(FROM_HERE, task, reply);
+  }
 }
 
 void SimpleEntryImpl::ReadSparseDataInternal(
@@ -109,6 +109,7 @@ class NET_EXPORT_PRIVATE SimpleEntryImpl : public Entry,
                 int buf_len,
                 const CompletionCallback& callback,
                 bool truncate) override;
+  void Preload(int stream_index, int offset, int length) override;
   int ReadSparseData(int64_t offset,
                      net::IOBuffer* buf,
                      int buf_len,
@@ -0,0 +1,210 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_flat_index_file.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/numerics/safe_conversions.h"
+#include "net/disk_cache/simple/simple_util.h"
+
+namespace disk_cache {
+namespace {
+
+static_assert(sizeof(SimpleFlatIndexFile::Header) == 64,
+              "flat index header must stay a single cache line");
+static_assert(sizeof(SimpleFlatIndexFile::Slot) == 24,
+              "flat index slot size is part of the on-disk format");
+
+// The table never fills beyond this load factor, which keeps linear probe
+// chains short and guarantees lookups terminate at an empty slot.
+const uint64_t kMaxLoadFactorDenominator = 2;
+
+// Smallest table we ever write; avoids degenerate capacities for tiny
+// caches.
+const uint64_t kMinTableCapacity = 64;
+
+uint32_t CalculateHeaderCRC(const SimpleFlatIndexFile::Header& header) {
+  return simple_util::Crc32(reinterpret_cast<const char*>(&header),
+                            offsetof(SimpleFlatIndexFile::Header, header_crc));
+}
+
+base::Time LastUsedTimeFromRaw(uint32_t raw_seconds) {
+  // Matches EntryMetadata: zero encodes the null time.
+  if (raw_seconds == 0)
+    return base::Time();
+  return base::Time::UnixEpoch() + base::TimeDelta::FromSeconds(raw_seconds);
+}
+
+}  // namespace
+
+SimpleFlatIndexFile::SimpleFlatIndexFile() {}
+
+SimpleFlatIndexFile::~SimpleFlatIndexFile() {}
+
+bool SimpleFlatIndexFile::Initialize(const base::FilePath& index_filename) {
+  DCHECK(!mapped_file_);
+  std::unique_ptr<base::MemoryMappedFile> mapped_file(
+      new base::MemoryMappedFile());
+  if (!mapped_file->Initialize(index_filename))
+    return false;
+  if (mapped_file->length() < sizeof(Header)) {
+    LOG(WARNING) << "Flat index file too small to hold a header.";
+    return false;
+  }
+  const Header* header =
+      reinterpret_cast<const Header*>(mapped_file->data());
+  if (header->magic_number != kSimpleFlatIndexMagicNumber ||
+      header->version != kVersion) {
+    LOG(WARNING) << "Flat index file has unrecognized magic or version.";
+    return false;
+  }
+  if (header->header_crc != CalculateHeaderCRC(*header)) {
+    LOG(WARNING) << "Flat index file header CRC mismatch.";
+    return false;
+  }
+  const uint64_t capacity = header->table_capacity;
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+      header->entry_count > capacity / kMaxLoadFactorDenominator) {
+    LOG(WARNING) << "Flat index file has an implausible table shape.";
+    return false;
+  }
+  if (mapped_file->length() != sizeof(Header) + capacity * sizeof(Slot)) {
+    LOG(WARNING) << "Flat index file length does not match its header.";
+    return false;
+  }
+  mapped_file_ = std::move(mapped_file);
+  return true;
+}
+
+bool SimpleFlatIndexFile::Lookup(uint64_t entry_hash,
+                                 EntryMetadata* out_entry_metadata) const {
+  DCHECK(mapped_file_);
+  const uint64_t mask = header()->table_capacity - 1;
+  uint64_t index = entry_hash & mask;
+  // The load factor guarantees an empty slot; the probe bound only guards
+  // against a corrupt (fully occupied) table.
+  for (uint64_t probes = 0; probes <= mask; ++probes) {
+    const Slot& slot = slots()[index];
+    if (slot.state == kSlotEmpty)
+      return false;
+    if (slot.entry_hash == entry_hash) {
+      if (out_entry_metadata) {
+        *out_entry_metadata = EntryMetadata(
+            LastUsedTimeFromRaw(slot.last_used_time_seconds_since_epoch),
+            slot.entry_size);
+      }
+      return true;
+    }
+    index = (index + 1) & mask;
+  }
+  return false;
+}
+
+void SimpleFlatIndexFile::GetAllEntries(
+    SimpleIndex::EntrySet* out_entries) const {
+  DCHECK(mapped_file_);
+  const uint64_t capacity = header()->table_capacity;
+  for (uint64_t i = 0; i < capacity; ++i) {
+    const Slot& slot = slots()[i];
+    if (slot.state != kSlotOccupied)
+      continue;
+    SimpleIndex::InsertInEntrySet(
+        slot.entry_hash,
+        EntryMetadata(
+            LastUsedTimeFromRaw(slot.last_used_time_seconds_since_epoch),
+            slot.entry_size),
+        out_entries);
+  }
+}
+
+uint64_t SimpleFlatIndexFile::entry_count() const {
+  DCHECK(mapped_file_);
+  return header()->entry_count;
+}
+
+uint64_t SimpleFlatIndexFile::cache_size() const {
+  DCHECK(mapped_file_);
+  return header()->cache_size;
+}
+
+base::Time SimpleFlatIndexFile::cache_last_modified() const {
+  DCHECK(mapped_file_);
+  return base::Time::FromInternalValue(header()->cache_last_modified_us);
+}
+
+// static
+bool SimpleFlatIndexFile::SyncWriteToDisk(
+    const base::FilePath& index_filename,
+    const base::FilePath& temp_index_filename,
+    const SimpleIndex::EntrySet& entries,
+    uint64_t cache_size,
+    base::Time cache_last_modified) {
+  const uint64_t capacity = TableCapacityForEntryCount(entries.size());
+  const size_t file_size = sizeof(Header) + capacity * sizeof(Slot);
+  std::vector<char> buffer(file_size, 0);
+
+  Header* header = reinterpret_cast<Header*>(buffer.data());
+  header->magic_number = kSimpleFlatIndexMagicNumber;
+  header->version = kVersion;
+  header->table_capacity = capacity;
+  header->entry_count = entries.size();
+  header->cache_size = cache_size;
+  header->cache_last_modified_us = cache_last_modified.ToInternalValue();
+  header->header_crc = CalculateHeaderCRC(*header);
+
+  Slot* slots = reinterpret_cast<Slot*>(buffer.data() + sizeof(Header));
+  const uint64_t mask = capacity - 1;
+  for (const auto& hash_and_metadata : entries) {
+    uint64_t index = hash_and_metadata.first & mask;
+    while (slots[index].state != kSlotEmpty)
+      index = (index + 1) & mask;
+    Slot* slot = &slots[index];
+    slot->entry_hash = hash_and_metadata.first;
+    slot->last_used_time_seconds_since_epoch =
+        hash_and_metadata.second.RawTimeForSorting();
+    slot->entry_size = hash_and_metadata.second.GetEntrySize();
+    slot->state = kSlotOccupied;
+  }
+
+  int bytes_written = base::WriteFile(temp_index_filename, buffer.data(),
+                                      base::checked_cast<int>(file_size));
+  if (bytes_written != base::checked_cast<int>(file_size)) {
+    LOG(ERROR) << "Failed to write the temporary flat index file.";
+    base::DeleteFile(temp_index_filename, /* recursive = */ false);
+    return false;
+  }
+  if (!base::ReplaceFile(temp_index_filename, index_filename, NULL)) {
+    LOG(ERROR) << "Failed to replace the flat index file.";
+    base::DeleteFile(index_filename, /* recursive = */ false);
+    base::DeleteFile(temp_index_filename, /* recursive = */ false);
+    return false;
+  }
+  return true;
+}
+
+// static
+uint64_t SimpleFlatIndexFile::TableCapacityForEntryCount(
+    uint64_t entry_count) {
+  uint64_t capacity = kMinTableCapacity;
+  while (capacity < entry_count * kMaxLoadFactorDenominator)
+    capacity *= 2;
+  return capacity;
+}
+
+const SimpleFlatIndexFile::Header* SimpleFlatIndexFile::header() const {
+  return reinterpret_cast<const Header*>(mapped_file_->data());
+}
+
+const SimpleFlatIndexFile::Slot* SimpleFlatIndexFile::slots() const {
+  return reinterpret_cast<const Slot*>(mapped_file_->data() +
+                                       sizeof(Header));
+}
+
+}  // namespace disk_cache
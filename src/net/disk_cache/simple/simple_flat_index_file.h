@@ -0,0 +1,114 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_FLAT_INDEX_FILE_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_FLAT_INDEX_FILE_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+#include "net/disk_cache/simple/simple_index.h"
+
+namespace disk_cache {
+
+const uint64_t kSimpleFlatIndexMagicNumber = UINT64_C(0x666c617420696478);
+
+// A flat, memory-mappable representation of the simple cache index.
+//
+// The pickle format read by SimpleIndexFile must be deserialized in full
+// into SimpleIndex's EntrySet before the backend can answer its first
+// lookup, which on large caches takes seconds after a cold start. This
+// format is instead usable directly from the mapping: a fixed-size header
+// followed by a power-of-two open-addressing hash table of fixed-size
+// slots, probed linearly on the entry hash. Opening the file is O(1) --
+// just map and validate the header -- and the page cache pulls table pages
+// in on demand as entries are looked up.
+//
+// All multi-byte fields are stored in host byte order; the index is a
+// local cache of local state and is rebuilt from the entry files whenever
+// it cannot be read back.
+class NET_EXPORT_PRIVATE SimpleFlatIndexFile {
+ public:
+  // On-disk file header. Kept to a single cache line.
+  struct Header {
+    uint64_t magic_number;
+    uint32_t version;
+    uint32_t unused;
+    uint64_t table_capacity;  // Number of slots; always a power of two.
+    uint64_t entry_count;     // Number of occupied slots.
+    uint64_t cache_size;      // Total cache storage size in bytes.
+    int64_t cache_last_modified_us;  // base::Time internal value.
+    uint32_t header_crc;  // Crc32 of all preceding header bytes.
+    uint32_t padding[3];
+  };
+
+  // One hash table slot. The |state| field disambiguates an empty slot from
+  // an occupied one, so no entry hash value needs to be reserved.
+  struct Slot {
+    uint64_t entry_hash;
+    uint32_t last_used_time_seconds_since_epoch;
+    uint32_t entry_size;
+    uint32_t state;  // kSlotEmpty or kSlotOccupied.
+    uint32_t padding;
+  };
+
+  enum SlotState : uint32_t {
+    kSlotEmpty = 0,
+    kSlotOccupied = 1,
+  };
+
+  static const uint32_t kVersion = 1;
+
+  SimpleFlatIndexFile();
+  ~SimpleFlatIndexFile();
+
+  // Maps |index_filename| and validates its header. Returns false (and
+  // leaves this object unusable) if the file is missing, truncated or
+  // corrupt; callers should then fall back to restoring the index from the
+  // cache directory.
+  bool Initialize(const base::FilePath& index_filename);
+
+  // Looks |entry_hash| up directly in the mapping. If found, returns true
+  // and fills |out_entry_metadata| when it is non-NULL.
+  bool Lookup(uint64_t entry_hash, EntryMetadata* out_entry_metadata) const;
+
+  // Inserts every indexed entry into |out_entries|, e.g. for the startup
+  // merge with entries created since the index was written.
+  void GetAllEntries(SimpleIndex::EntrySet* out_entries) const;
+
+  uint64_t entry_count() const;
+  uint64_t cache_size() const;
+  base::Time cache_last_modified() const;
+
+  // Serializes |entries| into the flat format and atomically replaces
+  // |index_filename|, staging through |temp_index_filename|. Returns false
+  // and removes both files on failure.
+  static bool SyncWriteToDisk(const base::FilePath& index_filename,
+                              const base::FilePath& temp_index_filename,
+                              const SimpleIndex::EntrySet& entries,
+                              uint64_t cache_size,
+                              base::Time cache_last_modified);
+
+  // Returns the slot count used for |entry_count| entries: the smallest
+  // power of two keeping the table at most half full. Exposed for tests.
+  static uint64_t TableCapacityForEntryCount(uint64_t entry_count);
+
+ private:
+  const Header* header() const;
+  const Slot* slots() const;
+
+  std::unique_ptr<base::MemoryMappedFile> mapped_file_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleFlatIndexFile);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_FLAT_INDEX_FILE_H_
@@ -0,0 +1,133 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_flat_index_file.h"
+
+#include <string>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/time/time.h"
+#include "net/disk_cache/simple/simple_index.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::Time;
+
+namespace disk_cache {
+namespace {
+
+class SimpleFlatIndexFileTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  base::FilePath index_path() const {
+    return temp_dir_.GetPath().AppendASCII("flat-index");
+  }
+
+  base::FilePath temp_index_path() const {
+    return temp_dir_.GetPath().AppendASCII("flat-index-temp");
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(SimpleFlatIndexFileTest, WriteThenLookup) {
+  SimpleIndex::EntrySet entries;
+  const Time now = Time::Now();
+  SimpleIndex::InsertInEntrySet(11, EntryMetadata(now, 100u), &entries);
+  SimpleIndex::InsertInEntrySet(22, EntryMetadata(now, 200u), &entries);
+  SimpleIndex::InsertInEntrySet(33, EntryMetadata(Time(), 300u), &entries);
+
+  ASSERT_TRUE(SimpleFlatIndexFile::SyncWriteToDisk(
+      index_path(), temp_index_path(), entries, /* cache_size = */ 600,
+      /* cache_last_modified = */ now));
+  EXPECT_FALSE(base::PathExists(temp_index_path()));
+
+  SimpleFlatIndexFile flat_index;
+  ASSERT_TRUE(flat_index.Initialize(index_path()));
+  EXPECT_EQ(3u, flat_index.entry_count());
+  EXPECT_EQ(600u, flat_index.cache_size());
+  EXPECT_EQ(now.ToInternalValue(),
+            flat_index.cache_last_modified().ToInternalValue());
+
+  EntryMetadata metadata;
+  ASSERT_TRUE(flat_index.Lookup(22, &metadata));
+  EXPECT_EQ(200u, metadata.GetEntrySize());
+  EXPECT_EQ(entries.find(22)->second.RawTimeForSorting(),
+            metadata.RawTimeForSorting());
+
+  // Null last-used times must survive the round trip as null.
+  ASSERT_TRUE(flat_index.Lookup(33, &metadata));
+  EXPECT_TRUE(metadata.GetLastUsedTime().is_null());
+
+  EXPECT_FALSE(flat_index.Lookup(44, NULL));
+}
+
+TEST_F(SimpleFlatIndexFileTest, CollidingHashesAllFound) {
+  // With the minimum capacity of 64 these hashes all probe from slot 1.
+  SimpleIndex::EntrySet entries;
+  const Time now = Time::Now();
+  const uint64_t kHashes[] = {1, 65, 129, 193};
+  for (uint64_t hash : kHashes)
+    SimpleIndex::InsertInEntrySet(hash, EntryMetadata(now, 10u), &entries);
+
+  ASSERT_TRUE(SimpleFlatIndexFile::SyncWriteToDisk(
+      index_path(), temp_index_path(), entries, 40, now));
+  SimpleFlatIndexFile flat_index;
+  ASSERT_TRUE(flat_index.Initialize(index_path()));
+  for (uint64_t hash : kHashes)
+    EXPECT_TRUE(flat_index.Lookup(hash, NULL)) << hash;
+  EXPECT_FALSE(flat_index.Lookup(257, NULL));
+
+  SimpleIndex::EntrySet read_back;
+  flat_index.GetAllEntries(&read_back);
+  EXPECT_EQ(entries.size(), read_back.size());
+  for (uint64_t hash : kHashes)
+    EXPECT_EQ(1u, read_back.count(hash));
+}
+
+TEST_F(SimpleFlatIndexFileTest, CorruptHeaderIsRejected) {
+  SimpleIndex::EntrySet entries;
+  SimpleIndex::InsertInEntrySet(11, EntryMetadata(Time::Now(), 100u),
+                                &entries);
+  ASSERT_TRUE(SimpleFlatIndexFile::SyncWriteToDisk(
+      index_path(), temp_index_path(), entries, 100, Time::Now()));
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(index_path(), &contents));
+  contents[20] ^= 0xff;  // Inside the header, past the magic number.
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(index_path(), contents.data(), contents.size()));
+
+  SimpleFlatIndexFile flat_index;
+  EXPECT_FALSE(flat_index.Initialize(index_path()));
+}
+
+TEST_F(SimpleFlatIndexFileTest, TruncatedFileIsRejected) {
+  SimpleIndex::EntrySet entries;
+  SimpleIndex::InsertInEntrySet(11, EntryMetadata(Time::Now(), 100u),
+                                &entries);
+  ASSERT_TRUE(SimpleFlatIndexFile::SyncWriteToDisk(
+      index_path(), temp_index_path(), entries, 100, Time::Now()));
+
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(index_path(), &contents));
+  contents.resize(contents.size() / 2);
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(index_path(), contents.data(), contents.size()));
+
+  SimpleFlatIndexFile flat_index;
+  EXPECT_FALSE(flat_index.Initialize(index_path()));
+}
+
+TEST_F(SimpleFlatIndexFileTest, TableCapacityKeepsTableAtMostHalfFull) {
+  EXPECT_EQ(64u, SimpleFlatIndexFile::TableCapacityForEntryCount(0));
+  EXPECT_EQ(64u, SimpleFlatIndexFile::TableCapacityForEntryCount(32));
+  EXPECT_EQ(128u, SimpleFlatIndexFile::TableCapacityForEntryCount(33));
+  EXPECT_EQ(1u << 21,
+            SimpleFlatIndexFile::TableCapacityForEntryCount(1000000));
+}
+
+}  // namespace
+}  // namespace disk_cache
@@ -25,6 +25,7 @@
 #include "base/trace_event/memory_usage_estimator.h"
 #include "net/base/net_errors.h"
 #include "net/disk_cache/backend_cleanup_tracker.h"
+#include "net/disk_cache/simple/simple_bloom_filter.h"
 #include "net/disk_cache/simple/simple_entry_format.h"
 #include "net/disk_cache/simple/simple_experiment.h"
 #include "net/disk_cache/simple/simple_histogram_macros.h"
@@ -268,6 +269,8 @@ void SimpleIndex::Insert(uint64_t entry_hash) {
   // creating the new entry, and then UpdateEntrySize will be called.
   InsertInEntrySet(entry_hash, EntryMetadata(base::Time::Now(), 0u),
                    &entries_set_);
+  if (bloom_filter_)
+    bloom_filter_->Insert(entry_hash);
   if (!initialized_)
     removed_entries_.erase(entry_hash);
   PostponeWritingToDisk();
@@ -292,6 +295,11 @@ bool SimpleIndex::Has(uint64_t hash) const {
   return !initialized_ || entries_set_.count(hash) > 0;
 }
 
+bool SimpleIndex::MayHave(uint64_t entry_hash) const {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  return !bloom_filter_ || bloom_filter_->MayContain(entry_hash);
+}
+
 bool SimpleIndex::UseIfExists(uint64_t entry_hash) {
   DCHECK(io_thread_checker_.CalledOnValidThread());
   // Always update the last used time, even if it is during initialization.
@@ -465,6 +473,15 @@ void SimpleIndex::MergeInitializingSet(
   initialized_ = true;
   init_method_ = load_result->init_method;
 
+  // (Re)build the Bloom filter over the merged set; Insert() keeps it
+  // current from here on.
+  bloom_filter_.reset(new SimpleBloomFilter(
+      SimpleBloomFilter::RecommendedBitCount(entries_set_.size())));
+  for (EntrySet::const_iterator it = entries_set_.begin();
+       it != entries_set_.end(); ++it) {
+    bloom_filter_->Insert(it->first);
+  }
+
   // The actual IO is asynchronous, so calling WriteToDisk() shouldn't slow the
   // merge down much.
   if (load_result->flush_required)
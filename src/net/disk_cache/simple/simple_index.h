@@ -39,6 +39,7 @@ class PickleIterator;
 namespace disk_cache {
 
 class BackendCleanupTracker;
+class SimpleBloomFilter;
 class SimpleIndexDelegate;
 class SimpleIndexFile;
 struct SimpleIndexLoadResult;
@@ -125,6 +126,12 @@ class NET_EXPORT_PRIVATE SimpleIndex
   // Check whether the index has the entry given the hash of its key.
   bool Has(uint64_t entry_hash) const;
 
+  // Returns false only if the entry is certainly absent. This is the Bloom
+  // filter front of the miss path: a few cache-line probes, no hash-map
+  // lookup, and usable before initialization completes. Returns true when
+  // the filter has not been built yet.
+  bool MayHave(uint64_t entry_hash) const;
+
   // Update the last used time of the entry with the given key and return true
   // iff the entry exist in the index.
   bool UseIfExists(uint64_t entry_hash);
@@ -214,6 +221,11 @@ class NET_EXPORT_PRIVATE SimpleIndex
 
   EntrySet entries_set_;
 
+  // Built over |entries_set_| when the initial merge completes and updated
+  // on every insert. Removals leave their bits set (extra false positives
+  // only), so MayHave() never returns a false negative.
+  std::unique_ptr<SimpleBloomFilter> bloom_filter_;
+
   const net::CacheType cache_type_;
   uint64_t cache_size_;  // Total cache storage size in bytes.
   uint64_t max_size_;
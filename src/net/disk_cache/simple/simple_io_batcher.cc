@@ -0,0 +1,92 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_io_batcher.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+
+namespace disk_cache {
+
+SimpleIoBatcher::SimpleIoBatcher(
+    const scoped_refptr<base::TaskRunner>& worker_pool,
+    const scoped_refptr<base::SingleThreadTaskRunner>& reply_runner,
+    size_t max_batch_size)
+    : worker_pool_(worker_pool),
+      reply_runner_(reply_runner),
+      max_batch_size_(max_batch_size),
+      flush_scheduled_(false),
+      num_batches_submitted_(0),
+      weak_factory_(this) {
+  DCHECK_GT(max_batch_size, 0u);
+}
+
+SimpleIoBatcher::~SimpleIoBatcher() {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  // Anything still pending has not been submitted; run no replies for it.
+  DCHECK(pending_operations_.empty()) << "destroyed with unsubmitted I/O";
+}
+
+void SimpleIoBatcher::PostOperation(const base::Closure& io_operation,
+                                    const base::Closure& reply) {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  Operation operation;
+  operation.io_operation = io_operation;
+  operation.reply = reply;
+  pending_operations_.push_back(operation);
+  if (pending_operations_.size() >= max_batch_size_) {
+    Flush();
+    return;
+  }
+  if (!flush_scheduled_) {
+    // Submit whatever the current IO-thread task leaves behind once it
+    // returns to the loop, so a lone operation is not delayed.
+    flush_scheduled_ = true;
+    reply_runner_->PostTask(FROM_HERE,
+                            base::Bind(&SimpleIoBatcher::OnScheduledFlush,
+                                       weak_factory_.GetWeakPtr()));
+  }
+}
+
+void SimpleIoBatcher::Flush() {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  if (pending_operations_.empty())
+    return;
+  std::unique_ptr<OperationBatch> batch(new OperationBatch());
+  batch->swap(pending_operations_);
+  ++num_batches_submitted_;
+  worker_pool_->PostTask(FROM_HERE,
+                         base::Bind(&SimpleIoBatcher::RunBatch,
+                                    base::Passed(&batch), reply_runner_));
+}
+
+// static
+void SimpleIoBatcher::RunBatch(
+    std::unique_ptr<OperationBatch> batch,
+    scoped_refptr<base::SingleThreadTaskRunner> reply_runner) {
+  for (const Operation& operation : *batch)
+    operation.io_operation.Run();
+  // One hop back carries every completion in the batch.
+  reply_runner->PostTask(FROM_HERE,
+                         base::Bind(&SimpleIoBatcher::DeliverReplies,
+                                    base::Passed(&batch)));
+}
+
+// static
+void SimpleIoBatcher::DeliverReplies(std::unique_ptr<OperationBatch> batch) {
+  for (const Operation& operation : *batch)
+    operation.reply.Run();
+}
+
+void SimpleIoBatcher::OnScheduledFlush() {
+  DCHECK(io_thread_checker_.CalledOnValidThread());
+  flush_scheduled_ = false;
+  Flush();
+}
+
+}  // namespace disk_cache
@@ -0,0 +1,92 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_IO_BATCHER_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_IO_BATCHER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/single_thread_task_runner.h"
+#include "base/task_runner.h"
+#include "base/threading/thread_checker.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+// Batches blocking simple-cache I/O operations so that a burst of reads or
+// writes costs one worker-pool handoff instead of one per operation. Each
+// operation is a pair of closures: |io_operation| runs the blocking
+// syscalls on the worker pool and |reply| delivers the completion on the
+// IO thread. Operations queued within one IO-thread task are submitted
+// together: as a full batch once |max_batch_size| accumulate, and the
+// remainder when control returns to the message loop. Within a batch,
+// operations run and complete in submission order; ordering across batches
+// is the caller's concern (SimpleEntryImpl already serializes operations
+// per entry).
+class NET_EXPORT_PRIVATE SimpleIoBatcher {
+ public:
+  SimpleIoBatcher(
+      const scoped_refptr<base::TaskRunner>& worker_pool,
+      const scoped_refptr<base::SingleThreadTaskRunner>& reply_runner,
+      size_t max_batch_size);
+  ~SimpleIoBatcher();
+
+  // Queues an operation. Must be called on the IO thread.
+  void PostOperation(const base::Closure& io_operation,
+                     const base::Closure& reply);
+
+  // Submits all queued operations now, without waiting for the batch to
+  // fill or for the message loop to turn.
+  void Flush();
+
+  size_t pending_operation_count() const { return pending_operations_.size(); }
+  uint64_t num_batches_submitted() const { return num_batches_submitted_; }
+
+ private:
+  struct Operation {
+    base::Closure io_operation;
+    base::Closure reply;
+  };
+  using OperationBatch = std::vector<Operation>;
+
+  // Runs on the worker pool: performs every blocking operation in order,
+  // then posts a single task delivering all replies to |reply_runner|.
+  static void RunBatch(std::unique_ptr<OperationBatch> batch,
+                       scoped_refptr<base::SingleThreadTaskRunner>
+                           reply_runner);
+
+  // Runs on the IO thread: delivers completions in submission order.
+  static void DeliverReplies(std::unique_ptr<OperationBatch> batch);
+
+  // Flushes the batch left over when the IO-thread task that queued it
+  // finished without filling it.
+  void OnScheduledFlush();
+
+  const scoped_refptr<base::TaskRunner> worker_pool_;
+  const scoped_refptr<base::SingleThreadTaskRunner> reply_runner_;
+  const size_t max_batch_size_;
+
+  OperationBatch pending_operations_;
+  // True while an OnScheduledFlush task is in flight.
+  bool flush_scheduled_;
+  uint64_t num_batches_submitted_;
+
+  base::ThreadChecker io_thread_checker_;
+
+  base::WeakPtrFactory<SimpleIoBatcher> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleIoBatcher);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_IO_BATCHER_H_
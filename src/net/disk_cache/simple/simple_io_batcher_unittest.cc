@@ -0,0 +1,107 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_io_batcher.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/message_loop/message_loop.h"
+#include "base/run_loop.h"
+#include "base/threading/thread.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace disk_cache {
+namespace {
+
+void AppendValue(std::vector<int>* log, int value) {
+  log->push_back(value);
+}
+
+class SimpleIoBatcherTest : public testing::Test {
+ protected:
+  SimpleIoBatcherTest() : worker_thread_("io_batcher_worker") {
+    CHECK(worker_thread_.Start());
+  }
+
+  std::unique_ptr<SimpleIoBatcher> MakeBatcher(size_t max_batch_size) {
+    return std::unique_ptr<SimpleIoBatcher>(
+        new SimpleIoBatcher(worker_thread_.task_runner(),
+                            base::ThreadTaskRunnerHandle::Get(),
+                            max_batch_size));
+  }
+
+  base::MessageLoop message_loop_;
+  base::Thread worker_thread_;
+};
+
+TEST_F(SimpleIoBatcherTest, OperationsCoalesceIntoOneBatch) {
+  std::unique_ptr<SimpleIoBatcher> batcher = MakeBatcher(16);
+  // I/O closures log 10 + i from the worker; replies log 20 + i from the
+  // IO thread. Posting order must be preserved in both.
+  std::vector<int> io_log;
+  std::vector<int> reply_log;
+  base::RunLoop run_loop;
+  for (int i = 0; i < 4; ++i) {
+    batcher->PostOperation(base::Bind(&AppendValue, &io_log, 10 + i),
+                           base::Bind(&AppendValue, &reply_log, 20 + i));
+  }
+  EXPECT_EQ(4u, batcher->pending_operation_count());
+  batcher->PostOperation(base::Bind(&base::DoNothing),
+                         run_loop.QuitClosure());
+  run_loop.Run();
+
+  EXPECT_EQ(1u, batcher->num_batches_submitted());
+  EXPECT_EQ(0u, batcher->pending_operation_count());
+  EXPECT_EQ((std::vector<int>{10, 11, 12, 13}), io_log);
+  EXPECT_EQ((std::vector<int>{20, 21, 22, 23}), reply_log);
+}
+
+TEST_F(SimpleIoBatcherTest, FullBatchIsSubmittedImmediately) {
+  std::unique_ptr<SimpleIoBatcher> batcher = MakeBatcher(2);
+  std::vector<int> reply_log;
+  base::RunLoop run_loop;
+  batcher->PostOperation(base::Bind(&base::DoNothing),
+                         base::Bind(&AppendValue, &reply_log, 1));
+  EXPECT_EQ(0u, batcher->num_batches_submitted());
+  batcher->PostOperation(base::Bind(&base::DoNothing),
+                         base::Bind(&AppendValue, &reply_log, 2));
+  // The batch filled; it went to the worker without waiting for the loop.
+  EXPECT_EQ(1u, batcher->num_batches_submitted());
+  EXPECT_EQ(0u, batcher->pending_operation_count());
+
+  batcher->PostOperation(base::Bind(&base::DoNothing),
+                         run_loop.QuitClosure());
+  run_loop.Run();
+  EXPECT_EQ(2u, batcher->num_batches_submitted());
+  EXPECT_EQ((std::vector<int>{1, 2}), reply_log);
+}
+
+TEST_F(SimpleIoBatcherTest, LoneOperationFlushesWhenTheLoopTurns) {
+  std::unique_ptr<SimpleIoBatcher> batcher = MakeBatcher(16);
+  base::RunLoop run_loop;
+  batcher->PostOperation(base::Bind(&base::DoNothing),
+                         run_loop.QuitClosure());
+  // Not submitted synchronously...
+  EXPECT_EQ(0u, batcher->num_batches_submitted());
+  EXPECT_EQ(1u, batcher->pending_operation_count());
+  // ...but the scheduled flush picks it up without an explicit Flush().
+  run_loop.Run();
+  EXPECT_EQ(1u, batcher->num_batches_submitted());
+}
+
+TEST_F(SimpleIoBatcherTest, ExplicitFlushSubmitsRightAway) {
+  std::unique_ptr<SimpleIoBatcher> batcher = MakeBatcher(16);
+  base::RunLoop run_loop;
+  batcher->PostOperation(base::Bind(&base::DoNothing),
+                         run_loop.QuitClosure());
+  batcher->Flush();
+  EXPECT_EQ(1u, batcher->num_batches_submitted());
+  run_loop.Run();
+}
+
+}  // namespace
+}  // namespace disk_cache
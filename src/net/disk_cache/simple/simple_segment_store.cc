@@ -0,0 +1,319 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_segment_store.h"
+
+#include <algorithm>
+
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "net/disk_cache/simple/simple_util.h"
+
+namespace disk_cache {
+
+namespace {
+
+const char kSegmentFilePrefix[] = "segment_";
+
+enum RecordState : uint32_t {
+  kRecordLive = 0,
+  kRecordDead = 1,
+};
+
+}  // namespace
+
+// Precedes every record in a segment file. The CRC covers the payload
+// only; the header fields are validated structurally.
+struct SimpleSegmentStore::RecordHeader {
+  uint32_t magic;
+  uint32_t state;  // RecordState.
+  uint64_t entry_hash;
+  int32_t data_length;
+  uint32_t data_crc;
+};
+
+SimpleSegmentStore::SimpleSegmentStore(const base::FilePath& directory,
+                                       int64_t max_segment_size)
+    : directory_(directory),
+      max_segment_size_(max_segment_size),
+      active_segment_id_(0),
+      active_offset_(0) {
+  static_assert(sizeof(RecordHeader) == 24,
+                "record header size is part of the on-disk format");
+  DCHECK_GT(max_segment_size,
+            static_cast<int64_t>(sizeof(RecordHeader)));
+}
+
+SimpleSegmentStore::~SimpleSegmentStore() {}
+
+bool SimpleSegmentStore::Initialize() {
+  DCHECK(segments_.empty());
+  base::FileEnumerator enumerator(
+      directory_, false /* recursive */, base::FileEnumerator::FILES,
+      std::string(kSegmentFilePrefix) + "*");
+  for (base::FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    uint32_t segment_id;
+    if (!base::HexStringToUInt(
+            path.BaseName().MaybeAsASCII().substr(strlen(kSegmentFilePrefix)),
+            &segment_id)) {
+      continue;
+    }
+    base::File* file = OpenSegment(segment_id);
+    if (!file)
+      return false;
+    SegmentInfo info = {0, 0, 0};
+    if (!ScanSegment(file, &info))
+      return false;
+    segments_[segment_id] = info;
+  }
+
+  // Resume appending to the newest segment if it has room, otherwise start
+  // a fresh one after it.
+  if (!segments_.empty()) {
+    active_segment_id_ = segments_.rbegin()->first;
+    active_offset_ = segments_.rbegin()->second.file_size;
+    if (active_offset_ >= max_segment_size_)
+      return RollOver();
+    return true;
+  }
+  active_segment_id_ = 0;
+  active_offset_ = 0;
+  if (!OpenSegment(active_segment_id_))
+    return false;
+  segments_[active_segment_id_] = SegmentInfo{0, 0, 0};
+  return true;
+}
+
+bool SimpleSegmentStore::Append(uint64_t entry_hash,
+                                base::StringPiece data,
+                                RecordLocation* out_location) {
+  const int64_t record_size = sizeof(RecordHeader) + data.size();
+  if (active_offset_ > 0 && active_offset_ + record_size > max_segment_size_) {
+    if (!RollOver())
+      return false;
+  }
+
+  RecordHeader header;
+  header.magic = kSimpleSegmentRecordMagic;
+  header.state = kRecordLive;
+  header.entry_hash = entry_hash;
+  header.data_length = static_cast<int32_t>(data.size());
+  header.data_crc = simple_util::Crc32(data.data(), data.size());
+
+  // One contiguous write keeps a record from ever straddling a torn tail
+  // boundary mid-header.
+  std::string buffer;
+  buffer.reserve(record_size);
+  buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+  buffer.append(data.data(), data.size());
+
+  base::File* file = OpenSegment(active_segment_id_);
+  if (!file)
+    return false;
+  if (file->Write(active_offset_, buffer.data(), buffer.size()) !=
+      static_cast<int>(buffer.size())) {
+    return false;
+  }
+
+  out_location->segment_id = active_segment_id_;
+  out_location->offset = active_offset_;
+  out_location->length = header.data_length;
+
+  SegmentInfo* info = &segments_[active_segment_id_];
+  info->file_size = active_offset_ + record_size;
+  info->live_bytes += record_size;
+  active_offset_ += record_size;
+  return true;
+}
+
+bool SimpleSegmentStore::Read(uint64_t entry_hash,
+                              const RecordLocation& location,
+                              std::string* out_data) {
+  base::File* file = OpenSegment(location.segment_id);
+  if (!file)
+    return false;
+  RecordHeader header;
+  if (file->Read(location.offset, reinterpret_cast<char*>(&header),
+                 sizeof(header)) != static_cast<int>(sizeof(header))) {
+    return false;
+  }
+  if (header.magic != kSimpleSegmentRecordMagic ||
+      header.state != kRecordLive || header.entry_hash != entry_hash ||
+      header.data_length != location.length) {
+    return false;
+  }
+  out_data->resize(header.data_length);
+  if (file->Read(location.offset + sizeof(header), &(*out_data)[0],
+                 header.data_length) != header.data_length) {
+    return false;
+  }
+  return header.data_crc ==
+         simple_util::Crc32(out_data->data(), out_data->size());
+}
+
+bool SimpleSegmentStore::Doom(const RecordLocation& location) {
+  base::File* file = OpenSegment(location.segment_id);
+  if (!file)
+    return false;
+  RecordHeader header;
+  if (file->Read(location.offset, reinterpret_cast<char*>(&header),
+                 sizeof(header)) != static_cast<int>(sizeof(header))) {
+    return false;
+  }
+  if (header.magic != kSimpleSegmentRecordMagic ||
+      header.state != kRecordLive) {
+    return false;
+  }
+  const uint32_t dead_state = kRecordDead;
+  if (file->Write(location.offset + offsetof(RecordHeader, state),
+                  reinterpret_cast<const char*>(&dead_state),
+                  sizeof(dead_state)) != static_cast<int>(sizeof(dead_state))) {
+    return false;
+  }
+  const int64_t record_size = sizeof(RecordHeader) + header.data_length;
+  SegmentInfo* info = &segments_[location.segment_id];
+  info->live_bytes -= record_size;
+  info->dead_bytes += record_size;
+  return true;
+}
+
+bool SimpleSegmentStore::GetCompactionCandidate(
+    uint32_t* out_segment_id) const {
+  int64_t most_dead_bytes = 0;
+  for (const auto& id_and_info : segments_) {
+    if (id_and_info.first == active_segment_id_)
+      continue;
+    if (id_and_info.second.dead_bytes > most_dead_bytes) {
+      most_dead_bytes = id_and_info.second.dead_bytes;
+      *out_segment_id = id_and_info.first;
+    }
+  }
+  return most_dead_bytes > 0;
+}
+
+bool SimpleSegmentStore::CompactSegment(
+    uint32_t segment_id,
+    std::vector<std::pair<uint64_t, RecordLocation>>* out_relocations) {
+  DCHECK_NE(active_segment_id_, segment_id);
+  std::map<uint32_t, SegmentInfo>::iterator it = segments_.find(segment_id);
+  if (it == segments_.end())
+    return false;
+  base::File* file = OpenSegment(segment_id);
+  if (!file)
+    return false;
+
+  const int64_t file_size = it->second.file_size;
+  int64_t offset = 0;
+  while (offset + static_cast<int64_t>(sizeof(RecordHeader)) <= file_size) {
+    RecordHeader header;
+    if (file->Read(offset, reinterpret_cast<char*>(&header),
+                   sizeof(header)) != static_cast<int>(sizeof(header))) {
+      return false;
+    }
+    if (header.magic != kSimpleSegmentRecordMagic || header.data_length < 0 ||
+        offset + static_cast<int64_t>(sizeof(header)) + header.data_length >
+            file_size) {
+      break;
+    }
+    if (header.state == kRecordLive) {
+      RecordLocation old_location = {segment_id, offset, header.data_length};
+      std::string data;
+      // A record failing its CRC is dropped rather than propagated.
+      if (Read(header.entry_hash, old_location, &data)) {
+        RecordLocation new_location;
+        if (!Append(header.entry_hash, data, &new_location))
+          return false;
+        out_relocations->push_back(
+            std::make_pair(header.entry_hash, new_location));
+      }
+    }
+    offset += sizeof(header) + header.data_length;
+  }
+
+  files_.erase(segment_id);
+  segments_.erase(segment_id);
+  return simple_util::SimpleCacheDeleteFile(SegmentPath(segment_id));
+}
+
+int64_t SimpleSegmentStore::live_bytes() const {
+  int64_t total = 0;
+  for (const auto& id_and_info : segments_)
+    total += id_and_info.second.live_bytes;
+  return total;
+}
+
+int64_t SimpleSegmentStore::dead_bytes() const {
+  int64_t total = 0;
+  for (const auto& id_and_info : segments_)
+    total += id_and_info.second.dead_bytes;
+  return total;
+}
+
+// static
+std::string SimpleSegmentStore::SegmentFileName(uint32_t segment_id) {
+  return base::StringPrintf("%s%08x", kSegmentFilePrefix, segment_id);
+}
+
+base::File* SimpleSegmentStore::OpenSegment(uint32_t segment_id) {
+  std::map<uint32_t, base::File>::iterator it = files_.find(segment_id);
+  if (it != files_.end())
+    return &it->second;
+  base::File file(SegmentPath(segment_id),
+                  base::File::FLAG_OPEN_ALWAYS | base::File::FLAG_READ |
+                      base::File::FLAG_WRITE);
+  if (!file.IsValid()) {
+    LOG(ERROR) << "Failed to open segment file "
+               << SegmentFileName(segment_id);
+    return nullptr;
+  }
+  return &files_.insert(std::make_pair(segment_id, std::move(file)))
+              .first->second;
+}
+
+bool SimpleSegmentStore::ScanSegment(base::File* file, SegmentInfo* info) {
+  const int64_t file_size = file->GetLength();
+  if (file_size < 0)
+    return false;
+  int64_t offset = 0;
+  while (offset + static_cast<int64_t>(sizeof(RecordHeader)) <= file_size) {
+    RecordHeader header;
+    if (file->Read(offset, reinterpret_cast<char*>(&header),
+                   sizeof(header)) != static_cast<int>(sizeof(header))) {
+      return false;
+    }
+    if (header.magic != kSimpleSegmentRecordMagic || header.data_length < 0 ||
+        offset + static_cast<int64_t>(sizeof(header)) + header.data_length >
+            file_size) {
+      // Torn tail from a crash mid-append; everything before it is intact.
+      break;
+    }
+    const int64_t record_size = sizeof(header) + header.data_length;
+    if (header.state == kRecordLive)
+      info->live_bytes += record_size;
+    else
+      info->dead_bytes += record_size;
+    offset += record_size;
+  }
+  info->file_size = offset;
+  return true;
+}
+
+bool SimpleSegmentStore::RollOver() {
+  ++active_segment_id_;
+  active_offset_ = 0;
+  if (!OpenSegment(active_segment_id_))
+    return false;
+  segments_[active_segment_id_] = SegmentInfo{0, 0, 0};
+  return true;
+}
+
+base::FilePath SimpleSegmentStore::SegmentPath(uint32_t segment_id) const {
+  return directory_.AppendASCII(SegmentFileName(segment_id));
+}
+
+}  // namespace disk_cache
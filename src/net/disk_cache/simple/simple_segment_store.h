@@ -0,0 +1,134 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_DISK_CACHE_SIMPLE_SIMPLE_SEGMENT_STORE_H_
+#define NET_DISK_CACHE_SIMPLE_SIMPLE_SEGMENT_STORE_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/strings/string_piece.h"
+#include "net/base/net_export.h"
+
+namespace disk_cache {
+
+const uint32_t kSimpleSegmentRecordMagic = 0x73656730;  // "seg0"
+
+// Packed storage for small cache entries: instead of one file set per
+// entry, entry data is appended to large segment files and addressed by
+// (segment, offset, length). This trades the per-entry open/create/unlink
+// metadata traffic of the one-file-per-entry layout for sequential appends
+// into a handful of always-open files, which is an order of magnitude
+// fewer filesystem metadata operations on small-object workloads.
+//
+// Records carry their own header (magic, key hash, length, CRC), so a
+// segment is self-describing: startup re-scans segments to rebuild
+// per-segment occupancy, stopping at a torn tail. Dooming a record flips a
+// state byte in place; the space is reclaimed by compaction, which copies
+// the surviving records of the deadest segment into the active one and
+// deletes the file.
+//
+// All methods perform blocking IO and must run on a thread that allows it,
+// like SimpleSynchronousEntry. The class itself is not thread-safe.
+class NET_EXPORT_PRIVATE SimpleSegmentStore {
+ public:
+  // Addresses one stored record. |offset| points at the record header
+  // inside the segment; |length| is the data length.
+  struct RecordLocation {
+    uint32_t segment_id;
+    int64_t offset;
+    int32_t length;
+  };
+
+  // Occupancy of one segment file.
+  struct SegmentInfo {
+    int64_t file_size;
+    int64_t live_bytes;
+    int64_t dead_bytes;
+  };
+
+  SimpleSegmentStore(const base::FilePath& directory,
+                     int64_t max_segment_size);
+  ~SimpleSegmentStore();
+
+  // Opens the existing segments under the directory, rebuilding occupancy
+  // by scanning their records, and opens a segment for appending. Returns
+  // false on unrecoverable IO errors; individual corrupt records are
+  // skipped and torn tails are dropped.
+  bool Initialize();
+
+  // Appends a record for |entry_hash| and returns its location. Rolls over
+  // to a new segment when the active one is full.
+  bool Append(uint64_t entry_hash,
+              base::StringPiece data,
+              RecordLocation* out_location);
+
+  // Reads the record at |location|, verifying its header against
+  // |entry_hash| and its payload against the stored CRC.
+  bool Read(uint64_t entry_hash,
+            const RecordLocation& location,
+            std::string* out_data);
+
+  // Marks the record at |location| dead. The bytes are reclaimed by a
+  // later CompactSegment() of that segment.
+  bool Doom(const RecordLocation& location);
+
+  // Returns the id of the non-active segment with the most dead bytes, or
+  // false if no segment has any dead bytes to reclaim.
+  bool GetCompactionCandidate(uint32_t* out_segment_id) const;
+
+  // Rewrites the live records of |segment_id| into the active segment and
+  // deletes its file. Appends (entry_hash, new_location) for every moved
+  // record to |out_relocations| so the caller can update its index.
+  bool CompactSegment(
+      uint32_t segment_id,
+      std::vector<std::pair<uint64_t, RecordLocation>>* out_relocations);
+
+  int64_t live_bytes() const;
+  int64_t dead_bytes() const;
+  size_t segment_count() const { return segments_.size(); }
+  uint32_t active_segment_id() const { return active_segment_id_; }
+
+  static std::string SegmentFileName(uint32_t segment_id);
+
+ private:
+  struct RecordHeader;
+
+  // Opens (creating if needed) the segment with the given id for IO and
+  // returns its handle, or NULL on failure.
+  base::File* OpenSegment(uint32_t segment_id);
+
+  // Scans one segment file, accounting records into |info|.
+  bool ScanSegment(base::File* file, SegmentInfo* info);
+
+  // Starts a fresh active segment after the current one reached
+  // |max_segment_size_|.
+  bool RollOver();
+
+  base::FilePath SegmentPath(uint32_t segment_id) const;
+
+  const base::FilePath directory_;
+  const int64_t max_segment_size_;
+
+  std::map<uint32_t, SegmentInfo> segments_;
+  // Open handles, one per segment; segments stay open so reads and dooms
+  // never pay a path lookup.
+  std::map<uint32_t, base::File> files_;
+  uint32_t active_segment_id_;
+  int64_t active_offset_;
+
+  DISALLOW_COPY_AND_ASSIGN(SimpleSegmentStore);
+};
+
+}  // namespace disk_cache
+
+#endif  // NET_DISK_CACHE_SIMPLE_SIMPLE_SEGMENT_STORE_H_
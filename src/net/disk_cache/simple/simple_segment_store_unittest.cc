@@ -0,0 +1,147 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/disk_cache/simple/simple_segment_store.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace disk_cache {
+namespace {
+
+const int64_t kSmallSegmentSize = 4096;
+
+class SimpleSegmentStoreTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  std::unique_ptr<SimpleSegmentStore> MakeStore(int64_t max_segment_size) {
+    std::unique_ptr<SimpleSegmentStore> store(
+        new SimpleSegmentStore(temp_dir_.GetPath(), max_segment_size));
+    if (!store->Initialize())
+      return nullptr;
+    return store;
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+TEST_F(SimpleSegmentStoreTest, AppendThenRead) {
+  std::unique_ptr<SimpleSegmentStore> store = MakeStore(kSmallSegmentSize);
+  ASSERT_TRUE(store);
+
+  const std::string data("some cached body bytes");
+  SimpleSegmentStore::RecordLocation location;
+  ASSERT_TRUE(store->Append(42, data, &location));
+  EXPECT_EQ(store->active_segment_id(), location.segment_id);
+  EXPECT_EQ(static_cast<int32_t>(data.size()), location.length);
+
+  std::string read_back;
+  ASSERT_TRUE(store->Read(42, location, &read_back));
+  EXPECT_EQ(data, read_back);
+
+  // A hash mismatch is detected by the record header.
+  EXPECT_FALSE(store->Read(43, location, &read_back));
+}
+
+TEST_F(SimpleSegmentStoreTest, RollsOverToNewSegments) {
+  std::unique_ptr<SimpleSegmentStore> store = MakeStore(kSmallSegmentSize);
+  ASSERT_TRUE(store);
+
+  const std::string data(1024, 'd');
+  std::vector<SimpleSegmentStore::RecordLocation> locations;
+  for (uint64_t i = 0; i < 16; ++i) {
+    SimpleSegmentStore::RecordLocation location;
+    ASSERT_TRUE(store->Append(i, data, &location));
+    locations.push_back(location);
+  }
+  EXPECT_GT(store->segment_count(), 1u);
+
+  // Records in rolled-over segments stay readable.
+  for (uint64_t i = 0; i < 16; ++i) {
+    std::string read_back;
+    EXPECT_TRUE(store->Read(i, locations[i], &read_back)) << i;
+  }
+}
+
+TEST_F(SimpleSegmentStoreTest, DoomMovesBytesToDead) {
+  std::unique_ptr<SimpleSegmentStore> store = MakeStore(kSmallSegmentSize);
+  ASSERT_TRUE(store);
+
+  SimpleSegmentStore::RecordLocation location;
+  ASSERT_TRUE(store->Append(7, std::string(100, 'x'), &location));
+  const int64_t live_before = store->live_bytes();
+  EXPECT_EQ(0, store->dead_bytes());
+
+  ASSERT_TRUE(store->Doom(location));
+  EXPECT_EQ(live_before, store->dead_bytes());
+  EXPECT_EQ(0, store->live_bytes());
+
+  // Doomed records cannot be read or doomed twice.
+  std::string read_back;
+  EXPECT_FALSE(store->Read(7, location, &read_back));
+  EXPECT_FALSE(store->Doom(location));
+}
+
+TEST_F(SimpleSegmentStoreTest, OccupancySurvivesReopen) {
+  SimpleSegmentStore::RecordLocation live_location;
+  SimpleSegmentStore::RecordLocation dead_location;
+  {
+    std::unique_ptr<SimpleSegmentStore> store = MakeStore(kSmallSegmentSize);
+    ASSERT_TRUE(store);
+    ASSERT_TRUE(store->Append(1, std::string(100, 'a'), &live_location));
+    ASSERT_TRUE(store->Append(2, std::string(100, 'b'), &dead_location));
+    ASSERT_TRUE(store->Doom(dead_location));
+  }
+
+  std::unique_ptr<SimpleSegmentStore> store = MakeStore(kSmallSegmentSize);
+  ASSERT_TRUE(store);
+  EXPECT_GT(store->live_bytes(), 0);
+  EXPECT_GT(store->dead_bytes(), 0);
+  std::string read_back;
+  EXPECT_TRUE(store->Read(1, live_location, &read_back));
+  EXPECT_EQ(std::string(100, 'a'), read_back);
+  EXPECT_FALSE(store->Read(2, dead_location, &read_back));
+}
+
+TEST_F(SimpleSegmentStoreTest, CompactionRelocatesLiveRecordsOnly) {
+  std::unique_ptr<SimpleSegmentStore> store = MakeStore(kSmallSegmentSize);
+  ASSERT_TRUE(store);
+
+  // Fill a few segments, then doom every even-hashed record.
+  const std::string data(1024, 'd');
+  std::vector<SimpleSegmentStore::RecordLocation> locations(16);
+  for (uint64_t i = 0; i < 16; ++i)
+    ASSERT_TRUE(store->Append(i, data, &locations[i]));
+  for (uint64_t i = 0; i < 16; i += 2)
+    ASSERT_TRUE(store->Doom(locations[i]));
+
+  uint32_t candidate;
+  ASSERT_TRUE(store->GetCompactionCandidate(&candidate));
+  EXPECT_NE(store->active_segment_id(), candidate);
+
+  std::vector<std::pair<uint64_t, SimpleSegmentStore::RecordLocation>>
+      relocations;
+  ASSERT_TRUE(store->CompactSegment(candidate, &relocations));
+  EXPECT_FALSE(base::PathExists(temp_dir_.GetPath().AppendASCII(
+      SimpleSegmentStore::SegmentFileName(candidate))));
+
+  // Every relocated record is live, odd-hashed, and readable at its new
+  // location.
+  for (const auto& relocation : relocations) {
+    EXPECT_EQ(1u, relocation.first % 2);
+    std::string read_back;
+    EXPECT_TRUE(store->Read(relocation.first, relocation.second, &read_back));
+    EXPECT_EQ(data, read_back);
+  }
+}
+
+}  // namespace
+}  // namespace disk_cache
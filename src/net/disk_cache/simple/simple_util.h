@@ -76,6 +76,14 @@ NET_EXPORT_PRIVATE int GetFileIndexFromStreamIndex(int stream_index);
 NET_EXPORT_PRIVATE bool GetMTime(const base::FilePath& path,
                                  base::Time* out_mtime);
 
+// Asks the OS to start reading the byte range [offset, offset + length) of
+// |path| into the page cache. A |length| of zero covers from |offset| to the
+// end of the file. Returns false if the file could not be opened; a true
+// return only means the hint was issued, not that any data was read.
+NET_EXPORT_PRIVATE bool PreloadFileRange(const base::FilePath& path,
+                                         int64_t offset,
+                                         int64_t length);
+
 // Deletes a file, insuring POSIX semantics. Provided that all open handles to
 // this file were opened with File::FLAG_SHARE_DELETE, it is possible to delete
 // an open file and continue to use that file. After deleting an open file, it
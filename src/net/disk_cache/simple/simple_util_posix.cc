@@ -4,6 +4,9 @@
 
 #include "net/disk_cache/simple/simple_util.h"
 
+#include <fcntl.h>
+
+#include "base/files/file.h"
 #include "base/files/file_util.h"
 
 namespace disk_cache {
@@ -13,5 +16,19 @@ bool SimpleCacheDeleteFile(const base::FilePath& path) {
   return base::DeleteFile(path, false);
 }
 
+bool PreloadFileRange(const base::FilePath& path,
+                      int64_t offset,
+                      int64_t length) {
+  base::File file(path, base::File::FLAG_OPEN | base::File::FLAG_READ);
+  if (!file.IsValid())
+    return false;
+#if defined(OS_LINUX) || defined(OS_ANDROID)
+  posix_fadvise(file.GetPlatformFile(), offset, length, POSIX_FADV_WILLNEED);
+#endif
+  // On other POSIX systems the open itself is the best cheap hint available;
+  // the advice is best effort everywhere, so the hint counts as issued.
+  return true;
+}
+
 }  // namespace simple_util
 }  // namespace disk_cache
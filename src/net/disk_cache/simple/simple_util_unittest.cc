@@ -5,7 +5,10 @@
 #include <stdint.h>
 #include <string>
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
+#include "build/build_config.h"
 #include "net/disk_cache/simple/simple_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -15,6 +18,7 @@ using disk_cache::simple_util::GetEntryHashKeyFromHexString;
 using disk_cache::simple_util::GetEntryHashKey;
 using disk_cache::simple_util::GetFileSizeFromDataSize;
 using disk_cache::simple_util::GetDataSizeFromFileSize;
+using disk_cache::simple_util::PreloadFileRange;
 
 class SimpleUtilTest : public testing::Test {};
 
@@ -76,3 +80,22 @@ TEST_F(SimpleUtilTest, SizesAndOffsets) {
   const int file_size = GetFileSizeFromDataSize(key.size(), data_size);
   EXPECT_EQ(data_size, GetDataSizeFromFileSize(key.size(), file_size));
 }
+
+#if defined(OS_POSIX)
+TEST_F(SimpleUtilTest, PreloadFileRange) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath file_path =
+      temp_dir.GetPath().AppendASCII("preload-me");
+  const std::string contents(8192, 'x');
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(file_path, contents.data(), contents.size()));
+
+  // Issuing the hint is best effort, but the open must succeed.
+  EXPECT_TRUE(PreloadFileRange(file_path, 0, 0));
+  EXPECT_TRUE(PreloadFileRange(file_path, 4096, 1024));
+
+  EXPECT_FALSE(PreloadFileRange(
+      temp_dir.GetPath().AppendASCII("no-such-file"), 0, 0));
+}
+#endif  // defined(OS_POSIX)
@@ -40,5 +40,14 @@ bool SimpleCacheDeleteFile(const base::FilePath& path) {
   return DeleteCacheFile(path);
 }
 
+bool PreloadFileRange(const base::FilePath& path,
+                      int64_t offset,
+                      int64_t length) {
+  // There is no cheap readahead hint to issue here; PrefetchVirtualMemory
+  // requires mapping the file first, which costs more than it saves for
+  // cache-entry sized files.
+  return false;
+}
+
 }  // namespace simple_util
 }  // namespace disk_cache
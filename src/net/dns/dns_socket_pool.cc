@@ -4,6 +4,9 @@
 
 #include "net/dns/dns_socket_pool.h"
 
+#include <map>
+#include <utility>
+
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
@@ -37,6 +40,12 @@ const unsigned kInitialPoolSize = 0;
 const unsigned kAllocateMinSize = 1;
 #endif
 
+// For the reusing pool: how many idle connected sockets to retain per
+// server, and how many queries one socket may serve before it is retired so
+// its port still rotates regularly.
+const unsigned kMaxIdleSocketsPerServer = 4;
+const unsigned kMaxUsesPerSocket = 64;
+
 } // namespace
 
 DnsSocketPool::DnsSocketPool(ClientSocketFactory* socket_factory,
@@ -221,4 +230,78 @@ void DefaultDnsSocketPool::FillPool(unsigned server_index, unsigned size) {
   }
 }
 
+class ReusingDnsSocketPool : public DnsSocketPool {
+ public:
+  ReusingDnsSocketPool(ClientSocketFactory* factory,
+                       const RandIntCallback& rand_int_callback)
+      : DnsSocketPool(factory, rand_int_callback) {}
+
+  ~ReusingDnsSocketPool() override {}
+
+  void Initialize(const std::vector<IPEndPoint>* nameservers,
+                  NetLog* net_log) override {
+    InitializeInternal(nameservers, net_log);
+
+    DCHECK(idle_pools_.empty());
+    idle_pools_.resize(nameservers->size());
+  }
+
+  std::unique_ptr<DatagramClientSocket> AllocateSocket(
+      unsigned server_index) override {
+    DCHECK_LT(server_index, idle_pools_.size());
+    SocketVector& pool = idle_pools_[server_index];
+
+    if (!pool.empty()) {
+      std::unique_ptr<DatagramClientSocket> socket = std::move(pool.back());
+      pool.pop_back();
+      ++use_counts_[socket.get()];
+      return socket;
+    }
+
+    std::unique_ptr<DatagramClientSocket> socket =
+        CreateConnectedSocket(server_index);
+    if (socket)
+      use_counts_[socket.get()] = 1;
+    return socket;
+  }
+
+  void FreeSocket(unsigned server_index,
+                  std::unique_ptr<DatagramClientSocket> socket) override {
+    DCHECK_LT(server_index, idle_pools_.size());
+    if (!socket)
+      return;
+
+    auto it = use_counts_.find(socket.get());
+    DCHECK(it != use_counts_.end());
+
+    SocketVector& pool = idle_pools_[server_index];
+    if (it->second >= kMaxUsesPerSocket ||
+        pool.size() >= kMaxIdleSocketsPerServer) {
+      // Deleting the socket rotates its port.
+      use_counts_.erase(it);
+      return;
+    }
+    pool.push_back(std::move(socket));
+  }
+
+ private:
+  typedef std::vector<std::unique_ptr<DatagramClientSocket>> SocketVector;
+
+  std::vector<SocketVector> idle_pools_;
+  // Number of queries each live socket has served, including the one it is
+  // currently allocated for; sockets reaching kMaxUsesPerSocket are retired
+  // instead of being returned to the idle pool.
+  std::map<DatagramClientSocket*, unsigned> use_counts_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReusingDnsSocketPool);
+};
+
+// static
+std::unique_ptr<DnsSocketPool> DnsSocketPool::CreateReusing(
+    ClientSocketFactory* factory,
+    const RandIntCallback& rand_int_callback) {
+  return std::unique_ptr<DnsSocketPool>(
+      new ReusingDnsSocketPool(factory, rand_int_callback));
+}
+
 } // namespace net
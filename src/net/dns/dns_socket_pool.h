@@ -42,6 +42,17 @@ class NET_EXPORT_PRIVATE DnsSocketPool {
       ClientSocketFactory* factory,
       const RandIntCallback& rand_int_callback);
 
+  // Creates a DnsSocketPool that keeps a small number of long-lived connected
+  // sockets per server and reuses them across queries, trading a bounded
+  // amount of port randomization for much less socket churn: each socket
+  // serves a limited number of queries before it is retired and its port
+  // rotated. Safe with DnsUDPAttempt, which ignores datagrams that do not
+  // match its query, so a stale response left over from an earlier query on
+  // a reused socket is simply skipped.
+  static std::unique_ptr<DnsSocketPool> CreateReusing(
+      ClientSocketFactory* factory,
+      const RandIntCallback& rand_int_callback);
+
   // Initializes the DnsSocketPool.  |nameservers| is the list of nameservers
   // for which the DnsSocketPool will manage sockets; |net_log| is the NetLog
   // used when constructing sockets with the factory.
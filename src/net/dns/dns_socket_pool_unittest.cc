@@ -4,11 +4,18 @@
 
 #include "net/dns/dns_socket_pool.h"
 
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/memory/weak_ptr.h"
+#include "net/base/ip_address.h"
+#include "net/base/ip_endpoint.h"
 #include "net/base/rand_callback.h"
 #include "net/socket/client_socket_factory.h"
+#include "net/socket/datagram_client_socket.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace net {
@@ -104,5 +111,31 @@ TEST_F(DnsSocketPoolTest, NullCopiesCallback) {
   EXPECT_TRUE(dummy_.HasRefs());
 }
 
+TEST_F(DnsSocketPoolTest, ReusingCopiesCallback) {
+  pool_ = DnsSocketPool::CreateReusing(ClientSocketFactory::GetDefaultFactory(),
+                                       dummy_.MakeCallback());
+  EXPECT_TRUE(dummy_.HasRefs());
+}
+
+// The reusing pool must hand a freed socket back out for the same server
+// instead of creating a fresh one.
+TEST_F(DnsSocketPoolTest, ReusingReusesFreedSocket) {
+  pool_ = DnsSocketPool::CreateReusing(ClientSocketFactory::GetDefaultFactory(),
+                                       dummy_.MakeCallback());
+
+  std::vector<IPEndPoint> nameservers;
+  nameservers.push_back(IPEndPoint(IPAddress::IPv4Localhost(), 53));
+  pool_->Initialize(&nameservers, nullptr);
+
+  std::unique_ptr<DatagramClientSocket> socket = pool_->AllocateSocket(0u);
+  ASSERT_TRUE(socket.get());
+  DatagramClientSocket* raw_socket = socket.get();
+  pool_->FreeSocket(0u, std::move(socket));
+
+  socket = pool_->AllocateSocket(0u);
+  EXPECT_EQ(raw_socket, socket.get());
+  pool_->FreeSocket(0u, std::move(socket));
+}
+
 }  // namespace
 }  // namespace net
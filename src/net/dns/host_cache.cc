@@ -223,6 +223,7 @@ void HostCache::Set(const Key& key,
     result_changed =
         entry.error() == OK &&
         (it->second.error() != entry.error() || delta != DELTA_IDENTICAL);
+    RemoveFromExpirationIndex(it->first, it->second.expires());
     entries_.erase(it);
   } else {
     result_changed = true;
@@ -240,10 +241,23 @@ void HostCache::Set(const Key& key,
 void HostCache::AddEntry(const Key& key, const Entry& entry) {
   DCHECK_GT(max_entries_, size());
   DCHECK_EQ(0u, entries_.count(key));
+  expiration_index_.insert(std::make_pair(entry.expires(), key));
   entries_.insert(std::make_pair(key, entry));
   DCHECK_GE(max_entries_, size());
 }
 
+void HostCache::RemoveFromExpirationIndex(const Key& key,
+                                          base::TimeTicks expires) {
+  auto range = expiration_index_.equal_range(expires);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == key) {
+      expiration_index_.erase(it);
+      return;
+    }
+  }
+  NOTREACHED();
+}
+
 void HostCache::OnNetworkChange() {
   ++network_changes_;
 }
@@ -264,6 +278,7 @@ void HostCache::clear() {
     return;
 
   entries_.clear();
+  expiration_index_.clear();
   if (delegate_)
     delegate_->ScheduleWrite();
 }
@@ -284,6 +299,7 @@ void HostCache::ClearForHosts(
 
     if (host_filter.Run(it->first.hostname)) {
       RecordErase(ERASE_CLEAR, now, it->second);
+      RemoveFromExpirationIndex(it->first, it->second.expires());
       entries_.erase(it);
       changed = true;
     }
@@ -425,20 +441,19 @@ std::unique_ptr<HostCache> HostCache::CreateDefaultCache() {
 
 void HostCache::EvictOneEntry(base::TimeTicks now) {
   DCHECK_LT(0u, entries_.size());
+  DCHECK_EQ(entries_.size(), expiration_index_.size());
 
-  auto oldest_it = entries_.begin();
-  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
-    if ((it->second.expires() < oldest_it->second.expires()) &&
-        (it->second.IsStale(now, network_changes_) ||
-         !oldest_it->second.IsStale(now, network_changes_))) {
-      oldest_it = it;
-    }
-  }
+  // The index orders entries by expiration time, so the victim is simply its
+  // front, with no need to scan the whole cache.
+  auto index_it = expiration_index_.begin();
+  auto oldest_it = entries_.find(index_it->second);
+  DCHECK(oldest_it != entries_.end());
 
   if (!eviction_callback_.is_null())
     eviction_callback_.Run(oldest_it->first, oldest_it->second);
   RecordErase(ERASE_EVICT, now, oldest_it->second);
   entries_.erase(oldest_it);
+  expiration_index_.erase(index_it);
 }
 
 void HostCache::RecordSet(SetOutcome outcome,
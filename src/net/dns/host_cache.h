@@ -12,8 +12,10 @@
 #include <memory>
 #include <string>
 #include <tuple>
+#include <unordered_map>
 
 #include "base/gtest_prod_util.h"
+#include "base/hash.h"
 #include "base/macros.h"
 #include "base/threading/thread_checker.h"
 #include "base/time/time.h"
@@ -52,11 +54,28 @@ class NET_EXPORT HostCache {
                       other.hostname);
     }
 
+    bool operator==(const Key& other) const {
+      return address_family == other.address_family &&
+             host_resolver_flags == other.host_resolver_flags &&
+             hostname == other.hostname;
+    }
+
     std::string hostname;
     AddressFamily address_family;
     HostResolverFlags host_resolver_flags;
   };
 
+  // Hash for |Key|, so a lookup costs one hash probe in |entries_| instead
+  // of O(log n) string comparisons.
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return base::HashInts(
+          base::Hash(key.hostname),
+          static_cast<uint32_t>(key.address_family) << 16 |
+              static_cast<uint32_t>(key.host_resolver_flags & 0xffff));
+    }
+  };
+
   struct NET_EXPORT EntryStaleness {
     // Time since the entry's TTL has expired. Negative if not expired.
     base::TimeDelta expired_by;
@@ -136,7 +155,7 @@ class NET_EXPORT HostCache {
     virtual void ScheduleWrite() = 0;
   };
 
-  using EntryMap = std::map<Key, Entry>;
+  using EntryMap = std::unordered_map<Key, Entry, KeyHash>;
   using EvictionCallback = base::Callback<void(const Key&, const Entry&)>;
 
   // Constructs a HostCache that stores up to |max_entries|.
@@ -228,10 +247,17 @@ class NET_EXPORT HostCache {
   void EvictOneEntry(base::TimeTicks now);
   // Helper to insert an Entry into the cache.
   void AddEntry(const Key& key, const Entry& entry);
+  // Removes the |expiration_index_| record for the entry with the given key
+  // and expiration time; the record must exist.
+  void RemoveFromExpirationIndex(const Key& key, base::TimeTicks expires);
 
   // Map from hostname (presumably in lowercase canonicalized format) to
   // a resolved result entry.
   EntryMap entries_;
+  // Entry keys ordered by expiration time, so eviction can pick the
+  // soonest-expiring entry without scanning the whole cache. Kept in sync
+  // with |entries_|, one record per entry.
+  std::multimap<base::TimeTicks, Key> expiration_index_;
   size_t max_entries_;
   int network_changes_;
   EvictionCallback eviction_callback_;
@@ -434,6 +434,33 @@ TEST(HostCacheTest, EvictWithCallback) {
   EXPECT_EQ(key2.hostname, evicted_key.hostname);
 }
 
+// Updating an entry must also update its position in the eviction order.
+TEST(HostCacheTest, EvictAfterUpdate) {
+  HostCache cache(2);
+
+  base::TimeTicks now;
+
+  HostCache::Key key1 = Key("foobar.com");
+  HostCache::Key key2 = Key("foobar2.com");
+  HostCache::Key key3 = Key("foobar3.com");
+  HostCache::Entry entry = HostCache::Entry(OK, AddressList());
+
+  // |key1| initially expires first...
+  cache.Set(key1, entry, now, base::TimeDelta::FromSeconds(5));
+  cache.Set(key2, entry, now, base::TimeDelta::FromSeconds(10));
+
+  // ...but is then refreshed to outlive |key2|.
+  cache.Set(key1, entry, now, base::TimeDelta::FromSeconds(20));
+  EXPECT_EQ(2u, cache.size());
+
+  // |key2| now expires soonest, so it is the one evicted.
+  cache.Set(key3, entry, now, base::TimeDelta::FromSeconds(10));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.Lookup(key1, now));
+  EXPECT_FALSE(cache.Lookup(key2, now));
+  EXPECT_TRUE(cache.Lookup(key3, now));
+}
+
 // Try to retrieve stale entries from the cache. They should be returned by
 // |LookupStale()| but not |Lookup()|, with correct |EntryStaleness| data.
 TEST(HostCacheTest, Stale) {
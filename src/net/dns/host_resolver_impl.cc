@@ -1324,7 +1324,6 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
         worker_task_runner_(std::move(worker_task_runner)),
         had_non_speculative_request_(false),
         had_dns_config_(false),
-        num_occupied_job_slots_(0),
         dns_task_error_(OK),
         creation_time_(base::TimeTicks::Now()),
         priority_change_time_(creation_time_),
@@ -1368,23 +1367,15 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
     }
   }
 
-  // Add this job to the dispatcher.  If "at_head" is true, adds at the front
-  // of the queue.
-  void Schedule(bool at_head) {
+  // Add this job to the dispatcher.
+  void Schedule() {
     DCHECK(!is_queued());
-    PrioritizedDispatcher::Handle handle;
-    if (!at_head) {
-      handle = resolver_->dispatcher_->Add(this, priority());
-    } else {
-      handle = resolver_->dispatcher_->AddAtHead(this, priority());
-    }
-    // The dispatcher could have started |this| in the above call to Add, which
-    // could have called Schedule again. In that case |handle| will be null,
-    // but |handle_| may have been set by the other nested call to Schedule.
-    if (!handle.is_null()) {
-      DCHECK(handle_.is_null());
+    // The dispatcher could have started |this| in the call to Add, in which
+    // case the returned handle is null and must not be stored.
+    PrioritizedDispatcher::Handle handle =
+        resolver_->dispatcher_->Add(this, priority());
+    if (!handle.is_null())
       handle_ = handle;
-    }
   }
 
   void AddRequest(RequestImpl* request) {
@@ -1511,27 +1502,14 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
  private:
   void KillDnsTask() {
     if (dns_task_) {
-      ReduceToOneJobSlot();
+      // A running DnsTask occupies exactly one dispatcher slot; both of its
+      // transactions (if it has two) were started within that slot, so there
+      // is no queued second slot to cancel here.
+      DCHECK(!is_queued());
       dns_task_.reset();
     }
   }
 
-  // Reduce the number of job slots occupied and queued in the dispatcher
-  // to one. If the second Job slot is queued in the dispatcher, cancels the
-  // queued job. Otherwise, the second Job has been started by the
-  // PrioritizedDispatcher, so signals it is complete.
-  void ReduceToOneJobSlot() {
-    DCHECK_GE(num_occupied_job_slots_, 1u);
-    if (is_queued()) {
-      resolver_->dispatcher_->Cancel(handle_);
-      handle_.Reset();
-    } else if (num_occupied_job_slots_ > 1) {
-      resolver_->dispatcher_->OnJobFinished();
-      --num_occupied_job_slots_;
-    }
-    DCHECK_EQ(1u, num_occupied_job_slots_);
-  }
-
   // MakeCacheEntry() and MakeCacheEntryWithTTL() are helpers to build a
   // HostCache::Entry(). The address list is omited from the cache entry
   // for errors.
@@ -1567,17 +1545,9 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
   // PriorityDispatch::Job:
   void Start() override {
-    DCHECK_LE(num_occupied_job_slots_, 1u);
+    DCHECK(!is_running());
 
     handle_.Reset();
-    ++num_occupied_job_slots_;
-
-    if (num_occupied_job_slots_ == 2) {
-      StartSecondDnsTransaction();
-      return;
-    }
-
-    DCHECK(!is_running());
 
     net_log_.AddEvent(NetLogEventType::HOST_RESOLVER_IMPL_JOB_STARTED);
 
@@ -1672,14 +1642,13 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
                                 net_log_));
 
     dns_task_->StartFirstTransaction();
-    // Schedule a second transaction, if needed.
+    // A dual-family lookup cannot complete before the slower of its A and
+    // AAAA responses, so start the second transaction right away within this
+    // Job's dispatcher slot rather than queueing it for a slot of its own,
+    // which would serialize the two queries whenever the dispatcher is busy.
+    // Safe because DnsTransaction::Start never completes synchronously.
     if (dns_task_->needs_two_transactions())
-      Schedule(true);
-  }
-
-  void StartSecondDnsTransaction() {
-    DCHECK(dns_task_->needs_two_transactions());
-    dns_task_->StartSecondTransaction();
+      dns_task_->StartSecondTransaction();
   }
 
   // Called if DnsTask fails. It is posted from StartDnsTask, so Job may be
@@ -1755,15 +1724,10 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
 
   void OnFirstDnsTransactionComplete() override {
     DCHECK(dns_task_->needs_two_transactions());
-    DCHECK_EQ(dns_task_->needs_another_transaction(), is_queued());
-    // No longer need to occupy two dispatcher slots.
-    ReduceToOneJobSlot();
-
-    // We already have a job slot at the dispatcher, so if the second
-    // transaction hasn't started, reuse it now instead of waiting in the queue
-    // for the second slot.
-    if (dns_task_->needs_another_transaction())
-      dns_task_->StartSecondTransaction();
+    // Both transactions are started together in StartDnsTask and share this
+    // Job's single dispatcher slot, so there is nothing to start or release
+    // here; the Job simply waits for the remaining transaction.
+    DCHECK(!dns_task_->needs_another_transaction());
   }
 
   // Performs Job's last rites. Completes all Requests. Deletes this.
@@ -1876,9 +1840,6 @@ class HostResolverImpl::Job : public PrioritizedDispatcher::Job,
   // Distinguishes measurements taken while DnsClient was fully configured.
   bool had_dns_config_;
 
-  // Number of slots occupied by this Job in resolver's PrioritizedDispatcher.
-  unsigned num_occupied_job_slots_;
-
   // Result of DnsTask.
   int dns_task_error_;
 
@@ -1975,7 +1936,7 @@ int HostResolverImpl::Resolve(const RequestInfo& info,
   if (jobit == jobs_.end()) {
     job = new Job(weak_ptr_factory_.GetWeakPtr(), key, priority,
                   worker_task_runner_, source_net_log);
-    job->Schedule(false);
+    job->Schedule();
 
     // Check for queue overflow.
     if (dispatcher_->num_queued_jobs() > max_queued_jobs_) {
@@ -2447,9 +2408,9 @@ void HostResolverImpl::AbortAllInProgressJobs() {
   }
 
   // Pause the dispatcher so it won't start any new dispatcher jobs while
-  // aborting the old ones.  This is needed so that it won't start the second
-  // DnsTransaction for a job in |jobs_to_abort| if the DnsConfig just became
-  // invalid.
+  // aborting the old ones.  This is needed so that a queued Job isn't started
+  // against the DnsConfig that just became invalid as slots are released by
+  // the jobs in |jobs_to_abort|.
   PrioritizedDispatcher::Limits limits = dispatcher_->GetLimits();
   dispatcher_->SetLimits(
       PrioritizedDispatcher::Limits(limits.reserved_slots.size(), 0));
@@ -2469,8 +2430,8 @@ void HostResolverImpl::AbortAllInProgressJobs() {
 
 void HostResolverImpl::AbortDnsTasks() {
   // Pause the dispatcher so it won't start any new dispatcher jobs while
-  // aborting the old ones.  This is needed so that it won't start the second
-  // DnsTransaction for a job if the DnsConfig just changed.
+  // aborting the old ones.  This is needed so that a queued Job isn't started
+  // against the DnsConfig that just changed.
   PrioritizedDispatcher::Limits limits = dispatcher_->GetLimits();
   dispatcher_->SetLimits(
       PrioritizedDispatcher::Limits(limits.reserved_slots.size(), 0));
@@ -2636,10 +2597,24 @@ void HostResolverImpl::InitializePersistence(
 }
 
 void HostResolverImpl::ApplyPersistentData(
-    std::unique_ptr<const base::Value> data) {}
+    std::unique_ptr<const base::Value> data) {
+  if (!cache_ || !data)
+    return;
+  const base::ListValue* entry_list;
+  if (!data->GetAsList(&entry_list))
+    return;
+  // Restored entries keep their original expiration times, so anything whose
+  // TTL lapsed while the process was down is only usable for stale lookups.
+  // Entries already resolved on this run take precedence over restored ones.
+  cache_->RestoreFromListValue(*entry_list);
+}
 
 std::unique_ptr<const base::Value> HostResolverImpl::GetPersistentData() {
-  return std::unique_ptr<const base::Value>();
+  if (!cache_)
+    return std::unique_ptr<const base::Value>();
+  auto entry_list = base::MakeUnique<base::ListValue>();
+  cache_->GetAsListValue(entry_list.get(), false /* include_staleness */);
+  return std::move(entry_list);
 }
 
 void HostResolverImpl::SchedulePersist() {
@@ -19,6 +19,7 @@
 #include "base/run_loop.h"
 #include "base/single_thread_task_runner.h"
 #include "base/stl_util.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/condition_variable.h"
@@ -26,6 +27,7 @@
 #include "base/test/test_timeouts.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/time.h"
+#include "base/values.h"
 #include "net/base/address_list.h"
 #include "net/base/ip_address.h"
 #include "net/base/mock_network_change_notifier.h"
@@ -51,6 +53,8 @@ namespace {
 const size_t kMaxJobs = 10u;
 const size_t kMaxRetryAttempts = 4u;
 
+void DoNothingPersistCallback(std::unique_ptr<const base::Value> value) {}
+
 HostResolver::Options DefaultOptions() {
   HostResolver::Options options;
   options.max_concurrent_resolves = kMaxJobs;
@@ -1449,6 +1453,42 @@ TEST_F(HostResolverImplTest, ResolveStaleFromCache) {
   EXPECT_TRUE(requests_[5]->staleness().is_stale());
 }
 
+// Test that serialized cache contents handed to InitializePersistence are
+// restored into the cache and can be served to stale-tolerant lookups.
+TEST_F(HostResolverImplTest, InitializePersistenceRestoresCache) {
+  // Build a serialized entry in the format produced by
+  // HostCache::GetAsListValue.
+  auto entry_dict = base::MakeUnique<base::DictionaryValue>();
+  entry_dict->SetString("hostname", "restored.testing");
+  entry_dict->SetInteger("address_family",
+                         static_cast<int>(ADDRESS_FAMILY_IPV4));
+  entry_dict->SetInteger("flags", 0);
+  entry_dict->SetString(
+      "expiration",
+      base::Int64ToString(
+          (base::Time::Now() + base::TimeDelta::FromHours(1))
+              .ToInternalValue()));
+  auto addresses = base::MakeUnique<base::ListValue>();
+  addresses->AppendString("192.168.1.99");
+  entry_dict->SetList("addresses", std::move(addresses));
+  auto old_data = base::MakeUnique<base::ListValue>();
+  old_data->Append(std::move(entry_dict));
+
+  resolver_->InitializePersistence(base::Bind(&DoNothingPersistCallback),
+                                   std::move(old_data));
+
+  // Restored entries are marked as received on a previous network, so they
+  // are only eligible for stale-allowing lookups.
+  HostResolver::RequestInfo info(HostPortPair("restored.testing", 80));
+  info.set_address_family(ADDRESS_FAMILY_IPV4);
+  EXPECT_EQ(ERR_DNS_CACHE_MISS,
+            CreateRequest(info, DEFAULT_PRIORITY)->ResolveFromCache());
+  EXPECT_THAT(CreateRequest(info, DEFAULT_PRIORITY)->ResolveStaleFromCache(),
+              IsOk());
+  EXPECT_TRUE(requests_[1]->HasOneAddress("192.168.1.99", 80));
+  EXPECT_TRUE(requests_[1]->staleness().is_stale());
+}
+
 // Test the retry attempts simulating host resolver proc that takes too long.
 TEST_F(HostResolverImplTest, MultipleAttempts) {
   // Total number of attempts would be 3 and we want the 3rd attempt to resolve
@@ -2147,8 +2187,9 @@ TEST_F(HostResolverImplDnsTest, CancelWithOneTransactionActive) {
   // Dispatcher state checked in TearDown.
 }
 
-// Cancel a request with a single DNS transaction active and another pending.
-TEST_F(HostResolverImplDnsTest, CancelWithOneTransactionActiveOnePending) {
+// Cancel a request with both DNS transactions running in the only available
+// dispatcher slot.
+TEST_F(HostResolverImplDnsTest, CancelWithTwoTransactionsActiveOneSlot) {
   CreateSerialResolver();
   ChangeDnsConfig(CreateValidDnsConfig());
 
@@ -2164,7 +2205,8 @@ TEST_F(HostResolverImplDnsTest, CancelWithTwoTransactionsActive) {
   ChangeDnsConfig(CreateValidDnsConfig());
 
   EXPECT_THAT(CreateRequest("ok", 80)->Resolve(), IsError(ERR_IO_PENDING));
-  EXPECT_EQ(2u, num_running_dispatcher_jobs());
+  // Both transactions are started within the Job's single dispatcher slot.
+  EXPECT_EQ(1u, num_running_dispatcher_jobs());
   requests_[0]->Cancel();
 
   // Dispatcher state checked in TearDown.
@@ -2181,9 +2223,9 @@ TEST_F(HostResolverImplDnsTest, DeleteWithActiveTransactions) {
   EXPECT_EQ(ERR_IO_PENDING, CreateRequest("ok", 80, MEDIUM,
                                           ADDRESS_FAMILY_IPV4)->Resolve());
 
-  // Add 10 more DNS lookups for different hostnames.  First 4 should have two
-  // active jobs, next one has a single active job, and one pending.  Others
-  // should all be queued.
+  // Add 10 more DNS lookups for different hostnames.  Each job takes a single
+  // dispatcher slot, so the first 9 of these should be active and the last
+  // one queued.
   for (int i = 0; i < 10; ++i) {
     EXPECT_EQ(ERR_IO_PENDING, CreateRequest(
         base::StringPrintf("ok%i", i))->Resolve());
@@ -2199,7 +2241,7 @@ TEST_F(HostResolverImplDnsTest, CancelWithIPv6TransactionActive) {
 
   EXPECT_THAT(CreateRequest("6slow_ok", 80)->Resolve(),
               IsError(ERR_IO_PENDING));
-  EXPECT_EQ(2u, num_running_dispatcher_jobs());
+  EXPECT_EQ(1u, num_running_dispatcher_jobs());
 
   // The IPv4 request should complete, the IPv6 request is still pending.
   base::RunLoop().RunUntilIdle();
@@ -2216,7 +2258,7 @@ TEST_F(HostResolverImplDnsTest, CancelWithIPv4TransactionPending) {
 
   EXPECT_THAT(CreateRequest("4slow_ok", 80)->Resolve(),
               IsError(ERR_IO_PENDING));
-  EXPECT_EQ(2u, num_running_dispatcher_jobs());
+  EXPECT_EQ(1u, num_running_dispatcher_jobs());
 
   // The IPv6 request should complete, the IPv4 request is still pending.
   base::RunLoop().RunUntilIdle();
@@ -2265,7 +2307,7 @@ TEST_F(HostResolverImplDnsTest, AAAACompletesFirst) {
   EXPECT_THAT(requests_[2]->result(), IsError(ERR_DNS_TIMED_OUT));
 }
 
-// Test the case where only a single transaction slot is available.
+// Test the case where only a single dispatcher slot is available.
 TEST_F(HostResolverImplDnsTest, SerialResolver) {
   CreateSerialResolver();
   set_fallback_to_proctask(false);
@@ -2282,9 +2324,10 @@ TEST_F(HostResolverImplDnsTest, SerialResolver) {
   EXPECT_TRUE(requests_[0]->HasAddress("::1", 80));
 }
 
-// Test the case where the AAAA query is started when another transaction
-// completes.
-TEST_F(HostResolverImplDnsTest, AAAAStartsAfterOtherJobFinishes) {
+// Test that a dual-family job runs both of its transactions within a single
+// dispatcher slot, so a saturated dispatcher does not serialize the A and
+// AAAA queries of one lookup.
+TEST_F(HostResolverImplDnsTest, DualTransactionsUseSingleDispatcherSlot) {
   CreateResolverWithLimitsAndParams(2u, DefaultParams(proc_.get()));
   set_fallback_to_proctask(false);
   ChangeDnsConfig(CreateValidDnsConfig());
@@ -2293,11 +2336,12 @@ TEST_F(HostResolverImplDnsTest, AAAAStartsAfterOtherJobFinishes) {
                                           ADDRESS_FAMILY_IPV4)->Resolve());
   EXPECT_EQ(ERR_IO_PENDING,
             CreateRequest("4slow_ok", 80, MEDIUM)->Resolve());
-  // An IPv4 request should have been started pending for each job.
+  // Each job occupies one slot, even though the second one is running both an
+  // A and an AAAA transaction.
   EXPECT_EQ(2u, num_running_dispatcher_jobs());
 
-  // Request 0's IPv4 request should complete, starting Request 1's IPv6
-  // request, which should also complete.
+  // Request 0 and Request 1's IPv6 transaction should complete; Request 1
+  // still waits for its delayed IPv4 transaction.
   base::RunLoop().RunUntilIdle();
   EXPECT_EQ(1u, num_running_dispatcher_jobs());
   EXPECT_TRUE(requests_[0]->completed());
@@ -2339,11 +2383,10 @@ TEST_F(HostResolverImplDnsTest, UnspecEmptyFallback) {
 
 // Tests getting a new invalid DnsConfig while there are active DnsTasks.
 TEST_F(HostResolverImplDnsTest, InvalidDnsConfigWithPendingRequests) {
-  // At most 3 jobs active at once.  This number is important, since we want to
-  // make sure that aborting the first HostResolverImpl::Job does not trigger
-  // another DnsTransaction on the second Job when it releases its second
-  // prioritized dispatcher slot.
-  CreateResolverWithLimitsAndParams(3u, DefaultParams(proc_.get()));
+  // At most 2 jobs active at once.  This number is important, since we want
+  // the third job to still be queued when the DnsConfig becomes invalid, so
+  // that it starts with a ProcTask rather than being aborted.
+  CreateResolverWithLimitsAndParams(2u, DefaultParams(proc_.get()));
 
   ChangeDnsConfig(CreateValidDnsConfig());
 
@@ -2351,13 +2394,12 @@ TEST_F(HostResolverImplDnsTest, InvalidDnsConfigWithPendingRequests) {
   proc_->AddRuleForAllFamilies("slow_nx2", "192.168.0.2");
   proc_->AddRuleForAllFamilies("ok", "192.168.0.3");
 
-  // First active job gets two slots.
   EXPECT_THAT(CreateRequest("slow_nx1")->Resolve(), IsError(ERR_IO_PENDING));
-  // Next job gets one slot, and waits on another.
   EXPECT_THAT(CreateRequest("slow_nx2")->Resolve(), IsError(ERR_IO_PENDING));
+  // Next one is queued.
   EXPECT_THAT(CreateRequest("ok")->Resolve(), IsError(ERR_IO_PENDING));
 
-  EXPECT_EQ(3u, num_running_dispatcher_jobs());
+  EXPECT_EQ(2u, num_running_dispatcher_jobs());
 
   // Clear DNS config.  Two in-progress jobs should be aborted, and the next one
   // should use a ProcTask.
@@ -2378,10 +2420,9 @@ TEST_F(HostResolverImplDnsTest, InvalidDnsConfigWithPendingRequests) {
 TEST_F(HostResolverImplDnsTest,
        AutomaticallyDisableDnsClientWithPendingRequests) {
   // Trying different limits is important for this test:  Different limits
-  // result in different behavior when aborting in-progress DnsTasks.  Having
-  // a DnsTask that has one job active and one in the queue when another job
-  // occupying two slots has its DnsTask aborted is the case most likely to run
-  // into problems.
+  // result in different numbers of jobs in progress and in the queue at the
+  // point the DnsClient is disabled and the in-progress DnsTasks are
+  // aborted.
   for (size_t limit = 1u; limit < 6u; ++limit) {
     CreateResolverWithLimitsAndParams(limit, DefaultParams(proc_.get()));
 
@@ -2425,10 +2466,8 @@ TEST_F(HostResolverImplDnsTest,
 
 // Tests a call to SetDnsClient while there are active DnsTasks.
 TEST_F(HostResolverImplDnsTest, ManuallyDisableDnsClientWithPendingRequests) {
-  // At most 3 jobs active at once.  This number is important, since we want to
-  // make sure that aborting the first HostResolverImpl::Job does not trigger
-  // another DnsTransaction on the second Job when it releases its second
-  // prioritized dispatcher slot.
+  // At most 3 jobs active at once, so that all three jobs below are running
+  // DnsTasks when the DnsClient is cleared.
   CreateResolverWithLimitsAndParams(3u, DefaultParams(proc_.get()));
 
   ChangeDnsConfig(CreateValidDnsConfig());
@@ -2437,11 +2476,8 @@ TEST_F(HostResolverImplDnsTest, ManuallyDisableDnsClientWithPendingRequests) {
   proc_->AddRuleForAllFamilies("slow_ok2", "192.168.0.2");
   proc_->AddRuleForAllFamilies("ok", "192.168.0.3");
 
-  // First active job gets two slots.
   EXPECT_THAT(CreateRequest("slow_ok1")->Resolve(), IsError(ERR_IO_PENDING));
-  // Next job gets one slot, and waits on another.
   EXPECT_THAT(CreateRequest("slow_ok2")->Resolve(), IsError(ERR_IO_PENDING));
-  // Next one is queued.
   EXPECT_THAT(CreateRequest("ok")->Resolve(), IsError(ERR_IO_PENDING));
 
   EXPECT_EQ(3u, num_running_dispatcher_jobs());
@@ -7,7 +7,9 @@
 #include <algorithm>
 #include <tuple>
 #include <utility>
+#include <vector>
 
+#include "base/logging.h"
 #include "base/strings/string_number_conversions.h"
 #include "net/dns/dns_protocol.h"
 #include "net/dns/record_parsed.h"
@@ -60,6 +62,24 @@ MDnsCache::Key MDnsCache::Key::CreateFor(const RecordParsed* record) {
              GetOptionalFieldForRecord(record));
 }
 
+bool MDnsCache::KeyComparator::operator()(const Key& a,
+                                          const KeyView& b) const {
+  if (a.name() != b.name)
+    return a.name() < b.name;
+  if (a.type() != b.type)
+    return a.type() < b.type;
+  return a.optional() < b.optional;
+}
+
+bool MDnsCache::KeyComparator::operator()(const KeyView& a,
+                                          const Key& b) const {
+  if (a.name != b.name())
+    return a.name < b.name();
+  if (a.type != b.type())
+    return a.type < b.type();
+  return a.optional < b.optional();
+}
+
 
 MDnsCache::MDnsCache() {
 }
@@ -84,8 +104,6 @@ MDnsCache::UpdateType MDnsCache::UpdateDnsRecord(
     return NoChange;
 
   base::Time new_expiration = GetEffectiveExpiration(record.get());
-  if (next_expiration_ != base::Time())
-    new_expiration = std::min(new_expiration, next_expiration_);
 
   std::pair<RecordMap::iterator, bool> insert_result =
       mdns_cache_.insert(std::make_pair(cache_key, nullptr));
@@ -97,38 +115,42 @@ MDnsCache::UpdateType MDnsCache::UpdateDnsRecord(
         !record->IsEqual(insert_result.first->second.get(), true)) {
       type = RecordChanged;
     }
+    // The replaced record is indexed under its old expiration time.
+    RemoveFromExpiryIndex(insert_result.first);
   }
 
   insert_result.first->second = std::move(record);
-  next_expiration_ = new_expiration;
+  expiry_index_.insert(std::make_pair(new_expiration, insert_result.first));
+  next_expiration_ = expiry_index_.begin()->first;
   return type;
 }
 
 void MDnsCache::CleanupRecords(
     base::Time now,
     const RecordRemovedCallback& record_removed_callback) {
-  base::Time next_expiration;
-
   // We are guaranteed that |next_expiration_| will be at or before the next
   // expiration. This allows clients to eagrely call CleanupRecords with
   // impunity.
   if (now < next_expiration_) return;
 
-  for (RecordMap::iterator i = mdns_cache_.begin();
-       i != mdns_cache_.end(); ) {
-    base::Time expiration = GetEffectiveExpiration(i->second.get());
-    if (now >= expiration) {
-      record_removed_callback.Run(i->second.get());
-      mdns_cache_.erase(i++);
-    } else {
-      if (next_expiration == base::Time() ||  expiration < next_expiration) {
-        next_expiration = expiration;
-      }
-      ++i;
-    }
+  // Pop due entries off the front of the expiry index, touching only the
+  // records that actually expired.
+  std::vector<std::unique_ptr<const RecordParsed>> removed_records;
+  while (!expiry_index_.empty() && now >= expiry_index_.begin()->first) {
+    RecordMap::iterator record_it = expiry_index_.begin()->second;
+    removed_records.push_back(std::move(record_it->second));
+    mdns_cache_.erase(record_it);
+    expiry_index_.erase(expiry_index_.begin());
   }
 
-  next_expiration_ = next_expiration;
+  next_expiration_ = expiry_index_.empty() ? base::Time()
+                                           : expiry_index_.begin()->first;
+
+  // Deliver the removals in one batch now that the cache is consistent, so
+  // the callback may re-enter the cache.
+  for (const auto& record : removed_records) {
+    record_removed_callback.Run(record.get());
+  }
 }
 
 void MDnsCache::FindDnsRecords(unsigned type,
@@ -138,7 +160,8 @@ void MDnsCache::FindDnsRecords(unsigned type,
   DCHECK(results);
   results->clear();
 
-  RecordMap::const_iterator i = mdns_cache_.lower_bound(Key(type, name, ""));
+  RecordMap::const_iterator i =
+      mdns_cache_.lower_bound(KeyView(type, name, base::StringPiece()));
   for (; i != mdns_cache_.end(); ++i) {
     if (i->first.name() != name ||
         (type != 0 && i->first.type() != type)) {
@@ -160,14 +183,28 @@ std::unique_ptr<const RecordParsed> MDnsCache::RemoveRecord(
   RecordMap::iterator found = mdns_cache_.find(key);
 
   if (found != mdns_cache_.end() && found->second.get() == record) {
+    RemoveFromExpiryIndex(found);
     std::unique_ptr<const RecordParsed> result = std::move(found->second);
-    mdns_cache_.erase(key);
+    mdns_cache_.erase(found);
     return result;
   }
 
   return std::unique_ptr<const RecordParsed>();
 }
 
+void MDnsCache::RemoveFromExpiryIndex(RecordMap::iterator record_it) {
+  base::Time expiration = GetEffectiveExpiration(record_it->second.get());
+  std::pair<ExpiryIndex::iterator, ExpiryIndex::iterator> range =
+      expiry_index_.equal_range(expiration);
+  for (ExpiryIndex::iterator i = range.first; i != range.second; ++i) {
+    if (i->second == record_it) {
+      expiry_index_.erase(i);
+      return;
+    }
+  }
+  NOTREACHED() << "Record missing from expiry index.";
+}
+
 // static
 std::string MDnsCache::GetOptionalFieldForRecord(const RecordParsed* record) {
   switch (record->type()) {
@@ -12,6 +12,7 @@
 
 #include "base/callback.h"
 #include "base/macros.h"
+#include "base/strings/string_piece.h"
 #include "base/time/time.h"
 #include "net/base/net_export.h"
 
@@ -50,6 +51,30 @@ class NET_EXPORT_PRIVATE MDnsCache {
     std::string optional_;
   };
 
+  // A borrowed view of a key, used to probe the record map without copying
+  // the name and optional strings. The viewed strings must outlive any
+  // lookup made with the view.
+  struct KeyView {
+    KeyView(unsigned type,
+            base::StringPiece name,
+            base::StringPiece optional)
+        : type(type), name(name), optional(optional) {}
+
+    unsigned type;
+    base::StringPiece name;
+    base::StringPiece optional;
+  };
+
+  // Orders Key and KeyView interchangeably on (name, type, optional), so
+  // map lookups can be made from borrowed strings.
+  struct KeyComparator {
+    using is_transparent = void;
+
+    bool operator()(const Key& a, const Key& b) const { return a < b; }
+    bool operator()(const Key& a, const KeyView& b) const;
+    bool operator()(const KeyView& a, const Key& b) const;
+  };
+
   typedef base::Callback<void(const RecordParsed*)> RecordRemovedCallback;
 
   enum UpdateType {
@@ -78,8 +103,9 @@ class NET_EXPORT_PRIVATE MDnsCache {
                       std::vector<const RecordParsed*>* records,
                       base::Time now) const;
 
-  // Remove expired records, call |record_removed_callback| for every removed
-  // record.
+  // Remove expired records, then call |record_removed_callback| for every
+  // removed record. The callbacks are delivered in one batch after the cache
+  // is consistent again, so they may safely re-enter the cache.
   void CleanupRecords(base::Time now,
                       const RecordRemovedCallback& record_removed_callback);
 
@@ -93,7 +119,13 @@ class NET_EXPORT_PRIVATE MDnsCache {
   std::unique_ptr<const RecordParsed> RemoveRecord(const RecordParsed* record);
 
  private:
-  typedef std::map<Key, std::unique_ptr<const RecordParsed>> RecordMap;
+  typedef std::map<Key, std::unique_ptr<const RecordParsed>, KeyComparator>
+      RecordMap;
+
+  // Secondary index ordered on expiration time, so expiry only touches the
+  // records that are actually due instead of scanning the whole map. Map
+  // iterators stay valid across unrelated inserts and erases.
+  typedef std::multimap<base::Time, RecordMap::iterator> ExpiryIndex;
 
   // Get the effective expiration of a cache entry, based on its creation time
   // and TTL. Does adjustments so entries with a TTL of zero will have a
@@ -105,8 +137,13 @@ class NET_EXPORT_PRIVATE MDnsCache {
   // for the same name.
   static std::string GetOptionalFieldForRecord(const RecordParsed* record);
 
+  // Removes the expiry-index entry pointing at |record_it|.
+  void RemoveFromExpiryIndex(RecordMap::iterator record_it);
+
   RecordMap mdns_cache_;
 
+  ExpiryIndex expiry_index_;
+
   base::Time next_expiration_;
 
   DISALLOW_COPY_AND_ASSIGN(MDnsCache);
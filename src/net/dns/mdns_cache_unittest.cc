@@ -258,6 +258,83 @@ TEST_F(MDnsCacheTest, RecordPreemptExpirationTime) {
   EXPECT_EQ(default_time_ + ttl1, cache_.next_expiration());
 }
 
+// Test that a replacing record reindexes the entry under its own expiration
+// time, including pushing the next expiration further out.
+TEST_F(MDnsCacheTest, ExpiryIndexFollowsRecordUpdate) {
+  DnsRecordParser parser(kTestResponsesSameAnswers,
+                         sizeof(kTestResponsesSameAnswers),
+                         0);
+
+  std::unique_ptr<const RecordParsed> record1;
+  std::unique_ptr<const RecordParsed> record2;
+  std::vector<const RecordParsed*> results;
+
+  record1 = RecordParsed::CreateFrom(&parser, default_time_);
+  record2 = RecordParsed::CreateFrom(&parser, default_time_);
+  base::TimeDelta ttl1 = base::TimeDelta::FromSeconds(record1->ttl());
+  base::TimeDelta ttl2 = base::TimeDelta::FromSeconds(record2->ttl());
+  ASSERT_LT(ttl1, ttl2);
+
+  EXPECT_EQ(MDnsCache::RecordAdded, cache_.UpdateDnsRecord(std::move(record1)));
+  EXPECT_EQ(default_time_ + ttl1, cache_.next_expiration());
+  EXPECT_EQ(MDnsCache::NoChange, cache_.UpdateDnsRecord(std::move(record2)));
+  EXPECT_EQ(default_time_ + ttl2, cache_.next_expiration());
+
+  // Nothing expires at the replaced record's old expiration time.
+  cache_.CleanupRecords(default_time_ + ttl1, base::Bind(
+      &RecordRemovalMock::OnRecordRemoved, base::Unretained(&record_removal_)));
+  cache_.FindDnsRecords(ARecordRdata::kType, "ghs.l.google.com", &results,
+                        default_time_ + ttl1);
+  EXPECT_EQ(1u, results.size());
+}
+
+// The removal callbacks are delivered after the expired records have been
+// dropped, so they may safely look back into the cache.
+class ReentrantRemovalHandler {
+ public:
+  explicit ReentrantRemovalHandler(MDnsCache* cache)
+      : cache_(cache), num_removed_(0), records_seen_(0) {}
+
+  void OnRecordRemoved(const RecordParsed* record) {
+    std::vector<const RecordParsed*> results;
+    cache_->FindDnsRecords(0, record->name(), &results, base::Time());
+    records_seen_ += results.size();
+    ++num_removed_;
+  }
+
+  int num_removed() const { return num_removed_; }
+  size_t records_seen() const { return records_seen_; }
+
+ private:
+  MDnsCache* cache_;
+  int num_removed_;
+  size_t records_seen_;
+};
+
+TEST_F(MDnsCacheTest, CleanupDeliversRemovalsInBatch) {
+  DnsRecordParser parser(kT1ResponseDatagram, sizeof(kT1ResponseDatagram),
+                         sizeof(dns_protocol::Header));
+  parser.SkipQuestion();
+
+  std::unique_ptr<const RecordParsed> record1 =
+      RecordParsed::CreateFrom(&parser, default_time_);
+  std::unique_ptr<const RecordParsed> record2 =
+      RecordParsed::CreateFrom(&parser, default_time_);
+
+  EXPECT_EQ(MDnsCache::RecordAdded, cache_.UpdateDnsRecord(std::move(record1)));
+  EXPECT_EQ(MDnsCache::RecordAdded, cache_.UpdateDnsRecord(std::move(record2)));
+
+  ReentrantRemovalHandler handler(&cache_);
+  cache_.CleanupRecords(
+      default_time_ + base::TimeDelta::FromDays(1),
+      base::Bind(&ReentrantRemovalHandler::OnRecordRemoved,
+                 base::Unretained(&handler)));
+  EXPECT_EQ(2, handler.num_removed());
+  // By the time the callbacks ran, the expired records were already gone.
+  EXPECT_EQ(0u, handler.records_seen());
+  EXPECT_EQ(base::Time(), cache_.next_expiration());
+}
+
 // Test that the cache handles mDNS "goodbye" packets correctly, not adding the
 // records to the cache if they are not already there, and eventually removing
 // records from the cache if they are.
@@ -271,12 +271,15 @@ void MDnsClientImpl::Core::HandlePacket(DnsResponse* response,
     MDnsCache::Key update_key = MDnsCache::Key::CreateFor(record.get());
     MDnsCache::UpdateType update = cache_.UpdateDnsRecord(std::move(record));
 
-    // Cleanup time may have changed.
-    ScheduleCleanup(cache_.next_expiration());
-
     update_keys.insert(std::make_pair(update_key, update));
   }
 
+  if (!update_keys.empty()) {
+    // Cleanup time may have changed; reschedule once for the whole packet
+    // rather than after every record.
+    ScheduleCleanup(cache_.next_expiration());
+  }
+
   for (std::map<MDnsCache::Key, MDnsCache::UpdateType>::iterator i =
            update_keys.begin(); i != update_keys.end(); i++) {
     const RecordParsed* record = cache_.LookupKey(i->first);
@@ -141,8 +141,14 @@ int FilterSourceStream::DoReadDataComplete(int result) {
   DCHECK_NE(ERR_IO_PENDING, result);
 
   if (result >= OK) {
-    drainable_input_buffer_ =
-        new DrainableIOBuffer(input_buffer_.get(), result);
+    // Reuse the wrapper across reads rather than allocating a fresh
+    // DrainableIOBuffer for every chunk; it always wraps |input_buffer_|.
+    if (drainable_input_buffer_) {
+      drainable_input_buffer_->SetSize(result);
+    } else {
+      drainable_input_buffer_ =
+          new DrainableIOBuffer(input_buffer_.get(), result);
+    }
     next_state_ = STATE_FILTER_DATA;
   }
   if (result <= OK)
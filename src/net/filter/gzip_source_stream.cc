@@ -4,13 +4,17 @@
 
 #include "net/filter/gzip_source_stream.h"
 
+#include <stdlib.h>
+
 #include <algorithm>
 #include <utility>
 
 #include "base/bind.h"
 #include "base/bit_cast.h"
+#include "base/lazy_instance.h"
 #include "base/logging.h"
 #include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
 #include "net/base/io_buffer.h"
 #include "third_party/zlib/zlib.h"
 
@@ -30,6 +34,67 @@ const char kGzipFallback[] = "GZIP_FALLBACK";
 // shouldn't affect memory usage, in practice.
 const int kMaxZlibHeaderSniffBytes = 1000;
 
+// zlib makes the same handful of fixed-size allocations (the inflate state
+// and a 32K sliding window) for every stream, so recycle freed blocks rather
+// than going back to the heap allocator each time a response is decompressed.
+// Blocks are matched by exact size, and at most |kMaxRecycledBytes| are kept
+// cached across all streams.
+const size_t kMaxRecycledBytes = 256 * 1024;
+
+struct RecycledBlock {
+  RecycledBlock* next;
+  size_t size;
+};
+
+struct ZlibBlockPool {
+  base::Lock lock;
+  RecycledBlock* free_list = nullptr;
+  size_t cached_bytes = 0;
+};
+
+base::LazyInstance<ZlibBlockPool>::Leaky g_zlib_block_pool =
+    LAZY_INSTANCE_INITIALIZER;
+
+voidpf RecyclingZlibAlloc(voidpf opaque, uInt items, uInt size) {
+  size_t bytes = static_cast<size_t>(items) * size;
+  ZlibBlockPool* pool = g_zlib_block_pool.Pointer();
+  {
+    base::AutoLock auto_lock(pool->lock);
+    for (RecycledBlock** link = &pool->free_list; *link;
+         link = &(*link)->next) {
+      RecycledBlock* block = *link;
+      if (block->size == bytes) {
+        *link = block->next;
+        pool->cached_bytes -= bytes;
+        return block + 1;
+      }
+    }
+  }
+  RecycledBlock* block =
+      static_cast<RecycledBlock*>(malloc(sizeof(RecycledBlock) + bytes));
+  if (!block)
+    return Z_NULL;
+  block->size = bytes;
+  return block + 1;
+}
+
+void RecyclingZlibFree(voidpf opaque, voidpf address) {
+  if (!address)
+    return;
+  RecycledBlock* block = static_cast<RecycledBlock*>(address) - 1;
+  ZlibBlockPool* pool = g_zlib_block_pool.Pointer();
+  {
+    base::AutoLock auto_lock(pool->lock);
+    if (pool->cached_bytes + block->size <= kMaxRecycledBytes) {
+      block->next = pool->free_list;
+      pool->free_list = block;
+      pool->cached_bytes += block->size;
+      return;
+    }
+  }
+  free(block);
+}
+
 }  // namespace
 
 GzipSourceStream::~GzipSourceStream() {
@@ -60,6 +125,9 @@ bool GzipSourceStream::Init() {
   if (!zlib_stream_)
     return false;
   memset(zlib_stream_.get(), 0, sizeof(z_stream));
+  zlib_stream_.get()->zalloc = &RecyclingZlibAlloc;
+  zlib_stream_.get()->zfree = &RecyclingZlibFree;
+  zlib_stream_.get()->opaque = Z_NULL;
 
   int ret;
   if (type() == TYPE_GZIP || type() == TYPE_GZIP_FALLBACK) {
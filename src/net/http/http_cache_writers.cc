@@ -15,6 +15,8 @@
 
 namespace net {
 
+const int HttpCache::Writers::kMaxTailBufferSize;
+
 HttpCache::Writers::Writers(disk_cache::Entry* disk_entry)
     : disk_entry_(disk_entry), weak_factory_(this) {}
 
@@ -183,6 +185,33 @@ void HttpCache::Writers::TruncateEntry() {
   DoLoop(OK);
 }
 
+int HttpCache::Writers::ReadFromTailBuffer(int64_t offset,
+                                           IOBuffer* buf,
+                                           int buf_len) const {
+  DCHECK(buf);
+  DCHECK_GT(buf_len, 0);
+  DCHECK_GE(offset, 0);
+
+  const int64_t end_offset = tail_start_offset_ + tail_buffer_.size();
+  if (offset < tail_start_offset_ || offset >= end_offset)
+    return ERR_CACHE_MISS;
+
+  int copy_len = static_cast<int>(
+      std::min(static_cast<int64_t>(buf_len), end_offset - offset));
+  memcpy(buf->data(), tail_buffer_.data() + (offset - tail_start_offset_),
+         copy_len);
+  return copy_len;
+}
+
+void HttpCache::Writers::AppendToTailBuffer(const char* data, int len) {
+  tail_buffer_.append(data, len);
+  if (tail_buffer_.size() > static_cast<size_t>(kMaxTailBufferSize)) {
+    size_t excess = tail_buffer_.size() - kMaxTailBufferSize;
+    tail_buffer_.erase(0, excess);
+    tail_start_offset_ += excess;
+  }
+}
+
 LoadState HttpCache::Writers::GetWriterLoadState() {
   DCHECK(network_transaction_);
   return network_transaction_->GetLoadState();
@@ -364,6 +393,12 @@ void HttpCache::Writers::OnDataReceived(int result) {
     // integration with HttpCache layer.
   }
 
+  // Exclusive requests can have no other writers, so there is nobody to
+  // serve from the tail buffer (and partial request offsets would not match
+  // body offsets anyway).
+  if (result > 0 && !is_exclusive_)
+    AppendToTailBuffer(read_buf_->data(), result);
+
   // Notify waiting_for_read_. Tasks will be posted for all the
   // transactions.
   ProcessWaitingForReadTransactions(write_len_);
@@ -5,8 +5,11 @@
 #ifndef NET_HTTP_HTTP_CACHE_WRITERS_H_
 #define NET_HTTP_HTTP_CACHE_WRITERS_H_
 
+#include <stdint.h>
+
 #include <list>
 #include <memory>
+#include <string>
 
 #include "base/memory/weak_ptr.h"
 #include "net/base/completion_callback.h"
@@ -96,6 +99,15 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
   // is no ongoing Read() call.
   void TruncateEntry();
 
+  // Serves response body bytes this object has already received out of an
+  // in-memory tail buffer, so a transaction that joins while the response is
+  // being written can catch up to the writer without a disk read. Copies up
+  // to |buf_len| bytes of the body starting at |offset| into |buf| and
+  // returns the number of bytes copied, or ERR_CACHE_MISS if the requested
+  // range is not resident (trimmed from the buffer, or not received yet), in
+  // which case the caller should read from the cache entry instead.
+  int ReadFromTailBuffer(int64_t offset, IOBuffer* buf, int buf_len) const;
+
   // Should be invoked only when writers has transactions attached to it and
   // thus has a valid network transaction.
   LoadState GetWriterLoadState();
@@ -107,6 +119,9 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
  private:
   friend class WritersTest;
 
+  // Most recent response body bytes kept resident for ReadFromTailBuffer.
+  static const int kMaxTailBufferSize = 256 * 1024;
+
   enum class State {
     UNSET,
     NONE,
@@ -173,6 +188,10 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
   // that are waiting for Read to be invoked by the consumer.
   bool ContainsOnlyIdleWriters() const;
 
+  // Appends a chunk of the response body to |tail_buffer_|, trimming its
+  // front so at most kMaxTailBufferSize bytes stay resident.
+  void AppendToTailBuffer(const char* data, int len);
+
   // IO Completion callback function.
   void OnIOComplete(int result);
 
@@ -214,6 +233,14 @@ class NET_EXPORT_PRIVATE HttpCache::Writers {
   // transactions.
   RequestPriority priority_ = MINIMUM_PRIORITY;
 
+  // Tail of the response body received so far, so transactions joining
+  // mid-response can be served from memory instead of re-reading from the
+  // entry what the writer just wrote. |tail_start_offset_| is the body
+  // offset of the first byte of |tail_buffer_|. Not maintained for
+  // exclusive (e.g. partial) requests, which can have no other writers.
+  std::string tail_buffer_;
+  int64_t tail_start_offset_ = 0;
+
   bool truncated_ = false;  // used for testing.
 
   CompletionCallback callback_;  // Callback for active_transaction_.
@@ -412,6 +412,15 @@ class WritersTest : public testing::Test {
     EXPECT_EQ(priority, writers_->priority_);
   }
 
+  // Accessors for the private tail buffer state.
+  void AppendToTailBuffer(const std::string& data) {
+    writers_->AppendToTailBuffer(data.data(), data.size());
+  }
+
+  int64_t TailStartOffset() const { return writers_->tail_start_offset_; }
+
+  int MaxTailBufferSize() const { return HttpCache::Writers::kMaxTailBufferSize; }
+
   MockHttpCache cache_;
   std::unique_ptr<HttpCache::Writers> writers_;
   disk_cache::Entry* disk_entry_;
@@ -661,4 +670,77 @@ TEST_F(WritersTest, TruncateEntry) {
   EXPECT_TRUE(writers_->IsTruncatedForTesting());
 }
 
+// Tests that body bytes read through Writers can be re-read from the tail
+// buffer by a transaction catching up to the writer.
+TEST_F(WritersTest, ReadFromTailBuffer) {
+  CreateWritersAddTransaction();
+
+  std::string expected(kSimpleGET_Transaction.data);
+
+  // Nothing has been received yet.
+  scoped_refptr<IOBuffer> buf(new IOBuffer(kDefaultBufferSize));
+  EXPECT_EQ(ERR_CACHE_MISS,
+            writers_->ReadFromTailBuffer(0, buf.get(), kDefaultBufferSize));
+
+  std::string content;
+  int rv = Read(&content);
+  EXPECT_THAT(rv, IsOk());
+  EXPECT_EQ(expected, content);
+
+  // The whole body is small enough to stay resident.
+  rv = writers_->ReadFromTailBuffer(0, buf.get(), kDefaultBufferSize);
+  ASSERT_EQ(static_cast<int>(expected.size()), rv);
+  EXPECT_EQ(expected, std::string(buf->data(), rv));
+
+  // Reads may start mid-body and are capped at the bytes received.
+  rv = writers_->ReadFromTailBuffer(5, buf.get(), kDefaultBufferSize);
+  ASSERT_EQ(static_cast<int>(expected.size()) - 5, rv);
+  EXPECT_EQ(expected.substr(5), std::string(buf->data(), rv));
+
+  // Offsets at or beyond the received bytes miss.
+  EXPECT_EQ(ERR_CACHE_MISS,
+            writers_->ReadFromTailBuffer(expected.size(), buf.get(),
+                                         kDefaultBufferSize));
+}
+
+// Tests that the tail buffer trims its oldest bytes at its size limit, and
+// that trimmed offsets report a miss.
+TEST_F(WritersTest, TailBufferTrimsOldestBytes) {
+  CreateWritersAddTransaction();
+
+  const int kMax = MaxTailBufferSize();
+  AppendToTailBuffer(std::string(kMax, 'a'));
+  EXPECT_EQ(0, TailStartOffset());
+
+  AppendToTailBuffer(std::string(100, 'b'));
+  EXPECT_EQ(100, TailStartOffset());
+
+  scoped_refptr<IOBuffer> buf(new IOBuffer(kDefaultBufferSize));
+
+  // The first 100 bytes were trimmed.
+  EXPECT_EQ(ERR_CACHE_MISS,
+            writers_->ReadFromTailBuffer(0, buf.get(), kDefaultBufferSize));
+  EXPECT_EQ(ERR_CACHE_MISS,
+            writers_->ReadFromTailBuffer(99, buf.get(), kDefaultBufferSize));
+
+  // The newest bytes are still served.
+  int rv = writers_->ReadFromTailBuffer(kMax + 100 - 10, buf.get(),
+                                        kDefaultBufferSize);
+  ASSERT_EQ(10, rv);
+  EXPECT_EQ(std::string(10, 'b'), std::string(buf->data(), rv));
+}
+
+// Tests that exclusive writers do not populate the tail buffer since no
+// other transaction can join them.
+TEST_F(WritersTest, TailBufferNotPopulatedWhenExclusive) {
+  CreateWritersAddTransaction(true /* is_exclusive */);
+
+  std::string content;
+  EXPECT_THAT(Read(&content), IsOk());
+
+  scoped_refptr<IOBuffer> buf(new IOBuffer(kDefaultBufferSize));
+  EXPECT_EQ(ERR_CACHE_MISS,
+            writers_->ReadFromTailBuffer(0, buf.get(), kDefaultBufferSize));
+}
+
 }  // namespace net
@@ -908,6 +908,12 @@ int HttpNetworkTransaction::DoInitStream() {
 int HttpNetworkTransaction::DoInitStreamComplete(int result) {
   if (result == OK) {
     next_state_ = STATE_GENERATE_PROXY_AUTH_TOKEN;
+    // The states between here and request building are synchronous for the
+    // trivial request, which is the overwhelmingly common case on a reused
+    // connection. Run them flattened; any step that deviates drops back
+    // into DoLoop() unchanged.
+    if (CanUseTrivialPreamble())
+      return RunTrivialPreamble();
   } else {
     if (result < 0)
       result = HandleIOError(result);
@@ -1019,6 +1025,45 @@ int HttpNetworkTransaction::DoGetReferredTokenBindingKeyComplete(int rv) {
   return rv;
 }
 
+bool HttpNetworkTransaction::CanUseTrivialPreamble() const {
+  return stream_ && stream_->IsConnectionReused() && !ShouldApplyProxyAuth();
+}
+
+int HttpNetworkTransaction::RunTrivialPreamble() {
+  // This chain performs the same calls DoLoop() would dispatch, in the same
+  // order and with the same next_state_ bookkeeping. Bailing out with a
+  // non-OK result therefore leaves next_state_ at the *_COMPLETE state the
+  // loop would have entered next, whether the result is ERR_IO_PENDING or a
+  // synchronous error.
+  int rv = DoGenerateProxyAuthToken();
+  if (rv != OK)
+    return rv;
+  rv = DoGenerateProxyAuthTokenComplete(OK);
+  DCHECK_EQ(OK, rv);
+  rv = DoGenerateServerAuthToken();
+  if (rv != OK)
+    return rv;
+  rv = DoGenerateServerAuthTokenComplete(OK);
+  DCHECK_EQ(OK, rv);
+  rv = DoGetProvidedTokenBindingKey();
+  if (rv != OK)
+    return rv;
+  rv = DoGetProvidedTokenBindingKeyComplete(OK);
+  DCHECK_EQ(OK, rv);
+  rv = DoGetReferredTokenBindingKey();
+  if (rv != OK)
+    return rv;
+  rv = DoGetReferredTokenBindingKeyComplete(OK);
+  DCHECK_EQ(OK, rv);
+  rv = DoInitRequestBody();
+  if (rv != OK)
+    return rv;
+  rv = DoInitRequestBodyComplete(OK);
+  DCHECK_EQ(OK, rv);
+  DCHECK_EQ(STATE_BUILD_REQUEST, next_state_);
+  return OK;
+}
+
 int HttpNetworkTransaction::BuildRequestHeaders(
     bool using_http_proxy_without_tunnel) {
   request_headers_.SetHeader(HttpRequestHeaders::kHost,
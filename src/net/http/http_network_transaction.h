@@ -215,6 +215,20 @@ class NET_EXPORT_PRIVATE HttpNetworkTransaction
   int DoDrainBodyForAuthRestart();
   int DoDrainBodyForAuthRestartComplete(int result);
 
+  // Whether the preamble states between stream initialization and request
+  // building may be run flattened, without returning to DoLoop() between
+  // them. True for the trivial request: a reused keep-alive connection with
+  // no proxy authentication to apply.
+  bool CanUseTrivialPreamble() const;
+
+  // Runs the states from STATE_GENERATE_PROXY_AUTH_TOKEN through
+  // STATE_INIT_REQUEST_BODY_COMPLETE as direct calls instead of DoLoop()
+  // dispatches. Each step still maintains next_state_, so the first step
+  // that completes asynchronously or fails returns to DoLoop() with the
+  // machine positioned exactly where the flattened run stopped. On full
+  // success returns OK with next_state_ == STATE_BUILD_REQUEST.
+  int RunTrivialPreamble();
+
   int BuildRequestHeaders(bool using_http_proxy_without_tunnel);
   int BuildTokenBindingHeader(std::string* out);
 
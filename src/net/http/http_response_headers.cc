@@ -272,6 +272,9 @@ void HttpResponseHeaders::Update(const HttpResponseHeaders& new_headers) {
 void HttpResponseHeaders::MergeWithHeaders(const std::string& raw_headers,
                                            const HeaderSet& headers_to_remove) {
   std::string new_raw_headers(raw_headers);
+  // The merged block is at most the replacement headers plus everything we
+  // already hold, so one reservation covers the whole splice loop.
+  new_raw_headers.reserve(raw_headers.size() + raw_headers_.size());
   for (size_t i = 0; i < parsed_.size(); ++i) {
     DCHECK(!parsed_[i].is_continuation());
 
@@ -324,27 +327,29 @@ void HttpResponseHeaders::RemoveHeaders(
 
 void HttpResponseHeaders::RemoveHeaderLine(const std::string& name,
                                            const std::string& value) {
-  std::string name_lowercase = base::ToLowerASCII(name);
-
   std::string new_raw_headers(GetStatusLine());
   new_raw_headers.push_back('\0');
 
   new_raw_headers.reserve(raw_headers_.size());
 
-  size_t iter = 0;
-  std::string old_header_name;
-  std::string old_header_value;
-  while (EnumerateHeaderLines(&iter, &old_header_name, &old_header_value)) {
-    std::string old_header_name_lowercase = base::ToLowerASCII(old_header_name);
-    if (name_lowercase == old_header_name_lowercase &&
-        value == old_header_value)
-      continue;
+  for (size_t i = 0; i < parsed_.size(); ++i) {
+    DCHECK(!parsed_[i].is_continuation());
+
+    // Locate the start of the next header.
+    size_t k = i;
+    while (++k < parsed_.size() && parsed_[k].is_continuation()) {}
+    --k;
+
+    StringPiece header_name(parsed_[i].name_begin, parsed_[i].name_end);
+    StringPiece header_value(parsed_[i].value_begin, parsed_[k].value_end);
+    if (!base::EqualsCaseInsensitiveASCII(header_name, name) ||
+        header_value != value) {
+      // Keep this header line, splicing its bytes verbatim.
+      new_raw_headers.append(parsed_[i].name_begin, parsed_[k].value_end);
+      new_raw_headers.push_back('\0');
+    }
 
-    new_raw_headers.append(old_header_name);
-    new_raw_headers.push_back(':');
-    new_raw_headers.push_back(' ');
-    new_raw_headers.append(old_header_value);
-    new_raw_headers.push_back('\0');
+    i = k;
   }
   new_raw_headers.push_back('\0');
 
@@ -411,6 +416,10 @@ void HttpResponseHeaders::UpdateWithNewRange(const HttpByteRange& byte_range,
 
 void HttpResponseHeaders::Parse(const std::string& raw_input) {
   raw_headers_.reserve(raw_input.size());
+  // One parsed entry per null-terminated header line in the common case
+  // (comma-separated values and continuations add more); reserving by
+  // separator count avoids regrowing parsed_ while tokenizing.
+  parsed_.reserve(std::count(raw_input.begin(), raw_input.end(), '\0'));
 
   // ParseStatusLine adds a normalized status line to raw_headers_
   std::string::const_iterator line_begin = raw_input.begin();
@@ -517,6 +526,23 @@ std::string HttpResponseHeaders::GetStatusText() const {
   return std::string(begin, end);
 }
 
+void HttpResponseHeaders::AppendRawHeaders(std::string* output) const {
+  // Each null separator becomes a CRLF, and the blank line ending the header
+  // block adds two more bytes.
+  output->reserve(output->size() + raw_headers_.size() +
+                  std::count(raw_headers_.begin(), raw_headers_.end(), '\0') +
+                  2);
+  // raw_headers_ ends with a double null; stop once only the final
+  // terminating null remains.
+  for (size_t begin = 0; begin + 1 < raw_headers_.size();) {
+    size_t end = raw_headers_.find('\0', begin);
+    output->append(raw_headers_, begin, end - begin);
+    output->append("\r\n");
+    begin = end + 1;
+  }
+  output->append("\r\n");
+}
+
 bool HttpResponseHeaders::EnumerateHeaderLines(size_t* iter,
                                                std::string* name,
                                                std::string* value) const {
@@ -295,6 +295,13 @@ class NET_EXPORT HttpResponseHeaders
   // Returns the raw header string.
   const std::string& raw_headers() const { return raw_headers_; }
 
+  // Appends the headers in HTTP/1.x wire format (the status line and each
+  // header line terminated with CRLF, followed by a blank line) to |output|.
+  // Header lines are spliced verbatim from the stored raw buffer and the
+  // output is reserved up front, so re-serializing a response whose headers
+  // are mostly untouched costs a single allocation plus byte copies.
+  void AppendRawHeaders(std::string* output) const;
+
  private:
   friend class base::RefCountedThreadSafe<HttpResponseHeaders>;
 
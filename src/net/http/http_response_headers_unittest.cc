@@ -489,6 +489,39 @@ INSTANTIATE_TEST_CASE_P(HttpResponseHeaders,
                         PersistenceTest,
                         testing::ValuesIn(persistence_tests));
 
+TEST(HttpResponseHeadersTest, AppendRawHeaders) {
+  std::string headers =
+      "HTTP/1.1 200 OK\n"
+      "Content-Length: 450\n"
+      "Cache-control: max-age=10000\n";
+  HeadersToRaw(&headers);
+  scoped_refptr<HttpResponseHeaders> parsed(new HttpResponseHeaders(headers));
+
+  std::string wire;
+  parsed->AppendRawHeaders(&wire);
+  EXPECT_EQ(
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 450\r\n"
+      "Cache-control: max-age=10000\r\n"
+      "\r\n",
+      wire);
+
+  // Appends after any existing output without disturbing it.
+  std::string prefixed = "GARBAGE";
+  parsed->AppendRawHeaders(&prefixed);
+  EXPECT_EQ("GARBAGE" + wire, prefixed);
+}
+
+TEST(HttpResponseHeadersTest, AppendRawHeadersNoHeaders) {
+  std::string headers = "HTTP/1.1 200 OK\n";
+  HeadersToRaw(&headers);
+  scoped_refptr<HttpResponseHeaders> parsed(new HttpResponseHeaders(headers));
+
+  std::string wire;
+  parsed->AppendRawHeaders(&wire);
+  EXPECT_EQ("HTTP/1.1 200 OK\r\n\r\n", wire);
+}
+
 TEST(HttpResponseHeadersTest, EnumerateHeader_Coalesced) {
   // Ensure that commas in quoted strings are not regarded as value separators.
   // Ensure that whitespace following a value is trimmed properly.
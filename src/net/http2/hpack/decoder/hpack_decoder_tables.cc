@@ -69,8 +69,7 @@ void HpackDecoderDynamicTable::DynamicTableSizeUpdate(size_t size_limit) {
 // peer are valid (e.g. are lower-case, no whitespace, etc.).
 bool HpackDecoderDynamicTable::Insert(const HpackString& name,
                                       const HpackString& value) {
-  HpackDecoderTableEntry entry(name, value);
-  size_t entry_size = entry.size();
+  size_t entry_size = HpackStringPair::SizeOf(name, value);
   DVLOG(2) << "InsertEntry of size=" << entry_size << "\n     name: " << name
            << "\n    value: " << value;
   if (entry_size > size_limit_) {
@@ -82,15 +81,18 @@ bool HpackDecoderDynamicTable::Insert(const HpackString& name,
     return false;  // Not inserted because too large.
   }
   ++insert_count_;
+  size_t insert_limit = size_limit_ - entry_size;
+  EnsureSizeNoMoreThan(insert_limit);
+  // Construct the entry in place, after eviction, so the strings are copied
+  // once rather than copied into a temporary and again into the table.
+  table_.emplace_front(name, value);
+  current_size_ += entry_size;
   if (debug_listener_ != nullptr) {
+    HpackDecoderTableEntry& entry = table_.front();
     entry.time_added = debug_listener_->OnEntryInserted(entry, insert_count_);
     DVLOG(2) << "OnEntryInserted returned time_added=" << entry.time_added
              << " for insert_count_=" << insert_count_;
   }
-  size_t insert_limit = size_limit_ - entry_size;
-  EnsureSizeNoMoreThan(insert_limit);
-  table_.push_front(entry);
-  current_size_ += entry_size;
   DVLOG(2) << "InsertEntry: current_size_=" << current_size_;
   DCHECK_GE(current_size_, entry_size);
   DCHECK_LE(current_size_, size_limit_);
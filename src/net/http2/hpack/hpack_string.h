@@ -61,7 +61,13 @@ struct HTTP2_EXPORT_PRIVATE HpackStringPair {
 
   // Returns the size of a header entry with this name and value, per the RFC:
   // http://httpwg.org/specs/rfc7541.html#calculating.table.size
-  size_t size() const { return 32 + name.size() + value.size(); }
+  size_t size() const { return SizeOf(name, value); }
+
+  // As above, but computable without first constructing an HpackStringPair
+  // (and hence without copying the strings).
+  static size_t SizeOf(const HpackString& name, const HpackString& value) {
+    return 32 + name.size() + value.size();
+  }
 
   Http2String DebugString() const;
 
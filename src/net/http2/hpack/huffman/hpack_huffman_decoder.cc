@@ -345,6 +345,271 @@ struct ShortCodeInfo {
     {0x7a, 7},  // Match: 0b1111011, Symbol: z
 };
 
+// Flat table indexed by the leading 8 bits of the accumulator, covering every
+// code of 5 to 8 bits; a length of zero marks the two prefixes (0b11111110
+// and 0b11111111) which start codes longer than 8 bits. This table was
+// generated.
+// clang-format off
+ShortCodeInfo kByteCodeTable[256] = {
+    {0x30, 5},  // Prefix: 0b00000000, Symbol: 0
+    {0x30, 5},  // Prefix: 0b00000001, Symbol: 0
+    {0x30, 5},  // Prefix: 0b00000010, Symbol: 0
+    {0x30, 5},  // Prefix: 0b00000011, Symbol: 0
+    {0x30, 5},  // Prefix: 0b00000100, Symbol: 0
+    {0x30, 5},  // Prefix: 0b00000101, Symbol: 0
+    {0x30, 5},  // Prefix: 0b00000110, Symbol: 0
+    {0x30, 5},  // Prefix: 0b00000111, Symbol: 0
+    {0x31, 5},  // Prefix: 0b00001000, Symbol: 1
+    {0x31, 5},  // Prefix: 0b00001001, Symbol: 1
+    {0x31, 5},  // Prefix: 0b00001010, Symbol: 1
+    {0x31, 5},  // Prefix: 0b00001011, Symbol: 1
+    {0x31, 5},  // Prefix: 0b00001100, Symbol: 1
+    {0x31, 5},  // Prefix: 0b00001101, Symbol: 1
+    {0x31, 5},  // Prefix: 0b00001110, Symbol: 1
+    {0x31, 5},  // Prefix: 0b00001111, Symbol: 1
+    {0x32, 5},  // Prefix: 0b00010000, Symbol: 2
+    {0x32, 5},  // Prefix: 0b00010001, Symbol: 2
+    {0x32, 5},  // Prefix: 0b00010010, Symbol: 2
+    {0x32, 5},  // Prefix: 0b00010011, Symbol: 2
+    {0x32, 5},  // Prefix: 0b00010100, Symbol: 2
+    {0x32, 5},  // Prefix: 0b00010101, Symbol: 2
+    {0x32, 5},  // Prefix: 0b00010110, Symbol: 2
+    {0x32, 5},  // Prefix: 0b00010111, Symbol: 2
+    {0x61, 5},  // Prefix: 0b00011000, Symbol: a
+    {0x61, 5},  // Prefix: 0b00011001, Symbol: a
+    {0x61, 5},  // Prefix: 0b00011010, Symbol: a
+    {0x61, 5},  // Prefix: 0b00011011, Symbol: a
+    {0x61, 5},  // Prefix: 0b00011100, Symbol: a
+    {0x61, 5},  // Prefix: 0b00011101, Symbol: a
+    {0x61, 5},  // Prefix: 0b00011110, Symbol: a
+    {0x61, 5},  // Prefix: 0b00011111, Symbol: a
+    {0x63, 5},  // Prefix: 0b00100000, Symbol: c
+    {0x63, 5},  // Prefix: 0b00100001, Symbol: c
+    {0x63, 5},  // Prefix: 0b00100010, Symbol: c
+    {0x63, 5},  // Prefix: 0b00100011, Symbol: c
+    {0x63, 5},  // Prefix: 0b00100100, Symbol: c
+    {0x63, 5},  // Prefix: 0b00100101, Symbol: c
+    {0x63, 5},  // Prefix: 0b00100110, Symbol: c
+    {0x63, 5},  // Prefix: 0b00100111, Symbol: c
+    {0x65, 5},  // Prefix: 0b00101000, Symbol: e
+    {0x65, 5},  // Prefix: 0b00101001, Symbol: e
+    {0x65, 5},  // Prefix: 0b00101010, Symbol: e
+    {0x65, 5},  // Prefix: 0b00101011, Symbol: e
+    {0x65, 5},  // Prefix: 0b00101100, Symbol: e
+    {0x65, 5},  // Prefix: 0b00101101, Symbol: e
+    {0x65, 5},  // Prefix: 0b00101110, Symbol: e
+    {0x65, 5},  // Prefix: 0b00101111, Symbol: e
+    {0x69, 5},  // Prefix: 0b00110000, Symbol: i
+    {0x69, 5},  // Prefix: 0b00110001, Symbol: i
+    {0x69, 5},  // Prefix: 0b00110010, Symbol: i
+    {0x69, 5},  // Prefix: 0b00110011, Symbol: i
+    {0x69, 5},  // Prefix: 0b00110100, Symbol: i
+    {0x69, 5},  // Prefix: 0b00110101, Symbol: i
+    {0x69, 5},  // Prefix: 0b00110110, Symbol: i
+    {0x69, 5},  // Prefix: 0b00110111, Symbol: i
+    {0x6f, 5},  // Prefix: 0b00111000, Symbol: o
+    {0x6f, 5},  // Prefix: 0b00111001, Symbol: o
+    {0x6f, 5},  // Prefix: 0b00111010, Symbol: o
+    {0x6f, 5},  // Prefix: 0b00111011, Symbol: o
+    {0x6f, 5},  // Prefix: 0b00111100, Symbol: o
+    {0x6f, 5},  // Prefix: 0b00111101, Symbol: o
+    {0x6f, 5},  // Prefix: 0b00111110, Symbol: o
+    {0x6f, 5},  // Prefix: 0b00111111, Symbol: o
+    {0x73, 5},  // Prefix: 0b01000000, Symbol: s
+    {0x73, 5},  // Prefix: 0b01000001, Symbol: s
+    {0x73, 5},  // Prefix: 0b01000010, Symbol: s
+    {0x73, 5},  // Prefix: 0b01000011, Symbol: s
+    {0x73, 5},  // Prefix: 0b01000100, Symbol: s
+    {0x73, 5},  // Prefix: 0b01000101, Symbol: s
+    {0x73, 5},  // Prefix: 0b01000110, Symbol: s
+    {0x73, 5},  // Prefix: 0b01000111, Symbol: s
+    {0x74, 5},  // Prefix: 0b01001000, Symbol: t
+    {0x74, 5},  // Prefix: 0b01001001, Symbol: t
+    {0x74, 5},  // Prefix: 0b01001010, Symbol: t
+    {0x74, 5},  // Prefix: 0b01001011, Symbol: t
+    {0x74, 5},  // Prefix: 0b01001100, Symbol: t
+    {0x74, 5},  // Prefix: 0b01001101, Symbol: t
+    {0x74, 5},  // Prefix: 0b01001110, Symbol: t
+    {0x74, 5},  // Prefix: 0b01001111, Symbol: t
+    {0x20, 6},  // Prefix: 0b01010000, Symbol: (sp)
+    {0x20, 6},  // Prefix: 0b01010001, Symbol: (sp)
+    {0x20, 6},  // Prefix: 0b01010010, Symbol: (sp)
+    {0x20, 6},  // Prefix: 0b01010011, Symbol: (sp)
+    {0x25, 6},  // Prefix: 0b01010100, Symbol: %
+    {0x25, 6},  // Prefix: 0b01010101, Symbol: %
+    {0x25, 6},  // Prefix: 0b01010110, Symbol: %
+    {0x25, 6},  // Prefix: 0b01010111, Symbol: %
+    {0x2d, 6},  // Prefix: 0b01011000, Symbol: -
+    {0x2d, 6},  // Prefix: 0b01011001, Symbol: -
+    {0x2d, 6},  // Prefix: 0b01011010, Symbol: -
+    {0x2d, 6},  // Prefix: 0b01011011, Symbol: -
+    {0x2e, 6},  // Prefix: 0b01011100, Symbol: .
+    {0x2e, 6},  // Prefix: 0b01011101, Symbol: .
+    {0x2e, 6},  // Prefix: 0b01011110, Symbol: .
+    {0x2e, 6},  // Prefix: 0b01011111, Symbol: .
+    {0x2f, 6},  // Prefix: 0b01100000, Symbol: /
+    {0x2f, 6},  // Prefix: 0b01100001, Symbol: /
+    {0x2f, 6},  // Prefix: 0b01100010, Symbol: /
+    {0x2f, 6},  // Prefix: 0b01100011, Symbol: /
+    {0x33, 6},  // Prefix: 0b01100100, Symbol: 3
+    {0x33, 6},  // Prefix: 0b01100101, Symbol: 3
+    {0x33, 6},  // Prefix: 0b01100110, Symbol: 3
+    {0x33, 6},  // Prefix: 0b01100111, Symbol: 3
+    {0x34, 6},  // Prefix: 0b01101000, Symbol: 4
+    {0x34, 6},  // Prefix: 0b01101001, Symbol: 4
+    {0x34, 6},  // Prefix: 0b01101010, Symbol: 4
+    {0x34, 6},  // Prefix: 0b01101011, Symbol: 4
+    {0x35, 6},  // Prefix: 0b01101100, Symbol: 5
+    {0x35, 6},  // Prefix: 0b01101101, Symbol: 5
+    {0x35, 6},  // Prefix: 0b01101110, Symbol: 5
+    {0x35, 6},  // Prefix: 0b01101111, Symbol: 5
+    {0x36, 6},  // Prefix: 0b01110000, Symbol: 6
+    {0x36, 6},  // Prefix: 0b01110001, Symbol: 6
+    {0x36, 6},  // Prefix: 0b01110010, Symbol: 6
+    {0x36, 6},  // Prefix: 0b01110011, Symbol: 6
+    {0x37, 6},  // Prefix: 0b01110100, Symbol: 7
+    {0x37, 6},  // Prefix: 0b01110101, Symbol: 7
+    {0x37, 6},  // Prefix: 0b01110110, Symbol: 7
+    {0x37, 6},  // Prefix: 0b01110111, Symbol: 7
+    {0x38, 6},  // Prefix: 0b01111000, Symbol: 8
+    {0x38, 6},  // Prefix: 0b01111001, Symbol: 8
+    {0x38, 6},  // Prefix: 0b01111010, Symbol: 8
+    {0x38, 6},  // Prefix: 0b01111011, Symbol: 8
+    {0x39, 6},  // Prefix: 0b01111100, Symbol: 9
+    {0x39, 6},  // Prefix: 0b01111101, Symbol: 9
+    {0x39, 6},  // Prefix: 0b01111110, Symbol: 9
+    {0x39, 6},  // Prefix: 0b01111111, Symbol: 9
+    {0x3d, 6},  // Prefix: 0b10000000, Symbol: =
+    {0x3d, 6},  // Prefix: 0b10000001, Symbol: =
+    {0x3d, 6},  // Prefix: 0b10000010, Symbol: =
+    {0x3d, 6},  // Prefix: 0b10000011, Symbol: =
+    {0x41, 6},  // Prefix: 0b10000100, Symbol: A
+    {0x41, 6},  // Prefix: 0b10000101, Symbol: A
+    {0x41, 6},  // Prefix: 0b10000110, Symbol: A
+    {0x41, 6},  // Prefix: 0b10000111, Symbol: A
+    {0x5f, 6},  // Prefix: 0b10001000, Symbol: _
+    {0x5f, 6},  // Prefix: 0b10001001, Symbol: _
+    {0x5f, 6},  // Prefix: 0b10001010, Symbol: _
+    {0x5f, 6},  // Prefix: 0b10001011, Symbol: _
+    {0x62, 6},  // Prefix: 0b10001100, Symbol: b
+    {0x62, 6},  // Prefix: 0b10001101, Symbol: b
+    {0x62, 6},  // Prefix: 0b10001110, Symbol: b
+    {0x62, 6},  // Prefix: 0b10001111, Symbol: b
+    {0x64, 6},  // Prefix: 0b10010000, Symbol: d
+    {0x64, 6},  // Prefix: 0b10010001, Symbol: d
+    {0x64, 6},  // Prefix: 0b10010010, Symbol: d
+    {0x64, 6},  // Prefix: 0b10010011, Symbol: d
+    {0x66, 6},  // Prefix: 0b10010100, Symbol: f
+    {0x66, 6},  // Prefix: 0b10010101, Symbol: f
+    {0x66, 6},  // Prefix: 0b10010110, Symbol: f
+    {0x66, 6},  // Prefix: 0b10010111, Symbol: f
+    {0x67, 6},  // Prefix: 0b10011000, Symbol: g
+    {0x67, 6},  // Prefix: 0b10011001, Symbol: g
+    {0x67, 6},  // Prefix: 0b10011010, Symbol: g
+    {0x67, 6},  // Prefix: 0b10011011, Symbol: g
+    {0x68, 6},  // Prefix: 0b10011100, Symbol: h
+    {0x68, 6},  // Prefix: 0b10011101, Symbol: h
+    {0x68, 6},  // Prefix: 0b10011110, Symbol: h
+    {0x68, 6},  // Prefix: 0b10011111, Symbol: h
+    {0x6c, 6},  // Prefix: 0b10100000, Symbol: l
+    {0x6c, 6},  // Prefix: 0b10100001, Symbol: l
+    {0x6c, 6},  // Prefix: 0b10100010, Symbol: l
+    {0x6c, 6},  // Prefix: 0b10100011, Symbol: l
+    {0x6d, 6},  // Prefix: 0b10100100, Symbol: m
+    {0x6d, 6},  // Prefix: 0b10100101, Symbol: m
+    {0x6d, 6},  // Prefix: 0b10100110, Symbol: m
+    {0x6d, 6},  // Prefix: 0b10100111, Symbol: m
+    {0x6e, 6},  // Prefix: 0b10101000, Symbol: n
+    {0x6e, 6},  // Prefix: 0b10101001, Symbol: n
+    {0x6e, 6},  // Prefix: 0b10101010, Symbol: n
+    {0x6e, 6},  // Prefix: 0b10101011, Symbol: n
+    {0x70, 6},  // Prefix: 0b10101100, Symbol: p
+    {0x70, 6},  // Prefix: 0b10101101, Symbol: p
+    {0x70, 6},  // Prefix: 0b10101110, Symbol: p
+    {0x70, 6},  // Prefix: 0b10101111, Symbol: p
+    {0x72, 6},  // Prefix: 0b10110000, Symbol: r
+    {0x72, 6},  // Prefix: 0b10110001, Symbol: r
+    {0x72, 6},  // Prefix: 0b10110010, Symbol: r
+    {0x72, 6},  // Prefix: 0b10110011, Symbol: r
+    {0x75, 6},  // Prefix: 0b10110100, Symbol: u
+    {0x75, 6},  // Prefix: 0b10110101, Symbol: u
+    {0x75, 6},  // Prefix: 0b10110110, Symbol: u
+    {0x75, 6},  // Prefix: 0b10110111, Symbol: u
+    {0x3a, 7},  // Prefix: 0b10111000, Symbol: :
+    {0x3a, 7},  // Prefix: 0b10111001, Symbol: :
+    {0x42, 7},  // Prefix: 0b10111010, Symbol: B
+    {0x42, 7},  // Prefix: 0b10111011, Symbol: B
+    {0x43, 7},  // Prefix: 0b10111100, Symbol: C
+    {0x43, 7},  // Prefix: 0b10111101, Symbol: C
+    {0x44, 7},  // Prefix: 0b10111110, Symbol: D
+    {0x44, 7},  // Prefix: 0b10111111, Symbol: D
+    {0x45, 7},  // Prefix: 0b11000000, Symbol: E
+    {0x45, 7},  // Prefix: 0b11000001, Symbol: E
+    {0x46, 7},  // Prefix: 0b11000010, Symbol: F
+    {0x46, 7},  // Prefix: 0b11000011, Symbol: F
+    {0x47, 7},  // Prefix: 0b11000100, Symbol: G
+    {0x47, 7},  // Prefix: 0b11000101, Symbol: G
+    {0x48, 7},  // Prefix: 0b11000110, Symbol: H
+    {0x48, 7},  // Prefix: 0b11000111, Symbol: H
+    {0x49, 7},  // Prefix: 0b11001000, Symbol: I
+    {0x49, 7},  // Prefix: 0b11001001, Symbol: I
+    {0x4a, 7},  // Prefix: 0b11001010, Symbol: J
+    {0x4a, 7},  // Prefix: 0b11001011, Symbol: J
+    {0x4b, 7},  // Prefix: 0b11001100, Symbol: K
+    {0x4b, 7},  // Prefix: 0b11001101, Symbol: K
+    {0x4c, 7},  // Prefix: 0b11001110, Symbol: L
+    {0x4c, 7},  // Prefix: 0b11001111, Symbol: L
+    {0x4d, 7},  // Prefix: 0b11010000, Symbol: M
+    {0x4d, 7},  // Prefix: 0b11010001, Symbol: M
+    {0x4e, 7},  // Prefix: 0b11010010, Symbol: N
+    {0x4e, 7},  // Prefix: 0b11010011, Symbol: N
+    {0x4f, 7},  // Prefix: 0b11010100, Symbol: O
+    {0x4f, 7},  // Prefix: 0b11010101, Symbol: O
+    {0x50, 7},  // Prefix: 0b11010110, Symbol: P
+    {0x50, 7},  // Prefix: 0b11010111, Symbol: P
+    {0x51, 7},  // Prefix: 0b11011000, Symbol: Q
+    {0x51, 7},  // Prefix: 0b11011001, Symbol: Q
+    {0x52, 7},  // Prefix: 0b11011010, Symbol: R
+    {0x52, 7},  // Prefix: 0b11011011, Symbol: R
+    {0x53, 7},  // Prefix: 0b11011100, Symbol: S
+    {0x53, 7},  // Prefix: 0b11011101, Symbol: S
+    {0x54, 7},  // Prefix: 0b11011110, Symbol: T
+    {0x54, 7},  // Prefix: 0b11011111, Symbol: T
+    {0x55, 7},  // Prefix: 0b11100000, Symbol: U
+    {0x55, 7},  // Prefix: 0b11100001, Symbol: U
+    {0x56, 7},  // Prefix: 0b11100010, Symbol: V
+    {0x56, 7},  // Prefix: 0b11100011, Symbol: V
+    {0x57, 7},  // Prefix: 0b11100100, Symbol: W
+    {0x57, 7},  // Prefix: 0b11100101, Symbol: W
+    {0x59, 7},  // Prefix: 0b11100110, Symbol: Y
+    {0x59, 7},  // Prefix: 0b11100111, Symbol: Y
+    {0x6a, 7},  // Prefix: 0b11101000, Symbol: j
+    {0x6a, 7},  // Prefix: 0b11101001, Symbol: j
+    {0x6b, 7},  // Prefix: 0b11101010, Symbol: k
+    {0x6b, 7},  // Prefix: 0b11101011, Symbol: k
+    {0x71, 7},  // Prefix: 0b11101100, Symbol: q
+    {0x71, 7},  // Prefix: 0b11101101, Symbol: q
+    {0x76, 7},  // Prefix: 0b11101110, Symbol: v
+    {0x76, 7},  // Prefix: 0b11101111, Symbol: v
+    {0x77, 7},  // Prefix: 0b11110000, Symbol: w
+    {0x77, 7},  // Prefix: 0b11110001, Symbol: w
+    {0x78, 7},  // Prefix: 0b11110010, Symbol: x
+    {0x78, 7},  // Prefix: 0b11110011, Symbol: x
+    {0x79, 7},  // Prefix: 0b11110100, Symbol: y
+    {0x79, 7},  // Prefix: 0b11110101, Symbol: y
+    {0x7a, 7},  // Prefix: 0b11110110, Symbol: z
+    {0x7a, 7},  // Prefix: 0b11110111, Symbol: z
+    {0x26, 8},  // Prefix: 0b11111000, Symbol: &
+    {0x2a, 8},  // Prefix: 0b11111001, Symbol: *
+    {0x2c, 8},  // Prefix: 0b11111010, Symbol: ,
+    {0x3b, 8},  // Prefix: 0b11111011, Symbol: ;
+    {0x58, 8},  // Prefix: 0b11111100, Symbol: X
+    {0x5a, 8},  // Prefix: 0b11111101, Symbol: Z
+    {0x00, 0},  // Prefix: 0b11111110, long code
+    {0x00, 0},  // Prefix: 0b11111111, long code
+};
+// clang-format on
+
 }  // namespace
 
 HuffmanBitBuffer::HuffmanBitBuffer() {
@@ -415,7 +680,7 @@ HpackHuffmanDecoder::HpackHuffmanDecoder() {}
 HpackHuffmanDecoder::~HpackHuffmanDecoder() {}
 
 bool HpackHuffmanDecoder::Decode(Http2StringPiece input, Http2String* output) {
-  return DecodeShortCodesFirst(input, output);
+  return DecodeByteCodesFirst(input, output);
 }
 
 // "Legacy" decoder, used until cl/129771019 submitted, which added
@@ -532,6 +797,74 @@ bool HpackHuffmanDecoder::DecodeShortCodesFirst(Http2StringPiece input,
   }
 }
 
+bool HpackHuffmanDecoder::DecodeByteCodesFirst(Http2StringPiece input,
+                                               Http2String* output) {
+  DVLOG(1) << "HpackHuffmanDecoder::DecodeByteCodesFirst";
+
+  // Fill bit_buffer_ from input.
+  input.remove_prefix(bit_buffer_.AppendBytes(input));
+
+  while (true) {
+    DVLOG(3) << "Enter Decode Loop, bit_buffer_: " << bit_buffer_;
+    // Decode as long as the accumulator holds at least a byte and the leading
+    // code is 8 bits or shorter; a single flat table lookup yields the symbol
+    // and code length, with no branching on the length.
+    while (bit_buffer_.count() >= 8) {
+      uint8_t byte_code =
+          bit_buffer_.value() >> (kHuffmanAccumulatorBitCount - 8);
+      ShortCodeInfo info = kByteCodeTable[byte_code];
+      if (info.length == 0) {
+        // The leading code is longer than 8 bits. Use PrefixToInfo, etc. to
+        // decode longer codes.
+        break;
+      }
+      bit_buffer_.ConsumeBits(info.length);
+      output->push_back(static_cast<char>(info.symbol));
+    }
+    if (bit_buffer_.count() < 8) {
+      // We may have (mostly) drained bit_buffer_. If we can top it up, try
+      // using the table decoder above.
+      size_t byte_count = bit_buffer_.AppendBytes(input);
+      if (byte_count > 0) {
+        input.remove_prefix(byte_count);
+        continue;
+      }
+    }
+
+    HuffmanCode code_prefix = bit_buffer_.value() >> kExtraAccumulatorBitCount;
+    DVLOG(3) << "code_prefix: " << HuffmanCodeBitSet(code_prefix);
+
+    PrefixInfo prefix_info = PrefixToInfo(code_prefix);
+    DVLOG(3) << "prefix_info: " << prefix_info;
+    DCHECK_LE(kMinCodeBitCount, prefix_info.code_length);
+    DCHECK_LE(prefix_info.code_length, kMaxCodeBitCount);
+
+    if (prefix_info.code_length <= bit_buffer_.count()) {
+      // We have enough bits for one code.
+      uint32_t canonical = prefix_info.DecodeToCanonical(code_prefix);
+      if (canonical < 256) {
+        // Valid code.
+        char c = kCanonicalToSymbol[canonical];
+        output->push_back(c);
+        bit_buffer_.ConsumeBits(prefix_info.code_length);
+        continue;
+      }
+      // Encoder is not supposed to explicity encode the EOS symbol.
+      DLOG(ERROR) << "EOS explicitly encoded!\n " << bit_buffer_ << "\n "
+                  << prefix_info;
+      return false;
+    }
+    // bit_buffer_ doesn't have enough bits in it to decode the next symbol.
+    // Append to it as many bytes as are available AND fit.
+    size_t byte_count = bit_buffer_.AppendBytes(input);
+    if (byte_count == 0) {
+      DCHECK_EQ(input.size(), 0u);
+      return true;
+    }
+    input.remove_prefix(byte_count);
+  }
+}
+
 Http2String HpackHuffmanDecoder::DebugString() const {
   return bit_buffer_.DebugString();
 }
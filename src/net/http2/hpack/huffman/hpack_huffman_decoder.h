@@ -135,6 +135,13 @@ class HTTP2_EXPORT_PRIVATE HpackHuffmanDecoder {
   // TODO(jamessynge): Be precise about that fraction.
   bool DecodeShortCodesFirst(Http2StringPiece input, Http2String* output);
 
+  // Based on DecodeShortCodesFirst, but drives the common case with a flat
+  // 256 entry table indexed by the leading 8 bits of the accumulator. The
+  // table covers all codes of 5 to 8 bits (the entire ASCII range the HPACK
+  // table favors), so those symbols are emitted a whole byte-indexed lookup
+  // at a time without branching on the code length.
+  bool DecodeByteCodesFirst(Http2StringPiece input, Http2String* output);
+
  private:
   HuffmanBitBuffer bit_buffer_;
 };
@@ -144,7 +144,7 @@ TEST(HuffmanBitBufferTest, AppendBytesUnaligned) {
                                   << "\n expected: " << expected;
 }
 
-enum class DecoderChoice { IF_TREE, SHORT_CODE };
+enum class DecoderChoice { IF_TREE, SHORT_CODE, BYTE_CODE };
 
 class HpackHuffmanDecoderTest
     : public RandomDecoderTest,
@@ -190,6 +190,8 @@ class HpackHuffmanDecoderTest
         return decoder_.DecodeWithIfTreeAndStruct(sp, &output_buffer_);
       case DecoderChoice::SHORT_CODE:
         return decoder_.DecodeShortCodesFirst(sp, &output_buffer_);
+      case DecoderChoice::BYTE_CODE:
+        return decoder_.DecodeByteCodesFirst(sp, &output_buffer_);
     }
 
     NOTREACHED();
@@ -219,7 +221,8 @@ class HpackHuffmanDecoderTest
 INSTANTIATE_TEST_CASE_P(AllDecoders,
                         HpackHuffmanDecoderTest,
                         ::testing::Values(DecoderChoice::IF_TREE,
-                                          DecoderChoice::SHORT_CODE));
+                                          DecoderChoice::SHORT_CODE,
+                                          DecoderChoice::BYTE_CODE));
 
 TEST_P(HpackHuffmanDecoderTest, SpecRequestExamples) {
   HpackHuffmanDecoder decoder;
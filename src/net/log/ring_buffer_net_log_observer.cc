@@ -0,0 +1,88 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/log/ring_buffer_net_log_observer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/memory/ptr_util.h"
+#include "base/values.h"
+#include "net/log/net_log_entry.h"
+
+namespace net {
+
+RingBufferNetLogObserver::RingBufferNetLogObserver(size_t capacity)
+    : ring_(capacity), num_added_(0) {
+  DCHECK_GT(capacity, 0u);
+}
+
+RingBufferNetLogObserver::~RingBufferNetLogObserver() {
+  DCHECK(!net_log());
+}
+
+void RingBufferNetLogObserver::StartObserving(NetLog* net_log,
+                                              NetLogCaptureMode capture_mode) {
+  net_log->AddObserver(this, capture_mode);
+}
+
+void RingBufferNetLogObserver::StopObserving() {
+  net_log()->RemoveObserver(this);
+}
+
+void RingBufferNetLogObserver::OnAddEntry(const NetLogEntry& entry) {
+  // Note the absence of entry.ToValue() and of the parameters callback:
+  // this path only copies scalars.
+  PackedEvent event;
+  event.time_ticks_us =
+      (entry.time() - base::TimeTicks()).InMicroseconds();
+  event.source_id = entry.source().id;
+  event.source_type = static_cast<uint16_t>(entry.source().type);
+  event.event_type = static_cast<uint16_t>(entry.type());
+  event.phase = static_cast<uint8_t>(entry.phase());
+
+  base::AutoLock lock(lock_);
+  ring_[num_added_ % ring_.size()] = event;
+  ++num_added_;
+}
+
+size_t RingBufferNetLogObserver::GetEventCount() const {
+  base::AutoLock lock(lock_);
+  return static_cast<size_t>(
+      std::min(static_cast<uint64_t>(ring_.size()), num_added_));
+}
+
+uint64_t RingBufferNetLogObserver::GetOverwrittenEventCount() const {
+  base::AutoLock lock(lock_);
+  return num_added_ <= ring_.size() ? 0 : num_added_ - ring_.size();
+}
+
+std::unique_ptr<base::ListValue>
+RingBufferNetLogObserver::GetEventsAsListValue() const {
+  base::AutoLock lock(lock_);
+  std::unique_ptr<base::ListValue> list(new base::ListValue());
+  const uint64_t retained =
+      std::min(static_cast<uint64_t>(ring_.size()), num_added_);
+  for (uint64_t i = 0; i < retained; ++i) {
+    const PackedEvent& event = ring_[(num_added_ - retained + i) % ring_.size()];
+    std::unique_ptr<base::DictionaryValue> entry_dict(
+        new base::DictionaryValue());
+    entry_dict->SetString(
+        "time",
+        NetLog::TickCountToString(base::TimeTicks() +
+                                  base::TimeDelta::FromMicroseconds(
+                                      event.time_ticks_us)));
+    std::unique_ptr<base::DictionaryValue> source_dict(
+        new base::DictionaryValue());
+    source_dict->SetInteger("id", event.source_id);
+    source_dict->SetInteger("type", event.source_type);
+    entry_dict->Set("source", std::move(source_dict));
+    entry_dict->SetInteger("type", event.event_type);
+    entry_dict->SetInteger("phase", event.phase);
+    list->Append(std::move(entry_dict));
+  }
+  return list;
+}
+
+}  // namespace net
@@ -0,0 +1,80 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_LOG_RING_BUFFER_NET_LOG_OBSERVER_H_
+#define NET_LOG_RING_BUFFER_NET_LOG_OBSERVER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "net/base/net_export.h"
+#include "net/log/net_log.h"
+
+namespace base {
+class ListValue;
+}  // namespace base
+
+namespace net {
+
+// A bounded NetLog observer cheap enough to leave attached in production.
+// Instead of materializing base::Value dictionaries per event the way
+// FileNetLogObserver does, it packs each event's fixed-schema fields into a
+// preallocated ring buffer and serializes them to the usual NetLog JSON
+// shape only at export time. Event parameters are deliberately never
+// captured -- the parameters callback is not run -- which is what reduces
+// the per-event cost to a few stores. When the ring is full, the oldest
+// events are overwritten.
+class NET_EXPORT RingBufferNetLogObserver : public NetLog::ThreadSafeObserver {
+ public:
+  // One captured event, packed to keep ring memory small.
+  struct PackedEvent {
+    int64_t time_ticks_us;
+    uint32_t source_id;
+    uint16_t source_type;
+    uint16_t event_type;
+    uint8_t phase;
+  };
+
+  // The ring holds the most recent |capacity| events.
+  explicit RingBufferNetLogObserver(size_t capacity);
+  ~RingBufferNetLogObserver() override;
+
+  // Starts/stops observing |net_log|. The capture mode only gates which
+  // events are delivered; parameters are never captured regardless.
+  void StartObserving(NetLog* net_log, NetLogCaptureMode capture_mode);
+  void StopObserving();
+
+  // NetLog::ThreadSafeObserver implementation:
+  void OnAddEntry(const NetLogEntry& entry) override;
+
+  // Number of events currently retained in the ring.
+  size_t GetEventCount() const;
+
+  // Number of events overwritten because the ring was full.
+  uint64_t GetOverwrittenEventCount() const;
+
+  // Serializes the retained events, oldest first, into the same JSON shape
+  // as NetLogEntry::ToValue() minus the "params" key.
+  std::unique_ptr<base::ListValue> GetEventsAsListValue() const;
+
+ private:
+  // Guards the ring; OnAddEntry runs under the NetLog's own observer lock,
+  // but exports may race with capture.
+  mutable base::Lock lock_;
+  // Fixed-capacity event storage, written at index |num_added_| modulo
+  // capacity.
+  std::vector<PackedEvent> ring_;
+  // Total events ever delivered to the observer.
+  uint64_t num_added_;
+
+  DISALLOW_COPY_AND_ASSIGN(RingBufferNetLogObserver);
+};
+
+}  // namespace net
+
+#endif  // NET_LOG_RING_BUFFER_NET_LOG_OBSERVER_H_
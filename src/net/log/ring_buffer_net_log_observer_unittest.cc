@@ -0,0 +1,102 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/log/ring_buffer_net_log_observer.h"
+
+#include <memory>
+
+#include "base/bind.h"
+#include "base/values.h"
+#include "net/log/net_log.h"
+#include "net/log/net_log_event_type.h"
+#include "net/log/net_log_source_type.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+std::unique_ptr<base::Value> ExpensiveCallback(bool* was_run,
+                                               NetLogCaptureMode /* mode */) {
+  *was_run = true;
+  return std::unique_ptr<base::Value>(new base::DictionaryValue());
+}
+
+TEST(RingBufferNetLogObserverTest, CapturesPackedEvents) {
+  NetLog net_log;
+  RingBufferNetLogObserver observer(4);
+  observer.StartObserving(&net_log, NetLogCaptureMode::Default());
+
+  net_log.AddGlobalEntry(NetLogEventType::CANCELLED);
+  EXPECT_EQ(1u, observer.GetEventCount());
+  EXPECT_EQ(0u, observer.GetOverwrittenEventCount());
+
+  std::unique_ptr<base::ListValue> list = observer.GetEventsAsListValue();
+  ASSERT_EQ(1u, list->GetSize());
+  base::DictionaryValue* entry = nullptr;
+  ASSERT_TRUE(list->GetDictionary(0, &entry));
+  int type = -1;
+  EXPECT_TRUE(entry->GetInteger("type", &type));
+  EXPECT_EQ(static_cast<int>(NetLogEventType::CANCELLED), type);
+  base::DictionaryValue* source = nullptr;
+  ASSERT_TRUE(entry->GetDictionary("source", &source));
+  int source_type = -1;
+  EXPECT_TRUE(source->GetInteger("type", &source_type));
+  EXPECT_EQ(static_cast<int>(NetLogSourceType::NONE), source_type);
+  std::string time;
+  EXPECT_TRUE(entry->GetString("time", &time));
+
+  observer.StopObserving();
+}
+
+TEST(RingBufferNetLogObserverTest, ParametersCallbackIsNeverRun) {
+  NetLog net_log;
+  RingBufferNetLogObserver observer(4);
+  observer.StartObserving(&net_log, NetLogCaptureMode::IncludeSocketBytes());
+
+  bool was_run = false;
+  net_log.AddGlobalEntry(NetLogEventType::SOCKET_ALIVE,
+                         base::Bind(ExpensiveCallback, &was_run));
+  EXPECT_EQ(1u, observer.GetEventCount());
+  // This is the point of the fast path: no base::Value is ever built.
+  EXPECT_FALSE(was_run);
+
+  observer.StopObserving();
+}
+
+TEST(RingBufferNetLogObserverTest, OldestEventsAreOverwritten) {
+  NetLog net_log;
+  RingBufferNetLogObserver observer(4);
+  observer.StartObserving(&net_log, NetLogCaptureMode::Default());
+
+  for (int i = 0; i < 6; ++i) {
+    net_log.AddGlobalEntry(NetLogEventType::CANCELLED);
+  }
+  EXPECT_EQ(4u, observer.GetEventCount());
+  EXPECT_EQ(2u, observer.GetOverwrittenEventCount());
+
+  // The retained events are the four most recent ones; with per-event
+  // unique source ids, the first exported id is the third ever allocated.
+  std::unique_ptr<base::ListValue> list = observer.GetEventsAsListValue();
+  ASSERT_EQ(4u, list->GetSize());
+  base::DictionaryValue* first = nullptr;
+  ASSERT_TRUE(list->GetDictionary(0, &first));
+  base::DictionaryValue* last = nullptr;
+  ASSERT_TRUE(list->GetDictionary(3, &last));
+  base::DictionaryValue* first_source = nullptr;
+  base::DictionaryValue* last_source = nullptr;
+  ASSERT_TRUE(first->GetDictionary("source", &first_source));
+  ASSERT_TRUE(last->GetDictionary("source", &last_source));
+  int first_id = -1;
+  int last_id = -1;
+  EXPECT_TRUE(first_source->GetInteger("id", &first_id));
+  EXPECT_TRUE(last_source->GetInteger("id", &last_id));
+  EXPECT_EQ(first_id + 3, last_id);
+
+  observer.StopObserving();
+}
+
+}  // namespace
+
+}  // namespace net
@@ -12,7 +12,6 @@
 #include "base/macros.h"
 #include "base/time/default_tick_clock.h"
 #include "base/time/time.h"
-#include "net/nqe/weighted_observation.h"
 
 namespace net {
 
@@ -20,6 +19,22 @@ namespace nqe {
 
 namespace internal {
 
+namespace {
+
+// Returns true if |observation| was taken from one of the sources in
+// |disallowed_observation_sources|.
+bool IsDisallowed(const Observation& observation,
+                  const std::vector<NetworkQualityObservationSource>&
+                      disallowed_observation_sources) {
+  for (const auto& disallowed_source : disallowed_observation_sources) {
+    if (disallowed_source == observation.source)
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
 ObservationBuffer::ObservationBuffer(double weight_multiplier_per_second,
                                      double weight_multiplier_per_signal_level)
     : weight_multiplier_per_second_(weight_multiplier_per_second),
@@ -31,6 +46,7 @@ ObservationBuffer::ObservationBuffer(double weight_multiplier_per_second,
   DCHECK_GE(1.0, weight_multiplier_per_second_);
   DCHECK_LE(0.0, weight_multiplier_per_signal_level_);
   DCHECK_GE(1.0, weight_multiplier_per_signal_level_);
+  weight_scratch_.reserve(kMaximumObservationsBufferSize);
 }
 
 ObservationBuffer::~ObservationBuffer() {}
@@ -39,10 +55,27 @@ void ObservationBuffer::AddObservation(const Observation& observation) {
   DCHECK_LE(observations_.size(), kMaximumObservationsBufferSize);
   // Evict the oldest element if the buffer is already full.
   if (observations_.size() == kMaximumObservationsBufferSize)
-    observations_.pop_front();
+    EvictOldestObservation();
 
   observations_.push_back(observation);
+  observations_by_value_.insert(
+      std::make_pair(observations_.back().value, &observations_.back()));
   DCHECK_LE(observations_.size(), kMaximumObservationsBufferSize);
+  DCHECK_EQ(observations_.size(), observations_by_value_.size());
+}
+
+void ObservationBuffer::EvictOldestObservation() {
+  DCHECK(!observations_.empty());
+  const Observation& oldest = observations_.front();
+  auto range = observations_by_value_.equal_range(oldest.value);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second == &oldest) {
+      observations_by_value_.erase(it);
+      break;
+    }
+  }
+  observations_.pop_front();
+  DCHECK_EQ(observations_.size(), observations_by_value_.size());
 }
 
 base::Optional<int32_t> ObservationBuffer::GetPercentile(
@@ -51,33 +84,55 @@ base::Optional<int32_t> ObservationBuffer::GetPercentile(
     int percentile,
     const std::vector<NetworkQualityObservationSource>&
         disallowed_observation_sources) const {
-  // Stores weighted observations in increasing order by value.
-  std::vector<WeightedObservation> weighted_observations;
+  DCHECK_GE(Capacity(), Size());
 
-  // Total weight of all observations in |weighted_observations|.
+  // Compute the weight of every eligible observation, walking
+  // |observations_by_value_| so that the weights line up with the value
+  // order. Ineligible observations get a weight of 0. |weight_scratch_| is
+  // preallocated to capacity, so this does not allocate.
+  weight_scratch_.clear();
   double total_weight = 0.0;
+  size_t eligible_observations = 0;
+  base::TimeTicks now = tick_clock_->NowTicks();
+
+  for (const auto& value_and_observation : observations_by_value_) {
+    const Observation& observation = *value_and_observation.second;
+    if (observation.timestamp < begin_timestamp ||
+        IsDisallowed(observation, disallowed_observation_sources)) {
+      weight_scratch_.push_back(0.0);
+      continue;
+    }
+    double weight =
+        ComputeObservationWeight(observation, now, current_signal_strength);
+    weight_scratch_.push_back(weight);
+    total_weight += weight;
+    ++eligible_observations;
+  }
 
-  ComputeWeightedObservations(begin_timestamp, current_signal_strength,
-                              &weighted_observations, &total_weight,
-                              disallowed_observation_sources);
-  if (weighted_observations.empty())
+  if (eligible_observations == 0)
     return base::nullopt;
 
   double desired_weight = percentile / 100.0 * total_weight;
 
   double cumulative_weight_seen_so_far = 0.0;
-  for (const auto& weighted_observation : weighted_observations) {
-    cumulative_weight_seen_so_far += weighted_observation.weight;
+  size_t weight_index = 0;
+  int32_t highest_eligible_value = 0;
+  for (const auto& value_and_observation : observations_by_value_) {
+    double weight = weight_scratch_[weight_index++];
+    if (weight == 0.0)
+      continue;
+    cumulative_weight_seen_so_far += weight;
+    highest_eligible_value = value_and_observation.first;
     if (cumulative_weight_seen_so_far >= desired_weight)
-      return weighted_observation.value;
+      return value_and_observation.first;
   }
 
   // Computation may reach here due to floating point errors. This may happen
   // if |percentile| was 100 (or close to 100), and |desired_weight| was
   // slightly larger than |total_weight| (due to floating point errors).
-  // In this case, we return the highest |value| among all observations.
-  // This is same as value of the last observation in the sorted vector.
-  return weighted_observations.at(weighted_observations.size() - 1).value;
+  // In this case, we return the highest |value| among all eligible
+  // observations.
+  return highest_eligible_value;
 }
 
 base::Optional<int32_t> ObservationBuffer::GetWeightedAverage(
@@ -85,26 +140,28 @@ base::Optional<int32_t> ObservationBuffer::GetWeightedAverage(
     const base::Optional<int32_t>& current_signal_strength,
     const std::vector<NetworkQualityObservationSource>&
         disallowed_observation_sources) const {
-  // Stores weighted observations in increasing order by value.
-  std::vector<WeightedObservation> weighted_observations;
-
-  // Total weight of all observations in |weighted_observations|.
   double total_weight = 0.0;
+  double total_weight_times_value = 0.0;
+  size_t eligible_observations = 0;
+  base::TimeTicks now = tick_clock_->NowTicks();
 
-  ComputeWeightedObservations(begin_timestamp, current_signal_strength,
-                              &weighted_observations, &total_weight,
-                              disallowed_observation_sources);
-  if (weighted_observations.empty())
+  for (const auto& observation : observations_) {
+    if (observation.timestamp < begin_timestamp ||
+        IsDisallowed(observation, disallowed_observation_sources)) {
+      continue;
+    }
+    double weight =
+        ComputeObservationWeight(observation, now, current_signal_strength);
+    total_weight += weight;
+    total_weight_times_value += weight * observation.value;
+    ++eligible_observations;
+  }
+
+  if (eligible_observations == 0)
     return base::nullopt;
 
   // Weighted average is the sum of observations times their respective
   // weights, divided by the sum of the weights of all observations.
-  double total_weight_times_value = 0.0;
-  for (const auto& weighted_observation : weighted_observations) {
-    total_weight_times_value +=
-        (weighted_observation.weight * weighted_observation.value);
-  }
-
   return static_cast<int32_t>(total_weight_times_value / total_weight);
 }
 
@@ -113,83 +170,44 @@ base::Optional<int32_t> ObservationBuffer::GetUnweightedAverage(
     const base::Optional<int32_t>& current_signal_strength,
     const std::vector<NetworkQualityObservationSource>&
         disallowed_observation_sources) const {
-  // Stores weighted observations in increasing order by value.
-  std::vector<WeightedObservation> weighted_observations;
-
-  // Total weight of all observations in |weighted_observations|.
-  double total_weight = 0.0;
-
-  ComputeWeightedObservations(begin_timestamp, current_signal_strength,
-                              &weighted_observations, &total_weight,
-                              disallowed_observation_sources);
-  if (weighted_observations.empty())
-    return base::nullopt;
-
-  // The unweighted average is the sum of all observations divided by the
-  // number of observations.
   double total_value = 0.0;
-  for (const auto& weighted_observation : weighted_observations)
-    total_value += weighted_observation.value;
-
-  return total_value / weighted_observations.size();
-}
-
-void ObservationBuffer::ComputeWeightedObservations(
-    const base::TimeTicks& begin_timestamp,
-    const base::Optional<int32_t>& current_signal_strength,
-    std::vector<WeightedObservation>* weighted_observations,
-    double* total_weight,
-    const std::vector<NetworkQualityObservationSource>&
-        disallowed_observation_sources) const {
-  DCHECK_GE(Capacity(), Size());
-
-  weighted_observations->clear();
-  double total_weight_observations = 0.0;
-  base::TimeTicks now = tick_clock_->NowTicks();
+  size_t eligible_observations = 0;
 
   for (const auto& observation : observations_) {
-    if (observation.timestamp < begin_timestamp)
+    if (observation.timestamp < begin_timestamp ||
+        IsDisallowed(observation, disallowed_observation_sources)) {
       continue;
-    bool disallowed = false;
-    for (const auto& disallowed_source : disallowed_observation_sources) {
-      if (disallowed_source == observation.source)
-        disallowed = true;
-    }
-    if (disallowed)
-      continue;
-    base::TimeDelta time_since_sample_taken = now - observation.timestamp;
-    double time_weight =
-        pow(weight_multiplier_per_second_, time_since_sample_taken.InSeconds());
-
-    double signal_strength_weight = 1.0;
-    if (current_signal_strength && observation.signal_strength) {
-      int32_t signal_strength_weight_diff =
-          std::abs(current_signal_strength.value() -
-                   observation.signal_strength.value());
-      signal_strength_weight =
-          pow(weight_multiplier_per_signal_level_, signal_strength_weight_diff);
     }
+    total_value += observation.value;
+    ++eligible_observations;
+  }
 
-    double weight = time_weight * signal_strength_weight;
+  if (eligible_observations == 0)
+    return base::nullopt;
 
-    weight = std::max(DBL_MIN, std::min(1.0, weight));
+  // The unweighted average is the sum of all observations divided by the
+  // number of observations.
+  return total_value / eligible_observations;
+}
 
-    weighted_observations->push_back(
-        WeightedObservation(observation.value, weight));
-    total_weight_observations += weight;
+double ObservationBuffer::ComputeObservationWeight(
+    const Observation& observation,
+    base::TimeTicks now,
+    const base::Optional<int32_t>& current_signal_strength) const {
+  base::TimeDelta time_since_sample_taken = now - observation.timestamp;
+  double time_weight =
+      pow(weight_multiplier_per_second_, time_since_sample_taken.InSeconds());
+
+  double signal_strength_weight = 1.0;
+  if (current_signal_strength && observation.signal_strength) {
+    int32_t signal_strength_weight_diff =
+        std::abs(current_signal_strength.value() -
+                 observation.signal_strength.value());
+    signal_strength_weight =
+        pow(weight_multiplier_per_signal_level_, signal_strength_weight_diff);
   }
 
-  // Sort the samples by value in ascending order.
-  std::sort(weighted_observations->begin(), weighted_observations->end());
-  *total_weight = total_weight_observations;
-
-  DCHECK_LE(0.0, *total_weight);
-  DCHECK(weighted_observations->empty() || 0.0 < *total_weight);
-
-  // |weighted_observations| may have a smaller size than |observations_|
-  // since the former contains only the observations later than
-  // |begin_timestamp|.
-  DCHECK_GE(observations_.size(), weighted_observations->size());
+  return std::max(DBL_MIN, std::min(1.0, time_weight * signal_strength_weight));
 }
 
 }  // namespace internal
@@ -8,6 +8,7 @@
 #include <stdint.h>
 
 #include <deque>
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -36,8 +37,6 @@ static const size_t kMaximumObservationsBufferSize = 300;
 
 }  // namespace
 
-struct WeightedObservation;
-
 // Stores observations sorted by time and provides utility functions for
 // computing weighted and non-weighted summary statistics.
 class NET_EXPORT_PRIVATE ObservationBuffer {
@@ -58,7 +57,10 @@ class NET_EXPORT_PRIVATE ObservationBuffer {
   size_t Capacity() const { return kMaximumObservationsBufferSize; }
 
   // Clears the observations stored in this buffer.
-  void Clear() { observations_.clear(); }
+  void Clear() {
+    observations_.clear();
+    observations_by_value_.clear();
+  }
 
   // Returns true iff the |percentile| value of the observations in this
   // buffer is available. Sets |result| to the computed |percentile|
@@ -106,25 +108,33 @@ class NET_EXPORT_PRIVATE ObservationBuffer {
   }
 
  private:
-  // Computes the weighted observations and stores them in
-  // |weighted_observations| sorted by ascending |WeightedObservation.value|.
-  // Only the observations with timestamp later than |begin_timestamp| are
-  // considered. |current_signal_strength| is the current signal strength
-  // when the observation was taken. This method also sets |total_weight| to
-  // the total weight of all observations. Should be called only when there is
-  // at least one observation in the buffer.
-  void ComputeWeightedObservations(
-      const base::TimeTicks& begin_timestamp,
-      const base::Optional<int32_t>& current_signal_strength,
-      std::vector<WeightedObservation>* weighted_observations,
-      double* total_weight,
-      const std::vector<NetworkQualityObservationSource>&
-          disallowed_observation_sources) const;
+  // Removes the oldest observation from |observations_| and its entry in
+  // |observations_by_value_|.
+  void EvictOldestObservation();
+
+  // Returns the weight of |observation| at time |now|.
+  // |current_signal_strength| is the current signal strength. The returned
+  // weight is always positive.
+  double ComputeObservationWeight(
+      const Observation& observation,
+      base::TimeTicks now,
+      const base::Optional<int32_t>& current_signal_strength) const;
 
   // Holds observations sorted by time, with the oldest observation at the
   // front of the queue.
   std::deque<Observation> observations_;
 
+  // Indexes the observations in |observations_| in ascending order of value,
+  // so that percentile queries can walk the observations in value order
+  // instead of copying and sorting them. Maintained incrementally as
+  // observations are added and evicted. Pointers into |observations_| stay
+  // valid since the deque is only modified at its ends.
+  std::multimap<int32_t, const Observation*> observations_by_value_;
+
+  // Scratch space for per-observation weights computed during a percentile
+  // query. Reserved to the buffer capacity so that queries do not allocate.
+  mutable std::vector<double> weight_scratch_;
+
   // The factor by which the weight of an observation reduces every second.
   // For example, if an observation is 6 seconds old, its weight would be:
   //     weight_multiplier_per_second_ ^ 6
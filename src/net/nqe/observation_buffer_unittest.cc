@@ -40,6 +40,29 @@ TEST(NetworkQualityObservationBufferTest, BoundedBuffer) {
   }
 }
 
+// Verify that the percentiles remain correct after older observations have
+// been evicted to make room for newer ones.
+TEST(NetworkQualityObservationBufferTest, PercentileAfterEviction) {
+  ObservationBuffer buffer(1.0, 1.0);
+  const base::TimeTicks now = base::TimeTicks::Now();
+
+  // Insert twice as many observations as the buffer can hold. Only the
+  // newest 300 observations (with values 301 to 600) should be retained.
+  for (int i = 1; i <= 600; ++i) {
+    buffer.AddObservation(Observation(i, now, INT32_MIN,
+                                      NETWORK_QUALITY_OBSERVATION_SOURCE_HTTP));
+  }
+  EXPECT_EQ(300u, buffer.Size());
+
+  for (int i = 0; i <= 100; ++i) {
+    base::Optional<int32_t> result = buffer.GetPercentile(
+        base::TimeTicks(), INT32_MIN, i,
+        std::vector<NetworkQualityObservationSource>());
+    ASSERT_TRUE(result.has_value());
+    EXPECT_NEAR(result.value(), 300 + i * 3, 2);
+  }
+}
+
 // Test disabled on OS_WIN to avoid linking errors when calling
 // SetTickClockForTesting.
 // TODO(tbansal): crbug.com/651963. Pass the clock through NQE's constructor.
@@ -10,6 +10,7 @@
 #include "base/metrics/sparse_histogram.h"
 #include "base/task_runner.h"
 #include "base/time/time.h"
+#include "net/quic/platform/impl/quic_chromium_clock.h"
 
 namespace net {
 
@@ -73,6 +74,9 @@ class QuicChromeAlarm : public QuicAlarm {
       return;
     }
 
+    // Alarm handlers consult ApproximateNow() repeatedly (to rearm timers and
+    // stamp NetLog entries); let those reads share one clock read.
+    QuicChromiumClock::ScopedApproximateNow scoped_approximate_now;
     Fire();
   }
 
@@ -10,6 +10,7 @@
 #include "base/threading/thread_task_runner_handle.h"
 #include "net/base/net_errors.h"
 #include "net/quic/platform/api/quic_clock.h"
+#include "net/quic/platform/impl/quic_chromium_clock.h"
 
 namespace net {
 
@@ -85,6 +86,11 @@ bool QuicChromiumPacketReader::ProcessReadResult(int result) {
     return false;
   }
 
+  // Processing one packet consults ApproximateNow() many times (ack and
+  // retransmission alarms, NetLog entries); let those reads share one clock
+  // read for the duration of this packet.
+  QuicChromiumClock::ScopedApproximateNow scoped_approximate_now;
+
   QuicReceivedPacket packet(read_buffer_->data(), result, clock_->Now());
   IPEndPoint local_address;
   IPEndPoint peer_address;
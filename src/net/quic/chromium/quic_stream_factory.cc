@@ -46,6 +46,7 @@
 #include "net/quic/chromium/quic_chromium_packet_writer.h"
 #include "net/quic/chromium/quic_crypto_client_stream_factory.h"
 #include "net/quic/chromium/quic_server_info.h"
+#include "net/quic/core/crypto/crypto_utils.h"
 #include "net/quic/core/crypto/proof_verifier.h"
 #include "net/quic/core/crypto/quic_random.h"
 #include "net/quic/core/quic_client_promised_info.h"
@@ -738,10 +739,11 @@ QuicStreamFactory::QuicStreamFactory(
   if (enable_token_binding && channel_id_service)
     crypto_config_.tb_key_params.push_back(kTB10);
   crypto::EnsureOpenSSLInit();
-  bool has_aes_hardware_support = !!EVP_has_aes_hardware();
-  UMA_HISTOGRAM_BOOLEAN("Net.QuicSession.PreferAesGcm",
-                        has_aes_hardware_support);
-  if (has_aes_hardware_support)
+  // Prefer whichever AEAD the measured probe says is faster here, rather
+  // than inferring from the presence of AES hardware alone.
+  bool prefer_aes_gcm = CryptoUtils::IsAesGcmFaster();
+  UMA_HISTOGRAM_BOOLEAN("Net.QuicSession.PreferAesGcm", prefer_aes_gcm);
+  if (prefer_aes_gcm)
     crypto_config_.PreferAesGcm();
 
   // migrate_sessions_early should only be set to true if
@@ -9,7 +9,6 @@
 #include "net/quic/core/quic_bandwidth.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_time.h"
-#include "net/quic/platform/api/quic_containers.h"
 #include "net/quic/platform/api/quic_export.h"
 
 namespace net {
@@ -245,9 +244,6 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
           last_acked_packet_ack_time(QuicTime::Zero()) {}
   };
 
-  typedef QuicLinkedHashMap<QuicPacketNumber, ConnectionStateOnSentPacket>
-      ConnectionStateMap;
-
   // The total number of congestion controlled bytes sent during the connection.
   QuicByteCount total_bytes_sent_;
 
@@ -47,6 +47,11 @@ const QuicTime::Delta kProbeRttTime = QuicTime::Delta::FromMilliseconds(200);
 const float kStartupGrowthTarget = 1.25;
 const QuicRoundTripCount kRoundTripsWithoutGrowthBeforeExitingStartup = 3;
 
+// The lowest pacing gain the aggregation-adaptive STARTUP will back off to.
+// Kept above |kStartupGrowthTarget| so the full bandwidth detection still
+// sees the expected growth on rounds where the link has spare capacity.
+const float kMinStartupGain = 1.5f;
+
 }  // namespace
 
 BbrSender::DebugState::DebugState(const BbrSender& sender)
@@ -101,6 +106,7 @@ BbrSender::BbrSender(const RttStats* rtt_stats,
           static_cast<float>(FLAGS_quic_bbr_rtt_variation_weight)),
       num_startup_rtts_(kRoundTripsWithoutGrowthBeforeExitingStartup),
       exit_startup_on_loss_(false),
+      startup_gain_from_aggregation_(false),
       cycle_current_offset_(0),
       last_cycle_start_(QuicTime::Zero()),
       is_at_full_bandwidth_(false),
@@ -212,6 +218,11 @@ void BbrSender::SetFromConfig(const QuicConfig& config,
                       2);
     max_aggregation_bytes_multiplier_ = 2;
   }
+  if (FLAGS_quic_reloadable_flag_quic_bbr_adaptive_startup_gain &&
+      config.HasClientRequestedIndependentOption(kBBR3, perspective)) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_bbr_adaptive_startup_gain);
+    startup_gain_from_aggregation_ = true;
+  }
 }
 
 void BbrSender::AdjustNetworkParameters(QuicBandwidth bandwidth,
@@ -273,6 +284,9 @@ void BbrSender::OnCongestionEvent(bool /*rtt_updated*/,
   if (is_round_start && !is_at_full_bandwidth_) {
     CheckIfFullBandwidthReached();
   }
+  if (startup_gain_from_aggregation_ && is_round_start && mode_ == STARTUP) {
+    MaybeAdjustStartupPacingGain();
+  }
   MaybeExitStartupOrDrain(event_time);
 
   // Handle logic specific to PROBE_RTT.
@@ -301,9 +315,18 @@ CongestionControlType BbrSender::GetCongestionControlType() const {
 }
 
 QuicTime::Delta BbrSender::GetMinRtt() const {
-  return !min_rtt_.IsZero()
-             ? min_rtt_
-             : QuicTime::Delta::FromMicroseconds(rtt_stats_->initial_rtt_us());
+  if (!min_rtt_.IsZero()) {
+    return min_rtt_;
+  }
+  if (FLAGS_quic_reloadable_flag_quic_windowed_rtt &&
+      !rtt_stats_->windowed_min_rtt().IsZero()) {
+    QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_windowed_rtt, 2, 2);
+    // The sampler has not produced an RTT yet (e.g. the send algorithm was
+    // swapped mid-connection); use the windowed minimum the connection has
+    // already measured instead of the configured initial rtt.
+    return rtt_stats_->windowed_min_rtt();
+  }
+  return QuicTime::Delta::FromMicroseconds(rtt_stats_->initial_rtt_us());
 }
 
 QuicByteCount BbrSender::GetTargetCongestionWindow(float gain) const {
@@ -559,6 +582,22 @@ void BbrSender::UpdateAckAggregationBytes(QuicTime ack_time,
                          round_trip_count_);
 }
 
+void BbrSender::MaybeAdjustStartupPacingGain() {
+  const QuicByteCount bdp = GetMinRtt() * BandwidthEstimate();
+  if (bdp == 0) {
+    return;
+  }
+  // The fraction of a BDP the peer acknowledges in bursts arriving faster
+  // than the estimated bandwidth. Near zero when acks arrive smoothly.
+  const float aggregation_fraction =
+      std::min(1.f, static_cast<float>(max_ack_height_.GetBest()) / bdp);
+  // When acks are heavily aggregated the bandwidth filter already
+  // overestimates, so scale the 2/ln(2) gain back towards kMinStartupGain
+  // instead of pacing the full overshoot into the bottleneck queue.
+  pacing_gain_ =
+      kHighGain - (kHighGain - kMinStartupGain) * aggregation_fraction;
+}
+
 void BbrSender::CalculatePacingRate() {
   if (BandwidthEstimate().IsZero()) {
     return;
@@ -582,6 +621,16 @@ void BbrSender::CalculatePacingRate() {
     return;
   }
 
+  if (startup_gain_from_aggregation_) {
+    // The adaptive gain must be able to lower the pacing rate outright;
+    // taking the running maximum below would latch the very overshoot the
+    // adaptation is shedding.
+    pacing_rate_ = std::max(target_rate,
+                            QuicBandwidth::FromBytesAndTimeDelta(
+                                initial_congestion_window_, GetMinRtt()));
+    return;
+  }
+
   // Do not decrease the pacing rate during the startup.
   pacing_rate_ = std::max(pacing_rate_, target_rate);
 }
@@ -609,6 +658,10 @@ void BbrSender::CalculateCongestionWindow(QuicByteCount bytes_acked) {
     }
   } else if (is_at_full_bandwidth_) {
     target_window += max_ack_height_.GetBest();
+  } else if (startup_gain_from_aggregation_) {
+    // The reduced pacing gain relies on the window absorbing the measured
+    // ack aggregation, otherwise in-flight runs dry between ack bursts.
+    target_window += max_ack_height_.GetBest();
   }
 
   if (FLAGS_quic_reloadable_flag_quic_bbr_add_tso_cwnd) {
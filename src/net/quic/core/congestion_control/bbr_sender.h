@@ -199,6 +199,10 @@ class QUIC_EXPORT_PRIVATE BbrSender : public SendAlgorithmInterface {
   void UpdateAckAggregationBytes(QuicTime ack_time,
                                  QuicByteCount newly_acked_bytes);
 
+  // Lowers the STARTUP pacing gain in proportion to the measured ack
+  // aggregation; called once per round trip while in STARTUP.
+  void MaybeAdjustStartupPacingGain();
+
   // Determines the appropriate pacing rate for the connection.
   void CalculatePacingRate();
   // Determines the appropriate congestion window for the connection.
@@ -280,6 +284,9 @@ class QUIC_EXPORT_PRIVATE BbrSender : public SendAlgorithmInterface {
   // If true, exit startup if 1RTT has passed with no bandwidth increase and
   // the connection is in recovery.
   bool exit_startup_on_loss_;
+  // If true, adapt the STARTUP pacing gain to the measured ack aggregation
+  // and add the max ack height to the congestion window during STARTUP.
+  bool startup_gain_from_aggregation_;
 
   // Number of round-trips in PROBE_BW mode, used for determining the current
   // pacing gain cycle.
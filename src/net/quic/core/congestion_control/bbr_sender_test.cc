@@ -388,6 +388,32 @@ TEST_F(BbrSenderTest, SimpleTransfer2RTTAggregationBytes4) {
   ExpectApproxEq(kTestRtt, rtt_stats_->min_rtt(), 0.12f);
 }
 
+// Test a simple long data transfer with 2 rtts of aggregation and the
+// STARTUP pacing gain adapting to the measured aggregation.
+TEST_F(BbrSenderTest, SimpleTransfer2RTTAggregationBytesAdaptiveStartupGain) {
+  FLAGS_quic_reloadable_flag_quic_bbr_adaptive_startup_gain = true;
+  FLAGS_quic_reloadable_flag_quic_bbr_add_tso_cwnd = false;
+
+  CreateDefaultSetup();
+  SetConnectionOption(kBBR3);
+
+  // 2 RTTs of aggregation, with a max of 10kb.
+  EnableAggregation(10 * 1024, 2 * kTestRtt);
+
+  // Transfer 12MB.
+  DoSimpleTransfer(12 * 1024 * 1024, QuicTime::Delta::FromSeconds(35));
+  EXPECT_EQ(BbrSender::PROBE_BW, sender_->ExportDebugState().mode);
+  // It's possible to read a bandwidth as much as 50% too high with aggregation.
+  EXPECT_LE(kTestLinkBandwidth * 0.99f,
+            sender_->ExportDebugState().max_bandwidth);
+  EXPECT_GE(kTestLinkBandwidth * 1.5f,
+            sender_->ExportDebugState().max_bandwidth);
+  // The margin here is high, because the aggregation greatly increases
+  // smoothed rtt.
+  EXPECT_GE(kTestRtt * 3.5, rtt_stats_->smoothed_rtt());
+  ExpectApproxEq(kTestRtt, rtt_stats_->min_rtt(), 0.12f);
+}
+
 // Test a simple long data transfer with 2 rtts of aggregation.
 TEST_F(BbrSenderTest, SimpleTransferAckDecimation4) {
   // Decrease the CWND gain so extra CWND is required with stretch acks.
@@ -32,7 +32,9 @@ GeneralLossAlgorithm::GeneralLossAlgorithm()
       largest_sent_on_spurious_retransmit_(0),
       loss_type_(kNack),
       reordering_shift_(kDefaultLossDelayShift),
-      largest_previously_acked_(0) {}
+      reordering_threshold_(kNumberOfNacksBeforeRetransmission),
+      largest_previously_acked_(0),
+      least_in_flight_(0) {}
 
 GeneralLossAlgorithm::GeneralLossAlgorithm(LossDetectionType loss_type)
     : loss_detection_timeout_(QuicTime::Zero()),
@@ -41,7 +43,9 @@ GeneralLossAlgorithm::GeneralLossAlgorithm(LossDetectionType loss_type)
       reordering_shift_(loss_type == kAdaptiveTime
                             ? kDefaultAdaptiveLossDelayShift
                             : kDefaultLossDelayShift),
-      largest_previously_acked_(0) {}
+      reordering_threshold_(kNumberOfNacksBeforeRetransmission),
+      largest_previously_acked_(0),
+      least_in_flight_(0) {}
 
 LossDetectionType GeneralLossAlgorithm::GetLossDetectionType() const {
   return loss_type_;
@@ -54,7 +58,9 @@ void GeneralLossAlgorithm::SetLossDetectionType(LossDetectionType loss_type) {
   reordering_shift_ = loss_type == kAdaptiveTime
                           ? kDefaultAdaptiveLossDelayShift
                           : kDefaultLossDelayShift;
+  reordering_threshold_ = kNumberOfNacksBeforeRetransmission;
   largest_previously_acked_ = 0;
+  least_in_flight_ = 0;
 }
 
 // Uses nack counts to decide when packets are lost.
@@ -67,21 +73,44 @@ void GeneralLossAlgorithm::DetectLosses(
   loss_detection_timeout_ = QuicTime::Zero();
   QuicTime::Delta max_rtt =
       std::max(rtt_stats.previous_srtt(), rtt_stats.latest_rtt());
+  if (FLAGS_quic_reloadable_flag_quic_windowed_rtt &&
+      !rtt_stats.windowed_max_rtt().IsZero()) {
+    QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_windowed_rtt, 1, 2);
+    // The windowed maximum captures RTT inflation over the whole window,
+    // which the last two samples can miss when acks are sparse.
+    max_rtt = rtt_stats.windowed_max_rtt();
+  }
   QuicTime::Delta loss_delay =
       std::max(QuicTime::Delta::FromMilliseconds(kMinLossDelayMs),
                max_rtt + (max_rtt >> reordering_shift_));
   QuicPacketNumber packet_number = unacked_packets.GetLeastUnacked();
-  for (QuicUnackedPacketMap::const_iterator it = unacked_packets.begin();
-       it != unacked_packets.end() && packet_number <= largest_newly_acked;
+  QuicUnackedPacketMap::const_iterator it = unacked_packets.begin();
+  if (FLAGS_quic_reloadable_flag_quic_incremental_ack_processing &&
+      least_in_flight_ > packet_number) {
+    if (least_in_flight_ > unacked_packets.largest_sent_packet() + 1) {
+      QUIC_BUG << "least_in_flight: " << least_in_flight_
+               << " is greater than largest_sent_packet + 1: "
+               << unacked_packets.largest_sent_packet() + 1;
+    } else {
+      QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_incremental_ack_processing,
+                        2, 2);
+      // Packets below least_in_flight_ were not in flight when the previous
+      // scan finished, and in flight status never comes back for packets at
+      // or below the largest newly acked, so resume the scan there.
+      it += least_in_flight_ - packet_number;
+      packet_number = least_in_flight_;
+    }
+  }
+  least_in_flight_ = 0;
+  for (; it != unacked_packets.end() && packet_number <= largest_newly_acked;
        ++it, ++packet_number) {
     if (!it->in_flight) {
       continue;
     }
 
-    if (loss_type_ == kNack) {
+    if (loss_type_ == kNack || loss_type_ == kAdaptiveNack) {
       // FACK based loss detection.
-      if (largest_newly_acked - packet_number >=
-          kNumberOfNacksBeforeRetransmission) {
+      if (largest_newly_acked - packet_number >= reordering_threshold_) {
         packets_lost->push_back(std::make_pair(packet_number, it->bytes_sent));
         continue;
       }
@@ -107,6 +136,9 @@ void GeneralLossAlgorithm::DetectLosses(
       QuicTime when_lost = it->sent_time + loss_delay;
       if (time < when_lost) {
         loss_detection_timeout_ = when_lost;
+        if (least_in_flight_ == 0) {
+          least_in_flight_ = packet_number;
+        }
         break;
       }
       packets_lost->push_back(std::make_pair(packet_number, it->bytes_sent));
@@ -119,6 +151,15 @@ void GeneralLossAlgorithm::DetectLosses(
       packets_lost->push_back(std::make_pair(packet_number, it->bytes_sent));
       continue;
     }
+
+    // The packet survived every loss check and stays in flight.
+    if (least_in_flight_ == 0) {
+      least_in_flight_ = packet_number;
+    }
+  }
+  if (least_in_flight_ == 0) {
+    // No in flight packets remain at or below the largest newly acked.
+    least_in_flight_ = largest_newly_acked + 1;
   }
   largest_previously_acked_ = largest_newly_acked;
 }
@@ -132,6 +173,17 @@ void GeneralLossAlgorithm::SpuriousRetransmitDetected(
     QuicTime time,
     const RttStats& rtt_stats,
     QuicPacketNumber spurious_retransmission) {
+  if (loss_type_ == kAdaptiveNack) {
+    // Raise the threshold by one packet per epoch so a single badly
+    // reordered flight does not permanently inflate it.
+    if (spurious_retransmission <= largest_sent_on_spurious_retransmit_) {
+      return;
+    }
+    largest_sent_on_spurious_retransmit_ =
+        unacked_packets.largest_sent_packet();
+    ++reordering_threshold_;
+    return;
+  }
   if (loss_type_ != kAdaptiveTime || reordering_shift_ == 0) {
     return;
   }
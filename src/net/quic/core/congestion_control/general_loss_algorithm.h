@@ -19,6 +19,8 @@ namespace net {
 
 // Class which can be configured to implement's TCP's approach of detecting loss
 // when 3 nacks have been received for a packet or with a time threshold.
+// The nack threshold can also be made adaptive, growing when retransmits
+// caused by packet reordering turn out to be spurious.
 // Also implements TCP's early retransmit(RFC5827).
 class QUIC_EXPORT_PRIVATE GeneralLossAlgorithm : public LossDetectionInterface {
  public:
@@ -55,6 +57,8 @@ class QUIC_EXPORT_PRIVATE GeneralLossAlgorithm : public LossDetectionInterface {
 
   int reordering_shift() const { return reordering_shift_; }
 
+  QuicPacketCount reordering_threshold() const { return reordering_threshold_; }
+
  private:
   QuicTime loss_detection_timeout_;
   // Largest sent packet when a spurious retransmit is detected.
@@ -67,8 +71,17 @@ class QUIC_EXPORT_PRIVATE GeneralLossAlgorithm : public LossDetectionInterface {
   // loss.  Fraction calculated by shifting max(SRTT, latest_rtt) to the right
   // by reordering_shift.
   int reordering_shift_;
+  // Number of packets the peer must ack above an outstanding packet before it
+  // is declared lost.  kNumberOfNacksBeforeRetransmission unless adaptive nack
+  // detection has raised it.
+  QuicPacketCount reordering_threshold_;
   // The largest newly acked from the previous call to DetectLosses.
   QuicPacketNumber largest_previously_acked_;
+  // The least in flight packet as of the previous call to DetectLosses.
+  // Packets below it have already been scanned and are no longer in flight,
+  // so the next scan starts here instead of at the least unacked packet.
+  // Zero until the first scan completes.
+  QuicPacketNumber least_in_flight_;
 
   DISALLOW_COPY_AND_ASSIGN(GeneralLossAlgorithm);
 };
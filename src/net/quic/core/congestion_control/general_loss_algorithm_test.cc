@@ -118,6 +118,36 @@ TEST_F(GeneralLossAlgorithmTest, NackRetransmit1PacketSingleAck) {
   EXPECT_EQ(QuicTime::Zero(), loss_algorithm_.GetLossTimeout());
 }
 
+TEST_F(GeneralLossAlgorithmTest, ResumesScanFromLeastInFlight) {
+  FLAGS_quic_reloadable_flag_quic_incremental_ack_processing = true;
+  const size_t kNumSentPackets = 10;
+  // Transmit 10 packets.
+  for (size_t i = 1; i <= kNumSentPackets; ++i) {
+    SendDataPacket(i);
+  }
+
+  // Nack packets 1 and 2 three times each, removing each loss from flight
+  // as the sent packet manager does once it is declared.
+  unacked_packets_.RemoveFromInFlight(3);
+  VerifyLosses(3, std::vector<QuicPacketNumber>{});
+  unacked_packets_.RemoveFromInFlight(4);
+  VerifyLosses(4, {1});
+  unacked_packets_.RemoveFromInFlight(1);
+  unacked_packets_.RemoveFromInFlight(5);
+  VerifyLosses(5, {2});
+  unacked_packets_.RemoveFromInFlight(2);
+
+  // Subsequent detection passes resume above the handled losses and do not
+  // redeclare them; packet 7 is the next one with enough nacks.
+  unacked_packets_.RemoveFromInFlight(6);
+  VerifyLosses(6, std::vector<QuicPacketNumber>{});
+  unacked_packets_.RemoveFromInFlight(10);
+  VerifyLosses(10, {7});
+  // Packet 8 is awaiting the early retransmit timer.
+  EXPECT_EQ(clock_.Now() + 1.25 * rtt_stats_.smoothed_rtt(),
+            loss_algorithm_.GetLossTimeout());
+}
+
 TEST_F(GeneralLossAlgorithmTest, EarlyRetransmit1Packet) {
   const size_t kNumSentPackets = 2;
   // Transmit 2 packets.
@@ -436,6 +466,43 @@ TEST_F(GeneralLossAlgorithmTest, IncreaseThresholdUponSpuriousLoss) {
   EXPECT_EQ(1, loss_algorithm_.reordering_shift());
 }
 
+TEST_F(GeneralLossAlgorithmTest, IncreaseReorderingThresholdUponSpuriousLoss) {
+  loss_algorithm_.SetLossDetectionType(kAdaptiveNack);
+  EXPECT_EQ(3u, loss_algorithm_.reordering_threshold());
+  for (size_t i = 1; i <= 5; ++i) {
+    SendDataPacket(i);
+  }
+  // Packet 1 is declared lost when three packets above it are acked.
+  unacked_packets_.RemoveFromInFlight(2);
+  unacked_packets_.RemoveFromInFlight(3);
+  unacked_packets_.RemoveFromInFlight(4);
+  VerifyLosses(4, {1});
+  unacked_packets_.RemoveFromInFlight(1);
+  // Retransmit packet 1 as 6.
+  SendDataPacket(6);
+
+  // The retransmit was spurious, so the reordering threshold grows by one.
+  loss_algorithm_.SpuriousRetransmitDetected(unacked_packets_, clock_.Now(),
+                                             rtt_stats_, 6);
+  EXPECT_EQ(4u, loss_algorithm_.reordering_threshold());
+  // A second spurious retransmit in the same epoch has no effect.
+  loss_algorithm_.SpuriousRetransmitDetected(unacked_packets_, clock_.Now(),
+                                             rtt_stats_, 6);
+  EXPECT_EQ(4u, loss_algorithm_.reordering_threshold());
+
+  // Four packets of reordering are now tolerated.
+  for (size_t i = 7; i <= 10; ++i) {
+    SendDataPacket(i);
+  }
+  unacked_packets_.RemoveFromInFlight(6);
+  unacked_packets_.RemoveFromInFlight(7);
+  unacked_packets_.RemoveFromInFlight(8);
+  VerifyLosses(8, std::vector<QuicPacketNumber>{});
+  unacked_packets_.RemoveFromInFlight(9);
+  VerifyLosses(9, {5});
+  EXPECT_EQ(QuicTime::Zero(), loss_algorithm_.GetLossTimeout());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
@@ -137,6 +137,42 @@ QuicTime::Delta PacingSender::TimeUntilSend(QuicTime now,
   return QuicTime::Delta::Zero();
 }
 
+uint32_t PacingSender::BurstAllowance(QuicTime now,
+                                      QuicByteCount bytes_in_flight) const {
+  DCHECK(sender_ != nullptr);
+  if (!sender_->TimeUntilSend(now, bytes_in_flight).IsZero()) {
+    // The underlying sender prevents sending.
+    return 0;
+  }
+  if (burst_tokens_ > 0) {
+    return burst_tokens_;
+  }
+  if (bytes_in_flight == 0) {
+    // Leaving quiescence; OnPacketSent will replenish the burst tokens.
+    return kInitialUnpacedBurst;
+  }
+  if (ideal_next_packet_send_time_ > now + kAlarmGranularity) {
+    // The pacer would delay the next packet.
+    return 0;
+  }
+  // Count how many full-sized packets have ideal send times within the
+  // alarm granularity, the same bound TimeUntilSend uses to send early
+  // rather than set a fine-grained alarm.
+  const QuicTime::Delta per_packet_delay =
+      PacingRate(bytes_in_flight + kDefaultTCPMSS)
+          .TransferTime(kDefaultTCPMSS);
+  if (per_packet_delay.IsZero()) {
+    return kMaxPacketBurstSize;
+  }
+  const QuicTime first_send_time =
+      std::max(ideal_next_packet_send_time_, now);
+  const uint64_t allowance =
+      1 + (now + kAlarmGranularity - first_send_time).ToMicroseconds() /
+              per_packet_delay.ToMicroseconds();
+  return static_cast<uint32_t>(
+      std::min<uint64_t>(allowance, kMaxPacketBurstSize));
+}
+
 QuicBandwidth PacingSender::PacingRate(QuicByteCount bytes_in_flight) const {
   DCHECK(sender_ != nullptr);
   if (!max_pacing_rate_.IsZero()) {
@@ -54,8 +54,22 @@ class QUIC_EXPORT_PRIVATE PacingSender {
 
   QuicTime::Delta TimeUntilSend(QuicTime now, QuicByteCount bytes_in_flight);
 
+  // Returns the number of packets which can be sent back to back right now
+  // without violating the pacing schedule: the remaining unpaced burst
+  // tokens, or in the paced regime the number of full-sized packets whose
+  // ideal send times all fall within the alarm granularity. Returns 0 when
+  // the next send must be delayed. Does not modify any pacing state.
+  uint32_t BurstAllowance(QuicTime now, QuicByteCount bytes_in_flight) const;
+
   QuicBandwidth PacingRate(QuicByteCount bytes_in_flight) const;
 
+  // The earliest time the pacing schedule allows the next packet onto the
+  // wire. Used to stamp packets with a release time when pacing is offloaded
+  // to the kernel.
+  QuicTime ideal_next_packet_send_time() const {
+    return ideal_next_packet_send_time_;
+  }
+
  private:
   // Underlying sender. Not owned.
   SendAlgorithmInterface* sender_;
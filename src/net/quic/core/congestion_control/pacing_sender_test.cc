@@ -134,6 +134,64 @@ TEST_F(PacingSenderTest, SendNow) {
   }
 }
 
+TEST_F(PacingSenderTest, BurstAllowanceIsZeroWhenSenderForbidsSending) {
+  EXPECT_CALL(*mock_sender_, TimeUntilSend(clock_.Now(), kBytesInFlight))
+      .WillOnce(Return(infinite_time_));
+  EXPECT_EQ(0u, pacing_sender_->BurstAllowance(clock_.Now(), kBytesInFlight));
+}
+
+TEST_F(PacingSenderTest, BurstAllowanceUsesBurstTokens) {
+  // All the initial burst tokens remain unspent, so they are all available.
+  EXPECT_CALL(*mock_sender_, TimeUntilSend(clock_.Now(), kBytesInFlight))
+      .WillOnce(Return(zero_time_));
+  EXPECT_EQ(static_cast<uint32_t>(kInitialBurstPackets),
+            pacing_sender_->BurstAllowance(clock_.Now(), kBytesInFlight));
+
+  // Spending a token shrinks the allowance accordingly.
+  CheckPacketIsSentImmediately();
+  EXPECT_CALL(*mock_sender_, TimeUntilSend(clock_.Now(), kBytesInFlight))
+      .WillOnce(Return(zero_time_));
+  EXPECT_EQ(static_cast<uint32_t>(kInitialBurstPackets) - 1,
+            pacing_sender_->BurstAllowance(clock_.Now(), kBytesInFlight));
+}
+
+TEST_F(PacingSenderTest, BurstAllowanceInPacedRegime) {
+  // Configure pacing rate of 1 packet per millisecond.
+  InitPacingRate(kInitialBurstPackets,
+                 QuicBandwidth::FromBytesAndTimeDelta(
+                     kMaxPacketSize, QuicTime::Delta::FromMilliseconds(1)));
+  UpdateRtt();
+
+  // Consume the initial burst tokens.
+  for (int i = 0; i < kInitialBurstPackets; ++i) {
+    CheckPacketIsSentImmediately();
+  }
+
+  // With no tokens left, only the packets whose ideal send times fall
+  // within the alarm granularity may be sent back to back. At 1 packet
+  // per millisecond that is a single packet.
+  EXPECT_CALL(*mock_sender_, TimeUntilSend(clock_.Now(), kBytesInFlight))
+      .WillRepeatedly(Return(zero_time_));
+  EXPECT_EQ(1u, pacing_sender_->BurstAllowance(clock_.Now(), kBytesInFlight));
+}
+
+TEST_F(PacingSenderTest, IdealNextPacketSendTimeTracksPacedSchedule) {
+  // Configure pacing rate of 1 packet per 1 ms, no initial burst.
+  InitPacingRate(0, QuicBandwidth::FromBytesAndTimeDelta(
+                        kMaxPacketSize, QuicTime::Delta::FromMilliseconds(1)));
+  UpdateRtt();
+
+  // Sending pushes the ideal send time for the next packet one pacing
+  // interval past the current schedule, which a release-time writer can use
+  // to stamp packets instead of waiting for the send alarm.
+  CheckPacketIsSentImmediately();
+  EXPECT_EQ(clock_.Now() + QuicTime::Delta::FromMilliseconds(1),
+            pacing_sender_->ideal_next_packet_send_time());
+  CheckPacketIsSentImmediately();
+  EXPECT_EQ(clock_.Now() + QuicTime::Delta::FromMilliseconds(2),
+            pacing_sender_->ideal_next_packet_send_time());
+}
+
 TEST_F(PacingSenderTest, VariousSending) {
   // Configure pacing rate of 1 packet per 1 ms, no initial burst.
   InitPacingRate(0, QuicBandwidth::FromBytesAndTimeDelta(
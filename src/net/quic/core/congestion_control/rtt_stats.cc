@@ -14,6 +14,9 @@ namespace {
 
 // Default initial rtt used before any samples are received.
 const int kInitialRttMs = 100;
+// Default period after which windowed min and max RTT samples expire.
+const QuicTime::Delta kDefaultRttWindowLength =
+    QuicTime::Delta::FromSeconds(10);
 const float kAlpha = 0.125f;
 const float kOneMinusAlpha = (1 - kAlpha);
 const float kBeta = 0.25f;
@@ -27,7 +30,13 @@ RttStats::RttStats()
       smoothed_rtt_(QuicTime::Delta::Zero()),
       previous_srtt_(QuicTime::Delta::Zero()),
       mean_deviation_(QuicTime::Delta::Zero()),
-      initial_rtt_us_(kInitialRttMs * kNumMicrosPerMilli) {}
+      initial_rtt_us_(kInitialRttMs * kNumMicrosPerMilli),
+      windowed_min_rtt_(kDefaultRttWindowLength,
+                        QuicTime::Delta::Zero(),
+                        QuicTime::Zero()),
+      windowed_max_rtt_(kDefaultRttWindowLength,
+                        QuicTime::Delta::Zero(),
+                        QuicTime::Zero()) {}
 
 void RttStats::ExpireSmoothedMetrics() {
   mean_deviation_ = std::max(
@@ -55,6 +64,8 @@ void RttStats::UpdateRtt(QuicTime::Delta send_delta,
   if (min_rtt_.IsZero() || min_rtt_ > send_delta) {
     min_rtt_ = send_delta;
   }
+  // The windowed min also uses the raw send_delta for the same reason.
+  windowed_min_rtt_.Update(send_delta, now);
 
   // Correct for ack_delay if information received from the peer results in a
   // positive RTT sample. Otherwise, we use the send_delta as a reasonable
@@ -66,6 +77,7 @@ void RttStats::UpdateRtt(QuicTime::Delta send_delta,
     rtt_sample = rtt_sample - ack_delay;
   }
   latest_rtt_ = rtt_sample;
+  windowed_max_rtt_.Update(rtt_sample, now);
   // First time call.
   if (smoothed_rtt_.IsZero()) {
     smoothed_rtt_ = rtt_sample;
@@ -87,6 +99,8 @@ void RttStats::OnConnectionMigration() {
   smoothed_rtt_ = QuicTime::Delta::Zero();
   mean_deviation_ = QuicTime::Delta::Zero();
   initial_rtt_us_ = kInitialRttMs * kNumMicrosPerMilli;
+  windowed_min_rtt_.Reset(QuicTime::Delta::Zero(), QuicTime::Zero());
+  windowed_max_rtt_.Reset(QuicTime::Delta::Zero(), QuicTime::Zero());
 }
 
 }  // namespace net
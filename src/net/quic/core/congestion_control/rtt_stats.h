@@ -11,6 +11,7 @@
 #include <cstdint>
 
 #include "base/macros.h"
+#include "net/quic/core/congestion_control/windowed_filter.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_time.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
@@ -66,6 +67,24 @@ class QUIC_EXPORT_PRIVATE RttStats {
   // May return Zero if no valid updates have occurred.
   QuicTime::Delta min_rtt() const { return min_rtt_; }
 
+  // Returns the lowest RTT observed over the last rtt window.
+  // May return Zero if no valid updates have occurred.
+  QuicTime::Delta windowed_min_rtt() const {
+    return windowed_min_rtt_.GetBest();
+  }
+
+  // Returns the highest RTT observed over the last rtt window.
+  // May return Zero if no valid updates have occurred.
+  QuicTime::Delta windowed_max_rtt() const {
+    return windowed_max_rtt_.GetBest();
+  }
+
+  // Sets the period after which windowed min and max RTT samples expire.
+  void SetRttWindowLength(QuicTime::Delta window_length) {
+    windowed_min_rtt_.SetWindowLength(window_length);
+    windowed_max_rtt_.SetWindowLength(window_length);
+  }
+
   QuicTime::Delta mean_deviation() const { return mean_deviation_; }
 
  private:
@@ -80,6 +99,19 @@ class QUIC_EXPORT_PRIVATE RttStats {
   // larger than the standard deviation, for a normally distributed signal.
   QuicTime::Delta mean_deviation_;
   int64_t initial_rtt_us_;
+  // Windowed filters over the raw RTT samples, in microsecond resolution.
+  // Unlike |min_rtt_|, these expire, so they track the recent path rather
+  // than the connection's lifetime best.
+  WindowedFilter<QuicTime::Delta,
+                 MinFilter<QuicTime::Delta>,
+                 QuicTime,
+                 QuicTime::Delta>
+      windowed_min_rtt_;
+  WindowedFilter<QuicTime::Delta,
+                 MaxFilter<QuicTime::Delta>,
+                 QuicTime,
+                 QuicTime::Delta>
+      windowed_max_rtt_;
 
   DISALLOW_COPY_AND_ASSIGN(RttStats);
 };
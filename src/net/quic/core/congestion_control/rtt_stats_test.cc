@@ -163,6 +163,52 @@ TEST_F(RttStatsTest, UpdateRttWithBadSendDeltas) {
   }
 }
 
+TEST_F(RttStatsTest, WindowedMinAndMaxRtt) {
+  EXPECT_EQ(QuicTime::Delta::Zero(), rtt_stats_.windowed_min_rtt());
+  EXPECT_EQ(QuicTime::Delta::Zero(), rtt_stats_.windowed_max_rtt());
+  rtt_stats_.SetRttWindowLength(QuicTime::Delta::FromMilliseconds(100));
+
+  rtt_stats_.UpdateRtt(QuicTime::Delta::FromMilliseconds(50),
+                       QuicTime::Delta::Zero(), QuicTime::Zero());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(50),
+            rtt_stats_.windowed_min_rtt());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(50),
+            rtt_stats_.windowed_max_rtt());
+  rtt_stats_.UpdateRtt(
+      QuicTime::Delta::FromMilliseconds(10), QuicTime::Delta::Zero(),
+      QuicTime::Zero() + QuicTime::Delta::FromMilliseconds(10));
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(10),
+            rtt_stats_.windowed_min_rtt());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(50),
+            rtt_stats_.windowed_max_rtt());
+  // The windowed min uses the raw send_delta, not the ack_delay corrected rtt,
+  // while the windowed max uses the corrected sample.
+  rtt_stats_.UpdateRtt(
+      QuicTime::Delta::FromMilliseconds(12),
+      QuicTime::Delta::FromMilliseconds(5),
+      QuicTime::Zero() + QuicTime::Delta::FromMilliseconds(20));
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(10),
+            rtt_stats_.windowed_min_rtt());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(50),
+            rtt_stats_.windowed_max_rtt());
+
+  // Once the window passes, the old extremes expire and more recent samples
+  // take over, while min_rtt() keeps the lifetime minimum.
+  rtt_stats_.UpdateRtt(
+      QuicTime::Delta::FromMilliseconds(30), QuicTime::Delta::Zero(),
+      QuicTime::Zero() + QuicTime::Delta::FromMilliseconds(150));
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(30),
+            rtt_stats_.windowed_min_rtt());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(30),
+            rtt_stats_.windowed_max_rtt());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(10), rtt_stats_.min_rtt());
+
+  // Connection migration resets the windowed filters along with the rest.
+  rtt_stats_.OnConnectionMigration();
+  EXPECT_EQ(QuicTime::Delta::Zero(), rtt_stats_.windowed_min_rtt());
+  EXPECT_EQ(QuicTime::Delta::Zero(), rtt_stats_.windowed_max_rtt());
+}
+
 TEST_F(RttStatsTest, ResetAfterConnectionMigrations) {
   rtt_stats_.UpdateRtt(QuicTime::Delta::FromMilliseconds(300),
                        QuicTime::Delta::FromMilliseconds(100),
@@ -74,6 +74,12 @@ class QUIC_EXPORT_PRIVATE SendAlgorithmInterface {
                             QuicByteCount bytes,
                             HasRetransmittableData is_retransmittable) = 0;
 
+  // Called when an incoming ack reports a new count of packets received with
+  // the ECN CE (congestion experienced) codepoint. |ecn_ce_count| is the
+  // cumulative count over the lifetime of the connection. Senders which do
+  // not react to ECN may ignore this; the default does nothing.
+  virtual void OnEcnFeedback(QuicPacketCount ecn_ce_count) {}
+
   // Called when the retransmission timeout fires.  Neither OnPacketAbandoned
   // nor OnPacketLost will be called for these packets.
   virtual void OnRetransmissionTimeout(bool packets_retransmitted) = 0;
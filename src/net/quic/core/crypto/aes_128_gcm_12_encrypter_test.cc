@@ -6,6 +6,7 @@
 
 #include <memory>
 
+#include "net/quic/core/crypto/aes_128_gcm_12_decrypter.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_test.h"
 #include "net/quic/platform/api/quic_text_utils.h"
@@ -223,6 +224,60 @@ TEST_F(Aes128Gcm12EncrypterTest, Encrypt) {
   }
 }
 
+TEST_F(Aes128Gcm12EncrypterTest, EncryptAndDecryptBatch) {
+  const string key("0123456789abcdef");
+  const string nonce_prefix("abcd");
+
+  Aes128Gcm12Encrypter encrypter;
+  ASSERT_TRUE(encrypter.SetKey(key));
+  ASSERT_TRUE(encrypter.SetNoncePrefix(nonce_prefix));
+  Aes128Gcm12Decrypter decrypter;
+  ASSERT_TRUE(decrypter.SetKey(key));
+  ASSERT_TRUE(decrypter.SetNoncePrefix(nonce_prefix));
+
+  const size_t kNumPackets = 4;
+  string plaintexts[kNumPackets];
+  char ciphertexts[kNumPackets][128];
+  QuicEncrypter::BatchEntry encrypt_entries[kNumPackets];
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    plaintexts[i] = string(10 + i, 'a' + i);
+    encrypt_entries[i].packet_number = i + 1;
+    encrypt_entries[i].associated_data = QuicStringPiece("header");
+    encrypt_entries[i].plaintext = plaintexts[i];
+    encrypt_entries[i].output = ciphertexts[i];
+    encrypt_entries[i].max_output_length = sizeof(ciphertexts[i]);
+  }
+  ASSERT_EQ(kNumPackets, encrypter.EncryptPackets(
+                             QUIC_VERSION_35, encrypt_entries, kNumPackets));
+
+  // Corrupt one packet; the rest of the batch must still decrypt.
+  ciphertexts[2][0] ^= 0x80;
+
+  char decrypted[kNumPackets][128];
+  QuicDecrypter::BatchEntry decrypt_entries[kNumPackets];
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    decrypt_entries[i].packet_number = i + 1;
+    decrypt_entries[i].associated_data = QuicStringPiece("header");
+    decrypt_entries[i].ciphertext =
+        QuicStringPiece(ciphertexts[i], encrypt_entries[i].output_length);
+    decrypt_entries[i].output = decrypted[i];
+    decrypt_entries[i].max_output_length = sizeof(decrypted[i]);
+  }
+  EXPECT_EQ(kNumPackets - 1, decrypter.DecryptPackets(
+                                 QUIC_VERSION_35, decrypt_entries,
+                                 kNumPackets));
+
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    if (i == 2) {
+      EXPECT_FALSE(decrypt_entries[i].success);
+      continue;
+    }
+    ASSERT_TRUE(decrypt_entries[i].success);
+    EXPECT_EQ(plaintexts[i],
+              string(decrypted[i], decrypt_entries[i].output_length));
+  }
+}
+
 TEST_F(Aes128Gcm12EncrypterTest, GetMaxPlaintextSize) {
   Aes128Gcm12Encrypter encrypter;
   EXPECT_EQ(1000u, encrypter.GetMaxPlaintextSize(1012));
@@ -0,0 +1,128 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/crypto/cached_network_parameters_codec.h"
+
+#include <cstdint>
+
+namespace net {
+
+namespace {
+
+const uint8_t kCompactFormatVersion = 1;
+
+// Sanity cap on the serving region; upstream values are short ASCII tags.
+const size_t kMaxServingRegionSize = 256;
+
+void AppendVarint64(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// Maps signed values to unsigned so small magnitudes of either sign encode
+// small: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Reads one varint from |*pos| without running past |end|. Advances |*pos|
+// past the consumed bytes on success.
+bool ReadVarint64(const char** pos, const char* end, uint64_t* value) {
+  uint64_t result = 0;
+  int shift = 0;
+  while (*pos != end && shift <= 63) {
+    const uint8_t byte = static_cast<uint8_t>(**pos);
+    ++*pos;
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+    shift += 7;
+  }
+  return false;
+}
+
+}  // namespace
+
+std::string SerializeCachedNetworkParametersCompact(
+    const CachedNetworkParameters& params) {
+  std::string out;
+  out.push_back(static_cast<char>(kCompactFormatVersion));
+  AppendVarint64(static_cast<uint64_t>(params.timestamp()), &out);
+  AppendVarint64(ZigZagEncode(params.max_bandwidth_timestamp_seconds() -
+                              params.timestamp()),
+                 &out);
+  AppendVarint64(
+      static_cast<uint64_t>(params.bandwidth_estimate_bytes_per_second()),
+      &out);
+  AppendVarint64(
+      ZigZagEncode(
+          static_cast<int64_t>(
+              params.max_bandwidth_estimate_bytes_per_second()) -
+          params.bandwidth_estimate_bytes_per_second()),
+      &out);
+  AppendVarint64(static_cast<uint64_t>(params.min_rtt_ms()), &out);
+  AppendVarint64(static_cast<uint64_t>(params.previous_connection_state()),
+                 &out);
+  AppendVarint64(params.serving_region().size(), &out);
+  out.append(params.serving_region());
+  return out;
+}
+
+bool DeserializeCachedNetworkParametersCompact(QuicStringPiece in,
+                                               CachedNetworkParameters* out) {
+  const char* pos = in.data();
+  const char* end = in.data() + in.size();
+  if (pos == end || static_cast<uint8_t>(*pos) != kCompactFormatVersion) {
+    return false;
+  }
+  ++pos;
+
+  uint64_t timestamp;
+  uint64_t max_bandwidth_timestamp_delta;
+  uint64_t bandwidth_estimate;
+  uint64_t max_bandwidth_delta;
+  uint64_t min_rtt_ms;
+  uint64_t previous_connection_state;
+  uint64_t serving_region_size;
+  if (!ReadVarint64(&pos, end, &timestamp) ||
+      !ReadVarint64(&pos, end, &max_bandwidth_timestamp_delta) ||
+      !ReadVarint64(&pos, end, &bandwidth_estimate) ||
+      !ReadVarint64(&pos, end, &max_bandwidth_delta) ||
+      !ReadVarint64(&pos, end, &min_rtt_ms) ||
+      !ReadVarint64(&pos, end, &previous_connection_state) ||
+      !ReadVarint64(&pos, end, &serving_region_size)) {
+    return false;
+  }
+  if (serving_region_size > kMaxServingRegionSize ||
+      serving_region_size != static_cast<size_t>(end - pos)) {
+    return false;
+  }
+
+  out->set_timestamp(static_cast<int64_t>(timestamp));
+  out->set_max_bandwidth_timestamp_seconds(
+      static_cast<int64_t>(timestamp) +
+      ZigZagDecode(max_bandwidth_timestamp_delta));
+  out->set_bandwidth_estimate_bytes_per_second(
+      static_cast<int32_t>(bandwidth_estimate));
+  out->set_max_bandwidth_estimate_bytes_per_second(static_cast<int32_t>(
+      static_cast<int64_t>(bandwidth_estimate) +
+      ZigZagDecode(max_bandwidth_delta)));
+  out->set_min_rtt_ms(static_cast<int32_t>(min_rtt_ms));
+  out->set_previous_connection_state(
+      static_cast<int32_t>(previous_connection_state));
+  out->set_serving_region(std::string(pos, serving_region_size));
+  return true;
+}
+
+}  // namespace net
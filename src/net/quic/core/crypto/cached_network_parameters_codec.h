@@ -0,0 +1,45 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_CRYPTO_CACHED_NETWORK_PARAMETERS_CODEC_H_
+#define NET_QUIC_CORE_CRYPTO_CACHED_NETWORK_PARAMETERS_CODEC_H_
+
+#include <string>
+
+#include "net/quic/core/proto/cached_network_parameters.pb.h"
+#include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+
+namespace net {
+
+// A compact, hand-rolled encoding of CachedNetworkParameters for embedding in
+// source-address tokens, where the full protobuf form inflates both the token
+// bytes echoed in every handshake and the parse cost of CHLO validation.
+//
+// Layout: a format-version byte followed by varints in fixed order, so
+// decoding is a single bounds-checked forward scan with no tag dispatch.
+// Fields that correlate are delta-encoded (zigzag) against their anchor:
+// max_bandwidth_timestamp_seconds against timestamp, and
+// max_bandwidth_estimate_bytes_per_second against
+// bandwidth_estimate_bytes_per_second. The serving region, usually empty or a
+// short ASCII tag, is length-prefixed at the end.
+//
+// Both sides of the encoding live on the server, so the format can evolve by
+// bumping the version byte; DeserializeCachedNetworkParametersCompact()
+// rejects unknown versions and truncated or oversized input.
+
+// Serializes |params| to the compact form described above.
+QUIC_EXPORT_PRIVATE std::string SerializeCachedNetworkParametersCompact(
+    const CachedNetworkParameters& params);
+
+// Parses the compact form in |in| into |out|. Returns false without modifying
+// |out| if |in| is truncated, has trailing bytes, or carries an unknown
+// format version.
+QUIC_EXPORT_PRIVATE bool DeserializeCachedNetworkParametersCompact(
+    QuicStringPiece in,
+    CachedNetworkParameters* out);
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_CRYPTO_CACHED_NETWORK_PARAMETERS_CODEC_H_
@@ -0,0 +1,104 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/crypto/cached_network_parameters_codec.h"
+
+#include <string>
+
+#include "net/quic/platform/api/quic_test.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class CachedNetworkParametersCodecTest : public QuicTest {};
+
+TEST_F(CachedNetworkParametersCodecTest, RoundTrip) {
+  CachedNetworkParameters params;
+  params.set_serving_region("usw2");
+  params.set_bandwidth_estimate_bytes_per_second(5000000);
+  params.set_max_bandwidth_estimate_bytes_per_second(7500000);
+  params.set_max_bandwidth_timestamp_seconds(1500000000);
+  params.set_min_rtt_ms(25);
+  params.set_previous_connection_state(1);
+  params.set_timestamp(1500000100);
+
+  const std::string blob = SerializeCachedNetworkParametersCompact(params);
+  CachedNetworkParameters parsed;
+  ASSERT_TRUE(DeserializeCachedNetworkParametersCompact(blob, &parsed));
+
+  EXPECT_EQ(params.serving_region(), parsed.serving_region());
+  EXPECT_EQ(params.bandwidth_estimate_bytes_per_second(),
+            parsed.bandwidth_estimate_bytes_per_second());
+  EXPECT_EQ(params.max_bandwidth_estimate_bytes_per_second(),
+            parsed.max_bandwidth_estimate_bytes_per_second());
+  EXPECT_EQ(params.max_bandwidth_timestamp_seconds(),
+            parsed.max_bandwidth_timestamp_seconds());
+  EXPECT_EQ(params.min_rtt_ms(), parsed.min_rtt_ms());
+  EXPECT_EQ(params.previous_connection_state(),
+            parsed.previous_connection_state());
+  EXPECT_EQ(params.timestamp(), parsed.timestamp());
+}
+
+TEST_F(CachedNetworkParametersCodecTest, RoundTripNegativeDeltas) {
+  // The anchors can exceed the delta-encoded fields; zigzag keeps the
+  // negative deltas small on the wire.
+  CachedNetworkParameters params;
+  params.set_bandwidth_estimate_bytes_per_second(4000000);
+  params.set_max_bandwidth_estimate_bytes_per_second(3000000);
+  params.set_max_bandwidth_timestamp_seconds(1499999000);
+  params.set_timestamp(1500000000);
+
+  const std::string blob = SerializeCachedNetworkParametersCompact(params);
+  CachedNetworkParameters parsed;
+  ASSERT_TRUE(DeserializeCachedNetworkParametersCompact(blob, &parsed));
+
+  EXPECT_EQ(3000000, parsed.max_bandwidth_estimate_bytes_per_second());
+  EXPECT_EQ(1499999000, parsed.max_bandwidth_timestamp_seconds());
+}
+
+TEST_F(CachedNetworkParametersCodecTest, RoundTripDefaults) {
+  CachedNetworkParameters params;
+  const std::string blob = SerializeCachedNetworkParametersCompact(params);
+  CachedNetworkParameters parsed;
+  ASSERT_TRUE(DeserializeCachedNetworkParametersCompact(blob, &parsed));
+  EXPECT_EQ("", parsed.serving_region());
+  EXPECT_EQ(0, parsed.bandwidth_estimate_bytes_per_second());
+  EXPECT_EQ(0, parsed.timestamp());
+}
+
+TEST_F(CachedNetworkParametersCodecTest, RejectsUnknownVersion) {
+  CachedNetworkParameters params;
+  std::string blob = SerializeCachedNetworkParametersCompact(params);
+  blob[0] = 0x7f;
+  CachedNetworkParameters parsed;
+  EXPECT_FALSE(DeserializeCachedNetworkParametersCompact(blob, &parsed));
+}
+
+TEST_F(CachedNetworkParametersCodecTest, RejectsTruncatedInput) {
+  CachedNetworkParameters params;
+  params.set_serving_region("region");
+  params.set_bandwidth_estimate_bytes_per_second(5000000);
+  params.set_timestamp(1500000100);
+  const std::string blob = SerializeCachedNetworkParametersCompact(params);
+
+  CachedNetworkParameters parsed;
+  for (size_t len = 0; len < blob.size(); ++len) {
+    EXPECT_FALSE(DeserializeCachedNetworkParametersCompact(
+        QuicStringPiece(blob.data(), len), &parsed))
+        << "prefix of length " << len << " unexpectedly parsed";
+  }
+}
+
+TEST_F(CachedNetworkParametersCodecTest, RejectsTrailingBytes) {
+  CachedNetworkParameters params;
+  std::string blob = SerializeCachedNetworkParametersCompact(params);
+  blob.push_back('x');
+  CachedNetworkParameters parsed;
+  EXPECT_FALSE(DeserializeCachedNetworkParametersCompact(blob, &parsed));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -0,0 +1,75 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_CRYPTO_CRYPTO_BOX_OFFLOAD_H_
+#define NET_QUIC_CORE_CRYPTO_CRYPTO_BOX_OFFLOAD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+
+namespace net {
+
+// Interface to a device (e.g. a NIC with inline crypto queues) that can run
+// CryptoSecretBoxer seal and open operations off the host CPUs. Jobs are
+// small and independent, so the interface is ring-shaped: callers submit a
+// batch, the device accepts some prefix of it, and completions are harvested
+// with Poll in whatever order the device finishes them. Anything the device
+// does not accept is run in software by the caller, so a provider may shed
+// load freely by accepting fewer jobs.
+//
+// A provider must produce and consume the exact CryptoSecretBoxer wire
+// format: a random nonce, the ciphertext, and the AEAD authenticator, using
+// the keys most recently supplied via SetKeys.
+//
+// Thread safety is the provider's problem: CryptoSecretBoxer may call Submit
+// and Poll from any thread that calls its batch operations.
+class QUIC_EXPORT_PRIVATE CryptoBoxOffload {
+ public:
+  enum JobType {
+    // Box: |input| is plaintext, |*output| receives the box.
+    SEAL,
+    // Unbox: |input| is a box, |*output| receives the plaintext.
+    OPEN,
+  };
+
+  // One seal or open operation. The caller owns the Job and the buffers it
+  // points at; both must stay valid until the job is returned by Poll.
+  struct Job {
+    JobType type;
+    // Opaque caller tag, untouched by the provider.
+    uint64_t cookie;
+    QuicStringPiece input;
+    std::string* output;
+    // Set by the provider on completion. An OPEN job fails when the box
+    // does not authenticate under any key; a SEAL job fails only on device
+    // error. Failed jobs are retried in software by the caller.
+    bool ok;
+  };
+
+  virtual ~CryptoBoxOffload() {}
+
+  // Loads |keys| into the device, replacing any previous set. As with
+  // CryptoSecretBoxer::SetKeys, the first key seals and all keys are tried
+  // when opening. Returns false if the device cannot take the keys, in
+  // which case the caller stops offloading.
+  virtual bool SetKeys(const std::vector<std::string>& keys) = 0;
+
+  // Offers |num_jobs| jobs starting at |jobs| and returns how many were
+  // accepted, always a prefix of the batch. Every accepted job must
+  // eventually be returned by Poll, exactly once.
+  virtual size_t Submit(Job* jobs, size_t num_jobs) = 0;
+
+  // Harvests up to |max_jobs| completed jobs into |completed|, returning
+  // the number written. Completion order is unspecified.
+  virtual size_t Poll(Job** completed, size_t max_jobs) = 0;
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_CRYPTO_CRYPTO_BOX_OFFLOAD_H_
@@ -96,7 +96,9 @@ size_t CryptoFramer::InputBytesRemaining() const {
 QuicData* CryptoFramer::ConstructHandshakeMessage(
     const CryptoHandshakeMessage& message,
     Perspective perspective) {
-  size_t num_entries = message.tag_value_map().size();
+  std::vector<std::pair<QuicTag, QuicStringPiece>> entries;
+  message.GetEntries(&entries);
+  size_t num_entries = entries.size();
   size_t pad_length = 0;
   bool need_pad_tag = false;
   bool need_pad_value = false;
@@ -136,8 +138,9 @@ QuicData* CryptoFramer::ConstructHandshakeMessage(
 
   uint32_t end_offset = 0;
   // Tags and offsets
-  for (QuicTagValueMap::const_iterator it = message.tag_value_map().begin();
-       it != message.tag_value_map().end(); ++it) {
+  for (std::vector<std::pair<QuicTag, QuicStringPiece>>::const_iterator it =
+           entries.begin();
+       it != entries.end(); ++it) {
     if (it->first == kPAD && need_pad_tag) {
       // Existing PAD tags are only checked when padding needs to be added
       // because parts of the code may need to reserialize received messages
@@ -171,8 +174,9 @@ QuicData* CryptoFramer::ConstructHandshakeMessage(
   }
 
   // Values
-  for (QuicTagValueMap::const_iterator it = message.tag_value_map().begin();
-       it != message.tag_value_map().end(); ++it) {
+  for (std::vector<std::pair<QuicTag, QuicStringPiece>>::const_iterator it =
+           entries.begin();
+       it != entries.end(); ++it) {
     if (it->first > kPAD && need_pad_value) {
       need_pad_value = false;
       if (!writer.WriteRepeatedByte('-', pad_length)) {
@@ -270,19 +274,20 @@ QuicErrorCode CryptoFramer::Process(QuicStringPiece input,
       values_len_ = last_end_offset;
       state_ = STATE_READING_VALUES;
     }
-    case STATE_READING_VALUES:
+    case STATE_READING_VALUES: {
       if (reader.BytesRemaining() < values_len_) {
         break;
       }
-      for (const std::pair<QuicTag, size_t>& item : tags_and_lengths_) {
-        QuicStringPiece value;
-        reader.ReadStringPiece(&value, item.second);
-        message_.SetStringPiece(item.first, value);
-      }
+      QuicStringPiece values;
+      reader.ReadStringPiece(&values, values_len_);
+      // Hand the whole value region to the message in one call so that it can
+      // be backed by a single copy rather than one allocation per tag.
+      message_.SetParsedContents(tags_and_lengths_, values);
       visitor_->OnHandshakeMessage(message_);
       Clear();
       state_ = STATE_READING_TAG;
       break;
+    }
   }
   // Save any remaining data.
   buffer_ = reader.PeekRemainingPayload().as_string();
@@ -4,6 +4,7 @@
 
 #include "net/quic/core/crypto/crypto_handshake_message.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "net/quic/core/crypto/crypto_framer.h"
@@ -12,7 +13,6 @@
 #include "net/quic/core/quic_socket_address_coder.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_endian.h"
-#include "net/quic/platform/api/quic_map_util.h"
 #include "net/quic/platform/api/quic_str_cat.h"
 #include "net/quic/platform/api/quic_text_utils.h"
 
@@ -26,6 +26,8 @@ CryptoHandshakeMessage::CryptoHandshakeMessage(
     const CryptoHandshakeMessage& other)
     : tag_(other.tag_),
       tag_value_map_(other.tag_value_map_),
+      arena_(other.arena_),
+      arena_index_(other.arena_index_),
       minimum_size_(other.minimum_size_) {
   // Don't copy serialized_. unique_ptr doesn't have a copy constructor.
   // The new object can lazily reconstruct serialized_.
@@ -40,6 +42,8 @@ CryptoHandshakeMessage& CryptoHandshakeMessage::operator=(
     const CryptoHandshakeMessage& other) {
   tag_ = other.tag_;
   tag_value_map_ = other.tag_value_map_;
+  arena_ = other.arena_;
+  arena_index_ = other.arena_index_;
   // Don't copy serialized_. unique_ptr doesn't have an assignment operator.
   // However, invalidate serialized_.
   serialized_.reset();
@@ -53,6 +57,8 @@ CryptoHandshakeMessage& CryptoHandshakeMessage::operator=(
 void CryptoHandshakeMessage::Clear() {
   tag_ = 0;
   tag_value_map_.clear();
+  arena_.clear();
+  arena_index_.clear();
   minimum_size_ = 0;
   serialized_.reset();
 }
@@ -70,24 +76,68 @@ void CryptoHandshakeMessage::MarkDirty() {
   serialized_.reset();
 }
 
+const QuicTagValueMap& CryptoHandshakeMessage::tag_value_map() const {
+  MaterializeTagValueMap();
+  return tag_value_map_;
+}
+
+void CryptoHandshakeMessage::GetEntries(
+    std::vector<std::pair<QuicTag, QuicStringPiece>>* out) const {
+  out->clear();
+  if (!arena_index_.empty()) {
+    out->reserve(arena_index_.size());
+    uint32_t start = 0;
+    for (const std::pair<QuicTag, uint32_t>& entry : arena_index_) {
+      out->push_back(std::make_pair(
+          entry.first,
+          QuicStringPiece(arena_.data() + start, entry.second - start)));
+      start = entry.second;
+    }
+    return;
+  }
+  out->reserve(tag_value_map_.size());
+  for (QuicTagValueMap::const_iterator it = tag_value_map_.begin();
+       it != tag_value_map_.end(); ++it) {
+    out->push_back(std::make_pair(it->first, QuicStringPiece(it->second)));
+  }
+}
+
+void CryptoHandshakeMessage::SetParsedContents(
+    const std::vector<std::pair<QuicTag, size_t>>& tags_and_lengths,
+    QuicStringPiece values) {
+  tag_value_map_.clear();
+  arena_.assign(values.data(), values.length());
+  arena_index_.clear();
+  arena_index_.reserve(tags_and_lengths.size());
+  uint32_t end_offset = 0;
+  for (const std::pair<QuicTag, size_t>& item : tags_and_lengths) {
+    DCHECK(arena_index_.empty() || arena_index_.back().first < item.first);
+    end_offset += item.second;
+    arena_index_.push_back(std::make_pair(item.first, end_offset));
+  }
+  DCHECK_EQ(arena_.length(), end_offset);
+}
+
 void CryptoHandshakeMessage::SetStringPiece(QuicTag tag,
                                             QuicStringPiece value) {
+  MaterializeTagValueMap();
   tag_value_map_[tag] = value.as_string();
 }
 
 void CryptoHandshakeMessage::Erase(QuicTag tag) {
+  MaterializeTagValueMap();
   tag_value_map_.erase(tag);
 }
 
 QuicErrorCode CryptoHandshakeMessage::GetTaglist(
     QuicTag tag,
     QuicTagVector* out_tags) const {
-  QuicTagValueMap::const_iterator it = tag_value_map_.find(tag);
+  QuicStringPiece value;
   QuicErrorCode ret = QUIC_NO_ERROR;
 
-  if (it == tag_value_map_.end()) {
+  if (!FindValue(tag, &value)) {
     ret = QUIC_CRYPTO_MESSAGE_PARAMETER_NOT_FOUND;
-  } else if (it->second.size() % sizeof(QuicTag) != 0) {
+  } else if (value.size() % sizeof(QuicTag) != 0) {
     ret = QUIC_INVALID_CRYPTO_MESSAGE_PARAMETER;
   }
 
@@ -96,11 +146,11 @@ QuicErrorCode CryptoHandshakeMessage::GetTaglist(
     return ret;
   }
 
-  size_t num_tags = it->second.size() / sizeof(QuicTag);
+  size_t num_tags = value.size() / sizeof(QuicTag);
   out_tags->resize(num_tags);
   for (size_t i = 0; i < num_tags; ++i) {
     QuicTag tag;
-    memcpy(&tag, it->second.data() + i * sizeof(tag), sizeof(tag));
+    memcpy(&tag, value.data() + i * sizeof(tag), sizeof(tag));
     (*out_tags)[i] = tag;
   }
   return ret;
@@ -108,16 +158,12 @@ QuicErrorCode CryptoHandshakeMessage::GetTaglist(
 
 bool CryptoHandshakeMessage::GetStringPiece(QuicTag tag,
                                             QuicStringPiece* out) const {
-  QuicTagValueMap::const_iterator it = tag_value_map_.find(tag);
-  if (it == tag_value_map_.end()) {
-    return false;
-  }
-  *out = it->second;
-  return true;
+  return FindValue(tag, out);
 }
 
 bool CryptoHandshakeMessage::HasStringPiece(QuicTag tag) const {
-  return QuicContainsKey(tag_value_map_, tag);
+  QuicStringPiece unused;
+  return FindValue(tag, &unused);
 }
 
 QuicErrorCode CryptoHandshakeMessage::GetNthValue24(
@@ -170,6 +216,12 @@ QuicErrorCode CryptoHandshakeMessage::GetUint64(QuicTag tag,
 size_t CryptoHandshakeMessage::size() const {
   size_t ret = sizeof(QuicTag) + sizeof(uint16_t) /* number of entries */ +
                sizeof(uint16_t) /* padding */;
+  if (!arena_index_.empty()) {
+    ret += (sizeof(QuicTag) + sizeof(uint32_t) /* end offset */) *
+           arena_index_.size();
+    ret += arena_index_.back().second;
+    return ret;
+  }
   ret += (sizeof(QuicTag) + sizeof(uint32_t) /* end offset */) *
          tag_value_map_.size();
   for (QuicTagValueMap::const_iterator i = tag_value_map_.begin();
@@ -199,12 +251,12 @@ string CryptoHandshakeMessage::DebugString(Perspective perspective) const {
 QuicErrorCode CryptoHandshakeMessage::GetPOD(QuicTag tag,
                                              void* out,
                                              size_t len) const {
-  QuicTagValueMap::const_iterator it = tag_value_map_.find(tag);
+  QuicStringPiece value;
   QuicErrorCode ret = QUIC_NO_ERROR;
 
-  if (it == tag_value_map_.end()) {
+  if (!FindValue(tag, &value)) {
     ret = QUIC_CRYPTO_MESSAGE_PARAMETER_NOT_FOUND;
-  } else if (it->second.size() != len) {
+  } else if (value.size() != len) {
     ret = QUIC_INVALID_CRYPTO_MESSAGE_PARAMETER;
   }
 
@@ -213,17 +265,56 @@ QuicErrorCode CryptoHandshakeMessage::GetPOD(QuicTag tag,
     return ret;
   }
 
-  memcpy(out, it->second.data(), len);
+  memcpy(out, value.data(), len);
   return ret;
 }
 
+bool CryptoHandshakeMessage::FindValue(QuicTag tag,
+                                       QuicStringPiece* out) const {
+  if (!arena_index_.empty()) {
+    std::vector<std::pair<QuicTag, uint32_t>>::const_iterator it =
+        std::lower_bound(arena_index_.begin(), arena_index_.end(),
+                         std::make_pair(tag, uint32_t{0}));
+    if (it == arena_index_.end() || it->first != tag) {
+      return false;
+    }
+    const uint32_t start = it == arena_index_.begin() ? 0 : (it - 1)->second;
+    *out = QuicStringPiece(arena_.data() + start, it->second - start);
+    return true;
+  }
+  QuicTagValueMap::const_iterator it = tag_value_map_.find(tag);
+  if (it == tag_value_map_.end()) {
+    return false;
+  }
+  *out = it->second;
+  return true;
+}
+
+void CryptoHandshakeMessage::MaterializeTagValueMap() const {
+  if (arena_index_.empty()) {
+    return;
+  }
+  DCHECK(tag_value_map_.empty());
+  uint32_t start = 0;
+  for (const std::pair<QuicTag, uint32_t>& entry : arena_index_) {
+    tag_value_map_[entry.first] = arena_.substr(start, entry.second - start);
+    start = entry.second;
+  }
+  // |arena_| is not cleared: QuicStringPieces previously returned by
+  // GetStringPiece may still point into it.
+  arena_index_.clear();
+}
+
 string CryptoHandshakeMessage::DebugStringInternal(
     size_t indent,
     Perspective perspective) const {
   string ret = string(2 * indent, ' ') + QuicTagToString(tag_) + "<\n";
   ++indent;
-  for (QuicTagValueMap::const_iterator it = tag_value_map_.begin();
-       it != tag_value_map_.end(); ++it) {
+  std::vector<std::pair<QuicTag, QuicStringPiece>> entries;
+  GetEntries(&entries);
+  for (std::vector<std::pair<QuicTag, QuicStringPiece>>::const_iterator it =
+           entries.begin();
+       it != entries.end(); ++it) {
     ret += string(2 * indent, ' ') + QuicTagToString(it->first) + ": ";
 
     bool done = false;
@@ -320,7 +411,7 @@ string CryptoHandshakeMessage::DebugStringInternal(
         break;
       case kSNI:
       case kUAID:
-        ret += "\"" + it->second + "\"";
+        ret += "\"" + it->second.as_string() + "\"";
         done = true;
         break;
     }
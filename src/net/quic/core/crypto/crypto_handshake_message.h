@@ -9,6 +9,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "net/quic/core/quic_packets.h"
@@ -43,8 +44,8 @@ class QUIC_EXPORT_PRIVATE CryptoHandshakeMessage {
   // |v|.
   template <class T>
   void SetValue(QuicTag tag, const T& v) {
-    tag_value_map_[tag] =
-        std::string(reinterpret_cast<const char*>(&v), sizeof(v));
+    SetStringPiece(
+        tag, QuicStringPiece(reinterpret_cast<const char*>(&v), sizeof(v)));
   }
 
   // SetVector sets an element with the given tag to the raw contents of an
@@ -52,10 +53,11 @@ class QUIC_EXPORT_PRIVATE CryptoHandshakeMessage {
   template <class T>
   void SetVector(QuicTag tag, const std::vector<T>& v) {
     if (v.empty()) {
-      tag_value_map_[tag] = std::string();
+      SetStringPiece(tag, QuicStringPiece());
     } else {
-      tag_value_map_[tag] = std::string(reinterpret_cast<const char*>(&v[0]),
-                                        v.size() * sizeof(T));
+      SetStringPiece(tag,
+                     QuicStringPiece(reinterpret_cast<const char*>(&v[0]),
+                                     v.size() * sizeof(T)));
     }
   }
 
@@ -64,7 +66,25 @@ class QUIC_EXPORT_PRIVATE CryptoHandshakeMessage {
   // Sets the message tag.
   void set_tag(QuicTag tag) { tag_ = tag; }
 
-  const QuicTagValueMap& tag_value_map() const { return tag_value_map_; }
+  // Returns the message's tag/value pairs as a map. For a message populated
+  // by SetParsedContents this materializes a map from the contiguous value
+  // storage, so hot paths should prefer GetStringPiece or GetEntries.
+  const QuicTagValueMap& tag_value_map() const;
+
+  // GetEntries appends the message's tag/value pairs, in ascending tag order,
+  // to |out|. The returned QuicStringPieces point into storage owned by this
+  // message and are valid until it is mutated or destroyed.
+  void GetEntries(std::vector<std::pair<QuicTag, QuicStringPiece>>* out) const;
+
+  // SetParsedContents replaces all tag/value pairs with a single copy of the
+  // wire-format value region |values|, indexed by |tags_and_lengths|, which
+  // must be sorted by tag without duplicates (the wire format guarantees
+  // both). This avoids the per-value heap allocations that populating the map
+  // one tag at a time would perform, and is intended for the CryptoFramer's
+  // parse path.
+  void SetParsedContents(
+      const std::vector<std::pair<QuicTag, size_t>>& tags_and_lengths,
+      QuicStringPiece values);
 
   void SetStringPiece(QuicTag tag, QuicStringPiece value);
 
@@ -117,10 +137,28 @@ class QUIC_EXPORT_PRIVATE CryptoHandshakeMessage {
   // little-endian.
   QuicErrorCode GetPOD(QuicTag tag, void* out, size_t len) const;
 
+  // FindValue looks up |tag| in whichever representation currently holds the
+  // message's values and, if found, points |out| at message-owned storage.
+  bool FindValue(QuicTag tag, QuicStringPiece* out) const;
+
+  // MaterializeTagValueMap copies any arena-backed values into
+  // |tag_value_map_|, which becomes the authoritative representation. |arena_|
+  // is retained so that QuicStringPieces previously handed out remain valid.
+  void MaterializeTagValueMap() const;
+
   std::string DebugStringInternal(size_t indent, Perspective perspective) const;
 
   QuicTag tag_;
-  QuicTagValueMap tag_value_map_;
+  // Lazily materialized from |arena_index_| by callers that need map access;
+  // see MaterializeTagValueMap.
+  mutable QuicTagValueMap tag_value_map_;
+
+  // Storage for a message populated by SetParsedContents: one contiguous copy
+  // of the wire-format value region, plus a tag-sorted index of end offsets
+  // into it. When |arena_index_| is non-empty it is the authoritative
+  // representation and |tag_value_map_| is empty.
+  std::string arena_;
+  mutable std::vector<std::pair<QuicTag, uint32_t>> arena_index_;
 
   size_t minimum_size_;
 
@@ -4,6 +4,7 @@
 
 #include "net/quic/core/crypto/crypto_handshake_message.h"
 
+#include "net/quic/core/crypto/crypto_framer.h"
 #include "net/quic/core/crypto/crypto_handshake.h"
 #include "net/quic/core/crypto/crypto_protocol.h"
 #include "net/quic/platform/api/quic_endian.h"
@@ -126,6 +127,48 @@ TEST_P(CryptoHandshakeMessageTest, ServerDesignatedConnectionId) {
   EXPECT_EQ(str, message5.DebugString(GetParam()));
 }
 
+TEST_P(CryptoHandshakeMessageTest, ParsedMessageRoundTrip) {
+  CryptoHandshakeMessage message;
+  message.set_tag(kSHLO);
+  message.SetStringPiece(kSNI, "www.example.com");
+  message.SetValue(kICSL, static_cast<uint32_t>(42));
+
+  // A parsed message is backed by a single contiguous copy of the value
+  // region; make sure that representation is indistinguishable from the
+  // map-backed one through the accessors.
+  std::unique_ptr<CryptoHandshakeMessage> parsed(CryptoFramer::ParseMessage(
+      message.GetSerialized(GetParam()).AsStringPiece(), GetParam()));
+  ASSERT_TRUE(parsed != nullptr);
+  EXPECT_EQ(message.size(), parsed->size());
+
+  QuicStringPiece sni;
+  ASSERT_TRUE(parsed->GetStringPiece(kSNI, &sni));
+  EXPECT_EQ("www.example.com", sni);
+  EXPECT_FALSE(parsed->HasStringPiece(kCADR));
+  uint32_t icsl;
+  EXPECT_EQ(QUIC_NO_ERROR, parsed->GetUint32(kICSL, &icsl));
+  EXPECT_EQ(42u, icsl);
+
+  // Copies of a parsed message preserve its contents.
+  CryptoHandshakeMessage copy(*parsed);
+  QuicStringPiece copied_sni;
+  ASSERT_TRUE(copy.GetStringPiece(kSNI, &copied_sni));
+  EXPECT_EQ(sni, copied_sni);
+
+  // The legacy map accessor materializes identical contents, and values
+  // handed out beforehand remain valid.
+  EXPECT_EQ(message.tag_value_map(), parsed->tag_value_map());
+  EXPECT_EQ("www.example.com", sni);
+
+  // Mutation after parsing behaves as it always has.
+  parsed->Erase(kICSL);
+  EXPECT_EQ(QUIC_CRYPTO_MESSAGE_PARAMETER_NOT_FOUND,
+            parsed->GetUint32(kICSL, &icsl));
+  copy.SetStringPiece(kSNI, "other.example.com");
+  ASSERT_TRUE(copy.GetStringPiece(kSNI, &copied_sni));
+  EXPECT_EQ("other.example.com", copied_sni);
+}
+
 TEST_P(CryptoHandshakeMessageTest, HasStringPiece) {
   CryptoHandshakeMessage message;
   EXPECT_FALSE(message.HasStringPiece(kRCID));
@@ -86,6 +86,8 @@ const QuicTag kLRTT = TAG('L', 'R', 'T', 'T');   // Exit STARTUP in BBR on loss
 const QuicTag kBBRR = TAG('B', 'B', 'R', 'R');   // Rate-based recovery in BBR
 const QuicTag kBBR1 = TAG('B', 'B', 'R', '1');   // Ack aggregatation v1
 const QuicTag kBBR2 = TAG('B', 'B', 'R', '2');   // Ack aggregatation v2
+const QuicTag kBBR3 = TAG('B', 'B', 'R', '3');   // Adapt STARTUP gain to
+                                                 // measured ack aggregation
 const QuicTag kRENO = TAG('R', 'E', 'N', 'O');   // Reno Congestion Control
 const QuicTag kTPCC = TAG('P', 'C', 'C', '\0');  // Performance-Oriented
                                                  // Congestion Control
@@ -102,6 +104,7 @@ const QuicTag kUNDO = TAG('U', 'N', 'D', 'O');   // Undo any pending retransmits
                                                  // if they're likely spurious.
 const QuicTag kTIME = TAG('T', 'I', 'M', 'E');   // Time based loss detection
 const QuicTag kATIM = TAG('A', 'T', 'I', 'M');   // Adaptive time loss detection
+const QuicTag kANAK = TAG('A', 'N', 'A', 'K');   // Adaptive nack loss detection
 const QuicTag kMIN1 = TAG('M', 'I', 'N', '1');   // Min CWND of 1 packet
 const QuicTag kMIN4 = TAG('M', 'I', 'N', '4');   // Min CWND of 4 packets,
                                                  // with a min rate of 1 BDP.
@@ -116,6 +119,9 @@ const QuicTag kAKD4 = TAG('A', 'K', 'D', '4');   // Ack decimation with 1/8 RTT
                                                  // tolerating out of order.
 const QuicTag kAKDU = TAG('A', 'K', 'D', 'U');   // Unlimited number of packets
                                                  // receieved before acking
+const QuicTag kAKDR = TAG('A', 'K', 'D', 'R');   // Ack decimation with the
+                                                 // threshold scaled from the
+                                                 // receive rate.
 const QuicTag kSSLR = TAG('S', 'S', 'L', 'R');   // Slow Start Large Reduction.
 const QuicTag kNPRR = TAG('N', 'P', 'R', 'R');   // Pace at unity instead of PRR
 const QuicTag k5RTO = TAG('5', 'R', 'T', 'O');   // Close connection on 5 RTOs
@@ -137,6 +143,11 @@ const QuicTag kBLMX = TAG('B', 'L', 'M', 'X');   // Fix Cubic BetaLastMax bug.
 const QuicTag kCPAU = TAG('C', 'P', 'A', 'U');   // Allow Cubic per-ack-updates.
 const QuicTag kNSTP = TAG('N', 'S', 'T', 'P');   // No stop waiting frames.
 
+// Named retransmission profiles.  Selected per session to match the
+// workload's latency needs; see QuicSentPacketManager::SetFromConfig.
+const QuicTag kRPAG = TAG('R', 'P', 'A', 'G');   // Aggressive TLP/RTO profile.
+const QuicTag kRPLZ = TAG('R', 'P', 'L', 'Z');   // Lazy TLP/RTO profile.
+
 // Optional support of truncated Connection IDs.  If sent by a peer, the value
 // is the minimum number of bytes allowed for the connection ID sent to the
 // peer.
@@ -145,6 +156,16 @@ const QuicTag kTCID = TAG('T', 'C', 'I', 'D');   // Connection ID truncation.
 // Multipath option.
 const QuicTag kMPTH = TAG('M', 'P', 'T', 'H');   // Enable multipath.
 
+// XOR forward error correction option. When negotiated, the sender may emit
+// one parity packet per FEC group so a single lost packet in the group can be
+// revived without waiting a retransmission RTT.
+const QuicTag kXFEC = TAG('X', 'F', 'E', 'C');   // XOR FEC parity packets.
+
+// Multiplexed header compression contexts. When negotiated, each block on the
+// headers stream is preceded by a compression context id and block length,
+// and every context runs an independent HPACK dynamic table.
+const QuicTag kMHCC = TAG('M', 'H', 'C', 'C');   // Multiplexed HPACK contexts.
+
 const QuicTag kNCMR = TAG('N', 'C', 'M', 'R');   // Do not attempt connection
                                                  // migration.
 
@@ -157,6 +178,8 @@ const QuicTag kBWS2 = TAG('B', 'W', 'S', '2');  // Server bw resumption v2.
 // Enable path MTU discovery experiment.
 const QuicTag kMTUH = TAG('M', 'T', 'U', 'H');  // High-target MTU discovery.
 const QuicTag kMTUL = TAG('M', 'T', 'U', 'L');  // Low-target MTU discovery.
+const QuicTag kMTUB = TAG('M', 'T', 'U', 'B');  // Binary-search MTU discovery
+                                                // with blackhole fallback.
 
 // Tags for async signing experiments
 const QuicTag kASYN = TAG('A', 'S', 'Y', 'N');  // Perform asynchronous signing
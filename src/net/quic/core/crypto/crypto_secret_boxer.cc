@@ -5,9 +5,11 @@
 #include "net/quic/core/crypto/crypto_secret_boxer.h"
 
 #include <memory>
+#include <utility>
 
 #include "base/logging.h"
 #include "base/strings/string_util.h"
+#include "net/quic/core/crypto/crypto_box_offload.h"
 #include "net/quic/core/crypto/quic_decrypter.h"
 #include "net/quic/core/crypto/quic_encrypter.h"
 #include "net/quic/core/crypto/quic_random.h"
@@ -25,11 +27,14 @@ static const size_t kBoxNonceSize = 12;
 
 struct CryptoSecretBoxer::State {
   // ctxs are the initialised AEAD contexts. These objects contain the
-  // scheduled AES state for each of the keys.
+  // scheduled AES state for each of the keys. They are never mutated after
+  // construction, and BoringSSL permits concurrent seal/open calls on an
+  // AEAD context, so a State may be shared between threads freely.
   std::vector<bssl::UniquePtr<EVP_AEAD_CTX>> ctxs;
 };
 
-CryptoSecretBoxer::CryptoSecretBoxer() {}
+CryptoSecretBoxer::CryptoSecretBoxer()
+    : current_state_(nullptr), offload_(nullptr) {}
 
 CryptoSecretBoxer::~CryptoSecretBoxer() {}
 
@@ -59,8 +64,19 @@ void CryptoSecretBoxer::SetKeys(const std::vector<string>& keys) {
     new_state->ctxs.push_back(std::move(ctx));
   }
 
-  QuicWriterMutexLock l(&lock_);
-  state_ = std::move(new_state);
+  if (offload_ != nullptr && !offload_->SetKeys(keys)) {
+    LOG(WARNING) << "Crypto box offload device rejected keys; "
+                 << "batch operations will run in software";
+    offload_ = nullptr;
+  }
+
+  QuicWriterMutexLock l(&set_keys_lock_);
+  states_.push_back(std::move(new_state));
+  current_state_.store(states_.back().get(), std::memory_order_release);
+}
+
+void CryptoSecretBoxer::SetOffload(CryptoBoxOffload* offload) {
+  offload_ = offload;
 }
 
 string CryptoSecretBoxer::Box(QuicRandom* rand,
@@ -82,16 +98,14 @@ string CryptoSecretBoxer::Box(QuicRandom* rand,
   out += kBoxNonceSize;
   out_len -= kBoxNonceSize;
 
+  const State* const state = current_state_.load(std::memory_order_acquire);
   size_t bytes_written;
-  {
-    QuicReaderMutexLock l(&lock_);
-    if (!EVP_AEAD_CTX_seal(state_->ctxs[0].get(), out, &bytes_written, out_len,
-                           nonce, kBoxNonceSize,
-                           reinterpret_cast<const uint8_t*>(plaintext.data()),
-                           plaintext.size(), nullptr, 0)) {
-      LOG(DFATAL) << "EVP_AEAD_CTX_seal failed";
-      return "";
-    }
+  if (!EVP_AEAD_CTX_seal(state->ctxs[0].get(), out, &bytes_written, out_len,
+                         nonce, kBoxNonceSize,
+                         reinterpret_cast<const uint8_t*>(plaintext.data()),
+                         plaintext.size(), nullptr, 0)) {
+    LOG(DFATAL) << "EVP_AEAD_CTX_seal failed";
+    return "";
   }
 
   DCHECK_EQ(out_len, bytes_written);
@@ -114,8 +128,8 @@ bool CryptoSecretBoxer::Unbox(QuicStringPiece in_ciphertext,
   uint8_t* out_data = reinterpret_cast<uint8_t*>(
       base::WriteInto(out_storage, ciphertext_len + 1));
 
-  QuicReaderMutexLock l(&lock_);
-  for (const bssl::UniquePtr<EVP_AEAD_CTX>& ctx : state_->ctxs) {
+  const State* const state = current_state_.load(std::memory_order_acquire);
+  for (const bssl::UniquePtr<EVP_AEAD_CTX>& ctx : state->ctxs) {
     size_t bytes_written;
     if (EVP_AEAD_CTX_open(ctx.get(), out_data, &bytes_written, ciphertext_len,
                           nonce, kBoxNonceSize, ciphertext, ciphertext_len,
@@ -128,4 +142,99 @@ bool CryptoSecretBoxer::Unbox(QuicStringPiece in_ciphertext,
   return false;
 }
 
+void CryptoSecretBoxer::BoxBatch(QuicRandom* rand,
+                                 const std::vector<QuicStringPiece>& plaintexts,
+                                 std::vector<string>* out_boxes) const {
+  out_boxes->assign(plaintexts.size(), string());
+  if (offload_ == nullptr) {
+    for (size_t i = 0; i < plaintexts.size(); ++i) {
+      (*out_boxes)[i] = Box(rand, plaintexts[i]);
+    }
+    return;
+  }
+
+  std::vector<CryptoBoxOffload::Job> jobs(plaintexts.size());
+  for (size_t i = 0; i < plaintexts.size(); ++i) {
+    jobs[i].type = CryptoBoxOffload::SEAL;
+    jobs[i].cookie = i;
+    jobs[i].input = plaintexts[i];
+    jobs[i].output = &(*out_boxes)[i];
+    jobs[i].ok = false;
+  }
+
+  const size_t accepted = offload_->Submit(jobs.data(), jobs.size());
+  // The device sheds load by declining a suffix of the batch; run it here.
+  for (size_t i = accepted; i < plaintexts.size(); ++i) {
+    (*out_boxes)[i] = Box(rand, plaintexts[i]);
+  }
+
+  size_t outstanding = accepted;
+  while (outstanding > 0) {
+    CryptoBoxOffload::Job* completed[16];
+    const size_t num_completed = offload_->Poll(completed, arraysize(completed));
+    outstanding -= num_completed;
+    for (size_t i = 0; i < num_completed; ++i) {
+      if (!completed[i]->ok) {
+        const size_t index = completed[i]->cookie;
+        (*out_boxes)[index] = Box(rand, plaintexts[index]);
+      }
+    }
+  }
+}
+
+void CryptoSecretBoxer::UnboxBatch(
+    const std::vector<QuicStringPiece>& ciphertexts,
+    std::vector<string>* out_plaintexts,
+    std::vector<bool>* results) const {
+  out_plaintexts->assign(ciphertexts.size(), string());
+  results->assign(ciphertexts.size(), false);
+
+  auto software_unbox = [&](size_t i) {
+    string storage;
+    QuicStringPiece out;
+    if (Unbox(ciphertexts[i], &storage, &out)) {
+      (*out_plaintexts)[i].assign(out.data(), out.size());
+      (*results)[i] = true;
+    }
+  };
+
+  if (offload_ == nullptr) {
+    for (size_t i = 0; i < ciphertexts.size(); ++i) {
+      software_unbox(i);
+    }
+    return;
+  }
+
+  std::vector<CryptoBoxOffload::Job> jobs(ciphertexts.size());
+  for (size_t i = 0; i < ciphertexts.size(); ++i) {
+    jobs[i].type = CryptoBoxOffload::OPEN;
+    jobs[i].cookie = i;
+    jobs[i].input = ciphertexts[i];
+    jobs[i].output = &(*out_plaintexts)[i];
+    jobs[i].ok = false;
+  }
+
+  const size_t accepted = offload_->Submit(jobs.data(), jobs.size());
+  for (size_t i = accepted; i < ciphertexts.size(); ++i) {
+    software_unbox(i);
+  }
+
+  size_t outstanding = accepted;
+  while (outstanding > 0) {
+    CryptoBoxOffload::Job* completed[16];
+    const size_t num_completed = offload_->Poll(completed, arraysize(completed));
+    outstanding -= num_completed;
+    for (size_t i = 0; i < num_completed; ++i) {
+      const size_t index = completed[i]->cookie;
+      if (completed[i]->ok) {
+        (*results)[index] = true;
+      } else {
+        // Give software a chance before declaring the box bad, in case the
+        // device and host disagree about key state.
+        software_unbox(index);
+      }
+    }
+  }
+}
+
 }  // namespace net
@@ -5,6 +5,7 @@
 #ifndef NET_QUIC_CORE_CRYPTO_CRYPTO_SECRET_BOXER_H_
 #define NET_QUIC_CORE_CRYPTO_CRYPTO_SECRET_BOXER_H_
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <string>
@@ -17,11 +18,14 @@
 
 namespace net {
 
+class CryptoBoxOffload;
 class QuicRandom;
 
 // CryptoSecretBoxer encrypts small chunks of plaintext (called 'boxing') and
 // then, later, can authenticate+decrypt the resulting boxes. This object is
-// thread-safe.
+// thread-safe: |Box| and |Unbox| are lock-free, so token operations running
+// concurrently on several threads never contend. |SetKeys| publishes a fresh
+// immutable key state RCU-style rather than mutating the state readers see.
 class QUIC_EXPORT_PRIVATE CryptoSecretBoxer {
  public:
   CryptoSecretBoxer();
@@ -51,14 +55,45 @@ class QUIC_EXPORT_PRIVATE CryptoSecretBoxer {
              std::string* out_storage,
              QuicStringPiece* out) const;
 
+  // Directs batch operations at |offload|, which is not owned and must
+  // outlive this object. Must be called before |SetKeys| so the device
+  // receives the keys; if the device rejects them, offloading is disabled
+  // and the batch operations run in software.
+  void SetOffload(CryptoBoxOffload* offload);
+
+  // Boxes each element of |plaintexts| into the corresponding element of
+  // |out_boxes|, submitting the batch to the offload device when one is
+  // configured. Jobs the device declines or fails are run in software, so
+  // the results are identical to per-element |Box| calls.
+  void BoxBatch(QuicRandom* rand,
+                const std::vector<QuicStringPiece>& plaintexts,
+                std::vector<std::string>* out_boxes) const;
+
+  // Unboxes each element of |ciphertexts| into the corresponding element of
+  // |out_plaintexts|, setting (*results)[i] to whether box i authenticated.
+  // Offload behavior matches |BoxBatch|; a box the device rejects is retried
+  // in software before being declared bad.
+  void UnboxBatch(const std::vector<QuicStringPiece>& ciphertexts,
+                  std::vector<std::string>* out_plaintexts,
+                  std::vector<bool>* results) const;
+
  private:
   struct State;
 
-  mutable QuicMutex lock_;
+  // Serializes writers; readers never take it.
+  mutable QuicMutex set_keys_lock_;
+
+  // current_state_ points at the immutable key state used by |Box| and
+  // |Unbox|, which load it with acquire semantics and take no lock. |SetKeys|
+  // appends a fresh State to |states_| and swings current_state_ to it;
+  // superseded states are retained until destruction so in-flight readers
+  // remain valid. Key rotations are rare, so the retained memory is trivial.
+  std::atomic<State*> current_state_;
+  std::vector<std::unique_ptr<State>> states_ GUARDED_BY(set_keys_lock_);
 
-  // state_ is an opaque pointer to whatever additional state the concrete
-  // implementation of CryptoSecretBoxer requires.
-  std::unique_ptr<State> state_ GUARDED_BY(lock_);
+  // Device used by the batch operations, or nullptr to run in software.
+  // Cleared by |SetKeys| if the device cannot take the keys. Not owned.
+  CryptoBoxOffload* offload_;
 
   DISALLOW_COPY_AND_ASSIGN(CryptoSecretBoxer);
 };
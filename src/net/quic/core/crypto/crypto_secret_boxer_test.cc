@@ -4,6 +4,9 @@
 
 #include "net/quic/core/crypto/crypto_secret_boxer.h"
 
+#include <deque>
+
+#include "net/quic/core/crypto/crypto_box_offload.h"
 #include "net/quic/core/crypto/quic_random.h"
 #include "net/quic/platform/api/quic_test.h"
 
@@ -14,6 +17,53 @@ namespace test {
 
 class CryptoSecretBoxerTest : public QuicTest {};
 
+// An offload device that runs jobs with an inner software boxer. Accepts at
+// most |capacity| jobs per Submit so tests can exercise the caller's
+// software fallback for the declined suffix.
+class FakeBoxOffload : public CryptoBoxOffload {
+ public:
+  explicit FakeBoxOffload(size_t capacity) : capacity_(capacity) {}
+
+  bool SetKeys(const std::vector<string>& keys) override {
+    boxer_.SetKeys(keys);
+    return true;
+  }
+
+  size_t Submit(Job* jobs, size_t num_jobs) override {
+    const size_t accepted = std::min(num_jobs, capacity_);
+    for (size_t i = 0; i < accepted; ++i) {
+      pending_.push_back(&jobs[i]);
+    }
+    return accepted;
+  }
+
+  size_t Poll(Job** completed, size_t max_jobs) override {
+    size_t num_completed = 0;
+    while (num_completed < max_jobs && !pending_.empty()) {
+      Job* job = pending_.front();
+      pending_.pop_front();
+      if (job->type == SEAL) {
+        *job->output = boxer_.Box(QuicRandom::GetInstance(), job->input);
+        job->ok = !job->output->empty();
+      } else {
+        string storage;
+        QuicStringPiece out;
+        job->ok = boxer_.Unbox(job->input, &storage, &out);
+        if (job->ok) {
+          job->output->assign(out.data(), out.size());
+        }
+      }
+      completed[num_completed++] = job;
+    }
+    return num_completed;
+  }
+
+ private:
+  const size_t capacity_;
+  CryptoSecretBoxer boxer_;
+  std::deque<Job*> pending_;
+};
+
 TEST_F(CryptoSecretBoxerTest, BoxAndUnbox) {
   QuicStringPiece message("hello world");
 
@@ -76,5 +126,53 @@ TEST_F(CryptoSecretBoxerTest, MultipleKeys) {
   EXPECT_FALSE(CanDecode(boxer, boxer_11));
 }
 
+TEST_F(CryptoSecretBoxerTest, BatchWithoutOffload) {
+  CryptoSecretBoxer boxer;
+  boxer.SetKeys({string(CryptoSecretBoxer::GetKeySize(), 0x11)});
+
+  std::vector<QuicStringPiece> plaintexts = {"one", "two", "three"};
+  std::vector<string> boxes;
+  boxer.BoxBatch(QuicRandom::GetInstance(), plaintexts, &boxes);
+  ASSERT_EQ(3u, boxes.size());
+
+  std::vector<QuicStringPiece> ciphertexts(boxes.begin(), boxes.end());
+  std::vector<string> recovered;
+  std::vector<bool> results;
+  boxer.UnboxBatch(ciphertexts, &recovered, &results);
+  for (size_t i = 0; i < plaintexts.size(); ++i) {
+    EXPECT_TRUE(results[i]);
+    EXPECT_EQ(plaintexts[i], recovered[i]);
+  }
+}
+
+TEST_F(CryptoSecretBoxerTest, BatchWithOffload) {
+  // Capacity two forces the third job of each batch through the software
+  // fallback path; both paths must produce interchangeable boxes.
+  FakeBoxOffload offload(2);
+  CryptoSecretBoxer boxer;
+  boxer.SetOffload(&offload);
+  boxer.SetKeys({string(CryptoSecretBoxer::GetKeySize(), 0x11)});
+
+  std::vector<QuicStringPiece> plaintexts = {"one", "two", "three"};
+  std::vector<string> boxes;
+  boxer.BoxBatch(QuicRandom::GetInstance(), plaintexts, &boxes);
+  ASSERT_EQ(3u, boxes.size());
+
+  std::vector<QuicStringPiece> ciphertexts(boxes.begin(), boxes.end());
+  std::vector<string> recovered;
+  std::vector<bool> results;
+  boxer.UnboxBatch(ciphertexts, &recovered, &results);
+  for (size_t i = 0; i < plaintexts.size(); ++i) {
+    EXPECT_TRUE(results[i]);
+    EXPECT_EQ(plaintexts[i], recovered[i]);
+  }
+
+  // A corrupt box fails through the offload and the software retry alike.
+  string corrupt = boxes[0];
+  corrupt[0] ^= 0x80;
+  boxer.UnboxBatch({QuicStringPiece(corrupt)}, &recovered, &results);
+  EXPECT_FALSE(results[0]);
+}
+
 }  // namespace test
 }  // namespace net
@@ -6,6 +6,7 @@
 
 #include <memory>
 
+#include "base/time/time.h"
 #include "crypto/hkdf.h"
 #include "net/quic/core/crypto/crypto_handshake.h"
 #include "net/quic/core/crypto/crypto_protocol.h"
@@ -21,6 +22,57 @@
 using std::string;
 
 namespace net {
+namespace {
+
+// Payload size for the AEAD microprobe; matches a typical full packet.
+const size_t kAeadProbePayloadSize = 1350;
+// Iterations per AEAD. At a few GB/s this keeps the one-time probe well
+// under a millisecond per cipher.
+const int kAeadProbeIterations = 64;
+
+// Returns the wall time |algorithm| takes to seal |kAeadProbeIterations|
+// packet-sized payloads, or TimeDelta::Max() if the cipher cannot be set up.
+base::TimeDelta TimeAead(QuicTag algorithm) {
+  std::unique_ptr<QuicEncrypter> encrypter(QuicEncrypter::Create(algorithm));
+  const string key(encrypter->GetKeySize(), 'k');
+  const string nonce_prefix(encrypter->GetNoncePrefixSize(), 'n');
+  if (!encrypter->SetKey(key) || !encrypter->SetNoncePrefix(nonce_prefix)) {
+    QUIC_BUG << "Unable to key AEAD probe for " << QuicTagToString(algorithm);
+    return base::TimeDelta::Max();
+  }
+  const string plaintext(kAeadProbePayloadSize, 'p');
+  char ciphertext[kAeadProbePayloadSize + 128];
+  size_t ciphertext_length = 0;
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kAeadProbeIterations; ++i) {
+    if (!encrypter->EncryptPacket(AllSupportedVersions().front(), i, "probe",
+                                  plaintext, ciphertext, &ciphertext_length,
+                                  sizeof(ciphertext))) {
+      QUIC_BUG << "AEAD probe encryption failed for "
+               << QuicTagToString(algorithm);
+      return base::TimeDelta::Max();
+    }
+  }
+  return base::TimeTicks::Now() - start;
+}
+
+bool MeasureAesGcmFaster() {
+  const base::TimeDelta aes_time = TimeAead(kAESG);
+  const base::TimeDelta chacha_time = TimeAead(kCC20);
+  QUIC_DLOG(INFO) << "AEAD probe: AES-GCM " << aes_time.InMicroseconds()
+                  << "us, ChaCha20-Poly1305 " << chacha_time.InMicroseconds()
+                  << "us over " << kAeadProbeIterations << " x "
+                  << kAeadProbePayloadSize << " bytes.";
+  return aes_time < chacha_time;
+}
+
+}  // namespace
+
+// static
+bool CryptoUtils::IsAesGcmFaster() {
+  static const bool aes_gcm_faster = MeasureAesGcmFaster();
+  return aes_gcm_faster;
+}
 
 // static
 void CryptoUtils::GenerateNonce(QuicWallTime now,
@@ -68,6 +68,13 @@ class QUIC_EXPORT_PRIVATE CryptoUtils {
     DiversificationNonce* nonce_;
   };
 
+  // Returns true if AES-GCM outperforms ChaCha20-Poly1305 on this machine.
+  // The first call times both AEADs over packet-sized payloads and caches the
+  // verdict for the process lifetime, so endpoints on hardware without AES
+  // acceleration end up preferring ChaCha20 and accelerated hardware prefers
+  // AES-GCM, without a per-platform build-time choice.
+  static bool IsAesGcmFaster();
+
   // Generates the connection nonce. The nonce is formed as:
   //   <4 bytes> current time
   //   <8 bytes> |orbit| (or random if |orbit| is empty)
@@ -0,0 +1,137 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/crypto/offloading_proof_source.h"
+
+#include <utility>
+
+namespace net {
+
+namespace {
+
+// ProofCompletion carries a finished proof back to the event loop thread and
+// invokes the caller's callback there.
+class ProofCompletion : public QuicCryptoWorkerInterface::Completion {
+ public:
+  ProofCompletion(std::unique_ptr<ProofSource::Callback> callback,
+                  bool ok,
+                  QuicReferenceCountedPointer<ProofSource::Chain> chain,
+                  const QuicCryptoProof& proof,
+                  std::unique_ptr<ProofSource::Details> details)
+      : callback_(std::move(callback)),
+        ok_(ok),
+        chain_(std::move(chain)),
+        proof_(proof),
+        details_(std::move(details)) {}
+
+  void Run() override {
+    callback_->Run(ok_, chain_, proof_, std::move(details_));
+  }
+
+ private:
+  std::unique_ptr<ProofSource::Callback> callback_;
+  const bool ok_;
+  QuicReferenceCountedPointer<ProofSource::Chain> chain_;
+  const QuicCryptoProof proof_;
+  std::unique_ptr<ProofSource::Details> details_;
+};
+
+// PostingCallback receives the wrapped source's result, possibly on a worker
+// thread, and posts it to the event loop as a ProofCompletion.
+class PostingCallback : public ProofSource::Callback {
+ public:
+  PostingCallback(QuicCryptoWorkerInterface* crypto_worker,
+                  std::unique_ptr<ProofSource::Callback> callback)
+      : crypto_worker_(crypto_worker), callback_(std::move(callback)) {}
+
+  void Run(bool ok,
+           const QuicReferenceCountedPointer<ProofSource::Chain>& chain,
+           const QuicCryptoProof& proof,
+           std::unique_ptr<ProofSource::Details> details) override {
+    crypto_worker_->PostCompletion(
+        std::unique_ptr<QuicCryptoWorkerInterface::Completion>(
+            new ProofCompletion(std::move(callback_), ok, chain, proof,
+                                std::move(details))));
+  }
+
+ private:
+  QuicCryptoWorkerInterface* crypto_worker_;
+  std::unique_ptr<ProofSource::Callback> callback_;
+};
+
+}  // namespace
+
+// SignWork runs the wrapped source's GetProof on a worker thread.  All
+// string arguments are copied since the caller's buffers do not outlive the
+// original GetProof call.
+class OffloadingProofSource::SignWork
+    : public QuicCryptoWorkerInterface::Work {
+ public:
+  SignWork(ProofSource* impl,
+           QuicCryptoWorkerInterface* crypto_worker,
+           const QuicSocketAddress& server_address,
+           const std::string& hostname,
+           const std::string& server_config,
+           QuicVersion quic_version,
+           QuicStringPiece chlo_hash,
+           const QuicTagVector& connection_options,
+           std::unique_ptr<ProofSource::Callback> callback)
+      : impl_(impl),
+        crypto_worker_(crypto_worker),
+        server_address_(server_address),
+        hostname_(hostname),
+        server_config_(server_config),
+        quic_version_(quic_version),
+        chlo_hash_(chlo_hash.as_string()),
+        connection_options_(connection_options),
+        callback_(std::move(callback)) {}
+
+  void Run() override {
+    impl_->GetProof(server_address_, hostname_, server_config_, quic_version_,
+                    chlo_hash_, connection_options_,
+                    std::unique_ptr<ProofSource::Callback>(new PostingCallback(
+                        crypto_worker_, std::move(callback_))));
+  }
+
+ private:
+  ProofSource* impl_;
+  QuicCryptoWorkerInterface* crypto_worker_;
+  const QuicSocketAddress server_address_;
+  const std::string hostname_;
+  const std::string server_config_;
+  const QuicVersion quic_version_;
+  const std::string chlo_hash_;
+  const QuicTagVector connection_options_;
+  std::unique_ptr<ProofSource::Callback> callback_;
+};
+
+OffloadingProofSource::OffloadingProofSource(std::unique_ptr<ProofSource> impl)
+    : impl_(std::move(impl)), crypto_worker_(nullptr) {}
+
+OffloadingProofSource::~OffloadingProofSource() {}
+
+void OffloadingProofSource::GetProof(const QuicSocketAddress& server_address,
+                                     const std::string& hostname,
+                                     const std::string& server_config,
+                                     QuicVersion quic_version,
+                                     QuicStringPiece chlo_hash,
+                                     const QuicTagVector& connection_options,
+                                     std::unique_ptr<Callback> callback) {
+  if (crypto_worker_ == nullptr) {
+    impl_->GetProof(server_address, hostname, server_config, quic_version,
+                    chlo_hash, connection_options, std::move(callback));
+    return;
+  }
+
+  std::unique_ptr<QuicCryptoWorkerInterface::Work> work(new SignWork(
+      impl_.get(), crypto_worker_, server_address, hostname, server_config,
+      quic_version, chlo_hash, connection_options, std::move(callback)));
+  if (!crypto_worker_->TryScheduleWork(&work)) {
+    // Worker backlog is full: sign on the current thread.  The result still
+    // flows through the completion queue, so delivery semantics are the same.
+    work->Run();
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,58 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_CRYPTO_OFFLOADING_PROOF_SOURCE_H_
+#define NET_QUIC_CORE_CRYPTO_OFFLOADING_PROOF_SOURCE_H_
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "net/quic/core/crypto/proof_source.h"
+#include "net/quic/core/quic_crypto_worker_interface.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// OffloadingProofSource wraps another ProofSource and runs its GetProof calls
+// (and therefore the RSA/ECDSA proof signature) on a crypto worker thread,
+// delivering the result back on the event loop thread.  This keeps signature
+// computation off the packet-processing thread without any changes to the
+// callers, which already treat GetProof as asynchronous.  An offload engine
+// (e.g. hardware signing) can equally be plugged in as the wrapped source.
+class QUIC_EXPORT_PRIVATE OffloadingProofSource : public ProofSource {
+ public:
+  // |impl| computes the actual proofs and must support concurrent GetProof
+  // calls, per the ProofSource contract.  Until a worker is installed with
+  // set_crypto_worker, calls are passed straight through to |impl|.
+  explicit OffloadingProofSource(std::unique_ptr<ProofSource> impl);
+  ~OffloadingProofSource() override;
+
+  // Sets the worker on which proofs are computed, or nullptr to pass calls
+  // through.  |crypto_worker| is unowned and must outlive this object.
+  void set_crypto_worker(QuicCryptoWorkerInterface* crypto_worker) {
+    crypto_worker_ = crypto_worker;
+  }
+
+  // ProofSource interface.
+  void GetProof(const QuicSocketAddress& server_address,
+                const std::string& hostname,
+                const std::string& server_config,
+                QuicVersion quic_version,
+                QuicStringPiece chlo_hash,
+                const QuicTagVector& connection_options,
+                std::unique_ptr<Callback> callback) override;
+
+ private:
+  class SignWork;
+
+  std::unique_ptr<ProofSource> impl_;
+  QuicCryptoWorkerInterface* crypto_worker_;  // Unowned, may be nullptr.
+
+  DISALLOW_COPY_AND_ASSIGN(OffloadingProofSource);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_CRYPTO_OFFLOADING_PROOF_SOURCE_H_
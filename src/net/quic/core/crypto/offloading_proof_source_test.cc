@@ -0,0 +1,165 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/crypto/offloading_proof_source.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "net/quic/platform/api/quic_test.h"
+
+using std::string;
+
+namespace net {
+namespace test {
+namespace {
+
+// A proof source which answers synchronously with a signature derived from
+// its arguments, so tests can check they survive the thread hop.
+class SyncProofSource : public ProofSource {
+ public:
+  void GetProof(const QuicSocketAddress& server_address,
+                const string& hostname,
+                const string& server_config,
+                QuicVersion quic_version,
+                QuicStringPiece chlo_hash,
+                const QuicTagVector& connection_options,
+                std::unique_ptr<Callback> callback) override {
+    QuicReferenceCountedPointer<Chain> chain(
+        new Chain(std::vector<string>{"cert"}));
+    QuicCryptoProof proof;
+    proof.signature = "sig." + hostname + "." + chlo_hash.as_string();
+    callback->Run(true, chain, proof, nullptr);
+  }
+};
+
+// A worker that holds scheduled work and posted completions until the test
+// runs them, mimicking the thread hops of the real pool.
+class FakeCryptoWorker : public QuicCryptoWorkerInterface {
+ public:
+  bool TryScheduleWork(std::unique_ptr<Work>* work) override {
+    if (reject_work_) {
+      return false;
+    }
+    work_.push_back(std::move(*work));
+    return true;
+  }
+
+  void PostCompletion(std::unique_ptr<Completion> completion) override {
+    completions_.push_back(std::move(completion));
+  }
+
+  size_t num_work() const { return work_.size(); }
+  size_t num_completions() const { return completions_.size(); }
+  void set_reject_work(bool reject_work) { reject_work_ = reject_work; }
+
+  void RunWork() {
+    for (const auto& work : work_) {
+      work->Run();
+    }
+    work_.clear();
+  }
+
+  void RunCompletions() {
+    for (const auto& completion : completions_) {
+      completion->Run();
+    }
+    completions_.clear();
+  }
+
+ private:
+  bool reject_work_ = false;
+  std::vector<std::unique_ptr<Work>> work_;
+  std::vector<std::unique_ptr<Completion>> completions_;
+};
+
+// Records the result of a GetProof call.
+class RecordingCallback : public ProofSource::Callback {
+ public:
+  RecordingCallback(bool* called, string* signature)
+      : called_(called), signature_(signature) {}
+
+  void Run(bool ok,
+           const QuicReferenceCountedPointer<ProofSource::Chain>& chain,
+           const QuicCryptoProof& proof,
+           std::unique_ptr<ProofSource::Details> details) override {
+    *called_ = true;
+    EXPECT_TRUE(ok);
+    ASSERT_TRUE(chain != nullptr);
+    EXPECT_EQ(1u, chain->certs.size());
+    *signature_ = proof.signature;
+  }
+
+ private:
+  bool* called_;
+  string* signature_;
+};
+
+class OffloadingProofSourceTest : public QuicTest {
+ protected:
+  void GetProof(OffloadingProofSource* source,
+                bool* called,
+                string* signature) {
+    source->GetProof(QuicSocketAddress(), "host", "config", QUIC_VERSION_35,
+                     "chlo-hash", QuicTagVector(),
+                     std::unique_ptr<ProofSource::Callback>(
+                         new RecordingCallback(called, signature)));
+  }
+};
+
+TEST_F(OffloadingProofSourceTest, PassesThroughWithoutWorker) {
+  OffloadingProofSource source(
+      std::unique_ptr<ProofSource>(new SyncProofSource));
+  bool called = false;
+  string signature;
+  GetProof(&source, &called, &signature);
+  EXPECT_TRUE(called);
+  EXPECT_EQ("sig.host.chlo-hash", signature);
+}
+
+TEST_F(OffloadingProofSourceTest, OffloadsToWorker) {
+  FakeCryptoWorker worker;
+  OffloadingProofSource source(
+      std::unique_ptr<ProofSource>(new SyncProofSource));
+  source.set_crypto_worker(&worker);
+
+  bool called = false;
+  string signature;
+  GetProof(&source, &called, &signature);
+
+  // The proof is computed on the worker and delivered as a completion.
+  EXPECT_FALSE(called);
+  ASSERT_EQ(1u, worker.num_work());
+  worker.RunWork();
+  EXPECT_FALSE(called);
+  ASSERT_EQ(1u, worker.num_completions());
+  worker.RunCompletions();
+  EXPECT_TRUE(called);
+  EXPECT_EQ("sig.host.chlo-hash", signature);
+}
+
+TEST_F(OffloadingProofSourceTest, FallsBackWhenBacklogFull) {
+  FakeCryptoWorker worker;
+  worker.set_reject_work(true);
+  OffloadingProofSource source(
+      std::unique_ptr<ProofSource>(new SyncProofSource));
+  source.set_crypto_worker(&worker);
+
+  bool called = false;
+  string signature;
+  GetProof(&source, &called, &signature);
+
+  // The signature was computed inline, but the result is still delivered
+  // through the completion queue.
+  EXPECT_EQ(0u, worker.num_work());
+  ASSERT_EQ(1u, worker.num_completions());
+  worker.RunCompletions();
+  EXPECT_TRUE(called);
+  EXPECT_EQ("sig.host.chlo-hash", signature);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
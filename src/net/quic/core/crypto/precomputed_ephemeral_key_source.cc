@@ -0,0 +1,118 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/crypto/precomputed_ephemeral_key_source.h"
+
+#include <memory>
+#include <utility>
+
+#include "net/quic/core/crypto/crypto_protocol.h"
+#include "net/quic/core/crypto/curve25519_key_exchange.h"
+#include "net/quic/core/crypto/key_exchange.h"
+#include "net/quic/core/crypto/quic_random.h"
+
+using std::string;
+
+namespace net {
+
+// RefillWork runs on a crypto worker thread and replenishes the ring.  The
+// source outlives any scheduled work because the worker pool is shut down
+// (joining its threads) before the server's crypto config is destroyed.
+class PrecomputedEphemeralKeySource::RefillWork
+    : public QuicCryptoWorkerInterface::Work {
+ public:
+  explicit RefillWork(PrecomputedEphemeralKeySource* source)
+      : source_(source) {}
+
+  void Run() override {
+    source_->RefillRing();
+    source_->refill_pending_.store(false, std::memory_order_release);
+  }
+
+ private:
+  PrecomputedEphemeralKeySource* source_;
+};
+
+PrecomputedEphemeralKeySource::PrecomputedEphemeralKeySource(
+    QuicCryptoWorkerInterface* crypto_worker)
+    : crypto_worker_(crypto_worker), refill_pending_(false) {
+  for (size_t i = 0; i < kRingSize; ++i) {
+    ring_[i].store(nullptr, std::memory_order_relaxed);
+  }
+  RefillRing();
+}
+
+PrecomputedEphemeralKeySource::~PrecomputedEphemeralKeySource() {
+  for (size_t i = 0; i < kRingSize; ++i) {
+    delete ring_[i].load(std::memory_order_relaxed);
+  }
+}
+
+string PrecomputedEphemeralKeySource::CalculateForwardSecureKey(
+    const KeyExchange* key_exchange,
+    QuicRandom* rand,
+    QuicTime now,
+    QuicStringPiece peer_public_value,
+    string* public_value) {
+  std::unique_ptr<KeyExchange> forward_secure_key_exchange;
+  if (key_exchange->tag() == kC255) {
+    forward_secure_key_exchange.reset(TryTake());
+  }
+  if (forward_secure_key_exchange != nullptr) {
+    ScheduleRefill();
+  } else {
+    // Ring empty, or an algorithm we don't precompute for.
+    forward_secure_key_exchange.reset(key_exchange->NewKeyPair(rand));
+  }
+  *public_value = forward_secure_key_exchange->public_value().as_string();
+  string forward_secure_premaster_secret;
+  if (!forward_secure_key_exchange->CalculateSharedKey(
+          peer_public_value, &forward_secure_premaster_secret)) {
+    // The interface has no failure channel; an empty premaster secret yields
+    // keys the peer cannot derive, so the handshake fails as it should.
+    return string();
+  }
+  return forward_secure_premaster_secret;
+}
+
+Curve25519KeyExchange* PrecomputedEphemeralKeySource::TryTake() {
+  for (size_t i = 0; i < kRingSize; ++i) {
+    Curve25519KeyExchange* key_pair = ring_[i].load(std::memory_order_relaxed);
+    if (key_pair != nullptr &&
+        ring_[i].compare_exchange_strong(key_pair, nullptr,
+                                         std::memory_order_acquire)) {
+      return key_pair;
+    }
+  }
+  return nullptr;
+}
+
+void PrecomputedEphemeralKeySource::RefillRing() {
+  QuicRandom* const rand = QuicRandom::GetInstance();
+  for (size_t i = 0; i < kRingSize; ++i) {
+    if (ring_[i].load(std::memory_order_relaxed) != nullptr) {
+      continue;
+    }
+    Curve25519KeyExchange* key_pair =
+        Curve25519KeyExchange::New(Curve25519KeyExchange::NewPrivateKey(rand));
+    ring_[i].store(key_pair, std::memory_order_release);
+  }
+}
+
+void PrecomputedEphemeralKeySource::ScheduleRefill() {
+  if (crypto_worker_ == nullptr) {
+    return;
+  }
+  bool expected = false;
+  if (!refill_pending_.compare_exchange_strong(expected, true)) {
+    return;
+  }
+  std::unique_ptr<QuicCryptoWorkerInterface::Work> work(new RefillWork(this));
+  if (!crypto_worker_->TryScheduleWork(&work)) {
+    // Worker backlog is full; the next successful take will try again.
+    refill_pending_.store(false);
+  }
+}
+
+}  // namespace net
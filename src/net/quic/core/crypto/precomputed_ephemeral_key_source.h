@@ -0,0 +1,77 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_CRYPTO_PRECOMPUTED_EPHEMERAL_KEY_SOURCE_H_
+#define NET_QUIC_CORE_CRYPTO_PRECOMPUTED_EPHEMERAL_KEY_SOURCE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+#include "base/macros.h"
+#include "net/quic/core/crypto/ephemeral_key_source.h"
+#include "net/quic/core/quic_crypto_worker_interface.h"
+#include "net/quic/core/quic_time.h"
+#include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+
+namespace net {
+
+class Curve25519KeyExchange;
+class KeyExchange;
+class QuicRandom;
+
+// PrecomputedEphemeralKeySource removes ephemeral key generation from
+// handshake latency by keeping a ring of Curve25519 key pairs computed ahead
+// of time.  Each handshake pops one pair and only performs the shared-key
+// computation inline; the ring is refilled on a crypto worker thread.  The
+// ring is an array of atomic slots popped by compare-and-swap, so handshakes
+// running concurrently (e.g. on crypto worker threads) never contend on a
+// lock.  If the ring runs dry, or the handshake negotiated an algorithm
+// other than Curve25519, the source falls back to generating a fresh key
+// pair inline, which is the unoffloaded behavior.
+class QUIC_EXPORT_PRIVATE PrecomputedEphemeralKeySource
+    : public EphemeralKeySource {
+ public:
+  // |crypto_worker| is unowned and must outlive this object.  It may be
+  // nullptr, in which case the ring is filled once at construction and
+  // handshakes generate keys inline after it drains.
+  explicit PrecomputedEphemeralKeySource(
+      QuicCryptoWorkerInterface* crypto_worker);
+  ~PrecomputedEphemeralKeySource() override;
+
+  // EphemeralKeySource interface.
+  std::string CalculateForwardSecureKey(const KeyExchange* key_exchange,
+                                        QuicRandom* rand,
+                                        QuicTime now,
+                                        QuicStringPiece peer_public_value,
+                                        std::string* public_value) override;
+
+ private:
+  class RefillWork;
+
+  static const size_t kRingSize = 64;
+
+  // Removes and returns a precomputed key pair, or nullptr if the ring is
+  // empty.  Safe to call from any thread.
+  Curve25519KeyExchange* TryTake();
+
+  // Generates key pairs for every empty slot.  Runs on a crypto worker
+  // thread, or inline from the constructor.
+  void RefillRing();
+
+  // Schedules RefillRing on the crypto worker.  At most one refill is in
+  // flight at a time.
+  void ScheduleRefill();
+
+  QuicCryptoWorkerInterface* crypto_worker_;  // Unowned, may be nullptr.
+  std::atomic<Curve25519KeyExchange*> ring_[kRingSize];
+  std::atomic<bool> refill_pending_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrecomputedEphemeralKeySource);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_CRYPTO_PRECOMPUTED_EPHEMERAL_KEY_SOURCE_H_
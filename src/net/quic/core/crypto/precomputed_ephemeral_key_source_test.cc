@@ -0,0 +1,106 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/crypto/precomputed_ephemeral_key_source.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "net/quic/core/crypto/curve25519_key_exchange.h"
+#include "net/quic/core/crypto/quic_random.h"
+#include "net/quic/core/quic_time.h"
+#include "net/quic/platform/api/quic_test.h"
+
+using std::string;
+
+namespace net {
+namespace test {
+namespace {
+
+// A worker that holds scheduled work until the test runs it.
+class FakeCryptoWorker : public QuicCryptoWorkerInterface {
+ public:
+  bool TryScheduleWork(std::unique_ptr<Work>* work) override {
+    scheduled_.push_back(std::move(*work));
+    return true;
+  }
+
+  void PostCompletion(std::unique_ptr<Completion> completion) override {
+    completion->Run();
+  }
+
+  size_t num_scheduled() const { return scheduled_.size(); }
+
+  void RunAll() {
+    for (const auto& work : scheduled_) {
+      work->Run();
+    }
+    scheduled_.clear();
+  }
+
+ private:
+  std::vector<std::unique_ptr<Work>> scheduled_;
+};
+
+class PrecomputedEphemeralKeySourceTest : public QuicTest {
+ protected:
+  PrecomputedEphemeralKeySourceTest()
+      : rand_(QuicRandom::GetInstance()),
+        template_key_exchange_(
+            Curve25519KeyExchange::New(
+                Curve25519KeyExchange::NewPrivateKey(rand_))) {}
+
+  // Runs one handshake's worth of key agreement against |source| and checks
+  // that the peer derives the same shared key.
+  void ExchangeAndExpectSharedKey(PrecomputedEphemeralKeySource* source) {
+    std::unique_ptr<Curve25519KeyExchange> peer(Curve25519KeyExchange::New(
+        Curve25519KeyExchange::NewPrivateKey(rand_)));
+
+    string public_value;
+    const string server_shared = source->CalculateForwardSecureKey(
+        template_key_exchange_.get(), rand_, QuicTime::Zero(),
+        peer->public_value(), &public_value);
+
+    string peer_shared;
+    ASSERT_TRUE(peer->CalculateSharedKey(public_value, &peer_shared));
+    EXPECT_EQ(server_shared, peer_shared);
+  }
+
+  QuicRandom* const rand_;
+  std::unique_ptr<Curve25519KeyExchange> template_key_exchange_;
+};
+
+TEST_F(PrecomputedEphemeralKeySourceTest, SharedKey) {
+  PrecomputedEphemeralKeySource source(/*crypto_worker=*/nullptr);
+  ExchangeAndExpectSharedKey(&source);
+}
+
+TEST_F(PrecomputedEphemeralKeySourceTest, FallsBackWhenDrained) {
+  // With no worker the ring is never refilled, so this exercises both the
+  // precomputed path and, once the ring drains, inline generation.
+  PrecomputedEphemeralKeySource source(/*crypto_worker=*/nullptr);
+  for (int i = 0; i < 100; ++i) {
+    ExchangeAndExpectSharedKey(&source);
+  }
+}
+
+TEST_F(PrecomputedEphemeralKeySourceTest, RefillsOffThread) {
+  FakeCryptoWorker worker;
+  PrecomputedEphemeralKeySource source(&worker);
+
+  ExchangeAndExpectSharedKey(&source);
+  // Taking a key pair schedules a refill, but only one at a time.
+  EXPECT_EQ(1u, worker.num_scheduled());
+  ExchangeAndExpectSharedKey(&source);
+  EXPECT_EQ(1u, worker.num_scheduled());
+
+  worker.RunAll();
+  ExchangeAndExpectSharedKey(&source);
+  EXPECT_EQ(1u, worker.num_scheduled());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -78,6 +78,7 @@ const string* QuicCompressedCertsCache::GetCompressedCert(
 
   uint64_t key = ComputeUncompressedCertsHash(uncompressed_certs);
 
+  QuicWriterMutexLock locked(&mutex_);
   CachedCerts* cached_value = certs_cache_.Lookup(key);
   if (cached_value != nullptr &&
       cached_value->MatchesUncompressedCerts(uncompressed_certs)) {
@@ -86,6 +87,26 @@ const string* QuicCompressedCertsCache::GetCompressedCert(
   return nullptr;
 }
 
+bool QuicCompressedCertsCache::GetCompressedCert(
+    const QuicReferenceCountedPointer<ProofSource::Chain>& chain,
+    const string& client_common_set_hashes,
+    const string& client_cached_cert_hashes,
+    string* compressed_cert) {
+  UncompressedCerts uncompressed_certs(chain, &client_common_set_hashes,
+                                       &client_cached_cert_hashes);
+
+  uint64_t key = ComputeUncompressedCertsHash(uncompressed_certs);
+
+  QuicWriterMutexLock locked(&mutex_);
+  CachedCerts* cached_value = certs_cache_.Lookup(key);
+  if (cached_value != nullptr &&
+      cached_value->MatchesUncompressedCerts(uncompressed_certs)) {
+    *compressed_cert = *cached_value->compressed_cert();
+    return true;
+  }
+  return false;
+}
+
 void QuicCompressedCertsCache::Insert(
     const QuicReferenceCountedPointer<ProofSource::Chain>& chain,
     const string& client_common_set_hashes,
@@ -99,14 +120,17 @@ void QuicCompressedCertsCache::Insert(
   // Insert one unit to the cache.
   std::unique_ptr<CachedCerts> cached_certs(
       new CachedCerts(uncompressed_certs, compressed_cert));
+  QuicWriterMutexLock locked(&mutex_);
   certs_cache_.Insert(key, std::move(cached_certs));
 }
 
 size_t QuicCompressedCertsCache::MaxSize() {
+  QuicWriterMutexLock locked(&mutex_);
   return certs_cache_.MaxSize();
 }
 
 size_t QuicCompressedCertsCache::Size() {
+  QuicWriterMutexLock locked(&mutex_);
   return certs_cache_.Size();
 }
 
@@ -11,6 +11,7 @@
 #include "net/quic/core/crypto/proof_source.h"
 #include "net/quic/platform/api/quic_export.h"
 #include "net/quic/platform/api/quic_lru_cache.h"
+#include "net/quic/platform/api/quic_mutex.h"
 
 namespace net {
 
@@ -23,12 +24,23 @@ class QUIC_EXPORT_PRIVATE QuicCompressedCertsCache {
   // Returns the pointer to the cached compressed cert if
   // |chain, client_common_set_hashes, client_cached_cert_hashes| hits cache.
   // Otherwise, return nullptr.
-  // Returned pointer might become invalid on the next call to Insert().
+  // Returned pointer might become invalid on the next call to Insert(), so
+  // this form must not be used when the cache is shared with crypto worker
+  // threads; use the copying overload below instead.
   const std::string* GetCompressedCert(
       const QuicReferenceCountedPointer<ProofSource::Chain>& chain,
       const std::string& client_common_set_hashes,
       const std::string& client_cached_cert_hashes);
 
+  // Thread-safe form of the lookup above: copies the cached compressed cert
+  // into |*compressed_cert| while holding the cache's internal lock.  Returns
+  // false on a cache miss, leaving |*compressed_cert| untouched.
+  bool GetCompressedCert(
+      const QuicReferenceCountedPointer<ProofSource::Chain>& chain,
+      const std::string& client_common_set_hashes,
+      const std::string& client_cached_cert_hashes,
+      std::string* compressed_cert);
+
   // Inserts the specified
   // |chain, client_common_set_hashes,
   //  client_cached_cert_hashes, compressed_cert| tuple to the cache.
@@ -97,6 +109,10 @@ class QUIC_EXPORT_PRIVATE QuicCompressedCertsCache {
   uint64_t ComputeUncompressedCertsHash(
       const UncompressedCerts& uncompressed_certs);
 
+  // Guards certs_cache_.  The cache is shared between the event loop thread
+  // and any crypto worker threads running ProcessClientHello.
+  mutable QuicMutex mutex_;
+
   // Key is a unit64_t hash for UncompressedCerts. Stored associated value is
   // CachedCerts which has both original uncompressed certs data and the
   // compressed representation of the certs.
@@ -331,6 +331,10 @@ QuicCryptoClientConfig::CachedState::proof_verify_details() const {
   return proof_verify_details_.get();
 }
 
+QuicWallTime QuicCryptoClientConfig::CachedState::expiration_time() const {
+  return expiration_time_;
+}
+
 void QuicCryptoClientConfig::CachedState::set_source_address_token(
     QuicStringPiece token) {
   source_address_token_ = token.as_string();
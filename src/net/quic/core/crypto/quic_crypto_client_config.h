@@ -115,6 +115,9 @@ class QUIC_EXPORT_PRIVATE QuicCryptoClientConfig : public QuicCryptoConfig {
     bool proof_valid() const;
     uint64_t generation_counter() const;
     const ProofVerifyDetails* proof_verify_details() const;
+    // Time at which the server config stops being valid, Zero() if no
+    // server config is cached.
+    QuicWallTime expiration_time() const;
 
     void set_source_address_token(QuicStringPiece token);
 
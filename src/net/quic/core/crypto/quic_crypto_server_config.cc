@@ -155,8 +155,7 @@ QuicCryptoServerConfig::QuicCryptoServerConfig(
     : replay_protection_(true),
       chlo_multiplier_(kMultiplier),
       configs_lock_(),
-      primary_config_(nullptr),
-      next_config_promotion_time_(QuicWallTime::Zero()),
+      configs_snapshot_(std::make_shared<ConfigsSnapshot>()),
       proof_source_(std::move(proof_source)),
       source_address_token_future_secs_(3600),
       source_address_token_lifetime_secs_(86400),
@@ -228,7 +227,13 @@ QuicCryptoServerConfig::GenerateConfig(QuicRandom* rand,
   } else {
     msg.SetVector(kKEXS, QuicTagVector{kC255});
   }
-  msg.SetVector(kAEAD, QuicTagVector{kAESG, kCC20});
+  // List the AEAD this machine seals fastest first, so clients without their
+  // own preference land on the cipher the server's hardware wants.
+  if (CryptoUtils::IsAesGcmFaster()) {
+    msg.SetVector(kAEAD, QuicTagVector{kAESG, kCC20});
+  } else {
+    msg.SetVector(kAEAD, QuicTagVector{kCC20, kAESG});
+  }
   msg.SetStringPiece(kPUBS, encoded_public_values);
 
   if (options.expiry_time.IsZero()) {
@@ -316,18 +321,21 @@ CryptoHandshakeMessage* QuicCryptoServerConfig::AddConfig(
 
   {
     QuicWriterMutexLock locked(&configs_lock_);
-    if (configs_.find(config->id) != configs_.end()) {
+    auto snapshot = std::make_shared<ConfigsSnapshot>(*GetConfigsSnapshot());
+    if (snapshot->configs.find(config->id) != snapshot->configs.end()) {
       QUIC_LOG(WARNING) << "Failed to add config because another with the same "
                            "server config id already exists: "
                         << QuicTextUtils::HexEncode(config->id);
       return nullptr;
     }
 
-    configs_[config->id] = config;
-    SelectNewPrimaryConfig(now);
-    DCHECK(primary_config_.get());
-    DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
-              primary_config_.get());
+    snapshot->configs[config->id] = config;
+    SelectNewPrimaryConfig(now, snapshot.get());
+    DCHECK(snapshot->primary_config.get());
+    DCHECK_EQ(
+        snapshot->configs.find(snapshot->primary_config->id)->second.get(),
+        snapshot->primary_config.get());
+    PublishConfigsSnapshot(std::move(snapshot));
   }
 
   return msg.release();
@@ -367,6 +375,7 @@ bool QuicCryptoServerConfig::SetConfigs(
     QUIC_LOG(INFO) << "Updating configs:";
 
     QuicWriterMutexLock locked(&configs_lock_);
+    auto snapshot = std::make_shared<ConfigsSnapshot>(*GetConfigsSnapshot());
     ConfigMap new_configs;
 
     for (std::vector<QuicReferenceCountedPointer<Config>>::const_iterator i =
@@ -374,8 +383,8 @@ bool QuicCryptoServerConfig::SetConfigs(
          i != parsed_configs.end(); ++i) {
       QuicReferenceCountedPointer<Config> config = *i;
 
-      ConfigMap::iterator it = configs_.find(config->id);
-      if (it != configs_.end()) {
+      ConfigMap::iterator it = snapshot->configs.find(config->id);
+      if (it != snapshot->configs.end()) {
         QUIC_LOG(INFO) << "Keeping scid: "
                        << QuicTextUtils::HexEncode(config->id) << " orbit: "
                        << QuicTextUtils::HexEncode(
@@ -404,11 +413,13 @@ bool QuicCryptoServerConfig::SetConfigs(
       }
     }
 
-    configs_.swap(new_configs);
-    SelectNewPrimaryConfig(now);
-    DCHECK(primary_config_.get());
-    DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
-              primary_config_.get());
+    snapshot->configs.swap(new_configs);
+    SelectNewPrimaryConfig(now, snapshot.get());
+    DCHECK(snapshot->primary_config.get());
+    DCHECK_EQ(
+        snapshot->configs.find(snapshot->primary_config->id)->second.get(),
+        snapshot->primary_config.get());
+    PublishConfigsSnapshot(std::move(snapshot));
   }
 
   return ok;
@@ -420,9 +431,9 @@ void QuicCryptoServerConfig::SetSourceAddressTokenKeys(
 }
 
 void QuicCryptoServerConfig::GetConfigIds(std::vector<string>* scids) const {
-  QuicReaderMutexLock locked(&configs_lock_);
-  for (ConfigMap::const_iterator it = configs_.begin(); it != configs_.end();
-       ++it) {
+  std::shared_ptr<const ConfigsSnapshot> snapshot = GetConfigsSnapshot();
+  for (ConfigMap::const_iterator it = snapshot->configs.begin();
+       it != snapshot->configs.end(); ++it) {
     scids->push_back(it->first);
   }
 }
@@ -446,31 +457,23 @@ void QuicCryptoServerConfig::ValidateClientHello(
 
   QuicReferenceCountedPointer<Config> requested_config;
   QuicReferenceCountedPointer<Config> primary_config;
-  {
-    QuicReaderMutexLock locked(&configs_lock_);
+  std::shared_ptr<const ConfigsSnapshot> snapshot = GetConfigsSnapshot();
 
-    if (!primary_config_.get()) {
-      result->error_code = QUIC_CRYPTO_INTERNAL_ERROR;
-      result->error_details = "No configurations loaded";
-    } else {
-      if (!next_config_promotion_time_.IsZero() &&
-          next_config_promotion_time_.IsAfter(now)) {
-        configs_lock_.ReaderUnlock();
-        configs_lock_.WriterLock();
-        SelectNewPrimaryConfig(now);
-        DCHECK(primary_config_.get());
-        DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
-                  primary_config_.get());
-        configs_lock_.WriterUnlock();
-        configs_lock_.ReaderLock();
-      }
+  if (!snapshot->primary_config.get()) {
+    result->error_code = QUIC_CRYPTO_INTERNAL_ERROR;
+    result->error_details = "No configurations loaded";
+  } else {
+    if (!snapshot->next_config_promotion_time.IsZero() &&
+        snapshot->next_config_promotion_time.IsAfter(now)) {
+      PromotePrimaryConfig(now);
+      snapshot = GetConfigsSnapshot();
     }
-
-    requested_config = GetConfigWithScid(requested_scid);
-    primary_config = primary_config_;
-    signed_config->config = primary_config_;
   }
 
+  requested_config = GetConfigWithScid(snapshot->configs, requested_scid);
+  primary_config = snapshot->primary_config;
+  signed_config->config = snapshot->primary_config;
+
   if (result->error_code == QUIC_NO_ERROR) {
     // QUIC requires a new proof for each CHLO so clear any existing proof.
     signed_config->chain = nullptr;
@@ -648,29 +651,21 @@ void QuicCryptoServerConfig::ProcessClientHello(
   QuicReferenceCountedPointer<Config> requested_config;
   QuicReferenceCountedPointer<Config> primary_config;
   bool no_primary_config = false;
-  {
-    QuicReaderMutexLock locked(&configs_lock_);
-
-    if (!primary_config_) {
-      no_primary_config = true;
-    } else {
-      if (!next_config_promotion_time_.IsZero() &&
-          next_config_promotion_time_.IsAfter(now)) {
-        configs_lock_.ReaderUnlock();
-        configs_lock_.WriterLock();
-        SelectNewPrimaryConfig(now);
-        DCHECK(primary_config_.get());
-        DCHECK_EQ(configs_.find(primary_config_->id)->second.get(),
-                  primary_config_.get());
-        configs_lock_.WriterUnlock();
-        configs_lock_.ReaderLock();
-      }
+  std::shared_ptr<const ConfigsSnapshot> snapshot = GetConfigsSnapshot();
 
-      // Use the config that the client requested in order to do key-agreement.
-      // Otherwise give it a copy of |primary_config_| to use.
-      primary_config = signed_config->config;
-      requested_config = GetConfigWithScid(requested_scid);
+  if (!snapshot->primary_config) {
+    no_primary_config = true;
+  } else {
+    if (!snapshot->next_config_promotion_time.IsZero() &&
+        snapshot->next_config_promotion_time.IsAfter(now)) {
+      PromotePrimaryConfig(now);
+      snapshot = GetConfigsSnapshot();
     }
+
+    // Use the config that the client requested in order to do key-agreement.
+    // Otherwise give it a copy of the primary config to use.
+    primary_config = signed_config->config;
+    requested_config = GetConfigWithScid(snapshot->configs, requested_scid);
   }
   if (no_primary_config) {
     helper.Fail(QUIC_CRYPTO_INTERNAL_ERROR, "No configurations loaded");
@@ -999,14 +994,33 @@ void QuicCryptoServerConfig::ProcessClientHelloAfterGetProof(
                  std::move(proof_source_details));
 }
 
-QuicReferenceCountedPointer<QuicCryptoServerConfig::Config>
-QuicCryptoServerConfig::GetConfigWithScid(
-    QuicStringPiece requested_scid) const {
-  configs_lock_.AssertReaderHeld();
+std::shared_ptr<const QuicCryptoServerConfig::ConfigsSnapshot>
+QuicCryptoServerConfig::GetConfigsSnapshot() const {
+  return std::atomic_load(&configs_snapshot_);
+}
+
+void QuicCryptoServerConfig::PublishConfigsSnapshot(
+    std::shared_ptr<const ConfigsSnapshot> snapshot) const {
+  std::atomic_store(&configs_snapshot_, std::move(snapshot));
+}
 
+void QuicCryptoServerConfig::PromotePrimaryConfig(QuicWallTime now) const {
+  QuicWriterMutexLock locked(&configs_lock_);
+  auto snapshot = std::make_shared<ConfigsSnapshot>(*GetConfigsSnapshot());
+  SelectNewPrimaryConfig(now, snapshot.get());
+  DCHECK(snapshot->primary_config.get());
+  DCHECK_EQ(snapshot->configs.find(snapshot->primary_config->id)->second.get(),
+            snapshot->primary_config.get());
+  PublishConfigsSnapshot(std::move(snapshot));
+}
+
+// static
+QuicReferenceCountedPointer<QuicCryptoServerConfig::Config>
+QuicCryptoServerConfig::GetConfigWithScid(const ConfigMap& configs,
+                                          QuicStringPiece requested_scid) {
   if (!requested_scid.empty()) {
-    ConfigMap::const_iterator it = configs_.find(requested_scid.as_string());
-    if (it != configs_.end()) {
+    ConfigMap::const_iterator it = configs.find(requested_scid.as_string());
+    if (it != configs.end()) {
       // We'll use the config that the client requested in order to do
       // key-agreement.
       return QuicReferenceCountedPointer<Config>(it->second);
@@ -1036,18 +1050,19 @@ bool QuicCryptoServerConfig::ConfigPrimaryTimeLessThan(
 }
 
 void QuicCryptoServerConfig::SelectNewPrimaryConfig(
-    const QuicWallTime now) const {
+    const QuicWallTime now,
+    ConfigsSnapshot* snapshot) const {
   std::vector<QuicReferenceCountedPointer<Config>> configs;
-  configs.reserve(configs_.size());
+  configs.reserve(snapshot->configs.size());
 
-  for (ConfigMap::const_iterator it = configs_.begin(); it != configs_.end();
-       ++it) {
+  for (ConfigMap::const_iterator it = snapshot->configs.begin();
+       it != snapshot->configs.end(); ++it) {
     // TODO(avd) Exclude expired configs?
     configs.push_back(it->second);
   }
 
   if (configs.empty()) {
-    if (primary_config_ != nullptr) {
+    if (snapshot->primary_config != nullptr) {
       QUIC_BUG << "No valid QUIC server config. Keeping the current config.";
     } else {
       QUIC_BUG << "No valid QUIC server config.";
@@ -1075,25 +1090,26 @@ void QuicCryptoServerConfig::SelectNewPrimaryConfig(
     if (i == 0) {
       // We need the primary_time of the next config.
       if (configs.size() > 1) {
-        next_config_promotion_time_ = configs[1]->primary_time;
+        snapshot->next_config_promotion_time = configs[1]->primary_time;
       } else {
-        next_config_promotion_time_ = QuicWallTime::Zero();
+        snapshot->next_config_promotion_time = QuicWallTime::Zero();
       }
     } else {
-      next_config_promotion_time_ = config->primary_time;
+      snapshot->next_config_promotion_time = config->primary_time;
     }
 
-    if (primary_config_) {
-      primary_config_->is_primary = false;
+    if (snapshot->primary_config) {
+      snapshot->primary_config->is_primary = false;
     }
-    primary_config_ = new_primary;
+    snapshot->primary_config = new_primary;
     new_primary->is_primary = true;
     QUIC_DLOG(INFO) << "New primary config.  orbit: "
-                    << QuicTextUtils::HexEncode(reinterpret_cast<const char*>(
-                                                    primary_config_->orbit),
-                                                kOrbitSize);
+                    << QuicTextUtils::HexEncode(
+                           reinterpret_cast<const char*>(
+                               snapshot->primary_config->orbit),
+                           kOrbitSize);
     if (primary_config_changed_cb_.get() != nullptr) {
-      primary_config_changed_cb_->Run(primary_config_->id);
+      primary_config_changed_cb_->Run(snapshot->primary_config->id);
     }
 
     return;
@@ -1102,19 +1118,21 @@ void QuicCryptoServerConfig::SelectNewPrimaryConfig(
   // All config's primary times are in the past. We should make the most recent
   // and highest priority candidate primary.
   QuicReferenceCountedPointer<Config> new_primary = best_candidate;
-  if (primary_config_) {
-    primary_config_->is_primary = false;
+  if (snapshot->primary_config) {
+    snapshot->primary_config->is_primary = false;
   }
-  primary_config_ = new_primary;
+  snapshot->primary_config = new_primary;
   new_primary->is_primary = true;
   QUIC_DLOG(INFO) << "New primary config.  orbit: "
                   << QuicTextUtils::HexEncode(
-                         reinterpret_cast<const char*>(primary_config_->orbit),
+                         reinterpret_cast<const char*>(
+                             snapshot->primary_config->orbit),
                          kOrbitSize)
-                  << " scid: " << QuicTextUtils::HexEncode(primary_config_->id);
-  next_config_promotion_time_ = QuicWallTime::Zero();
+                  << " scid: "
+                  << QuicTextUtils::HexEncode(snapshot->primary_config->id);
+  snapshot->next_config_promotion_time = QuicWallTime::Zero();
   if (primary_config_changed_cb_.get() != nullptr) {
-    primary_config_changed_cb_->Run(primary_config_->id);
+    primary_config_changed_cb_->Run(snapshot->primary_config->id);
   }
 }
 
@@ -1346,12 +1364,12 @@ void QuicCryptoServerConfig::BuildServerConfigUpdateMessage(
   string source_address_token;
   const CommonCertSets* common_cert_sets;
   {
-    QuicReaderMutexLock locked(&configs_lock_);
-    serialized = primary_config_->serialized;
-    common_cert_sets = primary_config_->common_cert_sets;
+    std::shared_ptr<const ConfigsSnapshot> snapshot = GetConfigsSnapshot();
+    serialized = snapshot->primary_config->serialized;
+    common_cert_sets = snapshot->primary_config->common_cert_sets;
     source_address_token = NewSourceAddressToken(
-        *primary_config_, previous_source_address_tokens, client_ip, rand,
-        clock->WallNow(), cached_network_params);
+        *snapshot->primary_config, previous_source_address_tokens, client_ip,
+        rand, clock->WallNow(), cached_network_params);
   }
 
   CryptoHandshakeMessage message;
@@ -1556,17 +1574,20 @@ string QuicCryptoServerConfig::CompressChain(
     const string& client_common_set_hashes,
     const string& client_cached_cert_hashes,
     const CommonCertSets* common_sets) {
-  // Check whether the compressed certs is available in the cache.
+  // Check whether the compressed certs is available in the cache.  The
+  // copying lookup is used because the cache may be shared with crypto worker
+  // threads.
   DCHECK(compressed_certs_cache);
-  const string* cached_value = compressed_certs_cache->GetCompressedCert(
-      chain, client_common_set_hashes, client_cached_cert_hashes);
-  if (cached_value) {
-    return *cached_value;
+  string cached_value;
+  if (compressed_certs_cache->GetCompressedCert(chain, client_common_set_hashes,
+                                                client_cached_cert_hashes,
+                                                &cached_value)) {
+    return cached_value;
   }
 
   const string compressed =
       CertCompressor::CompressChain(chain->certs, client_common_set_hashes,
-                                    client_common_set_hashes, common_sets);
+                                    client_cached_cert_hashes, common_sets);
 
   // Insert the newly compressed cert to cache.
   compressed_certs_cache->Insert(chain, client_common_set_hashes,
@@ -1794,8 +1815,7 @@ string QuicCryptoServerConfig::NewSourceAddressToken(
 }
 
 int QuicCryptoServerConfig::NumberOfConfigs() const {
-  QuicReaderMutexLock locked(&configs_lock_);
-  return configs_.size();
+  return GetConfigsSnapshot()->configs.size();
 }
 
 HandshakeFailureReason QuicCryptoServerConfig::ParseSourceAddressToken(
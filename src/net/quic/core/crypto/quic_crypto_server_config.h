@@ -464,10 +464,41 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
   typedef std::map<ServerConfigID, QuicReferenceCountedPointer<Config>>
       ConfigMap;
 
-  // Get a ref to the config with a given server config id.
-  QuicReferenceCountedPointer<Config> GetConfigWithScid(
-      QuicStringPiece requested_scid) const
-      SHARED_LOCKS_REQUIRED(configs_lock_);
+  // ConfigsSnapshot is an immutable view of the active server configs.
+  // Writers build a fresh snapshot under |configs_lock_| and publish it as a
+  // whole, so handshakes can read a consistent set without any locking.
+  struct ConfigsSnapshot {
+    ConfigsSnapshot() : next_config_promotion_time(QuicWallTime::Zero()) {}
+
+    // configs contains all active server configs. It's expected that there
+    // are about half-a-dozen configs active at any one time.
+    ConfigMap configs;
+    // primary_config points to a Config (which is also in |configs|) which is
+    // the primary config - i.e. the one that we'll give out to new clients.
+    QuicReferenceCountedPointer<Config> primary_config;
+    // The nearest, future time when an active config will be promoted to
+    // primary.
+    QuicWallTime next_config_promotion_time;
+  };
+
+  // Returns the current snapshot. Safe to call from any thread without
+  // holding |configs_lock_|.
+  std::shared_ptr<const ConfigsSnapshot> GetConfigsSnapshot() const;
+
+  // Atomically replaces the current snapshot with |snapshot|. Must be called
+  // with |configs_lock_| held to serialize writers.
+  void PublishConfigsSnapshot(
+      std::shared_ptr<const ConfigsSnapshot> snapshot) const;
+
+  // Re-evaluates which config should be primary as of |now| and publishes a
+  // new snapshot reflecting the result. Called from handshake paths when a
+  // config's promotion time has passed. Takes |configs_lock_| internally.
+  void PromotePrimaryConfig(QuicWallTime now) const;
+
+  // Get a ref to the config in |configs| with a given server config id.
+  static QuicReferenceCountedPointer<Config> GetConfigWithScid(
+      const ConfigMap& configs,
+      QuicStringPiece requested_scid);
 
   // ConfigPrimaryTimeLessThan returns true if a->primary_time <
   // b->primary_time.
@@ -475,9 +506,11 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
       const QuicReferenceCountedPointer<Config>& a,
       const QuicReferenceCountedPointer<Config>& b);
 
-  // SelectNewPrimaryConfig reevaluates the primary config based on the
-  // "primary_time" deadlines contained in each.
-  void SelectNewPrimaryConfig(QuicWallTime now) const;
+  // SelectNewPrimaryConfig reevaluates the primary config in |snapshot| based
+  // on the "primary_time" deadlines contained in each. Must be called with
+  // |configs_lock_| held; the caller publishes |snapshot| afterwards.
+  void SelectNewPrimaryConfig(QuicWallTime now, ConfigsSnapshot* snapshot)
+      const;
 
   // EvaluateClientHello checks |client_hello| for gross errors and determines
   // whether it can be shown to be fresh (i.e. not a replay). The results are
@@ -706,21 +739,20 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
   // used to protect QUIC from amplification attacks.
   size_t chlo_multiplier_;
 
-  // configs_ satisfies the following invariants:
-  //   1) configs_.empty() <-> primary_config_ == nullptr
-  //   2) primary_config_ != nullptr -> primary_config_->is_primary
-  //   3) ∀ c∈configs_, c->is_primary <-> c == primary_config_
+  // The current snapshot satisfies the following invariants:
+  //   1) configs.empty() <-> primary_config == nullptr
+  //   2) primary_config != nullptr -> primary_config->is_primary
+  //   3) ∀ c∈configs, c->is_primary <-> c == primary_config
+  //
+  // configs_lock_ serializes writers (AddConfig, SetConfigs and primary
+  // config promotion). Readers never take it: they load |configs_snapshot_|
+  // with std::atomic_load and work off that immutable view, so config
+  // rotation never stalls handshakes.
   mutable QuicMutex configs_lock_;
-  // configs_ contains all active server configs. It's expected that there are
-  // about half-a-dozen configs active at any one time.
-  ConfigMap configs_ GUARDED_BY(configs_lock_);
-  // primary_config_ points to a Config (which is also in |configs_|) which is
-  // the primary config - i.e. the one that we'll give out to new clients.
-  mutable QuicReferenceCountedPointer<Config> primary_config_
-      GUARDED_BY(configs_lock_);
-  // next_config_promotion_time_ contains the nearest, future time when an
-  // active config will be promoted to primary.
-  mutable QuicWallTime next_config_promotion_time_ GUARDED_BY(configs_lock_);
+  // The current, immutable view of the active configs. Written (with
+  // |configs_lock_| held) via std::atomic_store; read via std::atomic_load.
+  // Superseded snapshots drain naturally as readers release their references.
+  mutable std::shared_ptr<const ConfigsSnapshot> configs_snapshot_;
   // Callback to invoke when the primary config changes.
   std::unique_ptr<PrimaryConfigChangedCallback> primary_config_changed_cb_
       GUARDED_BY(configs_lock_);
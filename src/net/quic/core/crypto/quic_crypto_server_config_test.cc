@@ -15,6 +15,7 @@
 #include "net/quic/core/crypto/crypto_server_config_protobuf.h"
 #include "net/quic/core/crypto/quic_random.h"
 #include "net/quic/core/quic_time.h"
+#include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_socket_address.h"
 #include "net/quic/platform/api/quic_test.h"
 #include "net/quic/test_tools/crypto_test_utils.h"
@@ -132,6 +133,31 @@ TEST_F(QuicCryptoServerConfigTest, CompressDifferentCerts) {
   EXPECT_EQ(compressed_certs_cache.Size(), 3u);
 }
 
+TEST_F(QuicCryptoServerConfigTest, CompressCertsWithCachedCertHints) {
+  QuicCompressedCertsCache compressed_certs_cache(
+      QuicCompressedCertsCache::kQuicCompressedCertsCacheSize);
+
+  QuicRandom* rand = QuicRandom::GetInstance();
+  QuicCryptoServerConfig server(QuicCryptoServerConfig::TESTING, rand,
+                                crypto_test_utils::ProofSourceForTesting());
+  QuicCryptoServerConfigPeer peer(&server);
+
+  std::vector<string> certs = {"testcert"};
+  QuicReferenceCountedPointer<ProofSource::Chain> chain(
+      new ProofSource::Chain(certs));
+
+  // A client which already caches the certificate gets back a reference to
+  // it rather than a recompressed chain.
+  uint64_t hash = QuicUtils::FNV1a_64_Hash(certs[0]);
+  QuicStringPiece hash_bytes(reinterpret_cast<char*>(&hash), sizeof(hash));
+
+  string compressed = QuicCryptoServerConfigPeer::CompressChain(
+      &compressed_certs_cache, chain, "", hash_bytes.as_string(), nullptr);
+  EXPECT_EQ(CertCompressor::CompressChain(certs, "", hash_bytes, nullptr),
+            compressed);
+  EXPECT_EQ(compressed_certs_cache.Size(), 1u);
+}
+
 class SourceAddressTokenTest : public QuicTest {
  public:
   SourceAddressTokenTest()
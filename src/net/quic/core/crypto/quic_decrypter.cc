@@ -44,4 +44,23 @@ void QuicDecrypter::DiversifyPreliminaryKey(QuicStringPiece preliminary_key,
   *out_nonce_prefix = hkdf.server_write_iv().as_string();
 }
 
+size_t QuicDecrypter::DecryptPackets(QuicVersion version,
+                                     BatchEntry* entries,
+                                     size_t num_entries) {
+  size_t num_succeeded = 0;
+  for (size_t i = 0; i < num_entries; ++i) {
+    BatchEntry& entry = entries[i];
+    entry.success = DecryptPacket(version, entry.packet_number,
+                                  entry.associated_data, entry.ciphertext,
+                                  entry.output, &entry.output_length,
+                                  entry.max_output_length);
+    if (entry.success) {
+      ++num_succeeded;
+    } else {
+      entry.output_length = 0;
+    }
+  }
+  return num_succeeded;
+}
+
 }  // namespace net
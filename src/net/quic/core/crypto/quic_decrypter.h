@@ -75,6 +75,28 @@ class QUIC_EXPORT_PRIVATE QuicDecrypter {
                              size_t* output_length,
                              size_t max_output_length) = 0;
 
+  // One packet in a batch passed to |DecryptPackets|. All input fields have
+  // the same meaning as the corresponding |DecryptPacket| arguments;
+  // |success| and |output_length| are set per entry on return.
+  struct QUIC_EXPORT_PRIVATE BatchEntry {
+    QuicPacketNumber packet_number;
+    QuicStringPiece associated_data;
+    QuicStringPiece ciphertext;
+    char* output;
+    size_t max_output_length;
+    // Outputs.
+    size_t output_length;
+    bool success;
+  };
+
+  // Decrypts |num_entries| packets protected by this decrypter's key and
+  // returns the number that decrypted successfully. The base implementation
+  // simply calls |DecryptPacket| per entry; ciphers backed by a multi-buffer
+  // AEAD can override it to keep several streams in flight per call.
+  virtual size_t DecryptPackets(QuicVersion version,
+                                BatchEntry* entries,
+                                size_t num_entries);
+
   // The name of the cipher.
   virtual const char* cipher_name() const = 0;
   // The ID of the cipher. Return 0x03000000 ORed with the 'cryptographic suite
@@ -25,4 +25,23 @@ QuicEncrypter* QuicEncrypter::Create(QuicTag algorithm) {
   }
 }
 
+size_t QuicEncrypter::EncryptPackets(QuicVersion version,
+                                     BatchEntry* entries,
+                                     size_t num_entries) {
+  size_t num_succeeded = 0;
+  for (size_t i = 0; i < num_entries; ++i) {
+    BatchEntry& entry = entries[i];
+    entry.success = EncryptPacket(version, entry.packet_number,
+                                  entry.associated_data, entry.plaintext,
+                                  entry.output, &entry.output_length,
+                                  entry.max_output_length);
+    if (entry.success) {
+      ++num_succeeded;
+    } else {
+      entry.output_length = 0;
+    }
+  }
+  return num_succeeded;
+}
+
 }  // namespace net
@@ -57,6 +57,28 @@ class QUIC_EXPORT_PRIVATE QuicEncrypter {
                              size_t* output_length,
                              size_t max_output_length) = 0;
 
+  // One packet in a batch passed to |EncryptPackets|. All input fields have
+  // the same meaning as the corresponding |EncryptPacket| arguments;
+  // |success| and |output_length| are set per entry on return.
+  struct QUIC_EXPORT_PRIVATE BatchEntry {
+    QuicPacketNumber packet_number;
+    QuicStringPiece associated_data;
+    QuicStringPiece plaintext;
+    char* output;
+    size_t max_output_length;
+    // Outputs.
+    size_t output_length;
+    bool success;
+  };
+
+  // Encrypts |num_entries| packets under this encrypter's key and returns
+  // the number that encrypted successfully. The base implementation simply
+  // calls |EncryptPacket| per entry; ciphers backed by a multi-buffer AEAD
+  // can override it to keep several streams in flight per call.
+  virtual size_t EncryptPackets(QuicVersion version,
+                                BatchEntry* entries,
+                                size_t num_entries);
+
   // GetKeySize() and GetNoncePrefixSize() tell the HKDF class how many bytes
   // of key material needs to be derived from the master secret.
   // NOTE: the sizes returned by GetKeySize() and GetNoncePrefixSize() are
@@ -23,7 +23,7 @@ PacketNumberQueue::const_iterator::~const_iterator() {}
 
 PacketNumberQueue::const_iterator::const_iterator(
     typename QuicIntervalSet<QuicPacketNumber>::const_iterator it)
-    : vector_it_(it), use_deque_it_(false) {}
+    : set_it_(it), use_vector_it_(false) {}
 
 PacketNumberQueue::const_reverse_iterator::const_reverse_iterator(
     const const_reverse_iterator& other) = default;
@@ -32,18 +32,17 @@ PacketNumberQueue::const_reverse_iterator::const_reverse_iterator(
 PacketNumberQueue::const_reverse_iterator::~const_reverse_iterator() {}
 
 PacketNumberQueue::const_iterator::const_iterator(
-    typename std::deque<Interval<QuicPacketNumber>>::const_iterator it)
-    : deque_it_(it), use_deque_it_(true) {}
+    IntervalVector::ContainerType::const_iterator it)
+    : vector_it_(it), use_vector_it_(true) {}
 
 PacketNumberQueue::const_reverse_iterator::const_reverse_iterator(
     const typename QuicIntervalSet<QuicPacketNumber>::const_reverse_iterator&
         it)
-    : vector_it_(it), use_deque_it_(false) {}
+    : set_it_(it), use_vector_it_(false) {}
 
 PacketNumberQueue::const_reverse_iterator::const_reverse_iterator(
-    const typename std::deque<
-        Interval<QuicPacketNumber>>::const_reverse_iterator& it)
-    : deque_it_(it), use_deque_it_(true) {}
+    const IntervalVector::ContainerType::const_reverse_iterator& it)
+    : vector_it_(it), use_vector_it_(true) {}
 
 bool IsAwaitingPacket(const QuicAckFrame& ack_frame,
                       QuicPacketNumber packet_number,
@@ -53,7 +52,9 @@ bool IsAwaitingPacket(const QuicAckFrame& ack_frame,
 }
 
 QuicAckFrame::QuicAckFrame()
-    : largest_observed(0), ack_delay_time(QuicTime::Delta::Infinite()) {}
+    : largest_observed(0),
+      ack_delay_time(QuicTime::Delta::Infinite()),
+      ecn_ce_count(0) {}
 
 QuicAckFrame::QuicAckFrame(const QuicAckFrame& other) = default;
 
@@ -63,6 +64,7 @@ std::ostream& operator<<(std::ostream& os, const QuicAckFrame& ack_frame) {
   os << "{ largest_observed: " << ack_frame.largest_observed
      << ", ack_delay_time: " << ack_frame.ack_delay_time.ToMicroseconds()
      << ", packets: [ " << ack_frame.packets << " ]"
+     << ", ecn_ce_count: " << ack_frame.ecn_ce_count
      << ", received_packets: [ ";
   for (const std::pair<QuicPacketNumber, QuicTime>& p :
        ack_frame.received_packet_times) {
@@ -72,8 +74,8 @@ std::ostream& operator<<(std::ostream& os, const QuicAckFrame& ack_frame) {
   return os;
 }
 PacketNumberQueue::PacketNumberQueue()
-    : use_deque_(FLAGS_quic_reloadable_flag_quic_frames_deque2) {
-  if (use_deque_) {
+    : use_vector_(FLAGS_quic_reloadable_flag_quic_frames_deque2) {
+  if (use_vector_) {
     QUIC_FLAG_COUNT(quic_reloadable_flag_quic_frames_deque2);
   }
 }
@@ -88,45 +90,46 @@ PacketNumberQueue& PacketNumberQueue::operator=(PacketNumberQueue&& other) =
     default;
 
 void PacketNumberQueue::Add(QuicPacketNumber packet_number) {
-  if (use_deque_) {
-    // Check if the deque is empty
-    if (packet_number_deque_.empty()) {
-      packet_number_deque_.push_front(
+  if (use_vector_) {
+    // Check if the vector is empty
+    if (packet_number_vector_->empty()) {
+      packet_number_vector_->push_back(
           Interval<QuicPacketNumber>(packet_number, packet_number + 1));
       return;
     }
-    Interval<QuicPacketNumber> back = packet_number_deque_.back();
+    Interval<QuicPacketNumber> back = packet_number_vector_->back();
 
     // Check for the typical case,
     // when the next packet in order is acked
     if (back.max() == packet_number) {
-      packet_number_deque_.back().SetMax(packet_number + 1);
+      packet_number_vector_->back().SetMax(packet_number + 1);
       return;
     }
     // Check if the next packet in order is skipped
     if (back.max() < packet_number) {
-      packet_number_deque_.push_back(
+      packet_number_vector_->push_back(
           Interval<QuicPacketNumber>(packet_number, packet_number + 1));
       return;
     }
 
-    Interval<QuicPacketNumber> front = packet_number_deque_.front();
-    // Check if the packet can be  popped on the front
+    Interval<QuicPacketNumber> front = packet_number_vector_->front();
+    // Check if the packet can be added at the front
     if (front.min() > packet_number + 1) {
-      packet_number_deque_.push_front(
+      packet_number_vector_->insert(
+          packet_number_vector_->begin(),
           Interval<QuicPacketNumber>(packet_number, packet_number + 1));
       return;
     }
     if (front.min() == packet_number + 1) {
-      packet_number_deque_.front().SetMin(packet_number);
+      packet_number_vector_->front().SetMin(packet_number);
       return;
     }
 
-    int i = packet_number_deque_.size() - 1;
+    int i = packet_number_vector_->size() - 1;
     // Iterating through the queue backwards
     // to find a proper place for the packet
     while (i >= 0) {
-      Interval<QuicPacketNumber> packet_interval = packet_number_deque_[i];
+      Interval<QuicPacketNumber> packet_interval = packet_number_vector_[i];
       DCHECK(packet_interval.min() < packet_interval.max());
       // Check if the packet is contained in an interval already
       if (packet_interval.Contains(packet_number)) {
@@ -135,7 +138,7 @@ void PacketNumberQueue::Add(QuicPacketNumber packet_number) {
 
       // Check if the packet can extend an interval.
       if (packet_interval.max() == packet_number) {
-        packet_number_deque_[i].SetMax(packet_number + 1);
+        packet_number_vector_[i].SetMax(packet_number + 1);
         return;
       }
       // Check if the packet can extend an interval
@@ -143,18 +146,18 @@ void PacketNumberQueue::Add(QuicPacketNumber packet_number) {
       // There is no need to merge an interval in the previous
       // if statement, as all merges will happen here.
       if (packet_interval.min() == packet_number + 1) {
-        packet_number_deque_[i].SetMin(packet_number);
-        if (i > 0 && packet_number == packet_number_deque_[i - 1].max()) {
-          packet_number_deque_[i - 1].SetMax(packet_interval.max());
-          packet_number_deque_.erase(packet_number_deque_.begin() + i);
+        packet_number_vector_[i].SetMin(packet_number);
+        if (i > 0 && packet_number == packet_number_vector_[i - 1].max()) {
+          packet_number_vector_[i - 1].SetMax(packet_interval.max());
+          packet_number_vector_->erase(packet_number_vector_->begin() + i);
         }
         return;
       }
 
       // Check if we need to make a new interval for the packet
       if (packet_interval.max() < packet_number + 1) {
-        packet_number_deque_.insert(
-            packet_number_deque_.begin() + i + 1,
+        packet_number_vector_->insert(
+            packet_number_vector_->begin() + i + 1,
             Interval<QuicPacketNumber>(packet_number, packet_number + 1));
         return;
       }
@@ -170,47 +173,49 @@ void PacketNumberQueue::AddRange(QuicPacketNumber lower,
   if (lower >= higher) {
     return;
   }
-  if (use_deque_) {
-    if (packet_number_deque_.empty()) {
-      packet_number_deque_.push_front(
+  if (use_vector_) {
+    if (packet_number_vector_->empty()) {
+      packet_number_vector_->push_back(
           Interval<QuicPacketNumber>(lower, higher));
       return;
     }
-    Interval<QuicPacketNumber> back = packet_number_deque_.back();
+    Interval<QuicPacketNumber> back = packet_number_vector_->back();
 
     if (back.max() == lower) {
       // Check for the typical case,
       // when the next packet in order is acked
-      packet_number_deque_.back().SetMax(higher);
+      packet_number_vector_->back().SetMax(higher);
       return;
     }
     if (back.max() < lower) {
       // Check if the next packet in order is skipped
-      packet_number_deque_.push_back(Interval<QuicPacketNumber>(lower, higher));
+      packet_number_vector_->push_back(
+          Interval<QuicPacketNumber>(lower, higher));
       return;
     }
-    Interval<QuicPacketNumber> front = packet_number_deque_.front();
+    Interval<QuicPacketNumber> front = packet_number_vector_->front();
     // Check if the packets are being added in reverse order
     if (front.min() == higher) {
-      packet_number_deque_.front().SetMin(lower);
+      packet_number_vector_->front().SetMin(lower);
     } else if (front.min() > higher) {
-      packet_number_deque_.push_front(
-          Interval<QuicPacketNumber>(lower, higher));
+      packet_number_vector_->insert(packet_number_vector_->begin(),
+                                    Interval<QuicPacketNumber>(lower, higher));
 
     } else {
       // Iterating through the interval and adding packets one by one
       QUIC_BUG << "In the slowpath of AddRange. Adding [" << lower << ", "
-               << higher << "), in a deque of size "
-               << packet_number_deque_.size() << ", whose largest element is "
+               << higher << "), in a vector of size "
+               << packet_number_vector_->size()
+               << ", whose largest element is "
                << back.max() << " and smallest " << front.min() << ".\n";
-      // Check if the first and/or the last interval of the deque can be
+      // Check if the first and/or the last interval of the vector can be
       // extended, which would reduce the compexity of the following for loop.
       if (higher >= back.max()) {
-        packet_number_deque_.back().SetMax(higher);
+        packet_number_vector_->back().SetMax(higher);
         higher = max(lower, back.min());
       }
       if (lower < front.min()) {
-        packet_number_deque_.front().SetMin(lower);
+        packet_number_vector_->front().SetMin(lower);
         lower = min(higher, front.max());
       }
 
@@ -228,21 +233,19 @@ bool PacketNumberQueue::RemoveUpTo(QuicPacketNumber higher) {
     return false;
   }
   const QuicPacketNumber old_min = Min();
-  if (use_deque_) {
-    while (!packet_number_deque_.empty()) {
-      Interval<QuicPacketNumber> front = packet_number_deque_.front();
-      if (front.max() < higher) {
-        packet_number_deque_.pop_front();
-      } else if (front.min() < higher && front.max() >= higher) {
-        packet_number_deque_.front().SetMin(higher);
-        if (front.max() == higher) {
-          packet_number_deque_.pop_front();
-        }
-        break;
-      } else {
-        break;
-      }
+  if (use_vector_) {
+    // Intervals are sorted, so find the first one that survives and erase
+    // everything below it in one shot rather than popping the front
+    // repeatedly.
+    IntervalVector::ContainerType::iterator it =
+        packet_number_vector_->begin();
+    while (it != packet_number_vector_->end() && it->max() <= higher) {
+      ++it;
     }
+    if (it != packet_number_vector_->end() && it->min() < higher) {
+      it->SetMin(higher);
+    }
+    packet_number_vector_->erase(packet_number_vector_->begin(), it);
   } else {
     packet_number_intervals_.Difference(0, higher);
   }
@@ -251,11 +254,11 @@ bool PacketNumberQueue::RemoveUpTo(QuicPacketNumber higher) {
 }
 
 void PacketNumberQueue::RemoveSmallestInterval() {
-  if (use_deque_) {
-    QUIC_BUG_IF(packet_number_deque_.size() < 2)
+  if (use_vector_) {
+    QUIC_BUG_IF(packet_number_vector_->size() < 2)
         << (Empty() ? "No intervals to remove."
                     : "Can't remove the last interval.");
-    packet_number_deque_.pop_front();
+    packet_number_vector_->erase(packet_number_vector_->begin());
   } else {
     QUIC_BUG_IF(packet_number_intervals_.Size() < 2)
         << (Empty() ? "No intervals to remove."
@@ -265,28 +268,32 @@ void PacketNumberQueue::RemoveSmallestInterval() {
 }
 
 bool PacketNumberQueue::Contains(QuicPacketNumber packet_number) const {
-  if (use_deque_) {
-    if (packet_number_deque_.empty()) {
+  if (use_vector_) {
+    if (packet_number_vector_->empty()) {
       return false;
     }
-    if (packet_number_deque_.front().min() > packet_number ||
-        packet_number_deque_.back().max() <= packet_number) {
+    if (packet_number_vector_->front().min() > packet_number ||
+        packet_number_vector_->back().max() <= packet_number) {
       return false;
     }
-    for (Interval<QuicPacketNumber> interval : packet_number_deque_) {
-      if (interval.Contains(packet_number)) {
-        return true;
-      }
-    }
-    return false;
+    // Intervals are sorted and disjoint, so binary search for the first
+    // interval which could contain |packet_number|.
+    IntervalVector::ContainerType::const_iterator it = std::lower_bound(
+        packet_number_vector_->begin(), packet_number_vector_->end(),
+        packet_number,
+        [](const Interval<QuicPacketNumber>& interval,
+           QuicPacketNumber packet_number) {
+          return interval.max() <= packet_number;
+        });
+    return it != packet_number_vector_->end() && it->Contains(packet_number);
   } else {
     return packet_number_intervals_.Contains(packet_number);
   }
 }
 
 bool PacketNumberQueue::Empty() const {
-  if (use_deque_) {
-    return packet_number_deque_.empty();
+  if (use_vector_) {
+    return packet_number_vector_->empty();
   } else {
     return packet_number_intervals_.Empty();
   }
@@ -294,8 +301,8 @@ bool PacketNumberQueue::Empty() const {
 
 QuicPacketNumber PacketNumberQueue::Min() const {
   DCHECK(!Empty());
-  if (use_deque_) {
-    return packet_number_deque_.front().min();
+  if (use_vector_) {
+    return packet_number_vector_->front().min();
   } else {
     return packet_number_intervals_.begin()->min();
   }
@@ -303,17 +310,18 @@ QuicPacketNumber PacketNumberQueue::Min() const {
 
 QuicPacketNumber PacketNumberQueue::Max() const {
   DCHECK(!Empty());
-  if (use_deque_) {
-    return packet_number_deque_.back().max() - 1;
+  if (use_vector_) {
+    return packet_number_vector_->back().max() - 1;
   } else {
     return packet_number_intervals_.rbegin()->max() - 1;
   }
 }
 
 size_t PacketNumberQueue::NumPacketsSlow() const {
-  if (use_deque_) {
+  if (use_vector_) {
     int n_packets = 0;
-    for (Interval<QuicPacketNumber> interval : packet_number_deque_) {
+    for (const Interval<QuicPacketNumber>& interval :
+         packet_number_vector_.container()) {
       n_packets += interval.Length();
     }
     return n_packets;
@@ -327,40 +335,40 @@ size_t PacketNumberQueue::NumPacketsSlow() const {
 }
 
 size_t PacketNumberQueue::NumIntervals() const {
-  if (use_deque_) {
-    return packet_number_deque_.size();
+  if (use_vector_) {
+    return packet_number_vector_->size();
   } else {
     return packet_number_intervals_.Size();
   }
 }
 
 PacketNumberQueue::const_iterator PacketNumberQueue::begin() const {
-  if (use_deque_) {
-    return PacketNumberQueue::const_iterator(packet_number_deque_.begin());
+  if (use_vector_) {
+    return PacketNumberQueue::const_iterator(packet_number_vector_->begin());
   } else {
     return PacketNumberQueue::const_iterator(packet_number_intervals_.begin());
   }
 }
 
 PacketNumberQueue::const_iterator PacketNumberQueue::end() const {
-  if (use_deque_) {
-    return const_iterator(packet_number_deque_.end());
+  if (use_vector_) {
+    return const_iterator(packet_number_vector_->end());
   } else {
     return const_iterator(packet_number_intervals_.end());
   }
 }
 
 PacketNumberQueue::const_reverse_iterator PacketNumberQueue::rbegin() const {
-  if (use_deque_) {
-    return const_reverse_iterator(packet_number_deque_.rbegin());
+  if (use_vector_) {
+    return const_reverse_iterator(packet_number_vector_->rbegin());
   } else {
     return const_reverse_iterator(packet_number_intervals_.rbegin());
   }
 }
 
 PacketNumberQueue::const_reverse_iterator PacketNumberQueue::rend() const {
-  if (use_deque_) {
-    return const_reverse_iterator(packet_number_deque_.rend());
+  if (use_vector_) {
+    return const_reverse_iterator(packet_number_vector_->rend());
   } else {
     return const_reverse_iterator(packet_number_intervals_.rend());
   }
@@ -368,8 +376,8 @@ PacketNumberQueue::const_reverse_iterator PacketNumberQueue::rend() const {
 
 QuicPacketNumber PacketNumberQueue::LastIntervalLength() const {
   DCHECK(!Empty());
-  if (use_deque_) {
-    return packet_number_deque_.back().Length();
+  if (use_vector_) {
+    return packet_number_vector_->back().Length();
   } else {
     return packet_number_intervals_.rbegin()->Length();
   }
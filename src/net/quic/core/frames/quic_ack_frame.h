@@ -5,9 +5,10 @@
 #ifndef NET_QUIC_CORE_FRAMES_QUIC_ACK_FRAME_H_
 #define NET_QUIC_CORE_FRAMES_QUIC_ACK_FRAME_H_
 
-#include <deque>
+#include <iterator>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "net/quic/core/quic_types.h"
 #include "net/quic/platform/api/quic_containers.h"
@@ -29,6 +30,15 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
   PacketNumberQueue& operator=(const PacketNumberQueue& other);
   PacketNumberQueue& operator=(PacketNumberQueue&& other);
 
+  // The number of intervals stored without heap allocation. Acks on all but
+  // heavily reordered connections fit inline.
+  static const size_t kInlinedIntervalCapacity = 8;
+
+  // Intervals are kept sorted and disjoint in a flat vector so that walking
+  // them, as ack serialization does, touches contiguous memory.
+  typedef QuicStackVector<Interval<QuicPacketNumber>, kInlinedIntervalCapacity>
+      IntervalVector;
+
   class QUIC_EXPORT_PRIVATE const_iterator {
    public:
     const_iterator(const const_iterator& other);
@@ -39,7 +49,7 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
         typename QuicIntervalSet<QuicPacketNumber>::const_iterator it);
 
     explicit const_iterator(
-        typename std::deque<Interval<QuicPacketNumber>>::const_iterator it);
+        IntervalVector::ContainerType::const_iterator it);
 
     typedef std::input_iterator_tag iterator_category;
     typedef Interval<QuicPacketNumber> value_type;
@@ -49,49 +59,49 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
         difference_type;
 
     inline const Interval<QuicPacketNumber>& operator*() {
-      if (use_deque_it_) {
-        return *deque_it_;
-      } else {
+      if (use_vector_it_) {
         return *vector_it_;
+      } else {
+        return *set_it_;
       }
     }
 
     inline const_iterator& operator++() {
-      if (use_deque_it_) {
-        deque_it_++;
-      } else {
+      if (use_vector_it_) {
         vector_it_++;
+      } else {
+        set_it_++;
       }
       return *this;
     }
 
     inline const_iterator& operator--() {
-      if (use_deque_it_) {
-        deque_it_--;
-      } else {
+      if (use_vector_it_) {
         vector_it_--;
+      } else {
+        set_it_--;
       }
       return *this;
     }
 
     inline const_iterator& operator++(int) {
-      if (use_deque_it_) {
-        ++deque_it_;
-      } else {
+      if (use_vector_it_) {
         ++vector_it_;
+      } else {
+        ++set_it_;
       }
       return *this;
     }
 
     inline bool operator==(const const_iterator& other) {
-      if (use_deque_it_ != other.use_deque_it_) {
+      if (use_vector_it_ != other.use_vector_it_) {
         return false;
       }
 
-      if (use_deque_it_) {
-        return deque_it_ == other.deque_it_;
-      } else {
+      if (use_vector_it_) {
         return vector_it_ == other.vector_it_;
+      } else {
+        return set_it_ == other.set_it_;
       }
     }
 
@@ -100,9 +110,9 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
     }
 
    private:
-    typename QuicIntervalSet<QuicPacketNumber>::const_iterator vector_it_;
-    typename std::deque<Interval<QuicPacketNumber>>::const_iterator deque_it_;
-    const bool use_deque_it_;
+    typename QuicIntervalSet<QuicPacketNumber>::const_iterator set_it_;
+    IntervalVector::ContainerType::const_iterator vector_it_;
+    const bool use_vector_it_;
   };
 
   class QUIC_EXPORT_PRIVATE const_reverse_iterator {
@@ -116,8 +126,7 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
             QuicPacketNumber>::const_reverse_iterator& it);
 
     explicit const_reverse_iterator(
-        const typename std::deque<
-            Interval<QuicPacketNumber>>::const_reverse_iterator& it);
+        const IntervalVector::ContainerType::const_reverse_iterator& it);
 
     typedef std::input_iterator_tag iterator_category;
     typedef Interval<QuicPacketNumber> value_type;
@@ -127,57 +136,57 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
         difference_type;
 
     inline const Interval<QuicPacketNumber>& operator*() {
-      if (use_deque_it_) {
-        return *deque_it_;
-      } else {
+      if (use_vector_it_) {
         return *vector_it_;
+      } else {
+        return *set_it_;
       }
     }
 
     inline const Interval<QuicPacketNumber>* operator->() {
-      if (use_deque_it_) {
-        return &*deque_it_;
-      } else {
+      if (use_vector_it_) {
         return &*vector_it_;
+      } else {
+        return &*set_it_;
       }
     }
 
     inline const_reverse_iterator& operator++() {
-      if (use_deque_it_) {
-        deque_it_++;
-      } else {
+      if (use_vector_it_) {
         vector_it_++;
+      } else {
+        set_it_++;
       }
       return *this;
     }
 
     inline const_reverse_iterator& operator--() {
-      if (use_deque_it_) {
-        deque_it_--;
-      } else {
+      if (use_vector_it_) {
         vector_it_--;
+      } else {
+        set_it_--;
       }
       return *this;
     }
 
     inline const_reverse_iterator& operator++(int) {
-      if (use_deque_it_) {
-        ++deque_it_;
-      } else {
+      if (use_vector_it_) {
         ++vector_it_;
+      } else {
+        ++set_it_;
       }
       return *this;
     }
 
     inline bool operator==(const const_reverse_iterator& other) {
-      if (use_deque_it_ != other.use_deque_it_) {
+      if (use_vector_it_ != other.use_vector_it_) {
         return false;
       }
 
-      if (use_deque_it_) {
-        return deque_it_ == other.deque_it_;
-      } else {
+      if (use_vector_it_) {
         return vector_it_ == other.vector_it_;
+      } else {
+        return set_it_ == other.set_it_;
       }
     }
 
@@ -187,10 +196,9 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
 
    private:
     typename QuicIntervalSet<QuicPacketNumber>::const_reverse_iterator
-        vector_it_;
-    typename std::deque<Interval<QuicPacketNumber>>::const_reverse_iterator
-        deque_it_;
-    const bool use_deque_it_;
+        set_it_;
+    IntervalVector::ContainerType::const_reverse_iterator vector_it_;
+    const bool use_vector_it_;
   };
 
   // Adds |packet_number| to the set of packets in the queue.
@@ -246,8 +254,8 @@ class QUIC_EXPORT_PRIVATE PacketNumberQueue {
   // TODO(lilika): Remove QuicIntervalSet<QuicPacketNumber>
   // once FLAGS_quic_reloadable_flag_quic_frames_deque2 is removed
   QuicIntervalSet<QuicPacketNumber> packet_number_intervals_;
-  std::deque<Interval<QuicPacketNumber>> packet_number_deque_;
-  bool use_deque_;
+  IntervalVector packet_number_vector_;
+  bool use_vector_;
 };
 
 struct QUIC_EXPORT_PRIVATE QuicAckFrame {
@@ -271,6 +279,12 @@ struct QUIC_EXPORT_PRIVATE QuicAckFrame {
 
   // Set of packets.
   PacketNumberQueue packets;
+
+  // Number of packets received with the CE (congestion experienced) ECN
+  // codepoint over the lifetime of the connection. Only sent on the wire when
+  // FLAGS_quic_reloadable_flag_quic_ack_ecn_counts is enabled on both
+  // endpoints.
+  QuicPacketCount ecn_ce_count;
 };
 
 // True if the packet number is greater than largest_observed or is listed
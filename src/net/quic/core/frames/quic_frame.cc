@@ -94,6 +94,18 @@ void RemoveFramesForStream(QuicFrames* frames, QuicStreamId stream_id) {
   }
 }
 
+void DropFramesForStream(QuicFrames* frames, QuicStreamId stream_id) {
+  QuicFrames::iterator it = frames->begin();
+  while (it != frames->end()) {
+    if (it->type != STREAM_FRAME || it->stream_frame->stream_id != stream_id) {
+      ++it;
+      continue;
+    }
+    // The payload stays alive in its arena until the arena is released.
+    it = frames->erase(it);
+  }
+}
+
 std::ostream& operator<<(std::ostream& os, const QuicFrame& frame) {
   switch (frame.type) {
     case PADDING_FRAME: {
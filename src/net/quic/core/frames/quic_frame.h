@@ -74,6 +74,12 @@ QUIC_EXPORT_PRIVATE void DeleteFrames(QuicFrames* frames);
 QUIC_EXPORT_PRIVATE void RemoveFramesForStream(QuicFrames* frames,
                                                QuicStreamId stream_id);
 
+// Removes all the QuicStreamFrames for the specified |stream_id| without
+// deleting them; used when the frames' storage is owned by a QuicFrameArena
+// rather than the heap.
+QUIC_EXPORT_PRIVATE void DropFramesForStream(QuicFrames* frames,
+                                             QuicStreamId stream_id);
+
 }  // namespace net
 
 #endif  // NET_QUIC_CORE_FRAMES_QUIC_FRAME_H_
@@ -0,0 +1,163 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/frames/quic_frame_arena.h"
+
+#include <new>
+#include <utility>
+
+#include "net/quic/platform/api/quic_bug_tracker.h"
+
+namespace net {
+namespace {
+
+// Payloads and their type tags are laid out on 8 byte boundaries, matching
+// QuicOneBlockArena's alignment.
+const size_t kFrameAlign = 8;
+
+size_t AlignedSize(size_t size) {
+  return (size + kFrameAlign - 1) & ~(kFrameAlign - 1);
+}
+
+// Returns the payload size for a frame of |type|, or 0 when frames of that
+// type cannot be relocated into an arena. Only the types which appear in
+// retransmittable frame lists are supported; frames which are inlined in
+// QuicFrame have no payload to relocate.
+size_t PayloadSize(QuicFrameType type) {
+  switch (type) {
+    case STREAM_FRAME:
+      return sizeof(QuicStreamFrame);
+    case RST_STREAM_FRAME:
+      return sizeof(QuicRstStreamFrame);
+    case CONNECTION_CLOSE_FRAME:
+      return sizeof(QuicConnectionCloseFrame);
+    case GOAWAY_FRAME:
+      return sizeof(QuicGoAwayFrame);
+    case WINDOW_UPDATE_FRAME:
+      return sizeof(QuicWindowUpdateFrame);
+    case BLOCKED_FRAME:
+      return sizeof(QuicBlockedFrame);
+    default:
+      return 0;
+  }
+}
+
+bool IsInlinedFrame(QuicFrameType type) {
+  return type == PADDING_FRAME || type == MTU_DISCOVERY_FRAME ||
+         type == PING_FRAME;
+}
+
+}  // namespace
+
+// static
+QuicReferenceCountedPointer<QuicFrameArena> QuicFrameArena::Relocate(
+    QuicFrames* frames) {
+  size_t total_size = 0;
+  for (const QuicFrame& frame : *frames) {
+    if (IsInlinedFrame(frame.type)) {
+      continue;
+    }
+    const size_t payload_size = PayloadSize(frame.type);
+    if (payload_size == 0) {
+      // An unsupported type, e.g. an ack; leave everything on the heap.
+      return nullptr;
+    }
+    total_size += kFrameAlign + AlignedSize(payload_size);
+  }
+  if (total_size == 0) {
+    return nullptr;
+  }
+
+  QuicReferenceCountedPointer<QuicFrameArena> arena(
+      new QuicFrameArena(total_size));
+  for (QuicFrame& frame : *frames) {
+    switch (frame.type) {
+      case PADDING_FRAME:
+      case MTU_DISCOVERY_FRAME:
+      case PING_FRAME:
+        break;
+      case STREAM_FRAME:
+        frame.stream_frame =
+            arena->Relocated(STREAM_FRAME, frame.stream_frame);
+        break;
+      case RST_STREAM_FRAME:
+        frame.rst_stream_frame =
+            arena->Relocated(RST_STREAM_FRAME, frame.rst_stream_frame);
+        break;
+      case CONNECTION_CLOSE_FRAME:
+        frame.connection_close_frame = arena->Relocated(
+            CONNECTION_CLOSE_FRAME, frame.connection_close_frame);
+        break;
+      case GOAWAY_FRAME:
+        frame.goaway_frame = arena->Relocated(GOAWAY_FRAME, frame.goaway_frame);
+        break;
+      case WINDOW_UPDATE_FRAME:
+        frame.window_update_frame =
+            arena->Relocated(WINDOW_UPDATE_FRAME, frame.window_update_frame);
+        break;
+      case BLOCKED_FRAME:
+        frame.blocked_frame =
+            arena->Relocated(BLOCKED_FRAME, frame.blocked_frame);
+        break;
+      default:
+        QUIC_BUG << "Unexpected frame type during relocation: " << frame.type;
+        break;
+    }
+  }
+  return arena;
+}
+
+QuicFrameArena::QuicFrameArena(size_t size)
+    : storage_(new char[size]), used_(0) {}
+
+QuicFrameArena::~QuicFrameArena() {
+  size_t offset = 0;
+  while (offset < used_) {
+    char* tag = storage_.get() + offset;
+    char* payload = tag + kFrameAlign;
+    switch (static_cast<QuicFrameType>(*tag)) {
+      case STREAM_FRAME:
+        reinterpret_cast<QuicStreamFrame*>(payload)->~QuicStreamFrame();
+        offset += kFrameAlign + AlignedSize(sizeof(QuicStreamFrame));
+        break;
+      case RST_STREAM_FRAME:
+        reinterpret_cast<QuicRstStreamFrame*>(payload)->~QuicRstStreamFrame();
+        offset += kFrameAlign + AlignedSize(sizeof(QuicRstStreamFrame));
+        break;
+      case CONNECTION_CLOSE_FRAME:
+        reinterpret_cast<QuicConnectionCloseFrame*>(payload)
+            ->~QuicConnectionCloseFrame();
+        offset += kFrameAlign + AlignedSize(sizeof(QuicConnectionCloseFrame));
+        break;
+      case GOAWAY_FRAME:
+        reinterpret_cast<QuicGoAwayFrame*>(payload)->~QuicGoAwayFrame();
+        offset += kFrameAlign + AlignedSize(sizeof(QuicGoAwayFrame));
+        break;
+      case WINDOW_UPDATE_FRAME:
+        reinterpret_cast<QuicWindowUpdateFrame*>(payload)
+            ->~QuicWindowUpdateFrame();
+        offset += kFrameAlign + AlignedSize(sizeof(QuicWindowUpdateFrame));
+        break;
+      case BLOCKED_FRAME:
+        reinterpret_cast<QuicBlockedFrame*>(payload)->~QuicBlockedFrame();
+        offset += kFrameAlign + AlignedSize(sizeof(QuicBlockedFrame));
+        break;
+      default:
+        QUIC_BUG << "Corrupt frame arena tag: " << static_cast<int>(*tag);
+        return;
+    }
+  }
+}
+
+template <typename T>
+T* QuicFrameArena::Relocated(QuicFrameType type, T* original) {
+  char* tag = storage_.get() + used_;
+  *tag = static_cast<char>(type);
+  T* relocated = new (tag + kFrameAlign) T(std::move(*original));
+  delete original;
+  used_ += kFrameAlign + AlignedSize(sizeof(T));
+  return relocated;
+}
+
+}  // namespace net
@@ -0,0 +1,57 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_FRAMES_QUIC_FRAME_ARENA_H_
+#define NET_QUIC_CORE_FRAMES_QUIC_FRAME_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+
+#include "base/macros.h"
+#include "net/quic/core/frames/quic_frame.h"
+#include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_reference_counted.h"
+
+namespace net {
+
+// A single heap block holding all of a packet's retransmittable frame
+// payloads contiguously. Like QuicOneBlockArena, every allocation comes out
+// of one block; unlike it, the block is sized at runtime to exactly fit one
+// packet's frames. QuicTransmissionInfo holds the arena by reference so a
+// retransmission can take over the frames without copying them, and the
+// payloads are destroyed when the last reference is released.
+class QUIC_EXPORT_PRIVATE QuicFrameArena : public QuicReferenceCounted {
+ public:
+  // Moves the heap-allocated payloads of |frames| into one contiguous block,
+  // repointing each frame at its relocated payload and deleting the
+  // originals. Returns null - and relocates nothing - when no frame needs
+  // storage or when a frame of an unsupported type is present, in which case
+  // the frames remain individually heap-allocated and must be released with
+  // DeleteFrames as before.
+  static QuicReferenceCountedPointer<QuicFrameArena> Relocate(
+      QuicFrames* frames);
+
+ protected:
+  // Runs the destructor of every relocated payload.
+  ~QuicFrameArena() override;
+
+ private:
+  explicit QuicFrameArena(size_t size);
+
+  // Moves |*original| into the block, prefixed by a one-byte |type| tag so
+  // the destructor knows how to destroy it, and deletes |original|. Returns
+  // the relocated payload.
+  template <typename T>
+  T* Relocated(QuicFrameType type, T* original);
+
+  std::unique_ptr<char[]> storage_;
+  // Bytes of |storage_| holding relocated payloads and their tags.
+  size_t used_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicFrameArena);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_FRAMES_QUIC_FRAME_ARENA_H_
@@ -653,6 +653,36 @@ TEST_F(PacketNumberQueueTest, IntervalLengthAndRemoveInterval) {
   EXPECT_EQ(49u, queue.Max());
 }
 
+// Tests the flat-vector representation past its inline interval capacity.
+TEST_F(PacketNumberQueueTest, VectorSpillsPastInlineCapacity) {
+  FLAGS_quic_reloadable_flag_quic_frames_deque2 = true;
+  PacketNumberQueue queue;
+  const size_t num_intervals = 3 * PacketNumberQueue::kInlinedIntervalCapacity;
+  for (size_t i = 0; i < num_intervals; ++i) {
+    queue.AddRange(10 * i, 10 * i + 5);
+  }
+  EXPECT_EQ(num_intervals, queue.NumIntervals());
+  for (size_t i = 0; i < num_intervals; ++i) {
+    EXPECT_TRUE(queue.Contains(10 * i));
+    EXPECT_TRUE(queue.Contains(10 * i + 4));
+    EXPECT_FALSE(queue.Contains(10 * i + 5));
+  }
+
+  // Removal across several intervals leaves a trimmed front interval.
+  EXPECT_TRUE(queue.RemoveUpTo(42));
+  EXPECT_EQ(num_intervals - 4, queue.NumIntervals());
+  EXPECT_EQ(42u, queue.Min());
+  EXPECT_FALSE(queue.Contains(41));
+  EXPECT_TRUE(queue.Contains(42));
+
+  size_t remaining_intervals = 0;
+  for (const Interval<QuicPacketNumber>& interval : queue) {
+    EXPECT_LT(interval.min(), interval.max());
+    ++remaining_intervals;
+  }
+  EXPECT_EQ(num_intervals - 4, remaining_intervals);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
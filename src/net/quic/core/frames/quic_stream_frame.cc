@@ -4,6 +4,7 @@
 
 #include "net/quic/core/frames/quic_stream_frame.h"
 
+#include "net/quic/core/quic_copy_counters.h"
 #include "net/quic/platform/api/quic_logging.h"
 
 namespace net {
@@ -16,6 +17,7 @@ void StreamBufferDeleter::operator()(char* buffer) const {
 
 UniqueStreamBuffer NewStreamBuffer(QuicBufferAllocator* allocator,
                                    size_t size) {
+  QuicCopyCounters::RecordStreamBufferAllocation(size);
   return UniqueStreamBuffer(allocator->New(size),
                             StreamBufferDeleter(allocator));
 }
@@ -54,6 +54,8 @@ struct QUIC_EXPORT_PRIVATE QuicStreamFrame {
                   bool fin,
                   QuicStreamOffset offset,
                   QuicPacketLength data_length);
+  // Movable so a frame can be relocated into a QuicFrameArena.
+  QuicStreamFrame(QuicStreamFrame&& frame) = default;
   ~QuicStreamFrame();
 
   friend QUIC_EXPORT_PRIVATE std::ostream& operator<<(std::ostream& os,
@@ -8,6 +8,8 @@ namespace net {
 
 QuicAckListenerInterface::~QuicAckListenerInterface() {}
 
+QuicAckRangeListenerInterface::~QuicAckRangeListenerInterface() {}
+
 AckListenerWrapper::AckListenerWrapper(
     QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener,
     QuicPacketLength data_length)
@@ -32,6 +32,29 @@ class QUIC_EXPORT_PRIVATE QuicAckListenerInterface
   ~QuicAckListenerInterface() override;
 };
 
+// Pure virtual class to listen for acknowledgements of packet-number
+// ranges. Unlike QuicAckListenerInterface, which is attached to individual
+// packets and stored per packet in QuicTransmissionInfo, one registration
+// covers a whole range of packet numbers, so listeners that watch every
+// packet cost one registry entry instead of per-packet storage and
+// refcount traffic.
+class QUIC_EXPORT_PRIVATE QuicAckRangeListenerInterface
+    : public QuicReferenceCounted {
+ public:
+  QuicAckRangeListenerInterface() {}
+
+  // Called when packets [start, end] (both inclusive) within a registered
+  // range are newly acked. May be called several times per registration as
+  // different parts of the range are acked.
+  virtual void OnRangeAcked(QuicPacketNumber start,
+                            QuicPacketNumber end,
+                            QuicTime::Delta ack_delay_time) = 0;
+
+ protected:
+  // Listeners are ref counted.
+  ~QuicAckRangeListenerInterface() override;
+};
+
 struct QUIC_EXPORT_PRIVATE AckListenerWrapper {
   AckListenerWrapper(
       QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener,
@@ -4,6 +4,8 @@
 
 #include "net/quic/core/quic_alarm.h"
 
+#include "net/quic/core/quic_trace_ring.h"
+
 namespace net {
 
 QuicAlarm::QuicAlarm(QuicArenaScopedPtr<Delegate> delegate)
@@ -54,6 +56,8 @@ void QuicAlarm::Fire() {
     return;
   }
 
+  QUIC_TRACE_ALARM_FIRED(
+      (deadline_ - QuicTime::Zero()).ToMicroseconds());
   deadline_ = QuicTime::Zero();
   delegate_->OnAlarm();
 }
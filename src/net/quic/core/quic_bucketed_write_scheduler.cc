@@ -0,0 +1,213 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_bucketed_write_scheduler.h"
+
+#include "base/bits.h"
+#include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+static_assert(kV3LowestPriority < 32,
+              "Priorities must fit in the 32-bit ready bitmap");
+
+QuicBucketedWriteScheduler::QuicBucketedWriteScheduler()
+    : ready_priorities_(0), num_ready_streams_(0) {
+  for (Bucket& bucket : buckets_) {
+    bucket.ring.prev = &bucket.ring;
+    bucket.ring.next = &bucket.ring;
+    bucket.num_ready = 0;
+  }
+}
+
+QuicBucketedWriteScheduler::~QuicBucketedWriteScheduler() {}
+
+void QuicBucketedWriteScheduler::RegisterStream(QuicStreamId stream_id,
+                                                SpdyPriority priority) {
+  if (priority > kV3LowestPriority) {
+    QUIC_BUG << "Invalid priority " << static_cast<int>(priority)
+             << " for stream " << stream_id;
+    priority = kV3LowestPriority;
+  }
+  StreamInfo stream_info = {stream_id, priority, false, nullptr, nullptr};
+  bool inserted =
+      stream_infos_.insert(std::make_pair(stream_id, stream_info)).second;
+  QUIC_BUG_IF(!inserted) << "Stream " << stream_id << " already registered";
+}
+
+void QuicBucketedWriteScheduler::UnregisterStream(QuicStreamId stream_id) {
+  auto it = stream_infos_.find(stream_id);
+  if (it == stream_infos_.end()) {
+    QUIC_BUG << "Stream " << stream_id << " not registered";
+    return;
+  }
+  if (it->second.ready) {
+    Unlink(&it->second);
+  }
+  stream_infos_.erase(it);
+}
+
+bool QuicBucketedWriteScheduler::StreamRegistered(
+    QuicStreamId stream_id) const {
+  return stream_infos_.find(stream_id) != stream_infos_.end();
+}
+
+SpdyPriority QuicBucketedWriteScheduler::GetStreamPriority(
+    QuicStreamId stream_id) const {
+  auto it = stream_infos_.find(stream_id);
+  if (it == stream_infos_.end()) {
+    return kV3LowestPriority;
+  }
+  return it->second.priority;
+}
+
+void QuicBucketedWriteScheduler::UpdateStreamPriority(
+    QuicStreamId stream_id,
+    SpdyPriority new_priority) {
+  auto it = stream_infos_.find(stream_id);
+  if (it == stream_infos_.end()) {
+    QUIC_DVLOG(1) << "Stream " << stream_id << " not registered";
+    return;
+  }
+  if (new_priority > kV3LowestPriority) {
+    QUIC_BUG << "Invalid priority " << static_cast<int>(new_priority)
+             << " for stream " << stream_id;
+    new_priority = kV3LowestPriority;
+  }
+  StreamInfo& stream_info = it->second;
+  if (stream_info.priority == new_priority) {
+    return;
+  }
+  if (stream_info.ready) {
+    Unlink(&stream_info);
+    stream_info.priority = new_priority;
+    Link(&stream_info, /*add_to_front=*/false);
+    return;
+  }
+  stream_info.priority = new_priority;
+}
+
+void QuicBucketedWriteScheduler::MarkStreamReady(QuicStreamId stream_id,
+                                                 bool add_to_front) {
+  auto it = stream_infos_.find(stream_id);
+  if (it == stream_infos_.end()) {
+    QUIC_BUG << "Stream " << stream_id << " not registered";
+    return;
+  }
+  StreamInfo& stream_info = it->second;
+  if (stream_info.ready) {
+    return;
+  }
+  Link(&stream_info, add_to_front);
+}
+
+std::tuple<QuicStreamId, SpdyPriority>
+QuicBucketedWriteScheduler::PopNextReadyStreamAndPriority() {
+  if (ready_priorities_ == 0) {
+    QUIC_BUG << "No ready streams available";
+    return std::make_tuple(0, kV3LowestPriority);
+  }
+  const SpdyPriority priority = NextReadyPriority();
+  StreamInfo* info = buckets_[priority].ring.next;
+  DCHECK_EQ(priority, info->priority);
+  Unlink(info);
+  return std::make_tuple(info->stream_id, priority);
+}
+
+size_t QuicBucketedWriteScheduler::PopReadyBatch(size_t max_streams,
+                                                 std::vector<QuicStreamId>* batch,
+                                                 SpdyPriority* priority) {
+  if (ready_priorities_ == 0 || max_streams == 0) {
+    return 0;
+  }
+  *priority = NextReadyPriority();
+  Bucket& bucket = buckets_[*priority];
+  size_t num_popped = 0;
+  while (num_popped < max_streams && bucket.num_ready > 0) {
+    StreamInfo* info = bucket.ring.next;
+    DCHECK_EQ(*priority, info->priority);
+    Unlink(info);
+    batch->push_back(info->stream_id);
+    ++num_popped;
+  }
+  return num_popped;
+}
+
+bool QuicBucketedWriteScheduler::ShouldYield(QuicStreamId stream_id) const {
+  auto it = stream_infos_.find(stream_id);
+  if (it == stream_infos_.end()) {
+    QUIC_BUG << "Stream " << stream_id << " not registered";
+    return false;
+  }
+  const StreamInfo& stream_info = it->second;
+
+  // If any higher-priority bucket has a ready stream, this stream yields.
+  const uint32_t higher_priorities = (1u << stream_info.priority) - 1;
+  if ((ready_priorities_ & higher_priorities) != 0) {
+    return true;
+  }
+
+  // If this priority's bucket is empty, or this stream is the next up,
+  // there's no need to yield.
+  const Bucket& bucket = buckets_[stream_info.priority];
+  if (bucket.num_ready == 0 || bucket.ring.next == &stream_info) {
+    return false;
+  }
+
+  // Another stream in this bucket takes precedence. Yield.
+  return true;
+}
+
+size_t QuicBucketedWriteScheduler::NumReadyStreamsAtNextPriority() const {
+  if (ready_priorities_ == 0) {
+    return 0;
+  }
+  return buckets_[NextReadyPriority()].num_ready;
+}
+
+SpdyPriority QuicBucketedWriteScheduler::NextReadyPriority() const {
+  DCHECK_NE(0u, ready_priorities_);
+  // Priority p occupies bit p and smaller values are higher priority, so
+  // the bucket to serve next is the lowest set bit of the bitmap.
+  const uint32_t lowest_bit = ready_priorities_ & (0u - ready_priorities_);
+  return static_cast<SpdyPriority>(
+      31 - base::bits::CountLeadingZeroBits32(lowest_bit));
+}
+
+void QuicBucketedWriteScheduler::Link(StreamInfo* info, bool add_to_front) {
+  DCHECK(!info->ready);
+  Bucket& bucket = buckets_[info->priority];
+  StreamInfo* ring = &bucket.ring;
+  if (add_to_front) {
+    info->prev = ring;
+    info->next = ring->next;
+  } else {
+    info->prev = ring->prev;
+    info->next = ring;
+  }
+  info->prev->next = info;
+  info->next->prev = info;
+  ++bucket.num_ready;
+  ++num_ready_streams_;
+  ready_priorities_ |= 1u << info->priority;
+  info->ready = true;
+}
+
+void QuicBucketedWriteScheduler::Unlink(StreamInfo* info) {
+  DCHECK(info->ready);
+  Bucket& bucket = buckets_[info->priority];
+  info->prev->next = info->next;
+  info->next->prev = info->prev;
+  info->prev = nullptr;
+  info->next = nullptr;
+  --bucket.num_ready;
+  --num_ready_streams_;
+  if (bucket.num_ready == 0) {
+    ready_priorities_ &= ~(1u << info->priority);
+  }
+  info->ready = false;
+}
+
+}  // namespace net
@@ -0,0 +1,129 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_BUCKETED_WRITE_SCHEDULER_H_
+#define NET_QUIC_CORE_QUIC_BUCKETED_WRITE_SCHEDULER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/platform/api/quic_export.h"
+#include "net/spdy/core/spdy_protocol.h"
+
+namespace net {
+
+// A strict-priority write scheduler whose operations are all O(1). Ready
+// streams of each priority form a circular, doubly linked list threaded
+// through their registration records, so adding and removing a ready stream
+// never scans a list. A bitmap records which priorities have ready streams;
+// the next bucket to serve is found with a count-trailing-zeros, making
+// PopNextReadyStreamAndPriority() and ShouldYield() constant time regardless
+// of how many streams are ready.
+//
+// Within a priority, streams are served in the order they became ready,
+// except that MarkStreamReady() can re-queue a stream at the front of its
+// bucket to let it continue a batch write.
+class QUIC_EXPORT_PRIVATE QuicBucketedWriteScheduler {
+ public:
+  QuicBucketedWriteScheduler();
+  ~QuicBucketedWriteScheduler();
+
+  // Registers |stream_id| with the given priority. A stream must be
+  // registered before it can be marked ready.
+  void RegisterStream(QuicStreamId stream_id, SpdyPriority priority);
+
+  // Unregisters |stream_id|, removing it from its ready bucket if present.
+  void UnregisterStream(QuicStreamId stream_id);
+
+  bool StreamRegistered(QuicStreamId stream_id) const;
+
+  // Returns |stream_id|'s registered priority, or kV3LowestPriority if the
+  // stream is not registered.
+  SpdyPriority GetStreamPriority(QuicStreamId stream_id) const;
+
+  // Moves |stream_id| to |new_priority|. If the stream is ready it is
+  // re-queued at the back of the new priority's bucket.
+  void UpdateStreamPriority(QuicStreamId stream_id, SpdyPriority new_priority);
+
+  // Adds |stream_id| to its priority's bucket, at the front if
+  // |add_to_front| is true. No-op if the stream is already ready.
+  void MarkStreamReady(QuicStreamId stream_id, bool add_to_front);
+
+  // Pops the next stream to write: the front of the highest-priority
+  // non-empty bucket. Must not be called when HasReadyStreams() is false.
+  std::tuple<QuicStreamId, SpdyPriority> PopNextReadyStreamAndPriority();
+
+  // Pops up to |max_streams| streams from the highest-priority non-empty
+  // bucket, appending them to |batch| in the order consecutive
+  // PopNextReadyStreamAndPriority() calls would have returned them. A batch
+  // never mixes priorities, so it cannot outrank streams of a higher
+  // priority that are still queued. Returns the number of streams popped,
+  // and their shared priority via |priority| when that number is non-zero.
+  size_t PopReadyBatch(size_t max_streams,
+                       std::vector<QuicStreamId>* batch,
+                       SpdyPriority* priority);
+
+  // Returns true if |stream_id| should yield to another ready stream, i.e.
+  // a higher-priority bucket is non-empty or another stream is ahead of it
+  // in its own bucket.
+  bool ShouldYield(QuicStreamId stream_id) const;
+
+  bool HasReadyStreams() const { return ready_priorities_ != 0; }
+
+  size_t NumReadyStreams() const { return num_ready_streams_; }
+
+  // Batching hint: the number of streams that can be popped back to back
+  // from the highest-priority non-empty bucket before the scheduler needs
+  // to be consulted again. Zero when no stream is ready.
+  size_t NumReadyStreamsAtNextPriority() const;
+
+ private:
+  // State kept for every registered stream. The prev/next links thread the
+  // stream through its priority's ready ring; they are meaningful only
+  // while |ready| is true.
+  struct StreamInfo {
+    QuicStreamId stream_id;
+    SpdyPriority priority;
+    bool ready;
+    StreamInfo* prev;
+    StreamInfo* next;
+  };
+
+  // A ready bucket: a circular list rooted at a sentinel node, plus the
+  // number of streams currently linked into the ring.
+  struct Bucket {
+    StreamInfo ring;
+    size_t num_ready;
+  };
+
+  // Returns the highest priority (lowest value) with a ready stream.
+  // Must not be called when |ready_priorities_| is zero.
+  SpdyPriority NextReadyPriority() const;
+
+  // Links |info| into its priority's ring, at the front if |add_to_front|.
+  void Link(StreamInfo* info, bool add_to_front);
+
+  // Unlinks |info| from its priority's ring and clears its ready bit when
+  // the ring becomes empty.
+  void Unlink(StreamInfo* info);
+
+  // Bit p is set when buckets_[p] has at least one ready stream.
+  uint32_t ready_priorities_;
+  size_t num_ready_streams_;
+  Bucket buckets_[kV3LowestPriority + 1];
+  // Owns the StreamInfos; unordered_map guarantees stable addresses, which
+  // the intrusive rings rely on.
+  std::unordered_map<QuicStreamId, StreamInfo> stream_infos_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicBucketedWriteScheduler);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_BUCKETED_WRITE_SCHEDULER_H_
@@ -0,0 +1,176 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_bucketed_write_scheduler.h"
+
+#include "net/quic/platform/api/quic_test.h"
+#include "net/test/gtest_util.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicBucketedWriteSchedulerTest : public QuicTest {
+ protected:
+  QuicStreamId PopFront() {
+    return std::get<0>(scheduler_.PopNextReadyStreamAndPriority());
+  }
+
+  QuicBucketedWriteScheduler scheduler_;
+};
+
+TEST_F(QuicBucketedWriteSchedulerTest, PopsInStrictPriorityOrder) {
+  scheduler_.RegisterStream(5, kV3LowestPriority);
+  scheduler_.RegisterStream(7, kV3HighestPriority);
+  scheduler_.RegisterStream(9, 3);
+
+  scheduler_.MarkStreamReady(5, false);
+  scheduler_.MarkStreamReady(9, false);
+  scheduler_.MarkStreamReady(7, false);
+  EXPECT_EQ(3u, scheduler_.NumReadyStreams());
+
+  EXPECT_EQ(7u, PopFront());
+  EXPECT_EQ(9u, PopFront());
+  EXPECT_EQ(5u, PopFront());
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+}
+
+TEST_F(QuicBucketedWriteSchedulerTest, FifoWithinPriority) {
+  scheduler_.RegisterStream(5, 3);
+  scheduler_.RegisterStream(7, 3);
+  scheduler_.RegisterStream(9, 3);
+
+  scheduler_.MarkStreamReady(7, false);
+  scheduler_.MarkStreamReady(5, false);
+  // A stream continuing a batch write jumps its bucket's queue.
+  scheduler_.MarkStreamReady(9, true);
+
+  EXPECT_EQ(9u, PopFront());
+  EXPECT_EQ(7u, PopFront());
+  EXPECT_EQ(5u, PopFront());
+}
+
+TEST_F(QuicBucketedWriteSchedulerTest, UnregisterRemovesReadyStream) {
+  scheduler_.RegisterStream(5, 3);
+  scheduler_.RegisterStream(7, 3);
+  scheduler_.MarkStreamReady(5, false);
+  scheduler_.MarkStreamReady(7, false);
+
+  scheduler_.UnregisterStream(5);
+  EXPECT_EQ(1u, scheduler_.NumReadyStreams());
+  EXPECT_EQ(7u, PopFront());
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+}
+
+TEST_F(QuicBucketedWriteSchedulerTest, UpdatePriorityRequeuesReadyStream) {
+  scheduler_.RegisterStream(5, kV3LowestPriority);
+  scheduler_.RegisterStream(7, 3);
+  scheduler_.MarkStreamReady(5, false);
+  scheduler_.MarkStreamReady(7, false);
+
+  // Raising stream 5 above stream 7 makes it pop first.
+  scheduler_.UpdateStreamPriority(5, kV3HighestPriority);
+  EXPECT_EQ(5u, PopFront());
+  EXPECT_EQ(7u, PopFront());
+}
+
+TEST_F(QuicBucketedWriteSchedulerTest, UpdateToInvalidPriorityClamps) {
+  scheduler_.RegisterStream(5, 3);
+  scheduler_.MarkStreamReady(5, false);
+
+  EXPECT_QUIC_BUG(scheduler_.UpdateStreamPriority(5, kV3LowestPriority + 1),
+                  "Invalid priority");
+  EXPECT_EQ(kV3LowestPriority, scheduler_.GetStreamPriority(5));
+  EXPECT_EQ(5u, PopFront());
+}
+
+TEST_F(QuicBucketedWriteSchedulerTest, GetStreamPriority) {
+  // Unregistered streams report the lowest priority.
+  EXPECT_EQ(kV3LowestPriority, scheduler_.GetStreamPriority(5));
+
+  scheduler_.RegisterStream(5, 3);
+  EXPECT_EQ(3, scheduler_.GetStreamPriority(5));
+
+  scheduler_.UpdateStreamPriority(5, kV3HighestPriority);
+  EXPECT_EQ(kV3HighestPriority, scheduler_.GetStreamPriority(5));
+
+  scheduler_.UnregisterStream(5);
+  EXPECT_EQ(kV3LowestPriority, scheduler_.GetStreamPriority(5));
+}
+
+TEST_F(QuicBucketedWriteSchedulerTest, ShouldYield) {
+  scheduler_.RegisterStream(5, 3);
+  scheduler_.RegisterStream(7, 3);
+  scheduler_.RegisterStream(9, kV3HighestPriority);
+
+  // Nothing else is ready; no stream yields.
+  EXPECT_FALSE(scheduler_.ShouldYield(5));
+
+  // A ready stream of the same priority makes later streams yield, but the
+  // stream at the front of its bucket does not yield to itself.
+  scheduler_.MarkStreamReady(5, false);
+  EXPECT_FALSE(scheduler_.ShouldYield(5));
+  EXPECT_TRUE(scheduler_.ShouldYield(7));
+
+  // A ready higher-priority stream makes everything below it yield.
+  scheduler_.MarkStreamReady(9, false);
+  EXPECT_TRUE(scheduler_.ShouldYield(5));
+  EXPECT_TRUE(scheduler_.ShouldYield(7));
+  EXPECT_FALSE(scheduler_.ShouldYield(9));
+}
+
+TEST_F(QuicBucketedWriteSchedulerTest, BatchingHint) {
+  EXPECT_EQ(0u, scheduler_.NumReadyStreamsAtNextPriority());
+
+  scheduler_.RegisterStream(5, 3);
+  scheduler_.RegisterStream(7, 3);
+  scheduler_.RegisterStream(9, kV3HighestPriority);
+  scheduler_.MarkStreamReady(5, false);
+  scheduler_.MarkStreamReady(7, false);
+  EXPECT_EQ(2u, scheduler_.NumReadyStreamsAtNextPriority());
+
+  // The hint follows the highest-priority non-empty bucket.
+  scheduler_.MarkStreamReady(9, false);
+  EXPECT_EQ(1u, scheduler_.NumReadyStreamsAtNextPriority());
+  EXPECT_EQ(9u, PopFront());
+  EXPECT_EQ(2u, scheduler_.NumReadyStreamsAtNextPriority());
+}
+
+TEST_F(QuicBucketedWriteSchedulerTest, PopReadyBatch) {
+  scheduler_.RegisterStream(5, 3);
+  scheduler_.RegisterStream(7, 3);
+  scheduler_.RegisterStream(9, 3);
+  scheduler_.RegisterStream(11, kV3LowestPriority);
+  scheduler_.MarkStreamReady(5, false);
+  scheduler_.MarkStreamReady(7, false);
+  scheduler_.MarkStreamReady(9, false);
+  scheduler_.MarkStreamReady(11, false);
+
+  // A batch drains only the highest-priority bucket, in FIFO order, and is
+  // capped at the requested size.
+  std::vector<QuicStreamId> batch;
+  SpdyPriority priority = kV3HighestPriority;
+  EXPECT_EQ(2u, scheduler_.PopReadyBatch(2, &batch, &priority));
+  EXPECT_EQ(std::vector<QuicStreamId>({5, 7}), batch);
+  EXPECT_EQ(3, priority);
+
+  batch.clear();
+  EXPECT_EQ(1u, scheduler_.PopReadyBatch(5, &batch, &priority));
+  EXPECT_EQ(std::vector<QuicStreamId>({9}), batch);
+  EXPECT_EQ(3, priority);
+
+  batch.clear();
+  EXPECT_EQ(1u, scheduler_.PopReadyBatch(5, &batch, &priority));
+  EXPECT_EQ(std::vector<QuicStreamId>({11}), batch);
+  EXPECT_EQ(kV3LowestPriority, priority);
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+
+  batch.clear();
+  EXPECT_EQ(0u, scheduler_.PopReadyBatch(5, &batch, &priority));
+  EXPECT_TRUE(batch.empty());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -8,4 +8,16 @@ namespace net {
 
 QuicBufferAllocator::~QuicBufferAllocator() = default;
 
+size_t QuicBufferAllocator::BytesReserved() const {
+  return 0;
+}
+
+size_t QuicBufferAllocator::BytesInUse() const {
+  return 0;
+}
+
+uint64_t QuicBufferAllocator::NumAllocations() const {
+  return 0;
+}
+
 }  // namespace net
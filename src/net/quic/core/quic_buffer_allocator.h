@@ -6,6 +6,7 @@
 #define NET_QUIC_CORE_QUIC_BUFFER_ALLOCATOR_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "net/quic/platform/api/quic_export.h"
 
@@ -27,6 +28,20 @@ class QUIC_EXPORT_PRIVATE QuicBufferAllocator {
   // Releases a buffer.
   virtual void Delete(char* buffer) = 0;
 
+  // Returns the total payload bytes of all buffers this allocator is holding
+  // on to, whether free or handed out. Allocators which do not retain freed
+  // buffers return 0.
+  virtual size_t BytesReserved() const;
+
+  // Returns the payload bytes currently handed out and not yet released.
+  // Allocators which do not track occupancy return 0.
+  virtual size_t BytesInUse() const;
+
+  // Returns the number of buffers handed out over the allocator's lifetime.
+  // Monotonically increasing, so callers can attribute allocations to a
+  // window of work by differencing. Allocators which do not count return 0.
+  virtual uint64_t NumAllocations() const;
+
   // Marks the allocator as being idle. Serves as a hint to notify the allocator
   // that it should release any resources it's still holding on to.
   virtual void MarkAllocatorIdle() {}
@@ -6,6 +6,7 @@
 
 #include "net/quic/platform/api/quic_bug_tracker.h"
 #include "net/quic/platform/api/quic_flags.h"
+#include "net/quic/platform/api/quic_logging.h"
 #include "net/quic/platform/api/quic_map_util.h"
 
 namespace net {
@@ -82,6 +83,17 @@ EnqueuePacketResult QuicBufferedPacketStore::EnqueuePacket(
     QuicSocketAddress client_address,
     bool is_chlo,
     const std::string& alpn) {
+  BufferedPacket new_entry(std::unique_ptr<QuicReceivedPacket>(packet.Clone()),
+                           server_address, client_address);
+  return EnqueuePacketInner(connection_id, std::move(new_entry), is_chlo,
+                            alpn);
+}
+
+EnqueuePacketResult QuicBufferedPacketStore::EnqueuePacketInner(
+    QuicConnectionId connection_id,
+    BufferedPacket new_entry,
+    bool is_chlo,
+    const std::string& alpn) {
   QUIC_BUG_IF(!FLAGS_quic_allow_chlo_buffering)
       << "Shouldn't buffer packets if disabled via flag.";
   QUIC_BUG_IF(is_chlo && QuicContainsKey(connections_with_chlo_, connection_id))
@@ -122,8 +134,6 @@ EnqueuePacketResult QuicBufferedPacketStore::EnqueuePacket(
     queue.creation_time = clock_->ApproximateNow();
   }
 
-  BufferedPacket new_entry(std::unique_ptr<QuicReceivedPacket>(packet.Clone()),
-                           server_address, client_address);
   if (is_chlo) {
     // Add CHLO to the beginning of buffered packets so that it can be delivered
     // first later.
@@ -138,6 +148,33 @@ EnqueuePacketResult QuicBufferedPacketStore::EnqueuePacket(
   return SUCCESS;
 }
 
+void QuicBufferedPacketStore::EnqueuePacketFromOtherThread(
+    QuicConnectionId connection_id,
+    std::unique_ptr<QuicReceivedPacket> packet,
+    QuicSocketAddress server_address,
+    QuicSocketAddress client_address,
+    bool is_chlo,
+    const std::string& alpn) {
+  std::unique_ptr<HandedOffPacket> handoff(new HandedOffPacket{
+      connection_id,
+      BufferedPacket(std::move(packet), server_address, client_address),
+      is_chlo, alpn});
+  handoff_queue_.Push(std::move(handoff));
+}
+
+void QuicBufferedPacketStore::DrainPacketsHandedOff() {
+  std::unique_ptr<HandedOffPacket> handoff;
+  while (handoff_queue_.Pop(&handoff)) {
+    EnqueuePacketResult result =
+        EnqueuePacketInner(handoff->connection_id, std::move(handoff->packet),
+                           handoff->is_chlo, handoff->alpn);
+    if (result != SUCCESS) {
+      QUIC_DLOG(INFO) << "Dropping handed-off packet for connection "
+                      << handoff->connection_id << ": " << result;
+    }
+  }
+}
+
 bool QuicBufferedPacketStore::HasBufferedPackets(
     QuicConnectionId connection_id) const {
   return QuicContainsKey(undecryptable_packets_, connection_id);
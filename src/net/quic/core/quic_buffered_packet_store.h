@@ -9,6 +9,7 @@
 
 #include "net/quic/core/quic_alarm.h"
 #include "net/quic/core/quic_alarm_factory.h"
+#include "net/quic/core/quic_mpsc_queue.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_time.h"
 #include "net/quic/platform/api/quic_clock.h"
@@ -92,7 +93,8 @@ class QUIC_EXPORT_PRIVATE QuicBufferedPacketStore {
 
   QuicBufferedPacketStore& operator=(const QuicBufferedPacketStore&) = delete;
 
-  // Adds a copy of packet into packet queue for given connection.
+  // Adds a copy of packet (a shared reference to its buffer, when the packet
+  // is backed by a pooled buffer) into packet queue for given connection.
   EnqueuePacketResult EnqueuePacket(QuicConnectionId connection_id,
                                     const QuicReceivedPacket& packet,
                                     QuicSocketAddress server_address,
@@ -100,6 +102,25 @@ class QUIC_EXPORT_PRIVATE QuicBufferedPacketStore {
                                     bool is_chlo,
                                     const std::string& alpn);
 
+  // Hands a packet to the store from a thread other than the dispatcher
+  // thread (e.g. a crypto worker finishing async CHLO validation), without
+  // taking any lock. |packet| must own its buffer. The packet becomes
+  // visible to DeliverPackets()/DeliverPacketsForNextConnection() once the
+  // dispatcher thread calls DrainPacketsHandedOff().
+  void EnqueuePacketFromOtherThread(
+      QuicConnectionId connection_id,
+      std::unique_ptr<QuicReceivedPacket> packet,
+      QuicSocketAddress server_address,
+      QuicSocketAddress client_address,
+      bool is_chlo,
+      const std::string& alpn);
+
+  // Runs the normal enqueue logic for every packet handed off via
+  // EnqueuePacketFromOtherThread. Must be called on the dispatcher thread;
+  // packets rejected by the store's limits are dropped, as they would have
+  // been on the synchronous path.
+  void DrainPacketsHandedOff();
+
   // Returns true if there are any packets buffered for |connection_id|.
   bool HasBufferedPackets(QuicConnectionId connection_id) const;
 
@@ -135,6 +156,12 @@ class QUIC_EXPORT_PRIVATE QuicBufferedPacketStore {
  private:
   friend class test::QuicBufferedPacketStorePeer;
 
+  // Shared insertion logic for the synchronous and handed-off enqueue paths.
+  EnqueuePacketResult EnqueuePacketInner(QuicConnectionId connection_id,
+                                         BufferedPacket new_entry,
+                                         bool is_chlo,
+                                         const std::string& alpn);
+
   // Set expiration alarm if it hasn't been set.
   void MaybeSetExpirationAlarm();
 
@@ -159,6 +186,19 @@ class QUIC_EXPORT_PRIVATE QuicBufferedPacketStore {
   // Keeps track of connection with CHLO buffered up already and the order they
   // arrive.
   QuicLinkedHashMap<QuicConnectionId, bool> connections_with_chlo_;
+
+  // A packet handed off from another thread, pending insertion into the
+  // store on the dispatcher thread.
+  struct HandedOffPacket {
+    QuicConnectionId connection_id;
+    BufferedPacket packet;
+    bool is_chlo;
+    std::string alpn;
+  };
+
+  // Lock-free cross-thread handoff queue; drained by
+  // DrainPacketsHandedOff() on the dispatcher thread.
+  QuicMpscQueue<std::unique_ptr<HandedOffPacket>> handoff_queue_;
 };
 
 }  // namespace net
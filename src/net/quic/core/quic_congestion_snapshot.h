@@ -0,0 +1,105 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_CONGESTION_SNAPSHOT_H_
+#define NET_QUIC_CORE_QUIC_CONGESTION_SNAPSHOT_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "base/macros.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// The summary of congestion control state a sender needs between acks. All
+// fields are plain integers so a snapshot can be copied without invoking
+// any QUIC types on the reader side.
+struct QUIC_EXPORT_PRIVATE QuicCongestionSnapshot {
+  // Congestion window in bytes.
+  uint64_t congestion_window;
+  // Current pacing rate in bits per second.
+  int64_t pacing_rate_bps;
+  // Bytes considered in flight when the snapshot was taken.
+  uint64_t bytes_in_flight;
+  // Total packets declared lost over the lifetime of the connection.
+  uint64_t packets_lost;
+  // Smoothed RTT in microseconds, 0 before the first RTT sample.
+  int64_t smoothed_rtt_us;
+};
+
+// A single-slot, lock-free exchange of congestion control state between the
+// ack-processing side of a connection and its send side. The writer (the
+// thread running ack and loss processing) republishes the slot after every
+// congestion event; readers copy the latest snapshot without blocking the
+// writer. This is the hand-off point a split-mode connection uses to run
+// serialization on a different core than ack processing: the send side polls
+// version() each iteration and refreshes its view of (cwnd, pacing rate,
+// losses) only when it has changed.
+//
+// The slot is guarded by a sequence number in the style of a seqlock, like
+// QuicCongestionTelemetryRing: a reader racing the writer observes a torn
+// sequence and retries, so a successful Read always returns a consistent
+// snapshot.
+class QUIC_EXPORT_PRIVATE QuicCongestionSnapshotSlot {
+ public:
+  QuicCongestionSnapshotSlot() : sequence_(0) {
+    snapshot_.congestion_window = 0;
+    snapshot_.pacing_rate_bps = 0;
+    snapshot_.bytes_in_flight = 0;
+    snapshot_.packets_lost = 0;
+    snapshot_.smoothed_rtt_us = 0;
+  }
+
+  // Replaces the published snapshot. Must only be called from the writer
+  // thread.
+  void Publish(const QuicCongestionSnapshot& snapshot) {
+    const uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+    // Mark the slot busy (odd) before touching the payload, and stable
+    // (even) only after the payload is fully written.
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    snapshot_ = snapshot;
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // Copies the latest published snapshot into |*snapshot|. Returns false
+  // before the first Publish. Safe to call from any thread; retries
+  // internally if a Publish races the copy.
+  bool Read(QuicCongestionSnapshot* snapshot) const {
+    while (true) {
+      const uint64_t sequence_before =
+          sequence_.load(std::memory_order_acquire);
+      if (sequence_before == 0) {
+        return false;
+      }
+      if (sequence_before % 2 != 0) {
+        // A Publish is in progress; its trailing store is imminent.
+        continue;
+      }
+      *snapshot = snapshot_;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence_before) {
+        return true;
+      }
+    }
+  }
+
+  // Number of Publish calls so far. A reader that remembers the version of
+  // its last successful Read can skip the copy when nothing has changed.
+  uint64_t version() const {
+    return sequence_.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  // 2 * n after the n-th Publish completes, odd while one is in progress.
+  std::atomic<uint64_t> sequence_;
+  QuicCongestionSnapshot snapshot_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicCongestionSnapshotSlot);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_CONGESTION_SNAPSHOT_H_
@@ -0,0 +1,50 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_congestion_snapshot.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+QuicCongestionSnapshot MakeSnapshot(uint64_t n) {
+  QuicCongestionSnapshot snapshot;
+  snapshot.congestion_window = 100 * n;
+  snapshot.pacing_rate_bps = 1000 * n;
+  snapshot.bytes_in_flight = 10 * n;
+  snapshot.packets_lost = n / 10;
+  snapshot.smoothed_rtt_us = 25000;
+  return snapshot;
+}
+
+TEST(QuicCongestionSnapshotSlotTest, ReadBeforePublishReturnsFalse) {
+  QuicCongestionSnapshotSlot slot;
+  QuicCongestionSnapshot snapshot;
+  EXPECT_EQ(0u, slot.version());
+  EXPECT_FALSE(slot.Read(&snapshot));
+}
+
+TEST(QuicCongestionSnapshotSlotTest, ReadReturnsLatestPublish) {
+  QuicCongestionSnapshotSlot slot;
+  slot.Publish(MakeSnapshot(1));
+  slot.Publish(MakeSnapshot(2));
+
+  QuicCongestionSnapshot snapshot;
+  ASSERT_TRUE(slot.Read(&snapshot));
+  EXPECT_EQ(200u, snapshot.congestion_window);
+  EXPECT_EQ(2000, snapshot.pacing_rate_bps);
+  EXPECT_EQ(20u, snapshot.bytes_in_flight);
+}
+
+TEST(QuicCongestionSnapshotSlotTest, VersionCountsPublishes) {
+  QuicCongestionSnapshotSlot slot;
+  for (uint64_t i = 1; i <= 5; ++i) {
+    slot.Publish(MakeSnapshot(i));
+    EXPECT_EQ(i, slot.version());
+  }
+}
+
+}  // namespace
+}  // namespace net
@@ -0,0 +1,109 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_CONGESTION_TELEMETRY_RING_H_
+#define NET_QUIC_CORE_QUIC_CONGESTION_TELEMETRY_RING_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "base/macros.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// One congestion control sample, recorded per processed ack frame. All
+// fields are plain integers so a slot can be copied without invoking any
+// QUIC types on the reader side.
+struct QUIC_EXPORT_PRIVATE CongestionTelemetrySample {
+  // Time the ack was received, in microseconds since the epoch of the
+  // connection's clock.
+  int64_t ack_time_us;
+  // Congestion window in bytes.
+  uint64_t congestion_window;
+  // Current pacing rate in bits per second.
+  int64_t pacing_rate_bps;
+  // Current bandwidth estimate in bits per second.
+  int64_t bandwidth_estimate_bps;
+  // Minimum RTT in microseconds.
+  int64_t min_rtt_us;
+  // Total packets declared lost over the lifetime of the connection.
+  uint64_t packets_lost;
+};
+
+// A fixed-size time series of congestion control state with a single writer
+// (the connection thread) and any number of concurrent readers. Recording a
+// sample is a handful of stores and never blocks; readers never block the
+// writer. Each slot is guarded by a per-slot sequence number in the style of
+// a seqlock: a reader that races with the writer observes a sequence mismatch
+// and simply skips the sample, so torn reads are detected rather than
+// prevented.
+//
+// Readers poll sample_count() and fetch samples by their monotonic index;
+// samples older than kCapacity acks are overwritten and become unreadable.
+class QUIC_EXPORT_PRIVATE QuicCongestionTelemetryRing {
+ public:
+  // Number of samples retained. At ack granularity this covers several
+  // seconds of history for a sampler polling at 100ms.
+  static const uint64_t kCapacity = 256;
+
+  QuicCongestionTelemetryRing() : sample_count_(0) {
+    for (uint64_t i = 0; i < kCapacity; ++i) {
+      slots_[i].sequence.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // Appends |sample| to the ring, overwriting the sample kCapacity acks ago.
+  // Must only be called from the writer thread.
+  void Record(const CongestionTelemetrySample& sample) {
+    const uint64_t count = sample_count_.load(std::memory_order_relaxed);
+    Slot* slot = &slots_[count % kCapacity];
+    // Mark the slot busy (odd) before touching the payload, and stable
+    // (even) only after the payload is fully written.
+    slot->sequence.store(2 * count + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->sample = sample;
+    slot->sequence.store(2 * count + 2, std::memory_order_release);
+    sample_count_.store(count + 1, std::memory_order_release);
+  }
+
+  // Copies sample number |index| (zero-based, monotonic) into |*sample|.
+  // Returns false if the sample has been overwritten, is not yet recorded,
+  // or is being written concurrently. Safe to call from any thread.
+  bool ReadSample(uint64_t index, CongestionTelemetrySample* sample) const {
+    const Slot* slot = &slots_[index % kCapacity];
+    const uint64_t sequence_before =
+        slot->sequence.load(std::memory_order_acquire);
+    if (sequence_before != 2 * index + 2) {
+      return false;
+    }
+    *sample = slot->sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot->sequence.load(std::memory_order_relaxed) == sequence_before;
+  }
+
+  // Total number of samples recorded so far. The readable window is
+  // [max(0, sample_count() - kCapacity), sample_count()).
+  uint64_t sample_count() const {
+    return sample_count_.load(std::memory_order_acquire);
+  }
+
+ private:
+  struct Slot {
+    // 2 * n + 1 while sample number n is being written, 2 * n + 2 once it
+    // is stable, 0 if the slot has never been written.
+    std::atomic<uint64_t> sequence;
+    CongestionTelemetrySample sample;
+  };
+
+  Slot slots_[kCapacity];
+  // Number of completed Record calls; written after the slot it refers to.
+  std::atomic<uint64_t> sample_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicCongestionTelemetryRing);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_CONGESTION_TELEMETRY_RING_H_
@@ -0,0 +1,64 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_congestion_telemetry_ring.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+CongestionTelemetrySample MakeSample(uint64_t n) {
+  CongestionTelemetrySample sample;
+  sample.ack_time_us = n;
+  sample.congestion_window = 100 * n;
+  sample.pacing_rate_bps = 1000 * n;
+  sample.bandwidth_estimate_bps = 2000 * n;
+  sample.min_rtt_us = 25000;
+  sample.packets_lost = n / 10;
+  return sample;
+}
+
+TEST(QuicCongestionTelemetryRingTest, ReadBeforeRecordReturnsFalse) {
+  QuicCongestionTelemetryRing ring;
+  CongestionTelemetrySample sample;
+  EXPECT_EQ(0u, ring.sample_count());
+  EXPECT_FALSE(ring.ReadSample(0, &sample));
+}
+
+TEST(QuicCongestionTelemetryRingTest, RecordAndReadBack) {
+  QuicCongestionTelemetryRing ring;
+  for (uint64_t i = 0; i < 10; ++i) {
+    ring.Record(MakeSample(i));
+  }
+  EXPECT_EQ(10u, ring.sample_count());
+  for (uint64_t i = 0; i < 10; ++i) {
+    CongestionTelemetrySample sample;
+    ASSERT_TRUE(ring.ReadSample(i, &sample));
+    EXPECT_EQ(static_cast<int64_t>(i), sample.ack_time_us);
+    EXPECT_EQ(100 * i, sample.congestion_window);
+  }
+}
+
+TEST(QuicCongestionTelemetryRingTest, OverwrittenSamplesBecomeUnreadable) {
+  QuicCongestionTelemetryRing ring;
+  const uint64_t kTotal = QuicCongestionTelemetryRing::kCapacity + 5;
+  for (uint64_t i = 0; i < kTotal; ++i) {
+    ring.Record(MakeSample(i));
+  }
+  EXPECT_EQ(kTotal, ring.sample_count());
+  CongestionTelemetrySample sample;
+  // The first five samples were overwritten by the wrap-around.
+  for (uint64_t i = 0; i < 5; ++i) {
+    EXPECT_FALSE(ring.ReadSample(i, &sample));
+  }
+  // The rest of the window is intact.
+  for (uint64_t i = 5; i < kTotal; ++i) {
+    ASSERT_TRUE(ring.ReadSample(i, &sample));
+    EXPECT_EQ(static_cast<int64_t>(i), sample.ack_time_us);
+  }
+}
+
+}  // namespace
+}  // namespace net
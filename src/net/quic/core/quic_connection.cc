@@ -24,10 +24,14 @@
 #include "net/quic/core/proto/cached_network_parameters.pb.h"
 #include "net/quic/core/quic_bandwidth.h"
 #include "net/quic/core/quic_config.h"
+#include "net/quic/core/quic_fec_datagram.h"
+#include "net/quic/core/quic_fec_group.h"
 #include "net/quic/core/quic_packet_generator.h"
 #include "net/quic/core/quic_pending_retransmission.h"
+#include "net/quic/core/quic_trace_ring.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/quic/platform/api/quic_cpu_cycle_count.h"
 #include "net/quic/platform/api/quic_flag_utils.h"
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
@@ -55,6 +59,27 @@ const QuicPacketCount kMaxPacketsReceivedBeforeAckSend = 20;
 // Maximum number of consecutive sent nonretransmittable packets.
 const QuicPacketCount kMaxConsecutiveNonRetransmittablePackets = 19;
 
+// Maximum number of XOR FEC receive groups tracked per connection. Each group
+// holds up to kMaxPacketSize of parity state; the oldest group is dropped
+// when the limit is reached.
+const size_t kMaxFecReceiveGroups = 16;
+
+// Bucket width used to quantize idle-timeout and keepalive deadlines once
+// the handshake has completed, when
+// FLAGS_quic_reloadable_flag_quic_coarse_idle_timeout is true. Quantized
+// deadlines from different connections collapse into shared alarm slots, so
+// a large fleet of idle connections arms a handful of distinct alarms
+// instead of one each.
+const int64_t kCoarseDeadlineGranularityUs = 1000 * 1000;  // 1 second.
+
+// Rounds |time| up to the next multiple of |granularity_us| microseconds.
+QuicTime RoundUpToGranularity(QuicTime time, int64_t granularity_us) {
+  int64_t time_us = (time - QuicTime::Zero()).ToMicroseconds();
+  time_us =
+      ((time_us + granularity_us - 1) / granularity_us) * granularity_us;
+  return QuicTime::Zero() + QuicTime::Delta::FromMicroseconds(time_us);
+}
+
 // Maximum number of retransmittable packets received before sending an ack.
 const QuicPacketCount kDefaultRetransmittablePacketsBeforeAck = 2;
 // Minimum number of packets received before ack decimation is enabled.
@@ -63,11 +88,26 @@ const QuicPacketCount kDefaultRetransmittablePacketsBeforeAck = 2;
 const QuicPacketCount kMinReceivedBeforeAckDecimation = 100;
 // Wait for up to 10 retransmittable packets before sending an ack.
 const QuicPacketCount kMaxRetransmittablePacketsBeforeAck = 10;
+// With dynamic ack decimation, the number of acks per second the decimation
+// threshold is scaled towards, and the largest threshold allowed.  The
+// threshold never drops below kMaxRetransmittablePacketsBeforeAck, so dynamic
+// decimation acks at most as often as regular decimation.
+const QuicPacketCount kDynamicAckDecimationTargetAcksPerSecond = 1000;
+const QuicPacketCount kMaxRetransmittablePacketsBeforeDynamicAck = 100;
 // One quarter RTT delay when doing ack decimation.
 const float kAckDecimationDelay = 0.25;
 // One eighth RTT delay when doing ack decimation.
 const float kShortAckDecimationDelay = 0.125;
 
+// Coalesced window updates wait at most a quarter RTT for an outgoing packet
+// to carry them before being flushed by the window update alarm.
+const int64_t kCoalescedWindowUpdateRttDivisor = 4;
+
+// When pacing is offloaded to the kernel, how far into the future a packet
+// may be stamped with a release time. Pacing gaps beyond this still fall
+// back to the send alarm, bounding how much data sits queued in the kernel.
+const int64_t kMaxPacingOffloadDelayMs = 10;
+
 // Error code used in WriteResult to indicate that the packet writer rejected
 // the message as being too big.
 const int kMessageTooBigErrorCode = ERR_MSG_TOO_BIG;
@@ -165,6 +205,61 @@ class MtuDiscoveryAlarmDelegate : public QuicAlarm::Delegate {
   DISALLOW_COPY_AND_ASSIGN(MtuDiscoveryAlarmDelegate);
 };
 
+// An alarm that fires when coalesced window updates have waited long enough
+// for an outgoing packet to carry them and must be flushed on their own.
+class WindowUpdateAlarmDelegate : public QuicAlarm::Delegate {
+ public:
+  explicit WindowUpdateAlarmDelegate(QuicConnection* connection)
+      : connection_(connection) {}
+
+  void OnAlarm() override { connection_->FlushPendingWindowUpdates(); }
+
+ private:
+  QuicConnection* connection_;
+
+  DISALLOW_COPY_AND_ASSIGN(WindowUpdateAlarmDelegate);
+};
+
+// Accumulates the cycles spent and buffers allocated between construction
+// and destruction into per-connection counters. Two cycle counter reads and
+// two allocator counter reads per scope. |depth| guards against reentrant
+// scopes (OnCanWrite triggered while processing a packet): cycles are
+// charged to every enclosing scope's sink, but the allocation delta is only
+// accumulated by the outermost scope so the counter stays exact.
+class ScopedCpuAccountant {
+ public:
+  ScopedCpuAccountant(uint64_t* cycles_sink,
+                      uint64_t* allocations_sink,
+                      QuicBufferAllocator* allocator,
+                      int* depth)
+      : cycles_sink_(cycles_sink),
+        allocations_sink_(allocations_sink),
+        allocator_(allocator),
+        depth_(depth),
+        outermost_((*depth)++ == 0),
+        start_cycles_(QuicCpuCycleCount()),
+        start_allocations_(allocator->NumAllocations()) {}
+
+  ~ScopedCpuAccountant() {
+    *cycles_sink_ += QuicCpuCycleCount() - start_cycles_;
+    if (outermost_) {
+      *allocations_sink_ += allocator_->NumAllocations() - start_allocations_;
+    }
+    --(*depth_);
+  }
+
+ private:
+  uint64_t* cycles_sink_;
+  uint64_t* allocations_sink_;
+  QuicBufferAllocator* allocator_;
+  int* depth_;
+  const bool outermost_;
+  const uint64_t start_cycles_;
+  const uint64_t start_allocations_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedCpuAccountant);
+};
+
 }  // namespace
 
 #define ENDPOINT \
@@ -186,6 +281,9 @@ QuicConnection::QuicConnection(QuicConnectionId connection_id,
       per_packet_options_(nullptr),
       writer_(writer),
       owns_writer_(owns_writer),
+      supports_release_time_(
+          FLAGS_quic_reloadable_flag_quic_pacing_offload && writer != nullptr &&
+          writer->SupportsReleaseTime()),
       encryption_level_(ENCRYPTION_NONE),
       clock_(helper->GetClock()),
       random_generator_(helper->GetRandomGenerator()),
@@ -195,6 +293,7 @@ QuicConnection::QuicConnection(QuicConnectionId connection_id,
       highest_packet_sent_before_peer_migration_(0),
       last_packet_decrypted_(false),
       last_size_(0),
+      last_ecn_codepoint_(ECN_NOT_ECT),
       current_packet_data_(nullptr),
       last_decrypted_packet_level_(ENCRYPTION_NONE),
       should_last_packet_instigate_acks_(false),
@@ -202,6 +301,8 @@ QuicConnection::QuicConnection(QuicConnectionId connection_id,
       largest_seen_packet_with_ack_(0),
       largest_seen_packet_with_stop_waiting_(0),
       max_undecryptable_packets_(0),
+      fec_enabled_(false),
+      fec_send_group_index_(0),
       pending_version_negotiation_packet_(false),
       save_crypto_packets_as_termination_packets_(false),
       idle_timeout_connection_close_behavior_(
@@ -217,6 +318,7 @@ QuicConnection::QuicConnection(QuicConnectionId connection_id,
       ack_mode_(TCP_ACKING),
       ack_decimation_delay_(kAckDecimationDelay),
       unlimited_ack_decimation_(false),
+      dynamic_ack_decimation_(false),
       delay_setting_retransmission_alarm_(false),
       pending_retransmission_alarm_(false),
       defer_send_in_response_to_packets_(false),
@@ -224,6 +326,8 @@ QuicConnection::QuicConnection(QuicConnectionId connection_id,
       arena_(),
       ack_alarm_(alarm_factory_->CreateAlarm(arena_.New<AckAlarmDelegate>(this),
                                              &arena_)),
+      ack_scheduler_(nullptr),
+      batched_ack_deadline_(QuicTime::Zero()),
       retransmission_alarm_(alarm_factory_->CreateAlarm(
           arena_.New<RetransmissionAlarmDelegate>(this),
           &arena_)),
@@ -242,6 +346,9 @@ QuicConnection::QuicConnection(QuicConnectionId connection_id,
       mtu_discovery_alarm_(alarm_factory_->CreateAlarm(
           arena_.New<MtuDiscoveryAlarmDelegate>(this),
           &arena_)),
+      window_update_alarm_(alarm_factory_->CreateAlarm(
+          arena_.New<WindowUpdateAlarmDelegate>(this),
+          &arena_)),
       visitor_(nullptr),
       debug_visitor_(nullptr),
       packet_generator_(connection_id_,
@@ -251,6 +358,8 @@ QuicConnection::QuicConnection(QuicConnectionId connection_id,
                         this),
       idle_network_timeout_(QuicTime::Delta::Infinite()),
       handshake_timeout_(QuicTime::Delta::Infinite()),
+      cpu_accounting_depth_(0),
+      burst_packets_remaining_(0),
       time_of_last_received_packet_(clock_->ApproximateNow()),
       time_of_last_sent_new_packet_(clock_->ApproximateNow()),
       last_send_for_timeout_(clock_->ApproximateNow()),
@@ -268,6 +377,9 @@ QuicConnection::QuicConnection(QuicConnectionId connection_id,
       mtu_probe_count_(0),
       packets_between_mtu_probes_(kPacketsBetweenMtuProbesBase),
       next_mtu_probe_at_(kPacketsBetweenMtuProbesBase),
+      mtu_binary_search_(false),
+      last_mtu_probe_size_(0),
+      pre_discovery_mtu_(0),
       largest_received_packet_size_(0),
       goaway_sent_(false),
       goaway_received_(false),
@@ -338,6 +450,13 @@ void QuicConnection::SetFromConfig(const QuicConfig& config) {
   if (config.HasClientSentConnectionOption(kMTUL, perspective_)) {
     SetMtuDiscoveryTarget(kMtuDiscoveryTargetPacketSizeLow);
   }
+  if (config.HasClientSentConnectionOption(kMTUB, perspective_)) {
+    // Binary-search the whole window the writer permits, rather than probing
+    // a fixed target.
+    mtu_binary_search_ = true;
+    pre_discovery_mtu_ = max_packet_length();
+    SetMtuDiscoveryTarget(kMaxPacketSize);
+  }
   if (debug_visitor_ != nullptr) {
     debug_visitor_->OnSetFromConfig(config);
   }
@@ -360,6 +479,10 @@ void QuicConnection::SetFromConfig(const QuicConfig& config) {
     if (config.HasClientSentConnectionOption(kAKDU, perspective_)) {
       unlimited_ack_decimation_ = true;
     }
+    if (config.HasClientSentConnectionOption(kAKDR, perspective_)) {
+      ack_mode_ = ACK_DECIMATION_WITH_REORDERING;
+      dynamic_ack_decimation_ = true;
+    }
   }
   if (config.HasClientSentConnectionOption(k5RTO, perspective_)) {
     close_connection_after_five_rtos_ = true;
@@ -375,6 +498,11 @@ void QuicConnection::SetFromConfig(const QuicConfig& config) {
     QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_no_stop_waiting_frames, 2, 2);
     no_stop_waiting_frames_ = true;
   }
+  if (FLAGS_quic_reloadable_flag_quic_enable_xor_fec &&
+      config.HasClientRequestedIndependentOption(kXFEC, perspective_)) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_enable_xor_fec);
+    fec_enabled_ = true;
+  }
 }
 
 void QuicConnection::OnSendConnectionState(
@@ -656,6 +784,7 @@ bool QuicConnection::OnPacketHeader(const QuicPacketHeader& header) {
 
   --stats_.packets_dropped;
   QUIC_DVLOG(1) << ENDPOINT << "Received packet header: " << header;
+  QUIC_TRACE_PACKET_IN(header.packet_number, last_size_);
   last_header_ = header;
   // An ack will be sent if a missing retransmittable packet was received;
   was_last_packet_missing_ =
@@ -665,6 +794,10 @@ bool QuicConnection::OnPacketHeader(const QuicPacketHeader& header) {
   // frames, since the processing may result in sending a bundled ack.
   received_packet_manager_.RecordPacketReceived(last_header_,
                                                 time_of_last_received_packet_);
+  if (FLAGS_quic_reloadable_flag_quic_ack_ecn_counts &&
+      last_ecn_codepoint_ == ECN_CE) {
+    received_packet_manager_.RecordCeMarkedPacket();
+  }
   DCHECK(connected_);
   return true;
 }
@@ -674,8 +807,8 @@ bool QuicConnection::OnStreamFrame(const QuicStreamFrame& frame) {
   if (debug_visitor_ != nullptr) {
     debug_visitor_->OnStreamFrame(frame);
   }
-  if (frame.stream_id != kCryptoStreamId &&
-      last_decrypted_packet_level_ == ENCRYPTION_NONE) {
+  if (QUIC_PREDICT_FALSE(frame.stream_id != kCryptoStreamId &&
+                         last_decrypted_packet_level_ == ENCRYPTION_NONE)) {
     if (MaybeConsiderAsMemoryCorruption(frame)) {
       CloseConnection(QUIC_MAYBE_CORRUPTED_MEMORY,
                       "Received crypto frame on non crypto stream.",
@@ -713,7 +846,7 @@ bool QuicConnection::OnAckFrame(const QuicAckFrame& incoming_ack) {
   }
 
   const char* error = ValidateAckFrame(incoming_ack);
-  if (error != nullptr) {
+  if (QUIC_PREDICT_FALSE(error != nullptr)) {
     CloseConnection(QUIC_INVALID_ACK_DATA, error,
                     ConnectionCloseBehavior::SEND_CONNECTION_CLOSE_PACKET);
     return false;
@@ -723,6 +856,10 @@ bool QuicConnection::OnAckFrame(const QuicAckFrame& incoming_ack) {
     send_alarm_->Cancel();
   }
   largest_seen_packet_with_ack_ = last_header_.packet_number;
+  QUIC_TRACE_ACK_PROCESSED(incoming_ack.largest_observed,
+                           incoming_ack.ack_delay_time.ToMicroseconds());
+  // The ack may change the pacer's answer; drop any remaining allowance.
+  burst_packets_remaining_ = 0;
   sent_packet_manager_.OnIncomingAck(incoming_ack,
                                      time_of_last_received_packet_);
   if (no_stop_waiting_frames_) {
@@ -977,24 +1114,36 @@ void QuicConnection::MaybeQueueAck(bool was_missing) {
     if (ack_mode_ != TCP_ACKING &&
         last_header_.packet_number > kMinReceivedBeforeAckDecimation) {
       // Ack up to 10 packets at once unless ack decimation is unlimited.
+      QuicPacketCount max_packets_before_ack =
+          kMaxRetransmittablePacketsBeforeAck;
+      if (dynamic_ack_decimation_) {
+        // Scale the threshold so roughly
+        // kDynamicAckDecimationTargetAcksPerSecond acks are sent per second at
+        // the current receive rate.
+        max_packets_before_ack = std::min(
+            kMaxRetransmittablePacketsBeforeDynamicAck,
+            std::max(kMaxRetransmittablePacketsBeforeAck,
+                     received_packet_manager_.receive_rate_packets_per_second() /
+                         kDynamicAckDecimationTargetAcksPerSecond));
+      }
       if (!unlimited_ack_decimation_ &&
           num_retransmittable_packets_received_since_last_ack_sent_ >=
-              kMaxRetransmittablePacketsBeforeAck) {
+              max_packets_before_ack) {
         ack_queued_ = true;
-      } else if (!ack_alarm_->IsSet()) {
+      } else if (!IsAckAlarmSet()) {
         // Wait the minimum of a quarter min_rtt and the delayed ack time.
         QuicTime::Delta ack_delay = std::min(
             DelayedAckTime(), sent_packet_manager_.GetRttStats()->min_rtt() *
                                   ack_decimation_delay_);
-        ack_alarm_->Set(clock_->ApproximateNow() + ack_delay);
+        SetAckAlarm(clock_->ApproximateNow() + ack_delay);
       }
     } else {
       // Ack with a timer or every 2 packets by default.
       if (num_retransmittable_packets_received_since_last_ack_sent_ >=
           kDefaultRetransmittablePacketsBeforeAck) {
         ack_queued_ = true;
-      } else if (!ack_alarm_->IsSet()) {
-        ack_alarm_->Set(clock_->ApproximateNow() + DelayedAckTime());
+      } else if (!IsAckAlarmSet()) {
+        SetAckAlarm(clock_->ApproximateNow() + DelayedAckTime());
       }
     }
 
@@ -1005,8 +1154,8 @@ void QuicConnection::MaybeQueueAck(bool was_missing) {
         QuicTime ack_time =
             clock_->ApproximateNow() +
             0.125 * sent_packet_manager_.GetRttStats()->min_rtt();
-        if (!ack_alarm_->IsSet() || ack_alarm_->deadline() > ack_time) {
-          ack_alarm_->Update(ack_time, QuicTime::Delta::Zero());
+        if (!IsAckAlarmSet() || AckAlarmDeadline() > ack_time) {
+          UpdateAckAlarm(ack_time);
         }
       } else {
         ack_queued_ = true;
@@ -1015,7 +1164,7 @@ void QuicConnection::MaybeQueueAck(bool was_missing) {
   }
 
   if (ack_queued_) {
-    ack_alarm_->Cancel();
+    CancelAckAlarm();
   }
 }
 
@@ -1098,6 +1247,10 @@ QuicConsumedData QuicConnection::SendStreamData(
   // SHLO from the server, leading to two different decrypters at the server.)
   ScopedRetransmissionScheduler alarm_delayer(this);
   ScopedPacketBundler ack_bundler(this, SEND_ACK_IF_PENDING);
+  // Let any coalesced window updates ride along with this data.
+  if (!pending_window_updates_.empty()) {
+    FlushPendingWindowUpdates();
+  }
   // The optimized path may be used for data only packets which fit into a
   // standard buffer and don't need padding.
   const bool flag_run_fast_path =
@@ -1152,12 +1305,47 @@ void QuicConnection::SendRstStream(QuicStreamId id,
 
 void QuicConnection::SendWindowUpdate(QuicStreamId id,
                                       QuicStreamOffset byte_offset) {
+  if (FLAGS_quic_reloadable_flag_quic_coalesce_window_updates) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_coalesce_window_updates);
+    // Accumulate the update so it can ride in the next outgoing data or ack
+    // packet; the alarm bounds the extra delay to a fraction of the rtt.
+    QuicStreamOffset& pending_offset = pending_window_updates_[id];
+    pending_offset = std::max(pending_offset, byte_offset);
+    if (!window_update_alarm_->IsSet()) {
+      const RttStats* rtt_stats = sent_packet_manager_.GetRttStats();
+      int64_t rtt_us = rtt_stats->smoothed_rtt().ToMicroseconds();
+      if (rtt_us == 0) {
+        rtt_us = rtt_stats->initial_rtt_us();
+      }
+      window_update_alarm_->Set(
+          clock_->ApproximateNow() +
+          QuicTime::Delta::FromMicroseconds(rtt_us /
+                                            kCoalescedWindowUpdateRttDivisor));
+    }
+    return;
+  }
   // Opportunistically bundle an ack with this outgoing packet.
   ScopedPacketBundler ack_bundler(this, SEND_ACK_IF_PENDING);
   packet_generator_.AddControlFrame(
       QuicFrame(new QuicWindowUpdateFrame(id, byte_offset)));
 }
 
+void QuicConnection::FlushPendingWindowUpdates() {
+  window_update_alarm_->Cancel();
+  if (pending_window_updates_.empty()) {
+    return;
+  }
+  // Opportunistically bundle an ack with the coalesced updates.  The bundler
+  // keeps the generator in batch mode, so all updates share packets with each
+  // other and with whatever the caller is about to send.
+  ScopedPacketBundler ack_bundler(this, SEND_ACK_IF_PENDING);
+  for (const auto& update : pending_window_updates_) {
+    packet_generator_.AddControlFrame(
+        QuicFrame(new QuicWindowUpdateFrame(update.first, update.second)));
+  }
+  pending_window_updates_.clear();
+}
+
 void QuicConnection::SendBlocked(QuicStreamId id) {
   // Opportunistically bundle an ack with this outgoing packet.
   ScopedPacketBundler ack_bundler(this, SEND_ACK_IF_PENDING);
@@ -1186,19 +1374,35 @@ const QuicConnectionStats& QuicConnection::GetStats() {
   stats_.estimated_bandwidth = sent_packet_manager_.BandwidthEstimate();
   stats_.max_packet_size = packet_generator_.GetCurrentMaxPacketLength();
   stats_.max_received_packet_size = largest_received_packet_size_;
+
+  // Sample the occupancy of the thread-wide buffer pool.
+  QuicBufferAllocator* send_buffer_allocator =
+      helper_->GetStreamSendBufferAllocator();
+  stats_.buffer_pool_bytes_reserved = send_buffer_allocator->BytesReserved();
+  stats_.buffer_pool_bytes_in_use = send_buffer_allocator->BytesInUse();
+
+  // Snapshot per-cipher CPU spend from the framer, which owns all seal and
+  // open calls for this connection.
+  stats_.encryption_cycles = framer_.encryption_cycles();
+  stats_.decryption_cycles = framer_.decryption_cycles();
   return stats_;
 }
 
 void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
                                       const QuicSocketAddress& peer_address,
                                       const QuicReceivedPacket& packet) {
-  if (!connected_) {
+  if (QUIC_PREDICT_FALSE(!connected_)) {
     return;
   }
+  ScopedCpuAccountant accountant(&stats_.process_packet_cycles,
+                                 &stats_.buffer_allocations,
+                                 helper_->GetStreamSendBufferAllocator(),
+                                 &cpu_accounting_depth_);
   if (debug_visitor_ != nullptr) {
     debug_visitor_->OnPacketReceived(self_address, peer_address, packet);
   }
   last_size_ = packet.length();
+  last_ecn_codepoint_ = packet.ecn_codepoint();
   current_packet_data_ = packet.data();
 
   last_packet_destination_address_ = self_address;
@@ -1214,8 +1418,9 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
   ++stats_.packets_received;
 
   // Ensure the time coming from the packet reader is within a minute of now.
-  if (std::abs((packet.receipt_time() - clock_->ApproximateNow()).ToSeconds()) >
-      60) {
+  if (QUIC_PREDICT_FALSE(
+          std::abs((packet.receipt_time() - clock_->ApproximateNow())
+                       .ToSeconds()) > 60)) {
     QUIC_BUG << "Packet receipt time:"
              << packet.receipt_time().ToDebuggingValue()
              << " too far from current time:"
@@ -1225,8 +1430,16 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
   QUIC_DVLOG(1) << ENDPOINT << "time of last received packet: "
                 << time_of_last_received_packet_.ToDebuggingValue();
 
+  if (fec_enabled_ && IsFecDatagram(packet.data(), packet.length())) {
+    // Parity datagrams are not QUIC packets; the framer would reject their
+    // marker byte as illegal public flags.
+    ProcessFecDatagram(packet);
+    current_packet_data_ = nullptr;
+    return;
+  }
+
   ScopedRetransmissionScheduler alarm_delayer(this);
-  if (!framer_.ProcessPacket(packet)) {
+  if (QUIC_PREDICT_FALSE(!framer_.ProcessPacket(packet))) {
     // If we are unable to decrypt this packet, it might be
     // because the CHLO or SHLO packet was lost.
     if (framer_.error() == QUIC_DECRYPTION_FAILURE) {
@@ -1245,6 +1458,10 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
   }
 
   ++stats_.packets_processed;
+  if (fec_enabled_) {
+    RecordReceivedPacketForFec(last_header_.packet_number,
+                               QuicStringPiece(packet.data(), last_size_));
+  }
   if (active_peer_migration_type_ != NO_CHANGE &&
       sent_packet_manager_.GetLargestObserved() >
           highest_packet_sent_before_peer_migration_) {
@@ -1258,6 +1475,10 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
 
 void QuicConnection::OnCanWrite() {
   DCHECK(!writer_->IsWriteBlocked());
+  ScopedCpuAccountant accountant(&stats_.on_can_write_cycles,
+                                 &stats_.buffer_allocations,
+                                 helper_->GetStreamSendBufferAllocator(),
+                                 &cpu_accounting_depth_);
 
   WriteQueuedPackets();
   WritePendingRetransmissions();
@@ -1461,6 +1682,21 @@ bool QuicConnection::CanWrite(HasRetransmittableData retransmittable) {
   }
 
   QuicTime now = clock_->Now();
+  if (FLAGS_quic_reloadable_flag_quic_connection_write_bursts) {
+    if (burst_packets_remaining_ > 0) {
+      // A previous consultation already cleared this packet.
+      return true;
+    }
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_connection_write_bursts);
+    const QuicPacketCount burst_size =
+        sent_packet_manager_.GetSendBurstSize(now);
+    if (burst_size > 1) {
+      burst_packets_remaining_ = burst_size;
+      return true;
+    }
+    // Fall through to the per-packet path, which computes the alarm delay
+    // when the pacer requires one.
+  }
   QuicTime::Delta delay = sent_packet_manager_.TimeUntilSend(now);
   if (delay.IsInfinite()) {
     send_alarm_->Cancel();
@@ -1469,6 +1705,13 @@ bool QuicConnection::CanWrite(HasRetransmittableData retransmittable) {
 
   // If the scheduler requires a delay, then we can not send this packet now.
   if (!delay.IsZero()) {
+    if (supports_release_time_ && per_packet_options_ != nullptr &&
+        delay <= QuicTime::Delta::FromMilliseconds(kMaxPacingOffloadDelayMs)) {
+      QUIC_FLAG_COUNT(quic_reloadable_flag_quic_pacing_offload);
+      // The kernel enforces the pacing gap: hand the packet down now with a
+      // release time instead of taking an alarm wakeup for it.
+      return true;
+    }
     send_alarm_->Update(now + delay, QuicTime::Delta::FromMilliseconds(1));
     QUIC_DVLOG(1) << ENDPOINT << "Delaying sending " << delay.ToMilliseconds()
                   << "ms";
@@ -1534,6 +1777,19 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
   // min_rtt_, especially in cases where the thread blocks or gets swapped out
   // during the WritePacket below.
   QuicTime packet_send_time = clock_->Now();
+  if (supports_release_time_ && per_packet_options_ != nullptr) {
+    const QuicTime release_time = sent_packet_manager_.GetNextReleaseTime();
+    if (release_time > packet_send_time) {
+      per_packet_options_->release_time_delay =
+          release_time - packet_send_time;
+      // Credit the pacer from the time the kernel releases the packet, not
+      // from now, so the offloaded schedule keeps advancing.
+      packet_send_time = release_time;
+    } else {
+      per_packet_options_->release_time_delay = QuicTime::Delta::Zero();
+    }
+  }
+  QUIC_TRACE_PACKET_OUT(packet_number, encrypted_length);
   WriteResult result = writer_->WritePacket(
       packet->encrypted_buffer, encrypted_length, self_address().host(),
       peer_address(), per_packet_options_);
@@ -1595,6 +1851,10 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
   QUIC_DVLOG(1) << ENDPOINT << "time we began writing last sent packet: "
                 << packet_send_time.ToDebuggingValue();
 
+  if (burst_packets_remaining_ > 0) {
+    --burst_packets_remaining_;
+  }
+
   bool reset_retransmission_alarm = sent_packet_manager_.OnPacketSent(
       packet, packet->original_packet_number, packet_send_time,
       packet->transmission_type, IsRetransmittable(*packet));
@@ -1616,6 +1876,12 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
     ++stats_.packets_retransmitted;
   }
 
+  if (fec_enabled_) {
+    MaybeSendFecParity(
+        packet_number,
+        QuicStringPiece(packet->encrypted_buffer, encrypted_length));
+  }
+
   return true;
 }
 
@@ -1733,7 +1999,7 @@ void QuicConnection::OnHandshakeComplete() {
   // complete with the server.
   if (perspective_ == Perspective::IS_CLIENT && !ack_queued_ &&
       ack_frame_updated()) {
-    ack_alarm_->Update(clock_->ApproximateNow(), QuicTime::Delta::Zero());
+    UpdateAckAlarm(clock_->ApproximateNow());
   }
 }
 
@@ -1757,10 +2023,19 @@ void QuicConnection::SendOrQueuePacket(SerializedPacket* packet) {
 
 void QuicConnection::OnPingTimeout() {
   if (!retransmission_alarm_->IsSet()) {
+    // The connection has been quiet long enough to need a ping, so it is a
+    // good moment to shed the ack state an idle connection keeps pinned.
+    CollapseAckStateForQuiescence();
     SendPing();
   }
 }
 
+void QuicConnection::OnLocalSocketOverflow() {
+  QUIC_DVLOG(1) << ENDPOINT << "Local receive queue overflowed; ignoring "
+                << "losses detected within an RTT.";
+  sent_packet_manager_.OnLocalSocketOverflow(clock_->ApproximateNow());
+}
+
 void QuicConnection::SendPing() {
   ScopedPacketBundler bundler(this, SEND_ACK_IF_QUEUED);
   packet_generator_.AddControlFrame(QuicFrame(QuicPingFrame()));
@@ -1771,14 +2046,74 @@ void QuicConnection::SendPing() {
   }
 }
 
-void QuicConnection::SendAck() {
+bool QuicConnection::IsAckAlarmSet() const {
+  if (ack_scheduler_ != nullptr) {
+    return batched_ack_deadline_.IsInitialized();
+  }
+  return ack_alarm_->IsSet();
+}
+
+QuicTime QuicConnection::AckAlarmDeadline() const {
+  if (ack_scheduler_ != nullptr) {
+    return batched_ack_deadline_;
+  }
+  return ack_alarm_->deadline();
+}
+
+void QuicConnection::SetAckAlarm(QuicTime deadline) {
+  if (ack_scheduler_ != nullptr) {
+    batched_ack_deadline_ = deadline;
+    ack_scheduler_->ScheduleAckAlarm(this, deadline);
+    return;
+  }
+  ack_alarm_->Set(deadline);
+}
+
+void QuicConnection::UpdateAckAlarm(QuicTime deadline) {
+  if (ack_scheduler_ != nullptr) {
+    batched_ack_deadline_ = deadline;
+    ack_scheduler_->ScheduleAckAlarm(this, deadline);
+    return;
+  }
+  ack_alarm_->Update(deadline, QuicTime::Delta::Zero());
+}
+
+void QuicConnection::CancelAckAlarm() {
+  if (ack_scheduler_ != nullptr) {
+    // Cancellation is lazy: the deadline is cleared here and the stale
+    // scheduler callback is ignored by OnBatchedAckAlarm.
+    batched_ack_deadline_ = QuicTime::Zero();
+    return;
+  }
   ack_alarm_->Cancel();
+}
+
+void QuicConnection::OnBatchedAckAlarm() {
+  if (!batched_ack_deadline_.IsInitialized() ||
+      batched_ack_deadline_ > clock_->ApproximateNow()) {
+    // The pending ack was sent, cancelled, or rescheduled since this deadline
+    // was registered with the scheduler.
+    return;
+  }
+  batched_ack_deadline_ = QuicTime::Zero();
+  if (!ack_frame_updated()) {
+    return;
+  }
+  ScopedPacketBundler bundler(this, SEND_ACK);
+}
+
+void QuicConnection::SendAck() {
+  CancelAckAlarm();
   ack_queued_ = false;
   stop_waiting_count_ = 0;
   num_retransmittable_packets_received_since_last_ack_sent_ = 0;
   last_ack_had_missing_packets_ = received_packet_manager_.HasMissingPackets();
   num_packets_received_since_last_ack_sent_ = 0;
 
+  // Let any coalesced window updates ride along with this ack.
+  if (!pending_window_updates_.empty()) {
+    FlushPendingWindowUpdates();
+  }
   packet_generator_.SetShouldSendAck(!no_stop_waiting_frames_);
   if (consecutive_num_packets_with_no_retransmittable_frames_ <
       kMaxConsecutiveNonRetransmittablePackets) {
@@ -1816,6 +2151,23 @@ void QuicConnection::OnRetransmissionTimeout() {
     return;
   }
 
+  // If the path stops delivering after MTU discovery raised the packet
+  // length, assume the raised size is blackholing and fall back to the
+  // size in use before discovery.  Only connections which enabled kMTUB
+  // record |pre_discovery_mtu_|.
+  if (pre_discovery_mtu_ > 0 && max_packet_length() > pre_discovery_mtu_ &&
+      sent_packet_manager_.GetConsecutiveRtoCount() >= 1) {
+    QUIC_DLOG(INFO) << ENDPOINT << "Suspected MTU blackhole at "
+                    << max_packet_length() << " bytes; reverting to "
+                    << pre_discovery_mtu_;
+    SetMaxPacketLength(pre_discovery_mtu_);
+    mtu_discovery_target_ = 0;
+    last_mtu_probe_size_ = 0;
+  }
+
+  // A timeout changes what the pacer would answer; drop any remaining
+  // burst allowance.
+  burst_packets_remaining_ = 0;
   sent_packet_manager_.OnRetransmissionTimeout();
   WriteIfNotBlocked();
 
@@ -1916,6 +2268,139 @@ void QuicConnection::MaybeProcessUndecryptablePackets() {
   }
 }
 
+void QuicConnection::MaybeSendFecParity(QuicPacketNumber packet_number,
+                                        QuicStringPiece encrypted_packet) {
+  if (packet_number == 0 ||
+      encrypted_packet.length() > std::numeric_limits<uint16_t>::max()) {
+    return;
+  }
+  const QuicPacketNumber group_index = (packet_number - 1) / kFecGroupSize;
+  if (fec_send_group_ == nullptr || group_index != fec_send_group_index_) {
+    // WritePacket only accepts ascending packet numbers, so a new group
+    // index means the previous group was already emitted or abandoned.
+    fec_send_group_.reset(new QuicFecGroup);
+    fec_send_group_index_ = group_index;
+    fec_send_packet_lengths_.clear();
+  }
+  if (!fec_send_group_->Update(packet_number, encrypted_packet)) {
+    return;  // Already recorded, e.g. a termination packet written again.
+  }
+  fec_send_packet_lengths_.push_back(encrypted_packet.length());
+  if (packet_number % kFecGroupSize != 0) {
+    return;  // Group not full yet.
+  }
+  // Only emit parity if every packet of the group was recorded, so the
+  // per-packet lengths line up with the protected packet numbers.
+  if (fec_send_packet_lengths_.size() == kFecGroupSize &&
+      !writer_->IsWriteBlocked()) {
+    QuicFecDatagram datagram;
+    datagram.connection_id = connection_id_;
+    datagram.min_protected_packet = group_index * kFecGroupSize + 1;
+    datagram.protected_packet_lengths = fec_send_packet_lengths_;
+    datagram.parity = fec_send_group_->payload_parity();
+    char buffer[kFecDatagramHeaderSize + 2 * kFecGroupSize + kMaxPacketSize];
+    const size_t length =
+        SerializeFecDatagram(datagram, buffer, sizeof(buffer));
+    if (length > 0) {
+      // Parity is best effort: it consumes no packet number, is not tracked
+      // by the sent packet manager, and a failed write is only a lost
+      // recovery opportunity.
+      WriteResult result =
+          writer_->WritePacket(buffer, length, self_address().host(),
+                               peer_address(), per_packet_options_);
+      if (result.status == WRITE_STATUS_BLOCKED) {
+        visitor_->OnWriteBlocked();
+      } else if (result.status == WRITE_STATUS_OK) {
+        ++stats_.fec_parity_sent;
+      }
+    }
+  }
+  fec_send_group_.reset();
+  fec_send_packet_lengths_.clear();
+}
+
+void QuicConnection::RecordReceivedPacketForFec(
+    QuicPacketNumber packet_number,
+    QuicStringPiece encrypted_packet) {
+  if (packet_number == 0) {
+    return;
+  }
+  const QuicPacketNumber group_index = (packet_number - 1) / kFecGroupSize;
+  std::unique_ptr<QuicFecGroup>& group = fec_receive_groups_[group_index];
+  if (group == nullptr) {
+    group.reset(new QuicFecGroup);
+  }
+  group->Update(packet_number, encrypted_packet);
+  if (group->IsFinished()) {
+    fec_receive_groups_.erase(group_index);
+    return;
+  }
+  while (fec_receive_groups_.size() > kMaxFecReceiveGroups) {
+    fec_receive_groups_.erase(fec_receive_groups_.begin());
+  }
+}
+
+void QuicConnection::ProcessFecDatagram(const QuicReceivedPacket& packet) {
+  QuicFecDatagram datagram;
+  if (!ParseFecDatagram(packet.data(), packet.length(), &datagram) ||
+      datagram.connection_id != connection_id_ ||
+      datagram.protected_packet_lengths.size() != kFecGroupSize ||
+      (datagram.min_protected_packet - 1) % kFecGroupSize != 0) {
+    QUIC_DVLOG(1) << ENDPOINT << "Dropping malformed parity datagram";
+    return;
+  }
+  const QuicPacketNumber group_index =
+      (datagram.min_protected_packet - 1) / kFecGroupSize;
+  std::unique_ptr<QuicFecGroup>& group = fec_receive_groups_[group_index];
+  if (group == nullptr) {
+    group.reset(new QuicFecGroup);
+  }
+  if (!group->UpdateFec(datagram.min_protected_packet, kFecGroupSize,
+                        datagram.parity)) {
+    return;
+  }
+  if (group->CanRevive()) {
+    const QuicPacketNumber missing = group->missing_packet_number();
+    char buffer[kMaxPacketSize];
+    const size_t revived_length = group->Revive(buffer, sizeof(buffer));
+    // The parity is padded to the longest protected packet; truncate the
+    // revived bytes back to the missing packet's exact wire length, since
+    // its AEAD tag covers nothing more.
+    const uint16_t wire_length =
+        datagram
+            .protected_packet_lengths[missing - datagram.min_protected_packet];
+    if (revived_length >= wire_length) {
+      QUIC_DVLOG(1) << ENDPOINT << "Revived packet " << missing
+                    << " from FEC group " << group_index;
+      // The revived bytes are the packet exactly as it appeared on the
+      // wire, so it re-enters through the framer to be decrypted, acked and
+      // dispatched like any other received packet.
+      QuicReceivedPacket revived(buffer, wire_length, packet.receipt_time());
+      last_size_ = revived.length();
+      current_packet_data_ = revived.data();
+      ScopedRetransmissionScheduler alarm_delayer(this);
+      if (framer_.ProcessPacket(revived)) {
+        ++stats_.packets_processed;
+        ++stats_.packets_revived;
+        MaybeSendInResponseToPacket();
+        SetPingAlarm();
+      } else {
+        QUIC_DVLOG(1) << ENDPOINT << "Unable to process revived packet "
+                      << missing;
+      }
+      current_packet_data_ = nullptr;
+    }
+  }
+  if (fec_receive_groups_.count(group_index) > 0 &&
+      fec_receive_groups_[group_index]->IsFinished()) {
+    fec_receive_groups_.erase(group_index);
+  } else {
+    while (fec_receive_groups_.size() > kMaxFecReceiveGroups) {
+      fec_receive_groups_.erase(fec_receive_groups_.begin());
+    }
+  }
+}
+
 void QuicConnection::CloseConnection(
     QuicErrorCode error,
     const string& error_details,
@@ -1990,13 +2475,14 @@ void QuicConnection::TearDownLocalConnectionState(
 void QuicConnection::CancelAllAlarms() {
   QUIC_DVLOG(1) << "Cancelling all QuicConnection alarms.";
 
-  ack_alarm_->Cancel();
+  CancelAckAlarm();
   ping_alarm_->Cancel();
   resume_writes_alarm_->Cancel();
   retransmission_alarm_->Cancel();
   send_alarm_->Cancel();
   timeout_alarm_->Cancel();
   mtu_discovery_alarm_->Cancel();
+  window_update_alarm_->Cancel();
 }
 
 void QuicConnection::SendGoAway(QuicErrorCode error,
@@ -2119,6 +2605,12 @@ void QuicConnection::SetTimeoutAlarm() {
   if (!handshake_timeout_.IsInfinite()) {
     deadline = std::min(deadline,
                         stats_.connection_creation_time + handshake_timeout_);
+  } else if (FLAGS_quic_reloadable_flag_quic_coarse_idle_timeout) {
+    // Idle timeouts firing up to a bucket late are harmless once the
+    // handshake is over, and the quantized deadline rarely moves, so
+    // repeated calls are usually no-ops.
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_coarse_idle_timeout);
+    deadline = RoundUpToGranularity(deadline, kCoarseDeadlineGranularityUs);
   }
 
   timeout_alarm_->Update(deadline, QuicTime::Delta::Zero());
@@ -2134,8 +2626,14 @@ void QuicConnection::SetPingAlarm() {
     // Don't send a ping unless there are open streams.
     return;
   }
-  ping_alarm_->Update(clock_->ApproximateNow() + ping_timeout_,
-                      QuicTime::Delta::FromSeconds(1));
+  QuicTime deadline = clock_->ApproximateNow() + ping_timeout_;
+  if (FLAGS_quic_reloadable_flag_quic_coarse_idle_timeout) {
+    // Quantized keepalive deadlines land many connections' pings in the
+    // same alarm slot, so they are generated in one event loop iteration
+    // and share a flush through a batching packet writer.
+    deadline = RoundUpToGranularity(deadline, kCoarseDeadlineGranularityUs);
+  }
+  ping_alarm_->Update(deadline, QuicTime::Delta::FromSeconds(1));
 }
 
 void QuicConnection::SetRetransmissionAlarm() {
@@ -2156,7 +2654,10 @@ void QuicConnection::MaybeSetMtuAlarm(QuicPacketNumber sent_packet_number) {
     return;
   }
 
-  if (mtu_probe_count_ >= kMtuDiscoveryAttempts) {
+  const size_t max_probe_attempts = mtu_binary_search_
+                                        ? kMtuDiscoveryBinarySearchAttempts
+                                        : kMtuDiscoveryAttempts;
+  if (mtu_probe_count_ >= max_probe_attempts) {
     return;
   }
 
@@ -2202,7 +2703,7 @@ bool QuicConnection::ScopedPacketBundler::ShouldSendAck(
     case SEND_ACK_IF_QUEUED:
       return connection_->ack_queued();
     case SEND_ACK_IF_PENDING:
-      return connection_->ack_alarm_->IsSet() ||
+      return connection_->IsAckAlarmSet() ||
              connection_->stop_waiting_count_ > 1;
     case NO_ACK:
       return false;
@@ -2327,6 +2828,11 @@ void QuicConnection::SendMtuDiscoveryPacket(QuicByteCount target_mtu) {
 void QuicConnection::DiscoverMtu() {
   DCHECK(!mtu_discovery_alarm_->IsSet());
 
+  if (mtu_binary_search_) {
+    DiscoverMtuBinarySearch();
+    return;
+  }
+
   // Check if the MTU has been already increased.
   if (mtu_discovery_target_ <= max_packet_length()) {
     return;
@@ -2347,6 +2853,40 @@ void QuicConnection::DiscoverMtu() {
   DCHECK(!mtu_discovery_alarm_->IsSet());
 }
 
+void QuicConnection::DiscoverMtuBinarySearch() {
+  // A previous probe which was never acknowledged means its size does not fit
+  // the path; shrink the search window from above.
+  if (last_mtu_probe_size_ > 0 && max_packet_length() < last_mtu_probe_size_) {
+    mtu_discovery_target_ = last_mtu_probe_size_ - 1;
+  }
+
+  const QuicByteCount floor = max_packet_length();
+  if (mtu_discovery_target_ <= floor ||
+      mtu_discovery_target_ - floor < kMtuDiscoveryConvergenceDelta) {
+    // The search converged; stop probing.
+    mtu_discovery_target_ = 0;
+    last_mtu_probe_size_ = 0;
+    return;
+  }
+
+  // Unlike the fixed-target probing, the interval is not doubled: each probe
+  // halves the remaining window, so the number of probes is already bounded.
+  next_mtu_probe_at_ = sent_packet_manager_.GetLargestSentPacket() +
+                       packets_between_mtu_probes_ + 1;
+  ++mtu_probe_count_;
+
+  // Probe the midpoint of the remaining window, biased up so the search can
+  // reach the ceiling itself.
+  const QuicByteCount probe_size =
+      floor + (mtu_discovery_target_ - floor + 1) / 2;
+  last_mtu_probe_size_ = probe_size;
+  QUIC_DVLOG(2) << "Sending a binary-search path MTU probe #"
+                << mtu_probe_count_ << " of " << probe_size << " bytes";
+  SendMtuDiscoveryPacket(probe_size);
+
+  DCHECK(!mtu_discovery_alarm_->IsSet());
+}
+
 void QuicConnection::OnPeerMigrationValidated() {
   if (active_peer_migration_type_ == NO_CHANGE) {
     QUIC_BUG << "No migration underway.";
@@ -2375,6 +2915,22 @@ void QuicConnection::StartPeerMigration(
                   << last_packet_source_address_.ToString()
                   << ", migrating connection.";
 
+  const bool use_path_cache =
+      FLAGS_quic_reloadable_flag_quic_validated_path_cache;
+  // Congestion state is only worth caching for migrations which would
+  // otherwise reset it; NAT-induced changes leave it untouched.
+  const bool congestion_state_resets = peer_migration_type != PORT_CHANGE &&
+                                       peer_migration_type != IPV4_SUBNET_CHANGE;
+  if (use_path_cache) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_validated_path_cache);
+    if (congestion_state_resets) {
+      // The old path carried acknowledged traffic, so it is validated; retain
+      // its congestion state before the migration resets it.
+      sent_packet_manager_.RecordPathCongestionState(
+          self_address_.ToString() + "|" + peer_address_.ToString());
+    }
+  }
+
   highest_packet_sent_before_peer_migration_ =
       sent_packet_manager_.GetLargestSentPacket();
   peer_address_ = last_packet_source_address_;
@@ -2384,6 +2940,20 @@ void QuicConnection::StartPeerMigration(
   // OnConnectionMigration methods to OnPeerMigration.
   visitor_->OnConnectionMigration(peer_migration_type);
   sent_packet_manager_.OnConnectionMigration(peer_migration_type);
+
+  if (use_path_cache) {
+    if (congestion_state_resets &&
+        sent_packet_manager_.MaybeRestorePathCongestionState(
+            self_address_.ToString() + "|" + peer_address_.ToString())) {
+      QUIC_DLOG(INFO) << ENDPOINT
+                      << "Restored cached congestion state for known path "
+                      << peer_address_.ToString();
+    }
+    // Probe the new path right away instead of waiting for application
+    // traffic: the migration is validated once a packet sent from here on is
+    // acknowledged.
+    SendPing();
+  }
 }
 
 bool QuicConnection::ack_frame_updated() const {
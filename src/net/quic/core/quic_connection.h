@@ -33,6 +33,7 @@
 #include "net/quic/core/quic_blocked_writer_interface.h"
 #include "net/quic/core/quic_connection_stats.h"
 #include "net/quic/core/quic_framer.h"
+#include "net/quic/core/quic_object_pool.h"
 #include "net/quic/core/quic_one_block_arena.h"
 #include "net/quic/core/quic_packet_creator.h"
 #include "net/quic/core/quic_packet_generator.h"
@@ -53,6 +54,7 @@ class QuicConfig;
 class QuicConnection;
 class QuicDecrypter;
 class QuicEncrypter;
+class QuicFecGroup;
 class QuicRandom;
 
 namespace test {
@@ -67,6 +69,15 @@ const QuicPacketCount kPacketsBetweenMtuProbesBase = 100;
 // The number of MTU probes that get sent before giving up.
 const size_t kMtuDiscoveryAttempts = 3;
 
+// The number of probes sent before giving up when binary-searching for the
+// path MTU (kMTUB).  Each probe halves the remaining search window, so this
+// resolves the window to a handful of bytes.
+const size_t kMtuDiscoveryBinarySearchAttempts = 8;
+
+// The binary search for the path MTU stops once the remaining window is
+// smaller than this.
+const QuicByteCount kMtuDiscoveryConvergenceDelta = 16;
+
 // Ensure that exponential back-off does not result in an integer overflow.
 // The number of packets can be potentially capped, but that is not useful at
 // current kMtuDiscoveryAttempts value, and hence is not implemented at present.
@@ -289,6 +300,22 @@ class QUIC_EXPORT_PRIVATE QuicConnectionHelperInterface {
   virtual QuicBufferAllocator* GetStreamSendBufferAllocator() = 0;
 };
 
+// Schedules delayed acks for many connections on a shared alarm, so that the
+// per-connection ack alarm arm/cancel churn collapses into one alarm per
+// scheduling epoch.  Implemented by the connection's owner (e.g. a
+// dispatcher); see QuicConnection::set_ack_scheduler().
+class QUIC_EXPORT_PRIVATE QuicAckScheduler {
+ public:
+  virtual ~QuicAckScheduler() {}
+
+  // Requests that OnBatchedAckAlarm() be invoked on |connection| at or
+  // shortly after |deadline|.  Supersedes any earlier request; cancellation
+  // is lazy, so the scheduler may invoke OnBatchedAckAlarm spuriously and
+  // the connection ignores stale deadlines.
+  virtual void ScheduleAckAlarm(QuicConnection* connection,
+                                QuicTime deadline) = 0;
+};
+
 class QUIC_EXPORT_PRIVATE QuicConnection
     : public QuicFramerVisitorInterface,
       public QuicBlockedWriterInterface,
@@ -321,6 +348,16 @@ class QUIC_EXPORT_PRIVATE QuicConnection
                  const QuicVersionVector& supported_versions);
   ~QuicConnection() override;
 
+  // Servers allocate and tear down connections at high rates; recycle the
+  // object's memory through per-thread block pools. Sized deallocation
+  // routes subclasses to the right bucket.
+  static void* operator new(size_t size) {
+    return QuicObjectPool::Allocate(size);
+  }
+  static void operator delete(void* block, size_t size) {
+    QuicObjectPool::Deallocate(block, size);
+  }
+
   // Sets connection parameters from the supplied |config|.
   void SetFromConfig(const QuicConfig& config);
 
@@ -369,6 +406,12 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Send a WINDOW_UPDATE frame to the peer.
   virtual void SendWindowUpdate(QuicStreamId id, QuicStreamOffset byte_offset);
 
+  // Sends all window updates accumulated while
+  // FLAGS_quic_reloadable_flag_quic_coalesce_window_updates is on, bundled
+  // into as few packets as possible.  Called when the coalescing deadline
+  // passes and before outgoing data or ack packets which can carry them.
+  void FlushPendingWindowUpdates();
+
   // Closes the connection.
   // |connection_close_behavior| determines whether or not a connection close
   // packet is sent to the peer.
@@ -478,6 +521,22 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // the SHLO.
   void OnHandshakeComplete();
 
+  // Called by the crypto stream once the AEAD algorithm has been negotiated,
+  // so that per-cipher CPU accounting in the stats can be attributed to the
+  // cipher in use.
+  void OnAeadNegotiated(QuicTag aead) { stats_.aead_algorithm = aead; }
+
+  // Subscribes |listener| to acks of sent packets in [first, last], both
+  // inclusive. One registration covers the whole range; see
+  // QuicSentPacketManager::RegisterAckRangeListener.
+  void RegisterAckRangeListener(
+      QuicPacketNumber first,
+      QuicPacketNumber last,
+      QuicReferenceCountedPointer<QuicAckRangeListenerInterface> listener) {
+    sent_packet_manager_.RegisterAckRangeListener(first, last,
+                                                  std::move(listener));
+  }
+
   // Accessors
   void set_visitor(QuicConnectionVisitorInterface* visitor) {
     visitor_ = visitor;
@@ -497,6 +556,12 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   void set_creator_debug_delegate(QuicPacketCreator::DebugDelegate* visitor) {
     packet_generator_.set_debug_delegate(visitor);
   }
+  // Called by the session before writing a stream's data so packets are
+  // stamped with the priority of the streams they carry; see
+  // QuicTransmissionInfo::priority.
+  void set_current_stream_priority(SpdyPriority priority) {
+    packet_generator_.set_current_stream_priority(priority);
+  }
   const QuicSocketAddress& self_address() const { return self_address_; }
   const QuicSocketAddress& peer_address() const { return peer_address_; }
   QuicConnectionId connection_id() const { return connection_id_; }
@@ -509,6 +574,12 @@ class QUIC_EXPORT_PRIVATE QuicConnection
 
   bool connected() const { return connected_; }
 
+  // The time at which the last packet from the peer arrived, or
+  // QuicTime::Zero() if none has been received yet.
+  QuicTime time_of_last_received_packet() const {
+    return time_of_last_received_packet_;
+  }
+
   bool goaway_sent() const { return goaway_sent_; }
 
   bool goaway_received() const { return goaway_received_; }
@@ -552,6 +623,17 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Sets up a packet with an QuicAckFrame and sends it out.
   void SendAck();
 
+  // Called by the ack scheduler when a batched ack deadline fires.  Sends an
+  // ack if one is still pending; stale or superseded deadlines are ignored.
+  void OnBatchedAckAlarm();
+
+  // Routes delayed acks through |scheduler| instead of this connection's own
+  // ack alarm.  Must be set before any packets are processed; the scheduler
+  // must outlive the connection.
+  void set_ack_scheduler(QuicAckScheduler* scheduler) {
+    ack_scheduler_ = scheduler;
+  }
+
   // Called when an RTO fires.  Resets the retransmission alarm if there are
   // remaining unacked packets.
   void OnRetransmissionTimeout();
@@ -663,6 +745,11 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // the MTU discovery alarm.
   void DiscoverMtu();
 
+  // Binary-search variant of DiscoverMtu: probes the midpoint of the window
+  // between the current packet length and |mtu_discovery_target_|, shrinking
+  // the window from above when a probe goes unacknowledged.
+  void DiscoverMtuBinarySearch();
+
   // Sets the stream notifer on the SentPacketManager.
   void SetStreamNotifier(StreamNotifierInterface* stream_notifier);
 
@@ -695,6 +782,21 @@ class QUIC_EXPORT_PRIVATE QuicConnection
     return received_packet_manager_;
   }
 
+  // Collapses received-packet tracking to a compact watermark if the
+  // connection has nothing left to ack, releasing the memory the ack
+  // machinery pins per connection.  Intended to be called on connections
+  // that have been idle for a while; state is restored transparently when
+  // the next packet arrives.  Also invoked internally at ping timeout.
+  void CollapseAckStateForQuiescence() {
+    received_packet_manager_.CollapseToQuiescentState();
+  }
+
+  // Called when the kernel reports that the socket this connection reads
+  // from overflowed its receive queue.  Losses detected shortly afterwards
+  // are excluded from loss-based congestion reactions, since they are as
+  // likely to be our own drops as network congestion.
+  void OnLocalSocketOverflow();
+
   EncryptionLevel encryption_level() const { return encryption_level_; }
 
   const QuicSocketAddress& last_packet_source_address() const {
@@ -809,6 +911,22 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Attempts to process any queued undecryptable packets.
   void MaybeProcessUndecryptablePackets();
 
+  // XOR FEC (kXFEC). Records the encrypted form of a sent packet in the
+  // current send group and, once the group is full, emits a best-effort
+  // parity datagram through the writer.
+  void MaybeSendFecParity(QuicPacketNumber packet_number,
+                          QuicStringPiece encrypted_packet);
+
+  // Records the encrypted form of a successfully processed received packet in
+  // its receive group.
+  void RecordReceivedPacketForFec(QuicPacketNumber packet_number,
+                                  QuicStringPiece encrypted_packet);
+
+  // Processes a received parity datagram: records the parity, and if exactly
+  // one packet of the group is missing, revives its encrypted form and feeds
+  // it back through the framer like any other received packet.
+  void ProcessFecDatagram(const QuicReceivedPacket& packet);
+
   // Sends any packets which are a response to the last packet, including both
   // acks and pending writes if an ack opened the congestion window.
   void MaybeSendInResponseToPacket();
@@ -821,6 +939,14 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // sent if there are no outstanding packets.
   QuicPacketNumber GetLeastUnacked() const;
 
+  // Wrappers around |ack_alarm_| which route through |ack_scheduler_| when
+  // one is set.
+  bool IsAckAlarmSet() const;
+  QuicTime AckAlarmDeadline() const;
+  void SetAckAlarm(QuicTime deadline);
+  void UpdateAckAlarm(QuicTime deadline);
+  void CancelAckAlarm();
+
   // Sets the timeout alarm to the appropriate value, if any.
   void SetTimeoutAlarm();
 
@@ -865,6 +991,10 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   PerPacketOptions* per_packet_options_;   // Not owned.
   QuicPacketWriter* writer_;  // Owned or not depending on |owns_writer_|.
   bool owns_writer_;
+  // True if |writer_| honors PerPacketOptions::release_time_delay, so paced
+  // packets can be stamped with a release time and handed to the kernel
+  // immediately instead of waiting on the send alarm.
+  bool supports_release_time_;
   // Encryption level for new packets. Should only be changed via
   // SetDefaultEncryptionLevel().
   EncryptionLevel encryption_level_;
@@ -888,6 +1018,8 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // decrypted.
   bool last_packet_decrypted_;
   QuicByteCount last_size_;  // Size of the last received packet.
+  // ECN codepoint of the last received packet.
+  QuicEcnCodepoint last_ecn_codepoint_;
   // TODO(rch): remove this when b/27221014 is fixed.
   const char* current_packet_data_;  // UDP payload of packet currently being
                                      // parsed or nullptr.
@@ -913,6 +1045,27 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Maximum number of undecryptable packets the connection will store.
   size_t max_undecryptable_packets_;
 
+  // True once kXFEC has been negotiated (and the XOR FEC flag is on): sent
+  // packets are protected by parity datagrams and received parity datagrams
+  // are used to revive missing packets.
+  bool fec_enabled_;
+
+  // Parity accumulated over the encrypted packets of the send group
+  // currently being filled, or null if no packet of the group has been sent
+  // yet. Groups are aligned to packet numbers (see kFecGroupSize), so the
+  // group a packet belongs to is implicit.
+  std::unique_ptr<QuicFecGroup> fec_send_group_;
+  QuicPacketNumber fec_send_group_index_;
+  // Wire lengths of the packets fed to |fec_send_group_| so far, carried in
+  // the parity datagram so the receiver can truncate a revived packet to its
+  // exact length before decryption.
+  std::vector<uint16_t> fec_send_packet_lengths_;
+
+  // Receive groups with at least one recorded packet or parity, keyed by
+  // group index. Bounded; the oldest group is dropped when full.
+  std::map<QuicPacketNumber, std::unique_ptr<QuicFecGroup>>
+      fec_receive_groups_;
+
   // When the version negotiation packet could not be sent because the socket
   // was not writable, this is set to true.
   bool pending_version_negotiation_packet_;
@@ -964,6 +1117,10 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // When true, removes ack decimation's max number of packets(10) before
   // sending an ack.
   bool unlimited_ack_decimation_;
+  // When true, ack decimation's max number of packets is scaled from the
+  // current receive rate, so that fast flows generate a bounded number of
+  // acks per second instead of one per ten packets.
+  bool dynamic_ack_decimation_;
 
   // Indicates the retransmit alarm is going to be set by the
   // ScopedRetransmitAlarmDelayer
@@ -981,8 +1138,15 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Arena to store class implementations within the QuicConnection.
   QuicConnectionArena arena_;
 
-  // An alarm that fires when an ACK should be sent to the peer.
+  // An alarm that fires when an ACK should be sent to the peer.  Unused when
+  // |ack_scheduler_| is set.
   QuicArenaScopedPtr<QuicAlarm> ack_alarm_;
+  // If not null, delayed acks are registered with this shared scheduler
+  // instead of arming |ack_alarm_|.  Not owned.
+  QuicAckScheduler* ack_scheduler_;
+  // The pending batched ack deadline when |ack_scheduler_| is set, or zero if
+  // no ack is pending.  Used to ignore stale scheduler callbacks.
+  QuicTime batched_ack_deadline_;
   // An alarm that fires when a packet needs to be retransmitted.
   QuicArenaScopedPtr<QuicAlarm> retransmission_alarm_;
   // An alarm that is scheduled when the SentPacketManager requires a delay
@@ -999,6 +1163,14 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   QuicArenaScopedPtr<QuicAlarm> ping_alarm_;
   // An alarm that fires when an MTU probe should be sent.
   QuicArenaScopedPtr<QuicAlarm> mtu_discovery_alarm_;
+  // An alarm bounding how long coalesced window updates may wait for an
+  // outgoing packet to ride in.
+  QuicArenaScopedPtr<QuicAlarm> window_update_alarm_;
+
+  // Window updates queued for coalescing, keyed by stream id with the largest
+  // offset seen for each stream.  Only populated when
+  // FLAGS_quic_reloadable_flag_quic_coalesce_window_updates is on.
+  std::map<QuicStreamId, QuicStreamOffset> pending_window_updates_;
 
   // Neither visitor is owned by this class.
   QuicConnectionVisitorInterface* visitor_;
@@ -1014,6 +1186,17 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Statistics for this session.
   QuicConnectionStats stats_;
 
+  // Nesting depth of the CPU accounting scopes around ProcessUdpPacket and
+  // OnCanWrite. Allocation deltas are attributed by the outermost scope
+  // only, so reentrant calls do not double count.
+  int cpu_accounting_depth_;
+
+  // When FLAGS_quic_reloadable_flag_quic_connection_write_bursts is true,
+  // the number of packets which may still be written without re-consulting
+  // the sent packet manager's pacer. Reset to zero whenever an ack, loss or
+  // retransmission timeout changes what the pacer would answer.
+  QuicPacketCount burst_packets_remaining_;
+
   // The time that we got a packet for this connection.
   // This is used for timeouts, and does not indicate the packet was processed.
   QuicTime time_of_last_received_packet_;
@@ -1081,6 +1264,19 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // sent.
   QuicPacketNumber next_mtu_probe_at_;
 
+  // When true (kMTUB), MTU discovery binary-searches the window between the
+  // current packet length and |mtu_discovery_target_| instead of probing the
+  // target size directly.
+  bool mtu_binary_search_;
+
+  // The size of the most recent MTU probe whose fate is not yet known, or 0.
+  // An unacknowledged probe shrinks the binary search window from above.
+  QuicByteCount last_mtu_probe_size_;
+
+  // The packet length in use before MTU discovery raised it, or 0 if it was
+  // never raised.  Restored if the raised MTU appears to blackhole.
+  QuicByteCount pre_discovery_mtu_;
+
   // The value of the MTU regularly used by the connection. This is different
   // from the value returned by max_packet_size(), as max_packet_size() returns
   // the value of the MTU as currently used by the serializer, so if
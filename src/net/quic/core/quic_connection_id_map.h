@@ -0,0 +1,220 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_CONNECTION_ID_MAP_H_
+#define NET_QUIC_CORE_QUIC_CONNECTION_ID_MAP_H_
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+#include "base/macros.h"
+#include "net/quic/core/quic_types.h"
+#include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+// An open-addressing hash table keyed by 64-bit connection IDs, built for
+// the dispatcher's per-packet session lookup. Connection IDs are already
+// uniformly random, so the table indexes directly off the low bits instead
+// of hashing, probes linearly through a flat slot array (consecutive probes
+// share cache lines), and uses backward-shift deletion so probe chains
+// never accumulate tombstones. The interface is the subset of
+// std::unordered_map the dispatcher uses.
+//
+// Iterators are invalidated by insert() and erase().
+template <typename Value>
+class QuicConnectionIdMap {
+ public:
+  using value_type = std::pair<QuicConnectionId, Value>;
+
+  template <typename TableType, typename PairType>
+  class IteratorBase {
+   public:
+    IteratorBase(TableType* table, size_t index)
+        : table_(table), index_(index) {
+      SkipEmptySlots();
+    }
+
+    PairType& operator*() const { return table_->slots_[index_]; }
+    PairType* operator->() const { return &table_->slots_[index_]; }
+
+    IteratorBase& operator++() {
+      ++index_;
+      SkipEmptySlots();
+      return *this;
+    }
+
+    bool operator==(const IteratorBase& other) const {
+      return table_ == other.table_ && index_ == other.index_;
+    }
+    bool operator!=(const IteratorBase& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class QuicConnectionIdMap;
+
+    void SkipEmptySlots() {
+      while (index_ < table_->capacity_ && !table_->full_[index_]) {
+        ++index_;
+      }
+    }
+
+    TableType* table_;
+    size_t index_;
+  };
+
+  using iterator = IteratorBase<QuicConnectionIdMap, value_type>;
+  using const_iterator =
+      IteratorBase<const QuicConnectionIdMap, const value_type>;
+
+  QuicConnectionIdMap() : capacity_(0), size_(0) {}
+
+  ~QuicConnectionIdMap() {}
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, capacity_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, capacity_); }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator find(QuicConnectionId key) {
+    size_t index;
+    if (FindSlot(key, &index)) {
+      return iterator(this, index);
+    }
+    return end();
+  }
+
+  const_iterator find(QuicConnectionId key) const {
+    size_t index;
+    if (FindSlot(key, &index)) {
+      return const_iterator(this, index);
+    }
+    return end();
+  }
+
+  size_t count(QuicConnectionId key) const {
+    size_t unused;
+    return FindSlot(key, &unused) ? 1 : 0;
+  }
+
+  std::pair<iterator, bool> insert(value_type entry) {
+    MaybeGrow();
+    size_t index = entry.first & mask();
+    while (full_[index]) {
+      if (slots_[index].first == entry.first) {
+        return std::make_pair(iterator(this, index), false);
+      }
+      index = (index + 1) & mask();
+    }
+    slots_[index] = std::move(entry);
+    full_[index] = true;
+    ++size_;
+    return std::make_pair(iterator(this, index), true);
+  }
+
+  // Erases the slot |it| points at, backward-shifting any displaced
+  // followers in its probe chain so lookups never traverse dead slots.
+  void erase(iterator it) {
+    DCHECK(it.table_ == this && it.index_ < capacity_ && full_[it.index_]);
+    size_t hole = it.index_;
+    size_t probe = hole;
+    while (true) {
+      probe = (probe + 1) & mask();
+      if (!full_[probe]) {
+        break;
+      }
+      const size_t ideal = slots_[probe].first & mask();
+      // Move |probe| back into the hole only if its probe chain passes
+      // through the hole, i.e. the hole lies between its ideal slot and its
+      // current slot (cyclically).
+      if (((probe - ideal) & mask()) >= ((probe - hole) & mask())) {
+        slots_[hole] = std::move(slots_[probe]);
+        hole = probe;
+      }
+    }
+    full_[hole] = false;
+    slots_[hole] = value_type();
+    --size_;
+  }
+
+  size_t erase(QuicConnectionId key) {
+    iterator it = find(key);
+    if (it == end()) {
+      return 0;
+    }
+    erase(it);
+    return 1;
+  }
+
+  void clear() {
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (full_[i]) {
+        slots_[i] = value_type();
+        full_[i] = false;
+      }
+    }
+    size_ = 0;
+  }
+
+ private:
+  // Initial number of slots; must be a power of two.
+  static const size_t kInitialCapacity = 16;
+
+  size_t mask() const { return capacity_ - 1; }
+
+  bool FindSlot(QuicConnectionId key, size_t* out_index) const {
+    if (capacity_ == 0) {
+      return false;
+    }
+    size_t index = key & mask();
+    while (full_[index]) {
+      if (slots_[index].first == key) {
+        *out_index = index;
+        return true;
+      }
+      index = (index + 1) & mask();
+    }
+    return false;
+  }
+
+  void MaybeGrow() {
+    // Keep load factor under 3/4 so probe chains stay short.
+    if (capacity_ != 0 && (size_ + 1) * 4 <= capacity_ * 3) {
+      return;
+    }
+    const size_t new_capacity =
+        capacity_ == 0 ? kInitialCapacity : capacity_ * 2;
+    std::unique_ptr<value_type[]> old_slots = std::move(slots_);
+    std::unique_ptr<bool[]> old_full = std::move(full_);
+    const size_t old_capacity = capacity_;
+
+    slots_.reset(new value_type[new_capacity]);
+    full_.reset(new bool[new_capacity]());
+    capacity_ = new_capacity;
+    size_ = 0;
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_full[i]) {
+        insert(std::move(old_slots[i]));
+      }
+    }
+  }
+
+  std::unique_ptr<value_type[]> slots_;
+  std::unique_ptr<bool[]> full_;
+  size_t capacity_;
+  size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicConnectionIdMap);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_CONNECTION_ID_MAP_H_
@@ -0,0 +1,97 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_connection_id_map.h"
+
+#include <memory>
+#include <set>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+using TestMap = QuicConnectionIdMap<int>;
+
+TEST(QuicConnectionIdMapTest, InsertFindErase) {
+  TestMap map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.end(), map.find(42));
+
+  EXPECT_TRUE(map.insert(std::make_pair(42u, 1)).second);
+  EXPECT_EQ(1u, map.size());
+  auto it = map.find(42);
+  ASSERT_NE(map.end(), it);
+  EXPECT_EQ(42u, it->first);
+  EXPECT_EQ(1, it->second);
+
+  map.erase(it);
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.end(), map.find(42));
+}
+
+TEST(QuicConnectionIdMapTest, DuplicateInsertIsRejected) {
+  TestMap map;
+  EXPECT_TRUE(map.insert(std::make_pair(7u, 1)).second);
+  EXPECT_FALSE(map.insert(std::make_pair(7u, 2)).second);
+  EXPECT_EQ(1, map.find(7)->second);
+}
+
+TEST(QuicConnectionIdMapTest, CollidingKeysSurviveDeletion) {
+  TestMap map;
+  // These keys all land on the same initial slot (equal low bits), forcing
+  // one probe chain. Deleting from the middle must not break lookups of
+  // the displaced followers.
+  const QuicConnectionId kKeys[] = {0x10, 0x110, 0x210, 0x310, 0x410};
+  for (QuicConnectionId key : kKeys) {
+    map.insert(std::make_pair(key, static_cast<int>(key)));
+  }
+  map.erase(map.find(0x110));
+  map.erase(map.find(0x310));
+  for (QuicConnectionId key : {0x10, 0x210, 0x410}) {
+    auto it = map.find(key);
+    ASSERT_NE(map.end(), it) << "lost key " << key;
+    EXPECT_EQ(static_cast<int>(key), it->second);
+  }
+  EXPECT_EQ(map.end(), map.find(0x110));
+  EXPECT_EQ(map.end(), map.find(0x310));
+}
+
+TEST(QuicConnectionIdMapTest, GrowsPastInitialCapacity) {
+  TestMap map;
+  for (QuicConnectionId id = 1; id <= 1000; ++id) {
+    map.insert(std::make_pair(id * 0x9e3779b9u, static_cast<int>(id)));
+  }
+  EXPECT_EQ(1000u, map.size());
+  for (QuicConnectionId id = 1; id <= 1000; ++id) {
+    auto it = map.find(id * 0x9e3779b9u);
+    ASSERT_NE(map.end(), it);
+    EXPECT_EQ(static_cast<int>(id), it->second);
+  }
+}
+
+TEST(QuicConnectionIdMapTest, IterationCoversAllEntries) {
+  TestMap map;
+  std::set<QuicConnectionId> keys;
+  for (QuicConnectionId id = 1; id <= 50; ++id) {
+    map.insert(std::make_pair(id, 0));
+    keys.insert(id);
+  }
+  std::set<QuicConnectionId> seen;
+  for (const auto& entry : map) {
+    EXPECT_TRUE(seen.insert(entry.first).second);
+  }
+  EXPECT_EQ(keys, seen);
+}
+
+TEST(QuicConnectionIdMapTest, MoveOnlyValues) {
+  QuicConnectionIdMap<std::unique_ptr<int>> map;
+  map.insert(std::make_pair(5u, std::unique_ptr<int>(new int(9))));
+  EXPECT_EQ(9, *map.find(5)->second);
+  map.clear();
+  EXPECT_TRUE(map.empty());
+}
+
+}  // namespace
+}  // namespace net
@@ -24,10 +24,15 @@ QuicConnectionStats::QuicConnectionStats()
       slowstart_packets_lost(0),
       slowstart_bytes_lost(0),
       packets_dropped(0),
+      fec_parity_sent(0),
+      packets_revived(0),
+      acks_sent(0),
       crypto_retransmit_count(0),
       loss_timeout_count(0),
       tlp_count(0),
       rto_count(0),
+      tlp_spurious_count(0),
+      rto_spurious_count(0),
       min_rtt_us(0),
       srtt_us(0),
       max_packet_size(0),
@@ -39,7 +44,15 @@ QuicConnectionStats::QuicConnectionStats()
       tcp_loss_events(0),
       connection_creation_time(QuicTime::Zero()),
       blocked_frames_received(0),
-      blocked_frames_sent(0) {}
+      blocked_frames_sent(0),
+      buffer_pool_bytes_reserved(0),
+      buffer_pool_bytes_in_use(0),
+      process_packet_cycles(0),
+      on_can_write_cycles(0),
+      buffer_allocations(0),
+      aead_algorithm(0),
+      encryption_cycles(0),
+      decryption_cycles(0) {}
 
 QuicConnectionStats::QuicConnectionStats(const QuicConnectionStats& other) =
     default;
@@ -65,10 +78,15 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionStats& s) {
   os << " slowstart_packets_lost: " << s.slowstart_packets_lost;
   os << " slowstart_bytes_lost: " << s.slowstart_bytes_lost;
   os << " packets_dropped: " << s.packets_dropped;
+  os << " fec_parity_sent: " << s.fec_parity_sent;
+  os << " packets_revived: " << s.packets_revived;
+  os << " acks_sent: " << s.acks_sent;
   os << " crypto_retransmit_count: " << s.crypto_retransmit_count;
   os << " loss_timeout_count: " << s.loss_timeout_count;
   os << " tlp_count: " << s.tlp_count;
   os << " rto_count: " << s.rto_count;
+  os << " tlp_spurious_count: " << s.tlp_spurious_count;
+  os << " rto_spurious_count: " << s.rto_spurious_count;
   os << " min_rtt_us: " << s.min_rtt_us;
   os << " srtt_us: " << s.srtt_us;
   os << " max_packet_size: " << s.max_packet_size;
@@ -81,7 +99,15 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionStats& s) {
   os << " connection_creation_time: "
      << s.connection_creation_time.ToDebuggingValue();
   os << " blocked_frames_received: " << s.blocked_frames_received;
-  os << " blocked_frames_sent: " << s.blocked_frames_sent << " }";
+  os << " blocked_frames_sent: " << s.blocked_frames_sent;
+  os << " buffer_pool_bytes_reserved: " << s.buffer_pool_bytes_reserved;
+  os << " buffer_pool_bytes_in_use: " << s.buffer_pool_bytes_in_use;
+  os << " process_packet_cycles: " << s.process_packet_cycles;
+  os << " on_can_write_cycles: " << s.on_can_write_cycles;
+  os << " buffer_allocations: " << s.buffer_allocations;
+  os << " aead_algorithm: " << QuicTagToString(s.aead_algorithm);
+  os << " encryption_cycles: " << s.encryption_cycles;
+  os << " decryption_cycles: " << s.decryption_cycles << " }";
 
   return os;
 }
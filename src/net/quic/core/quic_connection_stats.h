@@ -58,12 +58,27 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   QuicByteCount slowstart_bytes_lost;
 
   QuicPacketCount packets_dropped;  // Duplicate or less than least unacked.
+  // XOR FEC (kXFEC): parity datagrams emitted for sent packet groups, and
+  // missing packets revived from a received parity instead of waiting for a
+  // retransmission.
+  QuicPacketCount fec_parity_sent;
+  QuicPacketCount packets_revived;
+  // Number of ack frames serialized and sent.  Together with bytes_received
+  // this measures how many acks the connection sends per megabyte, which ack
+  // decimation is supposed to drive down.
+  QuicPacketCount acks_sent;
   size_t crypto_retransmit_count;
   // Count of times the loss detection alarm fired.  At least one packet should
   // be lost when the alarm fires.
   size_t loss_timeout_count;
   size_t tlp_count;
   size_t rto_count;  // Count of times the rto timer fired.
+  // Of the timer fires above, retransmissions that later proved spurious
+  // because the original data was acked anyway. Subtracting these from the
+  // fire counts gives the probes that were actually useful, the signal used
+  // to tune retransmission profiles from data.
+  size_t tlp_spurious_count;
+  size_t rto_spurious_count;
 
   int64_t min_rtt_us;  // Minimum RTT in microseconds.
   int64_t srtt_us;     // Smoothed RTT in microseconds.
@@ -89,6 +104,33 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
 
   uint64_t blocked_frames_received;
   uint64_t blocked_frames_sent;
+
+  // Occupancy of the buffer pool backing stream send and receive buffers.
+  // The pool is shared by all connections using the same helper, so these
+  // describe the whole thread, not just this connection. Zero when the
+  // allocator in use does not track occupancy.
+  QuicByteCount buffer_pool_bytes_reserved;
+  QuicByteCount buffer_pool_bytes_in_use;
+
+  // Cumulative CPU cycles (TSC ticks) this connection spent inside
+  // ProcessUdpPacket and OnCanWrite respectively, and the number of buffers
+  // it drew from the helper's buffer allocator while doing so. Together
+  // these attribute a dispatcher thread's load to individual connections.
+  // Write work triggered while processing a packet is charged to both cycle
+  // counters, so the two must not be summed. Cycle counts are zero on
+  // platforms without a cheap cycle counter.
+  uint64_t process_packet_cycles;
+  uint64_t on_can_write_cycles;
+  uint64_t buffer_allocations;
+
+  // The negotiated AEAD algorithm (kAESG or kCC20), or 0 before the
+  // handshake settles, and the cumulative CPU cycles spent sealing and
+  // opening packets with it. Together these verify that connections land on
+  // the cipher their hardware handles cheapest. Cycle counts are zero on
+  // platforms without a cheap cycle counter.
+  QuicTag aead_algorithm;
+  uint64_t encryption_cycles;
+  uint64_t decryption_cycles;
 };
 
 }  // namespace net
@@ -17,6 +17,7 @@
 #include "net/quic/core/crypto/null_encrypter.h"
 #include "net/quic/core/crypto/quic_decrypter.h"
 #include "net/quic/core/crypto/quic_encrypter.h"
+#include "net/quic/core/quic_fec_datagram.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_simple_buffer_allocator.h"
 #include "net/quic/core/quic_utils.h"
@@ -303,6 +304,16 @@ class TestPacketWriter : public QuicPacketWriter {
     QuicEncryptedPacket packet(buffer, buf_len);
     ++packets_write_attempts_;
 
+    if (IsFecDatagram(buffer, buf_len)) {
+      // Parity datagrams are not QUIC packets and cannot be fed to the
+      // framer; record them for inspection instead.
+      fec_datagrams_.push_back(std::string(buffer, buf_len));
+      if (IsWriteBlocked()) {
+        return WriteResult(WRITE_STATUS_BLOCKED, -1);
+      }
+      return WriteResult(WRITE_STATUS_OK, buf_len);
+    }
+
     if (packet.length() >= sizeof(final_bytes_of_last_packet_)) {
       final_bytes_of_previous_packet_ = final_bytes_of_last_packet_;
       memcpy(&final_bytes_of_last_packet_, packet.data() + packet.length() - 4,
@@ -437,6 +448,11 @@ class TestPacketWriter : public QuicPacketWriter {
 
   uint32_t packets_write_attempts() { return packets_write_attempts_; }
 
+  // The XOR FEC parity datagrams written so far.
+  const std::vector<std::string>& fec_datagrams() const {
+    return fec_datagrams_;
+  }
+
   void Reset() { framer_.Reset(); }
 
   void SetSupportedVersions(const QuicVersionVector& versions) {
@@ -461,6 +477,7 @@ class TestPacketWriter : public QuicPacketWriter {
   uint32_t final_bytes_of_previous_packet_;
   bool use_tagging_decrypter_;
   uint32_t packets_write_attempts_;
+  std::vector<std::string> fec_datagrams_;
   MockClock* clock_;
   // If non-zero, the clock will pause during WritePacket for this amount of
   // time.
@@ -596,6 +613,22 @@ class TestConnection : public QuicConnection {
         .WillRepeatedly(Return(QuicBandwidth::Infinite()));
   }
 
+  // Enable binary-search path MTU discovery (kMTUB).  Assumes that the test
+  // is performed from the client perspective.
+  void EnableBinaryPathMtuDiscovery(MockSendAlgorithm* send_algorithm) {
+    ASSERT_EQ(Perspective::IS_CLIENT, perspective());
+
+    QuicConfig config;
+    QuicTagVector connection_options;
+    connection_options.push_back(kMTUB);
+    config.SetConnectionOptionsToSend(connection_options);
+    EXPECT_CALL(*send_algorithm, SetFromConfig(_, _));
+    SetFromConfig(config);
+
+    EXPECT_CALL(*send_algorithm, PacingRate(_))
+        .WillRepeatedly(Return(QuicBandwidth::Infinite()));
+  }
+
   TestAlarmFactory::TestAlarm* GetAckAlarm() {
     return reinterpret_cast<TestAlarmFactory::TestAlarm*>(
         QuicConnectionPeer::GetAckAlarm(this));
@@ -1206,6 +1239,30 @@ TEST_P(QuicConnectionTest, ClientAddressChangeAndPacketReordered) {
                                   kPeerAddress);
 }
 
+TEST_P(QuicConnectionTest, PeerMigrationProbesNewPath) {
+  FLAGS_quic_reloadable_flag_quic_validated_path_cache = true;
+  EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
+  set_perspective(Perspective::IS_SERVER);
+  QuicPacketCreatorPeer::SetSendVersionInPacket(creator_, false);
+
+  QuicStreamFrame stream_frame(1u, false, 0u, QuicStringPiece());
+  EXPECT_CALL(visitor_, OnStreamFrame(_)).Times(AnyNumber());
+  ProcessFramePacketWithAddresses(QuicFrame(&stream_frame), kSelfAddress,
+                                  kPeerAddress);
+
+  // A packet from a new peer IP starts a migration, and the connection probes
+  // the new path immediately with a ping instead of waiting for application
+  // traffic.
+  EXPECT_CALL(visitor_, OnConnectionMigration(IPV6_TO_IPV4_CHANGE));
+  const QuicSocketAddress kNewPeerAddress =
+      QuicSocketAddress(QuicIpAddress::Loopback4(),
+                        /*port=*/23456);
+  ProcessFramePacketWithAddresses(QuicFrame(&stream_frame), kSelfAddress,
+                                  kNewPeerAddress);
+  EXPECT_EQ(kNewPeerAddress, connection_.peer_address());
+  EXPECT_EQ(1u, writer_->ping_frames().size());
+}
+
 TEST_P(QuicConnectionTest, MaxPacketSize) {
   EXPECT_EQ(Perspective::IS_CLIENT, connection_.perspective());
   EXPECT_EQ(1350u, connection_.max_packet_length());
@@ -1581,6 +1638,29 @@ TEST_P(QuicConnectionTest, AckNeedsRetransmittableFrames) {
   EXPECT_EQ(1u, writer_->ping_frames().size());
 }
 
+TEST_P(QuicConnectionTest, CoalescedWindowUpdatesRideWithData) {
+  FLAGS_quic_reloadable_flag_quic_coalesce_window_updates = true;
+
+  // Queued window updates are not sent on their own.
+  connection_.SendWindowUpdate(3, 100);
+  connection_.SendWindowUpdate(3, 300);
+  connection_.SendWindowUpdate(5, 200);
+  EXPECT_EQ(0u, writer_->window_update_frames().size());
+
+  // The next outgoing data packet carries them, deduplicated per stream with
+  // the largest offset.
+  SendStreamDataToPeer(1, "foo", 0, NO_FIN, nullptr);
+  ASSERT_EQ(2u, writer_->window_update_frames().size());
+  EXPECT_EQ(3u, writer_->window_update_frames()[0].stream_id);
+  EXPECT_EQ(300u, writer_->window_update_frames()[0].byte_offset);
+  EXPECT_EQ(5u, writer_->window_update_frames()[1].stream_id);
+  EXPECT_EQ(200u, writer_->window_update_frames()[1].byte_offset);
+
+  // Nothing is left to flush.
+  SendStreamDataToPeer(1, "bar", 3, NO_FIN, nullptr);
+  EXPECT_EQ(0u, writer_->window_update_frames().size());
+}
+
 TEST_P(QuicConnectionTest, LeastUnackedLower) {
   EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
 
@@ -2884,6 +2964,32 @@ TEST_P(QuicConnectionTest, InitialTimeout) {
   EXPECT_FALSE(connection_.GetMtuDiscoveryAlarm()->IsSet());
 }
 
+TEST_P(QuicConnectionTest, CoarseIdleTimeoutBuckets) {
+  FLAGS_quic_reloadable_flag_quic_coarse_idle_timeout = true;
+  EXPECT_TRUE(connection_.connected());
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _)).Times(AnyNumber());
+
+  // Desynchronize the clock from whole-second boundaries, then install
+  // post-handshake timeouts (infinite handshake timeout).
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(137));
+  connection_.SetNetworkTimeouts(QuicTime::Delta::Infinite(),
+                                 QuicTime::Delta::FromSeconds(30));
+
+  // The deadline is quantized up to a whole-second bucket.
+  QuicTime deadline = connection_.GetTimeoutAlarm()->deadline();
+  EXPECT_EQ(0, (deadline - QuicTime::Zero()).ToMicroseconds() %
+                   (1000 * 1000));
+  EXPECT_LE(clock_.ApproximateNow(), deadline);
+
+  // The connection still idle-times out when the bucketed alarm fires.
+  EXPECT_CALL(visitor_, OnConnectionClosed(QUIC_NETWORK_IDLE_TIMEOUT, _,
+                                           ConnectionCloseSource::FROM_SELF));
+  clock_.AdvanceTime(deadline - clock_.ApproximateNow());
+  connection_.GetTimeoutAlarm()->Fire();
+  EXPECT_FALSE(connection_.GetTimeoutAlarm()->IsSet());
+  EXPECT_FALSE(connection_.connected());
+}
+
 TEST_P(QuicConnectionTest, HandshakeTimeout) {
   // Use a shorter handshake timeout than idle timeout for this test.
   const QuicTime::Delta timeout = QuicTime::Delta::FromSeconds(5);
@@ -3107,6 +3213,58 @@ TEST_P(QuicConnectionTest, MtuDiscoveryEnabled) {
   EXPECT_EQ(1u, connection_.mtu_probe_count());
 }
 
+// Tests that the kMTUB connection option probes the midpoint of the search
+// window and halves the window with every acknowledged probe.
+TEST_P(QuicConnectionTest, MtuDiscoveryBinarySearch) {
+  EXPECT_TRUE(connection_.connected());
+
+  connection_.EnableBinaryPathMtuDiscovery(send_algorithm_);
+
+  const QuicByteCount initial_mtu = connection_.max_packet_length();
+
+  // Send enough packets so that the next one triggers path MTU discovery.
+  QuicStreamOffset stream_offset = 0;
+  for (QuicPacketCount i = 0; i < kPacketsBetweenMtuProbesBase - 1; i++) {
+    SendStreamDataToPeer(3, ".", stream_offset++, NO_FIN, nullptr);
+    ASSERT_FALSE(connection_.GetMtuDiscoveryAlarm()->IsSet());
+  }
+
+  // Trigger the probe and expect the midpoint of [current MTU, ceiling].
+  SendStreamDataToPeer(3, "!", stream_offset++, NO_FIN, nullptr);
+  ASSERT_TRUE(connection_.GetMtuDiscoveryAlarm()->IsSet());
+  const QuicByteCount first_probe_size =
+      initial_mtu + (kMaxPacketSize - initial_mtu + 1) / 2;
+  QuicByteCount probe_size;
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _))
+      .WillOnce(DoAll(SaveArg<3>(&probe_size), Return(true)));
+  connection_.GetMtuDiscoveryAlarm()->Fire();
+  EXPECT_EQ(first_probe_size, probe_size);
+
+  // Acknowledge all packets sent so far; the probe raises the MTU.
+  QuicAckFrame probe_ack = InitAckFrame(creator_->packet_number());
+  EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
+  EXPECT_CALL(*send_algorithm_, OnCongestionEvent(true, _, _, _, _));
+  ProcessAckPacket(&probe_ack);
+  EXPECT_EQ(first_probe_size, connection_.max_packet_length());
+
+  // The next probe is scheduled after the same interval (binary search does
+  // not double the interval) and targets the midpoint of the halved window.
+  for (QuicPacketCount i = 0; i < kPacketsBetweenMtuProbesBase + 1; i++) {
+    SendStreamDataToPeer(3, ".", stream_offset++, NO_FIN, nullptr);
+    if (connection_.GetMtuDiscoveryAlarm()->IsSet()) {
+      break;
+    }
+  }
+  ASSERT_TRUE(connection_.GetMtuDiscoveryAlarm()->IsSet());
+  const QuicByteCount second_probe_size =
+      first_probe_size + (kMaxPacketSize - first_probe_size + 1) / 2;
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _))
+      .WillOnce(DoAll(SaveArg<3>(&probe_size), Return(true)));
+  connection_.GetMtuDiscoveryAlarm()->Fire();
+  EXPECT_EQ(second_probe_size, probe_size);
+  EXPECT_EQ(2u, connection_.mtu_probe_count());
+}
+
 // Tests whether MTU discovery works correctly when the probes never get
 // acknowledged.
 TEST_P(QuicConnectionTest, MtuDiscoveryFailed) {
@@ -3790,6 +3948,55 @@ TEST_P(QuicConnectionTest, SendDelayedAck) {
   EXPECT_FALSE(connection_.GetAckAlarm()->IsSet());
 }
 
+class RecordingAckScheduler : public QuicAckScheduler {
+ public:
+  void ScheduleAckAlarm(QuicConnection* connection,
+                        QuicTime deadline) override {
+    connection_ = connection;
+    deadline_ = deadline;
+    ++num_schedules_;
+  }
+
+  QuicConnection* connection_ = nullptr;
+  QuicTime deadline_ = QuicTime::Zero();
+  size_t num_schedules_ = 0;
+};
+
+TEST_P(QuicConnectionTest, SendDelayedAckViaAckScheduler) {
+  RecordingAckScheduler scheduler;
+  connection_.set_ack_scheduler(&scheduler);
+  QuicTime ack_time = clock_.ApproximateNow() + DefaultDelayedAckTime();
+  EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
+  const uint8_t tag = 0x07;
+  connection_.SetDecrypter(ENCRYPTION_INITIAL, new StrictTaggingDecrypter(tag));
+  peer_framer_.SetEncrypter(ENCRYPTION_INITIAL, new TaggingEncrypter(tag));
+  // Process a packet from the non-crypto stream.
+  frame1_.stream_id = 3;
+  EXPECT_CALL(visitor_, OnStreamFrame(_)).Times(1);
+  ProcessDataPacketAtLevel(1, !kHasStopWaiting, ENCRYPTION_INITIAL);
+
+  // The intent is registered with the scheduler; the connection's own ack
+  // alarm stays unarmed.
+  EXPECT_FALSE(connection_.GetAckAlarm()->IsSet());
+  EXPECT_EQ(1u, scheduler.num_schedules_);
+  EXPECT_EQ(&connection_, scheduler.connection_);
+  EXPECT_EQ(ack_time, scheduler.deadline_);
+
+  // A callback before the deadline is ignored.
+  connection_.OnBatchedAckAlarm();
+  EXPECT_TRUE(writer_->ack_frames().empty());
+
+  // Once the deadline passes, the callback sends the ack.
+  clock_.AdvanceTime(DefaultDelayedAckTime());
+  connection_.OnBatchedAckAlarm();
+  EXPECT_FALSE(writer_->ack_frames().empty());
+
+  // The deadline was consumed; a stale second callback does nothing.
+  writer_->Reset();
+  connection_.OnBatchedAckAlarm();
+  EXPECT_TRUE(writer_->ack_frames().empty());
+}
+
 TEST_P(QuicConnectionTest, SendDelayedAckDecimation) {
   EXPECT_CALL(visitor_, OnAckNeedsRetransmittableFrame()).Times(AnyNumber());
   QuicConnectionPeer::SetAckMode(&connection_, QuicConnection::ACK_DECIMATION);
@@ -5327,6 +5534,108 @@ TEST_P(QuicConnectionTest, FailedToWriteHandshakePacket) {
   connection_.SendCryptoStreamData();
 }
 
+TEST_P(QuicConnectionTest, FecParityEmittedWhenGroupIsFull) {
+  FLAGS_quic_reloadable_flag_quic_enable_xor_fec = true;
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  QuicConfig config;
+  QuicTagVector options;
+  options.push_back(kXFEC);
+  config.SetClientConnectionOptions(options);
+  connection_.SetFromConfig(config);
+
+  // No parity is emitted until a full group of packets has been sent.
+  for (size_t i = 0; i < kFecGroupSize; ++i) {
+    EXPECT_EQ(0u, writer_->fec_datagrams().size());
+    SendStreamDataToPeer(1, "foo", 3 * i, NO_FIN, nullptr);
+  }
+  ASSERT_EQ(1u, writer_->fec_datagrams().size());
+  EXPECT_EQ(1u, connection_.GetStats().fec_parity_sent);
+
+  const std::string& parity = writer_->fec_datagrams()[0];
+  QuicFecDatagram datagram;
+  ASSERT_TRUE(ParseFecDatagram(parity.data(), parity.length(), &datagram));
+  EXPECT_EQ(connection_.connection_id(), datagram.connection_id);
+  EXPECT_EQ(1u, datagram.min_protected_packet);
+  EXPECT_EQ(kFecGroupSize, datagram.protected_packet_lengths.size());
+}
+
+TEST_P(QuicConnectionTest, FecParityNotEmittedWhenNotNegotiated) {
+  FLAGS_quic_reloadable_flag_quic_enable_xor_fec = true;
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  QuicConfig config;
+  connection_.SetFromConfig(config);
+
+  for (size_t i = 0; i < kFecGroupSize; ++i) {
+    SendStreamDataToPeer(1, "foo", 3 * i, NO_FIN, nullptr);
+  }
+  EXPECT_EQ(0u, writer_->fec_datagrams().size());
+}
+
+TEST_P(QuicConnectionTest, FecDatagramRevivesMissingPacket) {
+  FLAGS_quic_reloadable_flag_quic_enable_xor_fec = true;
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  QuicConfig config;
+  QuicTagVector options;
+  options.push_back(kXFEC);
+  config.SetClientConnectionOptions(options);
+  connection_.SetFromConfig(config);
+  EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
+
+  // Build the encrypted form of one group of packets as the peer would send
+  // them.
+  std::vector<std::string> encrypted;
+  for (QuicPacketNumber i = 1; i <= kFecGroupSize; ++i) {
+    std::unique_ptr<QuicPacket> packet(ConstructDataPacket(i, false));
+    char buffer[kMaxPacketSize];
+    size_t encrypted_length = peer_framer_.EncryptPayload(
+        ENCRYPTION_NONE, i, *packet, buffer, kMaxPacketSize);
+    encrypted.push_back(std::string(buffer, encrypted_length));
+  }
+
+  // Deliver all of them but one.
+  const QuicPacketNumber kMissing = 5;
+  EXPECT_CALL(visitor_, OnStreamFrame(_)).Times(kFecGroupSize);
+  for (QuicPacketNumber i = 1; i <= kFecGroupSize; ++i) {
+    if (i == kMissing) {
+      continue;
+    }
+    connection_.ProcessUdpPacket(
+        kSelfAddress, kPeerAddress,
+        QuicReceivedPacket(encrypted[i - 1].data(), encrypted[i - 1].length(),
+                           clock_.Now(), false));
+  }
+  EXPECT_TRUE(IsMissing(kMissing));
+
+  // XOR the group's packets into a parity datagram, as the peer would.
+  size_t longest = 0;
+  for (const std::string& packet : encrypted) {
+    longest = std::max(longest, packet.length());
+  }
+  std::string parity(longest, '\0');
+  QuicFecDatagram datagram;
+  datagram.connection_id = connection_.connection_id();
+  datagram.min_protected_packet = 1;
+  for (const std::string& packet : encrypted) {
+    for (size_t i = 0; i < packet.length(); ++i) {
+      parity[i] ^= packet[i];
+    }
+    datagram.protected_packet_lengths.push_back(packet.length());
+  }
+  datagram.parity = parity;
+  char fec_buffer[2 * kMaxPacketSize];
+  const size_t fec_length =
+      SerializeFecDatagram(datagram, fec_buffer, sizeof(fec_buffer));
+  ASSERT_GT(fec_length, 0u);
+
+  // Processing the parity datagram revives the missing packet, which is
+  // decrypted and acked like any other received packet.
+  connection_.ProcessUdpPacket(
+      kSelfAddress, kPeerAddress,
+      QuicReceivedPacket(fec_buffer, fec_length, clock_.Now(), false));
+  EXPECT_FALSE(IsMissing(kMissing));
+  EXPECT_EQ(1u, connection_.GetStats().packets_revived);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
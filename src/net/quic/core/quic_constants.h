@@ -41,6 +41,11 @@ const QuicByteCount kDefaultTCPMSS = 1460;
 // We match SPDY's use of 32 (since we'd compete with SPDY).
 const QuicPacketCount kInitialCongestionWindow = 32;
 
+// Maximum number of packets the connection writes in one burst before
+// re-consulting the send algorithms, sized to fill a batching writer's
+// buffer with a single pass.
+const QuicPacketCount kMaxPacketBurstSize = 32;
+
 // Minimum size of initial flow control window, for both stream and session.
 const uint32_t kMinimumFlowControlSendWindow = 16 * 1024;  // 16 KB
 
@@ -0,0 +1,80 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_copy_counters.h"
+
+namespace net {
+
+std::atomic<bool> QuicCopyCounters::enabled_{false};
+std::atomic<uint64_t> QuicCopyCounters::copy_counts_[COPY_SITE_COUNT] = {};
+std::atomic<uint64_t> QuicCopyCounters::bytes_copied_[COPY_SITE_COUNT] = {};
+std::atomic<uint64_t> QuicCopyCounters::stream_buffer_allocations_{0};
+std::atomic<uint64_t> QuicCopyCounters::stream_buffer_bytes_allocated_{0};
+
+void QuicCopyCounters::Enable() {
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void QuicCopyCounters::Disable() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+void QuicCopyCounters::Reset() {
+  for (int i = 0; i < COPY_SITE_COUNT; ++i) {
+    copy_counts_[i].store(0, std::memory_order_relaxed);
+    bytes_copied_[i].store(0, std::memory_order_relaxed);
+  }
+  stream_buffer_allocations_.store(0, std::memory_order_relaxed);
+  stream_buffer_bytes_allocated_.store(0, std::memory_order_relaxed);
+}
+
+void QuicCopyCounters::RecordCopy(CopySite site, size_t bytes) {
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  copy_counts_[site].fetch_add(1, std::memory_order_relaxed);
+  bytes_copied_[site].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void QuicCopyCounters::RecordStreamBufferAllocation(size_t bytes) {
+  if (!enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  stream_buffer_allocations_.fetch_add(1, std::memory_order_relaxed);
+  stream_buffer_bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+uint64_t QuicCopyCounters::CopyCount(CopySite site) {
+  return copy_counts_[site].load(std::memory_order_relaxed);
+}
+
+uint64_t QuicCopyCounters::BytesCopied(CopySite site) {
+  return bytes_copied_[site].load(std::memory_order_relaxed);
+}
+
+uint64_t QuicCopyCounters::TotalCopyCount() {
+  uint64_t total = 0;
+  for (int i = 0; i < COPY_SITE_COUNT; ++i) {
+    total += copy_counts_[i].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t QuicCopyCounters::TotalBytesCopied() {
+  uint64_t total = 0;
+  for (int i = 0; i < COPY_SITE_COUNT; ++i) {
+    total += bytes_copied_[i].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t QuicCopyCounters::StreamBufferAllocationCount() {
+  return stream_buffer_allocations_.load(std::memory_order_relaxed);
+}
+
+uint64_t QuicCopyCounters::StreamBufferBytesAllocated() {
+  return stream_buffer_bytes_allocated_.load(std::memory_order_relaxed);
+}
+
+}  // namespace net
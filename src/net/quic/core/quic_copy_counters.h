@@ -0,0 +1,68 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_COPY_COUNTERS_H_
+#define NET_QUIC_CORE_QUIC_COPY_COUNTERS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// Process-wide copy and allocation instrumentation for regression tests.
+// Production code reports payload copies and stream buffer allocations
+// through the Record* hooks; regression tests enable the counters around a
+// scenario and assert per-request budgets. Disabled (the default), each hook
+// costs a single relaxed atomic load, so the hooks stay compiled into
+// production code. Counters are process-global: tests must not enable them
+// from concurrent scenarios.
+class QUIC_EXPORT_PRIVATE QuicCopyCounters {
+ public:
+  // Sites that copy payload bytes.
+  enum CopySite {
+    // QuicStreamSequencerBuffer copying received stream data in.
+    COPY_SITE_SEQUENCER_WRITE,
+    // QuicStreamSequencerBuffer copying stream data out to the reader.
+    COPY_SITE_SEQUENCER_READ,
+    // QuicPacketCreator copying application data into stream frames.
+    COPY_SITE_PACKET_CREATOR,
+    // QuicStreamSendBuffer copying application data in for retransmission.
+    COPY_SITE_STREAM_SEND_BUFFER,
+    COPY_SITE_COUNT,
+  };
+
+  QuicCopyCounters() = delete;
+
+  static void Enable();
+  static void Disable();
+  // Zeroes every counter. Only meaningful while disabled or quiescent.
+  static void Reset();
+
+  static void RecordCopy(CopySite site, size_t bytes);
+  static void RecordStreamBufferAllocation(size_t bytes);
+
+  // Number of copies and bytes copied at |site| since the last Reset().
+  static uint64_t CopyCount(CopySite site);
+  static uint64_t BytesCopied(CopySite site);
+  // Totals across all sites.
+  static uint64_t TotalCopyCount();
+  static uint64_t TotalBytesCopied();
+
+  static uint64_t StreamBufferAllocationCount();
+  static uint64_t StreamBufferBytesAllocated();
+
+ private:
+  static std::atomic<bool> enabled_;
+  static std::atomic<uint64_t> copy_counts_[COPY_SITE_COUNT];
+  static std::atomic<uint64_t> bytes_copied_[COPY_SITE_COUNT];
+  static std::atomic<uint64_t> stream_buffer_allocations_;
+  static std::atomic<uint64_t> stream_buffer_bytes_allocated_;
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_COPY_COUNTERS_H_
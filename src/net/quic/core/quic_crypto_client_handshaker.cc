@@ -648,6 +648,7 @@ void QuicCryptoClientHandshaker::DoReceiveSHLO(
   session()->connection()->SetDefaultEncryptionLevel(ENCRYPTION_FORWARD_SECURE);
 
   handshake_confirmed_ = true;
+  session()->connection()->OnAeadNegotiated(crypto_negotiated_params_->aead);
   session()->OnCryptoHandshakeEvent(QuicSession::HANDSHAKE_CONFIRMED);
   session()->connection()->OnHandshakeComplete();
 }
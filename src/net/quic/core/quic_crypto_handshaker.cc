@@ -4,7 +4,12 @@
 
 #include "net/quic/core/quic_crypto_handshaker.h"
 
+#include <memory>
+
+#include "net/quic/core/quic_connection.h"
 #include "net/quic/core/quic_session.h"
+#include "net/quic/platform/api/quic_flag_utils.h"
+#include "net/quic/platform/api/quic_flags.h"
 
 namespace net {
 
@@ -25,6 +30,15 @@ void QuicCryptoHandshaker::SendHandshakeMessage(
     const CryptoHandshakeMessage& message) {
   QUIC_DVLOG(1) << ENDPOINT << "Sending "
                 << message.DebugString(session()->perspective());
+  // Bundle the message with a pending ack and with whatever else is written
+  // while the bundler is open; a nested bundler is a no-op if the caller
+  // already holds one.
+  std::unique_ptr<QuicConnection::ScopedPacketBundler> bundler;
+  if (FLAGS_quic_reloadable_flag_quic_bundle_crypto_handshake_writes) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_bundle_crypto_handshake_writes);
+    bundler.reset(new QuicConnection::ScopedPacketBundler(
+        session()->connection(), QuicConnection::SEND_ACK_IF_PENDING));
+  }
   session()->connection()->NeuterUnencryptedPackets();
   session()->OnCryptoHandshakeMessageSent(message);
   const QuicData& data = message.GetSerialized(session()->perspective());
@@ -5,7 +5,9 @@
 #include "net/quic/core/quic_crypto_server_handshaker.h"
 
 #include <memory>
+#include <utility>
 
+#include "net/quic/core/quic_crypto_worker_interface.h"
 #include "net/quic/platform/api/quic_text_utils.h"
 #include "third_party/boringssl/src/include/openssl/sha.h"
 
@@ -45,6 +47,146 @@ class QuicCryptoServerHandshaker::ProcessClientHelloCallback
       result_;
 };
 
+namespace {
+
+// Runs the wrapped ProcessClientHelloResultCallback on the event loop thread
+// with a result captured on a crypto worker thread.
+class ProcessClientHelloResultCompletion
+    : public QuicCryptoWorkerInterface::Completion {
+ public:
+  ProcessClientHelloResultCompletion(
+      std::unique_ptr<ProcessClientHelloResultCallback> done_cb,
+      QuicErrorCode error,
+      const string& error_details,
+      std::unique_ptr<CryptoHandshakeMessage> message,
+      std::unique_ptr<DiversificationNonce> diversification_nonce,
+      std::unique_ptr<ProofSource::Details> proof_source_details)
+      : done_cb_(std::move(done_cb)),
+        error_(error),
+        error_details_(error_details),
+        message_(std::move(message)),
+        diversification_nonce_(std::move(diversification_nonce)),
+        proof_source_details_(std::move(proof_source_details)) {}
+
+  void Run() override {
+    done_cb_->Run(error_, error_details_, std::move(message_),
+                  std::move(diversification_nonce_),
+                  std::move(proof_source_details_));
+  }
+
+ private:
+  std::unique_ptr<ProcessClientHelloResultCallback> done_cb_;
+  const QuicErrorCode error_;
+  const string error_details_;
+  std::unique_ptr<CryptoHandshakeMessage> message_;
+  std::unique_ptr<DiversificationNonce> diversification_nonce_;
+  std::unique_ptr<ProofSource::Details> proof_source_details_;
+};
+
+// Marshals the result of an offloaded ProcessClientHello back to the event
+// loop thread before running |done_cb|, which is not thread safe.  May be
+// invoked from a worker thread (synchronous proof sources) or whatever thread
+// an asynchronous proof source completes on.
+class PostedProcessClientHelloCallback : public ProcessClientHelloResultCallback {
+ public:
+  PostedProcessClientHelloCallback(
+      QuicCryptoWorkerInterface* crypto_worker,
+      std::unique_ptr<ProcessClientHelloResultCallback> done_cb)
+      : crypto_worker_(crypto_worker), done_cb_(std::move(done_cb)) {}
+
+  void Run(QuicErrorCode error,
+           const string& error_details,
+           std::unique_ptr<CryptoHandshakeMessage> message,
+           std::unique_ptr<DiversificationNonce> diversification_nonce,
+           std::unique_ptr<ProofSource::Details> proof_source_details) override {
+    crypto_worker_->PostCompletion(
+        std::unique_ptr<QuicCryptoWorkerInterface::Completion>(
+            new ProcessClientHelloResultCompletion(
+                std::move(done_cb_), error, error_details, std::move(message),
+                std::move(diversification_nonce),
+                std::move(proof_source_details))));
+  }
+
+ private:
+  QuicCryptoWorkerInterface* crypto_worker_;
+  std::unique_ptr<ProcessClientHelloResultCallback> done_cb_;
+};
+
+// Invokes QuicCryptoServerConfig::ProcessClientHello, which performs the
+// handshake's key agreement and key derivation, on a crypto worker thread.
+// Everything captured here is passed by value, internally synchronized, or
+// owned exclusively by the handshake in flight.
+class ProcessClientHelloWork : public QuicCryptoWorkerInterface::Work {
+ public:
+  ProcessClientHelloWork(
+      const QuicCryptoServerConfig* crypto_config,
+      QuicReferenceCountedPointer<ValidateClientHelloResultCallback::Result>
+          validate_chlo_result,
+      QuicConnectionId connection_id,
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address,
+      QuicVersion version,
+      const QuicVersionVector& supported_versions,
+      bool use_stateless_rejects,
+      QuicConnectionId server_designated_connection_id,
+      const QuicClock* clock,
+      QuicRandom* rand,
+      QuicCompressedCertsCache* compressed_certs_cache,
+      QuicReferenceCountedPointer<QuicCryptoNegotiatedParameters> params,
+      QuicReferenceCountedPointer<QuicSignedServerConfig> signed_config,
+      QuicByteCount total_framing_overhead,
+      QuicByteCount chlo_packet_size,
+      std::unique_ptr<ProcessClientHelloResultCallback> done_cb)
+      : crypto_config_(crypto_config),
+        validate_chlo_result_(std::move(validate_chlo_result)),
+        connection_id_(connection_id),
+        server_address_(server_address),
+        client_address_(client_address),
+        version_(version),
+        supported_versions_(supported_versions),
+        use_stateless_rejects_(use_stateless_rejects),
+        server_designated_connection_id_(server_designated_connection_id),
+        clock_(clock),
+        rand_(rand),
+        compressed_certs_cache_(compressed_certs_cache),
+        params_(std::move(params)),
+        signed_config_(std::move(signed_config)),
+        total_framing_overhead_(total_framing_overhead),
+        chlo_packet_size_(chlo_packet_size),
+        done_cb_(std::move(done_cb)) {}
+
+  void Run() override {
+    crypto_config_->ProcessClientHello(
+        validate_chlo_result_, /*reject_only=*/false, connection_id_,
+        server_address_, client_address_, version_, supported_versions_,
+        use_stateless_rejects_, server_designated_connection_id_, clock_,
+        rand_, compressed_certs_cache_, params_, signed_config_,
+        total_framing_overhead_, chlo_packet_size_, std::move(done_cb_));
+  }
+
+ private:
+  const QuicCryptoServerConfig* crypto_config_;
+  QuicReferenceCountedPointer<ValidateClientHelloResultCallback::Result>
+      validate_chlo_result_;
+  const QuicConnectionId connection_id_;
+  const QuicSocketAddress server_address_;
+  const QuicSocketAddress client_address_;
+  const QuicVersion version_;
+  const QuicVersionVector supported_versions_;
+  const bool use_stateless_rejects_;
+  const QuicConnectionId server_designated_connection_id_;
+  const QuicClock* clock_;
+  QuicRandom* rand_;
+  QuicCompressedCertsCache* compressed_certs_cache_;
+  QuicReferenceCountedPointer<QuicCryptoNegotiatedParameters> params_;
+  QuicReferenceCountedPointer<QuicSignedServerConfig> signed_config_;
+  const QuicByteCount total_framing_overhead_;
+  const QuicByteCount chlo_packet_size_;
+  std::unique_ptr<ProcessClientHelloResultCallback> done_cb_;
+};
+
+}  // namespace
+
 QuicCryptoServerHandshaker::QuicCryptoServerHandshaker(
     const QuicCryptoServerConfig* crypto_config,
     QuicCryptoServerStream* stream,
@@ -217,7 +359,18 @@ void QuicCryptoServerHandshaker::
     return;
   }
 
-  session()->OnConfigNegotiated();
+  {
+    // Config negotiation can generate frames of its own (e.g. window
+    // updates); bundle them with the pending CHLO ack. The bundler must be
+    // closed before the encrypters are swapped below, because an open
+    // packet's encryption level follows the packet creator's current level.
+    std::unique_ptr<QuicConnection::ScopedPacketBundler> bundler;
+    if (FLAGS_quic_reloadable_flag_quic_bundle_crypto_handshake_writes) {
+      bundler.reset(new QuicConnection::ScopedPacketBundler(
+          session()->connection(), QuicConnection::SEND_ACK_IF_PENDING));
+    }
+    session()->OnConfigNegotiated();
+  }
 
   config->ToHandshakeMessage(reply.get());
 
@@ -251,6 +404,7 @@ void QuicCryptoServerHandshaker::
 
   encryption_established_ = true;
   handshake_confirmed_ = true;
+  session()->connection()->OnAeadNegotiated(crypto_negotiated_params_->aead);
   session()->OnCryptoHandshakeEvent(QuicSession::HANDSHAKE_CONFIRMED);
 }
 
@@ -435,6 +589,33 @@ void QuicCryptoServerHandshaker::ProcessClientHello(
   QuicConnection* connection = session()->connection();
   const QuicConnectionId server_designated_connection_id =
       GenerateConnectionIdForReject(use_stateless_rejects_in_crypto_config);
+
+  QuicCryptoWorkerInterface* crypto_worker = helper_->crypto_worker();
+  if (crypto_worker != nullptr) {
+    std::unique_ptr<QuicCryptoWorkerInterface::Work> work(
+        new ProcessClientHelloWork(
+            crypto_config_, result, connection->connection_id(),
+            connection->self_address(), GetClientAddress(), version(),
+            connection->supported_versions(),
+            use_stateless_rejects_in_crypto_config,
+            server_designated_connection_id, connection->clock(),
+            connection->random_generator(), compressed_certs_cache_,
+            crypto_negotiated_params_, signed_config_,
+            QuicCryptoStream::CryptoMessageFramingOverhead(version()),
+            chlo_packet_size_,
+            std::unique_ptr<ProcessClientHelloResultCallback>(
+                new PostedProcessClientHelloCallback(crypto_worker,
+                                                     std::move(done_cb)))));
+    if (!crypto_worker->TryScheduleWork(&work)) {
+      // The pool backlog is full; do the work here so handshake load beyond
+      // the pool's budget degrades to synchronous processing.  The result is
+      // still delivered through the completion queue, preserving ordering
+      // with handshakes already offloaded.
+      work->Run();
+    }
+    return;
+  }
+
   crypto_config_->ProcessClientHello(
       result, /*reject_only=*/false, connection->connection_id(),
       connection->self_address(), GetClientAddress(), version(),
@@ -26,6 +26,7 @@ class CachedNetworkParameters;
 class CryptoHandshakeMessage;
 class QuicCryptoServerConfig;
 class QuicCryptoServerStreamBase;
+class QuicCryptoWorkerInterface;
 
 // TODO(alyssar) see what can be moved out of QuicCryptoServerStream with
 // various code and test refactoring.
@@ -149,6 +150,11 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerStream
     virtual bool CanAcceptClientHello(const CryptoHandshakeMessage& message,
                                       const QuicSocketAddress& self_address,
                                       std::string* error_details) const = 0;
+
+    // Returns the worker pool on which CPU-intensive handshake work should
+    // run, or nullptr if such work should run synchronously on the current
+    // thread.  The pool must outlive all streams using this helper.
+    virtual QuicCryptoWorkerInterface* crypto_worker() const { return nullptr; }
   };
 
   // |crypto_config| must outlive the stream.
@@ -0,0 +1,53 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_CRYPTO_WORKER_INTERFACE_H_
+#define NET_QUIC_CORE_QUIC_CRYPTO_WORKER_INTERFACE_H_
+
+#include <memory>
+
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// QuicCryptoWorkerInterface is an abstract interface to a pool of worker
+// threads on which a server runs CPU-intensive handshake work (key agreement
+// and key derivation), keeping the event loop thread free to process packets
+// for established connections.  Implementations must run scheduled work on a
+// worker thread and posted completions back on the event loop thread.
+class QUIC_EXPORT_PRIVATE QuicCryptoWorkerInterface {
+ public:
+  // A unit of CPU-intensive work.  Run() is invoked on a worker thread and
+  // must not touch any state owned by the event loop thread.
+  class QUIC_EXPORT_PRIVATE Work {
+   public:
+    virtual ~Work() {}
+    virtual void Run() = 0;
+  };
+
+  // A continuation to be run on the event loop thread once some offloaded
+  // work has produced its result.
+  class QUIC_EXPORT_PRIVATE Completion {
+   public:
+    virtual ~Completion() {}
+    virtual void Run() = 0;
+  };
+
+  virtual ~QuicCryptoWorkerInterface() {}
+
+  // Schedules |work| to run on a worker thread.  Returns false without taking
+  // ownership when the worker backlog is at capacity; the caller should then
+  // fall back to doing the work synchronously on the current thread, so
+  // handshake load beyond the pool's configured share of CPU degrades to the
+  // unoffloaded behavior instead of queueing without bound.
+  virtual bool TryScheduleWork(std::unique_ptr<Work>* work) = 0;
+
+  // Posts |completion| to run on the event loop thread.  May be called from
+  // any thread.
+  virtual void PostCompletion(std::unique_ptr<Completion> completion) = 0;
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_CRYPTO_WORKER_INTERFACE_H_
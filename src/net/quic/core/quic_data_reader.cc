@@ -4,6 +4,8 @@
 
 #include "net/quic/core/quic_data_reader.h"
 
+#include <cstring>
+
 #include "net/base/int128.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_utils.h"
@@ -195,6 +197,25 @@ void QuicDataReader::OnFailure() {
   pos_ = len_;
 }
 
+size_t QuicDataReader::SkipRepeatedByte(uint8_t value) {
+  const size_t start = pos_;
+  // Compare eight bytes per iteration against a word filled with |value|.
+  uint64_t pattern;
+  memset(&pattern, value, sizeof(pattern));
+  while (len_ - pos_ >= sizeof(pattern)) {
+    uint64_t word;
+    memcpy(&word, data_ + pos_, sizeof(word));
+    if (word != pattern) {
+      break;
+    }
+    pos_ += sizeof(pattern);
+  }
+  while (pos_ < len_ && static_cast<uint8_t>(data_[pos_]) == value) {
+    ++pos_;
+  }
+  return pos_ - start;
+}
+
 uint8_t QuicDataReader::PeekByte() const {
   if (pos_ >= len_) {
     QUIC_BUG << "Reading is done, cannot peek next byte. Tried to read pos = "
@@ -125,6 +125,12 @@ class QUIC_EXPORT_PRIVATE QuicDataReader {
   // DOES NOT forward the internal iterator.
   uint8_t PeekByte() const;
 
+  // Advances the reader past all immediately following bytes equal to |value|
+  // and returns how many bytes were skipped.  Scans word-at-a-time, so
+  // consuming a long run (e.g. the padding of a handshake packet) costs far
+  // less than peeking and reading one byte per iteration.
+  size_t SkipRepeatedByte(uint8_t value);
+
   void set_endianness(Endianness endianness) { endianness_ = endianness; }
 
  private:
@@ -51,6 +51,9 @@ enum QuicRstStreamErrorCode {
   QUIC_PUSH_STREAM_TIMED_OUT,
   // Received headers were too large.
   QUIC_HEADERS_TOO_LARGE,
+  // The data on this stream exceeded its time to live and was discarded
+  // instead of being (re)transmitted.
+  QUIC_STREAM_TTL_EXPIRED,
   // No error. Used as bound while iterating.
   QUIC_STREAM_LAST_ERROR,
 };
@@ -0,0 +1,114 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_fec_datagram.h"
+
+#include <cstring>
+
+namespace net {
+
+namespace {
+
+uint64_t ReadUInt64(const char* data) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < 8; ++i) {
+    value = (value << 8) | static_cast<uint8_t>(data[i]);
+  }
+  return value;
+}
+
+void WriteUInt64(uint64_t value, char* data) {
+  for (size_t i = 0; i < 8; ++i) {
+    data[i] = static_cast<char>(value >> (8 * (7 - i)));
+  }
+}
+
+}  // namespace
+
+QuicFecDatagram::QuicFecDatagram()
+    : connection_id(0), min_protected_packet(0) {}
+
+QuicFecDatagram::QuicFecDatagram(const QuicFecDatagram& other) = default;
+
+QuicFecDatagram::~QuicFecDatagram() {}
+
+bool IsFecDatagram(const char* data, size_t length) {
+  return length >= 1 && static_cast<uint8_t>(data[0]) == kFecDatagramMarker;
+}
+
+bool ParseFecDatagramConnectionId(const char* data,
+                                  size_t length,
+                                  QuicConnectionId* connection_id) {
+  if (!IsFecDatagram(data, length) || length < 1 + 8) {
+    return false;
+  }
+  *connection_id = ReadUInt64(data + 1);
+  return true;
+}
+
+bool ParseFecDatagram(const char* data,
+                      size_t length,
+                      QuicFecDatagram* datagram) {
+  if (!IsFecDatagram(data, length) || length < kFecDatagramHeaderSize) {
+    return false;
+  }
+  datagram->connection_id = ReadUInt64(data + 1);
+  datagram->min_protected_packet = ReadUInt64(data + 9);
+  const size_t count = static_cast<uint8_t>(data[17]);
+  if (datagram->min_protected_packet == 0 || count == 0 ||
+      length < kFecDatagramHeaderSize + 2 * count) {
+    return false;
+  }
+  datagram->protected_packet_lengths.clear();
+  size_t offset = kFecDatagramHeaderSize;
+  size_t longest = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const uint16_t packet_length =
+        (static_cast<uint8_t>(data[offset]) << 8) |
+        static_cast<uint8_t>(data[offset + 1]);
+    if (packet_length == 0) {
+      return false;
+    }
+    if (packet_length > longest) {
+      longest = packet_length;
+    }
+    datagram->protected_packet_lengths.push_back(packet_length);
+    offset += 2;
+  }
+  if (length - offset < longest) {
+    return false;  // Parity cannot cover the longest protected packet.
+  }
+  datagram->parity = QuicStringPiece(data + offset, length - offset);
+  return true;
+}
+
+size_t SerializeFecDatagram(const QuicFecDatagram& datagram,
+                            char* buffer,
+                            size_t buffer_len) {
+  const size_t count = datagram.protected_packet_lengths.size();
+  const size_t total =
+      kFecDatagramHeaderSize + 2 * count + datagram.parity.length();
+  if (datagram.min_protected_packet == 0 || count == 0 || count > 255 ||
+      datagram.parity.empty() || buffer_len < total) {
+    return 0;
+  }
+  buffer[0] = static_cast<char>(kFecDatagramMarker);
+  WriteUInt64(datagram.connection_id, buffer + 1);
+  WriteUInt64(datagram.min_protected_packet, buffer + 9);
+  buffer[17] = static_cast<char>(count);
+  size_t offset = kFecDatagramHeaderSize;
+  for (size_t i = 0; i < count; ++i) {
+    const uint16_t packet_length = datagram.protected_packet_lengths[i];
+    if (packet_length == 0) {
+      return 0;
+    }
+    buffer[offset] = static_cast<char>(packet_length >> 8);
+    buffer[offset + 1] = static_cast<char>(packet_length & 0xFF);
+    offset += 2;
+  }
+  memcpy(buffer + offset, datagram.parity.data(), datagram.parity.length());
+  return total;
+}
+
+}  // namespace net
@@ -0,0 +1,86 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_FEC_DATAGRAM_H_
+#define NET_QUIC_CORE_QUIC_FEC_DATAGRAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "net/quic/core/quic_types.h"
+#include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+
+namespace net {
+
+// Wire framing for the XOR FEC parity datagrams negotiated with the kXFEC
+// connection option. Parity is computed over the encrypted packets as they
+// appear on the wire, so a revived packet re-enters the receiver through the
+// regular QuicFramer decryption path. A parity datagram is not itself a QUIC
+// packet:
+//
+//   [marker:1][connection id:8][min protected packet:8][count:1]
+//   [protected packet length:2]{count}[parity]
+//
+// with all fields in network byte order. The parity payload is as long as
+// the longest protected packet; shorter packets are treated as zero-padded,
+// and the per-packet lengths let the receiver truncate a revived packet back
+// to its exact wire length before decryption. The marker byte has the two
+// high bits set, which QuicFramer rejects as illegal public flags, so a
+// parity datagram can never be confused with a regular QUIC packet and peers
+// that did not negotiate kXFEC simply drop it as malformed.
+const uint8_t kFecDatagramMarker = 0xC1;
+
+// Number of consecutive packets protected by one parity datagram. Groups are
+// aligned to packet numbers: packet |p| belongs to group (p - 1) / size, so
+// both endpoints derive group membership without per-packet signaling.
+const size_t kFecGroupSize = 10;
+
+// Bytes of framing before the per-packet lengths.
+const size_t kFecDatagramHeaderSize = 1 + 8 + 8 + 1;
+
+// A parsed (or to-be-serialized) parity datagram. |parity| points into the
+// caller's buffer and is not owned.
+struct QUIC_EXPORT_PRIVATE QuicFecDatagram {
+  QuicFecDatagram();
+  QuicFecDatagram(const QuicFecDatagram& other);
+  ~QuicFecDatagram();
+
+  QuicConnectionId connection_id;
+  QuicPacketNumber min_protected_packet;
+  // Wire length of each protected packet, in packet number order starting at
+  // |min_protected_packet|.
+  std::vector<uint16_t> protected_packet_lengths;
+  QuicStringPiece parity;
+};
+
+// Returns true if |data| starts with the parity datagram marker.
+QUIC_EXPORT_PRIVATE bool IsFecDatagram(const char* data, size_t length);
+
+// Reads just the connection ID out of a parity datagram, for dispatching to
+// the owning connection without a full parse. Returns false if the datagram
+// is too short or does not carry the marker.
+QUIC_EXPORT_PRIVATE bool ParseFecDatagramConnectionId(
+    const char* data,
+    size_t length,
+    QuicConnectionId* connection_id);
+
+// Parses a parity datagram. |datagram->parity| points into |data|. Returns
+// false if the datagram is not well formed: missing marker, truncated, an
+// empty protected range, or a parity payload shorter than the longest
+// protected packet.
+QUIC_EXPORT_PRIVATE bool ParseFecDatagram(const char* data,
+                                          size_t length,
+                                          QuicFecDatagram* datagram);
+
+// Serializes |datagram| into |buffer|. Returns the number of bytes written,
+// or 0 if |buffer_len| is too small or |datagram| is not well formed.
+QUIC_EXPORT_PRIVATE size_t SerializeFecDatagram(const QuicFecDatagram& datagram,
+                                                char* buffer,
+                                                size_t buffer_len);
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_FEC_DATAGRAM_H_
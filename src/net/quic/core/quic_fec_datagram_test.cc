@@ -0,0 +1,97 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_fec_datagram.h"
+
+#include <string>
+
+#include "net/quic/platform/api/quic_test.h"
+
+using std::string;
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicFecDatagramTest : public QuicTest {};
+
+TEST_F(QuicFecDatagramTest, SerializeParseRoundTrip) {
+  QuicFecDatagram datagram;
+  datagram.connection_id = UINT64_C(0x0102030405060708);
+  datagram.min_protected_packet = 11;
+  datagram.protected_packet_lengths.push_back(3);
+  datagram.protected_packet_lengths.push_back(5);
+  datagram.parity = "fecce";
+
+  char buffer[64];
+  const size_t length = SerializeFecDatagram(datagram, buffer, sizeof(buffer));
+  ASSERT_EQ(kFecDatagramHeaderSize + 2 * 2 + 5, length);
+  EXPECT_TRUE(IsFecDatagram(buffer, length));
+
+  QuicConnectionId connection_id = 0;
+  EXPECT_TRUE(ParseFecDatagramConnectionId(buffer, length, &connection_id));
+  EXPECT_EQ(datagram.connection_id, connection_id);
+
+  QuicFecDatagram parsed;
+  ASSERT_TRUE(ParseFecDatagram(buffer, length, &parsed));
+  EXPECT_EQ(datagram.connection_id, parsed.connection_id);
+  EXPECT_EQ(11u, parsed.min_protected_packet);
+  EXPECT_EQ(datagram.protected_packet_lengths,
+            parsed.protected_packet_lengths);
+  EXPECT_EQ("fecce", parsed.parity);
+}
+
+TEST_F(QuicFecDatagramTest, MarkerIsIllegalPublicFlags) {
+  // The marker must never parse as a regular QUIC packet; the framer rejects
+  // public flags above 0x3F.
+  EXPECT_GT(kFecDatagramMarker, 0x3F);
+  const char regular_packet[] = {0x08, 0x01};
+  EXPECT_FALSE(IsFecDatagram(regular_packet, sizeof(regular_packet)));
+}
+
+TEST_F(QuicFecDatagramTest, SerializeRejectsMalformedInput) {
+  QuicFecDatagram datagram;
+  datagram.connection_id = 1;
+  datagram.min_protected_packet = 1;
+  datagram.protected_packet_lengths.push_back(3);
+  datagram.parity = "abc";
+
+  char buffer[64];
+  // Buffer too small.
+  EXPECT_EQ(0u, SerializeFecDatagram(datagram, buffer, 10));
+  // No protected packets.
+  QuicFecDatagram empty = datagram;
+  empty.protected_packet_lengths.clear();
+  EXPECT_EQ(0u, SerializeFecDatagram(empty, buffer, sizeof(buffer)));
+  // A zero-length protected packet.
+  QuicFecDatagram zero_length = datagram;
+  zero_length.protected_packet_lengths.push_back(0);
+  EXPECT_EQ(0u, SerializeFecDatagram(zero_length, buffer, sizeof(buffer)));
+}
+
+TEST_F(QuicFecDatagramTest, ParseRejectsMalformedInput) {
+  QuicFecDatagram datagram;
+  datagram.connection_id = 42;
+  datagram.min_protected_packet = 1;
+  datagram.protected_packet_lengths.push_back(4);
+  datagram.parity = "fecc";
+
+  char buffer[64];
+  const size_t length = SerializeFecDatagram(datagram, buffer, sizeof(buffer));
+  ASSERT_GT(length, 0u);
+
+  QuicFecDatagram parsed;
+  // Missing marker.
+  EXPECT_FALSE(ParseFecDatagram(buffer + 1, length - 1, &parsed));
+  // Truncated header.
+  EXPECT_FALSE(ParseFecDatagram(buffer, kFecDatagramHeaderSize - 1, &parsed));
+  // Parity shorter than the longest protected packet.
+  EXPECT_FALSE(ParseFecDatagram(buffer, length - 1, &parsed));
+  // Intact datagram still parses.
+  EXPECT_TRUE(ParseFecDatagram(buffer, length, &parsed));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
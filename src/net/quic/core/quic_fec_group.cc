@@ -0,0 +1,122 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_fec_group.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+QuicFecGroup::QuicFecGroup()
+    : min_protected_packet_(0),
+      num_protected_packets_(0),
+      has_parity_(false),
+      payload_parity_len_(0) {}
+
+QuicFecGroup::~QuicFecGroup() {}
+
+bool QuicFecGroup::Update(QuicPacketNumber packet_number,
+                          QuicStringPiece payload) {
+  if (payload.length() > kMaxPacketSize) {
+    QUIC_DLOG(ERROR) << "Payload of packet " << packet_number
+                     << " too large for FEC group: " << payload.length();
+    return false;
+  }
+  if (received_packets_.count(packet_number) > 0) {
+    return false;
+  }
+  if (has_parity_ &&
+      (packet_number < min_protected_packet_ ||
+       packet_number >= min_protected_packet_ + num_protected_packets_)) {
+    return false;
+  }
+  XorIntoParity(payload);
+  received_packets_.insert(packet_number);
+  return true;
+}
+
+bool QuicFecGroup::UpdateFec(QuicPacketNumber min_protected_packet,
+                             size_t num_protected_packets,
+                             QuicStringPiece parity) {
+  if (has_parity_ || num_protected_packets == 0 ||
+      parity.length() > kMaxPacketSize) {
+    return false;
+  }
+  for (QuicPacketNumber packet_number : received_packets_) {
+    if (packet_number < min_protected_packet ||
+        packet_number >= min_protected_packet + num_protected_packets) {
+      return false;
+    }
+  }
+  min_protected_packet_ = min_protected_packet;
+  num_protected_packets_ = num_protected_packets;
+  has_parity_ = true;
+  // After this XOR the parity buffer holds exactly the XOR of the payloads
+  // not yet received, i.e. the missing payload once only one is missing.
+  XorIntoParity(parity);
+  return true;
+}
+
+bool QuicFecGroup::CanRevive() const {
+  return has_parity_ && NumMissingPackets() == 1;
+}
+
+bool QuicFecGroup::IsFinished() const {
+  return has_parity_ && NumMissingPackets() == 0;
+}
+
+size_t QuicFecGroup::Revive(char* out_buffer, size_t out_buffer_len) {
+  if (!CanRevive() || out_buffer_len < payload_parity_len_) {
+    return 0;
+  }
+  const QuicPacketNumber revived = missing_packet_number();
+  memcpy(out_buffer, payload_parity_, payload_parity_len_);
+  const size_t revived_length = payload_parity_len_;
+  // Recording the revived packet cancels its contribution to the parity, so
+  // the buffer returns to tracking missing payloads (now none).
+  XorIntoParity(QuicStringPiece(out_buffer, revived_length));
+  received_packets_.insert(revived);
+  return revived_length;
+}
+
+QuicPacketNumber QuicFecGroup::missing_packet_number() const {
+  DCHECK(CanRevive());
+  for (size_t i = 0; i < num_protected_packets_; ++i) {
+    if (received_packets_.count(min_protected_packet_ + i) == 0) {
+      return min_protected_packet_ + i;
+    }
+  }
+  QUIC_BUG << "No missing packet in a revivable FEC group.";
+  return 0;
+}
+
+size_t QuicFecGroup::NumMissingPackets() const {
+  if (!has_parity_) {
+    return 0;
+  }
+  size_t missing = 0;
+  for (size_t i = 0; i < num_protected_packets_; ++i) {
+    if (received_packets_.count(min_protected_packet_ + i) == 0) {
+      ++missing;
+    }
+  }
+  return missing;
+}
+
+void QuicFecGroup::XorIntoParity(QuicStringPiece data) {
+  if (data.length() > payload_parity_len_) {
+    memset(payload_parity_ + payload_parity_len_, 0,
+           data.length() - payload_parity_len_);
+    payload_parity_len_ = data.length();
+  }
+  for (size_t i = 0; i < data.length(); ++i) {
+    payload_parity_[i] ^= data[i];
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,103 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_FEC_GROUP_H_
+#define NET_QUIC_CORE_QUIC_FEC_GROUP_H_
+
+#include <cstddef>
+#include <set>
+
+#include "base/macros.h"
+#include "net/quic/core/quic_constants.h"
+#include "net/quic/core/quic_types.h"
+#include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+
+namespace net {
+
+// Tracks one XOR forward error correction group: a run of consecutive data
+// packets protected by a single parity payload, negotiated with the kXFEC
+// connection option. The same class serves both directions. A sender feeds
+// each protected packet's payload to Update() and emits payload_parity() as
+// the parity packet. A receiver feeds the payloads it received to Update(),
+// records the parity with UpdateFec(), and when exactly one protected packet
+// is missing revives that packet's payload with Revive() instead of waiting a
+// retransmission RTT.
+//
+// Payloads within a group may differ in length; shorter ones are treated as
+// zero-padded to the longest. A revived payload therefore carries trailing
+// zero bytes, which parse as PADDING frames.
+class QUIC_EXPORT_PRIVATE QuicFecGroup {
+ public:
+  QuicFecGroup();
+  ~QuicFecGroup();
+
+  // XORs |payload| of |packet_number| into the running parity. Returns false
+  // if the packet was already recorded, lies outside the protected range
+  // announced by UpdateFec(), or |payload| exceeds kMaxPacketSize.
+  bool Update(QuicPacketNumber packet_number, QuicStringPiece payload);
+
+  // Receiver only: records the parity payload protecting the
+  // |num_protected_packets| packets starting at |min_protected_packet|.
+  // Returns false if a parity was already recorded, the range is empty, or a
+  // previously recorded packet falls outside the range.
+  bool UpdateFec(QuicPacketNumber min_protected_packet,
+                 size_t num_protected_packets,
+                 QuicStringPiece parity);
+
+  // True if the parity has been recorded and exactly one protected packet is
+  // missing, i.e. Revive() will succeed.
+  bool CanRevive() const;
+
+  // True if the parity has been recorded and every protected packet arrived,
+  // so the group can be discarded.
+  bool IsFinished() const;
+
+  // Writes the revived payload of the single missing packet to |out_buffer|
+  // and records that packet as received. Returns the payload length, or 0 if
+  // CanRevive() is false or |out_buffer_len| is too small.
+  size_t Revive(char* out_buffer, size_t out_buffer_len);
+
+  // Packet number of the single missing packet. Only valid when CanRevive()
+  // is true.
+  QuicPacketNumber missing_packet_number() const;
+
+  // Number of protected packets not yet recorded. Zero until UpdateFec() is
+  // called.
+  size_t NumMissingPackets() const;
+
+  // The running XOR of all payloads fed in so far. On the sender this is the
+  // parity payload to emit once the group is full.
+  QuicStringPiece payload_parity() const {
+    return QuicStringPiece(payload_parity_, payload_parity_len_);
+  }
+
+  size_t num_received_packets() const { return received_packets_.size(); }
+  QuicPacketNumber min_protected_packet() const {
+    return min_protected_packet_;
+  }
+
+ private:
+  // XORs |data| into |payload_parity_|, growing the parity length to cover it.
+  void XorIntoParity(QuicStringPiece data);
+
+  // Packets fed to Update() (or revived) so far.
+  std::set<QuicPacketNumber> received_packets_;
+
+  // First packet covered by the parity; 0 until UpdateFec() is called.
+  QuicPacketNumber min_protected_packet_;
+  // Number of packets covered by the parity; 0 until UpdateFec() is called.
+  size_t num_protected_packets_;
+  // True once UpdateFec() has recorded the parity payload.
+  bool has_parity_;
+
+  char payload_parity_[kMaxPacketSize];
+  size_t payload_parity_len_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicFecGroup);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_FEC_GROUP_H_
@@ -0,0 +1,108 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_fec_group.h"
+
+#include <string>
+
+#include "net/quic/platform/api/quic_test.h"
+
+using std::string;
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicFecGroupTest : public QuicTest {};
+
+TEST_F(QuicFecGroupTest, SenderParityIsXorOfPayloads) {
+  QuicFecGroup sender;
+  EXPECT_TRUE(sender.Update(1, "abc"));
+  EXPECT_TRUE(sender.Update(2, "xyz"));
+  QuicStringPiece parity = sender.payload_parity();
+  ASSERT_EQ(3u, parity.length());
+  EXPECT_EQ('a' ^ 'x', parity[0]);
+  EXPECT_EQ('b' ^ 'y', parity[1]);
+  EXPECT_EQ('c' ^ 'z', parity[2]);
+  // Duplicate packets are rejected.
+  EXPECT_FALSE(sender.Update(2, "xyz"));
+}
+
+TEST_F(QuicFecGroupTest, ReviveSingleMissingPacket) {
+  // Sender computes the parity over three packets.
+  QuicFecGroup sender;
+  ASSERT_TRUE(sender.Update(10, "foo"));
+  ASSERT_TRUE(sender.Update(11, "quux"));
+  ASSERT_TRUE(sender.Update(12, "bar"));
+
+  // Receiver misses packet 11.
+  QuicFecGroup receiver;
+  ASSERT_TRUE(receiver.Update(10, "foo"));
+  ASSERT_TRUE(receiver.Update(12, "bar"));
+  EXPECT_FALSE(receiver.CanRevive());
+  ASSERT_TRUE(receiver.UpdateFec(10, 3, sender.payload_parity()));
+  EXPECT_EQ(1u, receiver.NumMissingPackets());
+  ASSERT_TRUE(receiver.CanRevive());
+  EXPECT_EQ(11u, receiver.missing_packet_number());
+
+  char buf[kMaxPacketSize];
+  const size_t revived_length = receiver.Revive(buf, sizeof(buf));
+  ASSERT_EQ(4u, revived_length);
+  // Shorter payloads in the group are zero-padded to the longest, so the
+  // revived payload of "quux" carries no padding here but "foo" would.
+  EXPECT_EQ("quux", string(buf, revived_length));
+  EXPECT_TRUE(receiver.IsFinished());
+  EXPECT_FALSE(receiver.CanRevive());
+}
+
+TEST_F(QuicFecGroupTest, RevivedShorterPayloadIsZeroPadded) {
+  QuicFecGroup sender;
+  ASSERT_TRUE(sender.Update(1, "ab"));
+  ASSERT_TRUE(sender.Update(2, "wxyz"));
+
+  QuicFecGroup receiver;
+  ASSERT_TRUE(receiver.Update(2, "wxyz"));
+  ASSERT_TRUE(receiver.UpdateFec(1, 2, sender.payload_parity()));
+  ASSERT_TRUE(receiver.CanRevive());
+
+  char buf[kMaxPacketSize];
+  const size_t revived_length = receiver.Revive(buf, sizeof(buf));
+  ASSERT_EQ(4u, revived_length);
+  EXPECT_EQ(string("ab\0\0", 4), string(buf, revived_length));
+}
+
+TEST_F(QuicFecGroupTest, CannotReviveWithTwoMissingPackets) {
+  QuicFecGroup sender;
+  ASSERT_TRUE(sender.Update(1, "aaa"));
+  ASSERT_TRUE(sender.Update(2, "bbb"));
+  ASSERT_TRUE(sender.Update(3, "ccc"));
+
+  QuicFecGroup receiver;
+  ASSERT_TRUE(receiver.Update(2, "bbb"));
+  ASSERT_TRUE(receiver.UpdateFec(1, 3, sender.payload_parity()));
+  EXPECT_EQ(2u, receiver.NumMissingPackets());
+  EXPECT_FALSE(receiver.CanRevive());
+  char buf[kMaxPacketSize];
+  EXPECT_EQ(0u, receiver.Revive(buf, sizeof(buf)));
+
+  // Once the second missing packet arrives, the last one is revivable.
+  ASSERT_TRUE(receiver.Update(1, "aaa"));
+  ASSERT_TRUE(receiver.CanRevive());
+  EXPECT_EQ(3u, receiver.missing_packet_number());
+}
+
+TEST_F(QuicFecGroupTest, RejectsPacketsOutsideProtectedRange) {
+  QuicFecGroup receiver;
+  ASSERT_TRUE(receiver.Update(5, "abc"));
+  // A recorded packet outside the announced range invalidates the parity.
+  EXPECT_FALSE(receiver.UpdateFec(1, 3, "xor"));
+  // With a recorded parity, out-of-range packets are rejected.
+  ASSERT_TRUE(receiver.UpdateFec(4, 3, "xor"));
+  EXPECT_FALSE(receiver.Update(8, "def"));
+  EXPECT_TRUE(receiver.Update(4, "def"));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -202,3 +202,203 @@ QUIC_FLAG(
     bool,
     FLAGS_quic_reloadable_flag_quic_set_version_on_async_get_proof_returns,
     false)
+
+// If true, the toy QUIC server batches outgoing packets and sends them with
+// sendmmsg() (using UDP GSO for uniform-sized runs where the kernel supports
+// it) instead of issuing one sendto() per packet.
+QUIC_FLAG(bool, FLAGS_quic_use_batched_packet_writer, false)
+
+// If true, the toy QUIC server multiplexes all connection alarms onto a
+// single EpollServer alarm through a hierarchical timer wheel, making arm
+// and cancel O(1) and coalescing deadlines that fall in the same wheel
+// slot, instead of registering each alarm with EpollServer's alarm map.
+QUIC_FLAG(bool, FLAGS_quic_use_timer_wheel_alarms, false)
+
+// If positive, the toy QUIC server busy-polls for this many microseconds
+// before sleeping in epoll_wait, and sets SO_BUSY_POLL on its socket with
+// the same budget, trading CPU for sub-scheduler-latency packet wakeups.
+QUIC_FLAG(int64_t, FLAGS_quic_server_busy_poll_budget_us, 0)
+
+// If true, the toy QUIC server requests raw NIC receive timestamps
+// (SOF_TIMESTAMPING_RAW_HARDWARE) on its socket, so per-packet receipt
+// times fed to the bandwidth sampler come from the NIC when available.
+QUIC_FLAG(bool, FLAGS_quic_server_use_hardware_timestamps, false)
+
+// If positive, the time-wait list manager sends at most this many public
+// reset packets per second to any single source address; further stray
+// packets from that address are ignored until its token bucket refills.
+// Zero (the default) disables the limit.
+QUIC_FLAG(int64_t,
+          FLAGS_quic_time_wait_public_resets_per_address_per_second,
+          0)
+
+// If positive, the toy QUIC server runs handshake key agreement on this many
+// dedicated crypto worker threads instead of the dispatcher thread, so a
+// connection-setup storm cannot starve packet processing for established
+// connections.
+QUIC_FLAG(int64_t, FLAGS_quic_server_crypto_worker_threads, 0)
+
+// If true, the toy QUIC server serves forward-secure handshakes from a ring
+// of precomputed Curve25519 key pairs, refilled on the crypto worker threads
+// when FLAGS_quic_server_crypto_worker_threads is positive, so ephemeral key
+// generation is off the handshake critical path.
+QUIC_FLAG(bool, FLAGS_quic_server_precomputed_key_shares, false)
+
+// If true, stream data arriving exactly in order while nothing is buffered
+// is handed to the stream as a view into the decrypted packet buffer; only
+// whatever the stream does not consume before returning is copied into the
+// stream sequencer buffer.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_sequencer_zero_copy, false)
+
+// If true, the retransmittable frame payloads of each sent packet are
+// relocated from individual heap allocations into one contiguous arena
+// block owned by the packet's QuicTransmissionInfo, so acks walk compact
+// memory and allocator traffic drops with many packets in flight.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_arena_retransmittable_frames,
+          false)
+
+// If true, QuicConnection asks the sent packet manager once per burst how
+// many packets the pacer permits right now and skips the per-packet
+// TimeUntilSend consultation for the rest of the burst.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_connection_write_bursts, false)
+
+// If true, the BBR3 connection option lowers BBR's STARTUP pacing gain in
+// proportion to the measured ack aggregation and grants the congestion
+// window a matching allowance, so startup on paths with aggregated acks
+// does not build multi-hundred-millisecond queues.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_bbr_adaptive_startup_gain,
+          false)
+
+// If true, ack processing walks the acked packet number intervals instead
+// of probing every packet between the least unacked and largest observed,
+// and loss detection resumes its scan from the least packet still in
+// flight, so work per ack scales with newly acked packets rather than the
+// number of packets outstanding.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_incremental_ack_processing,
+          false)
+
+// If true, loss detection derives its reordering delay from the windowed
+// maximum RTT kept by RttStats rather than the last two samples, and BBR
+// falls back to the windowed minimum RTT before it has a sample of its own.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_windowed_rtt, false)
+
+// If true, ack frames carry the cumulative count of CE-marked packets
+// received and senders are told about new marks, enabling ECN-reactive
+// congestion control. Both endpoints must enable the flag, as it appends
+// the count to the ack frame wire format. Deployable only where we control
+// both sides (e.g. intra-DC traffic).
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_ack_ecn_counts, false)
+
+// If true, QuicFramer decrypts packets in place within the received buffer
+// (skipping the copy into a separate decryption buffer) once the connection
+// is at the forward-secure level with no alternative decrypter, i.e. when no
+// other key could ever decrypt the packet.  Requires packet buffers handed
+// to the framer to be writable.
+QUIC_FLAG(bool, FLAGS_quic_framer_decrypt_in_place, false)
+
+// If true, server connections register delayed acks with a shared
+// dispatcher-level scheduler which drains per-epoch buckets with a single
+// alarm, instead of each connection arming and cancelling its own ack alarm.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_dispatcher_ack_batching,
+          false)
+
+// If true, the stream-frame fast path serializes several plaintext packets
+// per pass and encrypts them with one call into the encrypter's batch
+// interface, instead of encrypting each packet inline as it is serialized.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_batched_egress_encryption,
+          false)
+
+// If true, when the peer migrates the connection retains the congestion state
+// of the old path, probes the new path with a ping, and restores cached
+// congestion state conservatively when returning to a previously validated
+// path instead of resetting rtt and cwnd from scratch.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_validated_path_cache, false)
+
+// If true, receive window auto-tuning sizes the window from the measured
+// application drain rate and rtt (2x the bandwidth-delay product, with
+// hysteresis, shrinking when the application drains slowly) instead of
+// doubling whenever window updates are sent faster than every two rtts.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_bdp_flow_control, false)
+
+// If true, WINDOW_UPDATE frames are accumulated per stream and ride in the
+// next outgoing data or ack packet, or are flushed by an alarm after a
+// quarter of the smoothed rtt, instead of each update being sent in its own
+// packet the moment a stream hits its update threshold.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_coalesce_window_updates, false)
+
+// If true, HEADERS and DATA frames for the headers stream are serialized
+// directly into a buffer owned by the stream's send buffer, instead of
+// through an intermediate SpdySerializedFrame which is then copied.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_headers_stream_zero_copy, false)
+
+// If true, QuicSession::OnCanWrite drains ready streams in batches popped
+// from the write blocked list, instead of consulting the scheduler once for
+// every stream written.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_batched_write_scheduling, false)
+
+// If true, the headers stream decodes at most a fixed budget of compressed
+// header bytes per event loop iteration, resuming from an alarm so one
+// connection's giant header blocks cannot starve other connections on the
+// same thread.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_headers_stream_decode_budget,
+          false)
+
+// If true, header blocks which decompress to more than eight times the
+// inbound header list size limit fail decoding outright instead of being
+// decoded in full and truncated afterwards.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_headers_decode_expansion_limit,
+          false)
+
+// If true and the packet writer supports release times (SO_TXTIME), paced
+// packets due within the next few milliseconds are handed to the kernel
+// immediately with a release timestamp, letting the fq qdisc enforce the
+// inter-packet gaps instead of a userspace send alarm per pacing interval.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_pacing_offload, false)
+
+// If true, the server grows the listening socket's SO_RCVBUF whenever the
+// kernel reports newly dropped packets (SO_RXQ_OVFL), up to
+// FLAGS_quic_server_max_rcvbuf_bytes, instead of keeping the fixed size set
+// at startup.
+QUIC_FLAG(bool, FLAGS_quic_server_rcvbuf_autotune, false)
+
+// Upper bound, in bytes, on the receive buffer the autotuner will request
+// with SO_RCVBUF.
+QUIC_FLAG(int64_t, FLAGS_quic_server_max_rcvbuf_bytes, 16 * 1024 * 1024)
+
+// If true, pending retransmissions are sent highest-stream-priority first
+// (using the priority stamped on each sent packet) instead of in packet
+// number order, so a loss burst on a mixed connection recovers interactive
+// data before bulk data. Crypto packets still go first.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_priority_ordered_retransmission,
+          false)
+
+// If true, each handshake message write opens a packet bundler on the
+// connection, so crypto stream data shares packets with pending acks and
+// with any other frames generated in the same event, instead of each
+// message flushing its own partially filled packet.
+QUIC_FLAG(bool,
+          FLAGS_quic_reloadable_flag_quic_bundle_crypto_handshake_writes,
+          false)
+
+// If true, idle-timeout and keepalive deadlines are rounded up into coarse
+// one-second buckets once the handshake completes. Bucketed deadlines from
+// many connections collapse into shared alarm slots (timer wheel buckets),
+// and keepalives that fire together share a flush through a batching packet
+// writer. Timeouts may fire up to one bucket late.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_coarse_idle_timeout, false)
+
+// If true, connections honor the kXFEC connection option: every
+// kFecGroupSize sent packets are followed by a best-effort XOR parity
+// datagram, and a received parity datagram revives the single missing packet
+// of its group without waiting a retransmission RTT. Costs one parity
+// datagram of bandwidth per group plus up to kMaxPacketSize of parity state
+// per in-flight group on each side.
+QUIC_FLAG(bool, FLAGS_quic_reloadable_flag_quic_enable_xor_fec, false)
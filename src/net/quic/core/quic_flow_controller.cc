@@ -39,7 +39,9 @@ QuicFlowController::QuicFlowController(
       auto_tune_receive_window_(should_auto_tune_receive_window),
       session_flow_controller_(session_flow_controller),
       last_blocked_send_window_offset_(0),
-      prev_window_update_time_(QuicTime::Zero()) {
+      prev_window_update_time_(QuicTime::Zero()),
+      bytes_consumed_at_prev_window_update_(0),
+      receive_window_size_floor_(receive_window_offset) {
   receive_window_size_limit_ = (id_ == kConnectionLevelId)
                                    ? kSessionReceiveWindowLimit
                                    : kStreamReceiveWindowLimit;
@@ -121,6 +123,9 @@ void QuicFlowController::MaybeIncreaseMaxWindowSize() {
   QuicTime now = connection_->clock()->ApproximateNow();
   QuicTime prev = prev_window_update_time_;
   prev_window_update_time_ = now;
+  const QuicByteCount bytes_drained =
+      bytes_consumed_ - bytes_consumed_at_prev_window_update_;
+  bytes_consumed_at_prev_window_update_ = bytes_consumed_;
   if (!prev.IsInitialized()) {
     QUIC_DVLOG(1) << ENDPOINT << "first window update for stream " << id_;
     return;
@@ -138,6 +143,12 @@ void QuicFlowController::MaybeIncreaseMaxWindowSize() {
     return;
   }
 
+  if (FLAGS_quic_reloadable_flag_quic_bdp_flow_control) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_bdp_flow_control);
+    AdjustWindowTowardsBdp(now - prev, rtt, bytes_drained);
+    return;
+  }
+
   // Now we can compare timing of window updates with RTT.
   QuicTime::Delta since_last = now - prev;
   QuicTime::Delta two_rtt = 2 * rtt;
@@ -168,6 +179,49 @@ void QuicFlowController::MaybeIncreaseMaxWindowSize() {
   }
 }
 
+void QuicFlowController::AdjustWindowTowardsBdp(QuicTime::Delta since_last,
+                                                QuicTime::Delta rtt,
+                                                QuicByteCount bytes_drained) {
+  if (since_last.IsZero()) {
+    return;
+  }
+
+  // Estimate the bandwidth-delay product from the rate at which the
+  // application drained data since the last window update, and aim for a
+  // window of twice that so neither endpoint stalls on the window.
+  const QuicByteCount bdp =
+      bytes_drained * rtt.ToMicroseconds() / since_last.ToMicroseconds();
+  QuicByteCount target_window = 2 * bdp;
+  target_window = std::max(target_window, receive_window_size_floor_);
+  target_window = std::min(target_window, receive_window_size_limit_);
+
+  const QuicByteCount old_window = receive_window_size_;
+  if (target_window > old_window + old_window / 4) {
+    // The flow is window limited; grow straight to the target.
+    receive_window_size_ = target_window;
+    QUIC_DVLOG(1) << ENDPOINT << "BDP window increase for stream " << id_
+                  << ", drained " << bytes_drained << " bytes in "
+                  << since_last.ToMicroseconds() << " us, rtt "
+                  << rtt.ToMicroseconds()
+                  << " us. New window: " << receive_window_size_;
+    if (session_flow_controller_ != nullptr) {
+      session_flow_controller_->EnsureWindowAtLeast(
+          kSessionFlowControlMultiplier * receive_window_size_);
+    }
+  } else if (target_window < old_window - old_window / 4) {
+    // The application drains far slower than the window allows; shrink to cap
+    // memory.  Shrink by at most half per update so the window never drops
+    // below the offset already advertised to the peer.
+    receive_window_size_ = std::max(target_window, old_window / 2);
+    QUIC_DVLOG(1) << ENDPOINT << "BDP window decrease for stream " << id_
+                  << ", drained " << bytes_drained << " bytes in "
+                  << since_last.ToMicroseconds() << " us, rtt "
+                  << rtt.ToMicroseconds()
+                  << " us. New window: " << receive_window_size_;
+  }
+  // Otherwise the window is within 25% of the target; leave it alone.
+}
+
 void QuicFlowController::IncreaseWindowSize() {
   receive_window_size_ *= 2;
   receive_window_size_ =
@@ -190,6 +244,7 @@ void QuicFlowController::MaybeSendWindowUpdate() {
     // Treat the initial window as if it is a window update, so if 1/2 the
     // window is used in less than 2 RTTs, the window is increased.
     prev_window_update_time_ = connection_->clock()->ApproximateNow();
+    bytes_consumed_at_prev_window_update_ = bytes_consumed_;
   }
 
   if (available_window >= threshold) {
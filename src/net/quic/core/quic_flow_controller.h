@@ -118,6 +118,15 @@ class QUIC_EXPORT_PRIVATE QuicFlowController
   // Double the window size as long as we haven't hit the max window size.
   void IncreaseWindowSize();
 
+  // Sizes the receive window towards twice the bandwidth-delay product
+  // estimated from the application drain rate over |since_last| and |rtt|.
+  // Grows or shrinks only when the target is more than 25% away from the
+  // current window (hysteresis), and never shrinks by more than half at once
+  // or below the window size the controller was created with.
+  void AdjustWindowTowardsBdp(QuicTime::Delta since_last,
+                              QuicTime::Delta rtt,
+                              QuicByteCount bytes_drained);
+
   // The parent connection, used to send connection close on flow control
   // violation, and WINDOW_UPDATE and BLOCKED frames when appropriate.
   // Not owned.
@@ -193,6 +202,15 @@ class QUIC_EXPORT_PRIVATE QuicFlowController
   // as part of the receive window auto tuning.
   QuicTime prev_window_update_time_;
 
+  // Value of |bytes_consumed_| when the last window update was sent.  Used to
+  // measure the application drain rate between window updates when
+  // FLAGS_quic_reloadable_flag_quic_bdp_flow_control is on.
+  QuicByteCount bytes_consumed_at_prev_window_update_;
+
+  // Receive window size this controller was created with.  BDP-based
+  // auto-tuning never shrinks the window below this.
+  QuicByteCount receive_window_size_floor_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicFlowController);
 };
 
@@ -6,6 +6,7 @@
 
 #include <memory>
 
+#include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_str_cat.h"
 #include "net/quic/platform/api/quic_test.h"
 #include "net/quic/test_tools/quic_connection_peer.h"
@@ -214,6 +215,59 @@ TEST_F(QuicFlowControllerTest, ReceivingBytesFastIncreasesFlowWindow) {
   EXPECT_GT(new_threshold, threshold);
 }
 
+TEST_F(QuicFlowControllerTest, BdpAutoTuneGrowsAndShrinksWindow) {
+  FLAGS_quic_reloadable_flag_quic_bdp_flow_control = true;
+  // This test will generate three WINDOW_UPDATE frames.
+  EXPECT_CALL(connection_, SendWindowUpdate(stream_id_, ::testing::_)).Times(3);
+
+  should_auto_tune_receive_window_ = true;
+  Initialize();
+  EXPECT_TRUE(flow_controller_->auto_tune_receive_window());
+
+  // Make sure clock is inititialized.
+  connection_.AdvanceTime(QuicTime::Delta::FromMilliseconds(1));
+
+  QuicSentPacketManager* manager =
+      QuicConnectionPeer::GetSentPacketManager(&connection_);
+  RttStats* rtt_stats = const_cast<RttStats*>(manager->GetRttStats());
+  rtt_stats->UpdateRtt(QuicTime::Delta::FromMilliseconds(kRtt),
+                       QuicTime::Delta::Zero(), QuicTime::Zero());
+
+  QuicByteCount threshold =
+      QuicFlowControllerPeer::WindowUpdateThreshold(flow_controller_.get());
+
+  // The first window update carries no drain-rate information, so the window
+  // is left alone.
+  QuicStreamOffset receive_offset = threshold + 1;
+  EXPECT_TRUE(flow_controller_->UpdateHighestReceivedOffset(receive_offset));
+  flow_controller_->AddBytesConsumed(threshold + 1);
+  EXPECT_EQ(kInitialSessionFlowControlWindowForTest,
+            QuicFlowControllerPeer::ReceiveWindowSize(flow_controller_.get()));
+
+  // Drain half a window in half an rtt: the BDP estimate is one full window
+  // plus two bytes, so the window grows to twice that.
+  connection_.AdvanceTime(QuicTime::Delta::FromMilliseconds(kRtt / 2));
+  receive_offset += threshold + 1;
+  EXPECT_TRUE(flow_controller_->UpdateHighestReceivedOffset(receive_offset));
+  EXPECT_CALL(session_flow_controller_, EnsureWindowAtLeast(::testing::_));
+  flow_controller_->AddBytesConsumed(threshold + 1);
+  const QuicByteCount grown_window =
+      2 * (kInitialSessionFlowControlWindowForTest + 2);
+  EXPECT_EQ(grown_window,
+            QuicFlowControllerPeer::ReceiveWindowSize(flow_controller_.get()));
+
+  // Now drain the same amount over ten rtts: the BDP target collapses, and
+  // the window shrinks, capped at half the previous window per update.
+  connection_.AdvanceTime(QuicTime::Delta::FromMilliseconds(10 * kRtt));
+  threshold =
+      QuicFlowControllerPeer::WindowUpdateThreshold(flow_controller_.get());
+  receive_offset += threshold + 1;
+  EXPECT_TRUE(flow_controller_->UpdateHighestReceivedOffset(receive_offset));
+  flow_controller_->AddBytesConsumed(threshold + 1);
+  EXPECT_EQ(grown_window / 2,
+            QuicFlowControllerPeer::ReceiveWindowSize(flow_controller_.get()));
+}
+
 TEST_F(QuicFlowControllerTest, ReceivingBytesFastNoAutoTune) {
   // This test will generate two WINDOW_UPDATE frames.
   EXPECT_CALL(connection_, SendWindowUpdate(stream_id_, ::testing::_)).Times(2);
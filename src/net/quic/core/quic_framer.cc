@@ -22,6 +22,7 @@
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_aligned.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/quic/platform/api/quic_cpu_cycle_count.h"
 #include "net/quic/platform/api/quic_flag_utils.h"
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
@@ -41,6 +42,20 @@ namespace {
 // edge of the public header.
 const uint8_t kPublicHeaderSequenceNumberShift = 4;
 
+// Adds the CPU cycles between construction and destruction to |*sink|.
+class ScopedCycleAccumulator {
+ public:
+  explicit ScopedCycleAccumulator(uint64_t* sink)
+      : sink_(sink), start_(QuicCpuCycleCount()) {}
+  ~ScopedCycleAccumulator() { *sink_ += QuicCpuCycleCount() - start_; }
+
+ private:
+  uint64_t* sink_;
+  const uint64_t start_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedCycleAccumulator);
+};
+
 // New Frame Types, QUIC v. >= 10:
 // There are two interpretations for the Frame Type byte in the QUIC protocol,
 // resulting in two Frame Types: Special Frame Types and Regular Frame Types.
@@ -164,18 +179,28 @@ QuicFramer::QuicFramer(const QuicVersionVector& supported_versions,
       last_packet_number_(0),
       largest_packet_number_(0),
       last_serialized_connection_id_(0),
+      header_template_connection_id_(0),
+      header_template_old_id_flag_(false),
+      header_template_valid_(false),
+      parse_template_connection_id_(0),
+      parse_template_packet_number_length_(PACKET_6BYTE_PACKET_NUMBER),
+      parse_template_valid_(false),
       last_version_tag_(0),
       supported_versions_(supported_versions),
       decrypter_level_(ENCRYPTION_NONE),
       alternative_decrypter_level_(ENCRYPTION_NONE),
       alternative_decrypter_latch_(false),
+      decrypter_sealed_(false),
       perspective_(perspective),
       validate_flags_(true),
       creation_time_(creation_time),
       last_timestamp_(QuicTime::Delta::Zero()),
-      data_producer_(nullptr) {
+      data_producer_(nullptr),
+      encryption_cycles_(0),
+      decryption_cycles_(0) {
   DCHECK(!supported_versions.empty());
   quic_version_ = supported_versions_[0];
+  UpdateCachedVersionProperties();
   decrypter_ = QuicMakeUnique<NullDecrypter>(perspective);
   encrypter_[ENCRYPTION_NONE] = QuicMakeUnique<NullEncrypter>(perspective);
 }
@@ -610,7 +635,8 @@ bool QuicFramer::ProcessDataPacket(QuicDataReader* encrypted_reader,
                                    char* decrypted_buffer,
                                    size_t buffer_length) {
   QuicPacketHeader header(public_header);
-  if (!ProcessUnauthenticatedHeader(encrypted_reader, &header)) {
+  if (QUIC_PREDICT_FALSE(!ProcessUnauthenticatedHeader(encrypted_reader,
+                                                       &header))) {
     DCHECK_NE("", detailed_error_);
     QUIC_DVLOG(1)
         << ENDPOINT
@@ -619,14 +645,15 @@ bool QuicFramer::ProcessDataPacket(QuicDataReader* encrypted_reader,
     return false;
   }
 
-  size_t decrypted_length = 0;
-  if (!DecryptPayload(encrypted_reader, header, packet, decrypted_buffer,
-                      buffer_length, &decrypted_length)) {
+  QuicStringPiece decrypted;
+  if (QUIC_PREDICT_FALSE(!DecryptPayload(encrypted_reader, header, packet,
+                                         decrypted_buffer, buffer_length,
+                                         &decrypted))) {
     set_detailed_error("Unable to decrypt payload.");
     return RaiseError(QUIC_DECRYPTION_FAILURE);
   }
 
-  QuicDataReader reader(decrypted_buffer, decrypted_length, perspective_,
+  QuicDataReader reader(decrypted.data(), decrypted.length(), perspective_,
                         endianness());
 
   // Set the last packet number after we have decrypted the packet
@@ -638,14 +665,14 @@ bool QuicFramer::ProcessDataPacket(QuicDataReader* encrypted_reader,
     return true;
   }
 
-  if (packet.length() > kMaxPacketSize) {
+  if (QUIC_PREDICT_FALSE(packet.length() > kMaxPacketSize)) {
     // If the packet has gotten this far, it should not be too large.
     QUIC_BUG << "Packet too large:" << packet.length();
     return RaiseError(QUIC_PACKET_TOO_LARGE);
   }
 
   // Handle the payload.
-  if (!ProcessFrameData(&reader, header)) {
+  if (QUIC_PREDICT_FALSE(!ProcessFrameData(&reader, header))) {
     DCHECK_NE(QUIC_NO_ERROR, error_);  // ProcessFrameData sets the error.
     DCHECK_NE("", detailed_error_);
     QUIC_DLOG(WARNING) << ENDPOINT << "Unable to process frame data. Error: "
@@ -695,6 +722,36 @@ bool QuicFramer::ProcessPublicResetPacket(
 bool QuicFramer::AppendPacketHeader(const QuicPacketHeader& header,
                                     QuicDataWriter* writer) {
   QUIC_DVLOG(1) << ENDPOINT << "Appending header: " << header;
+  // Fast path for the steady-state header shape: 8-byte connection id, no
+  // reset or version flag and no diversification nonce.  The flags byte and
+  // the connection id in wire order are prebuilt once, so per packet the
+  // header reduces to a copy of the template, the packet number length bits
+  // and the packet number itself.
+  if (!header.public_header.reset_flag && !header.public_header.version_flag &&
+      header.public_header.nonce == nullptr &&
+      header.public_header.connection_id_length == PACKET_8BYTE_CONNECTION_ID) {
+    const bool old_id_flag =
+        !FLAGS_quic_reloadable_flag_quic_remove_v33_hacks2 &&
+        perspective_ == Perspective::IS_CLIENT;
+    if (!header_template_valid_ ||
+        header_template_connection_id_ != header.public_header.connection_id ||
+        header_template_old_id_flag_ != old_id_flag) {
+      RefreshHeaderTemplate(header.public_header.connection_id, old_id_flag);
+    }
+    const uint8_t flags =
+        header_template_[0] |
+        (GetPacketNumberFlags(header.public_header.packet_number_length)
+         << kPublicHeaderSequenceNumberShift);
+    if (!writer->WriteUInt8(flags) ||
+        !writer->WriteBytes(header_template_ + kPublicFlagsSize,
+                            sizeof(QuicConnectionId))) {
+      return false;
+    }
+    last_serialized_connection_id_ = header.public_header.connection_id;
+    return AppendPacketNumber(header.public_header.packet_number_length,
+                              header.packet_number, writer);
+  }
+
   uint8_t public_flags = 0;
   if (header.public_header.reset_flag) {
     public_flags |= PACKET_PUBLIC_FLAGS_RST;
@@ -812,6 +869,26 @@ QuicPacketNumber QuicFramer::CalculatePacketNumberFromWire(
 
 bool QuicFramer::ProcessPublicHeader(QuicDataReader* reader,
                                      QuicPacketPublicHeader* public_header) {
+  QuicStringPiece raw_header = reader->PeekRemainingPayload();
+  if (parse_template_valid_ &&
+      QUIC_PREDICT_TRUE(raw_header.length() > sizeof(parse_template_) &&
+                        QuicUtils::BytesEqual(raw_header.data(),
+                                              parse_template_,
+                                              sizeof(parse_template_)))) {
+    // The flags byte and connection id match the previous packet exactly, so
+    // every field below is known without parsing.  The strict > above leaves
+    // short packets to the full parse so they fail with its error messages.
+    QuicStringPiece skipped;
+    reader->ReadStringPiece(&skipped, sizeof(parse_template_));
+    public_header->reset_flag = false;
+    public_header->version_flag = false;
+    public_header->connection_id = parse_template_connection_id_;
+    public_header->connection_id_length = PACKET_8BYTE_CONNECTION_ID;
+    public_header->packet_number_length = parse_template_packet_number_length_;
+    public_header->nonce = nullptr;
+    return true;
+  }
+
   uint8_t public_flags;
   if (!reader->ReadBytes(&public_flags, 1)) {
     set_detailed_error("Unable to read public flags.");
@@ -889,6 +966,20 @@ bool QuicFramer::ProcessPublicHeader(QuicDataReader* reader,
     public_header->nonce = nullptr;
   }
 
+  // Cache the header's raw prefix when its shape is one the fast path above
+  // can reproduce.  Only headers that passed flag validation are cached, so a
+  // framer that skips validation cannot seed the template with flags a
+  // validating parse would reject.
+  parse_template_valid_ =
+      validate_flags_ && !public_header->version_flag &&
+      !public_header->reset_flag && public_header->nonce == nullptr &&
+      public_header->connection_id_length == PACKET_8BYTE_CONNECTION_ID;
+  if (parse_template_valid_) {
+    memcpy(parse_template_, raw_header.data(), sizeof(parse_template_));
+    parse_template_connection_id_ = public_header->connection_id;
+    parse_template_packet_number_length_ = public_header->packet_number_length;
+  }
+
   return true;
 }
 
@@ -1001,26 +1092,27 @@ bool QuicFramer::ProcessAndCalculatePacketNumber(
 
 bool QuicFramer::ProcessFrameData(QuicDataReader* reader,
                                   const QuicPacketHeader& header) {
-  if (reader->IsDoneReading()) {
+  if (QUIC_PREDICT_FALSE(reader->IsDoneReading())) {
     set_detailed_error("Packet has no frames.");
     return RaiseError(QUIC_MISSING_PAYLOAD);
   }
   while (!reader->IsDoneReading()) {
     uint8_t frame_type;
-    if (!reader->ReadBytes(&frame_type, 1)) {
+    if (QUIC_PREDICT_FALSE(!reader->ReadBytes(&frame_type, 1))) {
       set_detailed_error("Unable to read frame type.");
       return RaiseError(QUIC_INVALID_FRAME_DATA);
     }
 
     if (frame_type & kQuicFrameTypeSpecialMask) {
       // Stream Frame
-      if ((quic_version_ < QUIC_VERSION_40 &&
+      if ((!version_uses_post39_framing_ &&
            (frame_type & kQuicFrameTypeStreamMask_Pre40)) ||
-          (quic_version_ >= QUIC_VERSION_40 &&
+          (version_uses_post39_framing_ &&
            ((frame_type & kQuicFrameTypeStreamMask) ==
             kQuicFrameTypeStreamMask))) {
         QuicStreamFrame frame;
-        if (!ProcessStreamFrame(reader, frame_type, &frame)) {
+        if (QUIC_PREDICT_FALSE(!ProcessStreamFrame(reader, frame_type,
+                                                   &frame))) {
           return RaiseError(QUIC_INVALID_STREAM_DATA);
         }
         if (!visitor_->OnStreamFrame(frame)) {
@@ -1033,13 +1125,13 @@ bool QuicFramer::ProcessFrameData(QuicDataReader* reader,
       }
 
       // Ack Frame
-      if ((quic_version_ < QUIC_VERSION_40 &&
+      if ((!version_uses_post39_framing_ &&
            (frame_type & kQuicFrameTypeAckMask_Pre40)) ||
-          (quic_version_ >= QUIC_VERSION_40 &&
+          (version_uses_post39_framing_ &&
            ((frame_type & kQuicFrameTypeSpecialMask) ==
             kQuicFrameTypeAckMask))) {
         QuicAckFrame frame;
-        if (!ProcessAckFrame(reader, frame_type, &frame)) {
+        if (QUIC_PREDICT_FALSE(!ProcessAckFrame(reader, frame_type, &frame))) {
           return RaiseError(QUIC_INVALID_ACK_DATA);
         }
         if (!visitor_->OnAckFrame(frame)) {
@@ -1203,7 +1295,7 @@ bool QuicFramer::ProcessStreamFrame(QuicDataReader* reader,
   uint8_t stream_id_length = 0;
   uint8_t offset_length = 4;
   bool has_data_length = true;
-  if (quic_version_ < QUIC_VERSION_40) {
+  if (!version_uses_post39_framing_) {
     stream_flags &= ~kQuicFrameTypeStreamMask_Pre40;
 
     // Read from right to left: StreamID, Offset, Data Length, Fin.
@@ -1245,7 +1337,7 @@ bool QuicFramer::ProcessStreamFrame(QuicDataReader* reader,
   }
 
   uint16_t data_len = 0;
-  if (has_data_length && quic_version_ > QUIC_VERSION_39) {
+  if (has_data_length && version_uses_post39_framing_) {
     if (!reader->ReadUInt16(&data_len)) {
       set_detailed_error("Unable to read data length.");
       return false;
@@ -1267,7 +1359,7 @@ bool QuicFramer::ProcessStreamFrame(QuicDataReader* reader,
   // TODO(ianswett): Don't use QuicStringPiece as an intermediary.
   QuicStringPiece data;
   if (has_data_length) {
-    if (quic_version_ > QUIC_VERSION_39) {
+    if (version_uses_post39_framing_) {
       if (!reader->ReadStringPiece(&data, data_len)) {
         set_detailed_error("Unable to read frame data.");
         return false;
@@ -1295,11 +1387,11 @@ bool QuicFramer::ProcessAckFrame(QuicDataReader* reader,
                                  QuicAckFrame* ack_frame) {
   bool has_ack_blocks = !!ExtractBits(
       frame_type, kBooleanNumBits,
-      quic_version_ < QUIC_VERSION_40 ? kQuicHasMultipleAckBlocksOffset_Pre40
+      !version_uses_post39_framing_ ? kQuicHasMultipleAckBlocksOffset_Pre40
                                       : kQuicHasMultipleAckBlocksOffset);
   uint8_t num_ack_blocks = 0;
   uint8_t num_received_packets = 0;
-  if (quic_version_ > QUIC_VERSION_39) {
+  if (version_uses_post39_framing_) {
     if (has_ack_blocks && !reader->ReadUInt8(&num_ack_blocks)) {
       set_detailed_error("Unable to read num of ack blocks.");
       return false;
@@ -1339,7 +1431,7 @@ bool QuicFramer::ProcessAckFrame(QuicDataReader* reader,
   }
 
   if (has_ack_blocks) {
-    if (quic_version_ <= QUIC_VERSION_39 &&
+    if (!version_uses_post39_framing_ &&
         !reader->ReadUInt8(&num_ack_blocks)) {
       set_detailed_error("Unable to read num of ack blocks.");
       return false;
@@ -1375,7 +1467,7 @@ bool QuicFramer::ProcessAckFrame(QuicDataReader* reader,
     }
   }
 
-  if (quic_version_ <= QUIC_VERSION_39 &&
+  if (!version_uses_post39_framing_ &&
       !reader->ReadUInt8(&num_received_packets)) {
     set_detailed_error("Unable to read num received packets.");
     return false;
@@ -1385,6 +1477,14 @@ bool QuicFramer::ProcessAckFrame(QuicDataReader* reader,
     return false;
   }
 
+  if (FLAGS_quic_reloadable_flag_quic_ack_ecn_counts) {
+    QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_ack_ecn_counts, 2, 2);
+    if (!reader->ReadUInt64(&ack_frame->ecn_ce_count)) {
+      set_detailed_error("Unable to read ecn ce count.");
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -1463,7 +1563,7 @@ bool QuicFramer::ProcessRstStreamFrame(QuicDataReader* reader,
     return false;
   }
 
-  if (quic_version_ <= QUIC_VERSION_39) {
+  if (!version_uses_post39_framing_) {
     if (!reader->ReadUInt64(&frame->byte_offset)) {
       set_detailed_error("Unable to read rst stream sent byte offset.");
       return false;
@@ -1483,7 +1583,7 @@ bool QuicFramer::ProcessRstStreamFrame(QuicDataReader* reader,
 
   frame->error_code = static_cast<QuicRstStreamErrorCode>(error_code);
 
-  if (quic_version_ > QUIC_VERSION_39) {
+  if (version_uses_post39_framing_) {
     if (!reader->ReadUInt64(&frame->byte_offset)) {
       set_detailed_error("Unable to read rst stream sent byte offset.");
       return false;
@@ -1576,19 +1676,15 @@ bool QuicFramer::ProcessBlockedFrame(QuicDataReader* reader,
 
 void QuicFramer::ProcessPaddingFrame(QuicDataReader* reader,
                                      QuicPaddingFrame* frame) {
-  if (quic_version_ <= QUIC_VERSION_37) {
+  if (version_pads_to_end_of_packet_) {
     frame->num_padding_bytes = reader->BytesRemaining() + 1;
     reader->ReadRemainingPayload();
     return;
   }
-  // Type byte has been read.
-  frame->num_padding_bytes = 1;
-  uint8_t next_byte;
-  while (!reader->IsDoneReading() && reader->PeekByte() == 0x00) {
-    reader->ReadBytes(&next_byte, 1);
-    DCHECK_EQ(0x00, next_byte);
-    ++frame->num_padding_bytes;
-  }
+  // Type byte has been read.  Consume the rest of the padding run in one
+  // sweep instead of one reader call per byte.
+  frame->num_padding_bytes =
+      1 + static_cast<int>(reader->SkipRepeatedByte(0x00));
 }
 
 // static
@@ -1612,6 +1708,7 @@ void QuicFramer::SetDecrypter(EncryptionLevel level, QuicDecrypter* decrypter) {
   DCHECK_GE(level, decrypter_level_);
   decrypter_.reset(decrypter);
   decrypter_level_ = level;
+  UpdateDecrypterSealed();
 }
 
 void QuicFramer::SetAlternativeDecrypter(EncryptionLevel level,
@@ -1620,6 +1717,12 @@ void QuicFramer::SetAlternativeDecrypter(EncryptionLevel level,
   alternative_decrypter_.reset(decrypter);
   alternative_decrypter_level_ = level;
   alternative_decrypter_latch_ = latch_once_used;
+  UpdateDecrypterSealed();
+}
+
+void QuicFramer::UpdateDecrypterSealed() {
+  decrypter_sealed_ = decrypter_level_ == ENCRYPTION_FORWARD_SECURE &&
+                      alternative_decrypter_.get() == nullptr;
 }
 
 const QuicDecrypter* QuicFramer::decrypter() const {
@@ -1642,6 +1745,7 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
                                   size_t total_len,
                                   size_t buffer_len,
                                   char* buffer) {
+  ScopedCycleAccumulator cycle_accumulator(&encryption_cycles_);
   size_t output_length = 0;
   if (!encrypter_[level]->EncryptPacket(
           quic_version_, packet_number,
@@ -1656,12 +1760,40 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
   return ad_len + output_length;
 }
 
+size_t QuicFramer::EncryptInPlaceBatch(EncryptionLevel level,
+                                       const PendingInPlaceEncryption* packets,
+                                       size_t num_packets,
+                                       size_t* encrypted_lengths) {
+  ScopedCycleAccumulator cycle_accumulator(&encryption_cycles_);
+  std::vector<QuicEncrypter::BatchEntry> entries(num_packets);
+  for (size_t i = 0; i < num_packets; ++i) {
+    const PendingInPlaceEncryption& packet = packets[i];
+    entries[i].packet_number = packet.packet_number;
+    entries[i].associated_data = QuicStringPiece(packet.buffer, packet.ad_len);
+    entries[i].plaintext = QuicStringPiece(packet.buffer + packet.ad_len,
+                                           packet.total_len - packet.ad_len);
+    entries[i].output = packet.buffer + packet.ad_len;
+    entries[i].max_output_length = packet.buffer_len - packet.ad_len;
+  }
+  const size_t num_encrypted = encrypter_[level]->EncryptPackets(
+      quic_version_, entries.data(), num_packets);
+  for (size_t i = 0; i < num_packets; ++i) {
+    encrypted_lengths[i] =
+        entries[i].success ? packets[i].ad_len + entries[i].output_length : 0;
+  }
+  if (num_encrypted != num_packets) {
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+  }
+  return num_encrypted;
+}
+
 size_t QuicFramer::EncryptPayload(EncryptionLevel level,
                                   QuicPacketNumber packet_number,
                                   const QuicPacket& packet,
                                   char* buffer,
                                   size_t buffer_len) {
   DCHECK(encrypter_[level].get() != nullptr);
+  ScopedCycleAccumulator cycle_accumulator(&encryption_cycles_);
 
   QuicStringPiece associated_data = packet.AssociatedData(quic_version_);
   // Copy in the header, because the encrypter only populates the encrypted
@@ -1703,7 +1835,13 @@ bool QuicFramer::DecryptPayload(QuicDataReader* encrypted_reader,
                                 const QuicEncryptedPacket& packet,
                                 char* decrypted_buffer,
                                 size_t buffer_length,
-                                size_t* decrypted_length) {
+                                QuicStringPiece* decrypted) {
+  ScopedCycleAccumulator cycle_accumulator(&decryption_cycles_);
+  if (decrypter_sealed_) {
+    return DecryptPayloadForwardSecure(encrypted_reader, header, packet,
+                                       decrypted_buffer, buffer_length,
+                                       decrypted);
+  }
   QuicStringPiece encrypted = encrypted_reader->ReadRemainingPayload();
   DCHECK(decrypter_.get() != nullptr);
   QuicStringPiece associated_data = GetAssociatedDataFromEncryptedPacket(
@@ -1711,9 +1849,25 @@ bool QuicFramer::DecryptPayload(QuicDataReader* encrypted_reader,
       header.public_header.version_flag, header.public_header.nonce != nullptr,
       header.public_header.packet_number_length);
 
+  // Decrypting within the received buffer avoids writing a copy of every
+  // packet's payload, but AEAD open clobbers the ciphertext even when
+  // authentication fails.  That is only acceptable once no other key could
+  // ever decrypt this packet: at the forward-secure level with no
+  // alternative decrypter installed.  Callers enabling the flag must hand
+  // the framer packets whose buffers are writable.
+  char* out_buffer = decrypted_buffer;
+  size_t max_out_length = buffer_length;
+  if (FLAGS_quic_framer_decrypt_in_place &&
+      alternative_decrypter_.get() == nullptr &&
+      decrypter_level_ == ENCRYPTION_FORWARD_SECURE) {
+    out_buffer = const_cast<char*>(encrypted.data());
+    max_out_length = encrypted.length();
+  }
+
+  size_t decrypted_length = 0;
   bool success = decrypter_->DecryptPacket(
       quic_version_, header.packet_number, associated_data, encrypted,
-      decrypted_buffer, decrypted_length, buffer_length);
+      out_buffer, &decrypted_length, max_out_length);
   if (success) {
     visitor_->OnDecryptedPacket(decrypter_level_);
   } else if (alternative_decrypter_.get() != nullptr) {
@@ -1737,7 +1891,7 @@ bool QuicFramer::DecryptPayload(QuicDataReader* encrypted_reader,
     if (try_alternative_decryption) {
       success = alternative_decrypter_->DecryptPacket(
           quic_version_, header.packet_number, associated_data, encrypted,
-          decrypted_buffer, decrypted_length, buffer_length);
+          decrypted_buffer, &decrypted_length, buffer_length);
     }
     if (success) {
       visitor_->OnDecryptedPacket(alternative_decrypter_level_);
@@ -1754,6 +1908,7 @@ bool QuicFramer::DecryptPayload(QuicDataReader* encrypted_reader,
         alternative_decrypter_level_ = decrypter_level_;
         decrypter_level_ = level;
       }
+      UpdateDecrypterSealed();
     }
   }
 
@@ -1763,6 +1918,44 @@ bool QuicFramer::DecryptPayload(QuicDataReader* encrypted_reader,
     return false;
   }
 
+  *decrypted = QuicStringPiece(out_buffer, decrypted_length);
+  return true;
+}
+
+bool QuicFramer::DecryptPayloadForwardSecure(QuicDataReader* encrypted_reader,
+                                             const QuicPacketHeader& header,
+                                             const QuicEncryptedPacket& packet,
+                                             char* decrypted_buffer,
+                                             size_t buffer_length,
+                                             QuicStringPiece* decrypted) {
+  DCHECK(decrypter_sealed_);
+  QuicStringPiece encrypted = encrypted_reader->ReadRemainingPayload();
+  QuicStringPiece associated_data = GetAssociatedDataFromEncryptedPacket(
+      quic_version_, packet, header.public_header.connection_id_length,
+      header.public_header.version_flag, header.public_header.nonce != nullptr,
+      header.public_header.packet_number_length);
+
+  // With the decrypter sealed there is no alternative key whose trial
+  // decryption could need the untouched ciphertext, so in-place decryption
+  // applies whenever the flag is on. See DecryptPayload() for the buffer
+  // mutability requirement.
+  char* out_buffer = decrypted_buffer;
+  size_t max_out_length = buffer_length;
+  if (FLAGS_quic_framer_decrypt_in_place) {
+    out_buffer = const_cast<char*>(encrypted.data());
+    max_out_length = encrypted.length();
+  }
+
+  size_t decrypted_length = 0;
+  if (!decrypter_->DecryptPacket(quic_version_, header.packet_number,
+                                 associated_data, encrypted, out_buffer,
+                                 &decrypted_length, max_out_length)) {
+    QUIC_DVLOG(1) << ENDPOINT << "DecryptPacket failed for packet_number:"
+                  << header.packet_number;
+    return false;
+  }
+  visitor_->OnDecryptedPacket(ENCRYPTION_FORWARD_SECURE);
+  *decrypted = QuicStringPiece(out_buffer, decrypted_length);
   return true;
 }
 
@@ -1797,6 +1990,10 @@ size_t QuicFramer::GetAckFrameSize(
   // Include timestamps.
   ack_size += GetAckFrameTimeStampSize(ack);
 
+  if (FLAGS_quic_reloadable_flag_quic_ack_ecn_counts) {
+    ack_size += sizeof(ack.ecn_ce_count);
+  }
+
   return ack_size;
 }
 
@@ -1853,64 +2050,9 @@ bool QuicFramer::AppendTypeByte(const QuicFrame& frame,
       if (frame.stream_frame == nullptr) {
         QUIC_BUG << "Failed to append STREAM frame with no stream_frame.";
       }
-      if (quic_version_ < QUIC_VERSION_40) {
-        // Fin bit.
-        type_byte |= frame.stream_frame->fin ? kQuicStreamFinMask_Pre40 : 0;
-
-        // Data Length bit.
-        type_byte <<= kQuicStreamDataLengthShift_Pre40;
-        type_byte |=
-            no_stream_frame_length ? 0 : kQuicStreamDataLengthMask_Pre40;
-
-        // Offset 3 bits.
-        type_byte <<= kQuicStreamOffsetShift_Pre40;
-        const size_t offset_len =
-            GetStreamOffsetSize(quic_version_, frame.stream_frame->offset);
-        if (offset_len > 0) {
-          type_byte |= offset_len - 1;
-        }
-
-        // stream id 2 bits.
-        type_byte <<= kQuicStreamIdShift_Pre40;
-        type_byte |= GetStreamIdSize(frame.stream_frame->stream_id) - 1;
-        type_byte |=
-            kQuicFrameTypeStreamMask_Pre40;  // Set Stream Frame Type to 1.
-      } else {
-        // Fin bit.
-        SetBits(&type_byte, frame.stream_frame->fin ? 1 : 0,
-                kQuicStreamFinNumBits, kQuicStreamFinOffsetShift);
-
-        // Data Length bit.
-        SetBits(&type_byte, no_stream_frame_length ? 0 : 1,
-                kQuicStreamDataLengthNumBits, kQuicStreamDataLengthOffsetShift);
-
-        // Offset 2 bits.
-        uint8_t offset_len_encode = 3;
-        switch (
-            GetStreamOffsetSize(quic_version_, frame.stream_frame->offset)) {
-          case 0:
-            offset_len_encode = 0;
-            break;
-          case 2:
-            offset_len_encode = 1;
-            break;
-          case 4:
-            offset_len_encode = 2;
-            break;
-          case 8:
-            offset_len_encode = 3;
-            break;
-          default:
-            QUIC_BUG << "Invalid offset_length.";
-        }
-        SetBits(&type_byte, offset_len_encode, kQuicStreamOffsetNumBits,
-                kQuicStreamOffsetOffsetShift);
-
-        // stream id 2 bits.
-        SetBits(&type_byte, GetStreamIdSize(frame.stream_frame->stream_id) - 1,
-                kQuicStreamIDLengthNumBits, kQuicStreamIDLengthOffsetShift);
-        type_byte |= kQuicFrameTypeStreamMask;  // Set Stream Frame Type to 1.
-      }
+      type_byte = GetStreamFrameTypeByte(
+          frame.stream_frame->stream_id, frame.stream_frame->offset,
+          frame.stream_frame->fin, no_stream_frame_length);
       break;
     }
     case ACK_FRAME:
@@ -1926,6 +2068,69 @@ bool QuicFramer::AppendTypeByte(const QuicFrame& frame,
   return writer->WriteUInt8(type_byte);
 }
 
+uint8_t QuicFramer::GetStreamFrameTypeByte(QuicStreamId stream_id,
+                                           QuicStreamOffset offset,
+                                           bool fin,
+                                           bool last_frame_in_packet) const {
+  uint8_t type_byte = 0;
+  if (!version_uses_post39_framing_) {
+    // Fin bit.
+    type_byte |= fin ? kQuicStreamFinMask_Pre40 : 0;
+
+    // Data Length bit.
+    type_byte <<= kQuicStreamDataLengthShift_Pre40;
+    type_byte |= last_frame_in_packet ? 0 : kQuicStreamDataLengthMask_Pre40;
+
+    // Offset 3 bits.
+    type_byte <<= kQuicStreamOffsetShift_Pre40;
+    const size_t offset_len = GetStreamOffsetSize(quic_version_, offset);
+    if (offset_len > 0) {
+      type_byte |= offset_len - 1;
+    }
+
+    // stream id 2 bits.
+    type_byte <<= kQuicStreamIdShift_Pre40;
+    type_byte |= GetStreamIdSize(stream_id) - 1;
+    type_byte |=
+        kQuicFrameTypeStreamMask_Pre40;  // Set Stream Frame Type to 1.
+  } else {
+    // Fin bit.
+    SetBits(&type_byte, fin ? 1 : 0, kQuicStreamFinNumBits,
+            kQuicStreamFinOffsetShift);
+
+    // Data Length bit.
+    SetBits(&type_byte, last_frame_in_packet ? 0 : 1,
+            kQuicStreamDataLengthNumBits, kQuicStreamDataLengthOffsetShift);
+
+    // Offset 2 bits.
+    uint8_t offset_len_encode = 3;
+    switch (GetStreamOffsetSize(quic_version_, offset)) {
+      case 0:
+        offset_len_encode = 0;
+        break;
+      case 2:
+        offset_len_encode = 1;
+        break;
+      case 4:
+        offset_len_encode = 2;
+        break;
+      case 8:
+        offset_len_encode = 3;
+        break;
+      default:
+        QUIC_BUG << "Invalid offset_length.";
+    }
+    SetBits(&type_byte, offset_len_encode, kQuicStreamOffsetNumBits,
+            kQuicStreamOffsetOffsetShift);
+
+    // stream id 2 bits.
+    SetBits(&type_byte, GetStreamIdSize(stream_id) - 1,
+            kQuicStreamIDLengthNumBits, kQuicStreamIDLengthOffsetShift);
+    type_byte |= kQuicFrameTypeStreamMask;  // Set Stream Frame Type to 1.
+  }
+  return type_byte;
+}
+
 // static
 bool QuicFramer::AppendPacketNumber(QuicPacketNumberLength packet_number_length,
                                     QuicPacketNumber packet_number,
@@ -1973,7 +2178,7 @@ bool QuicFramer::AppendAckBlock(uint8_t gap,
 bool QuicFramer::AppendStreamFrame(const QuicStreamFrame& frame,
                                    bool no_stream_frame_length,
                                    QuicDataWriter* writer) {
-  if (!no_stream_frame_length && quic_version_ > QUIC_VERSION_39) {
+  if (!no_stream_frame_length && version_uses_post39_framing_) {
     if ((frame.data_length > std::numeric_limits<uint16_t>::max()) ||
         !writer->WriteUInt16(static_cast<uint16_t>(frame.data_length))) {
       QUIC_BUG << "Writing stream frame length failed";
@@ -1990,7 +2195,7 @@ bool QuicFramer::AppendStreamFrame(const QuicStreamFrame& frame,
     QUIC_BUG << "Writing offset size failed.";
     return false;
   }
-  if (!no_stream_frame_length && quic_version_ <= QUIC_VERSION_39) {
+  if (!no_stream_frame_length && !version_uses_post39_framing_) {
     if ((frame.data_length > std::numeric_limits<uint16_t>::max()) ||
         !writer->WriteUInt16(static_cast<uint16_t>(frame.data_length))) {
       QUIC_BUG << "Writing stream frame length failed";
@@ -2018,9 +2223,102 @@ bool QuicFramer::AppendStreamFrame(const QuicStreamFrame& frame,
   return true;
 }
 
+bool QuicFramer::AppendStreamFrameHeader(QuicStreamId stream_id,
+                                         QuicStreamOffset offset,
+                                         bool fin,
+                                         QuicDataWriter* writer) {
+  // The frame extends to the end of the packet, so no length field is
+  // written for any version.
+  if (!writer->WriteUInt8(GetStreamFrameTypeByte(
+          stream_id, offset, fin, /* last_frame_in_packet= */ true))) {
+    QUIC_BUG << "Writing stream frame type byte failed.";
+    return false;
+  }
+  if (!AppendStreamId(GetStreamIdSize(stream_id), stream_id, writer)) {
+    QUIC_BUG << "Writing stream id size failed.";
+    return false;
+  }
+  if (!AppendStreamOffset(GetStreamOffsetSize(quic_version_, offset), offset,
+                          writer)) {
+    QUIC_BUG << "Writing offset size failed.";
+    return false;
+  }
+  return true;
+}
+
+bool QuicFramer::AppendStreamFrameData(QuicStreamId stream_id,
+                                       QuicStreamOffset offset,
+                                       const QuicIOVector& iov,
+                                       size_t iov_offset,
+                                       QuicPacketLength data_length,
+                                       QuicDataWriter* writer) {
+  if (data_length == 0) {
+    return true;
+  }
+  if (data_producer_ != nullptr) {
+    if (!data_producer_->WriteStreamData(stream_id, offset, data_length,
+                                         writer)) {
+      QUIC_BUG << "Writing frame data failed.";
+      return false;
+    }
+    return true;
+  }
+
+  // Gather the payload from |iov| straight into the writer, skipping to the
+  // iovec containing |iov_offset|.
+  int iov_index = 0;
+  size_t offset_in_iov = iov_offset;
+  while (iov_index < iov.iov_count &&
+         offset_in_iov >= iov.iov[iov_index].iov_len) {
+    offset_in_iov -= iov.iov[iov_index].iov_len;
+    ++iov_index;
+  }
+  size_t remaining = data_length;
+  while (remaining > 0) {
+    if (iov_index >= iov.iov_count) {
+      QUIC_BUG << "Writing frame data failed.";
+      return false;
+    }
+    const struct iovec& io = iov.iov[iov_index];
+    const size_t copy_len =
+        std::min<size_t>(remaining, io.iov_len - offset_in_iov);
+    if (!writer->WriteBytes(
+            static_cast<const char*>(io.iov_base) + offset_in_iov, copy_len)) {
+      QUIC_BUG << "Writing frame data failed.";
+      return false;
+    }
+    remaining -= copy_len;
+    offset_in_iov = 0;
+    ++iov_index;
+  }
+  return true;
+}
+
 void QuicFramer::set_version(const QuicVersion version) {
   DCHECK(IsSupportedVersion(version)) << QuicVersionToString(version);
   quic_version_ = version;
+  UpdateCachedVersionProperties();
+}
+
+void QuicFramer::RefreshHeaderTemplate(QuicConnectionId connection_id,
+                                       bool old_id_flag) {
+  uint8_t public_flags = PACKET_PUBLIC_FLAGS_8BYTE_CONNECTION_ID;
+  if (old_id_flag) {
+    public_flags |= PACKET_PUBLIC_FLAGS_8BYTE_CONNECTION_ID_OLD;
+  }
+  header_template_[0] = public_flags;
+  const uint64_t wire_connection_id = QuicEndian::HostToNet64(connection_id);
+  memcpy(header_template_ + kPublicFlagsSize, &wire_connection_id,
+         sizeof(wire_connection_id));
+  header_template_connection_id_ = connection_id;
+  header_template_old_id_flag_ = old_id_flag;
+  header_template_valid_ = true;
+}
+
+void QuicFramer::UpdateCachedVersionProperties() {
+  version_uses_post39_framing_ = quic_version_ > QUIC_VERSION_39;
+  version_uses_network_byte_order_ = quic_version_ > QUIC_VERSION_38;
+  version_pads_to_end_of_packet_ = quic_version_ <= QUIC_VERSION_37;
 }
 
 bool QuicFramer::AppendAckFrameAndTypeByte(const QuicAckFrame& frame,
@@ -2043,7 +2341,7 @@ bool QuicFramer::AppendAckFrameAndTypeByte(const QuicAckFrame& frame,
   // Whether there are multiple ack blocks.
   uint8_t type_byte = 0;
   SetBits(&type_byte, new_ack_info.num_ack_blocks == 0 ? 0 : 1, kBooleanNumBits,
-          quic_version_ < QUIC_VERSION_40
+          !version_uses_post39_framing_
               ? kQuicHasMultipleAckBlocksOffset_Pre40
               : kQuicHasMultipleAckBlocksOffset);
 
@@ -2053,7 +2351,7 @@ bool QuicFramer::AppendAckFrameAndTypeByte(const QuicAckFrame& frame,
   SetBits(&type_byte, GetPacketNumberFlags(ack_block_length),
           kQuicSequenceNumberLengthNumBits, kActBlockLengthOffset);
 
-  if (quic_version_ < QUIC_VERSION_40) {
+  if (!version_uses_post39_framing_) {
     type_byte |= kQuicFrameTypeAckMask_Pre40;
   } else {
     type_byte |= kQuicFrameTypeAckMask;
@@ -2074,7 +2372,7 @@ bool QuicFramer::AppendAckFrameAndTypeByte(const QuicAckFrame& frame,
     num_ack_blocks = std::numeric_limits<uint8_t>::max();
   }
 
-  if (quic_version_ > QUIC_VERSION_39) {
+  if (version_uses_post39_framing_) {
     if (num_ack_blocks > 0 && !writer->WriteBytes(&num_ack_blocks, 1)) {
       return false;
     }
@@ -2103,7 +2401,7 @@ bool QuicFramer::AppendAckFrameAndTypeByte(const QuicAckFrame& frame,
     return false;
   }
 
-  if (quic_version_ <= QUIC_VERSION_39) {
+  if (!version_uses_post39_framing_) {
     if (num_ack_blocks > 0) {
       if (!writer->WriteBytes(&num_ack_blocks, 1)) {
         return false;
@@ -2188,6 +2486,15 @@ bool QuicFramer::AppendAckFrameAndTypeByte(const QuicAckFrame& frame,
     }
   }
 
+  if (FLAGS_quic_reloadable_flag_quic_ack_ecn_counts) {
+    QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_ack_ecn_counts, 1, 2);
+    // Cumulative count of CE marked packets received. Both endpoints must
+    // have the flag enabled, since this extends the ack frame wire format.
+    if (!writer->WriteUInt64(frame.ecn_ce_count)) {
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -2203,7 +2510,7 @@ bool QuicFramer::AppendTimestampsToAckFrame(const QuicAckFrame& frame,
   }
 
   uint8_t num_received_packets = frame.received_packet_times.size();
-  if (quic_version_ <= QUIC_VERSION_39) {
+  if (!version_uses_post39_framing_) {
     if (!writer->WriteBytes(&num_received_packets, 1)) {
       return false;
     }
@@ -2296,7 +2603,7 @@ bool QuicFramer::AppendRstStreamFrame(const QuicRstStreamFrame& frame,
     return false;
   }
 
-  if (quic_version_ <= QUIC_VERSION_39) {
+  if (!version_uses_post39_framing_) {
     if (!writer->WriteUInt64(frame.byte_offset)) {
       return false;
     }
@@ -2307,7 +2614,7 @@ bool QuicFramer::AppendRstStreamFrame(const QuicRstStreamFrame& frame,
     return false;
   }
 
-  if (quic_version_ > QUIC_VERSION_39) {
+  if (version_uses_post39_framing_) {
     if (!writer->WriteUInt64(frame.byte_offset)) {
       return false;
     }
@@ -2368,7 +2675,7 @@ bool QuicFramer::AppendBlockedFrame(const QuicBlockedFrame& frame,
 
 bool QuicFramer::AppendPaddingFrame(const QuicPaddingFrame& frame,
                                     QuicDataWriter* writer) {
-  if (quic_version_ <= QUIC_VERSION_37) {
+  if (version_pads_to_end_of_packet_) {
     writer->WritePadding();
     return true;
   }
@@ -2394,7 +2701,8 @@ bool QuicFramer::RaiseError(QuicErrorCode error) {
 }
 
 Endianness QuicFramer::endianness() const {
-  return quic_version_ > QUIC_VERSION_38 ? NETWORK_BYTE_ORDER : HOST_BYTE_ORDER;
+  return version_uses_network_byte_order_ ? NETWORK_BYTE_ORDER
+                                          : HOST_BYTE_ORDER;
 }
 
 bool QuicFramer::StartsWithChlo(QuicStreamId id,
@@ -176,6 +176,7 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // version to trigger version negotiation.
   void set_version_for_tests(const QuicVersion version) {
     quic_version_ = version;
+    UpdateCachedVersionProperties();
   }
 
   QuicErrorCode error() const { return error_; }
@@ -268,6 +269,25 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
                          bool last_frame_in_packet,
                          QuicDataWriter* writer);
 
+  // Serializes the type byte and the header fields (stream id and offset) of
+  // a stream frame which extends to the end of the packet, so no length field
+  // is written.  The caller appends the payload directly afterwards, via
+  // AppendStreamFrameData, without materializing a QuicStreamFrame.
+  bool AppendStreamFrameHeader(QuicStreamId stream_id,
+                               QuicStreamOffset offset,
+                               bool fin,
+                               QuicDataWriter* writer);
+
+  // Appends |data_length| bytes of payload for stream |stream_id| at |offset|
+  // to |writer|: from the data producer when one is set, and otherwise
+  // gathered from |iov| starting at |iov_offset|.
+  bool AppendStreamFrameData(QuicStreamId stream_id,
+                             QuicStreamOffset offset,
+                             const QuicIOVector& iov,
+                             size_t iov_offset,
+                             QuicPacketLength data_length,
+                             QuicDataWriter* writer);
+
   // SetDecrypter sets the primary decrypter, replacing any that already exists,
   // and takes ownership. If an alternative decrypter is in place then the
   // function DCHECKs. This is intended for cases where one knows that future
@@ -288,6 +308,11 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   const QuicDecrypter* decrypter() const;
   const QuicDecrypter* alternative_decrypter() const;
 
+  // Cumulative CPU cycles spent sealing and opening packet payloads; zero on
+  // platforms without a cheap cycle counter.
+  uint64_t encryption_cycles() const { return encryption_cycles_; }
+  uint64_t decryption_cycles() const { return decryption_cycles_; }
+
   // Changes the encrypter used for level |level| to |encrypter|. The function
   // takes ownership of |encrypter|.
   void SetEncrypter(EncryptionLevel level, QuicEncrypter* encrypter);
@@ -302,6 +327,26 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
                         size_t buffer_len,
                         char* buffer);
 
+  // One packet in a batch passed to EncryptInPlaceBatch; the fields mirror
+  // the EncryptInPlace arguments.
+  struct QUIC_EXPORT_PRIVATE PendingInPlaceEncryption {
+    QuicPacketNumber packet_number;
+    size_t ad_len;
+    size_t total_len;
+    size_t buffer_len;
+    char* buffer;
+  };
+
+  // Encrypts |num_packets| same-level packets in place with one call into
+  // the encrypter's batch interface.  |encrypted_lengths| receives the total
+  // encrypted length of each packet, or 0 for packets which failed.  Returns
+  // the number of packets encrypted successfully and raises
+  // QUIC_ENCRYPTION_FAILURE if any failed.
+  size_t EncryptInPlaceBatch(EncryptionLevel level,
+                             const PendingInPlaceEncryption* packets,
+                             size_t num_packets,
+                             size_t* encrypted_lengths);
+
   // Returns the length of the data encrypted into |buffer| if |buffer_len| is
   // long enough, and otherwise 0.
   size_t EncryptPayload(EncryptionLevel level,
@@ -332,6 +377,7 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   void SetSupportedVersions(const QuicVersionVector& versions) {
     supported_versions_ = versions;
     quic_version_ = versions[0];
+    UpdateCachedVersionProperties();
   }
 
   // Returns true if data_producer_ is not null.
@@ -421,12 +467,30 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   bool ProcessBlockedFrame(QuicDataReader* reader, QuicBlockedFrame* frame);
   void ProcessPaddingFrame(QuicDataReader* reader, QuicPaddingFrame* frame);
 
+  // Decrypts the payload remaining in |encrypted_reader|. On success,
+  // |*decrypted| points at the plaintext: usually in |decrypted_buffer|, but
+  // when FLAGS_quic_framer_decrypt_in_place applies it points back into
+  // |packet|'s own buffer, which must then be mutable, and the ciphertext
+  // bytes there are clobbered even on failure.
   bool DecryptPayload(QuicDataReader* encrypted_reader,
                       const QuicPacketHeader& header,
                       const QuicEncryptedPacket& packet,
                       char* decrypted_buffer,
                       size_t buffer_length,
-                      size_t* decrypted_length);
+                      QuicStringPiece* decrypted);
+
+  // The sealed fast path of DecryptPayload(): the forward-secure decrypter
+  // is the only key that can ever apply, so the alternative-decrypter trial
+  // logic is skipped entirely.
+  bool DecryptPayloadForwardSecure(QuicDataReader* encrypted_reader,
+                                   const QuicPacketHeader& header,
+                                   const QuicEncryptedPacket& packet,
+                                   char* decrypted_buffer,
+                                   size_t buffer_length,
+                                   QuicStringPiece* decrypted);
+
+  // Recomputes |decrypter_sealed_| after a decrypter change.
+  void UpdateDecrypterSealed();
 
   // Sets last_packet_number_. This can only be called after the packet is
   // successfully decrypted.
@@ -458,6 +522,13 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
                             bool last_frame_in_packet,
                             QuicPacketNumberLength packet_number_length);
 
+  // Computes the type byte of a stream frame; shared by AppendTypeByte and
+  // AppendStreamFrameHeader.
+  uint8_t GetStreamFrameTypeByte(QuicStreamId stream_id,
+                                 QuicStreamOffset offset,
+                                 bool fin,
+                                 bool last_frame_in_packet) const;
+
   static bool AppendPacketNumber(QuicPacketNumberLength packet_number_length,
                                  QuicPacketNumber packet_number,
                                  QuicDataWriter* writer);
@@ -505,6 +576,14 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
 
   bool RaiseError(QuicErrorCode error);
 
+  // Recomputes the cached wire-format predicates below after |quic_version_|
+  // changes.
+  void UpdateCachedVersionProperties();
+
+  // Rebuilds |header_template_| for |connection_id|.
+  void RefreshHeaderTemplate(QuicConnectionId connection_id,
+                             bool old_id_flag);
+
   void set_error(QuicErrorCode error) { error_ = error; }
 
   void set_detailed_error(const char* error) { detailed_error_ = error; }
@@ -518,10 +597,41 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   QuicPacketNumber largest_packet_number_;
   // Updated by WritePacketHeader.
   QuicConnectionId last_serialized_connection_id_;
+  // Prebuilt public flags byte and wire-order connection id for the
+  // steady-state short header, so AppendPacketHeader can copy them instead of
+  // recomputing both for every packet.  Rebuilt whenever the connection id
+  // (or the flag configuration entering the flags byte) changes.
+  uint8_t header_template_[kPublicFlagsSize + sizeof(QuicConnectionId)];
+  QuicConnectionId header_template_connection_id_;
+  bool header_template_old_id_flag_;
+  bool header_template_valid_;
+  // Receive-side counterpart of |header_template_|: the raw flags byte and
+  // connection id of the last successfully parsed steady-state public header
+  // (no version flag, no reset flag, no nonce, 8-byte connection id).
+  // Consecutive packets from one peer repeat these bytes verbatim, so
+  // ProcessPublicHeader accepts them with a single prefix compare instead of
+  // the field-by-field parse; any mismatch falls back to the full parse,
+  // which rebuilds the template.
+  uint8_t parse_template_[kPublicFlagsSize + sizeof(QuicConnectionId)];
+  QuicConnectionId parse_template_connection_id_;
+  QuicPacketNumberLength parse_template_packet_number_length_;
+  bool parse_template_valid_;
   // The last QUIC version tag received.
   QuicTag last_version_tag_;
   // Version of the protocol being used.
   QuicVersion quic_version_;
+  // Wire-format predicates derived from |quic_version_|.  They are cached
+  // whenever the version changes, so the per-packet parse and serialize paths
+  // test a single flag instead of re-comparing version numbers in every hot
+  // call.
+  // Whether the version uses the post-QUIC_VERSION_39 framing (header form,
+  // frame type interpretation, explicit lengths).
+  bool version_uses_post39_framing_;
+  // Whether integers and floating point numbers are written to the wire in
+  // network byte order.
+  bool version_uses_network_byte_order_;
+  // Whether a padding frame consumes the rest of the packet.
+  bool version_pads_to_end_of_packet_;
   // This vector contains QUIC versions which we currently support.
   // This should be ordered such that the highest supported version is the first
   // element, with subsequent elements in descending order (versions can be
@@ -539,6 +649,10 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // successfully decrypts a packet, we should install it as the only
   // decrypter.
   bool alternative_decrypter_latch_;
+  // True once the forward-secure decrypter is installed with no alternative
+  // decrypter: no other key can ever decrypt a packet, so DecryptPayload()
+  // dispatches straight to DecryptPayloadForwardSecure().
+  bool decrypter_sealed_;
   // Encrypters used to encrypt packets via EncryptPayload().
   std::unique_ptr<QuicEncrypter> encrypter_[NUM_ENCRYPTION_LEVELS];
   // Tracks if the framer is being used by the entity that received the
@@ -559,6 +673,11 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // owned.
   QuicStreamFrameDataProducer* data_producer_;
 
+  // Cumulative CPU cycles spent in the encrypter and decrypter respectively;
+  // zero on platforms without a cheap cycle counter.
+  uint64_t encryption_cycles_;
+  uint64_t decryption_cycles_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicFramer);
 };
 
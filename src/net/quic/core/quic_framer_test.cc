@@ -656,6 +656,75 @@ TEST_P(QuicFramerTest, PacketHeader) {
   }
 }
 
+TEST_P(QuicFramerTest, PacketHeaderParseTemplate) {
+  // clang-format off
+  unsigned char packet[] = {
+    // public flags (8 byte connection_id)
+    0x38,
+    // connection_id
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+    // packet number
+    0xBC, 0x9A, 0x78, 0x56, 0x34, 0x12,
+  };
+
+  unsigned char packet39[] = {
+    // public flags (8 byte connection_id)
+    0x38,
+    // connection_id
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+    // packet number
+    0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC,
+  };
+
+  // Same shape but a different connection id, so the cached prefix compare
+  // misses and the header takes the full parse.
+  unsigned char other_id_packet[] = {
+    // public flags (8 byte connection_id)
+    0x38,
+    // connection_id
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x11,
+    // packet number
+    0xBC, 0x9A, 0x78, 0x56, 0x34, 0x12,
+  };
+
+  unsigned char other_id_packet39[] = {
+    // public flags (8 byte connection_id)
+    0x38,
+    // connection_id
+    0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x11,
+    // packet number
+    0x12, 0x34, 0x56, 0x78, 0x9A, 0xBC,
+  };
+  // clang-format on
+
+  // The first packet seeds the parse template; the second is accepted by it.
+  // Both must produce identical headers.
+  QuicEncryptedPacket encrypted(
+      AsChars(framer_.version() <= QUIC_VERSION_38 ? packet : packet39),
+      arraysize(packet), false);
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_FALSE(framer_.ProcessPacket(encrypted));
+    EXPECT_EQ(QUIC_MISSING_PAYLOAD, framer_.error());
+    ASSERT_TRUE(visitor_.header_.get());
+    EXPECT_EQ(kConnectionId, visitor_.header_->public_header.connection_id);
+    EXPECT_FALSE(visitor_.header_->public_header.reset_flag);
+    EXPECT_FALSE(visitor_.header_->public_header.version_flag);
+    EXPECT_EQ(PACKET_6BYTE_PACKET_NUMBER,
+              visitor_.header_->public_header.packet_number_length);
+    EXPECT_EQ(kPacketNumber, visitor_.header_->packet_number);
+  }
+
+  QuicEncryptedPacket other_id_encrypted(
+      AsChars(framer_.version() <= QUIC_VERSION_38 ? other_id_packet
+                                                   : other_id_packet39),
+      arraysize(other_id_packet), false);
+  EXPECT_FALSE(framer_.ProcessPacket(other_id_encrypted));
+  EXPECT_EQ(QUIC_MISSING_PAYLOAD, framer_.error());
+  ASSERT_TRUE(visitor_.header_.get());
+  EXPECT_EQ(kConnectionId + 1, visitor_.header_->public_header.connection_id);
+  EXPECT_EQ(kPacketNumber, visitor_.header_->packet_number);
+}
+
 TEST_P(QuicFramerTest, PacketHeaderWith0ByteConnectionId) {
   QuicFramerPeer::SetLastSerializedConnectionId(&framer_, kConnectionId);
 
@@ -1351,6 +1420,116 @@ TEST_P(QuicFramerTest, StreamFrame) {
       kQuicMaxStreamIdSize, !kIncludeVersion);
 }
 
+TEST_P(QuicFramerTest, DecrypterSealing) {
+  // Handshake keys can still change on a fresh framer, so it is not sealed.
+  EXPECT_FALSE(QuicFramerPeer::DecrypterSealed(&framer_));
+
+  // An alternative decrypter keeps trial decryption alive even once the
+  // primary decrypter is forward secure.
+  framer_.SetAlternativeDecrypter(ENCRYPTION_FORWARD_SECURE,
+                                  new test::TestDecrypter(), true);
+  EXPECT_FALSE(QuicFramerPeer::DecrypterSealed(&framer_));
+}
+
+TEST_P(QuicFramerTest, SealedDecrypterProcessesPackets) {
+  // Installing the forward-secure decrypter with no alternative promotes the
+  // framer to the sealed single-decrypter path.
+  decrypter_ = new test::TestDecrypter();
+  framer_.SetDecrypter(ENCRYPTION_FORWARD_SECURE, decrypter_);
+  EXPECT_TRUE(QuicFramerPeer::DecrypterSealed(&framer_));
+
+  // clang-format off
+  unsigned char packet[] = {
+      // public flags (8 byte connection_id)
+      0x38,
+      // connection_id
+      0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+      // packet number
+      0xBC, 0x9A, 0x78, 0x56,
+      0x34, 0x12,
+
+      // frame type (stream frame with fin)
+      0xFF,
+      // stream id
+      0x04, 0x03, 0x02, 0x01,
+      // offset
+      0x54, 0x76, 0x10, 0x32,
+      0xDC, 0xFE, 0x98, 0xBA,
+      // data length
+      0x0c, 0x00,
+      // data
+      'h',  'e',  'l',  'l',
+      'o',  ' ',  'w',  'o',
+      'r',  'l',  'd',  '!',
+  };
+
+  unsigned char packet39[] = {
+      // public flags (8 byte connection_id)
+      0x38,
+      // connection_id
+      0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+      // packet number
+      0x12, 0x34, 0x56, 0x78,
+      0x9A, 0xBC,
+
+      // frame type (stream frame with fin)
+      0xFF,
+      // stream id
+      0x01, 0x02, 0x03, 0x04,
+      // offset
+      0xBA, 0x98, 0xFE, 0xDC,
+      0x32, 0x10, 0x76, 0x54,
+      // data length
+      0x00, 0x0c,
+      // data
+      'h',  'e',  'l',  'l',
+      'o',  ' ',  'w',  'o',
+      'r',  'l',  'd',  '!',
+  };
+
+  unsigned char packet40[] = {
+      // public flags (8 byte connection_id)
+      0x38,
+      // connection_id
+      0xFE, 0xDC, 0xBA, 0x98, 0x76, 0x54, 0x32, 0x10,
+      // packet number
+      0x12, 0x34, 0x56, 0x78,
+      0x9A, 0xBC,
+
+      // frame type (stream frame with fin)
+      0xFF,
+      // data length
+      0x00, 0x0c,
+      // stream id
+      0x01, 0x02, 0x03, 0x04,
+      // offset
+      0xBA, 0x98, 0xFE, 0xDC,
+      0x32, 0x10, 0x76, 0x54,
+      // data
+      'h',  'e',  'l',  'l',
+      'o',  ' ',  'w',  'o',
+      'r',  'l',  'd',  '!',
+  };
+  // clang-format on
+
+  unsigned char* p = packet;
+  if (framer_.version() > QUIC_VERSION_39) {
+    p = packet40;
+  } else if (framer_.version() > QUIC_VERSION_38) {
+    p = packet39;
+  }
+  QuicEncryptedPacket encrypted(AsChars(p), arraysize(packet), false);
+  EXPECT_TRUE(framer_.ProcessPacket(encrypted));
+  EXPECT_EQ(QUIC_NO_ERROR, framer_.error());
+  ASSERT_TRUE(visitor_.header_.get());
+  EXPECT_TRUE(CheckDecryption(encrypted, !kIncludeVersion,
+                              !kIncludeDiversificationNonce));
+  ASSERT_EQ(1u, visitor_.stream_frames_.size());
+  CheckStreamFrameData("hello world!", visitor_.stream_frames_[0].get());
+  // Still sealed after processing.
+  EXPECT_TRUE(QuicFramerPeer::DecrypterSealed(&framer_));
+}
+
 TEST_P(QuicFramerTest, MissingDiversificationNonce) {
   QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
   framer_.SetDecrypter(ENCRYPTION_NONE,
@@ -4,10 +4,23 @@
 
 #include "net/quic/core/quic_headers_stream.h"
 
+#include "net/quic/core/quic_alarm_factory.h"
+#include "net/quic/core/quic_connection.h"
 #include "net/quic/core/quic_spdy_session.h"
+#include "net/quic/platform/api/quic_flag_utils.h"
 #include "net/quic/platform/api/quic_flags.h"
+#include "net/quic/platform/api/quic_logging.h"
 
 namespace net {
+namespace {
+
+// Maximum number of compressed header bytes decoded per OnDataAvailable()
+// call when FLAGS_quic_reloadable_flag_quic_headers_stream_decode_budget is
+// true. Decoding of any remaining buffered data resumes from the event loop,
+// after other connections on the thread have had a chance to run.
+const size_t kHeadersStreamDecodeBudgetPerLoop = 16 * 1024;
+
+}  // namespace
 
 QuicHeadersStream::CompressedHeaderInfo::CompressedHeaderInfo(
     QuicStreamOffset headers_stream_offset,
@@ -31,10 +44,16 @@ QuicHeadersStream::QuicHeadersStream(QuicSpdySession* session)
 
 QuicHeadersStream::~QuicHeadersStream() {}
 
+void QuicHeadersStream::ResumeDecodingAlarmDelegate::OnAlarm() {
+  QUIC_DVLOG(1) << "Resuming headers stream decoding";
+  stream_->OnDataAvailable();
+}
+
 void QuicHeadersStream::OnDataAvailable() {
   char buffer[1024];
   struct iovec iov;
   QuicTime timestamp(QuicTime::Zero());
+  size_t bytes_processed = 0;
   while (true) {
     iov.iov_base = buffer;
     iov.iov_len = arraysize(buffer);
@@ -48,6 +67,30 @@ void QuicHeadersStream::OnDataAvailable() {
     }
     sequencer()->MarkConsumed(iov.iov_len);
     MaybeReleaseSequencerBuffer();
+    if (FLAGS_quic_reloadable_flag_quic_headers_stream_decode_budget) {
+      QUIC_FLAG_COUNT(quic_reloadable_flag_quic_headers_stream_decode_budget);
+      bytes_processed += iov.iov_len;
+      if (bytes_processed >= kHeadersStreamDecodeBudgetPerLoop &&
+          sequencer()->HasBytesToRead()) {
+        // This connection's decode budget for the current event loop
+        // iteration is spent; decode the rest after other connections on
+        // this thread have run.
+        ScheduleResumeDecoding();
+        return;
+      }
+    }
+  }
+}
+
+void QuicHeadersStream::ScheduleResumeDecoding() {
+  if (resume_decoding_alarm_ == nullptr) {
+    resume_decoding_alarm_.reset(
+        spdy_session_->connection()->alarm_factory()->CreateAlarm(
+            new ResumeDecodingAlarmDelegate(this)));
+  }
+  if (!resume_decoding_alarm_->IsSet()) {
+    resume_decoding_alarm_->Set(
+        spdy_session_->connection()->clock()->ApproximateNow());
   }
 }
 
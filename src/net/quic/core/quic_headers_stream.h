@@ -10,6 +10,7 @@
 #include <memory>
 
 #include "base/macros.h"
+#include "net/quic/core/quic_alarm.h"
 #include "net/quic/core/quic_header_list.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_stream.h"
@@ -77,6 +78,23 @@ class QUIC_EXPORT_PRIVATE QuicHeadersStream : public QuicStream {
     QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener;
   };
 
+  // Re-enters OnDataAvailable() from the event loop when decoding stopped
+  // early because the per-iteration decode budget was exhausted.
+  class ResumeDecodingAlarmDelegate : public QuicAlarm::Delegate {
+   public:
+    explicit ResumeDecodingAlarmDelegate(QuicHeadersStream* stream)
+        : stream_(stream) {}
+
+    void OnAlarm() override;
+
+   private:
+    QuicHeadersStream* stream_;
+  };
+
+  // Arms |resume_decoding_alarm_| to continue decoding buffered header data
+  // on the next event loop iteration.
+  void ScheduleResumeDecoding();
+
   // Returns true if the session is still connected.
   bool IsConnected();
 
@@ -94,6 +112,10 @@ class QUIC_EXPORT_PRIVATE QuicHeadersStream : public QuicStream {
   // Headers that have not been fully acked.
   std::deque<CompressedHeaderInfo> unacked_headers_;
 
+  // Created lazily by ScheduleResumeDecoding(); only used when
+  // FLAGS_quic_reloadable_flag_quic_headers_stream_decode_budget is true.
+  std::unique_ptr<QuicAlarm> resume_decoding_alarm_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicHeadersStream);
 };
 
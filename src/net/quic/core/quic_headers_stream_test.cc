@@ -463,6 +463,65 @@ TEST_P(QuicHeadersStreamTest, ProcessRawData) {
   }
 }
 
+TEST_P(QuicHeadersStreamTest, ProcessMultiplexedCompressionContexts) {
+  QuicSpdySessionPeer::SetMultipleCompressionContexts(&session_, true);
+  // Two independent encoders stand in for the peer's compression contexts.
+  // The second block from each encoder references entries in that encoder's
+  // dynamic table, so decoding succeeds only if each block is demultiplexed
+  // to the decoder for its context.
+  SpdyFramer context1_framer(SpdyFramer::ENABLE_COMPRESSION);
+  SpdyHeaderBlock context1_headers;
+  context1_headers[":version"] = "HTTP/1.1";
+  context1_headers[":status"] = "500 Internal Server Error";
+  context1_headers["x-tenant"] = "other";
+  for (int round = 0; round < 2; ++round) {
+    for (uint8_t context_id = 0; context_id < 2; ++context_id) {
+      SpdyFramer* encoder = context_id == 0 ? framer_.get() : &context1_framer;
+      const SpdyHeaderBlock& expected =
+          context_id == 0 ? headers_ : context1_headers;
+      SpdyHeadersIR headers_frame(client_id_1_, expected.Clone());
+      if (perspective() == Perspective::IS_SERVER) {
+        headers_frame.set_has_priority(true);
+        headers_frame.set_weight(Spdy3PriorityToHttp2Weight(0));
+        EXPECT_CALL(session_, OnStreamHeadersPriority(client_id_1_, 0));
+      }
+      SpdySerializedFrame frame(encoder->SerializeFrame(headers_frame));
+      string block;
+      block.push_back(static_cast<char>(context_id));
+      block.push_back(static_cast<char>((frame.size() >> 24) & 0xff));
+      block.push_back(static_cast<char>((frame.size() >> 16) & 0xff));
+      block.push_back(static_cast<char>((frame.size() >> 8) & 0xff));
+      block.push_back(static_cast<char>(frame.size() & 0xff));
+      block.append(frame.data(), frame.size());
+      EXPECT_CALL(session_,
+                  OnStreamHeaderList(client_id_1_, false, frame.size(), _))
+          .WillOnce(Invoke(this, &QuicHeadersStreamTest::SaveHeaderList));
+      stream_frame_.data_buffer = block.data();
+      stream_frame_.data_length = block.size();
+      headers_stream_->OnStreamFrame(stream_frame_);
+      stream_frame_.offset += block.size();
+      EXPECT_EQ(expected, headers_handler_->decoded_block());
+      headers_handler_.reset();
+    }
+  }
+}
+
+TEST_P(QuicHeadersStreamTest, InvalidCompressionContextPrefix) {
+  QuicSpdySessionPeer::SetMultipleCompressionContexts(&session_, true);
+  // A context id beyond the supported range closes the connection.
+  string block;
+  block.push_back(static_cast<char>(kNumHeaderCompressionContexts));
+  block.append(4, '\x01');
+  EXPECT_CALL(*connection_,
+              CloseConnection(QUIC_INVALID_HEADERS_STREAM_DATA,
+                              "Invalid compression context prefix.", _))
+      .WillOnce(InvokeWithoutArgs(
+          this, &QuicHeadersStreamTest::TearDownLocalConnectionState));
+  stream_frame_.data_buffer = block.data();
+  stream_frame_.data_length = block.size();
+  headers_stream_->OnStreamFrame(stream_frame_);
+}
+
 TEST_P(QuicHeadersStreamTest, ProcessPushPromise) {
   if (perspective() == Perspective::IS_SERVER)
     return;
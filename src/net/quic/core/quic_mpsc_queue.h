@@ -0,0 +1,85 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_MPSC_QUEUE_H_
+#define NET_QUIC_CORE_QUIC_MPSC_QUEUE_H_
+
+#include <atomic>
+#include <utility>
+
+#include "base/macros.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// An unbounded multi-producer single-consumer FIFO queue. Push may be called
+// concurrently from any number of threads and never blocks; Pop must only be
+// called from one consumer thread. Used to hand work (e.g. buffered packets,
+// completed crypto results) from worker threads to the dispatcher thread
+// without taking a lock on the packet path.
+//
+// This is the classic two-pointer MPSC queue: producers atomically swing the
+// tail to their node and then link the predecessor, so a consumer can
+// momentarily observe a pushed-but-unlinked node; Pop simply reports empty
+// in that window and the element becomes visible once the producer finishes
+// the second store.
+template <typename T>
+class QuicMpscQueue {
+ public:
+  QuicMpscQueue() {
+    Node* stub = new Node();
+    head_ = stub;
+    tail_.store(stub, std::memory_order_relaxed);
+  }
+
+  ~QuicMpscQueue() {
+    while (head_ != nullptr) {
+      Node* next = head_->next.load(std::memory_order_relaxed);
+      delete head_;
+      head_ = next;
+    }
+  }
+
+  // Appends |value| to the queue. Safe to call from any thread.
+  void Push(T value) {
+    Node* node = new Node(std::move(value));
+    Node* prev = tail_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  // Removes the oldest element into |*value|. Returns false if the queue is
+  // empty (or a concurrent Push has not yet become visible). Must only be
+  // called from the consumer thread.
+  bool Pop(T* value) {
+    Node* next = head_->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    *value = std::move(next->value);
+    delete head_;
+    head_ = next;
+    return true;
+  }
+
+ private:
+  struct Node {
+    Node() : next(nullptr) {}
+    explicit Node(T value) : next(nullptr), value(std::move(value)) {}
+
+    std::atomic<Node*> next;
+    T value;
+  };
+
+  // Consumed from; only touched by the consumer thread. Always points at a
+  // stub whose value has already been consumed.
+  Node* head_;
+  // Produced onto; shared by all producers.
+  std::atomic<Node*> tail_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicMpscQueue);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_MPSC_QUEUE_H_
@@ -0,0 +1,89 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_mpsc_queue.h"
+
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+TEST(QuicMpscQueueTest, PopOnEmptyReturnsFalse) {
+  QuicMpscQueue<int> queue;
+  int value = 0;
+  EXPECT_FALSE(queue.Pop(&value));
+}
+
+TEST(QuicMpscQueueTest, PreservesFifoOrder) {
+  QuicMpscQueue<int> queue;
+  for (int i = 0; i < 100; ++i) {
+    queue.Push(i);
+  }
+  int value;
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(queue.Pop(&value));
+    EXPECT_EQ(i, value);
+  }
+  EXPECT_FALSE(queue.Pop(&value));
+}
+
+TEST(QuicMpscQueueTest, SupportsMoveOnlyTypes) {
+  QuicMpscQueue<std::unique_ptr<int>> queue;
+  queue.Push(std::unique_ptr<int>(new int(42)));
+  std::unique_ptr<int> value;
+  ASSERT_TRUE(queue.Pop(&value));
+  EXPECT_EQ(42, *value);
+}
+
+class PusherThread : public base::SimpleThread {
+ public:
+  PusherThread(QuicMpscQueue<int>* queue, int base, int count)
+      : base::SimpleThread("mpsc_pusher"),
+        queue_(queue),
+        base_(base),
+        count_(count) {}
+
+  void Run() override {
+    for (int i = 0; i < count_; ++i) {
+      queue_->Push(base_ + i);
+    }
+  }
+
+ private:
+  QuicMpscQueue<int>* queue_;
+  const int base_;
+  const int count_;
+};
+
+TEST(QuicMpscQueueTest, ConcurrentProducersLoseNothing) {
+  const int kNumProducers = 4;
+  const int kPushesPerProducer = 1000;
+  QuicMpscQueue<int> queue;
+
+  std::vector<std::unique_ptr<PusherThread>> producers;
+  for (int i = 0; i < kNumProducers; ++i) {
+    producers.push_back(std::unique_ptr<PusherThread>(
+        new PusherThread(&queue, i * kPushesPerProducer, kPushesPerProducer)));
+    producers.back()->Start();
+  }
+  for (const auto& producer : producers) {
+    producer->Join();
+  }
+
+  std::set<int> popped;
+  int value;
+  while (queue.Pop(&value)) {
+    EXPECT_TRUE(popped.insert(value).second);
+  }
+  EXPECT_EQ(static_cast<size_t>(kNumProducers * kPushesPerProducer),
+            popped.size());
+}
+
+}  // namespace
+}  // namespace net
@@ -0,0 +1,122 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_object_pool.h"
+
+#include <new>
+#include <vector>
+
+#include "base/lazy_instance.h"
+#include "base/macros.h"
+#include "base/threading/thread_local.h"
+
+namespace net {
+
+namespace {
+
+// Deeper buckets ride out bursts of simultaneous teardown; beyond this the
+// blocks go back to the heap.
+const size_t kMaxBlocksPerBucket = 64;
+
+// Singly-linked free list node, stored in the block itself while free.
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct Bucket {
+  size_t size;
+  size_t depth;
+  FreeBlock* head;
+};
+
+// A process sees only a handful of distinct pooled object sizes (one per
+// concrete connection or session class), so buckets are scanned linearly.
+class PerThreadPool {
+ public:
+  PerThreadPool() {}
+
+  void* Allocate(size_t size) {
+    for (Bucket& bucket : buckets_) {
+      if (bucket.size == size && bucket.head != nullptr) {
+        FreeBlock* block = bucket.head;
+        bucket.head = block->next;
+        bucket.depth--;
+        return block;
+      }
+    }
+    return ::operator new(size);
+  }
+
+  void Deallocate(void* block, size_t size) {
+    Bucket* bucket = FindOrCreateBucket(size);
+    if (bucket == nullptr || bucket->depth >= kMaxBlocksPerBucket) {
+      ::operator delete(block);
+      return;
+    }
+    FreeBlock* free_block = static_cast<FreeBlock*>(block);
+    free_block->next = bucket->head;
+    bucket->head = free_block;
+    bucket->depth++;
+  }
+
+  size_t FreeBlocks(size_t size) const {
+    for (const Bucket& bucket : buckets_) {
+      if (bucket.size == size) {
+        return bucket.depth;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  // Returns the bucket for |size|, or nullptr for blocks too small to hold
+  // a free list node.
+  Bucket* FindOrCreateBucket(size_t size) {
+    if (size < sizeof(FreeBlock)) {
+      return nullptr;
+    }
+    for (Bucket& bucket : buckets_) {
+      if (bucket.size == size) {
+        return &bucket;
+      }
+    }
+    buckets_.push_back(Bucket{size, 0, nullptr});
+    return &buckets_.back();
+  }
+
+  std::vector<Bucket> buckets_;
+
+  DISALLOW_COPY_AND_ASSIGN(PerThreadPool);
+};
+
+base::LazyInstance<base::ThreadLocalPointer<PerThreadPool>>::Leaky
+    g_per_thread_pool = LAZY_INSTANCE_INITIALIZER;
+
+PerThreadPool* GetPool() {
+  PerThreadPool* pool = g_per_thread_pool.Get().Get();
+  if (pool == nullptr) {
+    pool = new PerThreadPool;
+    g_per_thread_pool.Get().Set(pool);
+  }
+  return pool;
+}
+
+}  // namespace
+
+// static
+void* QuicObjectPool::Allocate(size_t size) {
+  return GetPool()->Allocate(size);
+}
+
+// static
+void QuicObjectPool::Deallocate(void* block, size_t size) {
+  GetPool()->Deallocate(block, size);
+}
+
+// static
+size_t QuicObjectPool::FreeBlocksForTesting(size_t size) {
+  return GetPool()->FreeBlocks(size);
+}
+
+}  // namespace net
@@ -0,0 +1,45 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_OBJECT_POOL_H_
+#define NET_QUIC_CORE_QUIC_OBJECT_POOL_H_
+
+#include <stddef.h>
+
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// Recycles the memory blocks behind objects that servers allocate and tear
+// down at connection rate (connections, sessions). Blocks are kept on
+// per-thread free lists bucketed by exact object size, so under steady
+// connection churn an accept costs a free-list pop instead of a heap
+// allocation, and teardown a push instead of a free. Each bucket's depth is
+// capped; overflow goes back to the heap.
+//
+// Classes opt in by routing their class-level operator new/delete here;
+// sized deallocation guarantees the block returns to the bucket it came
+// from, including for deletion through a base-class pointer.
+//
+// The per-thread lists are intentionally leaked on thread exit, like other
+// leaky thread-local caches; server threads live for the process lifetime.
+class QUIC_EXPORT_PRIVATE QuicObjectPool {
+ public:
+  // Returns a block of |size| bytes, recycled if one is available.
+  static void* Allocate(size_t size);
+
+  // Returns |block|, previously obtained from Allocate(|size|), to the
+  // calling thread's pool.
+  static void Deallocate(void* block, size_t size);
+
+  // Returns how many free blocks of |size| bytes the calling thread holds.
+  static size_t FreeBlocksForTesting(size_t size);
+
+ private:
+  QuicObjectPool() = delete;
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_OBJECT_POOL_H_
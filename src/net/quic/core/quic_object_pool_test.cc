@@ -0,0 +1,53 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_object_pool.h"
+
+#include <cstring>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+TEST(QuicObjectPoolTest, RecyclesBlocksOfSameSize) {
+  void* block = QuicObjectPool::Allocate(512);
+  ASSERT_NE(nullptr, block);
+  memset(block, 0xab, 512);
+  QuicObjectPool::Deallocate(block, 512);
+  EXPECT_EQ(1u, QuicObjectPool::FreeBlocksForTesting(512));
+
+  // The freed block sits at the head of its bucket.
+  EXPECT_EQ(block, QuicObjectPool::Allocate(512));
+  EXPECT_EQ(0u, QuicObjectPool::FreeBlocksForTesting(512));
+  QuicObjectPool::Deallocate(block, 512);
+}
+
+TEST(QuicObjectPoolTest, DistinctSizesDoNotShareBuckets) {
+  void* small = QuicObjectPool::Allocate(256);
+  QuicObjectPool::Deallocate(small, 256);
+  void* large = QuicObjectPool::Allocate(4096);
+  EXPECT_NE(small, large);
+  memset(large, 0xcd, 4096);
+  QuicObjectPool::Deallocate(large, 4096);
+  EXPECT_EQ(1u, QuicObjectPool::FreeBlocksForTesting(256));
+}
+
+TEST(QuicObjectPoolTest, BucketDepthIsCapped) {
+  const size_t kSize = 1024;
+  const size_t kBlocks = 100;  // Larger than the per-bucket cap.
+  void* blocks[kBlocks];
+  for (size_t i = 0; i < kBlocks; i++) {
+    blocks[i] = QuicObjectPool::Allocate(kSize);
+  }
+  for (size_t i = 0; i < kBlocks; i++) {
+    QuicObjectPool::Deallocate(blocks[i], kSize);
+  }
+  size_t depth = QuicObjectPool::FreeBlocksForTesting(kSize);
+  EXPECT_GT(depth, 0u);
+  EXPECT_LT(depth, kBlocks);
+}
+
+}  // namespace
+}  // namespace net
@@ -0,0 +1,73 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_packet_buffer_pool.h"
+
+#include <algorithm>
+
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+QuicPacketBuffer::QuicPacketBuffer(QuicPacketBufferPool* pool)
+    : ref_count_(0), pool_(pool) {}
+
+QuicPacketBuffer::~QuicPacketBuffer() {}
+
+void QuicPacketBuffer::Release() {
+  DCHECK_GT(ref_count_, 0);
+  if (--ref_count_ > 0) {
+    return;
+  }
+  if (pool_ != nullptr) {
+    pool_->Recycle(this);
+  } else {
+    // The pool was destroyed while this buffer was still referenced.
+    delete this;
+  }
+}
+
+QuicPacketBufferPool::QuicPacketBufferPool(size_t max_free_buffers)
+    : max_free_buffers_(max_free_buffers), num_outstanding_(0) {}
+
+QuicPacketBufferPool::~QuicPacketBufferPool() {
+  for (QuicPacketBuffer* buffer : all_buffers_) {
+    if (buffer->ref_count_ == 0) {
+      delete buffer;
+    } else {
+      // Orphan the buffer; it deletes itself on its last Release().
+      buffer->pool_ = nullptr;
+    }
+  }
+}
+
+QuicPacketBuffer* QuicPacketBufferPool::HandOut() {
+  QuicPacketBuffer* buffer;
+  if (!free_buffers_.empty()) {
+    buffer = free_buffers_.back();
+    free_buffers_.pop_back();
+  } else {
+    buffer = new QuicPacketBuffer(this);
+    all_buffers_.push_back(buffer);
+  }
+  DCHECK_EQ(0, buffer->ref_count_);
+  buffer->ref_count_ = 1;
+  ++num_outstanding_;
+  return buffer;
+}
+
+void QuicPacketBufferPool::Recycle(QuicPacketBuffer* buffer) {
+  DCHECK_EQ(0, buffer->ref_count_);
+  DCHECK_GT(num_outstanding_, 0u);
+  --num_outstanding_;
+  if (free_buffers_.size() < max_free_buffers_) {
+    free_buffers_.push_back(buffer);
+    return;
+  }
+  all_buffers_.erase(
+      std::find(all_buffers_.begin(), all_buffers_.end(), buffer));
+  delete buffer;
+}
+
+}  // namespace net
@@ -0,0 +1,87 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_PACKET_BUFFER_POOL_H_
+#define NET_QUIC_CORE_QUIC_PACKET_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "base/macros.h"
+#include "net/quic/core/quic_constants.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+class QuicPacketBufferPool;
+
+// A reference-counted packet-sized buffer drawn from a QuicPacketBufferPool.
+// The receive path reads datagrams directly into these buffers and hands out
+// references instead of copying packet bytes; when the last reference is
+// released the buffer goes back to the pool's free list. Not thread-safe:
+// all references to a buffer must be manipulated on the dispatch thread,
+// like the rest of the receive path.
+class QUIC_EXPORT_PRIVATE QuicPacketBuffer {
+ public:
+  char* data() { return buffer_; }
+  const char* data() const { return buffer_; }
+  size_t capacity() const { return kMaxPacketSize; }
+
+  void AddRef() { ++ref_count_; }
+
+  // Drops one reference. On the last release the buffer is recycled into its
+  // pool, or freed if the pool has already been destroyed.
+  void Release();
+
+  int ref_count() const { return ref_count_; }
+
+ private:
+  friend class QuicPacketBufferPool;
+
+  explicit QuicPacketBuffer(QuicPacketBufferPool* pool);
+  ~QuicPacketBuffer();
+
+  int ref_count_;
+  QuicPacketBufferPool* pool_;
+  char buffer_[kMaxPacketSize];
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPacketBuffer);
+};
+
+// An allocator of QuicPacketBuffers which retains up to |max_free_buffers|
+// released buffers for reuse, so a steady-state receive ring performs no
+// heap allocation per packet.
+class QUIC_EXPORT_PRIVATE QuicPacketBufferPool {
+ public:
+  explicit QuicPacketBufferPool(size_t max_free_buffers);
+
+  // Outstanding buffers survive pool destruction; they free themselves when
+  // their last reference is released.
+  ~QuicPacketBufferPool();
+
+  // Returns a buffer with one reference owned by the caller.
+  QuicPacketBuffer* HandOut();
+
+  size_t num_free_buffers() const { return free_buffers_.size(); }
+  size_t num_outstanding_buffers() const { return num_outstanding_; }
+
+ private:
+  friend class QuicPacketBuffer;
+
+  // Called by QuicPacketBuffer when its last reference is dropped.
+  void Recycle(QuicPacketBuffer* buffer);
+
+  std::vector<QuicPacketBuffer*> free_buffers_;
+  // Every live buffer created by this pool, free or outstanding. Used only
+  // at destruction to orphan buffers callers still hold.
+  std::vector<QuicPacketBuffer*> all_buffers_;
+  const size_t max_free_buffers_;
+  size_t num_outstanding_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPacketBufferPool);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_PACKET_BUFFER_POOL_H_
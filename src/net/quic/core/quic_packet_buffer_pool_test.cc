@@ -0,0 +1,67 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_packet_buffer_pool.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+TEST(QuicPacketBufferPoolTest, HandOutAndRecycle) {
+  QuicPacketBufferPool pool(2);
+  QuicPacketBuffer* buffer = pool.HandOut();
+  ASSERT_NE(nullptr, buffer);
+  EXPECT_EQ(1, buffer->ref_count());
+  EXPECT_EQ(1u, pool.num_outstanding_buffers());
+  EXPECT_EQ(0u, pool.num_free_buffers());
+
+  buffer->Release();
+  EXPECT_EQ(0u, pool.num_outstanding_buffers());
+  EXPECT_EQ(1u, pool.num_free_buffers());
+
+  // The recycled buffer is handed out again before any new allocation.
+  EXPECT_EQ(buffer, pool.HandOut());
+  buffer->Release();
+}
+
+TEST(QuicPacketBufferPoolTest, SharedReferencesKeepBufferOutstanding) {
+  QuicPacketBufferPool pool(2);
+  QuicPacketBuffer* buffer = pool.HandOut();
+  buffer->AddRef();
+  EXPECT_EQ(2, buffer->ref_count());
+
+  buffer->Release();
+  EXPECT_EQ(1u, pool.num_outstanding_buffers());
+
+  buffer->Release();
+  EXPECT_EQ(0u, pool.num_outstanding_buffers());
+  EXPECT_EQ(1u, pool.num_free_buffers());
+}
+
+TEST(QuicPacketBufferPoolTest, FreeListIsBounded) {
+  QuicPacketBufferPool pool(1);
+  QuicPacketBuffer* first = pool.HandOut();
+  QuicPacketBuffer* second = pool.HandOut();
+  first->Release();
+  second->Release();
+  // Only one released buffer is retained; the other is freed.
+  EXPECT_EQ(1u, pool.num_free_buffers());
+}
+
+TEST(QuicPacketBufferPoolTest, OutstandingBufferSurvivesPoolDestruction) {
+  QuicPacketBuffer* buffer;
+  {
+    QuicPacketBufferPool pool(2);
+    buffer = pool.HandOut();
+    buffer->data()[0] = 'x';
+  }
+  // The buffer is orphaned but still valid; releasing the last reference
+  // frees it.
+  EXPECT_EQ('x', buffer->data()[0]);
+  buffer->Release();
+}
+
+}  // namespace
+}  // namespace net
@@ -6,9 +6,11 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 
 #include "base/macros.h"
 #include "net/quic/core/crypto/crypto_protocol.h"
+#include "net/quic/core/quic_copy_counters.h"
 #include "net/quic/core/quic_data_writer.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_aligned.h"
@@ -48,7 +50,8 @@ QuicPacketCreator::QuicPacketCreator(QuicConnectionId connection_id,
       latched_flag_no_stop_waiting_frames_(
           FLAGS_quic_reloadable_flag_quic_no_stop_waiting_frames),
       pending_padding_bytes_(0),
-      needs_full_padding_(false) {
+      needs_full_padding_(false),
+      current_stream_priority_(kV3LowestPriority) {
   SetMaxPacketLength(kDefaultMaxPacketSize);
 }
 
@@ -148,6 +151,8 @@ bool QuicPacketCreator::ConsumeData(QuicStreamId id,
     delete frame->stream_frame;
     return false;
   }
+  // Stamp the packet with the most important stream it carries.
+  packet_.priority = std::min(packet_.priority, current_stream_priority_);
   if (needs_full_padding) {
     needs_full_padding_ = true;
   }
@@ -217,6 +222,8 @@ void QuicPacketCreator::CreateStreamFrame(QuicStreamId id,
   UniqueStreamBuffer buffer =
       NewStreamBuffer(buffer_allocator_, bytes_consumed);
   QuicUtils::CopyToBuffer(iov, iov_offset, bytes_consumed, buffer.get());
+  QuicCopyCounters::RecordCopy(QuicCopyCounters::COPY_SITE_PACKET_CREATOR,
+                               bytes_consumed);
   *frame = QuicFrame(new QuicStreamFrame(id, set_fin, offset, bytes_consumed,
                                          std::move(buffer)));
 }
@@ -307,6 +314,7 @@ void QuicPacketCreator::ClearPacket() {
   DCHECK(packet_.retransmittable_frames.empty());
   packet_.listeners.clear();
   packet_.largest_acked = 0;
+  packet_.priority = kV3LowestPriority;
   needs_full_padding_ = false;
 }
 
@@ -342,6 +350,24 @@ void QuicPacketCreator::CreateAndSerializeStreamFrame(
       std::min<size_t>(available_size, remaining_data_size);
 
   const bool set_fin = fin && (bytes_consumed == remaining_data_size);
+
+  // Serialize the frame straight into the packet buffer without materializing
+  // a QuicStreamFrame first; the payload is gathered from |iov| (or written
+  // by the data producer) in a single pass.
+  if (!framer_->AppendStreamFrameHeader(id, stream_offset, set_fin, &writer)) {
+    QUIC_BUG << "AppendStreamFrameHeader failed";
+    return;
+  }
+  const size_t payload_offset = writer.length();
+  if (!framer_->AppendStreamFrameData(id, stream_offset, iov, iov_offset,
+                                      bytes_consumed, &writer)) {
+    QUIC_BUG << "AppendStreamFrameData failed";
+    return;
+  }
+
+  // A frame is still materialized for the retransmittable frame storage; when
+  // there is no data producer, its copy of the payload is taken from the
+  // packet buffer before the packet is encrypted in place.
   std::unique_ptr<QuicStreamFrame> frame;
   if (framer_->HasDataProducer()) {
     frame = QuicMakeUnique<QuicStreamFrame>(id, set_fin, stream_offset,
@@ -349,26 +375,15 @@ void QuicPacketCreator::CreateAndSerializeStreamFrame(
   } else {
     UniqueStreamBuffer stream_buffer =
         NewStreamBuffer(buffer_allocator_, bytes_consumed);
-    QuicUtils::CopyToBuffer(iov, iov_offset, bytes_consumed,
-                            stream_buffer.get());
+    memcpy(stream_buffer.get(), writer.data() + payload_offset,
+           bytes_consumed);
+    QuicCopyCounters::RecordCopy(QuicCopyCounters::COPY_SITE_PACKET_CREATOR,
+                                 bytes_consumed);
     frame = QuicMakeUnique<QuicStreamFrame>(
         id, set_fin, stream_offset, bytes_consumed, std::move(stream_buffer));
   }
   QUIC_DVLOG(1) << ENDPOINT << "Adding frame: " << *frame;
 
-  // TODO(ianswett): AppendTypeByte and AppendStreamFrame could be optimized
-  // into one method that takes a QuicStreamFrame, if warranted.
-  if (!framer_->AppendTypeByte(QuicFrame(frame.get()),
-                               /* no stream frame length */ true, &writer)) {
-    QUIC_BUG << "AppendTypeByte failed";
-    return;
-  }
-  if (!framer_->AppendStreamFrame(*frame, /* no stream frame length */ true,
-                                  &writer)) {
-    QUIC_BUG << "AppendStreamFrame failed";
-    return;
-  }
-
   size_t encrypted_length = framer_->EncryptInPlace(
       packet_.encryption_level, packet_.packet_number,
       GetStartOfEncryptedData(framer_->version(), header), writer.length(),
@@ -386,10 +401,138 @@ void QuicPacketCreator::CreateAndSerializeStreamFrame(
   if (ack_listener != nullptr) {
     packet_.listeners.emplace_back(std::move(ack_listener), bytes_consumed);
   }
+  packet_.priority = std::min(packet_.priority, current_stream_priority_);
   packet_.retransmittable_frames.push_back(QuicFrame(frame.release()));
   OnSerializedPacket();
 }
 
+// static
+const size_t QuicPacketCreator::kMaxBatchEncryptPackets;
+
+void QuicPacketCreator::CreateAndSerializeStreamFrames(
+    QuicStreamId id,
+    const QuicIOVector& iov,
+    QuicStreamOffset iov_offset,
+    QuicStreamOffset stream_offset,
+    bool fin,
+    QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener,
+    size_t max_packets,
+    size_t* num_bytes_consumed) {
+  DCHECK(queued_frames_.empty());
+  DCHECK_LE(max_packets, kMaxBatchEncryptPackets);
+  QUIC_BUG_IF(iov_offset == iov.total_length && !fin)
+      << "Creating a stream frame with no data or fin.";
+  const EncryptionLevel level = packet_.encryption_level;
+  *num_bytes_consumed = 0;
+
+  // Stage 1: serialize plaintext packets back to back.
+  QUIC_CACHELINE_ALIGNED char buffers[kMaxBatchEncryptPackets][kMaxPacketSize];
+  QuicFramer::PendingInPlaceEncryption pending[kMaxBatchEncryptPackets];
+  size_t bytes_in_packet[kMaxBatchEncryptPackets];
+  std::vector<SerializedPacket> staged_packets;
+  staged_packets.reserve(max_packets);
+  size_t num_staged = 0;
+  size_t serialized_bytes = 0;
+  while (num_staged < max_packets &&
+         (iov_offset + serialized_bytes < iov.total_length ||
+          (fin && num_staged == 0))) {
+    char* buffer = buffers[num_staged];
+    QuicPacketHeader header;
+    FillPacketHeader(&header);
+    QuicDataWriter writer(kMaxPacketSize, buffer, framer_->perspective(),
+                          framer_->endianness());
+    if (!framer_->AppendPacketHeader(header, &writer)) {
+      QUIC_BUG << "AppendPacketHeader failed";
+      return;
+    }
+
+    const QuicStreamOffset packet_stream_offset =
+        stream_offset + serialized_bytes;
+    const size_t remaining_data_size =
+        iov.total_length - iov_offset - serialized_bytes;
+    const size_t min_frame_size = QuicFramer::GetMinStreamFrameSize(
+        framer_->version(), id, packet_stream_offset,
+        /* last_frame_in_packet= */ true);
+    const size_t available_size =
+        max_plaintext_size_ - writer.length() - min_frame_size;
+    const size_t bytes_consumed =
+        std::min<size_t>(available_size, remaining_data_size);
+    const bool set_fin = fin && (bytes_consumed == remaining_data_size);
+
+    if (!framer_->AppendStreamFrameHeader(id, packet_stream_offset, set_fin,
+                                          &writer)) {
+      QUIC_BUG << "AppendStreamFrameHeader failed";
+      return;
+    }
+    const size_t payload_offset = writer.length();
+    if (!framer_->AppendStreamFrameData(id, packet_stream_offset, iov,
+                                        iov_offset + serialized_bytes,
+                                        bytes_consumed, &writer)) {
+      QUIC_BUG << "AppendStreamFrameData failed";
+      return;
+    }
+
+    std::unique_ptr<QuicStreamFrame> frame;
+    if (framer_->HasDataProducer()) {
+      frame = QuicMakeUnique<QuicStreamFrame>(id, set_fin,
+                                              packet_stream_offset,
+                                              bytes_consumed);
+    } else {
+      UniqueStreamBuffer stream_buffer =
+          NewStreamBuffer(buffer_allocator_, bytes_consumed);
+      memcpy(stream_buffer.get(), writer.data() + payload_offset,
+             bytes_consumed);
+      QuicCopyCounters::RecordCopy(QuicCopyCounters::COPY_SITE_PACKET_CREATOR,
+                                   bytes_consumed);
+      frame = QuicMakeUnique<QuicStreamFrame>(id, set_fin,
+                                              packet_stream_offset,
+                                              bytes_consumed,
+                                              std::move(stream_buffer));
+    }
+    QUIC_DVLOG(1) << ENDPOINT << "Adding frame: " << *frame;
+
+    pending[num_staged].packet_number = packet_.packet_number;
+    pending[num_staged].ad_len =
+        GetStartOfEncryptedData(framer_->version(), header);
+    pending[num_staged].total_len = writer.length();
+    pending[num_staged].buffer_len = kMaxPacketSize;
+    pending[num_staged].buffer = buffer;
+    bytes_in_packet[num_staged] = bytes_consumed;
+
+    packet_size_ = 0;
+    if (ack_listener != nullptr) {
+      packet_.listeners.emplace_back(ack_listener, bytes_consumed);
+    }
+    packet_.retransmittable_frames.push_back(QuicFrame(frame.release()));
+    staged_packets.push_back(std::move(packet_));
+    ClearPacket();
+
+    serialized_bytes += bytes_consumed;
+    ++num_staged;
+    if (set_fin) {
+      break;
+    }
+  }
+
+  // Stage 2: encrypt the whole burst with one batched call, so a
+  // multi-buffer AEAD can keep several AES streams in flight.
+  size_t encrypted_lengths[kMaxBatchEncryptPackets];
+  framer_->EncryptInPlaceBatch(level, pending, num_staged, encrypted_lengths);
+
+  // Stage 3: deliver the packets to the delegate in serialization order.
+  for (size_t i = 0; i < num_staged; ++i) {
+    if (encrypted_lengths[i] == 0) {
+      QUIC_BUG << "Failed to encrypt packet number "
+               << staged_packets[i].packet_number;
+      return;
+    }
+    staged_packets[i].encrypted_buffer = pending[i].buffer;
+    staged_packets[i].encrypted_length = encrypted_lengths[i];
+    delegate_->OnSerializedPacket(&staged_packets[i]);
+    *num_bytes_consumed += bytes_in_packet[i];
+  }
+}
+
 bool QuicPacketCreator::HasPendingFrames() const {
   return !queued_frames_.empty();
 }
@@ -122,6 +122,25 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
       QuicReferenceCountedPointer<QuicAckListenerInterface> listener,
       size_t* num_bytes_consumed);
 
+  // The largest number of packets CreateAndSerializeStreamFrames stages
+  // before encrypting them with one batched call.
+  static const size_t kMaxBatchEncryptPackets = 4;
+
+  // Batched variant of CreateAndSerializeStreamFrame: serializes up to
+  // |max_packets| plaintext packets from |iov|, encrypts them with a single
+  // call into the encrypter's batch interface, and delivers them to the
+  // delegate in order.  Sets |num_bytes_consumed| to the total number of
+  // bytes consumed across all delivered packets.
+  void CreateAndSerializeStreamFrames(
+      QuicStreamId id,
+      const QuicIOVector& iov,
+      QuicStreamOffset iov_offset,
+      QuicStreamOffset stream_offset,
+      bool fin,
+      QuicReferenceCountedPointer<QuicAckListenerInterface> listener,
+      size_t max_packets,
+      size_t* num_bytes_consumed);
+
   // Returns true if there are frames pending to be serialized.
   bool HasPendingFrames() const;
 
@@ -209,6 +228,13 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
     debug_delegate_ = debug_delegate;
   }
 
+  // Sets the priority of the stream whose data is being consumed. Stream
+  // frames added to the packet under construction stamp the packet with the
+  // most important (numerically lowest) priority seen.
+  void set_current_stream_priority(SpdyPriority priority) {
+    current_stream_priority_ = priority;
+  }
+
   bool latched_flag_no_stop_waiting_frames() const {
     return latched_flag_no_stop_waiting_frames_;
   }
@@ -314,6 +340,10 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
   // bytes.
   bool needs_full_padding_;
 
+  // Priority of the stream currently being consumed, stamped onto the packet
+  // under construction whenever a stream frame is added.
+  SpdyPriority current_stream_priority_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicPacketCreator);
 };
 
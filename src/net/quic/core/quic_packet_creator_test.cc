@@ -914,6 +914,43 @@ TEST_P(QuicPacketCreatorTest, SerializeAndSendStreamFrame) {
   EXPECT_FALSE(creator_.HasPendingFrames());
 }
 
+TEST_P(QuicPacketCreatorTest, SerializeAndSendStreamFramesBatched) {
+  if (!GetParam().version_serialization) {
+    creator_.StopSendingVersion();
+  }
+  EXPECT_FALSE(creator_.HasPendingFrames());
+
+  // Enough data to fill several packets, so the batched path stages and
+  // encrypts more than one per call.
+  const std::string data(3 * kDefaultMaxPacketSize, 'x');
+  QuicIOVector iov(MakeIOVectorFromStringPiece(data));
+  if (client_framer_.HasDataProducer()) {
+    producer_.SaveStreamData(kHeadersStreamId, iov, 0u, 0u, iov.total_length);
+  }
+  std::vector<QuicPacketNumber> packet_numbers;
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillRepeatedly(Invoke([this, &packet_numbers](SerializedPacket* packet) {
+        packet_numbers.push_back(packet->packet_number);
+        ASSERT_TRUE(packet->encrypted_buffer);
+        ASSERT_EQ(1u, packet->retransmittable_frames.size());
+        EXPECT_EQ(STREAM_FRAME, packet->retransmittable_frames[0].type);
+        DeleteFrames(&packet->retransmittable_frames);
+      }));
+  size_t num_bytes_consumed;
+  creator_.CreateAndSerializeStreamFrames(
+      kHeadersStreamId, iov, 0, 0, true, nullptr,
+      QuicPacketCreator::kMaxBatchEncryptPackets, &num_bytes_consumed);
+
+  // Several packets were delivered, in packet number order.
+  EXPECT_LT(1u, packet_numbers.size());
+  EXPECT_GE(QuicPacketCreator::kMaxBatchEncryptPackets, packet_numbers.size());
+  for (size_t i = 1; i < packet_numbers.size(); ++i) {
+    EXPECT_EQ(packet_numbers[i - 1] + 1, packet_numbers[i]);
+  }
+  EXPECT_LT(0u, num_bytes_consumed);
+  EXPECT_FALSE(creator_.HasPendingFrames());
+}
+
 TEST_P(QuicPacketCreatorTest, AddUnencryptedStreamDataClosesConnection) {
   creator_.set_encryption_level(ENCRYPTION_NONE);
   EXPECT_CALL(delegate_, OnUnrecoverableError(_, _, _));
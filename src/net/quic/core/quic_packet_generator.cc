@@ -161,9 +161,20 @@ QuicConsumedData QuicPacketGenerator::ConsumeDataFastPath(
                                          NOT_HANDSHAKE)) {
     // Serialize and encrypt the packet.
     size_t bytes_consumed = 0;
-    packet_creator_.CreateAndSerializeStreamFrame(
-        id, iov, total_bytes_consumed, offset + total_bytes_consumed, fin,
-        ack_listener, &bytes_consumed);
+    if (FLAGS_quic_reloadable_flag_quic_batched_egress_encryption) {
+      QUIC_FLAG_COUNT(quic_reloadable_flag_quic_batched_egress_encryption);
+      packet_creator_.CreateAndSerializeStreamFrames(
+          id, iov, total_bytes_consumed, offset + total_bytes_consumed, fin,
+          ack_listener, QuicPacketCreator::kMaxBatchEncryptPackets,
+          &bytes_consumed);
+      if (bytes_consumed == 0) {
+        break;
+      }
+    } else {
+      packet_creator_.CreateAndSerializeStreamFrame(
+          id, iov, total_bytes_consumed, offset + total_bytes_consumed, fin,
+          ack_listener, &bytes_consumed);
+    }
     total_bytes_consumed += bytes_consumed;
   }
 
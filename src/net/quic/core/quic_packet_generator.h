@@ -189,6 +189,12 @@ class QUIC_EXPORT_PRIVATE QuicPacketGenerator {
     packet_creator_.set_debug_delegate(debug_delegate);
   }
 
+  // Sets the priority of the stream whose data will be consumed next, so the
+  // creator can stamp the packets it builds.
+  void set_current_stream_priority(SpdyPriority priority) {
+    packet_creator_.set_current_stream_priority(priority);
+  }
+
   bool latched_flag_no_stop_waiting_frames() const {
     return packet_creator_.latched_flag_no_stop_waiting_frames();
   }
@@ -8,6 +8,7 @@
 #include <cstddef>
 
 #include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_time.h"
 #include "net/quic/platform/api/quic_export.h"
 #include "net/quic/platform/api/quic_socket_address.h"
 
@@ -23,6 +24,12 @@ class QUIC_EXPORT_PRIVATE PerPacketOptions {
   // Returns a heap-allocated copy of |this|.
   virtual PerPacketOptions* Clone() const = 0;
 
+  // When the writer returns true from SupportsReleaseTime(), the earliest
+  // time the kernel should put this packet on the wire, expressed as a delay
+  // from the moment of the WritePacket call. Zero means send immediately.
+  // Writers without release time support ignore this field.
+  QuicTime::Delta release_time_delay = QuicTime::Delta::Zero();
+
  private:
   PerPacketOptions(PerPacketOptions&& other) = delete;
   PerPacketOptions& operator=(PerPacketOptions&& other) = delete;
@@ -66,6 +73,18 @@ class QUIC_EXPORT_PRIVATE QuicPacketWriter {
   // size of a valid QUIC packet.
   virtual QuicByteCount GetMaxPacketSize(
       const QuicSocketAddress& peer_address) const = 0;
+
+  // Pushes any internally buffered packets out to the network. Writers which
+  // batch packets across WritePacket calls override this; for unbatched
+  // writers it is a no-op. Returns WRITE_STATUS_OK and the number of bytes
+  // flushed on success.
+  virtual WriteResult Flush() { return WriteResult(WRITE_STATUS_OK, 0); }
+
+  // Returns true if the writer honors PerPacketOptions::release_time_delay,
+  // i.e. hands packets to a kernel-level scheduler which enforces the pacing
+  // gaps. When true, the connection may submit paced packets immediately
+  // with a release timestamp instead of spacing them with send alarms.
+  virtual bool SupportsReleaseTime() const { return false; }
 };
 
 }  // namespace net
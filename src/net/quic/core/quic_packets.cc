@@ -4,6 +4,7 @@
 
 #include "net/quic/core/quic_packets.h"
 
+#include "net/quic/core/quic_packet_buffer_pool.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/core/quic_versions.h"
 #include "net/quic/platform/api/quic_flags.h"
@@ -148,7 +149,9 @@ QuicReceivedPacket::QuicReceivedPacket(const char* buffer,
                                        QuicTime receipt_time)
     : QuicEncryptedPacket(buffer, length),
       receipt_time_(receipt_time),
-      ttl_(0) {}
+      ttl_(0),
+      ecn_codepoint_(ECN_NOT_ECT),
+      pool_buffer_(nullptr) {}
 
 QuicReceivedPacket::QuicReceivedPacket(const char* buffer,
                                        size_t length,
@@ -156,7 +159,9 @@ QuicReceivedPacket::QuicReceivedPacket(const char* buffer,
                                        bool owns_buffer)
     : QuicEncryptedPacket(buffer, length, owns_buffer),
       receipt_time_(receipt_time),
-      ttl_(0) {}
+      ttl_(0),
+      ecn_codepoint_(ECN_NOT_ECT),
+      pool_buffer_(nullptr) {}
 
 QuicReceivedPacket::QuicReceivedPacket(const char* buffer,
                                        size_t length,
@@ -166,13 +171,44 @@ QuicReceivedPacket::QuicReceivedPacket(const char* buffer,
                                        bool ttl_valid)
     : QuicEncryptedPacket(buffer, length, owns_buffer),
       receipt_time_(receipt_time),
-      ttl_(ttl_valid ? ttl : -1) {}
+      ttl_(ttl_valid ? ttl : -1),
+      ecn_codepoint_(ECN_NOT_ECT),
+      pool_buffer_(nullptr) {}
+
+QuicReceivedPacket::QuicReceivedPacket(QuicPacketBuffer* pool_buffer,
+                                       size_t length,
+                                       QuicTime receipt_time,
+                                       int ttl,
+                                       bool ttl_valid)
+    : QuicEncryptedPacket(pool_buffer->data(), length, /*owns_buffer=*/false),
+      receipt_time_(receipt_time),
+      ttl_(ttl_valid ? ttl : -1),
+      ecn_codepoint_(ECN_NOT_ECT),
+      pool_buffer_(pool_buffer) {
+  pool_buffer_->AddRef();
+}
+
+QuicReceivedPacket::~QuicReceivedPacket() {
+  if (pool_buffer_ != nullptr) {
+    pool_buffer_->Release();
+  }
+}
 
 std::unique_ptr<QuicReceivedPacket> QuicReceivedPacket::Clone() const {
-  char* buffer = new char[this->length()];
-  memcpy(buffer, this->data(), this->length());
-  return QuicMakeUnique<QuicReceivedPacket>(
-      buffer, this->length(), receipt_time(), true, ttl(), ttl() >= 0);
+  std::unique_ptr<QuicReceivedPacket> clone;
+  if (pool_buffer_ != nullptr) {
+    // Share the pooled buffer instead of copying the packet bytes.
+    clone = QuicMakeUnique<QuicReceivedPacket>(pool_buffer_, this->length(),
+                                               receipt_time(), ttl(),
+                                               ttl() >= 0);
+  } else {
+    char* buffer = new char[this->length()];
+    memcpy(buffer, this->data(), this->length());
+    clone = QuicMakeUnique<QuicReceivedPacket>(
+        buffer, this->length(), receipt_time(), true, ttl(), ttl() >= 0);
+  }
+  clone->set_ecn_codepoint(ecn_codepoint());
+  return clone;
 }
 
 std::ostream& operator<<(std::ostream& os, const QuicReceivedPacket& s) {
@@ -212,7 +248,8 @@ SerializedPacket::SerializedPacket(QuicPacketNumber packet_number,
       has_stop_waiting(has_stop_waiting),
       transmission_type(NOT_RETRANSMISSION),
       original_packet_number(0),
-      largest_acked(0) {}
+      largest_acked(0),
+      priority(kV3LowestPriority) {}
 
 SerializedPacket::SerializedPacket(const SerializedPacket& other) = default;
 
@@ -231,7 +268,8 @@ SerializedPacket::SerializedPacket(SerializedPacket&& other)
       has_stop_waiting(other.has_stop_waiting),
       transmission_type(other.transmission_type),
       original_packet_number(other.original_packet_number),
-      largest_acked(other.largest_acked) {
+      largest_acked(other.largest_acked),
+      priority(other.priority) {
   retransmittable_frames.swap(other.retransmittable_frames);
   listeners.swap(other.listeners);
 }
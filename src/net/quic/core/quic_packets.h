@@ -27,10 +27,12 @@
 #include "net/quic/platform/api/quic_export.h"
 #include "net/quic/platform/api/quic_socket_address.h"
 #include "net/quic/platform/api/quic_string_piece.h"
+#include "net/spdy/core/spdy_protocol.h"
 
 namespace net {
 
 class QuicPacket;
+class QuicPacketBuffer;
 struct QuicPacketHeader;
 
 // Size in bytes of the data packet header.
@@ -181,8 +183,18 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacket : public QuicEncryptedPacket {
                      bool owns_buffer,
                      int ttl,
                      bool ttl_valid);
+  // Constructs a packet backed by a pooled, reference-counted buffer. Takes
+  // one reference on |pool_buffer|, released on destruction. Clone() on such
+  // a packet shares the buffer instead of copying it.
+  QuicReceivedPacket(QuicPacketBuffer* pool_buffer,
+                     size_t length,
+                     QuicTime receipt_time,
+                     int ttl,
+                     bool ttl_valid);
+  ~QuicReceivedPacket();
 
-  // Clones the packet into a new packet which owns the buffer.
+  // Clones the packet into a new packet which owns (or, for pool-backed
+  // packets, shares) the buffer.
   std::unique_ptr<QuicReceivedPacket> Clone() const;
 
   // Returns the time at which the packet was received.
@@ -191,6 +203,13 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacket : public QuicEncryptedPacket {
   // This is the TTL of the packet, assuming ttl_vaild_ is true.
   int ttl() const { return ttl_; }
 
+  // The ECN codepoint from the packet's IP header, or ECN_NOT_ECT if the
+  // reader could not extract it.
+  QuicEcnCodepoint ecn_codepoint() const { return ecn_codepoint_; }
+  void set_ecn_codepoint(QuicEcnCodepoint ecn_codepoint) {
+    ecn_codepoint_ = ecn_codepoint;
+  }
+
   // By default, gtest prints the raw bytes of an object. The bool data
   // member (in the base class QuicData) causes this object to have padding
   // bytes, which causes the default gtest object printer to read
@@ -202,6 +221,10 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacket : public QuicEncryptedPacket {
  private:
   const QuicTime receipt_time_;
   int ttl_;
+  QuicEcnCodepoint ecn_codepoint_;
+  // Non-null if the packet data lives in a pooled buffer this packet holds a
+  // reference on.
+  QuicPacketBuffer* pool_buffer_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicReceivedPacket);
 };
@@ -237,6 +260,11 @@ struct QUIC_EXPORT_PRIVATE SerializedPacket {
   // The largest acked of the AckFrame in this packet if has_ack is true,
   // 0 otherwise.
   QuicPacketNumber largest_acked;
+  // Priority of the most important stream with data in this packet
+  // (numerically lowest SpdyPriority); kV3LowestPriority when the packet
+  // carries no stream data. Lets retransmission scheduling favor packets
+  // carrying high-priority streams.
+  SpdyPriority priority;
 
   // Optional notifiers which will be informed when this packet has been ACKed.
   std::list<AckListenerWrapper> listeners;
@@ -0,0 +1,326 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Steady-state microbenchmarks for the hot paths of the QUIC core:
+// QuicFramer::ProcessPacket (parse), QuicPacketCreator (serialize),
+// QuicFramer::EncryptPayload (encrypt), ack frame processing, and
+// QuicStreamSequencerBuffer (reassembly). Each benchmark reports ns/op
+// and allocs/op so CI can gate both time and allocation regressions.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "base/time/time.h"
+#include "net/quic/core/crypto/null_decrypter.h"
+#include "net/quic/core/crypto/null_encrypter.h"
+#include "net/quic/core/quic_framer.h"
+#include "net/quic/core/quic_packet_creator.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_simple_buffer_allocator.h"
+#include "net/quic/core/quic_stream_sequencer_buffer.h"
+#include "net/quic/core/quic_versions.h"
+#include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/quic/platform/api/quic_ptr_util.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+#include "net/quic/platform/api/quic_test.h"
+#include "net/quic/test_tools/quic_test_utils.h"
+#include "testing/perf/perf_test.h"
+
+namespace {
+
+// Number of heap allocations since process start. Maintained by the global
+// operator new overrides below; the count is binary-wide, but each benchmark
+// samples it immediately around its measured loop, so unrelated allocations
+// only show up if they happen on this thread during the loop.
+uint64_t g_num_allocations = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+  ++g_num_allocations;
+  return malloc(size);
+}
+
+void* operator new[](size_t size) {
+  ++g_num_allocations;
+  return malloc(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, size_t size) noexcept {
+  free(ptr);
+}
+
+namespace net {
+namespace test {
+namespace {
+
+const QuicConnectionId kConnectionId = 42;
+const QuicStreamId kStreamId = 5;
+// Payload sizes exercising the two interesting packet shapes: small frames
+// where per-packet overhead dominates, and full packets where memcpy and
+// encryption dominate.
+const size_t kSmallPayloadSize = 32;
+const size_t kFullPayloadSize = 1200;
+const int kWarmupIterations = 1000;
+const int kBenchmarkIterations = 100000;
+
+// Measures wall time and allocations across a benchmark loop and reports
+// them in per-operation units under the current test's name.
+class BenchmarkTimer {
+ public:
+  BenchmarkTimer() : start_allocations_(g_num_allocations),
+                     start_ticks_(base::TimeTicks::Now()) {}
+
+  void Report(int iterations) {
+    const base::TimeDelta elapsed = base::TimeTicks::Now() - start_ticks_;
+    const uint64_t allocations = g_num_allocations - start_allocations_;
+    const ::testing::TestInfo* test_info =
+        ::testing::UnitTest::GetInstance()->current_test_info();
+    const std::string modifier = std::string(".") + test_info->name();
+    perf_test::PrintResult(
+        test_info->test_case_name(), modifier, "time",
+        elapsed.InMicroseconds() * 1000.0 / iterations, "ns/op", true);
+    perf_test::PrintResult(
+        test_info->test_case_name(), modifier, "allocations",
+        static_cast<double>(allocations) / iterations, "allocs/op", true);
+  }
+
+ private:
+  uint64_t start_allocations_;
+  base::TimeTicks start_ticks_;
+
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkTimer);
+};
+
+// Discards serialized packets; serialization cost is what is measured, not
+// what the connection does with the result.
+class DiscardingDelegate : public QuicPacketCreator::DelegateInterface {
+ public:
+  DiscardingDelegate() {}
+  ~DiscardingDelegate() override {}
+
+  void OnSerializedPacket(SerializedPacket* serialized_packet) override {
+    ClearSerializedPacket(serialized_packet);
+  }
+
+  void OnUnrecoverableError(QuicErrorCode error,
+                            const std::string& error_details,
+                            ConnectionCloseSource source) override {
+    QUIC_BUG << "Unrecoverable error in benchmark: " << error_details;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(DiscardingDelegate);
+};
+
+class QuicPerfTest : public QuicTest {
+ protected:
+  QuicPerfTest()
+      : client_framer_(CurrentSupportedVersions(),
+                       QuicTime::Zero(),
+                       Perspective::IS_CLIENT),
+        server_framer_(CurrentSupportedVersions(),
+                       QuicTime::Zero(),
+                       Perspective::IS_SERVER) {
+    client_framer_.set_visitor(&visitor_);
+    server_framer_.set_visitor(&visitor_);
+  }
+
+  // Returns a client-to-server packet carrying one stream frame with
+  // |payload_size| bytes, encrypted with the NullEncrypter.
+  std::unique_ptr<QuicEncryptedPacket> MakeStreamPacket(size_t payload_size) {
+    return std::unique_ptr<QuicEncryptedPacket>(ConstructEncryptedPacket(
+        kConnectionId, /*version_flag=*/false, /*reset_flag=*/false,
+        /*packet_number=*/1, std::string(payload_size, 'a')));
+  }
+
+  // Returns a client-to-server packet carrying one ack frame with
+  // |num_ack_blocks| ack blocks.
+  std::unique_ptr<QuicEncryptedPacket> MakeAckPacket(size_t num_ack_blocks) {
+    QuicPacketHeader header;
+    header.public_header.connection_id = kConnectionId;
+    header.public_header.version_flag = false;
+    header.public_header.reset_flag = false;
+    header.packet_number = 1;
+    QuicAckFrame ack = MakeAckFrameWithAckBlocks(num_ack_blocks, 1);
+    QuicFrames frames;
+    frames.push_back(QuicFrame(&ack));
+    std::unique_ptr<QuicPacket> packet(
+        BuildUnsizedDataPacket(&client_framer_, header, frames));
+    CHECK(packet != nullptr);
+    char* buffer = new char[kMaxPacketSize];
+    size_t encrypted_length = client_framer_.EncryptPayload(
+        ENCRYPTION_NONE, 1, *packet, buffer, kMaxPacketSize);
+    CHECK_NE(0u, encrypted_length);
+    return QuicMakeUnique<QuicEncryptedPacket>(buffer, encrypted_length,
+                                               /*owns_buffer=*/true);
+  }
+
+  // Parses |packet| |kBenchmarkIterations| times on the server framer and
+  // reports per-packet cost.
+  void BenchmarkProcessPacket(const QuicEncryptedPacket& packet) {
+    for (int i = 0; i < kWarmupIterations; ++i) {
+      ASSERT_TRUE(server_framer_.ProcessPacket(packet));
+    }
+    BenchmarkTimer timer;
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      server_framer_.ProcessPacket(packet);
+    }
+    timer.Report(kBenchmarkIterations);
+  }
+
+  QuicFramer client_framer_;
+  QuicFramer server_framer_;
+  NoOpFramerVisitor visitor_;
+};
+
+TEST_F(QuicPerfTest, FramerProcessSmallStreamPacket) {
+  std::unique_ptr<QuicEncryptedPacket> packet =
+      MakeStreamPacket(kSmallPayloadSize);
+  BenchmarkProcessPacket(*packet);
+}
+
+TEST_F(QuicPerfTest, FramerProcessFullStreamPacket) {
+  std::unique_ptr<QuicEncryptedPacket> packet =
+      MakeStreamPacket(kFullPayloadSize);
+  BenchmarkProcessPacket(*packet);
+}
+
+TEST_F(QuicPerfTest, FramerProcessSmallAckPacket) {
+  std::unique_ptr<QuicEncryptedPacket> packet = MakeAckPacket(2);
+  BenchmarkProcessPacket(*packet);
+}
+
+// A reordering-heavy connection routinely carries hundreds of ack blocks;
+// this is the shape that has historically regressed.
+TEST_F(QuicPerfTest, FramerProcessLargeAckPacket) {
+  std::unique_ptr<QuicEncryptedPacket> packet = MakeAckPacket(256);
+  BenchmarkProcessPacket(*packet);
+}
+
+TEST_F(QuicPerfTest, FramerEncryptFullPacket) {
+  QuicPacketHeader header;
+  header.public_header.connection_id = kConnectionId;
+  header.public_header.version_flag = false;
+  header.public_header.reset_flag = false;
+  header.packet_number = 1;
+  std::string payload(kFullPayloadSize, 'a');
+  QuicStreamFrame stream_frame(kStreamId, false, 0, QuicStringPiece(payload));
+  QuicFrames frames;
+  frames.push_back(QuicFrame(&stream_frame));
+  std::unique_ptr<QuicPacket> packet(
+      BuildUnsizedDataPacket(&client_framer_, header, frames));
+  ASSERT_TRUE(packet != nullptr);
+
+  char buffer[kMaxPacketSize];
+  for (int i = 0; i < kWarmupIterations; ++i) {
+    ASSERT_NE(0u, client_framer_.EncryptPayload(ENCRYPTION_NONE, 1, *packet,
+                                                buffer, kMaxPacketSize));
+  }
+  BenchmarkTimer timer;
+  for (int i = 0; i < kBenchmarkIterations; ++i) {
+    client_framer_.EncryptPayload(ENCRYPTION_NONE, i + 1, *packet, buffer,
+                                  kMaxPacketSize);
+  }
+  timer.Report(kBenchmarkIterations);
+}
+
+TEST_F(QuicPerfTest, CreatorSerializeStreamPacket) {
+  SimpleBufferAllocator allocator;
+  DiscardingDelegate delegate;
+  QuicPacketCreator creator(kConnectionId, &client_framer_, &allocator,
+                            &delegate);
+  creator.SetEncrypter(ENCRYPTION_FORWARD_SECURE,
+                       new NullEncrypter(Perspective::IS_CLIENT));
+  creator.set_encryption_level(ENCRYPTION_FORWARD_SECURE);
+
+  std::string payload(kFullPayloadSize, 'a');
+  struct iovec iov;
+  QuicIOVector io_vector(MakeIOVector(payload, &iov));
+  QuicStreamOffset offset = 0;
+  for (int i = 0; i < kWarmupIterations; ++i) {
+    QuicFrame frame;
+    ASSERT_TRUE(creator.ConsumeData(kStreamId, io_vector, 0, offset,
+                                    /*fin=*/false,
+                                    /*needs_full_padding=*/false, &frame));
+    creator.Flush();
+    offset += kFullPayloadSize;
+  }
+  BenchmarkTimer timer;
+  for (int i = 0; i < kBenchmarkIterations; ++i) {
+    QuicFrame frame;
+    creator.ConsumeData(kStreamId, io_vector, 0, offset, /*fin=*/false,
+                        /*needs_full_padding=*/false, &frame);
+    creator.Flush();
+    offset += kFullPayloadSize;
+  }
+  timer.Report(kBenchmarkIterations);
+}
+
+TEST_F(QuicPerfTest, SequencerBufferInOrder) {
+  QuicStreamSequencerBuffer buffer(2 * 1024 * 1024);
+  std::string chunk(kFullPayloadSize, 'a');
+  char scratch[kFullPayloadSize];
+  iovec dest{scratch, kFullPayloadSize};
+  QuicStreamOffset offset = 0;
+  std::string error_details;
+
+  BenchmarkTimer timer;
+  for (int i = 0; i < kBenchmarkIterations; ++i) {
+    size_t written = 0;
+    ASSERT_EQ(QUIC_NO_ERROR,
+              buffer.OnStreamData(offset, chunk, QuicTime::Zero(), &written,
+                                  &error_details));
+    offset += kFullPayloadSize;
+    // Drain as the application would, keeping the buffer in steady state.
+    size_t read = 0;
+    ASSERT_EQ(QUIC_NO_ERROR, buffer.Readv(&dest, 1, &read, &error_details));
+  }
+  timer.Report(kBenchmarkIterations);
+}
+
+// Out-of-order arrival is the expensive path: every other chunk opens a gap
+// that the following chunk closes.
+TEST_F(QuicPerfTest, SequencerBufferOutOfOrder) {
+  QuicStreamSequencerBuffer buffer(2 * 1024 * 1024);
+  std::string chunk(kFullPayloadSize, 'a');
+  char scratch[2 * kFullPayloadSize];
+  iovec dest{scratch, 2 * kFullPayloadSize};
+  QuicStreamOffset offset = 0;
+  std::string error_details;
+
+  BenchmarkTimer timer;
+  for (int i = 0; i < kBenchmarkIterations / 2; ++i) {
+    size_t written = 0;
+    ASSERT_EQ(QUIC_NO_ERROR,
+              buffer.OnStreamData(offset + kFullPayloadSize, chunk,
+                                  QuicTime::Zero(), &written, &error_details));
+    ASSERT_EQ(QUIC_NO_ERROR,
+              buffer.OnStreamData(offset, chunk, QuicTime::Zero(), &written,
+                                  &error_details));
+    offset += 2 * kFullPayloadSize;
+    size_t read = 0;
+    ASSERT_EQ(QUIC_NO_ERROR, buffer.Readv(&dest, 1, &read, &error_details));
+  }
+  timer.Report(kBenchmarkIterations);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
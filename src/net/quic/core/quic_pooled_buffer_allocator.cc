@@ -0,0 +1,130 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_pooled_buffer_allocator.h"
+
+#include <limits>
+
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+namespace {
+
+// Size classes are chosen around the allocations QuicPacketCreator and the
+// stream send path actually make: small control frames, mid-sized stream
+// data slices, and full-MTU packet buffers (1350 for the common QUIC
+// payload size, 1500 for a full ethernet frame). 8192 covers the receive
+// side's QuicStreamSequencerBuffer blocks.
+const size_t kSizeClasses[] = {128, 512, 1350, 1500, 4096, 8192};
+const uint32_t kNumSizeClasses = arraysize(kSizeClasses);
+
+// Marks a block which was allocated directly from the heap because it was
+// larger than the biggest size class.
+const uint32_t kHeapBacked = 0xffffffff;
+
+// Number of blocks added to a free list per refill.
+const size_t kBlocksPerSlab = 16;
+
+// Returns the smallest size class index fitting |size|, or kNumSizeClasses
+// if the request is too large to pool.
+uint32_t SizeClassFor(size_t size) {
+  for (uint32_t i = 0; i < kNumSizeClasses; ++i) {
+    if (size <= kSizeClasses[i]) {
+      return i;
+    }
+  }
+  return kNumSizeClasses;
+}
+
+}  // namespace
+
+QuicPooledBufferAllocator::QuicPooledBufferAllocator()
+    : free_lists_(kNumSizeClasses, nullptr),
+      bytes_reserved_(0),
+      bytes_in_use_(0),
+      num_allocations_(0) {}
+
+QuicPooledBufferAllocator::~QuicPooledBufferAllocator() {
+  for (char* slab : slabs_) {
+    delete[] slab;
+  }
+}
+
+char* QuicPooledBufferAllocator::New(size_t size) {
+  ++num_allocations_;
+  uint32_t size_class = SizeClassFor(size);
+  if (size_class == kNumSizeClasses) {
+    DCHECK_LE(size, std::numeric_limits<uint32_t>::max());
+    char* block = new char[sizeof(BlockHeader) + size];
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(block);
+    header->size_class = kHeapBacked;
+    header->heap_size = size;
+    bytes_reserved_ += size;
+    bytes_in_use_ += size;
+    return block + sizeof(BlockHeader);
+  }
+
+  if (free_lists_[size_class] == nullptr) {
+    Refill(size_class);
+  }
+  FreeBlock* free_block = free_lists_[size_class];
+  free_lists_[size_class] = free_block->next;
+
+  char* payload = reinterpret_cast<char*>(free_block);
+  reinterpret_cast<BlockHeader*>(payload - sizeof(BlockHeader))->size_class =
+      size_class;
+  bytes_in_use_ += kSizeClasses[size_class];
+  return payload;
+}
+
+char* QuicPooledBufferAllocator::New(size_t size, bool /* flag_enable */) {
+  return New(size);
+}
+
+void QuicPooledBufferAllocator::Delete(char* buffer) {
+  if (buffer == nullptr) {
+    return;
+  }
+  BlockHeader* header =
+      reinterpret_cast<BlockHeader*>(buffer - sizeof(BlockHeader));
+  if (header->size_class == kHeapBacked) {
+    bytes_reserved_ -= header->heap_size;
+    bytes_in_use_ -= header->heap_size;
+    delete[] reinterpret_cast<char*>(header);
+    return;
+  }
+  DCHECK_LT(header->size_class, kNumSizeClasses);
+  bytes_in_use_ -= kSizeClasses[header->size_class];
+  FreeBlock* free_block = reinterpret_cast<FreeBlock*>(buffer);
+  free_block->next = free_lists_[header->size_class];
+  free_lists_[header->size_class] = free_block;
+}
+
+size_t QuicPooledBufferAllocator::BytesReserved() const {
+  return bytes_reserved_;
+}
+
+size_t QuicPooledBufferAllocator::BytesInUse() const {
+  return bytes_in_use_;
+}
+
+uint64_t QuicPooledBufferAllocator::NumAllocations() const {
+  return num_allocations_;
+}
+
+void QuicPooledBufferAllocator::Refill(uint32_t size_class) {
+  const size_t block_size = sizeof(BlockHeader) + kSizeClasses[size_class];
+  char* slab = new char[block_size * kBlocksPerSlab];
+  slabs_.push_back(slab);
+  bytes_reserved_ += kSizeClasses[size_class] * kBlocksPerSlab;
+  for (size_t i = 0; i < kBlocksPerSlab; ++i) {
+    char* payload = slab + i * block_size + sizeof(BlockHeader);
+    FreeBlock* free_block = reinterpret_cast<FreeBlock*>(payload);
+    free_block->next = free_lists_[size_class];
+    free_lists_[size_class] = free_block;
+  }
+}
+
+}  // namespace net
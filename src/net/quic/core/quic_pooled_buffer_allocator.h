@@ -0,0 +1,83 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_POOLED_BUFFER_ALLOCATOR_H_
+#define NET_QUIC_CORE_QUIC_POOLED_BUFFER_ALLOCATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/macros.h"
+#include "net/quic/core/quic_buffer_allocator.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// A slab-class buffer allocator for the packet serialization hot path.
+// Requests are rounded up to a small set of size classes chosen around
+// common QUIC packet lengths; each class maintains a free list refilled in
+// bulk from contiguous slabs, so steady-state New/Delete never touch the
+// global heap. Requests larger than the biggest class fall back to
+// operator new.
+//
+// Instances are not thread-safe. The server creates one allocator per
+// dispatcher thread (via its QuicConnectionHelperInterface), which makes
+// the free lists effectively thread-local.
+class QUIC_EXPORT_PRIVATE QuicPooledBufferAllocator
+    : public QuicBufferAllocator {
+ public:
+  QuicPooledBufferAllocator();
+  ~QuicPooledBufferAllocator() override;
+
+  // QuicBufferAllocator
+  char* New(size_t size) override;
+  char* New(size_t size, bool flag_enable) override;
+  void Delete(char* buffer) override;
+  size_t BytesReserved() const override;
+  size_t BytesInUse() const override;
+  uint64_t NumAllocations() const override;
+
+ private:
+  // Prefixed to every block handed out; records which free list the block
+  // belongs on (or that it came from the heap).
+  struct BlockHeader {
+    uint32_t size_class;
+    // The payload size of a heap-backed block; unused for pooled blocks.
+    // Also pads the payload out to 8-byte alignment.
+    uint32_t heap_size;
+  };
+
+  // Singly-linked free list node, stored in the block's payload while the
+  // block is free.
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  // Allocates one contiguous slab of blocks for |size_class| and pushes
+  // them all onto the class's free list.
+  void Refill(uint32_t size_class);
+
+  // One free list head per size class.
+  std::vector<FreeBlock*> free_lists_;
+
+  // Payload bytes of all blocks backed by slabs or the heap, free or not.
+  size_t bytes_reserved_;
+
+  // Payload bytes currently handed out.
+  size_t bytes_in_use_;
+
+  // Buffers handed out over the allocator's lifetime, pooled or heap-backed.
+  uint64_t num_allocations_;
+
+  // Every slab ever allocated, freed on destruction.
+  std::vector<char*> slabs_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicPooledBufferAllocator);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_POOLED_BUFFER_ALLOCATOR_H_
@@ -0,0 +1,102 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_pooled_buffer_allocator.h"
+
+#include <cstring>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace {
+
+TEST(QuicPooledBufferAllocatorTest, NewDeleteRoundTrip) {
+  QuicPooledBufferAllocator allocator;
+  char* buffer = allocator.New(1350);
+  ASSERT_NE(nullptr, buffer);
+  memset(buffer, 0xab, 1350);
+  allocator.Delete(buffer);
+}
+
+TEST(QuicPooledBufferAllocatorTest, PooledBlockIsReused) {
+  QuicPooledBufferAllocator allocator;
+  char* buffer = allocator.New(1350);
+  allocator.Delete(buffer);
+  // The freed block sits at the head of its class's free list.
+  EXPECT_EQ(buffer, allocator.New(1350));
+  allocator.Delete(buffer);
+}
+
+TEST(QuicPooledBufferAllocatorTest, DistinctClassesDoNotShareBlocks) {
+  QuicPooledBufferAllocator allocator;
+  char* small = allocator.New(100);
+  allocator.Delete(small);
+  // A full-MTU request must not be satisfied from the small class.
+  char* large = allocator.New(1500);
+  EXPECT_NE(small, large);
+  memset(large, 0xcd, 1500);
+  allocator.Delete(large);
+}
+
+TEST(QuicPooledBufferAllocatorTest, OversizedRequestsFallBackToHeap) {
+  QuicPooledBufferAllocator allocator;
+  char* buffer = allocator.New(128 * 1024);
+  ASSERT_NE(nullptr, buffer);
+  memset(buffer, 0xef, 128 * 1024);
+  allocator.Delete(buffer);
+}
+
+TEST(QuicPooledBufferAllocatorTest, OccupancyTracksPooledBlocks) {
+  QuicPooledBufferAllocator allocator;
+  EXPECT_EQ(0u, allocator.BytesReserved());
+  EXPECT_EQ(0u, allocator.BytesInUse());
+
+  // A pooled request reserves a whole slab but only the rounded-up block is
+  // in use; freeing it returns it to the pool without shrinking the reserve.
+  char* buffer = allocator.New(1350);
+  EXPECT_GE(allocator.BytesReserved(), allocator.BytesInUse());
+  EXPECT_EQ(1350u, allocator.BytesInUse());
+  const size_t reserved = allocator.BytesReserved();
+  allocator.Delete(buffer);
+  EXPECT_EQ(0u, allocator.BytesInUse());
+  EXPECT_EQ(reserved, allocator.BytesReserved());
+}
+
+TEST(QuicPooledBufferAllocatorTest, OccupancyTracksHeapBackedBlocks) {
+  QuicPooledBufferAllocator allocator;
+  char* buffer = allocator.New(128 * 1024);
+  EXPECT_EQ(128u * 1024u, allocator.BytesInUse());
+  EXPECT_EQ(128u * 1024u, allocator.BytesReserved());
+  allocator.Delete(buffer);
+  EXPECT_EQ(0u, allocator.BytesInUse());
+  EXPECT_EQ(0u, allocator.BytesReserved());
+}
+
+TEST(QuicPooledBufferAllocatorTest, NumAllocationsIsMonotonic) {
+  QuicPooledBufferAllocator allocator;
+  EXPECT_EQ(0u, allocator.NumAllocations());
+  char* pooled = allocator.New(1350);
+  EXPECT_EQ(1u, allocator.NumAllocations());
+  char* heap_backed = allocator.New(128 * 1024);
+  EXPECT_EQ(2u, allocator.NumAllocations());
+  // Frees do not decrement; the counter is a lifetime total that callers
+  // difference to attribute allocations to a window of work.
+  allocator.Delete(pooled);
+  allocator.Delete(heap_backed);
+  EXPECT_EQ(2u, allocator.NumAllocations());
+}
+
+TEST(QuicPooledBufferAllocatorTest, ManyAllocationsAcrossRefills) {
+  QuicPooledBufferAllocator allocator;
+  std::vector<char*> buffers;
+  for (int i = 0; i < 100; ++i) {
+    buffers.push_back(allocator.New(1500));
+  }
+  for (char* buffer : buffers) {
+    allocator.Delete(buffer);
+  }
+}
+
+}  // namespace
+}  // namespace net
@@ -21,6 +21,18 @@ namespace {
 // Set to the number of nacks needed for fast retransmit plus one for protection
 // against an ack loss
 const size_t kMaxPacketsAfterNewMissing = 4;
+
+// Length of the interval over which the receive rate is measured.  Short
+// enough to react to rate changes within a few round trips on fast paths,
+// long enough to collect a meaningful number of packets.
+const QuicTime::Delta kReceiveRateInterval =
+    QuicTime::Delta::FromMilliseconds(100);
+
+// The maximum number of receipt timestamps collected between acks.  On the
+// wire each timestamp costs 3 bytes after delta encoding, so this bounds the
+// timestamp portion of an ack frame to roughly 300 bytes while still covering
+// every packet a decimated ack is likely to report.
+const size_t kMaxReceivedPacketTimes = 100;
 }
 
 QuicReceivedPacketManager::QuicReceivedPacketManager(QuicConnectionStats* stats)
@@ -28,6 +40,12 @@ QuicReceivedPacketManager::QuicReceivedPacketManager(QuicConnectionStats* stats)
       ack_frame_updated_(false),
       max_ack_ranges_(0),
       time_largest_observed_(QuicTime::Zero()),
+      received_packet_times_ring_head_(0),
+      receive_rate_interval_start_(QuicTime::Zero()),
+      packets_in_receive_interval_(0),
+      receive_rate_packets_per_second_(0),
+      quiescent_(false),
+      least_received_before_quiescence_(0),
       stats_(stats) {
   ack_frame_.largest_observed = 0;
 }
@@ -37,10 +55,14 @@ QuicReceivedPacketManager::~QuicReceivedPacketManager() {}
 void QuicReceivedPacketManager::RecordPacketReceived(
     const QuicPacketHeader& header,
     QuicTime receipt_time) {
+  if (quiescent_) {
+    InflateFromQuiescentState();
+  }
   QuicPacketNumber packet_number = header.packet_number;
   DCHECK(IsAwaitingPacket(packet_number)) << " packet_number:" << packet_number;
   if (!ack_frame_updated_) {
-    ack_frame_.received_packet_times.clear();
+    received_packet_times_ring_.clear();
+    received_packet_times_ring_head_ = 0;
   }
   ack_frame_updated_ = true;
   ack_frame_.packets.Add(header.packet_number);
@@ -61,24 +83,62 @@ void QuicReceivedPacketManager::RecordPacketReceived(
     time_largest_observed_ = receipt_time;
   }
 
-  ack_frame_.received_packet_times.push_back(
-      std::make_pair(packet_number, receipt_time));
+  if (received_packet_times_ring_.size() < kMaxReceivedPacketTimes) {
+    received_packet_times_ring_.push_back(
+        std::make_pair(packet_number, receipt_time));
+  } else {
+    // The ring is full; overwrite the oldest timestamp.
+    received_packet_times_ring_[received_packet_times_ring_head_] =
+        std::make_pair(packet_number, receipt_time);
+    received_packet_times_ring_head_ =
+        (received_packet_times_ring_head_ + 1) % kMaxReceivedPacketTimes;
+  }
+
+  // Update the receive rate estimate.  The arriving packet is counted towards
+  // the new interval when it completes the current one.
+  if (receive_rate_interval_start_ == QuicTime::Zero()) {
+    receive_rate_interval_start_ = receipt_time;
+  }
+  const QuicTime::Delta interval = receipt_time - receive_rate_interval_start_;
+  if (interval >= kReceiveRateInterval) {
+    receive_rate_packets_per_second_ = packets_in_receive_interval_ *
+                                       kNumMicrosPerSecond /
+                                       interval.ToMicroseconds();
+    receive_rate_interval_start_ = receipt_time;
+    packets_in_receive_interval_ = 0;
+  }
+  ++packets_in_receive_interval_;
+}
+
+void QuicReceivedPacketManager::RecordCeMarkedPacket() {
+  ++ack_frame_.ecn_ce_count;
+  ack_frame_updated_ = true;
 }
 
 bool QuicReceivedPacketManager::IsMissing(QuicPacketNumber packet_number) {
+  if (quiescent_) {
+    InflateFromQuiescentState();
+  }
   return packet_number < ack_frame_.largest_observed &&
          !ack_frame_.packets.Contains(packet_number);
 }
 
 bool QuicReceivedPacketManager::IsAwaitingPacket(
     QuicPacketNumber packet_number) {
+  if (quiescent_) {
+    InflateFromQuiescentState();
+  }
   return net::IsAwaitingPacket(ack_frame_, packet_number,
                                peer_least_packet_awaiting_ack_);
 }
 
 const QuicFrame QuicReceivedPacketManager::GetUpdatedAckFrame(
     QuicTime approximate_now) {
+  if (quiescent_) {
+    InflateFromQuiescentState();
+  }
   ack_frame_updated_ = false;
+  ++stats_->acks_sent;
   if (time_largest_observed_ == QuicTime::Zero()) {
     // We have received no packets.
     ack_frame_.ack_delay_time = QuicTime::Delta::Infinite();
@@ -93,15 +153,18 @@ const QuicFrame QuicReceivedPacketManager::GetUpdatedAckFrame(
     ack_frame_.packets.RemoveSmallestInterval();
   }
 
-  // Clear all packet times if any are too far from largest observed.
-  // It's expected this is extremely rare.
-  for (PacketTimeVector::iterator it = ack_frame_.received_packet_times.begin();
-       it != ack_frame_.received_packet_times.end();) {
-    if (ack_frame_.largest_observed - it->first >=
+  // Materialize the timestamp ring into the frame in arrival order, skipping
+  // any packet too far from largest observed for the wire encoding.  It's
+  // expected the latter is extremely rare.
+  ack_frame_.received_packet_times.clear();
+  ack_frame_.received_packet_times.reserve(received_packet_times_ring_.size());
+  for (size_t i = 0; i < received_packet_times_ring_.size(); ++i) {
+    const std::pair<QuicPacketNumber, QuicTime>& packet_time =
+        received_packet_times_ring_[(received_packet_times_ring_head_ + i) %
+                                    received_packet_times_ring_.size()];
+    if (ack_frame_.largest_observed - packet_time.first <
         std::numeric_limits<uint8_t>::max()) {
-      it = ack_frame_.received_packet_times.erase(it);
-    } else {
-      ++it;
+      ack_frame_.received_packet_times.push_back(packet_time);
     }
   }
 
@@ -110,6 +173,9 @@ const QuicFrame QuicReceivedPacketManager::GetUpdatedAckFrame(
 
 void QuicReceivedPacketManager::DontWaitForPacketsBefore(
     QuicPacketNumber least_unacked) {
+  if (quiescent_) {
+    InflateFromQuiescentState();
+  }
   // ValidateAck() should fail if peer_least_packet_awaiting_ack shrinks.
   DCHECK_LE(peer_least_packet_awaiting_ack_, least_unacked);
   if (least_unacked > peer_least_packet_awaiting_ack_) {
@@ -125,6 +191,40 @@ void QuicReceivedPacketManager::DontWaitForPacketsBefore(
          ack_frame_.packets.Min() >= peer_least_packet_awaiting_ack_);
 }
 
+bool QuicReceivedPacketManager::CollapseToQuiescentState() {
+  if (quiescent_) {
+    return true;
+  }
+  if (ack_frame_updated_) {
+    // An ack is pending; collapsing now would lose what it has to report.
+    return false;
+  }
+  if (ack_frame_.packets.NumIntervals() > 1) {
+    // Missing packets below largest observed cannot be represented by a
+    // single watermark, so keep the full interval set.
+    return false;
+  }
+  quiescent_ = true;
+  least_received_before_quiescence_ =
+      ack_frame_.packets.Empty() ? 0 : ack_frame_.packets.Min();
+  // Replace the containers outright rather than clearing them: clear() keeps
+  // the heap capacity, which is exactly the memory this is meant to release.
+  ack_frame_.packets = PacketNumberQueue();
+  PacketTimeVector().swap(ack_frame_.received_packet_times);
+  PacketTimeVector().swap(received_packet_times_ring_);
+  received_packet_times_ring_head_ = 0;
+  return true;
+}
+
+void QuicReceivedPacketManager::InflateFromQuiescentState() {
+  DCHECK(quiescent_);
+  quiescent_ = false;
+  if (least_received_before_quiescence_ != 0) {
+    ack_frame_.packets.AddRange(least_received_before_quiescence_,
+                                ack_frame_.largest_observed + 1);
+  }
+}
+
 bool QuicReceivedPacketManager::HasMissingPackets() const {
   return ack_frame_.packets.NumIntervals() > 1 ||
          (!ack_frame_.packets.Empty() &&
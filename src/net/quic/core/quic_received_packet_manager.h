@@ -31,6 +31,10 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   virtual void RecordPacketReceived(const QuicPacketHeader& header,
                                     QuicTime receipt_time);
 
+  // Records that a packet with the CE (congestion experienced) ECN codepoint
+  // was received, so the count is reported in subsequent ack frames.
+  virtual void RecordCeMarkedPacket();
+
   // Checks whether |packet_number| is missing and less than largest observed.
   virtual bool IsMissing(QuicPacketNumber packet_number);
 
@@ -47,6 +51,18 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   // received after this call.
   void DontWaitForPacketsBefore(QuicPacketNumber least_unacked);
 
+  // Collapses received-packet tracking to a compact watermark while the
+  // connection is quiescent, releasing the heap storage the ack machinery
+  // otherwise pins for the connection's lifetime.  The collapse is lossless:
+  // state is re-inflated transparently before the next operation that needs
+  // it.  Returns false, changing nothing, if the state cannot currently be
+  // represented by a watermark: an ack is pending, or packets are missing
+  // below largest observed.  Safe to call repeatedly from an idle sweep.
+  bool CollapseToQuiescentState();
+
+  // Returns true while tracking state is collapsed to the watermark.
+  bool quiescent() const { return quiescent_; }
+
   // Returns true if there are any missing packets.
   bool HasMissingPackets() const;
 
@@ -58,6 +74,13 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
     return peer_least_packet_awaiting_ack_;
   }
 
+  // Returns an estimate of the current receive rate in packets per second,
+  // measured over fixed intervals of packet arrival times.  Returns zero until
+  // the first interval has elapsed.
+  QuicPacketCount receive_rate_packets_per_second() const {
+    return receive_rate_packets_per_second_;
+  }
+
   virtual bool ack_frame_updated() const;
 
   QuicPacketNumber GetLargestObserved() const;
@@ -72,6 +95,11 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
  private:
   friend class test::QuicConnectionPeer;
 
+  // Rebuilds |ack_frame_.packets| from the watermarks recorded by
+  // CollapseToQuiescentState.  Must be called before any operation that
+  // consults the packet set while |quiescent_| is true.
+  void InflateFromQuiescentState();
+
   // Least packet number of the the packet sent by the peer for which it
   // hasn't received an ack.
   QuicPacketNumber peer_least_packet_awaiting_ack_;
@@ -79,6 +107,15 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   // Received packet information used to produce acks.
   QuicAckFrame ack_frame_;
 
+  // Receipt timestamps awaiting the next outgoing ack frame, collected in a
+  // fixed-size ring so that the set stays bounded no matter how many packets
+  // arrive between acks: once full, the oldest entry is overwritten.  The
+  // ring is materialized into |ack_frame_| by GetUpdatedAckFrame, where the
+  // framer delta-encodes the timestamps on the wire.
+  PacketTimeVector received_packet_times_ring_;
+  // Index of the oldest entry once |received_packet_times_ring_| is full.
+  size_t received_packet_times_ring_head_;
+
   // True if |ack_frame_| has been updated since UpdateReceivedPacketInfo was
   // last called.
   bool ack_frame_updated_;
@@ -91,6 +128,22 @@ class QUIC_EXPORT_PRIVATE QuicReceivedPacketManager {
   // Needed for calculating ack_delay_time.
   QuicTime time_largest_observed_;
 
+  // Start of the current receive rate measurement interval, or zero if no
+  // packet has been received yet.
+  QuicTime receive_rate_interval_start_;
+  // Number of packets received in the current measurement interval.
+  QuicPacketCount packets_in_receive_interval_;
+  // Receive rate measured over the most recent complete interval.
+  QuicPacketCount receive_rate_packets_per_second_;
+
+  // True while tracking state is collapsed to a watermark.  The received
+  // range is then [|least_received_before_quiescence_|,
+  // |ack_frame_.largest_observed|] and |ack_frame_.packets| is empty.
+  bool quiescent_;
+  // Smallest tracked packet number at the time of the collapse, or zero if
+  // no packets were tracked.
+  QuicPacketNumber least_received_before_quiescence_;
+
   QuicConnectionStats* stats_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicReceivedPacketManager);
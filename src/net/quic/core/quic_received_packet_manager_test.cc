@@ -140,6 +140,105 @@ TEST_P(QuicReceivedPacketManagerTest, LimitAckRanges) {
   }
 }
 
+TEST_P(QuicReceivedPacketManagerTest, RecordCeMarkedPacket) {
+  RecordPacketReceipt(1);
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_EQ(0u, received_manager_.ack_frame().ecn_ce_count);
+
+  RecordPacketReceipt(2);
+  received_manager_.RecordCeMarkedPacket();
+  EXPECT_TRUE(received_manager_.ack_frame_updated());
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_EQ(1u, received_manager_.ack_frame().ecn_ce_count);
+
+  // The count is cumulative over the connection's lifetime.
+  RecordPacketReceipt(3);
+  received_manager_.RecordCeMarkedPacket();
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_EQ(2u, received_manager_.ack_frame().ecn_ce_count);
+}
+
+TEST_P(QuicReceivedPacketManagerTest, BoundedReceivedPacketTimes) {
+  // Receive many more packets than fit in an ack frame's timestamp list.
+  for (QuicPacketNumber i = 1; i <= 150; ++i) {
+    RecordPacketReceipt(
+        i, QuicTime::Zero() + i * QuicTime::Delta::FromMicroseconds(10));
+  }
+  QuicFrame ack = received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  // Only the most recent timestamps are kept, in arrival order.
+  ASSERT_EQ(100u, ack.ack_frame->received_packet_times.size());
+  EXPECT_EQ(51u, ack.ack_frame->received_packet_times.front().first);
+  EXPECT_EQ(150u, ack.ack_frame->received_packet_times.back().first);
+}
+
+TEST_P(QuicReceivedPacketManagerTest, ReceiveRateEstimate) {
+  // No estimate until the first measurement interval has elapsed.
+  EXPECT_EQ(0u, received_manager_.receive_rate_packets_per_second());
+  RecordPacketReceipt(1, QuicTime::Zero());
+  EXPECT_EQ(0u, received_manager_.receive_rate_packets_per_second());
+
+  // Receive a packet every 10ms.  The 100ms measurement interval completes
+  // with the arrival of packet 11, yielding 100 packets per second.
+  for (QuicPacketNumber i = 2; i <= 11; ++i) {
+    RecordPacketReceipt(
+        i, QuicTime::Zero() + (i - 1) * QuicTime::Delta::FromMilliseconds(10));
+  }
+  EXPECT_EQ(100u, received_manager_.receive_rate_packets_per_second());
+
+  // Speed up to a packet every millisecond; once the next interval completes,
+  // the estimate follows.
+  QuicTime start = QuicTime::Zero() + QuicTime::Delta::FromMilliseconds(100);
+  for (QuicPacketNumber i = 12; i <= 112; ++i) {
+    RecordPacketReceipt(
+        i, start + (i - 11) * QuicTime::Delta::FromMilliseconds(1));
+  }
+  EXPECT_EQ(1000u, received_manager_.receive_rate_packets_per_second());
+}
+
+TEST_P(QuicReceivedPacketManagerTest, CollapseToQuiescentState) {
+  RecordPacketReceipt(1);
+  RecordPacketReceipt(2);
+  // A pending ack blocks the collapse.
+  EXPECT_TRUE(received_manager_.ack_frame_updated());
+  EXPECT_FALSE(received_manager_.CollapseToQuiescentState());
+  EXPECT_FALSE(received_manager_.quiescent());
+
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_TRUE(received_manager_.CollapseToQuiescentState());
+  EXPECT_TRUE(received_manager_.quiescent());
+  // Collapsing is idempotent, and the watermark survives.
+  EXPECT_TRUE(received_manager_.CollapseToQuiescentState());
+  EXPECT_EQ(2u, received_manager_.GetLargestObserved());
+
+  // The next packet re-inflates tracking transparently.
+  RecordPacketReceipt(4);
+  EXPECT_FALSE(received_manager_.quiescent());
+  EXPECT_TRUE(received_manager_.IsMissing(3u));
+  EXPECT_FALSE(received_manager_.IsAwaitingPacket(2u));
+  EXPECT_TRUE(received_manager_.IsAwaitingPacket(3u));
+
+  // With a gap below largest observed the state cannot be represented by a
+  // watermark, so the collapse is refused.
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_FALSE(received_manager_.CollapseToQuiescentState());
+
+  // Once the gap is filled and acked, the collapse succeeds again.
+  RecordPacketReceipt(3);
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_TRUE(received_manager_.CollapseToQuiescentState());
+  EXPECT_TRUE(received_manager_.quiescent());
+}
+
+TEST_P(QuicReceivedPacketManagerTest, AcksSentStat) {
+  EXPECT_EQ(0u, stats_.acks_sent);
+  RecordPacketReceipt(1);
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_EQ(1u, stats_.acks_sent);
+  RecordPacketReceipt(2);
+  received_manager_.GetUpdatedAckFrame(QuicTime::Zero());
+  EXPECT_EQ(2u, stats_.acks_sent);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
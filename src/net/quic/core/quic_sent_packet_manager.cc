@@ -43,6 +43,11 @@ static const int64_t kConservativeMinHandshakeTimeoutMs = kMaxDelayedAckTimeMs;
 // per draft RFC draft-dukkipati-tcpm-tcp-loss-probe.
 static const size_t kDefaultMaxTailLossProbes = 2;
 
+// Maximum number of network paths whose congestion state is retained for
+// restoration after migration.  A connection rarely sees more than a couple
+// of paths over its lifetime.
+static const size_t kMaxPathCongestionCacheSize = 5;
+
 bool HasCryptoHandshake(const QuicTransmissionInfo& transmission_info) {
   DCHECK(!transmission_info.has_crypto_handshake ||
          !transmission_info.retransmittable_frames.empty());
@@ -54,6 +59,13 @@ bool HasCryptoHandshake(const QuicTransmissionInfo& transmission_info) {
 #define ENDPOINT \
   (perspective_ == Perspective::IS_SERVER ? "Server: " : "Client: ")
 
+QuicRetransmissionProfile::QuicRetransmissionProfile()
+    : tlp_srtt_multiplier(2.0),
+      min_tlp_timeout_ms(kMinTailLossProbeTimeoutMs),
+      min_rto_timeout_ms(kMinRetransmissionTimeMs),
+      max_rto_timeout_ms(kMaxRetransmissionTimeMs),
+      max_tail_loss_probes(kDefaultMaxTailLossProbes) {}
+
 QuicSentPacketManager::QuicSentPacketManager(
     Perspective perspective,
     const QuicClock* clock,
@@ -82,10 +94,12 @@ QuicSentPacketManager::QuicSentPacketManager(
       use_new_rto_(false),
       undo_pending_retransmits_(false),
       conservative_handshake_retransmits_(false),
+      last_local_drop_time_(QuicTime::Zero()),
       largest_newly_acked_(0),
       largest_mtu_acked_(0),
       handshake_confirmed_(false),
-      largest_packet_peer_knows_is_acked_(0) {
+      largest_packet_peer_knows_is_acked_(0),
+      peer_ecn_ce_count_(0) {
   SetSendAlgorithm(congestion_control_type);
 }
 
@@ -133,6 +147,26 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
   if (config.HasClientSentConnectionOption(kNCON, perspective_)) {
     n_connection_simulation_ = true;
   }
+  // Named retransmission profiles, applied before the individual overrides
+  // below so explicit options still win.
+  if (config.HasClientSentConnectionOption(kRPAG, perspective_)) {
+    // Latency-sensitive RPC workloads: probe at one smoothed RTT with a low
+    // floor and allow an extra probe before backing off to RTO.
+    retransmission_profile_.tlp_srtt_multiplier = 1.0;
+    retransmission_profile_.min_tlp_timeout_ms = 5;
+    retransmission_profile_.min_rto_timeout_ms = 100;
+    retransmission_profile_.max_tail_loss_probes = 3;
+    max_tail_loss_probes_ = retransmission_profile_.max_tail_loss_probes;
+  }
+  if (config.HasClientSentConnectionOption(kRPLZ, perspective_)) {
+    // Bulk transfer workloads: probes buy little, so wait longer and send
+    // fewer of them.
+    retransmission_profile_.tlp_srtt_multiplier = 3.0;
+    retransmission_profile_.min_tlp_timeout_ms = 50;
+    retransmission_profile_.min_rto_timeout_ms = 400;
+    retransmission_profile_.max_tail_loss_probes = 1;
+    max_tail_loss_probes_ = retransmission_profile_.max_tail_loss_probes;
+  }
   if (config.HasClientSentConnectionOption(kNTLP, perspective_)) {
     max_tail_loss_probes_ = 0;
   }
@@ -152,6 +186,9 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
   if (config.HasClientRequestedIndependentOption(kLFAK, perspective_)) {
     general_loss_algorithm_.SetLossDetectionType(kLazyFack);
   }
+  if (config.HasClientRequestedIndependentOption(kANAK, perspective_)) {
+    general_loss_algorithm_.SetLossDetectionType(kAdaptiveNack);
+  }
   if (config.HasClientSentConnectionOption(kUNDO, perspective_)) {
     undo_pending_retransmits_ = true;
   }
@@ -211,11 +248,28 @@ void QuicSentPacketManager::OnIncomingAck(const QuicAckFrame& ack_frame,
   unacked_packets_.IncreaseLargestObserved(ack_frame.largest_observed);
 
   HandleAckForSentPackets(ack_frame);
+  if (!ack_range_listeners_.empty()) {
+    NotifyAckRangeListeners(ack_frame.ack_delay_time);
+  }
   InvokeLossDetection(ack_receive_time);
   // Ignore losses in RTO mode.
   if (consecutive_rto_count_ > 0 && !use_new_rto_) {
     packets_lost_.clear();
   }
+  // Losses detected just after the kernel reported receive-queue overflow are
+  // as likely to be our own socket drops as network loss.  They have already
+  // been marked for retransmission by InvokeLossDetection; keeping them out
+  // of the congestion event stops the sender being punished for local drops.
+  if (ShouldIgnoreLossesForLocalDrops(ack_receive_time)) {
+    packets_lost_.clear();
+  }
+  if (FLAGS_quic_reloadable_flag_quic_ack_ecn_counts &&
+      ack_frame.ecn_ce_count > peer_ecn_ce_count_) {
+    // Deliver new CE marks before the congestion event so the sender can
+    // treat them as a congestion signal for this ack.
+    peer_ecn_ce_count_ = ack_frame.ecn_ce_count;
+    send_algorithm_->OnEcnFeedback(peer_ecn_ce_count_);
+  }
   MaybeInvokeCongestionEvent(rtt_updated, prior_in_flight, ack_receive_time);
   unacked_packets_.RemoveObsoletePackets();
 
@@ -224,6 +278,19 @@ void QuicSentPacketManager::OnIncomingAck(const QuicAckFrame& ack_frame,
       send_algorithm_->BandwidthEstimate(), ack_receive_time, clock_->WallNow(),
       rtt_stats_.smoothed_rtt());
 
+  CongestionTelemetrySample telemetry_sample;
+  telemetry_sample.ack_time_us =
+      (ack_receive_time - QuicTime::Zero()).ToMicroseconds();
+  telemetry_sample.congestion_window = send_algorithm_->GetCongestionWindow();
+  telemetry_sample.pacing_rate_bps =
+      send_algorithm_->PacingRate(unacked_packets_.bytes_in_flight())
+          .ToBitsPerSecond();
+  telemetry_sample.bandwidth_estimate_bps =
+      send_algorithm_->BandwidthEstimate().ToBitsPerSecond();
+  telemetry_sample.min_rtt_us = rtt_stats_.min_rtt().ToMicroseconds();
+  telemetry_sample.packets_lost = stats_->packets_lost;
+  congestion_telemetry_.Record(telemetry_sample);
+
   // Anytime we are making forward progress and have a new RTT estimate, reset
   // the backoff counters.
   if (rtt_updated) {
@@ -292,6 +359,18 @@ void QuicSentPacketManager::MaybeInvokeCongestionEvent(
   if (network_change_visitor_ != nullptr) {
     network_change_visitor_->OnCongestionChange();
   }
+
+  // Republish the congestion summary for a send side polling from another
+  // thread.
+  QuicCongestionSnapshot snapshot;
+  snapshot.congestion_window = send_algorithm_->GetCongestionWindow();
+  snapshot.pacing_rate_bps =
+      send_algorithm_->PacingRate(unacked_packets_.bytes_in_flight())
+          .ToBitsPerSecond();
+  snapshot.bytes_in_flight = unacked_packets_.bytes_in_flight();
+  snapshot.packets_lost = stats_->packets_lost;
+  snapshot.smoothed_rtt_us = rtt_stats_.smoothed_rtt().ToMicroseconds();
+  congestion_snapshot_.Publish(snapshot);
 }
 
 void QuicSentPacketManager::HandleAckForSentPackets(
@@ -301,6 +380,46 @@ void QuicSentPacketManager::HandleAckForSentPackets(
   // Go through the packets we have not received an ack for and see if this
   // incoming_ack shows they've been seen by the peer.
   QuicTime::Delta ack_delay_time = ack_frame.ack_delay_time;
+  if (FLAGS_quic_reloadable_flag_quic_incremental_ack_processing) {
+    QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_incremental_ack_processing, 1,
+                      2);
+    // Walk the acked intervals directly instead of probing every packet
+    // between the least unacked and the largest observed, so packets the
+    // ack still declares missing cost nothing.
+    const QuicPacketNumber least_unacked = unacked_packets_.GetLeastUnacked();
+    for (PacketNumberQueue::const_iterator interval_it =
+             ack_frame.packets.begin();
+         interval_it != ack_frame.packets.end(); ++interval_it) {
+      const QuicPacketNumber interval_end =
+          std::min((*interval_it).max(), ack_frame.largest_observed + 1);
+      for (QuicPacketNumber packet_number =
+               std::max((*interval_it).min(), least_unacked);
+           packet_number < interval_end; ++packet_number) {
+        QuicTransmissionInfo* info =
+            unacked_packets_.GetMutableTransmissionInfo(packet_number);
+        if (info->is_unackable) {
+          // Packets are marked unackable after they've been acked once.
+          continue;
+        }
+        // Packet was acked, so remove it from our unacked packet list.
+        QUIC_DVLOG(1) << ENDPOINT << "Got an ack for packet " << packet_number;
+        if (info->largest_acked > 0) {
+          largest_packet_peer_knows_is_acked_ =
+              std::max(largest_packet_peer_knows_is_acked_, info->largest_acked);
+        }
+        // If data is associated with the most recent transmission of this
+        // packet, then inform the caller.
+        if (info->in_flight) {
+          packets_acked_.push_back(
+              std::make_pair(packet_number, info->bytes_sent));
+        } else {
+          largest_newly_acked_ = packet_number;
+        }
+        MarkPacketHandled(packet_number, info, ack_delay_time);
+      }
+    }
+    return;
+  }
   QuicPacketNumber packet_number = unacked_packets_.GetLeastUnacked();
   for (QuicUnackedPacketMap::iterator it = unacked_packets_.begin();
        it != unacked_packets_.end(); ++it, ++packet_number) {
@@ -334,6 +453,70 @@ void QuicSentPacketManager::HandleAckForSentPackets(
   }
 }
 
+void QuicSentPacketManager::RegisterAckRangeListener(
+    QuicPacketNumber first,
+    QuicPacketNumber last,
+    QuicReferenceCountedPointer<QuicAckRangeListenerInterface> listener) {
+  DCHECK_LE(first, last);
+  if (!ack_range_listeners_.empty()) {
+    AckRangeRegistration& back = ack_range_listeners_.back();
+    if (back.listener.get() == listener.get() && first <= back.last + 1) {
+      // Extend the previous registration instead of adding another entry,
+      // so covering every sent packet costs one registration.
+      back.last = std::max(back.last, last);
+      return;
+    }
+  }
+  AckRangeRegistration registration;
+  registration.first = first;
+  registration.last = last;
+  registration.listener = std::move(listener);
+  ack_range_listeners_.push_back(std::move(registration));
+}
+
+void QuicSentPacketManager::NotifyAckRangeListeners(
+    QuicTime::Delta ack_delay_time) {
+  if (!packets_acked_.empty()) {
+    for (const AckRangeRegistration& registration : ack_range_listeners_) {
+      // |packets_acked_| is ascending, so the intersection with the
+      // registered range decomposes into contiguous runs.
+      QuicPacketNumber run_start = 0;
+      QuicPacketNumber run_end = 0;
+      for (const std::pair<QuicPacketNumber, QuicPacketLength>& acked :
+           packets_acked_) {
+        const QuicPacketNumber packet_number = acked.first;
+        if (packet_number < registration.first ||
+            packet_number > registration.last) {
+          continue;
+        }
+        if (run_start == 0) {
+          run_start = run_end = packet_number;
+        } else if (packet_number == run_end + 1) {
+          run_end = packet_number;
+        } else {
+          registration.listener->OnRangeAcked(run_start, run_end,
+                                              ack_delay_time);
+          run_start = run_end = packet_number;
+        }
+      }
+      if (run_start != 0) {
+        registration.listener->OnRangeAcked(run_start, run_end,
+                                            ack_delay_time);
+      }
+    }
+  }
+
+  // Retire registrations wholly below the least unacked packet: every
+  // packet in them has been acked or will never be.
+  const QuicPacketNumber least_unacked = unacked_packets_.GetLeastUnacked();
+  ack_range_listeners_.erase(
+      std::remove_if(ack_range_listeners_.begin(), ack_range_listeners_.end(),
+                     [least_unacked](const AckRangeRegistration& registration) {
+                       return registration.last < least_unacked;
+                     }),
+      ack_range_listeners_.end());
+}
+
 void QuicSentPacketManager::RetransmitUnackedPackets(
     TransmissionType retransmission_type) {
   DCHECK(retransmission_type == ALL_UNACKED_RETRANSMISSION ||
@@ -391,6 +574,13 @@ void QuicSentPacketManager::RecordOneSpuriousRetransmission(
     const QuicTransmissionInfo& info) {
   stats_->bytes_spuriously_retransmitted += info.bytes_sent;
   ++stats_->packets_spuriously_retransmitted;
+  // Attribute spurious timer-driven retransmissions to the timer that fired
+  // them, so probe policy can be tuned from data.
+  if (info.transmission_type == TLP_RETRANSMISSION) {
+    ++stats_->tlp_spurious_count;
+  } else if (info.transmission_type == RTO_RETRANSMISSION) {
+    ++stats_->rto_spurious_count;
+  }
   if (debug_delegate_ != nullptr) {
     debug_delegate_->OnSpuriousPacketRetransmission(info.transmission_type,
                                                     info.bytes_sent);
@@ -435,6 +625,23 @@ QuicPendingRetransmission QuicSentPacketManager::NextPendingRetransmission() {
         break;
       }
     }
+  } else if (FLAGS_quic_reloadable_flag_quic_priority_ordered_retransmission) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_priority_ordered_retransmission);
+    // Retransmit the packet carrying the most important stream first, so a
+    // loss epoch on a mixed connection recovers interactive data ahead of
+    // bulk data. Ties keep packet-number (i.e. insertion) order because the
+    // map is ordered by packet number.
+    SpdyPriority best_priority =
+        unacked_packets_.GetTransmissionInfo(packet_number).priority;
+    for (const auto& pair : pending_retransmissions_) {
+      const SpdyPriority priority =
+          unacked_packets_.GetTransmissionInfo(pair.first).priority;
+      if (priority < best_priority) {
+        best_priority = priority;
+        packet_number = pair.first;
+        transmission_type = pair.second;
+      }
+    }
   }
   DCHECK(unacked_packets_.IsUnacked(packet_number)) << packet_number;
   const QuicTransmissionInfo& transmission_info =
@@ -473,8 +680,10 @@ void QuicSentPacketManager::MarkPacketHandled(QuicPacketNumber packet_number,
   // transmission, since that's the one only one it tracks.
   if (newest_transmission == packet_number) {
     unacked_packets_.NotifyStreamFramesAcked(*info, ack_delay_time);
-    unacked_packets_.NotifyAndClearListeners(&info->ack_listeners,
-                                             ack_delay_time);
+    if (info->ack_listeners != nullptr) {
+      unacked_packets_.NotifyAndClearListeners(info->ack_listeners,
+                                               ack_delay_time);
+    }
   } else {
     unacked_packets_.NotifyAndClearListeners(newest_transmission,
                                              ack_delay_time);
@@ -567,6 +776,9 @@ void QuicSentPacketManager::OnRetransmissionTimeout() {
       QuicByteCount prior_in_flight = unacked_packets_.bytes_in_flight();
       const QuicTime now = clock_->Now();
       InvokeLossDetection(now);
+      if (ShouldIgnoreLossesForLocalDrops(now)) {
+        packets_lost_.clear();
+      }
       MaybeInvokeCongestionEvent(false, prior_in_flight, now);
       return;
     }
@@ -748,6 +960,38 @@ QuicTime::Delta QuicSentPacketManager::TimeUntilSend(QuicTime now) {
   return delay;
 }
 
+QuicTime QuicSentPacketManager::GetNextReleaseTime() const {
+  if (!using_pacing_ || pending_timer_transmission_count_ > 0) {
+    return QuicTime::Zero();
+  }
+  return pacing_sender_.ideal_next_packet_send_time();
+}
+
+QuicPacketCount QuicSentPacketManager::GetSendBurstSize(QuicTime now) const {
+  if (pending_timer_transmission_count_ > 0) {
+    return pending_timer_transmission_count_;
+  }
+  const QuicByteCount bytes_in_flight = unacked_packets_.bytes_in_flight();
+  QuicPacketCount burst_size = 0;
+  if (using_pacing_) {
+    burst_size = pacing_sender_.BurstAllowance(now, bytes_in_flight);
+  } else if (send_algorithm_->TimeUntilSend(now, bytes_in_flight).IsZero()) {
+    // Without pacing there is no per-packet delay; let the congestion
+    // window bound below and the writer's batch capacity limit the burst.
+    burst_size = kMaxPacketBurstSize;
+  }
+  // Never burst past the congestion window.
+  const QuicByteCount congestion_window =
+      send_algorithm_->GetCongestionWindow();
+  if (congestion_window <= bytes_in_flight) {
+    return burst_size == 0 ? 0 : 1;
+  }
+  const QuicPacketCount window_limit =
+      (congestion_window - bytes_in_flight + kDefaultTCPMSS - 1) /
+      kDefaultTCPMSS;
+  return std::min(burst_size, window_limit);
+}
+
 const QuicTime QuicSentPacketManager::GetRetransmissionTime() const {
   // Don't set the timer if there is nothing to retransmit or we've already
   // queued a tlp transmission and it hasn't been sent yet.
@@ -813,16 +1057,19 @@ const QuicTime::Delta QuicSentPacketManager::GetTailLossProbeDelay() const {
   }
   if (enable_half_rtt_tail_loss_probe_ && consecutive_tlp_count_ == 0u) {
     return QuicTime::Delta::FromMilliseconds(
-        std::max(kMinTailLossProbeTimeoutMs,
+        std::max(retransmission_profile_.min_tlp_timeout_ms,
                  static_cast<int64_t>(0.5 * srtt.ToMilliseconds())));
   }
   if (!unacked_packets_.HasMultipleInFlightPackets()) {
-    return std::max(2 * srtt, 1.5 * srtt + QuicTime::Delta::FromMilliseconds(
-                                               kMinRetransmissionTimeMs / 2));
-  }
-  return QuicTime::Delta::FromMilliseconds(
-      std::max(kMinTailLossProbeTimeoutMs,
-               static_cast<int64_t>(2 * srtt.ToMilliseconds())));
+    return std::max(
+        retransmission_profile_.tlp_srtt_multiplier * srtt,
+        1.5 * srtt + QuicTime::Delta::FromMilliseconds(
+                         retransmission_profile_.min_rto_timeout_ms / 2));
+  }
+  return QuicTime::Delta::FromMilliseconds(std::max(
+      retransmission_profile_.min_tlp_timeout_ms,
+      static_cast<int64_t>(retransmission_profile_.tlp_srtt_multiplier *
+                           srtt.ToMilliseconds())));
 }
 
 const QuicTime::Delta QuicSentPacketManager::GetRetransmissionDelay() const {
@@ -834,9 +1081,10 @@ const QuicTime::Delta QuicSentPacketManager::GetRetransmissionDelay() const {
   } else {
     retransmission_delay =
         rtt_stats_.smoothed_rtt() + 4 * rtt_stats_.mean_deviation();
-    if (retransmission_delay.ToMilliseconds() < kMinRetransmissionTimeMs) {
-      retransmission_delay =
-          QuicTime::Delta::FromMilliseconds(kMinRetransmissionTimeMs);
+    if (retransmission_delay.ToMilliseconds() <
+        retransmission_profile_.min_rto_timeout_ms) {
+      retransmission_delay = QuicTime::Delta::FromMilliseconds(
+          retransmission_profile_.min_rto_timeout_ms);
     }
   }
 
@@ -845,8 +1093,10 @@ const QuicTime::Delta QuicSentPacketManager::GetRetransmissionDelay() const {
       retransmission_delay *
       (1 << std::min<size_t>(consecutive_rto_count_, kMaxRetransmissions));
 
-  if (retransmission_delay.ToMilliseconds() > kMaxRetransmissionTimeMs) {
-    return QuicTime::Delta::FromMilliseconds(kMaxRetransmissionTimeMs);
+  if (retransmission_delay.ToMilliseconds() >
+      retransmission_profile_.max_rto_timeout_ms) {
+    return QuicTime::Delta::FromMilliseconds(
+        retransmission_profile_.max_rto_timeout_ms);
   }
   return retransmission_delay;
 }
@@ -866,6 +1116,16 @@ QuicSentPacketManager::SustainedBandwidthRecorder() const {
   return &sustained_bandwidth_recorder_;
 }
 
+const QuicCongestionTelemetryRing* QuicSentPacketManager::CongestionTelemetry()
+    const {
+  return &congestion_telemetry_;
+}
+
+const QuicCongestionSnapshotSlot* QuicSentPacketManager::CongestionSnapshot()
+    const {
+  return &congestion_snapshot_;
+}
+
 QuicPacketCount QuicSentPacketManager::EstimateMaxPacketsInFlight(
     QuicByteCount max_packet_length) const {
   return send_algorithm_->GetCongestionWindow() / max_packet_length;
@@ -929,6 +1189,59 @@ void QuicSentPacketManager::OnConnectionMigration(PeerAddressChangeType type) {
   send_algorithm_->OnConnectionMigration();
 }
 
+void QuicSentPacketManager::OnLocalSocketOverflow(QuicTime now) {
+  last_local_drop_time_ = now;
+}
+
+bool QuicSentPacketManager::ShouldIgnoreLossesForLocalDrops(
+    QuicTime now) const {
+  if (last_local_drop_time_ == QuicTime::Zero() || packets_lost_.empty()) {
+    return false;
+  }
+  // One smoothed RTT bounds how long acks sent before the overflow can keep
+  // arriving and surfacing losses that the drops themselves caused.
+  QuicTime::Delta window = rtt_stats_.smoothed_rtt();
+  if (window.IsZero()) {
+    window = QuicTime::Delta::FromMicroseconds(rtt_stats_.initial_rtt_us());
+  }
+  return now - last_local_drop_time_ <= window;
+}
+
+void QuicSentPacketManager::RecordPathCongestionState(
+    const std::string& path_key) {
+  const QuicBandwidth bandwidth = BandwidthEstimate();
+  if (bandwidth.IsZero()) {
+    // Nothing useful to retain yet.
+    return;
+  }
+  PathCongestionState state = {bandwidth, rtt_stats_.min_rtt()};
+  auto it = path_congestion_cache_.find(path_key);
+  if (it != path_congestion_cache_.end()) {
+    it->second = state;
+    return;
+  }
+  if (path_congestion_cache_.size() >= kMaxPathCongestionCacheSize) {
+    path_congestion_cache_.erase(path_congestion_cache_.begin());
+  }
+  path_congestion_cache_.insert(std::make_pair(path_key, state));
+}
+
+bool QuicSentPacketManager::MaybeRestorePathCongestionState(
+    const std::string& path_key) {
+  auto it = path_congestion_cache_.find(path_key);
+  if (it == path_congestion_cache_.end()) {
+    return false;
+  }
+  // Feed the cached state through the bandwidth resumption path, which
+  // derives a cwnd from bandwidth and rtt and clamps it conservatively.
+  CachedNetworkParameters cached_network_params;
+  cached_network_params.set_bandwidth_estimate_bytes_per_second(
+      it->second.bandwidth_estimate.ToBytesPerSecond());
+  cached_network_params.set_min_rtt_ms(it->second.min_rtt.ToMilliseconds());
+  ResumeConnectionState(cached_network_params, false);
+  return true;
+}
+
 void QuicSentPacketManager::SetDebugDelegate(DebugDelegate* debug_delegate) {
   debug_delegate_ = debug_delegate;
 }
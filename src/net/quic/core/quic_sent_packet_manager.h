@@ -19,6 +19,9 @@
 #include "net/quic/core/congestion_control/pacing_sender.h"
 #include "net/quic/core/congestion_control/rtt_stats.h"
 #include "net/quic/core/congestion_control/send_algorithm_interface.h"
+#include "net/quic/core/quic_ack_listener_interface.h"
+#include "net/quic/core/quic_congestion_snapshot.h"
+#include "net/quic/core/quic_congestion_telemetry_ring.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_pending_retransmission.h"
 #include "net/quic/core/quic_sustained_bandwidth_recorder.h"
@@ -37,6 +40,28 @@ class QuicClock;
 class QuicConfig;
 struct QuicConnectionStats;
 
+// Tunable policy for tail loss probe and retransmission timers.  Probe delays
+// are computed as multiples of smoothed RTT and clamped to the profile's
+// floor and ceiling, so a workload can select its probe aggressiveness per
+// session via connection options (kRPAG, kRPLZ) instead of recompiling the
+// policy constants.
+struct QUIC_EXPORT_PRIVATE QuicRetransmissionProfile {
+  // Initializes the default profile, which mirrors the historical constants.
+  QuicRetransmissionProfile();
+
+  // Multiplier applied to smoothed RTT when computing the TLP delay.
+  double tlp_srtt_multiplier;
+  // Floor for the TLP delay, in milliseconds.
+  int64_t min_tlp_timeout_ms;
+  // Floor for the retransmission (RTO) delay, in milliseconds.
+  int64_t min_rto_timeout_ms;
+  // Ceiling for the retransmission delay after exponential backoff, in
+  // milliseconds.
+  int64_t max_rto_timeout_ms;
+  // Number of tail loss probes sent before falling back to RTO.
+  size_t max_tail_loss_probes;
+};
+
 // Class which tracks the set of packets sent on a QUIC connection and contains
 // a send algorithm to decide when to send new packets.  It keeps track of any
 // retransmittable data associated with each packet. If a packet is
@@ -159,6 +184,18 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // calculations.
   QuicTime::Delta TimeUntilSend(QuicTime now);
 
+  // Returns the number of packets which can be sent back to back right now
+  // without re-consulting the pacer, bounded by the remaining congestion
+  // window. Returns 0 when the next send must wait. The allowance is a
+  // snapshot; it is stale once an ack, loss or timeout is processed.
+  QuicPacketCount GetSendBurstSize(QuicTime now) const;
+
+  // Returns the pacer's ideal send time for the next packet, or
+  // QuicTime::Zero() when pacing is disabled or a timer-driven
+  // (re)transmission is pending and must go out immediately. Used to stamp
+  // packets with a kernel release time when the writer offloads pacing.
+  QuicTime GetNextReleaseTime() const;
+
   // Returns the current delay for the retransmission timer, which may send
   // either a tail loss probe or do a full RTO.  Returns QuicTime::Zero() if
   // there are no retransmittable packets.
@@ -171,6 +208,15 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
 
   const QuicSustainedBandwidthRecorder* SustainedBandwidthRecorder() const;
 
+  // Time series of congestion control state, one sample per processed ack.
+  // Safe to read from a sampler thread while the connection is alive.
+  const QuicCongestionTelemetryRing* CongestionTelemetry() const;
+
+  // Latest (cwnd, pacing rate, losses) summary, republished after every
+  // congestion event. A send side running on another thread reads this
+  // instead of calling into the send algorithm directly.
+  const QuicCongestionSnapshotSlot* CongestionSnapshot() const;
+
   // Returns the size of the current congestion window in number of
   // kDefaultTCPMSS-sized segments. Note, this is not the *available* window.
   // Some send algorithms may not use a congestion window and will return 0.
@@ -204,6 +250,34 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // Called when peer address changes and the connection migrates.
   void OnConnectionMigration(PeerAddressChangeType type);
 
+  // Called when the kernel reports that the local socket's receive queue
+  // overflowed at |now|.  Losses detected within roughly one RTT of the
+  // report are still retransmitted but are excluded from loss-based
+  // congestion reactions: they are as likely to be our own socket drops as
+  // network congestion, and reducing the send rate for local drops collapses
+  // throughput on overloaded hosts.
+  void OnLocalSocketOverflow(QuicTime now);
+
+  // Records the current congestion state for |path_key| so it can be restored
+  // if the connection later migrates back to that path.  Only call for paths
+  // which carried acknowledged traffic.
+  void RecordPathCongestionState(const std::string& path_key);
+
+  // If congestion state was previously recorded for |path_key|, restores it
+  // conservatively (bandwidth-derived cwnd and cached rtt, as for bandwidth
+  // resumption) and returns true.  Returns false if the path is unknown.
+  bool MaybeRestorePathCongestionState(const std::string& path_key);
+
+  // Registers |listener| for acks of packets in [first, last] (both
+  // inclusive). A registration adjacent or overlapping the most recent one
+  // for the same listener extends it in place, so a sender covering every
+  // packet keeps a single live registration. Registrations are dropped once
+  // every packet in their range has been acked or abandoned.
+  void RegisterAckRangeListener(
+      QuicPacketNumber first,
+      QuicPacketNumber last,
+      QuicReferenceCountedPointer<QuicAckRangeListenerInterface> listener);
+
   void SetDebugDelegate(DebugDelegate* debug_delegate);
 
   QuicPacketNumber GetLargestObserved() const;
@@ -230,6 +304,12 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
     return largest_packet_peer_knows_is_acked_;
   }
 
+  // The TLP/RTO policy currently in effect, selected via connection options
+  // in SetFromConfig.
+  const QuicRetransmissionProfile& retransmission_profile() const {
+    return retransmission_profile_;
+  }
+
  private:
   friend class test::QuicConnectionPeer;
   friend class test::QuicSentPacketManagerPeer;
@@ -289,6 +369,11 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // necessary.
   void InvokeLossDetection(QuicTime time);
 
+  // Returns true if losses detected at |now| should be kept out of the
+  // congestion event because the local receive queue overflowed within
+  // roughly one RTT of |now|.
+  bool ShouldIgnoreLossesForLocalDrops(QuicTime now) const;
+
   // Invokes OnCongestionEvent if |rtt_updated| is true, there are pending acks,
   // or pending losses.  Clears pending acks and pending losses afterwards.
   // |prior_in_flight| is the number of bytes in flight before the losses or
@@ -299,6 +384,12 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
                                   QuicByteCount prior_in_flight,
                                   QuicTime event_time);
 
+  // Fires registered range listeners for the contiguous runs of newly acked
+  // packets in |packets_acked_|, then drops registrations whose entire range
+  // has been acked or abandoned. Must run before |packets_acked_| is cleared
+  // by MaybeInvokeCongestionEvent.
+  void NotifyAckRangeListeners(QuicTime::Delta ack_delay_time);
+
   // Removes the retransmittability and in flight properties from the packet at
   // |info| due to receipt by the peer.
   void MarkPacketHandled(QuicPacketNumber packet_number,
@@ -376,6 +467,8 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   size_t pending_timer_transmission_count_;
   // Maximum number of tail loss probes to send before firing an RTO.
   size_t max_tail_loss_probes_;
+  // TLP/RTO timing policy, selected per session via connection options.
+  QuicRetransmissionProfile retransmission_profile_;
   // If true, send the TLP at 0.5 RTT.
   bool enable_half_rtt_tail_loss_probe_;
   bool using_pacing_;
@@ -387,12 +480,24 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   bool undo_pending_retransmits_;
   // If true, use a more conservative handshake retransmission policy.
   bool conservative_handshake_retransmits_;
+  // Time of the most recent local receive-queue overflow report, or Zero()
+  // if none has been received.
+  QuicTime last_local_drop_time_;
 
   // Vectors packets acked and lost as a result of the last congestion event.
   SendAlgorithmInterface::CongestionVector packets_acked_;
   SendAlgorithmInterface::CongestionVector packets_lost_;
   // Largest newly acknowledged packet.
   QuicPacketNumber largest_newly_acked_;
+
+  // One registered ack-range listener. Kept in registration order, which is
+  // also ascending by |last| since ranges cover freshly sent packets.
+  struct AckRangeRegistration {
+    QuicPacketNumber first;
+    QuicPacketNumber last;
+    QuicReferenceCountedPointer<QuicAckRangeListenerInterface> listener;
+  };
+  std::vector<AckRangeRegistration> ack_range_listeners_;
   // Largest packet in bytes ever acknowledged.
   QuicPacketLength largest_mtu_acked_;
 
@@ -410,9 +515,33 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // of time with no loss events.
   QuicSustainedBandwidthRecorder sustained_bandwidth_recorder_;
 
+  // Records congestion control state at ack granularity for external
+  // samplers.
+  QuicCongestionTelemetryRing congestion_telemetry_;
+
+  // Latest congestion control summary for the send side, republished after
+  // every congestion event.
+  QuicCongestionSnapshotSlot congestion_snapshot_;
+
   // The largest acked value that was sent in an ack, which has then been acked.
   QuicPacketNumber largest_packet_peer_knows_is_acked_;
 
+  // The largest cumulative count of CE marked packets reported by the peer.
+  // Only changes when FLAGS_quic_reloadable_flag_quic_ack_ecn_counts is on.
+  QuicPacketCount peer_ecn_ce_count_;
+
+  // Congestion state retained for a previously validated network path.
+  struct PathCongestionState {
+    QuicBandwidth bandwidth_estimate;
+    QuicTime::Delta min_rtt;
+  };
+
+  // Maps path keys (self and peer address pairs) to the congestion state
+  // observed on that path, recorded when the connection migrates away from
+  // it.  Bounded; the oldest entry is evicted first.  Only populated when
+  // FLAGS_quic_reloadable_flag_quic_validated_path_cache is on.
+  QuicLinkedHashMap<std::string, PathCongestionState> path_congestion_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicSentPacketManager);
 };
 
@@ -55,6 +55,24 @@ class MockDebugDelegate : public QuicSentPacketManager::DebugDelegate {
                     QuicTime detection_time));
 };
 
+// Records the (start, end) runs delivered to OnRangeAcked.
+class RecordingAckRangeListener : public QuicAckRangeListenerInterface {
+ public:
+  void OnRangeAcked(QuicPacketNumber start,
+                    QuicPacketNumber end,
+                    QuicTime::Delta /*ack_delay_time*/) override {
+    acked_ranges_.push_back(std::make_pair(start, end));
+  }
+
+  const std::vector<std::pair<QuicPacketNumber, QuicPacketNumber>>&
+  acked_ranges() const {
+    return acked_ranges_;
+  }
+
+ private:
+  std::vector<std::pair<QuicPacketNumber, QuicPacketNumber>> acked_ranges_;
+};
+
 class QuicSentPacketManagerTest : public QuicTest {
  protected:
   QuicSentPacketManagerTest()
@@ -306,6 +324,30 @@ TEST_F(QuicSentPacketManagerTest, IsUnAckedRetransmit) {
   VerifyRetransmittablePackets(retransmittable, arraysize(retransmittable));
 }
 
+TEST_F(QuicSentPacketManagerTest, AckRangeListener) {
+  QuicReferenceCountedPointer<RecordingAckRangeListener> listener(
+      new RecordingAckRangeListener());
+  manager_.RegisterAckRangeListener(1, 2, listener);
+  // An adjacent registration for the same listener extends the first.
+  manager_.RegisterAckRangeListener(3, 4, listener);
+
+  for (QuicPacketNumber i = 1; i <= 4; ++i) {
+    SendDataPacket(i);
+  }
+
+  // Ack 1-2 and 4, leaving 3 missing: one call per contiguous run.
+  QuicAckFrame ack_frame = ConstructAckFrame(1, 3, 4, 4);
+  QuicPacketNumber acked[] = {1, 2, 4};
+  ExpectAcksAndLosses(true, acked, arraysize(acked), nullptr, 0);
+  manager_.OnIncomingAck(ack_frame, clock_.Now());
+
+  ASSERT_EQ(2u, listener->acked_ranges().size());
+  EXPECT_EQ(1u, listener->acked_ranges()[0].first);
+  EXPECT_EQ(2u, listener->acked_ranges()[0].second);
+  EXPECT_EQ(4u, listener->acked_ranges()[1].first);
+  EXPECT_EQ(4u, listener->acked_ranges()[1].second);
+}
+
 TEST_F(QuicSentPacketManagerTest, RetransmitThenAck) {
   SendDataPacket(1);
   RetransmitAndSendPacket(1, 2);
@@ -420,6 +462,56 @@ TEST_F(QuicSentPacketManagerTest, RetransmitThenAckPreviousThenNackRetransmit) {
   EXPECT_EQ(QuicTime::Zero(), manager_.GetRetransmissionTime());
 }
 
+TEST_F(QuicSentPacketManagerTest, LocalSocketOverflowSuppressesLossEvents) {
+  SendDataPacket(1);
+  SendDataPacket(2);
+  SendDataPacket(3);
+  SendDataPacket(4);
+  QuicTime::Delta rtt = QuicTime::Delta::FromMilliseconds(15);
+  clock_.AdvanceTime(rtt);
+
+  // NACK packet 1 twice.
+  ExpectAck(2);
+  QuicAckFrame ack_frame = ConstructAckFrame(0, 0, 2, 2);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+  ExpectAck(3);
+  ack_frame = ConstructAckFrame(0, 0, 2, 3);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+
+  // The kernel reports receive-queue overflow before the third NACK declares
+  // packet 1 lost.  The loss is still detected and marked for retransmission,
+  // but the congestion controller sees no lost packets.
+  manager_.OnLocalSocketOverflow(clock_.ApproximateNow());
+  ExpectAck(4);
+  ack_frame = ConstructAckFrame(0, 0, 2, 4);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+  EXPECT_TRUE(manager_.HasPendingRetransmissions());
+  EXPECT_EQ(1u, stats_.packets_lost);
+
+  // Retransmit and ack the suppressed loss, then let more than an RTT pass:
+  // losses reach the congestion controller again.
+  RetransmitAndSendPacket(1, 5, LOSS_RETRANSMISSION);
+  ExpectAck(5);
+  ack_frame = ConstructAckFrame(0, 0, 2, 5);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(100));
+
+  SendDataPacket(6);
+  SendDataPacket(7);
+  SendDataPacket(8);
+  SendDataPacket(9);
+  clock_.AdvanceTime(rtt);
+  ExpectAck(7);
+  ack_frame = ConstructAckFrame(0, 0, 7, 7);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+  ExpectAck(8);
+  ack_frame = ConstructAckFrame(0, 0, 7, 8);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+  ExpectAckAndLoss(true, 9, 6);
+  ack_frame = ConstructAckFrame(0, 0, 7, 9);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+}
+
 TEST_F(QuicSentPacketManagerTest,
        DISABLED_RetransmitTwiceThenAckPreviousBeforeSend) {
   SendDataPacket(1);
@@ -559,6 +651,30 @@ TEST_F(QuicSentPacketManagerTest, AckAckAndUpdateRtt) {
   EXPECT_EQ(3u, manager_.largest_packet_peer_knows_is_acked());
 }
 
+TEST_F(QuicSentPacketManagerTest, IncrementalAckProcessing) {
+  FLAGS_quic_reloadable_flag_quic_incremental_ack_processing = true;
+  for (size_t i = 1; i <= 5; ++i) {
+    SendDataPacket(i);
+  }
+
+  // Ack {1, 2} and {4, 5}, leaving 3 missing.
+  QuicPacketNumber acked[] = {1, 2, 4, 5};
+  ExpectAcksAndLosses(true, acked, arraysize(acked), nullptr, 0);
+  QuicAckFrame ack_frame = ConstructAckFrame(1, 3, 4, 5);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+
+  QuicPacketNumber unacked[] = {3};
+  VerifyUnackedPackets(unacked, arraysize(unacked));
+
+  // A second ack filling the hole only processes the newly acked packet;
+  // the packets acked above were marked unackable by the first ack.
+  QuicPacketNumber acked2[] = {3};
+  ExpectAcksAndLosses(false, acked2, arraysize(acked2), nullptr, 0);
+  ack_frame = InitAckFrame(5);
+  manager_.OnIncomingAck(ack_frame, clock_.ApproximateNow());
+  VerifyUnackedPackets(nullptr, 0);
+}
+
 TEST_F(QuicSentPacketManagerTest, Rtt) {
   QuicPacketNumber packet_number = 1;
   QuicTime::Delta expected_rtt = QuicTime::Delta::FromMilliseconds(15);
@@ -1354,6 +1470,34 @@ TEST_F(QuicSentPacketManagerTest, NegotiateTimeLossDetectionFromOptions) {
                        ->GetLossDetectionType());
 }
 
+TEST_F(QuicSentPacketManagerTest, NegotiateRetransmissionProfileFromOptions) {
+  // Defaults mirror the historical constants.
+  EXPECT_EQ(2.0, manager_.retransmission_profile().tlp_srtt_multiplier);
+  EXPECT_EQ(kMinTailLossProbeTimeoutMs,
+            manager_.retransmission_profile().min_tlp_timeout_ms);
+
+  QuicConfig config;
+  QuicTagVector options;
+  options.push_back(kRPAG);
+  QuicConfigPeer::SetReceivedConnectionOptions(&config, options);
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  manager_.SetFromConfig(config);
+  EXPECT_EQ(1.0, manager_.retransmission_profile().tlp_srtt_multiplier);
+  EXPECT_EQ(5, manager_.retransmission_profile().min_tlp_timeout_ms);
+  EXPECT_EQ(3u, QuicSentPacketManagerPeer::GetMaxTailLossProbes(&manager_));
+
+  options.clear();
+  options.push_back(kRPLZ);
+  QuicConfigPeer::SetReceivedConnectionOptions(&config, options);
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  manager_.SetFromConfig(config);
+  EXPECT_EQ(3.0, manager_.retransmission_profile().tlp_srtt_multiplier);
+  EXPECT_EQ(50, manager_.retransmission_profile().min_tlp_timeout_ms);
+  EXPECT_EQ(1u, QuicSentPacketManagerPeer::GetMaxTailLossProbes(&manager_));
+}
+
 TEST_F(QuicSentPacketManagerTest, NegotiateCongestionControlFromOptions) {
   QuicConfig config;
   QuicTagVector options;
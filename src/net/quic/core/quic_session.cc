@@ -4,11 +4,14 @@
 
 #include "net/quic/core/quic_session.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <utility>
+#include <vector>
 
 #include "net/quic/core/quic_connection.h"
 #include "net/quic/core/quic_flow_controller.h"
+#include "net/quic/core/quic_trace_ring.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
 #include "net/quic/platform/api/quic_flag_utils.h"
 #include "net/quic/platform/api/quic_flags.h"
@@ -20,6 +23,16 @@ using std::string;
 
 namespace net {
 
+namespace {
+
+// The maximum number of closed streams destroyed in one pass of
+// PostProcessAfterData(). Destroying tens of thousands of streams in a single
+// burst (e.g. after a connection-wide close) stalls the event loop; anything
+// beyond this is left for subsequent passes.
+const size_t kMaxClosedStreamsDestroyedPerLoop = 64;
+
+}  // namespace
+
 #define ENDPOINT \
   (perspective() == Perspective::IS_SERVER ? "Server: " : "Client: ")
 
@@ -47,6 +60,7 @@ QuicSession::QuicSession(QuicConnection* connection,
                        nullptr),
       currently_writing_stream_id_(0),
       respect_goaway_(true),
+      batch_stream_operation_in_progress_(false),
       use_stream_notifier_(
           FLAGS_quic_reloadable_flag_quic_use_stream_notifier2),
       save_data_before_consumption_(
@@ -249,6 +263,39 @@ void QuicSession::OnCanWrite() {
 
   QuicConnection::ScopedPacketBundler ack_bundler(
       connection_, QuicConnection::SEND_ACK_IF_QUEUED);
+
+  if (FLAGS_quic_reloadable_flag_quic_batched_write_scheduling) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_batched_write_scheduling);
+    std::vector<QuicStreamId> batch;
+    size_t num_writes_remaining = num_writes;
+    while (num_writes_remaining > 0) {
+      if (!(write_blocked_streams_.HasWriteBlockedCryptoOrHeadersStream() ||
+            write_blocked_streams_.HasWriteBlockedDataStreams())) {
+        // Writing one stream removed another!? Something's broken.
+        QUIC_BUG << "WriteBlockedStream is missing";
+        connection_->CloseConnection(QUIC_INTERNAL_ERROR,
+                                     "WriteBlockedStream is missing",
+                                     ConnectionCloseBehavior::SILENT_CLOSE);
+        return;
+      }
+      batch.clear();
+      write_blocked_streams_.PopFrontBatch(num_writes_remaining, &batch);
+      for (size_t i = 0; i < batch.size(); ++i) {
+        if (!connection_->CanWriteStreamData()) {
+          // Return the unserviced remainder of the batch to the blocked list
+          // before yielding; these streams have not had their turn.
+          for (size_t j = i; j < batch.size(); ++j) {
+            write_blocked_streams_.AddStream(batch[j]);
+          }
+          return;
+        }
+        WriteBlockedStream(batch[i]);
+        --num_writes_remaining;
+      }
+    }
+    return;
+  }
+
   for (size_t i = 0; i < num_writes; ++i) {
     if (!(write_blocked_streams_.HasWriteBlockedCryptoOrHeadersStream() ||
           write_blocked_streams_.HasWriteBlockedDataStreams())) {
@@ -262,23 +309,27 @@ void QuicSession::OnCanWrite() {
     if (!connection_->CanWriteStreamData()) {
       return;
     }
-    currently_writing_stream_id_ = write_blocked_streams_.PopFront();
-    QuicStream* stream = GetOrCreateStream(currently_writing_stream_id_);
-    if (stream != nullptr && !stream->flow_controller()->IsBlocked()) {
-      // If the stream can't write all bytes it'll re-add itself to the blocked
-      // list.
-      uint64_t previous_bytes_written = stream->stream_bytes_written();
-      bool previous_fin_sent = stream->fin_sent();
-      QUIC_DVLOG(1) << "stream " << stream->id() << " bytes_written "
-                    << previous_bytes_written << " fin " << previous_fin_sent;
-      stream->OnCanWrite();
-      DCHECK(CheckStreamNotBusyLooping(stream, previous_bytes_written,
-                                       previous_fin_sent));
-    }
-    currently_writing_stream_id_ = 0;
+    WriteBlockedStream(write_blocked_streams_.PopFront());
   }
 }
 
+void QuicSession::WriteBlockedStream(QuicStreamId stream_id) {
+  currently_writing_stream_id_ = stream_id;
+  QuicStream* stream = GetOrCreateStream(currently_writing_stream_id_);
+  if (stream != nullptr && !stream->flow_controller()->IsBlocked()) {
+    // If the stream can't write all bytes it'll re-add itself to the blocked
+    // list.
+    uint64_t previous_bytes_written = stream->stream_bytes_written();
+    bool previous_fin_sent = stream->fin_sent();
+    QUIC_DVLOG(1) << "stream " << stream->id() << " bytes_written "
+                  << previous_bytes_written << " fin " << previous_fin_sent;
+    stream->OnCanWrite();
+    DCHECK(CheckStreamNotBusyLooping(stream, previous_bytes_written,
+                                     previous_fin_sent));
+  }
+  currently_writing_stream_id_ = 0;
+}
+
 bool QuicSession::WillingAndAbleToWrite() const {
   // If the crypto or headers streams are blocked, we want to schedule a write -
   // they don't get blocked by connection level flow control. Otherwise only
@@ -329,6 +380,10 @@ QuicConsumedData QuicSession::WritevData(
     // up write blocked until OnCanWrite is next called.
     return QuicConsumedData(0, false);
   }
+  // Stamp outgoing packets with this stream's priority so retransmission
+  // scheduling can favor the most important data.
+  connection_->set_current_stream_priority(
+      write_blocked_streams_.GetStreamPriority(id));
   QuicConsumedData data = connection_->SendStreamData(id, iov, offset, state,
                                                       std::move(ack_listener));
   write_blocked_streams_.UpdateBytesForStream(id, data.bytes_consumed);
@@ -416,6 +471,19 @@ void QuicSession::CloseStreamInner(QuicStreamId stream_id, bool locally_reset) {
 
   stream->OnClose();
   // Decrease the number of streams being emulated when a new one is opened.
+  if (!batch_stream_operation_in_progress_) {
+    connection_->SetNumOpenStreams(dynamic_stream_map_.size());
+  }
+}
+
+void QuicSession::CloseStreamBatch(const std::vector<QuicStreamId>& stream_ids) {
+  closed_streams_.reserve(closed_streams_.size() + stream_ids.size());
+  batch_stream_operation_in_progress_ = true;
+  for (QuicStreamId stream_id : stream_ids) {
+    CloseStreamInner(stream_id, /*locally_reset=*/false);
+  }
+  batch_stream_operation_in_progress_ = false;
+  // One emulated-connection-count update covers the whole sweep.
   connection_->SetNumOpenStreams(dynamic_stream_map_.size());
 }
 
@@ -651,7 +719,10 @@ void QuicSession::ActivateStream(std::unique_ptr<QuicStream> stream) {
     ++num_dynamic_incoming_streams_;
   }
   // Increase the number of streams being emulated when a new one is opened.
-  connection_->SetNumOpenStreams(dynamic_stream_map_.size());
+  // Batch operations update the count once at the end of the sweep instead.
+  if (!batch_stream_operation_in_progress_) {
+    connection_->SetNumOpenStreams(dynamic_stream_map_.size());
+  }
 }
 
 QuicStreamId QuicSession::GetNextOutgoingStreamId() {
@@ -836,6 +907,7 @@ void QuicSession::MarkConnectionLevelWriteBlocked(QuicStreamId id) {
   QUIC_BUG_IF(GetOrCreateStream(id) == nullptr) << "Marking unknown stream "
                                                 << id << " blocked.";
 
+  QUIC_TRACE_STREAM_SCHEDULED(id);
   write_blocked_streams_.AddStream(id);
 }
 
@@ -846,7 +918,16 @@ bool QuicSession::HasDataToWrite() const {
 }
 
 void QuicSession::PostProcessAfterData() {
-  closed_streams_.clear();
+  if (closed_streams_.size() <= kMaxClosedStreamsDestroyedPerLoop) {
+    closed_streams_.clear();
+    return;
+  }
+  // Amortize the destruction over several event-loop iterations. The
+  // leftovers are dead objects holding only memory; the next pass (or the
+  // session destructor) gets to them.
+  closed_streams_.erase(
+      closed_streams_.begin(),
+      closed_streams_.begin() + kMaxClosedStreamsDestroyedPerLoop);
 }
 
 void QuicSession::OnAckNeedsRetransmittableFrame() {
@@ -961,6 +1042,34 @@ QuicStream* QuicSession::MaybeCreateOutgoingDynamicStream(
   return CreateAndActivateStream(GetNextOutgoingStreamId());
 }
 
+size_t QuicSession::CreateOutgoingDynamicStreamBatch(
+    size_t count,
+    std::vector<QuicStream*>* streams) {
+  // Mirrors ShouldCreateOutgoingDynamicStream2, which can't be called here
+  // because it is tied to the stream creation refactor flag.
+  if (count == 0 || !connection()->connected() || !IsEncryptionEstablished() ||
+      (goaway_received() && respect_goaway_)) {
+    return 0;
+  }
+  const size_t num_open = GetNumOpenOutgoingStreams();
+  if (num_open >= max_open_outgoing_streams()) {
+    return 0;
+  }
+  // Size the batch from the remaining allowance so the limits are consulted
+  // once instead of per stream.
+  const size_t headroom = max_open_outgoing_streams() - num_open;
+  const size_t num_to_create = std::min(count, headroom);
+  streams->reserve(streams->size() + num_to_create);
+  batch_stream_operation_in_progress_ = true;
+  for (size_t i = 0; i < num_to_create; ++i) {
+    streams->push_back(CreateAndActivateStream(GetNextOutgoingStreamId()));
+  }
+  batch_stream_operation_in_progress_ = false;
+  // One emulated-connection-count update covers the whole sweep.
+  connection_->SetNumOpenStreams(dynamic_stream_map_.size());
+  return num_to_create;
+}
+
 QuicStream* QuicSession::CreateAndActivateStream(QuicStreamId id) {
   std::unique_ptr<QuicStream> stream = CreateStream(id);
   QuicStream* stream_ptr = stream.get();
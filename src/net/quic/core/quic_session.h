@@ -21,6 +21,7 @@
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_stream.h"
 #include "net/quic/core/quic_stream_frame_data_producer.h"
+#include "net/quic/core/quic_stream_map.h"
 #include "net/quic/core/quic_write_blocked_list.h"
 #include "net/quic/core/stream_notifier_interface.h"
 #include "net/quic/platform/api/quic_containers.h"
@@ -84,6 +85,15 @@ class QUIC_EXPORT_PRIVATE QuicSession : public QuicConnectionVisitorInterface,
 
   ~QuicSession() override;
 
+  // Like QuicConnection, sessions churn with connections on servers; draw
+  // their memory from the per-thread block pools.
+  static void* operator new(size_t size) {
+    return QuicObjectPool::Allocate(size);
+  }
+  static void operator delete(void* block, size_t size) {
+    QuicObjectPool::Deallocate(block, size);
+  }
+
   virtual void Initialize();
 
   // QuicConnectionVisitorInterface methods:
@@ -153,6 +163,11 @@ class QUIC_EXPORT_PRIVATE QuicSession : public QuicConnectionVisitorInterface,
   // Removes the stream associated with 'stream_id' from the active stream map.
   virtual void CloseStream(QuicStreamId stream_id);
 
+  // Closes every stream in |stream_ids| as |CloseStream| would, but updates
+  // the connection's open-stream count once for the whole batch. For callers
+  // tearing down a fan-out of streams at once.
+  void CloseStreamBatch(const std::vector<QuicStreamId>& stream_ids);
+
   // Returns true if outgoing packets will be encrypted, even if the server
   // hasn't confirmed the handshake yet.
   virtual bool IsEncryptionEstablished() const;
@@ -283,8 +298,10 @@ class QUIC_EXPORT_PRIVATE QuicSession : public QuicConnectionVisitorInterface,
  protected:
   using StaticStreamMap = QuicSmallMap<QuicStreamId, QuicStream*, 2>;
 
-  using DynamicStreamMap =
-      QuicSmallMap<QuicStreamId, std::unique_ptr<QuicStream>, 10>;
+  // Stream IDs are allocated densely, so dynamic streams live in a paged
+  // direct-index map: routing a stream frame to its stream is O(1) whether
+  // the session has ten streams or fifty thousand.
+  using DynamicStreamMap = QuicStreamMap<std::unique_ptr<QuicStream>>;
 
   using ClosedStreams = std::vector<std::unique_ptr<QuicStream>>;
 
@@ -310,6 +327,14 @@ class QUIC_EXPORT_PRIVATE QuicSession : public QuicConnectionVisitorInterface,
   // Returns nullptr if max streams have already been opened.
   virtual QuicStream* MaybeCreateOutgoingDynamicStream(SpdyPriority priority);
 
+  // Creates up to |count| locally-initiated streams in one sweep, appending
+  // them to |streams| and returning the number created. The open-stream
+  // limits are consulted once for the batch rather than per stream, and the
+  // connection's open-stream count is updated once at the end. Creates
+  // fewer than |count| streams when the limit leaves less headroom.
+  size_t CreateOutgoingDynamicStreamBatch(size_t count,
+                                          std::vector<QuicStream*>* streams);
+
   // TODO(ckrasic) - For all Create*DynamicStream below, remove when
   // quic_reloadable_flag_quic_refactor_stream_creation is deprecated.
 
@@ -443,6 +468,10 @@ class QUIC_EXPORT_PRIVATE QuicSession : public QuicConnectionVisitorInterface,
                                  uint64_t previous_bytes_written,
                                  bool previous_fin_sent);
 
+  // Called by OnCanWrite for each stream popped from the write blocked list;
+  // lets the stream write if it is not flow control blocked.
+  void WriteBlockedStream(QuicStreamId stream_id);
+
   // Called in OnConfigNegotiated for Finch trials to measure performance of
   // starting with larger flow control receive windows.
   void AdjustInitialFlowControlWindows(size_t stream_window);
@@ -524,6 +553,10 @@ class QUIC_EXPORT_PRIVATE QuicSession : public QuicConnectionVisitorInterface,
   // chance they will fail.
   bool respect_goaway_;
 
+  // True while a batch create or close is sweeping streams, suppressing the
+  // per-stream open-stream-count updates in favor of one at the end.
+  bool batch_stream_operation_in_progress_;
+
   // This session is notified on every ack or loss.
   const bool use_stream_notifier_;
 
@@ -254,6 +254,7 @@ class TestSession : public QuicSpdySession {
                       FIN, nullptr);
   }
 
+  using QuicSession::CreateOutgoingDynamicStreamBatch;
   using QuicSession::PostProcessAfterData;
   using QuicSession::closed_streams;
   using QuicSession::zombie_streams;
@@ -459,6 +460,35 @@ TEST_P(QuicSessionTestServer, DebugDFatalIfMarkingClosedStreamWriteBlocked) {
                   msg);
 }
 
+TEST_P(QuicSessionTestServer, CreateAndCloseStreamBatch) {
+  session_.GetMutableCryptoStream()->set_encryption_established(true);
+
+  // The batch is capped by the remaining open-stream allowance.
+  QuicSessionPeer::SetMaxOpenOutgoingStreams(&session_, 5);
+  std::vector<QuicStream*> streams;
+  EXPECT_EQ(5u, session_.CreateOutgoingDynamicStreamBatch(8, &streams));
+  ASSERT_EQ(5u, streams.size());
+  EXPECT_EQ(5u, session_.GetNumOpenOutgoingStreams());
+
+  // IDs are allocated in order, as repeated single creations would.
+  for (size_t i = 0; i < streams.size(); ++i) {
+    EXPECT_EQ(GetNthServerInitiatedId(i), streams[i]->id());
+  }
+
+  // Symmetric teardown closes the whole fan-out in one sweep.
+  std::vector<QuicStreamId> stream_ids;
+  for (QuicStream* stream : streams) {
+    stream_ids.push_back(stream->id());
+  }
+  session_.CloseStreamBatch(stream_ids);
+  EXPECT_EQ(0u, session_.GetNumOpenOutgoingStreams());
+
+  // With the limit freed up, a new batch is created at full size.
+  streams.clear();
+  EXPECT_EQ(3u, session_.CreateOutgoingDynamicStreamBatch(3, &streams));
+  EXPECT_EQ(3u, session_.GetNumOpenOutgoingStreams());
+}
+
 TEST_P(QuicSessionTestServer, OnCanWrite) {
   session_.set_writev_consumes_all_data(true);
   TestStream* stream2 = session_.CreateOutgoingDynamicStream(kDefaultPriority);
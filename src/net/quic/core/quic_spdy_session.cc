@@ -96,6 +96,35 @@ class ForceHolAckListener : public QuicAckListenerInterface {
   DISALLOW_COPY_AND_ASSIGN(ForceHolAckListener);
 };
 
+// A conservative upper bound on the serialized size of |headers| in a HEADERS
+// frame. HPACK emits each header fragment as at most a pair of length-prefixed
+// literals, and large blocks are split across CONTINUATION frames.
+size_t HeadersFrameUpperBound(const SpdyHeaderBlock& headers) {
+  // Dynamic table size updates take at most a pair of 6-byte integers.
+  size_t block_bound = 12;
+  for (const auto& header : headers) {
+    // Cookie values are crumbled at ";" and other values are decomposed at
+    // NUL separators; every fragment repeats the name and adds up to 11 bytes
+    // of literal overhead.
+    size_t fragments =
+        1 + std::count(header.second.begin(), header.second.end(), '\0');
+    if (header.first == "cookie") {
+      fragments += std::count(header.second.begin(), header.second.end(), ';');
+    }
+    block_bound += header.second.size() + fragments * (header.first.size() + 11);
+  }
+  // Each control frame carries a bit less than kSpdyInitialFrameSizeLimit
+  // bytes of the block; undercounting the per-frame payload only overcounts
+  // frames, which keeps the bound conservative.
+  const size_t frame_count =
+      block_bound /
+          (kSpdyInitialFrameSizeLimit - 2 * kContinuationFrameMinimumSize) +
+      1;
+  // Priority information adds at most five bytes to the HEADERS frame.
+  return block_bound + kHeadersFrameMinimumSize + 5 +
+         frame_count * kContinuationFrameMinimumSize;
+}
+
 }  // namespace
 
 // A SpdyFramerVisitor that passes HEADERS frames to the QuicSpdyStream, and
@@ -345,7 +374,10 @@ QuicSpdySession::QuicSpdySession(QuicConnection* connection,
       cur_max_timestamp_(QuicTime::Zero()),
       prev_max_timestamp_(QuicTime::Zero()),
       spdy_framer_(SpdyFramer::ENABLE_COMPRESSION),
-      spdy_framer_visitor_(new SpdyFramerVisitor(this)) {
+      spdy_framer_visitor_(new SpdyFramerVisitor(this)),
+      multiple_compression_contexts_(false),
+      decode_context_id_(0),
+      remaining_block_bytes_(0) {
   spdy_framer_.set_visitor(spdy_framer_visitor_.get());
   spdy_framer_.set_debug_visitor(spdy_framer_visitor_.get());
 }
@@ -385,6 +417,15 @@ void QuicSpdySession::Initialize() {
     // Limit HPACK buffering to 2x header list size limit.
     set_max_decode_buffer_size_bytes(2 * max_inbound_header_list_size_);
   }
+
+  if (FLAGS_quic_reloadable_flag_quic_headers_decode_expansion_limit) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_headers_decode_expansion_limit);
+    // Fail decoding outright for header blocks which decompress far past the
+    // header list size limit, instead of decoding them in full only to
+    // truncate the result.
+    spdy_framer_.set_max_uncompressed_block_size_bytes(
+        8 * max_inbound_header_list_size_);
+  }
 }
 
 void QuicSpdySession::OnStreamHeadersPriority(QuicStreamId stream_id,
@@ -433,8 +474,57 @@ size_t QuicSpdySession::ProcessHeaderData(const struct iovec& iov,
                                           QuicTime timestamp) {
   DCHECK(timestamp.IsInitialized());
   UpdateCurMaxTimeStamp(timestamp);
-  return spdy_framer_.ProcessInput(static_cast<char*>(iov.iov_base),
-                                   iov.iov_len);
+  const char* data = static_cast<char*>(iov.iov_base);
+  const size_t len = iov.iov_len;
+  if (!multiple_compression_contexts_) {
+    return spdy_framer_.ProcessInput(data, len);
+  }
+
+  // Each block on the headers stream is preceded by a context id and block
+  // length; demultiplex the payload bytes to the framer for their context.
+  size_t total_processed = 0;
+  while (total_processed < len) {
+    if (remaining_block_bytes_ == 0) {
+      // Accumulate the prefix, which may be split across iovecs.
+      const size_t needed =
+          kCompressionContextPrefixSize - context_prefix_buffer_.size();
+      const size_t available =
+          std::min(needed, len - total_processed);
+      context_prefix_buffer_.append(data + total_processed, available);
+      total_processed += available;
+      if (context_prefix_buffer_.size() < kCompressionContextPrefixSize) {
+        break;
+      }
+      const uint8_t context_id =
+          static_cast<uint8_t>(context_prefix_buffer_[0]);
+      uint32_t block_len = 0;
+      for (size_t i = 1; i < kCompressionContextPrefixSize; ++i) {
+        block_len = (block_len << 8) |
+                    static_cast<uint8_t>(context_prefix_buffer_[i]);
+      }
+      context_prefix_buffer_.clear();
+      if (context_id >= kNumHeaderCompressionContexts || block_len == 0) {
+        CloseConnectionWithDetails(QUIC_INVALID_HEADERS_STREAM_DATA,
+                                   "Invalid compression context prefix.");
+        return total_processed;
+      }
+      decode_context_id_ = context_id;
+      remaining_block_bytes_ = block_len;
+      continue;
+    }
+    const size_t block_bytes =
+        std::min(remaining_block_bytes_, len - total_processed);
+    const size_t processed = FramerForContext(decode_context_id_)
+                                 ->ProcessInput(data + total_processed,
+                                                block_bytes);
+    total_processed += processed;
+    remaining_block_bytes_ -= processed;
+    if (processed < block_bytes) {
+      // The framer hit an error; its visitor has closed the connection.
+      break;
+    }
+  }
+  return total_processed;
 }
 
 size_t QuicSpdySession::WriteHeaders(
@@ -461,7 +551,32 @@ size_t QuicSpdySession::WriteHeadersImpl(
     headers_frame.set_has_priority(true);
     headers_frame.set_weight(Spdy3PriorityToHttp2Weight(priority));
   }
-  SpdySerializedFrame frame(spdy_framer_.SerializeFrame(headers_frame));
+  const uint8_t context_id = multiple_compression_contexts_
+                                 ? HeaderCompressionContextForStream(id)
+                                 : 0;
+  SpdyFramer* framer = FramerForContext(context_id);
+  if (FLAGS_quic_reloadable_flag_quic_headers_stream_zero_copy) {
+    QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_headers_stream_zero_copy, 1, 2);
+    QuicMemSliceOutputBuffer output(
+        connection()->helper()->GetStreamSendBufferAllocator(),
+        HeadersFrameUpperBound(headers_frame.header_block()));
+    const size_t frame_len = framer->SerializeFrame(headers_frame, &output);
+    if (frame_len == 0) {
+      // The HPACK encoder state has already been mutated, so the frame cannot
+      // be serialized again without desynchronizing the peer's decoder.
+      QUIC_BUG << "Failed to serialize HEADERS frame for stream " << id;
+      connection()->CloseConnection(
+          QUIC_INTERNAL_ERROR, "Failed to serialize HEADERS frame.",
+          ConnectionCloseBehavior::SEND_CONNECTION_CLOSE_PACKET);
+      return 0;
+    }
+    WriteCompressionContextPrefix(context_id, frame_len);
+    headers_stream_->WriteOrBufferMemSlice(output.Release(), false,
+                                           std::move(ack_notifier_delegate));
+    return frame_len;
+  }
+  SpdySerializedFrame frame(framer->SerializeFrame(headers_frame));
+  WriteCompressionContextPrefix(context_id, frame.size());
   headers_stream_->WriteOrBufferData(
       QuicStringPiece(frame.data(), frame.size()), false,
       std::move(ack_notifier_delegate));
@@ -482,7 +597,9 @@ size_t QuicSpdySession::WritePushPromise(QuicStreamId original_stream_id,
   // response headers.
   push_promise.set_fin(false);
 
+  // Push promise headers always use the default compression context.
   SpdySerializedFrame frame(spdy_framer_.SerializeFrame(push_promise));
+  WriteCompressionContextPrefix(0, frame.size());
   headers_stream_->WriteOrBufferData(
       QuicStringPiece(frame.data(), frame.size()), false, nullptr);
   return frame.size();
@@ -498,6 +615,32 @@ void QuicSpdySession::WriteDataFrame(
   SpdyDataIR spdy_data(id);
   spdy_data.SetDataShallow(data);
   spdy_data.set_fin(fin);
+  if (FLAGS_quic_reloadable_flag_quic_headers_stream_zero_copy) {
+    QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_headers_stream_zero_copy, 2, 2);
+    // A DATA frame is its payload plus a fixed-size frame header.
+    QuicMemSliceOutputBuffer output(
+        connection()->helper()->GetStreamSendBufferAllocator(),
+        kDataFrameMinimumSize + data.length());
+    const size_t frame_len = spdy_framer_.SerializeFrame(spdy_data, &output);
+    if (frame_len == 0) {
+      QUIC_BUG << "Failed to serialize DATA frame for stream " << id;
+      connection()->CloseConnection(
+          QUIC_INTERNAL_ERROR, "Failed to serialize DATA frame.",
+          ConnectionCloseBehavior::SEND_CONNECTION_CLOSE_PACKET);
+      return;
+    }
+    QuicReferenceCountedPointer<ForceHolAckListener> hol_ack_listener;
+    if (ack_listener != nullptr) {
+      hol_ack_listener = new ForceHolAckListener(std::move(ack_listener),
+                                                 frame_len - data.length());
+    }
+    // Use buffered writes so that coherence of framing is preserved
+    // between streams.
+    WriteCompressionContextPrefix(0, frame_len);
+    headers_stream_->WriteOrBufferMemSlice(output.Release(), false,
+                                           std::move(hol_ack_listener));
+    return;
+  }
   SpdySerializedFrame frame(spdy_framer_.SerializeFrame(spdy_data));
   QuicReferenceCountedPointer<ForceHolAckListener> force_hol_ack_listener;
   if (ack_listener != nullptr) {
@@ -506,6 +649,7 @@ void QuicSpdySession::WriteDataFrame(
   }
   // Use buffered writes so that coherence of framing is preserved
   // between streams.
+  WriteCompressionContextPrefix(0, frame.size());
   headers_stream_->WriteOrBufferData(
       QuicStringPiece(frame.data(), frame.size()), false,
       std::move(force_hol_ack_listener));
@@ -572,6 +716,7 @@ size_t QuicSpdySession::SendMaxHeaderListSize(size_t value) {
   settings_frame.AddSetting(SETTINGS_MAX_HEADER_LIST_SIZE, value);
 
   SpdySerializedFrame frame(spdy_framer_.SerializeFrame(settings_frame));
+  WriteCompressionContextPrefix(0, frame.size());
   headers_stream_->WriteOrBufferData(
       QuicStringPiece(frame.data(), frame.size()), false, nullptr);
   return frame.size();
@@ -627,6 +772,9 @@ void QuicSpdySession::OnConfigNegotiated() {
   if (config()->HasClientSentConnectionOption(kDHDT, perspective())) {
     DisableHpackDynamicTable();
   }
+  if (config()->HasClientSentConnectionOption(kMHCC, perspective())) {
+    multiple_compression_contexts_ = true;
+  }
   const QuicVersion version = connection()->version();
   if (!use_stream_notifier() &&
       version == QUIC_VERSION_36 && config()->ForceHolBlocking(perspective())) {
@@ -731,6 +879,50 @@ void QuicSpdySession::OnCompressedFrameSize(size_t frame_len) {
   frame_len_ += frame_len;
 }
 
+uint8_t QuicSpdySession::HeaderCompressionContextForStream(
+    QuicStreamId /*stream_id*/) const {
+  return 0;
+}
+
+SpdyFramer* QuicSpdySession::FramerForContext(uint8_t context_id) {
+  DCHECK_LT(context_id, kNumHeaderCompressionContexts);
+  if (context_id == 0) {
+    return &spdy_framer_;
+  }
+  std::unique_ptr<SpdyFramer>& framer = context_framers_[context_id];
+  if (framer == nullptr) {
+    framer.reset(new SpdyFramer(SpdyFramer::ENABLE_COMPRESSION));
+    framer->set_visitor(spdy_framer_visitor_.get());
+    framer->set_debug_visitor(spdy_framer_visitor_.get());
+    // Apply the same decoder limits Initialize() configures for the primary
+    // framer.
+    if (FLAGS_quic_restart_flag_quic_header_list_size) {
+      framer->set_max_decode_buffer_size_bytes(2 *
+                                               max_inbound_header_list_size_);
+    }
+    if (FLAGS_quic_reloadable_flag_quic_headers_decode_expansion_limit) {
+      framer->set_max_uncompressed_block_size_bytes(
+          8 * max_inbound_header_list_size_);
+    }
+  }
+  return framer.get();
+}
+
+void QuicSpdySession::WriteCompressionContextPrefix(uint8_t context_id,
+                                                    size_t frame_len) {
+  if (!multiple_compression_contexts_) {
+    return;
+  }
+  char prefix[kCompressionContextPrefixSize];
+  prefix[0] = static_cast<char>(context_id);
+  prefix[1] = static_cast<char>((frame_len >> 24) & 0xff);
+  prefix[2] = static_cast<char>((frame_len >> 16) & 0xff);
+  prefix[3] = static_cast<char>((frame_len >> 8) & 0xff);
+  prefix[4] = static_cast<char>(frame_len & 0xff);
+  headers_stream_->WriteOrBufferData(
+      QuicStringPiece(prefix, kCompressionContextPrefixSize), false, nullptr);
+}
+
 void QuicSpdySession::DisableHpackDynamicTable() {
   spdy_framer_.UpdateHeaderEncoderTableSize(0);
 }
@@ -6,7 +6,10 @@
 #define NET_QUIC_CORE_QUIC_SPDY_SESSION_H_
 
 #include <cstddef>
+#include <cstdint>
+#include <map>
 #include <memory>
+#include <string>
 
 #include "base/macros.h"
 #include "net/quic/core/quic_header_list.h"
@@ -22,6 +25,16 @@ namespace test {
 class QuicSpdySessionPeer;
 }  // namespace test
 
+// Number of selectable header compression contexts when the kMHCC connection
+// option is negotiated.  Context ids are carried in a single byte on the
+// headers stream; the small fixed bound keeps the per-connection memory for
+// HPACK dynamic tables predictable.
+const uint8_t kNumHeaderCompressionContexts = 8;
+
+// Size of the per-block prefix on the headers stream under kMHCC: one byte of
+// context id followed by the block length as a 32-bit big-endian integer.
+const size_t kCompressionContextPrefixSize = 5;
+
 // QuicHpackDebugVisitor gathers data used for understanding HPACK HoL
 // dynamics.  Specifically, it is to help predict the compression
 // penalty of avoiding HoL by chagning how the dynamic table is used.
@@ -134,6 +147,20 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession : public QuicSession {
 
   bool force_hol_blocking() const { return force_hol_blocking_; }
 
+  // Returns the header compression context used for HEADERS frames on
+  // |stream_id| when the kMHCC connection option is negotiated.  Contexts
+  // isolate HPACK dynamic tables from each other, so a shared proxy
+  // connection can keep unrelated tenants' header patterns from evicting
+  // each other's table entries.  The default implementation places every
+  // stream in context 0; subclasses map streams to tenants.  The returned
+  // value must be less than kNumHeaderCompressionContexts.
+  virtual uint8_t HeaderCompressionContextForStream(
+      QuicStreamId stream_id) const;
+
+  bool multiple_compression_contexts() const {
+    return multiple_compression_contexts_;
+  }
+
   bool server_push_enabled() const { return server_push_enabled_; }
 
   void UpdateCurMaxTimeStamp(QuicTime timestamp) {
@@ -255,6 +282,14 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession : public QuicSession {
       bool fin,
       QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener);
 
+  // Returns the framer for |context_id|, creating it on first use.  Context 0
+  // is the connection's primary framer, |spdy_framer_|.
+  SpdyFramer* FramerForContext(uint8_t context_id);
+
+  // When kMHCC is negotiated, writes the [context id, length] prefix that
+  // precedes every block on the headers stream.  No-op otherwise.
+  void WriteCompressionContextPrefix(uint8_t context_id, size_t frame_len);
+
   // This was formerly QuicHeadersStream::WriteHeaders.  Needs to be
   // separate from QuicSpdySession::WriteHeaders because tests call
   // this but mock the latter.
@@ -301,6 +336,22 @@ class QUIC_EXPORT_PRIVATE QuicSpdySession : public QuicSession {
   SpdyFramer spdy_framer_;
   std::unique_ptr<SpdyFramerVisitor> spdy_framer_visitor_;
 
+  // True when the kMHCC connection option has been negotiated: each block on
+  // the headers stream is preceded by a compression context id and length,
+  // and each context runs an independent HPACK dynamic table.
+  bool multiple_compression_contexts_;
+
+  // Framers for contexts other than 0, created on first use.  Header
+  // processing is serial, so they share |spdy_framer_visitor_|.
+  std::map<uint8_t, std::unique_ptr<SpdyFramer>> context_framers_;
+
+  // Demultiplexing state for incoming headers stream data: bytes of a
+  // partially received block prefix, the context the current block belongs
+  // to, and how many of its bytes are still expected.
+  std::string context_prefix_buffer_;
+  uint8_t decode_context_id_;
+  size_t remaining_block_bytes_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicSpdySession);
 };
 
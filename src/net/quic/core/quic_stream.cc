@@ -51,7 +51,11 @@ QuicStream::PendingData::~PendingData() {}
 
 QuicStream::QuicStream(QuicStreamId id, QuicSession* session)
     : queued_data_bytes_(0),
-      sequencer_(this, session->connection()->clock()),
+      sequencer_(this,
+                 session->connection()->clock(),
+                 session->connection()
+                     ->helper()
+                     ->GetStreamFrameBufferAllocator()),
       id_(id),
       session_(session),
       stream_bytes_read_(0),
@@ -83,7 +87,9 @@ QuicStream::QuicStream(QuicStreamId id, QuicSession* session)
       send_buffer_(
           session->connection()->helper()->GetStreamSendBufferAllocator()),
       buffered_data_threshold_(
-          GetQuicFlag(FLAGS_quic_buffered_data_threshold)) {
+          GetQuicFlag(FLAGS_quic_buffered_data_threshold)),
+      external_retransmission_data_(false),
+      deadline_(QuicTime::Zero()) {
   SetFromConfig();
 }
 
@@ -224,10 +230,14 @@ void QuicStream::WriteOrBufferData(
     // Do not respect buffered data upper limit as WriteOrBufferData guarantees
     // all data to be consumed.
     if (data.length() > 0) {
-      struct iovec iov(MakeIovec(data));
-      QuicIOVector quic_iov(&iov, 1, data.length());
       QuicStreamOffset offset = send_buffer_.stream_offset();
-      send_buffer_.SaveStreamData(quic_iov, 0, data.length());
+      if (external_retransmission_data_) {
+        send_buffer_.SaveExternalData(data.length());
+      } else {
+        struct iovec iov(MakeIovec(data));
+        QuicIOVector quic_iov(&iov, 1, data.length());
+        send_buffer_.SaveStreamData(quic_iov, 0, data.length());
+      }
       OnDataBuffered(offset, data.length(), ack_listener);
     }
     if (!had_buffered_data && (HasBufferedData() || fin_buffered_)) {
@@ -254,7 +264,54 @@ void QuicStream::WriteOrBufferData(
   }
 }
 
+void QuicStream::WriteOrBufferMemSlice(
+    QuicReferenceCountedPointer<QuicMemSlice> slice,
+    bool fin,
+    QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener) {
+  if (!slice || slice->length() == 0) {
+    QUIC_BUG << "Cannot save an empty mem slice";
+    return;
+  }
+  if (!session_->save_data_before_consumption()) {
+    // Without a send buffer there is nothing to hold the reference; copy.
+    WriteOrBufferData(QuicStringPiece(slice->data(), slice->length()), fin,
+                      std::move(ack_listener));
+    return;
+  }
+
+  if (fin_buffered_) {
+    QUIC_BUG << "Fin already buffered";
+    return;
+  }
+  if (write_side_closed_) {
+    QUIC_DLOG(ERROR) << ENDPOINT
+                     << "Attempt to write when the write side is closed";
+    return;
+  }
+
+  fin_buffered_ = fin;
+
+  bool had_buffered_data = HasBufferedData();
+  const QuicByteCount length = slice->length();
+  QuicStreamOffset offset = send_buffer_.stream_offset();
+  if (external_retransmission_data_) {
+    // No reference to hold: the application re-supplies the bytes on demand.
+    send_buffer_.SaveExternalData(length);
+  } else {
+    send_buffer_.SaveMemSlice(std::move(slice));
+  }
+  OnDataBuffered(offset, length, ack_listener);
+  if (!had_buffered_data) {
+    // Write data if there is no buffered data before.
+    WriteBufferedData();
+  }
+}
+
 void QuicStream::OnCanWrite() {
+  if (HasDeadlinePassed()) {
+    OnDeadlinePassed();
+    return;
+  }
   if (session_->save_data_before_consumption()) {
     DCHECK(queued_data_.empty());
     if (write_side_closed_) {
@@ -358,7 +415,11 @@ QuicConsumedData QuicStream::WritevData(
       consumed_data.bytes_consumed = write_length;
       if (consumed_data.bytes_consumed > 0) {
         QuicStreamOffset offset = send_buffer_.stream_offset();
-        send_buffer_.SaveStreamData(quic_iovec, 0, write_length);
+        if (external_retransmission_data_) {
+          send_buffer_.SaveExternalData(write_length);
+        } else {
+          send_buffer_.SaveStreamData(quic_iovec, 0, write_length);
+        }
         OnDataBuffered(offset, write_length, ack_listener);
       }
     }
@@ -633,13 +694,42 @@ bool QuicStream::WriteStreamData(QuicStreamOffset offset,
                                  QuicByteCount data_length,
                                  QuicDataWriter* writer) {
   DCHECK_LT(0u, data_length);
+  if (external_retransmission_data_) {
+    // The send buffer holds no bytes for this stream; the application
+    // supplies them, for initial serialization and retransmission alike.
+    return RetrieveStreamData(offset, data_length, writer);
+  }
   return send_buffer_.WriteStreamData(offset, data_length, writer);
 }
 
+bool QuicStream::RetrieveStreamData(QuicStreamOffset /*offset*/,
+                                    QuicByteCount /*data_length*/,
+                                    QuicDataWriter* /*writer*/) {
+  QUIC_BUG << "Stream " << id_
+           << " uses external retransmission data but does not implement "
+              "RetrieveStreamData.";
+  return false;
+}
+
+void QuicStream::set_external_retransmission_data(bool external) {
+  if (external) {
+    DCHECK(session_->save_data_before_consumption());
+    // Changing modes with data already saved would mix slices with and
+    // without payload; require an untouched send buffer.
+    DCHECK_EQ(0u, send_buffer_.stream_offset());
+  }
+  external_retransmission_data_ = external;
+}
+
 void QuicStream::WriteBufferedData() {
   DCHECK(!write_side_closed_ && queued_data_.empty() &&
          (HasBufferedData() || fin_buffered_));
 
+  if (HasDeadlinePassed()) {
+    OnDeadlinePassed();
+    return;
+  }
+
   if (session_->ShouldYield(id())) {
     session_->MarkConnectionLevelWriteBlocked(id());
     return;
@@ -731,4 +821,32 @@ bool QuicStream::CanWriteNewData() const {
   return queued_data_bytes() < buffered_data_threshold_;
 }
 
+bool QuicStream::MaybeSetTtl(QuicTime::Delta ttl) {
+  if (deadline_.IsInitialized()) {
+    QUIC_DLOG(WARNING) << "Deadline of stream " << id_
+                       << " has already been set.";
+    return false;
+  }
+  QuicTime now = session()->connection()->clock()->ApproximateNow();
+  deadline_ = now + ttl;
+  return true;
+}
+
+bool QuicStream::HasDeadlinePassed() const {
+  if (!deadline_.IsInitialized()) {
+    return false;
+  }
+  QuicTime now = session()->connection()->clock()->ApproximateNow();
+  if (now < deadline_) {
+    return false;
+  }
+  // TTL expired.
+  QUIC_DVLOG(1) << ENDPOINT << "stream " << id() << " deadline has passed";
+  return true;
+}
+
+void QuicStream::OnDeadlinePassed() {
+  Reset(QUIC_STREAM_TTL_EXPIRED);
+}
+
 }  // namespace net
@@ -192,6 +192,23 @@ class QUIC_EXPORT_PRIVATE QuicStream : public StreamNotifierInterface {
       bool fin,
       QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener);
 
+  // Like WriteOrBufferData, but hands |slice| to the send buffer by
+  // reference instead of copying it; packets serialize directly from the
+  // slice's bytes, including retransmissions. Falls back to the copying
+  // path when data is not saved before consumption.
+  void WriteOrBufferMemSlice(
+      QuicReferenceCountedPointer<QuicMemSlice> slice,
+      bool fin,
+      QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener);
+
+  // Sets the deadline of this stream to be now + |ttl|, returns true if
+  // the deadline is set successfully, and false if the deadline has already
+  // been set. Once the deadline passes, buffered and outstanding data is
+  // stale: instead of writing or retransmitting it, the stream resets itself
+  // with QUIC_STREAM_TTL_EXPIRED (carrying the final byte offset), which also
+  // cancels pending retransmissions so stale bytes stop occupying cwnd.
+  bool MaybeSetTtl(QuicTime::Delta ttl);
+
   // Adds random padding after the fin is consumed for this stream.
   void AddRandomPaddingAfterFin();
 
@@ -200,6 +217,15 @@ class QUIC_EXPORT_PRIVATE QuicStream : public StreamNotifierInterface {
                        QuicByteCount data_length,
                        QuicDataWriter* writer);
 
+  // Switches this stream to external retransmission data: the send buffer
+  // keeps only ack metadata, and RetrieveStreamData() supplies the payload
+  // whenever a frame is serialized, for initial sends and retransmissions
+  // alike. The application pledges that bytes for any unacked range stay
+  // available and byte-identical until acked or the stream is reset. Only
+  // valid when the session saves data before consumption, and must be set
+  // before the first write on the stream.
+  void set_external_retransmission_data(bool external);
+
   // StreamNotifierInterface methods:
   void OnStreamFrameAcked(const QuicStreamFrame& frame,
                           QuicTime::Delta ack_delay_time) override;
@@ -258,6 +284,14 @@ class QUIC_EXPORT_PRIVATE QuicStream : public StreamNotifierInterface {
   // Called when upper layer can write new data.
   virtual void OnCanWriteNewData() {}
 
+  // When external retransmission data is enabled, writes |data_length| bytes
+  // of stream data starting at |offset| to |writer| and returns true, or
+  // returns false if the data cannot be supplied (which closes the
+  // connection). Subclasses enabling the mode must override this.
+  virtual bool RetrieveStreamData(QuicStreamOffset offset,
+                                  QuicByteCount data_length,
+                                  QuicDataWriter* writer);
+
   bool fin_buffered() const { return fin_buffered_; }
 
   const QuicSession* session() const { return session_; }
@@ -308,6 +342,12 @@ class QUIC_EXPORT_PRIVATE QuicStream : public StreamNotifierInterface {
   // quic_reloadable_flag_quic_save_data_before_consumption2.
   void WriteBufferedData();
 
+  // Returns true if deadline_ has passed.
+  bool HasDeadlinePassed() const;
+
+  // Resets the stream because its remaining data is stale.
+  void OnDeadlinePassed();
+
   std::list<PendingData> queued_data_;
   // How many bytes are queued?
   // TODO(fayang): Remove this variable when deprecating
@@ -391,6 +431,14 @@ class QUIC_EXPORT_PRIVATE QuicStream : public StreamNotifierInterface {
   // Latched value of FLAGS_quic_buffered_data_threshold.
   const QuicByteCount buffered_data_threshold_;
 
+  // If true, the send buffer holds metadata only and RetrieveStreamData()
+  // re-supplies payload bytes on demand.
+  bool external_retransmission_data_;
+
+  // If initialized, reset this stream at this deadline instead of writing or
+  // retransmitting data that is no longer useful.
+  QuicTime deadline_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicStream);
 };
 
@@ -0,0 +1,233 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_STREAM_MAP_H_
+#define NET_QUIC_CORE_QUIC_STREAM_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "net/quic/core/quic_types.h"
+
+namespace net {
+
+// A map keyed by stream ID, tuned for the way sessions allocate IDs: densely
+// and mostly in increasing order. Entries live in fixed-size pages indexed
+// directly by (id >> kQuicStreamMapPageShift), so a lookup is two array
+// indexations with no hashing, probing or tree walk, and stays O(1) at any
+// stream count. Pages are allocated when the first stream in their ID range
+// arrives and freed when their last stream goes away, so a long-lived
+// connection whose IDs keep growing does not accumulate memory.
+//
+// Only the subset of the std::map interface that the session code uses is
+// provided. Iteration visits entries in ascending stream ID order. Erasing
+// invalidates only iterators to the erased entry; inserting invalidates all
+// iterators (a new page may be attached).
+template <typename Value>
+class QuicStreamMap {
+ public:
+  using key_type = QuicStreamId;
+  using value_type = std::pair<const QuicStreamId, Value>;
+  using size_type = size_t;
+
+ private:
+  static const size_t kPageShift = 7;
+  static const size_t kPageSize = 1 << kPageShift;  // Stream IDs per page.
+  static const size_t kPageMask = kPageSize - 1;
+  static const size_t kEndPosition = ~static_cast<size_t>(0);
+
+  struct Slot {
+    value_type* value() { return reinterpret_cast<value_type*>(&storage); }
+    const value_type* value() const {
+      return reinterpret_cast<const value_type*>(&storage);
+    }
+
+    bool occupied = false;
+    typename std::aligned_storage<sizeof(value_type),
+                                  alignof(value_type)>::type storage;
+  };
+
+  struct Page {
+    Slot slots[kPageSize];
+    size_t count = 0;
+  };
+
+ public:
+  // Iterates in ascending stream ID order.
+  template <bool is_const>
+  class Iterator {
+   public:
+    using MapType =
+        typename std::conditional<is_const, const QuicStreamMap, QuicStreamMap>::
+            type;
+    using reference =
+        typename std::conditional<is_const, const value_type, value_type>::
+            type&;
+    using pointer =
+        typename std::conditional<is_const, const value_type, value_type>::
+            type*;
+
+    Iterator() : map_(nullptr), position_(kEndPosition) {}
+
+    // Conversion from iterator to const_iterator.
+    Iterator(const Iterator<false>& other)
+        : map_(other.map_), position_(other.position_) {}
+
+    reference operator*() const { return *map_->SlotAt(position_)->value(); }
+    pointer operator->() const { return map_->SlotAt(position_)->value(); }
+
+    Iterator& operator++() {
+      position_ = map_->NextOccupied(position_ + 1);
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return position_ == other.position_;
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class QuicStreamMap;
+    template <bool other_const>
+    friend class Iterator;
+
+    Iterator(MapType* map, size_t position)
+        : map_(map), position_(position) {}
+
+    MapType* map_;
+    size_t position_;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+
+  QuicStreamMap() {}
+
+  ~QuicStreamMap() { clear(); }
+
+  size_type size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator begin() { return iterator(this, NextOccupied(0)); }
+  const_iterator begin() const {
+    return const_iterator(this, NextOccupied(0));
+  }
+  iterator end() { return iterator(this, kEndPosition); }
+  const_iterator end() const { return const_iterator(this, kEndPosition); }
+
+  iterator find(QuicStreamId id) {
+    return iterator(this, FindPosition(id));
+  }
+  const_iterator find(QuicStreamId id) const {
+    return const_iterator(this, FindPosition(id));
+  }
+
+  // Returns the value for |id|, default-constructing it if absent.
+  Value& operator[](QuicStreamId id) {
+    size_t page_index = id >> kPageShift;
+    if (page_index >= pages_.size()) {
+      pages_.resize(page_index + 1);
+    }
+    if (pages_[page_index] == nullptr) {
+      pages_[page_index].reset(new Page);
+    }
+    Page* page = pages_[page_index].get();
+    Slot* slot = &page->slots[id & kPageMask];
+    if (!slot->occupied) {
+      new (&slot->storage) value_type(id, Value());
+      slot->occupied = true;
+      page->count++;
+      size_++;
+    }
+    return slot->value()->second;
+  }
+
+  // Erases the entry at |pos| and returns an iterator to the entry with the
+  // next larger stream ID.
+  iterator erase(iterator pos) {
+    DCHECK_EQ(this, pos.map_);
+    size_t position = pos.position_;
+    Slot* slot = SlotAt(position);
+    DCHECK(slot->occupied);
+    slot->value()->~value_type();
+    slot->occupied = false;
+    size_--;
+    Page* page = pages_[position >> kPageShift].get();
+    if (--page->count == 0) {
+      pages_[position >> kPageShift].reset();
+    }
+    return iterator(this, NextOccupied(position + 1));
+  }
+
+  void clear() {
+    for (std::unique_ptr<Page>& page : pages_) {
+      if (page == nullptr) {
+        continue;
+      }
+      for (size_t i = 0; i < kPageSize; i++) {
+        if (page->slots[i].occupied) {
+          page->slots[i].value()->~value_type();
+        }
+      }
+      page.reset();
+    }
+    pages_.clear();
+    size_ = 0;
+  }
+
+ private:
+  // Positions encode (page_index << kPageShift) | slot_index, so position
+  // order is stream ID order.
+  Slot* SlotAt(size_t position) {
+    return &pages_[position >> kPageShift]->slots[position & kPageMask];
+  }
+  const Slot* SlotAt(size_t position) const {
+    return &pages_[position >> kPageShift]->slots[position & kPageMask];
+  }
+
+  size_t FindPosition(QuicStreamId id) const {
+    size_t page_index = id >> kPageShift;
+    if (page_index >= pages_.size() || pages_[page_index] == nullptr) {
+      return kEndPosition;
+    }
+    const Slot* slot = &pages_[page_index]->slots[id & kPageMask];
+    return slot->occupied ? id : kEndPosition;
+  }
+
+  // Returns the position of the first occupied slot at or after |position|,
+  // or kEndPosition. Absent pages are skipped without touching their slots.
+  size_t NextOccupied(size_t position) const {
+    size_t page_index = position >> kPageShift;
+    size_t slot_index = position & kPageMask;
+    for (; page_index < pages_.size(); page_index++, slot_index = 0) {
+      const Page* page = pages_[page_index].get();
+      if (page == nullptr || page->count == 0) {
+        continue;
+      }
+      for (; slot_index < kPageSize; slot_index++) {
+        if (page->slots[slot_index].occupied) {
+          return (page_index << kPageShift) | slot_index;
+        }
+      }
+    }
+    return kEndPosition;
+  }
+
+  std::vector<std::unique_ptr<Page>> pages_;
+  size_type size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicStreamMap);
+};
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_STREAM_MAP_H_
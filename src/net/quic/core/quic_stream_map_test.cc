@@ -0,0 +1,106 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_stream_map.h"
+
+#include <memory>
+#include <utility>
+
+#include "net/quic/platform/api/quic_test.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicStreamMapTest : public QuicTest {};
+
+TEST_F(QuicStreamMapTest, BasicInsertFindErase) {
+  QuicStreamMap<int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(0u, map.size());
+  EXPECT_TRUE(map.find(5) == map.end());
+
+  map[5] = 50;
+  map[7] = 70;
+  EXPECT_EQ(2u, map.size());
+  ASSERT_TRUE(map.find(5) != map.end());
+  EXPECT_EQ(5u, map.find(5)->first);
+  EXPECT_EQ(50, map.find(5)->second);
+  EXPECT_TRUE(map.find(6) == map.end());
+
+  // operator[] on an existing key does not insert.
+  map[5] = 51;
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ(51, map.find(5)->second);
+
+  QuicStreamMap<int>::iterator it = map.erase(map.find(5));
+  EXPECT_EQ(1u, map.size());
+  ASSERT_TRUE(it != map.end());
+  EXPECT_EQ(7u, it->first);  // erase() returns the next larger ID.
+  EXPECT_TRUE(map.erase(it) == map.end());
+  EXPECT_TRUE(map.empty());
+}
+
+TEST_F(QuicStreamMapTest, IteratesInStreamIdOrder) {
+  QuicStreamMap<int> map;
+  // Insert out of order, including IDs that land on different pages.
+  const QuicStreamId kIds[] = {301, 3, 1000, 5, 299, 2};
+  for (QuicStreamId id : kIds) {
+    map[id] = static_cast<int>(id);
+  }
+
+  QuicStreamId previous = 0;
+  size_t visited = 0;
+  for (const auto& kv : map) {
+    EXPECT_GT(kv.first, previous);
+    EXPECT_EQ(static_cast<int>(kv.first), kv.second);
+    previous = kv.first;
+    visited++;
+  }
+  EXPECT_EQ(arraysize(kIds), visited);
+}
+
+TEST_F(QuicStreamMapTest, SparseIdsDoNotCollide) {
+  // Far-apart IDs land on distinct pages and must not interfere.
+  QuicStreamMap<int> map;
+  map[2] = 1;
+  map[60000] = 2;
+  EXPECT_EQ(2u, map.size());
+  EXPECT_TRUE(map.find(3) == map.end());
+  EXPECT_TRUE(map.find(59998) == map.end());
+  EXPECT_EQ(1, map.find(2)->second);
+  EXPECT_EQ(2, map.find(60000)->second);
+  map.erase(map.find(60000));
+  EXPECT_TRUE(map.find(60000) == map.end());
+  EXPECT_EQ(1, map.find(2)->second);
+}
+
+TEST_F(QuicStreamMapTest, MoveOnlyValues) {
+  QuicStreamMap<std::unique_ptr<int>> map;
+  map[3] = std::unique_ptr<int>(new int(30));
+  ASSERT_TRUE(map.find(3) != map.end());
+  EXPECT_EQ(30, *map.find(3)->second);
+
+  std::unique_ptr<int> taken = std::move(map.find(3)->second);
+  EXPECT_EQ(30, *taken);
+  map.erase(map.find(3));
+  EXPECT_TRUE(map.empty());
+}
+
+TEST_F(QuicStreamMapTest, ClearDestroysValues) {
+  QuicStreamMap<std::shared_ptr<int>> map;
+  std::shared_ptr<int> value(new int(7));
+  for (QuicStreamId id = 2; id < 600; id += 2) {
+    map[id] = value;
+  }
+  EXPECT_GT(value.use_count(), 1);
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(1, value.use_count());
+  EXPECT_TRUE(map.find(2) == map.end());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
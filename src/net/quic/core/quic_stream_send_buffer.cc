@@ -5,6 +5,7 @@
 #include <algorithm>
 
 #include "net/quic/core/crypto/crypto_protocol.h"
+#include "net/quic/core/quic_copy_counters.h"
 #include "net/quic/core/quic_data_writer.h"
 #include "net/quic/core/quic_stream_send_buffer.h"
 #include "net/quic/core/quic_utils.h"
@@ -22,8 +23,57 @@ QuicStreamDataSlice::QuicStreamDataSlice(UniqueStreamBuffer data,
       data_length(data_length),
       outstanding_data_length(data_length) {}
 
+QuicStreamDataSlice::QuicStreamDataSlice(
+    QuicReferenceCountedPointer<QuicMemSlice> slice,
+    QuicStreamOffset offset)
+    : offset(offset),
+      data_length(slice->length()),
+      outstanding_data_length(data_length),
+      mem_slice(std::move(slice)) {}
+
+QuicStreamDataSlice::QuicStreamDataSlice(QuicStreamOffset offset,
+                                         QuicByteCount data_length)
+    : offset(offset),
+      data_length(data_length),
+      outstanding_data_length(data_length) {}
+
 QuicStreamDataSlice::~QuicStreamDataSlice() {}
 
+const char* QuicStreamDataSlice::data_start() const {
+  return mem_slice ? mem_slice->data() : data.get();
+}
+
+QuicMemSliceOutputBuffer::QuicMemSliceOutputBuffer(
+    QuicBufferAllocator* allocator,
+    QuicByteCount capacity)
+    : buffer_(NewStreamBuffer(allocator, capacity)),
+      capacity_(capacity),
+      written_(0) {}
+
+QuicMemSliceOutputBuffer::~QuicMemSliceOutputBuffer() {}
+
+void QuicMemSliceOutputBuffer::Next(char** data, int* size) {
+  *data = buffer_.get() + written_;
+  *size = capacity_ - written_;
+}
+
+void QuicMemSliceOutputBuffer::AdvanceWritePtr(int64_t count) {
+  DCHECK_LE(written_ + count, capacity_);
+  written_ += count;
+}
+
+uint64_t QuicMemSliceOutputBuffer::BytesFree() const {
+  return capacity_ - written_;
+}
+
+QuicReferenceCountedPointer<QuicMemSlice> QuicMemSliceOutputBuffer::Release() {
+  const QuicByteCount length = written_;
+  capacity_ = 0;
+  written_ = 0;
+  return QuicReferenceCountedPointer<QuicMemSlice>(
+      new QuicMemSlice(std::move(buffer_), length));
+}
+
 QuicStreamSendBuffer::QuicStreamSendBuffer(QuicBufferAllocator* allocator)
     : stream_offset_(0), allocator_(allocator) {}
 
@@ -44,6 +94,24 @@ void QuicStreamSendBuffer::SaveStreamData(QuicIOVector iov,
   }
 }
 
+void QuicStreamSendBuffer::SaveMemSlice(
+    QuicReferenceCountedPointer<QuicMemSlice> slice) {
+  DCHECK(slice && slice->length() > 0);
+  const QuicByteCount length = slice->length();
+  // No chunking by max_data_slice_size here: the slice is a single reference,
+  // and WriteStreamData already serves arbitrary sub-ranges of a slice.
+  send_buffer_.emplace_back(std::move(slice), stream_offset_);
+  stream_offset_ += length;
+}
+
+void QuicStreamSendBuffer::SaveExternalData(QuicByteCount data_length) {
+  DCHECK_LT(0u, data_length);
+  // No chunking by max_data_slice_size: there are no bytes to bound, and
+  // RemoveStreamFrame handles partial acks within a slice.
+  send_buffer_.emplace_back(stream_offset_, data_length);
+  stream_offset_ += data_length;
+}
+
 bool QuicStreamSendBuffer::WriteStreamData(QuicStreamOffset offset,
                                            QuicByteCount data_length,
                                            QuicDataWriter* writer) {
@@ -54,10 +122,15 @@ bool QuicStreamSendBuffer::WriteStreamData(QuicStreamOffset offset,
     if (offset >= slice.offset + slice.data_length) {
       continue;
     }
+    if (slice.data_start() == nullptr) {
+      QUIC_BUG << "Writing stream data from a metadata-only slice. The owner "
+                  "should have re-supplied these bytes instead.";
+      return false;
+    }
     QuicByteCount slice_offset = offset - slice.offset;
     QuicByteCount copy_length =
         std::min(data_length, slice.data_length - slice_offset);
-    if (!writer->WriteBytes(slice.data.get() + slice_offset, copy_length)) {
+    if (!writer->WriteBytes(slice.data_start() + slice_offset, copy_length)) {
       return false;
     }
     offset += copy_length;
@@ -99,6 +172,8 @@ void QuicStreamSendBuffer::SaveStreamDataOneSlice(QuicIOVector iov,
   DCHECK_LE(iov_offset + data_length, iov.total_length);
   UniqueStreamBuffer buffer = NewStreamBuffer(allocator_, data_length);
   QuicUtils::CopyToBuffer(iov, iov_offset, data_length, buffer.get());
+  QuicCopyCounters::RecordCopy(QuicCopyCounters::COPY_SITE_STREAM_SEND_BUFFER,
+                               data_length);
   send_buffer_.emplace_back(std::move(buffer), stream_offset_, data_length);
   stream_offset_ += data_length;
 }
@@ -9,6 +9,8 @@
 
 #include "net/quic/core/frames/quic_stream_frame.h"
 #include "net/quic/core/quic_iovector.h"
+#include "net/quic/platform/api/quic_reference_counted.h"
+#include "net/spdy/core/zero_copy_output_buffer.h"
 
 namespace net {
 
@@ -18,16 +20,82 @@ class QuicStreamSendBufferPeer;
 
 class QuicDataWriter;
 
+// An immutable, reference counted run of application data. The send buffer
+// holds slices by reference instead of copying them, so the underlying bytes
+// must stay alive and unchanged until the last reference is released.
+class QUIC_EXPORT_PRIVATE QuicMemSlice : public QuicReferenceCounted {
+ public:
+  // |data| is not owned and must outlive every reference to this slice.
+  QuicMemSlice(const char* data, QuicByteCount length)
+      : data_(data), length_(length) {}
+
+  // Takes ownership of |buffer|, of which the first |length| bytes are the
+  // slice's data.
+  QuicMemSlice(UniqueStreamBuffer buffer, QuicByteCount length)
+      : owned_buffer_(std::move(buffer)),
+        data_(owned_buffer_.get()),
+        length_(length) {}
+
+  const char* data() const { return data_; }
+  QuicByteCount length() const { return length_; }
+
+ private:
+  // Null unless the slice owns its bytes.
+  UniqueStreamBuffer owned_buffer_;
+  const char* const data_;
+  const QuicByteCount length_;
+};
+
+// A ZeroCopyOutputBuffer over a single stream buffer drawn from a
+// QuicBufferAllocator. Bytes serialized into it can be released as an owning
+// QuicMemSlice and saved to a QuicStreamSendBuffer without another copy.
+class QUIC_EXPORT_PRIVATE QuicMemSliceOutputBuffer
+    : public ZeroCopyOutputBuffer {
+ public:
+  QuicMemSliceOutputBuffer(QuicBufferAllocator* allocator,
+                           QuicByteCount capacity);
+  QuicMemSliceOutputBuffer(const QuicMemSliceOutputBuffer& other) = delete;
+  QuicMemSliceOutputBuffer& operator=(const QuicMemSliceOutputBuffer& other) =
+      delete;
+  ~QuicMemSliceOutputBuffer() override;
+
+  // ZeroCopyOutputBuffer implementation.
+  void Next(char** data, int* size) override;
+  void AdvanceWritePtr(int64_t count) override;
+  uint64_t BytesFree() const override;
+
+  // Number of bytes written so far.
+  QuicByteCount Size() const { return written_; }
+
+  // Releases the bytes written so far as a reference-counted slice which owns
+  // the underlying buffer. The output buffer must not be written afterwards.
+  QuicReferenceCountedPointer<QuicMemSlice> Release();
+
+ private:
+  UniqueStreamBuffer buffer_;
+  QuicByteCount capacity_;
+  QuicByteCount written_;
+};
+
 // QuicStreamDataSlice comprises information of a piece of stream data.
 struct QuicStreamDataSlice {
   QuicStreamDataSlice(UniqueStreamBuffer data,
                       QuicStreamOffset offset,
                       QuicByteCount data_length);
+  QuicStreamDataSlice(QuicReferenceCountedPointer<QuicMemSlice> slice,
+                      QuicStreamOffset offset);
+  // A metadata-only slice: no bytes are retained, and data_start() is null.
+  // The owner of the send buffer re-supplies the payload on demand.
+  QuicStreamDataSlice(QuicStreamOffset offset, QuicByteCount data_length);
   QuicStreamDataSlice(const QuicStreamDataSlice& other) = delete;
   QuicStreamDataSlice(QuicStreamDataSlice&& other) = delete;
   ~QuicStreamDataSlice();
 
-  // Stream data of this data slice.
+  // Returns the first byte of this slice's data, wherever it lives.
+  const char* data_start() const;
+
+  // Stream data of this data slice, when the data was copied in. Null when
+  // |mem_slice| is used instead.
   UniqueStreamBuffer data;
   // Location of this data slice in the stream.
   QuicStreamOffset offset;
@@ -35,6 +103,8 @@ struct QuicStreamDataSlice {
   QuicByteCount data_length;
   // Length of payload which is outstanding and waiting for acks.
   QuicByteCount outstanding_data_length;
+  // Application data held by reference rather than copied.
+  QuicReferenceCountedPointer<QuicMemSlice> mem_slice;
 };
 
 // QuicStreamSendBuffer contains a list of QuicStreamDataSlices. New data slices
@@ -53,6 +123,17 @@ class QUIC_EXPORT_PRIVATE QuicStreamSendBuffer {
                       size_t iov_offset,
                       QuicByteCount data_length);
 
+  // Save |slice| to send buffer by reference; no copy of the underlying
+  // bytes is made, so they must stay valid until every frame covering them
+  // has been acked.
+  void SaveMemSlice(QuicReferenceCountedPointer<QuicMemSlice> slice);
+
+  // Record |data_length| bytes of stream data without retaining the bytes
+  // themselves. Only ack bookkeeping is kept; the owner must be able to
+  // re-supply the identical payload for any outstanding range on demand, so
+  // WriteStreamData must not be called for ranges saved this way.
+  void SaveExternalData(QuicByteCount data_length);
+
   // Write |data_length| of data starts at |offset|.
   bool WriteStreamData(QuicStreamOffset offset,
                        QuicByteCount data_length,
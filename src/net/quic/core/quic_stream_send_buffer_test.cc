@@ -103,6 +103,77 @@ TEST_F(QuicStreamSendBufferTest, RemoveStreamFrameAcrossBoundries) {
   EXPECT_EQ(0u, send_buffer_.size());
 }
 
+TEST_F(QuicStreamSendBufferTest, SaveMemSliceIsNotCopied) {
+  string data4(1024, 'd');
+  QuicReferenceCountedPointer<QuicMemSlice> slice(
+      new QuicMemSlice(data4.data(), data4.length()));
+  send_buffer_.SaveMemSlice(std::move(slice));
+  EXPECT_EQ(5u, send_buffer_.size());
+  EXPECT_EQ(4864u, send_buffer_.stream_offset());
+
+  // Serialization reads the application's bytes in place.
+  char buf[2000];
+  QuicDataWriter writer(2000, buf, Perspective::IS_CLIENT, HOST_BYTE_ORDER);
+  ASSERT_TRUE(send_buffer_.WriteStreamData(3840, 1024, &writer));
+  EXPECT_EQ(data4, QuicStringPiece(buf, 1024));
+
+  // A mutation of the underlying bytes is visible on retransmission,
+  // demonstrating that no copy was made.
+  data4[0] = 'e';
+  QuicDataWriter writer2(2000, buf, Perspective::IS_CLIENT, HOST_BYTE_ORDER);
+  ASSERT_TRUE(send_buffer_.WriteStreamData(3840, 1, &writer2));
+  EXPECT_EQ('e', buf[0]);
+
+  send_buffer_.RemoveStreamFrame(0, 3840);
+  send_buffer_.RemoveStreamFrame(3840, 1024);
+  EXPECT_EQ(0u, send_buffer_.size());
+}
+
+TEST_F(QuicStreamSendBufferTest, SaveExternalDataKeepsMetadataOnly) {
+  send_buffer_.SaveExternalData(1024);
+  EXPECT_EQ(5u, send_buffer_.size());
+  EXPECT_EQ(4864u, send_buffer_.stream_offset());
+
+  // Ack bookkeeping works on metadata-only slices, including partial acks.
+  send_buffer_.RemoveStreamFrame(0, 3840);
+  EXPECT_EQ(1u, send_buffer_.size());
+  send_buffer_.RemoveStreamFrame(3840, 512);
+  EXPECT_EQ(1u, send_buffer_.size());
+  send_buffer_.RemoveStreamFrame(4352, 512);
+  EXPECT_EQ(0u, send_buffer_.size());
+}
+
+TEST_F(QuicStreamSendBufferTest, MemSliceOutputBuffer) {
+  QuicMemSliceOutputBuffer output(&allocator_, 64);
+  EXPECT_EQ(64u, output.BytesFree());
+  EXPECT_EQ(0u, output.Size());
+
+  char* data = nullptr;
+  int size = 0;
+  output.Next(&data, &size);
+  ASSERT_EQ(64, size);
+  memcpy(data, "foo", 3);
+  output.AdvanceWritePtr(3);
+  output.Next(&data, &size);
+  ASSERT_EQ(61, size);
+  memcpy(data, "bar", 3);
+  output.AdvanceWritePtr(3);
+  EXPECT_EQ(58u, output.BytesFree());
+  EXPECT_EQ(6u, output.Size());
+
+  // The released slice owns the buffer and covers exactly the written bytes.
+  QuicReferenceCountedPointer<QuicMemSlice> slice = output.Release();
+  ASSERT_EQ(6u, slice->length());
+  EXPECT_EQ("foobar", QuicStringPiece(slice->data(), slice->length()));
+
+  send_buffer_.SaveMemSlice(std::move(slice));
+  EXPECT_EQ(5u, send_buffer_.size());
+  char buf[10];
+  QuicDataWriter writer(10, buf, Perspective::IS_CLIENT, HOST_BYTE_ORDER);
+  ASSERT_TRUE(send_buffer_.WriteStreamData(3840, 6, &writer));
+  EXPECT_EQ("foobar", QuicStringPiece(buf, 6));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
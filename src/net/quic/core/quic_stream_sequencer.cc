@@ -15,6 +15,8 @@
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
 #include "net/quic/platform/api/quic_clock.h"
+#include "net/quic/platform/api/quic_flag_utils.h"
+#include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
 #include "net/quic/platform/api/quic_str_cat.h"
 #include "net/quic/platform/api/quic_string_piece.h"
@@ -24,15 +26,17 @@ using std::string;
 namespace net {
 
 QuicStreamSequencer::QuicStreamSequencer(QuicStream* quic_stream,
-                                         const QuicClock* clock)
+                                         const QuicClock* clock,
+                                         QuicBufferAllocator* allocator)
     : stream_(quic_stream),
-      buffered_frames_(kStreamReceiveWindowLimit),
+      buffered_frames_(kStreamReceiveWindowLimit, allocator),
       close_offset_(std::numeric_limits<QuicStreamOffset>::max()),
       blocked_(false),
       num_frames_received_(0),
       num_duplicate_frames_received_(0),
       clock_(clock),
-      ignore_read_data_(false) {}
+      ignore_read_data_(false),
+      zero_copy_timestamp_(QuicTime::Zero()) {}
 
 QuicStreamSequencer::~QuicStreamSequencer() {}
 
@@ -47,6 +51,14 @@ void QuicStreamSequencer::OnStreamFrame(const QuicStreamFrame& frame) {
       return;
     }
   }
+  if (FLAGS_quic_reloadable_flag_quic_sequencer_zero_copy && !blocked_ &&
+      !ignore_read_data_ && data_len > 0 &&
+      byte_offset == buffered_frames_.BytesConsumed() &&
+      buffered_frames_.BytesBuffered() == 0) {
+    QUIC_FLAG_COUNT(quic_reloadable_flag_quic_sequencer_zero_copy);
+    OnStreamFrameZeroCopy(frame);
+    return;
+  }
   size_t bytes_written;
   string error_details;
   QuicErrorCode result = buffered_frames_.OnStreamData(
@@ -82,6 +94,47 @@ void QuicStreamSequencer::OnStreamFrame(const QuicStreamFrame& frame) {
   }
 }
 
+void QuicStreamSequencer::OnStreamFrameZeroCopy(const QuicStreamFrame& frame) {
+  DCHECK(zero_copy_data_.empty());
+  zero_copy_data_ = QuicStringPiece(frame.data_buffer, frame.data_length);
+  zero_copy_timestamp_ = clock_->ApproximateNow();
+  // |zero_copy_data_| points into the decrypted packet buffer, which is only
+  // valid for the duration of this synchronous call, so whatever the stream
+  // leaves unread must be copied into |buffered_frames_| before returning.
+  stream_->OnDataAvailable();
+  QuicStringPiece remaining = zero_copy_data_;
+  zero_copy_data_ = QuicStringPiece();
+  if (remaining.empty()) {
+    return;
+  }
+  if (ignore_read_data_) {
+    // The stream stopped reading while the frame was being delivered; discard
+    // the rest of the frame as FlushBufferedFrames() would have.
+    if (!buffered_frames_.MarkExternallyConsumed(remaining.length())) {
+      QUIC_BUG << "Failed to discard the unread part of a zero copy frame. "
+               << DebugString();
+      return;
+    }
+    stream_->AddBytesConsumed(remaining.length());
+    MaybeCloseStream();
+    return;
+  }
+  size_t bytes_written;
+  string error_details;
+  QuicErrorCode result = buffered_frames_.OnStreamData(
+      buffered_frames_.BytesConsumed(), remaining, zero_copy_timestamp_,
+      &bytes_written, &error_details);
+  if (result != QUIC_NO_ERROR) {
+    string details = QuicStrCat(
+        "Stream ", stream_->id(), ": ", QuicErrorCodeToString(result), ": ",
+        error_details, "\nPeer Address: ",
+        stream_->PeerAddressOfLatestPacket().ToString());
+    QUIC_LOG_FIRST_N(WARNING, 50) << QuicErrorCodeToString(result);
+    QUIC_LOG_FIRST_N(WARNING, 50) << details;
+    stream_->CloseConnectionWithDetails(result, details);
+  }
+}
+
 void QuicStreamSequencer::CloseStreamAtOffset(QuicStreamOffset offset) {
   const QuicStreamOffset kMaxOffset =
       std::numeric_limits<QuicStreamOffset>::max();
@@ -121,17 +174,50 @@ bool QuicStreamSequencer::MaybeCloseStream() {
 
 int QuicStreamSequencer::GetReadableRegions(iovec* iov, size_t iov_len) const {
   DCHECK(!blocked_);
+  if (!zero_copy_data_.empty()) {
+    // Anything in |buffered_frames_| sits at higher offsets and only becomes
+    // readable once the zero copy frame has been fully consumed.
+    iov[0].iov_base = const_cast<char*>(zero_copy_data_.data());
+    iov[0].iov_len = zero_copy_data_.length();
+    return 1;
+  }
   return buffered_frames_.GetReadableRegions(iov, iov_len);
 }
 
 bool QuicStreamSequencer::GetReadableRegion(iovec* iov,
                                             QuicTime* timestamp) const {
   DCHECK(!blocked_);
+  if (!zero_copy_data_.empty()) {
+    iov->iov_base = const_cast<char*>(zero_copy_data_.data());
+    iov->iov_len = zero_copy_data_.length();
+    *timestamp = zero_copy_timestamp_;
+    return true;
+  }
   return buffered_frames_.GetReadableRegion(iov, timestamp);
 }
 
 int QuicStreamSequencer::Readv(const struct iovec* iov, size_t iov_len) {
   DCHECK(!blocked_);
+  if (!zero_copy_data_.empty()) {
+    // Copy straight from the packet buffer into the caller's iovecs; nothing
+    // readable sits behind the zero copy frame while it is being delivered.
+    size_t bytes_read = 0;
+    for (size_t i = 0; i < iov_len && !zero_copy_data_.empty(); ++i) {
+      size_t bytes_to_copy =
+          std::min<size_t>(iov[i].iov_len, zero_copy_data_.length());
+      memcpy(iov[i].iov_base, zero_copy_data_.data(), bytes_to_copy);
+      zero_copy_data_.remove_prefix(bytes_to_copy);
+      bytes_read += bytes_to_copy;
+    }
+    if (!buffered_frames_.MarkExternallyConsumed(bytes_read)) {
+      QUIC_BUG << "Failed to record a zero copy read of " << bytes_read
+               << " bytes. " << DebugString();
+      stream_->Reset(QUIC_ERROR_PROCESSING_STREAM);
+      return 0;
+    }
+    stream_->AddBytesConsumed(bytes_read);
+    return static_cast<int>(bytes_read);
+  }
   string error_details;
   size_t bytes_read;
   QuicErrorCode read_error =
@@ -147,7 +233,7 @@ int QuicStreamSequencer::Readv(const struct iovec* iov, size_t iov_len) {
 }
 
 bool QuicStreamSequencer::HasBytesToRead() const {
-  return buffered_frames_.HasBytesToRead();
+  return !zero_copy_data_.empty() || buffered_frames_.HasBytesToRead();
 }
 
 bool QuicStreamSequencer::IsClosed() const {
@@ -156,6 +242,19 @@ bool QuicStreamSequencer::IsClosed() const {
 
 void QuicStreamSequencer::MarkConsumed(size_t num_bytes_consumed) {
   DCHECK(!blocked_);
+  if (!zero_copy_data_.empty()) {
+    if (num_bytes_consumed > zero_copy_data_.length() ||
+        !buffered_frames_.MarkExternallyConsumed(num_bytes_consumed)) {
+      QUIC_BUG << "Invalid argument to MarkConsumed."
+               << " expect to consume: " << num_bytes_consumed
+               << ", but not enough bytes available. " << DebugString();
+      stream_->Reset(QUIC_ERROR_PROCESSING_STREAM);
+      return;
+    }
+    zero_copy_data_.remove_prefix(num_bytes_consumed);
+    stream_->AddBytesConsumed(num_bytes_consumed);
+    return;
+  }
   bool result = buffered_frames_.MarkConsumed(num_bytes_consumed);
   if (!result) {
     QUIC_BUG << "Invalid argument to MarkConsumed."
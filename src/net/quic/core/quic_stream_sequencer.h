@@ -12,6 +12,7 @@
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_stream_sequencer_buffer.h"
 #include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_string_piece.h"
 
 namespace net {
 
@@ -19,6 +20,7 @@ namespace test {
 class QuicStreamSequencerPeer;
 }  // namespace test
 
+class QuicBufferAllocator;
 class QuicClock;
 class QuicStream;
 
@@ -26,7 +28,11 @@ class QuicStream;
 // up to the next layer.
 class QUIC_EXPORT_PRIVATE QuicStreamSequencer {
  public:
-  QuicStreamSequencer(QuicStream* quic_stream, const QuicClock* clock);
+  // If |allocator| is non-null, the underlying buffer draws its blocks from
+  // it rather than the heap; see QuicStreamSequencerBuffer.
+  QuicStreamSequencer(QuicStream* quic_stream,
+                      const QuicClock* clock,
+                      QuicBufferAllocator* allocator = nullptr);
   virtual ~QuicStreamSequencer();
 
   // If the frame is the next one we need in order to process in-order data,
@@ -108,6 +114,12 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencer {
   // (To be called only after StopReading has been called.)
   void FlushBufferedFrames();
 
+  // Hands |frame|'s payload to the stream as a view into the decrypted packet
+  // buffer and buffers only whatever the stream does not consume before
+  // returning. Must only be called for a non-empty frame which starts at the
+  // next offset to read while nothing is buffered.
+  void OnStreamFrameZeroCopy(const QuicStreamFrame& frame);
+
   // Wait until we've seen 'offset' bytes, and then terminate the stream.
   void CloseStreamAtOffset(QuicStreamOffset offset);
 
@@ -141,6 +153,14 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencer {
   // If true, all incoming data will be discarded.
   bool ignore_read_data_;
 
+  // The unconsumed tail of the frame currently being delivered zero copy.
+  // Points into the decrypted packet buffer and is only non-empty during the
+  // stream_->OnDataAvailable() call made by OnStreamFrameZeroCopy.
+  QuicStringPiece zero_copy_data_;
+
+  // Arrival time of the frame backing |zero_copy_data_|.
+  QuicTime zero_copy_timestamp_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicStreamSequencer);
 };
 
@@ -4,8 +4,12 @@
 
 #include "net/quic/core/quic_stream_sequencer_buffer.h"
 
+#include <algorithm>
+
 #include "base/format_macros.h"
+#include "net/quic/core/quic_buffer_allocator.h"
 #include "net/quic/core/quic_constants.h"
+#include "net/quic/core/quic_copy_counters.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
@@ -34,8 +38,11 @@ QuicStreamSequencerBuffer::FrameInfo::FrameInfo(size_t length,
                                                 QuicTime timestamp)
     : length(length), timestamp(timestamp) {}
 
-QuicStreamSequencerBuffer::QuicStreamSequencerBuffer(size_t max_capacity_bytes)
-    : max_buffer_capacity_bytes_(max_capacity_bytes),
+QuicStreamSequencerBuffer::QuicStreamSequencerBuffer(
+    size_t max_capacity_bytes,
+    QuicBufferAllocator* allocator)
+    : allocator_(allocator),
+      max_buffer_capacity_bytes_(max_capacity_bytes),
       blocks_count_(
           ceil(static_cast<double>(max_capacity_bytes) / kBlockSizeBytes)),
       total_bytes_read_(0),
@@ -64,8 +71,9 @@ void QuicStreamSequencerBuffer::Clear() {
   // Reset gaps_ so that buffer is in a state as if all data before
   // total_bytes_read_ has been consumed, and those after total_bytes_read_
   // has never arrived.
-  gaps_ = std::list<Gap>(
-      1, Gap(total_bytes_read_, std::numeric_limits<QuicStreamOffset>::max()));
+  gaps_->clear();
+  gaps_->push_back(
+      Gap(total_bytes_read_, std::numeric_limits<QuicStreamOffset>::max()));
   frame_arrival_time_map_.clear();
 }
 
@@ -74,7 +82,11 @@ bool QuicStreamSequencerBuffer::RetireBlock(size_t idx) {
     QUIC_BUG << "Try to retire block twice";
     return false;
   }
-  delete blocks_[idx];
+  if (allocator_ != nullptr) {
+    allocator_->Delete(reinterpret_cast<char*>(blocks_[idx]));
+  } else {
+    delete blocks_[idx];
+  }
   blocks_[idx] = nullptr;
   QUIC_DVLOG(1) << "Retired block with index: " << idx;
   return true;
@@ -96,13 +108,16 @@ QuicErrorCode QuicStreamSequencerBuffer::OnStreamData(
   }
 
   // Find the first gap not ending before |offset|. This gap maybe the gap to
-  // fill if the arriving frame doesn't overlaps with previous ones.
-  std::list<Gap>::iterator current_gap = gaps_.begin();
-  while (current_gap != gaps_.end() && current_gap->end_offset <= offset) {
-    ++current_gap;
-  }
+  // fill if the arriving frame doesn't overlaps with previous ones.  Gaps are
+  // sorted and disjoint, so a binary search finds it in logarithmic time even
+  // when reordering has opened many gaps.
+  auto current_gap = std::lower_bound(
+      gaps_->begin(), gaps_->end(), offset,
+      [](const Gap& gap, QuicStreamOffset offset) {
+        return gap.end_offset <= offset;
+      });
 
-  DCHECK(current_gap != gaps_.end());
+  DCHECK(current_gap != gaps_->end());
 
   // "duplication": might duplicate with data alread filled,but also might
   // overlap across different QuicStringPiece objects already written.
@@ -145,7 +160,7 @@ QuicErrorCode QuicStreamSequencerBuffer::OnStreamData(
 
   if (current_gap->begin_offset != starting_offset &&
       current_gap->end_offset != starting_offset + data.length() &&
-      gaps_.size() >= kMaxNumGapsAllowed) {
+      gaps_->size() >= kMaxNumGapsAllowed) {
     // This frame is going to create one more gap which exceeds max number of
     // gaps allowed. Stop processing.
     *error_details = "Too many gaps created for this stream.";
@@ -193,9 +208,13 @@ QuicErrorCode QuicStreamSequencerBuffer::OnStreamData(
       return QUIC_STREAM_SEQUENCER_INVALID_STATE;
     }
     if (blocks_[write_block_num] == nullptr) {
-      // TODO(danzh): Investigate if using a freelist would improve performance.
-      // Same as RetireBlock().
-      blocks_[write_block_num] = new BufferBlock();
+      // A pooling |allocator_| serves as the freelist here; every byte of the
+      // block is written before it is read, so it need not be zeroed.
+      blocks_[write_block_num] =
+          allocator_ != nullptr
+              ? reinterpret_cast<BufferBlock*>(
+                    allocator_->New(sizeof(BufferBlock)))
+              : new BufferBlock();
     }
 
     const size_t bytes_to_copy =
@@ -215,6 +234,8 @@ QuicErrorCode QuicStreamSequencerBuffer::OnStreamData(
       return QUIC_STREAM_SEQUENCER_INVALID_STATE;
     }
     memcpy(dest, source, bytes_to_copy);
+    QuicCopyCounters::RecordCopy(QuicCopyCounters::COPY_SITE_SEQUENCER_WRITE,
+                                 bytes_to_copy);
     source += bytes_to_copy;
     source_remaining -= bytes_to_copy;
     offset += bytes_to_copy;
@@ -225,14 +246,38 @@ QuicErrorCode QuicStreamSequencerBuffer::OnStreamData(
   *bytes_buffered = total_written;
   UpdateGapList(current_gap, starting_offset, total_written);
 
-  frame_arrival_time_map_.insert(
-      std::make_pair(starting_offset, FrameInfo(size, timestamp)));
+  // Coalesce the new frame with buffered neighbours that are contiguous and
+  // arrived at the same time, so in-order bursts keep the map at one entry
+  // per arrival time instead of one per frame.
+  QuicStreamOffset frame_offset = starting_offset;
+  size_t frame_length = size;
+  auto next_frame = frame_arrival_time_map_.lower_bound(frame_offset);
+  if (next_frame != frame_arrival_time_map_.end() &&
+      frame_offset + frame_length == next_frame->first &&
+      next_frame->second.timestamp == timestamp) {
+    frame_length += next_frame->second.length;
+    next_frame = frame_arrival_time_map_.erase(next_frame);
+  }
+  bool merged_into_previous = false;
+  if (next_frame != frame_arrival_time_map_.begin()) {
+    auto prev_frame = next_frame;
+    --prev_frame;
+    if (prev_frame->first + prev_frame->second.length == frame_offset &&
+        prev_frame->second.timestamp == timestamp) {
+      prev_frame->second.length += frame_length;
+      merged_into_previous = true;
+    }
+  }
+  if (!merged_into_previous) {
+    frame_arrival_time_map_.insert(
+        std::make_pair(frame_offset, FrameInfo(frame_length, timestamp)));
+  }
   num_bytes_buffered_ += total_written;
   return QUIC_NO_ERROR;
 }
 
 inline void QuicStreamSequencerBuffer::UpdateGapList(
-    std::list<Gap>::iterator gap_with_new_data_written,
+    GapVector::ContainerType::iterator gap_with_new_data_written,
     QuicStreamOffset start_offset,
     size_t bytes_written) {
   if (gap_with_new_data_written->begin_offset == start_offset &&
@@ -248,16 +293,15 @@ inline void QuicStreamSequencerBuffer::UpdateGapList(
              gap_with_new_data_written->end_offset >
                  start_offset + bytes_written) {
     // New data has been written into the middle of the buffer.
-    auto current = gap_with_new_data_written++;
-    QuicStreamOffset current_end = current->end_offset;
-    current->end_offset = start_offset;
-    gaps_.insert(gap_with_new_data_written,
-                 Gap(start_offset + bytes_written, current_end));
+    QuicStreamOffset current_end = gap_with_new_data_written->end_offset;
+    gap_with_new_data_written->end_offset = start_offset;
+    gaps_->insert(gap_with_new_data_written + 1,
+                  Gap(start_offset + bytes_written, current_end));
   } else if (gap_with_new_data_written->begin_offset == start_offset &&
              gap_with_new_data_written->end_offset ==
                  start_offset + bytes_written) {
     // This gap has been filled with new data. So it's no longer a gap.
-    gaps_.erase(gap_with_new_data_written);
+    gaps_->erase(gap_with_new_data_written);
   }
 }
 
@@ -294,6 +338,8 @@ QuicErrorCode QuicStreamSequencerBuffer::Readv(const iovec* dest_iov,
       }
       memcpy(dest, blocks_[block_idx]->buffer + start_offset_in_block,
              bytes_to_copy);
+      QuicCopyCounters::RecordCopy(QuicCopyCounters::COPY_SITE_SEQUENCER_READ,
+                                   bytes_to_copy);
       dest += bytes_to_copy;
       dest_remaining -= bytes_to_copy;
       num_bytes_buffered_ -= bytes_to_copy;
@@ -338,7 +384,7 @@ int QuicStreamSequencerBuffer::GetReadableRegions(struct iovec* iov,
   }
 
   size_t start_block_idx = NextBlockToRead();
-  QuicStreamOffset readable_offset_end = gaps_.front().begin_offset - 1;
+  QuicStreamOffset readable_offset_end = gaps_->front().begin_offset - 1;
   DCHECK_GE(readable_offset_end + 1, total_bytes_read_);
   size_t end_block_offset = GetInBlockOffset(readable_offset_end);
   size_t end_block_idx = GetBlockIndex(readable_offset_end);
@@ -453,9 +499,27 @@ bool QuicStreamSequencerBuffer::MarkConsumed(size_t bytes_used) {
   return true;
 }
 
+bool QuicStreamSequencerBuffer::MarkExternallyConsumed(size_t bytes) {
+  CHECK_EQ(destruction_indicator_, 123456) << "This object has been destructed";
+
+  auto front_gap = gaps_->begin();
+  if (front_gap->begin_offset != total_bytes_read_ ||
+      bytes > front_gap->end_offset - total_bytes_read_) {
+    // Some of the skipped bytes are already buffered.
+    return false;
+  }
+  total_bytes_read_ += bytes;
+  front_gap->begin_offset = total_bytes_read_;
+  if (front_gap->begin_offset == front_gap->end_offset) {
+    // The skipped bytes filled the gap up to the next buffered byte.
+    gaps_->erase(front_gap);
+  }
+  return true;
+}
+
 size_t QuicStreamSequencerBuffer::FlushBufferedFrames() {
   size_t prev_total_bytes_read = total_bytes_read_;
-  total_bytes_read_ = gaps_.back().begin_offset;
+  total_bytes_read_ = gaps_->back().begin_offset;
   Clear();
   return total_bytes_read_ - prev_total_bytes_read;
 }
@@ -466,7 +530,7 @@ void QuicStreamSequencerBuffer::ReleaseWholeBuffer() {
 }
 
 size_t QuicStreamSequencerBuffer::ReadableBytes() const {
-  return gaps_.front().begin_offset - total_bytes_read_;
+  return gaps_->front().begin_offset - total_bytes_read_;
 }
 
 bool QuicStreamSequencerBuffer::HasBytesToRead() const {
@@ -509,13 +573,13 @@ bool QuicStreamSequencerBuffer::RetireBlockIfEmpty(size_t block_index) {
 
   // Check where the logical end of this buffer is.
   // Not empty if the end of circular buffer has been wrapped to this block.
-  if (GetBlockIndex(gaps_.back().begin_offset - 1) == block_index) {
+  if (GetBlockIndex(gaps_->back().begin_offset - 1) == block_index) {
     return true;
   }
 
   // Read index remains in this block, which means a gap has been reached.
   if (NextBlockToRead() == block_index) {
-    Gap first_gap = gaps_.front();
+    Gap first_gap = gaps_->front();
     DCHECK(first_gap.begin_offset == total_bytes_read_);
     // Check where the next piece data is.
     // Not empty if next piece of data is still in this chunk.
@@ -529,7 +593,7 @@ bool QuicStreamSequencerBuffer::RetireBlockIfEmpty(size_t block_index) {
 }
 
 bool QuicStreamSequencerBuffer::Empty() const {
-  return gaps_.size() == 1 && gaps_.front().begin_offset == total_bytes_read_;
+  return gaps_->size() == 1 && gaps_->front().begin_offset == total_bytes_read_;
 }
 
 size_t QuicStreamSequencerBuffer::GetBlockCapacity(size_t block_index) const {
@@ -569,7 +633,7 @@ void QuicStreamSequencerBuffer::UpdateFrameArrivalMap(QuicStreamOffset offset) {
 
 string QuicStreamSequencerBuffer::GapsDebugString() {
   string current_gaps_string;
-  for (const Gap& gap : gaps_) {
+  for (const Gap& gap : gaps_.container()) {
     QuicStreamOffset current_gap_begin = gap.begin_offset;
     QuicStreamOffset current_gap_end = gap.end_offset;
     current_gaps_string.append(
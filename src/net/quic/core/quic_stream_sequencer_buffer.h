@@ -7,7 +7,7 @@
 
 // QuicStreamSequencerBuffer is a circular stream buffer with random write and
 // in-sequence read. It consists of a vector of pointers pointing
-// to memory blocks created as needed and a list of Gaps to indicate
+// to memory blocks created as needed and a sorted vector of Gaps to indicate
 // the missing data between the data already written into the buffer.
 // - Data are written in with offset indicating where it should be in the
 // stream, and the buffer grown as needed (up to the maximum buffer capacity),
@@ -61,16 +61,18 @@
 
 #include <cstddef>
 #include <functional>
-#include <list>
 #include <memory>
 
 #include "base/macros.h"
 #include "net/quic/core/quic_packets.h"
+#include "net/quic/platform/api/quic_containers.h"
 #include "net/quic/platform/api/quic_export.h"
 #include "net/quic/platform/api/quic_string_piece.h"
 
 namespace net {
 
+class QuicBufferAllocator;
+
 namespace test {
 class QuicStreamSequencerBufferPeer;
 }  // namespace test
@@ -85,6 +87,16 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
     QuicStreamOffset end_offset;
   };
 
+  // The number of gaps stored without heap allocation. Streams on all but
+  // heavily reordered paths have at most a couple of gaps open at a time,
+  // which fit inline.
+  static const size_t kInlinedGapCapacity = 4;
+
+  // Gaps are kept sorted and disjoint in a flat vector, so the per-frame
+  // search is a binary search over contiguous memory instead of a walk of a
+  // linked list.
+  typedef QuicStackVector<Gap, kInlinedGapCapacity> GapVector;
+
   // A FrameInfo stores the length of a frame and the time it arrived.
   struct QUIC_EXPORT_PRIVATE FrameInfo {
     FrameInfo();
@@ -104,7 +116,12 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
     char buffer[kBlockSizeBytes];
   };
 
-  explicit QuicStreamSequencerBuffer(size_t max_capacity_bytes);
+  // If |allocator| is non-null, blocks are drawn from it instead of the heap.
+  // Passing the connection helper's allocator shares one block pool across
+  // all streams served by that helper. |allocator| is not owned and must
+  // outlive this buffer.
+  explicit QuicStreamSequencerBuffer(size_t max_capacity_bytes,
+                                     QuicBufferAllocator* allocator = nullptr);
   ~QuicStreamSequencerBuffer();
 
   // Free the space used to buffer data.
@@ -151,6 +168,12 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
   // Pre-requisite: bytes_used <= available bytes to read.
   bool MarkConsumed(size_t bytes_buffered);
 
+  // Advances the read position past |bytes| which were delivered to the
+  // application directly, without ever being written into this buffer. The
+  // skipped bytes must lie entirely within the first gap, i.e. none of them
+  // may already be buffered. Returns false and does nothing otherwise.
+  bool MarkExternallyConsumed(size_t bytes);
+
   // Deletes and records as consumed any buffered data and clear the buffer.
   // (To be called only after sequencer's StopReading has been called.)
   size_t FlushBufferedFrames();
@@ -185,9 +208,10 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
 
   // Called within OnStreamData() to update the gap OnStreamData() writes into
   // (remove, split or change begin/end offset).
-  void UpdateGapList(std::list<Gap>::iterator gap_with_new_data_written,
-                     QuicStreamOffset start_offset,
-                     size_t bytes_written);
+  void UpdateGapList(
+      GapVector::ContainerType::iterator gap_with_new_data_written,
+      QuicStreamOffset start_offset,
+      size_t bytes_written);
 
   // Calculate the capacity of block at specified index.
   // Return value should be either kBlockSizeBytes for non-trailing blocks and
@@ -222,6 +246,10 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
   // Return all received frames as a string in same format as GapsDebugString();
   std::string ReceivedFramesDebugString();
 
+  // Source of block storage, shared with other streams. Not owned, and null
+  // when blocks come straight from the heap.
+  QuicBufferAllocator* const allocator_;
+
   // The maximum total capacity of this buffer in byte, as constructed.
   const size_t max_buffer_capacity_bytes_;
 
@@ -231,8 +259,9 @@ class QUIC_EXPORT_PRIVATE QuicStreamSequencerBuffer {
   // Number of bytes read out of buffer.
   QuicStreamOffset total_bytes_read_;
 
-  // Contains Gaps which represents currently missing data.
-  std::list<Gap> gaps_;
+  // Contains Gaps which represents currently missing data, sorted by offset
+  // with inline storage for the common case of a handful of gaps.
+  GapVector gaps_;
 
   // An ordered, variable-length list of blocks, with the length limited
   // such that the number of blocks never exceeds blocks_count_.
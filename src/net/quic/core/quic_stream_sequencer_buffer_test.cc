@@ -11,6 +11,7 @@
 #include <utility>
 
 #include "base/macros.h"
+#include "net/quic/core/quic_buffer_allocator.h"
 #include "net/quic/platform/api/quic_logging.h"
 #include "net/quic/platform/api/quic_str_cat.h"
 #include "net/quic/platform/api/quic_test.h"
@@ -195,7 +196,41 @@ TEST_F(QuicStreamSequencerBufferTest,
             buffer_->OnStreamData(1824, one_byte, clock_.ApproximateNow(),
                                   &written, &error_details_));
   auto* frame_map = helper_->frame_arrival_time_map();
-  EXPECT_EQ(3u, frame_map->size());
+  // All three successful writes are contiguous and arrived at the same time,
+  // so they are coalesced into a single entry.
+  EXPECT_EQ(1u, frame_map->size());
+  EXPECT_EQ(0u, frame_map->begin()->first);
+  EXPECT_EQ(1825u, frame_map->begin()->second.length);
+  EXPECT_TRUE(helper_->CheckBufferInvariants());
+}
+
+TEST_F(QuicStreamSequencerBufferTest, OnStreamDataMergesAdjacentFrames) {
+  string source(100, 'a');
+  size_t written;
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  QuicTime t1 = clock_.ApproximateNow();
+  // Write [100, 200) and then [0, 100) and [200, 300), all at t1.  The three
+  // contiguous frames coalesce into one entry covering [0, 300).
+  EXPECT_EQ(QUIC_NO_ERROR,
+            buffer_->OnStreamData(100, source, t1, &written, &error_details_));
+  EXPECT_EQ(QUIC_NO_ERROR,
+            buffer_->OnStreamData(0, source, t1, &written, &error_details_));
+  EXPECT_EQ(QUIC_NO_ERROR,
+            buffer_->OnStreamData(200, source, t1, &written, &error_details_));
+  auto* frame_map = helper_->frame_arrival_time_map();
+  EXPECT_EQ(1u, frame_map->size());
+  EXPECT_EQ(0u, frame_map->begin()->first);
+  EXPECT_EQ(300u, frame_map->begin()->second.length);
+  EXPECT_EQ(t1, frame_map->begin()->second.timestamp);
+
+  // A contiguous frame from a different arrival time stays separate, so
+  // GetReadableRegion can still report per-arrival-time regions.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  QuicTime t2 = clock_.ApproximateNow();
+  EXPECT_EQ(QUIC_NO_ERROR,
+            buffer_->OnStreamData(300, source, t2, &written, &error_details_));
+  EXPECT_EQ(2u, frame_map->size());
+  EXPECT_EQ(t2, (*frame_map)[300].timestamp);
   EXPECT_TRUE(helper_->CheckBufferInvariants());
 }
 
@@ -1029,6 +1064,43 @@ TEST_F(QuicStreamSequencerBufferRandomIOTest, RandomWriteAndConsumeInPlace) {
   EXPECT_LE(bytes_to_buffer_, total_bytes_written_);
 }
 
+// An allocator that counts the blocks it has handed out and taken back.
+class CountingBufferAllocator : public QuicBufferAllocator {
+ public:
+  char* New(size_t size) override {
+    ++num_allocated_;
+    return new char[size];
+  }
+
+  char* New(size_t size, bool flag_enable) override { return New(size); }
+
+  void Delete(char* buffer) override {
+    ++num_deleted_;
+    delete[] buffer;
+  }
+
+  int num_allocated_ = 0;
+  int num_deleted_ = 0;
+};
+
+TEST_F(QuicStreamSequencerBufferTest, BlocksComeFromAllocatorWhenProvided) {
+  CountingBufferAllocator allocator;
+  QuicStreamSequencerBuffer buffer(max_capacity_bytes_, &allocator);
+
+  // Writing into two blocks draws two blocks from the allocator.
+  string source(kBlockSizeBytes + 1, 'a');
+  size_t written;
+  EXPECT_EQ(QUIC_NO_ERROR,
+            buffer.OnStreamData(0, source, clock_.ApproximateNow(), &written,
+                                &error_details_));
+  EXPECT_EQ(2, allocator.num_allocated_);
+  EXPECT_EQ(0, allocator.num_deleted_);
+
+  // Consuming everything returns both blocks to the allocator.
+  EXPECT_TRUE(buffer.MarkConsumed(source.size()));
+  EXPECT_EQ(2, allocator.num_deleted_);
+}
+
 }  // anonymous namespace
 
 }  // namespace test
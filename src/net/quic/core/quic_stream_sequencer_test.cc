@@ -67,6 +67,15 @@ class QuicStreamSequencerTest : public QuicTest {
     ASSERT_EQ(static_cast<int>(num_bytes), sequencer_->Readv(&iov, 1));
   }
 
+  // Reads the single readable region, checks that it is a view into
+  // |expected_view| rather than a copy, and consumes |num_bytes| of it.
+  void ConsumeZeroCopyData(const char* expected_view, size_t num_bytes) {
+    iovec iov;
+    ASSERT_EQ(1, sequencer_->GetReadableRegions(&iov, 1));
+    EXPECT_EQ(static_cast<const void*>(expected_view), iov.iov_base);
+    sequencer_->MarkConsumed(num_bytes);
+  }
+
  protected:
   QuicStreamSequencerTest()
       : connection_(new MockQuicConnection(&helper_,
@@ -564,6 +573,87 @@ TEST_F(QuicStreamSequencerTest, MarkConsumedWithMissingPacket) {
   sequencer_->MarkConsumed(6);
 }
 
+TEST_F(QuicStreamSequencerTest, ZeroCopyFullFrameConsumed) {
+  FLAGS_quic_reloadable_flag_quic_sequencer_zero_copy = true;
+  EXPECT_CALL(stream_, OnDataAvailable())
+      .WillOnce(testing::Invoke(
+          CreateFunctor(&QuicStreamSequencerTest::ConsumeData,
+                        base::Unretained(this), 3)));
+
+  OnFrame(0, "abc");
+  EXPECT_EQ(0u, NumBufferedBytes());
+  EXPECT_EQ(3u, sequencer_->NumBytesConsumed());
+  EXPECT_EQ(3u, stream_.flow_controller()->bytes_consumed());
+}
+
+TEST_F(QuicStreamSequencerTest, ZeroCopyRegionIsAViewIntoTheFrame) {
+  FLAGS_quic_reloadable_flag_quic_sequencer_zero_copy = true;
+  const char* payload = "abc";
+  EXPECT_CALL(stream_, OnDataAvailable())
+      .WillOnce(testing::Invoke(
+          CreateFunctor(&QuicStreamSequencerTest::ConsumeZeroCopyData,
+                        base::Unretained(this), payload, 3)));
+
+  OnFrame(0, payload);
+  EXPECT_EQ(0u, NumBufferedBytes());
+  EXPECT_EQ(3u, sequencer_->NumBytesConsumed());
+}
+
+TEST_F(QuicStreamSequencerTest, ZeroCopyPartialFrameConsumed) {
+  FLAGS_quic_reloadable_flag_quic_sequencer_zero_copy = true;
+  EXPECT_CALL(stream_, OnDataAvailable())
+      .WillOnce(testing::Invoke(
+          CreateFunctor(&QuicStreamSequencerTest::ConsumeData,
+                        base::Unretained(this), 2)));
+
+  // The byte the stream does not consume must be copied into the buffer
+  // before OnStreamFrame returns, since the view dies with the packet.
+  OnFrame(0, "abc");
+  EXPECT_EQ(1u, NumBufferedBytes());
+  EXPECT_EQ(2u, sequencer_->NumBytesConsumed());
+
+  std::vector<string> expected = {"c"};
+  ASSERT_TRUE(VerifyReadableRegions(expected));
+  sequencer_->MarkConsumed(1);
+  EXPECT_EQ(3u, sequencer_->NumBytesConsumed());
+}
+
+TEST_F(QuicStreamSequencerTest, ZeroCopySkippedWhenDataIsBuffered) {
+  FLAGS_quic_reloadable_flag_quic_sequencer_zero_copy = true;
+  // An out of order frame is buffered as usual...
+  OnFrame(3, "def");
+  EXPECT_EQ(3u, NumBufferedBytes());
+  EXPECT_EQ(0u, sequencer_->NumBytesConsumed());
+
+  EXPECT_CALL(stream_, OnDataAvailable())
+      .WillOnce(testing::Invoke(
+          CreateFunctor(&QuicStreamSequencerTest::ConsumeData,
+                        base::Unretained(this), 6)));
+
+  // ...so the frame filling the hole takes the buffered path and both frames
+  // are readable at once.
+  OnFrame(0, "abc");
+  EXPECT_EQ(6u, sequencer_->NumBytesConsumed());
+  EXPECT_EQ(0u, NumBufferedBytes());
+}
+
+TEST_F(QuicStreamSequencerTest, ZeroCopyStopReadingMidFrame) {
+  FLAGS_quic_reloadable_flag_quic_sequencer_zero_copy = true;
+  InSequence s;
+  EXPECT_CALL(stream_, OnDataAvailable())
+      .WillOnce(testing::Invoke(
+          CreateFunctor(&QuicStreamSequencer::StopReading,
+                        base::Unretained(sequencer_.get()))));
+  // The unread remainder of the frame is discarded, not buffered, and the
+  // FIN is delivered once the whole frame is recorded as consumed.
+  EXPECT_CALL(stream_, OnFinRead());
+
+  OnFinFrame(0, "abc");
+  EXPECT_EQ(0u, NumBufferedBytes());
+  EXPECT_EQ(3u, sequencer_->NumBytesConsumed());
+  EXPECT_TRUE(sequencer_->IsClosed());
+}
+
 TEST_F(QuicStreamSequencerTest, DontAcceptOverlappingFrames) {
   // The peer should never send us non-identical stream frames which contain
   // overlapping byte ranges - if they do, we close the connection.
@@ -7,6 +7,7 @@
 #include <memory>
 
 #include "net/quic/core/quic_connection.h"
+#include "net/quic/core/quic_data_writer.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/core/quic_write_blocked_list.h"
 #include "net/quic/core/spdy_utils.h"
@@ -54,6 +55,19 @@ class TestStream : public QuicStream {
 
   MOCK_METHOD0(OnCanWriteNewData, void());
 
+  // The bytes this stream re-supplies when external retransmission data is
+  // enabled; offset 0 of |external_data_| is stream offset 0.
+  void set_external_data(string data) { external_data_ = std::move(data); }
+
+  bool RetrieveStreamData(QuicStreamOffset offset,
+                          QuicByteCount data_length,
+                          QuicDataWriter* writer) override {
+    if (offset + data_length > external_data_.length()) {
+      return false;
+    }
+    return writer->WriteBytes(external_data_.data() + offset, data_length);
+  }
+
   using QuicStream::CanWriteNewData;
   using QuicStream::WriteOrBufferData;
   using QuicStream::WritevData;
@@ -62,6 +76,7 @@ class TestStream : public QuicStream {
 
  private:
   string data_;
+  string external_data_;
 };
 
 class QuicStreamTest : public QuicTestWithParam<bool> {
@@ -1002,6 +1017,60 @@ TEST_F(QuicStreamTest, WriteBufferedData) {
   EXPECT_FALSE(stream_->CanWriteNewData());
 }
 
+TEST_F(QuicStreamTest, ExternalRetransmissionData) {
+  Initialize(kShouldProcessData);
+  if (!session_->save_data_before_consumption()) {
+    return;
+  }
+  stream_->set_external_retransmission_data(true);
+  string data(128, 'x');
+  stream_->set_external_data(data);
+  EXPECT_CALL(*session_, WritevData(_, _, _, _, _, _))
+      .WillOnce(Invoke(MockQuicSession::ConsumeAllData));
+  stream_->WriteOrBufferData(data, false, nullptr);
+
+  // Serialization pulls the payload back from the application.
+  char buf[200];
+  QuicDataWriter writer(200, buf, Perspective::IS_SERVER, HOST_BYTE_ORDER);
+  ASSERT_TRUE(stream_->WriteStreamData(0, data.length(), &writer));
+  EXPECT_EQ(data, QuicStringPiece(buf, data.length()));
+
+  // A later serialization of the same range observes the application's
+  // current bytes, demonstrating that the transport retained no payload.
+  stream_->set_external_data(string(128, 'y'));
+  QuicDataWriter writer2(200, buf, Perspective::IS_SERVER, HOST_BYTE_ORDER);
+  ASSERT_TRUE(stream_->WriteStreamData(0, data.length(), &writer2));
+  EXPECT_EQ(string(128, 'y'), QuicStringPiece(buf, data.length()));
+}
+
+TEST_F(QuicStreamTest, MaybeSetTtl) {
+  Initialize(kShouldProcessData);
+  EXPECT_TRUE(stream_->MaybeSetTtl(QuicTime::Delta::FromSeconds(1)));
+  // The deadline can only be set once.
+  EXPECT_FALSE(stream_->MaybeSetTtl(QuicTime::Delta::FromSeconds(1)));
+}
+
+TEST_F(QuicStreamTest, CancelStreamOnTtlExpiry) {
+  Initialize(kShouldProcessData);
+  EXPECT_TRUE(stream_->MaybeSetTtl(QuicTime::Delta::FromMilliseconds(10)));
+
+  // Write data which is only partially consumed, leaving buffered data.
+  EXPECT_CALL(*session_, WritevData(_, _, _, _, _, _))
+      .WillOnce(Return(QuicConsumedData(kDataLen - 1, false)));
+  stream_->WriteOrBufferData(kData1, false, nullptr);
+  EXPECT_TRUE(stream_->HasBufferedData());
+  EXPECT_FALSE(rst_sent());
+
+  // Once the deadline passes, the next write opportunity resets the stream
+  // instead of sending the stale bytes.
+  connection_->AdvanceTime(QuicTime::Delta::FromMilliseconds(20));
+  EXPECT_CALL(*session_,
+              SendRstStream(kTestStreamId, QUIC_STREAM_TTL_EXPIRED, _));
+  stream_->OnCanWrite();
+  EXPECT_TRUE(rst_sent());
+  EXPECT_EQ(QUIC_STREAM_TTL_EXPIRED, stream_->stream_error());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
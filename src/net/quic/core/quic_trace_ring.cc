@@ -0,0 +1,150 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_trace_ring.h"
+
+#include <algorithm>
+
+#include "base/format_macros.h"
+#include "base/lazy_instance.h"
+#include "base/process/process_handle.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread_local.h"
+#include "base/time/time.h"
+
+namespace net {
+
+namespace {
+
+// Caches the calling thread's segment so Record() touches no shared state
+// after the first event. Segments belong to the (leaky) ring singleton; the
+// pointer type is erased here because Segment is private to the ring.
+base::LazyInstance<base::ThreadLocalPointer<void>>::Leaky g_thread_segment =
+    LAZY_INSTANCE_INITIALIZER;
+
+const char* EventTypeName(uint32_t type) {
+  switch (type) {
+    case QUIC_TRACE_EVENT_PACKET_IN:
+      return "PacketIn";
+    case QUIC_TRACE_EVENT_PACKET_OUT:
+      return "PacketOut";
+    case QUIC_TRACE_EVENT_ACK_PROCESSED:
+      return "AckProcessed";
+    case QUIC_TRACE_EVENT_ALARM_FIRED:
+      return "AlarmFired";
+    case QUIC_TRACE_EVENT_STREAM_SCHEDULED:
+      return "StreamScheduled";
+  }
+  return "Unknown";
+}
+
+}  // namespace
+
+struct QuicTraceRing::Segment {
+  Segment() : index(0), tid(base::PlatformThread::CurrentId()) {}
+
+  // Count of events ever recorded to this segment. The writer publishes each
+  // event with a release store here; readers pair with an acquire load.
+  std::atomic<uint64_t> index;
+  base::PlatformThreadId tid;
+  QuicTraceEvent events[kEventsPerThread];
+};
+
+const size_t QuicTraceRing::kEventsPerThread;
+const size_t QuicTraceRing::kMaxThreads;
+
+QuicTraceRing::QuicTraceRing() : enabled_(false), num_segments_(0) {
+  for (size_t i = 0; i < kMaxThreads; ++i) {
+    segments_[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+QuicTraceRing::~QuicTraceRing() {}
+
+// static
+QuicTraceRing* QuicTraceRing::GetInstance() {
+  // Deliberately leaked: recording threads may outlive any particular user of
+  // the ring, and segments are never reclaimed.
+  static QuicTraceRing* instance = new QuicTraceRing();
+  return instance;
+}
+
+void QuicTraceRing::Record(QuicTraceEventType type,
+                           uint64_t arg1,
+                           uint64_t arg2) {
+  Segment* segment = GetOrCreateSegment();
+  if (segment == nullptr) {
+    // All segment slots are taken; drop the event rather than block.
+    return;
+  }
+  const uint64_t index = segment->index.load(std::memory_order_relaxed);
+  QuicTraceEvent& event = segment->events[index & (kEventsPerThread - 1)];
+  event.timestamp_us = base::TimeTicks::Now().ToInternalValue();
+  event.type = type;
+  event.unused = 0;
+  event.arg1 = arg1;
+  event.arg2 = arg2;
+  // Publish the event before advancing the index so an exporter never reads
+  // a half-written record at |index|.
+  segment->index.store(index + 1, std::memory_order_release);
+}
+
+std::string QuicTraceRing::ExportToChromeTracing() const {
+  const base::ProcessId pid = base::GetCurrentProcId();
+  std::string out = "[";
+  bool first = true;
+  const size_t num_segments =
+      std::min(num_segments_.load(std::memory_order_acquire), kMaxThreads);
+  for (size_t i = 0; i < num_segments; ++i) {
+    const Segment* segment = segments_[i].load(std::memory_order_acquire);
+    if (segment == nullptr) {
+      continue;
+    }
+    const uint64_t end = segment->index.load(std::memory_order_acquire);
+    const uint64_t begin = end > kEventsPerThread ? end - kEventsPerThread : 0;
+    for (uint64_t j = begin; j < end; ++j) {
+      const QuicTraceEvent& event = segment->events[j & (kEventsPerThread - 1)];
+      base::StringAppendF(
+          &out,
+          "%s{\"name\":\"%s\",\"cat\":\"quic\",\"ph\":\"i\",\"s\":\"t\","
+          "\"ts\":%" PRIu64 ",\"pid\":%d,\"tid\":%d,"
+          "\"args\":{\"arg1\":%" PRIu64 ",\"arg2\":%" PRIu64 "}}",
+          first ? "" : ",", EventTypeName(event.type), event.timestamp_us,
+          static_cast<int>(pid), static_cast<int>(segment->tid), event.arg1,
+          event.arg2);
+      first = false;
+    }
+  }
+  out.append("]");
+  return out;
+}
+
+void QuicTraceRing::ClearForTesting() {
+  const size_t num_segments =
+      std::min(num_segments_.load(std::memory_order_acquire), kMaxThreads);
+  for (size_t i = 0; i < num_segments; ++i) {
+    Segment* segment = segments_[i].load(std::memory_order_acquire);
+    if (segment != nullptr) {
+      segment->index.store(0, std::memory_order_release);
+    }
+  }
+}
+
+QuicTraceRing::Segment* QuicTraceRing::GetOrCreateSegment() {
+  Segment* segment = static_cast<Segment*>(g_thread_segment.Get().Get());
+  if (segment != nullptr) {
+    return segment;
+  }
+  const size_t slot = num_segments_.fetch_add(1, std::memory_order_acq_rel);
+  if (slot >= kMaxThreads) {
+    return nullptr;
+  }
+  segment = new Segment();
+  segments_[slot].store(segment, std::memory_order_release);
+  g_thread_segment.Get().Set(segment);
+  return segment;
+}
+
+}  // namespace net
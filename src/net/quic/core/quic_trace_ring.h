@@ -0,0 +1,122 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_CORE_QUIC_TRACE_RING_H_
+#define NET_QUIC_CORE_QUIC_TRACE_RING_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+
+#include "base/macros.h"
+#include "net/quic/platform/api/quic_export.h"
+
+namespace net {
+
+// Event kinds recorded by the packet-path trace points below.
+enum QuicTraceEventType : uint32_t {
+  QUIC_TRACE_EVENT_PACKET_IN = 1,
+  QUIC_TRACE_EVENT_PACKET_OUT = 2,
+  QUIC_TRACE_EVENT_ACK_PROCESSED = 3,
+  QUIC_TRACE_EVENT_ALARM_FIRED = 4,
+  QUIC_TRACE_EVENT_STREAM_SCHEDULED = 5,
+};
+
+// One trace record, packed to 32 bytes so a thread's segment stays cache
+// friendly and sizing is easy to reason about (4096 events = 128 kB).
+struct QuicTraceEvent {
+  uint64_t timestamp_us;
+  uint32_t type;
+  uint32_t unused;
+  uint64_t arg1;
+  uint64_t arg2;
+};
+static_assert(sizeof(QuicTraceEvent) == 32,
+              "QuicTraceEvent must pack to 32 bytes");
+
+// A process-wide binary trace ring for the packet path. Unlike
+// base/trace_event, recording never takes a lock, never allocates after a
+// thread's first event, and costs a timestamp plus a few stores, so trace
+// points can live on the hot path of a production connection. Each recording
+// thread owns a fixed-size segment of the ring; within a segment the newest
+// events overwrite the oldest.
+//
+// Use the QUIC_TRACE_* macros below rather than calling Record() directly; a
+// disabled trace point costs one relaxed atomic load.
+class QUIC_EXPORT_PRIVATE QuicTraceRing {
+ public:
+  // Events retained per recording thread; must be a power of two.
+  static const size_t kEventsPerThread = 4096;
+  // Segment slots available; threads beyond this drop their events.
+  static const size_t kMaxThreads = 16;
+
+  static QuicTraceRing* GetInstance();
+
+  void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+  bool IsEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Appends an event to the calling thread's segment. Safe to call from any
+  // thread at any time; events recorded while the ring is being exported may
+  // or may not appear in that export.
+  void Record(QuicTraceEventType type, uint64_t arg1, uint64_t arg2);
+
+  // Serializes the retained events to the JSON array format understood by
+  // chrome://tracing ("trace event format"), oldest first within each
+  // thread's segment.
+  std::string ExportToChromeTracing() const;
+
+  // Drops all retained events. Only meaningful while no thread is recording;
+  // intended for tests.
+  void ClearForTesting();
+
+ private:
+  struct Segment;
+
+  QuicTraceRing();
+  ~QuicTraceRing();
+
+  // Returns the calling thread's segment, claiming a slot on first use, or
+  // nullptr if all kMaxThreads slots are taken.
+  Segment* GetOrCreateSegment();
+
+  std::atomic<bool> enabled_;
+  std::atomic<size_t> num_segments_;
+  std::atomic<Segment*> segments_[kMaxThreads];
+
+  DISALLOW_COPY_AND_ASSIGN(QuicTraceRing);
+};
+
+#define QUIC_TRACE_EVENT_INTERNAL(type, arg1, arg2)                 \
+  do {                                                              \
+    ::net::QuicTraceRing* quic_trace_ring_internal =                \
+        ::net::QuicTraceRing::GetInstance();                        \
+    if (quic_trace_ring_internal->IsEnabled())                      \
+      quic_trace_ring_internal->Record((type), (arg1), (arg2));     \
+  } while (0)
+
+// Packet-path trace points. Arguments are evaluated only when tracing is
+// enabled.
+#define QUIC_TRACE_PACKET_IN(packet_number, length) \
+  QUIC_TRACE_EVENT_INTERNAL(::net::QUIC_TRACE_EVENT_PACKET_IN, \
+                            (packet_number), (length))
+#define QUIC_TRACE_PACKET_OUT(packet_number, length) \
+  QUIC_TRACE_EVENT_INTERNAL(::net::QUIC_TRACE_EVENT_PACKET_OUT, \
+                            (packet_number), (length))
+#define QUIC_TRACE_ACK_PROCESSED(largest_observed, ack_delay_us) \
+  QUIC_TRACE_EVENT_INTERNAL(::net::QUIC_TRACE_EVENT_ACK_PROCESSED, \
+                            (largest_observed), (ack_delay_us))
+#define QUIC_TRACE_ALARM_FIRED(deadline_us) \
+  QUIC_TRACE_EVENT_INTERNAL(::net::QUIC_TRACE_EVENT_ALARM_FIRED, \
+                            (deadline_us), 0)
+#define QUIC_TRACE_STREAM_SCHEDULED(stream_id) \
+  QUIC_TRACE_EVENT_INTERNAL(::net::QUIC_TRACE_EVENT_STREAM_SCHEDULED, \
+                            (stream_id), 0)
+
+}  // namespace net
+
+#endif  // NET_QUIC_CORE_QUIC_TRACE_RING_H_
@@ -0,0 +1,73 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/quic/core/quic_trace_ring.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicTraceRingTest : public ::testing::Test {
+ protected:
+  QuicTraceRingTest() : ring_(QuicTraceRing::GetInstance()) {
+    ring_->ClearForTesting();
+    ring_->SetEnabled(true);
+  }
+
+  ~QuicTraceRingTest() override {
+    ring_->SetEnabled(false);
+    ring_->ClearForTesting();
+  }
+
+  QuicTraceRing* const ring_;
+};
+
+TEST_F(QuicTraceRingTest, RecordAndExport) {
+  QUIC_TRACE_PACKET_IN(7, 1350);
+  QUIC_TRACE_PACKET_OUT(8, 1200);
+  QUIC_TRACE_ACK_PROCESSED(8, 25);
+
+  std::string json = ring_->ExportToChromeTracing();
+  EXPECT_EQ('[', json.front());
+  EXPECT_EQ(']', json.back());
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"PacketIn\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"PacketOut\""));
+  EXPECT_NE(std::string::npos, json.find("\"name\":\"AckProcessed\""));
+  EXPECT_NE(std::string::npos, json.find("\"arg1\":7,\"arg2\":1350"));
+}
+
+TEST_F(QuicTraceRingTest, DisabledRecordsNothing) {
+  ring_->SetEnabled(false);
+  QUIC_TRACE_PACKET_IN(1, 2);
+  EXPECT_EQ("[]", ring_->ExportToChromeTracing());
+}
+
+TEST_F(QuicTraceRingTest, ClearDropsEvents) {
+  QUIC_TRACE_ALARM_FIRED(42);
+  ring_->ClearForTesting();
+  EXPECT_EQ("[]", ring_->ExportToChromeTracing());
+}
+
+TEST_F(QuicTraceRingTest, WrapsOldestEvents) {
+  for (size_t i = 0; i < QuicTraceRing::kEventsPerThread + 10; ++i) {
+    QUIC_TRACE_ALARM_FIRED(i);
+  }
+
+  std::string json = ring_->ExportToChromeTracing();
+  // The oldest ten events were overwritten; the rest are retained.
+  EXPECT_EQ(std::string::npos, json.find("\"arg1\":9,"));
+  EXPECT_NE(std::string::npos, json.find("\"arg1\":10,"));
+  EXPECT_NE(std::string::npos,
+            json.find("\"arg1\":" +
+                      std::to_string(QuicTraceRing::kEventsPerThread + 9) +
+                      ","));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -7,17 +7,19 @@
 namespace net {
 
 QuicTransmissionInfo::QuicTransmissionInfo()
-    : encryption_level(ENCRYPTION_NONE),
-      packet_number_length(PACKET_1BYTE_PACKET_NUMBER),
+    : sent_time(QuicTime::Zero()),
+      retransmission(0),
+      largest_acked(0),
       bytes_sent(0),
-      sent_time(QuicTime::Zero()),
+      num_padding_bytes(0),
+      encryption_level(ENCRYPTION_NONE),
+      packet_number_length(PACKET_1BYTE_PACKET_NUMBER),
       transmission_type(NOT_RETRANSMISSION),
       in_flight(false),
       is_unackable(false),
       has_crypto_handshake(false),
-      num_padding_bytes(0),
-      retransmission(0),
-      largest_acked(0) {}
+      priority(kV3LowestPriority),
+      ack_listeners(nullptr) {}
 
 QuicTransmissionInfo::QuicTransmissionInfo(
     EncryptionLevel level,
@@ -27,21 +29,75 @@ QuicTransmissionInfo::QuicTransmissionInfo(
     QuicPacketLength bytes_sent,
     bool has_crypto_handshake,
     int num_padding_bytes)
-    : encryption_level(level),
-      packet_number_length(packet_number_length),
+    : sent_time(sent_time),
+      retransmission(0),
+      largest_acked(0),
       bytes_sent(bytes_sent),
-      sent_time(sent_time),
+      num_padding_bytes(num_padding_bytes),
+      encryption_level(level),
+      packet_number_length(packet_number_length),
       transmission_type(transmission_type),
       in_flight(false),
       is_unackable(false),
       has_crypto_handshake(has_crypto_handshake),
-      num_padding_bytes(num_padding_bytes),
-      retransmission(0),
-      largest_acked(0) {}
+      priority(kV3LowestPriority),
+      ack_listeners(nullptr) {}
+
+QuicTransmissionInfo::QuicTransmissionInfo(const QuicTransmissionInfo& other)
+    : sent_time(other.sent_time),
+      retransmission(other.retransmission),
+      largest_acked(other.largest_acked),
+      bytes_sent(other.bytes_sent),
+      num_padding_bytes(other.num_padding_bytes),
+      encryption_level(other.encryption_level),
+      packet_number_length(other.packet_number_length),
+      transmission_type(other.transmission_type),
+      in_flight(other.in_flight),
+      is_unackable(other.is_unackable),
+      has_crypto_handshake(other.has_crypto_handshake),
+      priority(other.priority),
+      retransmittable_frames(other.retransmittable_frames),
+      ack_listeners(other.ack_listeners == nullptr
+                        ? nullptr
+                        : new std::list<AckListenerWrapper>(
+                              *other.ack_listeners)),
+      frame_arena(other.frame_arena) {}
+
+QuicTransmissionInfo& QuicTransmissionInfo::operator=(
+    const QuicTransmissionInfo& other) {
+  if (this == &other) {
+    return *this;
+  }
+  sent_time = other.sent_time;
+  retransmission = other.retransmission;
+  largest_acked = other.largest_acked;
+  bytes_sent = other.bytes_sent;
+  num_padding_bytes = other.num_padding_bytes;
+  encryption_level = other.encryption_level;
+  packet_number_length = other.packet_number_length;
+  transmission_type = other.transmission_type;
+  in_flight = other.in_flight;
+  is_unackable = other.is_unackable;
+  has_crypto_handshake = other.has_crypto_handshake;
+  priority = other.priority;
+  retransmittable_frames = other.retransmittable_frames;
+  delete ack_listeners;
+  ack_listeners = other.ack_listeners == nullptr
+                      ? nullptr
+                      : new std::list<AckListenerWrapper>(*other.ack_listeners);
+  frame_arena = other.frame_arena;
+  return *this;
+}
 
-QuicTransmissionInfo::QuicTransmissionInfo(const QuicTransmissionInfo& other) =
-    default;
+QuicTransmissionInfo::~QuicTransmissionInfo() {
+  delete ack_listeners;
+}
 
-QuicTransmissionInfo::~QuicTransmissionInfo() {}
+std::list<AckListenerWrapper>* QuicTransmissionInfo::mutable_ack_listeners() {
+  if (ack_listeners == nullptr) {
+    ack_listeners = new std::list<AckListenerWrapper>;
+  }
+  return ack_listeners;
+}
 
 }  // namespace net
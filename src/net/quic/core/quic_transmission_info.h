@@ -8,9 +8,12 @@
 #include <list>
 
 #include "net/quic/core/frames/quic_frame.h"
+#include "net/quic/core/frames/quic_frame_arena.h"
 #include "net/quic/core/quic_ack_listener_interface.h"
 #include "net/quic/core/quic_types.h"
 #include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_reference_counted.h"
+#include "net/spdy/core/spdy_protocol.h"
 
 namespace net {
 
@@ -30,14 +33,28 @@ struct QUIC_EXPORT_PRIVATE QuicTransmissionInfo {
                        int num_padding_bytes);
 
   QuicTransmissionInfo(const QuicTransmissionInfo& other);
+  QuicTransmissionInfo& operator=(const QuicTransmissionInfo& other);
 
   ~QuicTransmissionInfo();
 
-  QuicFrames retransmittable_frames;
+  // Returns the listener list, allocating it on first use. Most packets
+  // never have a listener and never pay for the list.
+  std::list<AckListenerWrapper>* mutable_ack_listeners();
+
+  // Hot fields, consulted for every unacked packet on every ack and loss
+  // detection pass, packed at the front of the struct so a pass touches as
+  // few cache lines of the unacked deque as possible.
+  QuicTime sent_time;
+  // Stores the packet number of the next retransmission of this packet.
+  // Zero if the packet has not been retransmitted.
+  QuicPacketNumber retransmission;
+  // The largest_acked in the ack frame, if the packet contains an ack.
+  QuicPacketNumber largest_acked;
+  QuicPacketLength bytes_sent;
+  // Non-zero if the packet needs padding if it's retransmitted.
+  int16_t num_padding_bytes;
   EncryptionLevel encryption_level;
   QuicPacketNumberLength packet_number_length;
-  QuicPacketLength bytes_sent;
-  QuicTime sent_time;
   // Reason why this packet was transmitted.
   TransmissionType transmission_type;
   // In flight packets have not been abandoned or lost.
@@ -48,15 +65,25 @@ struct QUIC_EXPORT_PRIVATE QuicTransmissionInfo {
   bool is_unackable;
   // True if the packet contains stream data from the crypto stream.
   bool has_crypto_handshake;
-  // Non-zero if the packet needs padding if it's retransmitted.
-  int16_t num_padding_bytes;
-  // Stores the packet number of the next retransmission of this packet.
-  // Zero if the packet has not been retransmitted.
-  QuicPacketNumber retransmission;
-  // Non-empty if there is a listener for this packet.
-  std::list<AckListenerWrapper> ack_listeners;
-  // The largest_acked in the ack frame, if the packet contains an ack.
-  QuicPacketNumber largest_acked;
+  // Priority of the most important stream with data in this packet;
+  // kV3LowestPriority when it carries no stream data. Inherited across
+  // retransmissions so recovery keeps favoring the original stream's
+  // priority.
+  SpdyPriority priority;
+
+  // Cold fields, needed only when a packet is retransmitted or its data is
+  // finally acked.
+  QuicFrames retransmittable_frames;
+  // Owned.  Non-null only when a listener registered for this packet; kept
+  // out of line because the inline list header dominated the struct while
+  // nearly every packet's list was empty. Use |mutable_ack_listeners| to
+  // populate.
+  std::list<AckListenerWrapper>* ack_listeners;
+  // Non-null when the payloads of |retransmittable_frames| live in one
+  // contiguous arena block instead of individual heap allocations. Such
+  // frames must not be passed to DeleteFrames; dropping the arena reference
+  // releases them.
+  QuicReferenceCountedPointer<QuicFrameArena> frame_arena;
 };
 // TODO(ianswett): Add static_assert when size of this struct is reduced below
 // 64 bytes.
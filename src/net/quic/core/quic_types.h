@@ -217,11 +217,21 @@ enum CongestionControlType {
   kPCC
 };
 
+// The two-bit ECN codepoint from a received packet's IP header.
+enum QuicEcnCodepoint {
+  ECN_NOT_ECT = 0,
+  ECN_ECT1 = 1,
+  ECN_ECT0 = 2,
+  ECN_CE = 3,
+};
+
 enum LossDetectionType {
   kNack,          // Used to mimic TCP's loss detection.
   kTime,          // Time based loss detection.
   kAdaptiveTime,  // Adaptive time based loss detection.
   kLazyFack,      // Nack based but with FACK disabled for the first ack.
+  kAdaptiveNack,  // Nack based with a reordering threshold which adapts to
+                  // spurious retransmits.
 };
 
 // EncryptionLevel enumerates the stages of encryption that a QUIC connection
@@ -4,12 +4,31 @@
 
 #include "net/quic/core/quic_unacked_packet_map.h"
 
+#include <utility>
+
 #include "net/quic/core/quic_connection_stats.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/quic/platform/api/quic_flag_utils.h"
+#include "net/quic/platform/api/quic_flags.h"
 
 namespace net {
 
+namespace {
+
+// Releases |info|'s retransmittable frames, whether they live in an arena
+// or as individual heap allocations.
+void ReleaseFrames(QuicTransmissionInfo* info) {
+  if (info->frame_arena != nullptr) {
+    info->retransmittable_frames.clear();
+    info->frame_arena = nullptr;
+    return;
+  }
+  DeleteFrames(&info->retransmittable_frames);
+}
+
+}  // namespace
+
 QuicUnackedPacketMap::QuicUnackedPacketMap()
     : largest_sent_packet_(0),
       largest_sent_retransmittable_packet_(0),
@@ -21,7 +40,7 @@ QuicUnackedPacketMap::QuicUnackedPacketMap()
 
 QuicUnackedPacketMap::~QuicUnackedPacketMap() {
   for (QuicTransmissionInfo& transmission_info : unacked_packets_) {
-    DeleteFrames(&(transmission_info.retransmittable_frames));
+    ReleaseFrames(&transmission_info);
   }
 }
 
@@ -45,6 +64,7 @@ void QuicUnackedPacketMap::AddSentPacket(SerializedPacket* packet,
       packet->encryption_level, packet->packet_number_length, transmission_type,
       sent_time, bytes_sent, has_crypto_handshake, packet->num_padding_bytes);
   info.largest_acked = packet->largest_acked;
+  info.priority = packet->priority;
   if (old_packet_number > 0) {
     TransferRetransmissionInfo(old_packet_number, packet_number,
                                transmission_type, &info);
@@ -66,7 +86,16 @@ void QuicUnackedPacketMap::AddSentPacket(SerializedPacket* packet,
 
     packet->retransmittable_frames.swap(
         unacked_packets_.back().retransmittable_frames);
-    unacked_packets_.back().ack_listeners.swap(packet->listeners);
+    if (!packet->listeners.empty()) {
+      unacked_packets_.back().mutable_ack_listeners()->swap(packet->listeners);
+    }
+    if (FLAGS_quic_reloadable_flag_quic_arena_retransmittable_frames) {
+      QUIC_FLAG_COUNT(quic_reloadable_flag_quic_arena_retransmittable_frames);
+      // Compact the frame payloads into one block so acks touch contiguous
+      // memory and the per-frame heap allocations are released now.
+      unacked_packets_.back().frame_arena =
+          QuicFrameArena::Relocate(&unacked_packets_.back().retransmittable_frames);
+    }
   }
 }
 
@@ -110,18 +139,26 @@ void QuicUnackedPacketMap::TransferRetransmissionInfo(
       }
     }
   }
-  for (AckListenerWrapper& wrapper : transmission_info->ack_listeners) {
-    wrapper.ack_listener->OnPacketRetransmitted(wrapper.length);
+  if (transmission_info->ack_listeners != nullptr) {
+    for (AckListenerWrapper& wrapper : *transmission_info->ack_listeners) {
+      wrapper.ack_listener->OnPacketRetransmitted(wrapper.length);
+    }
   }
 
   // Swap the frames and preserve num_padding_bytes and has_crypto_handshake.
   frames->swap(info->retransmittable_frames);
+  // The arena owning the frame payloads moves with the frames.
+  info->frame_arena = transmission_info->frame_arena;
+  transmission_info->frame_arena = nullptr;
   info->has_crypto_handshake = transmission_info->has_crypto_handshake;
   transmission_info->has_crypto_handshake = false;
   info->num_padding_bytes = transmission_info->num_padding_bytes;
+  // Retransmissions carry the original stream data, so they keep its
+  // priority.
+  info->priority = transmission_info->priority;
 
   // Transfer the AckListeners if any are present.
-  info->ack_listeners.swap(transmission_info->ack_listeners);
+  std::swap(info->ack_listeners, transmission_info->ack_listeners);
   QUIC_BUG_IF(frames == nullptr)
       << "Attempt to retransmit packet with no "
       << "retransmittable frames: " << old_packet_number;
@@ -160,7 +197,7 @@ void QuicUnackedPacketMap::RemoveRetransmittability(
     --pending_crypto_packet_count_;
     info->has_crypto_handshake = false;
   }
-  DeleteFrames(&info->retransmittable_frames);
+  ReleaseFrames(info);
 }
 
 void QuicUnackedPacketMap::RemoveRetransmittability(
@@ -234,7 +271,9 @@ void QuicUnackedPacketMap::NotifyAndClearListeners(
   DCHECK_LT(packet_number, least_unacked_ + unacked_packets_.size());
   QuicTransmissionInfo* info =
       &unacked_packets_[packet_number - least_unacked_];
-  NotifyAndClearListeners(&info->ack_listeners, ack_delay_time);
+  if (info->ack_listeners != nullptr) {
+    NotifyAndClearListeners(info->ack_listeners, ack_delay_time);
+  }
 }
 
 void QuicUnackedPacketMap::RemoveFromInFlight(QuicTransmissionInfo* info) {
@@ -281,7 +320,12 @@ void QuicUnackedPacketMap::CancelRetransmissionsForStream(
         stream_notifier_->OnStreamFrameDiscarded(*frame.stream_frame);
       }
     }
-    RemoveFramesForStream(frames, stream_id);
+    if (it->frame_arena != nullptr) {
+      // Arena-backed payloads stay alive until the arena is released.
+      DropFramesForStream(frames, stream_id);
+    } else {
+      RemoveFramesForStream(frames, stream_id);
+    }
     if (frames->empty()) {
       RemoveRetransmittability(packet_number);
     }
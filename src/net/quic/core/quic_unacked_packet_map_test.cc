@@ -4,6 +4,7 @@
 
 #include "net/quic/core/quic_unacked_packet_map.h"
 
+#include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_test.h"
 #include "net/quic/test_tools/quic_test_utils.h"
 
@@ -217,6 +218,34 @@ TEST_F(QuicUnackedPacketMapTest, StopRetransmissionAfterRetransmission) {
   VerifyRetransmittablePackets(nullptr, 0);
 }
 
+TEST_F(QuicUnackedPacketMapTest, ArenaBackedFrames) {
+  FLAGS_quic_reloadable_flag_quic_arena_retransmittable_frames = true;
+  const QuicStreamId stream_id = 2;
+  SerializedPacket packet1(CreateRetransmittablePacketForStream(1, stream_id));
+  unacked_packets_.AddSentPacket(&packet1, 0, NOT_RETRANSMISSION, now_, true);
+
+  // The frame payload was relocated into an arena owned by the packet.
+  const QuicTransmissionInfo& info1 = unacked_packets_.GetTransmissionInfo(1);
+  EXPECT_NE(nullptr, info1.frame_arena);
+  EXPECT_EQ(stream_id, info1.retransmittable_frames[0].stream_frame->stream_id);
+
+  // Retransmission moves the frames and their arena to the new packet.
+  EXPECT_CALL(notifier_, OnStreamFrameRetransmitted(_)).Times(1);
+  SerializedPacket packet2(CreateNonRetransmittablePacket(2));
+  unacked_packets_.AddSentPacket(&packet2, 1, LOSS_RETRANSMISSION, now_, true);
+  EXPECT_EQ(nullptr, unacked_packets_.GetTransmissionInfo(1).frame_arena);
+  const QuicTransmissionInfo& info2 = unacked_packets_.GetTransmissionInfo(2);
+  EXPECT_NE(nullptr, info2.frame_arena);
+  EXPECT_EQ(stream_id, info2.retransmittable_frames[0].stream_frame->stream_id);
+
+  // Cancelling the stream drops the frames without freeing arena storage,
+  // and losing retransmittability releases the arena.
+  EXPECT_CALL(notifier_, OnStreamFrameDiscarded(_)).Times(1);
+  unacked_packets_.CancelRetransmissionsForStream(stream_id);
+  VerifyRetransmittablePackets(nullptr, 0);
+  EXPECT_EQ(nullptr, unacked_packets_.GetTransmissionInfo(2).frame_arena);
+}
+
 TEST_F(QuicUnackedPacketMapTest, RetransmittedPacket) {
   // Simulate a retransmittable packet being sent, retransmitted, and the first
   // transmission being acked.
@@ -134,6 +134,58 @@ void QuicUtils::SerializeUint128Short(uint128 v, uint8_t* out) {
   memcpy(out + sizeof(lo), &hi, sizeof(hi) / 2);
 }
 
+// static
+bool QuicUtils::BytesEqual(const void* a, const void* b, size_t len) {
+  const char* pa = static_cast<const char*>(a);
+  const char* pb = static_cast<const char*>(b);
+  // memcpy compiles to a plain (possibly unaligned) load on the platforms we
+  // target, so each iteration is two loads and a compare.
+  while (len >= sizeof(uint64_t)) {
+    uint64_t wa;
+    uint64_t wb;
+    memcpy(&wa, pa, sizeof(wa));
+    memcpy(&wb, pb, sizeof(wb));
+    if (wa != wb) {
+      return false;
+    }
+    pa += sizeof(uint64_t);
+    pb += sizeof(uint64_t);
+    len -= sizeof(uint64_t);
+  }
+  while (len > 0) {
+    if (*pa++ != *pb++) {
+      return false;
+    }
+    --len;
+  }
+  return true;
+}
+
+// static
+bool QuicUtils::ConstantTimeBytesEqual(const void* a,
+                                       const void* b,
+                                       size_t len) {
+  const char* pa = static_cast<const char*>(a);
+  const char* pb = static_cast<const char*>(b);
+  uint64_t diff = 0;
+  while (len >= sizeof(uint64_t)) {
+    uint64_t wa;
+    uint64_t wb;
+    memcpy(&wa, pa, sizeof(wa));
+    memcpy(&wb, pb, sizeof(wb));
+    diff |= wa ^ wb;
+    pa += sizeof(uint64_t);
+    pb += sizeof(uint64_t);
+    len -= sizeof(uint64_t);
+  }
+  while (len > 0) {
+    diff |= static_cast<uint64_t>(static_cast<uint8_t>(*pa++) ^
+                                  static_cast<uint8_t>(*pb++));
+    --len;
+  }
+  return diff == 0;
+}
+
 #define RETURN_STRING_LITERAL(x) \
   case x:                        \
     return #x;
@@ -45,6 +45,18 @@ class QUIC_EXPORT_PRIVATE QuicUtils {
   // to |out|.
   static void SerializeUint128Short(uint128 v, uint8_t* out);
 
+  // Returns true if the |len| bytes at |a| and |b| are equal. Compares a
+  // machine word at a time, exiting on the first mismatch, so it beats
+  // memcmp for the short runs the framer compares (connection ids, parse
+  // templates, tags). Do not use when either input derives from secret
+  // material; see ConstantTimeBytesEqual().
+  static bool BytesEqual(const void* a, const void* b, size_t len);
+
+  // Like BytesEqual(), but always examines all |len| bytes so timing does
+  // not reveal the position of the first mismatch. Use for comparisons
+  // involving secrets (nonces, tokens, MACs).
+  static bool ConstantTimeBytesEqual(const void* a, const void* b, size_t len);
+
   // Returns the level of encryption as a char*
   static const char* EncryptionLevelToString(EncryptionLevel level);
 
@@ -100,6 +100,23 @@ TEST_F(QuicUtilsTest, ReferenceTest) {
                 reinterpret_cast<const char*>(data.data()), data.size())));
 }
 
+TEST_F(QuicUtilsTest, BytesEqual) {
+  // Exercise lengths below, at, and past the word-at-a-time stride, with
+  // mismatches in both the word loop and the byte tail.
+  for (size_t len = 0; len <= 24; ++len) {
+    std::vector<char> a(len, 'x');
+    std::vector<char> b(a);
+    EXPECT_TRUE(QuicUtils::BytesEqual(a.data(), b.data(), len));
+    EXPECT_TRUE(QuicUtils::ConstantTimeBytesEqual(a.data(), b.data(), len));
+    for (size_t i = 0; i < len; ++i) {
+      b[i] = 'y';
+      EXPECT_FALSE(QuicUtils::BytesEqual(a.data(), b.data(), len));
+      EXPECT_FALSE(QuicUtils::ConstantTimeBytesEqual(a.data(), b.data(), len));
+      b[i] = 'x';
+    }
+  }
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
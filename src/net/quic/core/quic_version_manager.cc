@@ -4,8 +4,14 @@
 
 #include "net/quic/core/quic_version_manager.h"
 
+#include <cstring>
+
+#include "net/quic/core/quic_constants.h"
+#include "net/quic/core/quic_data_writer.h"
+#include "net/quic/core/quic_framer.h"
 #include "net/quic/core/quic_versions.h"
 #include "net/quic/platform/api/quic_flags.h"
+#include "net/quic/platform/api/quic_ptr_util.h"
 
 namespace net {
 
@@ -26,6 +32,28 @@ const QuicVersionVector& QuicVersionManager::GetSupportedVersions() {
   return filtered_supported_versions_;
 }
 
+std::unique_ptr<QuicEncryptedPacket>
+QuicVersionManager::GetVersionNegotiationPacket(QuicConnectionId connection_id) {
+  MaybeRefilterSupportedVersions();
+  if (version_negotiation_template_.empty() ||
+      version_negotiation_template_versions_ != filtered_supported_versions_) {
+    std::unique_ptr<QuicEncryptedPacket> packet =
+        QuicFramer::BuildVersionNegotiationPacket(0,
+                                                  filtered_supported_versions_);
+    version_negotiation_template_.assign(packet->data(), packet->length());
+    version_negotiation_template_versions_ = filtered_supported_versions_;
+  }
+
+  const size_t len = version_negotiation_template_.length();
+  char* buffer = new char[len];
+  memcpy(buffer, version_negotiation_template_.data(), len);
+  // Patch in the connection ID; it sits right after the public flags byte.
+  QuicDataWriter writer(sizeof(connection_id), buffer + kPublicFlagsSize,
+                        Perspective::IS_SERVER, NETWORK_BYTE_ORDER);
+  writer.WriteConnectionId(connection_id);
+  return QuicMakeUnique<QuicEncryptedPacket>(buffer, len, true);
+}
+
 void QuicVersionManager::MaybeRefilterSupportedVersions() {
   if (enable_version_41_ != GetQuicFlag(FLAGS_quic_enable_version_41) ||
       enable_version_40_ != GetQuicFlag(FLAGS_quic_enable_version_40) ||
@@ -5,6 +5,10 @@
 #ifndef NET_QUIC_CORE_QUIC_VERSION_MANAGER_H_
 #define NET_QUIC_CORE_QUIC_VERSION_MANAGER_H_
 
+#include <memory>
+#include <string>
+
+#include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_versions.h"
 #include "net/quic/platform/api/quic_export.h"
 
@@ -19,6 +23,13 @@ class QUIC_EXPORT_PRIVATE QuicVersionManager {
   // Returns currently supported QUIC versions.
   const QuicVersionVector& GetSupportedVersions();
 
+  // Returns a serialized version negotiation packet for |connection_id|
+  // listing the currently supported versions. The packet bytes are
+  // precomputed once per supported-version-list revision, so each call costs
+  // a copy plus a connection ID patch instead of a full serialization.
+  std::unique_ptr<QuicEncryptedPacket> GetVersionNegotiationPacket(
+      QuicConnectionId connection_id);
+
  protected:
   // Maybe refilter filtered_supported_versions_ based on flags.
   void MaybeRefilterSupportedVersions();
@@ -46,6 +57,12 @@ class QUIC_EXPORT_PRIVATE QuicVersionManager {
   // This vector contains QUIC versions which are currently supported based on
   // flags.
   QuicVersionVector filtered_supported_versions_;
+  // Serialized version negotiation packet with a zeroed connection ID,
+  // rebuilt whenever the filtered version list changes. Empty until the
+  // first GetVersionNegotiationPacket() call.
+  std::string version_negotiation_template_;
+  // The versions |version_negotiation_template_| was built from.
+  QuicVersionVector version_negotiation_template_versions_;
 };
 
 }  // namespace net
@@ -4,6 +4,10 @@
 
 #include "net/quic/core/quic_version_manager.h"
 
+#include <cstring>
+#include <memory>
+
+#include "net/quic/core/quic_framer.h"
 #include "net/quic/core/quic_versions.h"
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_test.h"
@@ -77,6 +81,39 @@ TEST_F(QuicVersionManagerTest, QuicVersionManager) {
   EXPECT_EQ(QUIC_VERSION_35, manager.GetSupportedVersions()[5]);
 }
 
+TEST_F(QuicVersionManagerTest, GetVersionNegotiationPacket) {
+  FLAGS_quic_reloadable_flag_quic_disable_version_36 = false;
+  QuicVersionManager manager(AllSupportedVersions());
+
+  // The cached packet must be byte-identical to a freshly built one.
+  const QuicConnectionId kConnectionId = UINT64_C(0x0123456789abcdef);
+  std::unique_ptr<QuicEncryptedPacket> cached =
+      manager.GetVersionNegotiationPacket(kConnectionId);
+  std::unique_ptr<QuicEncryptedPacket> built =
+      QuicFramer::BuildVersionNegotiationPacket(kConnectionId,
+                                                manager.GetSupportedVersions());
+  ASSERT_EQ(built->length(), cached->length());
+  EXPECT_EQ(0, memcmp(built->data(), cached->data(), built->length()));
+
+  // A second ID reuses the template but patches the connection ID.
+  std::unique_ptr<QuicEncryptedPacket> second =
+      manager.GetVersionNegotiationPacket(42);
+  built = QuicFramer::BuildVersionNegotiationPacket(
+      42, manager.GetSupportedVersions());
+  ASSERT_EQ(built->length(), second->length());
+  EXPECT_EQ(0, memcmp(built->data(), second->data(), built->length()));
+
+  // A flag change shrinks the version list; the template must follow.
+  FLAGS_quic_reloadable_flag_quic_disable_version_36 = true;
+  std::unique_ptr<QuicEncryptedPacket> refiltered =
+      manager.GetVersionNegotiationPacket(kConnectionId);
+  built = QuicFramer::BuildVersionNegotiationPacket(
+      kConnectionId, manager.GetSupportedVersions());
+  ASSERT_EQ(built->length(), refiltered->length());
+  EXPECT_EQ(0, memcmp(built->data(), refiltered->data(), built->length()));
+  EXPECT_LT(refiltered->length(), cached->length());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace net
@@ -7,11 +7,12 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include "base/macros.h"
+#include "net/quic/core/quic_bucketed_write_scheduler.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/platform/api/quic_export.h"
-#include "net/spdy/core/priority_write_scheduler.h"
 
 namespace net {
 
@@ -19,15 +20,12 @@ namespace net {
 // priority.  QUIC stream priority order is:
 // Crypto stream > Headers stream > Data streams by requested priority.
 class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
- private:
-  typedef PriorityWriteScheduler<QuicStreamId> QuicPriorityWriteScheduler;
-
  public:
   QuicWriteBlockedList();
   ~QuicWriteBlockedList();
 
   bool HasWriteBlockedDataStreams() const {
-    return priority_write_scheduler_.HasReadyStreams();
+    return bucketed_scheduler_.HasReadyStreams();
   }
 
   bool HasWriteBlockedCryptoOrHeadersStream() const {
@@ -35,7 +33,7 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
   }
 
   size_t NumBlockedStreams() const {
-    size_t num_blocked = priority_write_scheduler_.NumReadyStreams();
+    size_t num_blocked = bucketed_scheduler_.NumReadyStreams();
     if (crypto_stream_blocked_) {
       ++num_blocked;
     }
@@ -60,7 +58,16 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
       return true;  // All data streams yield to the headers stream.
     }
 
-    return priority_write_scheduler_.ShouldYield(id);
+    return bucketed_scheduler_.ShouldYield(id);
+  }
+
+  // Batching hint: the number of data streams that will be popped
+  // consecutively from the highest-priority non-empty bucket, letting
+  // callers pull several streams per pass without re-consulting the
+  // scheduler. Does not account for the crypto or headers streams, which
+  // are always popped first.
+  size_t NumBlockedStreamsAtNextPriority() const {
+    return bucketed_scheduler_.NumReadyStreamsAtNextPriority();
   }
 
   // Pops the highest priorty stream, special casing crypto and headers streams.
@@ -76,13 +83,12 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
       return kHeadersStreamId;
     }
 
-    const auto id_and_precedence =
-        priority_write_scheduler_.PopNextReadyStreamAndPrecedence();
-    const QuicStreamId id = std::get<0>(id_and_precedence);
-    const SpdyPriority priority =
-        std::get<1>(id_and_precedence).spdy3_priority();
+    const auto id_and_priority =
+        bucketed_scheduler_.PopNextReadyStreamAndPriority();
+    const QuicStreamId id = std::get<0>(id_and_priority);
+    const SpdyPriority priority = std::get<1>(id_and_priority);
 
-    if (!priority_write_scheduler_.HasReadyStreams()) {
+    if (!bucketed_scheduler_.HasReadyStreams()) {
       // If no streams are blocked, don't bother latching.  This stream will be
       // the first popped for its priority anyway.
       batch_write_stream_id_[priority] = 0;
@@ -97,18 +103,71 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
     return id;
   }
 
+  // Pops up to |max_streams| streams in scheduling order, appending them to
+  // |batch| and returning the number popped. The crypto and headers streams
+  // are popped first; the remainder drains the highest-priority non-empty
+  // bucket, with the same latching as repeated PopFront() calls. A stream
+  // that re-blocks while an already-popped batch is being serviced is
+  // scheduled behind the batch rather than within it.
+  size_t PopFrontBatch(size_t max_streams, std::vector<QuicStreamId>* batch) {
+    size_t num_popped = 0;
+    if (num_popped < max_streams && crypto_stream_blocked_) {
+      crypto_stream_blocked_ = false;
+      batch->push_back(kCryptoStreamId);
+      ++num_popped;
+    }
+    if (num_popped < max_streams && headers_stream_blocked_) {
+      headers_stream_blocked_ = false;
+      batch->push_back(kHeadersStreamId);
+      ++num_popped;
+    }
+    if (num_popped == max_streams ||
+        !bucketed_scheduler_.HasReadyStreams()) {
+      return num_popped;
+    }
+
+    const size_t first_data_index = batch->size();
+    SpdyPriority priority = kV3LowestPriority;
+    num_popped += bucketed_scheduler_.PopReadyBatch(max_streams - num_popped,
+                                                    batch, &priority);
+    // Replay PopFront()'s latching for each popped data stream so the batch
+    // leaves the same latch state behind.
+    for (size_t i = first_data_index; i < batch->size(); ++i) {
+      const QuicStreamId id = (*batch)[i];
+      const bool more_ready = i + 1 < batch->size() ||
+                              bucketed_scheduler_.HasReadyStreams();
+      if (!more_ready) {
+        batch_write_stream_id_[priority] = 0;
+        last_priority_popped_ = priority;
+      } else if (batch_write_stream_id_[priority] != id) {
+        batch_write_stream_id_[priority] = id;
+        bytes_left_for_batch_write_[priority] = 16000;
+        last_priority_popped_ = priority;
+      }
+    }
+    return num_popped;
+  }
+
   void RegisterStream(QuicStreamId stream_id, SpdyPriority priority) {
-    priority_write_scheduler_.RegisterStream(stream_id,
-                                             SpdyStreamPrecedence(priority));
+    bucketed_scheduler_.RegisterStream(stream_id, priority);
   }
 
   void UnregisterStream(QuicStreamId stream_id) {
-    priority_write_scheduler_.UnregisterStream(stream_id);
+    bucketed_scheduler_.UnregisterStream(stream_id);
   }
 
   void UpdateStreamPriority(QuicStreamId stream_id, SpdyPriority new_priority) {
-    priority_write_scheduler_.UpdateStreamPrecedence(
-        stream_id, SpdyStreamPrecedence(new_priority));
+    bucketed_scheduler_.UpdateStreamPriority(stream_id, new_priority);
+  }
+
+  // Returns |stream_id|'s registered priority. The crypto and headers
+  // streams are not registered with the scheduler but always write at the
+  // highest priority.
+  SpdyPriority GetStreamPriority(QuicStreamId stream_id) const {
+    if (stream_id == kCryptoStreamId || stream_id == kHeadersStreamId) {
+      return kV3HighestPriority;
+    }
+    return bucketed_scheduler_.GetStreamPriority(stream_id);
   }
 
   void UpdateBytesForStream(QuicStreamId stream_id, size_t bytes) {
@@ -139,7 +198,7 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
     bool push_front =
         stream_id == batch_write_stream_id_[last_priority_popped_] &&
         bytes_left_for_batch_write_[last_priority_popped_] > 0;
-    priority_write_scheduler_.MarkStreamReady(stream_id, push_front);
+    bucketed_scheduler_.MarkStreamReady(stream_id, push_front);
 
     return;
   }
@@ -148,7 +207,7 @@ class QUIC_EXPORT_PRIVATE QuicWriteBlockedList {
   bool headers_stream_blocked() const { return headers_stream_blocked_; }
 
  private:
-  QuicPriorityWriteScheduler priority_write_scheduler_;
+  QuicBucketedWriteScheduler bucketed_scheduler_;
 
   // If performing batch writes, this will be the stream ID of the stream doing
   // batch writes for this priority level.  We will allow this stream to write
@@ -51,6 +51,45 @@ TEST_F(QuicWriteBlockedListTest, PriorityOrder) {
   EXPECT_FALSE(write_blocked_list.HasWriteBlockedDataStreams());
 }
 
+TEST_F(QuicWriteBlockedListTest, PopFrontBatch) {
+  QuicWriteBlockedList write_blocked_list;
+
+  write_blocked_list.RegisterStream(40, kV3LowestPriority);
+  write_blocked_list.RegisterStream(23, kV3HighestPriority);
+  write_blocked_list.RegisterStream(17, kV3HighestPriority);
+  write_blocked_list.RegisterStream(kHeadersStreamId, kV3HighestPriority);
+  write_blocked_list.RegisterStream(kCryptoStreamId, kV3HighestPriority);
+
+  write_blocked_list.AddStream(40);
+  write_blocked_list.AddStream(23);
+  write_blocked_list.AddStream(17);
+  write_blocked_list.AddStream(kHeadersStreamId);
+  write_blocked_list.AddStream(kCryptoStreamId);
+
+  // The crypto and headers streams lead the batch, followed by the
+  // highest-priority bucket in insertion order. The low priority stream is
+  // left for a later batch even though the requested size has room for it.
+  std::vector<QuicStreamId> batch;
+  EXPECT_EQ(4u, write_blocked_list.PopFrontBatch(5, &batch));
+  EXPECT_EQ(std::vector<QuicStreamId>({kCryptoStreamId, kHeadersStreamId, 23,
+                                       17}),
+            batch);
+  EXPECT_EQ(1u, write_blocked_list.NumBlockedStreams());
+
+  batch.clear();
+  EXPECT_EQ(1u, write_blocked_list.PopFrontBatch(5, &batch));
+  EXPECT_EQ(std::vector<QuicStreamId>({40}), batch);
+  EXPECT_EQ(0u, write_blocked_list.NumBlockedStreams());
+
+  // A batch is capped at the requested number of streams.
+  write_blocked_list.AddStream(23);
+  write_blocked_list.AddStream(17);
+  batch.clear();
+  EXPECT_EQ(1u, write_blocked_list.PopFrontBatch(1, &batch));
+  EXPECT_EQ(std::vector<QuicStreamId>({23}), batch);
+  EXPECT_EQ(17u, write_blocked_list.PopFront());
+}
+
 TEST_F(QuicWriteBlockedListTest, CryptoStream) {
   QuicWriteBlockedList write_blocked_list;
   write_blocked_list.RegisterStream(kCryptoStreamId, kV3HighestPriority);
@@ -40,6 +40,12 @@ using QuicSmallMap = QuicSmallMapImpl<Key, Value, Size>;
 template <typename T>
 using QuicIntervalSet = QuicIntervalSetImpl<T>;
 
+// A vector which provides inline storage for a small number of elements and
+// only heap-allocates once it grows beyond that. Copies are deep; moving is
+// no cheaper than copying.
+template <typename T, size_t Size>
+using QuicStackVector = QuicStackVectorImpl<T, Size>;
+
 }  // namespace net
 
 #endif  // NET_QUIC_PLATFORM_API_QUIC_CONTAINERS_H_
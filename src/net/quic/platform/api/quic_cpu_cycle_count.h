@@ -0,0 +1,22 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_QUIC_PLATFORM_API_QUIC_CPU_CYCLE_COUNT_H_
+#define NET_QUIC_PLATFORM_API_QUIC_CPU_CYCLE_COUNT_H_
+
+#include "net/quic/platform/impl/quic_cpu_cycle_count_impl.h"
+
+namespace net {
+
+// Returns a monotonically increasing CPU cycle (or equivalent fixed-rate)
+// counter, for cheap duration accounting on hot paths. Returns 0 on
+// platforms without a cheap counter, in which case deltas are zero and
+// cycle accounting is effectively disabled.
+inline uint64_t QuicCpuCycleCount() {
+  return QuicCpuCycleCountImpl();
+}
+
+}  // namespace net
+
+#endif  // NET_QUIC_PLATFORM_API_QUIC_CPU_CYCLE_COUNT_H_
@@ -21,7 +21,12 @@
   QUIC_LOG_EVERY_N_SEC_IMPL(severity, seconds)
 #define QUIC_LOG_IF(severity, condition) QUIC_LOG_IF_IMPL(severity, condition)
 
+// Branch prediction hints for validated-input fast paths: wrap conditions
+// that are overwhelmingly false (error and bug checks) in QUIC_PREDICT_FALSE
+// and overwhelmingly true conditions in QUIC_PREDICT_TRUE so the common case
+// falls through without a taken branch.
 #define QUIC_PREDICT_FALSE(x) QUIC_PREDICT_FALSE_IMPL(x)
+#define QUIC_PREDICT_TRUE(x) QUIC_PREDICT_TRUE_IMPL(x)
 
 #define QUIC_NOTREACHED() QUIC_NOTREACHED_IMPL()
 
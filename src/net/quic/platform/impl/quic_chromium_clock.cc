@@ -4,11 +4,38 @@
 
 #include "net/quic/platform/impl/quic_chromium_clock.h"
 
+#include "base/lazy_instance.h"
 #include "base/memory/singleton.h"
+#include "base/threading/thread_local.h"
 #include "base/time/time.h"
 
 namespace net {
 
+namespace {
+
+// Points at the microsecond timestamp cached by the innermost
+// ScopedApproximateNow on the current thread, or nullptr if none is active.
+// The pointee lives in the scoper itself, so no per-event allocation is made.
+base::LazyInstance<base::ThreadLocalPointer<int64_t>>::Leaky
+    g_cached_approximate_now = LAZY_INSTANCE_INITIALIZER;
+
+int64_t NowInMicroseconds() {
+  return (base::TimeTicks::Now() - base::TimeTicks()).InMicroseconds();
+}
+
+}  // namespace
+
+QuicChromiumClock::ScopedApproximateNow::ScopedApproximateNow()
+    : cached_now_in_us_(NowInMicroseconds()),
+      previous_(g_cached_approximate_now.Pointer()->Get()) {
+  g_cached_approximate_now.Pointer()->Set(&cached_now_in_us_);
+}
+
+QuicChromiumClock::ScopedApproximateNow::~ScopedApproximateNow() {
+  DCHECK_EQ(&cached_now_in_us_, g_cached_approximate_now.Pointer()->Get());
+  g_cached_approximate_now.Pointer()->Set(previous_);
+}
+
 QuicChromiumClock* QuicChromiumClock::GetInstance() {
   return base::Singleton<QuicChromiumClock>::get();
 }
@@ -17,8 +44,9 @@ QuicChromiumClock::QuicChromiumClock() {}
 QuicChromiumClock::~QuicChromiumClock() {}
 
 QuicTime QuicChromiumClock::ApproximateNow() const {
-  // At the moment, Chrome does not have a distinct notion of ApproximateNow().
-  // We should consider implementing this using MessageLoop::recent_time_.
+  const int64_t* cached_now_in_us = g_cached_approximate_now.Pointer()->Get();
+  if (cached_now_in_us)
+    return CreateTimeFromMicroseconds(*cached_now_in_us);
   return Now();
 }
 
@@ -5,6 +5,9 @@
 #ifndef NET_QUIC_PLATFORM_IMPL_QUIC_CHROMIUM_CLOCK_H_
 #define NET_QUIC_PLATFORM_IMPL_QUIC_CHROMIUM_CLOCK_H_
 
+#include <stdint.h>
+
+#include "base/macros.h"
 #include "base/time/time.h"
 #include "net/quic/platform/api/quic_clock.h"
 #include "net/quic/platform/api/quic_export.h"
@@ -15,6 +18,26 @@ namespace net {
 // EpollServer.
 class QUIC_EXPORT_PRIVATE QuicChromiumClock : public QuicClock {
  public:
+  // While an instance is alive, ApproximateNow() calls made on the
+  // constructing thread return the time captured at construction instead of
+  // reading the clock, mirroring how the epoll server caches a timestamp for
+  // the duration of one event-loop iteration. Event handlers place one of
+  // these around the processing of a single event (an incoming packet, a
+  // firing alarm) so the many ApproximateNow() reads made while servicing it
+  // share one clock read. Scopers may be nested; the innermost one wins.
+  // Now() and WallNow() are unaffected and always read the clock.
+  class QUIC_EXPORT_PRIVATE ScopedApproximateNow {
+   public:
+    ScopedApproximateNow();
+    ~ScopedApproximateNow();
+
+   private:
+    int64_t cached_now_in_us_;
+    int64_t* previous_;  // Cached value of an enclosing scoper, if any.
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedApproximateNow);
+  };
+
   static QuicChromiumClock* GetInstance();
 
   QuicChromiumClock();
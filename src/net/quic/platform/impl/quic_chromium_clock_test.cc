@@ -20,6 +20,29 @@ TEST(QuicChromiumClockTest, Now) {
   EXPECT_LE(now, end);
 }
 
+TEST(QuicChromiumClockTest, ScopedApproximateNow) {
+  QuicChromiumClock clock;
+
+  QuicTime start = clock.Now();
+  {
+    QuicChromiumClock::ScopedApproximateNow outer;
+    QuicTime outer_now = clock.ApproximateNow();
+    EXPECT_LE(start, outer_now);
+    EXPECT_LE(outer_now, clock.Now());
+    // The cached value does not advance within the scope.
+    EXPECT_EQ(outer_now, clock.ApproximateNow());
+    {
+      // A nested scoper takes over, and the enclosing one is restored when it
+      // goes out of scope.
+      QuicChromiumClock::ScopedApproximateNow inner;
+      EXPECT_LE(outer_now, clock.ApproximateNow());
+    }
+    EXPECT_EQ(outer_now, clock.ApproximateNow());
+  }
+  // Without a scoper, ApproximateNow() falls back to reading the clock.
+  EXPECT_LE(start, clock.ApproximateNow());
+}
+
 TEST(QuicChromiumClockTest, WallNow) {
   QuicChromiumClock clock;
 
@@ -9,6 +9,7 @@
 #include <unordered_set>
 
 #include "base/containers/small_map.h"
+#include "base/containers/stack_container.h"
 #include "net/base/interval_set.h"
 #include "net/base/linked_hash_map.h"
 
@@ -47,6 +48,12 @@ using QuicSmallMapImpl = base::small_map<std::unordered_map<Key, Value>, Size>;
 template <typename T>
 using QuicIntervalSetImpl = IntervalSet<T>;
 
+// A vector which provides inline storage for |Size| elements and spills to the
+// heap beyond that. The underlying std::vector is reached via operator-> or
+// container().
+template <typename T, size_t Size>
+using QuicStackVectorImpl = base::StackVector<T, Size>;
+
 }  // namespace net
 
 #endif  // NET_QUIC_PLATFORM_IMPL_QUIC_CONTAINERS_IMPL_H_
@@ -5,6 +5,7 @@
 #ifndef NET_QUIC_PLATFORM_IMPL_QUIC_LOGGING_IMPL_H_
 #define NET_QUIC_PLATFORM_IMPL_QUIC_LOGGING_IMPL_H_
 
+#include "base/compiler_specific.h"
 #include "base/logging.h"
 
 #define QUIC_LOG_IMPL(severity) QUIC_CHROMIUM_LOG_##severity
@@ -53,7 +54,8 @@
 #define QUIC_CHROMIUM_DLOG_IF_0 QUIC_CHROMIUM_DLOG_IF_ERROR
 #endif
 
-#define QUIC_PREDICT_FALSE_IMPL(x) x
+#define QUIC_PREDICT_FALSE_IMPL(x) UNLIKELY(x)
+#define QUIC_PREDICT_TRUE_IMPL(x) LIKELY(x)
 
 #define QUIC_NOTREACHED_IMPL() NOTREACHED()
 
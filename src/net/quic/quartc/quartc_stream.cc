@@ -4,6 +4,7 @@
 
 #include "net/quic/quartc/quartc_stream.h"
 
+#include "net/quic/core/quic_connection.h"
 #include "net/quic/platform/api/quic_string_piece.h"
 
 namespace net {
@@ -13,19 +14,29 @@ QuartcStream::QuartcStream(QuicStreamId id, QuicSession* session)
 QuartcStream::~QuartcStream() {}
 
 void QuartcStream::OnDataAvailable() {
-  struct iovec iov;
-  while (sequencer()->GetReadableRegions(&iov, 1) == 1) {
-    DCHECK(delegate_);
-    delegate_->OnReceived(this, reinterpret_cast<const char*>(iov.iov_base),
-                          iov.iov_len);
-    sequencer()->MarkConsumed(iov.iov_len);
+  // Number of iovecs borrowed from the sequencer at a time; each one is handed
+  // to the delegate in place, so the data is never copied.
+  const size_t kMaxReadableRegions = 16;
+  struct iovec iovs[kMaxReadableRegions];
+  int num_regions;
+  while ((num_regions = sequencer()->GetReadableRegions(
+              iovs, kMaxReadableRegions)) > 0) {
+    size_t bytes_consumed = 0;
+    for (int i = 0; i < num_regions; ++i) {
+      DCHECK(delegate_);
+      delegate_->OnReceived(this,
+                            reinterpret_cast<const char*>(iovs[i].iov_base),
+                            iovs[i].iov_len);
+      bytes_consumed += iovs[i].iov_len;
+    }
+    sequencer()->MarkConsumed(bytes_consumed);
   }
   // All the data has been received if the sequencer is closed.
   // Notify the delegate by calling the callback function one more time with
   // iov_len = 0.
   if (sequencer()->IsClosed()) {
     OnFinRead();
-    delegate_->OnReceived(this, reinterpret_cast<const char*>(iov.iov_base), 0);
+    delegate_->OnReceived(this, nullptr, 0);
   }
 }
 
@@ -36,6 +47,9 @@ void QuartcStream::OnClose() {
 }
 
 void QuartcStream::OnCanWrite() {
+  if (CancelIfExpired()) {
+    return;
+  }
   QuicStream::OnCanWrite();
   DCHECK(delegate_);
   // Don't call the delegate if the write-side is closed or a fin is buffered.
@@ -68,6 +82,18 @@ int QuartcStream::connection_error() {
 void QuartcStream::Write(const char* data,
                          size_t size,
                          const WriteParameters& param) {
+  if (param.max_frame_lifetime_us >= 0) {
+    frame_deadline_ =
+        session()->connection()->clock()->ApproximateNow() +
+        QuicTime::Delta::FromMicroseconds(param.max_frame_lifetime_us);
+  }
+  if (CancelIfExpired()) {
+    return;
+  }
+  // Flush the frame as one burst of back-to-back packets, rather than letting
+  // it interleave with other streams' data at arbitrary packet boundaries.
+  QuicConnection::ScopedPacketBundler bundler(
+      session()->connection(), QuicConnection::SEND_ACK_IF_PENDING);
   struct iovec iov = {const_cast<char*>(data), size};
   WritevData(&iov, 1, param.fin, nullptr);
 }
@@ -84,6 +110,18 @@ void QuartcStream::Close() {
   QuicStream::session()->CloseStream(id());
 }
 
+bool QuartcStream::CancelIfExpired() {
+  if (!frame_deadline_.IsInitialized() ||
+      session()->connection()->clock()->ApproximateNow() < frame_deadline_) {
+    return false;
+  }
+  // The frame is stale. Resetting the stream cancels retransmission of any
+  // outstanding data and drops whatever is still queued, so fresher frames
+  // are not delayed behind it.
+  Reset(QUIC_STREAM_CANCELLED);
+  return true;
+}
+
 void QuartcStream::SetDelegate(QuartcStreamInterface::Delegate* delegate) {
   if (delegate_) {
     LOG(WARNING) << "The delegate for Stream " << id()
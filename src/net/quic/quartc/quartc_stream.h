@@ -7,6 +7,7 @@
 
 #include "net/quic/core/quic_session.h"
 #include "net/quic/core/quic_stream.h"
+#include "net/quic/core/quic_time.h"
 #include "net/quic/platform/api/quic_export.h"
 #include "net/quic/quartc/quartc_stream_interface.h"
 
@@ -51,7 +52,17 @@ class QUIC_EXPORT_PRIVATE QuartcStream : public QuicStream,
   void SetDelegate(QuartcStreamInterface::Delegate* delegate) override;
 
  private:
+  // Cancels the stream if its frame deadline has passed, so that stale data
+  // is dropped instead of being retransmitted ahead of fresher frames.
+  // Returns true if the stream was cancelled.
+  bool CancelIfExpired();
+
   QuartcStreamInterface::Delegate* delegate_ = nullptr;
+
+  // Deadline after which any undelivered data on this stream is stale. Set by
+  // Write() when the caller bounds the frame's lifetime; remains
+  // uninitialized for reliable streams.
+  QuicTime frame_deadline_ = QuicTime::Zero();
 };
 
 }  // namespace net
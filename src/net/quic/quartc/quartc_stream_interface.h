@@ -35,11 +35,17 @@ class QUIC_EXPORT_PRIVATE QuartcStreamInterface {
   virtual int connection_error() = 0;
 
   struct WriteParameters {
-    WriteParameters() : fin(false) {}
+    WriteParameters() : fin(false), max_frame_lifetime_us(-1) {}
     // |fin| is set to be true when there is no more data need to be send
     // through a particular stream. The receiving side will used it to determine
     // if the sender finish sending data.
     bool fin;
+    // When non-negative, the data written is a real-time frame that is only
+    // useful for this many microseconds. Once the deadline passes, data that
+    // has not been delivered is dropped instead of being retransmitted ahead
+    // of fresher frames, and the stream is cancelled. Intended for streams
+    // that carry a single media frame each.
+    int64_t max_frame_lifetime_us;
   };
 
   // Sends data reliably and in-order.  Returns the amount sent.
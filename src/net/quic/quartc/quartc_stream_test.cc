@@ -347,6 +347,42 @@ TEST_F(QuartcStreamTest, CloseStream) {
   EXPECT_TRUE(mock_stream_delegate_->closed());
 }
 
+// A frame whose lifetime has expired is dropped rather than retransmitted:
+// the stream cancels itself at the next write opportunity.
+TEST_F(QuartcStreamTest, ExpiredFrameCancelsStream) {
+  CreateReliableQuicStream();
+
+  QuartcStreamInterface::WriteParameters param;
+  param.max_frame_lifetime_us = 100;
+  stream_->Write("Foo bar", 7, param);
+  EXPECT_EQ("Foo bar", write_buffer_);
+  EXPECT_FALSE(stream_->rst_sent());
+
+  // Before the deadline, write opportunities behave as usual.
+  stream_->OnCanWrite();
+  EXPECT_FALSE(stream_->rst_sent());
+
+  // Once the deadline passes, the stream is cancelled instead of sending
+  // anything further.
+  clock_.AdvanceTime(QuicTime::Delta::FromMicroseconds(200));
+  stream_->OnCanWrite();
+  EXPECT_TRUE(stream_->rst_sent());
+  EXPECT_EQ(QUIC_STREAM_CANCELLED, stream_->stream_error());
+  EXPECT_EQ("Foo bar", write_buffer_);
+}
+
+// A write that happens after the frame deadline passes is dropped entirely.
+TEST_F(QuartcStreamTest, ExpiredWriteIsDropped) {
+  CreateReliableQuicStream();
+
+  clock_.AdvanceTime(QuicTime::Delta::FromMicroseconds(1000));
+  QuartcStreamInterface::WriteParameters param;
+  param.max_frame_lifetime_us = 0;
+  stream_->Write("Foo bar", 7, param);
+  EXPECT_EQ(0ul, write_buffer_.size());
+  EXPECT_TRUE(stream_->rst_sent());
+}
+
 // Both sending and receiving fin automatically closes a stream.
 TEST_F(QuartcStreamTest, CloseOnFins) {
   CreateReliableQuicStream();
@@ -4,6 +4,8 @@
 
 #include "net/quic/test_tools/quic_crypto_server_config_peer.h"
 
+#include <memory>
+
 #include "net/quic/test_tools/mock_clock.h"
 #include "net/quic/test_tools/mock_random.h"
 #include "net/quic/test_tools/quic_test_utils.h"
@@ -19,19 +21,20 @@ ProofSource* QuicCryptoServerConfigPeer::GetProofSource() {
 
 QuicReferenceCountedPointer<QuicCryptoServerConfig::Config>
 QuicCryptoServerConfigPeer::GetPrimaryConfig() {
-  QuicReaderMutexLock locked(&server_config_->configs_lock_);
   return QuicReferenceCountedPointer<QuicCryptoServerConfig::Config>(
-      server_config_->primary_config_);
+      server_config_->GetConfigsSnapshot()->primary_config);
 }
 
 QuicReferenceCountedPointer<QuicCryptoServerConfig::Config>
 QuicCryptoServerConfigPeer::GetConfig(string config_id) {
-  QuicReaderMutexLock locked(&server_config_->configs_lock_);
+  std::shared_ptr<const QuicCryptoServerConfig::ConfigsSnapshot> snapshot =
+      server_config_->GetConfigsSnapshot();
   if (config_id == "<primary>") {
     return QuicReferenceCountedPointer<QuicCryptoServerConfig::Config>(
-        server_config_->primary_config_);
+        snapshot->primary_config);
   } else {
-    return server_config_->GetConfigWithScid(config_id);
+    return QuicCryptoServerConfig::GetConfigWithScid(snapshot->configs,
+                                                     config_id);
   }
 }
 
@@ -96,15 +99,16 @@ string QuicCryptoServerConfigPeer::NewServerNonce(QuicRandom* rand,
 
 void QuicCryptoServerConfigPeer::CheckConfigs(
     std::vector<std::pair<string, bool>> expected_ids_and_status) {
-  QuicReaderMutexLock locked(&server_config_->configs_lock_);
+  std::shared_ptr<const QuicCryptoServerConfig::ConfigsSnapshot> snapshot =
+      server_config_->GetConfigsSnapshot();
 
-  ASSERT_EQ(expected_ids_and_status.size(), server_config_->configs_.size())
+  ASSERT_EQ(expected_ids_and_status.size(), snapshot->configs.size())
       << ConfigsDebug();
 
   for (const std::pair<
            const ServerConfigID,
            QuicReferenceCountedPointer<QuicCryptoServerConfig::Config>>& i :
-       server_config_->configs_) {
+       snapshot->configs) {
     bool found = false;
     for (std::pair<ServerConfigID, bool>& j : expected_ids_and_status) {
       if (i.first == j.first && i.second->is_primary == j.second) {
@@ -123,13 +127,15 @@ void QuicCryptoServerConfigPeer::CheckConfigs(
 // ConfigsDebug returns a string that contains debugging information about
 // the set of Configs loaded in |server_config_| and their status.
 string QuicCryptoServerConfigPeer::ConfigsDebug() {
-  if (server_config_->configs_.empty()) {
+  std::shared_ptr<const QuicCryptoServerConfig::ConfigsSnapshot> snapshot =
+      server_config_->GetConfigsSnapshot();
+  if (snapshot->configs.empty()) {
     return "No Configs in QuicCryptoServerConfig";
   }
 
   string s;
 
-  for (const auto& i : server_config_->configs_) {
+  for (const auto& i : snapshot->configs) {
     const QuicReferenceCountedPointer<QuicCryptoServerConfig::Config> config =
         i.second;
     if (config->is_primary) {
@@ -145,9 +151,7 @@ string QuicCryptoServerConfigPeer::ConfigsDebug() {
 }
 
 void QuicCryptoServerConfigPeer::SelectNewPrimaryConfig(int seconds) {
-  QuicWriterMutexLock locked(&server_config_->configs_lock_);
-  server_config_->SelectNewPrimaryConfig(
-      QuicWallTime::FromUNIXSeconds(seconds));
+  server_config_->PromotePrimaryConfig(QuicWallTime::FromUNIXSeconds(seconds));
 }
 
 string QuicCryptoServerConfigPeer::CompressChain(
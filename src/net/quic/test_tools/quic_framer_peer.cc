@@ -64,6 +64,9 @@ void QuicFramerPeer::SwapCrypters(QuicFramer* framer1, QuicFramer* framer2) {
   const bool framer2_latch = framer2->alternative_decrypter_latch_;
   framer2->alternative_decrypter_latch_ = framer1->alternative_decrypter_latch_;
   framer1->alternative_decrypter_latch_ = framer2_latch;
+
+  framer1->UpdateDecrypterSealed();
+  framer2->UpdateDecrypterSealed();
 }
 
 // static
@@ -77,5 +80,10 @@ QuicPacketNumber QuicFramerPeer::GetLastPacketNumber(QuicFramer* framer) {
   return framer->last_packet_number_;
 }
 
+// static
+bool QuicFramerPeer::DecrypterSealed(QuicFramer* framer) {
+  return framer->decrypter_sealed_;
+}
+
 }  // namespace test
 }  // namespace net
@@ -37,6 +37,8 @@ class QuicFramerPeer {
 
   static QuicPacketNumber GetLastPacketNumber(QuicFramer* framer);
 
+  static bool DecrypterSealed(QuicFramer* framer);
+
  private:
   DISALLOW_COPY_AND_ASSIGN(QuicFramerPeer);
 };
@@ -30,6 +30,13 @@ void QuicSpdySessionPeer::SetForceHolBlocking(QuicSpdySession* session,
   session->force_hol_blocking_ = value;
 }
 
+// static
+void QuicSpdySessionPeer::SetMultipleCompressionContexts(
+    QuicSpdySession* session,
+    bool value) {
+  session->multiple_compression_contexts_ = value;
+}
+
 // static
 const SpdyFramer& QuicSpdySessionPeer::GetSpdyFramer(
     QuicSpdySession* session) {
@@ -24,6 +24,8 @@ class QuicSpdySessionPeer {
   static void SetHeadersStream(QuicSpdySession* session,
                                QuicHeadersStream* headers_stream);
   static void SetForceHolBlocking(QuicSpdySession* session, bool value);
+  static void SetMultipleCompressionContexts(QuicSpdySession* session,
+                                             bool value);
   static const SpdyFramer& GetSpdyFramer(QuicSpdySession* session);
   static void SetHpackEncoderDebugVisitor(
       QuicSpdySession* session,
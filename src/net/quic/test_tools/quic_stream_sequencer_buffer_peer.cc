@@ -64,16 +64,16 @@ bool QuicStreamSequencerBufferPeer::CheckInitialState() {
 
 bool QuicStreamSequencerBufferPeer::CheckBufferInvariants() {
   QuicStreamOffset data_span =
-      buffer_->gaps_.back().begin_offset - buffer_->total_bytes_read_;
+      buffer_->gaps_->back().begin_offset - buffer_->total_bytes_read_;
   bool capacity_sane = data_span <= buffer_->max_buffer_capacity_bytes_ &&
                        data_span >= buffer_->num_bytes_buffered_;
   if (!capacity_sane) {
     QUIC_LOG(ERROR) << "data span is larger than capacity.";
     QUIC_LOG(ERROR) << "total read: " << buffer_->total_bytes_read_
-                    << " last byte: " << buffer_->gaps_.back().begin_offset;
+                    << " last byte: " << buffer_->gaps_->back().begin_offset;
   }
   bool total_read_sane =
-      buffer_->gaps_.front().begin_offset >= buffer_->total_bytes_read_;
+      buffer_->gaps_->front().begin_offset >= buffer_->total_bytes_read_;
   if (!total_read_sane) {
     QUIC_LOG(ERROR) << "read across 1st gap.";
   }
@@ -106,11 +106,11 @@ BufferBlock* QuicStreamSequencerBufferPeer::GetBlock(size_t index) {
 }
 
 int QuicStreamSequencerBufferPeer::GapSize() {
-  return buffer_->gaps_.size();
+  return buffer_->gaps_->size();
 }
 
 std::list<Gap> QuicStreamSequencerBufferPeer::GetGaps() {
-  return buffer_->gaps_;
+  return std::list<Gap>(buffer_->gaps_->begin(), buffer_->gaps_->end());
 }
 
 size_t QuicStreamSequencerBufferPeer::max_buffer_capacity() {
@@ -132,7 +132,7 @@ void QuicStreamSequencerBufferPeer::set_total_bytes_read(
 }
 
 void QuicStreamSequencerBufferPeer::set_gaps(const std::list<Gap>& gaps) {
-  buffer_->gaps_ = gaps;
+  buffer_->gaps_->assign(gaps.begin(), gaps.end());
 }
 
 bool QuicStreamSequencerBufferPeer::IsBufferAllocated() {
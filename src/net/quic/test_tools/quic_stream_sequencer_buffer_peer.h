@@ -5,6 +5,8 @@
 #ifndef NET_QUIC_TEST_TOOLS_QUIC_STREAM_SEQUENCER_BUFFER_PEER_H_
 #define NET_QUIC_TEST_TOOLS_QUIC_STREAM_SEQUENCER_BUFFER_PEER_H_
 
+#include <list>
+
 #include "net/quic/core/quic_stream_sequencer_buffer.h"
 
 namespace net {
@@ -77,6 +77,26 @@ void RecordIdleSocketFate(IdleSocketFate fate) {
                             IDLE_SOCKET_FATE_MAX);
 }
 
+// Tracks whether an idle socket was handed out on the first probe of the
+// group's |idle_sockets_| (the common keep-alive case) or only after
+// examining more of the list.
+// This enum is used to back an UMA histogram, and should therefore be
+// treated as append-only.
+enum IdleSocketReusePath {
+  // The newest idle socket was claimed on the first probe.
+  IDLE_SOCKET_REUSE_PATH_FAST = 0,
+  // More than one idle socket had to be examined.
+  IDLE_SOCKET_REUSE_PATH_SLOW = 1,
+
+  // Max value.
+  IDLE_SOCKET_REUSE_PATH_MAX = 2
+};
+
+void RecordIdleSocketReusePath(IdleSocketReusePath path) {
+  UMA_HISTOGRAM_ENUMERATION("Net.Socket.IdleSocketReusePath", path,
+                            IDLE_SOCKET_REUSE_PATH_MAX);
+}
+
 }  // namespace
 
 ConnectJob::ConnectJob(const std::string& group_name,
@@ -493,12 +513,20 @@ bool ClientSocketPoolBaseHelper::AssignIdleSocketToRequest(
   std::list<IdleSocket>* idle_sockets = group->mutable_idle_sockets();
   std::list<IdleSocket>::iterator idle_socket_it = idle_sockets->end();
 
-  // Iterate through the idle sockets forwards (oldest to newest)
-  //   * Delete any disconnected ones.
-  //   * If we find a used idle socket, assign to |idle_socket|.  At the end,
-  //   the |idle_socket_it| will be set to the newest used idle socket.
-  for (std::list<IdleSocket>::iterator it = idle_sockets->begin();
-       it != idle_sockets->end();) {
+  // Released sockets are appended to |idle_sockets|, so the newest - most
+  // recently used - socket is at the back. Iterate through the idle sockets
+  // backwards (newest to oldest) and stop at the first used socket, so that
+  // the common keep-alive case - reusing the socket that was just released -
+  // claims it on the first probe instead of walking the whole list.
+  //   * Delete any disconnected ones encountered along the way. Remaining
+  //   unusable sockets are reaped by CleanupIdleSockets(), which runs at the
+  //   start of every request.
+  //   * If we find a used idle socket, assign it to |idle_socket_it| and stop;
+  //   it is the newest used idle socket.
+  size_t sockets_examined = 0;
+  for (std::list<IdleSocket>::iterator it = idle_sockets->end();
+       it != idle_sockets->begin();) {
+    --it;
     // Check whether socket is usable. Note that it's unlikely that the socket
     // is not usuable because this function is always invoked after a
     // reusability check, but in theory socket can be closed asynchronously.
@@ -510,12 +538,12 @@ bool ClientSocketPoolBaseHelper::AssignIdleSocketToRequest(
       continue;
     }
 
+    ++sockets_examined;
     if (it->socket->WasEverUsed()) {
       // We found one we can reuse!
       idle_socket_it = it;
+      break;
     }
-
-    ++it;
   }
 
   // If we haven't found an idle socket, that means there are no used idle
@@ -526,6 +554,9 @@ bool ClientSocketPoolBaseHelper::AssignIdleSocketToRequest(
 
   if (idle_socket_it != idle_sockets->end()) {
     DecrementIdleCount();
+    RecordIdleSocketReusePath(sockets_examined == 1
+                                  ? IDLE_SOCKET_REUSE_PATH_FAST
+                                  : IDLE_SOCKET_REUSE_PATH_SLOW);
     base::TimeDelta idle_time =
         base::TimeTicks::Now() - idle_socket_it->start_time;
     IdleSocket idle_socket = *idle_socket_it;
@@ -1390,6 +1421,8 @@ ClientSocketPoolBaseHelper::Group::GetNextPendingRequest() const {
 
 bool ClientSocketPoolBaseHelper::Group::HasConnectJobForHandle(
     const ClientSocketHandle* handle) const {
+  if (pending_request_pointers_.find(handle) == pending_request_pointers_.end())
+    return false;
   // Search the first |jobs_.size()| pending requests for |handle|.
   // If it's farther back in the deque than that, it doesn't have a
   // corresponding ConnectJob.
@@ -1405,17 +1438,22 @@ bool ClientSocketPoolBaseHelper::Group::HasConnectJobForHandle(
 
 void ClientSocketPoolBaseHelper::Group::InsertPendingRequest(
     std::unique_ptr<Request> request) {
-  // This value must be cached before we release |request|.
+  // These values must be cached before we release |request|.
   RequestPriority priority = request->priority();
+  const ClientSocketHandle* handle = request->handle();
+  DCHECK(pending_request_pointers_.find(handle) ==
+         pending_request_pointers_.end());
+  RequestQueue::Pointer pointer;
   if (request->respect_limits() == ClientSocketPool::RespectLimits::DISABLED) {
     // Put requests with RespectLimits::DISABLED (which should have
     // priority == MAXIMUM_PRIORITY) ahead of other requests with
     // MAXIMUM_PRIORITY.
     DCHECK_EQ(priority, MAXIMUM_PRIORITY);
-    pending_requests_.InsertAtFront(request.release(), priority);
+    pointer = pending_requests_.InsertAtFront(request.release(), priority);
   } else {
-    pending_requests_.Insert(request.release(), priority);
+    pointer = pending_requests_.Insert(request.release(), priority);
   }
+  pending_request_pointers_[handle] = pointer;
 }
 
 std::unique_ptr<ClientSocketPoolBaseHelper::Request>
@@ -1428,43 +1466,37 @@ ClientSocketPoolBaseHelper::Group::PopNextPendingRequest() {
 std::unique_ptr<ClientSocketPoolBaseHelper::Request>
 ClientSocketPoolBaseHelper::Group::FindAndRemovePendingRequest(
     ClientSocketHandle* handle) {
-  for (RequestQueue::Pointer pointer = pending_requests_.FirstMax();
-       !pointer.is_null();
-       pointer = pending_requests_.GetNextTowardsLastMin(pointer)) {
-    if (pointer.value()->handle() == handle) {
-      DCHECK_EQ(static_cast<RequestPriority>(pointer.priority()),
-                pointer.value()->priority());
-      std::unique_ptr<Request> request = RemovePendingRequest(pointer);
-      return request;
-    }
-  }
-  return std::unique_ptr<ClientSocketPoolBaseHelper::Request>();
+  auto it = pending_request_pointers_.find(handle);
+  if (it == pending_request_pointers_.end())
+    return std::unique_ptr<ClientSocketPoolBaseHelper::Request>();
+  RequestQueue::Pointer pointer = it->second;
+  DCHECK_EQ(static_cast<RequestPriority>(pointer.priority()),
+            pointer.value()->priority());
+  return RemovePendingRequest(pointer);
 }
 
 void ClientSocketPoolBaseHelper::Group::SetPriority(ClientSocketHandle* handle,
                                                     RequestPriority priority) {
-  for (RequestQueue::Pointer pointer = pending_requests_.FirstMax();
-       !pointer.is_null();
-       pointer = pending_requests_.GetNextTowardsLastMin(pointer)) {
-    if (pointer.value()->handle() == handle) {
-      if (pointer.value()->priority() == priority)
-        return;
+  auto it = pending_request_pointers_.find(handle);
+  if (it == pending_request_pointers_.end()) {
+    // This function must be called with a valid ClientSocketHandle.
+    NOTREACHED();
+    return;
+  }
 
-      std::unique_ptr<Request> request = RemovePendingRequest(pointer);
+  RequestQueue::Pointer pointer = it->second;
+  if (pointer.value()->priority() == priority)
+    return;
 
-      // Requests that ignore limits much be created and remain at the highest
-      // priority, and should not be reprioritized.
-      DCHECK_EQ(request->respect_limits(),
-                ClientSocketPool::RespectLimits::ENABLED);
+  std::unique_ptr<Request> request = RemovePendingRequest(pointer);
 
-      request->set_priority(priority);
-      InsertPendingRequest(std::move(request));
-      return;
-    }
-  }
+  // Requests that ignore limits much be created and remain at the highest
+  // priority, and should not be reprioritized.
+  DCHECK_EQ(request->respect_limits(),
+            ClientSocketPool::RespectLimits::ENABLED);
 
-  // This function must be called with a valid ClientSocketHandle.
-  NOTREACHED();
+  request->set_priority(priority);
+  InsertPendingRequest(std::move(request));
 }
 
 std::unique_ptr<ClientSocketPoolBaseHelper::Request>
@@ -1474,6 +1506,7 @@ ClientSocketPoolBaseHelper::Group::RemovePendingRequest(
   CHECK(!pointer.is_null());
   std::unique_ptr<Request> request(pointer.value());
   pending_requests_.Erase(pointer);
+  pending_request_pointers_.erase(request->handle());
   // If there are no more requests, kill the backup timer.
   if (pending_requests_.empty())
     backup_job_timer_.Stop();
@@ -518,6 +518,10 @@ class NET_EXPORT_PRIVATE ClientSocketPoolBaseHelper
     std::list<IdleSocket> idle_sockets_;
     JobList jobs_;
     RequestQueue pending_requests_;
+    // Indexes |pending_requests_| by handle, so that cancellations and
+    // priority changes find their request without scanning the queue.
+    std::map<const ClientSocketHandle*, RequestQueue::Pointer>
+        pending_request_pointers_;
     int active_socket_count_;  // number of active sockets used by clients
     // A timer for when to start the backup job.
     base::OneShotTimer backup_job_timer_;
@@ -62,6 +62,7 @@ namespace {
 const int kDefaultMaxSockets = 4;
 const int kDefaultMaxSocketsPerGroup = 2;
 const char kIdleSocketFateHistogram[] = "Net.Socket.IdleSocketFate";
+const char kIdleSocketReusePathHistogram[] = "Net.Socket.IdleSocketReusePath";
 
 // Make sure |handle| sets load times correctly when it has been assigned a
 // reused socket.
@@ -3176,6 +3177,65 @@ TEST_F(ClientSocketPoolBaseTest, PreferUsedSocketToUnusedSocket) {
   EXPECT_FALSE(handle3.socket()->WasEverUsed());
 }
 
+TEST_F(ClientSocketPoolBaseTest, IdleSocketReusePathHistogram) {
+  base::HistogramTester histograms;
+  CreatePool(kDefaultMaxSockets, kDefaultMaxSockets);
+
+  connect_job_factory_->set_job_type(TestConnectJob::kMockJob);
+
+  ClientSocketHandle handle1;
+  TestCompletionCallback callback1;
+  EXPECT_EQ(
+      OK, handle1.Init("a", params_, DEFAULT_PRIORITY,
+                       ClientSocketPool::RespectLimits::ENABLED,
+                       callback1.callback(), pool_.get(), NetLogWithSource()));
+
+  ClientSocketHandle handle2;
+  TestCompletionCallback callback2;
+  EXPECT_EQ(
+      OK, handle2.Init("a", params_, DEFAULT_PRIORITY,
+                       ClientSocketPool::RespectLimits::ENABLED,
+                       callback2.callback(), pool_.get(), NetLogWithSource()));
+
+  ClientSocketHandle handle3;
+  TestCompletionCallback callback3;
+  EXPECT_EQ(
+      OK, handle3.Init("a", params_, DEFAULT_PRIORITY,
+                       ClientSocketPool::RespectLimits::ENABLED,
+                       callback3.callback(), pool_.get(), NetLogWithSource()));
+
+  // Use the first and third sockets, then release all three. The idle list
+  // is now, oldest to newest: used, unused, used.
+  EXPECT_EQ(1, handle1.socket()->Write(NULL, 1, CompletionCallback()));
+  EXPECT_EQ(1, handle3.socket()->Write(NULL, 1, CompletionCallback()));
+
+  handle1.Reset();
+  handle2.Reset();
+  handle3.Reset();
+
+  // The first request claims the newest used socket on the first probe (fast
+  // path). The second finds an unused socket at the back and must look one
+  // further for a used one (slow path). The third falls back to the lone
+  // unused socket, again on the first probe (fast path).
+  EXPECT_EQ(
+      OK, handle1.Init("a", params_, DEFAULT_PRIORITY,
+                       ClientSocketPool::RespectLimits::ENABLED,
+                       callback1.callback(), pool_.get(), NetLogWithSource()));
+  EXPECT_EQ(
+      OK, handle2.Init("a", params_, DEFAULT_PRIORITY,
+                       ClientSocketPool::RespectLimits::ENABLED,
+                       callback2.callback(), pool_.get(), NetLogWithSource()));
+  EXPECT_EQ(
+      OK, handle3.Init("a", params_, DEFAULT_PRIORITY,
+                       ClientSocketPool::RespectLimits::ENABLED,
+                       callback3.callback(), pool_.get(), NetLogWithSource()));
+
+  EXPECT_THAT(
+      histograms.GetAllSamples(kIdleSocketReusePathHistogram),
+      testing::ElementsAre(base::Bucket(/*IDLE_SOCKET_REUSE_PATH_FAST=*/0, 2),
+                           base::Bucket(/*IDLE_SOCKET_REUSE_PATH_SLOW=*/1, 1)));
+}
+
 TEST_F(ClientSocketPoolBaseTest, RequestSockets) {
   CreatePool(kDefaultMaxSockets, kDefaultMaxSocketsPerGroup);
   connect_job_factory_->set_job_type(TestConnectJob::kMockPendingJob);
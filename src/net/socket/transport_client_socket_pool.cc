@@ -38,15 +38,15 @@ namespace net {
 
 namespace {
 
-// Returns true iff all addresses in |list| are in the IPv6 family.
-bool AddressListOnlyContainsIPv6(const AddressList& list) {
+// Returns true iff |list| contains at least one address in |family|.
+bool AddressListContainsFamily(const AddressList& list, AddressFamily family) {
   DCHECK(!list.empty());
   for (AddressList::const_iterator iter = list.begin(); iter != list.end();
        ++iter) {
-    if (iter->GetFamily() != ADDRESS_FAMILY_IPV6)
-      return false;
+    if (iter->GetFamily() == family)
+      return true;
   }
-  return true;
+  return false;
 }
 
 }  // namespace
@@ -85,6 +85,9 @@ const int TransportConnectJob::kTimeoutInSeconds = 240;  // 4 minutes.
 // don't synchronize.
 const int TransportConnectJob::kIPv6FallbackTimerInMs = 300;
 
+int TransportConnectJob::fallback_delay_ms_ =
+    TransportConnectJob::kIPv6FallbackTimerInMs;
+
 TransportConnectJob::TransportConnectJob(
     const std::string& group_name,
     RequestPriority priority,
@@ -148,8 +151,14 @@ void TransportConnectJob::GetAdditionalErrorState(ClientSocketHandle* handle) {
 
 // static
 void TransportConnectJob::MakeAddressListStartWithIPv4(AddressList* list) {
+  MakeAddressListStartWithFamily(list, ADDRESS_FAMILY_IPV4);
+}
+
+// static
+void TransportConnectJob::MakeAddressListStartWithFamily(AddressList* list,
+                                                         AddressFamily family) {
   for (AddressList::iterator i = list->begin(); i != list->end(); ++i) {
-    if (i->GetFamily() == ADDRESS_FAMILY_IPV4) {
+    if (i->GetFamily() == family) {
       std::rotate(list->begin(), i, list->end());
       break;
     }
@@ -299,17 +308,17 @@ int TransportConnectJob::DoTransportConnect() {
       addresses_, std::move(socket_performance_watcher), net_log().net_log(),
       net_log().source());
 
-  // If the list contains IPv6 and IPv4 addresses, and the first address
-  // is IPv6, the IPv4 addresses will be tried as fallback addresses, per
-  // "Happy Eyeballs" (RFC 6555).
-  bool try_ipv6_connect_with_ipv4_fallback =
-      addresses_.front().GetFamily() == ADDRESS_FAMILY_IPV6 &&
-      !AddressListOnlyContainsIPv6(addresses_);
+  // If the list contains both IPv6 and IPv4 addresses, a second connect() to
+  // the family not tried first is raced against the main one after a short
+  // stagger, per "Happy Eyeballs" (RFC 6555). Whichever completes first wins.
+  bool try_connect_with_fallback =
+      AddressListContainsFamily(addresses_, ADDRESS_FAMILY_IPV4) &&
+      AddressListContainsFamily(addresses_, ADDRESS_FAMILY_IPV6);
 
   // Enable TCP FastOpen if indicated by transport socket params.
   // Note: We currently do not turn on TCP FastOpen for destinations where
-  // we try a TCP connect over IPv6 with fallback to IPv4.
-  if (!try_ipv6_connect_with_ipv4_fallback &&
+  // we race a fallback connection against the main one.
+  if (!try_connect_with_fallback &&
       params_->combine_connect_and_write() ==
           TransportSocketParams::COMBINE_CONNECT_AND_WRITE_DESIRED) {
     transport_socket_->EnableTCPFastOpenIfSupported();
@@ -317,10 +326,11 @@ int TransportConnectJob::DoTransportConnect() {
 
   int rv = transport_socket_->Connect(
       base::Bind(&TransportConnectJob::OnIOComplete, base::Unretained(this)));
-  if (rv == ERR_IO_PENDING && try_ipv6_connect_with_ipv4_fallback) {
-    fallback_timer_.Start(
-        FROM_HERE, base::TimeDelta::FromMilliseconds(kIPv6FallbackTimerInMs),
-        this, &TransportConnectJob::DoIPv6FallbackTransportConnect);
+  if (rv == ERR_IO_PENDING && try_connect_with_fallback) {
+    fallback_timer_.Start(FROM_HERE,
+                          base::TimeDelta::FromMilliseconds(fallback_delay_ms_),
+                          this,
+                          &TransportConnectJob::DoFallbackTransportConnect);
   }
   return rv;
 }
@@ -339,12 +349,15 @@ int TransportConnectJob::DoTransportConnectComplete(int result) {
 
     bool is_ipv4 = addresses_.front().GetFamily() == ADDRESS_FAMILY_IPV4;
     RaceResult race_result = RACE_UNKNOWN;
-    if (is_ipv4)
-      race_result = RACE_IPV4_SOLO;
-    else if (AddressListOnlyContainsIPv6(addresses_))
-      race_result = RACE_IPV6_SOLO;
-    else
-      race_result = RACE_IPV6_WINS;
+    if (is_ipv4) {
+      race_result = AddressListContainsFamily(addresses_, ADDRESS_FAMILY_IPV6)
+                        ? RACE_IPV4_WINS
+                        : RACE_IPV4_SOLO;
+    } else {
+      race_result = AddressListContainsFamily(addresses_, ADDRESS_FAMILY_IPV4)
+                        ? RACE_IPV6_WINS
+                        : RACE_IPV6_SOLO;
+    }
     HistogramDuration(connect_timing_, race_result);
 
     SetSocket(std::move(transport_socket_));
@@ -363,7 +376,7 @@ int TransportConnectJob::DoTransportConnectComplete(int result) {
   return result;
 }
 
-void TransportConnectJob::DoIPv6FallbackTransportConnect() {
+void TransportConnectJob::DoFallbackTransportConnect() {
   // The timer should only fire while we're waiting for the main connect to
   // succeed.
   if (next_state_ != STATE_TRANSPORT_CONNECT_COMPLETE) {
@@ -374,8 +387,14 @@ void TransportConnectJob::DoIPv6FallbackTransportConnect() {
   DCHECK(!fallback_transport_socket_.get());
   DCHECK(!fallback_addresses_.get());
 
+  // The fallback attempt starts from the first address of whichever family
+  // the main attempt did not try first.
+  AddressFamily fallback_family =
+      addresses_.front().GetFamily() == ADDRESS_FAMILY_IPV6
+          ? ADDRESS_FAMILY_IPV4
+          : ADDRESS_FAMILY_IPV6;
   fallback_addresses_.reset(new AddressList(addresses_));
-  MakeAddressListStartWithIPv4(fallback_addresses_.get());
+  MakeAddressListStartWithFamily(fallback_addresses_.get(), fallback_family);
 
   // Create a |SocketPerformanceWatcher|, and pass the ownership.
   std::unique_ptr<SocketPerformanceWatcher> socket_performance_watcher;
@@ -392,14 +411,13 @@ void TransportConnectJob::DoIPv6FallbackTransportConnect() {
           net_log().net_log(), net_log().source());
   fallback_connect_start_time_ = base::TimeTicks::Now();
   int rv = fallback_transport_socket_->Connect(
-      base::Bind(
-          &TransportConnectJob::DoIPv6FallbackTransportConnectComplete,
-          base::Unretained(this)));
+      base::Bind(&TransportConnectJob::DoFallbackTransportConnectComplete,
+                 base::Unretained(this)));
   if (rv != ERR_IO_PENDING)
-    DoIPv6FallbackTransportConnectComplete(rv);
+    DoFallbackTransportConnectComplete(rv);
 }
 
-void TransportConnectJob::DoIPv6FallbackTransportConnectComplete(int result) {
+void TransportConnectJob::DoFallbackTransportConnectComplete(int result) {
   // This should only happen when we're waiting for the main connect to succeed.
   if (next_state_ != STATE_TRANSPORT_CONNECT_COMPLETE) {
     NOTREACHED();
@@ -424,7 +442,11 @@ void TransportConnectJob::DoIPv6FallbackTransportConnectComplete(int result) {
     }
 
     connect_timing_.connect_start = fallback_connect_start_time_;
-    HistogramDuration(connect_timing_, RACE_IPV4_WINS);
+    RaceResult race_result =
+        fallback_addresses_->front().GetFamily() == ADDRESS_FAMILY_IPV4
+            ? RACE_IPV4_WINS
+            : RACE_IPV6_WINS;
+    HistogramDuration(connect_timing_, race_result);
     SetSocket(std::move(fallback_transport_socket_));
     next_state_ = STATE_NONE;
   } else {
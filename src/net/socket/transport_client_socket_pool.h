@@ -12,6 +12,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/time/time.h"
 #include "base/timer/timer.h"
+#include "net/base/address_family.h"
 #include "net/base/host_port_pair.h"
 #include "net/base/net_export.h"
 #include "net/dns/host_resolver.h"
@@ -77,13 +78,14 @@ class NET_EXPORT_PRIVATE TransportSocketParams
 };
 
 // TransportConnectJob handles the host resolution necessary for socket creation
-// and the transport (likely TCP) connect. TransportConnectJob also has fallback
-// logic for IPv6 connect() timeouts (which may happen due to networks / routers
-// with broken IPv6 support). Those timeouts take 20s, so rather than make the
-// user wait 20s for the timeout to fire, we use a fallback timer
-// (kIPv6FallbackTimerInMs) and start a connect() to a IPv4 address if the timer
-// fires. Then we race the IPv4 connect() against the IPv6 connect() (which has
-// a headstart) and return the one that completes first to the socket pool.
+// and the transport (likely TCP) connect. When the resolved address list
+// contains both address families, TransportConnectJob races a second connect()
+// to the other family against the first one: the first connect() gets a small
+// headstart (fallback_delay_ms(), kIPv6FallbackTimerInMs by default), the
+// second starts when the fallback timer fires, and whichever completes first
+// is returned to the socket pool while the loser is cancelled. This bounds the
+// damage of broken IPv6 routes (whose connect() timeouts take 20s or more)
+// and, symmetrically, of slow or lossy IPv4 paths.
 class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
  public:
   // For recording the connection time in the appropriate bucket.
@@ -100,10 +102,18 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   static const int kTimeoutInSeconds;
 
   // In cases where both IPv6 and IPv4 addresses were returned from DNS,
-  // TransportConnectJobs will start a second connection attempt to just the
-  // IPv4 addresses after this many milliseconds. (This is "Happy Eyeballs".)
+  // TransportConnectJobs will start a second connection attempt to the other
+  // address family after this many milliseconds. (This is "Happy Eyeballs".)
   static const int kIPv6FallbackTimerInMs;
 
+  // The delay before the second, other-family connection attempt is started.
+  // Defaults to kIPv6FallbackTimerInMs; embedders may lower it to race the
+  // families more aggressively on lossy or high-latency paths.
+  static int fallback_delay_ms() { return fallback_delay_ms_; }
+  static void set_fallback_delay_ms(int delay_ms) {
+    fallback_delay_ms_ = delay_ms;
+  }
+
   TransportConnectJob(
       const std::string& group_name,
       RequestPriority priority,
@@ -125,6 +135,10 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   // WARNING: this method should only be used to implement the prefer-IPv4 hack.
   static void MakeAddressListStartWithIPv4(AddressList* addrlist);
 
+  // Rolls |addrlist| forward until the first address of |family|, if any.
+  static void MakeAddressListStartWithFamily(AddressList* addrlist,
+                                             AddressFamily family);
+
   // Record the histograms Net.DNS_Resolution_And_TCP_Connection_Latency2 and
   // Net.TCP_Connection_Latency and return the connect duration.
   static void HistogramDuration(
@@ -149,8 +163,8 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   int DoTransportConnectComplete(int result);
 
   // Not part of the state machine.
-  void DoIPv6FallbackTransportConnect();
-  void DoIPv6FallbackTransportConnectComplete(int result);
+  void DoFallbackTransportConnect();
+  void DoFallbackTransportConnectComplete(int result);
 
   // Begins the host resolution and the TCP connect.  Returns OK on success
   // and ERR_IO_PENDING if it cannot immediately service the request.
@@ -185,6 +199,8 @@ class NET_EXPORT_PRIVATE TransportConnectJob : public ConnectJob {
   ConnectionAttempts connection_attempts_;
   ConnectionAttempts fallback_connection_attempts_;
 
+  static int fallback_delay_ms_;
+
   DISALLOW_COPY_AND_ASSIGN(TransportConnectJob);
 };
 
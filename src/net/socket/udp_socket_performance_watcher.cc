@@ -0,0 +1,81 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/udp_socket_performance_watcher.h"
+
+#include <errno.h>
+
+#include <algorithm>
+
+namespace net {
+
+UDPSocketPerformanceStats::UDPSocketPerformanceStats()
+    : write_count(0),
+      write_bytes(0),
+      write_eagain_count(0),
+      write_error_count(0),
+      read_count(0),
+      read_bytes(0),
+      read_eagain_count(0),
+      read_error_count(0),
+      last_send_queue_bytes(0),
+      last_receive_queue_bytes(0),
+      max_send_queue_bytes(0) {}
+
+UDPSocketPerformanceTracker::UDPSocketPerformanceTracker() {}
+
+UDPSocketPerformanceTracker::~UDPSocketPerformanceTracker() {}
+
+void UDPSocketPerformanceTracker::OnWriteResult(
+    int result,
+    base::TimeDelta syscall_duration) {
+  stats_.write_count++;
+  if (result >= 0) {
+    stats_.write_bytes += result;
+  } else if (result == -EAGAIN || result == -EWOULDBLOCK) {
+    stats_.write_eagain_count++;
+  } else {
+    stats_.write_error_count++;
+  }
+  stats_.total_write_syscall_time += syscall_duration;
+  stats_.max_write_syscall_time =
+      std::max(stats_.max_write_syscall_time, syscall_duration);
+}
+
+void UDPSocketPerformanceTracker::OnReadResult(
+    int result,
+    base::TimeDelta syscall_duration) {
+  stats_.read_count++;
+  if (result >= 0) {
+    stats_.read_bytes += result;
+  } else if (result == -EAGAIN || result == -EWOULDBLOCK) {
+    stats_.read_eagain_count++;
+  } else {
+    stats_.read_error_count++;
+  }
+  stats_.total_read_syscall_time += syscall_duration;
+  stats_.max_read_syscall_time =
+      std::max(stats_.max_read_syscall_time, syscall_duration);
+}
+
+void UDPSocketPerformanceTracker::OnQueueDepthSample(
+    size_t send_queue_bytes,
+    size_t receive_queue_bytes) {
+  stats_.last_send_queue_bytes = send_queue_bytes;
+  stats_.last_receive_queue_bytes = receive_queue_bytes;
+  stats_.max_send_queue_bytes =
+      std::max(stats_.max_send_queue_bytes, send_queue_bytes);
+}
+
+double UDPSocketPerformanceTracker::WriteEagainRate() const {
+  if (stats_.write_count == 0)
+    return 0.0;
+  return static_cast<double>(stats_.write_eagain_count) / stats_.write_count;
+}
+
+void UDPSocketPerformanceTracker::Reset() {
+  stats_ = UDPSocketPerformanceStats();
+}
+
+}  // namespace net
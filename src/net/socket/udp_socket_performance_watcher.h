@@ -0,0 +1,100 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SOCKET_UDP_SOCKET_PERFORMANCE_WATCHER_H_
+#define NET_SOCKET_UDP_SOCKET_PERFORMANCE_WATCHER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "net/base/net_export.h"
+
+namespace net {
+
+// UDPSocketPerformanceWatcher observes the health of a single UDP socket.
+// Unlike SocketPerformanceWatcher, which only carries transport RTT samples,
+// this surface is fed directly by the datagram read and write paths, so it
+// sees kernel-side distress (send buffer pressure, EAGAIN, slow syscalls)
+// before packets are dropped. Must be used on a single thread.
+class NET_EXPORT_PRIVATE UDPSocketPerformanceWatcher {
+ public:
+  virtual ~UDPSocketPerformanceWatcher() {}
+
+  // Called after every datagram send syscall. |result| is the number of
+  // bytes written, -EAGAIN when the socket was write blocked, or the
+  // negated errno on failure. |syscall_duration| is the wall time spent in
+  // the syscall.
+  virtual void OnWriteResult(int result, base::TimeDelta syscall_duration) = 0;
+
+  // Called after every datagram receive syscall, with the same conventions
+  // as OnWriteResult(). For batched reads (recvmmsg) |result| is the total
+  // number of bytes read across the batch.
+  virtual void OnReadResult(int result, base::TimeDelta syscall_duration) = 0;
+
+  // Called with the kernel send and receive queue depths in bytes, when the
+  // feeding socket samples them. Sampling cadence is up to the feeder.
+  virtual void OnQueueDepthSample(size_t send_queue_bytes,
+                                  size_t receive_queue_bytes) = 0;
+};
+
+// Aggregated statistics collected by UDPSocketPerformanceTracker. All
+// counters are cumulative since construction or the last Reset().
+struct NET_EXPORT_PRIVATE UDPSocketPerformanceStats {
+  UDPSocketPerformanceStats();
+
+  uint64_t write_count;
+  uint64_t write_bytes;
+  uint64_t write_eagain_count;
+  uint64_t write_error_count;  // Errors other than EAGAIN.
+  base::TimeDelta total_write_syscall_time;
+  base::TimeDelta max_write_syscall_time;
+
+  uint64_t read_count;
+  uint64_t read_bytes;
+  uint64_t read_eagain_count;
+  uint64_t read_error_count;  // Errors other than EAGAIN.
+  base::TimeDelta total_read_syscall_time;
+  base::TimeDelta max_read_syscall_time;
+
+  // Most recent kernel queue depth sample, 0 until the first sample.
+  size_t last_send_queue_bytes;
+  size_t last_receive_queue_bytes;
+  // Largest send queue depth ever sampled.
+  size_t max_send_queue_bytes;
+};
+
+// A UDPSocketPerformanceWatcher that aggregates the observations into
+// UDPSocketPerformanceStats for polling, e.g. by a load balancer deciding
+// which socket new connections should land on.
+class NET_EXPORT_PRIVATE UDPSocketPerformanceTracker
+    : public UDPSocketPerformanceWatcher {
+ public:
+  UDPSocketPerformanceTracker();
+  ~UDPSocketPerformanceTracker() override;
+
+  // UDPSocketPerformanceWatcher implementation.
+  void OnWriteResult(int result, base::TimeDelta syscall_duration) override;
+  void OnReadResult(int result, base::TimeDelta syscall_duration) override;
+  void OnQueueDepthSample(size_t send_queue_bytes,
+                          size_t receive_queue_bytes) override;
+
+  const UDPSocketPerformanceStats& stats() const { return stats_; }
+
+  // Fraction of send syscalls that returned EAGAIN, in [0, 1]. Returns 0
+  // before any write has been observed.
+  double WriteEagainRate() const;
+
+  void Reset();
+
+ private:
+  UDPSocketPerformanceStats stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(UDPSocketPerformanceTracker);
+};
+
+}  // namespace net
+
+#endif  // NET_SOCKET_UDP_SOCKET_PERFORMANCE_WATCHER_H_
@@ -0,0 +1,81 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/socket/udp_socket_performance_watcher.h"
+
+#include <errno.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+
+namespace {
+
+TEST(UDPSocketPerformanceTrackerTest, CountsWriteResults) {
+  UDPSocketPerformanceTracker tracker;
+  tracker.OnWriteResult(1200, base::TimeDelta::FromMicroseconds(10));
+  tracker.OnWriteResult(800, base::TimeDelta::FromMicroseconds(30));
+  tracker.OnWriteResult(-EAGAIN, base::TimeDelta::FromMicroseconds(5));
+  tracker.OnWriteResult(-EMSGSIZE, base::TimeDelta::FromMicroseconds(5));
+
+  const UDPSocketPerformanceStats& stats = tracker.stats();
+  EXPECT_EQ(4u, stats.write_count);
+  EXPECT_EQ(2000u, stats.write_bytes);
+  EXPECT_EQ(1u, stats.write_eagain_count);
+  EXPECT_EQ(1u, stats.write_error_count);
+  EXPECT_EQ(base::TimeDelta::FromMicroseconds(50),
+            stats.total_write_syscall_time);
+  EXPECT_EQ(base::TimeDelta::FromMicroseconds(30),
+            stats.max_write_syscall_time);
+  EXPECT_DOUBLE_EQ(0.25, tracker.WriteEagainRate());
+}
+
+TEST(UDPSocketPerformanceTrackerTest, CountsReadResults) {
+  UDPSocketPerformanceTracker tracker;
+  tracker.OnReadResult(1500, base::TimeDelta::FromMicroseconds(20));
+  tracker.OnReadResult(-EAGAIN, base::TimeDelta::FromMicroseconds(2));
+  tracker.OnReadResult(-EBADF, base::TimeDelta::FromMicroseconds(2));
+
+  const UDPSocketPerformanceStats& stats = tracker.stats();
+  EXPECT_EQ(3u, stats.read_count);
+  EXPECT_EQ(1500u, stats.read_bytes);
+  EXPECT_EQ(1u, stats.read_eagain_count);
+  EXPECT_EQ(1u, stats.read_error_count);
+  EXPECT_EQ(base::TimeDelta::FromMicroseconds(24),
+            stats.total_read_syscall_time);
+  EXPECT_EQ(base::TimeDelta::FromMicroseconds(20),
+            stats.max_read_syscall_time);
+}
+
+TEST(UDPSocketPerformanceTrackerTest, TracksQueueDepths) {
+  UDPSocketPerformanceTracker tracker;
+  EXPECT_EQ(0u, tracker.stats().max_send_queue_bytes);
+
+  tracker.OnQueueDepthSample(4096, 1024);
+  tracker.OnQueueDepthSample(512, 2048);
+
+  const UDPSocketPerformanceStats& stats = tracker.stats();
+  EXPECT_EQ(512u, stats.last_send_queue_bytes);
+  EXPECT_EQ(2048u, stats.last_receive_queue_bytes);
+  EXPECT_EQ(4096u, stats.max_send_queue_bytes);
+}
+
+TEST(UDPSocketPerformanceTrackerTest, ResetClearsStats) {
+  UDPSocketPerformanceTracker tracker;
+  tracker.OnWriteResult(100, base::TimeDelta::FromMicroseconds(1));
+  tracker.OnQueueDepthSample(64, 64);
+
+  tracker.Reset();
+
+  const UDPSocketPerformanceStats& stats = tracker.stats();
+  EXPECT_EQ(0u, stats.write_count);
+  EXPECT_EQ(0u, stats.write_bytes);
+  EXPECT_EQ(0u, stats.max_send_queue_bytes);
+  EXPECT_EQ(base::TimeDelta(), stats.total_write_syscall_time);
+  EXPECT_DOUBLE_EQ(0.0, tracker.WriteEagainRate());
+}
+
+}  // namespace
+
+}  // namespace net
@@ -2,8 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <vector>
+
 #include "base/bind.h"
 #include "base/memory/weak_ptr.h"
+#include "build/build_config.h"
 #include "base/message_loop/message_loop.h"
 #include "base/run_loop.h"
 #include "base/test/perf_time_logger.h"
@@ -15,6 +18,9 @@
 #include "net/socket/udp_client_socket.h"
 #include "net/socket/udp_server_socket.h"
 #include "net/socket/udp_socket.h"
+#if defined(OS_POSIX)
+#include "net/socket/udp_socket_posix.h"
+#endif
 #include "net/test/gtest_util.h"
 #include "net/test/net_test_suite.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -48,6 +54,12 @@ class UDPSocketPerfTest : public PlatformTest {
   // has effect on Windows.
   void WriteBenchmark(bool use_nonblocking_io);
 
+#if defined(OS_POSIX)
+  // Same as WriteBenchmark, but sends |batch_size| packets per SendBatch
+  // call instead of one packet per Write call.
+  void WriteBatchBenchmark(int batch_size);
+#endif
+
  protected:
   static const int kPacketSize = 1024;
   scoped_refptr<IOBufferWithSize> buffer_;
@@ -122,6 +134,61 @@ void UDPSocketPerfTest::WriteBenchmark(bool use_nonblocking_io) {
   LOG(INFO) << "Write speed: " << packets / 1024 / elapsed << " MB/s";
 }
 
+#if defined(OS_POSIX)
+void UDPSocketPerfTest::WriteBatchBenchmark(int batch_size) {
+  base::MessageLoopForIO message_loop;
+  const uint16_t kPort = 9999;
+
+  // Setup the server to listen.
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", kPort, &bind_address);
+  std::unique_ptr<UDPServerSocket> server(
+      new UDPServerSocket(nullptr, NetLogSource()));
+  int rv = server->Listen(bind_address);
+  ASSERT_THAT(rv, IsOk());
+
+  // Setup the client.
+  IPEndPoint server_address;
+  CreateUDPAddress("127.0.0.1", kPort, &server_address);
+  UDPSocketPosix client(DatagramSocket::DEFAULT_BIND, RandIntCallback(),
+                        nullptr, NetLogSource());
+  rv = client.Open(ADDRESS_FAMILY_IPV4);
+  ASSERT_THAT(rv, IsOk());
+  rv = client.Connect(server_address);
+  ASSERT_THAT(rv, IsOk());
+  client.SetSendBufferSize(1024);
+
+  memset(buffer_->data(), 'G', kPacketSize);
+  std::vector<UDPSocketPosix::Datagram> batch;
+  for (int i = 0; i < batch_size; ++i)
+    batch.push_back(UDPSocketPosix::Datagram(buffer_, kPacketSize));
+
+  base::TimeTicks start_ticks = base::TimeTicks::Now();
+  const int kPackets = 100000;
+  int sent = 0;
+  while (sent < kPackets) {
+    rv = client.SendBatch(&batch);
+    ASSERT_GE(rv, 0);
+    if (rv == 0) {
+      // Send buffer is full; send a single packet asynchronously to wait for
+      // space.
+      TestCompletionCallback callback;
+      rv = client.Write(buffer_.get(), kPacketSize, callback.callback());
+      if (rv == ERR_IO_PENDING)
+        rv = callback.WaitForResult();
+      ASSERT_GT(rv, 0);
+      sent += 1;
+      continue;
+    }
+    sent += rv;
+  }
+
+  double elapsed = (base::TimeTicks::Now() - start_ticks).InSecondsF();
+  LOG(INFO) << "Write batch speed (batch size " << batch_size
+            << "): " << sent / 1024 / elapsed << " MB/s";
+}
+#endif  // defined(OS_POSIX)
+
 TEST_F(UDPSocketPerfTest, Write) {
   base::PerfTimeLogger timer("UDP_socket_write");
   WriteBenchmark(false);
@@ -132,6 +199,23 @@ TEST_F(UDPSocketPerfTest, WriteNonBlocking) {
   WriteBenchmark(true);
 }
 
+#if defined(OS_POSIX)
+TEST_F(UDPSocketPerfTest, WriteBatch1) {
+  base::PerfTimeLogger timer("UDP_socket_write_batch_1");
+  WriteBatchBenchmark(1);
+}
+
+TEST_F(UDPSocketPerfTest, WriteBatch16) {
+  base::PerfTimeLogger timer("UDP_socket_write_batch_16");
+  WriteBatchBenchmark(16);
+}
+
+TEST_F(UDPSocketPerfTest, WriteBatch64) {
+  base::PerfTimeLogger timer("UDP_socket_write_batch_64");
+  WriteBatchBenchmark(64);
+}
+#endif  // defined(OS_POSIX)
+
 }  // namespace
 
 }  // namespace net
@@ -391,6 +391,123 @@ int UDPSocketPosix::SendTo(IOBuffer* buf,
   return SendToOrWrite(buf, buf_len, &address, callback);
 }
 
+UDPSocketPosix::Datagram::Datagram() : length(0) {}
+
+UDPSocketPosix::Datagram::Datagram(scoped_refptr<IOBuffer> buffer, int length)
+    : buffer(std::move(buffer)), length(length) {}
+
+UDPSocketPosix::Datagram::Datagram(const Datagram& other) = default;
+
+UDPSocketPosix::Datagram::~Datagram() {}
+
+int UDPSocketPosix::SendBatch(std::vector<Datagram>* datagrams) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(datagrams);
+  DCHECK(is_connected());
+
+#if defined(OS_LINUX)
+  std::vector<struct iovec> iovecs(datagrams->size());
+  std::vector<struct mmsghdr> msgvec(datagrams->size());
+  for (size_t i = 0; i < datagrams->size(); ++i) {
+    Datagram& datagram = (*datagrams)[i];
+    DCHECK_GT(datagram.length, 0);
+    iovecs[i].iov_base = datagram.buffer->data();
+    iovecs[i].iov_len = datagram.length;
+    memset(&msgvec[i], 0, sizeof(msgvec[i]));
+    msgvec[i].msg_hdr.msg_iov = &iovecs[i];
+    msgvec[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int result =
+      HANDLE_EINTR(sendmmsg(socket_, msgvec.data(), msgvec.size(), 0));
+  if (result < 0) {
+    int net_error = MapSystemError(errno);
+    if (net_error == ERR_IO_PENDING)
+      return 0;
+    LogWrite(net_error, NULL, NULL);
+    return net_error;
+  }
+
+  for (int i = 0; i < result; ++i) {
+    const Datagram& datagram = (*datagrams)[i];
+    LogWrite(datagram.length, datagram.buffer->data(), NULL);
+  }
+  return result;
+#else
+  // Without sendmmsg(), send one datagram per syscall until the send buffer
+  // fills up.
+  int num_sent = 0;
+  for (const Datagram& datagram : *datagrams) {
+    DCHECK_GT(datagram.length, 0);
+    int rv = InternalSendTo(datagram.buffer.get(), datagram.length, NULL);
+    if (rv == ERR_IO_PENDING)
+      break;
+    if (rv < 0)
+      return num_sent > 0 ? num_sent : rv;
+    ++num_sent;
+  }
+  return num_sent;
+#endif
+}
+
+int UDPSocketPosix::ReadBatch(std::vector<Datagram>* datagrams) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  DCHECK_NE(kInvalidSocket, socket_);
+  DCHECK(datagrams);
+  DCHECK(is_connected());
+
+#if defined(OS_LINUX)
+  std::vector<struct iovec> iovecs(datagrams->size());
+  std::vector<struct mmsghdr> msgvec(datagrams->size());
+  std::vector<SockaddrStorage> addresses(datagrams->size());
+  for (size_t i = 0; i < datagrams->size(); ++i) {
+    Datagram& datagram = (*datagrams)[i];
+    DCHECK_GT(datagram.length, 0);
+    iovecs[i].iov_base = datagram.buffer->data();
+    iovecs[i].iov_len = datagram.length;
+    memset(&msgvec[i], 0, sizeof(msgvec[i]));
+    msgvec[i].msg_hdr.msg_iov = &iovecs[i];
+    msgvec[i].msg_hdr.msg_iovlen = 1;
+    msgvec[i].msg_hdr.msg_name = addresses[i].addr;
+    msgvec[i].msg_hdr.msg_namelen = addresses[i].addr_len;
+  }
+
+  int result =
+      HANDLE_EINTR(recvmmsg(socket_, msgvec.data(), msgvec.size(), 0, NULL));
+  if (result < 0) {
+    int net_error = MapSystemError(errno);
+    if (net_error == ERR_IO_PENDING)
+      return 0;
+    LogRead(net_error, NULL, 0, NULL);
+    return net_error;
+  }
+
+  for (int i = 0; i < result; ++i) {
+    Datagram& datagram = (*datagrams)[i];
+    datagram.length = msgvec[i].msg_len;
+    LogRead(datagram.length, datagram.buffer->data(),
+            msgvec[i].msg_hdr.msg_namelen, addresses[i].addr);
+  }
+  return result;
+#else
+  // Without recvmmsg(), receive one datagram per syscall until none are
+  // pending.
+  int num_received = 0;
+  for (Datagram& datagram : *datagrams) {
+    DCHECK_GT(datagram.length, 0);
+    int rv = InternalRecvFrom(datagram.buffer.get(), datagram.length, NULL);
+    if (rv == ERR_IO_PENDING)
+      break;
+    if (rv < 0)
+      return num_received > 0 ? num_received : rv;
+    datagram.length = rv;
+    ++num_received;
+  }
+  return num_received;
+#endif
+}
+
 int UDPSocketPosix::SendToOrWrite(IOBuffer* buf,
                                   int buf_len,
                                   const IPEndPoint* address,
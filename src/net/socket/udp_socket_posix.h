@@ -8,6 +8,7 @@
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -156,6 +157,37 @@ class NET_EXPORT UDPSocketPosix {
              const IPEndPoint& address,
              const CompletionCallback& callback);
 
+  // A single datagram in a batched send or receive. |buffer| must be kept
+  // alive by the caller for the duration of the call. For sends, |length| is
+  // the number of bytes to send from |buffer|; for receives, it is the
+  // capacity of |buffer| and is overwritten with the size of the received
+  // datagram.
+  struct NET_EXPORT Datagram {
+    Datagram();
+    Datagram(scoped_refptr<IOBuffer> buffer, int length);
+    Datagram(const Datagram& other);
+    ~Datagram();
+
+    scoped_refptr<IOBuffer> buffer;
+    int length;
+  };
+
+  // Sends |datagrams| with a single sendmmsg() call where the kernel supports
+  // it, and with a sendto() loop elsewhere. Only usable on a connected
+  // socket. Never blocks and never returns ERR_IO_PENDING: returns the number
+  // of datagrams handed to the kernel, which is 0 when the socket's send
+  // buffer is full (use Write() to wait for space), or a net error code if
+  // nothing was sent.
+  int SendBatch(std::vector<Datagram>* datagrams);
+
+  // Receives up to |datagrams->size()| datagrams with a single recvmmsg()
+  // call where the kernel supports it, and with a recvfrom() loop elsewhere.
+  // Only usable on a connected socket. Never blocks and never returns
+  // ERR_IO_PENDING: returns the number of datagrams received, which is 0 when
+  // none were pending (use Read() to wait for data), or a net error code if
+  // nothing was received.
+  int ReadBatch(std::vector<Datagram>* datagrams);
+
   // Sets the receive buffer size (in bytes) for the socket.
   // Returns a net error code.
   int SetReceiveBufferSize(int32_t size);
@@ -4,6 +4,9 @@
 
 #include "net/socket/udp_socket.h"
 
+#include <string>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/location.h"
 #include "base/macros.h"
@@ -11,6 +14,7 @@
 #include "base/memory/weak_ptr.h"
 #include "base/run_loop.h"
 #include "base/single_thread_task_runner.h"
+#include "base/threading/platform_thread.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "build/build_config.h"
 #include "net/base/io_buffer.h"
@@ -629,6 +633,63 @@ TEST_F(UDPSocketTest, CloseWithPendingRead) {
   EXPECT_FALSE(callback.have_result());
 }
 
+#if defined(OS_POSIX)
+TEST_F(UDPSocketTest, BatchSendAndRead) {
+  IPEndPoint bind_address;
+  CreateUDPAddress("127.0.0.1", 0, &bind_address);
+  UDPServerSocket server(NULL, NetLogSource());
+  int rv = server.Listen(bind_address);
+  ASSERT_THAT(rv, IsOk());
+  IPEndPoint server_address;
+  ASSERT_THAT(server.GetLocalAddress(&server_address), IsOk());
+
+  UDPSocketPosix client(DatagramSocket::DEFAULT_BIND, RandIntCallback(), NULL,
+                        NetLogSource());
+  ASSERT_THAT(client.Open(ADDRESS_FAMILY_IPV4), IsOk());
+  ASSERT_THAT(client.Connect(server_address), IsOk());
+
+  // Send three datagrams in a single batch; the server should receive them
+  // individually and in order.
+  const char* kMessages[] = {"first", "second", "third"};
+  std::vector<UDPSocketPosix::Datagram> batch;
+  for (const char* message : kMessages) {
+    scoped_refptr<StringIOBuffer> buffer(new StringIOBuffer(message));
+    batch.push_back(UDPSocketPosix::Datagram(buffer, buffer->size()));
+  }
+  EXPECT_EQ(3, client.SendBatch(&batch));
+  EXPECT_EQ("first", RecvFromSocket(&server));
+  EXPECT_EQ("second", RecvFromSocket(&server));
+  EXPECT_EQ("third", RecvFromSocket(&server));
+
+  // Echo two datagrams back and collect them with batched reads. ReadBatch
+  // never blocks, so poll until loopback delivery completes.
+  EXPECT_EQ(5, SendToSocket(&server, "hello"));
+  EXPECT_EQ(5, SendToSocket(&server, "world"));
+
+  std::vector<std::string> received;
+  while (received.size() < 2u) {
+    std::vector<UDPSocketPosix::Datagram> read_batch;
+    for (int i = 0; i < 2; ++i) {
+      read_batch.push_back(UDPSocketPosix::Datagram(
+          new IOBufferWithSize(kMaxRead), kMaxRead));
+    }
+    rv = client.ReadBatch(&read_batch);
+    ASSERT_GE(rv, 0);
+    if (rv == 0) {
+      base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(1));
+      continue;
+    }
+    for (int i = 0; i < rv; ++i) {
+      received.push_back(
+          std::string(read_batch[i].buffer->data(), read_batch[i].length));
+    }
+  }
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ("hello", received[0]);
+  EXPECT_EQ("world", received[1]);
+}
+#endif  // defined(OS_POSIX)
+
 #if defined(OS_ANDROID) || defined(OS_FUCHSIA)
 // Some Android devices do not support multicast socket.
 // The ones supporting multicast need WifiManager.MulitcastLock to enable it.
@@ -68,7 +68,8 @@ SpdySessionPool::SpdySessionPool(
       initial_settings_(initial_settings),
       time_func_(time_func),
       push_delegate_(nullptr),
-      proxy_delegate_(proxy_delegate) {
+      proxy_delegate_(proxy_delegate),
+      max_sessions_per_origin_(1) {
   NetworkChangeNotifier::AddIPAddressObserver(this);
   if (ssl_config_service_.get())
     ssl_config_service_->AddObserver(this);
@@ -168,18 +169,36 @@ base::WeakPtr<SpdySession> SpdySessionPool::FindAvailableSession(
 
   AvailableSessionMap::iterator it = LookupAvailableSessionByKey(key);
   if (it != available_sessions_.end()) {
-    if (key.Equals(it->second->spdy_session_key())) {
+    base::WeakPtr<SpdySession> available_session =
+        PickLeastLoadedSession(&it->second);
+    if (!available_session) {
+      // Every session mapped to |key| has been destroyed; fall through to
+      // the IP pooling lookup as if the key had no mapping.
+      available_sessions_.erase(it);
+    } else if (key.Equals(available_session->spdy_session_key())) {
+      if (available_session->IsSendStalled() &&
+          it->second.size() < max_sessions_per_origin_) {
+        // The least loaded pick being send-stalled means every parallel
+        // session for this origin has an exhausted send window. Have the
+        // caller open another session instead of queueing behind them.
+        return base::WeakPtr<SpdySession>();
+      }
       UMA_HISTOGRAM_ENUMERATION("Net.SpdySessionGet", FOUND_EXISTING,
                                 SPDY_SESSION_GET_MAX);
       net_log.AddEvent(
           NetLogEventType::HTTP2_SESSION_POOL_FOUND_EXISTING_SESSION,
-          it->second->net_log().source().ToEventParametersCallback());
+          available_session->net_log().source().ToEventParametersCallback());
+      return available_session;
     } else {
       if (!enable_ip_based_pooling) {
-        // Remove session from available sessions and from aliases, and remove
-        // key from the session's pooled alias set, so that a new session can be
-        // created with this |key|.
-        it->second->RemovePooledAlias(key);
+        // Remove sessions from available sessions and from aliases, and
+        // remove key from the sessions' pooled alias sets, so that a new
+        // session can be created with this |key|.
+        for (WeakSessionList::const_iterator session_it = it->second.begin();
+             session_it != it->second.end(); ++session_it) {
+          if (*session_it)
+            (*session_it)->RemovePooledAlias(key);
+        }
         UnmapKey(key);
         RemoveAliases(key);
         return base::WeakPtr<SpdySession>();
@@ -191,9 +210,9 @@ base::WeakPtr<SpdySession> SpdySessionPool::FindAvailableSession(
       net_log.AddEvent(
           NetLogEventType::
               HTTP2_SESSION_POOL_FOUND_EXISTING_SESSION_FROM_IP_POOL,
-          it->second->net_log().source().ToEventParametersCallback());
+          available_session->net_log().source().ToEventParametersCallback());
+      return available_session;
     }
-    return it->second;
   }
 
   if (!enable_ip_based_pooling)
@@ -231,8 +250,12 @@ base::WeakPtr<SpdySession> SpdySessionPool::FindAvailableSession(
       continue;
     }
 
-    const base::WeakPtr<SpdySession>& available_session =
-        available_session_it->second;
+    base::WeakPtr<SpdySession> available_session =
+        PickLeastLoadedSession(&available_session_it->second);
+    if (!available_session) {
+      available_sessions_.erase(available_session_it);
+      continue;
+    }
     DCHECK(base::ContainsKey(sessions_, available_session.get()));
     // If the session is a secure one, we need to verify that the
     // server is authenticated to serve traffic for |host_port_proxy_pair| too.
@@ -260,13 +283,17 @@ base::WeakPtr<SpdySession> SpdySessionPool::FindAvailableSession(
 
 void SpdySessionPool::MakeSessionUnavailable(
     const base::WeakPtr<SpdySession>& available_session) {
-  UnmapKey(available_session->spdy_session_key());
-  RemoveAliases(available_session->spdy_session_key());
+  // Only drop the IP aliases for a key once its last parallel session goes
+  // away; until then the surviving sessions can still serve pooled streams.
+  if (UnmapSessionFromKey(available_session->spdy_session_key(),
+                          available_session.get())) {
+    RemoveAliases(available_session->spdy_session_key());
+  }
   const std::set<SpdySessionKey>& aliases = available_session->pooled_aliases();
   for (std::set<SpdySessionKey>::const_iterator it = aliases.begin();
        it != aliases.end(); ++it) {
-    UnmapKey(*it);
-    RemoveAliases(*it);
+    if (UnmapSessionFromKey(*it, available_session.get()))
+      RemoveAliases(*it);
   }
   DCHECK(!IsSessionAvailable(available_session));
 }
@@ -358,12 +385,17 @@ std::unique_ptr<base::Value> SpdySessionPool::SpdySessionPoolInfoToValue()
 
   for (AvailableSessionMap::const_iterator it = available_sessions_.begin();
        it != available_sessions_.end(); ++it) {
-    // Only add the session if the key in the map matches the main
-    // host_port_proxy_pair (not an alias).
     const SpdySessionKey& key = it->first;
-    const SpdySessionKey& session_key = it->second->spdy_session_key();
-    if (key.Equals(session_key))
-      list->Append(it->second->GetInfoAsValue());
+    for (WeakSessionList::const_iterator session_it = it->second.begin();
+         session_it != it->second.end(); ++session_it) {
+      if (!*session_it)
+        continue;
+      // Only add the session if the key in the map matches the main
+      // host_port_proxy_pair (not an alias).
+      const SpdySessionKey& session_key = (*session_it)->spdy_session_key();
+      if (key.Equals(session_key))
+        list->Append((*session_it)->GetInfoAsValue());
+    }
   }
   return std::move(list);
 }
@@ -543,8 +575,11 @@ bool SpdySessionPool::IsSessionAvailable(
     const base::WeakPtr<SpdySession>& session) const {
   for (AvailableSessionMap::const_iterator it = available_sessions_.begin();
        it != available_sessions_.end(); ++it) {
-    if (it->second.get() == session.get())
-      return true;
+    for (WeakSessionList::const_iterator session_it = it->second.begin();
+         session_it != it->second.end(); ++session_it) {
+      if (session_it->get() == session.get())
+        return true;
+    }
   }
   return false;
 }
@@ -553,9 +588,12 @@ void SpdySessionPool::MapKeyToAvailableSession(
     const SpdySessionKey& key,
     const base::WeakPtr<SpdySession>& session) {
   DCHECK(base::ContainsKey(sessions_, session.get()));
-  std::pair<AvailableSessionMap::iterator, bool> result =
-      available_sessions_.insert(std::make_pair(key, session));
-  CHECK(result.second);
+  WeakSessionList& sessions = available_sessions_[key];
+  for (WeakSessionList::const_iterator it = sessions.begin();
+       it != sessions.end(); ++it) {
+    CHECK(it->get() != session.get());
+  }
+  sessions.push_back(session);
 }
 
 SpdySessionPool::AvailableSessionMap::iterator
@@ -564,12 +602,61 @@ SpdySessionPool::LookupAvailableSessionByKey(
   return available_sessions_.find(key);
 }
 
+base::WeakPtr<SpdySession> SpdySessionPool::PickLeastLoadedSession(
+    WeakSessionList* sessions) const {
+  base::WeakPtr<SpdySession> best;
+  bool best_is_stalled = false;
+  for (WeakSessionList::iterator it = sessions->begin();
+       it != sessions->end();) {
+    // Lazy deletion of destroyed SpdySessions.
+    if (!*it) {
+      it = sessions->erase(it);
+      continue;
+    }
+    bool is_stalled = (*it)->IsSendStalled();
+    if (!best || (best_is_stalled && !is_stalled) ||
+        (best_is_stalled == is_stalled &&
+         (*it)->num_active_streams() < best->num_active_streams())) {
+      best = *it;
+      best_is_stalled = is_stalled;
+    }
+    ++it;
+  }
+  return best;
+}
+
 void SpdySessionPool::UnmapKey(const SpdySessionKey& key) {
   AvailableSessionMap::iterator it = LookupAvailableSessionByKey(key);
   CHECK(it != available_sessions_.end());
   available_sessions_.erase(it);
 }
 
+bool SpdySessionPool::UnmapSessionFromKey(const SpdySessionKey& key,
+                                          SpdySession* session) {
+  AvailableSessionMap::iterator it = LookupAvailableSessionByKey(key);
+  CHECK(it != available_sessions_.end());
+  bool removed = false;
+  for (WeakSessionList::iterator session_it = it->second.begin();
+       session_it != it->second.end();) {
+    if (session_it->get() == session) {
+      session_it = it->second.erase(session_it);
+      removed = true;
+      continue;
+    }
+    // Lazy deletion of destroyed SpdySessions.
+    if (!*session_it) {
+      session_it = it->second.erase(session_it);
+      continue;
+    }
+    ++session_it;
+  }
+  CHECK(removed);
+  if (!it->second.empty())
+    return false;
+  available_sessions_.erase(it);
+  return true;
+}
+
 void SpdySessionPool::RemoveAliases(const SpdySessionKey& key) {
   // Walk the aliases map, find references to this pair.
   // TODO(mbelshe):  Figure out if this is too expensive.
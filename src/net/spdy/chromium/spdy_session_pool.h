@@ -13,6 +13,7 @@
 #include <set>
 #include <vector>
 
+#include "base/logging.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
@@ -87,8 +88,14 @@ class NET_EXPORT SpdySessionPool
       const NetLogWithSource& net_log);
 
   // If |url| is not empty and there is a session for |key| that has an
-  // unclaimed push stream for |url|, return it.
-  // Otherwise if there is an available session for |key|, return it.
+  // unclaimed push stream for |url|, return it (this doubles as a stickiness
+  // hint: the stream is routed to the session already serving the origin's
+  // pushes).
+  // Otherwise if there are available sessions for |key|, return the least
+  // loaded one (fewest active streams), preferring sessions that are not
+  // send-stalled. If all of them are send-stalled and fewer than
+  // max_sessions_per_origin() exist, return nullptr so that the caller dials
+  // an additional parallel session.
   // Otherwise if there is a session to pool to based on IP address:
   //   * if |enable_ip_based_pooling == true|,
   //     then mark it as available for |key| and return it;
@@ -144,6 +151,17 @@ class NET_EXPORT SpdySessionPool
     push_delegate_ = push_delegate;
   }
 
+  // The maximum number of parallel sessions FindAvailableSession() will ask
+  // the caller to open per origin. One (the default) preserves the classic
+  // funnel-everything-onto-one-session behavior; larger values let an origin
+  // spread streams over several connections' congestion windows when the
+  // existing sessions are send-stalled.
+  size_t max_sessions_per_origin() const { return max_sessions_per_origin_; }
+  void set_max_sessions_per_origin(size_t max_sessions) {
+    DCHECK_GE(max_sessions, 1u);
+    max_sessions_per_origin_ = max_sessions;
+  }
+
   // NetworkChangeNotifier::IPAddressObserver methods:
 
   // We flush all idle sessions and release references to the active ones so
@@ -204,16 +222,17 @@ class NET_EXPORT SpdySessionPool
   typedef std::map<SpdySessionKey, RequestSet> SpdySessionRequestMap;
   typedef std::set<SpdySession*> SessionSet;
   typedef std::vector<base::WeakPtr<SpdySession> > WeakSessionList;
-  typedef std::map<SpdySessionKey, base::WeakPtr<SpdySession> >
-      AvailableSessionMap;
+  // Each key maps to the parallel sessions available for it. With the
+  // default max_sessions_per_origin() of one this is a list of length one.
+  typedef std::map<SpdySessionKey, WeakSessionList> AvailableSessionMap;
   typedef std::map<IPEndPoint, SpdySessionKey> AliasMap;
   typedef std::map<GURL, WeakSessionList> UnclaimedPushedStreamMap;
 
   // Returns true iff |session| is in |available_sessions_|.
   bool IsSessionAvailable(const base::WeakPtr<SpdySession>& session) const;
 
-  // Map the given key to the given session. There must not already be
-  // a mapping for |key|.
+  // Add the given session to the sessions available for |key|. The session
+  // must not already be mapped to |key|.
   void MapKeyToAvailableSession(const SpdySessionKey& key,
                                 const base::WeakPtr<SpdySession>& session);
 
@@ -222,9 +241,20 @@ class NET_EXPORT SpdySessionPool
   AvailableSessionMap::iterator LookupAvailableSessionByKey(
       const SpdySessionKey& key);
 
+  // Prunes dead WeakPtrs from |sessions| and returns the session with the
+  // fewest active streams, preferring sessions that are not send-stalled.
+  // Returns a null WeakPtr if the list is empty after pruning.
+  base::WeakPtr<SpdySession> PickLeastLoadedSession(
+      WeakSessionList* sessions) const;
+
   // Remove the mapping of the given key, which must exist.
   void UnmapKey(const SpdySessionKey& key);
 
+  // Remove |session| from the sessions mapped to |key|, erasing the mapping
+  // entirely if it was the last one. Returns true in that case. It is not an
+  // error if |session| is not mapped to |key|.
+  bool UnmapSessionFromKey(const SpdySessionKey& key, SpdySession* session);
+
   // Remove all aliases for |key| from the aliases table.
   void RemoveAliases(const SpdySessionKey& key);
 
@@ -295,6 +325,9 @@ class NET_EXPORT SpdySessionPool
   // streams. May be nullptr.
   ProxyDelegate* proxy_delegate_;
 
+  // See max_sessions_per_origin().
+  size_t max_sessions_per_origin_;
+
   DISALLOW_COPY_AND_ASSIGN(SpdySessionPool);
 };
 
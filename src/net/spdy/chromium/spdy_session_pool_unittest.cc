@@ -20,7 +20,9 @@
 #include "net/log/net_log_with_source.h"
 #include "net/log/test_net_log.h"
 #include "net/log/test_net_log_entry.h"
+#include "net/base/test_completion_callback.h"
 #include "net/socket/client_socket_handle.h"
+#include "net/socket/ssl_client_socket_pool.h"
 #include "net/socket/transport_client_socket_pool.h"
 #include "net/spdy/chromium/spdy_session.h"
 #include "net/spdy/chromium/spdy_stream_test_util.h"
@@ -839,6 +841,75 @@ TEST_F(SpdySessionPoolTest, FindAvailableSession) {
   spdy_session_pool_->CloseCurrentSessions(ERR_ABORTED);
 }
 
+TEST_F(SpdySessionPoolTest, MultipleSessionsPerOrigin) {
+  SpdySessionKey key(HostPortPair("www.example.org", 443),
+                     ProxyServer::Direct(), PRIVACY_MODE_DISABLED);
+
+  MockRead reads1[] = {MockRead(SYNCHRONOUS, ERR_IO_PENDING)};
+  StaticSocketDataProvider data1(reads1, arraysize(reads1), nullptr, 0);
+  data1.set_connect_data(MockConnect(SYNCHRONOUS, OK));
+  session_deps_.socket_factory->AddSocketDataProvider(&data1);
+  MockRead reads2[] = {MockRead(SYNCHRONOUS, ERR_IO_PENDING)};
+  StaticSocketDataProvider data2(reads2, arraysize(reads2), nullptr, 0);
+  data2.set_connect_data(MockConnect(SYNCHRONOUS, OK));
+  session_deps_.socket_factory->AddSocketDataProvider(&data2);
+
+  SSLSocketDataProvider ssl1(SYNCHRONOUS, OK);
+  session_deps_.socket_factory->AddSSLSocketDataProvider(&ssl1);
+  SSLSocketDataProvider ssl2(SYNCHRONOUS, OK);
+  session_deps_.socket_factory->AddSSLSocketDataProvider(&ssl2);
+
+  CreateNetworkSession();
+  spdy_session_pool_->set_max_sessions_per_origin(2);
+
+  base::WeakPtr<SpdySession> session1 =
+      CreateSpdySession(http_session_.get(), key, NetLogWithSource());
+  base::RunLoop().RunUntilIdle();
+
+  // Open a second parallel session for the same key.
+  scoped_refptr<TransportSocketParams> transport_params(
+      new TransportSocketParams(
+          key.host_port_pair(), false, OnHostResolutionCallback(),
+          TransportSocketParams::COMBINE_CONNECT_AND_WRITE_DEFAULT));
+  SSLConfig ssl_config;
+  scoped_refptr<SSLSocketParams> ssl_params(
+      new SSLSocketParams(transport_params, NULL, NULL, key.host_port_pair(),
+                          ssl_config, key.privacy_mode(), 0, false));
+  auto connection = base::MakeUnique<ClientSocketHandle>();
+  TestCompletionCallback callback;
+  int rv = connection->Init(
+      key.host_port_pair().ToString(), ssl_params, MEDIUM,
+      ClientSocketPool::RespectLimits::ENABLED, callback.callback(),
+      http_session_->GetSSLSocketPool(HttpNetworkSession::NORMAL_SOCKET_POOL),
+      NetLogWithSource());
+  if (rv == ERR_IO_PENDING)
+    rv = callback.WaitForResult();
+  EXPECT_THAT(rv, IsOk());
+  base::WeakPtr<SpdySession> session2 =
+      spdy_session_pool_->CreateAvailableSessionFromSocket(
+          key, std::move(connection), NetLogWithSource());
+  base::RunLoop().RunUntilIdle();
+
+  // Both sessions are mapped to |key|; with neither of them loaded the pool
+  // hands out one of the two instead of asking for a third.
+  base::WeakPtr<SpdySession> found = spdy_session_pool_->FindAvailableSession(
+      key, GURL(),
+      /* enable_ip_based_pooling = */ true, NetLogWithSource());
+  ASSERT_TRUE(found);
+  EXPECT_TRUE(found.get() == session1.get() || found.get() == session2.get());
+
+  // Closing one of the parallel sessions leaves the other available.
+  session1->CloseSessionOnError(ERR_ABORTED, "Closing session1.");
+  base::RunLoop().RunUntilIdle();
+  EXPECT_FALSE(session1);
+  found = spdy_session_pool_->FindAvailableSession(
+      key, GURL(),
+      /* enable_ip_based_pooling = */ true, NetLogWithSource());
+  EXPECT_EQ(session2.get(), found.get());
+
+  spdy_session_pool_->CloseCurrentSessions(ERR_ABORTED);
+}
+
 class SpdySessionMemoryDumpTest
     : public SpdySessionPoolTest,
       public testing::WithParamInterface<
@@ -0,0 +1,362 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_SPDY_CORE_DEADLINE_WRITE_SCHEDULER_H_
+#define NET_SPDY_CORE_DEADLINE_WRITE_SCHEDULER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "base/logging.h"
+#include "net/spdy/core/spdy_bug_tracker.h"
+#include "net/spdy/core/spdy_protocol.h"
+#include "net/spdy/core/write_scheduler.h"
+
+namespace net {
+
+namespace test {
+template <typename StreamIdType>
+class DeadlineWriteSchedulerPeer;
+}
+
+// WriteScheduler implementation for transports carrying deadlined requests
+// (e.g. internal RPCs). Scheduling is SPDY-priority first, exactly as in
+// PriorityWriteScheduler, but within each priority band ready streams are
+// ordered earliest-deadline-first instead of FIFO, so a request with 5ms
+// remaining does not queue behind one with 500ms. Streams without a deadline
+// sort after all deadlined streams in their band and retain FIFO order among
+// themselves.
+//
+// Deadlines are attached with SetStreamDeadline() (microseconds on the
+// caller's clock, 0 meaning none) and may be updated at any time. Streams
+// whose deadline has passed can be harvested wholesale with
+// PopExpiredStreams(), letting the session cancel their writes instead of
+// spending bandwidth on bytes the caller will discard.
+template <typename StreamIdType>
+class SPDY_EXPORT_PRIVATE DeadlineWriteScheduler
+    : public WriteScheduler<StreamIdType> {
+ public:
+  using typename WriteScheduler<StreamIdType>::StreamPrecedenceType;
+
+  // Deadline value meaning "no deadline".
+  static const int64_t kNoDeadline = 0;
+
+  DeadlineWriteScheduler() = default;
+
+  void RegisterStream(StreamIdType stream_id,
+                      const StreamPrecedenceType& precedence) override {
+    SPDY_BUG_IF(!precedence.is_spdy3_priority()) << "Expected SPDY priority";
+
+    if (stream_id == kHttp2RootStreamId) {
+      SPDY_BUG << "Stream " << kHttp2RootStreamId << " already registered";
+      return;
+    }
+    StreamInfo stream_info;
+    stream_info.stream_id = stream_id;
+    stream_info.priority = precedence.spdy3_priority();
+    stream_info.deadline_usec = kNoDeadline;
+    stream_info.ready = false;
+    bool inserted =
+        stream_infos_.insert(std::make_pair(stream_id, stream_info)).second;
+    SPDY_BUG_IF(!inserted) << "Stream " << stream_id << " already registered";
+  }
+
+  void UnregisterStream(StreamIdType stream_id) override {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      SPDY_BUG << "Stream " << stream_id << " not registered";
+      return;
+    }
+    if (it->second.ready) {
+      EraseFromReadyList(&it->second);
+    }
+    stream_infos_.erase(it);
+  }
+
+  bool StreamRegistered(StreamIdType stream_id) const override {
+    return stream_infos_.find(stream_id) != stream_infos_.end();
+  }
+
+  StreamPrecedenceType GetStreamPrecedence(
+      StreamIdType stream_id) const override {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      DVLOG(1) << "Stream " << stream_id << " not registered";
+      return StreamPrecedenceType(kV3LowestPriority);
+    }
+    return StreamPrecedenceType(it->second.priority);
+  }
+
+  void UpdateStreamPrecedence(StreamIdType stream_id,
+                              const StreamPrecedenceType& precedence) override {
+    SPDY_BUG_IF(!precedence.is_spdy3_priority()) << "Expected SPDY priority";
+
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      DVLOG(1) << "Stream " << stream_id << " not registered";
+      return;
+    }
+    StreamInfo& stream_info = it->second;
+    SpdyPriority new_priority = precedence.spdy3_priority();
+    if (stream_info.priority == new_priority) {
+      return;
+    }
+    if (stream_info.ready) {
+      EraseFromReadyList(&stream_info);
+      stream_info.priority = new_priority;
+      InsertIntoReadyList(&stream_info, /*add_to_front=*/false);
+    } else {
+      stream_info.priority = new_priority;
+    }
+  }
+
+  std::vector<StreamIdType> GetStreamChildren(
+      StreamIdType stream_id) const override {
+    return std::vector<StreamIdType>();
+  }
+
+  void RecordStreamEventTime(StreamIdType stream_id,
+                             int64_t now_in_usec) override {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      SPDY_BUG << "Stream " << stream_id << " not registered";
+      return;
+    }
+    PriorityInfo& priority_info = priority_infos_[it->second.priority];
+    priority_info.last_event_time_usec =
+        std::max(priority_info.last_event_time_usec, now_in_usec);
+  }
+
+  int64_t GetLatestEventWithPrecedence(StreamIdType stream_id) const override {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      SPDY_BUG << "Stream " << stream_id << " not registered";
+      return 0;
+    }
+    int64_t last_event_time_usec = 0;
+    for (SpdyPriority p = kV3HighestPriority; p < it->second.priority; ++p) {
+      last_event_time_usec = std::max(last_event_time_usec,
+                                      priority_infos_[p].last_event_time_usec);
+    }
+    return last_event_time_usec;
+  }
+
+  StreamIdType PopNextReadyStream() override {
+    return std::get<0>(PopNextReadyStreamAndPrecedence());
+  }
+
+  std::tuple<StreamIdType, StreamPrecedenceType>
+  PopNextReadyStreamAndPrecedence() override {
+    for (SpdyPriority p = kV3HighestPriority; p <= kV3LowestPriority; ++p) {
+      ReadyList& ready_list = priority_infos_[p].ready_list;
+      if (!ready_list.empty()) {
+        StreamInfo* info = ready_list.begin()->second;
+        ready_list.erase(ready_list.begin());
+        --num_ready_streams_;
+        info->ready = false;
+        return std::make_tuple(info->stream_id,
+                               StreamPrecedenceType(info->priority));
+      }
+    }
+    SPDY_BUG << "No ready streams available";
+    return std::make_tuple(0, StreamPrecedenceType(kV3LowestPriority));
+  }
+
+  bool ShouldYield(StreamIdType stream_id) const override {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      SPDY_BUG << "Stream " << stream_id << " not registered";
+      return false;
+    }
+
+    const StreamInfo& stream_info = it->second;
+    for (SpdyPriority p = kV3HighestPriority; p < stream_info.priority; ++p) {
+      if (!priority_infos_[p].ready_list.empty()) {
+        return true;
+      }
+    }
+
+    const ReadyList& ready_list = priority_infos_[stream_info.priority].ready_list;
+    if (ready_list.empty() ||
+        ready_list.begin()->second->stream_id == stream_id) {
+      return false;
+    }
+    return true;
+  }
+
+  void MarkStreamReady(StreamIdType stream_id, bool add_to_front) override {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      SPDY_BUG << "Stream " << stream_id << " not registered";
+      return;
+    }
+    StreamInfo& stream_info = it->second;
+    if (stream_info.ready) {
+      return;
+    }
+    InsertIntoReadyList(&stream_info, add_to_front);
+    stream_info.ready = true;
+  }
+
+  void MarkStreamNotReady(StreamIdType stream_id) override {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      SPDY_BUG << "Stream " << stream_id << " not registered";
+      return;
+    }
+    StreamInfo& stream_info = it->second;
+    if (!stream_info.ready) {
+      return;
+    }
+    EraseFromReadyList(&stream_info);
+    stream_info.ready = false;
+  }
+
+  bool HasReadyStreams() const override { return num_ready_streams_ > 0; }
+
+  size_t NumReadyStreams() const override { return num_ready_streams_; }
+
+  // Attaches |deadline_usec| (microseconds, same clock as
+  // PopExpiredStreams()'s |now_in_usec|; kNoDeadline clears it) to the given
+  // stream. If the stream is ready it is repositioned within its priority
+  // band.
+  //
+  // Preconditions: |stream_id| should be registered.
+  void SetStreamDeadline(StreamIdType stream_id, int64_t deadline_usec) {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      SPDY_BUG << "Stream " << stream_id << " not registered";
+      return;
+    }
+    StreamInfo& stream_info = it->second;
+    if (stream_info.deadline_usec == deadline_usec) {
+      return;
+    }
+    if (stream_info.ready) {
+      EraseFromReadyList(&stream_info);
+      stream_info.deadline_usec = deadline_usec;
+      InsertIntoReadyList(&stream_info, /*add_to_front=*/false);
+    } else {
+      stream_info.deadline_usec = deadline_usec;
+    }
+  }
+
+  // Returns the stream's deadline, or kNoDeadline if none is attached.
+  //
+  // Preconditions: |stream_id| should be registered.
+  int64_t GetStreamDeadline(StreamIdType stream_id) const {
+    auto it = stream_infos_.find(stream_id);
+    if (it == stream_infos_.end()) {
+      SPDY_BUG << "Stream " << stream_id << " not registered";
+      return kNoDeadline;
+    }
+    return it->second.deadline_usec;
+  }
+
+  // Removes every ready stream whose deadline is at or before |now_in_usec|
+  // from the scheduling queues and returns their ids, so the caller can
+  // cancel the writes wholesale (e.g. by resetting the streams) instead of
+  // sending bytes the peer will discard. The streams remain registered but
+  // become not ready.
+  std::vector<StreamIdType> PopExpiredStreams(int64_t now_in_usec) {
+    std::vector<StreamIdType> expired;
+    for (SpdyPriority p = kV3HighestPriority; p <= kV3LowestPriority; ++p) {
+      ReadyList& ready_list = priority_infos_[p].ready_list;
+      while (!ready_list.empty() &&
+             ready_list.begin()->first.deadline_usec != kNoDeadline &&
+             ready_list.begin()->first.deadline_usec <= now_in_usec) {
+        StreamInfo* info = ready_list.begin()->second;
+        ready_list.erase(ready_list.begin());
+        --num_ready_streams_;
+        info->ready = false;
+        expired.push_back(info->stream_id);
+      }
+    }
+    return expired;
+  }
+
+ private:
+  friend class test::DeadlineWriteSchedulerPeer<StreamIdType>;
+
+  // Ready-list ordering key: earliest deadline first, deadline-less streams
+  // last, FIFO among equals via |sequence|.
+  struct ReadyKey {
+    int64_t deadline_usec;
+    uint64_t sequence;
+
+    bool operator<(const ReadyKey& other) const {
+      int64_t lhs = deadline_usec == kNoDeadline ? INT64_MAX : deadline_usec;
+      int64_t rhs =
+          other.deadline_usec == kNoDeadline ? INT64_MAX : other.deadline_usec;
+      if (lhs != rhs) {
+        return lhs < rhs;
+      }
+      return sequence < other.sequence;
+    }
+  };
+
+  struct StreamInfo;
+  typedef std::map<ReadyKey, StreamInfo*> ReadyList;
+
+  // State kept for all registered streams.
+  struct StreamInfo {
+    StreamIdType stream_id;
+    SpdyPriority priority;
+    int64_t deadline_usec;
+    bool ready;
+    // Position in the owning ready list; valid only when |ready|.
+    typename ReadyList::iterator ready_it;
+  };
+
+  // State kept for each priority level.
+  struct PriorityInfo {
+    ReadyList ready_list;
+    // Time of latest write event for streams of this priority.
+    int64_t last_event_time_usec = 0;
+  };
+
+  void InsertIntoReadyList(StreamInfo* info, bool add_to_front) {
+    // Earlier sequence numbers sort first, so front insertion gets a number
+    // below every previously issued one.
+    ReadyKey key;
+    key.deadline_usec = info->deadline_usec;
+    key.sequence = add_to_front ? front_sequence_-- : back_sequence_++;
+    info->ready_it = priority_infos_[info->priority].ready_list
+                         .insert(std::make_pair(key, info))
+                         .first;
+    ++num_ready_streams_;
+  }
+
+  void EraseFromReadyList(StreamInfo* info) {
+    priority_infos_[info->priority].ready_list.erase(info->ready_it);
+    --num_ready_streams_;
+  }
+
+  typedef std::unordered_map<StreamIdType, StreamInfo> StreamInfoMap;
+
+  // Number of ready streams.
+  size_t num_ready_streams_ = 0;
+  // Sequence counters for FIFO ordering among equal deadlines. Front
+  // insertions count down from the midpoint, back insertions count up.
+  uint64_t back_sequence_ = UINT64_MAX / 2;
+  uint64_t front_sequence_ = UINT64_MAX / 2 - 1;
+  // Per-priority state, including ready lists.
+  PriorityInfo priority_infos_[kV3LowestPriority + 1];
+  // StreamInfos for all registered streams.
+  StreamInfoMap stream_infos_;
+};
+
+// static
+template <typename StreamIdType>
+const int64_t DeadlineWriteScheduler<StreamIdType>::kNoDeadline;
+
+}  // namespace net
+
+#endif  // NET_SPDY_CORE_DEADLINE_WRITE_SCHEDULER_H_
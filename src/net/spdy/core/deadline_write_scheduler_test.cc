@@ -0,0 +1,177 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/spdy/core/deadline_write_scheduler.h"
+
+#include "net/spdy/core/spdy_protocol.h"
+#include "net/spdy/core/spdy_test_utils.h"
+#include "net/test/gtest_util.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class DeadlineWriteSchedulerTest : public ::testing::Test {
+ public:
+  DeadlineWriteScheduler<SpdyStreamId> scheduler_;
+};
+
+TEST_F(DeadlineWriteSchedulerTest, RegisterUnregisterStreams) {
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+  EXPECT_FALSE(scheduler_.StreamRegistered(1));
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(1));
+  EXPECT_TRUE(scheduler_.StreamRegistered(1));
+
+  EXPECT_SPDY_BUG(scheduler_.RegisterStream(1, SpdyStreamPrecedence(1)),
+                  "Stream 1 already registered");
+
+  scheduler_.MarkStreamReady(1, false);
+  EXPECT_TRUE(scheduler_.HasReadyStreams());
+  scheduler_.UnregisterStream(1);
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+  EXPECT_FALSE(scheduler_.StreamRegistered(1));
+}
+
+TEST_F(DeadlineWriteSchedulerTest, EarliestDeadlineFirstWithinPriority) {
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(3, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(5, SpdyStreamPrecedence(3));
+  scheduler_.SetStreamDeadline(1, 500);
+  scheduler_.SetStreamDeadline(3, 5);
+  scheduler_.SetStreamDeadline(5, 50);
+
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+  scheduler_.MarkStreamReady(5, false);
+
+  EXPECT_EQ(3u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(5u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(1u, scheduler_.PopNextReadyStream());
+  EXPECT_FALSE(scheduler_.HasReadyStreams());
+}
+
+TEST_F(DeadlineWriteSchedulerTest, PriorityBandsTrumpDeadlines) {
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(5));
+  scheduler_.RegisterStream(3, SpdyStreamPrecedence(2));
+  scheduler_.SetStreamDeadline(1, 5);  // Urgent, but lower priority.
+  scheduler_.SetStreamDeadline(3, 500);
+
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+
+  EXPECT_EQ(3u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(1u, scheduler_.PopNextReadyStream());
+}
+
+TEST_F(DeadlineWriteSchedulerTest, DeadlinelessStreamsKeepFifoOrder) {
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(3, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(5, SpdyStreamPrecedence(3));
+  scheduler_.SetStreamDeadline(5, 100);
+
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+  scheduler_.MarkStreamReady(5, false);
+
+  // The deadlined stream goes first; the rest drain FIFO.
+  EXPECT_EQ(5u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(1u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(3u, scheduler_.PopNextReadyStream());
+}
+
+TEST_F(DeadlineWriteSchedulerTest, MarkStreamReadyAddToFront) {
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(3, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(5, SpdyStreamPrecedence(3));
+
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+  scheduler_.MarkStreamReady(5, true);
+
+  EXPECT_EQ(5u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(1u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(3u, scheduler_.PopNextReadyStream());
+}
+
+TEST_F(DeadlineWriteSchedulerTest, UpdatingDeadlineRepositionsStream) {
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(3, SpdyStreamPrecedence(3));
+  scheduler_.SetStreamDeadline(1, 10);
+  scheduler_.SetStreamDeadline(3, 20);
+
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+
+  // Stream 3's deadline tightens past stream 1's.
+  scheduler_.SetStreamDeadline(3, 5);
+  EXPECT_EQ(5, scheduler_.GetStreamDeadline(3));
+
+  EXPECT_EQ(3u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(1u, scheduler_.PopNextReadyStream());
+}
+
+TEST_F(DeadlineWriteSchedulerTest, ShouldYield) {
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(3, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(5, SpdyStreamPrecedence(1));
+  scheduler_.SetStreamDeadline(3, 5);
+
+  scheduler_.MarkStreamReady(1, false);
+  EXPECT_FALSE(scheduler_.ShouldYield(1));
+
+  // A tighter deadline in the same band takes precedence.
+  scheduler_.MarkStreamReady(3, false);
+  EXPECT_TRUE(scheduler_.ShouldYield(1));
+  EXPECT_FALSE(scheduler_.ShouldYield(3));
+
+  // A ready higher-priority stream preempts both.
+  scheduler_.MarkStreamReady(5, false);
+  EXPECT_TRUE(scheduler_.ShouldYield(3));
+}
+
+TEST_F(DeadlineWriteSchedulerTest, PopExpiredStreams) {
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(3, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(5, SpdyStreamPrecedence(1));
+  scheduler_.RegisterStream(7, SpdyStreamPrecedence(3));
+  scheduler_.SetStreamDeadline(1, 100);
+  scheduler_.SetStreamDeadline(3, 300);
+  scheduler_.SetStreamDeadline(5, 50);
+  // Stream 7 has no deadline and never expires.
+
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+  scheduler_.MarkStreamReady(5, false);
+  scheduler_.MarkStreamReady(7, false);
+
+  std::vector<SpdyStreamId> expired = scheduler_.PopExpiredStreams(200);
+  ASSERT_EQ(2u, expired.size());
+  EXPECT_EQ(5u, expired[0]);  // Higher priority band is drained first.
+  EXPECT_EQ(1u, expired[1]);
+
+  // Expired streams are no longer ready but remain registered.
+  EXPECT_TRUE(scheduler_.StreamRegistered(1));
+  EXPECT_TRUE(scheduler_.StreamRegistered(5));
+  EXPECT_EQ(2u, scheduler_.NumReadyStreams());
+
+  EXPECT_EQ(3u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(7u, scheduler_.PopNextReadyStream());
+}
+
+TEST_F(DeadlineWriteSchedulerTest, UpdateStreamPrecedenceMovesReadyStream) {
+  scheduler_.RegisterStream(1, SpdyStreamPrecedence(3));
+  scheduler_.RegisterStream(3, SpdyStreamPrecedence(5));
+  scheduler_.MarkStreamReady(1, false);
+  scheduler_.MarkStreamReady(3, false);
+
+  scheduler_.UpdateStreamPrecedence(3, SpdyStreamPrecedence(1));
+  EXPECT_EQ(1, scheduler_.GetStreamPrecedence(3).spdy3_priority());
+
+  EXPECT_EQ(3u, scheduler_.PopNextReadyStream());
+  EXPECT_EQ(1u, scheduler_.PopNextReadyStream());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -24,7 +24,10 @@ struct SharedHpackHuffmanTable {
   SharedHpackHuffmanTable() {
     std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
     auto mutable_table = SpdyMakeUnique<HpackHuffmanTable>();
-    CHECK(mutable_table->Initialize(&code[0], code.size()));
+    // The RFC 7541 code is compile-time data whose canonical validity is
+    // enforced by tests through Initialize(); skip re-validating it on every
+    // process start.
+    mutable_table->InitializeFromCanonicalCode(&code[0], code.size());
     CHECK(mutable_table->IsInitialized());
     table = std::move(mutable_table);
   }
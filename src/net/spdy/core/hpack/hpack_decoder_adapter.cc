@@ -19,6 +19,7 @@ const size_t kMaxDecodeBufferSizeBytes = 32 * 1024;  // 32 KB
 HpackDecoderAdapter::HpackDecoderAdapter()
     : hpack_decoder_(&listener_adapter_, kMaxDecodeBufferSizeBytes),
       max_decode_buffer_size_bytes_(kMaxDecodeBufferSizeBytes),
+      max_uncompressed_block_size_bytes_(0),
       header_block_started_(false) {}
 
 HpackDecoderAdapter::~HpackDecoderAdapter() {}
@@ -64,6 +65,15 @@ bool HpackDecoderAdapter::HandleControlFrameHeadersData(
     DecodeBuffer db(headers_data, headers_data_length);
     bool ok = hpack_decoder_.DecodeFragment(&db);
     DCHECK(!ok || db.Empty()) << "Remaining=" << db.Remaining();
+    if (ok && max_uncompressed_block_size_bytes_ > 0 &&
+        listener_adapter_.total_uncompressed_bytes() >
+            max_uncompressed_block_size_bytes_) {
+      VLOG(1) << "Uncompressed block size "
+              << listener_adapter_.total_uncompressed_bytes()
+              << " exceeds max_uncompressed_block_size_bytes_: "
+              << max_uncompressed_block_size_bytes_;
+      return false;
+    }
     return ok;
   }
   return true;
@@ -106,6 +116,12 @@ void HpackDecoderAdapter::set_max_decode_buffer_size_bytes(
   hpack_decoder_.set_max_string_size_bytes(max_decode_buffer_size_bytes);
 }
 
+void HpackDecoderAdapter::set_max_uncompressed_block_size_bytes(
+    size_t max_uncompressed_block_size_bytes) {
+  DVLOG(2) << "HpackDecoderAdapter::set_max_uncompressed_block_size_bytes";
+  max_uncompressed_block_size_bytes_ = max_uncompressed_block_size_bytes;
+}
+
 size_t HpackDecoderAdapter::EstimateMemoryUsage() const {
   return SpdyEstimateMemoryUsage(hpack_decoder_);
 }
@@ -77,6 +77,13 @@ class SPDY_EXPORT_PRIVATE HpackDecoderAdapter {
   // of individual transport buffers.
   void set_max_decode_buffer_size_bytes(size_t max_decode_buffer_size_bytes);
 
+  // Sets a hard limit on the total bytes of decompressed name and value
+  // strings produced by a single HPACK block; decoding fails once the limit
+  // is exceeded, bounding the compressed-to-decompressed expansion an
+  // adversarial peer can force. Zero (the default) means no limit.
+  void set_max_uncompressed_block_size_bytes(
+      size_t max_uncompressed_block_size_bytes);
+
   size_t EstimateMemoryUsage() const;
 
  private:
@@ -114,6 +121,9 @@ class SPDY_EXPORT_PRIVATE HpackDecoderAdapter {
 
     void AddToTotalHpackBytes(size_t delta) { total_hpack_bytes_ += delta; }
     size_t total_hpack_bytes() const { return total_hpack_bytes_; }
+    size_t total_uncompressed_bytes() const {
+      return total_uncompressed_bytes_;
+    }
 
    private:
     // If the caller doesn't provide a handler, the header list is stored in
@@ -145,6 +155,10 @@ class SPDY_EXPORT_PRIVATE HpackDecoderAdapter {
   // How much encoded data this decoder is willing to buffer.
   size_t max_decode_buffer_size_bytes_;
 
+  // Hard cap on the decompressed size of a single HPACK block; zero means
+  // no limit. See set_max_uncompressed_block_size_bytes().
+  size_t max_uncompressed_block_size_bytes_;
+
   // Flag to keep track of having seen the header block start. Needed at the
   // moment because HandleControlFrameHeadersStart won't be called if a handler
   // is not being provided by the caller.
@@ -321,6 +321,26 @@ TEST_P(HpackDecoderAdapterTest, HeaderTooLongToBuffer) {
   EXPECT_FALSE(HandleControlFrameHeadersData(fragment));
 }
 
+TEST_P(HpackDecoderAdapterTest, UncompressedBlockSizeLimit) {
+  // Verify that decoding fails once a block's decompressed size exceeds
+  // max_uncompressed_block_size_bytes, and that a block under the limit is
+  // unaffected.
+  decoder_.set_max_uncompressed_block_size_bytes(32);
+
+  HpackBlockBuilder under_limit;
+  under_limit.AppendLiteralNameAndValue(
+      HpackEntryType::kNeverIndexedLiteralHeader, false, "name", false,
+      SpdyString(20, 'x'));
+  EXPECT_TRUE(DecodeHeaderBlock(under_limit.buffer()));
+
+  HpackBlockBuilder over_limit;
+  over_limit.AppendLiteralNameAndValue(
+      HpackEntryType::kNeverIndexedLiteralHeader, false, "name", false,
+      SpdyString(40, 'x'));
+  HandleControlFrameHeadersStart();
+  EXPECT_FALSE(HandleControlFrameHeadersData(over_limit.buffer()));
+}
+
 // Decode with incomplete data in buffer.
 TEST_P(HpackDecoderAdapterTest, DecodeWithIncompleteData) {
   HandleControlFrameHeadersStart();
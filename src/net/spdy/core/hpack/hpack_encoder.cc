@@ -72,6 +72,17 @@ bool DefaultPolicy(SpdyStringPiece name, SpdyStringPiece /* value */) {
   return true;
 }
 
+// An upper bound on the encoded size of a sequence of representations: each
+// header is emitted as at most a pair of literal strings, each preceded by up
+// to five bytes of length prefix, plus one byte of opcode.
+size_t EncodedSizeEstimate(const HpackEncoder::Representations& headers) {
+  size_t estimate = 0;
+  for (const auto& header : headers) {
+    estimate += header.first.size() + header.second.size() + 11;
+  }
+  return estimate;
+}
+
 }  // namespace
 
 HpackEncoder::HpackEncoder(const HpackHuffmanTable& table)
@@ -87,6 +98,7 @@ HpackEncoder::~HpackEncoder() {}
 
 void HpackEncoder::EncodeHeaderSet(const Representations& representations,
                                    SpdyString* output) {
+  output_stream_.Reserve(EncodedSizeEstimate(representations));
   RepresentationIterator iter(representations);
   EncodeRepresentations(&iter, output);
 }
@@ -111,6 +123,8 @@ bool HpackEncoder::EncodeHeaderSet(const SpdyHeaderBlock& header_set,
     }
   }
 
+  output_stream_.Reserve(EncodedSizeEstimate(pseudo_headers) +
+                         EncodedSizeEstimate(regular_headers));
   {
     RepresentationIterator iter(pseudo_headers, regular_headers);
     EncodeRepresentations(&iter, output);
@@ -195,13 +209,15 @@ void HpackEncoder::EmitLiteral(const Representation& representation) {
 }
 
 void HpackEncoder::EmitString(SpdyStringPiece str) {
-  size_t encoded_size =
-      enable_compression_ ? huffman_table_.EncodedSize(str) : str.size();
-  if (encoded_size < str.size()) {
-    DVLOG(2) << "Emitted Huffman-encoded string of length " << encoded_size;
+  // The Huffman encoding is built in a single pass over |str|, rather than
+  // sizing it with EncodedSize() and then encoding in a second pass.
+  if (enable_compression_ &&
+      huffman_table_.EncodeStringIfShorter(str, &huffman_buffer_)) {
+    DVLOG(2) << "Emitted Huffman-encoded string of length "
+             << huffman_buffer_.size();
     output_stream_.AppendPrefix(kStringLiteralHuffmanEncoded);
-    output_stream_.AppendUint32(encoded_size);
-    huffman_table_.EncodeString(str, &output_stream_);
+    output_stream_.AppendUint32(huffman_buffer_.size());
+    output_stream_.AppendBytes(huffman_buffer_);
   } else {
     DVLOG(2) << "Emitted literal string of length " << str.size();
     output_stream_.AppendPrefix(kStringLiteralIdentityEncoded);
@@ -330,6 +346,8 @@ HpackEncoder::Encoderator::Encoderator(const SpdyHeaderBlock& header_set,
   header_it_ =
       SpdyMakeUnique<RepresentationIterator>(pseudo_headers_, regular_headers_);
 
+  encoder_->output_stream_.Reserve(EncodedSizeEstimate(pseudo_headers_) +
+                                   EncodedSizeEstimate(regular_headers_));
   encoder_->MaybeEmitTableSize();
 }
 
@@ -142,6 +142,9 @@ class SPDY_EXPORT_PRIVATE HpackEncoder {
   HpackOutputStream output_stream_;
 
   const HpackHuffmanTable& huffman_table_;
+  // Scratch buffer reused across EmitString() calls for Huffman encoding, so
+  // a header block pays for at most one allocation.
+  SpdyString huffman_buffer_;
   size_t min_table_size_setting_received_;
   HeaderListener listener_;
   IndexingPolicy should_index_;
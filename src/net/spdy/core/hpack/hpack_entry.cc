@@ -22,6 +22,7 @@ HpackEntry::HpackEntry(SpdyStringPiece name,
       value_ref_(value_),
       insertion_index_(insertion_index),
       type_(is_static ? STATIC : DYNAMIC),
+      hash_(Hash(name, value)),
       time_added_(0) {}
 
 HpackEntry::HpackEntry(SpdyStringPiece name, SpdyStringPiece value)
@@ -29,13 +30,19 @@ HpackEntry::HpackEntry(SpdyStringPiece name, SpdyStringPiece value)
       value_ref_(value),
       insertion_index_(0),
       type_(LOOKUP),
+      hash_(Hash(name, value)),
       time_added_(0) {}
 
-HpackEntry::HpackEntry() : insertion_index_(0), type_(LOOKUP), time_added_(0) {}
+HpackEntry::HpackEntry()
+    : insertion_index_(0),
+      type_(LOOKUP),
+      hash_(Hash(SpdyStringPiece(), SpdyStringPiece())),
+      time_added_(0) {}
 
 HpackEntry::HpackEntry(const HpackEntry& other)
     : insertion_index_(other.insertion_index_),
       type_(other.type_),
+      hash_(other.hash_),
       time_added_(0) {
   if (type_ == LOOKUP) {
     name_ref_ = other.name_ref_;
@@ -51,6 +58,7 @@ HpackEntry::HpackEntry(const HpackEntry& other)
 HpackEntry& HpackEntry::operator=(const HpackEntry& other) {
   insertion_index_ = other.insertion_index_;
   type_ = other.type_;
+  hash_ = other.hash_;
   if (type_ == LOOKUP) {
     name_ref_ = other.name_ref_;
     value_ref_ = other.value_ref_;
@@ -70,6 +78,11 @@ size_t HpackEntry::Size(SpdyStringPiece name, SpdyStringPiece value) {
   return name.size() + value.size() + kSizeOverhead;
 }
 
+// static
+size_t HpackEntry::Hash(SpdyStringPiece name, SpdyStringPiece value) {
+  return base::StringPieceHash()(name) ^ base::StringPieceHash()(value);
+}
+
 size_t HpackEntry::Size() const {
   return Size(name(), value());
 }
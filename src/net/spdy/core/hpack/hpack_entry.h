@@ -70,6 +70,14 @@ class SPDY_EXPORT_PRIVATE HpackEntry {
   static size_t Size(SpdyStringPiece name, SpdyStringPiece value);
   size_t Size() const;
 
+  // Returns the hash of a name-value pair, as used by the indexing data
+  // structures of HpackHeaderTable.
+  static size_t Hash(SpdyStringPiece name, SpdyStringPiece value);
+
+  // The hash of this entry's name and value, computed at construction so that
+  // index insertions, lookups and rehashes need not touch the strings again.
+  size_t hash() const { return hash_; }
+
   SpdyString GetDebugString() const;
 
   int64_t time_added() const { return time_added_; }
@@ -100,6 +108,9 @@ class SPDY_EXPORT_PRIVATE HpackEntry {
 
   EntryType type_;
 
+  // Precomputed hash of the name and value; see hash().
+  size_t hash_;
+
   // For HpackHeaderTable::DebugVisitorInterface
   int64_t time_added_;
 };
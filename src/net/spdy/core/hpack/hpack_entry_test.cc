@@ -88,6 +88,19 @@ TEST_F(HpackEntryTest, DefaultConstructor) {
   EXPECT_EQ(HpackEntry::kSizeOverhead, entry.Size());
 }
 
+TEST_F(HpackEntryTest, HashIsPrecomputed) {
+  HpackEntry entry(DynamicEntry());
+
+  EXPECT_EQ(HpackEntry::Hash(name_, value_), entry.hash());
+
+  // The hash survives copies, and lookup entries hash identically to table
+  // entries with the same name and value.
+  HpackEntry copy(entry);
+  HpackEntry lookup(name_, value_);
+  EXPECT_EQ(entry.hash(), copy.hash());
+  EXPECT_EQ(entry.hash(), lookup.hash());
+}
+
 TEST_F(HpackEntryTest, IndexUpdate) {
   HpackEntry static1(StaticEntry());
   HpackEntry static2(StaticEntry());
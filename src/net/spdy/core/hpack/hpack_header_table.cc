@@ -15,8 +15,7 @@ namespace net {
 
 size_t HpackHeaderTable::EntryHasher::operator()(
     const HpackEntry* entry) const {
-  return base::StringPieceHash()(entry->name()) ^
-         base::StringPieceHash()(entry->value());
+  return entry->hash();
 }
 
 bool HpackHeaderTable::EntriesEq::operator()(const HpackEntry* lhs,
@@ -116,9 +115,8 @@ void HpackHeaderTable::SetMaxSize(size_t max_size) {
   CHECK_LE(max_size, settings_size_bound_);
 
   max_size_ = max_size;
-  if (size_ > max_size_) {
-    Evict(EvictionCountToReclaim(size_ - max_size_));
-    CHECK_LE(size_, max_size_);
+  while (size_ > max_size_) {
+    EvictOldest();
   }
 }
 
@@ -159,35 +157,43 @@ size_t HpackHeaderTable::EvictionCountToReclaim(size_t reclaim_size) const {
 
 void HpackHeaderTable::Evict(size_t count) {
   for (size_t i = 0; i != count; ++i) {
-    CHECK(!dynamic_entries_.empty());
-    HpackEntry* entry = &dynamic_entries_.back();
+    EvictOldest();
+  }
+}
 
-    size_ -= entry->Size();
-    UnorderedEntrySet::iterator it = dynamic_index_.find(entry);
-    DCHECK(it != dynamic_index_.end());
-    // Only remove an entry from the index if its insertion index matches;
-    // otherwise, the index refers to another entry with the same name and
-    // value.
-    if ((*it)->InsertionIndex() == entry->InsertionIndex()) {
-      dynamic_index_.erase(it);
-    }
-    NameToEntryMap::iterator name_it = dynamic_name_index_.find(entry->name());
-    DCHECK(name_it != dynamic_name_index_.end());
-    // Only remove an entry from the literal index if its insertion index
-    /// matches; otherwise, the index refers to another entry with the same
-    // name.
-    if (name_it->second->InsertionIndex() == entry->InsertionIndex()) {
-      dynamic_name_index_.erase(name_it);
-    }
-    dynamic_entries_.pop_back();
+void HpackHeaderTable::EvictOldest() {
+  CHECK(!dynamic_entries_.empty());
+  HpackEntry* entry = &dynamic_entries_.back();
+
+  size_ -= entry->Size();
+  UnorderedEntrySet::iterator it = dynamic_index_.find(entry);
+  DCHECK(it != dynamic_index_.end());
+  // Only remove an entry from the index if its insertion index matches;
+  // otherwise, the index refers to another entry with the same name and
+  // value.
+  if ((*it)->InsertionIndex() == entry->InsertionIndex()) {
+    dynamic_index_.erase(it);
   }
+  NameToEntryMap::iterator name_it = dynamic_name_index_.find(entry->name());
+  DCHECK(name_it != dynamic_name_index_.end());
+  // Only remove an entry from the literal index if its insertion index
+  /// matches; otherwise, the index refers to another entry with the same
+  // name.
+  if (name_it->second->InsertionIndex() == entry->InsertionIndex()) {
+    dynamic_name_index_.erase(name_it);
+  }
+  dynamic_entries_.pop_back();
 }
 
 const HpackEntry* HpackHeaderTable::TryAddEntry(SpdyStringPiece name,
                                                 SpdyStringPiece value) {
-  Evict(EvictionCountForEntry(name, value));
-
   size_t entry_size = HpackEntry::Size(name, value);
+  // Evict the oldest entries until the new entry fits, or the table is empty.
+  // This avoids the separate counting pass of EvictionCountForEntry().
+  while (entry_size > (max_size_ - size_) && !dynamic_entries_.empty()) {
+    EvictOldest();
+  }
+
   if (entry_size > (max_size_ - size_)) {
     // Entire table has been emptied, but there's still insufficient room.
     DCHECK(dynamic_entries_.empty());
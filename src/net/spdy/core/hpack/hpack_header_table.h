@@ -138,6 +138,12 @@ class SPDY_EXPORT_PRIVATE HpackHeaderTable {
   // Evicts |count| oldest entries from the table.
   void Evict(size_t count);
 
+  // Evicts the single oldest entry from the table, removing it from the
+  // dynamic indexes and decrementing |size_|. Insertion and size-change
+  // paths call this in a loop, evicting exactly as many entries as needed
+  // without a separate counting pass over the table.
+  void EvictOldest();
+
   // |static_entries_| and |static_index_| are owned by HpackStaticTable
   // singleton.
   const EntryTable& static_entries_;
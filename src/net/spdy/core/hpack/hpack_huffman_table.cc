@@ -83,6 +83,26 @@ bool HpackHuffmanTable::Initialize(const HpackHuffmanSymbol* input_symbols,
   return true;
 }
 
+void HpackHuffmanTable::InitializeFromCanonicalCode(
+    const Symbol* input_symbols,
+    size_t symbol_count) {
+  CHECK(!IsInitialized());
+  DCHECK(base::IsValueInRangeForNumericType<uint16_t>(symbol_count));
+
+  code_by_id_.reserve(symbol_count);
+  length_by_id_.reserve(symbol_count);
+  uint32_t longest_code = 0;
+  for (size_t i = 0; i < symbol_count; i++) {
+    const Symbol& symbol = input_symbols[i];
+    DCHECK_EQ(i, symbol.id);
+    code_by_id_.push_back(symbol.code);
+    length_by_id_.push_back(symbol.length);
+    // In a canonical code the longest symbol also has the largest code value.
+    longest_code = std::max(longest_code, symbol.code);
+  }
+  pad_bits_ = static_cast<uint8_t>(longest_code >> 24);
+}
+
 void HpackHuffmanTable::BuildEncodeTable(const std::vector<Symbol>& symbols) {
   for (size_t i = 0; i != symbols.size(); i++) {
     const Symbol& symbol = symbols[i];
@@ -143,6 +163,62 @@ size_t HpackHuffmanTable::EncodedSize(SpdyStringPiece in) const {
   return bit_count / 8;
 }
 
+bool HpackHuffmanTable::EncodeStringIfShorter(SpdyStringPiece in,
+                                              SpdyString* out) const {
+  out->clear();
+  if (in.empty()) {
+    // An empty encoding is never shorter than an empty string.
+    return false;
+  }
+  out->reserve(in.size());
+
+  // Codes are packed into the low bits of |accumulator|, which is flushed
+  // four bytes at a time. The longest code is 30 bits, so after appending
+  // one code at most 61 bits are pending, which fits.
+  uint64_t accumulator = 0;
+  size_t bits_in_accumulator = 0;
+  for (size_t i = 0; i != in.size(); i++) {
+    uint16_t symbol_id = static_cast<uint8_t>(in[i]);
+    CHECK_GT(code_by_id_.size(), symbol_id);
+
+    // Load, and shift code to low bits.
+    const unsigned length = length_by_id_[symbol_id];
+    const uint32_t code = code_by_id_[symbol_id] >> (32 - length);
+
+    accumulator = (accumulator << length) | code;
+    bits_in_accumulator += length;
+
+    if (bits_in_accumulator >= 32) {
+      const uint32_t chunk =
+          static_cast<uint32_t>(accumulator >> (bits_in_accumulator - 32));
+      out->push_back(static_cast<char>(chunk >> 24));
+      out->push_back(static_cast<char>(chunk >> 16));
+      out->push_back(static_cast<char>(chunk >> 8));
+      out->push_back(static_cast<char>(chunk));
+      bits_in_accumulator -= 32;
+
+      if (out->size() >= in.size()) {
+        // The encoding can only grow from here; give up.
+        return false;
+      }
+    }
+  }
+  // Flush remaining whole bytes, then pad any final partial byte with the
+  // high bits of the EOS symbol.
+  while (bits_in_accumulator >= 8) {
+    out->push_back(
+        static_cast<char>(accumulator >> (bits_in_accumulator - 8)));
+    bits_in_accumulator -= 8;
+  }
+  if (bits_in_accumulator > 0) {
+    const uint8_t last_byte =
+        static_cast<uint8_t>(accumulator << (8 - bits_in_accumulator)) |
+        (pad_bits_ >> bits_in_accumulator);
+    out->push_back(static_cast<char>(last_byte));
+  }
+  return out->size() < in.size();
+}
+
 size_t HpackHuffmanTable::EstimateMemoryUsage() const {
   return SpdyEstimateMemoryUsage(code_by_id_) +
          SpdyEstimateMemoryUsage(length_by_id_);
@@ -42,6 +42,15 @@ class SPDY_EXPORT_PRIVATE HpackHuffmanTable {
   // and |symbol_count| must fit in a uint16_t.
   bool Initialize(const Symbol* input_symbols, size_t symbol_count);
 
+  // Like Initialize(), but for symbols already known to form a valid
+  // canonical code in ascending ID order — true of the RFC 7541 code baked
+  // into hpack_constants.cc, whose validity existing tests enforce through
+  // Initialize(). Skips the per-process sort-and-validate pass, so preparing
+  // the shared table reduces to copying compile-time data; the invariants
+  // are DCHECKed in debug builds.
+  void InitializeFromCanonicalCode(const Symbol* input_symbols,
+                                   size_t symbol_count);
+
   // Returns whether Initialize() has been successfully called.
   bool IsInitialized() const;
 
@@ -52,6 +61,14 @@ class SPDY_EXPORT_PRIVATE HpackHuffmanTable {
   // Returns the encoded size of the input string.
   size_t EncodedSize(SpdyStringPiece in) const;
 
+  // Encodes the input string into |*out| in a single pass, returning true if
+  // the encoding is shorter than |in| (the only case in which an HPACK
+  // encoder should use it). Returns false, leaving |*out| in an unspecified
+  // state, as soon as the encoding is determined not to be shorter, so
+  // incompressible input does not pay for a full encode. Unlike
+  // EncodedSize() followed by EncodeString(), the input is walked only once.
+  bool EncodeStringIfShorter(SpdyStringPiece in, SpdyString* out) const;
+
   // Returns the estimate of dynamically allocated memory in bytes.
   size_t EstimateMemoryUsage() const;
 
@@ -60,6 +60,14 @@ class GenericHuffmanTableTest : public ::testing::Test {
     output_stream.TakeString(&result);
     // Verify EncodedSize() agrees with EncodeString().
     EXPECT_EQ(result.size(), table_.EncodedSize(input));
+    // Verify the single-pass encoder produces identical bytes whenever the
+    // encoding is shorter than the input.
+    SpdyString single_pass;
+    EXPECT_EQ(result.size() < input.size(),
+              table_.EncodeStringIfShorter(input, &single_pass));
+    if (result.size() < input.size()) {
+      EXPECT_EQ(result, single_pass);
+    }
     return result;
   }
 
@@ -221,6 +229,19 @@ TEST_F(HpackHuffmanTableTest, InitializeHpackCode) {
   EXPECT_EQ(peer_.pad_bits(), '\xFF');  // First 8 bits of EOS.
 }
 
+TEST_F(HpackHuffmanTableTest, InitializeFromCanonicalCodeMatchesInitialize) {
+  // The validation-skipping path must end up byte-identical to the validated
+  // one for the RFC 7541 code.
+  std::vector<HpackHuffmanSymbol> code = HpackHuffmanCode();
+  HpackHuffmanTable canonical_table;
+  HpackHuffmanTablePeer canonical_peer(canonical_table);
+  canonical_table.InitializeFromCanonicalCode(&code[0], code.size());
+  EXPECT_TRUE(canonical_table.IsInitialized());
+  EXPECT_EQ(peer_.code_by_id(), canonical_peer.code_by_id());
+  EXPECT_EQ(peer_.length_by_id(), canonical_peer.length_by_id());
+  EXPECT_EQ(peer_.pad_bits(), canonical_peer.pad_bits());
+}
+
 TEST_F(HpackHuffmanTableTest, SpecRequestExamples) {
   SpdyString buffer;
   SpdyString test_table[] = {
@@ -323,6 +344,22 @@ TEST_F(HpackHuffmanTableTest, EncodedSizeAgreesWithEncodeString) {
   }
 }
 
+TEST_F(HpackHuffmanTableTest, EncodeStringIfShorterRejectsIncompressible) {
+  // Encodings of '\x1f' are 28 bits each, so this input is incompressible
+  // and the single-pass encoder must bail out without producing it.
+  SpdyString incompressible(64, '\x1f');
+  SpdyString buffer;
+  EXPECT_FALSE(table_.EncodeStringIfShorter(incompressible, &buffer));
+
+  // The empty string is never shorter when encoded.
+  EXPECT_FALSE(table_.EncodeStringIfShorter("", &buffer));
+
+  // Compressible input yields exactly the bytes of EncodeString().
+  SpdyString compressible = "www.example.com";
+  EXPECT_TRUE(table_.EncodeStringIfShorter(compressible, &buffer));
+  EXPECT_EQ(SpdyHexDecode("f1e3c2e5f23a6ba0ab90f4ff"), buffer);
+}
+
 }  // namespace
 
 }  // namespace test
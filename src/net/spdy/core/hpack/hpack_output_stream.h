@@ -49,6 +49,10 @@ class SPDY_EXPORT_PRIVATE HpackOutputStream {
   // boundary after this function is called.
   void AppendUint32(uint32_t I);
 
+  // Reserves space in the internal buffer, so that encoding a header block of
+  // up to |size| bytes does not have to grow the buffer repeatedly.
+  void Reserve(size_t size) { buffer_.reserve(size); }
+
   // Swaps the internal buffer with |output|, then resets state.
   void TakeString(SpdyString* output);
 
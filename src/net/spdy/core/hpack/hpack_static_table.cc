@@ -20,6 +20,13 @@ void HpackStaticTable::Initialize(const HpackStaticEntry* static_entry_table,
                                   size_t static_entry_count) {
   CHECK(!IsInitialized());
 
+  // Size the indexes for one entry per bucket up front. The table is built
+  // once per process and shared read-only between HPACK contexts, so this
+  // keeps static-table hits -- the majority of real-world header matches --
+  // at one hash and one compare.
+  static_index_.reserve(static_entry_count);
+  static_name_index_.reserve(static_entry_count);
+
   int total_insertions = 0;
   for (const HpackStaticEntry* it = static_entry_table;
        it != static_entry_table + static_entry_count; ++it) {
@@ -140,6 +140,33 @@ size_t Http2DecoderAdapter::ProcessInput(const char* data, size_t len) {
   return total_processed;
 }
 
+size_t Http2DecoderAdapter::ProcessInput(const struct iovec* iov,
+                                         size_t iov_count) {
+  size_t total_processed = 0;
+  for (size_t i = 0; i < iov_count; ++i) {
+    const char* data = static_cast<const char*>(iov[i].iov_base);
+    const size_t len = iov[i].iov_len;
+    if (len == 0) {
+      continue;
+    }
+    const size_t processed = ProcessInput(data, len);
+    total_processed += processed;
+    // The decoder suspends mid-frame at fragment boundaries, so a fragment
+    // is left partially consumed only on error or when limited to a single
+    // frame; either way, stop feeding input.
+    if (processed < len) {
+      break;
+    }
+    // In single frame mode, keep feeding fragments only while the one frame
+    // is still incomplete (i.e. it spans the fragment boundary).
+    if (process_single_input_frame() &&
+        spdy_state_ == SpdyFramer::SPDY_READY_FOR_FRAME) {
+      break;
+    }
+  }
+  return total_processed;
+}
+
 void Http2DecoderAdapter::Reset() {
   ResetInternal();
 }
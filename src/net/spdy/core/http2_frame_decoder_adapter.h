@@ -11,6 +11,7 @@
 #include <memory>
 
 #include "base/optional.h"
+#include "net/base/iovec.h"
 #include "net/http2/decoder/http2_frame_decoder.h"
 #include "net/spdy/core/hpack/hpack_header_table.h"
 #include "net/spdy/core/spdy_alt_svc_wire_format.h"
@@ -226,6 +227,13 @@ class SPDY_EXPORT_PRIVATE Http2DecoderAdapter
   // available, unless process_single_input_frame is true.
   size_t ProcessInput(const char* data, size_t len);
 
+  // Decode encoded HTTP/2 scattered across the |iov_count| fragments of
+  // |iov|, e.g. received TCP segments still in their own buffers. The decoder
+  // suspends and resumes mid-frame at fragment boundaries, so the fragments
+  // need not be flattened into a contiguous buffer before decoding. Returns
+  // the total number of bytes consumed.
+  size_t ProcessInput(const struct iovec* iov, size_t iov_count);
+
   // Reset the decoder (used just for tests at this time).
   void Reset();
 
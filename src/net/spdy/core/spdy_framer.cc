@@ -270,6 +270,18 @@ size_t SpdyFramer::ProcessInput(const char* data, size_t len) {
   }
 }
 
+size_t SpdyFramer::ProcessInput(const struct iovec* iov, size_t iov_count) {
+  DCHECK(visitor_);
+  DCHECK(iov);
+
+  if (decoder_adapter_ != nullptr) {
+    return decoder_adapter_->ProcessInput(iov, iov_count);
+  } else {
+    SPDY_BUG << "SpdyFramer::ProcessInput called without decoder_adapter_!";
+    return 0;
+  }
+}
+
 size_t SpdyFramer::GetUncompressedSerializedLength(
     const SpdyHeaderBlock& headers) {
   const size_t num_name_value_pairs_size = sizeof(uint32_t);
@@ -1573,6 +1585,17 @@ void SpdyFramer::set_max_decode_buffer_size_bytes(
   }
 }
 
+void SpdyFramer::set_max_uncompressed_block_size_bytes(
+    size_t max_uncompressed_block_size_bytes) {
+  if (decoder_adapter_ != nullptr) {
+    decoder_adapter_->GetHpackDecoder()->set_max_uncompressed_block_size_bytes(
+        max_uncompressed_block_size_bytes);
+  } else {
+    SPDY_BUG << "SpdyFramer::set_max_uncompressed_block_size_bytes called "
+                "without decoder_adapter_!";
+  }
+}
+
 void SpdyFramer::SetEncoderHeaderTableDebugVisitor(
     std::unique_ptr<HpackHeaderTable::DebugVisitorInterface> visitor) {
   GetHpackEncoder()->SetHeaderTableDebugVisitor(std::move(visitor));
@@ -13,6 +13,7 @@
 #include <utility>
 
 #include "base/sys_byteorder.h"
+#include "net/base/iovec.h"
 #include "net/spdy/core/hpack/hpack_decoder_adapter.h"
 #include "net/spdy/core/hpack/hpack_encoder.h"
 #include "net/spdy/core/spdy_alt_svc_wire_format.h"
@@ -215,6 +216,12 @@ class SPDY_EXPORT_PRIVATE SpdyFramer {
   // than may be consumed.
   size_t ProcessInput(const char* data, size_t len);
 
+  // As above, but with the input scattered across the |iov_count| fragments
+  // of |iov| (e.g. received TCP segments still in their own buffers). The
+  // decoder suspends and resumes mid-frame at fragment boundaries, so the
+  // fragments need not be flattened into a contiguous buffer first.
+  size_t ProcessInput(const struct iovec* iov, size_t iov_count);
+
   // Resets the framer state after a frame has been successfully decoded.
   // TODO(mbelshe): can we make this private?
   void Reset();
@@ -395,6 +402,11 @@ class SPDY_EXPORT_PRIVATE SpdyFramer {
 
   void set_max_decode_buffer_size_bytes(size_t max_decode_buffer_size_bytes);
 
+  // Sets a hard limit on the decompressed size of a single HPACK block; see
+  // HpackDecoderAdapter::set_max_uncompressed_block_size_bytes().
+  void set_max_uncompressed_block_size_bytes(
+      size_t max_uncompressed_block_size_bytes);
+
   size_t send_frame_size_limit() const { return send_frame_size_limit_; }
   void set_send_frame_size_limit(size_t send_frame_size_limit) {
     send_frame_size_limit_ = send_frame_size_limit;
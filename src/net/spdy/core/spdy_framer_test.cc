@@ -4212,6 +4212,39 @@ TEST_P(SpdyFramerTest, PingFrameFlags) {
   } while (++flags != 0);
 }
 
+// Decoding input scattered across iovec fragments must be equivalent to
+// decoding the same bytes from one contiguous buffer; the decoder suspends
+// and resumes mid-frame at the fragment boundaries.
+TEST_P(SpdyFramerTest, ProcessInputScatteredAcrossIovecs) {
+  testing::StrictMock<test::MockSpdyFramerVisitor> visitor;
+  SpdyFramer framer(SpdyFramer::ENABLE_COMPRESSION);
+  framer.set_visitor(&visitor);
+
+  SpdySerializedFrame ping1(framer.SerializePing(SpdyPingIR(42)));
+  SpdySerializedFrame ping2(framer.SerializePing(SpdyPingIR(4711)));
+  SpdyString input(ping1.data(), ping1.size());
+  input.append(ping2.data(), ping2.size());
+
+  EXPECT_CALL(visitor, OnPing(42u, false));
+  EXPECT_CALL(visitor, OnPing(4711u, false));
+
+  // Split mid-way through the first frame's header, then mid-way through the
+  // second frame, so both boundaries land inside a frame.
+  char* data = const_cast<char*>(input.data());
+  struct iovec iov[3];
+  iov[0].iov_base = data;
+  iov[0].iov_len = 5;
+  iov[1].iov_base = data + 5;
+  iov[1].iov_len = 15;
+  iov[2].iov_base = data + 20;
+  iov[2].iov_len = input.size() - 20;
+
+  EXPECT_EQ(input.size(), framer.ProcessInput(iov, arraysize(iov)));
+  EXPECT_EQ(SpdyFramer::SPDY_READY_FOR_FRAME, framer.state());
+  EXPECT_EQ(SpdyFramer::SPDY_NO_ERROR, framer.spdy_framer_error())
+      << SpdyFramer::SpdyFramerErrorToString(framer.spdy_framer_error());
+}
+
 TEST_P(SpdyFramerTest, WindowUpdateFrameFlags) {
   uint8_t flags = 0;
   do {
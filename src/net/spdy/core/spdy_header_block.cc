@@ -106,17 +106,19 @@ class SpdyHeaderBlock::Storage {
 SpdyHeaderBlock::HeaderValue::HeaderValue(Storage* storage,
                                           SpdyStringPiece key,
                                           SpdyStringPiece initial_value)
-    : storage_(storage), fragments_({initial_value}), pair_({key, {}}) {}
+    : storage_(storage), fragment_(initial_value), pair_({key, {}}) {}
 
 SpdyHeaderBlock::HeaderValue::HeaderValue(HeaderValue&& other)
     : storage_(other.storage_),
-      fragments_(std::move(other.fragments_)),
+      fragment_(other.fragment_),
+      more_fragments_(std::move(other.more_fragments_)),
       pair_(std::move(other.pair_)) {}
 
 SpdyHeaderBlock::HeaderValue& SpdyHeaderBlock::HeaderValue::operator=(
     HeaderValue&& other) {
   storage_ = other.storage_;
-  fragments_ = std::move(other.fragments_);
+  fragment_ = other.fragment_;
+  more_fragments_ = std::move(other.more_fragments_);
   pair_ = std::move(other.pair_);
   return *this;
 }
@@ -124,18 +126,21 @@ SpdyHeaderBlock::HeaderValue& SpdyHeaderBlock::HeaderValue::operator=(
 SpdyHeaderBlock::HeaderValue::~HeaderValue() {}
 
 SpdyStringPiece SpdyHeaderBlock::HeaderValue::ConsolidatedValue() const {
-  if (fragments_.empty()) {
-    return SpdyStringPiece();
+  if (!more_fragments_.empty()) {
+    std::vector<SpdyStringPiece> fragments;
+    fragments.reserve(1 + more_fragments_.size());
+    fragments.push_back(fragment_);
+    fragments.insert(fragments.end(), more_fragments_.begin(),
+                     more_fragments_.end());
+    fragment_ =
+        storage_->WriteFragments(fragments, SeparatorForKey(pair_.first));
+    more_fragments_.clear();
   }
-  if (fragments_.size() > 1) {
-    fragments_ = {
-        storage_->WriteFragments(fragments_, SeparatorForKey(pair_.first))};
-  }
-  return fragments_[0];
+  return fragment_;
 }
 
 void SpdyHeaderBlock::HeaderValue::Append(SpdyStringPiece fragment) {
-  fragments_.push_back(fragment);
+  more_fragments_.push_back(fragment);
 }
 
 const std::pair<SpdyStringPiece, SpdyStringPiece>&
@@ -78,7 +78,11 @@ class SPDY_EXPORT_PRIVATE SpdyHeaderBlock {
     SpdyStringPiece ConsolidatedValue() const;
 
     mutable Storage* storage_;
-    mutable std::vector<SpdyStringPiece> fragments_;
+    // The first fragment of the value is stored inline so that values with a
+    // single fragment -- by far the common case -- never allocate a vector.
+    // Fragments after the first, if any, live in |more_fragments_|.
+    mutable SpdyStringPiece fragment_;
+    mutable std::vector<SpdyStringPiece> more_fragments_;
     // The first element is the key; the second is the consolidated value.
     mutable std::pair<SpdyStringPiece, SpdyStringPiece> pair_;
   };
@@ -4,10 +4,12 @@
 
 #include "net/ssl/ssl_client_session_cache.h"
 
+#include <functional>
 #include <utility>
 
 #include "base/containers/flat_set.h"
 #include "base/memory/memory_coordinator_client_registry.h"
+#include "base/memory/ptr_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/time/clock.h"
 #include "base/time/default_clock.h"
@@ -16,11 +18,28 @@
 
 namespace net {
 
+namespace {
+
+// The minimum per-shard capacity. Shard counts are reduced for small caches
+// so that sharding does not degrade each shard into a handful of entries.
+const size_t kMinShardEntries = 64;
+
+}  // namespace
+
 SSLClientSessionCache::SSLClientSessionCache(const Config& config)
     : clock_(new base::DefaultClock),
       config_(config),
-      cache_(config.max_entries),
       lookups_since_flush_(0) {
+  // Use the largest power-of-two shard count, up to |config.num_shards|, that
+  // still leaves each shard with a useful capacity. Small caches collapse to
+  // a single shard.
+  size_t num_shards = 1;
+  while (num_shards < config.num_shards &&
+         num_shards * 2 * kMinShardEntries <= config.max_entries) {
+    num_shards *= 2;
+  }
+  for (size_t i = 0; i < num_shards; i++)
+    shards_.push_back(base::MakeUnique<Shard>(config.max_entries / num_shards));
   memory_pressure_listener_.reset(new base::MemoryPressureListener(base::Bind(
       &SSLClientSessionCache::OnMemoryPressure, base::Unretained(this))));
   base::MemoryCoordinatorClientRegistry::GetInstance()->Register(this);
@@ -32,32 +51,43 @@ SSLClientSessionCache::~SSLClientSessionCache() {
 }
 
 size_t SSLClientSessionCache::size() const {
-  return cache_.size();
+  size_t size = 0;
+  for (const auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    size += shard->sessions.size();
+  }
+  return size;
 }
 
 bssl::UniquePtr<SSL_SESSION> SSLClientSessionCache::Lookup(
     const std::string& cache_key,
     int* count) {
-  base::AutoLock lock(lock_);
-
-  // Expire stale sessions.
-  lookups_since_flush_++;
-  if (lookups_since_flush_ >= config_.expiration_check_count) {
-    lookups_since_flush_ = 0;
+  // Expire stale sessions. The counter is shared across shards so that
+  // lookups in busy shards also age out sessions in quiet ones.
+  if (lookups_since_flush_.fetch_add(1, std::memory_order_relaxed) + 1 >=
+      config_.expiration_check_count) {
+    lookups_since_flush_.store(0, std::memory_order_relaxed);
     FlushExpiredSessions();
   }
 
+  Shard* shard = GetShard(cache_key);
+  AcquireShardLock(shard);
+  base::AutoLock lock(shard->lock, base::AutoLock::AlreadyAcquired());
+
   // Set count to 0 if there's no session in the cache.
   if (count != nullptr)
     *count = 0;
 
-  auto iter = cache_.Get(cache_key);
-  if (iter == cache_.end())
+  auto iter = shard->sessions.Get(cache_key);
+  if (iter == shard->sessions.end()) {
+    shard->misses++;
     return nullptr;
+  }
 
   SSL_SESSION* session = iter->second.session.get();
   if (IsExpired(session, clock_->Now().ToTimeT())) {
-    cache_.Erase(iter);
+    shard->sessions.Erase(iter);
+    shard->misses++;
     return nullptr;
   }
 
@@ -66,17 +96,20 @@ bssl::UniquePtr<SSL_SESSION> SSLClientSessionCache::Lookup(
     *count = iter->second.lookups;
   }
 
+  shard->hits++;
   SSL_SESSION_up_ref(session);
   return bssl::UniquePtr<SSL_SESSION>(session);
 }
 
 void SSLClientSessionCache::ResetLookupCount(const std::string& cache_key) {
-  base::AutoLock lock(lock_);
+  Shard* shard = GetShard(cache_key);
+  AcquireShardLock(shard);
+  base::AutoLock lock(shard->lock, base::AutoLock::AlreadyAcquired());
 
   // It's possible that the cached session for this key was deleted after the
   // Lookup. If that's the case, don't do anything.
-  auto iter = cache_.Get(cache_key);
-  if (iter == cache_.end())
+  auto iter = shard->sessions.Get(cache_key);
+  if (iter == shard->sessions.end())
     return;
 
   iter->second.lookups = 0;
@@ -84,18 +117,21 @@ void SSLClientSessionCache::ResetLookupCount(const std::string& cache_key) {
 
 void SSLClientSessionCache::Insert(const std::string& cache_key,
                                    SSL_SESSION* session) {
-  base::AutoLock lock(lock_);
+  Shard* shard = GetShard(cache_key);
+  AcquireShardLock(shard);
+  base::AutoLock lock(shard->lock, base::AutoLock::AlreadyAcquired());
 
   SSL_SESSION_up_ref(session);
   Entry entry;
   entry.session = bssl::UniquePtr<SSL_SESSION>(session);
-  cache_.Put(cache_key, std::move(entry));
+  shard->sessions.Put(cache_key, std::move(entry));
 }
 
 void SSLClientSessionCache::Flush() {
-  base::AutoLock lock(lock_);
-
-  cache_.Clear();
+  for (const auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    shard->sessions.Clear();
+  }
 }
 
 void SSLClientSessionCache::SetClockForTesting(
@@ -103,6 +139,21 @@ void SSLClientSessionCache::SetClockForTesting(
   clock_ = std::move(clock);
 }
 
+SSLClientSessionCache::Shard* SSLClientSessionCache::GetShard(
+    const std::string& cache_key) {
+  // The key is hashed once here to pick the shard; FlatMRUCache hashes it
+  // again internally, but only within the selected shard and under its lock.
+  size_t hash = std::hash<std::string>()(cache_key);
+  return shards_[hash & (shards_.size() - 1)].get();
+}
+
+void SSLClientSessionCache::AcquireShardLock(Shard* shard) {
+  if (shard->lock.Try())
+    return;
+  shard->lock.Acquire();
+  shard->contentions++;
+}
+
 bool SSLClientSessionCache::IsExpired(SSL_SESSION* session, time_t now) {
   if (now < 0)
     return true;
@@ -123,29 +174,40 @@ void SSLClientSessionCache::DumpMemoryStats(
   if (cache_dump)
     return;
   cache_dump = pmd->CreateAllocatorDump(absolute_name);
-  base::AutoLock lock(lock_);
   size_t cert_size = 0;
   size_t cert_count = 0;
   size_t undeduped_cert_size = 0;
   size_t undeduped_cert_count = 0;
-  for (const auto& pair : cache_) {
-    undeduped_cert_count +=
-        sk_CRYPTO_BUFFER_num(pair.second.session.get()->certs);
+  uint64_t hit_count = 0;
+  uint64_t miss_count = 0;
+  uint64_t contention_count = 0;
+  for (const auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    for (const auto& pair : shard->sessions) {
+      undeduped_cert_count +=
+          sk_CRYPTO_BUFFER_num(pair.second.session.get()->certs);
+    }
   }
   // Use a flat_set here to avoid malloc upon insertion.
   base::flat_set<const CRYPTO_BUFFER*> crypto_buffer_set;
   crypto_buffer_set.reserve(undeduped_cert_count);
-  for (const auto& pair : cache_) {
-    const SSL_SESSION* session = pair.second.session.get();
-    size_t pair_cert_count = sk_CRYPTO_BUFFER_num(session->certs);
-    for (size_t i = 0; i < pair_cert_count; ++i) {
-      const CRYPTO_BUFFER* cert = sk_CRYPTO_BUFFER_value(session->certs, i);
-      undeduped_cert_size += CRYPTO_BUFFER_len(cert);
-      auto result = crypto_buffer_set.insert(cert);
-      if (!result.second)
-        continue;
-      cert_size += CRYPTO_BUFFER_len(cert);
-      cert_count++;
+  for (const auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    hit_count += shard->hits;
+    miss_count += shard->misses;
+    contention_count += shard->contentions;
+    for (const auto& pair : shard->sessions) {
+      const SSL_SESSION* session = pair.second.session.get();
+      size_t pair_cert_count = sk_CRYPTO_BUFFER_num(session->certs);
+      for (size_t i = 0; i < pair_cert_count; ++i) {
+        const CRYPTO_BUFFER* cert = sk_CRYPTO_BUFFER_value(session->certs, i);
+        undeduped_cert_size += CRYPTO_BUFFER_len(cert);
+        auto result = crypto_buffer_set.insert(cert);
+        if (!result.second)
+          continue;
+        cert_size += CRYPTO_BUFFER_len(cert);
+        cert_count++;
+      }
     }
   }
   cache_dump->AddScalar(base::trace_event::MemoryAllocatorDump::kNameSize,
@@ -163,20 +225,36 @@ void SSLClientSessionCache::DumpMemoryStats(
   cache_dump->AddScalar("undeduped_cert_count",
                         base::trace_event::MemoryAllocatorDump::kUnitsObjects,
                         undeduped_cert_count);
+  cache_dump->AddScalar("hit_count",
+                        base::trace_event::MemoryAllocatorDump::kUnitsObjects,
+                        hit_count);
+  cache_dump->AddScalar("miss_count",
+                        base::trace_event::MemoryAllocatorDump::kUnitsObjects,
+                        miss_count);
+  cache_dump->AddScalar("contention_count",
+                        base::trace_event::MemoryAllocatorDump::kUnitsObjects,
+                        contention_count);
 }
 
 SSLClientSessionCache::Entry::Entry() : lookups(0) {}
 SSLClientSessionCache::Entry::Entry(Entry&&) = default;
 SSLClientSessionCache::Entry::~Entry() = default;
 
+SSLClientSessionCache::Shard::Shard(size_t max_entries)
+    : sessions(max_entries), hits(0), misses(0), contentions(0) {}
+SSLClientSessionCache::Shard::~Shard() = default;
+
 void SSLClientSessionCache::FlushExpiredSessions() {
   time_t now = clock_->Now().ToTimeT();
-  auto iter = cache_.begin();
-  while (iter != cache_.end()) {
-    if (IsExpired(iter->second.session.get(), now)) {
-      iter = cache_.Erase(iter);
-    } else {
-      ++iter;
+  for (const auto& shard : shards_) {
+    base::AutoLock lock(shard->lock);
+    auto iter = shard->sessions.begin();
+    while (iter != shard->sessions.end()) {
+      if (IsExpired(iter->second.session.get(), now)) {
+        iter = shard->sessions.Erase(iter);
+      } else {
+        ++iter;
+      }
     }
   }
 }
@@ -6,13 +6,16 @@
 #define NET_SSL_SSL_CLIENT_SESSION_CACHE_H_
 
 #include <stddef.h>
+#include <stdint.h>
 #include <time.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/bind.h"
-#include "base/containers/mru_cache.h"
+#include "base/containers/flat_mru_cache.h"
 #include "base/macros.h"
 #include "base/memory/memory_coordinator_client.h"
 #include "base/memory/memory_pressure_monitor.h"
@@ -38,6 +41,12 @@ class NET_EXPORT SSLClientSessionCache : public base::MemoryCoordinatorClient {
     size_t max_entries = 1024;
     // The number of calls to Lookup before a new check for expired sessions.
     size_t expiration_check_count = 256;
+    // The maximum number of shards the cache is split into. Each shard has
+    // its own lock, so lookups for different keys need not serialize. The
+    // actual shard count is rounded down to a power of two and reduced if
+    // |max_entries| is too small for each shard to hold a useful number of
+    // sessions.
+    size_t num_shards = 8;
   };
 
   explicit SSLClientSessionCache(const Config& config);
@@ -66,7 +75,8 @@ class NET_EXPORT SSLClientSessionCache : public base::MemoryCoordinatorClient {
   void SetClockForTesting(std::unique_ptr<base::Clock> clock);
 
   // Dumps memory allocation stats. |pmd| is the ProcessMemoryDump of the
-  // browser process.
+  // browser process. Also exports the cache's hit, miss and lock contention
+  // counters.
   void DumpMemoryStats(base::trace_event::ProcessMemoryDump* pmd);
 
  private:
@@ -79,9 +89,31 @@ class NET_EXPORT SSLClientSessionCache : public base::MemoryCoordinatorClient {
     bssl::UniquePtr<SSL_SESSION> session;
   };
 
+  // A slice of the cache, guarded by its own lock. Keys are assigned to
+  // shards by hash, so handshakes for unrelated servers do not contend on a
+  // single mutex.
+  struct Shard {
+    explicit Shard(size_t max_entries);
+    ~Shard();
+
+    base::Lock lock;
+    base::FlatMRUCache<std::string, Entry> sessions;
+    // Stats, guarded by |lock|.
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t contentions;
+  };
+
   // base::MemoryCoordinatorClient implementation:
   void OnPurgeMemory() override;
 
+  // Returns the shard responsible for |cache_key|.
+  Shard* GetShard(const std::string& cache_key);
+
+  // Acquires |shard|'s lock, counting the acquisition as contended if the
+  // lock was not free.
+  void AcquireShardLock(Shard* shard);
+
   // Returns true if |entry| is expired as of |now|.
   bool IsExpired(SSL_SESSION* session, time_t now);
 
@@ -94,13 +126,8 @@ class NET_EXPORT SSLClientSessionCache : public base::MemoryCoordinatorClient {
 
   std::unique_ptr<base::Clock> clock_;
   Config config_;
-  base::HashingMRUCache<std::string, Entry> cache_;
-  size_t lookups_since_flush_;
-
-  // TODO(davidben): After https://crbug.com/458365 is fixed, replace this with
-  // a ThreadChecker. The session cache should be single-threaded like other
-  // classes in net.
-  base::Lock lock_;
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<size_t> lookups_since_flush_;
 
   std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
 
@@ -4,6 +4,9 @@
 
 #include "net/ssl/ssl_client_session_cache.h"
 
+#include <utility>
+#include <vector>
+
 #include "base/memory/ptr_util.h"
 #include "base/run_loop.h"
 #include "base/strings/string_number_conversions.h"
@@ -212,6 +215,37 @@ TEST_F(SSLClientSessionCacheTest, MaxEntries) {
   EXPECT_EQ(3u, cache.size());
 }
 
+// Tests that entries spread across shards behave like one cache.
+TEST_F(SSLClientSessionCacheTest, Sharded) {
+  // The default config is large enough to use several shards.
+  SSLClientSessionCache::Config config;
+  SSLClientSessionCache cache(config);
+
+  const size_t kNumSessions = 100;
+  std::vector<bssl::UniquePtr<SSL_SESSION>> sessions;
+  for (size_t i = 0; i < kNumSessions; i++) {
+    bssl::UniquePtr<SSL_SESSION> session = NewSSLSession();
+    cache.Insert("key" + base::SizeTToString(i), session.get());
+    sessions.push_back(std::move(session));
+  }
+  EXPECT_EQ(kNumSessions, cache.size());
+
+  // Every session is found under its own key, whichever shard it landed in.
+  for (size_t i = 0; i < kNumSessions; i++) {
+    SCOPED_TRACE(i);
+    EXPECT_EQ(sessions[i].get(),
+              cache.Lookup("key" + base::SizeTToString(i), nullptr).get());
+  }
+
+  // A miss does not disturb entries in other shards.
+  EXPECT_EQ(nullptr, cache.Lookup("missing", nullptr).get());
+  EXPECT_EQ(kNumSessions, cache.size());
+
+  // Flush clears all shards.
+  cache.Flush();
+  EXPECT_EQ(0u, cache.size());
+}
+
 // Tests that session expiration works properly.
 TEST_F(SSLClientSessionCacheTest, Expiration) {
   const size_t kNumEntries = 20;
@@ -400,6 +434,9 @@ TEST_P(SSLClientSessionCacheMemoryDumpTest, TestDumpMemoryStats) {
   ASSERT_TRUE(attrs->HasKey("undeduped_cert_size"));
   ASSERT_TRUE(attrs->HasKey("undeduped_cert_count"));
   ASSERT_TRUE(attrs->HasKey(base::trace_event::MemoryAllocatorDump::kNameSize));
+  ASSERT_TRUE(attrs->HasKey("hit_count"));
+  ASSERT_TRUE(attrs->HasKey("miss_count"));
+  ASSERT_TRUE(attrs->HasKey("contention_count"));
 }
 
 }  // namespace net
@@ -6,6 +6,7 @@
 
 #include <unistd.h>  // For read, pipe, close and write.
 #include <stdlib.h>  // for abort
+#include <string.h>  // for memset and strerror_r
 #include <errno.h>    // for errno and strerror_r
 #include <algorithm>
 #include <utility>
@@ -52,6 +53,11 @@
 //   for registration. Before iteration, the ready_list_ is swapped into the
 //   tmp_list_. Once iteration is done, tmp_list_ will be empty, and
 //   ready_list_ will have all the new ready fds.
+// - There is one ready list per activity class, drained in class priority
+//   order (interactive, bulk, background). Each class is swapped into the
+//   tmp_list_ and drained in turn, optionally stopping early when the class
+//   exhausts its per-iteration byte budget; the remainder is pushed back
+//   onto the class's ready list for the next iteration.
 
 // The size we use for buffers passed to strerror_r
 static const int kErrorBufferSize = 256;
@@ -76,22 +82,49 @@ class ReadPipeCallback : public EpollCallbackInterface {
   void OnUnregistration(int, bool) override {}  // COV_NF_LINE
 };
 
+namespace {
+
+// Records 'value' into a power-of-two bucketed histogram: bucket 0 holds
+// zeroes (and negative clock skew), bucket i holds [2^(i-1), 2^i), and the
+// last bucket absorbs everything larger.
+void RecordToStatsHistogram(
+    uint64_t (&buckets)[EpollServerEventLoopStats::kNumBuckets],
+    int64_t value) {
+  int bucket = 0;
+  while (value > 0 && bucket < EpollServerEventLoopStats::kNumBuckets - 1) {
+    value >>= 1;
+    ++bucket;
+  }
+  ++buckets[bucket];
+}
+
+}  // namespace
+
+EpollServerEventLoopStats::EpollServerEventLoopStats() {
+  memset(this, 0, sizeof(*this));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
 EpollServer::EpollServer()
   : epoll_fd_(epoll_create(1024)),
     timeout_in_us_(0),
+    busy_poll_budget_in_us_(0),
     recorded_now_in_us_(0),
     ready_list_size_(0),
     wake_cb_(new ReadPipeCallback),
     read_fd_(-1),
     write_fd_(-1),
     in_wait_for_events_and_execute_callbacks_(false),
-    in_shutdown_(false) {
+    in_shutdown_(false),
+    event_loop_stats_(NULL) {
   // ensure that the epoll_fd_ is valid.
   CHECK_NE(epoll_fd_, -1);
-  LIST_INIT(&ready_list_);
+  for (int i = 0; i < EPOLL_NUM_ACTIVITY_CLASSES; ++i) {
+    LIST_INIT(&ready_list_[i]);
+    activity_class_byte_budget_[i] = 0;
+  }
   LIST_INIT(&tmp_list_);
 
   int pipe_fds[2];
@@ -153,7 +186,9 @@ EpollServer::~EpollServer() {
   VLOG(2) << "Shutting down epoll server ";
   CleanupFDToCBMap();
 
-  LIST_INIT(&ready_list_);
+  for (int i = 0; i < EPOLL_NUM_ACTIVITY_CLASSES; ++i) {
+    LIST_INIT(&ready_list_[i]);
+  }
   LIST_INIT(&tmp_list_);
 
   CleanupTimeToAlarmCBMap();
@@ -167,7 +202,8 @@ EpollServer::~EpollServer() {
 // le_prev pointer (le_next being NULL indicates end of list).
 inline void EpollServer::AddToReadyList(CBAndEventMask* cb_and_mask) {
   if (cb_and_mask->entry.le_prev == NULL) {
-    LIST_INSERT_HEAD(&ready_list_, cb_and_mask, entry);
+    LIST_INSERT_HEAD(&ready_list_[cb_and_mask->activity_class], cb_and_mask,
+                     entry);
     ++ready_list_size_;
   }
 }
@@ -182,7 +218,9 @@ inline void EpollServer::RemoveFromReadyList(
     cb_and_mask.entry.le_prev = NULL;
     --ready_list_size_;
     if (ready_list_size_ == 0) {
-      DCHECK(ready_list_.lh_first == NULL);
+      for (int i = 0; i < EPOLL_NUM_ACTIVITY_CLASSES; ++i) {
+        DCHECK(ready_list_[i].lh_first == NULL);
+      }
       DCHECK(tmp_list_.lh_first == NULL);
     }
   }
@@ -352,6 +390,7 @@ void EpollServer::WaitForEventsAndExecuteCallbacks() {
     WaitForEventsAndCallHandleEvents(timeout_in_us_,
                                      events_,
                                      events_size_);
+    RecordIterationStats();
     recorded_now_in_us_ = 0;
     return;
   }
@@ -390,9 +429,21 @@ void EpollServer::WaitForEventsAndExecuteCallbacks() {
                                    events_,
                                    events_size_);
   CallAndReregisterAlarmEvents();
+  RecordIterationStats();
   recorded_now_in_us_ = 0;
 }
 
+void EpollServer::RecordIterationStats() {
+  if (event_loop_stats_ == NULL || recorded_now_in_us_ == 0) {
+    return;
+  }
+  ++event_loop_stats_->num_iterations;
+  // recorded_now_in_us_ was taken right after epoll_wait returned, so this
+  // measures the time spent handling events and alarms, not sleeping.
+  RecordToStatsHistogram(event_loop_stats_->iteration_duration_us,
+                         NowInUsec() - recorded_now_in_us_);
+}
+
 void EpollServer::SetFDReady(int fd, int events_to_fake) {
   FDToCBMap::iterator fd_i = cb_map_.find(CBAndEventMask(NULL, 0, fd));
   if (cb_map_.end() != fd_i && fd_i->cb != NULL) {
@@ -421,6 +472,28 @@ void EpollServer::SetFDNotReady(int fd) {
   }
 }
 
+void EpollServer::SetFDActivityClass(int fd,
+                                     EpollActivityClass activity_class) {
+  FDToCBMap::iterator fd_i = cb_map_.find(CBAndEventMask(NULL, 0, fd));
+  if (cb_map_.end() == fd_i || fd_i->cb == NULL) {
+    return;
+  }
+  if (fd_i->activity_class == activity_class) {
+    return;
+  }
+  CBAndEventMask* cb_and_mask = const_cast<CBAndEventMask*>(&*fd_i);
+  // If the fd is already queued, move it to its new class's list so the
+  // reclassification takes effect without waiting for the next event.
+  const bool was_ready = cb_and_mask->entry.le_prev != NULL;
+  if (was_ready) {
+    RemoveFromReadyList(*cb_and_mask);
+  }
+  cb_and_mask->activity_class = activity_class;
+  if (was_ready) {
+    AddToReadyList(cb_and_mask);
+  }
+}
+
 bool EpollServer::IsFDReady(int fd) const {
   FDToCBMap::const_iterator fd_i = cb_map_.find(CBAndEventMask(NULL, 0, fd));
   return (cb_map_.end() != fd_i &&
@@ -430,11 +503,14 @@ bool EpollServer::IsFDReady(int fd) const {
 
 void EpollServer::VerifyReadyList() const {
   int count = 0;
-  CBAndEventMask* cur = ready_list_.lh_first;
-  for (; cur; cur = cur->entry.le_next) {
-    ++count;
+  for (int i = 0; i < EPOLL_NUM_ACTIVITY_CLASSES; ++i) {
+    for (CBAndEventMask* cur = ready_list_[i].lh_first; cur;
+         cur = cur->entry.le_next) {
+      ++count;
+    }
   }
-  for (cur = tmp_list_.lh_first; cur; cur = cur->entry.le_next) {
+  for (CBAndEventMask* cur = tmp_list_.lh_first; cur;
+       cur = cur->entry.le_next) {
     ++count;
   }
   CHECK_EQ(ready_list_size_, count) << "Ready list size does not match count";
@@ -464,6 +540,14 @@ void EpollServer::UnregisterAlarm(const AlarmRegToken& iterator_token) {
   cb->OnUnregistration();
 }
 
+int64_t EpollServer::CumulativeCallbackTimeInUsec(int fd) const {
+  FDToCBMap::const_iterator fd_i = cb_map_.find(CBAndEventMask(NULL, 0, fd));
+  if (fd_i == cb_map_.end()) {
+    return 0;
+  }
+  return fd_i->cumulative_cb_time_in_us;
+}
+
 int EpollServer::NumFDsRegistered() const {
   DCHECK_GE(cb_map_.size(), 1u);
   // Omit the internal FD (read_fd_)
@@ -615,7 +699,7 @@ void EpollServer::ModifyFD(int fd, int remove_event, int add_event) {
 void EpollServer::WaitForEventsAndCallHandleEvents(int64_t timeout_in_us,
                                                    struct epoll_event events[],
                                                    int events_size) {
-  if (timeout_in_us == 0 || ready_list_.lh_first != NULL) {
+  if (timeout_in_us == 0 || ready_list_size_ > 0) {
     // If ready list is not empty, then don't sleep at all.
     timeout_in_us = 0;
   } else if (timeout_in_us < 0) {
@@ -632,10 +716,21 @@ void EpollServer::WaitForEventsAndCallHandleEvents(int64_t timeout_in_us,
     }
   }
   const int timeout_in_ms = timeout_in_us / 1000;
-  int nfds = epoll_wait_impl(epoll_fd_,
-                             events,
-                             events_size,
-                             timeout_in_ms);
+  int nfds = 0;
+  if (busy_poll_budget_in_us_ > 0 && timeout_in_ms != 0) {
+    // Spin on zero-timeout polls for the configured budget before paying
+    // for a scheduler wakeup in a sleeping epoll_wait.
+    const int64_t spin_deadline_in_us = NowInUsec() + busy_poll_budget_in_us_;
+    do {
+      nfds = epoll_wait_impl(epoll_fd_, events, events_size, 0);
+    } while (nfds == 0 && NowInUsec() < spin_deadline_in_us);
+  }
+  if (nfds == 0) {
+    nfds = epoll_wait_impl(epoll_fd_,
+                           events,
+                           events_size,
+                           timeout_in_ms);
+  }
   VLOG(3) << "nfds=" << nfds;
 
 #ifdef EPOLL_SERVER_EVENT_TRACING
@@ -666,8 +761,8 @@ void EpollServer::WaitForEventsAndCallHandleEvents(int64_t timeout_in_us,
     }
   }
 
-  // Now run through the ready list.
-  if (ready_list_.lh_first) {
+  // Now run through the ready lists.
+  if (ready_list_size_ > 0) {
     CallReadyListCallbacks();
   }
 }
@@ -675,18 +770,31 @@ void EpollServer::WaitForEventsAndCallHandleEvents(int64_t timeout_in_us,
 void EpollServer::CallReadyListCallbacks() {
   // Check pre-conditions.
   DCHECK(tmp_list_.lh_first == NULL);
-  // Swap out the ready_list_ into the tmp_list_ before traversing the list to
-  // enable SetFDReady() to just push new items into the ready_list_.
-  std::swap(ready_list_.lh_first, tmp_list_.lh_first);
-  if (tmp_list_.lh_first) {
+  if (event_loop_stats_ != NULL) {
+    RecordToStatsHistogram(event_loop_stats_->ready_list_depth,
+                           ready_list_size_);
+  }
+  EpollEvent event(0);
+  // Drain the classes in priority order so that bulk and background fds
+  // cannot starve interactive ones within an iteration.
+  for (int ac = 0; ac < EPOLL_NUM_ACTIVITY_CLASSES; ++ac) {
+    if (ready_list_[ac].lh_first == NULL) {
+      continue;
+    }
+    const int64_t byte_budget = activity_class_byte_budget_[ac];
+    int64_t bytes_drained = 0;
+    // Swap out the class's ready list into the tmp_list_ before traversing
+    // the list to enable SetFDReady() to just push new items into the
+    // ready_list_.
+    std::swap(ready_list_[ac].lh_first, tmp_list_.lh_first);
     tmp_list_.lh_first->entry.le_prev = &tmp_list_.lh_first;
-    EpollEvent event(0);
     while (tmp_list_.lh_first != NULL) {
       DCHECK_GT(ready_list_size_, 0);
       CBAndEventMask* cb_and_mask = tmp_list_.lh_first;
       RemoveFromReadyList(*cb_and_mask);
 
       event.out_ready_mask = 0;
+      event.out_bytes_processed = 0;
       event.in_events =
         cb_and_mask->events_asserted | cb_and_mask->events_to_fake;
       // TODO(fenix): get rid of the two separate fields in cb_and_mask.
@@ -698,7 +806,16 @@ void EpollServer::CallReadyListCallbacks() {
         // invalidating the cb_and_mask object (by deleting the object in the
         // map to which cb_and_mask refers)
         base::AutoReset<bool> in_use_guard(&(cb_and_mask->in_use), true);
-        cb_and_mask->cb->OnEvent(cb_and_mask->fd, &event);
+        if (event_loop_stats_ == NULL) {
+          cb_and_mask->cb->OnEvent(cb_and_mask->fd, &event);
+        } else {
+          const int64_t start_time_in_us = NowInUsec();
+          cb_and_mask->cb->OnEvent(cb_and_mask->fd, &event);
+          const int64_t duration_in_us = NowInUsec() - start_time_in_us;
+          cb_and_mask->cumulative_cb_time_in_us += duration_in_us;
+          RecordToStatsHistogram(event_loop_stats_->callback_duration_us,
+                                 duration_in_us);
+        }
       }
 
       // Since OnEvent may have called UnregisterFD, we must check here that
@@ -710,6 +827,22 @@ void EpollServer::CallReadyListCallbacks() {
         cb_and_mask->events_to_fake = event.out_ready_mask;
         AddToReadyList(cb_and_mask);
       }
+
+      bytes_drained += event.out_bytes_processed;
+      if (byte_budget > 0 && bytes_drained >= byte_budget) {
+        // Budget exhausted. Push the rest of this class back onto its ready
+        // list -- their pending event masks stay intact -- and move on. They
+        // run next iteration, after higher-priority classes have seen fresh
+        // events. An fd remaining ready also keeps the next epoll_wait from
+        // sleeping, so deferred work is picked up promptly. Moving nodes
+        // between lists directly leaves ready_list_size_ unchanged.
+        while (tmp_list_.lh_first != NULL) {
+          CBAndEventMask* deferred = tmp_list_.lh_first;
+          LIST_REMOVE(deferred, entry);
+          LIST_INSERT_HEAD(&ready_list_[ac], deferred, entry);
+        }
+        break;
+      }
     }
   }
   DCHECK(tmp_list_.lh_first == NULL);
@@ -738,6 +871,11 @@ void EpollServer::CallAndReregisterAlarmEvents() {
       ++i;
       continue;
     }
+    if (event_loop_stats_ != NULL) {
+      // How far past its registered deadline this alarm is firing.
+      RecordToStatsHistogram(event_loop_stats_->alarm_lag_us,
+                             now_in_us - i->first);
+    }
     all_alarms_.erase(cb);
     const int64_t new_timeout_time_in_us = cb->OnAlarm();
 
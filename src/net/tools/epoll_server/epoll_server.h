@@ -49,7 +49,8 @@ class ReadPipeCallback;
 struct EpollEvent {
   EpollEvent(int events)
       : in_events(events),
-        out_ready_mask(0) {
+        out_ready_mask(0),
+        out_bytes_processed(0) {
   }
 
   int in_events;            // incoming events
@@ -57,6 +58,51 @@ struct EpollEvent {
                             // get on the ready list). This field is always
                             // initialized to 0 when the event is passed to
                             // OnEvent.
+  int64_t out_bytes_processed;  // number of bytes the callback read or wrote
+                                // while handling this event. Reporting is
+                                // optional; callbacks that do report are
+                                // charged against their activity class's
+                                // per-iteration byte budget (see
+                                // EpollServer::set_activity_class_byte_budget).
+                                // Always initialized to 0 when the event is
+                                // passed to OnEvent.
+};
+
+// Activity classes for event-loop QoS. The ready list is drained in class
+// priority order -- interactive first, background last -- so that a few
+// high-throughput bulk fds cannot starve latency-sensitive ones within a
+// single WaitForEventsAndExecuteCallbacks iteration. See
+// EpollServer::SetFDActivityClass().
+enum EpollActivityClass {
+  EPOLL_CLASS_INTERACTIVE = 0,
+  EPOLL_CLASS_BULK = 1,
+  EPOLL_CLASS_BACKGROUND = 2,
+  EPOLL_NUM_ACTIVITY_CLASSES = 3,
+};
+
+// Event-loop health counters for an EpollServer. Contains only plain
+// counters and power-of-two bucketed histograms -- no pointers or
+// dynamic memory -- so a process may place an instance in a shared-memory
+// mapping and have external monitors read loop-lag metrics while the loop
+// runs. All durations are in microseconds.
+struct EpollServerEventLoopStats {
+  // Histogram bucket i covers values in [2^(i-1), 2^i); bucket 0 holds
+  // zeroes and the last bucket absorbs everything too large to fit.
+  static const int kNumBuckets = 24;
+
+  EpollServerEventLoopStats();
+
+  // Number of completed WaitForEventsAndExecuteCallbacks iterations.
+  uint64_t num_iterations;
+  // Time spent handling events and alarms per iteration, excluding the
+  // time slept inside epoll_wait.
+  uint64_t iteration_duration_us[kNumBuckets];
+  // Duration of individual EpollCallbackInterface::OnEvent calls.
+  uint64_t callback_duration_us[kNumBuckets];
+  // How far past its registered deadline each alarm fired.
+  uint64_t alarm_lag_us[kNumBuckets];
+  // Number of ready FDs waiting at the start of each ready-list pass.
+  uint64_t ready_list_depth[kNumBuckets];
 };
 
 // Callbacks which go into EpollServers are expected to derive from this class.
@@ -336,6 +382,35 @@ class EpollServer {
 
   virtual void SetFDNotReady(int fd);
 
+  // Summary:
+  //   Assigns 'fd' to an activity class. Ready fds are drained in class
+  //   priority order (interactive, then bulk, then background), so bulk
+  //   transfers cannot starve latency-sensitive fds within an iteration.
+  //   Newly registered fds start in EPOLL_CLASS_INTERACTIVE, which keeps
+  //   the historical behavior when classes are not used. If the fd is
+  //   currently on the ready list it is moved to its new class's list
+  //   immediately. Does nothing if the fd is not registered.
+  // Args:
+  //   fd - a file-descriptor registered with this epoll server.
+  //   activity_class - the class to assign to 'fd'.
+  virtual void SetFDActivityClass(int fd, EpollActivityClass activity_class);
+
+  // Summary:
+  //   Caps the number of bytes fds of a given class may process per
+  //   WaitForEventsAndExecuteCallbacks iteration. Callbacks report the
+  //   bytes they handled via EpollEvent::out_bytes_processed; once a
+  //   class's reported bytes reach its budget, the class's remaining ready
+  //   fds are deferred to the next iteration, where higher-priority classes
+  //   see fresh events first. Zero (the default) means unlimited.
+  //   Callbacks which do not report bytes are not constrained.
+  // Args:
+  //   activity_class - the class whose budget is being set.
+  //   bytes - per-iteration byte budget, or 0 for unlimited.
+  void set_activity_class_byte_budget(EpollActivityClass activity_class,
+                                      int64_t bytes) {
+    activity_class_byte_budget_[activity_class] = bytes;
+  }
+
   // Summary:
   //   IsFDReady(), ReadyListSize(), and VerifyReadyList are intended as
   //   debugging tools and for writing unit tests.
@@ -469,6 +544,49 @@ class EpollServer {
 
   ////////////////////////////////////////
 
+  // Summary:
+  //   Sets the busy-poll budget. When nonzero, and a wait would otherwise
+  //   sleep in epoll_wait, the server instead spins on zero-timeout polls
+  //   for up to busy_poll_budget_in_us microseconds before falling back to
+  //   a sleeping epoll_wait. This trades CPU for removing the scheduler
+  //   wakeup latency from low-load event delivery. Zero (the default)
+  //   disables spinning.
+  //  Args:
+  //    busy_poll_budget_in_us - spin budget per wait, in microseconds.
+  void set_busy_poll_budget_in_us(int64_t busy_poll_budget_in_us) {
+    busy_poll_budget_in_us_ = busy_poll_budget_in_us;
+  }
+
+  ////////////////////////////////////////
+
+  // Summary:
+  //   Points loop instrumentation at 'stats', which the caller owns and
+  //   must keep alive while set. The struct is flat, so the caller may
+  //   place it in a shared-memory mapping for external monitors to read
+  //   live. Pass NULL (the initial state) to disable collection; while
+  //   disabled the loop makes no extra clock calls.
+  // Args:
+  //   stats - the stats page to fill in, or NULL.
+  void set_event_loop_stats(EpollServerEventLoopStats* stats) {
+    event_loop_stats_ = stats;
+  }
+
+  EpollServerEventLoopStats* event_loop_stats() const {
+    return event_loop_stats_;
+  }
+
+  ////////////////////////////////////////
+
+  // Summary:
+  //   Returns the total time, in microseconds, spent inside OnEvent() for
+  //   the callback registered on 'fd'. Only accumulated while an
+  //   event-loop stats page is set; returns 0 for unknown fds.
+  // Args:
+  //   fd - a file-descriptor registered with this epoll server.
+  int64_t CumulativeCallbackTimeInUsec(int fd) const;
+
+  ////////////////////////////////////////
+
   // Summary:
   //   Accessor for the current value of timeout_in_us.
   int timeout_in_us() const { return timeout_in_us_; }
@@ -502,7 +620,9 @@ class EpollServer {
           event_mask(0),
           events_asserted(0),
           events_to_fake(0),
-          in_use(false) {
+          in_use(false),
+          cumulative_cb_time_in_us(0),
+          activity_class(EPOLL_CLASS_INTERACTIVE) {
       entry.le_next = NULL;
       entry.le_prev = NULL;
     }
@@ -511,7 +631,8 @@ class EpollServer {
                    int event_mask,
                    int fd)
         : cb(cb), fd(fd), event_mask(event_mask), events_asserted(0),
-          events_to_fake(0), in_use(false) {
+          events_to_fake(0), in_use(false), cumulative_cb_time_in_us(0),
+          activity_class(EPOLL_CLASS_INTERACTIVE) {
       entry.le_next = NULL;
       entry.le_prev = NULL;
     }
@@ -538,6 +659,12 @@ class EpollServer {
     // toggle around calls to OnEvent to tell UnregisterFD to not erase the
     // iterator because HandleEvent is using it.
     mutable bool in_use;
+    // total time spent inside OnEvent for this callback, accumulated only
+    // while an event-loop stats page is set.
+    mutable int64_t cumulative_cb_time_in_us;
+    // which per-class ready list this fd is queued on when ready. Determines
+    // drain order and which byte budget it is charged against.
+    mutable EpollActivityClass activity_class;
   };
 
   // Custom hash function to be used by hash_set.
@@ -647,6 +774,12 @@ class EpollServer {
   // were recurring.
   virtual void CallAndReregisterAlarmEvents();
 
+  // Summary:
+  //   Records the just-finished iteration's working time into the
+  //   event-loop stats page, if one is set. Must be called while
+  //   recorded_now_in_us_ still holds the post-epoll_wait timestamp.
+  void RecordIterationStats();
+
   // The file-descriptor created for epolling
   int epoll_fd_;
 
@@ -677,6 +810,11 @@ class EpollServer {
   // If this is zero, never wait for an event.
   int64_t timeout_in_us_;
 
+  // If positive, the number of microseconds to spin on zero-timeout polls
+  // before falling back to a sleeping epoll_wait. See
+  // set_busy_poll_budget_in_us().
+  int64_t busy_poll_budget_in_us_;
+
   // This is nonzero only after the invocation of epoll_wait_impl within
   // WaitForEventsAndCallHandleEvents and before the function
   // WaitForEventsAndExecuteCallbacks returns.  At all other times, this is
@@ -693,9 +831,13 @@ class EpollServer {
   // go in an infinite loop.
   AlarmCBMap alarms_reregistered_and_should_be_skipped_;
 
-  LIST_HEAD(ReadyList, CBAndEventMask) ready_list_;
+  // One ready list per activity class, drained in class priority order.
+  LIST_HEAD(ReadyList, CBAndEventMask) ready_list_[EPOLL_NUM_ACTIVITY_CLASSES];
   LIST_HEAD(TmpList, CBAndEventMask) tmp_list_;
+  // Total number of fds queued across all per-class ready lists.
   int ready_list_size_;
+  // Per-iteration byte budget for each activity class; 0 means unlimited.
+  int64_t activity_class_byte_budget_[EPOLL_NUM_ACTIVITY_CLASSES];
   // TODO(alyssar): make this into something that scales up.
   static const int events_size_ = 256;
   struct epoll_event events_[256];
@@ -958,6 +1100,10 @@ class EpollServer {
   // Returns true when the EpollServer() is being destroyed.
   bool in_shutdown_;
 
+  // The stats page loop instrumentation writes into, or NULL when
+  // collection is disabled. Not owned.
+  EpollServerEventLoopStats* event_loop_stats_;
+
   DISALLOW_COPY_AND_ASSIGN(EpollServer);
 };
 
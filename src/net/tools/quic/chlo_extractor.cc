@@ -151,17 +151,29 @@ void ChloFramerVisitor::OnHandshakeMessage(
 
 }  // namespace
 
+ChloExtractor::ChloExtractor(const QuicVersionVector& versions)
+    : framer_(versions, QuicTime::Zero(), Perspective::IS_SERVER),
+      first_version_(versions.front()) {}
+
+ChloExtractor::~ChloExtractor() {}
+
+bool ChloExtractor::ExtractChlo(const QuicEncryptedPacket& packet,
+                                Delegate* delegate) {
+  framer_.set_version(first_version_);
+  ChloFramerVisitor visitor(&framer_, delegate);
+  framer_.set_visitor(&visitor);
+  if (!framer_.ProcessPacket(packet)) {
+    return false;
+  }
+  return visitor.found_chlo();
+}
+
 // static
 bool ChloExtractor::Extract(const QuicEncryptedPacket& packet,
                             const QuicVersionVector& versions,
                             Delegate* delegate) {
-  QuicFramer framer(versions, QuicTime::Zero(), Perspective::IS_SERVER);
-  ChloFramerVisitor visitor(&framer, delegate);
-  framer.set_visitor(&visitor);
-  if (!framer.ProcessPacket(packet)) {
-    return false;
-  }
-  return visitor.found_chlo();
+  ChloExtractor extractor(versions);
+  return extractor.ExtractChlo(packet, delegate);
 }
 
 }  // namespace net
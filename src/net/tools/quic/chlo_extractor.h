@@ -6,6 +6,7 @@
 #define NET_TOOLS_QUIC_CHLO_EXTRACTOR_H_
 
 #include "net/quic/core/crypto/crypto_handshake_message.h"
+#include "net/quic/core/quic_framer.h"
 #include "net/quic/core/quic_packets.h"
 
 namespace net {
@@ -24,15 +25,30 @@ class ChloExtractor {
                         const CryptoHandshakeMessage& chlo) = 0;
   };
 
+  // Creates an extractor whose internal framer is reused across packets.
+  // Since extraction runs on every new-connection packet, hot paths should
+  // hold an instance rather than paying framer construction per packet.
+  explicit ChloExtractor(const QuicVersionVector& versions);
+  ~ChloExtractor();
+
   // Extracts a CHLO message from |packet| and invokes the OnChlo method
-  // of |delegate|. Return true if a CHLO message was found, and false
+  // of |delegate|. Returns true if a CHLO message was found, and false
   // otherwise.
+  bool ExtractChlo(const QuicEncryptedPacket& packet, Delegate* delegate);
+
+  // Convenience form of ExtractChlo which constructs a fresh extractor.
   static bool Extract(const QuicEncryptedPacket& packet,
                       const QuicVersionVector& versions,
                       Delegate* delegate);
 
   ChloExtractor(const ChloExtractor&) = delete;
   ChloExtractor operator=(const ChloExtractor&) = delete;
+
+ private:
+  QuicFramer framer_;
+  // The version to restore before each packet, in case version negotiation
+  // for a previous packet moved the framer off of it.
+  const QuicVersion first_version_;
 };
 
 }  // namespace net
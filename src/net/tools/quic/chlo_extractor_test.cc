@@ -101,6 +101,30 @@ TEST_F(ChloExtractorTest, FindsValidChlo) {
   }
 }
 
+TEST_F(ChloExtractorTest, ReusableExtractorFindsValidChlo) {
+  CryptoHandshakeMessage client_hello;
+  client_hello.set_tag(kCHLO);
+
+  string client_hello_str(client_hello.GetSerialized(Perspective::IS_CLIENT)
+                              .AsStringPiece()
+                              .as_string());
+  // A single extractor instance processes CHLOs of every supported version,
+  // as the dispatcher's long-lived instance does.
+  ChloExtractor extractor(AllSupportedVersions());
+  for (QuicVersion version : AllSupportedVersions()) {
+    header_.public_header.versions = SupportedVersions(version);
+    MakePacket(
+        new QuicStreamFrame(kCryptoStreamId, false, 0, client_hello_str));
+    EXPECT_TRUE(extractor.ExtractChlo(*packet_, &delegate_))
+        << QuicVersionToString(version);
+    EXPECT_EQ(version, delegate_.version());
+    EXPECT_EQ(header_.public_header.connection_id, delegate_.connection_id());
+    EXPECT_EQ(client_hello.DebugString(Perspective::IS_SERVER),
+              delegate_.chlo())
+        << QuicVersionToString(version);
+  }
+}
+
 TEST_F(ChloExtractorTest, DoesNotFindValidChloOnWrongStream) {
   CryptoHandshakeMessage client_hello;
   client_hello.set_tag(kCHLO);
@@ -21,6 +21,7 @@
 #include "net/base/ip_endpoint.h"
 #include "net/quic/core/crypto/aes_128_gcm_12_encrypter.h"
 #include "net/quic/core/crypto/null_encrypter.h"
+#include "net/quic/core/quic_copy_counters.h"
 #include "net/quic/core/quic_framer.h"
 #include "net/quic/core/quic_packet_creator.h"
 #include "net/quic/core/quic_packets.h"
@@ -636,6 +637,43 @@ TEST_P(EndToEndTest, SimpleRequestResponsev6) {
   EXPECT_EQ(2, client_->client()->GetNumSentClientHellos());
 }
 
+// Measures payload copies and stream buffer allocations across full
+// client/server exchanges; both endpoints run in this process, so the
+// process-global counters observe both sides. The budgets are deliberately
+// loose: they exist to catch changes that add wholesale copying per request,
+// not to pin exact counts.
+TEST_P(EndToEndTest, CopyAndAllocationBudget) {
+  ASSERT_TRUE(Initialize());
+  // Warm up the connection so handshake copies are not attributed to the
+  // measured requests.
+  client_->SendSynchronousRequest("/foo");
+
+  QuicCopyCounters::Reset();
+  QuicCopyCounters::Enable();
+  const int kNumRequests = 10;
+  for (int i = 0; i < kNumRequests; ++i) {
+    EXPECT_EQ(kFooResponseBody, client_->SendSynchronousRequest("/foo"));
+  }
+  QuicCopyCounters::Disable();
+
+  const uint64_t bytes_copied_per_request =
+      QuicCopyCounters::TotalBytesCopied() / kNumRequests;
+  const uint64_t allocations_per_request =
+      QuicCopyCounters::StreamBufferAllocationCount() / kNumRequests;
+  QUIC_LOG(INFO) << "Per request over " << kNumRequests
+                 << " requests: " << bytes_copied_per_request
+                 << " bytes copied, "
+                 << QuicCopyCounters::TotalCopyCount() / kNumRequests
+                 << " copies, " << allocations_per_request
+                 << " stream buffer allocations.";
+
+  // A /foo exchange moves a few hundred payload bytes in each direction;
+  // tens of kilobytes copied or dozens of stream buffer allocations per
+  // request would mean a layer started copying wholesale.
+  EXPECT_LE(bytes_copied_per_request, 64u * 1024);
+  EXPECT_LE(allocations_per_request, 100u);
+}
+
 TEST_P(EndToEndTest, SimpleRequestResponseWithLargeReject) {
   chlo_multiplier_ = 1;
   ASSERT_TRUE(Initialize());
@@ -689,6 +727,78 @@ TEST_P(EndToEndTest, MultipleRequestResponse) {
   EXPECT_EQ("200", client_->response_headers()->find(":status")->second);
 }
 
+// Collects the incremental response events of one async request.
+class RecordingRequestDelegate : public QuicSpdyClientBase::RequestDelegate {
+ public:
+  RecordingRequestDelegate() : complete_(false), response_complete_(false) {}
+  ~RecordingRequestDelegate() override {}
+
+  void OnResponseHeaders(QuicStreamId id,
+                         const SpdyHeaderBlock& headers) override {
+    auto status = headers.find(":status");
+    if (status != headers.end()) {
+      status_ = status->second.as_string();
+    }
+  }
+
+  void OnResponseBodyData(QuicStreamId id, QuicStringPiece data) override {
+    body_.append(data.data(), data.size());
+  }
+
+  void OnRequestComplete(QuicStreamId id, bool response_complete) override {
+    complete_ = true;
+    response_complete_ = response_complete;
+  }
+
+  const string& status() const { return status_; }
+  const string& body() const { return body_; }
+  bool complete() const { return complete_; }
+  bool response_complete() const { return response_complete_; }
+
+ private:
+  string status_;
+  string body_;
+  bool complete_;
+  bool response_complete_;
+};
+
+TEST_P(EndToEndTest, AsyncRequests) {
+  // Issue several requests at once and drive the event loop until all have
+  // completed, with headers and body delivered incrementally per request.
+  ASSERT_TRUE(Initialize());
+  EXPECT_TRUE(client_->client()->WaitForCryptoHandshakeConfirmed());
+
+  SpdyHeaderBlock foo_headers;
+  foo_headers[":method"] = "GET";
+  foo_headers[":path"] = "/foo";
+  foo_headers[":scheme"] = "https";
+  foo_headers[":authority"] = server_hostname_;
+  SpdyHeaderBlock bar_headers = foo_headers.Clone();
+  bar_headers[":path"] = "/bar";
+
+  QuicSpdyClientBase* client = client_->client();
+  RecordingRequestDelegate foo_delegate;
+  RecordingRequestDelegate bar_delegate;
+  EXPECT_NE(0u, client->SendAsyncRequest(foo_headers, "", /*fin=*/true,
+                                         &foo_delegate));
+  EXPECT_NE(0u, client->SendAsyncRequest(bar_headers, "", /*fin=*/true,
+                                         &bar_delegate));
+  EXPECT_EQ(2u, client->num_outstanding_async_requests());
+
+  client->WaitForAsyncRequests();
+  EXPECT_EQ(0u, client->num_outstanding_async_requests());
+
+  EXPECT_TRUE(foo_delegate.complete());
+  EXPECT_TRUE(foo_delegate.response_complete());
+  EXPECT_EQ("200", foo_delegate.status());
+  EXPECT_EQ(kFooResponseBody, foo_delegate.body());
+
+  EXPECT_TRUE(bar_delegate.complete());
+  EXPECT_TRUE(bar_delegate.response_complete());
+  EXPECT_EQ("200", bar_delegate.status());
+  EXPECT_EQ(kBarResponseBody, bar_delegate.body());
+}
+
 TEST_P(EndToEndTest, MultipleStreams) {
   // Verifies quic_test_client can track responses of all active streams.
   ASSERT_TRUE(Initialize());
@@ -5,6 +5,7 @@
 #include "net/tools/quic/platform/impl/quic_socket_utils.h"
 
 #include <errno.h>
+#include <linux/filter.h>
 #include <linux/net_tstamp.h>
 #include <netinet/in.h>
 #include <string.h>
@@ -23,6 +24,15 @@
 #define SO_RXQ_OVFL 40
 #endif
 
+// Not available in all linux/filter.h revisions we build against.
+#ifndef SO_ATTACH_REUSEPORT_CBPF
+#define SO_ATTACH_REUSEPORT_CBPF 51
+#endif
+
+#ifndef SO_BUSY_POLL
+#define SO_BUSY_POLL 46
+#endif
+
 using std::string;
 
 namespace net {
@@ -51,7 +61,21 @@ void QuicSocketUtils::GetAddressAndTimestampFromMsghdr(
                  cmsg->cmsg_type == SO_TIMESTAMPING) {
         LinuxTimestamping* lts =
             reinterpret_cast<LinuxTimestamping*>(CMSG_DATA(cmsg));
-        timespec* ts = &lts->systime;
+        // Prefer the NIC's raw hardware timestamp when present; it is
+        // immune to the latency between DMA and the kernel's softirq
+        // processing.
+        timespec* ts = (lts->hwtimeraw.tv_sec != 0 || lts->hwtimeraw.tv_nsec != 0)
+                           ? &lts->hwtimeraw
+                           : &lts->systime;
+        int64_t usec = (static_cast<int64_t>(ts->tv_sec) * 1000 * 1000) +
+                       (static_cast<int64_t>(ts->tv_nsec) / 1000);
+        *walltimestamp = QuicWallTime::FromUNIXMicroseconds(usec);
+      } else if (cmsg->cmsg_level == SOL_SOCKET &&
+                 cmsg->cmsg_type == SCM_TIMESTAMPNS &&
+                 walltimestamp->IsZero()) {
+        // SO_TIMESTAMPNS fallback for kernels without SO_TIMESTAMPING.
+        // Never overrides a SO_TIMESTAMPING value already found.
+        timespec* ts = reinterpret_cast<timespec*>(CMSG_DATA(cmsg));
         int64_t usec = (static_cast<int64_t>(ts->tv_sec) * 1000 * 1000) +
                        (static_cast<int64_t>(ts->tv_nsec) / 1000);
         *walltimestamp = QuicWallTime::FromUNIXMicroseconds(usec);
@@ -93,6 +117,30 @@ bool QuicSocketUtils::GetTtlFromMsghdr(struct msghdr* hdr, int* ttl) {
   return false;
 }
 
+// static
+bool QuicSocketUtils::GetEcnFromMsghdr(struct msghdr* hdr,
+                                       QuicEcnCodepoint* ecn) {
+  if (hdr->msg_controllen > 0) {
+    struct cmsghdr* cmsg;
+    for (cmsg = CMSG_FIRSTHDR(hdr); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+      if (cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TOS) {
+        // IP_RECVTOS delivers the TOS byte as a single octet.
+        *ecn = static_cast<QuicEcnCodepoint>(
+            *(reinterpret_cast<uint8_t*>(CMSG_DATA(cmsg))) & 0x03);
+        return true;
+      }
+      if (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_TCLASS) {
+        // IPV6_RECVTCLASS delivers the traffic class as an int.
+        *ecn = static_cast<QuicEcnCodepoint>(
+            *(reinterpret_cast<int*>(CMSG_DATA(cmsg))) & 0x03);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 // static
 int QuicSocketUtils::SetGetAddressInfo(int fd, int address_family) {
   int get_local_ip = 1;
@@ -105,6 +153,17 @@ int QuicSocketUtils::SetGetAddressInfo(int fd, int address_family) {
   return rc;
 }
 
+// static
+int QuicSocketUtils::SetGetEcn(int fd, int address_family) {
+  int get_tos = 1;
+  int rc = setsockopt(fd, IPPROTO_IP, IP_RECVTOS, &get_tos, sizeof(get_tos));
+  if (rc == 0 && address_family == AF_INET6) {
+    rc = setsockopt(fd, IPPROTO_IPV6, IPV6_RECVTCLASS, &get_tos,
+                    sizeof(get_tos));
+  }
+  return rc;
+}
+
 // static
 int QuicSocketUtils::SetGetSoftwareReceiveTimestamp(int fd) {
   int timestamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
@@ -112,6 +171,63 @@ int QuicSocketUtils::SetGetSoftwareReceiveTimestamp(int fd) {
                     sizeof(timestamping));
 }
 
+// static
+int QuicSocketUtils::SetGetHardwareReceiveTimestamp(int fd) {
+  // Request NIC timestamps alongside the software ones; the kernel fills in
+  // whichever are available per packet and the cmsg parser prefers the raw
+  // hardware value. The NIC itself must have RX timestamping enabled
+  // (SIOCSHWTSTAMP, typically via hwstamp_ctl) for hardware values to
+  // appear.
+  int timestamping = SOF_TIMESTAMPING_RX_HARDWARE |
+                     SOF_TIMESTAMPING_RAW_HARDWARE |
+                     SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE;
+  return setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &timestamping,
+                    sizeof(timestamping));
+}
+
+// static
+int QuicSocketUtils::SetReusePort(int fd) {
+  int one = 1;
+  return setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+}
+
+// static
+bool QuicSocketUtils::AttachShardingFilter(int fd, size_t num_shards) {
+  // The filter sees packet data starting at the UDP payload, i.e. the QUIC
+  // public header. Byte 0 holds the public flags; if the 8-byte connection
+  // ID is present (flag 0x08), shard on its leading 4 bytes, otherwise fall
+  // back to the kernel's flow hash.
+  struct sock_filter insns[] = {
+      // A = public flags; test the connection ID bit.
+      {BPF_LD | BPF_B | BPF_ABS, 0, 0, 0},
+      {BPF_ALU | BPF_AND | BPF_K, 0, 0, 0x08},
+      {BPF_JMP | BPF_JEQ | BPF_K, 3, 0, 0},
+      // A = first 4 bytes of the connection ID.
+      {BPF_LD | BPF_W | BPF_ABS, 0, 0, 1},
+      {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(num_shards)},
+      {BPF_RET | BPF_A, 0, 0, 0},
+      // No connection ID: A = skb->hash.
+      {BPF_LD | BPF_W | BPF_ABS, 0, 0,
+       static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_RXHASH)},
+      {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(num_shards)},
+      {BPF_RET | BPF_A, 0, 0, 0},
+  };
+  struct sock_fprog prog = {arraysize(insns), insns};
+  if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog,
+                 sizeof(prog)) != 0) {
+    QUIC_LOG(WARNING) << "SO_ATTACH_REUSEPORT_CBPF failed: " << strerror(errno)
+                      << ". Falling back to kernel 4-tuple hashing.";
+    return false;
+  }
+  return true;
+}
+
+// static
+int QuicSocketUtils::SetBusyPoll(int fd, int busy_poll_us) {
+  return setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &busy_poll_us,
+                    sizeof(busy_poll_us));
+}
+
 // static
 bool QuicSocketUtils::SetSendBufferSize(int fd, size_t size) {
   if (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &size, sizeof(size)) != 0) {
@@ -130,6 +246,16 @@ bool QuicSocketUtils::SetReceiveBufferSize(int fd, size_t size) {
   return true;
 }
 
+// static
+int QuicSocketUtils::GetReceiveBufferSize(int fd) {
+  int size = 0;
+  socklen_t size_len = sizeof(size);
+  if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &size, &size_len) != 0) {
+    return -1;
+  }
+  return size;
+}
+
 // static
 int QuicSocketUtils::ReadPacket(int fd,
                                 char* buffer,
@@ -305,7 +431,16 @@ int QuicSocketUtils::CreateUDPSocket(const QuicSocketAddress& address,
     return -1;
   }
 
-  rc = SetGetSoftwareReceiveTimestamp(fd);
+  rc = SetGetEcn(fd, address_family);
+  if (rc < 0) {
+    QUIC_LOG(WARNING) << "ECN detection not supported: " << strerror(errno);
+  }
+
+  if (FLAGS_quic_server_use_hardware_timestamps) {
+    rc = SetGetHardwareReceiveTimestamp(fd);
+  } else {
+    rc = SetGetSoftwareReceiveTimestamp(fd);
+  }
   if (rc < 0) {
     QUIC_LOG(WARNING) << "SO_TIMESTAMPING not supported; using fallback: "
                       << strerror(errno);
@@ -40,13 +40,14 @@ class QuicSocketUtils {
  public:
   // The first integer is for overflow. The in6_pktinfo is the larger of the
   // address structures present. LinuxTimestamping is present for socket
-  // timestamping.  The subsequent int is for ttl.
+  // timestamping.  The subsequent ints are for ttl and the TOS byte (ECN).
   // The final int is a sentinel so the msg_controllen feedback
   // can be used to detect larger control messages than there is space for.
   static const int kSpaceForCmsg =
       CMSG_SPACE(CMSG_LEN(sizeof(int)) + CMSG_LEN(sizeof(in6_pktinfo)) +
                  CMSG_LEN(sizeof(LinuxTimestamping)) +
                  CMSG_LEN(sizeof(int)) +
+                 CMSG_LEN(sizeof(int)) +
                  CMSG_LEN(sizeof(int)));
 
   // Fills in |address| if |hdr| contains IP_PKTINFO or IPV6_PKTINFO. Fills in
@@ -65,20 +66,57 @@ class QuicSocketUtils {
   // value and return true. Otherwise it will return false.
   static bool GetTtlFromMsghdr(struct msghdr* hdr, int* ttl);
 
+  // If the msghdr contains an IP_TOS or IPV6_TCLASS entry, this will set ecn
+  // to the codepoint in its low two bits and return true. Otherwise it will
+  // return false.
+  static bool GetEcnFromMsghdr(struct msghdr* hdr, QuicEcnCodepoint* ecn);
+
   // Sets either IP_PKTINFO or IPV6_PKTINFO on the socket, based on
   // address_family.  Returns the return code from setsockopt.
   static int SetGetAddressInfo(int fd, int address_family);
 
+  // Sets IP_RECVTOS (and IPV6_RECVTCLASS for AF_INET6) on the socket so the
+  // received TOS byte, including the ECN codepoint, is delivered as a cmsg.
+  // Returns the return code from setsockopt.
+  static int SetGetEcn(int fd, int address_family);
+
   // Sets SO_TIMESTAMPING on the socket for software receive timestamping.
   // Returns the return code from setsockopt.
   static int SetGetSoftwareReceiveTimestamp(int fd);
 
+  // Sets SO_TIMESTAMPING on the socket requesting raw NIC receive timestamps
+  // in addition to software ones. Returns the return code from setsockopt.
+  static int SetGetHardwareReceiveTimestamp(int fd);
+
+  // Sets SO_REUSEPORT on the socket so that several sockets may bind the
+  // same address, with the kernel spreading incoming packets across them.
+  // Must be called before bind(). Returns the return code from setsockopt.
+  static int SetReusePort(int fd);
+
+  // Attaches a classic BPF program to |fd|'s SO_REUSEPORT group which steers
+  // incoming packets to group member (connection_id % num_shards) when the
+  // QUIC public header carries a connection ID, falling back to the kernel's
+  // flow hash otherwise. Attaching through any member applies to the whole
+  // group, which must have exactly |num_shards| sockets bound in shard
+  // order. Returns false (and leaves the kernel's default 4-tuple hashing in
+  // place) if the kernel does not support SO_ATTACH_REUSEPORT_CBPF.
+  static bool AttachShardingFilter(int fd, size_t num_shards);
+
+  // Sets SO_BUSY_POLL so the kernel busy-polls the device queue for up to
+  // |busy_poll_us| microseconds on a blocking receive before sleeping.
+  // Returns the return code from setsockopt.
+  static int SetBusyPoll(int fd, int busy_poll_us);
+
   // Sets the send buffer size to |size| and returns false if it fails.
   static bool SetSendBufferSize(int fd, size_t size);
 
   // Sets the receive buffer size to |size| and returns false if it fails.
   static bool SetReceiveBufferSize(int fd, size_t size);
 
+  // Returns the receive buffer size the kernel granted for |fd| (which may
+  // differ from what was requested), or -1 on failure.
+  static int GetReceiveBufferSize(int fd);
+
   // Reads buf_len from the socket.  If reading is successful, returns bytes
   // read and sets peer_address to the peer address.  Otherwise returns -1.
   //
@@ -0,0 +1,303 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_batch_packet_writer.h"
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include "net/quic/platform/api/quic_logging.h"
+#include "net/tools/quic/platform/impl/quic_socket_utils.h"
+
+// UDP_SEGMENT and SO_TXTIME are only present in very recent kernel headers;
+// define them locally so the writer still compiles (and probes at runtime)
+// on older build machines.
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+#if defined(__linux__) && !defined(SO_TXTIME)
+#define SO_TXTIME 61
+#define SCM_TXTIME SO_TXTIME
+#endif
+
+namespace net {
+
+namespace {
+
+// Space for a pktinfo cmsg (the larger of the v4/v6 variants), a uint16_t
+// UDP_SEGMENT cmsg, and a uint64_t SCM_TXTIME cmsg.
+const int kSpaceForPktInfo = CMSG_SPACE(sizeof(in6_pktinfo));
+const int kSpaceForGsoSize = CMSG_SPACE(sizeof(uint16_t));
+const int kSpaceForTxTime = CMSG_SPACE(sizeof(uint64_t));
+
+// Mirrors struct sock_txtime from <linux/net_tstamp.h>, which older headers
+// do not provide.
+struct SockTxTime {
+  clockid_t clockid;
+  uint32_t flags;
+};
+
+// Returns the current CLOCK_MONOTONIC time in nanoseconds, the clock domain
+// SO_TXTIME transmit times are expressed in.
+uint64_t MonotonicNowNanos() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+}  // namespace
+
+QuicBatchPacketWriter::QuicBatchPacketWriter(int fd)
+    : QuicDefaultPacketWriter(fd),
+      num_buffered_(0),
+      supports_gso_(SupportsGso(fd)),
+      supports_txtime_(SupportsTxTime(fd)) {}
+
+QuicBatchPacketWriter::~QuicBatchPacketWriter() {}
+
+WriteResult QuicBatchPacketWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const QuicIpAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    PerPacketOptions* options) {
+  DCHECK(!IsWriteBlocked());
+  DCHECK_LE(buf_len, static_cast<size_t>(kMaxPacketSize));
+
+  if (num_buffered_ == kMaxBatchedPackets) {
+    WriteResult result = Flush();
+    if (result.status != WRITE_STATUS_OK && num_buffered_ > 0) {
+      // The caller's packet was not buffered; it will retransmit it after
+      // the socket becomes writable again.
+      return result;
+    }
+  }
+
+  BufferedWrite* write = &buffered_writes_[num_buffered_];
+  memcpy(write->buffer, buffer, buf_len);
+  write->buf_len = buf_len;
+  write->self_address = self_address;
+  write->peer_address = peer_address;
+  write->release_time_ns = 0;
+  if (supports_txtime_ && options != nullptr &&
+      !options->release_time_delay.IsZero()) {
+    write->release_time_ns =
+        MonotonicNowNanos() +
+        options->release_time_delay.ToMicroseconds() * 1000;
+  }
+  ++num_buffered_;
+  return WriteResult(WRITE_STATUS_OK, buf_len);
+}
+
+bool QuicBatchPacketWriter::SupportsReleaseTime() const {
+  return supports_txtime_;
+}
+
+bool QuicBatchPacketWriter::IsWriteBlockedDataBuffered() const {
+  // Only packets accepted by WritePacket are buffered. A packet whose
+  // WritePacket call returned WRITE_STATUS_BLOCKED was dropped and must be
+  // retransmitted by the caller.
+  return false;
+}
+
+WriteResult QuicBatchPacketWriter::Flush() {
+  int total_bytes = 0;
+  while (num_buffered_ > 0) {
+    // Find the longest run of packets to the same peer from the same self
+    // address, and within it the prefix eligible for GSO: uniform packet
+    // sizes, with only the final segment allowed to be shorter. A GSO
+    // superpacket carries a single transmit time, so packets with distinct
+    // release times stay in the sendmmsg() path, which stamps each one.
+    const BufferedWrite& head = buffered_writes_[0];
+    size_t run = 1;
+    size_t gso_run = 1;
+    while (run < num_buffered_ &&
+           buffered_writes_[run].peer_address == head.peer_address &&
+           buffered_writes_[run].self_address == head.self_address) {
+      if (gso_run == run &&
+          buffered_writes_[run].release_time_ns == head.release_time_ns &&
+          (buffered_writes_[run].buf_len == head.buf_len ||
+           (buffered_writes_[run].buf_len < head.buf_len &&
+            run + 1 == num_buffered_))) {
+        ++gso_run;
+      }
+      ++run;
+    }
+
+    int sent;
+    if (supports_gso_ && gso_run > 1) {
+      sent = FlushGsoRun(0, gso_run);
+    } else {
+      sent = FlushMmsgRun(0, run);
+    }
+
+    if (sent < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        set_write_blocked(true);
+        return WriteResult(WRITE_STATUS_BLOCKED, errno);
+      }
+      // Drop the packet at the head of the run so a persistent per-packet
+      // error cannot wedge the whole batch.
+      QUIC_LOG_FIRST_N(ERROR, 10)
+          << "Batched write failed: " << strerror(errno);
+      ReleaseBufferedPackets(1);
+      return WriteResult(WRITE_STATUS_ERROR, errno);
+    }
+    for (int i = 0; i < sent; ++i) {
+      total_bytes += buffered_writes_[i].buf_len;
+    }
+    ReleaseBufferedPackets(sent);
+  }
+  return WriteResult(WRITE_STATUS_OK, total_bytes);
+}
+
+// static
+bool QuicBatchPacketWriter::SupportsGso(int fd) {
+#if defined(__linux__)
+  int gso_size = 0;
+  return setsockopt(fd, SOL_UDP, UDP_SEGMENT, &gso_size, sizeof(gso_size)) ==
+         0;
+#else
+  return false;
+#endif
+}
+
+// static
+bool QuicBatchPacketWriter::SupportsTxTime(int fd) {
+#if defined(__linux__)
+  SockTxTime so_txtime = {CLOCK_MONOTONIC, 0};
+  return setsockopt(fd, SOL_SOCKET, SO_TXTIME, &so_txtime,
+                    sizeof(so_txtime)) == 0;
+#else
+  return false;
+#endif
+}
+
+int QuicBatchPacketWriter::FlushGsoRun(size_t first, size_t count) {
+  const BufferedWrite& head = buffered_writes_[first];
+  sockaddr_storage raw_address = head.peer_address.generic_address();
+  iovec iov[kMaxBatchedPackets];
+  for (size_t i = 0; i < count; ++i) {
+    iov[i].iov_base = buffered_writes_[first + i].buffer;
+    iov[i].iov_len = buffered_writes_[first + i].buf_len;
+  }
+
+  msghdr hdr;
+  hdr.msg_name = &raw_address;
+  hdr.msg_namelen = raw_address.ss_family == AF_INET ? sizeof(sockaddr_in)
+                                                     : sizeof(sockaddr_in6);
+  hdr.msg_iov = iov;
+  hdr.msg_iovlen = count;
+  hdr.msg_flags = 0;
+
+  char cbuf[kSpaceForPktInfo + kSpaceForGsoSize + kSpaceForTxTime];
+  hdr.msg_control = cbuf;
+  hdr.msg_controllen = sizeof(cbuf);
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr);
+  size_t cmsg_len = 0;
+  if (head.self_address.IsInitialized()) {
+    QuicSocketUtils::SetIpInfoInCmsg(head.self_address, cmsg);
+    cmsg_len += CMSG_SPACE(cmsg->cmsg_len - CMSG_LEN(0));
+    cmsg = CMSG_NXTHDR(&hdr, cmsg);
+  }
+#if defined(__linux__)
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+  *reinterpret_cast<uint16_t*>(CMSG_DATA(cmsg)) =
+      static_cast<uint16_t>(head.buf_len);
+  cmsg_len += kSpaceForGsoSize;
+  if (supports_txtime_ && head.release_time_ns != 0) {
+    cmsg = CMSG_NXTHDR(&hdr, cmsg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_TXTIME;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+    memcpy(CMSG_DATA(cmsg), &head.release_time_ns, sizeof(uint64_t));
+    cmsg_len += kSpaceForTxTime;
+  }
+#endif
+  hdr.msg_controllen = cmsg_len;
+
+  int rc;
+  do {
+    rc = sendmsg(fd(), &hdr, 0);
+  } while (rc < 0 && errno == EINTR);
+  if (rc < 0) {
+    return -1;
+  }
+  // The kernel either takes the whole superpacket or none of it.
+  return count;
+}
+
+int QuicBatchPacketWriter::FlushMmsgRun(size_t first, size_t count) {
+  mmsghdr mmsg[kMaxBatchedPackets];
+  iovec iov[kMaxBatchedPackets];
+  sockaddr_storage raw_addresses[kMaxBatchedPackets];
+  char cbuf[kMaxBatchedPackets][kSpaceForPktInfo + kSpaceForTxTime];
+
+  for (size_t i = 0; i < count; ++i) {
+    const BufferedWrite& write = buffered_writes_[first + i];
+    iov[i].iov_base = const_cast<char*>(write.buffer);
+    iov[i].iov_len = write.buf_len;
+    raw_addresses[i] = write.peer_address.generic_address();
+
+    msghdr* hdr = &mmsg[i].msg_hdr;
+    hdr->msg_name = &raw_addresses[i];
+    hdr->msg_namelen = raw_addresses[i].ss_family == AF_INET
+                           ? sizeof(sockaddr_in)
+                           : sizeof(sockaddr_in6);
+    hdr->msg_iov = &iov[i];
+    hdr->msg_iovlen = 1;
+    hdr->msg_flags = 0;
+    hdr->msg_control = cbuf[i];
+    hdr->msg_controllen = sizeof(cbuf[i]);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(hdr);
+    size_t cmsg_len = 0;
+    if (write.self_address.IsInitialized()) {
+      QuicSocketUtils::SetIpInfoInCmsg(write.self_address, cmsg);
+      cmsg_len += CMSG_SPACE(cmsg->cmsg_len - CMSG_LEN(0));
+      cmsg = CMSG_NXTHDR(hdr, cmsg);
+    }
+#if defined(__linux__)
+    if (supports_txtime_ && write.release_time_ns != 0) {
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_TXTIME;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(uint64_t));
+      memcpy(CMSG_DATA(cmsg), &write.release_time_ns, sizeof(uint64_t));
+      cmsg_len += kSpaceForTxTime;
+    }
+#endif
+    if (cmsg_len == 0) {
+      hdr->msg_control = nullptr;
+    }
+    hdr->msg_controllen = cmsg_len;
+  }
+
+  int rc;
+  do {
+    rc = sendmmsg(fd(), mmsg, count, 0);
+  } while (rc < 0 && errno == EINTR);
+  return rc;
+}
+
+void QuicBatchPacketWriter::ReleaseBufferedPackets(size_t count) {
+  DCHECK_LE(count, num_buffered_);
+  for (size_t i = count; i < num_buffered_; ++i) {
+    buffered_writes_[i - count].buf_len = buffered_writes_[i].buf_len;
+    buffered_writes_[i - count].self_address = buffered_writes_[i].self_address;
+    buffered_writes_[i - count].peer_address = buffered_writes_[i].peer_address;
+    buffered_writes_[i - count].release_time_ns =
+        buffered_writes_[i].release_time_ns;
+    memcpy(buffered_writes_[i - count].buffer, buffered_writes_[i].buffer,
+           buffered_writes_[i].buf_len);
+  }
+  num_buffered_ -= count;
+}
+
+}  // namespace net
@@ -0,0 +1,95 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
+#define NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/macros.h"
+#include "net/quic/platform/api/quic_export.h"
+#include "net/quic/platform/api/quic_socket_address.h"
+#include "net/tools/quic/quic_default_packet_writer.h"
+
+namespace net {
+
+// Number of packets the writer will accumulate before forcing a flush.
+// Matches the kernel's UIO_MAXIOV granularity well enough that a full
+// batch still goes out in a single sendmmsg() call.
+const size_t kMaxBatchedPackets = 32;
+
+// A packet writer which batches packets written between flushes and sends
+// them to the kernel with a single sendmmsg() call, using UDP generic
+// segmentation offload (GSO) for runs of same-sized packets to the same
+// peer when the kernel supports it. Writes are buffered internally until
+// Flush() is called, so the owner (QuicDispatcher::OnCanWrite and the
+// server's event loop) must flush at the end of every epoll wakeup.
+//
+// On kernels with SO_TXTIME the writer also offloads pacing: packets
+// carrying a PerPacketOptions::release_time_delay are stamped with an
+// SCM_TXTIME transmit time and the fq qdisc enforces the inter-packet gaps,
+// so a whole paced burst can be submitted in one batch.
+class QuicBatchPacketWriter : public QuicDefaultPacketWriter {
+ public:
+  explicit QuicBatchPacketWriter(int fd);
+  ~QuicBatchPacketWriter() override;
+
+  // QuicPacketWriter
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const QuicIpAddress& self_address,
+                          const QuicSocketAddress& peer_address,
+                          PerPacketOptions* options) override;
+  bool IsWriteBlockedDataBuffered() const override;
+  WriteResult Flush() override;
+  bool SupportsReleaseTime() const override;
+
+  size_t num_buffered_packets() const { return num_buffered_; }
+
+ private:
+  // A packet accepted by WritePacket but not yet handed to the kernel.
+  struct BufferedWrite {
+    size_t buf_len;
+    QuicIpAddress self_address;
+    QuicSocketAddress peer_address;
+    // Absolute CLOCK_MONOTONIC transmit time in nanoseconds, or 0 to send
+    // as soon as the batch is flushed.
+    uint64_t release_time_ns;
+    char buffer[kMaxPacketSize];
+  };
+
+  // Returns true if setting UDP_SEGMENT on |fd| succeeds, i.e. the running
+  // kernel can segment a GSO superpacket for us.
+  static bool SupportsGso(int fd);
+
+  // Returns true if enabling SO_TXTIME on |fd| succeeds, i.e. the running
+  // kernel honors per-packet SCM_TXTIME transmit times.
+  static bool SupportsTxTime(int fd);
+
+  // Sends buffered packets [first, first + count) as a single GSO write.
+  // All packets except the last must have identical lengths. Returns the
+  // number of packets handed to the kernel, or -1 with errno set.
+  int FlushGsoRun(size_t first, size_t count);
+
+  // Sends buffered packets [first, first + count) with one sendmmsg() call.
+  // Returns the number of packets handed to the kernel, or -1 with errno
+  // set.
+  int FlushMmsgRun(size_t first, size_t count);
+
+  // Drops the first |count| buffered packets, compacting the remainder to
+  // the front of the buffer.
+  void ReleaseBufferedPackets(size_t count);
+
+  BufferedWrite buffered_writes_[kMaxBatchedPackets];
+  size_t num_buffered_;
+  bool supports_gso_;
+  bool supports_txtime_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicBatchPacketWriter);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_BATCH_PACKET_WRITER_H_
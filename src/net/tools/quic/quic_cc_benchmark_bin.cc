@@ -0,0 +1,304 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Sweeps the congestion controllers over a corpus of simulated network
+// scenarios and emits one JSON record per run, so that congestion control
+// regressions can be caught by comparing the output against a known-good
+// baseline instead of being discovered in production.
+//
+// Each scenario describes a bottleneck link (bandwidth, propagation delay,
+// queue size, random loss rate) modeled with net/quic/test_tools/simulator,
+// together with a throughput floor and an RTT ceiling that every controller
+// is expected to meet.  A run which misses its envelope is reported with
+// "pass": false and causes a non-zero exit code.
+//
+// Usage: quic_cc_benchmark [--seed=<uint64>] [--transfer_bytes=<bytes>]
+//
+// Example output:
+// {"cc": "bbr", "scenario": "4g", "transfer_bytes": 5242880,
+//  "elapsed_us": 5719137, "throughput_kbps": 7333, "srtt_us": 114490,
+//  "min_rtt_us": 83283, "packets_lost": 0, "pass": true}
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/command_line.h"
+#include "net/quic/core/congestion_control/bbr_sender.h"
+#include "net/quic/core/congestion_control/rtt_stats.h"
+#include "net/quic/core/congestion_control/tcp_cubic_sender_bytes.h"
+#include "net/quic/core/crypto/quic_random.h"
+#include "net/quic/core/quic_bandwidth.h"
+#include "net/quic/core/quic_connection_stats.h"
+#include "net/quic/core/quic_constants.h"
+#include "net/quic/platform/api/quic_logging.h"
+#include "net/quic/test_tools/quic_connection_peer.h"
+#include "net/quic/test_tools/quic_sent_packet_manager_peer.h"
+#include "net/quic/test_tools/simulator/packet_filter.h"
+#include "net/quic/test_tools/simulator/quic_endpoint.h"
+#include "net/quic/test_tools/simulator/simulator.h"
+#include "net/quic/test_tools/simulator/switch.h"
+
+using std::string;
+
+namespace net {
+namespace {
+
+// The initial CWND used by all benchmarked senders.
+const QuicPacketCount kInitialCongestionWindowPackets = 10;
+
+// A network scenario the congestion controllers are swept over, together
+// with the envelope each of them is expected to stay within.  The simulator
+// clock has a granularity of 1us, so bottleneck bandwidths are kept at or
+// below 20 Mbps to prevent packets from landing on the same timestamp; the
+// scenarios are therefore scaled-down versions of the real edge profiles.
+struct Scenario {
+  // Name emitted into the JSON output.
+  const char* name;
+  QuicBandwidth bottleneck_bandwidth;
+  QuicTime::Delta propagation_delay;
+  // Size of the bottleneck queue, as a multiple of BDP.
+  float queue_bdp_multiplier;
+  // Probability of dropping any given data packet at the bottleneck.
+  float loss_rate;
+  // The run fails unless it achieves this fraction of the bottleneck
+  // bandwidth...
+  float utilization_floor;
+  // ...while keeping the smoothed RTT below this multiple of the two-way
+  // propagation delay.
+  float srtt_ceiling_multiplier;
+};
+
+std::vector<Scenario> GetScenarioCorpus() {
+  return {
+      {"4g", QuicBandwidth::FromKBitsPerSecond(8000),
+       QuicTime::Delta::FromMilliseconds(40), 2.f, 0.f, 0.8f, 4.f},
+      {"wifi", QuicBandwidth::FromKBitsPerSecond(15000),
+       QuicTime::Delta::FromMilliseconds(15), 1.f, 0.01f, 0.4f, 4.f},
+      {"inter-dc", QuicBandwidth::FromKBitsPerSecond(20000),
+       QuicTime::Delta::FromMilliseconds(2), 0.5f, 0.f, 0.8f, 4.f},
+  };
+}
+
+// A seedable deterministic random number generator, so that runs with the
+// same --seed exercise the same loss pattern and can be compared directly.
+// Not cryptographically secure; xorshift128+.
+class DeterministicRandom : public QuicRandom {
+ public:
+  explicit DeterministicRandom(uint64_t seed)
+      : state0_(seed | 1), state1_(~seed | 1) {}
+
+  uint64_t RandUint64() override {
+    uint64_t x = state0_;
+    const uint64_t y = state1_;
+    state0_ = y;
+    x ^= x << 23;
+    state1_ = x ^ y ^ (x >> 17) ^ (y >> 26);
+    return state1_ + y;
+  }
+
+  void RandBytes(void* data, size_t len) override {
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(data);
+    for (size_t i = 0; i < len; i++) {
+      bytes[i] = RandUint64() & 0xff;
+    }
+  }
+
+  void Reseed(const void* additional_entropy, size_t entropy_len) override {}
+
+ private:
+  uint64_t state0_;
+  uint64_t state1_;
+};
+
+// Drops each packet traversing the filter with the configured probability.
+class RandomLossFilter : public simulator::PacketFilter {
+ public:
+  RandomLossFilter(simulator::Simulator* simulator,
+                   string name,
+                   simulator::Endpoint* input,
+                   float loss_rate,
+                   QuicRandom* random)
+      : PacketFilter(simulator, name, input),
+        loss_rate_(loss_rate),
+        random_(random) {}
+
+ protected:
+  bool FilterPacket(const simulator::Packet& packet) override {
+    return random_->RandUint64() >=
+           loss_rate_ * std::numeric_limits<uint64_t>::max();
+  }
+
+ private:
+  const float loss_rate_;
+  QuicRandom* random_;
+};
+
+// The result of a single controller/scenario run.
+struct BenchmarkResult {
+  BenchmarkResult()
+      : transfer_bytes(0),
+        elapsed(QuicTime::Delta::Zero()),
+        throughput(QuicBandwidth::Zero()),
+        srtt(QuicTime::Delta::Zero()),
+        min_rtt(QuicTime::Delta::Zero()),
+        packets_lost(0),
+        pass(false) {}
+
+  string cc;
+  string scenario;
+  QuicByteCount transfer_bytes;
+  QuicTime::Delta elapsed;
+  QuicBandwidth throughput;
+  QuicTime::Delta srtt;
+  QuicTime::Delta min_rtt;
+  QuicPacketCount packets_lost;
+  bool pass;
+};
+
+void PrintResultAsJson(const BenchmarkResult& result) {
+  std::cout << "{\"cc\": \"" << result.cc << "\", \"scenario\": \""
+            << result.scenario
+            << "\", \"transfer_bytes\": " << result.transfer_bytes
+            << ", \"elapsed_us\": " << result.elapsed.ToMicroseconds()
+            << ", \"throughput_kbps\": " << result.throughput.ToKBitsPerSecond()
+            << ", \"srtt_us\": " << result.srtt.ToMicroseconds()
+            << ", \"min_rtt_us\": " << result.min_rtt.ToMicroseconds()
+            << ", \"packets_lost\": " << result.packets_lost
+            << ", \"pass\": " << (result.pass ? "true" : "false") << "}"
+            << std::endl;
+}
+
+// Replaces the send algorithm of |endpoint| with the controller named by
+// |cc|.  Ownership of the new sender is taken over by the connection.
+void InstallSender(const string& cc,
+                   simulator::QuicEndpoint* endpoint,
+                   QuicRandom* random) {
+  QuicConnection* connection = endpoint->connection();
+  const RttStats* rtt_stats = connection->sent_packet_manager().GetRttStats();
+  SendAlgorithmInterface* sender = nullptr;
+  if (cc == "bbr") {
+    sender = new BbrSender(
+        rtt_stats,
+        test::QuicSentPacketManagerPeer::GetUnackedPacketMap(
+            test::QuicConnectionPeer::GetSentPacketManager(connection)),
+        kInitialCongestionWindowPackets, kDefaultMaxCongestionWindowPackets,
+        random);
+  } else {
+    sender = new TcpCubicSenderBytes(
+        connection->helper()->GetClock(), rtt_stats, false /* don't use Reno */,
+        kInitialCongestionWindowPackets, kDefaultMaxCongestionWindowPackets,
+        test::QuicConnectionPeer::GetStats(connection));
+  }
+  test::QuicConnectionPeer::SetSendAlgorithm(connection, sender);
+}
+
+BenchmarkResult RunScenario(const string& cc,
+                            const Scenario& scenario,
+                            QuicByteCount transfer_bytes,
+                            uint64_t seed) {
+  // The topology mirrors the one used by the sender unit tests: a fast local
+  // link into a switch with the bottleneck queue, and the scenario's
+  // bottleneck link out to the receiver.
+  const QuicBandwidth local_bandwidth =
+      QuicBandwidth::FromKBitsPerSecond(10000) + scenario.bottleneck_bandwidth;
+  const QuicTime::Delta local_propagation_delay =
+      QuicTime::Delta::FromMilliseconds(2);
+  const QuicTime::Delta rtt =
+      2 * (scenario.propagation_delay + local_propagation_delay +
+           scenario.bottleneck_bandwidth.TransferTime(kMaxPacketSize) +
+           local_bandwidth.TransferTime(kMaxPacketSize));
+  const QuicByteCount bdp = rtt * scenario.bottleneck_bandwidth;
+
+  simulator::Simulator simulator;
+  DeterministicRandom random(seed);
+  simulator.set_random_generator(&random);
+
+  simulator::QuicEndpoint sender_endpoint(&simulator, "Sender", "Receiver",
+                                          Perspective::IS_CLIENT,
+                                          /*connection_id=*/42);
+  simulator::QuicEndpoint receiver_endpoint(&simulator, "Receiver", "Sender",
+                                            Perspective::IS_SERVER,
+                                            /*connection_id=*/42);
+  InstallSender(cc, &sender_endpoint, &random);
+
+  simulator::Switch network_switch(
+      &simulator, "Switch", /*port_count=*/8,
+      std::max<QuicByteCount>(scenario.queue_bdp_multiplier * bdp,
+                              2 * kMaxPacketSize));
+  RandomLossFilter loss_filter(&simulator, "Loss filter", &sender_endpoint,
+                               scenario.loss_rate, &random);
+  simulator::SymmetricLink sender_link(&loss_filter, network_switch.port(1),
+                                       local_bandwidth,
+                                       local_propagation_delay);
+  simulator::SymmetricLink receiver_link(
+      &receiver_endpoint, network_switch.port(2),
+      scenario.bottleneck_bandwidth, scenario.propagation_delay);
+
+  const QuicTime start_time = simulator.GetClock()->Now();
+  sender_endpoint.AddBytesToTransfer(transfer_bytes);
+  // Allow several times the ideal transfer time before declaring the run
+  // stuck; lossy scenarios recover from tail losses via retransmission
+  // timeouts, which can stretch the tail of the transfer considerably.
+  const QuicTime::Delta deadline =
+      10 * scenario.bottleneck_bandwidth.TransferTime(transfer_bytes) +
+      QuicTime::Delta::FromSeconds(30);
+  bool finished = simulator.RunUntilOrTimeout(
+      [&sender_endpoint]() { return sender_endpoint.bytes_to_transfer() == 0; },
+      deadline);
+
+  const QuicConnectionStats& stats = sender_endpoint.connection()->GetStats();
+  BenchmarkResult result;
+  result.cc = cc;
+  result.scenario = scenario.name;
+  result.transfer_bytes = transfer_bytes;
+  result.elapsed = simulator.GetClock()->Now() - start_time;
+  result.throughput = QuicBandwidth::FromBytesAndTimeDelta(
+      transfer_bytes - sender_endpoint.bytes_to_transfer(), result.elapsed);
+  result.srtt = QuicTime::Delta::FromMicroseconds(stats.srtt_us);
+  result.min_rtt = QuicTime::Delta::FromMicroseconds(stats.min_rtt_us);
+  result.packets_lost = stats.packets_lost;
+  result.pass =
+      finished && !sender_endpoint.wrong_data_received() &&
+      result.throughput >=
+          scenario.utilization_floor * scenario.bottleneck_bandwidth &&
+      result.srtt <= scenario.srtt_ceiling_multiplier * rtt;
+  return result;
+}
+
+}  // namespace
+}  // namespace net
+
+int main(int argc, char* argv[]) {
+  base::CommandLine::Init(argc, argv);
+  base::CommandLine* line = base::CommandLine::ForCurrentProcess();
+
+  uint64_t seed = 1;
+  if (line->HasSwitch("seed")) {
+    seed = std::strtoull(line->GetSwitchValueASCII("seed").c_str(), nullptr,
+                         10);
+  }
+  net::QuicByteCount transfer_bytes = 5 * 1024 * 1024;
+  if (line->HasSwitch("transfer_bytes")) {
+    transfer_bytes = std::strtoull(
+        line->GetSwitchValueASCII("transfer_bytes").c_str(), nullptr, 10);
+  }
+
+  int failures = 0;
+  for (const string& cc : std::vector<string>{"bbr", "cubic"}) {
+    for (const net::Scenario& scenario : net::GetScenarioCorpus()) {
+      net::BenchmarkResult result =
+          net::RunScenario(cc, scenario, transfer_bytes, seed);
+      net::PrintResultAsJson(result);
+      if (!result.pass) {
+        ++failures;
+      }
+    }
+  }
+  return failures;
+}
@@ -0,0 +1,456 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// quic_cc_canary: feeds one captured packet dump (the QUICRPL1 format
+// written by the capture layer and consumed by quic_dispatcher_replay) to
+// two QuicSimpleDispatcher arms in lockstep — a baseline arm running the
+// stack's default send algorithm (TcpCubicSenderBytes) and a candidate arm
+// whose congestion controller is selected via connection options (e.g.
+// TBBR) — and periodically emits a JSON record diffing the arms' send
+// volume, per-packet processing latency and CPU time. Pointing it at a
+// continuously appended mirror dump turns a one-off congestion control
+// experiment into a standing fixture: every interval gets a measured
+// baseline-vs-candidate verdict over identical traffic.
+//
+// QUIC flags are process globals, so a flag flip from quic_flags_list.h
+// applies to both arms of one process identically. Candidates that differ
+// only by a flag are therefore canaried by running two instances of this
+// binary over the same dump, one per flag setting, and diffing their
+// summaries; candidates selectable per connection (connection options) are
+// compared in-process by the two arms.
+//
+// Both arms see the byte-identical packet stream, so like
+// quic_dispatcher_replay the comparison covers the handshake and the
+// unencryptable post-handshake packet paths (routing, buffering,
+// time-wait), which is where dispatcher-side send algorithm cost shows up.
+
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "net/quic/chromium/crypto/proof_source_chromium.h"
+#include "net/quic/chromium/quic_utils_chromium.h"
+#include "net/quic/core/crypto/quic_random.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/platform/api/quic_socket_address.h"
+#include "net/quic/platform/api/quic_str_cat.h"
+#include "net/tools/epoll_server/epoll_server.h"
+#include "net/tools/quic/platform/impl/quic_epoll_clock.h"
+#include "net/tools/quic/quic_client_load_generator.h"
+#include "net/tools/quic/quic_epoll_alarm_factory.h"
+#include "net/tools/quic/quic_epoll_connection_helper.h"
+#include "net/tools/quic/quic_http_response_cache.h"
+#include "net/tools/quic/quic_simple_crypto_server_stream_helper.h"
+#include "net/tools/quic/quic_simple_dispatcher.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+
+namespace {
+
+const char kDumpMagic[] = "QUICRPL1";
+const size_t kDumpMagicLen = 8;
+
+// A writer which counts and discards everything the dispatcher sends; the
+// mirrored peers are not listening, and the counts are the arm's send
+// volume measurement.
+class CountingPacketWriter : public net::QuicPacketWriter {
+ public:
+  CountingPacketWriter() : packets_(0), bytes_(0) {}
+  ~CountingPacketWriter() override {}
+
+  net::WriteResult WritePacket(const char* buffer,
+                               size_t buf_len,
+                               const net::QuicIpAddress& self_address,
+                               const net::QuicSocketAddress& peer_address,
+                               net::PerPacketOptions* options) override {
+    ++packets_;
+    bytes_ += buf_len;
+    return net::WriteResult(net::WRITE_STATUS_OK, buf_len);
+  }
+
+  bool IsWriteBlockedDataBuffered() const override { return false; }
+  bool IsWriteBlocked() const override { return false; }
+  void SetWritable() override {}
+
+  net::QuicByteCount GetMaxPacketSize(
+      const net::QuicSocketAddress& peer_address) const override {
+    return net::kMaxPacketSize;
+  }
+
+  uint64_t packets() const { return packets_; }
+  uint64_t bytes() const { return bytes_; }
+
+ private:
+  uint64_t packets_;
+  uint64_t bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingPacketWriter);
+};
+
+// CPU time consumed by this thread so far, in nanoseconds. The packet loop
+// is single threaded and processes the arms one after the other, so deltas
+// of this clock attribute CPU cost to the arm being run.
+uint64_t ThreadCpuNowNs() {
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(ts.tv_sec) * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+// One dispatcher under measurement: its own event loop, clock, configs and
+// counters, fed the same packets as the other arm.
+class CanaryArm {
+ public:
+  CanaryArm(const string& name,
+            const net::QuicTagVector& connection_options,
+            std::unique_ptr<net::ProofSource> proof_source,
+            net::QuicHttpResponseCache* response_cache)
+      : name_(name),
+        clock_(&epoll_server_),
+        crypto_config_("secret",
+                       net::QuicRandom::GetInstance(),
+                       std::move(proof_source)),
+        version_manager_(net::AllSupportedVersions()),
+        server_address_(net::QuicIpAddress::Loopback6(), 6121),
+        packets_(0),
+        bytes_(0),
+        cpu_ns_(0),
+        interval_packets_(0),
+        interval_bytes_(0),
+        interval_cpu_ns_(0),
+        interval_sent_packets_(0),
+        interval_sent_bytes_(0) {
+    epoll_server_.set_timeout_in_us(0);
+    if (!connection_options.empty()) {
+      CHECK(config_.SetInitialReceivedConnectionOptions(connection_options));
+    }
+    scfg_.reset(crypto_config_.AddDefaultConfig(
+        net::QuicRandom::GetInstance(), &clock_,
+        net::QuicCryptoServerConfig::ConfigOptions()));
+    dispatcher_.reset(new net::QuicSimpleDispatcher(
+        config_, &crypto_config_, &version_manager_,
+        std::unique_ptr<net::QuicEpollConnectionHelper>(
+            new net::QuicEpollConnectionHelper(
+                &epoll_server_, net::QuicAllocator::BUFFER_POOL)),
+        std::unique_ptr<net::QuicCryptoServerStream::Helper>(
+            new net::QuicSimpleCryptoServerStreamHelper(
+                net::QuicRandom::GetInstance())),
+        std::unique_ptr<net::QuicAlarmFactory>(
+            new net::QuicEpollAlarmFactory(&epoll_server_)),
+        response_cache));
+    writer_ = new CountingPacketWriter();
+    dispatcher_->InitializeWithWriter(writer_);
+    interval_histogram_.reset(new net::QuicLatencyHistogram());
+  }
+
+  // Runs one mirrored packet through this arm's dispatcher, including any
+  // alarms it makes due (retransmissions are part of a send algorithm's
+  // cost), and charges the latency and CPU spent to the arm.
+  void ProcessPacket(const net::QuicSocketAddress& client_address,
+                     const char* data,
+                     size_t length) {
+    net::QuicReceivedPacket packet(data, length, clock_.Now());
+    const uint64_t cpu_before = ThreadCpuNowNs();
+    const int64_t t0 = epoll_server_.NowInUsec();
+    dispatcher_->ProcessPacket(server_address_, client_address, packet);
+    epoll_server_.WaitForEventsAndExecuteCallbacks();
+    const int64_t t1 = epoll_server_.NowInUsec();
+    const uint64_t cpu_delta = ThreadCpuNowNs() - cpu_before;
+
+    const uint64_t process_us = t0 <= t1 ? static_cast<uint64_t>(t1 - t0) : 0;
+    total_histogram_.Record(process_us);
+    interval_histogram_->Record(process_us);
+    cpu_ns_ += cpu_delta;
+    interval_cpu_ns_ += cpu_delta;
+    ++packets_;
+    ++interval_packets_;
+    bytes_ += length;
+    interval_bytes_ += length;
+  }
+
+  // Renders this arm's counters for the current interval as a JSON object
+  // and resets them; the cumulative counters keep accruing.
+  string IntervalJsonAndReset() {
+    const uint64_t sent_packets = writer_->packets() - interval_sent_packets_;
+    const uint64_t sent_bytes = writer_->bytes() - interval_sent_bytes_;
+    const string json = net::QuicStrCat(
+        "\"", name_, "\":{\"packets_in\":", interval_packets_,
+        ",\"bytes_in\":", interval_bytes_, ",\"packets_out\":", sent_packets,
+        ",\"bytes_out\":", sent_bytes,
+        ",\"cpu_us\":", interval_cpu_ns_ / 1000,
+        ",\"process_us\":{\"p50\":", interval_histogram_->ValueAtQuantile(0.50),
+        ",\"p99\":", interval_histogram_->ValueAtQuantile(0.99),
+        ",\"max\":", interval_histogram_->max(), "}}");
+    interval_packets_ = 0;
+    interval_bytes_ = 0;
+    interval_cpu_ns_ = 0;
+    interval_sent_packets_ = writer_->packets();
+    interval_sent_bytes_ = writer_->bytes();
+    interval_histogram_.reset(new net::QuicLatencyHistogram());
+    return json;
+  }
+
+  string SummaryJson() const {
+    return net::QuicStrCat(
+        "\"", name_, "\":{\"packets_in\":", packets_, ",\"bytes_in\":", bytes_,
+        ",\"packets_out\":", writer_->packets(),
+        ",\"bytes_out\":", writer_->bytes(), ",\"cpu_us\":", cpu_ns_ / 1000,
+        ",\"process_us\":{\"min\":", total_histogram_.min(),
+        ",\"mean\":", total_histogram_.Mean(),
+        ",\"p50\":", total_histogram_.ValueAtQuantile(0.50),
+        ",\"p99\":", total_histogram_.ValueAtQuantile(0.99),
+        ",\"max\":", total_histogram_.max(), "}}");
+  }
+
+  uint64_t interval_cpu_ns() const { return interval_cpu_ns_; }
+  uint64_t interval_sent_bytes() const {
+    return writer_->bytes() - interval_sent_bytes_;
+  }
+  uint64_t cpu_ns() const { return cpu_ns_; }
+  uint64_t sent_bytes() const { return writer_->bytes(); }
+
+ private:
+  const string name_;
+  net::EpollServer epoll_server_;
+  net::QuicEpollClock clock_;
+  net::QuicConfig config_;
+  net::QuicCryptoServerConfig crypto_config_;
+  std::unique_ptr<net::CryptoHandshakeMessage> scfg_;
+  net::QuicVersionManager version_manager_;
+  std::unique_ptr<net::QuicSimpleDispatcher> dispatcher_;
+  CountingPacketWriter* writer_;  // Owned by |dispatcher_|.
+  const net::QuicSocketAddress server_address_;
+
+  net::QuicLatencyHistogram total_histogram_;
+  std::unique_ptr<net::QuicLatencyHistogram> interval_histogram_;
+  uint64_t packets_;
+  uint64_t bytes_;
+  uint64_t cpu_ns_;
+  uint64_t interval_packets_;
+  uint64_t interval_bytes_;
+  uint64_t interval_cpu_ns_;
+  uint64_t interval_sent_packets_;
+  uint64_t interval_sent_bytes_;
+
+  DISALLOW_COPY_AND_ASSIGN(CanaryArm);
+};
+
+// Candidate CPU and send volume as a percentage of baseline, 100 meaning
+// parity. Returns 0 when the baseline value is zero.
+uint64_t PercentOfBaseline(uint64_t candidate, uint64_t baseline) {
+  return baseline == 0 ? 0 : candidate * 100 / baseline;
+}
+
+bool ReadExact(std::ifstream* in, char* out, size_t len) {
+  in->read(out, len);
+  return static_cast<size_t>(in->gcount()) == len;
+}
+
+uint64_t ReadLE64(const char* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint16_t ReadLE16(const char* p) {
+  uint16_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  base::AtExitManager exit_manager;
+  base::MessageLoopForIO message_loop;
+
+  base::CommandLine::Init(argc, argv);
+  base::CommandLine* line = base::CommandLine::ForCurrentProcess();
+
+  logging::LoggingSettings settings;
+  settings.logging_dest = logging::LOG_TO_SYSTEM_DEBUG_LOG;
+  CHECK(logging::InitLogging(settings));
+
+  if (line->HasSwitch("h") || line->HasSwitch("help") ||
+      !line->HasSwitch("dump_file")) {
+    const char* help_str =
+        "Usage: quic_cc_canary [options]\n"
+        "\n"
+        "Options:\n"
+        "-h, --help                  show this help message and exit\n"
+        "--dump_file=<file>          mirrored packet dump to feed both arms\n"
+        "                            (required)\n"
+        "--candidate_options=<tags>  comma separated connection options for\n"
+        "                            the candidate arm (default TBBR)\n"
+        "--baseline_options=<tags>   connection options for the baseline arm\n"
+        "                            (default none: TcpCubicSenderBytes)\n"
+        "--report_every=<packets>    mirrored packets per diff record\n"
+        "                            (default 10000)\n"
+        "--quic_response_cache_dir   directory of response data to serve\n"
+        "--certificate_file=<file>   path to the certificate chain\n"
+        "--key_file=<file>           path to the pkcs8 private key\n";
+    cout << help_str;
+    exit(0);
+  }
+
+  if (!line->HasSwitch("certificate_file")) {
+    cerr << "missing --certificate_file\n";
+    return 1;
+  }
+  if (!line->HasSwitch("key_file")) {
+    cerr << "missing --key_file\n";
+    return 1;
+  }
+
+  uint64_t report_every = 10000;
+  if (line->HasSwitch("report_every")) {
+    if (!base::StringToUint64(line->GetSwitchValueASCII("report_every"),
+                              &report_every) ||
+        report_every == 0) {
+      cerr << "--report_every must be a positive integer\n";
+      return 1;
+    }
+  }
+
+  string candidate_options_str = "TBBR";
+  if (line->HasSwitch("candidate_options")) {
+    candidate_options_str = line->GetSwitchValueASCII("candidate_options");
+  }
+  string baseline_options_str;
+  if (line->HasSwitch("baseline_options")) {
+    baseline_options_str = line->GetSwitchValueASCII("baseline_options");
+  }
+
+  std::ifstream dump(line->GetSwitchValueASCII("dump_file"),
+                     std::ios::in | std::ios::binary);
+  if (!dump) {
+    cerr << "Unable to open " << line->GetSwitchValueASCII("dump_file")
+         << "\n";
+    return 1;
+  }
+  char magic[kDumpMagicLen];
+  if (!ReadExact(&dump, magic, kDumpMagicLen) ||
+      memcmp(magic, kDumpMagic, kDumpMagicLen) != 0) {
+    cerr << "Not a QUIC replay dump (bad magic)\n";
+    return 1;
+  }
+
+  net::QuicHttpResponseCache response_cache;
+  if (line->HasSwitch("quic_response_cache_dir")) {
+    response_cache.InitializeFromDirectory(
+        line->GetSwitchValueASCII("quic_response_cache_dir"));
+  }
+
+  // Each arm gets its own proof source; they load the same certificate.
+  std::unique_ptr<net::ProofSourceChromium> baseline_proof(
+      new net::ProofSourceChromium());
+  std::unique_ptr<net::ProofSourceChromium> candidate_proof(
+      new net::ProofSourceChromium());
+  CHECK(baseline_proof->Initialize(line->GetSwitchValuePath("certificate_file"),
+                                   line->GetSwitchValuePath("key_file"),
+                                   base::FilePath()));
+  CHECK(candidate_proof->Initialize(
+      line->GetSwitchValuePath("certificate_file"),
+      line->GetSwitchValuePath("key_file"), base::FilePath()));
+
+  CanaryArm baseline("baseline",
+                     net::ParseQuicConnectionOptions(baseline_options_str),
+                     std::move(baseline_proof), &response_cache);
+  CanaryArm candidate("candidate",
+                      net::ParseQuicConnectionOptions(candidate_options_str),
+                      std::move(candidate_proof), &response_cache);
+
+  uint64_t num_packets = 0;
+  uint64_t num_intervals = 0;
+  uint64_t interval_first_timestamp_us = 0;
+  uint64_t timestamp_us = 0;
+
+  char header[13];
+  char addr_bytes[16];
+  char payload[net::kMaxPacketSize * 4];
+  while (ReadExact(&dump, header, 9)) {
+    timestamp_us = ReadLE64(header);
+    const uint8_t family = static_cast<uint8_t>(header[8]);
+    const size_t addr_len = family == 4 ? 4 : 16;
+    if ((family != 4 && family != 6) ||
+        !ReadExact(&dump, addr_bytes, addr_len) ||
+        !ReadExact(&dump, header, 4)) {
+      cerr << "Truncated or corrupt record after " << num_packets
+           << " packets\n";
+      return 1;
+    }
+    const uint16_t port = ReadLE16(header);
+    const uint16_t length = ReadLE16(header + 2);
+    if (length == 0 || length > sizeof(payload) ||
+        !ReadExact(&dump, payload, length)) {
+      cerr << "Truncated or corrupt record after " << num_packets
+           << " packets\n";
+      return 1;
+    }
+    net::QuicIpAddress client_ip;
+    if (!client_ip.FromPackedString(addr_bytes, addr_len)) {
+      cerr << "Bad client address after " << num_packets << " packets\n";
+      return 1;
+    }
+    const net::QuicSocketAddress client_address(client_ip, port);
+
+    if (num_packets % report_every == 0) {
+      interval_first_timestamp_us = timestamp_us;
+    }
+
+    baseline.ProcessPacket(client_address, payload, length);
+    candidate.ProcessPacket(client_address, payload, length);
+    ++num_packets;
+
+    if (num_packets % report_every == 0) {
+      ++num_intervals;
+      // Snapshot the ratios before IntervalJsonAndReset() zeroes the
+      // interval counters.
+      const uint64_t cpu_pct = PercentOfBaseline(candidate.interval_cpu_ns(),
+                                                 baseline.interval_cpu_ns());
+      const uint64_t bytes_out_pct = PercentOfBaseline(
+          candidate.interval_sent_bytes(), baseline.interval_sent_bytes());
+      cout << net::QuicStrCat(
+                  "{\"interval\":", num_intervals,
+                  ",\"capture_span_us\":",
+                  timestamp_us - interval_first_timestamp_us, ",",
+                  baseline.IntervalJsonAndReset(), ",",
+                  candidate.IntervalJsonAndReset(),
+                  ",\"candidate_pct_of_baseline\":{\"cpu\":", cpu_pct,
+                  ",\"bytes_out\":", bytes_out_pct, "}}")
+           << endl;
+    }
+  }
+
+  if (num_packets == 0) {
+    cerr << "Dump contains no packets\n";
+    return 1;
+  }
+
+  cout << net::QuicStrCat(
+              "{\"summary\":true,\"packets\":", num_packets, ",",
+              baseline.SummaryJson(), ",", candidate.SummaryJson(),
+              ",\"candidate_pct_of_baseline\":{\"cpu\":",
+              PercentOfBaseline(candidate.cpu_ns(), baseline.cpu_ns()),
+              ",\"bytes_out\":",
+              PercentOfBaseline(candidate.sent_bytes(), baseline.sent_bytes()),
+              "}}")
+       << endl;
+  return 0;
+}
@@ -10,6 +10,7 @@
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
 #include "net/quic/platform/api/quic_text_utils.h"
+#include "net/tools/quic/quic_client_cached_state_store.h"
 
 using base::StringToInt;
 using std::string;
@@ -28,6 +29,7 @@ QuicClientBase::QuicClientBase(const QuicServerId& server_id,
     : server_id_(server_id),
       initialized_(false),
       local_port_(0),
+      cached_state_store_(nullptr),
       config_(config),
       crypto_config_(std::move(proof_verifier)),
       helper_(helper),
@@ -67,6 +69,19 @@ bool QuicClientBase::Initialize() {
     return false;
   }
 
+  if (cached_state_store_ != nullptr) {
+    // Seed the in-memory cache from the persistent store so that the first
+    // handshake after a restart can attempt 0-RTT.
+    QuicCryptoClientConfig::CachedState* cached =
+        crypto_config_.LookupOrCreate(server_id_);
+    if (cached->IsEmpty() &&
+        cached_state_store_->RestoreCachedState(
+            server_id_, cached, helper_->GetClock()->WallNow())) {
+      QUIC_DLOG(INFO) << "Restored cached state for "
+                      << server_id_.ToString();
+    }
+  }
+
   initialized_ = true;
   return true;
 }
@@ -148,6 +163,13 @@ void QuicClientBase::Disconnect() {
 
   network_helper_->CleanUpAllUDPSockets();
 
+  if (cached_state_store_ != nullptr) {
+    // Persist whatever the handshake learned (server config, source-address
+    // token, certs) so the next process can resume without a full handshake.
+    cached_state_store_->StoreCachedState(
+        server_id_, *crypto_config_.LookupOrCreate(server_id_));
+  }
+
   initialized_ = false;
 }
 
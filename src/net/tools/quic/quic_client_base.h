@@ -22,6 +22,7 @@
 namespace net {
 
 class ProofVerifier;
+class QuicClientCachedStateStore;
 class QuicServerId;
 
 // QuicClientBase handles establishing a connection to the passed in
@@ -154,6 +155,15 @@ class QuicClientBase {
 
   QuicCryptoClientConfig* crypto_config() { return &crypto_config_; }
 
+  // Sets the persistent store used to carry handshake state for |server_id_|
+  // across process restarts. The store must outlive this client and should
+  // only be set before the initial Connect(). Initialize() restores any
+  // stored state for |server_id_| so the first handshake can attempt 0-RTT,
+  // and Disconnect() writes the freshest state back.
+  void set_cached_state_store(QuicClientCachedStateStore* store) {
+    cached_state_store_ = store;
+  }
+
   // Change the initial maximum packet size of the connection.  Has to be called
   // before Connect()/StartConnect() in order to have any effect.
   void set_initial_max_packet_length(QuicByteCount initial_max_packet_length) {
@@ -306,6 +316,10 @@ class QuicClientBase {
   // Local port to bind to. Initialize to 0.
   int local_port_;
 
+  // Persists crypto_config_ state for |server_id_| across restarts. Not
+  // owned, may be null.
+  QuicClientCachedStateStore* cached_state_store_;
+
   // config_ and crypto_config_ contain configuration and cached state about
   // servers.
   QuicConfig config_;
@@ -62,6 +62,7 @@
 #include "net/spdy/core/spdy_header_block.h"
 #include "net/tools/epoll_server/epoll_server.h"
 #include "net/tools/quic/quic_client.h"
+#include "net/tools/quic/quic_client_load_generator.h"
 #include "net/tools/quic/synchronous_host_resolver.h"
 
 using net::CertVerifier;
@@ -104,6 +105,14 @@ bool FLAGS_version_mismatch_ok = false;
 bool FLAGS_redirect_is_success = true;
 // Initial MTU of the connection.
 int32_t FLAGS_initial_mtu = 0;
+// If positive, run in load-generation mode: send GET requests for the
+// supplied URLs at this open-loop Poisson rate instead of a single batch,
+// and print a JSON latency summary.
+double FLAGS_load_qps = 0;
+// Number of concurrent connections used in load-generation mode.
+int32_t FLAGS_load_connections = 1;
+// Duration of the load-generation run, in seconds.
+int32_t FLAGS_load_duration = 10;
 
 class FakeProofVerifier : public ProofVerifier {
  public:
@@ -165,7 +174,13 @@ int main(int argc, char* argv[]) {
         "is considered to be a successful response, otherwise a failure\n"
         "--initial_mtu=<initial_mtu> specify the initial MTU of the connection"
         "\n"
-        "--disable-certificate-verification do not verify certificates\n";
+        "--disable-certificate-verification do not verify certificates\n"
+        "--load_qps=<rate>           run a load test: send GETs for the "
+        "given URLs at this open-loop Poisson rate and print a JSON latency "
+        "summary\n"
+        "--load_connections=<n>      number of connections used by the load "
+        "test (default 1)\n"
+        "--load_duration=<seconds>   duration of the load test (default 10)\n";
     cout << help_str;
     exit(0);
   }
@@ -210,6 +225,30 @@ int main(int argc, char* argv[]) {
       return 1;
     }
   }
+  if (line->HasSwitch("load_qps")) {
+    if (!base::StringToDouble(line->GetSwitchValueASCII("load_qps"),
+                              &FLAGS_load_qps) ||
+        FLAGS_load_qps <= 0) {
+      std::cerr << "--load_qps must be a positive number\n";
+      return 1;
+    }
+  }
+  if (line->HasSwitch("load_connections")) {
+    if (!base::StringToInt(line->GetSwitchValueASCII("load_connections"),
+                           &FLAGS_load_connections) ||
+        FLAGS_load_connections <= 0) {
+      std::cerr << "--load_connections must be a positive integer\n";
+      return 1;
+    }
+  }
+  if (line->HasSwitch("load_duration")) {
+    if (!base::StringToInt(line->GetSwitchValueASCII("load_duration"),
+                           &FLAGS_load_duration) ||
+        FLAGS_load_duration <= 0) {
+      std::cerr << "--load_duration must be a positive integer\n";
+      return 1;
+    }
+  }
 
   VLOG(1) << "server host: " << FLAGS_host << " port: " << FLAGS_port
           << " body: " << FLAGS_body << " headers: " << FLAGS_headers
@@ -265,14 +304,44 @@ int main(int argc, char* argv[]) {
   std::unique_ptr<MultiLogCTVerifier> ct_verifier(new MultiLogCTVerifier());
   ct_verifier->AddLogs(net::ct::CreateLogVerifiersForKnownLogs());
   std::unique_ptr<CTPolicyEnforcer> ct_policy_enforcer(new CTPolicyEnforcer());
-  std::unique_ptr<ProofVerifier> proof_verifier;
-  if (line->HasSwitch("disable-certificate-verification")) {
-    proof_verifier.reset(new FakeProofVerifier());
-  } else {
-    proof_verifier.reset(new ProofVerifierChromium(
+  const bool disable_cert_verification =
+      line->HasSwitch("disable-certificate-verification");
+  auto make_proof_verifier = [&]() -> std::unique_ptr<ProofVerifier> {
+    if (disable_cert_verification) {
+      return std::unique_ptr<ProofVerifier>(new FakeProofVerifier());
+    }
+    return std::unique_ptr<ProofVerifier>(new ProofVerifierChromium(
         cert_verifier.get(), ct_policy_enforcer.get(),
         transport_security_state.get(), ct_verifier.get()));
+  };
+
+  if (FLAGS_load_qps > 0) {
+    // Load-generation mode: the command-line URLs form the request mix (a
+    // URL may be repeated to weight it).
+    std::vector<string> url_mix(urls.begin(), urls.end());
+    std::vector<std::unique_ptr<net::QuicClient>> clients;
+    for (int i = 0; i < FLAGS_load_connections; ++i) {
+      clients.push_back(std::unique_ptr<net::QuicClient>(new net::QuicClient(
+          net::QuicSocketAddress(ip_addr, port), server_id, versions,
+          &epoll_server, make_proof_verifier())));
+      clients.back()->set_initial_max_packet_length(
+          FLAGS_initial_mtu != 0 ? FLAGS_initial_mtu
+                                 : net::kDefaultMaxPacketSize);
+    }
+    net::QuicClientLoadGenerator generator(
+        std::move(clients), std::move(url_mix), FLAGS_load_qps,
+        static_cast<int64_t>(FLAGS_load_duration) * 1000 * 1000,
+        &epoll_server);
+    if (!generator.Run()) {
+      cerr << "Failed to connect any load connections to " << host_port
+           << endl;
+      return 1;
+    }
+    cout << generator.ResultsAsJson() << endl;
+    return 0;
   }
+
+  std::unique_ptr<ProofVerifier> proof_verifier = make_proof_verifier();
   net::QuicClient client(net::QuicSocketAddress(ip_addr, port), server_id,
                          versions, &epoll_server, std::move(proof_verifier));
   client.set_initial_max_packet_length(
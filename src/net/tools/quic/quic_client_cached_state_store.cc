@@ -0,0 +1,222 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_client_cached_state_store.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/memory_mapped_file.h"
+#include "net/quic/core/quic_data_reader.h"
+#include "net/quic/core/quic_data_writer.h"
+#include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/quic/platform/api/quic_logging.h"
+
+using std::string;
+
+namespace net {
+
+namespace {
+
+// File magic, bumped whenever the record layout changes. Stores written by
+// an incompatible version fail to load and start empty.
+const uint32_t kStoreMagic = 0x51435331;  // "QCS1"
+
+// Every string in a record is length-prefixed with 16 bits.
+const size_t kMaxFieldSize = (1 << 16) - 1;
+
+}  // namespace
+
+QuicClientCachedStateStore::Record::Record() : expiration_seconds(0) {}
+
+QuicClientCachedStateStore::Record::Record(const Record& other) = default;
+
+QuicClientCachedStateStore::Record::~Record() {}
+
+QuicClientCachedStateStore::QuicClientCachedStateStore(
+    const base::FilePath& path)
+    : path_(path) {}
+
+QuicClientCachedStateStore::~QuicClientCachedStateStore() {}
+
+bool QuicClientCachedStateStore::Load(QuicWallTime now) {
+  records_.clear();
+  if (!base::PathExists(path_)) {
+    // First run; the store is created by the first StoreCachedState().
+    return true;
+  }
+  base::MemoryMappedFile mapped_file;
+  if (!mapped_file.Initialize(path_)) {
+    QUIC_LOG(WARNING) << "Failed to map cached state store "
+                      << path_.value();
+    return false;
+  }
+  if (!ParseRecords(reinterpret_cast<const char*>(mapped_file.data()),
+                    mapped_file.length(), now)) {
+    QUIC_LOG(WARNING) << "Malformed cached state store " << path_.value();
+    records_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool QuicClientCachedStateStore::RestoreCachedState(
+    const QuicServerId& server_id,
+    QuicCryptoClientConfig::CachedState* cached,
+    QuicWallTime now) const {
+  if (!cached->IsEmpty()) {
+    QUIC_BUG << "Restoring into a non-empty cached state.";
+    return false;
+  }
+  auto it = records_.find(server_id.ToString());
+  if (it == records_.end()) {
+    return false;
+  }
+  const Record& record = it->second;
+  return cached->Initialize(
+      record.server_config, record.source_address_token, record.certs,
+      record.cert_sct, record.chlo_hash, record.signature, now,
+      QuicWallTime::FromUNIXSeconds(record.expiration_seconds));
+}
+
+bool QuicClientCachedStateStore::StoreCachedState(
+    const QuicServerId& server_id,
+    const QuicCryptoClientConfig::CachedState& cached) {
+  const string key = server_id.ToString();
+  if (cached.IsEmpty()) {
+    records_.erase(key);
+    return base::ImportantFileWriter::WriteFileAtomically(path_,
+                                                          SerializeRecords());
+  }
+
+  Record record;
+  record.expiration_seconds = cached.expiration_time().ToUNIXSeconds();
+  record.server_config = cached.server_config();
+  record.source_address_token = cached.source_address_token();
+  record.cert_sct = cached.cert_sct();
+  record.chlo_hash = cached.chlo_hash();
+  record.signature = cached.signature();
+  record.certs = cached.certs();
+
+  if (key.size() > kMaxFieldSize ||
+      record.server_config.size() > kMaxFieldSize ||
+      record.source_address_token.size() > kMaxFieldSize ||
+      record.cert_sct.size() > kMaxFieldSize ||
+      record.chlo_hash.size() > kMaxFieldSize ||
+      record.signature.size() > kMaxFieldSize ||
+      record.certs.size() > kMaxFieldSize) {
+    QUIC_DLOG(WARNING) << "Cached state for " << key
+                       << " has a field too large to persist.";
+    return false;
+  }
+  for (const string& cert : record.certs) {
+    if (cert.size() > kMaxFieldSize) {
+      QUIC_DLOG(WARNING) << "Cached state for " << key
+                         << " has a cert too large to persist.";
+      return false;
+    }
+  }
+
+  records_[key] = record;
+  return base::ImportantFileWriter::WriteFileAtomically(path_,
+                                                        SerializeRecords());
+}
+
+string QuicClientCachedStateStore::SerializeRecords() const {
+  size_t size = sizeof(uint32_t) * 2;
+  for (const auto& entry : records_) {
+    const Record& record = entry.second;
+    size += sizeof(uint16_t) + entry.first.size();
+    size += sizeof(uint64_t);
+    size += sizeof(uint16_t) + record.server_config.size();
+    size += sizeof(uint16_t) + record.source_address_token.size();
+    size += sizeof(uint16_t) + record.cert_sct.size();
+    size += sizeof(uint16_t) + record.chlo_hash.size();
+    size += sizeof(uint16_t) + record.signature.size();
+    size += sizeof(uint16_t);
+    for (const string& cert : record.certs) {
+      size += sizeof(uint16_t) + cert.size();
+    }
+  }
+
+  std::unique_ptr<char[]> buffer(new char[size]);
+  QuicDataWriter writer(size, buffer.get(), Perspective::IS_CLIENT,
+                        NETWORK_BYTE_ORDER);
+  bool success = writer.WriteUInt32(kStoreMagic) &&
+                 writer.WriteUInt32(records_.size());
+  for (const auto& entry : records_) {
+    const Record& record = entry.second;
+    success = success && writer.WriteStringPiece16(entry.first) &&
+              writer.WriteUInt64(record.expiration_seconds) &&
+              writer.WriteStringPiece16(record.server_config) &&
+              writer.WriteStringPiece16(record.source_address_token) &&
+              writer.WriteStringPiece16(record.cert_sct) &&
+              writer.WriteStringPiece16(record.chlo_hash) &&
+              writer.WriteStringPiece16(record.signature) &&
+              writer.WriteUInt16(record.certs.size());
+    for (const string& cert : record.certs) {
+      success = success && writer.WriteStringPiece16(cert);
+    }
+  }
+  DCHECK(success);
+  DCHECK_EQ(size, writer.length());
+  return string(writer.data(), writer.length());
+}
+
+bool QuicClientCachedStateStore::ParseRecords(const char* data,
+                                              size_t len,
+                                              QuicWallTime now) {
+  QuicDataReader reader(data, len, Perspective::IS_CLIENT, NETWORK_BYTE_ORDER);
+  uint32_t magic;
+  uint32_t num_records;
+  if (!reader.ReadUInt32(&magic) || magic != kStoreMagic ||
+      !reader.ReadUInt32(&num_records)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < num_records; ++i) {
+    QuicStringPiece key;
+    QuicStringPiece server_config;
+    QuicStringPiece source_address_token;
+    QuicStringPiece cert_sct;
+    QuicStringPiece chlo_hash;
+    QuicStringPiece signature;
+    Record record;
+    uint16_t num_certs;
+    if (!reader.ReadStringPiece16(&key) ||
+        !reader.ReadUInt64(&record.expiration_seconds) ||
+        !reader.ReadStringPiece16(&server_config) ||
+        !reader.ReadStringPiece16(&source_address_token) ||
+        !reader.ReadStringPiece16(&cert_sct) ||
+        !reader.ReadStringPiece16(&chlo_hash) ||
+        !reader.ReadStringPiece16(&signature) ||
+        !reader.ReadUInt16(&num_certs)) {
+      return false;
+    }
+    record.server_config = server_config.as_string();
+    record.source_address_token = source_address_token.as_string();
+    record.cert_sct = cert_sct.as_string();
+    record.chlo_hash = chlo_hash.as_string();
+    record.signature = signature.as_string();
+    record.certs.reserve(num_certs);
+    for (uint16_t j = 0; j < num_certs; ++j) {
+      QuicStringPiece cert;
+      if (!reader.ReadStringPiece16(&cert)) {
+        return false;
+      }
+      record.certs.push_back(cert.as_string());
+    }
+    if (now.IsAfter(
+            QuicWallTime::FromUNIXSeconds(record.expiration_seconds))) {
+      // Expired entries cannot produce a 0-RTT handshake; drop them so the
+      // next rewrite compacts the file.
+      continue;
+    }
+    records_[key.as_string()] = record;
+  }
+  return reader.IsDoneReading();
+}
+
+}  // namespace net
@@ -0,0 +1,85 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_CLIENT_CACHED_STATE_STORE_H_
+#define NET_TOOLS_QUIC_QUIC_CLIENT_CACHED_STATE_STORE_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "net/quic/core/crypto/quic_crypto_client_config.h"
+#include "net/quic/core/quic_server_id.h"
+#include "net/quic/core/quic_time.h"
+
+namespace net {
+
+// Persists client handshake state (server config, source-address token and
+// cert hints) across process restarts so that a freshly started client can
+// attempt 0-RTT immediately instead of paying a full handshake per server.
+// Records are kept in a single file of compact binary entries keyed by
+// server ID; Load() maps the file read-only and indexes it, and every
+// StoreCachedState() rewrites the file atomically. The store trusts its own
+// file contents only as far as their framing: restored proofs are not marked
+// valid, so certificate verification still runs before the state is used.
+class QuicClientCachedStateStore {
+ public:
+  explicit QuicClientCachedStateStore(const base::FilePath& path);
+  ~QuicClientCachedStateStore();
+
+  // Maps the store file and indexes its records, dropping any that are
+  // expired at |now|. A missing file yields an empty store and returns
+  // true; a file that cannot be mapped or parsed returns false.
+  bool Load(QuicWallTime now);
+
+  // Copies the stored record for |server_id|, if any, into |cached|, which
+  // must be empty. Returns true if state was restored.
+  bool RestoreCachedState(const QuicServerId& server_id,
+                          QuicCryptoClientConfig::CachedState* cached,
+                          QuicWallTime now) const;
+
+  // Records the handshake state of |cached| under |server_id| and rewrites
+  // the store file. An empty |cached| removes any existing record. Returns
+  // false if the state cannot be encoded or the file cannot be written.
+  bool StoreCachedState(const QuicServerId& server_id,
+                        const QuicCryptoClientConfig::CachedState& cached);
+
+  // Number of records currently held.
+  size_t num_records() const { return records_.size(); }
+
+ private:
+  // One decoded store entry; strings own their bytes so the mapping can be
+  // dropped once Load() returns.
+  struct Record {
+    Record();
+    Record(const Record& other);
+    ~Record();
+
+    uint64_t expiration_seconds;
+    std::string server_config;
+    std::string source_address_token;
+    std::string cert_sct;
+    std::string chlo_hash;
+    std::string signature;
+    std::vector<std::string> certs;
+  };
+
+  // Encodes all records into the on-disk format.
+  std::string SerializeRecords() const;
+
+  // Decodes |data| into |records_|. Returns false and leaves |records_|
+  // empty on any framing error.
+  bool ParseRecords(const char* data, size_t len, QuicWallTime now);
+
+  const base::FilePath path_;
+  std::map<std::string, Record> records_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicClientCachedStateStore);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_CLIENT_CACHED_STATE_STORE_H_
@@ -0,0 +1,146 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_client_cached_state_store.h"
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "net/quic/core/crypto/crypto_handshake_message.h"
+#include "net/quic/core/crypto/crypto_protocol.h"
+#include "net/quic/platform/api/quic_test.h"
+
+using std::string;
+
+namespace net {
+namespace test {
+namespace {
+
+const uint64_t kNowSeconds = 1000;
+const uint64_t kExpirySeconds = 2000;
+
+string MakeServerConfig() {
+  CryptoHandshakeMessage scfg;
+  scfg.set_tag(kSCFG);
+  scfg.SetStringPiece(kSCID, "12345678");
+  return scfg.GetSerialized(Perspective::IS_CLIENT).AsStringPiece().as_string();
+}
+
+class QuicClientCachedStateStoreTest : public QuicTest {
+ protected:
+  QuicClientCachedStateStoreTest()
+      : server_id_("www.example.org", 443, PRIVACY_MODE_DISABLED),
+        now_(QuicWallTime::FromUNIXSeconds(kNowSeconds)) {
+    CHECK(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("cached_state_store");
+  }
+
+  // Fills |cached| with a complete, unexpired state.
+  void InitializeCachedState(QuicCryptoClientConfig::CachedState* cached) {
+    std::vector<string> certs;
+    certs.push_back("leaf cert");
+    certs.push_back("intermediate cert");
+    ASSERT_TRUE(cached->Initialize(
+        MakeServerConfig(), "source address token", certs, "cert sct",
+        "chlo hash", "signature", now_,
+        QuicWallTime::FromUNIXSeconds(kExpirySeconds)));
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+  QuicServerId server_id_;
+  QuicWallTime now_;
+};
+
+TEST_F(QuicClientCachedStateStoreTest, MissingFileLoadsEmpty) {
+  QuicClientCachedStateStore store(path_);
+  EXPECT_TRUE(store.Load(now_));
+  EXPECT_EQ(0u, store.num_records());
+}
+
+TEST_F(QuicClientCachedStateStoreTest, RoundTrip) {
+  QuicCryptoClientConfig::CachedState cached;
+  InitializeCachedState(&cached);
+  {
+    QuicClientCachedStateStore store(path_);
+    ASSERT_TRUE(store.Load(now_));
+    ASSERT_TRUE(store.StoreCachedState(server_id_, cached));
+  }
+
+  // A second store simulates a fresh process reading the same file.
+  QuicClientCachedStateStore store(path_);
+  ASSERT_TRUE(store.Load(now_));
+  EXPECT_EQ(1u, store.num_records());
+
+  QuicCryptoClientConfig::CachedState restored;
+  ASSERT_TRUE(store.RestoreCachedState(server_id_, &restored, now_));
+  EXPECT_EQ(cached.server_config(), restored.server_config());
+  EXPECT_EQ(cached.source_address_token(), restored.source_address_token());
+  EXPECT_EQ(cached.certs(), restored.certs());
+  EXPECT_EQ(cached.cert_sct(), restored.cert_sct());
+  EXPECT_EQ(cached.chlo_hash(), restored.chlo_hash());
+  EXPECT_EQ(cached.signature(), restored.signature());
+  EXPECT_EQ(kExpirySeconds,
+            static_cast<uint64_t>(restored.expiration_time().ToUNIXSeconds()));
+  // Proofs are never restored as pre-validated.
+  EXPECT_FALSE(restored.proof_valid());
+}
+
+TEST_F(QuicClientCachedStateStoreTest, UnknownServerIdDoesNotRestore) {
+  QuicCryptoClientConfig::CachedState cached;
+  InitializeCachedState(&cached);
+  QuicClientCachedStateStore store(path_);
+  ASSERT_TRUE(store.Load(now_));
+  ASSERT_TRUE(store.StoreCachedState(server_id_, cached));
+
+  QuicCryptoClientConfig::CachedState restored;
+  EXPECT_FALSE(store.RestoreCachedState(
+      QuicServerId("other.example.org", 443, PRIVACY_MODE_DISABLED), &restored,
+      now_));
+}
+
+TEST_F(QuicClientCachedStateStoreTest, ExpiredRecordsDroppedAtLoad) {
+  QuicCryptoClientConfig::CachedState cached;
+  InitializeCachedState(&cached);
+  {
+    QuicClientCachedStateStore store(path_);
+    ASSERT_TRUE(store.Load(now_));
+    ASSERT_TRUE(store.StoreCachedState(server_id_, cached));
+  }
+
+  QuicClientCachedStateStore store(path_);
+  ASSERT_TRUE(
+      store.Load(QuicWallTime::FromUNIXSeconds(kExpirySeconds + 1)));
+  EXPECT_EQ(0u, store.num_records());
+}
+
+TEST_F(QuicClientCachedStateStoreTest, EmptyStateRemovesRecord) {
+  QuicCryptoClientConfig::CachedState cached;
+  InitializeCachedState(&cached);
+  QuicClientCachedStateStore store(path_);
+  ASSERT_TRUE(store.Load(now_));
+  ASSERT_TRUE(store.StoreCachedState(server_id_, cached));
+  EXPECT_EQ(1u, store.num_records());
+
+  QuicCryptoClientConfig::CachedState empty;
+  ASSERT_TRUE(store.StoreCachedState(server_id_, empty));
+  EXPECT_EQ(0u, store.num_records());
+
+  QuicClientCachedStateStore reloaded(path_);
+  ASSERT_TRUE(reloaded.Load(now_));
+  EXPECT_EQ(0u, reloaded.num_records());
+}
+
+TEST_F(QuicClientCachedStateStoreTest, MalformedFileRejected) {
+  ASSERT_EQ(7, base::WriteFile(path_, "garbage", 7));
+  QuicClientCachedStateStore store(path_);
+  EXPECT_FALSE(store.Load(now_));
+  EXPECT_EQ(0u, store.num_records());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
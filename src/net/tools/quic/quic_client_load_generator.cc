@@ -0,0 +1,285 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_client_load_generator.h"
+
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "net/quic/core/spdy_utils.h"
+#include "net/quic/platform/api/quic_logging.h"
+#include "net/quic/platform/api/quic_ptr_util.h"
+#include "net/quic/platform/api/quic_str_cat.h"
+#include "net/tools/quic/quic_spdy_client_stream.h"
+
+using std::string;
+
+namespace net {
+namespace {
+
+// How long to keep the event loop running after the arrival process stops,
+// waiting for in-flight responses.
+const int64_t kDrainTimeoutUs = 5 * 1000 * 1000;
+
+// Epoll wait granularity. Arrival alarms bound the effective timeout anyway;
+// this only caps how long the drain phase sleeps between checks.
+const int64_t kEpollTimeoutUs = 10 * 1000;
+
+}  // namespace
+
+QuicLatencyHistogram::QuicLatencyHistogram()
+    : num_samples_(0), sum_(0), min_(0), max_(0) {
+  memset(buckets_, 0, sizeof(buckets_));
+}
+
+// static
+size_t QuicLatencyHistogram::BucketFor(uint64_t value_us) {
+  if (value_us < kNumExactBuckets) {
+    return static_cast<size_t>(value_us);
+  }
+  size_t log = 0;
+  for (uint64_t v = value_us; v > 1; v >>= 1) {
+    ++log;
+  }
+  const size_t sub = (value_us >> (log - kSubBucketBits)) &
+                     (kNumExactBuckets - 1);
+  return (log - kSubBucketBits + 1) * kNumExactBuckets + sub;
+}
+
+// static
+uint64_t QuicLatencyHistogram::BucketUpperBound(size_t bucket) {
+  if (bucket < kNumExactBuckets) {
+    return bucket;
+  }
+  const size_t log = bucket / kNumExactBuckets + kSubBucketBits - 1;
+  const uint64_t sub = bucket % kNumExactBuckets;
+  const size_t shift = log - kSubBucketBits;
+  return (((kNumExactBuckets + sub) << shift)) + ((UINT64_C(1) << shift) - 1);
+}
+
+void QuicLatencyHistogram::Record(uint64_t value_us) {
+  ++buckets_[BucketFor(value_us)];
+  if (num_samples_ == 0 || value_us < min_) {
+    min_ = value_us;
+  }
+  if (value_us > max_) {
+    max_ = value_us;
+  }
+  sum_ += value_us;
+  ++num_samples_;
+}
+
+uint64_t QuicLatencyHistogram::ValueAtQuantile(double fraction) const {
+  if (num_samples_ == 0) {
+    return 0;
+  }
+  // Index (1-based) of the sample at the requested quantile.
+  uint64_t rank = static_cast<uint64_t>(fraction * num_samples_);
+  if (rank < 1) {
+    rank = 1;
+  }
+  if (rank > num_samples_) {
+    rank = num_samples_;
+  }
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return BucketUpperBound(i);
+    }
+  }
+  return max_;
+}
+
+uint64_t QuicLatencyHistogram::Mean() const {
+  return num_samples_ == 0 ? 0 : sum_ / num_samples_;
+}
+
+int64_t QuicClientLoadGenerator::ArrivalAlarm::OnAlarm() {
+  EpollAlarm::OnAlarm();
+  if (generator_->epoll_server_->ApproximateNowInUsec() >=
+      generator_->end_time_us_) {
+    // The run is over; stop generating arrivals.
+    return 0;
+  }
+  generator_->SendOneRequest();
+  return generator_->epoll_server_->ApproximateNowInUsec() +
+         generator_->NextArrivalDeltaUs();
+}
+
+void QuicClientLoadGenerator::PerClientResponseListener::OnCompleteResponse(
+    QuicStreamId id,
+    const SpdyHeaderBlock& response_headers,
+    const string& response_body) {
+  generator_->OnResponse(client_index_, id, response_headers);
+}
+
+QuicClientLoadGenerator::QuicClientLoadGenerator(
+    std::vector<std::unique_ptr<QuicClient>> clients,
+    std::vector<string> urls,
+    double requests_per_second,
+    int64_t duration_us,
+    EpollServer* epoll_server)
+    : clients_(std::move(clients)),
+      pending_(clients_.size()),
+      urls_(std::move(urls)),
+      requests_per_second_(requests_per_second),
+      duration_us_(duration_us),
+      epoll_server_(epoll_server),
+      random_(QuicRandom::GetInstance()),
+      arrival_alarm_(this),
+      end_time_us_(0),
+      next_client_(0),
+      requests_sent_(0),
+      responses_received_(0),
+      errors_(0),
+      actual_duration_us_(0) {
+  DCHECK(!clients_.empty());
+  DCHECK(!urls_.empty());
+  DCHECK_LT(0, requests_per_second_);
+  for (size_t i = 0; i < clients_.size(); ++i) {
+    clients_[i]->set_response_listener(
+        QuicMakeUnique<PerClientResponseListener>(this, i));
+  }
+}
+
+QuicClientLoadGenerator::~QuicClientLoadGenerator() {}
+
+bool QuicClientLoadGenerator::Run() {
+  size_t num_connected = 0;
+  for (const auto& client : clients_) {
+    if (!client->Initialize()) {
+      QUIC_LOG(ERROR) << "Failed to initialize load connection";
+      continue;
+    }
+    if (!client->Connect()) {
+      QUIC_LOG(ERROR) << "Failed to connect load connection: "
+                      << QuicErrorCodeToString(client->session()->error());
+      continue;
+    }
+    ++num_connected;
+  }
+  if (num_connected == 0) {
+    return false;
+  }
+  QUIC_LOG(INFO) << "Load run starting: " << num_connected << "/"
+                 << clients_.size() << " connections, "
+                 << requests_per_second_ << " req/s for " << duration_us_
+                 << "us";
+
+  const int64_t start_time_us = epoll_server_->NowInUsec();
+  end_time_us_ = start_time_us + duration_us_;
+  epoll_server_->set_timeout_in_us(kEpollTimeoutUs);
+  epoll_server_->RegisterAlarmApproximateDelta(NextArrivalDeltaUs(),
+                                               &arrival_alarm_);
+
+  while (epoll_server_->NowInUsec() < end_time_us_) {
+    epoll_server_->WaitForEventsAndExecuteCallbacks();
+  }
+  // The arrival process has stopped; drain in-flight requests.
+  const int64_t drain_deadline_us = epoll_server_->NowInUsec() + kDrainTimeoutUs;
+  while (TotalPending() > 0 &&
+         epoll_server_->NowInUsec() < drain_deadline_us) {
+    epoll_server_->WaitForEventsAndExecuteCallbacks();
+  }
+  actual_duration_us_ = epoll_server_->NowInUsec() - start_time_us;
+
+  // Requests never answered (connection loss, drain timeout) are errors.
+  errors_ += TotalPending();
+  return true;
+}
+
+void QuicClientLoadGenerator::SendOneRequest() {
+  // Round-robin over connections, skipping ones that have gone away.
+  QuicClient* client = nullptr;
+  size_t client_index = 0;
+  for (size_t i = 0; i < clients_.size(); ++i) {
+    client_index = next_client_;
+    next_client_ = (next_client_ + 1) % clients_.size();
+    if (clients_[client_index]->connected()) {
+      client = clients_[client_index].get();
+      break;
+    }
+  }
+  ++requests_sent_;
+  if (client == nullptr) {
+    // Open-loop: an arrival with no connection to carry it is a failure,
+    // not a reason to pause the arrival process.
+    ++errors_;
+    return;
+  }
+
+  const string& url = urls_[random_->RandUint64() % urls_.size()];
+  SpdyHeaderBlock headers;
+  if (!SpdyUtils::PopulateHeaderBlockFromUrl(url, &headers)) {
+    QUIC_BUG << "Unable to build request for url " << url;
+    ++errors_;
+    return;
+  }
+  QuicSpdyClientStream* stream = client->CreateClientStream();
+  if (stream == nullptr) {
+    // Stream limit reached; the server is holding too many requests open.
+    ++errors_;
+    return;
+  }
+  pending_[client_index][stream->id()] =
+      epoll_server_->ApproximateNowInUsec();
+  stream->SendRequest(std::move(headers), "", /*fin=*/true);
+}
+
+void QuicClientLoadGenerator::OnResponse(
+    size_t client_index,
+    QuicStreamId id,
+    const SpdyHeaderBlock& response_headers) {
+  auto it = pending_[client_index].find(id);
+  if (it == pending_[client_index].end()) {
+    // A stream the generator did not open (e.g. server push); ignore.
+    return;
+  }
+  const int64_t latency_us =
+      epoll_server_->ApproximateNowInUsec() - it->second;
+  pending_[client_index].erase(it);
+  if (response_headers.find(":status") == response_headers.end()) {
+    // Stream closed without a response, e.g. reset by the server.
+    ++errors_;
+    return;
+  }
+  ++responses_received_;
+  histogram_.Record(latency_us < 0 ? 0 : static_cast<uint64_t>(latency_us));
+}
+
+int64_t QuicClientLoadGenerator::NextArrivalDeltaUs() {
+  // Inverse-CDF sample of the exponential inter-arrival distribution with
+  // rate |requests_per_second_|, yielding a Poisson arrival process.
+  const double u =
+      (random_->RandUint64() >> 11) * (1.0 / (UINT64_C(1) << 53));
+  const double interval_seconds = -std::log(1.0 - u) / requests_per_second_;
+  return static_cast<int64_t>(interval_seconds * 1e6) + 1;
+}
+
+size_t QuicClientLoadGenerator::TotalPending() const {
+  size_t total = 0;
+  for (const auto& per_client : pending_) {
+    total += per_client.size();
+  }
+  return total;
+}
+
+string QuicClientLoadGenerator::ResultsAsJson() const {
+  return QuicStrCat(
+      "{\"requests_sent\":", requests_sent_,
+      ",\"responses_received\":", responses_received_,
+      ",\"errors\":", errors_, ",\"duration_us\":", actual_duration_us_,
+      ",\"latency_us\":{\"min\":", histogram_.min(),
+      ",\"mean\":", histogram_.Mean(),
+      ",\"p50\":", histogram_.ValueAtQuantile(0.50),
+      ",\"p90\":", histogram_.ValueAtQuantile(0.90),
+      ",\"p95\":", histogram_.ValueAtQuantile(0.95),
+      ",\"p99\":", histogram_.ValueAtQuantile(0.99),
+      ",\"p999\":", histogram_.ValueAtQuantile(0.999),
+      ",\"max\":", histogram_.max(), "}}");
+}
+
+}  // namespace net
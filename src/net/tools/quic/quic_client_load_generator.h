@@ -0,0 +1,181 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A load generator for the toy QUIC client: sends GET requests to a server
+// on an open-loop Poisson arrival process across a set of connections, and
+// records per-request latencies into a histogram for capacity planning.
+
+#ifndef NET_TOOLS_QUIC_QUIC_CLIENT_LOAD_GENERATOR_H_
+#define NET_TOOLS_QUIC_QUIC_CLIENT_LOAD_GENERATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/macros.h"
+#include "net/quic/core/crypto/quic_random.h"
+#include "net/tools/epoll_server/epoll_server.h"
+#include "net/tools/quic/quic_client.h"
+
+namespace net {
+
+namespace test {
+class QuicClientLoadGeneratorPeer;
+}  // namespace test
+
+// A latency histogram with HDR-style bucketing: values below 32us are
+// recorded exactly, larger values into one of 32 sub-buckets per power of
+// two, bounding the relative quantization error to 1/32 (~3%). This keeps
+// memory constant regardless of sample count, so high percentiles remain
+// meaningful over arbitrarily long runs.
+class QuicLatencyHistogram {
+ public:
+  QuicLatencyHistogram();
+
+  // Records a single latency measurement, in microseconds.
+  void Record(uint64_t value_us);
+
+  // Returns the upper bound of the bucket holding the value at quantile
+  // |fraction| in [0, 1], e.g. 0.99 for p99. Returns 0 before any sample
+  // has been recorded.
+  uint64_t ValueAtQuantile(double fraction) const;
+
+  uint64_t num_samples() const { return num_samples_; }
+  // Minimum, maximum and mean are tracked exactly, not bucketed.
+  uint64_t min() const { return num_samples_ == 0 ? 0 : min_; }
+  uint64_t max() const { return max_; }
+  uint64_t Mean() const;
+
+ private:
+  friend class test::QuicClientLoadGeneratorPeer;
+
+  // 32 sub-buckets per power of two.
+  static const size_t kSubBucketBits = 5;
+  static const size_t kNumExactBuckets = 1 << kSubBucketBits;
+  static const size_t kNumBuckets =
+      (64 - kSubBucketBits + 1) * kNumExactBuckets;
+
+  // Returns the bucket index holding |value_us|. Monotone in |value_us|.
+  static size_t BucketFor(uint64_t value_us);
+
+  // Returns the largest value mapping to |bucket|, the inverse of
+  // BucketFor() up to quantization.
+  static uint64_t BucketUpperBound(size_t bucket);
+
+  uint64_t buckets_[kNumBuckets];
+  uint64_t num_samples_;
+  uint64_t sum_;
+  uint64_t min_;
+  uint64_t max_;
+};
+
+// Drives an open-loop load test: request arrivals are drawn from a Poisson
+// process at a fixed rate, independent of response completion, so the
+// generator keeps offering load when the server slows down instead of
+// backing off the way a closed-loop harness would. Requests are spread
+// round-robin across the supplied connections and drawn uniformly from the
+// supplied URL mix; a URL may be listed multiple times to weight it.
+class QuicClientLoadGenerator {
+ public:
+  // |clients| must all target the same server and be uninitialized;
+  // Run() connects them. |duration_us| is how long new arrivals are
+  // generated; in-flight requests are drained afterwards.
+  QuicClientLoadGenerator(std::vector<std::unique_ptr<QuicClient>> clients,
+                          std::vector<std::string> urls,
+                          double requests_per_second,
+                          int64_t duration_us,
+                          EpollServer* epoll_server);
+  ~QuicClientLoadGenerator();
+
+  // Connects all clients, generates load for the configured duration and
+  // waits for in-flight requests to drain. Returns false if no client could
+  // connect. Blocks until the run completes.
+  bool Run();
+
+  // Results of the run, valid after Run() returns.
+  uint64_t requests_sent() const { return requests_sent_; }
+  uint64_t responses_received() const { return responses_received_; }
+  uint64_t errors() const { return errors_; }
+  const QuicLatencyHistogram& latency_histogram() const { return histogram_; }
+
+  // Returns the run's results as a single-line JSON object, with latencies
+  // in microseconds.
+  std::string ResultsAsJson() const;
+
+ private:
+  friend class test::QuicClientLoadGeneratorPeer;
+
+  // Epoll alarm driving the arrival process; fires once per request and
+  // reschedules itself at the next sampled arrival time.
+  class ArrivalAlarm : public EpollAlarm {
+   public:
+    explicit ArrivalAlarm(QuicClientLoadGenerator* generator)
+        : generator_(generator) {}
+
+    int64_t OnAlarm() override;
+
+   private:
+    QuicClientLoadGenerator* generator_;
+  };
+
+  // Observes completed responses on one client connection.
+  class PerClientResponseListener : public QuicSpdyClientBase::ResponseListener {
+   public:
+    PerClientResponseListener(QuicClientLoadGenerator* generator,
+                              size_t client_index)
+        : generator_(generator), client_index_(client_index) {}
+
+    void OnCompleteResponse(QuicStreamId id,
+                            const SpdyHeaderBlock& response_headers,
+                            const std::string& response_body) override;
+
+   private:
+    QuicClientLoadGenerator* generator_;
+    size_t client_index_;
+  };
+
+  // Sends one request on the next connection in round-robin order.
+  void SendOneRequest();
+
+  // Called when the stream carrying request |id| on client |client_index|
+  // closes.
+  void OnResponse(size_t client_index, QuicStreamId id,
+                  const SpdyHeaderBlock& response_headers);
+
+  // Samples the delta to the next Poisson arrival, in microseconds.
+  int64_t NextArrivalDeltaUs();
+
+  // Number of requests sent but not yet answered, across all clients.
+  size_t TotalPending() const;
+
+  std::vector<std::unique_ptr<QuicClient>> clients_;
+  // Send times of in-flight requests, per client, keyed by stream id.
+  std::vector<std::unordered_map<QuicStreamId, int64_t>> pending_;
+  std::vector<std::string> urls_;
+  const double requests_per_second_;
+  const int64_t duration_us_;
+  EpollServer* epoll_server_;
+  QuicRandom* random_;
+
+  ArrivalAlarm arrival_alarm_;
+  // Absolute time after which no new arrivals are generated.
+  int64_t end_time_us_;
+  // Index of the client carrying the next request.
+  size_t next_client_;
+
+  uint64_t requests_sent_;
+  uint64_t responses_received_;
+  uint64_t errors_;
+  int64_t actual_duration_us_;
+  QuicLatencyHistogram histogram_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicClientLoadGenerator);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_CLIENT_LOAD_GENERATOR_H_
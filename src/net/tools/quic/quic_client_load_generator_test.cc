@@ -0,0 +1,73 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_client_load_generator.h"
+
+#include "net/quic/platform/api/quic_test.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicLatencyHistogramTest : public QuicTest {};
+
+TEST_F(QuicLatencyHistogramTest, Empty) {
+  QuicLatencyHistogram histogram;
+  EXPECT_EQ(0u, histogram.num_samples());
+  EXPECT_EQ(0u, histogram.min());
+  EXPECT_EQ(0u, histogram.max());
+  EXPECT_EQ(0u, histogram.Mean());
+  EXPECT_EQ(0u, histogram.ValueAtQuantile(0.99));
+}
+
+TEST_F(QuicLatencyHistogramTest, SmallValuesAreExact) {
+  QuicLatencyHistogram histogram;
+  // Values below 32us fall into per-microsecond buckets.
+  for (uint64_t value = 0; value < 32; ++value) {
+    histogram.Record(value);
+  }
+  EXPECT_EQ(32u, histogram.num_samples());
+  EXPECT_EQ(0u, histogram.min());
+  EXPECT_EQ(31u, histogram.max());
+  EXPECT_EQ(15u, histogram.Mean());
+  EXPECT_EQ(15u, histogram.ValueAtQuantile(0.5));
+  EXPECT_EQ(31u, histogram.ValueAtQuantile(1.0));
+}
+
+TEST_F(QuicLatencyHistogramTest, QuantilesHaveBoundedRelativeError) {
+  QuicLatencyHistogram histogram;
+  // One sample per millisecond of a 10 second run.
+  for (uint64_t i = 1; i <= 10000; ++i) {
+    histogram.Record(i * 1000);
+  }
+  EXPECT_EQ(10000u, histogram.num_samples());
+  EXPECT_EQ(1000u, histogram.min());
+  EXPECT_EQ(10000000u, histogram.max());
+  // Bucketing may round a quantile up by at most 1/32 (~3%).
+  const double kMaxError = 1.0 / 32;
+  EXPECT_GE(histogram.ValueAtQuantile(0.5), 5000000u * (1 - kMaxError));
+  EXPECT_LE(histogram.ValueAtQuantile(0.5), 5000000u * (1 + kMaxError));
+  EXPECT_GE(histogram.ValueAtQuantile(0.99), 9900000u * (1 - kMaxError));
+  EXPECT_LE(histogram.ValueAtQuantile(0.99), 9900000u * (1 + kMaxError));
+}
+
+TEST_F(QuicLatencyHistogramTest, QuantilesAreMonotone) {
+  QuicLatencyHistogram histogram;
+  histogram.Record(10);
+  histogram.Record(100);
+  histogram.Record(1000);
+  histogram.Record(10000);
+  uint64_t last = 0;
+  for (double q = 0.1; q <= 1.0; q += 0.1) {
+    const uint64_t value = histogram.ValueAtQuantile(q);
+    EXPECT_GE(value, last);
+    last = value;
+  }
+  EXPECT_EQ(10u, histogram.ValueAtQuantile(0.1));
+  EXPECT_GE(histogram.ValueAtQuantile(1.0), 10000u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
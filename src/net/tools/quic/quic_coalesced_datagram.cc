@@ -0,0 +1,39 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_coalesced_datagram.h"
+
+namespace net {
+
+bool IsCoalescedDatagram(const char* data, size_t length) {
+  return length >= kCoalescedDatagramHeaderSize &&
+         static_cast<uint8_t>(data[0]) == kCoalescedDatagramMarker;
+}
+
+bool SplitCoalescedDatagram(const char* data,
+                            size_t length,
+                            std::vector<QuicStringPiece>* packets) {
+  packets->clear();
+  if (!IsCoalescedDatagram(data, length)) {
+    return false;
+  }
+  size_t offset = kCoalescedDatagramHeaderSize;
+  while (offset < length) {
+    if (length - offset < kCoalescedPacketPrefixSize) {
+      return false;  // Truncated length prefix.
+    }
+    const size_t packet_length =
+        (static_cast<uint8_t>(data[offset]) << 8) |
+        static_cast<uint8_t>(data[offset + 1]);
+    offset += kCoalescedPacketPrefixSize;
+    if (packet_length == 0 || packet_length > length - offset) {
+      return false;  // Empty or truncated packet.
+    }
+    packets->push_back(QuicStringPiece(data + offset, packet_length));
+    offset += packet_length;
+  }
+  return !packets->empty();
+}
+
+}  // namespace net
@@ -0,0 +1,47 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_COALESCED_DATAGRAM_H_
+#define NET_TOOLS_QUIC_QUIC_COALESCED_DATAGRAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "net/quic/platform/api/quic_string_piece.h"
+
+namespace net {
+
+// Wire framing that lets one UDP datagram carry several QUIC packets on
+// jumbo-MTU links where both endpoints run this stack:
+//
+//   [marker:1][length:2][packet]([length:2][packet])*
+//
+// with lengths in network byte order. The marker byte has the two high bits
+// set, which QuicFramer rejects as illegal public flags, so a coalesced
+// datagram can never be confused with a regular QUIC packet and peers
+// without coalescing support simply drop it as malformed. Single packets
+// are always sent bare, so coalescing is only ever attempted against peers
+// which have demonstrated support (i.e. our own endpoints).
+const uint8_t kCoalescedDatagramMarker = 0xC0;
+
+// Bytes of framing per datagram and per carried packet.
+const size_t kCoalescedDatagramHeaderSize = 1;
+const size_t kCoalescedPacketPrefixSize = 2;
+
+// Returns true if |data| starts with the coalesced datagram marker.
+bool IsCoalescedDatagram(const char* data, size_t length);
+
+// Splits a coalesced datagram into the packets it carries. The returned
+// pieces point into |data|. Returns false (leaving |packets| in an
+// unspecified state) if the datagram is not well formed: missing marker,
+// truncated record, zero-length packet, or trailing bytes.
+bool SplitCoalescedDatagram(const char* data,
+                            size_t length,
+                            std::vector<QuicStringPiece>* packets);
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_COALESCED_DATAGRAM_H_
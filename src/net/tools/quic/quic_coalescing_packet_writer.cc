@@ -0,0 +1,129 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_coalescing_packet_writer.h"
+
+#include <string.h>
+
+#include <limits>
+
+#include "net/quic/platform/api/quic_logging.h"
+#include "net/tools/quic/quic_coalesced_datagram.h"
+
+namespace net {
+
+QuicCoalescingPacketWriter::QuicCoalescingPacketWriter(
+    QuicByteCount max_datagram_size)
+    : max_datagram_size_(max_datagram_size),
+      buffer_(new char[max_datagram_size]),
+      buffered_length_(0),
+      buffered_packets_(0) {
+  DCHECK_GT(max_datagram_size_,
+            kCoalescedDatagramHeaderSize + kCoalescedPacketPrefixSize);
+}
+
+QuicCoalescingPacketWriter::~QuicCoalescingPacketWriter() {}
+
+WriteResult QuicCoalescingPacketWriter::WritePacket(
+    const char* buffer,
+    size_t buf_len,
+    const QuicIpAddress& self_address,
+    const QuicSocketAddress& peer_address,
+    PerPacketOptions* options) {
+  // Per-packet options (e.g. release time) and packets too large to frame
+  // bypass coalescing entirely.
+  const bool can_coalesce =
+      options == nullptr && buf_len <= std::numeric_limits<uint16_t>::max() &&
+      kCoalescedDatagramHeaderSize + kCoalescedPacketPrefixSize + buf_len <=
+          max_datagram_size_;
+
+  if (buffered_packets_ > 0 &&
+      (!can_coalesce || peer_address != buffered_peer_address_ ||
+       !(self_address == buffered_self_address_) || !Fits(buf_len))) {
+    WriteResult result = Flush();
+    if (result.status != WRITE_STATUS_OK) {
+      return result;
+    }
+  }
+
+  if (!can_coalesce) {
+    return QuicPacketWriterWrapper::WritePacket(buffer, buf_len, self_address,
+                                                peer_address, options);
+  }
+
+  Buffer(buffer, buf_len, self_address, peer_address);
+  return WriteResult(WRITE_STATUS_OK, buf_len);
+}
+
+WriteResult QuicCoalescingPacketWriter::Flush() {
+  if (buffered_packets_ == 0) {
+    return QuicPacketWriterWrapper::Flush();
+  }
+
+  WriteResult result(WRITE_STATUS_OK, 0);
+  if (buffered_packets_ == 1) {
+    // A lone packet goes out bare; strip the framing so the datagram is
+    // indistinguishable from an uncoalesced send.
+    const char* packet =
+        buffer_.get() + kCoalescedDatagramHeaderSize + kCoalescedPacketPrefixSize;
+    const size_t packet_length = buffered_length_ - kCoalescedDatagramHeaderSize -
+                                 kCoalescedPacketPrefixSize;
+    result = QuicPacketWriterWrapper::WritePacket(packet, packet_length,
+                                                  buffered_self_address_,
+                                                  buffered_peer_address_,
+                                                  /*options=*/nullptr);
+  } else {
+    result = QuicPacketWriterWrapper::WritePacket(buffer_.get(),
+                                                  buffered_length_,
+                                                  buffered_self_address_,
+                                                  buffered_peer_address_,
+                                                  /*options=*/nullptr);
+  }
+
+  if (result.status == WRITE_STATUS_BLOCKED) {
+    // Keep the datagram; the owner flushes again once writable.
+    return result;
+  }
+  if (result.status == WRITE_STATUS_ERROR) {
+    QUIC_DLOG(ERROR) << "Dropping coalesced datagram of " << buffered_packets_
+                     << " packets after write error " << result.error_code;
+  }
+  buffered_length_ = 0;
+  buffered_packets_ = 0;
+  if (result.status != WRITE_STATUS_OK) {
+    return result;
+  }
+
+  WriteResult flush_result = QuicPacketWriterWrapper::Flush();
+  if (flush_result.status != WRITE_STATUS_OK) {
+    return flush_result;
+  }
+  return result;
+}
+
+bool QuicCoalescingPacketWriter::Fits(size_t buf_len) const {
+  return buffered_length_ + kCoalescedPacketPrefixSize + buf_len <=
+         max_datagram_size_;
+}
+
+void QuicCoalescingPacketWriter::Buffer(const char* buffer,
+                                        size_t buf_len,
+                                        const QuicIpAddress& self_address,
+                                        const QuicSocketAddress& peer_address) {
+  if (buffered_packets_ == 0) {
+    buffer_[0] = static_cast<char>(kCoalescedDatagramMarker);
+    buffered_length_ = kCoalescedDatagramHeaderSize;
+    buffered_self_address_ = self_address;
+    buffered_peer_address_ = peer_address;
+  }
+  DCHECK(Fits(buf_len));
+  buffer_[buffered_length_] = static_cast<char>((buf_len >> 8) & 0xff);
+  buffer_[buffered_length_ + 1] = static_cast<char>(buf_len & 0xff);
+  memcpy(buffer_.get() + buffered_length_ + kCoalescedPacketPrefixSize, buffer,
+         buf_len);
+  buffered_length_ += kCoalescedPacketPrefixSize + buf_len;
+  ++buffered_packets_;
+}
+
+}  // namespace net
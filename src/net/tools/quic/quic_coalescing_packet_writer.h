@@ -0,0 +1,79 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_COALESCING_PACKET_WRITER_H_
+#define NET_TOOLS_QUIC_QUIC_COALESCING_PACKET_WRITER_H_
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "base/macros.h"
+#include "net/quic/platform/api/quic_socket_address.h"
+#include "net/tools/quic/quic_packet_writer_wrapper.h"
+
+namespace net {
+
+// A writer wrapper which packs consecutive small packets to the same peer
+// into a single coalesced datagram (see quic_coalesced_datagram.h), cutting
+// the per-datagram syscall and routing cost of handshake flights and
+// small-packet workloads on jumbo-MTU links where the peer also runs this
+// stack. Packets are accumulated until the datagram budget is exhausted, the
+// peer changes, or Flush() is called; as with QuicBatchPacketWriter, the
+// owner must Flush() at the end of every event loop iteration so no packet
+// outlives the wakeup that produced it. A lone buffered packet is always
+// sent bare, so enabling this writer against a peer that never triggers
+// coalescing is interoperable with any QUIC implementation.
+class QuicCoalescingPacketWriter : public QuicPacketWriterWrapper {
+ public:
+  // |max_datagram_size| bounds the coalesced datagram, framing included.
+  // Callers should size it to the path MTU (e.g. ~8950 bytes of UDP payload
+  // on 9000-byte-MTU links).
+  explicit QuicCoalescingPacketWriter(QuicByteCount max_datagram_size);
+  ~QuicCoalescingPacketWriter() override;
+
+  // Buffers |buffer| for coalescing when it fits, flushing first if the
+  // peer changed or the datagram is full. Packets with per-packet options
+  // and packets too large to frame are written through directly.
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const QuicIpAddress& self_address,
+                          const QuicSocketAddress& peer_address,
+                          PerPacketOptions* options) override;
+
+  // Sends buffered packets: a single packet bare, several as one coalesced
+  // datagram. On WRITE_STATUS_BLOCKED the packets stay buffered and the
+  // next Flush() retries them.
+  WriteResult Flush() override;
+
+  size_t buffered_packets() const { return buffered_packets_; }
+
+ private:
+  // Returns true if a |buf_len|-byte packet fits in the current datagram.
+  bool Fits(size_t buf_len) const;
+
+  // Appends a framed copy of the packet to |buffer_|.
+  void Buffer(const char* buffer,
+              size_t buf_len,
+              const QuicIpAddress& self_address,
+              const QuicSocketAddress& peer_address);
+
+  const QuicByteCount max_datagram_size_;
+
+  // Coalesced datagram under construction: the marker byte followed by
+  // length-prefixed packets. |buffered_length_| counts framing.
+  std::unique_ptr<char[]> buffer_;
+  size_t buffered_length_;
+  size_t buffered_packets_;
+
+  // Addresses the buffered packets will be sent between.
+  QuicIpAddress buffered_self_address_;
+  QuicSocketAddress buffered_peer_address_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicCoalescingPacketWriter);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_COALESCING_PACKET_WRITER_H_
@@ -0,0 +1,192 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_coalescing_packet_writer.h"
+
+#include <string>
+#include <vector>
+
+#include "net/quic/platform/api/quic_test.h"
+#include "net/tools/quic/quic_coalesced_datagram.h"
+
+namespace net {
+namespace test {
+namespace {
+
+const QuicByteCount kTestMaxDatagramSize = 100;
+
+// Records every datagram handed to it, and can be made write blocked.
+class RecordingPacketWriter : public QuicPacketWriter {
+ public:
+  RecordingPacketWriter() : write_blocked_(false) {}
+  ~RecordingPacketWriter() override {}
+
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const QuicIpAddress& self_address,
+                          const QuicSocketAddress& peer_address,
+                          PerPacketOptions* options) override {
+    if (write_blocked_) {
+      return WriteResult(WRITE_STATUS_BLOCKED, EAGAIN);
+    }
+    datagrams_.push_back(std::string(buffer, buf_len));
+    peers_.push_back(peer_address);
+    return WriteResult(WRITE_STATUS_OK, buf_len);
+  }
+
+  bool IsWriteBlockedDataBuffered() const override { return false; }
+  bool IsWriteBlocked() const override { return write_blocked_; }
+  void SetWritable() override { write_blocked_ = false; }
+  QuicByteCount GetMaxPacketSize(
+      const QuicSocketAddress& peer_address) const override {
+    return kMaxPacketSize;
+  }
+
+  void set_write_blocked(bool blocked) { write_blocked_ = blocked; }
+
+  const std::vector<std::string>& datagrams() const { return datagrams_; }
+  const std::vector<QuicSocketAddress>& peers() const { return peers_; }
+
+ private:
+  bool write_blocked_;
+  std::vector<std::string> datagrams_;
+  std::vector<QuicSocketAddress> peers_;
+};
+
+class QuicCoalescingPacketWriterTest : public QuicTest {
+ protected:
+  QuicCoalescingPacketWriterTest()
+      : recorder_(new RecordingPacketWriter),
+        writer_(kTestMaxDatagramSize),
+        self_address_(QuicIpAddress::Loopback4()),
+        peer_address_(QuicIpAddress::Loopback4(), 443) {
+    writer_.set_writer(recorder_);
+  }
+
+  WriteResult WritePacket(const std::string& packet,
+                          const QuicSocketAddress& peer) {
+    return writer_.WritePacket(packet.data(), packet.length(), self_address_,
+                               peer, nullptr);
+  }
+
+  RecordingPacketWriter* recorder_;  // Owned by |writer_|.
+  QuicCoalescingPacketWriter writer_;
+  QuicIpAddress self_address_;
+  QuicSocketAddress peer_address_;
+};
+
+TEST_F(QuicCoalescingPacketWriterTest, LonePacketIsSentBare) {
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket("packet", peer_address_).status);
+  EXPECT_EQ(1u, writer_.buffered_packets());
+  EXPECT_TRUE(recorder_->datagrams().empty());
+
+  EXPECT_EQ(WRITE_STATUS_OK, writer_.Flush().status);
+  EXPECT_EQ(0u, writer_.buffered_packets());
+  ASSERT_EQ(1u, recorder_->datagrams().size());
+  EXPECT_EQ("packet", recorder_->datagrams()[0]);
+}
+
+TEST_F(QuicCoalescingPacketWriterTest, MultiplePacketsAreCoalesced) {
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket("first", peer_address_).status);
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket("second", peer_address_).status);
+  EXPECT_EQ(2u, writer_.buffered_packets());
+
+  EXPECT_EQ(WRITE_STATUS_OK, writer_.Flush().status);
+  ASSERT_EQ(1u, recorder_->datagrams().size());
+
+  const std::string& datagram = recorder_->datagrams()[0];
+  ASSERT_TRUE(IsCoalescedDatagram(datagram.data(), datagram.length()));
+  std::vector<QuicStringPiece> packets;
+  ASSERT_TRUE(
+      SplitCoalescedDatagram(datagram.data(), datagram.length(), &packets));
+  ASSERT_EQ(2u, packets.size());
+  EXPECT_EQ("first", packets[0]);
+  EXPECT_EQ("second", packets[1]);
+}
+
+TEST_F(QuicCoalescingPacketWriterTest, PeerChangeFlushesBufferedPackets) {
+  QuicSocketAddress other_peer(QuicIpAddress::Loopback4(), 8443);
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket("to first peer", peer_address_).status);
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket("to second peer", other_peer).status);
+
+  // The first peer's packet went out when the peer changed.
+  ASSERT_EQ(1u, recorder_->datagrams().size());
+  EXPECT_EQ("to first peer", recorder_->datagrams()[0]);
+  EXPECT_EQ(peer_address_, recorder_->peers()[0]);
+  EXPECT_EQ(1u, writer_.buffered_packets());
+
+  EXPECT_EQ(WRITE_STATUS_OK, writer_.Flush().status);
+  ASSERT_EQ(2u, recorder_->datagrams().size());
+  EXPECT_EQ(other_peer, recorder_->peers()[1]);
+}
+
+TEST_F(QuicCoalescingPacketWriterTest, FullDatagramFlushesBufferedPackets) {
+  // Each packet consumes its length plus the two-byte prefix; pack until the
+  // next packet no longer fits in the 100-byte budget.
+  const std::string packet(40, 'a');
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket(packet, peer_address_).status);
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket(packet, peer_address_).status);
+  EXPECT_TRUE(recorder_->datagrams().empty());
+
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket(packet, peer_address_).status);
+  ASSERT_EQ(1u, recorder_->datagrams().size());
+  std::vector<QuicStringPiece> packets;
+  ASSERT_TRUE(SplitCoalescedDatagram(recorder_->datagrams()[0].data(),
+                                     recorder_->datagrams()[0].length(),
+                                     &packets));
+  EXPECT_EQ(2u, packets.size());
+  EXPECT_EQ(1u, writer_.buffered_packets());
+}
+
+TEST_F(QuicCoalescingPacketWriterTest, OversizedPacketIsWrittenThrough) {
+  const std::string big(kTestMaxDatagramSize, 'b');
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket(big, peer_address_).status);
+  EXPECT_EQ(0u, writer_.buffered_packets());
+  ASSERT_EQ(1u, recorder_->datagrams().size());
+  EXPECT_EQ(big, recorder_->datagrams()[0]);
+}
+
+TEST_F(QuicCoalescingPacketWriterTest, BlockedFlushRetainsPackets) {
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket("first", peer_address_).status);
+  EXPECT_EQ(WRITE_STATUS_OK, WritePacket("second", peer_address_).status);
+
+  recorder_->set_write_blocked(true);
+  EXPECT_EQ(WRITE_STATUS_BLOCKED, writer_.Flush().status);
+  EXPECT_EQ(2u, writer_.buffered_packets());
+
+  recorder_->set_write_blocked(false);
+  EXPECT_EQ(WRITE_STATUS_OK, writer_.Flush().status);
+  EXPECT_EQ(0u, writer_.buffered_packets());
+  ASSERT_EQ(1u, recorder_->datagrams().size());
+  std::vector<QuicStringPiece> packets;
+  ASSERT_TRUE(SplitCoalescedDatagram(recorder_->datagrams()[0].data(),
+                                     recorder_->datagrams()[0].length(),
+                                     &packets));
+  EXPECT_EQ(2u, packets.size());
+}
+
+TEST_F(QuicCoalescingPacketWriterTest, SplitRejectsMalformedDatagrams) {
+  std::vector<QuicStringPiece> packets;
+  // Not a coalesced datagram at all.
+  EXPECT_FALSE(SplitCoalescedDatagram("plain packet", 12, &packets));
+  // Marker with no packets.
+  const char empty[] = {static_cast<char>(kCoalescedDatagramMarker)};
+  EXPECT_FALSE(SplitCoalescedDatagram(empty, 1, &packets));
+  // Truncated length prefix.
+  const char truncated_prefix[] = {static_cast<char>(kCoalescedDatagramMarker),
+                                   0x00};
+  EXPECT_FALSE(SplitCoalescedDatagram(truncated_prefix, 2, &packets));
+  // Zero-length packet.
+  const char zero_length[] = {static_cast<char>(kCoalescedDatagramMarker), 0x00,
+                              0x00};
+  EXPECT_FALSE(SplitCoalescedDatagram(zero_length, 3, &packets));
+  // Length prefix claiming more bytes than remain.
+  const char truncated_packet[] = {static_cast<char>(kCoalescedDatagramMarker),
+                                   0x00, 0x05, 'a', 'b'};
+  EXPECT_FALSE(SplitCoalescedDatagram(truncated_packet, 5, &packets));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -0,0 +1,157 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_connection_handoff.h"
+
+#include "net/quic/core/congestion_control/rtt_stats.h"
+#include "net/quic/core/proto/cached_network_parameters.pb.h"
+#include "net/quic/core/quic_connection.h"
+#include "net/quic/core/quic_data_reader.h"
+#include "net/quic/core/quic_data_writer.h"
+#include "net/quic/core/quic_flow_controller.h"
+#include "net/quic/core/quic_session.h"
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+namespace {
+
+const char kHandoffMagic[] = "QHO";
+const size_t kHandoffMagicSize = 3;
+const uint8_t kHandoffFormatVersion = 1;
+
+// Upper bound on the serialized size of the fixed fields plus the magic,
+// the format version and the crypto state length prefix.
+const size_t kHandoffFixedSize = kHandoffMagicSize + 1 + 4 + 10 * 8 + 2;
+
+}  // namespace
+
+QuicConnectionHandoffState::QuicConnectionHandoffState()
+    : connection_id(0),
+      version(QUIC_VERSION_UNSUPPORTED),
+      next_outgoing_packet_number(0),
+      least_unacked(0),
+      largest_received_packet_number(0),
+      smoothed_rtt_us(0),
+      min_rtt_us(0),
+      bandwidth_estimate_bytes_per_second(0),
+      congestion_window_bytes(0),
+      flow_control_bytes_consumed(0),
+      flow_control_highest_received_offset(0),
+      flow_control_send_window_bytes(0) {}
+
+void ExportConnectionHandoffState(QuicSession* session,
+                                  QuicConnectionHandoffState* state) {
+  const QuicConnection* connection = session->connection();
+  const QuicSentPacketManager& sent_packet_manager =
+      connection->sent_packet_manager();
+  const RttStats* rtt_stats = sent_packet_manager.GetRttStats();
+
+  state->connection_id = connection->connection_id();
+  state->version = connection->version();
+  state->next_outgoing_packet_number =
+      sent_packet_manager.GetLargestSentPacket() + 1;
+  state->least_unacked = sent_packet_manager.GetLeastUnacked();
+  state->largest_received_packet_number =
+      connection->received_packet_manager().GetLargestObserved();
+  state->smoothed_rtt_us = rtt_stats->smoothed_rtt().ToMicroseconds();
+  state->min_rtt_us = rtt_stats->min_rtt().ToMicroseconds();
+  state->bandwidth_estimate_bytes_per_second =
+      sent_packet_manager.BandwidthEstimate().ToBytesPerSecond();
+  state->congestion_window_bytes =
+      sent_packet_manager.GetCongestionWindowInBytes();
+  state->flow_control_bytes_consumed =
+      session->flow_controller()->bytes_consumed();
+  state->flow_control_highest_received_offset =
+      session->flow_controller()->highest_received_byte_offset();
+  state->flow_control_send_window_bytes =
+      session->flow_controller()->SendWindowSize();
+  state->crypto_state.clear();
+}
+
+std::string SerializeConnectionHandoffState(
+    const QuicConnectionHandoffState& state) {
+  const size_t buffer_size = kHandoffFixedSize + state.crypto_state.size();
+  std::string blob(buffer_size, '\0');
+  QuicDataWriter writer(buffer_size, &blob[0], Perspective::IS_SERVER,
+                        NETWORK_BYTE_ORDER);
+  bool success =
+      writer.WriteBytes(kHandoffMagic, kHandoffMagicSize) &&
+      writer.WriteUInt8(kHandoffFormatVersion) &&
+      writer.WriteUInt32(QuicVersionToQuicTag(state.version)) &&
+      writer.WriteUInt64(state.connection_id) &&
+      writer.WriteUInt64(state.next_outgoing_packet_number) &&
+      writer.WriteUInt64(state.least_unacked) &&
+      writer.WriteUInt64(state.largest_received_packet_number) &&
+      writer.WriteUInt64(state.smoothed_rtt_us) &&
+      writer.WriteUInt64(state.min_rtt_us) &&
+      writer.WriteUInt64(state.bandwidth_estimate_bytes_per_second) &&
+      writer.WriteUInt64(state.congestion_window_bytes) &&
+      writer.WriteUInt64(state.flow_control_bytes_consumed) &&
+      writer.WriteUInt64(state.flow_control_highest_received_offset) &&
+      writer.WriteUInt64(state.flow_control_send_window_bytes) &&
+      writer.WriteStringPiece16(state.crypto_state);
+  DCHECK(success);
+  blob.resize(writer.length());
+  return blob;
+}
+
+bool DeserializeConnectionHandoffState(QuicStringPiece blob,
+                                       QuicConnectionHandoffState* state) {
+  QuicDataReader reader(blob.data(), blob.length(), Perspective::IS_SERVER,
+                        NETWORK_BYTE_ORDER);
+  QuicStringPiece magic;
+  if (!reader.ReadStringPiece(&magic, kHandoffMagicSize) ||
+      magic != QuicStringPiece(kHandoffMagic, kHandoffMagicSize)) {
+    QUIC_DLOG(WARNING) << "Handoff blob has bad magic.";
+    return false;
+  }
+  uint8_t format_version;
+  if (!reader.ReadUInt8(&format_version) ||
+      format_version != kHandoffFormatVersion) {
+    QUIC_DLOG(WARNING) << "Unsupported handoff format version.";
+    return false;
+  }
+  uint32_t version_tag;
+  uint64_t smoothed_rtt_us;
+  uint64_t min_rtt_us;
+  QuicStringPiece crypto_state;
+  if (!reader.ReadUInt32(&version_tag) ||
+      !reader.ReadUInt64(&state->connection_id) ||
+      !reader.ReadUInt64(&state->next_outgoing_packet_number) ||
+      !reader.ReadUInt64(&state->least_unacked) ||
+      !reader.ReadUInt64(&state->largest_received_packet_number) ||
+      !reader.ReadUInt64(&smoothed_rtt_us) ||
+      !reader.ReadUInt64(&min_rtt_us) ||
+      !reader.ReadUInt64(&state->bandwidth_estimate_bytes_per_second) ||
+      !reader.ReadUInt64(&state->congestion_window_bytes) ||
+      !reader.ReadUInt64(&state->flow_control_bytes_consumed) ||
+      !reader.ReadUInt64(&state->flow_control_highest_received_offset) ||
+      !reader.ReadUInt64(&state->flow_control_send_window_bytes) ||
+      !reader.ReadStringPiece16(&crypto_state)) {
+    QUIC_DLOG(WARNING) << "Handoff blob is truncated.";
+    return false;
+  }
+  state->version = QuicTagToQuicVersion(version_tag);
+  if (state->version == QUIC_VERSION_UNSUPPORTED) {
+    QUIC_DLOG(WARNING) << "Handoff blob carries an unsupported QUIC version.";
+    return false;
+  }
+  state->smoothed_rtt_us = smoothed_rtt_us;
+  state->min_rtt_us = min_rtt_us;
+  state->crypto_state.assign(crypto_state.data(), crypto_state.size());
+  return true;
+}
+
+void ApplyConnectionHandoffState(const QuicConnectionHandoffState& state,
+                                 QuicConnection* connection) {
+  CachedNetworkParameters cached_network_params;
+  cached_network_params.set_bandwidth_estimate_bytes_per_second(
+      state.bandwidth_estimate_bytes_per_second);
+  cached_network_params.set_min_rtt_ms(state.min_rtt_us / 1000);
+  connection->ResumeConnectionState(cached_network_params,
+                                    /*max_bandwidth_resumption=*/false);
+}
+
+}  // namespace net
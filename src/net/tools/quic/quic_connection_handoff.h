@@ -0,0 +1,91 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Serialization of a connection's transport state into a versioned binary
+// blob, so a draining quic_server can hand live connections to its
+// replacement process instead of resetting them. The replacement imports
+// the blob before the SO_REUSEPORT steering layer starts routing the
+// connection's packets to it.
+
+#ifndef NET_TOOLS_QUIC_QUIC_CONNECTION_HANDOFF_H_
+#define NET_TOOLS_QUIC_QUIC_CONNECTION_HANDOFF_H_
+
+#include <cstdint>
+#include <string>
+
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_versions.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+
+namespace net {
+
+class QuicConnection;
+class QuicSession;
+
+// The transport state captured from a connection at export time. Everything
+// here is enumerable from QuicConnection, QuicSentPacketManager and the
+// connection-level QuicFlowController; |crypto_state| is an opaque blob
+// produced by the crypto layer (the serialized forward-secure key material)
+// and is carried through the format untouched.
+struct QuicConnectionHandoffState {
+  QuicConnectionHandoffState();
+
+  QuicConnectionId connection_id;
+  QuicVersion version;
+
+  // Send side: the packet number the importing process must continue from,
+  // and the oldest packet the peer has not yet acked.
+  QuicPacketNumber next_outgoing_packet_number;
+  QuicPacketNumber least_unacked;
+  // Receive side: the largest packet number observed from the peer.
+  QuicPacketNumber largest_received_packet_number;
+
+  // Path state from QuicSentPacketManager, used to seed the replacement's
+  // congestion controller via ResumeConnectionState().
+  int64_t smoothed_rtt_us;
+  int64_t min_rtt_us;
+  uint64_t bandwidth_estimate_bytes_per_second;
+  uint64_t congestion_window_bytes;
+
+  // Connection-level flow control.
+  QuicByteCount flow_control_bytes_consumed;
+  QuicStreamOffset flow_control_highest_received_offset;
+  QuicByteCount flow_control_send_window_bytes;
+
+  // Opaque crypto state, owned by the crypto layer.
+  std::string crypto_state;
+};
+
+// Fills |state| from |session|'s connection, sent packet manager and
+// connection-level flow controller. |crypto_state| is left empty; the
+// caller obtains it from the crypto stream separately.
+void ExportConnectionHandoffState(QuicSession* session,
+                                  QuicConnectionHandoffState* state);
+
+// Serializes |state| into the versioned wire format:
+//
+//   "QHO" | uint8 format version | fields in declaration order, big-endian,
+//   with |crypto_state| as a 16-bit-length-prefixed string.
+//
+// Unknown format versions are rejected at import, so fields may be appended
+// in later versions without breaking older exporters.
+std::string SerializeConnectionHandoffState(
+    const QuicConnectionHandoffState& state);
+
+// Parses |blob| into |state|. Returns false if the magic or format version
+// does not match or the blob is truncated, leaving |state| unspecified.
+bool DeserializeConnectionHandoffState(QuicStringPiece blob,
+                                       QuicConnectionHandoffState* state);
+
+// Applies the imported path state to |connection| by resuming its
+// congestion controller with the exported bandwidth and RTT. Packet
+// numbers, flow control offsets and crypto state are consumed by the
+// dispatcher when it constructs the replacement connection and are not
+// applied here.
+void ApplyConnectionHandoffState(const QuicConnectionHandoffState& state,
+                                 QuicConnection* connection);
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_CONNECTION_HANDOFF_H_
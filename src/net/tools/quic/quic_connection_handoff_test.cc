@@ -0,0 +1,102 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_connection_handoff.h"
+
+#include "net/quic/platform/api/quic_test.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class QuicConnectionHandoffTest : public QuicTest {
+ protected:
+  // Returns a state with every field set to a distinct value.
+  QuicConnectionHandoffState MakeState() {
+    QuicConnectionHandoffState state;
+    state.connection_id = UINT64_C(0xFEDCBA9876543210);
+    state.version = AllSupportedVersions().front();
+    state.next_outgoing_packet_number = 1001;
+    state.least_unacked = 950;
+    state.largest_received_packet_number = 876;
+    state.smoothed_rtt_us = 25000;
+    state.min_rtt_us = 20000;
+    state.bandwidth_estimate_bytes_per_second = 1250000;
+    state.congestion_window_bytes = 64000;
+    state.flow_control_bytes_consumed = 123456;
+    state.flow_control_highest_received_offset = 234567;
+    state.flow_control_send_window_bytes = 16384;
+    state.crypto_state = "opaque key material";
+    return state;
+  }
+};
+
+TEST_F(QuicConnectionHandoffTest, RoundTrip) {
+  QuicConnectionHandoffState original = MakeState();
+  std::string blob = SerializeConnectionHandoffState(original);
+
+  QuicConnectionHandoffState imported;
+  ASSERT_TRUE(DeserializeConnectionHandoffState(blob, &imported));
+  EXPECT_EQ(original.connection_id, imported.connection_id);
+  EXPECT_EQ(original.version, imported.version);
+  EXPECT_EQ(original.next_outgoing_packet_number,
+            imported.next_outgoing_packet_number);
+  EXPECT_EQ(original.least_unacked, imported.least_unacked);
+  EXPECT_EQ(original.largest_received_packet_number,
+            imported.largest_received_packet_number);
+  EXPECT_EQ(original.smoothed_rtt_us, imported.smoothed_rtt_us);
+  EXPECT_EQ(original.min_rtt_us, imported.min_rtt_us);
+  EXPECT_EQ(original.bandwidth_estimate_bytes_per_second,
+            imported.bandwidth_estimate_bytes_per_second);
+  EXPECT_EQ(original.congestion_window_bytes,
+            imported.congestion_window_bytes);
+  EXPECT_EQ(original.flow_control_bytes_consumed,
+            imported.flow_control_bytes_consumed);
+  EXPECT_EQ(original.flow_control_highest_received_offset,
+            imported.flow_control_highest_received_offset);
+  EXPECT_EQ(original.flow_control_send_window_bytes,
+            imported.flow_control_send_window_bytes);
+  EXPECT_EQ(original.crypto_state, imported.crypto_state);
+}
+
+TEST_F(QuicConnectionHandoffTest, RoundTripEmptyCryptoState) {
+  QuicConnectionHandoffState original = MakeState();
+  original.crypto_state.clear();
+  std::string blob = SerializeConnectionHandoffState(original);
+
+  QuicConnectionHandoffState imported;
+  ASSERT_TRUE(DeserializeConnectionHandoffState(blob, &imported));
+  EXPECT_TRUE(imported.crypto_state.empty());
+}
+
+TEST_F(QuicConnectionHandoffTest, RejectsBadMagic) {
+  std::string blob = SerializeConnectionHandoffState(MakeState());
+  blob[0] = 'X';
+
+  QuicConnectionHandoffState imported;
+  EXPECT_FALSE(DeserializeConnectionHandoffState(blob, &imported));
+}
+
+TEST_F(QuicConnectionHandoffTest, RejectsUnknownFormatVersion) {
+  std::string blob = SerializeConnectionHandoffState(MakeState());
+  blob[3] = 0x7f;
+
+  QuicConnectionHandoffState imported;
+  EXPECT_FALSE(DeserializeConnectionHandoffState(blob, &imported));
+}
+
+TEST_F(QuicConnectionHandoffTest, RejectsTruncatedBlob) {
+  std::string blob = SerializeConnectionHandoffState(MakeState());
+
+  QuicConnectionHandoffState imported;
+  for (size_t len = 0; len < blob.size(); ++len) {
+    EXPECT_FALSE(DeserializeConnectionHandoffState(
+        QuicStringPiece(blob.data(), len), &imported))
+        << "prefix of length " << len << " unexpectedly parsed";
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
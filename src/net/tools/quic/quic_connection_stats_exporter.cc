@@ -0,0 +1,182 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_connection_stats_exporter.h"
+
+#include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/tools/quic/quic_dispatcher.h"
+
+namespace net {
+namespace {
+
+const char kStreamMagic[] = "QST1";
+const int64_t kSnapshotIntervalUs = 1000 * 1000;
+
+}  // namespace
+
+QuicConnectionStatsExporter::QuicConnectionStatsExporter(
+    QuicDispatcher* dispatcher,
+    EpollServer* epoll_server,
+    uint32_t field_mask,
+    Sink* sink)
+    : dispatcher_(dispatcher),
+      epoll_server_(epoll_server),
+      field_mask_(field_mask & kAllFields),
+      sink_(sink),
+      header_sent_(false),
+      alarm_(this) {}
+
+QuicConnectionStatsExporter::~QuicConnectionStatsExporter() {}
+
+void QuicConnectionStatsExporter::Start() {
+  DCHECK(dispatcher_ != nullptr);
+  DCHECK(epoll_server_ != nullptr);
+  epoll_server_->RegisterAlarmApproximateDelta(kSnapshotIntervalUs, &alarm_);
+}
+
+void QuicConnectionStatsExporter::Stop() {
+  alarm_.UnregisterIfRegistered();
+}
+
+void QuicConnectionStatsExporter::AppendStreamHeader(std::string* out) const {
+  out->append(kStreamMagic, 4);
+  AppendVarint(field_mask_, out);
+}
+
+void QuicConnectionStatsExporter::AppendRecord(
+    QuicConnectionId connection_id,
+    const QuicConnectionStats& stats,
+    std::string* out) {
+  std::vector<uint64_t>& last = last_values_[connection_id];
+  if (last.empty()) {
+    // First record for this connection: deltas are against zero.
+    last.resize(kNumFields, 0);
+  }
+  AppendVarint(connection_id, out);
+  for (int i = 0; i < kNumFields; ++i) {
+    if ((field_mask_ & (1u << i)) == 0) {
+      continue;
+    }
+    const uint64_t value = FieldValue(stats, i);
+    AppendVarint(
+        ZigZagEncode(static_cast<int64_t>(value) -
+                     static_cast<int64_t>(last[i])),
+        out);
+    last[i] = value;
+  }
+}
+
+void QuicConnectionStatsExporter::TakeSnapshot(std::string* out) {
+  const QuicDispatcher::SessionMap& sessions = dispatcher_->session_map();
+  AppendVarint(sessions.size(), out);
+  QuicUnorderedSet<QuicConnectionId> live_connections;
+  live_connections.reserve(sessions.size());
+  for (auto& kv : sessions) {
+    live_connections.insert(kv.first);
+    AppendRecord(kv.first, kv.second->connection()->GetStats(), out);
+  }
+  // Drop state for connections that have gone away so the registry does not
+  // grow without bound.
+  for (auto it = last_values_.begin(); it != last_values_.end();) {
+    if (live_connections.count(it->first) == 0) {
+      it = last_values_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+// static
+void QuicConnectionStatsExporter::AppendVarint(uint64_t value,
+                                               std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// static
+bool QuicConnectionStatsExporter::ReadVarint(QuicStringPiece* data,
+                                             uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (data->empty()) {
+      return false;
+    }
+    const uint8_t byte = static_cast<uint8_t>((*data)[0]);
+    data->remove_prefix(1);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// static
+uint64_t QuicConnectionStatsExporter::ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+// static
+int64_t QuicConnectionStatsExporter::ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// static
+uint64_t QuicConnectionStatsExporter::FieldValue(
+    const QuicConnectionStats& stats,
+    int field_index) {
+  switch (1u << field_index) {
+    case kBytesSent:
+      return stats.bytes_sent;
+    case kPacketsSent:
+      return stats.packets_sent;
+    case kBytesReceived:
+      return stats.bytes_received;
+    case kPacketsReceived:
+      return stats.packets_received;
+    case kBytesRetransmitted:
+      return stats.bytes_retransmitted;
+    case kPacketsRetransmitted:
+      return stats.packets_retransmitted;
+    case kPacketsLost:
+      return stats.packets_lost;
+    case kMinRttUs:
+      return stats.min_rtt_us;
+    case kSrttUs:
+      return stats.srtt_us;
+    case kEstimatedBandwidthBytesPerSecond:
+      return stats.estimated_bandwidth.ToBytesPerSecond();
+    case kProcessPacketCycles:
+      return stats.process_packet_cycles;
+    case kOnCanWriteCycles:
+      return stats.on_can_write_cycles;
+    case kBufferAllocations:
+      return stats.buffer_allocations;
+  }
+  QUIC_BUG << "Unknown stats field index " << field_index;
+  return 0;
+}
+
+void QuicConnectionStatsExporter::EmitSnapshot() {
+  std::string snapshot;
+  if (!header_sent_) {
+    AppendStreamHeader(&snapshot);
+    header_sent_ = true;
+  }
+  TakeSnapshot(&snapshot);
+  sink_->OnSnapshot(snapshot);
+}
+
+int64_t QuicConnectionStatsExporter::ExportAlarm::OnAlarm() {
+  EpollAlarm::OnAlarm();
+  exporter_->EmitSnapshot();
+  return exporter_->epoll_server_->ApproximateNowInUsec() +
+         kSnapshotIntervalUs;
+}
+
+}  // namespace net
@@ -0,0 +1,137 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// Streams per-connection QuicConnectionStats off a dispatcher as a compact
+// delta-encoded binary stream, so a fleet collector can watch connections
+// continuously instead of only reading stats in-process at connection end.
+
+#ifndef NET_TOOLS_QUIC_QUIC_CONNECTION_STATS_EXPORTER_H_
+#define NET_TOOLS_QUIC_QUIC_CONNECTION_STATS_EXPORTER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "net/quic/core/quic_connection_stats.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/platform/api/quic_containers.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+#include "net/tools/epoll_server/epoll_server.h"
+
+namespace net {
+
+class QuicDispatcher;
+
+// Once a second, snapshots the stats of every connection on a dispatcher
+// and emits one binary frame to a sink. The stream is:
+//
+//   header:   "QST1" | varint field_mask
+//   snapshot: varint num_records | num_records x record
+//   record:   varint connection_id | one zigzag varint delta per field
+//             enabled in field_mask, in ascending Field bit order
+//
+// The header precedes the first snapshot. Deltas are against the previous
+// snapshot's values; a connection's first record carries deltas against
+// zero, i.e. absolute values. Fields are opt-in via the field mask so the
+// steady-state cost stays at a few bytes per enabled field per connection
+// per second (a delta of zero encodes in one byte).
+class QuicConnectionStatsExporter {
+ public:
+  // Exportable fields, used as bits in the field mask. The bit's index is
+  // the field's position in a record.
+  enum Field : uint32_t {
+    kBytesSent = 1 << 0,
+    kPacketsSent = 1 << 1,
+    kBytesReceived = 1 << 2,
+    kPacketsReceived = 1 << 3,
+    kBytesRetransmitted = 1 << 4,
+    kPacketsRetransmitted = 1 << 5,
+    kPacketsLost = 1 << 6,
+    kMinRttUs = 1 << 7,
+    kSrttUs = 1 << 8,
+    kEstimatedBandwidthBytesPerSecond = 1 << 9,
+    kProcessPacketCycles = 1 << 10,
+    kOnCanWriteCycles = 1 << 11,
+    kBufferAllocations = 1 << 12,
+  };
+  static const int kNumFields = 13;
+  static const uint32_t kAllFields = (1 << kNumFields) - 1;
+
+  // Receives one buffer per emitted snapshot (the first prefixed with the
+  // stream header) and forwards it to the collector.
+  class Sink {
+   public:
+    virtual ~Sink() {}
+    virtual void OnSnapshot(const std::string& snapshot) = 0;
+  };
+
+  // |dispatcher|, |epoll_server| and |sink| are not owned and must outlive
+  // the exporter. |dispatcher| and |epoll_server| may be null if the caller
+  // only uses the encoding methods and never calls Start().
+  QuicConnectionStatsExporter(QuicDispatcher* dispatcher,
+                              EpollServer* epoll_server,
+                              uint32_t field_mask,
+                              Sink* sink);
+  ~QuicConnectionStatsExporter();
+
+  // Starts emitting one snapshot per second on the epoll server.
+  void Start();
+  void Stop();
+
+  // Appends the header every stream begins with.
+  void AppendStreamHeader(std::string* out) const;
+
+  // Appends one connection's record, updating the remembered values the
+  // next record's deltas are computed against.
+  void AppendRecord(QuicConnectionId connection_id,
+                    const QuicConnectionStats& stats,
+                    std::string* out);
+
+  // Appends a snapshot of every active session on the dispatcher and drops
+  // remembered state for connections that have gone away.
+  void TakeSnapshot(std::string* out);
+
+  // Encoding primitives, shared with the collector side.
+  static void AppendVarint(uint64_t value, std::string* out);
+  static bool ReadVarint(QuicStringPiece* data, uint64_t* value);
+  static uint64_t ZigZagEncode(int64_t value);
+  static int64_t ZigZagDecode(uint64_t value);
+
+ private:
+  // Epoll alarm driving the once-a-second snapshots.
+  class ExportAlarm : public EpollAlarm {
+   public:
+    explicit ExportAlarm(QuicConnectionStatsExporter* exporter)
+        : exporter_(exporter) {}
+
+    int64_t OnAlarm() override;
+
+   private:
+    QuicConnectionStatsExporter* exporter_;
+  };
+
+  // Returns the current value of the field at bit index |field_index|.
+  static uint64_t FieldValue(const QuicConnectionStats& stats,
+                             int field_index);
+
+  // Builds and emits one snapshot to the sink.
+  void EmitSnapshot();
+
+  QuicDispatcher* dispatcher_;
+  EpollServer* epoll_server_;
+  const uint32_t field_mask_;
+  Sink* sink_;
+  // Whether the stream header has been emitted yet.
+  bool header_sent_;
+  // Per-connection field values as of the previous snapshot.
+  QuicUnorderedMap<QuicConnectionId, std::vector<uint64_t>> last_values_;
+  ExportAlarm alarm_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicConnectionStatsExporter);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_CONNECTION_STATS_EXPORTER_H_
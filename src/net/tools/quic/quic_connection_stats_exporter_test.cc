@@ -0,0 +1,150 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_connection_stats_exporter.h"
+
+#include "net/quic/platform/api/quic_test.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class NullSink : public QuicConnectionStatsExporter::Sink {
+ public:
+  void OnSnapshot(const std::string& snapshot) override {}
+};
+
+class QuicConnectionStatsExporterTest : public QuicTest {
+ protected:
+  QuicConnectionStatsExporterTest()
+      : exporter_(nullptr,
+                  nullptr,
+                  QuicConnectionStatsExporter::kAllFields,
+                  &sink_) {}
+
+  // Reads and returns the next varint from |data|, failing the test on a
+  // truncated stream.
+  uint64_t NextVarint(QuicStringPiece* data) {
+    uint64_t value = 0;
+    EXPECT_TRUE(QuicConnectionStatsExporter::ReadVarint(data, &value));
+    return value;
+  }
+
+  NullSink sink_;
+  QuicConnectionStatsExporter exporter_;
+};
+
+TEST_F(QuicConnectionStatsExporterTest, VarintRoundTrip) {
+  const uint64_t kValues[] = {0,    1,          127,        128,
+                              300,  0xffffffff, UINT64_C(1) << 40,
+                              ~UINT64_C(0)};
+  for (uint64_t value : kValues) {
+    std::string encoded;
+    QuicConnectionStatsExporter::AppendVarint(value, &encoded);
+    QuicStringPiece data(encoded);
+    uint64_t decoded = 0;
+    ASSERT_TRUE(QuicConnectionStatsExporter::ReadVarint(&data, &decoded));
+    EXPECT_EQ(value, decoded);
+    EXPECT_TRUE(data.empty());
+  }
+  // Small values use a single byte; that is what keeps zero deltas cheap.
+  std::string encoded;
+  QuicConnectionStatsExporter::AppendVarint(0, &encoded);
+  EXPECT_EQ(1u, encoded.size());
+}
+
+TEST_F(QuicConnectionStatsExporterTest, ZigZagRoundTrip) {
+  const int64_t kValues[] = {0, 1, -1, 1000, -1000, INT64_MAX, INT64_MIN};
+  for (int64_t value : kValues) {
+    EXPECT_EQ(value, QuicConnectionStatsExporter::ZigZagDecode(
+                         QuicConnectionStatsExporter::ZigZagEncode(value)));
+  }
+  // Small magnitudes map to small encodings regardless of sign.
+  EXPECT_EQ(1u, QuicConnectionStatsExporter::ZigZagEncode(-1));
+  EXPECT_EQ(2u, QuicConnectionStatsExporter::ZigZagEncode(1));
+}
+
+TEST_F(QuicConnectionStatsExporterTest, StreamHeader) {
+  std::string header;
+  exporter_.AppendStreamHeader(&header);
+  ASSERT_GE(header.size(), 5u);
+  EXPECT_EQ("QST1", header.substr(0, 4));
+  QuicStringPiece data(header);
+  data.remove_prefix(4);
+  EXPECT_EQ(QuicConnectionStatsExporter::kAllFields, NextVarint(&data));
+}
+
+TEST_F(QuicConnectionStatsExporterTest, FirstRecordCarriesAbsoluteValues) {
+  QuicConnectionStats stats;
+  stats.bytes_sent = 5000;
+  stats.packets_sent = 4;
+  stats.min_rtt_us = 1234;
+
+  std::string record;
+  exporter_.AppendRecord(/*connection_id=*/7, stats, &record);
+
+  QuicStringPiece data(record);
+  EXPECT_EQ(7u, NextVarint(&data));
+  // Field order follows ascending Field bits: bytes_sent first.
+  EXPECT_EQ(5000, QuicConnectionStatsExporter::ZigZagDecode(
+                      NextVarint(&data)));  // kBytesSent
+  EXPECT_EQ(4, QuicConnectionStatsExporter::ZigZagDecode(
+                   NextVarint(&data)));  // kPacketsSent
+}
+
+TEST_F(QuicConnectionStatsExporterTest, SubsequentRecordsCarryDeltas) {
+  NullSink sink;
+  QuicConnectionStatsExporter exporter(
+      nullptr, nullptr,
+      QuicConnectionStatsExporter::kBytesSent |
+          QuicConnectionStatsExporter::kSrttUs,
+      &sink);
+
+  QuicConnectionStats stats;
+  stats.bytes_sent = 1000;
+  stats.srtt_us = 30000;
+  std::string first;
+  exporter.AppendRecord(/*connection_id=*/7, stats, &first);
+
+  stats.bytes_sent = 1500;
+  stats.srtt_us = 25000;  // RTT fell; the delta must go negative.
+  std::string second;
+  exporter.AppendRecord(/*connection_id=*/7, stats, &second);
+
+  QuicStringPiece data(second);
+  EXPECT_EQ(7u, NextVarint(&data));
+  EXPECT_EQ(500, QuicConnectionStatsExporter::ZigZagDecode(NextVarint(&data)));
+  EXPECT_EQ(-5000,
+            QuicConnectionStatsExporter::ZigZagDecode(NextVarint(&data)));
+  EXPECT_TRUE(data.empty());
+}
+
+TEST_F(QuicConnectionStatsExporterTest, DisabledFieldsAreOmitted) {
+  NullSink sink;
+  QuicConnectionStatsExporter exporter(
+      nullptr, nullptr, QuicConnectionStatsExporter::kBytesSent, &sink);
+
+  QuicConnectionStats stats;
+  stats.bytes_sent = 42;
+  stats.packets_sent = 999;  // Not exported.
+  std::string record;
+  exporter.AppendRecord(/*connection_id=*/1, stats, &record);
+
+  QuicStringPiece data(record);
+  EXPECT_EQ(1u, NextVarint(&data));
+  EXPECT_EQ(42, QuicConnectionStatsExporter::ZigZagDecode(NextVarint(&data)));
+  EXPECT_TRUE(data.empty());
+}
+
+TEST_F(QuicConnectionStatsExporterTest, TruncatedVarintFailsCleanly) {
+  std::string encoded;
+  QuicConnectionStatsExporter::AppendVarint(UINT64_C(1) << 40, &encoded);
+  QuicStringPiece truncated(encoded.data(), encoded.size() - 1);
+  uint64_t value = 0;
+  EXPECT_FALSE(QuicConnectionStatsExporter::ReadVarint(&truncated, &value));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -0,0 +1,133 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_crypto_worker_pool.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "net/quic/platform/api/quic_logging.h"
+
+namespace net {
+
+QuicCryptoWorkerPool::WorkerThread::WorkerThread(QuicCryptoWorkerPool* pool)
+    : base::SimpleThread("quic_crypto_worker"), pool_(pool) {}
+
+QuicCryptoWorkerPool::WorkerThread::~WorkerThread() {}
+
+void QuicCryptoWorkerPool::WorkerThread::Run() {
+  pool_->WorkerLoop();
+}
+
+QuicCryptoWorkerPool::QuicCryptoWorkerPool(EpollServer* epoll_server,
+                                           size_t num_workers,
+                                           size_t max_pending_work)
+    : epoll_server_(epoll_server),
+      max_pending_work_(max_pending_work),
+      work_available_(&work_lock_),
+      shutting_down_(false) {
+  if (pipe(completion_pipe_) != 0) {
+    QUIC_LOG(FATAL) << "pipe() failed: " << strerror(errno);
+  }
+  for (int end : completion_pipe_) {
+    const int flags = fcntl(end, F_GETFL, 0);
+    fcntl(end, F_SETFL, flags | O_NONBLOCK);
+  }
+  epoll_server_->RegisterFD(completion_pipe_[0], this, EPOLLIN);
+  for (size_t i = 0; i < num_workers; ++i) {
+    workers_.push_back(
+        std::unique_ptr<WorkerThread>(new WorkerThread(this)));
+    workers_.back()->Start();
+  }
+}
+
+QuicCryptoWorkerPool::~QuicCryptoWorkerPool() {
+  Shutdown();
+}
+
+bool QuicCryptoWorkerPool::TryScheduleWork(std::unique_ptr<Work>* work) {
+  {
+    base::AutoLock locked(work_lock_);
+    if (shutting_down_ || work_queue_.size() >= max_pending_work_) {
+      return false;
+    }
+    work_queue_.push_back(std::move(*work));
+  }
+  work_available_.Signal();
+  return true;
+}
+
+void QuicCryptoWorkerPool::PostCompletion(
+    std::unique_ptr<Completion> completion) {
+  completions_.Push(std::move(completion));
+  // Wake the epoll loop.  If the pipe is full a wakeup is already pending,
+  // so a short write can be ignored.
+  const char wake = 0;
+  int rc;
+  do {
+    rc = write(completion_pipe_[1], &wake, 1);
+  } while (rc < 0 && errno == EINTR);
+}
+
+void QuicCryptoWorkerPool::Shutdown() {
+  {
+    base::AutoLock locked(work_lock_);
+    if (shutting_down_) {
+      return;
+    }
+    shutting_down_ = true;
+  }
+  work_available_.Broadcast();
+  for (const auto& worker : workers_) {
+    worker->Join();
+  }
+  workers_.clear();
+  // Deliver any results that were posted before the workers stopped.  This
+  // runs on the thread driving the shutdown, which is the epoll thread.
+  DrainCompletions();
+  epoll_server_->UnregisterFD(completion_pipe_[0]);
+  close(completion_pipe_[0]);
+  close(completion_pipe_[1]);
+}
+
+void QuicCryptoWorkerPool::OnEvent(int fd, EpollEvent* event) {
+  DCHECK_EQ(completion_pipe_[0], fd);
+  char buf[64];
+  while (read(fd, buf, sizeof(buf)) > 0) {
+  }
+  DrainCompletions();
+}
+
+void QuicCryptoWorkerPool::WorkerLoop() {
+  while (true) {
+    std::unique_ptr<Work> work;
+    {
+      base::AutoLock locked(work_lock_);
+      while (work_queue_.empty() && !shutting_down_) {
+        work_available_.Wait();
+      }
+      if (work_queue_.empty()) {
+        // Shutting down with nothing left to do.
+        return;
+      }
+      work = std::move(work_queue_.front());
+      work_queue_.pop_front();
+    }
+    work->Run();
+  }
+}
+
+void QuicCryptoWorkerPool::DrainCompletions() {
+  std::unique_ptr<Completion> completion;
+  while (completions_.Pop(&completion)) {
+    completion->Run();
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,103 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A pool of threads that runs CPU-intensive handshake work off the epoll
+// thread, with completions delivered back through the epoll loop.
+
+#ifndef NET_TOOLS_QUIC_QUIC_CRYPTO_WORKER_POOL_H_
+#define NET_TOOLS_QUIC_QUIC_CRYPTO_WORKER_POOL_H_
+
+#include <stddef.h>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/simple_thread.h"
+#include "net/quic/core/quic_crypto_worker_interface.h"
+#include "net/quic/core/quic_mpsc_queue.h"
+#include "net/tools/epoll_server/epoll_server.h"
+
+namespace net {
+
+// QuicCryptoWorkerPool implements QuicCryptoWorkerInterface on top of the
+// toy server's epoll loop.  Work is handed to a fixed set of worker threads
+// through a bounded queue; completions are pushed onto a lock-free queue and
+// drained on the epoll thread, which is woken through a pipe registered with
+// the EpollServer.
+class QuicCryptoWorkerPool : public QuicCryptoWorkerInterface,
+                             public EpollCallbackInterface {
+ public:
+  // |epoll_server| must outlive this pool.  |num_workers| threads are started
+  // immediately; at most |max_pending_work| work items may wait for a worker
+  // before TryScheduleWork starts returning false.
+  QuicCryptoWorkerPool(EpollServer* epoll_server,
+                       size_t num_workers,
+                       size_t max_pending_work);
+  ~QuicCryptoWorkerPool() override;
+
+  // QuicCryptoWorkerInterface implementation.
+  bool TryScheduleWork(std::unique_ptr<Work>* work) override;
+  void PostCompletion(std::unique_ptr<Completion> completion) override;
+
+  // Stops accepting work, joins the worker threads and runs any queued
+  // completions on the calling (epoll) thread.  Called by the destructor if
+  // not called explicitly.
+  void Shutdown();
+
+  // EpollCallbackInterface implementation for the completion pipe.
+  void OnRegistration(EpollServer* eps, int fd, int event_mask) override {}
+  void OnModification(int fd, int event_mask) override {}
+  void OnEvent(int fd, EpollEvent* event) override;
+  void OnUnregistration(int fd, bool replaced) override {}
+  void OnShutdown(EpollServer* eps, int fd) override {}
+
+ private:
+  class WorkerThread : public base::SimpleThread {
+   public:
+    explicit WorkerThread(QuicCryptoWorkerPool* pool);
+    ~WorkerThread() override;
+
+    void Run() override;
+
+   private:
+    QuicCryptoWorkerPool* pool_;
+
+    DISALLOW_COPY_AND_ASSIGN(WorkerThread);
+  };
+
+  // Body of each worker thread: pops work items until Shutdown.
+  void WorkerLoop();
+
+  // Runs all queued completions.  Must be called on the epoll thread.
+  void DrainCompletions();
+
+  EpollServer* epoll_server_;  // Unowned.
+  const size_t max_pending_work_;
+
+  // Guards work_queue_ and shutting_down_.
+  base::Lock work_lock_;
+  base::ConditionVariable work_available_;
+  std::deque<std::unique_ptr<Work>> work_queue_;
+  bool shutting_down_;
+
+  std::vector<std::unique_ptr<WorkerThread>> workers_;
+
+  // Completions pushed by worker threads and drained on the epoll thread.
+  QuicMpscQueue<std::unique_ptr<Completion>> completions_;
+
+  // Pipe used to wake the epoll loop when a completion is posted.
+  // completion_pipe_[0] is registered with the epoll server for reads;
+  // worker threads write a byte to completion_pipe_[1].
+  int completion_pipe_[2];
+
+  DISALLOW_COPY_AND_ASSIGN(QuicCryptoWorkerPool);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_CRYPTO_WORKER_POOL_H_
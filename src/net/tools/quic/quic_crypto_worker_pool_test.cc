@@ -0,0 +1,95 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_crypto_worker_pool.h"
+
+#include <memory>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace net {
+namespace test {
+namespace {
+
+class CountingWork : public QuicCryptoWorkerInterface::Work {
+ public:
+  CountingWork(QuicCryptoWorkerPool* pool, int* completions_run)
+      : pool_(pool), completions_run_(completions_run) {}
+
+  void Run() override {
+    pool_->PostCompletion(
+        std::unique_ptr<QuicCryptoWorkerInterface::Completion>(
+            new CountingCompletion(completions_run_)));
+  }
+
+ private:
+  class CountingCompletion : public QuicCryptoWorkerInterface::Completion {
+   public:
+    explicit CountingCompletion(int* completions_run)
+        : completions_run_(completions_run) {}
+
+    void Run() override { ++*completions_run_; }
+
+   private:
+    int* completions_run_;
+  };
+
+  QuicCryptoWorkerPool* pool_;
+  int* completions_run_;
+};
+
+TEST(QuicCryptoWorkerPoolTest, WorkCompletesOnEpollThread) {
+  EpollServer epoll_server;
+  QuicCryptoWorkerPool pool(&epoll_server, /*num_workers=*/2,
+                            /*max_pending_work=*/16);
+  int completions_run = 0;
+  for (int i = 0; i < 5; ++i) {
+    std::unique_ptr<QuicCryptoWorkerInterface::Work> work(
+        new CountingWork(&pool, &completions_run));
+    EXPECT_TRUE(pool.TryScheduleWork(&work));
+  }
+  while (completions_run < 5) {
+    epoll_server.WaitForEventsAndExecuteCallbacks();
+  }
+  EXPECT_EQ(5, completions_run);
+}
+
+TEST(QuicCryptoWorkerPoolTest, BacklogIsBounded) {
+  EpollServer epoll_server;
+  // With no workers nothing drains the queue, so the bound is exact.
+  QuicCryptoWorkerPool pool(&epoll_server, /*num_workers=*/0,
+                            /*max_pending_work=*/3);
+  int completions_run = 0;
+  for (int i = 0; i < 3; ++i) {
+    std::unique_ptr<QuicCryptoWorkerInterface::Work> work(
+        new CountingWork(&pool, &completions_run));
+    EXPECT_TRUE(pool.TryScheduleWork(&work));
+  }
+  std::unique_ptr<QuicCryptoWorkerInterface::Work> work(
+      new CountingWork(&pool, &completions_run));
+  EXPECT_FALSE(pool.TryScheduleWork(&work));
+  // The rejected work is returned to the caller for synchronous fallback.
+  ASSERT_TRUE(work != nullptr);
+  work->Run();
+  pool.Shutdown();
+  EXPECT_EQ(1, completions_run);
+}
+
+TEST(QuicCryptoWorkerPoolTest, ShutdownRunsPendingCompletions) {
+  EpollServer epoll_server;
+  QuicCryptoWorkerPool pool(&epoll_server, /*num_workers=*/1,
+                            /*max_pending_work=*/16);
+  int completions_run = 0;
+  std::unique_ptr<QuicCryptoWorkerInterface::Work> work(
+      new CountingWork(&pool, &completions_run));
+  EXPECT_TRUE(pool.TryScheduleWork(&work));
+  // Shut down without pumping the epoll loop; the completion must still be
+  // delivered before Shutdown returns.
+  pool.Shutdown();
+  EXPECT_EQ(1, completions_run);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
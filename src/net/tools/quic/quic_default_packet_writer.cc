@@ -4,12 +4,16 @@
 
 #include "net/tools/quic/quic_default_packet_writer.h"
 
+#include <errno.h>
+
+#include "base/time/time.h"
+#include "net/socket/udp_socket_performance_watcher.h"
 #include "net/tools/quic/platform/impl/quic_socket_utils.h"
 
 namespace net {
 
 QuicDefaultPacketWriter::QuicDefaultPacketWriter(int fd)
-    : fd_(fd), write_blocked_(false) {}
+    : fd_(fd), write_blocked_(false), performance_watcher_(nullptr) {}
 
 QuicDefaultPacketWriter::~QuicDefaultPacketWriter() {}
 
@@ -22,8 +26,24 @@ WriteResult QuicDefaultPacketWriter::WritePacket(
   DCHECK(!write_blocked_);
   DCHECK(nullptr == options)
       << "QuicDefaultPacketWriter does not accept any options.";
+  base::TimeTicks syscall_start;
+  if (performance_watcher_ != nullptr) {
+    syscall_start = base::TimeTicks::Now();
+  }
   WriteResult result = QuicSocketUtils::WritePacket(fd_, buffer, buf_len,
                                                     self_address, peer_address);
+  if (performance_watcher_ != nullptr) {
+    int watcher_result;
+    if (result.status == WRITE_STATUS_OK) {
+      watcher_result = result.bytes_written;
+    } else if (result.status == WRITE_STATUS_BLOCKED) {
+      watcher_result = -EAGAIN;
+    } else {
+      watcher_result = -result.error_code;
+    }
+    performance_watcher_->OnWriteResult(watcher_result,
+                                        base::TimeTicks::Now() - syscall_start);
+  }
   if (result.status == WRITE_STATUS_BLOCKED) {
     write_blocked_ = true;
   }
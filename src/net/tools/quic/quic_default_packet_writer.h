@@ -14,6 +14,7 @@
 
 namespace net {
 
+class UDPSocketPerformanceWatcher;
 struct WriteResult;
 
 
@@ -37,6 +38,13 @@ class QUIC_EXPORT_PRIVATE QuicDefaultPacketWriter : public QuicPacketWriter {
 
   void set_fd(int fd) { fd_ = fd; }
 
+  // Sets the watcher notified after each send syscall. The watcher is not
+  // owned and must outlive this writer. May be null (the default), in which
+  // case no per-send instrumentation is done.
+  void set_performance_watcher(UDPSocketPerformanceWatcher* watcher) {
+    performance_watcher_ = watcher;
+  }
+
  protected:
   void set_write_blocked(bool is_blocked);
   int fd() { return fd_; }
@@ -44,6 +52,7 @@ class QUIC_EXPORT_PRIVATE QuicDefaultPacketWriter : public QuicPacketWriter {
  private:
   int fd_;
   bool write_blocked_;
+  UDPSocketPerformanceWatcher* performance_watcher_;  // Not owned.
 
   DISALLOW_COPY_AND_ASSIGN(QuicDefaultPacketWriter);
 };
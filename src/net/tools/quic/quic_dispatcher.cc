@@ -4,11 +4,13 @@
 
 #include "net/tools/quic/quic_dispatcher.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "base/macros.h"
 #include "net/quic/core/crypto/crypto_protocol.h"
 #include "net/quic/core/crypto/quic_random.h"
+#include "net/quic/core/quic_fec_datagram.h"
 #include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
 #include "net/quic/platform/api/quic_flag_utils.h"
@@ -48,6 +50,52 @@ class DeleteSessionsAlarm : public QuicAlarm::Delegate {
   DISALLOW_COPY_AND_ASSIGN(DeleteSessionsAlarm);
 };
 
+// The maximum number of peer hosts whose discovered path MTU is remembered.
+const size_t kMaxPathMtuCacheSize = 1024;
+
+// The granularity with which batched ack deadlines are quantized.  Deadlines
+// are rounded up, so acks fire at or shortly after the time a connection's
+// own ack alarm would have fired.
+const int64_t kAckBatchingEpochGranularityUs = 5000;
+
+// An alarm that informs the QuicDispatcher to drain due ack epoch buckets.
+class AckBatchingAlarm : public QuicAlarm::Delegate {
+ public:
+  explicit AckBatchingAlarm(QuicDispatcher* dispatcher)
+      : dispatcher_(dispatcher) {}
+
+  void OnAlarm() override { dispatcher_->DeliverBatchedAcks(); }
+
+ private:
+  // Not owned.
+  QuicDispatcher* dispatcher_;
+
+  DISALLOW_COPY_AND_ASSIGN(AckBatchingAlarm);
+};
+
+// An alarm that periodically sweeps idle sessions into hibernation.
+class HibernationAlarm : public QuicAlarm::Delegate {
+ public:
+  explicit HibernationAlarm(QuicDispatcher* dispatcher)
+      : dispatcher_(dispatcher) {}
+
+  void OnAlarm() override { dispatcher_->HibernateIdleConnections(); }
+
+ private:
+  // Not owned.
+  QuicDispatcher* dispatcher_;
+
+  DISALLOW_COPY_AND_ASSIGN(HibernationAlarm);
+};
+
+// How long a hibernated connection's record stays routable before it is
+// forgotten entirely.
+const int64_t kHibernationRecordRetentionSeconds = 600;
+
+// Lower bound on the hibernation sweep period, so a short idle timeout
+// cannot turn the sweep into a busy loop over the session map.
+const int64_t kMinHibernationSweepIntervalSeconds = 1;
+
 // Collects packets serialized by a QuicPacketCreator in order
 // to be handed off to the time wait list manager.
 class PacketCollector : public QuicPacketCreator::DelegateInterface,
@@ -259,20 +307,30 @@ QuicDispatcher::QuicDispatcher(
       crypto_config_(crypto_config),
       compressed_certs_cache_(
           QuicCompressedCertsCache::kQuicCompressedCertsCacheSize),
+      connection_id_alias_epoch_(0),
+      hibernation_idle_timeout_(QuicTime::Delta::Zero()),
+      hibernating_current_session_(false),
+      kernel_packets_dropped_(0),
       helper_(std::move(helper)),
       session_helper_(std::move(session_helper)),
       alarm_factory_(std::move(alarm_factory)),
       delete_sessions_alarm_(
           alarm_factory_->CreateAlarm(new DeleteSessionsAlarm(this))),
+      ack_batching_alarm_(
+          alarm_factory_->CreateAlarm(new AckBatchingAlarm(this))),
+      hibernation_alarm_(
+          alarm_factory_->CreateAlarm(new HibernationAlarm(this))),
       buffered_packets_(this, helper_->GetClock(), alarm_factory_.get()),
       current_packet_(nullptr),
       version_manager_(version_manager),
       framer_(GetSupportedVersions(),
               /*unused*/ QuicTime::Zero(),
               Perspective::IS_SERVER),
+      chlo_extractor_(GetSupportedVersions()),
       last_error_(QUIC_NO_ERROR),
       new_sessions_allowed_per_event_loop_(0u),
-      accept_new_connections_(true) {
+      accept_new_connections_(true),
+      stateless_rejector_completed_inline_(false) {
   framer_.set_visitor(this);
 }
 
@@ -293,6 +351,22 @@ void QuicDispatcher::ProcessPacket(const QuicSocketAddress& server_address,
   current_server_address_ = server_address;
   current_client_address_ = client_address;
   current_packet_ = &packet;
+  if (FLAGS_quic_reloadable_flag_quic_enable_xor_fec &&
+      IsFecDatagram(packet.data(), packet.length())) {
+    // XOR FEC parity datagrams are not QUIC packets (the framer rejects
+    // their marker byte as illegal public flags), so route them by the
+    // embedded connection ID. Sessions that did not negotiate kXFEC drop
+    // them.
+    QuicConnectionId connection_id;
+    if (ParseFecDatagramConnectionId(packet.data(), packet.length(),
+                                     &connection_id)) {
+      SessionMap::iterator it = FindSession(connection_id);
+      if (it != session_map_.end()) {
+        it->second->ProcessUdpPacket(server_address, client_address, packet);
+      }
+    }
+    return;
+  }
   // ProcessPacket will cause the packet to be dispatched in
   // OnUnauthenticatedPublicHeader, or sent to the time wait list manager
   // in OnUnauthenticatedHeader.
@@ -323,7 +397,7 @@ bool QuicDispatcher::OnUnauthenticatedPublicHeader(
   // Packets with connection IDs for active connections are processed
   // immediately.
   QuicConnectionId connection_id = header.connection_id;
-  SessionMap::iterator it = session_map_.find(connection_id);
+  SessionMap::iterator it = FindSession(connection_id);
   if (it != session_map_.end()) {
     DCHECK(!buffered_packets_.HasBufferedPackets(connection_id));
     it->second->ProcessUdpPacket(current_server_address_,
@@ -361,6 +435,25 @@ bool QuicDispatcher::OnUnauthenticatedPublicHeader(
     return HandlePacketForTimeWait(header);
   }
 
+  auto hibernated_it = hibernated_connections_.find(connection_id);
+  if (hibernated_it != hibernated_connections_.end()) {
+    if (!header.version_flag) {
+      // A mid-connection packet for a hibernated session. Fast-fail it
+      // through the time-wait machinery so the peer learns the connection
+      // is gone now and re-handshakes with its cached config, rather than
+      // discovering the loss through its own timeout.
+      const QuicVersion version = hibernated_it->second.version;
+      hibernated_connections_.erase(hibernated_it);
+      time_wait_list_manager_->AddConnectionIdToTimeWait(
+          connection_id, version, /*connection_rejected_statelessly=*/false,
+          nullptr);
+      return HandlePacketForTimeWait(header);
+    }
+    // A fresh handshake on a hibernated ID: drop the record and let the
+    // normal CHLO path revive the connection as a new session.
+    hibernated_connections_.erase(hibernated_it);
+  }
+
   // The packet has an unknown connection ID.
 
   // Unless the packet provides a version, assume that we can continue
@@ -379,8 +472,8 @@ bool QuicDispatcher::OnUnauthenticatedPublicHeader(
       // Since the version is not supported, send a version negotiation
       // packet and stop processing the current packet.
       time_wait_list_manager()->SendVersionNegotiationPacket(
-          connection_id, GetSupportedVersions(), current_server_address_,
-          current_client_address_);
+          version_manager_->GetVersionNegotiationPacket(connection_id),
+          current_server_address_, current_client_address_);
       return false;
     }
     version = packet_version;
@@ -502,20 +595,265 @@ void QuicDispatcher::CleanUpSession(SessionMap::iterator it,
     DCHECK(connection->termination_packets() != nullptr &&
            !connection->termination_packets()->empty());
   }
-  time_wait_list_manager_->AddConnectionIdToTimeWait(
-      it->first, connection->version(), should_close_statelessly,
-      connection->termination_packets());
+  if (!hibernating_current_session_) {
+    // A hibernating session's ID lives on as a compact record in
+    // |hibernated_connections_| instead of a time-wait entry.
+    time_wait_list_manager_->AddConnectionIdToTimeWait(
+        it->first, connection->version(), should_close_statelessly,
+        connection->termination_packets());
+  }
+  RemoveAliasesForConnectionId(it->first);
   session_map_.erase(it);
 }
 
+void QuicDispatcher::EnableHibernation(QuicTime::Delta idle_timeout) {
+  DCHECK(!idle_timeout.IsZero());
+  hibernation_idle_timeout_ = idle_timeout;
+  HibernateIdleConnections();
+}
+
+bool QuicDispatcher::IsSessionIdleForHibernation(QuicSession* session,
+                                                 QuicTime now) const {
+  QuicConnection* connection = session->connection();
+  if (!connection->connected() || connection->HasQueuedData()) {
+    return false;
+  }
+  return now - connection->time_of_last_received_packet() >=
+         hibernation_idle_timeout_;
+}
+
+void QuicDispatcher::HibernateIdleConnections() {
+  if (hibernation_idle_timeout_.IsZero()) {
+    return;
+  }
+  const QuicTime now = helper()->GetClock()->ApproximateNow();
+  std::vector<QuicConnectionId> idle_ids;
+  for (auto& kv : session_map_) {
+    if (IsSessionIdleForHibernation(kv.second.get(), now)) {
+      idle_ids.push_back(kv.first);
+    }
+  }
+  for (QuicConnectionId connection_id : idle_ids) {
+    SessionMap::iterator it = session_map_.find(connection_id);
+    if (it == session_map_.end()) {
+      continue;
+    }
+    QuicConnection* connection = it->second->connection();
+    HibernatedConnection record;
+    record.version = connection->version();
+    record.hibernate_time_us = (now - QuicTime::Zero()).ToMicroseconds();
+    hibernated_connections_.insert(std::make_pair(connection_id, record));
+    // The silent close runs through OnConnectionClosed and CleanUpSession;
+    // the flag keeps the ID out of the time-wait list.
+    hibernating_current_session_ = true;
+    connection->CloseConnection(QUIC_NETWORK_IDLE_TIMEOUT,
+                                "Connection hibernated while idle.",
+                                ConnectionCloseBehavior::SILENT_CLOSE);
+    hibernating_current_session_ = false;
+  }
+
+  // Forget records past the retention period; by then the client has either
+  // revived the connection or given up on it.
+  const int64_t cutoff_us =
+      (now - QuicTime::Zero()).ToMicroseconds() -
+      QuicTime::Delta::FromSeconds(kHibernationRecordRetentionSeconds)
+          .ToMicroseconds();
+  std::vector<QuicConnectionId> expired;
+  for (const auto& entry : hibernated_connections_) {
+    if (entry.second.hibernate_time_us < cutoff_us) {
+      expired.push_back(entry.first);
+    }
+  }
+  for (QuicConnectionId connection_id : expired) {
+    hibernated_connections_.erase(connection_id);
+  }
+
+  hibernation_alarm_->Update(
+      now + std::max(QuicTime::Delta::FromSeconds(
+                         kMinHibernationSweepIntervalSeconds),
+                     hibernation_idle_timeout_ * 0.5),
+      QuicTime::Delta::Zero());
+}
+
+bool QuicDispatcher::AddConnectionIdAlias(QuicConnectionId alias_id,
+                                          QuicConnectionId existing_id) {
+  if (session_map_.count(alias_id) > 0 ||
+      connection_id_aliases_.count(alias_id) > 0) {
+    return false;
+  }
+  // Collapse chains so every alias routes directly to the primary ID.
+  QuicConnectionId primary_id = existing_id;
+  auto alias_it = connection_id_aliases_.find(existing_id);
+  if (alias_it != connection_id_aliases_.end()) {
+    primary_id = alias_it->second.primary_id;
+  } else if (session_map_.count(existing_id) == 0) {
+    return false;
+  }
+  ConnectionIdAlias alias;
+  alias.primary_id = primary_id;
+  alias.epoch = connection_id_alias_epoch_;
+  connection_id_aliases_.insert(std::make_pair(alias_id, alias));
+  return true;
+}
+
+void QuicDispatcher::AdvanceConnectionIdAliasEpoch() {
+  ++connection_id_alias_epoch_;
+  // Aliases retire after this many epochs without being added or refreshed
+  // by traffic, leaving old IDs routable long enough to drain the network.
+  const uint64_t kConnectionIdAliasRetentionEpochs = 2;
+  std::vector<QuicConnectionId> expired;
+  for (const auto& entry : connection_id_aliases_) {
+    if (entry.second.epoch + kConnectionIdAliasRetentionEpochs <=
+        connection_id_alias_epoch_) {
+      expired.push_back(entry.first);
+    }
+  }
+  for (QuicConnectionId alias_id : expired) {
+    connection_id_aliases_.erase(alias_id);
+  }
+}
+
+QuicDispatcher::SessionMap::iterator QuicDispatcher::FindSession(
+    QuicConnectionId connection_id) {
+  SessionMap::iterator it = session_map_.find(connection_id);
+  if (it != session_map_.end()) {
+    return it;
+  }
+  auto alias_it = connection_id_aliases_.find(connection_id);
+  if (alias_it == connection_id_aliases_.end()) {
+    return session_map_.end();
+  }
+  // An alias that still carries traffic should not be retired.
+  alias_it->second.epoch = connection_id_alias_epoch_;
+  return session_map_.find(alias_it->second.primary_id);
+}
+
+void QuicDispatcher::RemoveAliasesForConnectionId(
+    QuicConnectionId connection_id) {
+  std::vector<QuicConnectionId> to_remove;
+  for (const auto& entry : connection_id_aliases_) {
+    if (entry.second.primary_id == connection_id) {
+      to_remove.push_back(entry.first);
+    }
+  }
+  for (QuicConnectionId alias_id : to_remove) {
+    connection_id_aliases_.erase(alias_id);
+  }
+}
+
 void QuicDispatcher::StopAcceptingNewConnections() {
   accept_new_connections_ = false;
 }
 
+std::vector<QuicDispatcher::ConnectionAccountingEntry>
+QuicDispatcher::GetConnectionAccounting() {
+  std::vector<ConnectionAccountingEntry> entries;
+  entries.reserve(session_map_.size());
+  for (auto& kv : session_map_) {
+    QuicConnection* connection = kv.second->connection();
+    const QuicConnectionStats& stats = connection->GetStats();
+    ConnectionAccountingEntry entry;
+    entry.connection_id = kv.first;
+    entry.peer_address = connection->peer_address();
+    entry.process_packet_cycles = stats.process_packet_cycles;
+    entry.on_can_write_cycles = stats.on_can_write_cycles;
+    entry.buffer_allocations = stats.buffer_allocations;
+    entry.bytes_sent = stats.bytes_sent;
+    entry.bytes_received = stats.bytes_received;
+    entries.push_back(entry);
+  }
+  return entries;
+}
+
+void QuicDispatcher::OnKernelPacketsDropped(QuicPacketCount dropped) {
+  if (dropped == 0) {
+    return;
+  }
+  kernel_packets_dropped_ += dropped;
+  QUIC_DLOG(WARNING) << "Kernel dropped " << dropped
+                     << " packets from the receive queue ("
+                     << kernel_packets_dropped_ << " total).";
+  // All active sessions share the overflowing socket, so each of them may
+  // see losses caused by our own drops rather than the network.
+  for (auto& kv : session_map_) {
+    kv.second->connection()->OnLocalSocketOverflow();
+  }
+}
+
 void QuicDispatcher::DeleteSessions() {
   closed_session_list_.clear();
 }
 
+void QuicDispatcher::RecordPathMtu(const QuicSocketAddress& peer_address,
+                                   QuicByteCount mtu) {
+  const std::string host = peer_address.host().ToString();
+  auto it = path_mtu_cache_.find(host);
+  if (it != path_mtu_cache_.end()) {
+    it->second = mtu;
+    return;
+  }
+  if (path_mtu_cache_.size() >= kMaxPathMtuCacheSize) {
+    path_mtu_cache_.erase(path_mtu_cache_.begin());
+  }
+  path_mtu_cache_.insert(std::make_pair(host, mtu));
+}
+
+QuicByteCount QuicDispatcher::LookupPathMtu(
+    const QuicSocketAddress& peer_address) {
+  auto it = path_mtu_cache_.find(peer_address.host().ToString());
+  if (it == path_mtu_cache_.end()) {
+    return 0;
+  }
+  return it->second;
+}
+
+void QuicDispatcher::ScheduleAckAlarm(QuicConnection* connection,
+                                      QuicTime deadline) {
+  // Round the deadline up to the containing epoch, so the ack fires at or
+  // shortly after the time the connection asked for.
+  const int64_t epoch = ((deadline - QuicTime::Zero()).ToMicroseconds() +
+                         kAckBatchingEpochGranularityUs - 1) /
+                        kAckBatchingEpochGranularityUs;
+  ack_epoch_buckets_[epoch].push_back(connection->connection_id());
+
+  const QuicTime earliest_bucket_deadline =
+      QuicTime::Zero() +
+      QuicTime::Delta::FromMicroseconds(ack_epoch_buckets_.begin()->first *
+                                        kAckBatchingEpochGranularityUs);
+  ack_batching_alarm_->Update(
+      earliest_bucket_deadline,
+      QuicTime::Delta::FromMicroseconds(kAckBatchingEpochGranularityUs));
+}
+
+void QuicDispatcher::DeliverBatchedAcks() {
+  const QuicTime now = helper_->GetClock()->ApproximateNow();
+  while (!ack_epoch_buckets_.empty()) {
+    auto bucket = ack_epoch_buckets_.begin();
+    const QuicTime bucket_deadline =
+        QuicTime::Zero() + QuicTime::Delta::FromMicroseconds(
+                               bucket->first * kAckBatchingEpochGranularityUs);
+    if (bucket_deadline > now) {
+      ack_batching_alarm_->Update(
+          bucket_deadline,
+          QuicTime::Delta::FromMicroseconds(kAckBatchingEpochGranularityUs));
+      return;
+    }
+    // Detach the bucket before draining it, as sending acks may register new
+    // intents and mutate the bucket map.
+    std::vector<QuicConnectionId> connection_ids;
+    connection_ids.swap(bucket->second);
+    ack_epoch_buckets_.erase(bucket);
+    for (QuicConnectionId connection_id : connection_ids) {
+      auto it = session_map_.find(connection_id);
+      if (it == session_map_.end()) {
+        // The connection was closed after registering the intent.
+        continue;
+      }
+      it->second->connection()->OnBatchedAckAlarm();
+    }
+  }
+}
+
 void QuicDispatcher::OnCanWrite() {
   // The socket is now writable.
   writer_->SetWritable();
@@ -528,6 +866,10 @@ void QuicDispatcher::OnCanWrite() {
     write_blocked_list_.erase(write_blocked_list_.begin());
     blocked_writer->OnCanWrite();
   }
+
+  // Batching writers accumulate everything written above; push it to the
+  // network in as few syscalls as possible.
+  writer_->Flush();
 }
 
 bool QuicDispatcher::HasPendingWrites() const {
@@ -569,6 +911,11 @@ void QuicDispatcher::OnConnectionClosed(QuicConnectionId connection_id,
                                    QuicTime::Delta::Zero());
   }
   QuicConnection* connection = it->second->connection();
+  if (connection->max_packet_length() > kDefaultMaxPacketSize) {
+    // Remember what MTU discovery learned about this path, so future
+    // connections from the same host skip re-probing.
+    RecordPathMtu(connection->peer_address(), connection->max_packet_length());
+  }
   closed_session_list_.push_back(std::move(it->second));
   const bool should_close_statelessly =
       (error == QUIC_CRYPTO_HANDSHAKE_STATELESS_REJECT);
@@ -703,6 +1050,8 @@ void QuicDispatcher::OnExpiredPackets(
 }
 
 void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
+  // Pull in any packets worker threads handed off since the last event loop.
+  buffered_packets_.DrainPacketsHandedOff();
   // Reset the counter before starting creating connections.
   new_sessions_allowed_per_event_loop_ = max_connections_to_create;
   for (; new_sessions_allowed_per_event_loop_ > 0;
@@ -717,6 +1066,16 @@ void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
     QuicSession* session = CreateQuicSession(
         connection_id, packets.front().client_address, packet_list.alpn);
     QUIC_DLOG(INFO) << "Created new session for " << connection_id;
+    const QuicByteCount cached_mtu =
+        LookupPathMtu(packets.front().client_address);
+    if (cached_mtu != 0) {
+      session->connection()->SetMaxPacketLength(cached_mtu);
+    }
+    if (FLAGS_quic_reloadable_flag_quic_dispatcher_ack_batching) {
+      QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_dispatcher_ack_batching, 1,
+                        2);
+      session->connection()->set_ack_scheduler(this);
+    }
     session_map_.insert(std::make_pair(connection_id, QuicWrapUnique(session)));
     DeliverPacketsToSession(packets, session);
   }
@@ -804,6 +1163,14 @@ void QuicDispatcher::ProcessChlo() {
   QuicSession* session = CreateQuicSession(
       current_connection_id_, current_client_address_, current_alpn_);
   QUIC_DLOG(INFO) << "Created new session for " << current_connection_id_;
+  const QuicByteCount cached_mtu = LookupPathMtu(current_client_address_);
+  if (cached_mtu != 0) {
+    session->connection()->SetMaxPacketLength(cached_mtu);
+  }
+  if (FLAGS_quic_reloadable_flag_quic_dispatcher_ack_batching) {
+    QUIC_FLAG_COUNT_N(quic_reloadable_flag_quic_dispatcher_ack_batching, 2, 2);
+    session->connection()->set_ack_scheduler(this);
+  }
   session_map_.insert(
       std::make_pair(current_connection_id_, QuicWrapUnique(session)));
   std::list<BufferedPacket> packets =
@@ -863,11 +1230,24 @@ class StatelessRejectorProcessDoneCallback
       : dispatcher_(dispatcher),
         current_client_address_(dispatcher->current_client_address_),
         current_server_address_(dispatcher->current_server_address_),
-        current_packet_(
-            dispatcher->current_packet_->Clone()),  // Note: copies the packet
         first_version_(first_version) {}
 
+  // Called by the dispatcher if rejector processing did not complete inside
+  // StatelessRejector::Process, at which point the current packet must be
+  // copied to outlive the dispatcher's receive loop.
+  void CapturePacketForAsyncProcessing() {
+    current_packet_ = dispatcher_->current_packet_->Clone();
+  }
+
   void Run(std::unique_ptr<StatelessRejector> rejector) override {
+    if (current_packet_ == nullptr) {
+      // Still inside StatelessRejector::Process: the packet which initiated
+      // the stateless reject is the dispatcher's current packet, so no copy
+      // is needed.
+      dispatcher_->OnStatelessRejectorProcessDoneInline(std::move(rejector),
+                                                        first_version_);
+      return;
+    }
     dispatcher_->OnStatelessRejectorProcessDone(
         std::move(rejector), current_client_address_, current_server_address_,
         std::move(current_packet_), first_version_);
@@ -891,8 +1271,7 @@ void QuicDispatcher::MaybeRejectStatelessly(QuicConnectionId connection_id,
     // Not use cheap stateless reject.
     ChloAlpnExtractor alpn_extractor;
     if (FLAGS_quic_allow_chlo_buffering &&
-        !ChloExtractor::Extract(*current_packet_, GetSupportedVersions(),
-                                &alpn_extractor)) {
+        !chlo_extractor_.ExtractChlo(*current_packet_, &alpn_extractor)) {
       // Buffer non-CHLO packets.
       ProcessUnauthenticatedHeaderFate(kFateBuffer, connection_id);
       return;
@@ -908,8 +1287,7 @@ void QuicDispatcher::MaybeRejectStatelessly(QuicConnectionId connection_id,
       current_packet_->length(), GetClientAddress(), current_server_address_));
   ChloValidator validator(session_helper_.get(), current_server_address_,
                           rejector.get());
-  if (!ChloExtractor::Extract(*current_packet_, GetSupportedVersions(),
-                              &validator)) {
+  if (!chlo_extractor_.ExtractChlo(*current_packet_, &validator)) {
     ProcessUnauthenticatedHeaderFate(kFateBuffer, connection_id);
     return;
   }
@@ -933,17 +1311,28 @@ void QuicDispatcher::MaybeRejectStatelessly(QuicConnectionId connection_id,
     return;
   }
 
-  // Insert into set of connection IDs to buffer
+  // Continue stateless rejector processing.  This typically completes
+  // synchronously (the source-address token is validated locally), in which
+  // case the callback runs inline and neither a copy of the current packet
+  // nor buffered-connection bookkeeping is needed.
+  std::unique_ptr<StatelessRejectorProcessDoneCallback> cb(
+      new StatelessRejectorProcessDoneCallback(this, version));
+  StatelessRejectorProcessDoneCallback* cb_ptr = cb.get();
+  stateless_rejector_completed_inline_ = false;
+  StatelessRejector::Process(std::move(rejector), std::move(cb));
+  if (stateless_rejector_completed_inline_) {
+    return;
+  }
+
+  // Processing went asynchronous.  The validation chain still owns |cb_ptr|,
+  // which must now capture the current packet, and subsequent packets for
+  // this connection are buffered until the rejector completes.
+  cb_ptr->CapturePacketForAsyncProcessing();
   const bool ok =
       temporarily_buffered_connections_.insert(connection_id).second;
   QUIC_BUG_IF(!ok)
       << "Processing multiple stateless rejections for connection ID "
       << connection_id;
-
-  // Continue stateless rejector processing
-  std::unique_ptr<StatelessRejectorProcessDoneCallback> cb(
-      new StatelessRejectorProcessDoneCallback(this, version));
-  StatelessRejector::Process(std::move(rejector), std::move(cb));
 }
 
 void QuicDispatcher::OnStatelessRejectorProcessDone(
@@ -984,6 +1373,17 @@ void QuicDispatcher::OnStatelessRejectorProcessDone(
   ProcessStatelessRejectorState(std::move(rejector), first_version);
 }
 
+void QuicDispatcher::OnStatelessRejectorProcessDoneInline(
+    std::unique_ptr<StatelessRejector> rejector,
+    QuicVersion first_version) {
+  stateless_rejector_completed_inline_ = true;
+  // The dispatcher's current packet, addresses and framer version are those
+  // of the packet which initiated the stateless reject, so no state needs to
+  // be restored, and the connection cannot have entered time-wait since
+  // MaybeRejectStatelessly started.
+  ProcessStatelessRejectorState(std::move(rejector), first_version);
+}
+
 void QuicDispatcher::ProcessStatelessRejectorState(
     std::unique_ptr<StatelessRejector> rejector,
     QuicVersion first_version) {
@@ -8,6 +8,7 @@
 #ifndef NET_TOOLS_QUIC_QUIC_DISPATCHER_H_
 #define NET_TOOLS_QUIC_QUIC_DISPATCHER_H_
 
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -17,6 +18,7 @@
 #include "net/quic/core/quic_blocked_writer_interface.h"
 #include "net/quic/core/quic_buffered_packet_store.h"
 #include "net/quic/core/quic_connection.h"
+#include "net/quic/core/quic_connection_id_map.h"
 #include "net/quic/core/quic_crypto_server_stream.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/core/quic_session.h"
@@ -24,6 +26,7 @@
 #include "net/quic/platform/api/quic_containers.h"
 #include "net/quic/platform/api/quic_socket_address.h"
 
+#include "net/tools/quic/chlo_extractor.h"
 #include "net/tools/quic/quic_process_packet_interface.h"
 #include "net/tools/quic/quic_time_wait_list_manager.h"
 #include "net/tools/quic/stateless_rejector.h"
@@ -40,7 +43,8 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
                        public ProcessPacketInterface,
                        public QuicBlockedWriterInterface,
                        public QuicFramerVisitorInterface,
-                       public QuicBufferedPacketStore::VisitorInterface {
+                       public QuicBufferedPacketStore::VisitorInterface,
+                       public QuicAckScheduler {
  public:
   // Ideally we'd have a linked_hash_set: the  boolean is unused.
   typedef QuicLinkedHashMap<QuicBlockedWriterInterface*, bool> WriteBlockedList;
@@ -94,14 +98,82 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
   // time-wait list.
   void OnConnectionAddedToTimeWaitList(QuicConnectionId connection_id) override;
 
-  using SessionMap =
-      QuicUnorderedMap<QuicConnectionId, std::unique_ptr<QuicSession>>;
+  // Open-addressing table keyed directly on the (already random) connection
+  // ID; the per-packet lookup is the dispatcher's hottest index.
+  using SessionMap = QuicConnectionIdMap<std::unique_ptr<QuicSession>>;
 
   const SessionMap& session_map() const { return session_map_; }
 
+  // Routes packets bearing |alias_id| to the session currently reachable via
+  // |existing_id| (which may itself be an alias). Connection ID rotation then
+  // costs two table writes: add the new ID as an alias and let the old one
+  // age out, so in-flight packets for either ID keep hitting the session.
+  // Returns false if |alias_id| already routes somewhere or |existing_id| is
+  // unknown.
+  bool AddConnectionIdAlias(QuicConnectionId alias_id,
+                            QuicConnectionId existing_id);
+
+  // Advances the alias epoch and retires aliases that have neither been
+  // added nor carried traffic for kConnectionIdAliasRetentionEpochs epochs.
+  // Call at the cadence clients rotate; the retention keeps an old ID
+  // routable long enough for the network to drain.
+  void AdvanceConnectionIdAliasEpoch();
+
+  // Enables idle-connection hibernation: sessions whose peers have been
+  // silent for |idle_timeout| are torn down without going through time wait
+  // and replaced by a compact record, a few dozen bytes instead of tens of
+  // kilobytes of session state. A versioned CHLO for a hibernated ID
+  // revives it as a fresh session on the normal handshake path (one round
+  // trip with a cached server config); a mid-connection packet is
+  // fast-failed through the time-wait machinery so the client re-handshakes
+  // immediately instead of waiting out its own timeout.
+  void EnableHibernation(QuicTime::Delta idle_timeout);
+
+  // Hibernates every session idle for at least the configured timeout and
+  // expires stale hibernation records. Runs periodically off an alarm once
+  // hibernation is enabled; exposed for callers wanting an eager sweep.
+  void HibernateIdleConnections();
+
+  size_t num_hibernated_connections() const {
+    return hibernated_connections_.size();
+  }
+
+  // A snapshot of one connection's resource consumption, for attributing
+  // this dispatcher's load to individual connections.
+  struct ConnectionAccountingEntry {
+    QuicConnectionId connection_id;
+    QuicSocketAddress peer_address;
+    // See the matching QuicConnectionStats fields for semantics.
+    uint64_t process_packet_cycles;
+    uint64_t on_can_write_cycles;
+    uint64_t buffer_allocations;
+    QuicByteCount bytes_sent;
+    QuicByteCount bytes_received;
+  };
+
+  // Returns accounting snapshots for every active session. Cheap enough to
+  // poll: it only copies counters the connections already maintain.
+  std::vector<ConnectionAccountingEntry> GetConnectionAccounting();
+
+  // Called when the kernel reports that |dropped| packets overflowed the
+  // receive queue of this dispatcher's socket since the last report.  Counts
+  // the drops against this dispatcher and tells every active connection so
+  // losses detected while the queue was overflowing are excluded from
+  // loss-based congestion reactions.
+  void OnKernelPacketsDropped(QuicPacketCount dropped);
+
+  // Cumulative kernel receive-queue drops reported against this dispatcher.
+  QuicPacketCount kernel_packets_dropped() const {
+    return kernel_packets_dropped_;
+  }
+
   // Deletes all sessions on the closed session list and clears the list.
   virtual void DeleteSessions();
 
+  // The shared packet writer all per-connection writers wrap. Public so the
+  // server can flush a batching writer after dispatching a burst of reads.
+  QuicPacketWriter* writer() { return writer_.get(); }
+
   // The largest packet number we expect to receive with a connection
   // ID for a connection that is not established yet.  The current design will
   // send a handshake and then up to 50 or so data packets, and then it may
@@ -158,6 +230,22 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
   // Return true if there is CHLO buffered.
   virtual bool HasChlosBuffered() const;
 
+  // QuicAckScheduler implementation.  Registers an ack intent for
+  // |connection| in the epoch bucket covering |deadline|; a single alarm
+  // drains due buckets through DeliverBatchedAcks.
+  void ScheduleAckAlarm(QuicConnection* connection, QuicTime deadline) override;
+
+  // Sends pending acks for every epoch bucket whose deadline has passed and
+  // re-arms the batching alarm for the next bucket, if any.
+  void DeliverBatchedAcks();
+
+  // Remembers |mtu| as the discovered path MTU for |peer_address|'s host,
+  // evicting the oldest entry when the cache is full.
+  void RecordPathMtu(const QuicSocketAddress& peer_address, QuicByteCount mtu);
+
+  // Returns the cached path MTU for |peer_address|'s host, or 0 if unknown.
+  QuicByteCount LookupPathMtu(const QuicSocketAddress& peer_address);
+
  protected:
   virtual QuicSession* CreateQuicSession(
       QuicConnectionId connection_id,
@@ -243,8 +331,6 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
 
   QuicAlarmFactory* alarm_factory() { return alarm_factory_.get(); }
 
-  QuicPacketWriter* writer() { return writer_.get(); }
-
   // Creates per-connection packet writers out of the QuicDispatcher's shared
   // QuicPacketWriter. The per-connection writers' IsWriteBlocked() state must
   // always be the same as the shared writer's IsWriteBlocked(), or else the
@@ -293,6 +379,36 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
 
   typedef QuicUnorderedSet<QuicConnectionId> QuicConnectionIdSet;
 
+  // A secondary connection ID routed to a primary entry in |session_map_|.
+  struct ConnectionIdAlias {
+    // The connection ID under which the session is registered.
+    QuicConnectionId primary_id = 0;
+    // Epoch in which this alias was added or last carried traffic.
+    uint64_t epoch = 0;
+  };
+
+  // Finds the session for |connection_id|, resolving through
+  // |connection_id_aliases_| when the primary lookup misses. Refreshes the
+  // epoch of an alias that carried traffic.
+  SessionMap::iterator FindSession(QuicConnectionId connection_id);
+
+  // Drops every alias routing to |connection_id|; called when the session is
+  // removed from the session map.
+  void RemoveAliasesForConnectionId(QuicConnectionId connection_id);
+
+  // What remains of a hibernated connection: enough to route the next
+  // packet for its ID onto a revival path and to expire the record.
+  struct HibernatedConnection {
+    QuicVersion version = QUIC_VERSION_UNSUPPORTED;
+    // When the session was hibernated, in microseconds since the clock's
+    // epoch. Records older than the retention period are expired by sweeps.
+    int64_t hibernate_time_us = 0;
+  };
+
+  // Returns true if |session|'s connection has been quiet long enough, as
+  // of |now|, to hibernate.
+  bool IsSessionIdleForHibernation(QuicSession* session, QuicTime now) const;
+
   bool HandlePacketForTimeWait(const QuicPacketPublicHeader& header);
 
   // Attempts to reject the connection statelessly, if stateless rejects are
@@ -321,6 +437,14 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
       std::unique_ptr<QuicReceivedPacket> current_packet,
       QuicVersion first_version);
 
+  // Invoked when StatelessRejector::Process completes synchronously, while
+  // the packet which initiated the stateless reject is still the current
+  // packet.  Unlike the asynchronous completion above, this requires no
+  // cloned packet and no buffered-connection bookkeeping.
+  void OnStatelessRejectorProcessDoneInline(
+      std::unique_ptr<StatelessRejector> rejector,
+      QuicVersion first_version);
+
   // Examine the state of the rejector and decide what to do with the current
   // packet.
   void ProcessStatelessRejectorState(
@@ -344,6 +468,30 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
 
   SessionMap session_map_;
 
+  // Secondary connection IDs routed to entries in |session_map_|. Small:
+  // only rotating connections occupy it, and old IDs retire by epoch.
+  QuicConnectionIdMap<ConnectionIdAlias> connection_id_aliases_;
+
+  // Advanced by AdvanceConnectionIdAliasEpoch(); aliases with stale epochs
+  // are retired.
+  uint64_t connection_id_alias_epoch_;
+
+  // Compact records for hibernated connections. Sized by the hibernation
+  // retention period, not by concurrent session state.
+  QuicConnectionIdMap<HibernatedConnection> hibernated_connections_;
+
+  // Idle period after which a session is hibernated. Zero means
+  // hibernation is disabled.
+  QuicTime::Delta hibernation_idle_timeout_;
+
+  // True while a session is being closed by HibernateIdleConnections, so
+  // CleanUpSession skips the time-wait insertion for it.
+  bool hibernating_current_session_;
+
+  // Cumulative kernel receive-queue drops reported for this dispatcher's
+  // socket via OnKernelPacketsDropped().
+  QuicPacketCount kernel_packets_dropped_;
+
   // Entity that manages connection_ids in time wait state.
   std::unique_ptr<QuicTimeWaitListManager> time_wait_list_manager_;
 
@@ -362,6 +510,23 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
   // An alarm which deletes closed sessions.
   std::unique_ptr<QuicAlarm> delete_sessions_alarm_;
 
+  // Pending batched-ack intents, keyed by scheduling epoch (the deadline
+  // rounded up to the batching granularity).  Buckets hold connection ids
+  // rather than pointers so they may safely outlive their connections;
+  // closed connections are skipped at drain time.
+  std::map<int64_t, std::vector<QuicConnectionId>> ack_epoch_buckets_;
+
+  // An alarm which fires when the earliest ack epoch bucket is due.
+  std::unique_ptr<QuicAlarm> ack_batching_alarm_;
+
+  // An alarm which periodically sweeps idle sessions into hibernation.
+  std::unique_ptr<QuicAlarm> hibernation_alarm_;
+
+  // MTUs discovered by closed connections, keyed by peer IP.  New
+  // connections to a known path start at the cached packet length instead of
+  // re-probing from the default.  Bounded, FIFO eviction.
+  QuicLinkedHashMap<std::string, QuicByteCount> path_mtu_cache_;
+
   // The writer to write to the socket with.
   std::unique_ptr<QuicPacketWriter> writer_;
 
@@ -387,6 +552,10 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
 
   QuicFramer framer_;
 
+  // Sniffs CHLOs out of undecryptable new-connection packets.  Kept as a
+  // member so its internal framer is reused rather than rebuilt per packet.
+  ChloExtractor chlo_extractor_;
+
   // The last error set by SetLastError(), which is called by
   // framer_visitor_->OnError().
   QuicErrorCode last_error_;
@@ -398,6 +567,10 @@ class QuicDispatcher : public QuicTimeWaitListManager::Visitor,
   // True if this dispatcher is not draining.
   bool accept_new_connections_;
 
+  // Set by OnStatelessRejectorProcessDoneInline so MaybeRejectStatelessly can
+  // tell whether StatelessRejector::Process completed synchronously.
+  bool stateless_rejector_completed_inline_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicDispatcher);
 };
 
@@ -0,0 +1,346 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// quic_dispatcher_replay: replays a dump of captured QUIC packets against a
+// QuicSimpleDispatcher at a configurable speed multiplier and reports
+// per-packet processing cost and heap allocation counts. Unlike
+// end_to_end_test, the input is deterministic, so two runs over the same
+// dump isolate the effect of a server-side change.
+//
+// Dump format (all integers little endian):
+//   8 bytes   magic "QUICRPL1"
+// then one record per packet:
+//   8 bytes   capture timestamp, microseconds
+//   1 byte    client address family: 4 or 6
+//   4 or 16   client IP address, network byte order
+//   2 bytes   client UDP port
+//   2 bytes   packet length
+//   n bytes   raw QUIC packet payload
+//
+// --speed=1 preserves the captured inter-packet gaps, larger values
+// compress them, and 0 (the default) replays back to back.
+//
+// Handshake packets run the dispatcher's real code path (version
+// negotiation, stateless rejects, CHLO processing). Post-handshake short
+// header packets exercise routing, buffering and time-wait handling, but
+// cannot be decrypted: the forward-secure keys of the captured connection
+// are not reconstructible from a packet dump, and the dispatcher has no
+// interface for injecting them.
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/logging.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "net/quic/chromium/crypto/proof_source_chromium.h"
+#include "net/quic/core/crypto/quic_random.h"
+#include "net/tools/quic/quic_epoll_connection_helper.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/platform/api/quic_socket_address.h"
+#include "net/quic/platform/api/quic_str_cat.h"
+#include "net/tools/epoll_server/epoll_server.h"
+#include "net/tools/quic/quic_client_load_generator.h"
+#include "net/tools/quic/quic_epoll_alarm_factory.h"
+#include "net/tools/quic/platform/impl/quic_epoll_clock.h"
+#include "net/tools/quic/quic_http_response_cache.h"
+#include "net/tools/quic/quic_simple_crypto_server_stream_helper.h"
+#include "net/tools/quic/quic_simple_dispatcher.h"
+
+using std::cerr;
+using std::cout;
+using std::endl;
+using std::string;
+
+namespace {
+
+// Counts heap allocations made while the replay runs. The replay loop is
+// single threaded, so a plain counter suffices.
+uint64_t g_num_allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++g_num_allocations;
+  return malloc(size);
+}
+
+void* operator new[](std::size_t size) {
+  ++g_num_allocations;
+  return malloc(size);
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+  free(p);
+}
+
+namespace {
+
+const char kDumpMagic[] = "QUICRPL1";
+const size_t kDumpMagicLen = 8;
+
+// A writer which reports every packet as sent; the replayed peers are not
+// listening, and writing to a real socket would only add noise to the
+// measurement.
+class DiscardingPacketWriter : public net::QuicPacketWriter {
+ public:
+  DiscardingPacketWriter() {}
+  ~DiscardingPacketWriter() override {}
+
+  net::WriteResult WritePacket(const char* buffer,
+                               size_t buf_len,
+                               const net::QuicIpAddress& self_address,
+                               const net::QuicSocketAddress& peer_address,
+                               net::PerPacketOptions* options) override {
+    return net::WriteResult(net::WRITE_STATUS_OK, buf_len);
+  }
+
+  bool IsWriteBlockedDataBuffered() const override { return false; }
+  bool IsWriteBlocked() const override { return false; }
+  void SetWritable() override {}
+
+  net::QuicByteCount GetMaxPacketSize(
+      const net::QuicSocketAddress& peer_address) const override {
+    return net::kMaxPacketSize;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(DiscardingPacketWriter);
+};
+
+bool ReadExact(std::ifstream* in, char* out, size_t len) {
+  in->read(out, len);
+  return static_cast<size_t>(in->gcount()) == len;
+}
+
+uint64_t ReadLE64(const char* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint16_t ReadLE16(const char* p) {
+  uint16_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  base::AtExitManager exit_manager;
+  base::MessageLoopForIO message_loop;
+
+  base::CommandLine::Init(argc, argv);
+  base::CommandLine* line = base::CommandLine::ForCurrentProcess();
+
+  logging::LoggingSettings settings;
+  settings.logging_dest = logging::LOG_TO_SYSTEM_DEBUG_LOG;
+  CHECK(logging::InitLogging(settings));
+
+  if (line->HasSwitch("h") || line->HasSwitch("help") ||
+      !line->HasSwitch("dump_file")) {
+    const char* help_str =
+        "Usage: quic_dispatcher_replay [options]\n"
+        "\n"
+        "Options:\n"
+        "-h, --help                  show this help message and exit\n"
+        "--dump_file=<file>          packet dump to replay (required)\n"
+        "--speed=<multiplier>        replay speed: 1 preserves captured\n"
+        "                            timing, 0 replays back to back "
+        "(default)\n"
+        "--quic_response_cache_dir   directory of response data to serve\n"
+        "--certificate_file=<file>   path to the certificate chain\n"
+        "--key_file=<file>           path to the pkcs8 private key\n";
+    cout << help_str;
+    exit(0);
+  }
+
+  double speed = 0;
+  if (line->HasSwitch("speed")) {
+    if (!base::StringToDouble(line->GetSwitchValueASCII("speed"), &speed) ||
+        speed < 0) {
+      cerr << "--speed must be a non-negative number\n";
+      return 1;
+    }
+  }
+
+  if (!line->HasSwitch("certificate_file")) {
+    cerr << "missing --certificate_file\n";
+    return 1;
+  }
+  if (!line->HasSwitch("key_file")) {
+    cerr << "missing --key_file\n";
+    return 1;
+  }
+
+  std::ifstream dump(line->GetSwitchValueASCII("dump_file"),
+                     std::ios::in | std::ios::binary);
+  if (!dump) {
+    cerr << "Unable to open " << line->GetSwitchValueASCII("dump_file")
+         << "\n";
+    return 1;
+  }
+  char magic[kDumpMagicLen];
+  if (!ReadExact(&dump, magic, kDumpMagicLen) ||
+      memcmp(magic, kDumpMagic, kDumpMagicLen) != 0) {
+    cerr << "Not a QUIC replay dump (bad magic)\n";
+    return 1;
+  }
+
+  net::QuicHttpResponseCache response_cache;
+  if (line->HasSwitch("quic_response_cache_dir")) {
+    response_cache.InitializeFromDirectory(
+        line->GetSwitchValueASCII("quic_response_cache_dir"));
+  }
+
+  std::unique_ptr<net::ProofSourceChromium> proof_source(
+      new net::ProofSourceChromium());
+  CHECK(proof_source->Initialize(line->GetSwitchValuePath("certificate_file"),
+                                 line->GetSwitchValuePath("key_file"),
+                                 base::FilePath()));
+
+  net::EpollServer epoll_server;
+  epoll_server.set_timeout_in_us(0);
+  net::QuicEpollClock clock(&epoll_server);
+
+  net::QuicConfig config;
+  net::QuicCryptoServerConfig crypto_config("secret",
+                                            net::QuicRandom::GetInstance(),
+                                            std::move(proof_source));
+  std::unique_ptr<net::CryptoHandshakeMessage> scfg(
+      crypto_config.AddDefaultConfig(
+          net::QuicRandom::GetInstance(), &clock,
+          net::QuicCryptoServerConfig::ConfigOptions()));
+  net::QuicVersionManager version_manager(net::AllSupportedVersions());
+
+  net::QuicSimpleDispatcher dispatcher(
+      config, &crypto_config, &version_manager,
+      std::unique_ptr<net::QuicEpollConnectionHelper>(
+          new net::QuicEpollConnectionHelper(&epoll_server,
+                                             net::QuicAllocator::BUFFER_POOL)),
+      std::unique_ptr<net::QuicCryptoServerStream::Helper>(
+          new net::QuicSimpleCryptoServerStreamHelper(
+              net::QuicRandom::GetInstance())),
+      std::unique_ptr<net::QuicAlarmFactory>(
+          new net::QuicEpollAlarmFactory(&epoll_server)),
+      &response_cache);
+  dispatcher.InitializeWithWriter(new DiscardingPacketWriter());
+
+  const net::QuicSocketAddress server_address(net::QuicIpAddress::Loopback6(),
+                                              6121);
+
+  net::QuicLatencyHistogram process_histogram;
+  uint64_t num_packets = 0;
+  uint64_t num_bytes = 0;
+  uint64_t total_allocations = 0;
+  uint64_t max_allocations = 0;
+  uint64_t first_timestamp_us = 0;
+  uint64_t prev_timestamp_us = 0;
+  uint64_t last_timestamp_us = 0;
+  const int64_t replay_start_us = epoll_server.NowInUsec();
+
+  char header[13];
+  char addr_bytes[16];
+  char payload[net::kMaxPacketSize * 4];
+  while (ReadExact(&dump, header, 9)) {
+    const uint64_t timestamp_us = ReadLE64(header);
+    const uint8_t family = static_cast<uint8_t>(header[8]);
+    const size_t addr_len = family == 4 ? 4 : 16;
+    if ((family != 4 && family != 6) ||
+        !ReadExact(&dump, addr_bytes, addr_len) ||
+        !ReadExact(&dump, header, 4)) {
+      cerr << "Truncated or corrupt record after " << num_packets
+           << " packets\n";
+      return 1;
+    }
+    const uint16_t port = ReadLE16(header);
+    const uint16_t length = ReadLE16(header + 2);
+    if (length == 0 || length > sizeof(payload) ||
+        !ReadExact(&dump, payload, length)) {
+      cerr << "Truncated or corrupt record after " << num_packets
+           << " packets\n";
+      return 1;
+    }
+    net::QuicIpAddress client_ip;
+    if (!client_ip.FromPackedString(addr_bytes, addr_len)) {
+      cerr << "Bad client address after " << num_packets << " packets\n";
+      return 1;
+    }
+    const net::QuicSocketAddress client_address(client_ip, port);
+
+    if (num_packets == 0) {
+      first_timestamp_us = timestamp_us;
+    } else if (speed > 0 && timestamp_us > prev_timestamp_us) {
+      usleep(static_cast<useconds_t>((timestamp_us - prev_timestamp_us) /
+                                     speed));
+    }
+    prev_timestamp_us = timestamp_us;
+    last_timestamp_us = timestamp_us;
+
+    net::QuicReceivedPacket packet(payload, length, clock.Now());
+    const uint64_t allocations_before = g_num_allocations;
+    const int64_t t0 = epoll_server.NowInUsec();
+    dispatcher.ProcessPacket(server_address, client_address, packet);
+    const int64_t t1 = epoll_server.NowInUsec();
+    const uint64_t allocations = g_num_allocations - allocations_before;
+
+    process_histogram.Record(t0 <= t1 ? static_cast<uint64_t>(t1 - t0) : 0);
+    total_allocations += allocations;
+    if (allocations > max_allocations) {
+      max_allocations = allocations;
+    }
+    ++num_packets;
+    num_bytes += length;
+
+    // Fire any alarms that came due (retransmissions, idle timeouts) so
+    // the dispatcher's state evolves as it would in production. Kept
+    // outside the per-packet measurement.
+    epoll_server.WaitForEventsAndExecuteCallbacks();
+  }
+
+  const int64_t replay_duration_us =
+      epoll_server.NowInUsec() - replay_start_us;
+  if (num_packets == 0) {
+    cerr << "Dump contains no packets\n";
+    return 1;
+  }
+
+  cout << net::QuicStrCat(
+              "{\"packets\":", num_packets, ",\"bytes\":", num_bytes,
+              ",\"capture_span_us\":", last_timestamp_us - first_timestamp_us,
+              ",\"replay_duration_us\":", replay_duration_us,
+              ",\"process_us\":{\"min\":", process_histogram.min(),
+              ",\"mean\":", process_histogram.Mean(),
+              ",\"p50\":", process_histogram.ValueAtQuantile(0.50),
+              ",\"p90\":", process_histogram.ValueAtQuantile(0.90),
+              ",\"p99\":", process_histogram.ValueAtQuantile(0.99),
+              ",\"max\":", process_histogram.max(),
+              "},\"allocations\":{\"total\":", total_allocations,
+              ",\"per_packet_mean\":", total_allocations / num_packets,
+              ",\"per_packet_max\":", max_allocations, "}}")
+       << endl;
+  return 0;
+}
@@ -469,6 +469,121 @@ TEST_F(QuicDispatcherTest, TimeWaitListManager) {
   ProcessPacket(client_address, connection_id, true, "data");
 }
 
+TEST_F(QuicDispatcherTest, ConnectionIdAliasRoutesToExistingSession) {
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  server_address_ = QuicSocketAddress(QuicIpAddress::Any4(), 5);
+
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(1, client_address, QuicStringPiece("hq")))
+      .WillOnce(testing::Return(CreateSession(
+          dispatcher_.get(), config_, 1, client_address, &mock_helper_,
+          &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_)));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .WillOnce(testing::WithArgs<2>(Invoke(CreateFunctor(
+          &QuicDispatcherTest::ValidatePacket, base::Unretained(this), 1))));
+  EXPECT_CALL(*dispatcher_, ShouldCreateOrBufferPacketForConnection(1));
+  ProcessPacket(client_address, 1, true, SerializeCHLO());
+
+  // Alias connection ID 2 to the established connection 1.
+  EXPECT_TRUE(dispatcher_->AddConnectionIdAlias(2, 1));
+  // IDs already in use, either as primary or alias, cannot be re-aliased.
+  EXPECT_FALSE(dispatcher_->AddConnectionIdAlias(1, 2));
+  EXPECT_FALSE(dispatcher_->AddConnectionIdAlias(2, 1));
+  // Aliases to unknown connections are rejected.
+  EXPECT_FALSE(dispatcher_->AddConnectionIdAlias(3, 42));
+  // Chains collapse: an alias of an alias routes directly to the primary.
+  EXPECT_TRUE(dispatcher_->AddConnectionIdAlias(3, 2));
+
+  // Packets with either alias are delivered to session 1.
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .WillOnce(testing::WithArgs<2>(Invoke(CreateFunctor(
+          &QuicDispatcherTest::ValidatePacket, base::Unretained(this), 2))))
+      .WillOnce(testing::WithArgs<2>(Invoke(CreateFunctor(
+          &QuicDispatcherTest::ValidatePacket, base::Unretained(this), 3))));
+  ProcessPacket(client_address, 2, false, "data");
+  ProcessPacket(client_address, 3, false, "data");
+}
+
+TEST_F(QuicDispatcherTest, ConnectionIdAliasRetiresAfterIdleEpochs) {
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  server_address_ = QuicSocketAddress(QuicIpAddress::Any4(), 5);
+
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(1, client_address, QuicStringPiece("hq")))
+      .WillOnce(testing::Return(CreateSession(
+          dispatcher_.get(), config_, 1, client_address, &mock_helper_,
+          &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_)));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .WillOnce(testing::WithArgs<2>(Invoke(CreateFunctor(
+          &QuicDispatcherTest::ValidatePacket, base::Unretained(this), 1))));
+  EXPECT_CALL(*dispatcher_, ShouldCreateOrBufferPacketForConnection(1));
+  ProcessPacket(client_address, 1, true, SerializeCHLO());
+
+  EXPECT_TRUE(dispatcher_->AddConnectionIdAlias(2, 1));
+  // An alias that carries traffic within the retention period stays routable.
+  dispatcher_->AdvanceConnectionIdAliasEpoch();
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .WillOnce(testing::WithArgs<2>(Invoke(CreateFunctor(
+          &QuicDispatcherTest::ValidatePacket, base::Unretained(this), 2))));
+  ProcessPacket(client_address, 2, false, "data");
+  dispatcher_->AdvanceConnectionIdAliasEpoch();
+  EXPECT_FALSE(dispatcher_->AddConnectionIdAlias(2, 1));
+
+  // Two idle epochs retire the alias; its ID then becomes available again.
+  dispatcher_->AdvanceConnectionIdAliasEpoch();
+  dispatcher_->AdvanceConnectionIdAliasEpoch();
+  EXPECT_TRUE(dispatcher_->AddConnectionIdAlias(2, 1));
+}
+
+TEST_F(QuicDispatcherTest, HibernateIdleConnection) {
+  CreateTimeWaitListManager();
+
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  server_address_ = QuicSocketAddress(QuicIpAddress::Any4(), 5);
+  QuicConnectionId connection_id = 1;
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(connection_id, client_address,
+                                              QuicStringPiece("hq")))
+      .WillOnce(testing::Return(CreateSession(
+          dispatcher_.get(), config_, connection_id, client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_)));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .WillOnce(testing::WithArgs<2>(Invoke(CreateFunctor(
+          &QuicDispatcherTest::ValidatePacket, base::Unretained(this), 1))));
+  EXPECT_CALL(*dispatcher_, ShouldCreateOrBufferPacketForConnection(1));
+  ProcessPacket(client_address, connection_id, true, SerializeCHLO());
+
+  // The session's connection runs on the test's mock clock, so it looks
+  // long idle against the dispatcher's clock and one sweep hibernates it.
+  // The ID must not enter time wait; a compact record replaces the session.
+  EXPECT_CALL(*time_wait_list_manager_, AddConnectionIdToTimeWait(_, _, _, _))
+      .Times(0);
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              CloseConnection(QUIC_NETWORK_IDLE_TIMEOUT, _,
+                              ConnectionCloseBehavior::SILENT_CLOSE));
+  dispatcher_->EnableHibernation(QuicTime::Delta::FromSeconds(10));
+  EXPECT_EQ(0u, dispatcher_->session_map().size());
+  EXPECT_EQ(1u, dispatcher_->num_hibernated_connections());
+
+  // A mid-connection packet for the hibernated ID is fast-failed through
+  // the time-wait machinery, prompting the client to re-handshake, and the
+  // record is dropped.
+  EXPECT_CALL(*time_wait_list_manager_,
+              AddConnectionIdToTimeWait(connection_id, _, false, _))
+      .Times(1);
+  EXPECT_CALL(*time_wait_list_manager_, ProcessPacket(_, _, connection_id))
+      .Times(1);
+  ProcessPacket(client_address, connection_id, false, "data");
+  EXPECT_EQ(0u, dispatcher_->num_hibernated_connections());
+}
+
 TEST_F(QuicDispatcherTest, NoVersionPacketToTimeWaitListManager) {
   CreateTimeWaitListManager();
 
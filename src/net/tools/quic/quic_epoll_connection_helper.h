@@ -15,6 +15,7 @@
 #include "net/quic/core/quic_connection.h"
 #include "net/quic/core/quic_packet_writer.h"
 #include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_pooled_buffer_allocator.h"
 #include "net/quic/core/quic_simple_buffer_allocator.h"
 #include "net/quic/core/quic_time.h"
 #include "net/tools/quic/platform/impl/quic_epoll_clock.h"
@@ -25,7 +26,7 @@ namespace net {
 class EpollServer;
 class QuicRandom;
 
-using QuicStreamBufferAllocator = SimpleBufferAllocator;
+using QuicStreamBufferAllocator = QuicPooledBufferAllocator;
 
 enum class QuicAllocator { SIMPLE, BUFFER_POOL };
 
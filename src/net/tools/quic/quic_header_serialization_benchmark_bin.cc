@@ -0,0 +1,70 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how many data packets per second QuicFramer::BuildDataPacket can
+// serialize for a steady-state short-header packet carrying a single stream
+// frame.  Used to compare header serialization changes (e.g. the prebuilt
+// header template) before and after.
+//
+// Usage: quic_header_serialization_benchmark [--iterations=<count>]
+//
+// Example output:
+// serialized 5000000 packets of 1302 bytes in 2.31 s: 2164502 packets/sec
+
+#include <cstdlib>
+#include <iostream>
+
+#include "base/command_line.h"
+#include "base/time/time.h"
+#include "net/quic/core/quic_framer.h"
+#include "net/quic/core/quic_packets.h"
+#include "net/quic/core/quic_utils.h"
+#include "net/quic/platform/api/quic_string_piece.h"
+
+int main(int argc, char* argv[]) {
+  base::CommandLine::Init(argc, argv);
+  base::CommandLine* line = base::CommandLine::ForCurrentProcess();
+
+  uint64_t iterations = 5 * 1000 * 1000;
+  if (line->HasSwitch("iterations")) {
+    iterations = std::strtoull(line->GetSwitchValueASCII("iterations").c_str(),
+                               nullptr, 10);
+  }
+
+  net::QuicFramer framer(net::AllSupportedVersions(), net::QuicTime::Zero(),
+                         net::Perspective::IS_CLIENT);
+
+  net::QuicPacketHeader header;
+  header.public_header.connection_id = UINT64_C(0x0123456789abcdef);
+  header.public_header.connection_id_length = net::PACKET_8BYTE_CONNECTION_ID;
+  header.public_header.reset_flag = false;
+  header.public_header.version_flag = false;
+  header.public_header.packet_number_length = net::PACKET_2BYTE_PACKET_NUMBER;
+
+  std::string payload(1280, 'p');
+  net::QuicStreamFrame stream_frame(5, false, 0, net::QuicStringPiece(payload));
+  net::QuicFrames frames;
+  frames.push_back(net::QuicFrame(&stream_frame));
+
+  char buffer[net::kMaxPacketSize];
+  size_t packet_size = 0;
+
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (uint64_t i = 0; i < iterations; ++i) {
+    header.packet_number = i + 1;
+    packet_size = framer.BuildDataPacket(header, frames, buffer,
+                                         net::kMaxPacketSize);
+    if (packet_size == 0) {
+      std::cerr << "BuildDataPacket failed at iteration " << i << "\n";
+      return 1;
+    }
+  }
+  const base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+
+  std::cout << "serialized " << iterations << " packets of " << packet_size
+            << " bytes in " << elapsed.InSecondsF() << " s: "
+            << static_cast<uint64_t>(iterations / elapsed.InSecondsF())
+            << " packets/sec" << std::endl;
+  return 0;
+}
@@ -4,6 +4,7 @@
 
 #include "net/tools/quic/quic_http_response_cache.h"
 
+#include <functional>
 #include <utility>
 
 #include "base/files/file_enumerator.h"
@@ -50,23 +51,36 @@ QuicHttpResponseCache::ResourceFile::ResourceFile(
 QuicHttpResponseCache::ResourceFile::~ResourceFile() {}
 
 void QuicHttpResponseCache::ResourceFile::Read() {
-  base::ReadFileToString(FilePath(file_name_), &file_contents_);
+  // Map the file rather than copying it, so large bodies consume address
+  // space instead of heap and fault in on demand when sent.
+  std::unique_ptr<base::MemoryMappedFile> mapping(new base::MemoryMappedFile);
+  QuicStringPiece contents;
+  if (mapping->Initialize(file_name_)) {
+    contents = QuicStringPiece(reinterpret_cast<const char*>(mapping->data()),
+                               mapping->length());
+    file_mapping_ = std::move(mapping);
+  } else {
+    // Mapping can fail, e.g. for empty files; fall back to reading the file
+    // into memory.
+    base::ReadFileToString(FilePath(file_name_), &file_contents_);
+    contents = QuicStringPiece(file_contents_);
+  }
 
   // First read the headers.
   size_t start = 0;
-  while (start < file_contents_.length()) {
-    size_t pos = file_contents_.find("\n", start);
-    if (pos == string::npos) {
+  while (start < contents.length()) {
+    size_t pos = contents.find("\n", start);
+    if (pos == QuicStringPiece::npos) {
       QUIC_LOG(DFATAL) << "Headers invalid or empty, ignoring: "
                        << file_name_.value();
       return;
     }
     size_t len = pos - start;
     // Support both dos and unix line endings for convenience.
-    if (file_contents_[pos - 1] == '\r') {
+    if (contents[pos - 1] == '\r') {
       len -= 1;
     }
-    QuicStringPiece line(file_contents_.data() + start, len);
+    QuicStringPiece line(contents.data() + start, len);
     start = pos + 1;
     // Headers end with an empty line.
     if (line.empty()) {
@@ -123,8 +137,7 @@ void QuicHttpResponseCache::ResourceFile::Read() {
     }
   }
 
-  body_ = QuicStringPiece(file_contents_.data() + start,
-                          file_contents_.size() - start);
+  body_ = contents.substr(start);
 }
 
 void QuicHttpResponseCache::ResourceFile::SetHostPathFromBase(
@@ -160,18 +173,22 @@ void QuicHttpResponseCache::ResourceFile::HandleXOriginalUrl() {
 const QuicHttpResponseCache::Response* QuicHttpResponseCache::GetResponse(
     QuicStringPiece host,
     QuicStringPiece path) const {
-  QuicWriterMutexLock lock(&response_mutex_);
-
-  auto it = responses_.find(GetKey(host, path));
-  if (it == responses_.end()) {
-    DVLOG(1) << "Get response for resource failed: host " << host << " path "
-             << path;
-    if (default_response_) {
-      return default_response_.get();
+  string key = GetKey(host, path);
+  const Shard& shard = GetShard(key);
+  {
+    QuicReaderMutexLock lock(&shard.mutex);
+    auto it = shard.responses.find(key);
+    if (it != shard.responses.end()) {
+      return it->second.get();
     }
-    return nullptr;
   }
-  return it->second.get();
+  DVLOG(1) << "Get response for resource failed: host " << host << " path "
+           << path;
+  QuicReaderMutexLock lock(&response_mutex_);
+  if (default_response_) {
+    return default_response_.get();
+  }
+  return nullptr;
 }
 
 typedef QuicHttpResponseCache::ServerPushInfo ServerPushInfo;
@@ -207,7 +224,8 @@ void QuicHttpResponseCache::AddResponse(QuicStringPiece host,
                                         SpdyHeaderBlock response_headers,
                                         QuicStringPiece response_body) {
   AddResponseImpl(host, path, REGULAR_RESPONSE, std::move(response_headers),
-                  response_body, SpdyHeaderBlock());
+                  response_body, SpdyHeaderBlock(), nullptr,
+                  /* replace_existing = */ false);
 }
 
 void QuicHttpResponseCache::AddResponse(QuicStringPiece host,
@@ -216,7 +234,8 @@ void QuicHttpResponseCache::AddResponse(QuicStringPiece host,
                                         QuicStringPiece response_body,
                                         SpdyHeaderBlock response_trailers) {
   AddResponseImpl(host, path, REGULAR_RESPONSE, std::move(response_headers),
-                  response_body, std::move(response_trailers));
+                  response_body, std::move(response_trailers), nullptr,
+                  /* replace_existing = */ false);
 }
 
 void QuicHttpResponseCache::AddSpecialResponse(
@@ -224,13 +243,23 @@ void QuicHttpResponseCache::AddSpecialResponse(
     QuicStringPiece path,
     SpecialResponseType response_type) {
   AddResponseImpl(host, path, response_type, SpdyHeaderBlock(), "",
-                  SpdyHeaderBlock());
+                  SpdyHeaderBlock(), nullptr, /* replace_existing = */ false);
 }
 
 QuicHttpResponseCache::QuicHttpResponseCache() {}
 
 void QuicHttpResponseCache::InitializeFromDirectory(
     const string& cache_directory) {
+  LoadFromDirectory(cache_directory, /* replace_existing = */ false);
+}
+
+void QuicHttpResponseCache::ReloadFromDirectory(
+    const string& cache_directory) {
+  LoadFromDirectory(cache_directory, /* replace_existing = */ true);
+}
+
+void QuicHttpResponseCache::LoadFromDirectory(const string& cache_directory,
+                                              bool replace_existing) {
   if (cache_directory.empty()) {
     QUIC_BUG << "cache_directory must not be empty.";
     return;
@@ -260,8 +289,13 @@ void QuicHttpResponseCache::InitializeFromDirectory(
     resource_file->SetHostPathFromBase(base);
     resource_file->Read();
 
-    AddResponse(resource_file->host(), resource_file->path(),
-                resource_file->spdy_headers().Clone(), resource_file->body());
+    // Hand the file mapping (if any) to the response, so the body is served
+    // from the mapped pages rather than a copy.
+    QuicStringPiece body = resource_file->body();
+    AddResponseImpl(resource_file->host(), resource_file->path(),
+                    REGULAR_RESPONSE, resource_file->spdy_headers().Clone(),
+                    body, SpdyHeaderBlock(), resource_file->ReleaseMapping(),
+                    replace_existing);
 
     resource_files.push_back(std::move(resource_file));
   }
@@ -286,7 +320,7 @@ void QuicHttpResponseCache::InitializeFromDirectory(
 
 std::list<ServerPushInfo> QuicHttpResponseCache::GetServerPushResources(
     string request_url) {
-  QuicWriterMutexLock lock(&response_mutex_);
+  QuicReaderMutexLock lock(&response_mutex_);
 
   std::list<ServerPushInfo> resources;
   auto resource_range = server_push_resources_.equal_range(request_url);
@@ -299,33 +333,58 @@ std::list<ServerPushInfo> QuicHttpResponseCache::GetServerPushResources(
 }
 
 QuicHttpResponseCache::~QuicHttpResponseCache() {
-  {
-    QuicWriterMutexLock lock(&response_mutex_);
-    responses_.clear();
+  for (Shard& shard : shards_) {
+    QuicWriterMutexLock lock(&shard.mutex);
+    shard.responses.clear();
+    shard.retired_responses.clear();
   }
 }
 
-void QuicHttpResponseCache::AddResponseImpl(QuicStringPiece host,
-                                            QuicStringPiece path,
-                                            SpecialResponseType response_type,
-                                            SpdyHeaderBlock response_headers,
-                                            QuicStringPiece response_body,
-                                            SpdyHeaderBlock response_trailers) {
-  QuicWriterMutexLock lock(&response_mutex_);
-
+void QuicHttpResponseCache::AddResponseImpl(
+    QuicStringPiece host,
+    QuicStringPiece path,
+    SpecialResponseType response_type,
+    SpdyHeaderBlock response_headers,
+    QuicStringPiece response_body,
+    SpdyHeaderBlock response_trailers,
+    std::unique_ptr<base::MemoryMappedFile> body_file,
+    bool replace_existing) {
   DCHECK(!host.empty()) << "Host must be populated, e.g. \"www.google.com\"";
   string key = GetKey(host, path);
-  if (QuicContainsKey(responses_, key)) {
-    QUIC_BUG << "Response for '" << key << "' already exists!";
-    return;
+  Shard& shard = GetShard(key);
+  QuicWriterMutexLock lock(&shard.mutex);
+  auto it = shard.responses.find(key);
+  if (it != shard.responses.end()) {
+    if (!replace_existing) {
+      QUIC_BUG << "Response for '" << key << "' already exists!";
+      return;
+    }
+    // Streams in flight may still reference the old response's body, so
+    // retire it rather than freeing it.
+    shard.retired_responses.push_back(std::move(it->second));
+    shard.responses.erase(it);
   }
   auto new_response = QuicMakeUnique<Response>();
   new_response->set_response_type(response_type);
   new_response->set_headers(std::move(response_headers));
-  new_response->set_body(response_body);
+  if (body_file != nullptr) {
+    new_response->set_body(std::move(body_file), response_body);
+  } else {
+    new_response->set_body(response_body);
+  }
   new_response->set_trailers(std::move(response_trailers));
   QUIC_DVLOG(1) << "Add response with key " << key;
-  responses_[key] = std::move(new_response);
+  shard.responses[key] = std::move(new_response);
+}
+
+QuicHttpResponseCache::Shard& QuicHttpResponseCache::GetShard(
+    const string& key) {
+  return shards_[std::hash<string>()(key) % kNumShards];
+}
+
+const QuicHttpResponseCache::Shard& QuicHttpResponseCache::GetShard(
+    const string& key) const {
+  return shards_[std::hash<string>()(key) % kNumShards];
 }
 
 string QuicHttpResponseCache::GetKey(QuicStringPiece host,
@@ -360,8 +419,10 @@ void QuicHttpResponseCache::MaybeAddServerPushResources(
     string path = push_resource.request_url.path();
     bool found_existing_response = false;
     {
-      QuicWriterMutexLock lock(&response_mutex_);
-      found_existing_response = QuicContainsKey(responses_, GetKey(host, path));
+      string key = GetKey(host, path);
+      const Shard& shard = GetShard(key);
+      QuicReaderMutexLock lock(&shard.mutex);
+      found_existing_response = QuicContainsKey(shard.responses, key);
     }
     if (!found_existing_response) {
       // Add a server push response to responses map, if it is not in the map.
@@ -376,7 +437,7 @@ void QuicHttpResponseCache::MaybeAddServerPushResources(
 bool QuicHttpResponseCache::PushResourceExistsInCache(
     string original_request_url,
     ServerPushInfo resource) {
-  QuicWriterMutexLock lock(&response_mutex_);
+  QuicReaderMutexLock lock(&response_mutex_);
   auto resource_range =
       server_push_resources_.equal_range(original_request_url);
   for (auto it = resource_range.first; it != resource_range.second; ++it) {
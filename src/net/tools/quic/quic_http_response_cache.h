@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/macros.h"
 #include "net/quic/core/spdy_utils.h"
 #include "net/quic/platform/api/quic_containers.h"
@@ -56,7 +57,9 @@ class QuicHttpResponseCache {
     SpecialResponseType response_type() const { return response_type_; }
     const SpdyHeaderBlock& headers() const { return headers_; }
     const SpdyHeaderBlock& trailers() const { return trailers_; }
-    const QuicStringPiece body() const { return QuicStringPiece(body_); }
+    const QuicStringPiece body() const {
+      return body_file_ != nullptr ? mapped_body_ : QuicStringPiece(body_);
+    }
 
     void set_response_type(SpecialResponseType response_type) {
       response_type_ = response_type;
@@ -66,14 +69,26 @@ class QuicHttpResponseCache {
       trailers_ = std::move(trailers);
     }
     void set_body(QuicStringPiece body) {
+      body_file_.reset();
       body_.assign(body.data(), body.size());
     }
+    // Backs the body with |body_file|, a memory mapping of the on-disk
+    // resource, instead of copying it.  |body| must point into the mapping;
+    // its pages are faulted in on demand as the body is sent.
+    void set_body(std::unique_ptr<base::MemoryMappedFile> body_file,
+                  QuicStringPiece body) {
+      body_file_ = std::move(body_file);
+      mapped_body_ = body;
+    }
 
    private:
     SpecialResponseType response_type_;
     SpdyHeaderBlock headers_;
     SpdyHeaderBlock trailers_;
     std::string body_;
+    // When set, the body is served from this mapping rather than |body_|.
+    std::unique_ptr<base::MemoryMappedFile> body_file_;
+    QuicStringPiece mapped_body_;
 
     DISALLOW_COPY_AND_ASSIGN(Response);
   };
@@ -106,6 +121,13 @@ class QuicHttpResponseCache {
 
     const std::vector<QuicStringPiece>& push_urls() { return push_urls_; }
 
+    // Transfers ownership of the memory mapping backing body(), if Read()
+    // mapped the file rather than copying it.  Returns nullptr otherwise.
+    // Once released, body() remains valid only as long as the mapping lives.
+    std::unique_ptr<base::MemoryMappedFile> ReleaseMapping() {
+      return std::move(file_mapping_);
+    }
+
    protected:
     void HandleXOriginalUrl();
     void HandlePushUrls(const std::vector<QuicStringPiece>& push_urls);
@@ -114,6 +136,9 @@ class QuicHttpResponseCache {
     const std::string cache_directory_;
     const base::FilePath file_name_;
     const std::string file_name_string_;
+    // Set by Read(): the file is mapped into |file_mapping_| when possible,
+    // and copied into |file_contents_| only as a fallback.
+    std::unique_ptr<base::MemoryMappedFile> file_mapping_;
     std::string file_contents_;
     QuicStringPiece body_;
     SpdyHeaderBlock spdy_headers_;
@@ -178,16 +203,56 @@ class QuicHttpResponseCache {
   // |cache_cirectory| can be generated using `wget -p --save-headers <url>`.
   void InitializeFromDirectory(const std::string& cache_directory);
 
+  // Re-reads |cache_directory| as InitializeFromDirectory() does, replacing
+  // responses already in the cache so that changed files take effect without
+  // a restart.  Replaced responses are kept alive until the cache is
+  // destroyed, since in-flight streams may still reference their bodies.
+  void ReloadFromDirectory(const std::string& cache_directory);
+
   // Find all the server push resources associated with |request_url|.
   std::list<ServerPushInfo> GetServerPushResources(std::string request_url);
 
  private:
+  // Responses are partitioned across this many shards by a hash of their
+  // cache key, so that a lookup takes only the owning shard's reader lock
+  // and an insertion blocks lookups in that shard alone.
+  static const size_t kNumShards = 16;
+
+  // One partition of the cached responses and the lock guarding it.
+  struct Shard {
+    mutable QuicMutex mutex;
+
+    // Responses in this shard, keyed as in GetKey().
+    QuicUnorderedMap<std::string, std::unique_ptr<Response>> responses
+        GUARDED_BY(mutex);
+
+    // Responses displaced by ReloadFromDirectory().  In-flight streams may
+    // still reference their bodies, so they are retired here and freed only
+    // when the cache is destroyed.
+    std::vector<std::unique_ptr<Response>> retired_responses GUARDED_BY(mutex);
+  };
+
+  // |body_file|, if non-null, is a memory mapping which |response_body|
+  // points into; the response then serves the body from the mapping without
+  // copying it.  If |replace_existing| is true an existing response with the
+  // same key is retired and replaced instead of triggering a QUIC_BUG.
   void AddResponseImpl(QuicStringPiece host,
                        QuicStringPiece path,
                        SpecialResponseType response_type,
                        SpdyHeaderBlock response_headers,
                        QuicStringPiece response_body,
-                       SpdyHeaderBlock response_trailers);
+                       SpdyHeaderBlock response_trailers,
+                       std::unique_ptr<base::MemoryMappedFile> body_file,
+                       bool replace_existing);
+
+  // Shared implementation of InitializeFromDirectory() and
+  // ReloadFromDirectory().  Responses are published one at a time, as their
+  // files are parsed, so lookups can be served while a scan is in progress.
+  void LoadFromDirectory(const std::string& cache_directory,
+                         bool replace_existing);
+
+  Shard& GetShard(const std::string& key);
+  const Shard& GetShard(const std::string& key) const;
 
   std::string GetKey(QuicStringPiece host, QuicStringPiece path) const;
 
@@ -202,9 +267,8 @@ class QuicHttpResponseCache {
   bool PushResourceExistsInCache(std::string original_request_url,
                                  ServerPushInfo resource);
 
-  // Cached responses.
-  QuicUnorderedMap<std::string, std::unique_ptr<Response>> responses_
-      GUARDED_BY(response_mutex_);
+  // Cached responses, sharded by key hash.
+  Shard shards_[kNumShards];
 
   // The default response for cache misses, if set.
   std::unique_ptr<Response> default_response_ GUARDED_BY(response_mutex_);
@@ -213,8 +277,9 @@ class QuicHttpResponseCache {
   std::multimap<std::string, ServerPushInfo> server_push_resources_
       GUARDED_BY(response_mutex_);
 
-  // Protects against concurrent access from test threads setting responses, and
-  // server threads accessing those responses.
+  // Guards the default response and the server push map against concurrent
+  // access from test threads setting responses, and server threads accessing
+  // those responses.
   mutable QuicMutex response_mutex_;
 
   DISALLOW_COPY_AND_ASSIGN(QuicHttpResponseCache);
@@ -10,12 +10,19 @@
 #include <features.h>
 #endif
 #include <string.h>
+#if defined(__linux__)
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+#endif
 
+#include "base/time/time.h"
 #include "net/quic/platform/api/quic_bug_tracker.h"
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
 #include "net/quic/platform/api/quic_socket_address.h"
+#include "net/socket/udp_socket_performance_watcher.h"
 #include "net/tools/quic/platform/impl/quic_socket_utils.h"
+#include "net/tools/quic/quic_coalesced_datagram.h"
 #include "net/tools/quic/quic_dispatcher.h"
 #include "net/tools/quic/quic_process_packet_interface.h"
 
@@ -26,7 +33,8 @@
 namespace net {
 
 
-QuicPacketReader::QuicPacketReader() {
+QuicPacketReader::QuicPacketReader()
+    : performance_watcher_(nullptr), buffer_pool_(kPacketBufferPoolSize) {
   Initialize();
 }
 
@@ -36,11 +44,11 @@ void QuicPacketReader::Initialize() {
   memset(mmsg_hdr_, 0, sizeof(mmsg_hdr_));
 
   for (int i = 0; i < kNumPacketsPerReadMmsgCall; ++i) {
-    packets_[i].iov.iov_base = packets_[i].buf;
-    packets_[i].iov.iov_len = kMaxPacketSize;
+    packets_[i].buf = buffer_pool_.HandOut();
+    packets_[i].iov.iov_base = packets_[i].buf->data();
+    packets_[i].iov.iov_len = packets_[i].buf->capacity();
     memset(&packets_[i].raw_address, 0, sizeof(packets_[i].raw_address));
     memset(packets_[i].cbuf, 0, sizeof(packets_[i].cbuf));
-    memset(packets_[i].buf, 0, sizeof(packets_[i].buf));
 
     msghdr* hdr = &mmsg_hdr_[i].msg_hdr;
     hdr->msg_name = &packets_[i].raw_address;
@@ -54,7 +62,13 @@ void QuicPacketReader::Initialize() {
 #endif
 }
 
-QuicPacketReader::~QuicPacketReader() {}
+QuicPacketReader::~QuicPacketReader() {
+#if MMSG_MORE
+  for (int i = 0; i < kNumPacketsPerReadMmsgCall; ++i) {
+    packets_[i].buf->Release();
+  }
+#endif
+}
 
 bool QuicPacketReader::ReadAndDispatchPackets(
     int fd,
@@ -62,6 +76,9 @@ bool QuicPacketReader::ReadAndDispatchPackets(
     const QuicClock& clock,
     ProcessPacketInterface* processor,
     QuicPacketCount* packets_dropped) {
+  if (performance_watcher_ != nullptr) {
+    SampleSocketQueueDepths(fd);
+  }
 #if MMSG_MORE
   return ReadAndDispatchManyPackets(fd, port, clock, processor,
                                     packets_dropped);
@@ -71,6 +88,19 @@ bool QuicPacketReader::ReadAndDispatchPackets(
 #endif
 }
 
+void QuicPacketReader::SampleSocketQueueDepths(int fd) {
+#if defined(__linux__)
+  int send_queue_bytes = 0;
+  int receive_queue_bytes = 0;
+  if (ioctl(fd, SIOCOUTQ, &send_queue_bytes) != 0 ||
+      ioctl(fd, SIOCINQ, &receive_queue_bytes) != 0) {
+    return;
+  }
+  performance_watcher_->OnQueueDepthSample(send_queue_bytes,
+                                           receive_queue_bytes);
+#endif
+}
+
 bool QuicPacketReader::ReadAndDispatchManyPackets(
     int fd,
     int port,
@@ -87,8 +117,25 @@ bool QuicPacketReader::ReadAndDispatchManyPackets(
     hdr->msg_controllen = QuicSocketUtils::kSpaceForCmsg;
   }
 
+  base::TimeTicks syscall_start;
+  if (performance_watcher_ != nullptr) {
+    syscall_start = base::TimeTicks::Now();
+  }
   int packets_read =
       recvmmsg(fd, mmsg_hdr_, kNumPacketsPerReadMmsgCall, 0, nullptr);
+  if (performance_watcher_ != nullptr) {
+    const base::TimeDelta syscall_duration =
+        base::TimeTicks::Now() - syscall_start;
+    if (packets_read > 0) {
+      int bytes_read = 0;
+      for (int i = 0; i < packets_read; ++i) {
+        bytes_read += mmsg_hdr_[i].msg_len;
+      }
+      performance_watcher_->OnReadResult(bytes_read, syscall_duration);
+    } else {
+      performance_watcher_->OnReadResult(-errno, syscall_duration);
+    }
+  }
 
   if (packets_read <= 0) {
     return false;  // recvmmsg failed.
@@ -130,16 +177,42 @@ bool QuicPacketReader::ReadAndDispatchManyPackets(
     int ttl = 0;
     bool has_ttl =
         QuicSocketUtils::GetTtlFromMsghdr(&mmsg_hdr_[i].msg_hdr, &ttl);
-    QuicReceivedPacket packet(reinterpret_cast<char*>(packets_[i].iov.iov_base),
-                              mmsg_hdr_[i].msg_len, timestamp, false, ttl,
-                              has_ttl);
-    QuicSocketAddress server_address(server_ip, port);
-    processor->ProcessPacket(server_address, client_address, packet);
+    QuicEcnCodepoint ecn = ECN_NOT_ECT;
+    QuicSocketUtils::GetEcnFromMsghdr(&mmsg_hdr_[i].msg_hdr, &ecn);
+    {
+      QuicSocketAddress server_address(server_ip, port);
+      if (IsCoalescedDatagram(packets_[i].buf->data(), mmsg_hdr_[i].msg_len)) {
+        DispatchCoalescedDatagram(packets_[i].buf->data(), mmsg_hdr_[i].msg_len,
+                                  timestamp, ttl, has_ttl, ecn, server_address,
+                                  client_address, processor);
+      } else {
+        QuicReceivedPacket packet(packets_[i].buf, mmsg_hdr_[i].msg_len,
+                                  timestamp, ttl, has_ttl);
+        packet.set_ecn_codepoint(ecn);
+        processor->ProcessPacket(server_address, client_address, packet);
+      }
+    }
+
+    if (packets_[i].buf->ref_count() > 1) {
+      // The processor retained a reference (e.g. the packet was parked in
+      // the buffered packet store); give the ring slot a fresh buffer.
+      packets_[i].buf->Release();
+      packets_[i].buf = buffer_pool_.HandOut();
+      packets_[i].iov.iov_base = packets_[i].buf->data();
+      packets_[i].iov.iov_len = packets_[i].buf->capacity();
+    }
   }
 
   if (packets_dropped != nullptr) {
-    QuicSocketUtils::GetOverflowFromMsghdr(&mmsg_hdr_[0].msg_hdr,
-                                           packets_dropped);
+    // The SO_RXQ_OVFL counter is cumulative and the kernel does not attach
+    // the cmsg to every message, so scan backwards and take the most recent
+    // value in the batch instead of only consulting the first slot.
+    for (int i = packets_read - 1; i >= 0; --i) {
+      if (QuicSocketUtils::GetOverflowFromMsghdr(&mmsg_hdr_[i].msg_hdr,
+                                                 packets_dropped)) {
+        break;
+      }
+    }
   }
 
   // We may not have read all of the packets available on the socket.
@@ -150,26 +223,36 @@ bool QuicPacketReader::ReadAndDispatchManyPackets(
 #endif
 }
 
-/* static */
 bool QuicPacketReader::ReadAndDispatchSinglePacket(
     int fd,
     int port,
     const QuicClock& clock,
     ProcessPacketInterface* processor,
     QuicPacketCount* packets_dropped) {
-  char buf[kMaxPacketSize];
+  QuicPacketBuffer* buf = buffer_pool_.HandOut();
 
   QuicSocketAddress client_address;
   QuicIpAddress server_ip;
   QuicWallTime walltimestamp = QuicWallTime::Zero();
+  base::TimeTicks syscall_start;
+  if (performance_watcher_ != nullptr) {
+    syscall_start = base::TimeTicks::Now();
+  }
   int bytes_read =
-      QuicSocketUtils::ReadPacket(fd, buf, arraysize(buf), packets_dropped,
-                                  &server_ip, &walltimestamp, &client_address);
+      QuicSocketUtils::ReadPacket(fd, buf->data(), buf->capacity(),
+                                  packets_dropped, &server_ip, &walltimestamp,
+                                  &client_address);
+  if (performance_watcher_ != nullptr) {
+    performance_watcher_->OnReadResult(bytes_read >= 0 ? bytes_read : -errno,
+                                       base::TimeTicks::Now() - syscall_start);
+  }
   if (bytes_read < 0) {
+    buf->Release();
     return false;  // ReadPacket failed.
   }
 
   if (!server_ip.IsInitialized()) {
+    buf->Release();
     QUIC_BUG << "Unable to get server address.";
     return false;
   }
@@ -180,14 +263,52 @@ bool QuicPacketReader::ReadAndDispatchSinglePacket(
   }
   QuicTime timestamp = clock.ConvertWallTimeToQuicTime(walltimestamp);
 
-  QuicReceivedPacket packet(buf, bytes_read, timestamp, false);
-  QuicSocketAddress server_address(server_ip, port);
-  processor->ProcessPacket(server_address, client_address, packet);
+  {
+    QuicSocketAddress server_address(server_ip, port);
+    if (IsCoalescedDatagram(buf->data(), bytes_read)) {
+      DispatchCoalescedDatagram(buf->data(), bytes_read, timestamp, /*ttl=*/0,
+                                /*has_ttl=*/false, ECN_NOT_ECT, server_address,
+                                client_address, processor);
+    } else {
+      QuicReceivedPacket packet(buf, bytes_read, timestamp, 0,
+                                /*ttl_valid=*/false);
+      processor->ProcessPacket(server_address, client_address, packet);
+    }
+  }
+  buf->Release();
 
   // The socket read was successful, so return true even if packet dispatch
   // failed.
   return true;
 }
 
+bool QuicPacketReader::DispatchCoalescedDatagram(
+    const char* data,
+    size_t length,
+    QuicTime timestamp,
+    int ttl,
+    bool has_ttl,
+    QuicEcnCodepoint ecn,
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address,
+    ProcessPacketInterface* processor) {
+  std::vector<QuicStringPiece> packets;
+  if (!SplitCoalescedDatagram(data, length, &packets)) {
+    QUIC_DLOG(WARNING) << "Dropping malformed coalesced datagram of " << length
+                       << " bytes from " << client_address.ToString();
+    return false;
+  }
+  for (const QuicStringPiece& piece : packets) {
+    // Sub-packets reference the datagram buffer; consumers which keep a
+    // packet past dispatch copy it (QuicReceivedPacket::Clone), so the
+    // pooled-buffer fast path does not apply here.
+    QuicReceivedPacket packet(piece.data(), piece.length(), timestamp,
+                              /*owns_buffer=*/false, ttl, has_ttl);
+    packet.set_ecn_codepoint(ecn);
+    processor->ProcessPacket(server_address, client_address, packet);
+  }
+  return true;
+}
+
 
 }  // namespace net
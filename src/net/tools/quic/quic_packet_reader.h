@@ -13,6 +13,7 @@
 #include <sys/socket.h>
 
 #include "base/macros.h"
+#include "net/quic/core/quic_packet_buffer_pool.h"
 #include "net/quic/core/quic_packets.h"
 #include "net/quic/platform/api/quic_clock.h"
 #include "net/quic/platform/api/quic_socket_address.h"
@@ -28,12 +29,27 @@ namespace net {
 const int kNumPacketsPerReadMmsgCall = 16;
 #endif
 
+// Upper bound on released packet buffers the reader's pool retains for
+// reuse. Sized for a few full recvmmsg rings' worth of packets parked in
+// the buffered packet store.
+const size_t kPacketBufferPoolSize = 64;
+
+class UDPSocketPerformanceWatcher;
+
 class QuicPacketReader {
  public:
   QuicPacketReader();
 
   virtual ~QuicPacketReader();
 
+  // Sets the watcher notified after each receive syscall, and fed kernel
+  // queue depth samples once per ReadAndDispatchPackets() call. The watcher
+  // is not owned and must outlive this reader. May be null (the default), in
+  // which case no per-read instrumentation is done.
+  void set_performance_watcher(UDPSocketPerformanceWatcher* watcher) {
+    performance_watcher_ = watcher;
+  }
+
   // Reads a number of packets from the given fd, and then passes them off to
   // the PacketProcessInterface.  Returns true if there may be additional
   // packets available on the socket.
@@ -59,11 +75,37 @@ class QuicPacketReader {
                                   QuicPacketCount* packets_dropped);
 
   // Reads and dispatches a single packet using recvmsg.
-  static bool ReadAndDispatchSinglePacket(int fd,
-                                          int port,
-                                          const QuicClock& clock,
-                                          ProcessPacketInterface* processor,
-                                          QuicPacketCount* packets_dropped);
+  bool ReadAndDispatchSinglePacket(int fd,
+                                   int port,
+                                   const QuicClock& clock,
+                                   ProcessPacketInterface* processor,
+                                   QuicPacketCount* packets_dropped);
+
+  // Reports the kernel send and receive queue depths of |fd| to
+  // |performance_watcher_|, on platforms where they can be queried.
+  void SampleSocketQueueDepths(int fd);
+
+  // Dispatches the packets carried by a coalesced datagram (see
+  // quic_coalesced_datagram.h), each under the datagram's timestamp and
+  // ancillary data. Returns false without dispatching anything if the
+  // datagram is malformed.
+  bool DispatchCoalescedDatagram(const char* data,
+                                 size_t length,
+                                 QuicTime timestamp,
+                                 int ttl,
+                                 bool has_ttl,
+                                 QuicEcnCodepoint ecn,
+                                 const QuicSocketAddress& server_address,
+                                 const QuicSocketAddress& client_address,
+                                 ProcessPacketInterface* processor);
+
+  // Notified of read results and queue depth samples. Not owned.
+  UDPSocketPerformanceWatcher* performance_watcher_;
+
+  // Hands out the refcounted buffers the kernel reads packets into;
+  // consumers which need to keep a packet past dispatch (e.g.
+  // QuicBufferedPacketStore) retain a reference instead of copying.
+  QuicPacketBufferPool buffer_pool_;
 
   // Storage only used when recvmmsg is available.
 
@@ -80,8 +122,10 @@ class QuicPacketReader {
     struct sockaddr_storage raw_address;
     // cbuf is used for ancillary data from the kernel on recvmmsg.
     char cbuf[QuicSocketUtils::kSpaceForCmsg];
-    // buf is used for the data read from the kernel on recvmmsg.
-    char buf[kMaxPacketSize];
+    // buf is the pooled buffer the kernel reads this slot's packet into.
+    // The reader holds one reference; the slot is swapped for a fresh
+    // buffer after dispatch if anyone else retained a reference.
+    QuicPacketBuffer* buf;
   };
   PacketData packets_[kNumPacketsPerReadMmsgCall];
   mmsghdr mmsg_hdr_[kNumPacketsPerReadMmsgCall];
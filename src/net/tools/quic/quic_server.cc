@@ -11,9 +11,12 @@
 #include <sys/epoll.h>
 #include <sys/socket.h>
 
+#include <algorithm>
 #include <memory>
 
 #include "net/quic/core/crypto/crypto_handshake.h"
+#include "net/quic/core/crypto/offloading_proof_source.h"
+#include "net/quic/core/crypto/precomputed_ephemeral_key_source.h"
 #include "net/quic/core/crypto/quic_random.h"
 #include "net/quic/core/quic_crypto_stream.h"
 #include "net/quic/core/quic_data_reader.h"
@@ -23,6 +26,8 @@
 #include "net/quic/platform/api/quic_logging.h"
 #include "net/tools/quic/platform/impl/quic_epoll_clock.h"
 #include "net/tools/quic/platform/impl/quic_socket_utils.h"
+#include "net/tools/quic/quic_batch_packet_writer.h"
+#include "net/tools/quic/quic_crypto_worker_pool.h"
 #include "net/tools/quic/quic_dispatcher.h"
 #include "net/tools/quic/quic_epoll_alarm_factory.h"
 #include "net/tools/quic/quic_epoll_connection_helper.h"
@@ -30,6 +35,7 @@
 #include "net/tools/quic/quic_packet_reader.h"
 #include "net/tools/quic/quic_simple_crypto_server_stream_helper.h"
 #include "net/tools/quic/quic_simple_dispatcher.h"
+#include "net/tools/quic/quic_timer_wheel_alarm_factory.h"
 
 #ifndef SO_RXQ_OVFL
 #define SO_RXQ_OVFL 40
@@ -47,6 +53,10 @@ std::string FLAGS_quic_response_cache_dir = "";
 const int kEpollFlags = EPOLLIN | EPOLLOUT | EPOLLET;
 const char kSourceAddressTokenSecret[] = "secret";
 
+// Bound on handshakes waiting for a crypto worker; beyond this, handshakes
+// fall back to synchronous processing on the dispatcher thread.
+const size_t kMaxPendingCryptoWork = 256;
+
 }  // namespace
 
 const size_t kNumSessionsToCreatePerSocketEvent = 16;
@@ -69,11 +79,16 @@ QuicServer::QuicServer(
       fd_(-1),
       packets_dropped_(0),
       overflow_supported_(false),
+      packets_dropped_at_last_check_(0),
+      packets_dropped_at_last_notify_(0),
+      current_rcvbuf_bytes_(0),
+      rcvbuf_resizes_(0),
       silent_close_(false),
+      reuse_port_(false),
       config_(config),
       crypto_config_(kSourceAddressTokenSecret,
                      QuicRandom::GetInstance(),
-                     std::move(proof_source)),
+                     MaybeOffloadProofSource(std::move(proof_source))),
       crypto_config_options_(crypto_config_options),
       version_manager_(supported_versions),
       packet_reader_(new QuicPacketReader()),
@@ -81,6 +96,17 @@ QuicServer::QuicServer(
   Initialize();
 }
 
+std::unique_ptr<ProofSource> QuicServer::MaybeOffloadProofSource(
+    std::unique_ptr<ProofSource> proof_source) {
+  if (FLAGS_quic_server_crypto_worker_threads <= 0) {
+    return proof_source;
+  }
+  std::unique_ptr<OffloadingProofSource> offloading(
+      new OffloadingProofSource(std::move(proof_source)));
+  offloading_proof_source_ = offloading.get();
+  return std::move(offloading);
+}
+
 void QuicServer::Initialize() {
   // If an initial flow control window has not explicitly been set, then use a
   // sensible value for a server: 1 MB for session, 64 KB for each stream.
@@ -98,11 +124,30 @@ void QuicServer::Initialize() {
   }
 
   epoll_server_.set_timeout_in_us(50 * 1000);
+  if (FLAGS_quic_server_busy_poll_budget_us > 0) {
+    epoll_server_.set_busy_poll_budget_in_us(
+        FLAGS_quic_server_busy_poll_budget_us);
+  }
 
   if (!FLAGS_quic_response_cache_dir.empty()) {
     response_cache_->InitializeFromDirectory(FLAGS_quic_response_cache_dir);
   }
 
+  if (FLAGS_quic_server_crypto_worker_threads > 0) {
+    crypto_worker_pool_.reset(new QuicCryptoWorkerPool(
+        &epoll_server_, FLAGS_quic_server_crypto_worker_threads,
+        kMaxPendingCryptoWork));
+    if (offloading_proof_source_ != nullptr) {
+      offloading_proof_source_->set_crypto_worker(crypto_worker_pool_.get());
+    }
+  }
+
+  if (FLAGS_quic_server_precomputed_key_shares) {
+    crypto_config_.SetEphemeralKeySource(
+        std::unique_ptr<EphemeralKeySource>(
+            new PrecomputedEphemeralKeySource(crypto_worker_pool_.get())));
+  }
+
   QuicEpollClock clock(&epoll_server_);
 
   std::unique_ptr<CryptoHandshakeMessage> scfg(crypto_config_.AddDefaultConfig(
@@ -118,6 +163,21 @@ bool QuicServer::CreateUDPSocketAndListen(const QuicSocketAddress& address) {
     return false;
   }
 
+  const int granted_rcvbuf = QuicSocketUtils::GetReceiveBufferSize(fd_);
+  current_rcvbuf_bytes_ =
+      granted_rcvbuf > 0 ? granted_rcvbuf : kDefaultSocketReceiveBuffer;
+
+  if (FLAGS_quic_server_busy_poll_budget_us > 0 &&
+      QuicSocketUtils::SetBusyPoll(
+          fd_, FLAGS_quic_server_busy_poll_budget_us) < 0) {
+    QUIC_DLOG(WARNING) << "SO_BUSY_POLL not supported";
+  }
+
+  if (reuse_port_ && QuicSocketUtils::SetReusePort(fd_) < 0) {
+    QUIC_LOG(ERROR) << "SetReusePort() failed: " << strerror(errno);
+    return false;
+  }
+
   sockaddr_storage addr = address.generic_address();
   int rc = bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
   if (rc < 0) {
@@ -142,21 +202,33 @@ bool QuicServer::CreateUDPSocketAndListen(const QuicSocketAddress& address) {
   return true;
 }
 
+bool QuicServer::AttachShardingFilter(size_t num_shards) {
+  DCHECK_GE(fd_, 0) << "AttachShardingFilter called before listen";
+  return QuicSocketUtils::AttachShardingFilter(fd_, num_shards);
+}
+
 QuicDefaultPacketWriter* QuicServer::CreateWriter(int fd) {
+  if (FLAGS_quic_use_batched_packet_writer) {
+    return new QuicBatchPacketWriter(fd);
+  }
   return new QuicDefaultPacketWriter(fd);
 }
 
 QuicDispatcher* QuicServer::CreateQuicDispatcher() {
-  QuicEpollAlarmFactory alarm_factory(&epoll_server_);
+  std::unique_ptr<QuicAlarmFactory> alarm_factory;
+  if (FLAGS_quic_use_timer_wheel_alarms) {
+    alarm_factory.reset(new QuicTimerWheelAlarmFactory(&epoll_server_));
+  } else {
+    alarm_factory.reset(new QuicEpollAlarmFactory(&epoll_server_));
+  }
+  std::unique_ptr<QuicSimpleCryptoServerStreamHelper> session_helper(
+      new QuicSimpleCryptoServerStreamHelper(QuicRandom::GetInstance()));
+  session_helper->set_crypto_worker(crypto_worker_pool_.get());
   return new QuicSimpleDispatcher(
       config_, &crypto_config_, &version_manager_,
       std::unique_ptr<QuicEpollConnectionHelper>(new QuicEpollConnectionHelper(
           &epoll_server_, QuicAllocator::BUFFER_POOL)),
-      std::unique_ptr<QuicCryptoServerStream::Helper>(
-          new QuicSimpleCryptoServerStreamHelper(QuicRandom::GetInstance())),
-      std::unique_ptr<QuicEpollAlarmFactory>(
-          new QuicEpollAlarmFactory(&epoll_server_)),
-      response_cache_);
+      std::move(session_helper), std::move(alarm_factory), response_cache_);
 }
 
 void QuicServer::WaitForEvents() {
@@ -164,6 +236,11 @@ void QuicServer::WaitForEvents() {
 }
 
 void QuicServer::Shutdown() {
+  if (crypto_worker_pool_ != nullptr) {
+    // Join the crypto workers and run their pending completions while the
+    // dispatcher's sessions are still alive to receive them.
+    crypto_worker_pool_->Shutdown();
+  }
   if (!silent_close_) {
     // Before we shut down the epoll server, give all active sessions a chance
     // to notify clients that they're closing.
@@ -192,6 +269,18 @@ void QuicServer::OnEvent(int fd, EpollEvent* event) {
           overflow_supported_ ? &packets_dropped_ : nullptr);
     }
 
+    // Responses generated while dispatching the packets read above may still
+    // be sitting in a batching writer.
+    dispatcher_->writer()->Flush();
+
+    if (packets_dropped_ > packets_dropped_at_last_notify_) {
+      dispatcher_->OnKernelPacketsDropped(packets_dropped_ -
+                                          packets_dropped_at_last_notify_);
+      packets_dropped_at_last_notify_ = packets_dropped_;
+    }
+
+    MaybeGrowReceiveBuffer();
+
     if (FLAGS_quic_reloadable_flag_quic_limit_num_new_sessions_per_epoll_loop &&
         dispatcher_->HasChlosBuffered()) {
       // Register EPOLLIN event to consume buffered CHLO(s).
@@ -208,4 +297,53 @@ void QuicServer::OnEvent(int fd, EpollEvent* event) {
   }
 }
 
+void QuicServer::MaybeGrowReceiveBuffer() {
+  if (!FLAGS_quic_server_rcvbuf_autotune || !overflow_supported_) {
+    return;
+  }
+  if (packets_dropped_ == packets_dropped_at_last_check_) {
+    return;
+  }
+  const QuicPacketCount new_drops =
+      packets_dropped_ - packets_dropped_at_last_check_;
+  packets_dropped_at_last_check_ = packets_dropped_;
+
+  const size_t max_rcvbuf =
+      static_cast<size_t>(FLAGS_quic_server_max_rcvbuf_bytes);
+  if (current_rcvbuf_bytes_ >= max_rcvbuf) {
+    QUIC_DLOG(WARNING) << "Kernel dropped " << new_drops
+                       << " packets with SO_RCVBUF already at its cap of "
+                       << max_rcvbuf << " bytes";
+    return;
+  }
+
+  // Grow to the larger of double the current size and the aggregate BDP of
+  // the active connections: burst size scales with how much data peers can
+  // legitimately have in flight toward this socket.
+  uint64_t aggregate_bdp = 0;
+  for (auto& kv : dispatcher_->session_map()) {
+    const QuicConnectionStats& stats = kv.second->connection()->GetStats();
+    if (stats.min_rtt_us > 0) {
+      aggregate_bdp += stats.estimated_bandwidth.ToBytesPerPeriod(
+          QuicTime::Delta::FromMicroseconds(stats.min_rtt_us));
+    }
+  }
+  const uint64_t target =
+      std::min<uint64_t>(std::max<uint64_t>(2 * current_rcvbuf_bytes_,
+                                            aggregate_bdp),
+                         max_rcvbuf);
+  if (target <= current_rcvbuf_bytes_ ||
+      !QuicSocketUtils::SetReceiveBufferSize(fd_, target)) {
+    return;
+  }
+  // The kernel rounds (and typically doubles) the requested size; record
+  // what it actually granted.
+  const int granted = QuicSocketUtils::GetReceiveBufferSize(fd_);
+  current_rcvbuf_bytes_ = granted > 0 ? granted : target;
+  ++rcvbuf_resizes_;
+  QUIC_LOG(INFO) << "Grew SO_RCVBUF to " << current_rcvbuf_bytes_
+                 << " bytes after " << new_drops << " kernel drops (resize #"
+                 << rcvbuf_resizes_ << ")";
+}
+
 }  // namespace net
@@ -30,6 +30,8 @@ namespace test {
 class QuicServerPeer;
 }  // namespace test
 
+class OffloadingProofSource;
+class QuicCryptoWorkerPool;
 class QuicDispatcher;
 class QuicPacketReader;
 
@@ -70,6 +72,13 @@ class QuicServer : public EpollCallbackInterface {
 
   QuicPacketCount packets_dropped() { return packets_dropped_; }
 
+  // Number of times the receive-buffer autotuner has grown SO_RCVBUF, and
+  // the size the kernel currently reports for the buffer. Together with
+  // packets_dropped() these make kernel-side drops visible to monitoring.
+  uint64_t rcvbuf_resizes() { return rcvbuf_resizes_; }
+
+  size_t current_rcvbuf_bytes() { return current_rcvbuf_bytes_; }
+
   int port() { return port_; }
 
  protected:
@@ -89,12 +98,33 @@ class QuicServer : public EpollCallbackInterface {
 
   void set_silent_close(bool value) { silent_close_ = value; }
 
+  // When set before CreateUDPSocketAndListen, SO_REUSEPORT is applied to the
+  // socket so that several QuicServer shards may bind the same address.
+  void set_reuse_port(bool reuse_port) { reuse_port_ = reuse_port; }
+
+  // Attaches connection-ID-aware steering to this socket's SO_REUSEPORT
+  // group; see QuicSocketUtils::AttachShardingFilter. Must be called after
+  // all |num_shards| shards have bound their sockets, in shard order.
+  bool AttachShardingFilter(size_t num_shards);
+
  private:
   friend class net::test::QuicServerPeer;
 
   // Initialize the internal state of the server.
   void Initialize();
 
+  // Grows the socket's SO_RCVBUF when the kernel has dropped packets since
+  // the last call, sizing toward the aggregate BDP of the active
+  // connections. No-op unless FLAGS_quic_server_rcvbuf_autotune is set and
+  // the kernel reports drops via SO_RXQ_OVFL.
+  void MaybeGrowReceiveBuffer();
+
+  // Wraps |proof_source| in an OffloadingProofSource when crypto worker
+  // threads are configured, recording the wrapper in
+  // offloading_proof_source_ so Initialize can attach the worker pool.
+  std::unique_ptr<ProofSource> MaybeOffloadProofSource(
+      std::unique_ptr<ProofSource> proof_source);
+
   // Accepts data from the framer and demuxes clients to sessions.
   std::unique_ptr<QuicDispatcher> dispatcher_;
   // Frames incoming packets and hands them to the dispatcher.
@@ -115,13 +145,35 @@ class QuicServer : public EpollCallbackInterface {
   // because the socket would otherwise overflow.
   bool overflow_supported_;
 
+  // Value of packets_dropped_ the last time the receive-buffer autotuner
+  // ran; used to detect new kernel drops.
+  QuicPacketCount packets_dropped_at_last_check_;
+
+  // Value of packets_dropped_ the last time the dispatcher was notified of
+  // kernel drops; used to report only the delta each event loop.
+  QuicPacketCount packets_dropped_at_last_notify_;
+
+  // Receive buffer size the kernel reports for the listening socket,
+  // refreshed whenever the autotuner grows it.
+  size_t current_rcvbuf_bytes_;
+
+  // Number of times the autotuner has grown SO_RCVBUF.
+  uint64_t rcvbuf_resizes_;
+
   // If true, do not call Shutdown on the dispatcher.  Connections will close
   // without sending a final connection close.
   bool silent_close_;
 
+  // If true, set SO_REUSEPORT on the listening socket before bind().
+  bool reuse_port_;
+
   // config_ contains non-crypto parameters that are negotiated in the crypto
   // handshake.
   QuicConfig config_;
+  // If proof computation is offloaded, points at the wrapper owned by
+  // crypto_config_'s proof source; set by MaybeOffloadProofSource, which
+  // runs while crypto_config_ is constructed, so it must precede it here.
+  OffloadingProofSource* offloading_proof_source_ = nullptr;  // Unowned.
   // crypto_config_ contains crypto parameters for the handshake.
   QuicCryptoServerConfig crypto_config_;
   // crypto_config_options_ contains crypto parameters for the handshake.
@@ -134,6 +186,11 @@ class QuicServer : public EpollCallbackInterface {
   // space than allowed on the stack.
   std::unique_ptr<QuicPacketReader> packet_reader_;
 
+  // Worker threads for handshake key agreement, created when
+  // FLAGS_quic_server_crypto_worker_threads is positive.  Shut down before
+  // the dispatcher so pending completions run while sessions still exist.
+  std::unique_ptr<QuicCryptoWorkerPool> crypto_worker_pool_;
+
   QuicHttpResponseCache* response_cache_;  // unowned.
 
   DISALLOW_COPY_AND_ASSIGN(QuicServer);
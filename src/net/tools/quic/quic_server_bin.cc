@@ -5,6 +5,8 @@
 // A binary wrapper for QuicServer.  It listens forever on --port
 // (default 6121) until it's killed or ctrl-cd to death.
 
+#include <unistd.h>
+
 #include <iostream>
 
 #include "base/at_exit.h"
@@ -18,10 +20,15 @@
 #include "net/quic/platform/api/quic_socket_address.h"
 #include "net/tools/quic/quic_http_response_cache.h"
 #include "net/tools/quic/quic_server.h"
+#include "net/tools/quic/quic_sharded_server.h"
 
 // The port the quic server will listen on.
 int32_t FLAGS_port = 6121;
 
+// Number of SO_REUSEPORT dispatcher shards (threads). 1 runs the classic
+// single-threaded server.
+int32_t FLAGS_num_shards = 1;
+
 std::unique_ptr<net::ProofSource> CreateProofSource(
     const base::FilePath& cert_path,
     const base::FilePath& key_path) {
@@ -49,6 +56,8 @@ int main(int argc, char* argv[]) {
         "Options:\n"
         "-h, --help                  show this help message and exit\n"
         "--port=<port>               specify the port to listen on\n"
+        "--num_shards=<n>            run <n> dispatcher threads sharing the\n"
+        "                            port via SO_REUSEPORT\n"
         "--quic_response_cache_dir  directory containing response data\n"
         "                            to load\n"
         "--certificate_file=<file>   path to the certificate chain\n"
@@ -70,6 +79,15 @@ int main(int argc, char* argv[]) {
     }
   }
 
+  if (line->HasSwitch("num_shards")) {
+    if (!base::StringToInt(line->GetSwitchValueASCII("num_shards"),
+                           &FLAGS_num_shards) ||
+        FLAGS_num_shards < 1) {
+      LOG(ERROR) << "--num_shards must be a positive integer\n";
+      return 1;
+    }
+  }
+
   if (!line->HasSwitch("certificate_file")) {
     LOG(ERROR) << "missing --certificate_file";
     return 1;
@@ -81,6 +99,27 @@ int main(int argc, char* argv[]) {
   }
 
   net::QuicConfig config;
+
+  if (FLAGS_num_shards > 1) {
+    base::FilePath cert_path = line->GetSwitchValuePath("certificate_file");
+    base::FilePath key_path = line->GetSwitchValuePath("key_file");
+    net::QuicShardedServer sharded_server(
+        FLAGS_num_shards,
+        [&cert_path, &key_path]() {
+          return CreateProofSource(cert_path, key_path);
+        },
+        config, net::QuicCryptoServerConfig::ConfigOptions(),
+        net::AllSupportedVersions(), &response_cache);
+    if (!sharded_server.CreateUDPSocketsAndListen(net::QuicSocketAddress(
+            net::QuicIpAddress::Any6(), FLAGS_port))) {
+      return 1;
+    }
+    // The shard threads own the event loops; nothing to do here.
+    while (1) {
+      sleep(1);
+    }
+  }
+
   net::QuicServer server(
       CreateProofSource(line->GetSwitchValuePath("certificate_file"),
                         line->GetSwitchValuePath("key_file")),
@@ -0,0 +1,97 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_sharded_server.h"
+
+#include <utility>
+
+#include "net/quic/platform/api/quic_logging.h"
+#include "net/quic/platform/api/quic_str_cat.h"
+#include "net/tools/quic/quic_http_response_cache.h"
+
+namespace net {
+
+QuicShardedServer::ShardThread::ShardThread(QuicServer* server,
+                                            base::AtomicFlag* quit,
+                                            size_t shard_index)
+    : base::SimpleThread(QuicStrCat("quic_server_shard_", shard_index)),
+      server_(server),
+      quit_(quit) {}
+
+QuicShardedServer::ShardThread::~ShardThread() {}
+
+void QuicShardedServer::ShardThread::Run() {
+  // WaitForEvents returns at least every 50ms, so the quit flag is observed
+  // promptly.
+  while (!quit_->IsSet()) {
+    server_->WaitForEvents();
+  }
+  server_->Shutdown();
+}
+
+QuicShardedServer::QuicShardedServer(
+    size_t num_shards,
+    ProofSourceFactory proof_source_factory,
+    const QuicConfig& config,
+    const QuicCryptoServerConfig::ConfigOptions& crypto_options,
+    const QuicVersionVector& supported_versions,
+    QuicHttpResponseCache* response_cache)
+    : port_(0) {
+  DCHECK_GT(num_shards, 0u);
+  for (size_t i = 0; i < num_shards; ++i) {
+    std::unique_ptr<QuicServer> shard(
+        new QuicServer(proof_source_factory(), config, crypto_options,
+                       supported_versions, response_cache));
+    shard->set_reuse_port(true);
+    shards_.push_back(std::move(shard));
+  }
+}
+
+QuicShardedServer::~QuicShardedServer() {
+  if (!threads_.empty()) {
+    Shutdown();
+  }
+}
+
+bool QuicShardedServer::CreateUDPSocketsAndListen(
+    const QuicSocketAddress& address) {
+  // Bind sequentially so each shard's index in the reuseport group matches
+  // its index in |shards_|, which the steering filter relies on.
+  QuicSocketAddress bind_address = address;
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    if (!shards_[i]->CreateUDPSocketAndListen(bind_address)) {
+      QUIC_LOG(ERROR) << "Shard " << i << " failed to listen";
+      return false;
+    }
+    if (i == 0) {
+      // If an ephemeral port was requested, all remaining shards must share
+      // the port the first shard was assigned.
+      port_ = shards_[0]->port();
+      bind_address = QuicSocketAddress(address.host(), port_);
+    }
+  }
+
+  if (shards_.size() > 1 &&
+      !shards_[0]->AttachShardingFilter(shards_.size())) {
+    QUIC_LOG(WARNING) << "Connection-ID steering unavailable; connections "
+                         "will be pinned to shards by 4-tuple hash instead.";
+  }
+
+  for (size_t i = 0; i < shards_.size(); ++i) {
+    threads_.push_back(std::unique_ptr<ShardThread>(
+        new ShardThread(shards_[i].get(), &quit_, i)));
+    threads_.back()->Start();
+  }
+  return true;
+}
+
+void QuicShardedServer::Shutdown() {
+  quit_.Set();
+  for (const auto& thread : threads_) {
+    thread->Join();
+  }
+  threads_.clear();
+}
+
+}  // namespace net
@@ -0,0 +1,84 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+//
+// A sharded QUIC server: N QuicServer instances, each with its own
+// SO_REUSEPORT socket, EpollServer and QuicDispatcher, running on dedicated
+// threads. A classic BPF program attached to the reuseport group steers
+// packets by connection ID so every packet for a connection lands on the
+// thread owning that connection.
+
+#ifndef NET_TOOLS_QUIC_QUIC_SHARDED_SERVER_H_
+#define NET_TOOLS_QUIC_QUIC_SHARDED_SERVER_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/synchronization/atomic_flag.h"
+#include "base/threading/simple_thread.h"
+#include "net/quic/core/crypto/quic_crypto_server_config.h"
+#include "net/quic/core/quic_config.h"
+#include "net/quic/platform/api/quic_socket_address.h"
+#include "net/tools/quic/quic_server.h"
+
+namespace net {
+
+class QuicHttpResponseCache;
+
+class QuicShardedServer {
+ public:
+  // Invoked once per shard; every QuicServer needs its own ProofSource since
+  // the crypto config takes ownership.
+  using ProofSourceFactory = std::function<std::unique_ptr<ProofSource>()>;
+
+  QuicShardedServer(size_t num_shards,
+                    ProofSourceFactory proof_source_factory,
+                    const QuicConfig& config,
+                    const QuicCryptoServerConfig::ConfigOptions& crypto_options,
+                    const QuicVersionVector& supported_versions,
+                    QuicHttpResponseCache* response_cache);
+  ~QuicShardedServer();
+
+  // Binds all shards to |address| (in shard order, so the BPF steering
+  // indices line up with shard indices) and starts one event-loop thread per
+  // shard. Returns false if any shard fails to listen.
+  bool CreateUDPSocketsAndListen(const QuicSocketAddress& address);
+
+  // Signals all shard threads to exit their event loops and joins them.
+  void Shutdown();
+
+  size_t num_shards() const { return shards_.size(); }
+
+  int port() const { return port_; }
+
+ private:
+  // Runs one shard's epoll loop until |quit| is set.
+  class ShardThread : public base::SimpleThread {
+   public:
+    ShardThread(QuicServer* server, base::AtomicFlag* quit, size_t shard_index);
+    ~ShardThread() override;
+
+    void Run() override;
+
+   private:
+    QuicServer* server_;       // Unowned.
+    base::AtomicFlag* quit_;   // Unowned.
+
+    DISALLOW_COPY_AND_ASSIGN(ShardThread);
+  };
+
+  std::vector<std::unique_ptr<QuicServer>> shards_;
+  std::vector<std::unique_ptr<ShardThread>> threads_;
+  base::AtomicFlag quit_;
+  int port_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicShardedServer);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_SHARDED_SERVER_H_
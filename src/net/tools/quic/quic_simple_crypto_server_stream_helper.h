@@ -26,8 +26,20 @@ class QuicSimpleCryptoServerStreamHelper
                             const QuicSocketAddress& self_address,
                             std::string* error_details) const override;
 
+  QuicCryptoWorkerInterface* crypto_worker() const override {
+    return crypto_worker_;
+  }
+
+  // Sets the worker pool on which handshake key agreement runs, or nullptr
+  // (the default) to run it synchronously.  |crypto_worker| must outlive all
+  // streams using this helper.
+  void set_crypto_worker(QuicCryptoWorkerInterface* crypto_worker) {
+    crypto_worker_ = crypto_worker;
+  }
+
  private:
   QuicRandom* random_;  // Unowned.
+  QuicCryptoWorkerInterface* crypto_worker_ = nullptr;  // Unowned.
 };
 
 }  // namespace net
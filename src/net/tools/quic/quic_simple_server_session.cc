@@ -4,18 +4,51 @@
 
 #include "net/tools/quic/quic_simple_server_session.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "net/quic/core/proto/cached_network_parameters.pb.h"
 #include "net/quic/core/quic_connection.h"
+#include "net/quic/core/quic_utils.h"
 #include "net/quic/platform/api/quic_flags.h"
 #include "net/quic/platform/api/quic_logging.h"
 #include "net/quic/platform/api/quic_ptr_util.h"
+#include "net/quic/platform/api/quic_text_utils.h"
 #include "net/tools/quic/quic_simple_server_stream.h"
 
 using std::string;
 
 namespace net {
+namespace {
+
+// Name of the request header carrying the client's cache digest.
+const char kCacheDigestHeader[] = "cache-digest";
+
+// Number of Bloom filter bits probed per URL in the cache digest.
+const size_t kCacheDigestHashes = 5;
+
+// Returns true if every probe bit for |url| is set in |digest|, the raw
+// (hex-decoded) Bloom filter, i.e. the client most likely has |url| cached.
+// The probe positions are derived from the two halves of a 128-bit FNV-1a
+// hash of the URL by double hashing.
+bool DigestContainsUrl(QuicStringPiece digest, const string& url) {
+  if (digest.empty()) {
+    return false;
+  }
+  const uint64_t num_bits = digest.size() * 8;
+  const uint128 hash = QuicUtils::FNV1a_128_Hash(url);
+  const uint64_t h1 = Uint128High64(hash);
+  const uint64_t h2 = Uint128Low64(hash);
+  for (size_t i = 0; i < kCacheDigestHashes; ++i) {
+    const uint64_t bit = (h1 + i * h2) % num_bits;
+    if ((static_cast<uint8_t>(digest[bit / 8]) & (1 << (bit % 8))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
 
 QuicSimpleServerSession::QuicSimpleServerSession(
     const QuicConfig& config,
@@ -75,14 +108,35 @@ void QuicSimpleServerSession::PromisePushResources(
     return;
   }
 
+  QuicSpdyStream* original_stream = GetSpdyDataStream(original_stream_id);
+  const SpdyPriority original_priority =
+      original_stream != nullptr ? original_stream->priority()
+                                 : kV3HighestPriority;
+
   for (QuicHttpResponseCache::ServerPushInfo resource : resources) {
+    if (ClientLikelyHasResource(original_request_headers,
+                                resource.request_url.ToString())) {
+      QUIC_DVLOG(1) << "Not pushing " << resource.request_url.ToString()
+                    << ": present in client's cache digest";
+      continue;
+    }
     SpdyHeaderBlock headers = SynthesizePushRequestHeaders(
         request_url, resource, original_request_headers);
     highest_promised_stream_id_ += 2;
     SendPushPromise(original_stream_id, highest_promised_stream_id_,
                     headers.Clone());
+    // Give the push stream a priority strictly lower than the promising
+    // stream's. The write scheduler serves streams in strict priority
+    // order, so pushed bytes only consume whatever send budget is left
+    // once the primary response has nothing to write, rather than
+    // delaying its first byte.
+    SpdyPriority priority = resource.priority;
+    if (priority <= original_priority) {
+      priority = std::min(static_cast<SpdyPriority>(original_priority + 1),
+                          kV3LowestPriority);
+    }
     promised_streams_.push_back(PromisedStreamInfo(
-        std::move(headers), highest_promised_stream_id_, resource.priority));
+        std::move(headers), highest_promised_stream_id_, priority));
   }
 
   // Procese promised push request as many as possible.
@@ -177,6 +231,18 @@ SpdyHeaderBlock QuicSimpleServerSession::SynthesizePushRequestHeaders(
   return spdy_headers;
 }
 
+// static
+bool QuicSimpleServerSession::ClientLikelyHasResource(
+    const SpdyHeaderBlock& original_request_headers,
+    const string& resource_url) {
+  auto it = original_request_headers.find(kCacheDigestHeader);
+  if (it == original_request_headers.end()) {
+    return false;
+  }
+  const string digest = QuicTextUtils::HexDecode(it->second);
+  return DigestContainsUrl(digest, resource_url);
+}
+
 void QuicSimpleServerSession::SendPushPromise(QuicStreamId original_stream_id,
                                               QuicStreamId promised_stream_id,
                                               SpdyHeaderBlock headers) {
@@ -125,6 +125,17 @@ class QuicSimpleServerSession : public QuicServerSessionBase {
                        QuicStreamId promised_stream_id,
                        SpdyHeaderBlock headers);
 
+  // Returns true if the cache digest advertised by the client in
+  // |original_request_headers| indicates that |resource_url| is already in
+  // the client's cache, in which case pushing it would waste bandwidth.
+  // The digest is carried in the "cache-digest" request header as a
+  // hex-encoded Bloom filter; for each cached URL the client sets several
+  // bits at positions derived from an FNV-1a hash of the URL.  A missing or
+  // empty digest suppresses nothing.
+  static bool ClientLikelyHasResource(
+      const SpdyHeaderBlock& original_request_headers,
+      const std::string& resource_url);
+
   // Fetch response from cache for request headers enqueued into
   // promised_headers_and_streams_ and send them on dedicated stream until
   // reaches max_open_stream_ limit.
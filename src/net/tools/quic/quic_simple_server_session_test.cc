@@ -580,6 +580,36 @@ TEST_P(QuicSimpleServerSessionServerPushTest, TestPromisePushResources) {
   EXPECT_EQ(kMaxStreamsForTest, session_->GetNumOpenOutgoingStreams());
 }
 
+TEST_P(QuicSimpleServerSessionServerPushTest, CacheDigestSuppressesPush) {
+  // Tests that a push resource listed in the client's cache digest is
+  // neither promised nor pushed.
+  QuicUrl resource_url("http://www.google.com/server_push_src1");
+  std::list<QuicHttpResponseCache::ServerPushInfo> push_resources;
+  push_resources.push_back(QuicHttpResponseCache::ServerPushInfo(
+      resource_url, SpdyHeaderBlock(), kDefaultPriority, "push body"));
+
+  // Build a Bloom filter containing the resource URL, mirroring the probe
+  // scheme in QuicSimpleServerSession::ClientLikelyHasResource().
+  string digest(32, '\0');
+  const uint128 hash = QuicUtils::FNV1a_128_Hash(resource_url.ToString());
+  const uint64_t h1 = Uint128High64(hash);
+  const uint64_t h2 = Uint128Low64(hash);
+  for (size_t i = 0; i < 5; ++i) {
+    const uint64_t bit = (h1 + i * h2) % (digest.size() * 8);
+    digest[bit / 8] |= 1 << (bit % 8);
+  }
+  SpdyHeaderBlock request_headers;
+  request_headers["cache-digest"] = QuicTextUtils::HexEncode(digest);
+
+  EXPECT_CALL(*session_, WritePushPromiseMock(_, _, _)).Times(0);
+  EXPECT_CALL(*session_, WriteHeadersMock(_, _, _, _, _)).Times(0);
+  session_->PromisePushResources("mail.google.com/", push_resources,
+                                 GetNthClientInitiatedId(0), request_headers);
+  EXPECT_EQ(0u, session_->GetNumOpenOutgoingStreams());
+  EXPECT_TRUE(
+      QuicSimpleServerSessionPeer::promised_streams(session_.get())->empty());
+}
+
 TEST_P(QuicSimpleServerSessionServerPushTest,
        HandlePromisedPushRequestsAfterStreamDraining) {
   if (session_->force_hol_blocking()) {
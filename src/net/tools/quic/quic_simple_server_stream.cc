@@ -4,6 +4,7 @@
 
 #include "net/tools/quic/quic_simple_server_stream.h"
 
+#include <algorithm>
 #include <list>
 #include <utility>
 
@@ -22,13 +23,47 @@ using std::string;
 
 namespace net {
 
+namespace {
+
+// Number of body bytes pulled from the provider per chunk.
+const size_t kStreamingChunkSize = 16 * 1024;
+
+// Default cap on streamed body bytes buffered in the stream. Responses no
+// larger than this are sent through the non-streaming path.
+const QuicByteCount kDefaultStreamingWatermark = 256 * 1024;
+
+// Serves chunks out of a response cache entry. The cache keeps its
+// responses alive until server shutdown, so the body can be referenced
+// without copying.
+class CachedBodyProvider : public QuicSimpleServerStream::BodyProvider {
+ public:
+  explicit CachedBodyProvider(QuicStringPiece body) : body_(body) {}
+  ~CachedBodyProvider() override {}
+
+  QuicStringPiece ReadBody(uint64_t offset, size_t max_length) override {
+    DCHECK_LT(offset, body_.size());
+    return QuicStringPiece(
+        body_.data() + offset,
+        std::min<uint64_t>(max_length, body_.size() - offset));
+  }
+
+  uint64_t length() const override { return body_.size(); }
+
+ private:
+  QuicStringPiece body_;
+};
+
+}  // namespace
+
 QuicSimpleServerStream::QuicSimpleServerStream(
     QuicStreamId id,
     QuicSpdySession* session,
     QuicHttpResponseCache* response_cache)
     : QuicSpdyServerStreamBase(id, session),
       content_length_(-1),
-      response_cache_(response_cache) {}
+      response_cache_(response_cache),
+      body_provider_offset_(0),
+      streaming_watermark_(kDefaultStreamingWatermark) {}
 
 QuicSimpleServerStream::~QuicSimpleServerStream() {}
 
@@ -54,24 +89,32 @@ void QuicSimpleServerStream::OnTrailingHeadersComplete(
 }
 
 void QuicSimpleServerStream::OnDataAvailable() {
+  // Number of iovecs borrowed from the sequencer at a time while draining the
+  // request body.
+  const int kMaxReadableRegions = 16;
   while (HasBytesToRead()) {
-    struct iovec iov;
-    if (GetReadableRegions(&iov, 1) == 0) {
+    struct iovec iovs[kMaxReadableRegions];
+    int num_regions = GetReadableRegions(iovs, kMaxReadableRegions);
+    if (num_regions == 0) {
       // No more data to read.
       break;
     }
-    QUIC_DVLOG(1) << "Stream " << id() << " processed " << iov.iov_len
-                  << " bytes.";
-    body_.append(static_cast<char*>(iov.iov_base), iov.iov_len);
-
-    if (content_length_ >= 0 &&
-        body_.size() > static_cast<uint64_t>(content_length_)) {
-      QUIC_DVLOG(1) << "Body size (" << body_.size() << ") > content length ("
-                    << content_length_ << ").";
-      SendErrorResponse();
-      return;
+    size_t bytes_read = 0;
+    for (int i = 0; i < num_regions; ++i) {
+      body_.append(static_cast<char*>(iovs[i].iov_base), iovs[i].iov_len);
+      bytes_read += iovs[i].iov_len;
+
+      if (content_length_ >= 0 &&
+          body_.size() > static_cast<uint64_t>(content_length_)) {
+        QUIC_DVLOG(1) << "Body size (" << body_.size() << ") > content length ("
+                      << content_length_ << ").";
+        SendErrorResponse();
+        return;
+      }
     }
-    MarkConsumed(iov.iov_len);
+    QUIC_DVLOG(1) << "Stream " << id() << " processed " << bytes_read
+                  << " bytes.";
+    MarkConsumed(bytes_read);
   }
   if (!sequencer()->IsClosed()) {
     sequencer()->SetUnblocked();
@@ -198,8 +241,24 @@ void QuicSimpleServerStream::SendResponse() {
   }
 
   QUIC_DVLOG(1) << "Stream " << id() << " sending response.";
+  if (response->body().length() > streaming_watermark_) {
+    // Large bodies are streamed in chunks pulled as flow control and the
+    // congestion window open up, so at most |streaming_watermark_| bytes are
+    // ever buffered in the stream.
+    SendHeadersAndStreamBody(
+        response->headers().Clone(),
+        std::unique_ptr<BodyProvider>(new CachedBodyProvider(response->body())),
+        response->trailers().Clone());
+    return;
+  }
+  // The cache owns the response and keeps it alive until server shutdown, so
+  // the body can be sent by reference instead of being copied into the send
+  // buffer.
+  QuicReferenceCountedPointer<QuicMemSlice> body_slice(
+      new QuicMemSlice(response->body().data(), response->body().length()));
   SendHeadersAndBodyAndTrailers(response->headers().Clone(), response->body(),
-                                response->trailers().Clone());
+                                response->trailers().Clone(),
+                                std::move(body_slice));
 }
 
 void QuicSimpleServerStream::SendNotFoundResponse() {
@@ -220,6 +279,60 @@ void QuicSimpleServerStream::SendErrorResponse() {
   SendHeadersAndBody(std::move(headers), kErrorResponseBody);
 }
 
+void QuicSimpleServerStream::OnCanWrite() {
+  // Drain previously buffered data first, then refill from the body
+  // provider up to the watermark.
+  QuicSpdyStream::OnCanWrite();
+  if (body_provider_ != nullptr) {
+    WriteStreamedBody();
+  }
+}
+
+void QuicSimpleServerStream::SendHeadersAndStreamBody(
+    SpdyHeaderBlock response_headers,
+    std::unique_ptr<BodyProvider> body_provider,
+    SpdyHeaderBlock response_trailers) {
+  DCHECK(body_provider != nullptr);
+  DCHECK_LT(0u, body_provider->length());
+  QUIC_DLOG(INFO) << "Stream " << id() << " writing headers (fin = false) : "
+                  << response_headers.DebugString();
+  WriteHeaders(std::move(response_headers), /*fin=*/false, nullptr);
+
+  QUIC_DLOG(INFO) << "Stream " << id() << " streaming body with size: "
+                  << body_provider->length();
+  body_provider_ = std::move(body_provider);
+  body_provider_offset_ = 0;
+  streaming_trailers_ = std::move(response_trailers);
+  WriteStreamedBody();
+}
+
+void QuicSimpleServerStream::WriteStreamedBody() {
+  DCHECK(body_provider_ != nullptr);
+  while (!write_side_closed() &&
+         queued_data_bytes() < streaming_watermark_) {
+    const uint64_t remaining =
+        body_provider_->length() - body_provider_offset_;
+    QuicStringPiece chunk = body_provider_->ReadBody(
+        body_provider_offset_, std::min<uint64_t>(kStreamingChunkSize,
+                                                  remaining));
+    DCHECK(!chunk.empty());
+    body_provider_offset_ += chunk.size();
+    const bool last_chunk = body_provider_offset_ == body_provider_->length();
+    WriteOrBufferData(chunk, /*fin=*/last_chunk && streaming_trailers_.empty(),
+                      nullptr);
+    if (last_chunk) {
+      body_provider_.reset();
+      if (!streaming_trailers_.empty()) {
+        QUIC_DLOG(INFO) << "Stream " << id()
+                        << " writing trailers (fin = true): "
+                        << streaming_trailers_.DebugString();
+        WriteTrailers(std::move(streaming_trailers_), nullptr);
+      }
+      return;
+    }
+  }
+}
+
 void QuicSimpleServerStream::SendHeadersAndBody(
     SpdyHeaderBlock response_headers,
     QuicStringPiece body) {
@@ -230,7 +343,8 @@ void QuicSimpleServerStream::SendHeadersAndBody(
 void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
     SpdyHeaderBlock response_headers,
     QuicStringPiece body,
-    SpdyHeaderBlock response_trailers) {
+    SpdyHeaderBlock response_trailers,
+    QuicReferenceCountedPointer<QuicMemSlice> body_slice) {
   // Send the headers, with a FIN if there's nothing else to send.
   bool send_fin = (body.empty() && response_trailers.empty());
   QUIC_DLOG(INFO) << "Stream " << id() << " writing headers (fin = " << send_fin
@@ -245,7 +359,9 @@ void QuicSimpleServerStream::SendHeadersAndBodyAndTrailers(
   send_fin = response_trailers.empty();
   QUIC_DLOG(INFO) << "Stream " << id() << " writing body (fin = " << send_fin
                   << ") with size: " << body.size();
-  if (!body.empty() || send_fin) {
+  if (!body.empty() && body_slice != nullptr) {
+    WriteOrBufferMemSlice(std::move(body_slice), send_fin, nullptr);
+  } else if (!body.empty() || send_fin) {
     WriteOrBufferData(body, send_fin, nullptr);
   }
   if (send_fin) {
@@ -5,6 +5,7 @@
 #ifndef NET_TOOLS_QUIC_QUIC_SIMPLE_SERVER_STREAM_H_
 #define NET_TOOLS_QUIC_QUIC_SIMPLE_SERVER_STREAM_H_
 
+#include <memory>
 #include <string>
 
 #include "base/macros.h"
@@ -25,6 +26,23 @@ class QuicSimpleServerStreamPeer;
 // response.
 class QuicSimpleServerStream : public QuicSpdyServerStreamBase {
  public:
+  // Pull source for response bodies streamed in chunks, so that large
+  // objects are never buffered whole in the send buffer. ReadBody() is
+  // invoked repeatedly as flow control and the congestion window open up;
+  // the returned bytes are copied into the send buffer before the next
+  // call, so they only need to stay valid for the duration of the call.
+  class BodyProvider {
+   public:
+    virtual ~BodyProvider() {}
+
+    // Returns up to |max_length| bytes of the body starting at |offset|.
+    // Must return at least one byte for any |offset| < length().
+    virtual QuicStringPiece ReadBody(uint64_t offset, size_t max_length) = 0;
+
+    // Returns the total body length in bytes.
+    virtual uint64_t length() const = 0;
+  };
+
   QuicSimpleServerStream(QuicStreamId id,
                          QuicSpdySession* session,
                          QuicHttpResponseCache* response_cache);
@@ -42,6 +60,10 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase {
   // data (or a FIN) to be read.
   void OnDataAvailable() override;
 
+  // QuicStream implementation. Refills the send buffer from the body
+  // provider, if one is registered, whenever the stream can write again.
+  void OnCanWrite() override;
+
   // Make this stream start from as if it just finished parsing an incoming
   // request whose headers are equivalent to |push_request_headers|.
   // Doing so will trigger this toy stream to fetch response and send it back.
@@ -66,9 +88,24 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase {
 
   void SendHeadersAndBody(SpdyHeaderBlock response_headers,
                           QuicStringPiece body);
-  void SendHeadersAndBodyAndTrailers(SpdyHeaderBlock response_headers,
-                                     QuicStringPiece body,
-                                     SpdyHeaderBlock response_trailers);
+  // If |body_slice| is non-null it references the same bytes as |body| and
+  // the body is handed to the send buffer by reference instead of being
+  // copied; the bytes must then stay valid until fully acked. Callers whose
+  // body does not outlive the stream must pass a null |body_slice|.
+  void SendHeadersAndBodyAndTrailers(
+      SpdyHeaderBlock response_headers,
+      QuicStringPiece body,
+      SpdyHeaderBlock response_trailers,
+      QuicReferenceCountedPointer<QuicMemSlice> body_slice = nullptr);
+
+  // Sends |response_headers|, then streams the body pulled from
+  // |body_provider| in chunks, keeping at most |streaming_watermark_| bytes
+  // buffered in the stream at a time. More chunks are pulled from
+  // OnCanWrite() as flow control and the congestion window open up. The FIN
+  // is sent with the final chunk, or with |response_trailers| if non-empty.
+  void SendHeadersAndStreamBody(SpdyHeaderBlock response_headers,
+                                std::unique_ptr<BodyProvider> body_provider,
+                                SpdyHeaderBlock response_trailers);
 
   SpdyHeaderBlock* request_headers() { return &request_headers_; }
 
@@ -77,6 +114,10 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase {
  private:
   friend class test::QuicSimpleServerStreamPeer;
 
+  // Writes chunks pulled from |body_provider_| until the watermark is
+  // reached, the write side blocks, or the body is exhausted.
+  void WriteStreamedBody();
+
   // The parsed headers received from the client.
   SpdyHeaderBlock request_headers_;
   int64_t content_length_;
@@ -84,6 +125,16 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase {
 
   QuicHttpResponseCache* response_cache_;  // Not owned.
 
+  // Set while a response body is being streamed; reset once the final chunk
+  // has been handed to the send buffer.
+  std::unique_ptr<BodyProvider> body_provider_;
+  // Offset of the next body byte to pull from |body_provider_|.
+  uint64_t body_provider_offset_;
+  // Trailers to send after the streamed body, empty for none.
+  SpdyHeaderBlock streaming_trailers_;
+  // Maximum number of streamed body bytes kept buffered in the stream.
+  QuicByteCount streaming_watermark_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicSimpleServerStream);
 };
 
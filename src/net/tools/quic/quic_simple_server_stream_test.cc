@@ -13,6 +13,7 @@
 #include "net/quic/platform/api/quic_ptr_util.h"
 #include "net/quic/platform/api/quic_socket_address.h"
 #include "net/quic/platform/api/quic_test.h"
+#include "net/quic/platform/api/quic_text_utils.h"
 #include "net/quic/test_tools/crypto_test_utils.h"
 #include "net/quic/test_tools/quic_spdy_session_peer.h"
 #include "net/quic/test_tools/quic_stream_peer.h"
@@ -69,6 +70,10 @@ class QuicSimpleServerStreamPeer : public QuicSimpleServerStream {
   static SpdyHeaderBlock& headers(QuicSimpleServerStream* stream) {
     return stream->request_headers_;
   }
+
+  static bool is_streaming(QuicSimpleServerStream* stream) {
+    return stream->body_provider_ != nullptr;
+  }
 };
 
 namespace {
@@ -414,6 +419,78 @@ TEST_P(QuicSimpleServerStreamTest, SendResponseWithValidHeaders) {
   EXPECT_TRUE(stream_->write_side_closed());
 }
 
+TEST_P(QuicSimpleServerStreamTest, StreamedResponseRespectsWatermark) {
+  // A response body larger than the streaming watermark is pulled from the
+  // cache in chunks. While the session consumes nothing, buffering stops at
+  // the watermark instead of absorbing the whole body, and the remainder is
+  // pulled from OnCanWrite() once the session can make progress again.
+  const size_t kStreamingWatermark = 256 * 1024;
+  const size_t kBodySize = 4 * kStreamingWatermark;
+  SpdyHeaderBlock* request_headers = stream_->mutable_headers();
+  (*request_headers)[":path"] = "/big";
+  (*request_headers)[":authority"] = "www.google.com";
+  (*request_headers)[":version"] = "HTTP/1.1";
+  (*request_headers)[":method"] = "GET";
+
+  response_headers_[":version"] = "HTTP/1.1";
+  response_headers_[":status"] = "200";
+  response_headers_["content-length"] = QuicTextUtils::Uint64ToString(kBodySize);
+  string body(kBodySize, 'a');
+  response_cache_.AddResponse("www.google.com", "/big",
+                              std::move(response_headers_), body);
+  stream_->set_fin_received(true);
+
+  InSequence s;
+  EXPECT_CALL(session_, WriteHeadersMock(stream_->id(), _, false, _, _));
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(Return(QuicConsumedData(0, false)));
+
+  QuicSimpleServerStreamPeer::SendResponse(stream_);
+  EXPECT_TRUE(QuicSimpleServerStreamPeer::is_streaming(stream_));
+  EXPECT_GE(stream_->queued_data_bytes(), kStreamingWatermark);
+  EXPECT_LT(stream_->queued_data_bytes(), kBodySize);
+  EXPECT_FALSE(stream_->write_side_closed());
+
+  // Unblock the session. OnCanWrite() drains the buffered chunks and pulls
+  // the rest of the body, finishing with a FIN.
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(Invoke(MockQuicSession::ConsumeAllData));
+  stream_->OnCanWrite();
+  EXPECT_FALSE(QuicSimpleServerStreamPeer::is_streaming(stream_));
+  EXPECT_EQ(kBodySize, stream_->stream_bytes_written());
+  EXPECT_TRUE(stream_->write_side_closed());
+}
+
+TEST_P(QuicSimpleServerStreamTest, StreamedResponseUnblockedSession) {
+  // When the session consumes everything as it is written, a streamed
+  // response completes within SendResponse() itself.
+  const size_t kBodySize = 512 * 1024;
+  SpdyHeaderBlock* request_headers = stream_->mutable_headers();
+  (*request_headers)[":path"] = "/big";
+  (*request_headers)[":authority"] = "www.google.com";
+  (*request_headers)[":version"] = "HTTP/1.1";
+  (*request_headers)[":method"] = "GET";
+
+  response_headers_[":version"] = "HTTP/1.1";
+  response_headers_[":status"] = "200";
+  response_headers_["content-length"] = QuicTextUtils::Uint64ToString(kBodySize);
+  string body(kBodySize, 'b');
+  response_cache_.AddResponse("www.google.com", "/big",
+                              std::move(response_headers_), body);
+  stream_->set_fin_received(true);
+
+  InSequence s;
+  EXPECT_CALL(session_, WriteHeadersMock(stream_->id(), _, false, _, _));
+  EXPECT_CALL(session_, WritevData(_, _, _, _, _, _))
+      .WillRepeatedly(Invoke(MockQuicSession::ConsumeAllData));
+
+  QuicSimpleServerStreamPeer::SendResponse(stream_);
+  EXPECT_FALSE(QuicSimpleServerStreamPeer::is_streaming(stream_));
+  EXPECT_EQ(0u, stream_->queued_data_bytes());
+  EXPECT_EQ(kBodySize, stream_->stream_bytes_written());
+  EXPECT_TRUE(stream_->write_side_closed());
+}
+
 TEST_P(QuicSimpleServerStreamTest, SendReponseWithPushResources) {
   // Tests that if a reponse has push resources to be send, SendResponse() will
   // call PromisePushResources() to handle these resources.
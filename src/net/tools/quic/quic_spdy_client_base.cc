@@ -68,6 +68,15 @@ void QuicSpdyClientBase::OnClose(QuicSpdyStream* stream) {
   QuicSpdyClientStream* client_stream =
       static_cast<QuicSpdyClientStream*>(stream);
 
+  auto async_it = async_requests_.find(stream->id());
+  if (async_it != async_requests_.end()) {
+    RequestDelegate* delegate = async_it->second;
+    async_requests_.erase(async_it);
+    delegate->OnRequestComplete(
+        stream->id(),
+        client_stream->fin_received() && !client_stream->rst_received());
+  }
+
   const SpdyHeaderBlock& response_headers = client_stream->response_headers();
   if (response_listener_ != nullptr) {
     response_listener_->OnCompleteResponse(stream->id(), response_headers,
@@ -122,6 +131,33 @@ void QuicSpdyClientBase::SendRequest(const SpdyHeaderBlock& headers,
   MaybeAddDataToResend(headers, body, fin);
 }
 
+QuicStreamId QuicSpdyClientBase::SendAsyncRequest(
+    const SpdyHeaderBlock& headers,
+    QuicStringPiece body,
+    bool fin,
+    RequestDelegate* delegate) {
+  DCHECK(delegate != nullptr);
+  // Async requests bypass the push promise index: their responses are
+  // delivered incrementally, for which a promised (already buffered)
+  // response offers no benefit.
+  QuicSpdyClientStream* stream = CreateClientStream();
+  if (stream == nullptr) {
+    QUIC_DLOG(WARNING) << "Async request failed: no stream available.";
+    return 0;
+  }
+  stream->set_delegate(delegate);
+  const QuicStreamId stream_id = stream->id();
+  async_requests_[stream_id] = delegate;
+  stream->SendRequest(headers.Clone(), body, fin);
+  MaybeAddDataToResend(headers, body, fin);
+  return stream_id;
+}
+
+void QuicSpdyClientBase::WaitForAsyncRequests() {
+  while (!async_requests_.empty() && connected() && WaitForEvents()) {
+  }
+}
+
 void QuicSpdyClientBase::SendRequestAndWaitForResponse(
     const SpdyHeaderBlock& headers,
     QuicStringPiece body,
@@ -8,6 +8,7 @@
 #ifndef NET_TOOLS_QUIC_QUIC_SPDY_CLIENT_BASE_H_
 #define NET_TOOLS_QUIC_QUIC_SPDY_CLIENT_BASE_H_
 
+#include <map>
 #include <string>
 
 #include "base/macros.h"
@@ -39,6 +40,18 @@ class QuicSpdyClientBase : public QuicClientBase,
                                     const std::string& response_body) = 0;
   };
 
+  // Observer for a single request issued through SendAsyncRequest().
+  // Response headers and body are delivered incrementally as they arrive;
+  // OnRequestComplete() fires exactly once when the stream closes.
+  class RequestDelegate : public QuicSpdyClientStream::Delegate {
+   public:
+    ~RequestDelegate() override {}
+
+    // |response_complete| is false if the stream was reset before the full
+    // response arrived.
+    virtual void OnRequestComplete(QuicStreamId id, bool response_complete) = 0;
+  };
+
   // The client uses these objects to keep track of any data to resend upon
   // receipt of a stateless reject.  Recall that the client API allows callers
   // to optimistically send data to the server prior to handshake-confirmation.
@@ -99,6 +112,28 @@ class QuicSpdyClientBase : public QuicClientBase,
   // each to complete.
   void SendRequestsAndWaitForResponse(const std::vector<std::string>& url_list);
 
+  // Issues a request without driving the event loop; response events are
+  // delivered to |delegate| as the loop is pumped. Many requests may be
+  // outstanding at once, and one WaitForEvents() pass services every stream
+  // that is ready, so responses make progress in batches instead of one
+  // loop-pumping cycle per request. Returns the request's stream id, or 0
+  // if no stream could be created (stream limit reached or connection
+  // closed). |delegate| must outlive the request.
+  QuicStreamId SendAsyncRequest(const SpdyHeaderBlock& headers,
+                                QuicStringPiece body,
+                                bool fin,
+                                RequestDelegate* delegate);
+
+  // Drives the event loop until every request issued through
+  // SendAsyncRequest() has completed or the connection closes.
+  void WaitForAsyncRequests();
+
+  // Number of requests issued through SendAsyncRequest() that have not yet
+  // completed.
+  size_t num_outstanding_async_requests() const {
+    return async_requests_.size();
+  }
+
   // Returns a newly created QuicSpdyClientStream.
   QuicSpdyClientStream* CreateClientStream();
 
@@ -183,6 +218,10 @@ class QuicSpdyClientBase : public QuicClientBase,
   // Index of pending promised streams. Must outlive |session_|.
   QuicClientPushPromiseIndex push_promise_index_;
 
+  // Delegates of requests issued through SendAsyncRequest() that have not
+  // yet completed, keyed by stream id. Not owned.
+  std::map<QuicStreamId, RequestDelegate*> async_requests_;
+
   // If true, store the latest response code, headers, and body.
   bool store_response_;
   // HTTP response code from most recent response.
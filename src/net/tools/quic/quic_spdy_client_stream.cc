@@ -22,10 +22,12 @@ QuicSpdyClientStream::QuicSpdyClientStream(QuicStreamId id,
     : QuicSpdyStream(id, session),
       content_length_(-1),
       response_code_(0),
+      body_bytes_read_(0),
       header_bytes_read_(0),
       header_bytes_written_(0),
       session_(session),
-      has_preliminary_headers_(false) {}
+      has_preliminary_headers_(false),
+      delegate_(nullptr) {}
 
 QuicSpdyClientStream::~QuicSpdyClientStream() {}
 
@@ -64,6 +66,11 @@ void QuicSpdyClientStream::OnInitialHeadersComplete(
   QUIC_DVLOG(1) << "headers complete for stream " << id();
 
   session_->OnInitialHeadersComplete(id(), response_headers_);
+  if (delegate_ != nullptr && headers_decompressed()) {
+    // Preliminary 100 Continue headers reset headers_decompressed() above
+    // and are not delivered; the delegate only sees the real response.
+    delegate_->OnResponseHeaders(id(), response_headers_);
+  }
 }
 
 void QuicSpdyClientStream::OnTrailingHeadersComplete(
@@ -109,12 +116,21 @@ void QuicSpdyClientStream::OnDataAvailable() {
     }
     QUIC_DVLOG(1) << "Client processed " << iov.iov_len << " bytes for stream "
                   << id();
-    data_.append(static_cast<char*>(iov.iov_base), iov.iov_len);
+    body_bytes_read_ += iov.iov_len;
+    if (delegate_ != nullptr) {
+      // Hand the bytes to the delegate instead of accumulating them, so
+      // large responses are never buffered whole.
+      delegate_->OnResponseBodyData(
+          id(),
+          QuicStringPiece(static_cast<char*>(iov.iov_base), iov.iov_len));
+    } else {
+      data_.append(static_cast<char*>(iov.iov_base), iov.iov_len);
+    }
 
     if (content_length_ >= 0 &&
-        data_.size() > static_cast<uint64_t>(content_length_)) {
+        body_bytes_read_ > static_cast<uint64_t>(content_length_)) {
       QUIC_DLOG(ERROR) << "Invalid content length (" << content_length_
-                       << ") with data of size " << data_.size();
+                       << ") with data of size " << body_bytes_read_;
       Reset(QUIC_BAD_APPLICATION_PAYLOAD);
       return;
     }
@@ -23,6 +23,21 @@ class QuicSpdyClientSession;
 // SPDY response.
 class QuicSpdyClientStream : public QuicSpdyStream {
  public:
+  // Receives the response incrementally as it arrives instead of waiting
+  // for the stream to close.
+  class Delegate {
+   public:
+    virtual ~Delegate() {}
+
+    // Called once the complete (non-1xx) response headers have arrived.
+    virtual void OnResponseHeaders(QuicStreamId id,
+                                   const SpdyHeaderBlock& headers) = 0;
+
+    // Called as body bytes arrive. |data| is only valid for the duration
+    // of the call.
+    virtual void OnResponseBodyData(QuicStreamId id, QuicStringPiece data) = 0;
+  };
+
   QuicSpdyClientStream(QuicStreamId id, QuicSpdyClientSession* session);
   ~QuicSpdyClientStream() override;
 
@@ -66,6 +81,12 @@ class QuicSpdyClientStream : public QuicSpdyStream {
   // of client-side streams should be able to set the priority.
   using QuicSpdyStream::SetPriority;
 
+  // Sets the delegate receiving incremental response events. When a delegate
+  // is set the stream no longer accumulates the body into data(); callers
+  // wanting the bytes must retain them from OnResponseBodyData().
+  void set_delegate(Delegate* delegate) { delegate_ = delegate; }
+  Delegate* delegate() { return delegate_; }
+
  private:
   // The parsed headers received from the server.
   SpdyHeaderBlock response_headers_;
@@ -74,6 +95,8 @@ class QuicSpdyClientStream : public QuicSpdyStream {
   int64_t content_length_;
   int response_code_;
   std::string data_;
+  // Total body bytes consumed, whether or not they were stored in |data_|.
+  uint64_t body_bytes_read_;
   size_t header_bytes_read_;
   size_t header_bytes_written_;
 
@@ -85,6 +108,9 @@ class QuicSpdyClientStream : public QuicSpdyStream {
   bool has_preliminary_headers_;
   SpdyHeaderBlock preliminary_headers_;
 
+  // If set, receives headers and body incrementally. Not owned.
+  Delegate* delegate_;
+
   DISALLOW_COPY_AND_ASSIGN(QuicSpdyClientStream);
 };
 
@@ -0,0 +1,96 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_stream_splice_adapter.h"
+
+#include <sys/uio.h>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/socket/stream_socket.h"
+
+namespace net {
+
+QuicStreamSpliceAdapter::QuicStreamSpliceAdapter(
+    QuicSpdyStream* stream,
+    StreamSocket* socket,
+    const DoneCallback& done_callback)
+    : stream_(stream),
+      socket_(socket),
+      done_callback_(done_callback),
+      write_pending_(false),
+      finished_(false),
+      bytes_spliced_(0),
+      weak_factory_(this) {
+  DCHECK(socket_->IsConnected());
+}
+
+QuicStreamSpliceAdapter::~QuicStreamSpliceAdapter() {}
+
+void QuicStreamSpliceAdapter::OnDataAvailable() {
+  // If a write is outstanding its completion restarts the drain; any data
+  // that arrived meanwhile is picked up then.
+  if (write_pending_ || finished_) {
+    return;
+  }
+  TrySplice();
+}
+
+void QuicStreamSpliceAdapter::TrySplice() {
+  while (true) {
+    iovec iov;
+    if (stream_->GetReadableRegions(&iov, 1) == 0) {
+      if (stream_->IsDoneReading()) {
+        Finish(OK);
+      }
+      // Otherwise wait for the next OnDataAvailable().
+      return;
+    }
+
+    // The region belongs to the sequencer and stays valid until it is
+    // marked consumed, which only happens after the write completes.
+    scoped_refptr<WrappedIOBuffer> buffer(
+        new WrappedIOBuffer(static_cast<const char*>(iov.iov_base)));
+    int rv = socket_->Write(buffer.get(), iov.iov_len,
+                            base::Bind(&QuicStreamSpliceAdapter::OnWriteComplete,
+                                       weak_factory_.GetWeakPtr()));
+    if (rv == ERR_IO_PENDING) {
+      write_pending_ = true;
+      return;
+    }
+    if (rv < 0) {
+      Finish(rv);
+      return;
+    }
+    // Partial writes leave the remainder readable for the next iteration.
+    stream_->MarkConsumed(rv);
+    bytes_spliced_ += rv;
+  }
+}
+
+void QuicStreamSpliceAdapter::OnWriteComplete(int result) {
+  DCHECK(write_pending_);
+  write_pending_ = false;
+  if (result < 0) {
+    Finish(result);
+    return;
+  }
+  // Consuming releases the sequencer memory and extends the stream's flow
+  // control window, letting the sender refill what the socket drained.
+  stream_->MarkConsumed(result);
+  bytes_spliced_ += result;
+  TrySplice();
+}
+
+void QuicStreamSpliceAdapter::Finish(int status) {
+  DCHECK(!finished_);
+  finished_ = true;
+  if (!done_callback_.is_null()) {
+    done_callback_.Run(status);
+  }
+}
+
+}  // namespace net
@@ -0,0 +1,87 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_STREAM_SPLICE_ADAPTER_H_
+#define NET_TOOLS_QUIC_QUIC_STREAM_SPLICE_ADAPTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "net/quic/core/quic_spdy_stream.h"
+
+namespace net {
+
+class StreamSocket;
+
+// QuicStreamSpliceAdapter joins the read side of a QuicSpdyStream to the
+// write side of a StreamSocket, for gateways which terminate QUIC and
+// forward stream bytes upstream over TCP.
+//
+// Readable sequencer regions are handed to the socket's write path directly
+// (wrapped, not copied), and are only marked consumed once the socket has
+// accepted them. Because the QUIC flow control window is not extended until
+// bytes are consumed, a slow upstream socket backpressures the QUIC sender
+// through the stream's flow controller — no application-level buffer sits
+// between the two.
+//
+// The owning stream drives the adapter by calling OnDataAvailable() from its
+// own OnDataAvailable(). Both the stream and the socket must outlive the
+// adapter.
+class QuicStreamSpliceAdapter {
+ public:
+  // Invoked once when splicing finishes: with OK after the stream's fin has
+  // been received and every byte was written to the socket, or with the
+  // socket's net error on write failure.
+  typedef base::Callback<void(int status)> DoneCallback;
+
+  // Neither |stream| nor |socket| is owned. |socket| must already be
+  // connected.
+  QuicStreamSpliceAdapter(QuicSpdyStream* stream,
+                          StreamSocket* socket,
+                          const DoneCallback& done_callback);
+  ~QuicStreamSpliceAdapter();
+
+  // Drains readable sequencer regions into the socket until the socket
+  // blocks or the stream has no more data. Safe to call at any time,
+  // including while a socket write is pending.
+  void OnDataAvailable();
+
+  // Total bytes accepted by the socket so far.
+  uint64_t bytes_spliced() const { return bytes_spliced_; }
+
+  // True once the done callback has run (successfully or not).
+  bool finished() const { return finished_; }
+
+ private:
+  // Writes the next readable region to the socket, looping over synchronous
+  // completions.
+  void TrySplice();
+
+  void OnWriteComplete(int result);
+
+  // Marks the splice finished and reports |status| to the done callback.
+  void Finish(int status);
+
+  QuicSpdyStream* stream_;  // Not owned.
+  StreamSocket* socket_;    // Not owned.
+  DoneCallback done_callback_;
+
+  // True while a socket write is outstanding. The in-flight region is not
+  // consumed from the sequencer until the write completes, so its memory
+  // stays valid for the duration of the write.
+  bool write_pending_;
+  bool finished_;
+  uint64_t bytes_spliced_;
+
+  base::WeakPtrFactory<QuicStreamSpliceAdapter> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(QuicStreamSpliceAdapter);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_STREAM_SPLICE_ADAPTER_H_
@@ -0,0 +1,263 @@
+// Copyright 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_stream_splice_adapter.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "base/bind.h"
+#include "net/base/io_buffer.h"
+#include "net/base/ip_endpoint.h"
+#include "net/base/net_errors.h"
+#include "net/log/net_log_with_source.h"
+#include "net/quic/platform/api/quic_ptr_util.h"
+#include "net/quic/platform/api/quic_test.h"
+#include "net/quic/test_tools/quic_spdy_session_peer.h"
+#include "net/quic/test_tools/quic_test_utils.h"
+#include "net/socket/stream_socket.h"
+
+using std::string;
+
+namespace net {
+namespace test {
+namespace {
+
+// A stream which hands every data arrival to the splice adapter instead of
+// reading the bytes itself.
+class SplicedStream : public QuicSpdyStream {
+ public:
+  SplicedStream(QuicStreamId id, QuicSpdySession* session)
+      : QuicSpdyStream(id, session) {}
+
+  void OnDataAvailable() override {
+    if (adapter_ != nullptr) {
+      adapter_->OnDataAvailable();
+    }
+  }
+
+  void set_adapter(QuicStreamSpliceAdapter* adapter) { adapter_ = adapter; }
+
+ private:
+  QuicStreamSpliceAdapter* adapter_ = nullptr;
+};
+
+// A connected StreamSocket which records written bytes. Writes complete
+// synchronously while |accept_bytes_| remain, and return ERR_IO_PENDING
+// afterwards; CompletePendingWrite() drains the pending write by hand.
+class FakeStreamSocket : public StreamSocket {
+ public:
+  FakeStreamSocket() : accept_bytes_(SIZE_MAX), pending_length_(0) {}
+  ~FakeStreamSocket() override {}
+
+  // Socket implementation.
+  int Read(IOBuffer* buf,
+           int buf_len,
+           const CompletionCallback& callback) override {
+    return ERR_IO_PENDING;
+  }
+  int Write(IOBuffer* buf,
+            int buf_len,
+            const CompletionCallback& callback) override {
+    if (accept_bytes_ == 0) {
+      pending_buffer_ = buf;
+      pending_length_ = buf_len;
+      pending_callback_ = callback;
+      return ERR_IO_PENDING;
+    }
+    size_t written = std::min(accept_bytes_, static_cast<size_t>(buf_len));
+    accept_bytes_ -= written;
+    data_.append(buf->data(), written);
+    return written;
+  }
+  int SetReceiveBufferSize(int32_t size) override { return OK; }
+  int SetSendBufferSize(int32_t size) override { return OK; }
+
+  // StreamSocket implementation.
+  int Connect(const CompletionCallback& callback) override { return OK; }
+  void Disconnect() override {}
+  bool IsConnected() const override { return true; }
+  bool IsConnectedAndIdle() const override { return true; }
+  int GetPeerAddress(IPEndPoint* address) const override {
+    return ERR_SOCKET_NOT_CONNECTED;
+  }
+  int GetLocalAddress(IPEndPoint* address) const override {
+    return ERR_SOCKET_NOT_CONNECTED;
+  }
+  const NetLogWithSource& NetLog() const override { return net_log_; }
+  void SetSubresourceSpeculation() override {}
+  void SetOmniboxSpeculation() override {}
+  bool WasEverUsed() const override { return true; }
+  bool WasAlpnNegotiated() const override { return false; }
+  NextProto GetNegotiatedProtocol() const override { return kProtoUnknown; }
+  bool GetSSLInfo(SSLInfo* ssl_info) override { return false; }
+  void GetConnectionAttempts(ConnectionAttempts* out) const override {
+    out->clear();
+  }
+  void ClearConnectionAttempts() override {}
+  void AddConnectionAttempts(const ConnectionAttempts& attempts) override {}
+  int64_t GetTotalReceivedBytes() const override { return 0; }
+
+  // Accepts |bytes| more before future writes go pending.
+  void set_accept_bytes(size_t bytes) { accept_bytes_ = bytes; }
+
+  bool has_pending_write() const { return !pending_callback_.is_null(); }
+
+  // Completes the pending write, accepting |bytes| of it.
+  void CompletePendingWrite(size_t bytes) {
+    ASSERT_TRUE(has_pending_write());
+    size_t written = std::min(bytes, pending_length_);
+    data_.append(pending_buffer_->data(), written);
+    pending_buffer_ = nullptr;
+    pending_length_ = 0;
+    CompletionCallback callback = pending_callback_;
+    pending_callback_.Reset();
+    callback.Run(written);
+  }
+
+  // Fails the pending write with |error|.
+  void FailPendingWrite(int error) {
+    ASSERT_TRUE(has_pending_write());
+    pending_buffer_ = nullptr;
+    pending_length_ = 0;
+    CompletionCallback callback = pending_callback_;
+    pending_callback_.Reset();
+    callback.Run(error);
+  }
+
+  const string& data() const { return data_; }
+
+ private:
+  size_t accept_bytes_;
+  string data_;
+  scoped_refptr<IOBuffer> pending_buffer_;
+  size_t pending_length_;
+  CompletionCallback pending_callback_;
+  NetLogWithSource net_log_;
+};
+
+class QuicStreamSpliceAdapterTest : public QuicTest {
+ protected:
+  QuicStreamSpliceAdapterTest()
+      : connection_(new testing::NiceMock<MockQuicConnection>(
+            &helper_,
+            &alarm_factory_,
+            Perspective::IS_SERVER)),
+        session_(connection_),
+        done_status_(ERR_IO_PENDING),
+        done_count_(0) {
+    stream_ = new SplicedStream(
+        QuicSpdySessionPeer::GetNthClientInitiatedStreamId(session_, 0),
+        &session_);
+    session_.ActivateStream(QuicWrapUnique(stream_));
+    adapter_.reset(new QuicStreamSpliceAdapter(
+        stream_, &socket_,
+        base::Bind(&QuicStreamSpliceAdapterTest::OnSpliceDone,
+                   base::Unretained(this))));
+    stream_->set_adapter(adapter_.get());
+  }
+
+  void OnSpliceDone(int status) {
+    done_status_ = status;
+    ++done_count_;
+  }
+
+  void DeliverData(QuicStreamOffset offset, QuicStringPiece data, bool fin) {
+    stream_->OnStreamFrame(
+        QuicStreamFrame(stream_->id(), fin, offset, data));
+  }
+
+  MockQuicConnectionHelper helper_;
+  MockAlarmFactory alarm_factory_;
+  MockQuicConnection* connection_;  // Owned by |session_|.
+  testing::NiceMock<MockQuicSpdySession> session_;
+  SplicedStream* stream_;  // Owned by |session_|.
+  FakeStreamSocket socket_;
+  std::unique_ptr<QuicStreamSpliceAdapter> adapter_;
+  int done_status_;
+  int done_count_;
+};
+
+TEST_F(QuicStreamSpliceAdapterTest, SplicesSynchronously) {
+  DeliverData(0, "hello ", false);
+  DeliverData(6, "world", true);
+
+  EXPECT_EQ("hello world", socket_.data());
+  EXPECT_EQ(11u, adapter_->bytes_spliced());
+  EXPECT_TRUE(adapter_->finished());
+  EXPECT_EQ(1, done_count_);
+  EXPECT_EQ(OK, done_status_);
+}
+
+TEST_F(QuicStreamSpliceAdapterTest, BlockedSocketBackpressuresStream) {
+  socket_.set_accept_bytes(0);
+  DeliverData(0, "payload", true);
+
+  // The write is pending and nothing has been consumed from the sequencer,
+  // so the flow control window has not been extended.
+  EXPECT_TRUE(socket_.has_pending_write());
+  EXPECT_EQ(0u, adapter_->bytes_spliced());
+  EXPECT_FALSE(adapter_->finished());
+  EXPECT_TRUE(stream_->HasBytesToRead());
+
+  socket_.set_accept_bytes(SIZE_MAX);
+  socket_.CompletePendingWrite(7);
+
+  EXPECT_EQ("payload", socket_.data());
+  EXPECT_EQ(7u, adapter_->bytes_spliced());
+  EXPECT_TRUE(adapter_->finished());
+  EXPECT_EQ(OK, done_status_);
+  EXPECT_FALSE(stream_->HasBytesToRead());
+}
+
+TEST_F(QuicStreamSpliceAdapterTest, PartialWritesResumeWhereTheyLeftOff) {
+  socket_.set_accept_bytes(3);
+  DeliverData(0, "abcdef", true);
+
+  // Three bytes were accepted synchronously; the rest went pending.
+  EXPECT_TRUE(socket_.has_pending_write());
+  EXPECT_EQ(3u, adapter_->bytes_spliced());
+
+  socket_.set_accept_bytes(SIZE_MAX);
+  socket_.CompletePendingWrite(2);
+
+  EXPECT_EQ("abcdef", socket_.data());
+  EXPECT_EQ(6u, adapter_->bytes_spliced());
+  EXPECT_TRUE(adapter_->finished());
+  EXPECT_EQ(OK, done_status_);
+}
+
+TEST_F(QuicStreamSpliceAdapterTest, SocketErrorReported) {
+  socket_.set_accept_bytes(0);
+  DeliverData(0, "doomed", true);
+  ASSERT_TRUE(socket_.has_pending_write());
+
+  socket_.FailPendingWrite(ERR_CONNECTION_RESET);
+
+  EXPECT_TRUE(adapter_->finished());
+  EXPECT_EQ(1, done_count_);
+  EXPECT_EQ(ERR_CONNECTION_RESET, done_status_);
+}
+
+TEST_F(QuicStreamSpliceAdapterTest, DataArrivingDuringPendingWriteIsDrained) {
+  socket_.set_accept_bytes(0);
+  DeliverData(0, "first", false);
+  ASSERT_TRUE(socket_.has_pending_write());
+
+  // More data arrives while the socket is blocked; it must not be dropped.
+  DeliverData(5, "second", true);
+
+  socket_.set_accept_bytes(SIZE_MAX);
+  socket_.CompletePendingWrite(5);
+
+  EXPECT_EQ("firstsecond", socket_.data());
+  EXPECT_EQ(11u, adapter_->bytes_spliced());
+  EXPECT_TRUE(adapter_->finished());
+  EXPECT_EQ(OK, done_status_);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -6,6 +6,7 @@
 
 #include <errno.h>
 
+#include <algorithm>
 #include <memory>
 
 #include "base/macros.h"
@@ -24,6 +25,10 @@
 
 namespace net {
 
+const size_t QuicTimeWaitListManager::kTimeWaitWheelSlots;
+const size_t QuicTimeWaitListManager::kMaxConnectionsToExpirePerCleanUp;
+const size_t QuicTimeWaitListManager::kMaxTrackedResetAddresses;
+
 // A very simple alarm that just informs the QuicTimeWaitListManager to clean
 // up old connection_ids. This alarm should be cancelled and deleted before
 // the QuicTimeWaitListManager is deleted.
@@ -79,6 +84,12 @@ QuicTimeWaitListManager::QuicTimeWaitListManager(
     QuicAlarmFactory* alarm_factory)
     : time_wait_period_(
           QuicTime::Delta::FromSeconds(FLAGS_quic_time_wait_list_seconds)),
+      wheel_(kTimeWaitWheelSlots),
+      wheel_head_(0),
+      wheel_granularity_us_(
+          std::max(static_cast<int64_t>(1),
+                   time_wait_period_.ToMicroseconds() /
+                       static_cast<int64_t>(kTimeWaitWheelSlots))),
       connection_id_clean_up_alarm_(
           alarm_factory->CreateAlarm(new ConnectionIdCleanUpAlarm(this))),
       clock_(helper->GetClock()),
@@ -111,12 +122,20 @@ void QuicTimeWaitListManager::AddConnectionIdToTimeWait(
   TrimTimeWaitListIfNeeded();
   DCHECK_LT(num_connections(),
             static_cast<size_t>(FLAGS_quic_time_wait_list_max_connections));
-  ConnectionIdData data(num_packets, version, clock_->ApproximateNow(),
+  const QuicTime time_added = clock_->ApproximateNow();
+  ConnectionIdData data(num_packets, version, time_added,
                         connection_rejected_statelessly);
   if (termination_packets != nullptr) {
     data.termination_packets.swap(*termination_packets);
   }
-  connection_id_map_.emplace(std::make_pair(connection_id, std::move(data)));
+  connection_id_map_.insert(std::make_pair(connection_id, std::move(data)));
+  if (connection_id_map_.size() == 1) {
+    // The wheel was empty, so no slot holds the oldest live connection yet;
+    // start the head at this entry's slot.
+    wheel_head_ = WheelSlot(time_added);
+  }
+  WheelEntry entry = {connection_id, time_added};
+  wheel_[WheelSlot(time_added) % kTimeWaitWheelSlots].push_back(entry);
   if (new_connection_id) {
     visitor_->OnConnectionAddedToTimeWaitList(connection_id);
   }
@@ -188,6 +207,14 @@ void QuicTimeWaitListManager::SendVersionNegotiationPacket(
                                           connection_id, supported_versions)));
 }
 
+void QuicTimeWaitListManager::SendVersionNegotiationPacket(
+    std::unique_ptr<QuicEncryptedPacket> packet,
+    const QuicSocketAddress& server_address,
+    const QuicSocketAddress& client_address) {
+  SendOrQueuePacket(QuicMakeUnique<QueuedPacket>(server_address, client_address,
+                                                 std::move(packet)));
+}
+
 // Returns true if the number of packets received for this connection_id is a
 // power of 2 to throttle the number of public reset packets we send to a
 // client.
@@ -199,6 +226,22 @@ void QuicTimeWaitListManager::SendPublicReset(
     const QuicSocketAddress& server_address,
     const QuicSocketAddress& client_address,
     QuicConnectionId connection_id) {
+  if (!AllowPublicResetForAddress(client_address)) {
+    QUIC_DVLOG(1) << "Suppressed public reset for " << connection_id << " to "
+                  << client_address.ToString() << ": rate limit exceeded.";
+    return;
+  }
+  ConnectionIdMap::iterator it = connection_id_map_.find(connection_id);
+  if (it != connection_id_map_.end() &&
+      it->second.cached_public_reset != nullptr &&
+      it->second.cached_reset_client_address == client_address) {
+    // Reset storm fast path: resend the reset serialized for the previous
+    // stray packet from this source.
+    SendOrQueuePacket(QuicMakeUnique<QueuedPacket>(
+        server_address, client_address,
+        it->second.cached_public_reset->Clone()));
+    return;
+  }
   QuicPublicResetPacket packet;
   packet.public_header.connection_id = connection_id;
   packet.public_header.reset_flag = true;
@@ -206,9 +249,46 @@ void QuicTimeWaitListManager::SendPublicReset(
   // TODO(satyamshekhar): generate a valid nonce for this connection_id.
   packet.nonce_proof = 1010101;
   packet.client_address = client_address;
+  std::unique_ptr<QuicEncryptedPacket> reset = BuildPublicReset(packet);
+  if (it != connection_id_map_.end() && reset != nullptr) {
+    it->second.cached_public_reset = reset->Clone();
+    it->second.cached_reset_client_address = client_address;
+  }
   // Takes ownership of the packet.
   SendOrQueuePacket(QuicMakeUnique<QueuedPacket>(server_address, client_address,
-                                                 BuildPublicReset(packet)));
+                                                 std::move(reset)));
+}
+
+bool QuicTimeWaitListManager::AllowPublicResetForAddress(
+    const QuicSocketAddress& client_address) {
+  const int64_t resets_per_second =
+      FLAGS_quic_time_wait_public_resets_per_address_per_second;
+  if (resets_per_second <= 0) {
+    return true;
+  }
+  const QuicTime now = clock_->ApproximateNow();
+  const std::string key = client_address.host().ToPackedString();
+  ResetRateLimitMap::iterator it = reset_token_buckets_.find(key);
+  if (it == reset_token_buckets_.end()) {
+    if (reset_token_buckets_.size() >= kMaxTrackedResetAddresses) {
+      reset_token_buckets_.erase(reset_token_buckets_.begin());
+    }
+    ResetTokenBucket bucket = {resets_per_second - 1, now};
+    reset_token_buckets_.insert(std::make_pair(key, bucket));
+    return true;
+  }
+  ResetTokenBucket* bucket = &it->second;
+  const int64_t refill = (now - bucket->last_refill).ToMicroseconds() *
+                         resets_per_second / 1000000;
+  if (refill > 0) {
+    bucket->tokens = std::min(resets_per_second, bucket->tokens + refill);
+    bucket->last_refill = now;
+  }
+  if (bucket->tokens <= 0) {
+    return false;
+  }
+  --bucket->tokens;
+  return true;
 }
 
 std::unique_ptr<QuicEncryptedPacket> QuicTimeWaitListManager::BuildPublicReset(
@@ -252,9 +332,9 @@ bool QuicTimeWaitListManager::WriteToWire(QueuedPacket* queued_packet) {
 
 void QuicTimeWaitListManager::SetConnectionIdCleanUpAlarm() {
   QuicTime::Delta next_alarm_interval = QuicTime::Delta::Zero();
-  if (!connection_id_map_.empty()) {
-    QuicTime oldest_connection_id =
-        connection_id_map_.begin()->second.time_added;
+  ConnectionIdData* oldest_connection = FindOldestConnection();
+  if (oldest_connection != nullptr) {
+    QuicTime oldest_connection_id = oldest_connection->time_added;
     QuicTime now = clock_->ApproximateNow();
     if (now - oldest_connection_id < time_wait_period_) {
       next_alarm_interval = oldest_connection_id + time_wait_period_ - now;
@@ -271,19 +351,60 @@ void QuicTimeWaitListManager::SetConnectionIdCleanUpAlarm() {
       clock_->ApproximateNow() + next_alarm_interval, QuicTime::Delta::Zero());
 }
 
+uint64_t QuicTimeWaitListManager::WheelSlot(QuicTime time) const {
+  const int64_t time_us = (time - QuicTime::Zero()).ToMicroseconds();
+  return static_cast<uint64_t>(time_us / wheel_granularity_us_);
+}
+
+QuicTimeWaitListManager::ConnectionIdData*
+QuicTimeWaitListManager::FindOldestConnection() {
+  if (connection_id_map_.empty()) {
+    return nullptr;
+  }
+  // The map is non-empty, so some slot at or ahead of wheel_head_ holds a
+  // live entry; stale entries passed on the way are dropped.
+  while (true) {
+    std::deque<WheelEntry>& slot = wheel_[wheel_head_ % kTimeWaitWheelSlots];
+    if (slot.empty()) {
+      ++wheel_head_;
+      continue;
+    }
+    const WheelEntry& entry = slot.front();
+    if (WheelSlot(entry.time_added) > wheel_head_) {
+      // The front was added a full wheel revolution after the slot the head
+      // is scanning (the wheel's span equals time_wait_period_, so ring
+      // indices alias at the lifetime boundary).  Genuinely older entries
+      // may sit in later ring slots; skip this slot for now rather than
+      // report a brand-new connection as the oldest.
+      ++wheel_head_;
+      continue;
+    }
+    ConnectionIdMap::iterator it = connection_id_map_.find(entry.connection_id);
+    if (it == connection_id_map_.end() ||
+        it->second.time_added != entry.time_added) {
+      // The connection was trimmed, or reinserted with a fresh add time;
+      // this wheel entry is stale.
+      slot.pop_front();
+      continue;
+    }
+    return &it->second;
+  }
+}
+
 bool QuicTimeWaitListManager::MaybeExpireOldestConnection(
     QuicTime expiration_time) {
-  if (connection_id_map_.empty()) {
+  ConnectionIdData* oldest_connection = FindOldestConnection();
+  if (oldest_connection == nullptr) {
     return false;
   }
-  ConnectionIdMap::iterator it = connection_id_map_.begin();
-  QuicTime oldest_connection_id_time = it->second.time_added;
-  if (oldest_connection_id_time > expiration_time) {
+  if (oldest_connection->time_added > expiration_time) {
     // Too recent, don't retire.
     return false;
   }
   // This connection_id has lived its age, retire it now.
-  connection_id_map_.erase(it);
+  std::deque<WheelEntry>& slot = wheel_[wheel_head_ % kTimeWaitWheelSlots];
+  connection_id_map_.erase(slot.front().connection_id);
+  slot.pop_front();
   return true;
 }
 
@@ -291,7 +412,16 @@ void QuicTimeWaitListManager::CleanUpOldConnectionIds() {
   QuicTime now = clock_->ApproximateNow();
   QuicTime expiration = now - time_wait_period_;
 
-  while (MaybeExpireOldestConnection(expiration)) {
+  size_t num_expired = 0;
+  while (num_expired < kMaxConnectionsToExpirePerCleanUp &&
+         MaybeExpireOldestConnection(expiration)) {
+    ++num_expired;
+  }
+  if (num_expired == kMaxConnectionsToExpirePerCleanUp) {
+    // The backlog may be larger than the per-call budget; resume on the next
+    // event loop iteration instead of scanning it all in one pass.
+    connection_id_clean_up_alarm_->Update(now, QuicTime::Delta::Zero());
+    return;
   }
 
   SetConnectionIdCleanUpAlarm();
@@ -307,6 +437,12 @@ void QuicTimeWaitListManager::TrimTimeWaitListIfNeeded() {
   }
 }
 
+QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData()
+    : num_packets(0),
+      version(QUIC_VERSION_UNSUPPORTED),
+      time_added(QuicTime::Zero()),
+      connection_rejected_statelessly(false) {}
+
 QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData(
     int num_packets_,
     QuicVersion version_,
@@ -320,6 +456,9 @@ QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData(
 QuicTimeWaitListManager::ConnectionIdData::ConnectionIdData(
     ConnectionIdData&& other) = default;
 
+QuicTimeWaitListManager::ConnectionIdData& QuicTimeWaitListManager::
+    ConnectionIdData::operator=(ConnectionIdData&& other) = default;
+
 QuicTimeWaitListManager::ConnectionIdData::~ConnectionIdData() {}
 
 }  // namespace net
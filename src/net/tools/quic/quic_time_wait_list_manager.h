@@ -13,10 +13,13 @@
 
 #include <deque>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "base/macros.h"
 #include "net/quic/core/quic_blocked_writer_interface.h"
 #include "net/quic/core/quic_connection.h"
+#include "net/quic/core/quic_connection_id_map.h"
 #include "net/quic/core/quic_framer.h"
 #include "net/quic/core/quic_packet_writer.h"
 #include "net/quic/core/quic_packets.h"
@@ -115,6 +118,14 @@ class QuicTimeWaitListManager : public QuicBlockedWriterInterface {
       const QuicSocketAddress& server_address,
       const QuicSocketAddress& client_address);
 
+  // Like above, but sends |packet|, a version negotiation packet the caller
+  // already holds (e.g. from QuicVersionManager's precomputed cache),
+  // skipping serialization entirely.
+  virtual void SendVersionNegotiationPacket(
+      std::unique_ptr<QuicEncryptedPacket> packet,
+      const QuicSocketAddress& server_address,
+      const QuicSocketAddress& client_address);
+
  protected:
   virtual std::unique_ptr<QuicEncryptedPacket> BuildPublicReset(
       const QuicPublicResetPacket& packet);
@@ -151,16 +162,17 @@ class QuicTimeWaitListManager : public QuicBlockedWriterInterface {
   // Removes the oldest connection from the time-wait list if it was added prior
   // to "expiration_time".  To unconditionally remove the oldest connection, use
   // a QuicTime::Delta:Infinity().  This function modifies the
-  // connection_id_map_.  If you plan to call this function in a loop, any
-  // iterators that you hold before the call to this function may be invalid
-  // afterward.  Returns true if the oldest connection was expired.  Returns
-  // false if the map is empty or the oldest connection has not expired.
+  // connection_id_map_ and the expiry wheel.  If you plan to call this function
+  // in a loop, any iterators that you hold before the call to this function may
+  // be invalid afterward.  Returns true if the oldest connection was expired.
+  // Returns false if the map is empty or the oldest connection has not expired.
   bool MaybeExpireOldestConnection(QuicTime expiration_time);
 
   // A map from a recently closed connection_id to the number of packets
   // received after the termination of the connection bound to the
   // connection_id.
   struct ConnectionIdData {
+    ConnectionIdData();
     ConnectionIdData(int num_packets_,
                      QuicVersion version_,
                      QuicTime time_added_,
@@ -168,6 +180,7 @@ class QuicTimeWaitListManager : public QuicBlockedWriterInterface {
 
     ConnectionIdData(const ConnectionIdData& other) = delete;
     ConnectionIdData(ConnectionIdData&& other);
+    ConnectionIdData& operator=(ConnectionIdData&& other);
 
     ~ConnectionIdData();
 
@@ -177,12 +190,74 @@ class QuicTimeWaitListManager : public QuicBlockedWriterInterface {
     // These packets may contain CONNECTION_CLOSE frames, or SREJ messages.
     std::vector<std::unique_ptr<QuicEncryptedPacket>> termination_packets;
     bool connection_rejected_statelessly;
+    // Serialized public reset last sent for this connection, kept so a storm
+    // of stray packets from the same source degenerates to a memcpy instead
+    // of re-serializing an identical reset each time.  Populated lazily on
+    // the first stray packet; rebuilt only if the source address changes
+    // (the reset embeds the client address as the CADR holepunch hint).
+    std::unique_ptr<QuicEncryptedPacket> cached_public_reset;
+    QuicSocketAddress cached_reset_client_address;
   };
 
-  // QuicLinkedHashMap allows lookup by ConnectionId and traversal in add order.
-  typedef QuicLinkedHashMap<QuicConnectionId, ConnectionIdData> ConnectionIdMap;
+  // An entry on the expiry wheel.  |time_added| lets stale entries (left
+  // behind when a connection ID is reinserted or trimmed) be recognized and
+  // discarded lazily when the wheel head reaches them.
+  struct WheelEntry {
+    QuicConnectionId connection_id;
+    QuicTime time_added;
+  };
+
+  // Per-source-address budget for public resets.  Tokens refill at
+  // FLAGS_quic_time_wait_public_resets_per_address_per_second and cap at one
+  // second's worth, so a reflection event costs each source at most that many
+  // resets per second no matter how many stray packets it sends.
+  struct ResetTokenBucket {
+    int64_t tokens;
+    QuicTime last_refill;
+  };
+
+  // Consumes a token from |client_address|'s bucket.  Returns false if the
+  // bucket is empty and the reset should be suppressed.  Always returns true
+  // when rate limiting is disabled (the flag is zero or negative).
+  bool AllowPublicResetForAddress(const QuicSocketAddress& client_address);
+
+  // Discards stale wheel entries from the front of the wheel and positions
+  // wheel_head_ on the slot holding the oldest live connection.  Returns a
+  // pointer to that connection's map entry, or nullptr if the list is empty.
+  // The returned connection is the front of wheel_[wheel_head_].
+  ConnectionIdData* FindOldestConnection();
+
+  // Returns the absolute (non-wrapping) wheel slot covering |time|; the
+  // ring index is the value modulo kTimeWaitWheelSlots.
+  uint64_t WheelSlot(QuicTime time) const;
+
+  // Number of slots on the expiry wheel; must be a power of two.  Each slot
+  // covers time_wait_period_ / kTimeWaitWheelSlots, so entries that expire
+  // within the same fraction of the wait period share a slot.
+  static const size_t kTimeWaitWheelSlots = 128;
+
+  // Upper bound on the number of connection IDs retired by a single firing of
+  // the clean up alarm.  When the backlog is larger (e.g. after a churn
+  // storm), the alarm re-arms for the next event loop iteration instead of
+  // stalling the dispatcher on one long scan.
+  static const size_t kMaxConnectionsToExpirePerCleanUp = 128;
+
+  // Cap on the number of source addresses with tracked reset token buckets.
+  // When the cap is hit the oldest tracked address is dropped, so a spoofed
+  // source flood cannot grow the map without bound.
+  static const size_t kMaxTrackedResetAddresses = 1024;
+
+  // Flat open-addressed table for per-packet lookup.  Traversal in add order
+  // is provided by the expiry wheel below, not by the map.
+  typedef QuicConnectionIdMap<ConnectionIdData> ConnectionIdMap;
   ConnectionIdMap connection_id_map_;
 
+  // Reset token buckets keyed by packed source IP, in add order so the
+  // oldest tracked address can be evicted when kMaxTrackedResetAddresses is
+  // reached.  Only populated while rate limiting is enabled.
+  typedef QuicLinkedHashMap<std::string, ResetTokenBucket> ResetRateLimitMap;
+  ResetRateLimitMap reset_token_buckets_;
+
   // Pending public reset packets that need to be sent out to the client
   // when we are given a chance to write by the dispatcher.
   std::deque<std::unique_ptr<QueuedPacket>> pending_packets_queue_;
@@ -190,6 +265,26 @@ class QuicTimeWaitListManager : public QuicBlockedWriterInterface {
   // Time period for which connection_ids should remain in time wait state.
   const QuicTime::Delta time_wait_period_;
 
+  // Hashed timer wheel holding connection IDs in expiry order.  A connection
+  // is appended to the ring slot covering its add time; since every
+  // connection lives for exactly time_wait_period_, slot order starting at
+  // wheel_head_ (and insertion order within a slot) is expiry order.  The
+  // wheel's span equals time_wait_period_, so ring indices alias across
+  // revolutions; each entry's revolution is recovered from |time_added|
+  // when the head reaches it.  Entries are not removed eagerly on reinsert
+  // or trim; they are dropped when the head reaches them and their
+  // |time_added| no longer matches the map.
+  std::vector<std::deque<WheelEntry>> wheel_;
+
+  // Absolute slot of the oldest live connection, or an arbitrary slot if
+  // the list is empty.  Never decreases, so entries from a later wheel
+  // revolution sharing the head's ring slot are not mistaken for the
+  // oldest.
+  uint64_t wheel_head_;
+
+  // Width of one wheel slot, in microseconds.
+  const int64_t wheel_granularity_us_;
+
   // Alarm to clean up connection_ids that have out lived their duration in
   // time wait state.
   std::unique_ptr<QuicAlarm> connection_id_clean_up_alarm_;
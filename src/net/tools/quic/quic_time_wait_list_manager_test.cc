@@ -26,6 +26,7 @@
 #include "net/tools/quic/test_tools/mock_epoll_server.h"
 #include "net/tools/quic/test_tools/mock_quic_session_visitor.h"
 
+using testing::AnyNumber;
 using testing::Args;
 using testing::Assign;
 using testing::DoAll;
@@ -330,6 +331,42 @@ TEST_F(QuicTimeWaitListManagerTest, CleanUpOldConnectionIds) {
             time_wait_list_manager_.num_connections());
 }
 
+TEST_F(QuicTimeWaitListManagerTest, WheelSlotAliasingDoesNotHideConnections) {
+  // The wheel's span equals time_wait_period_, so a connection added exactly
+  // one period after another lands in the same ring slot. Such a connection
+  // must not be mistaken for the oldest entry when the slot's expired
+  // original is popped, or genuinely older entries in later slots would
+  // never expire.
+  EXPECT_CALL(epoll_server_, RegisterAlarm(_, _)).Times(AnyNumber());
+  const QuicTime::Delta time_wait_period =
+      QuicTimeWaitListManagerPeer::time_wait_period(&time_wait_list_manager_);
+
+  epoll_server_.set_now_in_usec(0);
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(1));
+  AddConnectionId(1);
+
+  epoll_server_.set_now_in_usec(time_wait_period.ToMicroseconds() / 2);
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(2));
+  AddConnectionId(2);
+
+  // Connection 3 shares connection 1's ring slot, one revolution later.
+  epoll_server_.set_now_in_usec(time_wait_period.ToMicroseconds());
+  EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(3));
+  AddConnectionId(3);
+  time_wait_list_manager_.CleanUpOldConnectionIds();
+  EXPECT_FALSE(IsConnectionIdInTimeWait(1));
+  EXPECT_TRUE(IsConnectionIdInTimeWait(2));
+  EXPECT_TRUE(IsConnectionIdInTimeWait(3));
+
+  // Half a period later connection 2 has lived its age; connection 3, though
+  // at the front of the head's ring slot, has not.
+  epoll_server_.set_now_in_usec(3 * time_wait_period.ToMicroseconds() / 2 + 1);
+  time_wait_list_manager_.CleanUpOldConnectionIds();
+  EXPECT_FALSE(IsConnectionIdInTimeWait(2));
+  EXPECT_TRUE(IsConnectionIdInTimeWait(3));
+  EXPECT_EQ(1u, time_wait_list_manager_.num_connections());
+}
+
 TEST_F(QuicTimeWaitListManagerTest, SendQueuedPackets) {
   QuicConnectionId connection_id = 1;
   EXPECT_CALL(visitor_, OnConnectionAddedToTimeWaitList(connection_id));
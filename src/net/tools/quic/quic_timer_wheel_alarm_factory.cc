@@ -0,0 +1,260 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_timer_wheel_alarm_factory.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "net/quic/platform/api/quic_bug_tracker.h"
+#include "net/tools/epoll_server/epoll_server.h"
+
+namespace net {
+
+const int64_t QuicTimerWheelAlarmFactory::kSlotGranularityBits;
+const int64_t QuicTimerWheelAlarmFactory::kSlotGranularityUs;
+const int64_t QuicTimerWheelAlarmFactory::kWheelBits;
+const int64_t QuicTimerWheelAlarmFactory::kSlotsPerWheel;
+const int64_t QuicTimerWheelAlarmFactory::kSlotMask;
+const int QuicTimerWheelAlarmFactory::kNumWheels;
+
+// An alarm whose SetImpl/CancelImpl link and unlink its embedded node in the
+// factory's wheel instead of touching the EpollServer alarm map.
+class QuicTimerWheelAlarmFactory::TimerWheelAlarm : public QuicAlarm {
+ public:
+  TimerWheelAlarm(QuicTimerWheelAlarmFactory* factory,
+                  QuicArenaScopedPtr<Delegate> delegate)
+      : QuicAlarm(std::move(delegate)), factory_(factory) {
+    node_.prev = nullptr;
+    node_.next = nullptr;
+    node_.deadline_tick = 0;
+    node_.alarm = this;
+  }
+
+  ~TimerWheelAlarm() override { factory_->Cancel(&node_); }
+
+  // Called by the factory when the wheel reaches the alarm's slot.
+  void OnExpiry() { Fire(); }
+
+ protected:
+  void SetImpl() override {
+    DCHECK(deadline().IsInitialized());
+    factory_->Arm(&node_, (deadline() - QuicTime::Zero()).ToMicroseconds());
+  }
+
+  void CancelImpl() override {
+    DCHECK(!deadline().IsInitialized());
+    factory_->Cancel(&node_);
+  }
+
+ private:
+  QuicTimerWheelAlarmFactory* factory_;
+  AlarmNode node_;
+};
+
+// The single EpollServer alarm driving the wheel. Its return value from
+// OnAlarm re-registers it for the next wakeup the wheel needs.
+class QuicTimerWheelAlarmFactory::WheelDriver : public EpollAlarm {
+ public:
+  explicit WheelDriver(QuicTimerWheelAlarmFactory* factory)
+      : factory_(factory) {}
+
+  int64_t OnAlarm() override {
+    EpollAlarm::OnAlarm();
+    return factory_->OnDriverAlarm();
+  }
+
+ private:
+  QuicTimerWheelAlarmFactory* factory_;
+};
+
+QuicTimerWheelAlarmFactory::QuicTimerWheelAlarmFactory(
+    EpollServer* epoll_server)
+    : epoll_server_(epoll_server),
+      current_tick_(epoll_server->NowInUsec() >> kSlotGranularityBits),
+      num_armed_(0),
+      registered_wakeup_us_(0),
+      processing_(false),
+      driver_(new WheelDriver(this)) {
+  for (int level = 0; level < kNumWheels; ++level) {
+    for (int64_t slot = 0; slot < kSlotsPerWheel; ++slot) {
+      AlarmNode* head = &slots_[level][slot];
+      head->prev = head;
+      head->next = head;
+      head->deadline_tick = 0;
+      head->alarm = nullptr;
+    }
+  }
+}
+
+QuicTimerWheelAlarmFactory::~QuicTimerWheelAlarmFactory() {}
+
+QuicAlarm* QuicTimerWheelAlarmFactory::CreateAlarm(
+    QuicAlarm::Delegate* delegate) {
+  return new TimerWheelAlarm(this,
+                             QuicArenaScopedPtr<QuicAlarm::Delegate>(delegate));
+}
+
+QuicArenaScopedPtr<QuicAlarm> QuicTimerWheelAlarmFactory::CreateAlarm(
+    QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+    QuicConnectionArena* arena) {
+  if (arena != nullptr) {
+    return arena->New<TimerWheelAlarm>(this, std::move(delegate));
+  }
+  return QuicArenaScopedPtr<QuicAlarm>(
+      new TimerWheelAlarm(this, std::move(delegate)));
+}
+
+void QuicTimerWheelAlarmFactory::Arm(AlarmNode* node, int64_t deadline_us) {
+  DCHECK(node->next == nullptr);
+  if (num_armed_ == 0 && !processing_) {
+    // The wheel has been idle; catch the tick up so placement is relative
+    // to the present rather than the last firing.
+    current_tick_ = std::max(
+        current_tick_, epoll_server_->ApproximateNowInUsec() >> kSlotGranularityBits);
+  }
+  // Round the deadline up to the slot boundary at or after it, so the alarm
+  // never fires early and nearby deadlines share a slot.
+  node->deadline_tick =
+      (deadline_us + kSlotGranularityUs - 1) >> kSlotGranularityBits;
+  Place(node, current_tick_ + 1);
+  ++num_armed_;
+  if (processing_) {
+    // The driver re-registers from OnDriverAlarm's return value once the
+    // current batch of firings completes.
+    return;
+  }
+  const int64_t target_us = std::max(node->deadline_tick, current_tick_ + 1)
+                            << kSlotGranularityBits;
+  if (registered_wakeup_us_ == 0 || target_us < registered_wakeup_us_) {
+    driver_->UnregisterIfRegistered();
+    epoll_server_->RegisterAlarm(target_us, driver_.get());
+    registered_wakeup_us_ = target_us;
+  }
+}
+
+void QuicTimerWheelAlarmFactory::Cancel(AlarmNode* node) {
+  if (node->next == nullptr) {
+    return;
+  }
+  node->prev->next = node->next;
+  node->next->prev = node->prev;
+  node->prev = nullptr;
+  node->next = nullptr;
+  --num_armed_;
+}
+
+void QuicTimerWheelAlarmFactory::Place(AlarmNode* node, int64_t min_tick) {
+  // Clamp far deadlines into the outermost wheel; they re-place themselves
+  // closer to their real tick each time they cascade.
+  const int64_t max_tick =
+      current_tick_ + (INT64_C(1) << (kWheelBits * kNumWheels)) - 1;
+  const int64_t tick =
+      std::min(std::max(node->deadline_tick, min_tick), max_tick);
+  const int64_t delta = tick - current_tick_;
+  int level = 0;
+  while (level < kNumWheels - 1 &&
+         delta >= (INT64_C(1) << (kWheelBits * (level + 1)))) {
+    ++level;
+  }
+  AlarmNode* head = &slots_[level][(tick >> (kWheelBits * level)) & kSlotMask];
+  node->prev = head->prev;
+  node->next = head;
+  head->prev->next = node;
+  head->prev = node;
+}
+
+void QuicTimerWheelAlarmFactory::Process(int64_t now_us) {
+  const int64_t now_tick = now_us >> kSlotGranularityBits;
+  while (current_tick_ < now_tick) {
+    if (num_armed_ == 0) {
+      current_tick_ = now_tick;
+      break;
+    }
+    ++current_tick_;
+    if ((current_tick_ & kSlotMask) == 0) {
+      Cascade();
+    }
+    FireCurrentSlot();
+  }
+}
+
+void QuicTimerWheelAlarmFactory::Cascade() {
+  for (int level = 1; level < kNumWheels; ++level) {
+    const size_t slot = (current_tick_ >> (kWheelBits * level)) & kSlotMask;
+    AlarmNode* head = &slots_[level][slot];
+    AlarmNode* node = head->next;
+    // Empty the ring first; an entry a full wheel revolution away may be
+    // re-placed into the very slot being drained.
+    head->prev = head;
+    head->next = head;
+    while (node != head) {
+      AlarmNode* next = node->next;
+      // Entries due this tick land in the level 0 slot fired right after
+      // the cascade.
+      Place(node, current_tick_);
+      node = next;
+    }
+    // An outer slot is drained only when every slot below it has wrapped.
+    if (slot != 0) {
+      break;
+    }
+  }
+}
+
+void QuicTimerWheelAlarmFactory::FireCurrentSlot() {
+  AlarmNode* head = &slots_[0][current_tick_ & kSlotMask];
+  while (head->next != head) {
+    AlarmNode* node = head->next;
+    Cancel(node);
+    node->alarm->OnExpiry();
+  }
+}
+
+int64_t QuicTimerWheelAlarmFactory::NextWakeupUs() const {
+  if (num_armed_ == 0) {
+    return 0;
+  }
+  int64_t next_us = std::numeric_limits<int64_t>::max();
+  // The earliest level 0 entry is in the first occupied slot ahead of the
+  // current tick.
+  for (int64_t i = 1; i <= kSlotsPerWheel; ++i) {
+    const int64_t tick = current_tick_ + i;
+    const AlarmNode* head = &slots_[0][tick & kSlotMask];
+    if (head->next != head) {
+      next_us = tick << kSlotGranularityBits;
+      break;
+    }
+  }
+  // An outer level entry may cascade - and therefore possibly fire - before
+  // any level 0 entry; wake at the first occupied outer slot's boundary.
+  for (int level = 1; level < kNumWheels; ++level) {
+    const int64_t base = current_tick_ >> (kWheelBits * level);
+    for (int64_t i = 1; i <= kSlotsPerWheel; ++i) {
+      const AlarmNode* head = &slots_[level][(base + i) & kSlotMask];
+      if (head->next != head) {
+        next_us = std::min(next_us, ((base + i) << (kWheelBits * level))
+                                        << kSlotGranularityBits);
+        break;
+      }
+    }
+  }
+  if (next_us == std::numeric_limits<int64_t>::max()) {
+    QUIC_BUG << "Timer wheel has " << num_armed_
+             << " armed alarms but no occupied slot.";
+    return 0;
+  }
+  return next_us;
+}
+
+int64_t QuicTimerWheelAlarmFactory::OnDriverAlarm() {
+  registered_wakeup_us_ = 0;
+  processing_ = true;
+  Process(epoll_server_->NowInUsec());
+  processing_ = false;
+  registered_wakeup_us_ = NextWakeupUs();
+  return registered_wakeup_us_;
+}
+
+}  // namespace net
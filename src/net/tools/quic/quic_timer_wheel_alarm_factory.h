@@ -0,0 +1,116 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef NET_TOOLS_QUIC_QUIC_TIMER_WHEEL_ALARM_FACTORY_H_
+#define NET_TOOLS_QUIC_QUIC_TIMER_WHEEL_ALARM_FACTORY_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "net/quic/core/quic_alarm.h"
+#include "net/quic/core/quic_alarm_factory.h"
+
+namespace net {
+
+class EpollServer;
+
+// Creates alarms that share one hierarchical timer wheel driven by a single
+// EpollServer alarm, instead of registering every alarm with EpollServer's
+// time-ordered alarm map. Arming and cancelling an alarm are O(1) intrusive
+// list operations; the EpollServer alarm map is only touched when an alarm
+// needs an earlier wakeup than the one already registered, so the common
+// pattern of pushing a retransmission or ack deadline further out costs
+// nothing. Deadlines are rounded up to the next wheel slot boundary, which
+// both bounds how late an alarm may fire and coalesces near-simultaneous
+// deadlines into one wakeup. The factory must outlive the alarms it creates.
+class QuicTimerWheelAlarmFactory : public QuicAlarmFactory {
+ public:
+  explicit QuicTimerWheelAlarmFactory(EpollServer* epoll_server);
+  ~QuicTimerWheelAlarmFactory() override;
+
+  // QuicAlarmFactory interface.
+  QuicAlarm* CreateAlarm(QuicAlarm::Delegate* delegate) override;
+  QuicArenaScopedPtr<QuicAlarm> CreateAlarm(
+      QuicArenaScopedPtr<QuicAlarm::Delegate> delegate,
+      QuicConnectionArena* arena) override;
+
+  // Microseconds covered by one slot of the innermost wheel. An alarm fires
+  // at the first slot boundary at or after its deadline, so it may fire up
+  // to this much late, and alarms whose deadlines round up to the same
+  // boundary fire in one batch.
+  static const int64_t kSlotGranularityBits = 10;
+  static const int64_t kSlotGranularityUs = 1 << kSlotGranularityBits;
+
+ private:
+  class TimerWheelAlarm;
+  class WheelDriver;
+
+  // Each wheel level holds kSlotsPerWheel slots; level N slots span
+  // kSlotsPerWheel^N ticks, so four levels cover roughly 50 days at 1.024ms
+  // per tick. Entries in outer levels cascade towards level 0 as the wheel
+  // turns and fire from level 0 slots only.
+  static const int64_t kWheelBits = 8;
+  static const int64_t kSlotsPerWheel = 1 << kWheelBits;
+  static const int64_t kSlotMask = kSlotsPerWheel - 1;
+  static const int kNumWheels = 4;
+
+  // Intrusive node linking an alarm into its wheel slot; the slot heads are
+  // sentinel nodes of circular lists. A node with null links is unarmed.
+  struct AlarmNode {
+    AlarmNode* prev;
+    AlarmNode* next;
+    int64_t deadline_tick;
+    TimerWheelAlarm* alarm;
+  };
+
+  // Arms |node| to fire at |deadline_us|, registering an earlier epoll
+  // wakeup if the one currently registered would be too late.
+  void Arm(AlarmNode* node, int64_t deadline_us);
+
+  // Unlinks |node| from its slot if armed. Any wakeup registered on its
+  // behalf is left to expire as a no-op.
+  void Cancel(AlarmNode* node);
+
+  // Links |node| into the wheel level and slot matching its deadline tick,
+  // clamped to fire no earlier than |min_tick|.
+  void Place(AlarmNode* node, int64_t min_tick);
+
+  // Advances the wheel tick by tick up to |now_us|, cascading outer levels
+  // and firing every alarm that has come due.
+  void Process(int64_t now_us);
+
+  // Moves the entries of the outer slots reached by current_tick_ down a
+  // level; called whenever the level below has wrapped.
+  void Cascade();
+
+  // Fires all alarms in the level 0 slot for current_tick_.
+  void FireCurrentSlot();
+
+  // Returns the next time the driver must wake to fire or cascade the
+  // earliest armed alarm, or 0 when nothing is armed.
+  int64_t NextWakeupUs() const;
+
+  // Called by the driver when the registered wakeup fires; returns the next
+  // wakeup time for the EpollServer to re-register, or 0 for none.
+  int64_t OnDriverAlarm();
+
+  EpollServer* epoll_server_;  // Not owned.
+  // The last tick whose slot has been fired.
+  int64_t current_tick_;
+  // Number of alarms currently linked into the wheel.
+  size_t num_armed_;
+  // Wakeup time the driver is registered for with the EpollServer, or 0.
+  int64_t registered_wakeup_us_;
+  // True while Process() runs; arms during firing defer re-registration to
+  // the driver's return value.
+  bool processing_;
+  std::unique_ptr<WheelDriver> driver_;
+  AlarmNode slots_[kNumWheels][kSlotsPerWheel];
+
+  DISALLOW_COPY_AND_ASSIGN(QuicTimerWheelAlarmFactory);
+};
+
+}  // namespace net
+
+#endif  // NET_TOOLS_QUIC_QUIC_TIMER_WHEEL_ALARM_FACTORY_H_
@@ -0,0 +1,178 @@
+// Copyright (c) 2017 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "net/tools/quic/quic_timer_wheel_alarm_factory.h"
+
+#include "net/quic/platform/api/quic_test.h"
+#include "net/tools/quic/platform/impl/quic_epoll_clock.h"
+#include "net/tools/quic/test_tools/mock_epoll_server.h"
+
+namespace net {
+namespace test {
+namespace {
+
+const int64_t kGranularityUs = QuicTimerWheelAlarmFactory::kSlotGranularityUs;
+
+class TestDelegate : public QuicAlarm::Delegate {
+ public:
+  TestDelegate() : fired_(false) {}
+
+  void OnAlarm() override { fired_ = true; }
+
+  bool fired() const { return fired_; }
+
+ private:
+  bool fired_;
+};
+
+// The boolean parameter denotes whether or not to use an arena.
+class QuicTimerWheelAlarmFactoryTest : public QuicTestWithParam<bool> {
+ protected:
+  QuicTimerWheelAlarmFactoryTest()
+      : clock_(&epoll_server_), alarm_factory_(&epoll_server_) {}
+
+  QuicConnectionArena* GetArenaParam() {
+    return GetParam() ? &arena_ : nullptr;
+  }
+
+  QuicArenaScopedPtr<QuicAlarm> CreateAlarm(
+      QuicArenaScopedPtr<QuicAlarm::Delegate> delegate) {
+    return alarm_factory_.CreateAlarm(std::move(delegate), GetArenaParam());
+  }
+
+  test::MockEpollServer epoll_server_;
+  const QuicEpollClock clock_;
+  QuicTimerWheelAlarmFactory alarm_factory_;
+  QuicConnectionArena arena_;
+};
+
+INSTANTIATE_TEST_CASE_P(UseArena,
+                        QuicTimerWheelAlarmFactoryTest,
+                        ::testing::ValuesIn({true, false}));
+
+TEST_P(QuicTimerWheelAlarmFactoryTest, CreateAlarm) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(CreateAlarm(std::move(delegate)));
+
+  QuicTime start = clock_.Now();
+  QuicTime::Delta delta = QuicTime::Delta::FromMicroseconds(kGranularityUs);
+  alarm->Set(start + delta);
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(delta.ToMicroseconds());
+  EXPECT_EQ(start + delta, clock_.Now());
+  EXPECT_TRUE(unowned_delegate->fired());
+}
+
+TEST_P(QuicTimerWheelAlarmFactoryTest, RoundsDeadlineUpToSlotBoundary) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(CreateAlarm(std::move(delegate)));
+
+  // A deadline inside a slot fires at the end of that slot, never early.
+  alarm->Set(clock_.Now() + QuicTime::Delta::FromMicroseconds(100));
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(100);
+  EXPECT_FALSE(unowned_delegate->fired());
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(kGranularityUs - 100);
+  EXPECT_TRUE(unowned_delegate->fired());
+}
+
+TEST_P(QuicTimerWheelAlarmFactoryTest, CoalescesNearbyDeadlines) {
+  QuicArenaScopedPtr<TestDelegate> delegate1 =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  QuicArenaScopedPtr<TestDelegate> delegate2 =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate1 = delegate1.get();
+  TestDelegate* unowned_delegate2 = delegate2.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm1(CreateAlarm(std::move(delegate1)));
+  QuicArenaScopedPtr<QuicAlarm> alarm2(CreateAlarm(std::move(delegate2)));
+
+  // Deadlines in the same slot fire in one batch at its boundary.
+  alarm1->Set(clock_.Now() + QuicTime::Delta::FromMicroseconds(100));
+  alarm2->Set(clock_.Now() + QuicTime::Delta::FromMicroseconds(1000));
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(kGranularityUs);
+  EXPECT_TRUE(unowned_delegate1->fired());
+  EXPECT_TRUE(unowned_delegate2->fired());
+}
+
+TEST_P(QuicTimerWheelAlarmFactoryTest, CreateAlarmAndCancel) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(CreateAlarm(std::move(delegate)));
+
+  alarm->Set(clock_.Now() + QuicTime::Delta::FromMicroseconds(kGranularityUs));
+  alarm->Cancel();
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(kGranularityUs);
+  EXPECT_FALSE(unowned_delegate->fired());
+}
+
+TEST_P(QuicTimerWheelAlarmFactoryTest, CreateAlarmAndReset) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(CreateAlarm(std::move(delegate)));
+
+  alarm->Set(clock_.Now() + QuicTime::Delta::FromMicroseconds(kGranularityUs));
+  alarm->Cancel();
+  alarm->Set(clock_.Now() +
+             QuicTime::Delta::FromMicroseconds(3 * kGranularityUs));
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(kGranularityUs);
+  EXPECT_FALSE(unowned_delegate->fired());
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(2 * kGranularityUs);
+  EXPECT_TRUE(unowned_delegate->fired());
+}
+
+TEST_P(QuicTimerWheelAlarmFactoryTest, CreateAlarmAndUpdate) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(CreateAlarm(std::move(delegate)));
+
+  alarm->Set(clock_.Now() + QuicTime::Delta::FromMicroseconds(kGranularityUs));
+  alarm->Update(clock_.Now() +
+                    QuicTime::Delta::FromMicroseconds(3 * kGranularityUs),
+                QuicTime::Delta::FromMicroseconds(1));
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(kGranularityUs);
+  EXPECT_FALSE(unowned_delegate->fired());
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(2 * kGranularityUs);
+  EXPECT_TRUE(unowned_delegate->fired());
+
+  // Update with an uninitialized time cancels the alarm.
+  alarm->Set(clock_.Now() + QuicTime::Delta::FromMicroseconds(kGranularityUs));
+  alarm->Update(QuicTime::Zero(), QuicTime::Delta::FromMicroseconds(1));
+  EXPECT_FALSE(alarm->IsSet());
+}
+
+TEST_P(QuicTimerWheelAlarmFactoryTest, OuterWheelAlarmFires) {
+  QuicArenaScopedPtr<TestDelegate> delegate =
+      QuicArenaScopedPtr<TestDelegate>(new TestDelegate());
+  TestDelegate* unowned_delegate = delegate.get();
+  QuicArenaScopedPtr<QuicAlarm> alarm(CreateAlarm(std::move(delegate)));
+
+  // A deadline beyond the innermost wheel's range lands in an outer level
+  // and cascades down as the wheel turns.
+  const int64_t far_us = 400 * kGranularityUs;
+  alarm->Set(clock_.Now() + QuicTime::Delta::FromMicroseconds(far_us));
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(far_us - kGranularityUs);
+  EXPECT_FALSE(unowned_delegate->fired());
+
+  epoll_server_.AdvanceByExactlyAndCallCallbacks(kGranularityUs);
+  EXPECT_TRUE(unowned_delegate->fired());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace net
@@ -314,8 +314,12 @@ Connection::Connection()
       cache_size_(0),
       exclusive_locking_(false),
       restrict_to_user_(false),
+      journal_mode_wal_(false),
       transaction_nesting_(0),
       needs_rollback_(false),
+      max_batched_writes_(0),
+      batch_open_(false),
+      batch_write_count_(0),
       in_memory_(false),
       poisoned_(false),
       mmap_disabled_(false),
@@ -1283,11 +1287,65 @@ bool Connection::CommitTransaction() {
 
 void Connection::RollbackAllTransactions() {
   if (transaction_nesting_ > 0) {
+    batch_open_ = false;
     transaction_nesting_ = 0;
     DoRollback();
   }
 }
 
+bool Connection::BeginBatchedWrite() {
+  if (!max_batched_writes_)
+    return BeginTransaction();
+
+  // A batch marked for rollback cannot accept further writes; close it out
+  // (which performs the rollback) so this write can start fresh.
+  if (batch_open_ && needs_rollback_)
+    ignore_result(FlushBatchedWrites());
+
+  if (!batch_open_) {
+    if (!BeginTransaction())
+      return false;
+    batch_open_ = true;
+    batch_write_count_ = 0;
+    batch_start_time_ = Now();
+  }
+
+  // The write itself runs in a nested transaction, which is bookkeeping only;
+  // the real commit happens when the batch closes.
+  return BeginTransaction();
+}
+
+bool Connection::EndBatchedWrite() {
+  if (!max_batched_writes_)
+    return CommitTransaction();
+
+  if (!batch_open_) {
+    DLOG_IF(FATAL, !poisoned_) << "Ending a batched write with no open batch";
+    return false;
+  }
+
+  if (!CommitTransaction()) {
+    // The nested transaction was rolled back, which dooms the whole batch;
+    // close it out now rather than discarding later writes with it.
+    ignore_result(FlushBatchedWrites());
+    return false;
+  }
+
+  batch_write_count_++;
+  if (batch_write_count_ >= max_batched_writes_ ||
+      Now() - batch_start_time_ >= max_batch_latency_) {
+    return FlushBatchedWrites();
+  }
+  return true;
+}
+
+bool Connection::FlushBatchedWrites() {
+  if (!batch_open_)
+    return true;
+  batch_open_ = false;
+  return CommitTransaction();
+}
+
 bool Connection::AttachDatabase(const base::FilePath& other_db_path,
                                 const char* attachment_point) {
   DCHECK(ValidAttachmentPoint(attachment_point));
@@ -1741,10 +1799,21 @@ bool Connection::OpenInternal(const std::string& file_name,
   // DELETE (default) - delete -journal file to commit.
   // TRUNCATE - truncate -journal file to commit.
   // PERSIST - zero out header of -journal file to commit.
+  // WAL - append commits to a -wal file, sync on checkpoint.
   // TRUNCATE should be faster than DELETE because it won't need directory
   // changes for each transaction.  PERSIST may break the spirit of using
-  // secure_delete.
-  ignore_result(Execute("PRAGMA journal_mode = TRUNCATE"));
+  // secure_delete.  WAL groups the sync cost of consecutive commits but
+  // requires SHM support and is incompatible with exclusive locking for
+  // other connections, so it is opt-in (see set_journal_mode_wal()).
+  if (journal_mode_wal_ && !in_memory_) {
+    if (Execute("PRAGMA journal_mode = WAL")) {
+      // NORMAL only syncs at checkpoint.  Durable against application
+      // crashes; the most recent commits may be lost on power failure.
+      ignore_result(Execute("PRAGMA synchronous = NORMAL"));
+    }
+  } else {
+    ignore_result(Execute("PRAGMA journal_mode = TRUNCATE"));
+  }
 
   const base::TimeDelta kBusyTimeout =
     base::TimeDelta::FromSeconds(kBusyTimeoutSeconds);
@@ -144,6 +144,17 @@ class SQL_EXPORT Connection {
   // This must be called before Open() to have an effect.
   void set_exclusive_locking() { exclusive_locking_ = true; }
 
+  // Call to put the database in write-ahead logging mode, with synchronous
+  // set to NORMAL. In WAL mode commits only append to the -wal file and the
+  // sync to the main database happens when the log is checkpointed, so a
+  // burst of commits shares one sync instead of paying for one each. NORMAL
+  // synchronous is durable against application crashes, though the most
+  // recent commits may be lost on power failure.
+  //
+  // This must be called before Open() to have an effect, and is ignored for
+  // in-memory databases.
+  void set_journal_mode_wal() { journal_mode_wal_ = true; }
+
   // Call to cause Open() to restrict access permissions of the
   // database file to only the owner.
   // TODO(shess): Currently only supported on OS_POSIX, is a noop on
@@ -370,6 +381,37 @@ class SQL_EXPORT Connection {
   // no open transactions.
   int transaction_nesting() const { return transaction_nesting_; }
 
+  // Batched writes ------------------------------------------------------------
+
+  // Configures write batching for BeginBatchedWrite()/EndBatchedWrite().
+  // While a batch is open, completed batched writes accumulate in a single
+  // real transaction; EndBatchedWrite() commits it once |max_batched_writes|
+  // writes have accumulated or |max_batch_latency| has passed since the
+  // batch opened. A burst of small writes then pays for one commit (and, in
+  // WAL mode, one shared sync) instead of one per write. May be called at
+  // any time; |max_batched_writes| of 0 disables batching.
+  void set_write_batching(int max_batched_writes,
+                          base::TimeDelta max_batch_latency) {
+    max_batched_writes_ = max_batched_writes;
+    max_batch_latency_ = max_batch_latency;
+  }
+
+  // Wrap each independent mutation in BeginBatchedWrite()/EndBatchedWrite()
+  // instead of its own sql::Transaction to let the connection coalesce
+  // consecutive mutations per set_write_batching(). With batching disabled,
+  // each pair degenerates to a plain transaction. On failure of a batched
+  // mutation, call RollbackTransaction() instead of EndBatchedWrite(); this
+  // marks the whole batch for rollback, which takes effect on the next
+  // FlushBatchedWrites() or BeginBatchedWrite().
+  //
+  // Call FlushBatchedWrites() before points where the data must be durable
+  // (e.g. shutdown); an open batch is rolled back like any other open
+  // transaction if the connection is closed without committing. Returns true
+  // if there was no open batch or it committed cleanly.
+  bool BeginBatchedWrite();
+  bool EndBatchedWrite();
+  bool FlushBatchedWrites();
+
   // Attached databases---------------------------------------------------------
 
   // SQLite supports attaching multiple database files to a single
@@ -732,6 +774,7 @@ class SQL_EXPORT Connection {
   int cache_size_;
   bool exclusive_locking_;
   bool restrict_to_user_;
+  bool journal_mode_wal_;
 
   // All cached statements. Keeping a reference to these statements means that
   // they'll remain active.
@@ -753,6 +796,23 @@ class SQL_EXPORT Connection {
   // a rollback instead of a commit.
   bool needs_rollback_;
 
+  // Number of batched writes that triggers a batch commit, or 0 if write
+  // batching is disabled. See set_write_batching().
+  int max_batched_writes_;
+
+  // Maximum time a batch may be held open before EndBatchedWrite() commits
+  // it.
+  base::TimeDelta max_batch_latency_;
+
+  // True while a batched-write transaction is being held open.
+  bool batch_open_;
+
+  // Batched writes accumulated in the currently open batch.
+  int batch_write_count_;
+
+  // When the currently open batch was started, for the latency threshold.
+  base::TimeTicks batch_start_time_;
+
   // True if database is open with OpenInMemory(), False if database is open
   // with Open().
   bool in_memory_;
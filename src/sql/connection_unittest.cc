@@ -362,6 +362,63 @@ TEST_F(SQLConnectionTest, Rollback) {
   EXPECT_TRUE(db().BeginTransaction());
 }
 
+TEST_F(SQLConnectionTest, BatchedWrites) {
+  ASSERT_TRUE(db().Execute("CREATE TABLE foo (id INTEGER PRIMARY KEY, value)"));
+
+  db().set_write_batching(3, base::TimeDelta::FromMinutes(1));
+
+  // The first two writes are held open in a single real transaction.
+  ASSERT_TRUE(db().BeginBatchedWrite());
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (value) VALUES (1)"));
+  ASSERT_TRUE(db().EndBatchedWrite());
+  EXPECT_EQ(1, db().transaction_nesting());
+
+  ASSERT_TRUE(db().BeginBatchedWrite());
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (value) VALUES (2)"));
+  ASSERT_TRUE(db().EndBatchedWrite());
+  EXPECT_EQ(1, db().transaction_nesting());
+
+  // The third write reaches the size threshold and commits the batch.
+  ASSERT_TRUE(db().BeginBatchedWrite());
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (value) VALUES (3)"));
+  ASSERT_TRUE(db().EndBatchedWrite());
+  EXPECT_EQ(0, db().transaction_nesting());
+
+  {
+    sql::Statement s(db().GetUniqueStatement("SELECT COUNT(*) FROM foo"));
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ(3, s.ColumnInt(0));
+  }
+
+  // Flushing commits a partial batch.
+  ASSERT_TRUE(db().BeginBatchedWrite());
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (value) VALUES (4)"));
+  ASSERT_TRUE(db().EndBatchedWrite());
+  EXPECT_EQ(1, db().transaction_nesting());
+  EXPECT_TRUE(db().FlushBatchedWrites());
+  EXPECT_EQ(0, db().transaction_nesting());
+
+  // Rolling back a batched write discards the whole batch.
+  ASSERT_TRUE(db().BeginBatchedWrite());
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (value) VALUES (5)"));
+  db().RollbackTransaction();
+  EXPECT_FALSE(db().FlushBatchedWrites());
+  EXPECT_EQ(0, db().transaction_nesting());
+
+  {
+    sql::Statement s(db().GetUniqueStatement("SELECT COUNT(*) FROM foo"));
+    ASSERT_TRUE(s.Step());
+    EXPECT_EQ(4, s.ColumnInt(0));
+  }
+
+  // With batching disabled, each pair is a plain transaction.
+  db().set_write_batching(0, base::TimeDelta());
+  ASSERT_TRUE(db().BeginBatchedWrite());
+  ASSERT_TRUE(db().Execute("INSERT INTO foo (value) VALUES (6)"));
+  ASSERT_TRUE(db().EndBatchedWrite());
+  EXPECT_EQ(0, db().transaction_nesting());
+}
+
 // Test the scoped error expecter by attempting to insert a duplicate
 // value into an index.
 TEST_F(SQLConnectionTest, ScopedErrorExpecter) {
@@ -89,6 +89,18 @@ GURL::GURL(GURL&& other) noexcept
 }
 
 GURL::GURL(base::StringPiece url_string) {
+  if (url::IsCanonicalStandardSpec(url_string.data(),
+                                   static_cast<int>(url_string.length()),
+                                   &parsed_)) {
+    // The input is already in canonical form, which is the common case for
+    // URLs we generate ourselves; adopt its bytes without running the
+    // canonicalizer. InitializeFromCanonicalSpec() cross-checks this against
+    // a full canonicalization in debug builds.
+    spec_.assign(url_string.data(), url_string.length());
+    is_valid_ = true;
+    InitializeFromCanonicalSpec();
+    return;
+  }
   InitCanonical(url_string, true);
 }
 
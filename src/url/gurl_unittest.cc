@@ -97,6 +97,26 @@ TEST(GURLTest, Components) {
   EXPECT_EQ("12345", url_special_pass.port());
 }
 
+TEST(GURLTest, AlreadyCanonical) {
+  // Construction from an already-canonical spec takes a fast path that
+  // adopts the input bytes without running the canonicalizer; the result
+  // must be indistinguishable from full canonicalization.
+  GURL url("http://www.example.com:8080/path/file.html?q=1#ref");
+  EXPECT_TRUE(url.is_valid());
+  EXPECT_EQ("http://www.example.com:8080/path/file.html?q=1#ref", url.spec());
+  EXPECT_EQ("http", url.scheme());
+  EXPECT_EQ("www.example.com", url.host());
+  EXPECT_EQ("8080", url.port());
+  EXPECT_EQ("/path/file.html", url.path());
+  EXPECT_EQ("q=1", url.query());
+  EXPECT_EQ("ref", url.ref());
+
+  // Inputs that need rewriting still go through the canonicalizer.
+  GURL rewritten("HTTP://www.Example.Com:80/a/./b");
+  EXPECT_TRUE(rewritten.is_valid());
+  EXPECT_EQ("http://www.example.com/a/b", rewritten.spec());
+}
+
 TEST(GURLTest, Empty) {
   GURL url;
   EXPECT_FALSE(url.is_valid());
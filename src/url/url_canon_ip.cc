@@ -118,13 +118,15 @@ CanonHostInfo::Family IPv4ComponentToNumber(const CHAR* spec,
          spec[component.begin + base_prefix_len] == '0')
     base_prefix_len++;
 
-  // Put the component, minus any base prefix, into a NULL-terminated buffer so
-  // we can call the standard library. Because leading zeros have already been
-  // discarded, filling the entire buffer is guaranteed to trigger the 32-bit
-  // overflow check.
-  const int kMaxComponentLen = 16;
-  char buf[kMaxComponentLen + 1];  // digits + '\0'
-  int dest_i = 0;
+  // Accumulate the value directly while validating each character.
+  // |kOverflow| is past the largest representable value; once the
+  // accumulator reaches it, it is clamped there so that arbitrarily long
+  // components keep reporting 32-bit overflow (and keep being validated)
+  // without overflowing the 64-bit accumulator.
+  const uint64_t kOverflow =
+      static_cast<uint64_t>(std::numeric_limits<uint32_t>::max()) + 1;
+  const uint64_t base_value = static_cast<uint64_t>(BaseForType(base));
+  uint64_t num = 0;
   for (int i = component.begin + base_prefix_len; i < component.end(); i++) {
     // We know the input is 7-bit, so convert to narrow (if this is the wide
     // version of the template) by casting.
@@ -134,18 +136,12 @@ CanonHostInfo::Family IPv4ComponentToNumber(const CHAR* spec,
     if (!IsCharOfType(input, base))
       return CanonHostInfo::NEUTRAL;
 
-    // Fill the buffer, if there's space remaining. This check allows us to
-    // verify that all characters are numeric, even those that don't fit.
-    if (dest_i < kMaxComponentLen)
-      buf[dest_i++] = input;
+    // HexCharToValue() maps digits to their value in every supported base.
+    num = num * base_value + HexCharToValue(input);
+    if (num >= kOverflow)
+      num = kOverflow;
   }
 
-  buf[dest_i] = '\0';
-
-  // Use the 64-bit strtoi so we get a big number (no hex, decimal, or octal
-  // number can overflow a 64-bit number in <= 16 characters).
-  uint64_t num = _strtoui64(buf, NULL, BaseForType(base));
-
   // Check for 32-bit overflow.
   if (num > std::numeric_limits<uint32_t>::max())
     return CanonHostInfo::BROKEN;
@@ -507,6 +507,230 @@ void DoAddSchemeWithType(const char* new_scheme,
   schemes->push_back(scheme_with_type);
 }
 
+// Character classes for DoIsCanonicalStandardSpec() below. Each predicate
+// accepts exactly those characters that the corresponding canonicalizer is
+// known to emit unchanged for unescaped input; everything else makes the
+// checker bail out so the caller falls back to full canonicalization.
+
+bool IsCanonicalHostChar(unsigned char ch) {
+  // Characters that kHostCharLookup in url_canon_host.cc maps to themselves.
+  // '+', '[', ']' and ':' also map to themselves but only appear in IPv6
+  // literals and ports, which the fast path does not model.
+  return (ch >= 'a' && ch <= 'z') || (ch >= '0' && ch <= '9') || ch == '-' ||
+         ch == '.' || ch == '_';
+}
+
+bool IsCanonicalPathChar(unsigned char ch) {
+  // Characters marked PASS or UNESCAPE in kPathCharLookup in
+  // url_canon_path.cc. Dots are accepted here; "." and ".." directory
+  // segments, which the canonicalizer resolves away, are rejected separately.
+  if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+      (ch >= '0' && ch <= '9'))
+    return true;
+  switch (ch) {
+    case '!':
+    case '$':
+    case '&':
+    case '\'':
+    case '(':
+    case ')':
+    case '*':
+    case '+':
+    case ',':
+    case '-':
+    case '.':
+    case '/':
+    case ':':
+    case ';':
+    case '=':
+    case '@':
+    case '[':
+    case ']':
+    case '_':
+    case '~':
+      return true;
+  }
+  return false;
+}
+
+// Returns true if the host between |begin| and |end| is a canonical IPv4
+// literal: exactly four decimal components, each 0-255 with no leading zeros.
+bool IsCanonicalIPv4Literal(const char* spec, int begin, int end) {
+  int pos = begin;
+  for (int component = 0; component < 4; component++) {
+    if (component > 0) {
+      if (pos >= end || spec[pos] != '.')
+        return false;
+      pos++;
+    }
+    int digits_begin = pos;
+    int value = 0;
+    while (pos < end && spec[pos] >= '0' && spec[pos] <= '9' &&
+           pos - digits_begin < 3) {
+      value = value * 10 + (spec[pos] - '0');
+      pos++;
+    }
+    int num_digits = pos - digits_begin;
+    if (num_digits == 0 || value > 255 ||
+        (num_digits > 1 && spec[digits_begin] == '0'))
+      return false;
+  }
+  return pos == end;
+}
+
+// Backend for IsCanonicalStandardSpec(); see the header comment there. Only
+// fills in |*parsed| when returning true.
+bool DoIsCanonicalStandardSpec(const char* spec, int spec_len, Parsed* parsed) {
+  // Only the built-in standard schemes are recognized; all of them are
+  // canonicalized by CanonicalizeStandardURL() with a default port.
+  struct SchemeAndSeparator {
+    const char* prefix;  // Lowercase scheme plus "://".
+    int scheme_len;
+    int default_port;
+  };
+  static const SchemeAndSeparator kSchemes[] = {
+      {"http://", 4, 80},
+      {"https://", 5, 443},
+      {"ws://", 2, 80},
+      {"wss://", 3, 443},
+      {"ftp://", 3, 21},
+  };
+
+  const SchemeAndSeparator* scheme = NULL;
+  for (size_t i = 0; i < arraysize(kSchemes); i++) {
+    int prefix_len = kSchemes[i].scheme_len + 3;
+    if (spec_len > prefix_len &&
+        !memcmp(spec, kSchemes[i].prefix, prefix_len)) {
+      scheme = &kSchemes[i];
+      break;
+    }
+  }
+  if (!scheme)
+    return false;
+
+  // Host. Stopping only at the characters below means any user info will run
+  // into an '@' or other character outside the host set and get rejected,
+  // which is what we want: the canonicalizer rewrites user info.
+  int host_begin = scheme->scheme_len + 3;
+  int p = host_begin;
+  while (p < spec_len && spec[p] != ':' && spec[p] != '/' && spec[p] != '?' &&
+         spec[p] != '#') {
+    if (!IsCanonicalHostChar(static_cast<unsigned char>(spec[p])))
+      return false;
+    p++;
+  }
+  int host_end = p;
+  if (host_end == host_begin)
+    return false;
+
+  // Reject empty host labels, except for a single trailing dot which the
+  // canonicalizer preserves on registry names.
+  int effective_host_end = host_end;
+  if (spec[effective_host_end - 1] == '.') {
+    effective_host_end--;
+    if (effective_host_end == host_begin)
+      return false;
+  }
+  int last_label_begin = host_begin;
+  for (int i = host_begin; i < effective_host_end; i++) {
+    if (spec[i] == '.') {
+      if (i == last_label_begin)
+        return false;
+      last_label_begin = i + 1;
+    }
+  }
+  if (last_label_begin == effective_host_end)
+    return false;
+
+  // The host canonicalizer rewrites any host whose components are all
+  // numbers as an IPv4 literal, so a host whose last component starts with a
+  // digit is only canonical when it already is a dotted-quad literal.
+  if (spec[last_label_begin] >= '0' && spec[last_label_begin] <= '9' &&
+      !IsCanonicalIPv4Literal(spec, host_begin, host_end))
+    return false;
+
+  // Port. The canonical form has no leading zeros and omits the default port
+  // for the scheme entirely.
+  Component port;
+  if (p < spec_len && spec[p] == ':') {
+    p++;
+    port.begin = p;
+    int value = 0;
+    while (p < spec_len && spec[p] >= '0' && spec[p] <= '9' &&
+           p - port.begin < 5) {
+      value = value * 10 + (spec[p] - '0');
+      p++;
+    }
+    port.len = p - port.begin;
+    if (port.len == 0 || spec[port.begin] == '0' || value > 65535 ||
+        value == scheme->default_port)
+      return false;
+  }
+
+  // Path. Canonical standard URLs always have one, starting with a slash.
+  if (p == spec_len || spec[p] != '/')
+    return false;
+  Component path;
+  path.begin = p;
+  while (p < spec_len && spec[p] != '?' && spec[p] != '#') {
+    unsigned char ch = static_cast<unsigned char>(spec[p]);
+    if (!IsCanonicalPathChar(ch))
+      return false;
+    if (ch == '.' && spec[p - 1] == '/') {
+      // A dot after a slash begins a "." or ".." directory segment if
+      // another slash or the end of the path follows, matching
+      // ClassifyAfterDot() in url_canon_path.cc.
+      int after_dots = p + 1;
+      if (after_dots < spec_len && spec[after_dots] == '.')
+        after_dots++;
+      if (after_dots == spec_len || spec[after_dots] == '/' ||
+          spec[after_dots] == '?' || spec[after_dots] == '#')
+        return false;
+    }
+    p++;
+  }
+  path.len = p - path.begin;
+
+  // Query. CHAR_QUERY characters (including '%') pass through the query
+  // canonicalizer unchanged, and it never unescapes.
+  Component query;
+  if (p < spec_len && spec[p] == '?') {
+    p++;
+    query.begin = p;
+    while (p < spec_len && spec[p] != '#') {
+      if (!IsQueryChar(static_cast<unsigned char>(spec[p])))
+        return false;
+      p++;
+    }
+    query.len = p - query.begin;
+  }
+
+  // Ref. The canonicalizer passes printable ASCII through unchanged; spaces
+  // are rejected since the parser trims trailing ones.
+  Component ref;
+  if (p < spec_len) {
+    DCHECK(spec[p] == '#');
+    p++;
+    ref.begin = p;
+    while (p < spec_len) {
+      unsigned char ch = static_cast<unsigned char>(spec[p]);
+      if (ch <= 0x20 || ch >= 0x7f)
+        return false;
+      p++;
+    }
+    ref.len = p - ref.begin;
+  }
+
+  *parsed = Parsed();
+  parsed->scheme = Component(0, scheme->scheme_len);
+  parsed->host = Component(host_begin, host_end - host_begin);
+  parsed->port = port;
+  parsed->path = path;
+  parsed->query = query;
+  parsed->ref = ref;
+  return true;
+}
+
 }  // namespace
 
 void Initialize() {
@@ -737,6 +961,10 @@ bool Canonicalize(const base::char16* spec,
                         charset_converter, output, output_parsed);
 }
 
+bool IsCanonicalStandardSpec(const char* spec, int spec_len, Parsed* parsed) {
+  return DoIsCanonicalStandardSpec(spec, spec_len, parsed);
+}
+
 bool ResolveRelative(const char* base_spec,
                      int base_spec_len,
                      const Parsed& base_parsed,
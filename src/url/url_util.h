@@ -213,6 +213,17 @@ URL_EXPORT bool Canonicalize(const base::char16* spec,
                              CanonOutput* output,
                              Parsed* output_parsed);
 
+// Returns true if |spec| is a standard URL (http, https, ws, wss or ftp)
+// that is already in canonical form, filling in |*parsed| with its component
+// ranges on success. This is a conservative single-pass check: it never
+// accepts a spec that Canonicalize() would rewrite, but it does return false
+// for some unusual canonical specs (IPv6 literals, user info, escape
+// sequences outside the query, ...), so on false the caller must fall back
+// to Canonicalize(). |*parsed| is left untouched in that case.
+URL_EXPORT bool IsCanonicalStandardSpec(const char* spec,
+                                        int spec_len,
+                                        Parsed* parsed);
+
 // Resolves a potentially relative URL relative to the given parsed base URL.
 // The base MUST be valid. The resulting canonical URL and parsed information
 // will be placed in to the given out variables.
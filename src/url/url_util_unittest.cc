@@ -110,6 +110,86 @@ TEST(URLUtilTest, GetStandardSchemeType) {
                                      &scheme_type));
 }
 
+TEST(URLUtilTest, IsCanonicalStandardSpec) {
+  // Specs that are already canonical must be accepted, and for each of them
+  // a full canonicalization must reproduce the input byte for byte with the
+  // same component ranges.
+  const char* accept_cases[] = {
+      "http://www.example.com/",
+      "https://example.com/path/file.html?q=1&b=2#frag",
+      "http://example.com:8080/",
+      "ftp://ftp.example.com/pub/",
+      "ws://example.com/socket",
+      "wss://example.com:8443/socket?x",
+      "http://10.0.0.1/",
+      "http://10.0.0.1:3128/proxy.pac",
+      "http://example.com./",
+      "http://foo_bar.example.com/",
+      "http://example.com/a//b/",
+      "http://example.com/?",
+      "http://example.com/#",
+      "http://example.com/p?q=%zz",
+      "http://example.com/~user/(1)/;p=x",
+  };
+  for (size_t i = 0; i < arraysize(accept_cases); i++) {
+    const char* spec = accept_cases[i];
+    int spec_len = static_cast<int>(strlen(spec));
+    Parsed parsed;
+    EXPECT_TRUE(IsCanonicalStandardSpec(spec, spec_len, &parsed)) << spec;
+
+    std::string canonical;
+    StdStringCanonOutput output(&canonical);
+    Parsed canonical_parsed;
+    EXPECT_TRUE(
+        Canonicalize(spec, spec_len, true, NULL, &output, &canonical_parsed));
+    output.Complete();
+    EXPECT_EQ(spec, canonical);
+    EXPECT_TRUE(parsed.scheme == canonical_parsed.scheme) << spec;
+    EXPECT_TRUE(parsed.username == canonical_parsed.username) << spec;
+    EXPECT_TRUE(parsed.password == canonical_parsed.password) << spec;
+    EXPECT_TRUE(parsed.host == canonical_parsed.host) << spec;
+    EXPECT_TRUE(parsed.port == canonical_parsed.port) << spec;
+    EXPECT_TRUE(parsed.path == canonical_parsed.path) << spec;
+    EXPECT_TRUE(parsed.query == canonical_parsed.query) << spec;
+    EXPECT_TRUE(parsed.ref == canonical_parsed.ref) << spec;
+  }
+
+  // Specs that the canonicalizer would rewrite or reject, plus canonical
+  // ones outside the conservative fast path, must not be accepted.
+  const char* reject_cases[] = {
+      "HTTP://example.com/",       // Uppercase scheme.
+      "http://EXAMPLE.com/",       // Uppercase host.
+      "http://example.com",        // Missing path.
+      "http://example.com:80/",    // Default port.
+      "https://example.com:443/",  // Default port.
+      "http://example.com:008/",   // Leading zeros in port.
+      "http://example.com:/",      // Empty port.
+      "http://example.com/a/./b",  // "." segment.
+      "http://example.com/a/..",   // ".." segment.
+      "http://example.com/a b",    // Space needs escaping.
+      "http://example.com/a%2eb",  // Escape sequence in path.
+      "http://user@example.com/",  // User info takes the slow path.
+      "http://0x7f.0.0.1/",        // Non-canonical IPv4.
+      "http://1.2.3.4.5/",         // Broken IPv4.
+      "http://01.2.3.4/",          // Leading zero in IPv4.
+      "http://1.2.3.4./",          // Trailing dot on IPv4.
+      "http://12345678/",          // All-digit host.
+      "http://example..com/",      // Empty host label.
+      "http://.example.com/",      // Empty host label.
+      "http://[::1]/",             // IPv6 takes the slow path.
+      " http://example.com/",      // Whitespace gets trimmed.
+      "file:///etc/passwd",        // Not a standard scheme.
+      "mailto:someone@example.com",
+  };
+  for (size_t i = 0; i < arraysize(reject_cases); i++) {
+    const char* spec = reject_cases[i];
+    Parsed parsed;
+    EXPECT_FALSE(IsCanonicalStandardSpec(
+        spec, static_cast<int>(strlen(spec)), &parsed))
+        << spec;
+  }
+}
+
 TEST(URLUtilTest, ReplaceComponents) {
   Parsed parsed;
   RawCanonOutputT<char> output;